@@ -0,0 +1,150 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cuda_runtime.h>
+#include <thrust/host_vector.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
+
+namespace benchmark_utility {
+
+/// Times the GPU work enqueued on the per-thread default stream between
+/// Start() and Stop(), which returns it in seconds for
+/// benchmark::State::SetIterationTime().
+class CudaTimer {
+public:
+    CudaTimer() {
+        cudaSafeCall(cudaEventCreate(&start_));
+        cudaSafeCall(cudaEventCreate(&stop_));
+    }
+    ~CudaTimer() {
+        cudaEventDestroy(start_);
+        cudaEventDestroy(stop_);
+    }
+
+    void Start() { cudaSafeCall(cudaEventRecord(start_, cudaStreamPerThread)); }
+
+    double Stop() {
+        cudaSafeCall(cudaEventRecord(stop_, cudaStreamPerThread));
+        cudaSafeCall(cudaEventSynchronize(stop_));
+        float ms = 0.0f;
+        cudaSafeCall(cudaEventElapsedTime(&ms, start_, stop_));
+        return ms * 1.0e-3;
+    }
+
+private:
+    cudaEvent_t start_;
+    cudaEvent_t stop_;
+};
+
+/// Runs \p func once per iteration of \p state, timed by a CudaTimer. The
+/// benchmarks using it are registered with UseManualTime().
+template <typename Func>
+void RunTimed(benchmark::State &state, Func func) {
+    CudaTimer timer;
+    for (auto _ : state) {
+        timer.Start();
+        func();
+        state.SetIterationTime(timer.Stop());
+    }
+}
+
+/// Runs \p func once per iteration of \p state with the iteration index, as
+/// one frame of a pipeline, and reports the sustained frame rate, the latency
+/// percentiles and the peak device memory of the run as counters, which the
+/// JSON output of --benchmark_format=json includes.
+template <typename Func>
+void RunPipeline(benchmark::State &state, Func func) {
+    const bool tracking = cupoch::utility::IsMemoryTrackingEnabled();
+    cupoch::utility::EnableMemoryTracking(true);
+    cupoch::utility::ResetPeakMemoryUsage();
+    CudaTimer timer;
+    std::vector<double> latencies;
+    int64_t frame = 0;
+    for (auto _ : state) {
+        timer.Start();
+        func(frame++);
+        latencies.push_back(timer.Stop());
+        state.SetIterationTime(latencies.back());
+    }
+    const auto total = cupoch::utility::GetMemoryUsage().back();
+    cupoch::utility::EnableMemoryTracking(tracking);
+    if (latencies.empty()) return;
+
+    double sum = 0.0;
+    for (double latency : latencies) sum += latency;
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        const size_t i = std::min(latencies.size() - 1,
+                                  size_t(p * latencies.size()));
+        return latencies[i] * 1.0e3;
+    };
+    state.counters["fps"] = latencies.size() / sum;
+    state.counters["p50_ms"] = percentile(0.5);
+    state.counters["p95_ms"] = percentile(0.95);
+    state.counters["p99_ms"] = percentile(0.99);
+    state.counters["peak_mb"] = total.peak_bytes_ / 1048576.0;
+}
+
+/// \p n points sampled on a wavy surface of 4 x 4 m with some noise, colored
+/// by their height, deterministic for a given \p seed.
+inline std::shared_ptr<cupoch::geometry::PointCloud> CreateSurfacePointCloud(
+        size_t n, int seed = 0) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<float> xy(-2.0f, 2.0f);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    thrust::host_vector<Eigen::Vector3f> points(n);
+    thrust::host_vector<Eigen::Vector3f> colors(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float x = xy(engine);
+        const float y = xy(engine);
+        const float z = 0.2f * std::sin(2.0f * x) * std::cos(2.0f * y) +
+                        noise(engine);
+        points[i] = Eigen::Vector3f(x, y, z);
+        const float c = 0.5f + 2.5f * z;
+        colors[i] = Eigen::Vector3f(c, 1.0f - c, 0.5f);
+    }
+    auto pointcloud = std::make_shared<cupoch::geometry::PointCloud>();
+    pointcloud->SetPoints(points);
+    pointcloud->SetColors(colors);
+    return pointcloud;
+}
+
+/// RGBD frame of \p width x \p height seeing a slanted plane 1 to 2 m away,
+/// with its color in 8 bits and its depth in meters.
+inline std::shared_ptr<cupoch::geometry::RGBDImage> CreatePlaneRGBDImage(
+        int width, int height) {
+    cupoch::geometry::Image color;
+    cupoch::geometry::Image depth;
+    color.Prepare(width, height, 3, 1);
+    depth.Prepare(width, height, 1, 2);
+    thrust::host_vector<uint8_t> color_data(width * height * 3);
+    thrust::host_vector<uint8_t> depth_data(width * height * 2);
+    for (int v = 0; v < height; ++v) {
+        for (int u = 0; u < width; ++u) {
+            const int i = v * width + u;
+            const uint16_t d = uint16_t(1000 + 1000 * u / width);
+            depth_data[2 * i] = uint8_t(d & 0xff);
+            depth_data[2 * i + 1] = uint8_t(d >> 8);
+            color_data[3 * i] = uint8_t(255 * u / width);
+            color_data[3 * i + 1] = uint8_t(255 * v / height);
+            color_data[3 * i + 2] = 128;
+        }
+    }
+    color.SetData(color_data);
+    depth.SetData(depth_data);
+    return cupoch::geometry::RGBDImage::CreateFromColorAndDepth(
+            color, depth, 1000.0, 4.0, false);
+}
+
+}  // namespace benchmark_utility
@@ -0,0 +1,107 @@
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/occupancygrid.h"
+
+#include "benchmarks/benchmark_utility.h"
+
+using namespace cupoch;
+using namespace benchmark_utility;
+
+namespace {
+
+void BM_VoxelDownSample(benchmark::State &state) {
+    auto pointcloud = CreateSurfacePointCloud(state.range(0));
+    RunTimed(state, [&] {
+        benchmark::DoNotOptimize(pointcloud->VoxelDownSample(0.02));
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_EstimateNormals(benchmark::State &state) {
+    auto pointcloud = CreateSurfacePointCloud(state.range(0));
+    RunTimed(state, [&] {
+        pointcloud->EstimateNormals(geometry::KDTreeSearchParamKNN(20));
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_KDTreeFlannSearchKNN(benchmark::State &state) {
+    auto pointcloud = CreateSurfacePointCloud(state.range(0));
+    geometry::KDTreeFlann kdtree(*pointcloud);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    RunTimed(state, [&] {
+        kdtree.SearchKNN(pointcloud->points_, int(state.range(1)), indices,
+                         distance2);
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_KDTreeFlannSearchHybrid(benchmark::State &state) {
+    auto pointcloud = CreateSurfacePointCloud(state.range(0));
+    geometry::KDTreeFlann kdtree(*pointcloud);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    RunTimed(state, [&] {
+        kdtree.SearchHybrid(pointcloud->points_, 0.05f, 30, indices,
+                            distance2);
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OccupancyGridInsert(benchmark::State &state) {
+    auto pointcloud = CreateSurfacePointCloud(state.range(0));
+    pointcloud->Translate(Eigen::Vector3f(0.0f, 0.0f, -1.0f));
+    geometry::OccupancyGrid grid(0.02f, 256);
+    RunTimed(state, [&] {
+        grid.Insert(pointcloud->points_, Eigen::Vector3f::Zero());
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ComputeEDT(benchmark::State &state) {
+    const int resolution = int(state.range(0));
+    std::mt19937 engine(0);
+    std::uniform_int_distribution<int> cell(0, resolution - 1);
+    thrust::host_vector<Eigen::Vector3i> sites(resolution * resolution);
+    for (auto &site : sites) {
+        site = Eigen::Vector3i(cell(engine), cell(engine), cell(engine));
+    }
+    utility::device_vector<Eigen::Vector3i> sites_dv = sites;
+    geometry::DistanceTransform dt(1.0f / resolution, resolution);
+    RunTimed(state, [&] { dt.ComputeEDT(sites_dv); });
+    state.SetItemsProcessed(state.iterations() * resolution * resolution *
+                            resolution);
+}
+
+}  // namespace
+
+BENCHMARK(BM_VoxelDownSample)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EstimateNormals)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KDTreeFlannSearchKNN)
+        ->ArgsProduct({{10000, 100000, 1000000}, {1, 16}})
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KDTreeFlannSearchHybrid)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OccupancyGridInsert)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ComputeEDT)
+        ->RangeMultiplier(2)
+        ->Range(64, 256)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
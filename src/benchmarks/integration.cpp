@@ -0,0 +1,57 @@
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+
+#include "benchmarks/benchmark_utility.h"
+
+using namespace cupoch;
+using namespace benchmark_utility;
+
+namespace {
+
+camera::PinholeCameraIntrinsic CreateIntrinsic(int width, int height) {
+    const float f = 525.0f * width / 640.0f;
+    return camera::PinholeCameraIntrinsic(width, height, f, f,
+                                          0.5f * (width - 1),
+                                          0.5f * (height - 1));
+}
+
+void BM_ScalableTSDFVolumeIntegrate(benchmark::State &state) {
+    const int width = int(state.range(0));
+    const int height = width * 3 / 4;
+    auto rgbd = CreatePlaneRGBDImage(width, height);
+    const auto intrinsic = CreateIntrinsic(width, height);
+    integration::ScalableTSDFVolume volume(
+            4.0f / 512, 0.04f, integration::TSDFVolumeColorType::RGB8);
+    RunTimed(state, [&] {
+        volume.Integrate(*rgbd, intrinsic, Eigen::Matrix4f::Identity());
+    });
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_ScalableTSDFVolumeExtractTriangleMesh(benchmark::State &state) {
+    const int width = int(state.range(0));
+    const int height = width * 3 / 4;
+    auto rgbd = CreatePlaneRGBDImage(width, height);
+    const auto intrinsic = CreateIntrinsic(width, height);
+    integration::ScalableTSDFVolume volume(
+            4.0f / 512, 0.04f, integration::TSDFVolumeColorType::RGB8);
+    for (int i = 0; i < 3; ++i) {
+        volume.Integrate(*rgbd, intrinsic, Eigen::Matrix4f::Identity());
+    }
+    RunTimed(state, [&] {
+        benchmark::DoNotOptimize(volume.ExtractTriangleMesh());
+    });
+}
+
+}  // namespace
+
+BENCHMARK(BM_ScalableTSDFVolumeIntegrate)
+        ->Arg(320)
+        ->Arg(640)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ScalableTSDFVolumeExtractTriangleMesh)
+        ->Arg(320)
+        ->Arg(640)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,128 @@
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/io/class_io/image_io.h"
+#include "cupoch/odometry/odometry.h"
+#include "cupoch/utility/console.h"
+
+#include "benchmarks/benchmark_utility.h"
+
+using namespace cupoch;
+using namespace benchmark_utility;
+
+namespace {
+
+const int kNumRGBDFrames = 5;
+
+std::shared_ptr<geometry::RGBDImage> ReadRGBDFrame(int i) {
+    geometry::Image color;
+    std::ostringstream color_path;
+    color_path << TEST_DATA_DIR << "/rgbd/color/" << std::setfill('0')
+               << std::setw(5) << i << ".jpg";
+    geometry::Image depth;
+    std::ostringstream depth_path;
+    depth_path << TEST_DATA_DIR << "/rgbd/depth/" << std::setfill('0')
+               << std::setw(5) << i << ".png";
+    if (!io::ReadImage(color_path.str(), color) ||
+        !io::ReadImage(depth_path.str(), depth)) {
+        utility::LogError("Failed to read the RGBD frame {:d}.", i);
+    }
+    return geometry::RGBDImage::CreateFromColorAndDepth(color, depth);
+}
+
+/// Scan of a spinning LiDAR of \p num_beams x \p num_azimuths rays at
+/// \p origin inside a 20 x 20 x 4 m room centered on the origin.
+thrust::host_vector<Eigen::Vector3f> CreateLiDARScan(
+        const Eigen::Vector3f &origin, int num_beams, int num_azimuths) {
+    const Eigen::Vector3f room_min(-10.0f, -10.0f, -1.0f);
+    const Eigen::Vector3f room_max(10.0f, 10.0f, 3.0f);
+    thrust::host_vector<Eigen::Vector3f> points;
+    points.reserve(num_beams * num_azimuths);
+    for (int b = 0; b < num_beams; ++b) {
+        const float elevation =
+                (-15.0f + 30.0f * b / std::max(num_beams - 1, 1)) * M_PI /
+                180.0f;
+        for (int a = 0; a < num_azimuths; ++a) {
+            const float azimuth = 2.0f * M_PI * a / num_azimuths;
+            const Eigen::Vector3f dir(std::cos(elevation) * std::cos(azimuth),
+                                      std::cos(elevation) * std::sin(azimuth),
+                                      std::sin(elevation));
+            // Exit distance of the ray from the room.
+            float t = std::numeric_limits<float>::max();
+            for (int k = 0; k < 3; ++k) {
+                if (dir[k] > 0.0f) {
+                    t = std::min(t, (room_max[k] - origin[k]) / dir[k]);
+                } else if (dir[k] < 0.0f) {
+                    t = std::min(t, (room_min[k] - origin[k]) / dir[k]);
+                }
+            }
+            if (t < 30.0f) points.push_back(origin + t * dir);
+        }
+    }
+    return points;
+}
+
+/// Replays the test RGBD sequence back and forth through the frame-to-frame
+/// odometry and the integration of each frame at its tracked pose.
+void BM_RGBDOdometryIntegrationPipeline(benchmark::State &state) {
+    std::vector<std::shared_ptr<geometry::RGBDImage>> frames;
+    for (int i = 0; i < kNumRGBDFrames; ++i) {
+        frames.push_back(ReadRGBDFrame(i));
+    }
+    const camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    odometry::RGBDOdometryTracker tracker(intrinsic);
+    integration::ScalableTSDFVolume volume(
+            4.0f / 512, 0.04f, integration::TSDFVolumeColorType::Gray32);
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    RunPipeline(state, [&](int64_t n) {
+        const int period = 2 * (kNumRGBDFrames - 1);
+        const int phase = int(n % period);
+        const int i = phase < kNumRGBDFrames ? phase : period - phase;
+        const auto &frame = *frames[i];
+        const auto result = tracker.Track(frame);
+        if (std::get<0>(result)) pose = pose * std::get<1>(result);
+        // The volume takes the camera to world transform inverse.
+        volume.Integrate(frame, intrinsic, pose.inverse());
+    });
+    state.SetItemsProcessed(state.iterations());
+}
+
+/// Inserts the scans of a LiDAR moving on a circle into an occupancy grid.
+void BM_LiDAROccupancyMappingPipeline(benchmark::State &state) {
+    const int num_beams = int(state.range(0));
+    const int num_azimuths = 1024;
+    const int num_scans = 64;
+    std::vector<utility::device_vector<Eigen::Vector3f>> scans;
+    std::vector<Eigen::Vector3f> origins;
+    for (int i = 0; i < num_scans; ++i) {
+        const float angle = 2.0f * M_PI * i / num_scans;
+        origins.emplace_back(5.0f * std::cos(angle), 5.0f * std::sin(angle),
+                             0.5f);
+        scans.emplace_back(
+                CreateLiDARScan(origins.back(), num_beams, num_azimuths));
+    }
+    geometry::OccupancyGrid grid(0.1f, 256);
+    RunPipeline(state, [&](int64_t n) {
+        const int i = int(n % num_scans);
+        grid.Insert(scans[i], origins[i]);
+    });
+    state.SetItemsProcessed(state.iterations() * num_beams * num_azimuths);
+}
+
+}  // namespace
+
+BENCHMARK(BM_RGBDOdometryIntegrationPipeline)
+        ->Iterations(200)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LiDAROccupancyMappingPipeline)
+        ->Arg(16)
+        ->Arg(64)
+        ->Iterations(256)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
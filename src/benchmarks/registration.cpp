@@ -0,0 +1,57 @@
+#include <Eigen/Geometry>
+
+#include "cupoch/registration/colored_icp.h"
+#include "cupoch/registration/registration.h"
+
+#include "benchmarks/benchmark_utility.h"
+
+using namespace cupoch;
+using namespace benchmark_utility;
+
+namespace {
+
+Eigen::Matrix4f SmallMotion() {
+    Eigen::Matrix4f motion = Eigen::Matrix4f::Identity();
+    motion.block<3, 3>(0, 0) =
+            Eigen::AngleAxisf(0.02f, Eigen::Vector3f::UnitZ()).matrix();
+    motion.block<3, 1>(0, 3) = Eigen::Vector3f(0.01f, -0.02f, 0.005f);
+    return motion;
+}
+
+void BM_RegistrationICP(benchmark::State &state) {
+    auto target = CreateSurfacePointCloud(state.range(0));
+    auto source = CreateSurfacePointCloud(state.range(0), 1);
+    source->Transform(SmallMotion());
+    RunTimed(state, [&] {
+        benchmark::DoNotOptimize(registration::RegistrationICP(
+                *source, *target, 0.05f, Eigen::Matrix4f::Identity(),
+                registration::TransformationEstimationPointToPoint()));
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_RegistrationColoredICP(benchmark::State &state) {
+    auto target = CreateSurfacePointCloud(state.range(0));
+    auto source = CreateSurfacePointCloud(state.range(0), 1);
+    source->Transform(SmallMotion());
+    target->EstimateNormals(geometry::KDTreeSearchParamKNN(20));
+    source->EstimateNormals(geometry::KDTreeSearchParamKNN(20));
+    RunTimed(state, [&] {
+        benchmark::DoNotOptimize(
+                registration::RegistrationColoredICP(*source, *target, 0.05f));
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_RegistrationICP)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RegistrationColoredICP)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include <Eigen/Core>
+#include <cmath>
+
+namespace cupoch {
+namespace camera {
+
+/// \enum DistortionModel
+///
+/// \brief Lens distortion of the normalized image coordinates, with the
+/// coefficients in the order of OpenCV.
+enum class DistortionModel {
+    /// Ideal pinhole camera.
+    None = 0,
+    /// Brown-Conrady radial and tangential distortion, coefficients
+    /// (k1, k2, p1, p2, k3).
+    BrownConrady = 1,
+    /// Equidistant fisheye distortion of the angle of incidence,
+    /// coefficients (k1, k2, k3, k4).
+    Fisheye = 2,
+};
+
+typedef Eigen::Matrix<float, 5, 1> DistortionCoefficients;
+
+/// Distorts the normalized coordinates \p xy of a point of the ideal
+/// pinhole camera.
+__host__ __device__ inline Eigen::Vector2f DistortNormalizedPoint(
+        DistortionModel model,
+        const DistortionCoefficients &coeffs,
+        const Eigen::Vector2f &xy) {
+    const float x = xy[0];
+    const float y = xy[1];
+    const float r2 = x * x + y * y;
+    switch (model) {
+        case DistortionModel::BrownConrady: {
+            const float radial =
+                    1.0f + r2 * (coeffs[0] + r2 * (coeffs[1] + r2 * coeffs[4]));
+            return Eigen::Vector2f(
+                    x * radial + 2.0f * coeffs[2] * x * y +
+                            coeffs[3] * (r2 + 2.0f * x * x),
+                    y * radial + coeffs[2] * (r2 + 2.0f * y * y) +
+                            2.0f * coeffs[3] * x * y);
+        }
+        case DistortionModel::Fisheye: {
+            const float r = sqrtf(r2);
+            if (r < 1.0e-8f) return xy;
+            const float theta = atanf(r);
+            const float t2 = theta * theta;
+            const float poly =
+                    coeffs[0] +
+                    t2 * (coeffs[1] + t2 * (coeffs[2] + t2 * coeffs[3]));
+            const float theta_d = theta * (1.0f + t2 * poly);
+            return xy * (theta_d / r);
+        }
+        default:
+            return xy;
+    }
+}
+
+}  // namespace camera
+}  // namespace cupoch
@@ -31,6 +31,21 @@ PinholeCameraIntrinsic::PinholeCameraIntrinsic(
 
 PinholeCameraIntrinsic::~PinholeCameraIntrinsic() {}
 
+Eigen::Vector2f PinholeCameraIntrinsic::DistortPixel(
+        const Eigen::Vector2f &uv) const {
+    const float fx = intrinsic_matrix_(0, 0);
+    const float fy = intrinsic_matrix_(1, 1);
+    const float cx = intrinsic_matrix_(0, 2);
+    const float cy = intrinsic_matrix_(1, 2);
+    const float skew = intrinsic_matrix_(0, 1);
+    const float y = (uv[1] - cy) / fy;
+    const float x = (uv[0] - cx - skew * y) / fx;
+    const Eigen::Vector2f xy_d = DistortNormalizedPoint(
+            distortion_model_, distortion_coeffs_, Eigen::Vector2f(x, y));
+    return Eigen::Vector2f(fx * xy_d[0] + skew * xy_d[1] + cx,
+                           fy * xy_d[1] + cy);
+}
+
 bool PinholeCameraIntrinsic::ConvertToJsonValue(Json::Value &value) const {
     value["width"] = width_;
     value["height"] = height_;
@@ -38,6 +53,12 @@ bool PinholeCameraIntrinsic::ConvertToJsonValue(Json::Value &value) const {
                                  value["intrinsic_matrix"]) == false) {
         return false;
     }
+    if (distortion_model_ != DistortionModel::None) {
+        value["distortion_model"] = int(distortion_model_);
+        for (int i = 0; i < distortion_coeffs_.size(); ++i) {
+            value["distortion_coeffs"].append(distortion_coeffs_[i]);
+        }
+    }
     return true;
 }
 
@@ -56,6 +77,21 @@ bool PinholeCameraIntrinsic::ConvertFromJsonValue(const Json::Value &value) {
                 "PinholeCameraParameters read JSON failed: wrong format.");
         return false;
     }
+    distortion_model_ =
+            DistortionModel(value.get("distortion_model", 0).asInt());
+    distortion_coeffs_.setZero();
+    const Json::Value &coeffs = value["distortion_coeffs"];
+    if (coeffs.isArray()) {
+        if (coeffs.size() > (Json::ArrayIndex)distortion_coeffs_.size()) {
+            utility::LogWarning(
+                    "PinholeCameraParameters read JSON failed: too many "
+                    "distortion coefficients.");
+            return false;
+        }
+        for (Json::ArrayIndex i = 0; i < coeffs.size(); ++i) {
+            distortion_coeffs_[i] = coeffs[i].asFloat();
+        }
+    }
     return true;
 }
 }  // namespace camera
@@ -4,6 +4,7 @@
 
 #include <Eigen/Core>
 
+#include "cupoch/camera/distortion.h"
 #include "cupoch/utility/ijson_convertible.h"
 
 namespace cupoch {
@@ -84,6 +85,23 @@ public:
     /// Returns `true` iff both the width and height are greater than 0.
     bool IsValid() const { return (width_ > 0 && height_ > 0); }
 
+    /// Sets the lens distortion, the unused coefficients being zero.
+    void SetDistortion(DistortionModel model,
+                       const DistortionCoefficients &coeffs) {
+        distortion_model_ = model;
+        distortion_coeffs_ = coeffs;
+    }
+
+    /// Returns `true` if the images of the camera must be undistorted.
+    bool HasDistortion() const {
+        return distortion_model_ != DistortionModel::None &&
+               !distortion_coeffs_.isZero();
+    }
+
+    /// Pixel of the distorted image showing the same point as the pixel
+    /// \p uv of the ideal pinhole camera of the same matrix.
+    Eigen::Vector2f DistortPixel(const Eigen::Vector2f &uv) const;
+
     bool ConvertToJsonValue(Json::Value &value) const override;
     bool ConvertFromJsonValue(const Json::Value &value) override;
 
@@ -98,6 +116,9 @@ public:
     ///`` [0, fy, cy],``\n
     ///`` [0, 0, 1]]``
     Eigen::Matrix3f intrinsic_matrix_;
+    /// Lens distortion, none by default.
+    DistortionModel distortion_model_ = DistortionModel::None;
+    DistortionCoefficients distortion_coeffs_ = DistortionCoefficients::Zero();
 };
 }  // namespace camera
 }  // namespace cupoch
\ No newline at end of file
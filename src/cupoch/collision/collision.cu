@@ -1,85 +1,400 @@
 #include "cupoch/collision/collision.h"
+#include "cupoch/geometry/aabb_tree.h"
 #include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/geometry/lineset.h"
 #include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/intersection_test.h"
+#include "cupoch/geometry/distance_test.h"
+#include "cupoch/utility/device_hash_map.inl"
 
 #include <thrust/iterator/discard_iterator.h>
+#include <thrust/sequence.h>
 
 namespace cupoch {
 namespace collision {
 
 namespace {
 
-struct intersect_voxel_voxel_functor {
-    intersect_voxel_voxel_functor(const Eigen::Vector3i* voxels_keys1,
-                                  const Eigen::Vector3i* voxels_keys2,
-                                  float voxel_size1, float voxel_size2,
-                                  const Eigen::Vector3f& origin1,
-                                  const Eigen::Vector3f& origin2,
-                                  int n_v2, float margin)
-                                  : voxels_keys1_(voxels_keys1), voxels_keys2_(voxels_keys2),
-                                  voxel_size1_(voxel_size1), voxel_size2_(voxel_size2),
-                                  box_half_size1_(Eigen::Vector3f(
-                                    voxel_size1 / 2, voxel_size1 / 2, voxel_size1 / 2)),
-                                  box_half_size2_(Eigen::Vector3f(
-                                        voxel_size2 / 2, voxel_size2 / 2, voxel_size2 / 2)),
-                                  origin1_(origin1), origin2_(origin2),
-                                  n_v2_(n_v2), margin_(margin) {};
-    const Eigen::Vector3i* voxels_keys1_;
-    const Eigen::Vector3i* voxels_keys2_;
-    const float voxel_size1_;
-    const float voxel_size2_;
-    const Eigen::Vector3f box_half_size1_;
-    const Eigen::Vector3f box_half_size2_;
-    const Eigen::Vector3f origin1_;
-    const Eigen::Vector3f origin2_;
-    const int n_v2_;
+/// Broad phase of the voxel pairs: the voxels of the probing grid look up
+/// the grid keys of the indexed one covered by their box, expanded by the
+/// margin and by one voxel for the boxes that only touch, in the sorted keys
+/// of the indexed grid, and test the voxels found exactly. Counts the pairs
+/// of each probing voxel when pairs_ is NULL, writes them from offsets_
+/// otherwise.
+struct probe_voxel_keys_functor {
+    probe_voxel_keys_functor(const Eigen::Vector3i* probe_keys,
+                             float probe_voxel_size,
+                             const Eigen::Vector3f& probe_origin,
+                             const utility::device_hash_map<unsigned long long, int>& index_table,
+                             float voxel_size, const Eigen::Vector3f& origin,
+                             float margin, const int* offsets,
+                             Eigen::Vector2i* pairs)
+                             : probe_keys_(probe_keys), probe_voxel_size_(probe_voxel_size),
+                             probe_origin_(probe_origin), index_table_(index_table.view()),
+                             voxel_size_(voxel_size), origin_(origin), margin_(margin),
+                             offsets_(offsets), pairs_(pairs) {};
+    const Eigen::Vector3i* probe_keys_;
+    const float probe_voxel_size_;
+    const Eigen::Vector3f probe_origin_;
+    const utility::device_hash_map<unsigned long long, int>::view_type index_table_;
+    const float voxel_size_;
+    const Eigen::Vector3f origin_;
     const float margin_;
-    __device__ Eigen::Vector2i operator() (size_t idx) const {
-        int i1 = idx / n_v2_;
-        int i2 = idx % n_v2_;
-        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5);
+    const int* offsets_;
+    Eigen::Vector2i* pairs_;
+    __device__ int operator() (size_t idx) const {
         const Eigen::Vector3f ms = Eigen::Vector3f::Constant(margin_);
-        Eigen::Vector3f center1 = ((voxels_keys1_[i1].cast<float>() + h3) * voxel_size1_) + origin1_;
-        Eigen::Vector3f center2 = ((voxels_keys2_[i2].cast<float>() + h3) * voxel_size2_) + origin2_;
-        int coll = geometry::intersection_test::AABBAABB(center1 - box_half_size1_ - ms, center1 + box_half_size1_ + ms,
-                                                         center2 - box_half_size2_, center2 + box_half_size2_);
-        return (coll == 1) ? Eigen::Vector2i(i1, i2) : Eigen::Vector2i(-1, -1);
+        const Eigen::Vector3f min_bound = probe_keys_[idx].cast<float>() * probe_voxel_size_ + probe_origin_ - ms;
+        const Eigen::Vector3f max_bound = min_bound + Eigen::Vector3f::Constant(probe_voxel_size_) + 2.0 * ms;
+        Eigen::Vector3i kmin, kmax;
+        for (int i = 0; i < 3; ++i) {
+            kmin[i] = (int)floorf((min_bound[i] - origin_[i]) / voxel_size_) - 1;
+            kmax[i] = (int)floorf((max_bound[i] - origin_[i]) / voxel_size_) + 1;
+        }
+        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5 * voxel_size_);
+        int n = 0;
+        for (int x = kmin[0]; x <= kmax[0]; ++x) {
+            for (int y = kmin[1]; y <= kmax[1]; ++y) {
+                for (int z = kmin[2]; z <= kmax[2]; ++z) {
+                    const Eigen::Vector3i key(x, y, z);
+                    const int* j = index_table_.find(PackCellKey(key));
+                    if (!j) continue;
+                    const Eigen::Vector3f center = (key.cast<float>() + Eigen::Vector3f::Constant(0.5)) * voxel_size_ + origin_;
+                    if (!geometry::intersection_test::AABBAABB(min_bound, max_bound,
+                                                               center - h3, center + h3)) continue;
+                    if (pairs_) pairs_[offsets_[idx] + n] = Eigen::Vector2i(idx, *j);
+                    ++n;
+                }
+            }
+        }
+        return n;
     }
 };
 
-struct intersect_voxel_line_functor {
-    intersect_voxel_line_functor(const Eigen::Vector3i* voxels_keys,
-                                 const Eigen::Vector3f* points,
-                                 const Eigen::Vector2i* lines,
-                                 float voxel_size,
-                                 const Eigen::Vector3f& origin,
-                                 int n_v2, float margin)
-                                  : voxels_keys_(voxels_keys),
-                                  points_(points), lines_(lines),
-                                  voxel_size_(voxel_size),
-                                  box_half_size_(Eigen::Vector3f(
-                                    voxel_size / 2, voxel_size / 2, voxel_size / 2)),
-                                  origin_(origin), n_v2_(n_v2), margin_(margin) {};
+// Pairs (i, j) of the voxels i and the triangles j of the tree that
+// intersect once the voxels are grown by the margin. Counts the pairs when
+// pairs_ is NULL.
+struct intersect_voxel_triangle_functor {
+    intersect_voxel_triangle_functor(const geometry::AABBTreeView& tree,
+                                     const Eigen::Vector3i* voxels_keys,
+                                     const Eigen::Vector3i* triangles,
+                                     const Eigen::Vector3f* vertices,
+                                     float voxel_size, const Eigen::Vector3f& origin,
+                                     float margin, const int* offsets,
+                                     Eigen::Vector2i* pairs)
+                                     : tree_(tree), voxels_keys_(voxels_keys),
+                                     triangles_(triangles), vertices_(vertices),
+                                     voxel_size_(voxel_size), origin_(origin),
+                                     margin_(margin), offsets_(offsets), pairs_(pairs) {};
+    const geometry::AABBTreeView tree_;
     const Eigen::Vector3i* voxels_keys_;
-    const Eigen::Vector3f* points_;
-    const Eigen::Vector2i* lines_;
+    const Eigen::Vector3i* triangles_;
+    const Eigen::Vector3f* vertices_;
     const float voxel_size_;
-    const Eigen::Vector3f box_half_size_;
     const Eigen::Vector3f origin_;
-    const int n_v2_;
     const float margin_;
+    const int* offsets_;
+    Eigen::Vector2i* pairs_;
+
+    struct node_test {
+        __device__ node_test(const Eigen::Vector3f& min_bound, const Eigen::Vector3f& max_bound)
+        : min_bound_(min_bound), max_bound_(max_bound) {};
+        const Eigen::Vector3f min_bound_;
+        const Eigen::Vector3f max_bound_;
+        __device__ bool operator() (const Eigen::Vector3f& min_bound, const Eigen::Vector3f& max_bound) const {
+            return geometry::intersection_test::AABBAABB(min_bound_, max_bound_, min_bound, max_bound);
+        }
+    };
+
+    struct leaf_func {
+        __device__ leaf_func(const intersect_voxel_triangle_functor& parent, int voxel,
+                             const Eigen::Vector3f& center, const Eigen::Vector3f& half_size)
+        : parent_(parent), voxel_(voxel), center_(center), half_size_(half_size) {};
+        const intersect_voxel_triangle_functor& parent_;
+        const int voxel_;
+        const Eigen::Vector3f center_;
+        const Eigen::Vector3f half_size_;
+        int n_ = 0;
+        __device__ bool operator() (int tidx, const Eigen::Vector3f&, const Eigen::Vector3f&) {
+            const Eigen::Vector3i& tri = parent_.triangles_[tidx];
+            const Eigen::Vector3f* v = parent_.vertices_;
+            if (geometry::intersection_test::TriangleAABB(center_, half_size_,
+                                                          v[tri[0]], v[tri[1]], v[tri[2]])) {
+                if (parent_.pairs_) parent_.pairs_[parent_.offsets_[voxel_] + n_] = Eigen::Vector2i(voxel_, tidx);
+                ++n_;
+            }
+            return true;
+        }
+    };
+
+    __device__ int operator() (size_t idx) const {
+        const Eigen::Vector3f half_size = Eigen::Vector3f::Constant(0.5 * voxel_size_ + margin_);
+        const Eigen::Vector3f center = (voxels_keys_[idx].cast<float>() + Eigen::Vector3f::Constant(0.5)) * voxel_size_ + origin_;
+        node_test test(center - half_size, center + half_size);
+        leaf_func leaf(*this, idx, center, half_size);
+        tree_.Traverse(test, leaf);
+        return leaf.n_;
+    }
+};
+
+// Pairs (i, j) of the primitives i and the point j within the margin of
+// them. Counts the pairs of each point when pairs_ is NULL.
+struct intersect_primitive_point_functor {
+    intersect_primitive_point_functor(const PrimitiveShape* primitives, int n_primitives,
+                                      const Eigen::Vector3f* points, float margin,
+                                      const int* offsets, Eigen::Vector2i* pairs)
+                                      : primitives_(primitives), n_primitives_(n_primitives),
+                                      points_(points), margin_(margin), offsets_(offsets),
+                                      pairs_(pairs) {};
+    const PrimitiveShape* primitives_;
+    const int n_primitives_;
+    const Eigen::Vector3f* points_;
+    const float margin_;
+    const int* offsets_;
+    Eigen::Vector2i* pairs_;
+    __device__ int operator() (size_t idx) const {
+        const Eigen::Vector3f& p = points_[idx];
+        int n = 0;
+        for (int i = 0; i < n_primitives_; ++i) {
+            if (primitives_[i].SignedDistance(p) > margin_) continue;
+            if (pairs_) pairs_[offsets_[idx] + n] = Eigen::Vector2i(i, idx);
+            ++n;
+        }
+        return n;
+    }
+};
+
+// Visits the cells of the bounds of every primitive, the cell idx - offsets_[i]
+// of the box of primitive i being enumerated in the order of IndexOf(), so
+// that the pairs come out sorted. (-1, -1) for the cells not hit.
+struct intersect_primitive_occupancy_functor {
+    intersect_primitive_occupancy_functor(const PrimitiveShape* primitives, int n_primitives,
+                                          const size_t* offsets,
+                                          const Eigen::Vector3i* min_indices,
+                                          const Eigen::Vector3i* sizes,
+                                          const geometry::DenseGridView<geometry::CompactOccupancyVoxel>& view,
+                                          int16_t thres, float margin)
+                                          : primitives_(primitives), n_primitives_(n_primitives),
+                                          offsets_(offsets), min_indices_(min_indices), sizes_(sizes),
+                                          view_(view), thres_(thres),
+                                          max_distance_(margin + 0.5 * sqrtf(3.0) * view.voxel_size_) {};
+    const PrimitiveShape* primitives_;
+    const int n_primitives_;
+    const size_t* offsets_;
+    const Eigen::Vector3i* min_indices_;
+    const Eigen::Vector3i* sizes_;
+    const geometry::DenseGridView<geometry::CompactOccupancyVoxel> view_;
+    const int16_t thres_;
+    const float max_distance_;
     __device__ Eigen::Vector2i operator() (size_t idx) const {
-        int i1 = idx / n_v2_;
-        int i2 = idx % n_v2_;
-        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5);
-        const Eigen::Vector3f ms = Eigen::Vector3f::Constant(margin_);
-        Eigen::Vector3f center = ((voxels_keys_[i1].cast<float>() + h3) * voxel_size_) + origin_;
-        Eigen::Vector2i lidx = lines_[idx];
-        int coll = geometry::intersection_test::LineSegmentAABB(points_[lidx[0]], points_[lidx[1]],
-                                                                center - box_half_size_, center + box_half_size_);
-        return (coll == 1) ? Eigen::Vector2i(i1, i2) : Eigen::Vector2i(-1, -1);
+        // Last primitive whose offset is not after idx.
+        int lo = 0;
+        int hi = n_primitives_;
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) / 2;
+            if (offsets_[mid] <= idx) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const Eigen::Vector3i& size = sizes_[lo];
+        const int local = idx - offsets_[lo];
+        const Eigen::Vector3i grid_index = min_indices_[lo] +
+                Eigen::Vector3i(local / (size[1] * size[2]), (local / size[2]) % size[1], local % size[2]);
+        const int sidx = view_.GetStorageIndex(grid_index);
+        if (sidx < 0) return Eigen::Vector2i(-1, -1);
+        const geometry::CompactOccupancyVoxel& v = view_.voxels_[sidx];
+        if (v.IsUnknown() || v.prob_log_q_ <= thres_) return Eigen::Vector2i(-1, -1);
+        const Eigen::Vector3f center = (grid_index.cast<float>() -
+                                        Eigen::Vector3f::Constant(view_.resolution_ / 2 - 0.5)) * view_.voxel_size_ + view_.origin_;
+        if (primitives_[lo].SignedDistance(center) > max_distance_) return Eigen::Vector2i(-1, -1);
+        return Eigen::Vector2i(lo, IndexOf(grid_index, view_.resolution_));
+    }
+};
+
+// Nearest obstacle voxel of the center of the bounding sphere of the
+// primitive, (-1, -1) when the sphere and the voxel do not intersect.
+struct intersect_primitive_distance_functor {
+    intersect_primitive_distance_functor(const geometry::DenseGridView<geometry::DistanceVoxel>& view,
+                                         float margin)
+                                         : view_(view), margin_(margin) {};
+    const geometry::DenseGridView<geometry::DistanceVoxel> view_;
+    const float margin_;
+    __device__ Eigen::Vector2i operator() (const thrust::tuple<size_t, PrimitiveShape>& x) const {
+        const int i = thrust::get<0>(x);
+        Eigen::Vector3f center;
+        float radius;
+        thrust::get<1>(x).GetBoundingSphere(center, radius);
+        const geometry::DistanceVoxel* v = view_.GetVoxel(center);
+        if (v == NULL || v->IsNotSite()) return Eigen::Vector2i(-1, -1);
+        const Eigen::Vector3i site = v->nearest_index_.cast<int>();
+        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5 * view_.voxel_size_);
+        const Eigen::Vector3f site_center = (site.cast<float>() -
+                                             Eigen::Vector3f::Constant(view_.resolution_ / 2 - 0.5)) * view_.voxel_size_ + view_.origin_;
+        const float d = ((center - site_center).cwiseAbs() - h3).cwiseMax(0.0).norm();
+        if (d > radius + margin_) return Eigen::Vector2i(-1, -1);
+        return Eigen::Vector2i(i, IndexOf(site, view_.resolution_));
+    }
+};
+
+// Objects of the distance queries, giving the point of object j closest to
+// a point. kNumIterations alternating projections are done against the
+// primitives.
+struct point_projector {
+    static constexpr int kNumIterations = 1;
+    point_projector(const Eigen::Vector3f* points) : points_(points) {};
+    const Eigen::Vector3f* points_;
+    __device__ Eigen::Vector3f operator() (int j, const Eigen::Vector3f&) const {
+        return points_[j];
+    }
+};
+
+struct box_projector {
+    static constexpr int kNumIterations = 8;
+    box_projector(const Eigen::Vector3f* min_bounds, const Eigen::Vector3f* max_bounds)
+    : min_bounds_(min_bounds), max_bounds_(max_bounds) {};
+    const Eigen::Vector3f* min_bounds_;
+    const Eigen::Vector3f* max_bounds_;
+    __device__ Eigen::Vector3f operator() (int j, const Eigen::Vector3f& p) const {
+        return p.cwiseMax(min_bounds_[j]).cwiseMin(max_bounds_[j]);
+    }
+};
+
+struct triangle_projector {
+    static constexpr int kNumIterations = 8;
+    triangle_projector(const Eigen::Vector3i* triangles, const Eigen::Vector3f* vertices)
+    : triangles_(triangles), vertices_(vertices) {};
+    const Eigen::Vector3i* triangles_;
+    const Eigen::Vector3f* vertices_;
+    __device__ Eigen::Vector3f operator() (int j, const Eigen::Vector3f& p) const {
+        const Eigen::Vector3i& tri = triangles_[j];
+        return geometry::distance_test::ClosestPointTriangle(p, vertices_[tri[0]],
+                                                             vertices_[tri[1]], vertices_[tri[2]]);
+    }
+};
+
+/// Witness points \p a on \p shape and \p b on object j by alternating
+/// projections from the point of the object closest to \p center, and
+/// their distance, the signed distance of b in penetration.
+template <class Projector>
+__device__ float ClosestPoints(const PrimitiveShape& shape, const Eigen::Vector3f& center,
+                               const Projector& proj, int j,
+                               Eigen::Vector3f& a, Eigen::Vector3f& b) {
+    b = proj(j, center);
+    a = shape.ClosestPoint(b);
+    for (int k = 1; k < Projector::kNumIterations; ++k) {
+        b = proj(j, a);
+        a = shape.ClosestPoint(b);
+    }
+    const float d = (a - b).norm();
+    return (d > 0.0f) ? d : shape.SignedDistance(b);
+}
+
+// Closest object of every primitive in the tree, the subtrees farther than
+// the best distance from the bounding sphere being pruned. (-1, -1) for the
+// primitives without object within the maximum distance.
+template <class Projector>
+struct closest_object_functor {
+    closest_object_functor(const geometry::AABBTreeView& tree,
+                           const PrimitiveShape* primitives,
+                           const Projector& projector, float max_distance,
+                           Eigen::Vector2i* pairs, float* distances,
+                           Eigen::Vector3f* first_points, Eigen::Vector3f* second_points)
+                           : tree_(tree), primitives_(primitives), projector_(projector),
+                           max_distance_(max_distance), pairs_(pairs), distances_(distances),
+                           first_points_(first_points), second_points_(second_points) {};
+    const geometry::AABBTreeView tree_;
+    const PrimitiveShape* primitives_;
+    const Projector projector_;
+    const float max_distance_;
+    Eigen::Vector2i* pairs_;
+    float* distances_;
+    Eigen::Vector3f* first_points_;
+    Eigen::Vector3f* second_points_;
+
+    struct node_test {
+        __device__ node_test(const Eigen::Vector3f& center, float radius, const float* best)
+        : center_(center), radius_(radius), best_(best) {};
+        const Eigen::Vector3f center_;
+        const float radius_;
+        const float* best_;
+        __device__ bool operator() (const Eigen::Vector3f& min_bound, const Eigen::Vector3f& max_bound) const {
+            return sqrtf(geometry::distance_test::PointAABBSquared(center_, min_bound, max_bound)) - radius_ <= *best_;
+        }
+    };
+
+    struct leaf_func {
+        __device__ leaf_func(const PrimitiveShape& shape, const Eigen::Vector3f& center,
+                             const Projector& projector, float max_distance)
+        : shape_(shape), center_(center), projector_(projector), best_(max_distance) {};
+        const PrimitiveShape& shape_;
+        const Eigen::Vector3f center_;
+        const Projector& projector_;
+        float best_;
+        int best_index_ = -1;
+        Eigen::Vector3f a_ = Eigen::Vector3f::Zero();
+        Eigen::Vector3f b_ = Eigen::Vector3f::Zero();
+        __device__ bool operator() (int j, const Eigen::Vector3f&, const Eigen::Vector3f&) {
+            Eigen::Vector3f a, b;
+            const float d = ClosestPoints(shape_, center_, projector_, j, a, b);
+            if (d <= best_) {
+                best_ = d;
+                best_index_ = j;
+                a_ = a;
+                b_ = b;
+            }
+            return true;
+        }
+    };
+
+    __device__ void operator() (size_t idx) const {
+        const PrimitiveShape shape = primitives_[idx];
+        Eigen::Vector3f center;
+        float radius;
+        shape.GetBoundingSphere(center, radius);
+        leaf_func leaf(shape, center, projector_, max_distance_);
+        node_test test(center, radius, &leaf.best_);
+        tree_.Traverse(test, leaf);
+        pairs_[idx] = (leaf.best_index_ < 0) ? Eigen::Vector2i(-1, -1) : Eigen::Vector2i(idx, leaf.best_index_);
+        distances_[idx] = leaf.best_;
+        first_points_[idx] = leaf.a_;
+        second_points_[idx] = leaf.b_;
+    }
+};
+
+// Distance of every primitive to the nearest obstacle voxel of the center of
+// its bounding sphere.
+struct distance_transform_distance_functor {
+    distance_transform_distance_functor(const geometry::DenseGridView<geometry::DistanceVoxel>& view,
+                                        float max_distance)
+                                        : view_(view), max_distance_(max_distance) {};
+    const geometry::DenseGridView<geometry::DistanceVoxel> view_;
+    const float max_distance_;
+    __device__ thrust::tuple<Eigen::Vector2i, float, Eigen::Vector3f, Eigen::Vector3f>
+    operator() (const thrust::tuple<size_t, PrimitiveShape>& x) const {
+        const int i = thrust::get<0>(x);
+        const PrimitiveShape& shape = thrust::get<1>(x);
+        Eigen::Vector3f center;
+        float radius;
+        shape.GetBoundingSphere(center, radius);
+        const geometry::DistanceVoxel* v = view_.GetVoxel(center);
+        const auto invalid = thrust::make_tuple(Eigen::Vector2i(-1, -1), max_distance_,
+                                                Eigen::Vector3f::Zero().eval(), Eigen::Vector3f::Zero().eval());
+        if (v == NULL || v->IsNotSite()) return invalid;
+        const Eigen::Vector3i site = v->nearest_index_.cast<int>();
+        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5 * view_.voxel_size_);
+        const Eigen::Vector3f site_center = (site.cast<float>() -
+                                             Eigen::Vector3f::Constant(view_.resolution_ / 2 - 0.5)) * view_.voxel_size_ + view_.origin_;
+        const Eigen::Vector3f min_bound = site_center - h3;
+        const Eigen::Vector3f max_bound = site_center + h3;
+        Eigen::Vector3f a, b;
+        const float d = ClosestPoints(shape, center, box_projector(&min_bound, &max_bound), 0, a, b);
+        if (d > max_distance_) return invalid;
+        return thrust::make_tuple(Eigen::Vector2i(i, IndexOf(site, view_.resolution_)), d, a, b);
     }
 };
 
@@ -93,6 +408,89 @@ struct convert_index_functor {
     }
 };
 
+/// Intersecting pairs of the voxels of keys1 and keys2, ordered by the
+/// first index then the second. The grid with the larger voxels is indexed,
+/// so that a probing voxel covers at most 27 of its keys before the margin,
+/// and the pairs are counted before being written, so the time is
+/// O(n1 + n2) and the memory is in the number of pairs. The keys of a grid
+/// are unique, and those outside the range of PackCellKey are not indexed.
+utility::device_vector<Eigen::Vector2i> IntersectVoxelKeys(
+        const utility::device_vector<Eigen::Vector3i>& keys1, float voxel_size1,
+        const Eigen::Vector3f& origin1,
+        const utility::device_vector<Eigen::Vector3i>& keys2, float voxel_size2,
+        const Eigen::Vector3f& origin2, float margin) {
+    // The test is symmetric, the margin expanding the probing boxes.
+    const bool swapped = voxel_size1 > voxel_size2;
+    const auto& probe_keys = (swapped) ? keys2 : keys1;
+    const auto& index_keys = (swapped) ? keys1 : keys2;
+    utility::device_vector<Eigen::Vector2i> pairs;
+    if (probe_keys.empty() || index_keys.empty()) return pairs;
+    utility::device_vector<unsigned long long> packed_keys(index_keys.size());
+    thrust::transform(index_keys.begin(), index_keys.end(), packed_keys.begin(),
+                      [] __device__ (const Eigen::Vector3i& key) { return PackCellKey(key); });
+    utility::device_vector<int> indices(index_keys.size());
+    thrust::sequence(indices.begin(), indices.end());
+    utility::device_hash_map<unsigned long long, int> index_table(index_keys.size());
+    index_table.insert(packed_keys, indices);
+    utility::device_vector<int> offsets(probe_keys.size() + 1, 0);
+    probe_voxel_keys_functor count_func(thrust::raw_pointer_cast(probe_keys.data()),
+                                        (swapped) ? voxel_size2 : voxel_size1,
+                                        (swapped) ? origin2 : origin1,
+                                        index_table,
+                                        (swapped) ? voxel_size1 : voxel_size2,
+                                        (swapped) ? origin1 : origin2,
+                                        margin, NULL, NULL);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(probe_keys.size()),
+                      offsets.begin(), count_func);
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    pairs.resize(offsets.back());
+    probe_voxel_keys_functor write_func = count_func;
+    write_func.offsets_ = thrust::raw_pointer_cast(offsets.data());
+    write_func.pairs_ = thrust::raw_pointer_cast(pairs.data());
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(probe_keys.size()), write_func);
+    if (swapped) swap_index(pairs);
+    thrust::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+struct is_invalid_distance_functor {
+    __device__ bool operator() (const thrust::tuple<Eigen::Vector2i, float, Eigen::Vector3f, Eigen::Vector3f>& x) const {
+        return thrust::get<0>(x)[0] < 0;
+    }
+};
+
+void RemoveInvalidDistances(DistanceResult& result) {
+    remove_if_vectors(is_invalid_distance_functor(), result.index_pairs_, result.distances_,
+                      result.first_points_, result.second_points_);
+}
+
+/// Closest objects of the primitives in \p tree, keeping the primitives
+/// with an object within \p max_distance.
+template <class Projector>
+std::shared_ptr<DistanceResult> ComputeClosestObjects(
+        const utility::device_vector<PrimitiveShape>& primitives,
+        const geometry::AABBTree& tree, const Projector& projector,
+        float max_distance, geometry::Geometry::GeometryType second) {
+    auto out = std::make_shared<DistanceResult>();
+    out->first_ = geometry::Geometry::GeometryType::Unspecified;
+    out->second_ = second;
+    const size_t n = primitives.size();
+    if (n == 0 || tree.IsEmpty()) return out;
+    resize_all(n, out->index_pairs_, out->distances_, out->first_points_, out->second_points_);
+    closest_object_functor<Projector> func(tree.GetView(), thrust::raw_pointer_cast(primitives.data()),
+                                           projector, max_distance,
+                                           thrust::raw_pointer_cast(out->index_pairs_.data()),
+                                           thrust::raw_pointer_cast(out->distances_.data()),
+                                           thrust::raw_pointer_cast(out->first_points_.data()),
+                                           thrust::raw_pointer_cast(out->second_points_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n), func);
+    RemoveInvalidDistances(*out);
+    return out;
+}
+
 }  // namespace
 
 CollisionResult::CollisionResult()
@@ -119,20 +517,11 @@ std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::VoxelGrid&
                                                      const geometry::VoxelGrid& voxelgrid2,
                                                      float margin) {
     auto out = std::make_shared<CollisionResult>();
-    size_t n_v1 = voxelgrid1.voxels_keys_.size();
-    size_t n_v2 = voxelgrid2.voxels_keys_.size();
-    size_t n_total = n_v1 * n_v2;
-    intersect_voxel_voxel_functor func(thrust::raw_pointer_cast(voxelgrid1.voxels_keys_.data()),
-                                       thrust::raw_pointer_cast(voxelgrid2.voxels_keys_.data()),
-                                       voxelgrid1.voxel_size_, voxelgrid2.voxel_size_,
-                                       voxelgrid1.origin_, voxelgrid2.origin_, n_v2, margin);
     out->first_ = geometry::Geometry::GeometryType::VoxelGrid;
     out->second_ = geometry::Geometry::GeometryType::VoxelGrid;
-    out->collision_index_pairs_.resize(n_total);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_total),
-                      out->collision_index_pairs_.begin(), func);
-    remove_negative(out->collision_index_pairs_);
+    out->collision_index_pairs_ = IntersectVoxelKeys(voxelgrid1.voxels_keys_, voxelgrid1.voxel_size_,
+                                                     voxelgrid1.origin_, voxelgrid2.voxels_keys_,
+                                                     voxelgrid2.voxel_size_, voxelgrid2.origin_, margin);
     return out;
 }
 
@@ -140,27 +529,26 @@ std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::VoxelGrid&
                                                      const geometry::LineSet& lineset,
                                                      float margin) {
     auto out = std::make_shared<CollisionResult>();
-    size_t n_v1 = voxelgrid.voxels_keys_.size();
-    size_t n_v2 = lineset.lines_.size();
-    size_t n_total = n_v1 * n_v2;
-    intersect_voxel_line_functor func(thrust::raw_pointer_cast(voxelgrid.voxels_keys_.data()),
-                                      thrust::raw_pointer_cast(lineset.points_.data()),
-                                      thrust::raw_pointer_cast(lineset.lines_.data()),
-                                      voxelgrid.voxel_size_, voxelgrid.origin_, n_v2, margin);
     out->first_ = geometry::Geometry::GeometryType::VoxelGrid;
     out->second_ = geometry::Geometry::GeometryType::LineSet;
-    out->collision_index_pairs_.resize(n_total);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_total),
-                      out->collision_index_pairs_.begin(), func);
-    remove_negative(out->collision_index_pairs_);
+    if (voxelgrid.voxels_keys_.empty() || lineset.lines_.empty()) return out;
+    // The segments traverse a BVH over the voxels instead of testing all
+    // the voxel and line pairs.
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
+    geometry::AABBTree::AppendBoxes(voxelgrid, min_bounds, max_bounds);
+    geometry::AABBTree tree;
+    tree.Build(min_bounds, max_bounds);
+    out->collision_index_pairs_ = tree.IntersectLineSegmentPairs(lineset.points_, lineset.lines_, margin);
+    swap_index(out->collision_index_pairs_);
+    thrust::sort(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end());
     return out;
 }
 
 std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::LineSet& lineset,
                                                      const geometry::VoxelGrid& voxelgrid,
                                                      float margin) {
-    auto out = ComputeIntersection(voxelgrid, lineset);
+    auto out = ComputeIntersection(voxelgrid, lineset, margin);
     out->first_ = geometry::Geometry::GeometryType::LineSet;
     out->second_ = geometry::Geometry::GeometryType::VoxelGrid;
     swap_index(out->collision_index_pairs_);
@@ -171,26 +559,18 @@ std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::VoxelGrid&
                                                      const geometry::OccupancyGrid& occgrid,
                                                      float margin) {
     auto out = std::make_shared<CollisionResult>();
-    size_t n_v1 = voxelgrid.voxels_keys_.size();
     auto occupied_voxels = occgrid.ExtractOccupiedVoxels();
     utility::device_vector<Eigen::Vector3i> occupied_voxels_keys(occupied_voxels->size());
     thrust::transform(occupied_voxels->begin(), occupied_voxels->end(), occupied_voxels_keys.begin(),
                       [] __device__ (const geometry::OccupancyVoxel& voxel) {
                           return voxel.grid_index_.cast<int>();
                       });
-    size_t n_v2 = occupied_voxels->size();
-    size_t n_total = n_v1 * n_v2;
     const Eigen::Vector3f occ_origin = occgrid.origin_ - 0.5 * occgrid.voxel_size_ * Eigen::Vector3f::Constant(occgrid.resolution_);
-    intersect_voxel_voxel_functor func(thrust::raw_pointer_cast(voxelgrid.voxels_keys_.data()),
-                                       thrust::raw_pointer_cast(occupied_voxels_keys.data()),
-                                       voxelgrid.voxel_size_, occgrid.voxel_size_,
-                                       voxelgrid.origin_, occ_origin, n_v2, margin);
     out->first_ = geometry::Geometry::GeometryType::VoxelGrid;
     out->second_ = geometry::Geometry::GeometryType::OccupancyGrid;
-    out->collision_index_pairs_.resize(n_total);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_total),
-                      out->collision_index_pairs_.begin(), func);
+    out->collision_index_pairs_ = IntersectVoxelKeys(voxelgrid.voxels_keys_, voxelgrid.voxel_size_,
+                                                     voxelgrid.origin_, occupied_voxels_keys,
+                                                     occgrid.voxel_size_, occ_origin, margin);
     convert_index_functor func_c(thrust::raw_pointer_cast(occupied_voxels_keys.data()), occgrid.resolution_);
     thrust::transform(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end(),
                       out->collision_index_pairs_.begin(), func_c);
@@ -207,5 +587,273 @@ std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::OccupancyGr
     return out;
 }
 
+std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::VoxelGrid& voxelgrid,
+                                                     const geometry::TriangleMesh& mesh,
+                                                     float margin) {
+    auto out = std::make_shared<CollisionResult>();
+    out->first_ = geometry::Geometry::GeometryType::VoxelGrid;
+    out->second_ = geometry::Geometry::GeometryType::TriangleMesh;
+    const size_t n_voxels = voxelgrid.voxels_keys_.size();
+    if (n_voxels == 0 || mesh.triangles_.empty()) return out;
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
+    geometry::AABBTree::AppendBoxes(mesh, min_bounds, max_bounds);
+    geometry::AABBTree tree;
+    tree.Build(min_bounds, max_bounds);
+    utility::device_vector<int> offsets(n_voxels + 1, 0);
+    intersect_voxel_triangle_functor count_func(tree.GetView(),
+                                                thrust::raw_pointer_cast(voxelgrid.voxels_keys_.data()),
+                                                thrust::raw_pointer_cast(mesh.triangles_.data()),
+                                                thrust::raw_pointer_cast(mesh.vertices_.data()),
+                                                voxelgrid.voxel_size_, voxelgrid.origin_, margin,
+                                                NULL, NULL);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_voxels),
+                      offsets.begin(), count_func);
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    out->collision_index_pairs_.resize(offsets.back());
+    intersect_voxel_triangle_functor write_func(tree.GetView(),
+                                                thrust::raw_pointer_cast(voxelgrid.voxels_keys_.data()),
+                                                thrust::raw_pointer_cast(mesh.triangles_.data()),
+                                                thrust::raw_pointer_cast(mesh.vertices_.data()),
+                                                voxelgrid.voxel_size_, voxelgrid.origin_, margin,
+                                                thrust::raw_pointer_cast(offsets.data()),
+                                                thrust::raw_pointer_cast(out->collision_index_pairs_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_voxels), write_func);
+    thrust::sort(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end());
+    return out;
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::TriangleMesh& mesh,
+                                                     const geometry::VoxelGrid& voxelgrid,
+                                                     float margin) {
+    auto out = ComputeIntersection(voxelgrid, mesh, margin);
+    out->first_ = geometry::Geometry::GeometryType::TriangleMesh;
+    out->second_ = geometry::Geometry::GeometryType::VoxelGrid;
+    swap_index(out->collision_index_pairs_);
+    thrust::sort(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end());
+    return out;
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const utility::device_vector<PrimitiveShape>& primitives,
+                                                     const geometry::PointCloud& pointcloud,
+                                                     float margin) {
+    auto out = std::make_shared<CollisionResult>();
+    out->first_ = geometry::Geometry::GeometryType::Unspecified;
+    out->second_ = geometry::Geometry::GeometryType::PointCloud;
+    const size_t n_points = pointcloud.points_.size();
+    if (primitives.empty() || n_points == 0) return out;
+    utility::device_vector<int> offsets(n_points + 1, 0);
+    intersect_primitive_point_functor count_func(thrust::raw_pointer_cast(primitives.data()),
+                                                 primitives.size(),
+                                                 thrust::raw_pointer_cast(pointcloud.points_.data()),
+                                                 margin, NULL, NULL);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_points),
+                      offsets.begin(), count_func);
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    out->collision_index_pairs_.resize(offsets.back());
+    intersect_primitive_point_functor write_func = count_func;
+    write_func.offsets_ = thrust::raw_pointer_cast(offsets.data());
+    write_func.pairs_ = thrust::raw_pointer_cast(out->collision_index_pairs_.data());
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_points), write_func);
+    thrust::sort(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end());
+    return out;
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const Primitive& primitive,
+                                                     const geometry::PointCloud& pointcloud,
+                                                     float margin) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeIntersection(primitives, pointcloud, margin);
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const utility::device_vector<PrimitiveShape>& primitives,
+                                                     const geometry::OccupancyGrid& occgrid,
+                                                     float margin) {
+    auto out = std::make_shared<CollisionResult>();
+    out->first_ = geometry::Geometry::GeometryType::Unspecified;
+    out->second_ = geometry::Geometry::GeometryType::OccupancyGrid;
+    if (primitives.empty() || occgrid.voxels_.empty()) return out;
+    // Grid index ranges of the grown bounds of the primitives, clamped to
+    // the grid.
+    const auto view = occgrid.GetView();
+    thrust::host_vector<PrimitiveShape> h_primitives = primitives;
+    thrust::host_vector<size_t> h_offsets(primitives.size() + 1, 0);
+    thrust::host_vector<Eigen::Vector3i> h_min_indices(primitives.size());
+    thrust::host_vector<Eigen::Vector3i> h_sizes(primitives.size());
+    const Eigen::Vector3f ms = Eigen::Vector3f::Constant(margin);
+    for (size_t i = 0; i < h_primitives.size(); ++i) {
+        const auto bbox = h_primitives[i].GetAxisAlignedBoundingBox();
+        const Eigen::Vector3i kmin = view.GetGridIndex(bbox.min_bound_ - ms).cwiseMax(0);
+        const Eigen::Vector3i kmax = view.GetGridIndex(bbox.max_bound_ + ms).cwiseMin(occgrid.resolution_ - 1);
+        h_min_indices[i] = kmin;
+        h_sizes[i] = (kmax - kmin + Eigen::Vector3i::Ones()).cwiseMax(0);
+        h_offsets[i + 1] = h_offsets[i] + (size_t)h_sizes[i][0] * h_sizes[i][1] * h_sizes[i][2];
+    }
+    const size_t n_cells = h_offsets.back();
+    if (n_cells == 0) return out;
+    utility::device_vector<size_t> offsets = h_offsets;
+    utility::device_vector<Eigen::Vector3i> min_indices = h_min_indices;
+    utility::device_vector<Eigen::Vector3i> sizes = h_sizes;
+    // Same quantized threshold as OccupancyGrid::ExtractOccupiedVoxels().
+    int16_t thres = geometry::CompactOccupancyVoxel::Quantize(occgrid.occ_prob_thres_log_);
+    if (thres * geometry::CompactOccupancyVoxel::kProbLogResolution > occgrid.occ_prob_thres_log_) --thres;
+    intersect_primitive_occupancy_functor func(thrust::raw_pointer_cast(primitives.data()),
+                                               primitives.size(),
+                                               thrust::raw_pointer_cast(offsets.data()),
+                                               thrust::raw_pointer_cast(min_indices.data()),
+                                               thrust::raw_pointer_cast(sizes.data()),
+                                               view, thres, margin);
+    out->collision_index_pairs_.resize(n_cells);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_cells),
+                      out->collision_index_pairs_.begin(), func);
+    auto end = thrust::remove_if(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end(),
+                                 [] __device__ (const Eigen::Vector2i& pair) { return pair[0] < 0; });
+    out->collision_index_pairs_.resize(thrust::distance(out->collision_index_pairs_.begin(), end));
+    return out;
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const Primitive& primitive,
+                                                     const geometry::OccupancyGrid& occgrid,
+                                                     float margin) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeIntersection(primitives, occgrid, margin);
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const utility::device_vector<PrimitiveShape>& primitives,
+                                                     const geometry::DistanceTransform& distance_transform,
+                                                     float margin) {
+    auto out = std::make_shared<CollisionResult>();
+    out->first_ = geometry::Geometry::GeometryType::Unspecified;
+    out->second_ = geometry::Geometry::GeometryType::DistanceTransform;
+    if (primitives.empty() || distance_transform.voxels_.empty()) return out;
+    intersect_primitive_distance_functor func(distance_transform.GetView(), margin);
+    out->collision_index_pairs_.resize(primitives.size());
+    thrust::transform(make_tuple_iterator(thrust::make_counting_iterator<size_t>(0), primitives.begin()),
+                      make_tuple_iterator(thrust::make_counting_iterator(primitives.size()), primitives.end()),
+                      out->collision_index_pairs_.begin(), func);
+    auto end = thrust::remove_if(out->collision_index_pairs_.begin(), out->collision_index_pairs_.end(),
+                                 [] __device__ (const Eigen::Vector2i& pair) { return pair[0] < 0; });
+    out->collision_index_pairs_.resize(thrust::distance(out->collision_index_pairs_.begin(), end));
+    return out;
+}
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const Primitive& primitive,
+                                                     const geometry::DistanceTransform& distance_transform,
+                                                     float margin) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeIntersection(primitives, distance_transform, margin);
+}
+
+DistanceResult::DistanceResult()
+: first_(geometry::Geometry::GeometryType::Unspecified),
+second_(geometry::Geometry::GeometryType::Unspecified) {};
+
+DistanceResult::DistanceResult(const DistanceResult& other)
+: first_(other.first_), second_(other.second_), index_pairs_(other.index_pairs_),
+distances_(other.distances_), first_points_(other.first_points_),
+second_points_(other.second_points_) {};
+
+DistanceResult::~DistanceResult() {};
+
+thrust::host_vector<Eigen::Vector2i> DistanceResult::GetIndexPairs() const {
+    thrust::host_vector<Eigen::Vector2i> h_index_pairs = index_pairs_;
+    return h_index_pairs;
+}
+
+thrust::host_vector<float> DistanceResult::GetDistances() const {
+    thrust::host_vector<float> h_distances = distances_;
+    return h_distances;
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::PointCloud& pointcloud,
+                                                float max_distance) {
+    geometry::AABBTree tree;
+    if (!pointcloud.points_.empty()) tree.Build(pointcloud.points_, pointcloud.points_);
+    return ComputeClosestObjects(primitives, tree,
+                                 point_projector(thrust::raw_pointer_cast(pointcloud.points_.data())),
+                                 max_distance, geometry::Geometry::GeometryType::PointCloud);
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::PointCloud& pointcloud,
+                                                float max_distance) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeDistance(primitives, pointcloud, max_distance);
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::VoxelGrid& voxelgrid,
+                                                float max_distance) {
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
+    geometry::AABBTree::AppendBoxes(voxelgrid, min_bounds, max_bounds);
+    geometry::AABBTree tree;
+    if (!min_bounds.empty()) tree.Build(min_bounds, max_bounds);
+    return ComputeClosestObjects(primitives, tree,
+                                 box_projector(thrust::raw_pointer_cast(min_bounds.data()),
+                                               thrust::raw_pointer_cast(max_bounds.data())),
+                                 max_distance, geometry::Geometry::GeometryType::VoxelGrid);
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::VoxelGrid& voxelgrid,
+                                                float max_distance) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeDistance(primitives, voxelgrid, max_distance);
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::TriangleMesh& mesh,
+                                                float max_distance) {
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
+    geometry::AABBTree::AppendBoxes(mesh, min_bounds, max_bounds);
+    geometry::AABBTree tree;
+    if (!min_bounds.empty()) tree.Build(min_bounds, max_bounds);
+    return ComputeClosestObjects(primitives, tree,
+                                 triangle_projector(thrust::raw_pointer_cast(mesh.triangles_.data()),
+                                                    thrust::raw_pointer_cast(mesh.vertices_.data())),
+                                 max_distance, geometry::Geometry::GeometryType::TriangleMesh);
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::TriangleMesh& mesh,
+                                                float max_distance) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeDistance(primitives, mesh, max_distance);
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::DistanceTransform& distance_transform,
+                                                float max_distance) {
+    auto out = std::make_shared<DistanceResult>();
+    out->first_ = geometry::Geometry::GeometryType::Unspecified;
+    out->second_ = geometry::Geometry::GeometryType::DistanceTransform;
+    const size_t n = primitives.size();
+    if (n == 0 || distance_transform.voxels_.empty()) return out;
+    resize_all(n, out->index_pairs_, out->distances_, out->first_points_, out->second_points_);
+    distance_transform_distance_functor func(distance_transform.GetView(), max_distance);
+    thrust::transform(make_tuple_iterator(thrust::make_counting_iterator<size_t>(0), primitives.begin()),
+                      make_tuple_iterator(thrust::make_counting_iterator(n), primitives.end()),
+                      make_tuple_begin(out->index_pairs_, out->distances_,
+                                       out->first_points_, out->second_points_),
+                      func);
+    RemoveInvalidDistances(*out);
+    return out;
+}
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::DistanceTransform& distance_transform,
+                                                float max_distance) {
+    utility::device_vector<PrimitiveShape> primitives(1, CreatePrimitiveShape(primitive));
+    return ComputeDistance(primitives, distance_transform, max_distance);
+}
+
 }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <Eigen/Core>
 
+#include "cupoch/collision/primitives.h"
 #include "cupoch/geometry/geometry.h"
 #include "cupoch/utility/device_vector.h"
 
@@ -11,6 +12,9 @@ namespace geometry {
 class VoxelGrid;
 class LineSet;
 class OccupancyGrid;
+class TriangleMesh;
+class PointCloud;
+class DistanceTransform;
 }
 
 namespace collision {
@@ -31,6 +35,27 @@ struct CollisionResult {
     thrust::host_vector<Eigen::Vector2i> GetCollisionIndexPairs() const;
 };
 
+/// Result of the distance queries: for every query object i with an
+/// object j of the other geometry within the maximum distance, the pair
+/// (i, j) of the closest object, their distance, negative in penetration,
+/// and the witness points on both, from first_points_ to second_points_.
+struct DistanceResult {
+    geometry::Geometry::GeometryType first_;
+    geometry::Geometry::GeometryType second_;
+    utility::device_vector<Eigen::Vector2i> index_pairs_;
+    utility::device_vector<float> distances_;
+    utility::device_vector<Eigen::Vector3f> first_points_;
+    utility::device_vector<Eigen::Vector3f> second_points_;
+
+    DistanceResult();
+    DistanceResult(const DistanceResult& other);
+    ~DistanceResult();
+
+    bool IsEmpty() const { return index_pairs_.empty(); };
+    thrust::host_vector<Eigen::Vector2i> GetIndexPairs() const;
+    thrust::host_vector<float> GetDistances() const;
+};
+
 std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::VoxelGrid& voxelgrid1,
                                                      const geometry::VoxelGrid& voxelgrid2,
                                                      float margin = 0.0f);
@@ -51,5 +76,98 @@ std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::OccupancyGr
                                                      const geometry::VoxelGrid& voxelgrid,
                                                      float margin = 0.0f);
 
+/// Pairs of the voxels and the triangles that intersect, the voxels being
+/// grown by \p margin. The triangles are searched in a BVH over their
+/// bounds.
+std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::VoxelGrid& voxelgrid,
+                                                     const geometry::TriangleMesh& mesh,
+                                                     float margin = 0.0f);
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const geometry::TriangleMesh& mesh,
+                                                     const geometry::VoxelGrid& voxelgrid,
+                                                     float margin = 0.0f);
+
+/// Pairs (i, j) of the primitives i and the points j within \p margin of
+/// them, tested with the signed distances of the primitives, without
+/// voxelizing them. Every point tests all the primitives, for the small
+/// sets of a robot model. The primitive side of the result is Unspecified.
+std::shared_ptr<CollisionResult> ComputeIntersection(const utility::device_vector<PrimitiveShape>& primitives,
+                                                     const geometry::PointCloud& pointcloud,
+                                                     float margin = 0.0f);
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const Primitive& primitive,
+                                                     const geometry::PointCloud& pointcloud,
+                                                     float margin = 0.0f);
+
+/// Pairs (i, j) of the primitives i and the occupied voxels j, indexed as
+/// in ComputeIntersection(VoxelGrid, OccupancyGrid). Only the voxels in the
+/// bounds of a primitive grown by \p margin are visited, the voxel being
+/// hit when its center is within margin plus half its diagonal of the
+/// primitive, which is conservative by at most one voxel.
+std::shared_ptr<CollisionResult> ComputeIntersection(const utility::device_vector<PrimitiveShape>& primitives,
+                                                     const geometry::OccupancyGrid& occgrid,
+                                                     float margin = 0.0f);
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const Primitive& primitive,
+                                                     const geometry::OccupancyGrid& occgrid,
+                                                     float margin = 0.0f);
+
+/// Pairs (i, j) of the primitives i and the nearest obstacle voxels j of
+/// their bounding spheres, with a single lookup of the transform per
+/// primitive: a primitive collides when the voxel nearest to the center of
+/// its bounding sphere is closer than the radius plus \p margin. Exact up to
+/// the voxelization for the spheres, conservative for the other shapes.
+/// The primitives whose center is outside of the transform are free.
+std::shared_ptr<CollisionResult> ComputeIntersection(const utility::device_vector<PrimitiveShape>& primitives,
+                                                     const geometry::DistanceTransform& distance_transform,
+                                                     float margin = 0.0f);
+
+std::shared_ptr<CollisionResult> ComputeIntersection(const Primitive& primitive,
+                                                     const geometry::DistanceTransform& distance_transform,
+                                                     float margin = 0.0f);
+
+/// Closest point, voxel or triangle of every primitive within
+/// \p max_distance. The objects are searched in a BVH over their bounds,
+/// pruned by the bounding spheres of the primitives. The closest points of
+/// a primitive and a voxel or a triangle are found by alternating
+/// projections, whose distance is an upper bound converging to the true
+/// one. In penetration, the distance is the signed distance of the witness
+/// point of the second geometry, which is an estimate of the depth.
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::PointCloud& pointcloud,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::PointCloud& pointcloud,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::VoxelGrid& voxelgrid,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::VoxelGrid& voxelgrid,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::TriangleMesh& mesh,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::TriangleMesh& mesh,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+/// Distance of every primitive to the nearest obstacle voxel of the center
+/// of its bounding sphere, with one lookup of the transform, the second
+/// index being the storage index of the voxel. Exact up to the
+/// voxelization for the spheres.
+std::shared_ptr<DistanceResult> ComputeDistance(const utility::device_vector<PrimitiveShape>& primitives,
+                                                const geometry::DistanceTransform& distance_transform,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
+std::shared_ptr<DistanceResult> ComputeDistance(const Primitive& primitive,
+                                                const geometry::DistanceTransform& distance_transform,
+                                                float max_distance = std::numeric_limits<float>::infinity());
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "cupoch/collision/continuous_collision.h"
+#include "cupoch/geometry/distance_test.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/utility/console.h"
+
+namespace cupoch {
+namespace collision {
+
+namespace {
+
+/// Rotation between the start and the end of a motion, as R(t) = R0 * exp(t * theta * [axis]).
+struct interpolated_rotation {
+    __device__ interpolated_rotation(const Eigen::Matrix3f& r0, const Eigen::Matrix3f& r1)
+    : r0_(r0) {
+        const Eigen::Matrix3f rel = r0.transpose() * r1;
+        const float c = fminf(fmaxf(0.5f * (rel.trace() - 1.0f), -1.0f), 1.0f);
+        theta_ = acosf(c);
+        const Eigen::Vector3f w(rel(2, 1) - rel(1, 2), rel(0, 2) - rel(2, 0), rel(1, 0) - rel(0, 1));
+        if (theta_ < 1.0e-6f) {
+            theta_ = 0.0f;
+            axis_ = Eigen::Vector3f::UnitX();
+        } else if (w.norm() > 1.0e-4f) {
+            axis_ = w.normalized();
+        } else {
+            // Half turn: the axis is the column of R + I of largest norm.
+            const Eigen::Matrix3f s = rel + Eigen::Matrix3f::Identity();
+            int k = 0;
+            for (int i = 1; i < 3; ++i) {
+                if (s.col(i).squaredNorm() > s.col(k).squaredNorm()) k = i;
+            }
+            axis_ = s.col(k).normalized();
+        }
+    }
+    Eigen::Matrix3f r0_;
+    Eigen::Vector3f axis_;
+    float theta_;
+    __device__ Eigen::Matrix3f operator() (float t) const {
+        if (theta_ == 0.0f) return r0_;
+        Eigen::Matrix3f k;
+        k << 0.0f, -axis_[2], axis_[1],
+             axis_[2], 0.0f, -axis_[0],
+             -axis_[1], axis_[0], 0.0f;
+        const float phi = t * theta_;
+        return r0_ * (Eigen::Matrix3f::Identity() + sinf(phi) * k + (1.0f - cosf(phi)) * k * k);
+    }
+};
+
+struct time_of_impact_functor {
+    time_of_impact_functor(const Eigen::Vector3f& center, float radius,
+                           const geometry::DenseGridView<geometry::DistanceVoxel>& view,
+                           float margin, float tolerance, int max_iterations)
+                           : center_(center), radius_(radius), view_(view), margin_(margin),
+                           tolerance_(tolerance), max_iterations_(max_iterations) {};
+    const Eigen::Vector3f center_;
+    const float radius_;
+    const geometry::DenseGridView<geometry::DistanceVoxel> view_;
+    const float margin_;
+    const float tolerance_;
+    const int max_iterations_;
+
+    /// Lower bound of the distance from \p p to the obstacles, the distance
+    /// to the nearest obstacle voxel of the center of its voxel less half a
+    /// voxel diagonal. -1 out of the transform, infinity without obstacle.
+    __device__ float Clearance(const Eigen::Vector3f& p) const {
+        const geometry::DistanceVoxel* v = view_.GetVoxel(p);
+        if (v == NULL) return -1.0f;
+        if (v->IsNotSite()) return std::numeric_limits<float>::infinity();
+        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5 * view_.voxel_size_);
+        const Eigen::Vector3f site_center = (v->nearest_index_.cast<float>() -
+                                             Eigen::Vector3f::Constant(view_.resolution_ / 2 - 0.5)) * view_.voxel_size_ + view_.origin_;
+        return fmaxf(sqrtf(geometry::distance_test::PointAABBSquared(p, site_center - h3, site_center + h3)) -
+                     h3.norm(), 0.0f);
+    }
+
+    __device__ float operator() (const thrust::tuple<Eigen::Matrix4f_u, Eigen::Matrix4f_u>& x) const {
+        const Eigen::Matrix4f_u& start = thrust::get<0>(x);
+        const Eigen::Matrix4f_u& end = thrust::get<1>(x);
+        const interpolated_rotation rot(start.block<3, 3>(0, 0), end.block<3, 3>(0, 0));
+        const Eigen::Vector3f t0 = start.block<3, 1>(0, 3);
+        const Eigen::Vector3f dt = end.block<3, 1>(0, 3) - t0;
+        // Bound of the speed of the center of the bounding sphere, the
+        // points of the primitive staying in the sphere.
+        const float speed = dt.norm() + rot.theta_ * center_.norm();
+        float t = 0.0f;
+        for (int i = 0; i < max_iterations_; ++i) {
+            const Eigen::Vector3f p = rot(t) * center_ + t0 + t * dt;
+            const float c = Clearance(p);
+            float step;
+            if (c < 0.0f) {
+                step = view_.voxel_size_;
+            } else {
+                const float d = c - radius_;
+                if (d < margin_ + tolerance_) return t;
+                if (isinf(d)) return std::numeric_limits<float>::infinity();
+                step = d - margin_;
+            }
+            if (speed == 0.0f) return std::numeric_limits<float>::infinity();
+            t += step / speed;
+            if (t >= 1.0f) return std::numeric_limits<float>::infinity();
+        }
+        return t;
+    }
+};
+
+}  // namespace
+
+void ComputeTimesOfImpact(const Primitive& primitive,
+                          const utility::device_vector<Eigen::Matrix4f_u>& start_poses,
+                          const utility::device_vector<Eigen::Matrix4f_u>& end_poses,
+                          const geometry::DistanceTransform& distance_transform,
+                          utility::device_vector<float>& times,
+                          float margin, float tolerance, int max_iterations) {
+    if (start_poses.size() != end_poses.size()) {
+        utility::LogError("[ComputeTimesOfImpact] The sizes of start_poses and end_poses are different.");
+        return;
+    }
+    if (tolerance <= 0) {
+        utility::LogError("[ComputeTimesOfImpact] tolerance must be positive.");
+        return;
+    }
+    times.resize(start_poses.size());
+    if (start_poses.empty()) return;
+    if (distance_transform.voxels_.empty()) {
+        thrust::fill(times.begin(), times.end(), std::numeric_limits<float>::infinity());
+        return;
+    }
+    // Bounding sphere in the frame of the moving pose.
+    Eigen::Vector3f center;
+    float radius;
+    CreatePrimitiveShape(primitive).GetBoundingSphere(center, radius);
+    time_of_impact_functor func(center, radius, distance_transform.GetView(),
+                                margin, tolerance, max_iterations);
+    thrust::transform(make_tuple_begin(start_poses, end_poses),
+                      make_tuple_end(start_poses, end_poses), times.begin(), func);
+}
+
+}  // namespace collision
+}  // namespace cupoch
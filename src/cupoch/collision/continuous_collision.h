@@ -0,0 +1,42 @@
+#pragma once
+#include <Eigen/Core>
+
+#include "cupoch/collision/primitives.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+class DistanceTransform;
+}
+
+namespace collision {
+
+/// Times of impact of \p primitive moving from start_poses[i] to
+/// end_poses[i] against the obstacles of \p distance_transform, by
+/// conservative advancement instead of sweeping it in a VoxelGrid.
+///
+/// The world pose of the primitive is pose * transform_, the pose being
+/// interpolated linearly in translation and along the geodesic in
+/// rotation, so the poses must be rigid. Every step advances the time by
+/// the clearance of the bounding sphere of the primitive over a bound of
+/// the speed of its points, the clearance being a lower bound of the
+/// distance derived from the nearest obstacle voxel of the center. The
+/// time of impact is the first time in [0, 1] where the clearance is below
+/// \p margin plus \p tolerance, and is never after the first contact of
+/// the bounding sphere. The segments without impact get infinity, and
+/// those still advancing after \p max_iterations steps get the time
+/// reached. The centers out of the transform advance by one voxel per
+/// step. An OccupancyGrid is tested through its DistanceTransform, see
+/// DistanceTransform::ComputeEDT().
+void ComputeTimesOfImpact(const Primitive& primitive,
+                          const utility::device_vector<Eigen::Matrix4f_u>& start_poses,
+                          const utility::device_vector<Eigen::Matrix4f_u>& end_poses,
+                          const geometry::DistanceTransform& distance_transform,
+                          utility::device_vector<float>& times,
+                          float margin = 0.0,
+                          float tolerance = 0.01,
+                          int max_iterations = 100);
+
+}  // namespace collision
+}  // namespace cupoch
@@ -291,5 +291,33 @@ std::shared_ptr<geometry::TriangleMesh> CreateTriangleMesh(const Primitive& prim
     }
 }
 
+PrimitiveShape CreatePrimitiveShape(const Primitive& primitive) {
+    PrimitiveShape shape;
+    shape.type_ = primitive.type_;
+    shape.local_to_world_ = primitive.transform_;
+    shape.world_to_local_ = primitive.transform_.inverse();
+    switch (primitive.type_) {
+        case Primitive::PrimitiveType::Box:
+            shape.extents_ = ((const Box&)primitive).lengths_;
+            break;
+        case Primitive::PrimitiveType::Sphere:
+            shape.extents_ = Eigen::Vector3f(((const Sphere&)primitive).radius_, 0.0, 0.0);
+            break;
+        case Primitive::PrimitiveType::Cylinder: {
+            const Cylinder& cylinder = (const Cylinder&)primitive;
+            shape.extents_ = Eigen::Vector3f(cylinder.radius_, cylinder.height_, 0.0);
+            break;
+        }
+        case Primitive::PrimitiveType::Cone: {
+            const Cone& cone = (const Cone&)primitive;
+            shape.extents_ = Eigen::Vector3f(cone.radius_, cone.height_, 0.0);
+            break;
+        }
+        default:
+            utility::LogError("[CreatePrimitiveShape] Unsupported primitive type.");
+    }
+    return shape;
+}
+
 }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/utility/eigen.h"
 
 namespace cupoch {
 
@@ -41,7 +42,7 @@ public:
     __host__ __device__ Box() : Primitive(Primitive::PrimitiveType::Box) {};
     __host__ __device__ Box(const Eigen::Vector3f lengths) : Primitive(Primitive::PrimitiveType::Box), lengths_(lengths) {};
     __host__ __device__ Box(const Eigen::Vector3f lengths, const Eigen::Matrix4f& transform)
-    : Primitive(Primitive::PrimitiveType::Sphere, transform), lengths_(lengths) {};
+    : Primitive(Primitive::PrimitiveType::Box, transform), lengths_(lengths) {};
     __host__ __device__ ~Box() {};
 
     __host__ __device__
@@ -128,6 +129,155 @@ union PrimitivePack {
 
 typedef utility::device_vector<PrimitivePack> PrimitiveArray;
 
+/// Primitive as tested by the device code, without the virtual functions:
+/// its transform and the inverse, and its dimensions, lengths_ for a box,
+/// (radius_, 0, 0) for a sphere and (radius_, height_, 0) for a cylinder or
+/// a cone. Made by CreatePrimitiveShape().
+struct PrimitiveShape {
+    Primitive::PrimitiveType type_ = Primitive::PrimitiveType::Unspecified;
+    Eigen::Matrix4f_u local_to_world_ = Eigen::Matrix4f_u::Identity();
+    Eigen::Matrix4f_u world_to_local_ = Eigen::Matrix4f_u::Identity();
+    Eigen::Vector3f extents_ = Eigen::Vector3f::Zero();
+
+    __host__ __device__ Eigen::Vector3f ToLocal(const Eigen::Vector3f& p) const {
+        return world_to_local_.block<3, 3>(0, 0) * p + world_to_local_.block<3, 1>(0, 3);
+    }
+
+    /// Signed distance from the world point \p p to the primitive, negative
+    /// inside. A lower bound of the distance for the cone.
+    __host__ __device__ float SignedDistance(const Eigen::Vector3f& p) const {
+        const Eigen::Vector3f l = ToLocal(p);
+        switch (type_) {
+            case Primitive::PrimitiveType::Box: {
+                const Eigen::Vector3f q = l.cwiseAbs() - 0.5 * extents_;
+                return q.cwiseMax(0.0).norm() + fminf(q.maxCoeff(), 0.0f);
+            }
+            case Primitive::PrimitiveType::Sphere:
+                return l.norm() - extents_[0];
+            case Primitive::PrimitiveType::Cylinder: {
+                const Eigen::Vector2f d(l.head<2>().norm() - extents_[0],
+                                        fabsf(l[2]) - 0.5 * extents_[1]);
+                return d.cwiseMax(0.0).norm() + fminf(d.maxCoeff(), 0.0f);
+            }
+            case Primitive::PrimitiveType::Cone: {
+                // Maximum of the distances to the plane of the base and to
+                // the tangent plane of the lateral surface.
+                const float r = extents_[0];
+                const float h = extents_[1];
+                const float lateral = (l.head<2>().norm() - r * (1.0f - l[2] / h)) * h / sqrtf(h * h + r * r);
+                return fmaxf(lateral, -l[2]);
+            }
+            default:
+                return std::numeric_limits<float>::infinity();
+        }
+    }
+
+    /// Point of the solid primitive closest to the world point \p p, \p p
+    /// itself inside.
+    __host__ __device__ Eigen::Vector3f ClosestPoint(const Eigen::Vector3f& p) const {
+        const Eigen::Vector3f l = ToLocal(p);
+        Eigen::Vector3f c = l;
+        switch (type_) {
+            case Primitive::PrimitiveType::Box:
+                c = l.cwiseMax(-0.5 * extents_).cwiseMin(0.5 * extents_);
+                break;
+            case Primitive::PrimitiveType::Sphere: {
+                const float n = l.norm();
+                if (n > extents_[0]) c = l * (extents_[0] / n);
+                break;
+            }
+            case Primitive::PrimitiveType::Cylinder: {
+                const float rho = l.head<2>().norm();
+                if (rho > extents_[0]) c.head<2>() *= extents_[0] / rho;
+                c[2] = fminf(fmaxf(l[2], -0.5f * extents_[1]), 0.5f * extents_[1]);
+                break;
+            }
+            case Primitive::PrimitiveType::Cone: {
+                // Closest point of the triangle (0, 0), (r, 0), (0, h) of the
+                // half plane (rho, z), the base or the lateral side outside.
+                const float r = extents_[0];
+                const float h = extents_[1];
+                const float rho = l.head<2>().norm();
+                if (l[2] >= 0.0f && rho / r + l[2] / h <= 1.0f) break;
+                const Eigen::Vector2f q(rho, l[2]);
+                const Eigen::Vector2f base(fminf(rho, r), 0.0f);
+                const Eigen::Vector2f ab(-r, h);
+                const float t = fminf(fmaxf((q - Eigen::Vector2f(r, 0.0f)).dot(ab) / ab.squaredNorm(), 0.0f), 1.0f);
+                const Eigen::Vector2f lateral = Eigen::Vector2f(r, 0.0f) + t * ab;
+                const Eigen::Vector2f best = ((q - base).squaredNorm() < (q - lateral).squaredNorm()) ? base : lateral;
+                c.head<2>() = (rho > 0.0f) ? Eigen::Vector2f(l.head<2>() * (best[0] / rho)) : Eigen::Vector2f::Zero();
+                c[2] = best[1];
+                break;
+            }
+            default:
+                break;
+        }
+        return local_to_world_.block<3, 3>(0, 0) * c + local_to_world_.block<3, 1>(0, 3);
+    }
+
+    /// Bounds of the primitive in its local frame, the cone standing on its
+    /// base at z = 0.
+    __host__ __device__ void GetLocalBounds(Eigen::Vector3f& min_bound,
+                                            Eigen::Vector3f& max_bound) const {
+        switch (type_) {
+            case Primitive::PrimitiveType::Box:
+                max_bound = 0.5 * extents_;
+                min_bound = -max_bound;
+                break;
+            case Primitive::PrimitiveType::Sphere:
+                max_bound = Eigen::Vector3f::Constant(extents_[0]);
+                min_bound = -max_bound;
+                break;
+            case Primitive::PrimitiveType::Cylinder:
+                max_bound = Eigen::Vector3f(extents_[0], extents_[0], 0.5 * extents_[1]);
+                min_bound = -max_bound;
+                break;
+            case Primitive::PrimitiveType::Cone:
+                max_bound = Eigen::Vector3f(extents_[0], extents_[0], extents_[1]);
+                min_bound = Eigen::Vector3f(-extents_[0], -extents_[0], 0.0);
+                break;
+            default:
+                min_bound = Eigen::Vector3f::Zero();
+                max_bound = Eigen::Vector3f::Zero();
+        }
+    }
+
+    /// World bounds of the transformed local bounds.
+    __host__ __device__ geometry::AxisAlignedBoundingBox GetAxisAlignedBoundingBox() const {
+        Eigen::Vector3f lmin, lmax;
+        GetLocalBounds(lmin, lmax);
+        const Eigen::Vector3f c = local_to_world_.block<3, 3>(0, 0) * (0.5 * (lmin + lmax)) +
+                                  local_to_world_.block<3, 1>(0, 3);
+        const Eigen::Vector3f e = local_to_world_.block<3, 3>(0, 0).cwiseAbs() * (0.5 * (lmax - lmin));
+        return geometry::AxisAlignedBoundingBox(c - e, c + e);
+    }
+
+    /// Sphere around the center of the local bounds, containing the
+    /// primitive.
+    __host__ __device__ void GetBoundingSphere(Eigen::Vector3f& center, float& radius) const {
+        Eigen::Vector3f lmin, lmax;
+        GetLocalBounds(lmin, lmax);
+        center = local_to_world_.block<3, 3>(0, 0) * (0.5 * (lmin + lmax)) +
+                 local_to_world_.block<3, 1>(0, 3);
+        switch (type_) {
+            case Primitive::PrimitiveType::Box:
+                radius = 0.5 * extents_.norm();
+                break;
+            case Primitive::PrimitiveType::Sphere:
+                radius = extents_[0];
+                break;
+            case Primitive::PrimitiveType::Cylinder:
+            case Primitive::PrimitiveType::Cone:
+                radius = sqrtf(extents_[0] * extents_[0] + 0.25 * extents_[1] * extents_[1]);
+                break;
+            default:
+                radius = 0.0;
+        }
+    }
+};
+
+PrimitiveShape CreatePrimitiveShape(const Primitive& primitive);
+
 std::shared_ptr<geometry::VoxelGrid> CreateVoxelGrid(const Primitive& primitive, float voxel_size);
 std::shared_ptr<geometry::VoxelGrid> CreateVoxelGridWithSweeping(const Primitive& primitive, 
     float voxel_size, const Eigen::Matrix4f& dst, int sampling = 100);
@@ -0,0 +1,181 @@
+#include "cupoch/collision/robot_collision.h"
+#include "cupoch/geometry/distance_test.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/intersection_test.h"
+#include "cupoch/utility/console.h"
+
+namespace cupoch {
+namespace collision {
+
+namespace {
+
+/// \p link at the rigid pose \p pose of its link.
+__device__ PrimitiveShape TransformShape(const PrimitiveShape& link,
+                                         const Eigen::Matrix4f_u& pose) {
+    PrimitiveShape shape = link;
+    shape.local_to_world_ = pose * link.local_to_world_;
+    const Eigen::Matrix3f rt = shape.local_to_world_.block<3, 3>(0, 0).transpose();
+    shape.world_to_local_.block<3, 3>(0, 0) = rt;
+    shape.world_to_local_.block<3, 1>(0, 3) = -rt * shape.local_to_world_.block<3, 1>(0, 3);
+    return shape;
+}
+
+__device__ bool IsSelfCollided(const PrimitiveShape& a, const PrimitiveShape& b,
+                               float margin) {
+    if (a.type_ == Primitive::PrimitiveType::Sphere) {
+        return b.SignedDistance(a.local_to_world_.block<3, 1>(0, 3)) < a.extents_[0] + margin;
+    }
+    if (b.type_ == Primitive::PrimitiveType::Sphere) {
+        return a.SignedDistance(b.local_to_world_.block<3, 1>(0, 3)) < b.extents_[0] + margin;
+    }
+    // Oriented bounding boxes of the local bounds, grown by the margin.
+    Eigen::Vector3f amin, amax, bmin, bmax;
+    a.GetLocalBounds(amin, amax);
+    b.GetLocalBounds(bmin, bmax);
+    const Eigen::Matrix3f ra = a.local_to_world_.block<3, 3>(0, 0);
+    const Eigen::Matrix3f rb = b.local_to_world_.block<3, 3>(0, 0);
+    const Eigen::Vector3f ca = ra * (0.5 * (amin + amax)) + a.local_to_world_.block<3, 1>(0, 3);
+    const Eigen::Vector3f cb = rb * (0.5 * (bmin + bmax)) + b.local_to_world_.block<3, 1>(0, 3);
+    const Eigen::Vector3f ms = Eigen::Vector3f::Constant(0.5 * margin);
+    return geometry::intersection_test::BoxBox(0.5 * (amax - amin) + ms, ra.transpose(), ca,
+                                               0.5 * (bmax - bmin) + ms, rb, cb);
+}
+
+struct check_configurations_functor {
+    check_configurations_functor(const Eigen::Matrix4f_u* transforms,
+                                 const PrimitiveShape* links, int n_links,
+                                 const Eigen::Vector2i* pairs, int n_pairs,
+                                 const geometry::DenseGridView<geometry::DistanceVoxel>& dt_view,
+                                 bool has_dt, float margin,
+                                 uint8_t* collided, float* min_distances)
+                                 : transforms_(transforms), links_(links), n_links_(n_links),
+                                 pairs_(pairs), n_pairs_(n_pairs), dt_view_(dt_view),
+                                 has_dt_(has_dt), margin_(margin), collided_(collided),
+                                 min_distances_(min_distances) {};
+    const Eigen::Matrix4f_u* transforms_;
+    const PrimitiveShape* links_;
+    const int n_links_;
+    const Eigen::Vector2i* pairs_;
+    const int n_pairs_;
+    const geometry::DenseGridView<geometry::DistanceVoxel> dt_view_;
+    const bool has_dt_;
+    const float margin_;
+    uint8_t* collided_;
+    float* min_distances_;
+
+    /// Distance from the bounding sphere of \p shape to the nearest obstacle
+    /// voxel of its center, infinite when there is none.
+    __device__ float Clearance(const PrimitiveShape& shape) const {
+        Eigen::Vector3f center;
+        float radius;
+        shape.GetBoundingSphere(center, radius);
+        const geometry::DistanceVoxel* v = dt_view_.GetVoxel(center);
+        if (v == NULL || v->IsNotSite()) return std::numeric_limits<float>::infinity();
+        const Eigen::Vector3f h3 = Eigen::Vector3f::Constant(0.5 * dt_view_.voxel_size_);
+        const Eigen::Vector3f site_center = (v->nearest_index_.cast<float>() -
+                                             Eigen::Vector3f::Constant(dt_view_.resolution_ / 2 - 0.5)) * dt_view_.voxel_size_ + dt_view_.origin_;
+        return sqrtf(geometry::distance_test::PointAABBSquared(center, site_center - h3, site_center + h3)) - radius;
+    }
+
+    __device__ void operator() (size_t idx) const {
+        const Eigen::Matrix4f_u* poses = transforms_ + idx * n_links_;
+        float min_dist = std::numeric_limits<float>::infinity();
+        bool hit = false;
+        if (has_dt_) {
+            for (int i = 0; i < n_links_ && !hit; ++i) {
+                const float d = Clearance(TransformShape(links_[i], poses[i]));
+                min_dist = fminf(min_dist, d);
+                hit = d < margin_;
+            }
+        }
+        for (int i = 0; i < n_pairs_ && !hit; ++i) {
+            const Eigen::Vector2i& p = pairs_[i];
+            hit = IsSelfCollided(TransformShape(links_[p[0]], poses[p[0]]),
+                                 TransformShape(links_[p[1]], poses[p[1]]), margin_);
+        }
+        collided_[idx] = (hit) ? 1 : 0;
+        if (min_distances_) min_distances_[idx] = min_dist;
+    }
+};
+
+}  // namespace
+
+RobotCollisionChecker::RobotCollisionChecker(float margin) : margin_(margin) {}
+
+RobotCollisionChecker::~RobotCollisionChecker() {}
+
+RobotCollisionChecker &RobotCollisionChecker::AddLink(const Primitive &primitive) {
+    links_.push_back(CreatePrimitiveShape(primitive));
+    return *this;
+}
+
+RobotCollisionChecker &RobotCollisionChecker::AddSelfCollisionPair(int link1, int link2) {
+    const int n_links = links_.size();
+    if (link1 < 0 || link1 >= n_links || link2 < 0 || link2 >= n_links || link1 == link2) {
+        utility::LogError("[RobotCollisionChecker::AddSelfCollisionPair] Invalid link indices ({}, {}).",
+                          link1, link2);
+        return *this;
+    }
+    self_collision_pairs_.push_back(Eigen::Vector2i(link1, link2));
+    return *this;
+}
+
+RobotCollisionChecker &RobotCollisionChecker::SetDistanceTransform(
+        const std::shared_ptr<const geometry::DistanceTransform> &distance_transform) {
+    distance_transform_ = distance_transform;
+    return *this;
+}
+
+RobotCollisionChecker &RobotCollisionChecker::Clear() {
+    links_.clear();
+    self_collision_pairs_.clear();
+    distance_transform_.reset();
+    return *this;
+}
+
+void RobotCollisionChecker::Check(const utility::device_vector<Eigen::Matrix4f_u> &transforms,
+                                  utility::device_vector<uint8_t> &collided) const {
+    CheckConfigurations(transforms, collided, NULL);
+}
+
+void RobotCollisionChecker::Check(const utility::device_vector<Eigen::Matrix4f_u> &transforms,
+                                  utility::device_vector<uint8_t> &collided,
+                                  utility::device_vector<float> &min_distances) const {
+    const size_t n_links = links_.size();
+    min_distances.resize((n_links == 0) ? 0 : transforms.size() / n_links);
+    CheckConfigurations(transforms, collided, thrust::raw_pointer_cast(min_distances.data()));
+}
+
+void RobotCollisionChecker::CheckConfigurations(
+        const utility::device_vector<Eigen::Matrix4f_u> &transforms,
+        utility::device_vector<uint8_t> &collided,
+        float *min_distances) const {
+    const size_t n_links = links_.size();
+    if (n_links == 0) {
+        utility::LogError("[RobotCollisionChecker::Check] The robot has no link.");
+        collided.clear();
+        return;
+    }
+    if (transforms.size() % n_links != 0) {
+        utility::LogError("[RobotCollisionChecker::Check] The number of transforms {} is not a multiple of the number of links {}.",
+                          transforms.size(), n_links);
+        collided.clear();
+        return;
+    }
+    const size_t n_configs = transforms.size() / n_links;
+    collided.resize(n_configs);
+    geometry::DenseGridView<geometry::DistanceVoxel> dt_view;
+    if (distance_transform_) dt_view = distance_transform_->GetView();
+    check_configurations_functor func(thrust::raw_pointer_cast(transforms.data()),
+                                      thrust::raw_pointer_cast(links_.data()), n_links,
+                                      thrust::raw_pointer_cast(self_collision_pairs_.data()),
+                                      self_collision_pairs_.size(), dt_view,
+                                      (bool)distance_transform_, margin_,
+                                      thrust::raw_pointer_cast(collided.data()),
+                                      min_distances);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_configs), func);
+}
+
+}  // namespace collision
+}  // namespace cupoch
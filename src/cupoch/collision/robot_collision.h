@@ -0,0 +1,71 @@
+#pragma once
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/collision/primitives.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+class DistanceTransform;
+}
+
+namespace collision {
+
+/// \class RobotCollisionChecker
+///
+/// \brief Environment and self collision checks of a robot made of
+/// primitives, for batches of configurations in one launch.
+///
+/// Every link is one primitive, its transform_ being its pose in the frame
+/// of the link. A configuration is given by the poses of the n links, pose i
+/// of configuration c being at c * n + i in the transforms, so that the
+/// world pose of the primitive is transforms[c * n + i] * transform_. The
+/// poses must be rigid.
+///
+/// A link collides with the environment when the nearest obstacle voxel of
+/// the center of its bounding sphere in the DistanceTransform is closer than
+/// its radius plus margin_, which is exact up to the voxelization for the
+/// spheres and conservative for the other shapes. The self collision pairs
+/// are tested with the signed distance when one of the links is a sphere,
+/// and with their oriented bounding boxes otherwise.
+class RobotCollisionChecker {
+public:
+    RobotCollisionChecker(float margin = 0.0);
+    ~RobotCollisionChecker();
+
+    RobotCollisionChecker &AddLink(const Primitive &primitive);
+    RobotCollisionChecker &AddSelfCollisionPair(int link1, int link2);
+    RobotCollisionChecker &SetDistanceTransform(
+            const std::shared_ptr<const geometry::DistanceTransform> &distance_transform);
+    RobotCollisionChecker &Clear();
+    size_t GetNumLinks() const { return links_.size(); }
+
+    /// 1 for the configurations in collision, 0 for the others. A
+    /// configuration stops at its first collision.
+    void Check(const utility::device_vector<Eigen::Matrix4f_u> &transforms,
+               utility::device_vector<uint8_t> &collided) const;
+    /// Same as Check(), with the smallest clearance of the links to the
+    /// environment, infinite without a DistanceTransform. Every link of the
+    /// free configurations is visited, the collided ones stopping at their
+    /// first collision with the clearance found so far.
+    void Check(const utility::device_vector<Eigen::Matrix4f_u> &transforms,
+               utility::device_vector<uint8_t> &collided,
+               utility::device_vector<float> &min_distances) const;
+
+public:
+    float margin_;
+
+private:
+    void CheckConfigurations(const utility::device_vector<Eigen::Matrix4f_u> &transforms,
+                             utility::device_vector<uint8_t> &collided,
+                             float *min_distances) const;
+
+    utility::device_vector<PrimitiveShape> links_;
+    utility::device_vector<Eigen::Vector2i> self_collision_pairs_;
+    std::shared_ptr<const geometry::DistanceTransform> distance_transform_;
+};
+
+}  // namespace collision
+}  // namespace cupoch
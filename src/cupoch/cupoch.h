@@ -10,15 +10,19 @@
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/rgbdimage.h"
 #include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/geometry/voxel_point_map.h"
 #include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/geometry/voxelgrid_hash_map.h"
 #include "cupoch/io/class_io/ijson_convertible_io.h"
 #include "cupoch/io/class_io/image_io.h"
 #include "cupoch/io/class_io/pointcloud_io.h"
 #include "cupoch/io/class_io/trianglemesh_io.h"
 #include "cupoch/io/class_io/voxelgrid_io.h"
+#include "cupoch/localization/monte_carlo_localization.h"
 #include "cupoch/odometry/odometry.h"
 #include "cupoch/cupoch_config.h"
 #include "cupoch/registration/feature.h"
+#include "cupoch/registration/ndt.h"
 #include "cupoch/registration/registration.h"
 #include "cupoch/registration/transformation_estimation.h"
 #include "cupoch/utility/console.h"
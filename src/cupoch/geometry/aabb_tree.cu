@@ -0,0 +1,665 @@
+#include <thrust/gather.h>
+#include <thrust/sequence.h>
+
+#include "cupoch/geometry/aabb_tree.h"
+#include "cupoch/geometry/intersection_test.h"
+#include "cupoch/geometry/lineset.h"
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+namespace cupoch {
+namespace geometry {
+
+namespace {
+
+struct box_morton_code_functor {
+    box_morton_code_functor(const Eigen::Vector3f &scene_min,
+                            const Eigen::Vector3f &scene_size)
+        : scene_min_(scene_min), scene_size_(scene_size){};
+    const Eigen::Vector3f scene_min_;
+    const Eigen::Vector3f scene_size_;
+    __device__ MortonCode operator()(
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> &x) const {
+        const Eigen::Vector3f center =
+                (thrust::get<0>(x) + thrust::get<1>(x)) * 0.5;
+        const float scale = (1 << kMortonBitsPerAxis) - 1;
+        unsigned int q[3];
+        for (int i = 0; i < 3; ++i) {
+            float t = (scene_size_[i] > 0)
+                              ? (center[i] - scene_min_[i]) / scene_size_[i]
+                              : 0.0f;
+            t = fminf(fmaxf(t, 0.0f), 1.0f);
+            q[i] = (unsigned int)(t * scale);
+        }
+        return EncodeMorton(q[0], q[1], q[2]);
+    }
+};
+
+// Length of the common prefix of the codes of the leaves i and j, the
+// indices breaking the ties between equal codes. -1 out of range.
+__device__ int CommonPrefix(const MortonCode *codes,
+                            int n,
+                            int i,
+                            int j) {
+    if (j < 0 || j >= n) return -1;
+    const MortonCode ci = codes[i];
+    const MortonCode cj = codes[j];
+    if (ci == cj) return 64 + __clz(i ^ j);
+    return __clzll(ci ^ cj);
+}
+
+struct build_internal_nodes_functor {
+    build_internal_nodes_functor(const MortonCode *codes,
+                                 int n,
+                                 Eigen::Vector2i *children,
+                                 int *parents)
+        : codes_(codes), n_(n), children_(children), parents_(parents){};
+    const MortonCode *codes_;
+    const int n_;
+    Eigen::Vector2i *children_;
+    int *parents_;
+    __device__ void operator()(int i) {
+        const int d = (CommonPrefix(codes_, n_, i, i + 1) -
+                       CommonPrefix(codes_, n_, i, i - 1)) >= 0
+                              ? 1
+                              : -1;
+        // Range of the leaves of the node.
+        const int delta_min = CommonPrefix(codes_, n_, i, i - d);
+        int l_max = 2;
+        while (CommonPrefix(codes_, n_, i, i + l_max * d) > delta_min) {
+            l_max *= 2;
+        }
+        int l = 0;
+        for (int t = l_max / 2; t >= 1; t /= 2) {
+            if (CommonPrefix(codes_, n_, i, i + (l + t) * d) > delta_min) {
+                l += t;
+            }
+        }
+        const int j = i + l * d;
+        // Split position by binary search.
+        const int delta_node = CommonPrefix(codes_, n_, i, j);
+        int s = 0;
+        int t = l;
+        do {
+            t = (t + 1) / 2;
+            if (CommonPrefix(codes_, n_, i, i + (s + t) * d) > delta_node) {
+                s += t;
+            }
+        } while (t > 1);
+        const int gamma = i + s * d + min(d, 0);
+        const int n_internal = n_ - 1;
+        const int left =
+                (min(i, j) == gamma) ? n_internal + gamma : gamma;
+        const int right =
+                (max(i, j) == gamma + 1) ? n_internal + gamma + 1 : gamma + 1;
+        children_[i] = Eigen::Vector2i(left, right);
+        parents_[left] = i;
+        parents_[right] = i;
+    }
+};
+
+// Merges the bounds from the leaves to the root. The second child to
+// arrive at a node merges its bounds and goes on.
+struct merge_bounds_functor {
+    merge_bounds_functor(const Eigen::Vector2i *children,
+                         const int *parents,
+                         int *visits,
+                         Eigen::Vector3f *min_bounds,
+                         Eigen::Vector3f *max_bounds,
+                         int n_internal)
+        : children_(children),
+          parents_(parents),
+          visits_(visits),
+          min_bounds_(min_bounds),
+          max_bounds_(max_bounds),
+          n_internal_(n_internal){};
+    const Eigen::Vector2i *children_;
+    const int *parents_;
+    int *visits_;
+    Eigen::Vector3f *min_bounds_;
+    Eigen::Vector3f *max_bounds_;
+    const int n_internal_;
+    __device__ void operator()(int leaf) {
+        int node = parents_[n_internal_ + leaf];
+        while (node >= 0) {
+            __threadfence();
+            if (atomicAdd(visits_ + node, 1) == 0) return;
+            const Eigen::Vector2i c = children_[node];
+            min_bounds_[node] = min_bounds_[c[0]]
+                                        .array()
+                                        .min(min_bounds_[c[1]].array())
+                                        .matrix();
+            max_bounds_[node] = max_bounds_[c[0]]
+                                        .array()
+                                        .max(max_bounds_[c[1]].array())
+                                        .matrix();
+            node = parents_[node];
+        }
+    }
+};
+
+struct segment_node_test {
+    __device__ segment_node_test(const Eigen::Vector3f &p0,
+                                 const Eigen::Vector3f &p1,
+                                 float margin)
+        : p0_(p0), p1_(p1), ms_(Eigen::Vector3f::Constant(margin)){};
+    const Eigen::Vector3f p0_;
+    const Eigen::Vector3f p1_;
+    const Eigen::Vector3f ms_;
+    __device__ bool operator()(const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) const {
+        return intersection_test::LineSegmentAABB(p0_, p1_, min_bound - ms_,
+                                                  max_bound + ms_);
+    }
+};
+
+struct box_node_test {
+    __device__ box_node_test(const Eigen::Vector3f &min_bound,
+                             const Eigen::Vector3f &max_bound)
+        : min_bound_(min_bound), max_bound_(max_bound){};
+    const Eigen::Vector3f min_bound_;
+    const Eigen::Vector3f max_bound_;
+    __device__ bool operator()(const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) const {
+        return intersection_test::AABBAABB(min_bound_, max_bound_, min_bound,
+                                           max_bound);
+    }
+};
+
+struct first_hit_leaf {
+    int hit_ = -1;
+    __device__ bool operator()(int box,
+                               const Eigen::Vector3f &,
+                               const Eigen::Vector3f &) {
+        hit_ = box;
+        return false;
+    }
+};
+
+// Counts the pairs of a query, and writes them from pairs_ if not NULL.
+struct pair_leaf {
+    __device__ pair_leaf(int query, Eigen::Vector2i *pairs)
+        : query_(query), pairs_(pairs){};
+    const int query_;
+    Eigen::Vector2i *pairs_;
+    int n_ = 0;
+    __device__ bool operator()(int box,
+                               const Eigen::Vector3f &,
+                               const Eigen::Vector3f &) {
+        if (pairs_) pairs_[n_] = Eigen::Vector2i(query_, box);
+        ++n_;
+        return true;
+    }
+};
+
+__device__ float BoxDistance(const Eigen::Vector3f &p,
+                             const Eigen::Vector3f &min_bound,
+                             const Eigen::Vector3f &max_bound) {
+    return (min_bound - p).cwiseMax(p - max_bound).cwiseMax(0.0f).norm();
+}
+
+// Nearest box for the rays and the points: the node test prunes the nodes
+// farther than the best box found so far.
+struct nearest_leaf {
+    int index_ = -1;
+    float distance_ = std::numeric_limits<float>::infinity();
+};
+
+struct ray_node_test {
+    __device__ ray_node_test(const Eigen::Vector3f &origin,
+                             const Eigen::Vector3f &direction,
+                             const nearest_leaf *best)
+        : origin_(origin),
+          inv_dir_(direction.cwiseInverse()),
+          best_(best){};
+    const Eigen::Vector3f origin_;
+    const Eigen::Vector3f inv_dir_;
+    const nearest_leaf *best_;
+    __device__ float Distance(const Eigen::Vector3f &min_bound,
+                              const Eigen::Vector3f &max_bound) const {
+        return intersection_test::RayAABB(origin_, inv_dir_, min_bound,
+                                          max_bound, best_->distance_);
+    }
+    __device__ bool operator()(const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) const {
+        return Distance(min_bound, max_bound) < best_->distance_;
+    }
+};
+
+struct ray_leaf {
+    __device__ ray_leaf(const ray_node_test &test, nearest_leaf *best)
+        : test_(test), best_(best){};
+    const ray_node_test &test_;
+    nearest_leaf *best_;
+    __device__ bool operator()(int box,
+                               const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) {
+        const float t = test_.Distance(min_bound, max_bound);
+        if (t < best_->distance_) {
+            best_->distance_ = t;
+            best_->index_ = box;
+        }
+        return true;
+    }
+};
+
+struct point_node_test {
+    __device__ point_node_test(const Eigen::Vector3f &point,
+                               const nearest_leaf *best)
+        : point_(point), best_(best){};
+    const Eigen::Vector3f point_;
+    const nearest_leaf *best_;
+    __device__ bool operator()(const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) const {
+        return BoxDistance(point_, min_bound, max_bound) < best_->distance_;
+    }
+};
+
+struct point_leaf {
+    __device__ point_leaf(const Eigen::Vector3f &point, nearest_leaf *best)
+        : point_(point), best_(best){};
+    const Eigen::Vector3f point_;
+    nearest_leaf *best_;
+    __device__ bool operator()(int box,
+                               const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) {
+        const float d = BoxDistance(point_, min_bound, max_bound);
+        if (d < best_->distance_) {
+            best_->distance_ = d;
+            best_->index_ = box;
+        }
+        return d > 0.0f;
+    }
+};
+
+struct intersect_line_segments_functor {
+    intersect_line_segments_functor(const AABBTreeView &view,
+                                    const Eigen::Vector3f *points,
+                                    float margin)
+        : view_(view), points_(points), margin_(margin){};
+    const AABBTreeView view_;
+    const Eigen::Vector3f *points_;
+    const float margin_;
+    __device__ int operator()(const Eigen::Vector2i &line) const {
+        segment_node_test test(points_[line[0]], points_[line[1]], margin_);
+        first_hit_leaf leaf;
+        view_.Traverse(test, leaf);
+        return leaf.hit_;
+    }
+};
+
+template <class Query>
+struct query_pairs_functor {
+    query_pairs_functor(const AABBTreeView &view,
+                        const Query &query,
+                        const int *offsets,
+                        Eigen::Vector2i *pairs)
+        : view_(view), query_(query), offsets_(offsets), pairs_(pairs){};
+    const AABBTreeView view_;
+    const Query query_;
+    const int *offsets_;
+    Eigen::Vector2i *pairs_;
+    __device__ int operator()(size_t idx) const {
+        pair_leaf leaf(idx, (pairs_) ? pairs_ + offsets_[idx] : NULL);
+        view_.Traverse(query_.GetNodeTest(idx), leaf);
+        return leaf.n_;
+    }
+};
+
+struct segment_query {
+    segment_query(const Eigen::Vector3f *points,
+                  const Eigen::Vector2i *lines,
+                  float margin)
+        : points_(points), lines_(lines), margin_(margin){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector2i *lines_;
+    const float margin_;
+    __device__ segment_node_test GetNodeTest(size_t idx) const {
+        const Eigen::Vector2i &line = lines_[idx];
+        return segment_node_test(points_[line[0]], points_[line[1]], margin_);
+    }
+};
+
+struct box_query {
+    box_query(const Eigen::Vector3f *min_bounds,
+              const Eigen::Vector3f *max_bounds,
+              float margin)
+        : min_bounds_(min_bounds), max_bounds_(max_bounds), margin_(margin){};
+    const Eigen::Vector3f *min_bounds_;
+    const Eigen::Vector3f *max_bounds_;
+    const float margin_;
+    __device__ box_node_test GetNodeTest(size_t idx) const {
+        const Eigen::Vector3f ms = Eigen::Vector3f::Constant(margin_);
+        return box_node_test(min_bounds_[idx] - ms, max_bounds_[idx] + ms);
+    }
+};
+
+// Counts the pairs of every query, then writes them.
+template <class Query>
+utility::device_vector<Eigen::Vector2i> QueryPairs(const AABBTreeView &view,
+                                                   const Query &query,
+                                                   size_t n_queries) {
+    utility::device_vector<Eigen::Vector2i> pairs;
+    if (view.n_boxes_ == 0 || n_queries == 0) return pairs;
+    utility::device_vector<int> offsets(n_queries + 1, 0);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_queries),
+                      offsets.begin(),
+                      query_pairs_functor<Query>(view, query, NULL, NULL));
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    pairs.resize(offsets.back());
+    query_pairs_functor<Query> write_func(
+            view, query, thrust::raw_pointer_cast(offsets.data()),
+            thrust::raw_pointer_cast(pairs.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_queries), write_func);
+    thrust::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+struct nearest_ray_functor {
+    nearest_ray_functor(const AABBTreeView &view, float max_distance)
+        : view_(view), max_distance_(max_distance){};
+    const AABBTreeView view_;
+    const float max_distance_;
+    __device__ thrust::tuple<int, float> operator()(
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> &x) const {
+        nearest_leaf best;
+        best.distance_ = max_distance_;
+        ray_node_test test(thrust::get<0>(x), thrust::get<1>(x), &best);
+        ray_leaf leaf(test, &best);
+        view_.Traverse(test, leaf);
+        if (best.index_ < 0) best.distance_ = std::numeric_limits<float>::infinity();
+        return thrust::make_tuple(best.index_, best.distance_);
+    }
+};
+
+struct nearest_point_functor {
+    nearest_point_functor(const AABBTreeView &view) : view_(view){};
+    const AABBTreeView view_;
+    __device__ thrust::tuple<int, float> operator()(
+            const Eigen::Vector3f &point) const {
+        nearest_leaf best;
+        point_node_test test(point, &best);
+        point_leaf leaf(point, &best);
+        view_.Traverse(test, leaf);
+        return thrust::make_tuple(best.index_, best.distance_);
+    }
+};
+
+struct line_box_functor {
+    line_box_functor(const Eigen::Vector3f *points) : points_(points){};
+    const Eigen::Vector3f *points_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            const Eigen::Vector2i &line) const {
+        const Eigen::Vector3f &p0 = points_[line[0]];
+        const Eigen::Vector3f &p1 = points_[line[1]];
+        return thrust::make_tuple(p0.cwiseMin(p1), p0.cwiseMax(p1));
+    }
+};
+
+struct triangle_box_functor {
+    triangle_box_functor(const Eigen::Vector3f *vertices)
+        : vertices_(vertices){};
+    const Eigen::Vector3f *vertices_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            const Eigen::Vector3i &triangle) const {
+        const Eigen::Vector3f &p0 = vertices_[triangle[0]];
+        const Eigen::Vector3f &p1 = vertices_[triangle[1]];
+        const Eigen::Vector3f &p2 = vertices_[triangle[2]];
+        return thrust::make_tuple(p0.cwiseMin(p1).cwiseMin(p2),
+                                  p0.cwiseMax(p1).cwiseMax(p2));
+    }
+};
+
+struct voxel_box_functor {
+    voxel_box_functor(float voxel_size, const Eigen::Vector3f &origin)
+        : voxel_size_(voxel_size), origin_(origin){};
+    const float voxel_size_;
+    const Eigen::Vector3f origin_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            const Eigen::Vector3i &key) const {
+        const Eigen::Vector3f min_bound =
+                key.cast<float>() * voxel_size_ + origin_;
+        return thrust::make_tuple(
+                min_bound,
+                (min_bound.array() + voxel_size_).matrix().eval());
+    }
+};
+
+struct occupancy_voxel_box_functor {
+    occupancy_voxel_box_functor(float voxel_size, const Eigen::Vector3f &origin)
+        : voxel_size_(voxel_size), origin_(origin){};
+    const float voxel_size_;
+    const Eigen::Vector3f origin_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            const OccupancyVoxel &voxel) const {
+        const Eigen::Vector3f min_bound =
+                voxel.grid_index_.cast<float>() * voxel_size_ + origin_;
+        return thrust::make_tuple(
+                min_bound,
+                (min_bound.array() + voxel_size_).matrix().eval());
+    }
+};
+
+}  // namespace
+
+AABBTree::AABBTree() {}
+AABBTree::~AABBTree() {}
+AABBTree::AABBTree(const AABBTree &other)
+    : node_min_bounds_(other.node_min_bounds_),
+      node_max_bounds_(other.node_max_bounds_),
+      node_children_(other.node_children_),
+      leaf_box_indices_(other.leaf_box_indices_) {}
+
+AABBTree &AABBTree::Clear() {
+    node_min_bounds_.clear();
+    node_max_bounds_.clear();
+    node_children_.clear();
+    leaf_box_indices_.clear();
+    return *this;
+}
+
+AABBTree &AABBTree::Build(
+        const utility::device_vector<Eigen::Vector3f> &min_bounds,
+        const utility::device_vector<Eigen::Vector3f> &max_bounds) {
+    if (min_bounds.size() != max_bounds.size()) {
+        utility::LogError(
+                "[AABBTree::Build] min_bounds and max_bounds have different "
+                "sizes.");
+        return *this;
+    }
+    Clear();
+    const int n = min_bounds.size();
+    if (n == 0) return *this;
+    const int n_internal = n - 1;
+
+    const Eigen::Vector3f scene_min = thrust::reduce(
+            min_bounds.begin(), min_bounds.end(),
+            Eigen::Vector3f::Constant(std::numeric_limits<float>::max()),
+            thrust::elementwise_minimum<Eigen::Vector3f>());
+    const Eigen::Vector3f scene_max = thrust::reduce(
+            max_bounds.begin(), max_bounds.end(),
+            Eigen::Vector3f::Constant(-std::numeric_limits<float>::max()),
+            thrust::elementwise_maximum<Eigen::Vector3f>());
+    utility::device_vector<MortonCode> codes(n);
+    thrust::transform(make_tuple_begin(min_bounds, max_bounds),
+                      make_tuple_end(min_bounds, max_bounds), codes.begin(),
+                      box_morton_code_functor(scene_min, scene_max - scene_min));
+    leaf_box_indices_.resize(n);
+    thrust::sequence(leaf_box_indices_.begin(), leaf_box_indices_.end(), 0);
+    thrust::sort_by_key(codes.begin(), codes.end(), leaf_box_indices_.begin());
+
+    node_min_bounds_.resize(n_internal + n);
+    node_max_bounds_.resize(n_internal + n);
+    thrust::gather(leaf_box_indices_.begin(), leaf_box_indices_.end(),
+                   min_bounds.begin(), node_min_bounds_.begin() + n_internal);
+    thrust::gather(leaf_box_indices_.begin(), leaf_box_indices_.end(),
+                   max_bounds.begin(), node_max_bounds_.begin() + n_internal);
+    if (n_internal == 0) return *this;
+
+    node_children_.resize(n_internal);
+    utility::device_vector<int> parents(n_internal + n, -1);
+    build_internal_nodes_functor build_func(
+            thrust::raw_pointer_cast(codes.data()), n,
+            thrust::raw_pointer_cast(node_children_.data()),
+            thrust::raw_pointer_cast(parents.data()));
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_internal), build_func);
+    utility::device_vector<int> visits(n_internal, 0);
+    merge_bounds_functor merge_func(
+            thrust::raw_pointer_cast(node_children_.data()),
+            thrust::raw_pointer_cast(parents.data()),
+            thrust::raw_pointer_cast(visits.data()),
+            thrust::raw_pointer_cast(node_min_bounds_.data()),
+            thrust::raw_pointer_cast(node_max_bounds_.data()), n_internal);
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n), merge_func);
+    return *this;
+}
+
+AABBTreeView AABBTree::GetView() const {
+    AABBTreeView view;
+    view.node_min_bounds_ = thrust::raw_pointer_cast(node_min_bounds_.data());
+    view.node_max_bounds_ = thrust::raw_pointer_cast(node_max_bounds_.data());
+    view.node_children_ = thrust::raw_pointer_cast(node_children_.data());
+    view.leaf_box_indices_ = thrust::raw_pointer_cast(leaf_box_indices_.data());
+    view.n_boxes_ = GetNumBoxes();
+    return view;
+}
+
+utility::device_vector<int> AABBTree::IntersectLineSegments(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<Eigen::Vector2i> &lines,
+        float margin) const {
+    utility::device_vector<int> hits(lines.size(), -1);
+    if (IsEmpty()) return hits;
+    intersect_line_segments_functor func(
+            GetView(), thrust::raw_pointer_cast(points.data()), margin);
+    thrust::transform(lines.begin(), lines.end(), hits.begin(), func);
+    return hits;
+}
+
+utility::device_vector<Eigen::Vector2i> AABBTree::IntersectLineSegmentPairs(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<Eigen::Vector2i> &lines,
+        float margin) const {
+    segment_query query(thrust::raw_pointer_cast(points.data()),
+                        thrust::raw_pointer_cast(lines.data()), margin);
+    return QueryPairs(GetView(), query, lines.size());
+}
+
+utility::device_vector<Eigen::Vector2i> AABBTree::IntersectBoxes(
+        const utility::device_vector<Eigen::Vector3f> &min_bounds,
+        const utility::device_vector<Eigen::Vector3f> &max_bounds,
+        float margin) const {
+    if (min_bounds.size() != max_bounds.size()) {
+        utility::LogError(
+                "[AABBTree::IntersectBoxes] min_bounds and max_bounds have "
+                "different sizes.");
+        return utility::device_vector<Eigen::Vector2i>();
+    }
+    box_query query(thrust::raw_pointer_cast(min_bounds.data()),
+                    thrust::raw_pointer_cast(max_bounds.data()), margin);
+    return QueryPairs(GetView(), query, min_bounds.size());
+}
+
+void AABBTree::IntersectRays(
+        const utility::device_vector<Eigen::Vector3f> &origins,
+        const utility::device_vector<Eigen::Vector3f> &directions,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distances,
+        float max_distance) const {
+    if (origins.size() != directions.size()) {
+        utility::LogError(
+                "[AABBTree::IntersectRays] origins and directions have "
+                "different sizes.");
+        return;
+    }
+    indices.resize(origins.size());
+    distances.resize(origins.size());
+    thrust::transform(make_tuple_begin(origins, directions),
+                      make_tuple_end(origins, directions),
+                      make_tuple_begin(indices, distances),
+                      nearest_ray_functor(GetView(), max_distance));
+}
+
+void AABBTree::ComputeClosestBoxes(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distances) const {
+    indices.resize(points.size());
+    distances.resize(points.size());
+    thrust::transform(points.begin(), points.end(),
+                      make_tuple_begin(indices, distances),
+                      nearest_point_functor(GetView()));
+}
+
+void AABBTree::AppendBoxes(const VoxelGrid &voxelgrid,
+                           utility::device_vector<Eigen::Vector3f> &min_bounds,
+                           utility::device_vector<Eigen::Vector3f> &max_bounds) {
+    const size_t n_old = min_bounds.size();
+    const size_t n_new = voxelgrid.voxels_keys_.size();
+    min_bounds.resize(n_old + n_new);
+    max_bounds.resize(n_old + n_new);
+    thrust::transform(voxelgrid.voxels_keys_.begin(),
+                      voxelgrid.voxels_keys_.end(),
+                      make_tuple_iterator(min_bounds.begin() + n_old,
+                                          max_bounds.begin() + n_old),
+                      voxel_box_functor(voxelgrid.voxel_size_,
+                                        voxelgrid.origin_));
+}
+
+void AABBTree::AppendBoxes(const OccupancyGrid &occgrid,
+                           utility::device_vector<Eigen::Vector3f> &min_bounds,
+                           utility::device_vector<Eigen::Vector3f> &max_bounds) {
+    auto occupied_voxels = occgrid.ExtractOccupiedVoxels();
+    const size_t n_old = min_bounds.size();
+    const size_t n_new = occupied_voxels->size();
+    min_bounds.resize(n_old + n_new);
+    max_bounds.resize(n_old + n_new);
+    const Eigen::Vector3f occ_origin =
+            occgrid.origin_ - 0.5 * occgrid.voxel_size_ *
+                                      Eigen::Vector3f::Constant(
+                                              occgrid.resolution_);
+    thrust::transform(occupied_voxels->begin(), occupied_voxels->end(),
+                      make_tuple_iterator(min_bounds.begin() + n_old,
+                                          max_bounds.begin() + n_old),
+                      occupancy_voxel_box_functor(occgrid.voxel_size_,
+                                                  occ_origin));
+}
+
+void AABBTree::AppendBoxes(const LineSet &lineset,
+                           utility::device_vector<Eigen::Vector3f> &min_bounds,
+                           utility::device_vector<Eigen::Vector3f> &max_bounds) {
+    const size_t n_old = min_bounds.size();
+    const size_t n_new = lineset.lines_.size();
+    min_bounds.resize(n_old + n_new);
+    max_bounds.resize(n_old + n_new);
+    thrust::transform(lineset.lines_.begin(), lineset.lines_.end(),
+                      make_tuple_iterator(min_bounds.begin() + n_old,
+                                          max_bounds.begin() + n_old),
+                      line_box_functor(thrust::raw_pointer_cast(
+                              lineset.points_.data())));
+}
+
+void AABBTree::AppendBoxes(const TriangleMesh &mesh,
+                           utility::device_vector<Eigen::Vector3f> &min_bounds,
+                           utility::device_vector<Eigen::Vector3f> &max_bounds) {
+    const size_t n_old = min_bounds.size();
+    const size_t n_new = mesh.triangles_.size();
+    min_bounds.resize(n_old + n_new);
+    max_bounds.resize(n_old + n_new);
+    thrust::transform(mesh.triangles_.begin(), mesh.triangles_.end(),
+                      make_tuple_iterator(min_bounds.begin() + n_old,
+                                          max_bounds.begin() + n_old),
+                      triangle_box_functor(thrust::raw_pointer_cast(
+                              mesh.vertices_.data())));
+}
+
+}  // namespace geometry
+}  // namespace cupoch
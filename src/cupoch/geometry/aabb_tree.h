@@ -0,0 +1,147 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class VoxelGrid;
+class OccupancyGrid;
+class LineSet;
+class TriangleMesh;
+
+/// Non owning view of an AABBTree, passed by value to the device code.
+struct AABBTreeView {
+    /// The tree is at most 64 levels deep for distinct codes, and up to 32
+    /// more for equal ones.
+    static constexpr int kStackSize = 128;
+
+    const Eigen::Vector3f *node_min_bounds_ = nullptr;
+    const Eigen::Vector3f *node_max_bounds_ = nullptr;
+    const Eigen::Vector2i *node_children_ = nullptr;
+    const int *leaf_box_indices_ = nullptr;
+    int n_boxes_ = 0;
+
+    /// Visits the boxes whose nodes pass \p node_test, depth first.
+    /// node_test(min_bound, max_bound) prunes the subtrees, and
+    /// leaf_func(box_index, min_bound, max_bound) returns false to stop the
+    /// traversal. Device only.
+    template <class NodeTest, class LeafFunc>
+    __device__ void Traverse(const NodeTest &node_test, LeafFunc &leaf_func) const {
+        if (n_boxes_ == 0) return;
+        const int n_internal = n_boxes_ - 1;
+        int stack[kStackSize];
+        int n_stack = 0;
+        stack[n_stack++] = 0;
+        while (n_stack > 0) {
+            const int node = stack[--n_stack];
+            if (!node_test(node_min_bounds_[node], node_max_bounds_[node])) continue;
+            if (node >= n_internal) {
+                if (!leaf_func(leaf_box_indices_[node - n_internal],
+                               node_min_bounds_[node], node_max_bounds_[node])) return;
+                continue;
+            }
+            const Eigen::Vector2i c = node_children_[node];
+            stack[n_stack++] = c[0];
+            stack[n_stack++] = c[1];
+        }
+    }
+};
+
+/// \class AABBTree
+///
+/// \brief Linear BVH over axis aligned boxes, built on the device.
+///
+/// The boxes are sorted by the Morton codes of their centers and the binary
+/// radix tree of the codes is built with one thread per internal node, as
+/// Karras, "Maximizing parallelism in the construction of BVHs, octrees,
+/// and k-d trees" (2012). The node bounds are merged bottom up. The n - 1
+/// internal nodes come first, then the n leaves in Morton order, and node 0
+/// is the root. The queries traverse the tree with one thread per query, so
+/// a batch of queries against all the boxes is a single launch. The exact
+/// tests against the objects in the boxes, triangles or segments, are left
+/// to the callers through GetView().
+class AABBTree {
+public:
+    AABBTree();
+    ~AABBTree();
+    AABBTree(const AABBTree &other);
+
+public:
+    AABBTree &Clear();
+    bool IsEmpty() const { return leaf_box_indices_.empty(); }
+    size_t GetNumBoxes() const { return leaf_box_indices_.size(); }
+
+    /// Builds the tree over the boxes [min_bounds[i], max_bounds[i]]. The
+    /// query results refer to the boxes by their index i.
+    AABBTree &Build(const utility::device_vector<Eigen::Vector3f> &min_bounds,
+                    const utility::device_vector<Eigen::Vector3f> &max_bounds);
+
+    /// View of the tree for the device code, valid until the next Build().
+    AABBTreeView GetView() const;
+
+    /// For every line of \p lines between \p points, the index of a box
+    /// that the segment crosses once the box is grown by \p margin, -1 if
+    /// none.
+    utility::device_vector<int> IntersectLineSegments(
+            const utility::device_vector<Eigen::Vector3f> &points,
+            const utility::device_vector<Eigen::Vector2i> &lines,
+            float margin = 0.0f) const;
+    /// Pairs (i, j) of the lines i and the boxes j grown by \p margin that
+    /// they cross, sorted.
+    utility::device_vector<Eigen::Vector2i> IntersectLineSegmentPairs(
+            const utility::device_vector<Eigen::Vector3f> &points,
+            const utility::device_vector<Eigen::Vector2i> &lines,
+            float margin = 0.0f) const;
+    /// Pairs (i, j) of the query boxes i and the boxes j that overlap once
+    /// the query boxes are grown by \p margin, sorted. The pairs of every
+    /// query are counted before being written, so the memory is in the
+    /// number of pairs.
+    utility::device_vector<Eigen::Vector2i> IntersectBoxes(
+            const utility::device_vector<Eigen::Vector3f> &min_bounds,
+            const utility::device_vector<Eigen::Vector3f> &max_bounds,
+            float margin = 0.0f) const;
+    /// First box along every ray from origins[i] in the direction
+    /// directions[i], not normalized, with the ray parameter of its entry
+    /// as distance; -1 and infinity beyond \p max_distance.
+    void IntersectRays(const utility::device_vector<Eigen::Vector3f> &origins,
+                       const utility::device_vector<Eigen::Vector3f> &directions,
+                       utility::device_vector<int> &indices,
+                       utility::device_vector<float> &distances,
+                       float max_distance = std::numeric_limits<float>::infinity()) const;
+    /// Closest box of every point and the distance to it, zero inside.
+    void ComputeClosestBoxes(const utility::device_vector<Eigen::Vector3f> &points,
+                             utility::device_vector<int> &indices,
+                             utility::device_vector<float> &distances) const;
+
+    /// Appends the boxes of the voxels of \p voxelgrid.
+    static void AppendBoxes(const VoxelGrid &voxelgrid,
+                            utility::device_vector<Eigen::Vector3f> &min_bounds,
+                            utility::device_vector<Eigen::Vector3f> &max_bounds);
+    /// Appends the boxes of the occupied voxels of \p occgrid.
+    static void AppendBoxes(const OccupancyGrid &occgrid,
+                            utility::device_vector<Eigen::Vector3f> &min_bounds,
+                            utility::device_vector<Eigen::Vector3f> &max_bounds);
+    /// Appends the bounds of the lines of \p lineset.
+    static void AppendBoxes(const LineSet &lineset,
+                            utility::device_vector<Eigen::Vector3f> &min_bounds,
+                            utility::device_vector<Eigen::Vector3f> &max_bounds);
+    /// Appends the bounds of the triangles of \p mesh.
+    static void AppendBoxes(const TriangleMesh &mesh,
+                            utility::device_vector<Eigen::Vector3f> &min_bounds,
+                            utility::device_vector<Eigen::Vector3f> &max_bounds);
+
+public:
+    /// Bounds of the 2n - 1 nodes.
+    utility::device_vector<Eigen::Vector3f> node_min_bounds_;
+    utility::device_vector<Eigen::Vector3f> node_max_bounds_;
+    /// Children of the n - 1 internal nodes.
+    utility::device_vector<Eigen::Vector2i> node_children_;
+    /// Input index of the box of every leaf.
+    utility::device_vector<int> leaf_box_indices_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
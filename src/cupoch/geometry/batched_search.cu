@@ -0,0 +1,148 @@
+#include <thrust/scan.h>
+
+#include <limits>
+
+#include "cupoch/geometry/batched_search.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct batched_search_functor {
+    batched_search_functor(const Eigen::Vector3f *points,
+                           const int *segment_offsets,
+                           int n_segments,
+                           float radius2,
+                           int max_nn,
+                           const int *result_offsets,
+                           int *counts,
+                           int *indices,
+                           float *distance2)
+        : points_(points),
+          segment_offsets_(segment_offsets),
+          n_segments_(n_segments),
+          radius2_(radius2),
+          max_nn_(max_nn),
+          result_offsets_(result_offsets),
+          counts_(counts),
+          indices_(indices),
+          distance2_(distance2){};
+    const Eigen::Vector3f *points_;
+    const int *segment_offsets_;
+    const int n_segments_;
+    const float radius2_;
+    const int max_nn_;
+    const int *result_offsets_;
+    int *counts_;
+    int *indices_;
+    float *distance2_;
+    __device__ void operator()(size_t idx) const {
+        int lo = 0;
+        int hi = n_segments_;
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) / 2;
+            if (segment_offsets_[mid] <= int(idx)) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const int begin = segment_offsets_[lo];
+        const int end = segment_offsets_[lo + 1];
+        const Eigen::Vector3f &query = points_[idx];
+        if (result_offsets_ == NULL) {
+            int count = 0;
+            for (int j = begin; j < end && count < max_nn_; ++j) {
+                if ((points_[j] - query).squaredNorm() <= radius2_) ++count;
+            }
+            counts_[idx] = count;
+            return;
+        }
+        int nn_idx[NUM_MAX_NN];
+        float nn_d2[NUM_MAX_NN];
+        int count = 0;
+        for (int j = begin; j < end; ++j) {
+            const float d2 = (points_[j] - query).squaredNorm();
+            if (d2 > radius2_) continue;
+            if (count == max_nn_ && d2 >= nn_d2[count - 1]) continue;
+            int k = (count < max_nn_) ? count++ : count - 1;
+            while (k > 0 && nn_d2[k - 1] > d2) {
+                nn_d2[k] = nn_d2[k - 1];
+                nn_idx[k] = nn_idx[k - 1];
+                --k;
+            }
+            nn_d2[k] = d2;
+            nn_idx[k] = j;
+        }
+        const int offset = result_offsets_[idx];
+        for (int k = 0; k < count; ++k) {
+            indices_[offset + k] = nn_idx[k];
+            distance2_[offset + k] = nn_d2[k];
+        }
+    }
+};
+
+int SearchBatchedImpl(const utility::device_vector<Eigen::Vector3f> &points,
+                      const utility::device_vector<int> &segment_offsets,
+                      float radius2,
+                      int max_nn,
+                      utility::device_vector<int> &result_offsets,
+                      utility::device_vector<int> &indices,
+                      utility::device_vector<float> &distance2) {
+    if (points.empty() || segment_offsets.size() < 2 || max_nn <= 0 ||
+        max_nn > NUM_MAX_NN)
+        return -1;
+    const size_t n_pt = points.size();
+    const int n_segments = segment_offsets.size() - 1;
+    utility::device_vector<int> counts(n_pt + 1, 0);
+    batched_search_functor count_func(
+            thrust::raw_pointer_cast(points.data()),
+            thrust::raw_pointer_cast(segment_offsets.data()), n_segments,
+            radius2, max_nn, NULL, thrust::raw_pointer_cast(counts.data()),
+            NULL, NULL);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_pt), count_func);
+    result_offsets.resize(n_pt + 1);
+    thrust::exclusive_scan(counts.begin(), counts.end(),
+                           result_offsets.begin());
+    const int total = result_offsets.back();
+    indices.resize(total);
+    distance2.resize(total);
+    batched_search_functor fill_func(
+            thrust::raw_pointer_cast(points.data()),
+            thrust::raw_pointer_cast(segment_offsets.data()), n_segments,
+            radius2, max_nn, thrust::raw_pointer_cast(result_offsets.data()),
+            NULL, thrust::raw_pointer_cast(indices.data()),
+            thrust::raw_pointer_cast(distance2.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_pt), fill_func);
+    return 1;
+}
+
+}  // namespace
+
+int cupoch::geometry::SearchKNNBatched(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<int> &segment_offsets,
+        int knn,
+        utility::device_vector<int> &result_offsets,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) {
+    return SearchBatchedImpl(points, segment_offsets,
+                             std::numeric_limits<float>::infinity(), knn,
+                             result_offsets, indices, distance2);
+}
+
+int cupoch::geometry::SearchRadiusBatched(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<int> &segment_offsets,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &result_offsets,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) {
+    return SearchBatchedImpl(points, segment_offsets, radius * radius, max_nn,
+                             result_offsets, indices, distance2);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// Neighbor searches over many small point sets in a single launch.
+///
+/// \p points is the concatenation of the point sets and \p segment_offsets
+/// holds the start of every set followed by the total number of points.
+/// Every point is a query against the points of its own set. The results
+/// are returned in CSR layout: the neighbors of point i are
+/// indices[result_offsets[i]:result_offsets[i + 1]], sorted by distance and
+/// given as indices into \p points.
+///
+/// The search is brute force inside each set, so it is meant for sets of up
+/// to a few thousand points such as per-object segments, where it is much
+/// cheaper than building one KDTreeFlann per set.
+int SearchKNNBatched(const utility::device_vector<Eigen::Vector3f> &points,
+                     const utility::device_vector<int> &segment_offsets,
+                     int knn,
+                     utility::device_vector<int> &result_offsets,
+                     utility::device_vector<int> &indices,
+                     utility::device_vector<float> &distance2);
+
+/// Same as SearchKNNBatched but returns up to \p max_nn neighbors within
+/// \p radius. The neighbors are counted in a first pass so the output is
+/// packed without padding.
+int SearchRadiusBatched(const utility::device_vector<Eigen::Vector3f> &points,
+                        const utility::device_vector<int> &segment_offsets,
+                        float radius,
+                        int max_nn,
+                        utility::device_vector<int> &result_offsets,
+                        utility::device_vector<int> &indices,
+                        utility::device_vector<float> &distance2);
+
+}  // namespace geometry
+}  // namespace cupoch
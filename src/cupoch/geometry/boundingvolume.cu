@@ -1,10 +1,18 @@
+#include <thrust/binary_search.h>
+#include <thrust/extrema.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/sort.h>
+
 #include <Eigen/Eigenvalues>
 #include <numeric>
 
 #include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/estimate_normals.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
 #include "cupoch/utility/platform.h"
 
 using namespace cupoch;
@@ -61,6 +69,84 @@ struct check_within_axis_aligned_bounding_box_functor {
     }
 };
 
+
+// Scatter matrix of the point idx around the mean of its cluster.
+struct cluster_scatter_functor {
+    cluster_scatter_functor(const Eigen::Vector3f *points,
+                            const int *segments,
+                            const Eigen::Vector3f *means)
+        : points_(points), segments_(segments), means_(means){};
+    const Eigen::Vector3f *points_;
+    const int *segments_;
+    const Eigen::Vector3f *means_;
+    __device__ Eigen::Matrix3f operator()(size_t idx) const {
+        const Eigen::Vector3f d = points_[idx] - means_[segments_[idx]];
+        return d * d.transpose();
+    }
+};
+
+// Principal axes of a cluster from its covariance, the largest first and
+// the smallest last, as the columns of a rotation.
+struct cluster_axes_functor {
+    __device__ Eigen::Matrix3f operator()(const Eigen::Matrix3f &cov) const {
+        Eigen::Matrix3f A = cov;
+        Eigen::Vector3f evals;
+        Eigen::Vector3f e_min = FastEigen3x3(A, evals);
+        if (e_min.squaredNorm() == 0.0f) return Eigen::Matrix3f::Identity();
+        e_min.normalize();
+        // The largest eigenvalue of A is the smallest of tr(A) I - A.
+        Eigen::Matrix3f B =
+                Eigen::Matrix3f::Identity() * cov.trace() - cov;
+        Eigen::Vector3f e_max = FastEigen3x3(B, evals);
+        e_max -= e_min.dot(e_max) * e_min;
+        if (e_max.squaredNorm() < 1.0e-12f) {
+            // Any direction orthogonal to e_min.
+            e_max = (abs(e_min(0)) > abs(e_min(1)))
+                            ? Eigen::Vector3f(-e_min(2), 0, e_min(0))
+                            : Eigen::Vector3f(0, e_min(2), -e_min(1));
+        }
+        e_max.normalize();
+        Eigen::Matrix3f R;
+        R.col(0) = e_max;
+        R.col(1) = e_min.cross(e_max);
+        R.col(2) = e_min;
+        return R;
+    }
+};
+
+// Point idx in the frame of the axes of its cluster, as the tuple of the
+// bounds it starts the reduction with.
+struct cluster_local_point_functor {
+    cluster_local_point_functor(const Eigen::Vector3f *points,
+                                const int *segments,
+                                const Eigen::Vector3f *means,
+                                const Eigen::Matrix3f *axes)
+        : points_(points), segments_(segments), means_(means), axes_(axes){};
+    const Eigen::Vector3f *points_;
+    const int *segments_;
+    const Eigen::Vector3f *means_;
+    const Eigen::Matrix3f *axes_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            size_t idx) const {
+        const int s = segments_[idx];
+        const Eigen::Vector3f p =
+                axes_[s].transpose() * (points_[idx] - means_[s]);
+        return thrust::make_tuple(p, p);
+    }
+};
+
+struct merge_bounds_functor {
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> &a,
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> &b) const {
+        const Eigen::Vector3f mn =
+                thrust::get<0>(a).array().min(thrust::get<0>(b).array());
+        const Eigen::Vector3f mx =
+                thrust::get<1>(a).array().max(thrust::get<1>(b).array());
+        return thrust::make_tuple(mn, mx);
+    }
+};
+
 }  // namespace
 
 OrientedBoundingBox &OrientedBoundingBox::Clear() {
@@ -176,6 +262,104 @@ OrientedBoundingBox OrientedBoundingBox::CreateFromAxisAlignedBoundingBox(
     return obox;
 }
 
+std::vector<OrientedBoundingBox> OrientedBoundingBox::CreateFromPointClusters(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<int> &labels) {
+    std::vector<OrientedBoundingBox> boxes;
+    if (points.size() != labels.size()) {
+        utility::LogError(
+                "[CreateFromPointClusters] points and labels must have the "
+                "same size.");
+        return boxes;
+    }
+    if (labels.empty()) return boxes;
+    const int max_label = thrust::reduce(labels.begin(), labels.end(), -1,
+                                         thrust::maximum<int>());
+    if (max_label < 0) return boxes;
+    boxes.resize(max_label + 1);
+
+    // Points of the clusters, grouped by cluster.
+    utility::device_vector<int> sorted_labels(labels.size());
+    utility::device_vector<Eigen::Vector3f> sorted_points(points.size());
+    auto end = thrust::copy_if(
+            make_tuple_begin(labels, points), make_tuple_end(labels, points),
+            labels.begin(), make_tuple_begin(sorted_labels, sorted_points),
+            [] __device__(int l) { return l >= 0; });
+    const size_t n = thrust::distance(
+            make_tuple_begin(sorted_labels, sorted_points), end);
+    resize_all(n, sorted_labels, sorted_points);
+    thrust::stable_sort_by_key(sorted_labels.begin(), sorted_labels.end(),
+                               sorted_points.begin());
+
+    // Means of the clusters.
+    utility::device_vector<int> keys(n);
+    utility::device_vector<Eigen::Vector3f> means(n);
+    utility::device_vector<int> counts(n);
+    auto end_m = thrust::reduce_by_key(
+            sorted_labels.begin(), sorted_labels.end(),
+            make_tuple_iterator(sorted_points.begin(),
+                                thrust::make_constant_iterator(1)),
+            keys.begin(), make_tuple_begin(means, counts),
+            thrust::equal_to<int>(), add_tuple_functor<Eigen::Vector3f, int>());
+    const size_t n_clusters = thrust::distance(keys.begin(), end_m.first);
+    resize_all(n_clusters, keys, means, counts);
+    thrust::transform(means.begin(), means.end(), counts.begin(),
+                      means.begin(),
+                      [] __device__(const Eigen::Vector3f &sum, int count) {
+                          return (sum / count).eval();
+                      });
+    utility::device_vector<int> segments(n);
+    thrust::lower_bound(keys.begin(), keys.end(), sorted_labels.begin(),
+                        sorted_labels.end(), segments.begin());
+
+    // Covariances and their principal axes, solved on the device.
+    utility::device_vector<Eigen::Matrix3f> axes(n_clusters);
+    thrust::reduce_by_key(
+            sorted_labels.begin(), sorted_labels.end(),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0),
+                    cluster_scatter_functor(
+                            thrust::raw_pointer_cast(sorted_points.data()),
+                            thrust::raw_pointer_cast(segments.data()),
+                            thrust::raw_pointer_cast(means.data()))),
+            thrust::make_discard_iterator(), axes.begin(),
+            thrust::equal_to<int>(), thrust::plus<Eigen::Matrix3f>());
+    thrust::transform(axes.begin(), axes.end(), counts.begin(), axes.begin(),
+                      [] __device__(const Eigen::Matrix3f &scatter, int count) {
+                          return cluster_axes_functor()(scatter / count);
+                      });
+
+    // Bounds of the clusters along their axes.
+    utility::device_vector<Eigen::Vector3f> min_bounds(n_clusters);
+    utility::device_vector<Eigen::Vector3f> max_bounds(n_clusters);
+    thrust::reduce_by_key(
+            sorted_labels.begin(), sorted_labels.end(),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0),
+                    cluster_local_point_functor(
+                            thrust::raw_pointer_cast(sorted_points.data()),
+                            thrust::raw_pointer_cast(segments.data()),
+                            thrust::raw_pointer_cast(means.data()),
+                            thrust::raw_pointer_cast(axes.data()))),
+            thrust::make_discard_iterator(),
+            make_tuple_begin(min_bounds, max_bounds), thrust::equal_to<int>(),
+            merge_bounds_functor());
+
+    thrust::host_vector<int> h_keys = keys;
+    thrust::host_vector<Eigen::Vector3f> h_means = means;
+    thrust::host_vector<Eigen::Matrix3f> h_axes = axes;
+    thrust::host_vector<Eigen::Vector3f> h_min_bounds = min_bounds;
+    thrust::host_vector<Eigen::Vector3f> h_max_bounds = max_bounds;
+    for (size_t i = 0; i < n_clusters; ++i) {
+        const Eigen::Matrix3f &R = h_axes[i];
+        const Eigen::Vector3f center =
+                h_means[i] + R * (0.5f * (h_min_bounds[i] + h_max_bounds[i]));
+        boxes[h_keys[i]] = OrientedBoundingBox(
+                center, R, h_max_bounds[i] - h_min_bounds[i]);
+    }
+    return boxes;
+}
+
 AxisAlignedBoundingBox &AxisAlignedBoundingBox::Clear() {
     min_bound_.setZero();
     max_bound_.setZero();
@@ -271,8 +455,9 @@ AxisAlignedBoundingBox AxisAlignedBoundingBox::CreateFromPoints(
         box.min_bound_ = Eigen::Vector3f(0.0, 0.0, 0.0);
         box.max_bound_ = Eigen::Vector3f(0.0, 0.0, 0.0);
     } else {
-        box.min_bound_ = box.ComputeMinBound(utility::GetStream(0), points);
-        box.max_bound_ = box.ComputeMaxBound(utility::GetStream(1), points);
+        const PointStatistics stats = box.ComputePointStatistics(points);
+        box.min_bound_ = stats.min_bound_;
+        box.max_bound_ = stats.max_bound_;
     }
     return box;
 }
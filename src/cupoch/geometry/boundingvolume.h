@@ -2,6 +2,7 @@
 
 #include <Eigen/Core>
 #include <array>
+#include <vector>
 
 #include "cupoch/geometry/geometry3d.h"
 #include "cupoch/utility/helper.h"
@@ -78,6 +79,14 @@ public:
     static OrientedBoundingBox CreateFromAxisAlignedBoundingBox(
             const AxisAlignedBoundingBox &aabox);
 
+    /// Boxes of the clusters of \p points given by \p labels, e.g. by
+    /// PointCloud::ClusterDBSCAN, aligned with the principal axes of each
+    /// cluster, all computed in one pass on the device. The box of label l
+    /// is at index l, and the noise points, labeled -1, are ignored.
+    static std::vector<OrientedBoundingBox> CreateFromPointClusters(
+            const utility::device_vector<Eigen::Vector3f> &points,
+            const utility::device_vector<int> &labels);
+
 public:
     /// The center point of the bounding box.
     Eigen::Vector3f center_;
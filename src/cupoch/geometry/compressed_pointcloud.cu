@@ -0,0 +1,329 @@
+#include <cuda_fp16.h>
+#include <thrust/iterator/transform_iterator.h>
+
+#include <limits>
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/compressed_pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+constexpr float kInt16Range = 32767.0f;
+
+__device__ short3 EncodePoint(const Eigen::Vector3f &pt,
+                              const Eigen::Vector3f &origin,
+                              float resolution) {
+    const Eigen::Vector3f q = (pt - origin) / resolution;
+    return make_short3(
+            (short)fminf(fmaxf(rintf(q(0)), -kInt16Range), kInt16Range),
+            (short)fminf(fmaxf(rintf(q(1)), -kInt16Range), kInt16Range),
+            (short)fminf(fmaxf(rintf(q(2)), -kInt16Range), kInt16Range));
+}
+
+__device__ Eigen::Vector3f DecodePoint(const short3 &q,
+                                       const Eigen::Vector3f &origin,
+                                       float resolution) {
+    return origin + Eigen::Vector3f(q.x, q.y, q.z) * resolution;
+}
+
+__device__ ushort3 EncodeNormal(const Eigen::Vector3f &nl) {
+    return make_ushort3(__half_as_ushort(__float2half_rn(nl(0))),
+                        __half_as_ushort(__float2half_rn(nl(1))),
+                        __half_as_ushort(__float2half_rn(nl(2))));
+}
+
+__device__ Eigen::Vector3f DecodeNormal(const ushort3 &h) {
+    return Eigen::Vector3f(__half2float(__ushort_as_half(h.x)),
+                           __half2float(__ushort_as_half(h.y)),
+                           __half2float(__ushort_as_half(h.z)));
+}
+
+struct encode_point_functor {
+    encode_point_functor(const Eigen::Vector3f &origin, float resolution)
+        : origin_(origin), resolution_(resolution){};
+    const Eigen::Vector3f origin_;
+    const float resolution_;
+    __device__ short3 operator()(const Eigen::Vector3f &pt) const {
+        return EncodePoint(pt, origin_, resolution_);
+    }
+};
+
+struct decode_point_functor {
+    decode_point_functor(const Eigen::Vector3f &origin, float resolution)
+        : origin_(origin), resolution_(resolution){};
+    const Eigen::Vector3f origin_;
+    const float resolution_;
+    __device__ Eigen::Vector3f operator()(const short3 &q) const {
+        return DecodePoint(q, origin_, resolution_);
+    }
+};
+
+struct encode_normal_functor {
+    __device__ ushort3 operator()(const Eigen::Vector3f &nl) const {
+        return EncodeNormal(nl);
+    }
+};
+
+struct decode_normal_functor {
+    __device__ Eigen::Vector3f operator()(const ushort3 &h) const {
+        return DecodeNormal(h);
+    }
+};
+
+struct encode_color_functor {
+    __device__ uchar3 operator()(const Eigen::Vector3f &cl) const {
+        const Eigen::Vector3f c =
+                (cl.array().max(0.0f).min(1.0f) * 255.0f).matrix();
+        return make_uchar3((unsigned char)rintf(c(0)),
+                           (unsigned char)rintf(c(1)),
+                           (unsigned char)rintf(c(2)));
+    }
+};
+
+struct decode_color_functor {
+    __device__ Eigen::Vector3f operator()(const uchar3 &c) const {
+        return Eigen::Vector3f(c.x, c.y, c.z) / 255.0f;
+    }
+};
+
+struct transform_decoded_point_functor {
+    transform_decoded_point_functor(const Eigen::Vector3f &origin,
+                                    float resolution,
+                                    const Eigen::Matrix4f &transform)
+        : origin_(origin), resolution_(resolution), transform_(transform){};
+    const Eigen::Vector3f origin_;
+    const float resolution_;
+    const Eigen::Matrix4f transform_;
+    __device__ Eigen::Vector3f operator()(const short3 &q) const {
+        const Eigen::Vector3f pt = DecodePoint(q, origin_, resolution_);
+        const Eigen::Vector4f new_pt =
+                transform_ * Eigen::Vector4f(pt(0), pt(1), pt(2), 1.0);
+        return new_pt.head<3>() / new_pt(3);
+    }
+};
+
+struct requantize_point_functor {
+    requantize_point_functor(const transform_decoded_point_functor &func,
+                             const Eigen::Vector3f &origin,
+                             float resolution)
+        : func_(func), origin_(origin), resolution_(resolution){};
+    const transform_decoded_point_functor func_;
+    const Eigen::Vector3f origin_;
+    const float resolution_;
+    __device__ void operator()(short3 &q) const {
+        q = EncodePoint(func_(q), origin_, resolution_);
+    }
+};
+
+struct transform_encoded_normal_functor {
+    transform_encoded_normal_functor(const Eigen::Matrix4f &transform)
+        : transform_(transform){};
+    const Eigen::Matrix4f transform_;
+    __device__ void operator()(ushort3 &h) const {
+        const Eigen::Vector3f nl = DecodeNormal(h);
+        const Eigen::Vector4f new_nl =
+                transform_ * Eigen::Vector4f(nl(0), nl(1), nl(2), 0.0);
+        h = EncodeNormal(new_nl.head<3>());
+    }
+};
+
+void ComputeQuantization(const Eigen::Vector3f &min_bound,
+                         const Eigen::Vector3f &max_bound,
+                         float requested_resolution,
+                         Eigen::Vector3f &origin,
+                         float &resolution) {
+    origin = 0.5 * (min_bound + max_bound);
+    const float min_resolution =
+            0.5 * (max_bound - min_bound).maxCoeff() / kInt16Range;
+    if (requested_resolution > 0.0) {
+        if (requested_resolution < min_resolution) {
+            utility::LogWarning(
+                    "[CompressedPointCloud] resolution {} is too small for "
+                    "the extent of the cloud, use {} instead.",
+                    requested_resolution, min_resolution);
+            resolution = min_resolution;
+        } else {
+            resolution = requested_resolution;
+        }
+    } else {
+        resolution = (min_resolution > 0.0) ? min_resolution : 1.0;
+    }
+}
+
+}  // namespace
+
+CompressedPointCloud::CompressedPointCloud() {}
+
+CompressedPointCloud::CompressedPointCloud(const PointCloud &cloud,
+                                           PointEncoding encoding,
+                                           float resolution) {
+    Compress(cloud, encoding, resolution);
+}
+
+CompressedPointCloud::CompressedPointCloud(const CompressedPointCloud &other)
+    : encoding_(other.encoding_),
+      origin_(other.origin_),
+      resolution_(other.resolution_),
+      points_(other.points_),
+      quantized_points_(other.quantized_points_),
+      normals_(other.normals_),
+      colors_(other.colors_) {}
+
+CompressedPointCloud::~CompressedPointCloud() {}
+
+CompressedPointCloud &CompressedPointCloud::operator=(
+        const CompressedPointCloud &other) {
+    encoding_ = other.encoding_;
+    origin_ = other.origin_;
+    resolution_ = other.resolution_;
+    points_ = other.points_;
+    quantized_points_ = other.quantized_points_;
+    normals_ = other.normals_;
+    colors_ = other.colors_;
+    return *this;
+}
+
+CompressedPointCloud &CompressedPointCloud::Clear() {
+    points_.clear();
+    quantized_points_.clear();
+    normals_.clear();
+    colors_.clear();
+    return *this;
+}
+
+size_t CompressedPointCloud::GetMemoryFootprint() const {
+    return points_.size() * sizeof(Eigen::Vector3f) +
+           quantized_points_.size() * sizeof(short3) +
+           normals_.size() * sizeof(ushort3) + colors_.size() * sizeof(uchar3);
+}
+
+CompressedPointCloud &CompressedPointCloud::Compress(const PointCloud &cloud,
+                                                     PointEncoding encoding,
+                                                     float resolution) {
+    Clear();
+    encoding_ = encoding;
+    if (!cloud.HasPoints()) return *this;
+    const size_t n = cloud.points_.size();
+    if (encoding_ == PointEncoding::Int16) {
+        const AxisAlignedBoundingBox box = cloud.GetAxisAlignedBoundingBox();
+        ComputeQuantization(box.min_bound_, box.max_bound_,
+                            resolution, origin_, resolution_);
+        quantized_points_.resize(n);
+        thrust::transform(cloud.points_.begin(), cloud.points_.end(),
+                          quantized_points_.begin(),
+                          encode_point_functor(origin_, resolution_));
+    } else {
+        origin_ = Eigen::Vector3f::Zero();
+        resolution_ = 1.0;
+        points_ = cloud.points_;
+    }
+    if (cloud.HasNormals()) {
+        normals_.resize(n);
+        thrust::transform(cloud.normals_.begin(), cloud.normals_.end(),
+                          normals_.begin(), encode_normal_functor());
+    }
+    if (cloud.HasColors()) {
+        colors_.resize(n);
+        thrust::transform(cloud.colors_.begin(), cloud.colors_.end(),
+                          colors_.begin(), encode_color_functor());
+    }
+    return *this;
+}
+
+std::shared_ptr<PointCloud> CompressedPointCloud::Decompress() const {
+    auto output = std::make_shared<PointCloud>();
+    Decompress(*output);
+    return output;
+}
+
+void CompressedPointCloud::Decompress(PointCloud &output) const {
+    output.Clear();
+    output.points_ = DecompressPoints();
+    if (HasNormals()) {
+        output.normals_.resize(normals_.size());
+        thrust::transform(normals_.begin(), normals_.end(),
+                          output.normals_.begin(), decode_normal_functor());
+    }
+    if (HasColors()) {
+        output.colors_.resize(colors_.size());
+        thrust::transform(colors_.begin(), colors_.end(),
+                          output.colors_.begin(), decode_color_functor());
+    }
+}
+
+utility::device_vector<Eigen::Vector3f>
+CompressedPointCloud::DecompressPoints() const {
+    if (encoding_ == PointEncoding::Float32) return points_;
+    utility::device_vector<Eigen::Vector3f> points(quantized_points_.size());
+    thrust::transform(quantized_points_.begin(), quantized_points_.end(),
+                      points.begin(),
+                      decode_point_functor(origin_, resolution_));
+    return points;
+}
+
+CompressedPointCloud &CompressedPointCloud::Transform(
+        const Eigen::Matrix4f &transformation) {
+    if (encoding_ == PointEncoding::Int16) {
+        transform_decoded_point_functor tf_func(origin_, resolution_,
+                                                transformation);
+        const Eigen::Vector3f init_min =
+                Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+        const Eigen::Vector3f init_max =
+                Eigen::Vector3f::Constant(-std::numeric_limits<float>::max());
+        const Eigen::Vector3f min_bound = thrust::transform_reduce(
+                quantized_points_.begin(), quantized_points_.end(), tf_func,
+                init_min, thrust::elementwise_minimum<Eigen::Vector3f>());
+        const Eigen::Vector3f max_bound = thrust::transform_reduce(
+                quantized_points_.begin(), quantized_points_.end(), tf_func,
+                init_max, thrust::elementwise_maximum<Eigen::Vector3f>());
+        Eigen::Vector3f new_origin;
+        float new_resolution;
+        ComputeQuantization(min_bound, max_bound, 0.0, new_origin,
+                            new_resolution);
+        thrust::for_each(
+                quantized_points_.begin(), quantized_points_.end(),
+                requantize_point_functor(tf_func, new_origin, new_resolution));
+        origin_ = new_origin;
+        resolution_ = new_resolution;
+    } else {
+        PointCloud tmp;
+        tmp.points_.swap(points_);
+        tmp.Transform(transformation);
+        points_.swap(tmp.points_);
+    }
+    if (HasNormals()) {
+        thrust::for_each(normals_.begin(), normals_.end(),
+                         transform_encoded_normal_functor(transformation));
+    }
+    return *this;
+}
+
+std::shared_ptr<CompressedPointCloud> CompressedPointCloud::VoxelDownSample(
+        float voxel_size) const {
+    auto down = Decompress()->VoxelDownSample(voxel_size);
+    return std::make_shared<CompressedPointCloud>(
+            *down, encoding_,
+            encoding_ == PointEncoding::Int16 ? resolution_ : 0.0);
+}
+
+bool CompressedPointCloud::EstimateNormals(
+        const KDTreeSearchParam &search_param) {
+    if (!HasPoints()) return false;
+    PointCloud tmp;
+    tmp.points_ = DecompressPoints();
+    if (HasNormals()) {
+        tmp.normals_.resize(normals_.size());
+        thrust::transform(normals_.begin(), normals_.end(),
+                          tmp.normals_.begin(), decode_normal_functor());
+    }
+    if (!tmp.EstimateNormals(search_param)) return false;
+    normals_.resize(tmp.normals_.size());
+    thrust::transform(tmp.normals_.begin(), tmp.normals_.end(),
+                      normals_.begin(), encode_normal_functor());
+    return true;
+}
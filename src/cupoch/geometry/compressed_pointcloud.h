@@ -0,0 +1,91 @@
+#pragma once
+#include <vector_types.h>
+
+#include <memory>
+
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// \class CompressedPointCloud
+///
+/// \brief Memory saving storage of a PointCloud for large maps.
+///
+/// Normals are stored as fp16 and colors as uint8 per channel. Points are
+/// either kept as fp32 or quantized to int16 relative to the center of the
+/// cloud (the tile origin). A point with normal and color takes 12 (or 6)
+/// + 6 + 3 bytes instead of 36 bytes in PointCloud.
+class CompressedPointCloud {
+public:
+    enum class PointEncoding {
+        Float32 = 0,
+        Int16 = 1,
+    };
+
+    CompressedPointCloud();
+    /// Compresses \p cloud. For PointEncoding::Int16, \p resolution is the
+    /// quantization step in meters. If it is not positive, the finest step
+    /// covering the bounding box of the cloud is used.
+    CompressedPointCloud(const PointCloud &cloud,
+                         PointEncoding encoding = PointEncoding::Float32,
+                         float resolution = 0.0);
+    CompressedPointCloud(const CompressedPointCloud &other);
+    ~CompressedPointCloud();
+    CompressedPointCloud &operator=(const CompressedPointCloud &other);
+
+    CompressedPointCloud &Clear();
+    bool IsEmpty() const { return !HasPoints(); }
+    size_t GetNumPoints() const {
+        return encoding_ == PointEncoding::Int16 ? quantized_points_.size()
+                                                 : points_.size();
+    }
+    bool HasPoints() const { return GetNumPoints() > 0; }
+    bool HasNormals() const {
+        return HasPoints() && normals_.size() == GetNumPoints();
+    }
+    bool HasColors() const {
+        return HasPoints() && colors_.size() == GetNumPoints();
+    }
+
+    /// Device memory used by the point, normal and color buffers in bytes.
+    size_t GetMemoryFootprint() const;
+
+    CompressedPointCloud &Compress(const PointCloud &cloud,
+                                   PointEncoding encoding,
+                                   float resolution = 0.0);
+    std::shared_ptr<PointCloud> Decompress() const;
+    void Decompress(PointCloud &output) const;
+    /// Decodes the points only.
+    utility::device_vector<Eigen::Vector3f> DecompressPoints() const;
+
+    /// Transforms the points and normals in place without decompressing the
+    /// whole cloud. Int16 points are re-quantized to the transformed bounds.
+    CompressedPointCloud &Transform(const Eigen::Matrix4f &transformation);
+
+    /// Voxel down sampling of the decoded cloud. The result is compressed
+    /// with the same encoding.
+    std::shared_ptr<CompressedPointCloud> VoxelDownSample(
+            float voxel_size) const;
+
+    /// Estimates normals from the decoded points and stores them as fp16.
+    bool EstimateNormals(
+            const KDTreeSearchParam &search_param = KDTreeSearchParamKNN());
+
+public:
+    PointEncoding encoding_ = PointEncoding::Float32;
+    /// Tile origin and quantization step of Int16 points.
+    Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    float resolution_ = 1.0;
+    utility::device_vector<Eigen::Vector3f> points_;
+    utility::device_vector<short3> quantized_points_;
+    /// fp16 bit patterns of the normals.
+    utility::device_vector<ushort3> normals_;
+    utility::device_vector<uchar3> colors_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -1,12 +1,101 @@
 #pragma once
 #include "cupoch/geometry/geometry3d.h"
+#include "cupoch/utility/helper.h"
 
 namespace cupoch {
 namespace geometry {
 
-template <class VoxelType>
+/// Voxel order of a DenseGrid, x-major as IndexOf().
+struct LinearGridLayout {
+    static constexpr int kBrickSize = 1;
+    __host__ __device__ static int StorageIndexOf(const Eigen::Vector3i& grid_index, int resolution) {
+        return IndexOf(grid_index, resolution);
+    }
+    __host__ __device__ static Eigen::Vector3i GridIndexOf(int storage_index, int resolution) {
+        const int yz = storage_index % (resolution * resolution);
+        return Eigen::Vector3i(storage_index / (resolution * resolution), yz / resolution, yz % resolution);
+    }
+    static size_t NumStorageVoxels(int resolution) { return (size_t)resolution * resolution * resolution; }
+};
+
+/// Voxel order of a DenseGrid in bricks of BrickSize^3 voxels: the bricks
+/// are x-major in the grid and the voxels x-major in their brick, so that
+/// the 3D neighborhoods read by the stencils and the ray marching span a
+/// few cache lines instead of one per row. The grid is padded to a
+/// multiple of BrickSize.
+template <int BrickSize = 8>
+struct BrickedGridLayout {
+    static_assert(BrickSize > 0 && (BrickSize & (BrickSize - 1)) == 0,
+                  "The brick size must be a power of 2.");
+    static constexpr int kBrickSize = BrickSize;
+    static constexpr int kBrickVoxels = BrickSize * BrickSize * BrickSize;
+    __host__ __device__ static int NumBricks(int resolution) { return (resolution + BrickSize - 1) / BrickSize; }
+    __host__ __device__ static int StorageIndexOf(const Eigen::Vector3i& grid_index, int resolution) {
+        const int n = NumBricks(resolution);
+        const int brick = IndexOf(grid_index[0] / BrickSize, grid_index[1] / BrickSize,
+                                  grid_index[2] / BrickSize, n);
+        const int local = IndexOf(grid_index[0] & (BrickSize - 1), grid_index[1] & (BrickSize - 1),
+                                  grid_index[2] & (BrickSize - 1), BrickSize);
+        return brick * kBrickVoxels + local;
+    }
+    __host__ __device__ static Eigen::Vector3i GridIndexOf(int storage_index, int resolution) {
+        return LinearGridLayout::GridIndexOf(storage_index / kBrickVoxels, NumBricks(resolution)) * BrickSize +
+               LinearGridLayout::GridIndexOf(storage_index % kBrickVoxels, BrickSize);
+    }
+    static size_t NumStorageVoxels(int resolution) {
+        return LinearGridLayout::NumStorageVoxels(NumBricks(resolution)) * kBrickVoxels;
+    }
+};
+
+/// Non owning view of the voxels of a DenseGrid, passed by value to the
+/// device code. ring_offset_ is the circular buffer offset of
+/// OccupancyGrid, zero for the other grids.
+template <class VoxelType, class Layout = LinearGridLayout>
+struct DenseGridView {
+    const VoxelType* voxels_ = nullptr;
+    float voxel_size_ = 0.0;
+    int resolution_ = 0;
+    Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    Eigen::Vector3i ring_offset_ = Eigen::Vector3i::Zero();
+
+    /// Grid index of the voxel of \p point, possibly outside of the grid.
+    __host__ __device__ Eigen::Vector3i GetGridIndex(const Eigen::Vector3f& point) const {
+        Eigen::Vector3i idx;
+        for (int i = 0; i < 3; ++i) {
+            idx[i] = (int)floorf((point[i] - origin_[i]) / voxel_size_) + resolution_ / 2;
+        }
+        return idx;
+    }
+    /// Index in voxels_ of the voxel of grid index \p grid_index, -1 outside
+    /// of the grid.
+    __host__ __device__ int GetStorageIndex(const Eigen::Vector3i& grid_index) const {
+        Eigen::Vector3i v;
+        for (int i = 0; i < 3; ++i) {
+            if (grid_index[i] < 0 || grid_index[i] >= resolution_) return -1;
+            v[i] = grid_index[i] + ring_offset_[i];
+            if (v[i] >= resolution_) v[i] -= resolution_;
+        }
+        return Layout::StorageIndexOf(v, resolution_);
+    }
+    __host__ __device__ int GetVoxelIndex(const Eigen::Vector3f& point) const {
+        return GetStorageIndex(GetGridIndex(point));
+    }
+    /// Voxel of \p point, NULL outside of the grid. Device only, voxels_
+    /// being device memory.
+    __device__ const VoxelType* GetVoxel(const Eigen::Vector3f& point) const {
+        int idx = GetVoxelIndex(point);
+        return (idx < 0) ? NULL : voxels_ + idx;
+    }
+};
+
+/// Dense voxel grid of resolution^3 voxels centered at origin_, stored in
+/// the order of \p Layout, LinearGridLayout or BrickedGridLayout. The
+/// device code finds the voxels with GetView().
+template <class VoxelType, class Layout = LinearGridLayout>
 class DenseGrid : public Geometry3D {
 public:
+    typedef Layout LayoutType;
+
     DenseGrid(Geometry::GeometryType type);
     DenseGrid(Geometry::GeometryType type, float voxel_size, int resolution, const Eigen::Vector3f& origin);
     DenseGrid(Geometry::GeometryType type, const DenseGrid &src_grid);
@@ -30,6 +119,26 @@ public:
     int GetVoxelIndex(const Eigen::Vector3f& point) const;
     thrust::tuple<bool, VoxelType> GetVoxel(const Eigen::Vector3f &point) const;
 
+    /// View of the grid for the device code, valid until voxels_ is
+    /// resized.
+    virtual DenseGridView<VoxelType, Layout> GetView() const;
+    /// Batched GetVoxelIndex() on the device, -1 for the points outside of
+    /// the grid.
+    void GetVoxelIndices(const utility::device_vector<Eigen::Vector3f>& points,
+                         utility::device_vector<int>& indices) const;
+    /// Batched lookup on the device. The voxels of the points outside of the
+    /// grid are default constructed and their indices are -1.
+    void GetVoxels(const utility::device_vector<Eigen::Vector3f>& points,
+                   utility::device_vector<int>& indices,
+                   utility::device_vector<VoxelType>& voxels) const;
+    /// If the voxels are in managed memory, see EnableVolumeOversubscription()
+    /// in utility, enqueues on \p stream the migration to the device of the
+    /// slabs of voxels overlapping the box [min_bound, max_bound], e.g.
+    /// around the camera frustum, and the eviction of the others to the host.
+    void PrefetchRegion(const Eigen::Vector3f& min_bound,
+                        const Eigen::Vector3f& max_bound,
+                        cudaStream_t stream = 0) const;
+
 public:
     float voxel_size_ = 0.0;
     int resolution_ = 0;
@@ -1,27 +1,54 @@
 #include "cupoch/geometry/densegrid.h"
 #include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/utility/memory_resource.h"
 
 namespace cupoch {
 namespace geometry {
 
-template<class VoxelType>
-DenseGrid<VoxelType>::DenseGrid(Geometry::GeometryType type) : Geometry3D(type) {}
-template<class VoxelType>
-DenseGrid<VoxelType>::DenseGrid(Geometry::GeometryType type, float voxel_size, int resolution, const Eigen::Vector3f& origin)
+namespace {
+
+template<class VoxelType, class Layout>
+struct view_voxel_index_functor {
+    view_voxel_index_functor(const DenseGridView<VoxelType, Layout>& view) : view_(view) {};
+    const DenseGridView<VoxelType, Layout> view_;
+    __device__ int operator() (const Eigen::Vector3f& point) const {
+        return view_.GetVoxelIndex(point);
+    }
+};
+
+template<class VoxelType, class Layout>
+struct view_voxel_functor {
+    view_voxel_functor(const DenseGridView<VoxelType, Layout>& view) : view_(view) {};
+    const DenseGridView<VoxelType, Layout> view_;
+    __device__ VoxelType operator() (int idx) const {
+        return (idx < 0) ? VoxelType() : view_.voxels_[idx];
+    }
+};
+
+}
+
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout>::DenseGrid(Geometry::GeometryType type) : Geometry3D(type) {}
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout>::DenseGrid(Geometry::GeometryType type, float voxel_size, int resolution, const Eigen::Vector3f& origin)
 : Geometry3D(type), voxel_size_(voxel_size), resolution_(resolution), origin_(origin) {
-    voxels_.resize(resolution_ * resolution_ * resolution_);
+    utility::ScopedMemorySubsystem memory_subsystem(
+            type == Geometry::GeometryType::OccupancyGrid
+                    ? utility::MemorySubsystem::Occupancy
+                    : utility::GetMemorySubsystem());
+    voxels_ = utility::MakeVolumeVector<VoxelType>(Layout::NumStorageVoxels(resolution_));
 }
-template<class VoxelType>
-DenseGrid<VoxelType>::DenseGrid(Geometry::GeometryType type, const DenseGrid &src_grid)
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout>::DenseGrid(Geometry::GeometryType type, const DenseGrid &src_grid)
 : Geometry3D(type), voxel_size_(src_grid.voxel_size_),
  resolution_(src_grid.resolution_),
  origin_(src_grid.origin_),
  voxels_(src_grid.voxels_) {}
-template<class VoxelType>
-DenseGrid<VoxelType>::~DenseGrid() {}
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout>::~DenseGrid() {}
 
-template<class VoxelType>
-DenseGrid<VoxelType> &DenseGrid<VoxelType>::Clear() {
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout> &DenseGrid<VoxelType, Layout>::Clear() {
     voxel_size_ = 0.0;
     resolution_ = 0;
     origin_ = Eigen::Vector3f::Zero();
@@ -29,90 +56,151 @@ DenseGrid<VoxelType> &DenseGrid<VoxelType>::Clear() {
     return *this;
 }
 
-template<class VoxelType>
-bool DenseGrid<VoxelType>::IsEmpty() const { return voxels_.empty(); }
+template<class VoxelType, class Layout>
+bool DenseGrid<VoxelType, Layout>::IsEmpty() const { return voxels_.empty(); }
 
-template<class VoxelType>
-Eigen::Vector3f DenseGrid<VoxelType>::GetMinBound() const {
+template<class VoxelType, class Layout>
+Eigen::Vector3f DenseGrid<VoxelType, Layout>::GetMinBound() const {
     float len = voxel_size_ * resolution_ * 0.5;
     return origin_ - Eigen::Vector3f::Constant(len);
 }
 
-template<class VoxelType>
-Eigen::Vector3f DenseGrid<VoxelType>::GetMaxBound() const {
+template<class VoxelType, class Layout>
+Eigen::Vector3f DenseGrid<VoxelType, Layout>::GetMaxBound() const {
     float len = voxel_size_ * resolution_ * 0.5;
     return origin_ + Eigen::Vector3f::Constant(len);
 }
 
-template<class VoxelType>
-Eigen::Vector3f DenseGrid<VoxelType>::GetCenter() const {
+template<class VoxelType, class Layout>
+Eigen::Vector3f DenseGrid<VoxelType, Layout>::GetCenter() const {
     return origin_;
 }
 
-template<class VoxelType>
-AxisAlignedBoundingBox DenseGrid<VoxelType>::GetAxisAlignedBoundingBox() const {
+template<class VoxelType, class Layout>
+AxisAlignedBoundingBox DenseGrid<VoxelType, Layout>::GetAxisAlignedBoundingBox() const {
     AxisAlignedBoundingBox box;
     box.min_bound_ = GetMinBound();
     box.max_bound_ = GetMaxBound();
     return box;
 }
 
-template<class VoxelType>
-OrientedBoundingBox DenseGrid<VoxelType>::GetOrientedBoundingBox() const {
+template<class VoxelType, class Layout>
+OrientedBoundingBox DenseGrid<VoxelType, Layout>::GetOrientedBoundingBox() const {
     return OrientedBoundingBox::CreateFromAxisAlignedBoundingBox(
             GetAxisAlignedBoundingBox());
 }
 
-template<class VoxelType>
-DenseGrid<VoxelType> &DenseGrid<VoxelType>::Transform(const Eigen::Matrix4f &transformation) {
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout> &DenseGrid<VoxelType, Layout>::Transform(const Eigen::Matrix4f &transformation) {
     utility::LogError("DenseGrid::Transform is not supported");
     return *this;
 }
 
-template<class VoxelType>
-DenseGrid<VoxelType> &DenseGrid<VoxelType>::Translate(const Eigen::Vector3f &translation,
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout> &DenseGrid<VoxelType, Layout>::Translate(const Eigen::Vector3f &translation,
                                                bool relative) {
     origin_ += translation;
     return *this;
 }
 
-template<class VoxelType>
-DenseGrid<VoxelType> &DenseGrid<VoxelType>::Scale(const float scale, bool center) {
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout> &DenseGrid<VoxelType, Layout>::Scale(const float scale, bool center) {
     voxel_size_ *= scale;
     return *this;
 }
 
-template<class VoxelType>
-DenseGrid<VoxelType> &DenseGrid<VoxelType>::Rotate(const Eigen::Matrix3f &R, bool center) {
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout> &DenseGrid<VoxelType, Layout>::Rotate(const Eigen::Matrix3f &R, bool center) {
     utility::LogError("DenseGrid::Rotate is not supported");
     return *this;
 }
 
-template<class VoxelType>
-DenseGrid<VoxelType> &DenseGrid<VoxelType>::Reconstruct(float voxel_size, int resolution) {
+template<class VoxelType, class Layout>
+DenseGrid<VoxelType, Layout> &DenseGrid<VoxelType, Layout>::Reconstruct(float voxel_size, int resolution) {
     voxel_size_ = voxel_size;
     resolution_ = resolution;
-    voxels_.resize(resolution_ * resolution_ * resolution_, VoxelType());
+    if (voxels_.empty()) {
+        voxels_ = utility::MakeVolumeVector<VoxelType>(Layout::NumStorageVoxels(resolution_));
+    } else {
+        voxels_.resize(Layout::NumStorageVoxels(resolution_), VoxelType());
+    }
     return *this;
 }
 
-template<class VoxelType>
-int DenseGrid<VoxelType>::GetVoxelIndex(const Eigen::Vector3f& point) const {
+template<class VoxelType, class Layout>
+int DenseGrid<VoxelType, Layout>::GetVoxelIndex(const Eigen::Vector3f& point) const {
     Eigen::Vector3f voxel_f = (point - origin_) / voxel_size_;
     int h_res = resolution_ / 2;
     Eigen::Vector3i voxel_idx = (Eigen::floor(voxel_f.array())).matrix().cast<int>() + Eigen::Vector3i::Constant(h_res);
-    int idx = IndexOf(voxel_idx, resolution_);
-    if (idx < 0 || idx >= resolution_ * resolution_ * resolution_) return -1;
-    return idx;
+    if ((voxel_idx.array() < 0).any() || (voxel_idx.array() >= resolution_).any()) return -1;
+    return Layout::StorageIndexOf(voxel_idx, resolution_);
 }
 
-template<class VoxelType>
-thrust::tuple<bool, VoxelType> DenseGrid<VoxelType>::GetVoxel(const Eigen::Vector3f &point) const {
+template<class VoxelType, class Layout>
+thrust::tuple<bool, VoxelType> DenseGrid<VoxelType, Layout>::GetVoxel(const Eigen::Vector3f &point) const {
     auto idx = GetVoxelIndex(point);
     if (idx < 0) return thrust::make_tuple(false, VoxelType());
     VoxelType voxel = voxels_[idx];
     return thrust::make_tuple(true, voxel);
 }
 
+template<class VoxelType, class Layout>
+DenseGridView<VoxelType, Layout> DenseGrid<VoxelType, Layout>::GetView() const {
+    DenseGridView<VoxelType, Layout> view;
+    view.voxels_ = thrust::raw_pointer_cast(voxels_.data());
+    view.voxel_size_ = voxel_size_;
+    view.resolution_ = resolution_;
+    view.origin_ = origin_;
+    return view;
+}
+
+template<class VoxelType, class Layout>
+void DenseGrid<VoxelType, Layout>::GetVoxelIndices(const utility::device_vector<Eigen::Vector3f>& points,
+                                           utility::device_vector<int>& indices) const {
+    indices.resize(points.size());
+    thrust::transform(points.begin(), points.end(), indices.begin(),
+                      view_voxel_index_functor<VoxelType, Layout>(GetView()));
+}
+
+template<class VoxelType, class Layout>
+void DenseGrid<VoxelType, Layout>::GetVoxels(const utility::device_vector<Eigen::Vector3f>& points,
+                                     utility::device_vector<int>& indices,
+                                     utility::device_vector<VoxelType>& voxels) const {
+    GetVoxelIndices(points, indices);
+    voxels.resize(points.size());
+    thrust::transform(indices.begin(), indices.end(), voxels.begin(),
+                      view_voxel_functor<VoxelType, Layout>(GetView()));
+}
+
+template<class VoxelType, class Layout>
+void DenseGrid<VoxelType, Layout>::PrefetchRegion(const Eigen::Vector3f& min_bound,
+                                          const Eigen::Vector3f& max_bound,
+                                          cudaStream_t stream) const {
+    if (voxels_.empty()) return;
+    const DenseGridView<VoxelType, Layout> view = GetView();
+    // The voxels are ordered by x first, shifted by the ring offset, in
+    // slabs of kBrickSize voxels along x.
+    const int i0 = std::max(view.GetGridIndex(min_bound)[0], 0);
+    const int i1 = std::min(view.GetGridIndex(max_bound)[0], resolution_ - 1);
+    const size_t bytes = voxels_.size() * sizeof(VoxelType);
+    if (i0 > i1) {
+        utility::PrefetchManagedRegion(view.voxels_, bytes, 0, 0, stream);
+        return;
+    }
+    const int r0 = (i0 + view.ring_offset_[0]) % resolution_;
+    const int r1 = (i1 + view.ring_offset_[0]) % resolution_;
+    const int s0 = r0 / Layout::kBrickSize;
+    const int s1 = r1 / Layout::kBrickSize;
+    const int n_slabs = (resolution_ + Layout::kBrickSize - 1) / Layout::kBrickSize;
+    const size_t slab_bytes = bytes / n_slabs;
+    if (r0 <= r1) {
+        utility::PrefetchManagedRegion(view.voxels_, bytes, s0 * slab_bytes,
+                                       (s1 + 1) * slab_bytes, stream);
+    } else {
+        // The region wraps around the ring, keep it all resident.
+        utility::PrefetchManagedRegion(view.voxels_, bytes, 0, bytes, stream);
+    }
+}
+
+}
 }
-}
\ No newline at end of file
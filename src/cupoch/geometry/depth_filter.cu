@@ -0,0 +1,208 @@
+#include "cupoch/geometry/depth_filter.h"
+#include "cupoch/geometry/image_view.h"
+#include "cupoch/utility/console.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct truncate_depth_functor {
+    truncate_depth_functor(ImageView<float> depth,
+                           float min_depth,
+                           float max_depth)
+        : depth_(depth), min_depth_(min_depth), max_depth_(max_depth){};
+    const ImageView<float> depth_;
+    const float min_depth_;
+    const float max_depth_;
+    __device__ void operator()(size_t idx) {
+        float &d = depth_.At(idx % depth_.width_, idx / depth_.width_);
+        // Also catches NaN.
+        if (!(d > 0.0f && d >= min_depth_ && d <= max_depth_)) d = 0.0f;
+    }
+};
+
+struct remove_flying_pixels_functor {
+    remove_flying_pixels_functor(ImageView<const float> src,
+                                 float threshold,
+                                 ImageView<float> dst)
+        : src_(src), threshold_(threshold), dst_(dst){};
+    const ImageView<const float> src_;
+    const float threshold_;
+    const ImageView<float> dst_;
+    /// Whether the neighbor (u, v) is invalid or beyond the discontinuity
+    /// threshold; the pixels out of the image are not.
+    __device__ bool IsFar(int u, int v, float d) const {
+        if (u < 0 || u >= src_.width_ || v < 0 || v >= src_.height_) {
+            return false;
+        }
+        const float dq = src_.At(u, v);
+        return dq <= 0.0f || fabsf(dq - d) > threshold_ * d;
+    }
+    __device__ void operator()(size_t idx) {
+        const int y = idx / src_.width_;
+        const int x = idx % src_.width_;
+        const float d = src_.At(x, y);
+        const bool flying =
+                d > 0.0f &&
+                ((IsFar(x - 1, y, d) && IsFar(x + 1, y, d)) ||
+                 (IsFar(x, y - 1, d) && IsFar(x, y + 1, d)));
+        dst_.At(x, y) = flying ? 0.0f : d;
+    }
+};
+
+/// Average of the current depth and of the previous depths close to it,
+/// then the current depth is written over the oldest frame.
+struct temporal_filter_functor {
+    temporal_filter_functor(ImageView<float> depth,
+                            float *history,
+                            int window,
+                            int history_size,
+                            int history_head,
+                            float delta,
+                            bool persistence)
+        : depth_(depth),
+          history_(history),
+          frame_size_(depth.width_ * depth.height_),
+          window_(window),
+          history_size_(history_size),
+          history_head_(history_head),
+          delta_(delta),
+          persistence_(persistence){};
+    const ImageView<float> depth_;
+    float *history_;
+    const size_t frame_size_;
+    const int window_;
+    const int history_size_;
+    const int history_head_;
+    const float delta_;
+    const bool persistence_;
+    __device__ void operator()(size_t idx) {
+        const int x = idx % depth_.width_;
+        const int y = idx / depth_.width_;
+        float &d = depth_.At(x, y);
+        const float input = d;
+        float sum = input;
+        int n = 1;
+        float latest = 0.0f;
+        // From the newest frame to the oldest one.
+        for (int k = 0; k < history_size_; ++k) {
+            const int slot = (history_head_ - 1 - k + window_) % window_;
+            const float h = history_[slot * frame_size_ + idx];
+            if (h <= 0.0f) continue;
+            if (latest == 0.0f) latest = h;
+            if (input > 0.0f && fabsf(h - input) <= delta_) {
+                sum += h;
+                ++n;
+            }
+        }
+        if (input > 0.0f) {
+            d = sum / n;
+        } else if (persistence_) {
+            d = latest;
+        }
+        history_[history_head_ * frame_size_ + idx] = input;
+    }
+};
+
+struct fill_holes_functor {
+    fill_holes_functor(ImageView<const float> src,
+                       int radius,
+                       bool farthest,
+                       ImageView<float> dst)
+        : src_(src), radius_(radius), farthest_(farthest), dst_(dst){};
+    const ImageView<const float> src_;
+    const int radius_;
+    const bool farthest_;
+    const ImageView<float> dst_;
+    __device__ void operator()(size_t idx) {
+        const int y = idx / src_.width_;
+        const int x = idx % src_.width_;
+        float d = src_.At(x, y);
+        if (d <= 0.0f) {
+            for (int j = max(y - radius_, 0);
+                 j <= min(y + radius_, src_.height_ - 1); ++j) {
+                for (int i = max(x - radius_, 0);
+                     i <= min(x + radius_, src_.width_ - 1); ++i) {
+                    const float dq = src_.At(i, j);
+                    if (dq <= 0.0f) continue;
+                    if (d <= 0.0f || (farthest_ ? dq > d : dq < d)) d = dq;
+                }
+            }
+        }
+        dst_.At(x, y) = d;
+    }
+};
+
+}  // namespace
+
+DepthFilter::DepthFilter(const DepthFilterOption &option) : option_(option) {}
+
+DepthFilter::~DepthFilter() {}
+
+void DepthFilter::Reset() {
+    history_size_ = 0;
+    history_head_ = 0;
+}
+
+void DepthFilter::Process(Image &depth) {
+    if (depth.num_of_channels_ != 1 || depth.bytes_per_channel_ != 4) {
+        utility::LogError("[DepthFilter] Unsupported image format.");
+    }
+    if (depth.width_ != width_ || depth.height_ != height_) {
+        width_ = depth.width_;
+        height_ = depth.height_;
+        Reset();
+    }
+    const size_t n_pixels = (size_t)width_ * height_;
+    if (n_pixels == 0) return;
+    const auto range = thrust::make_counting_iterator<size_t>(0);
+    // Every stage but the truncation and the temporal smoothing reads the
+    // depth and writes buffer_, which is then swapped with it.
+    buffer_.Prepare(width_, height_, 1, 4);
+
+    truncate_depth_functor truncate_func(MakeImageView<float>(depth),
+                                         option_.min_depth_,
+                                         option_.max_depth_);
+    thrust::for_each(range, range + n_pixels, truncate_func);
+
+    if (option_.flying_pixel_threshold_ > 0.0) {
+        remove_flying_pixels_functor func(
+                MakeImageView<float>((const Image &)depth),
+                option_.flying_pixel_threshold_, MakeImageView<float>(buffer_));
+        thrust::for_each(range, range + n_pixels, func);
+        depth.data_.swap(buffer_.data_);
+    }
+
+    if (option_.spatial_half_kernel_size_ > 0) {
+        depth.BilateralFilter(option_.spatial_half_kernel_size_,
+                              option_.spatial_sigma_space_,
+                              option_.spatial_sigma_depth_, buffer_);
+        depth.data_.swap(buffer_.data_);
+    }
+
+    if (option_.temporal_window_ > 0) {
+        history_.resize(option_.temporal_window_ * n_pixels);
+        temporal_filter_functor func(
+                MakeImageView<float>(depth),
+                thrust::raw_pointer_cast(history_.data()),
+                option_.temporal_window_, history_size_, history_head_,
+                option_.temporal_delta_, option_.temporal_persistence_);
+        thrust::for_each(range, range + n_pixels, func);
+        history_head_ = (history_head_ + 1) % option_.temporal_window_;
+        history_size_ = std::min(history_size_ + 1, option_.temporal_window_);
+    }
+
+    if (option_.hole_filling_mode_ !=
+                DepthFilterOption::HoleFillingMode::Disabled &&
+        option_.hole_filling_radius_ > 0) {
+        fill_holes_functor func(
+                MakeImageView<float>((const Image &)depth),
+                option_.hole_filling_radius_,
+                option_.hole_filling_mode_ ==
+                        DepthFilterOption::HoleFillingMode::FarthestFromAround,
+                MakeImageView<float>(buffer_));
+        thrust::for_each(range, range + n_pixels, func);
+        depth.data_.swap(buffer_.data_);
+    }
+}
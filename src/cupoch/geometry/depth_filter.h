@@ -0,0 +1,111 @@
+#pragma once
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class DepthFilterOption {
+public:
+    /// \enum HoleFillingMode
+    ///
+    /// \brief Value given to the invalid pixels by the hole filling.
+    enum class HoleFillingMode {
+        /// No hole filling.
+        Disabled = 0,
+        /// Farthest valid depth around the hole, which extends the
+        /// background rather than the objects in front of it.
+        FarthestFromAround = 1,
+        /// Nearest valid depth around the hole.
+        NearestFromAround = 2,
+    };
+
+    DepthFilterOption(float min_depth = 0.0,
+                      float max_depth = 4.0,
+                      float flying_pixel_threshold = 0.05,
+                      int spatial_half_kernel_size = 2,
+                      float spatial_sigma_space = 2.0,
+                      float spatial_sigma_depth = 0.02,
+                      int temporal_window = 3,
+                      float temporal_delta = 0.02,
+                      bool temporal_persistence = false,
+                      HoleFillingMode hole_filling_mode =
+                              HoleFillingMode::Disabled,
+                      int hole_filling_radius = 1)
+        : min_depth_(min_depth),
+          max_depth_(max_depth),
+          flying_pixel_threshold_(flying_pixel_threshold),
+          spatial_half_kernel_size_(spatial_half_kernel_size),
+          spatial_sigma_space_(spatial_sigma_space),
+          spatial_sigma_depth_(spatial_sigma_depth),
+          temporal_window_(temporal_window),
+          temporal_delta_(temporal_delta),
+          temporal_persistence_(temporal_persistence),
+          hole_filling_mode_(hole_filling_mode),
+          hole_filling_radius_(hole_filling_radius) {}
+    ~DepthFilterOption() {}
+
+public:
+    /// Depths out of [min_depth_, max_depth_] are invalidated.
+    float min_depth_;
+    float max_depth_;
+    /// A pixel is a flying pixel when both of its neighbors along a row or
+    /// a column are farther than this ratio of its depth. 0 disables.
+    float flying_pixel_threshold_;
+    /// Edge-aware smoothing: Image::BilateralFilter of these parameters.
+    /// 0 disables.
+    int spatial_half_kernel_size_;
+    float spatial_sigma_space_;
+    float spatial_sigma_depth_;
+    /// Number of previous frames averaged with the current one. 0 disables.
+    int temporal_window_;
+    /// Previous depths farther than this from the current depth are left
+    /// out of the average, so that moving edges are not smeared.
+    float temporal_delta_;
+    /// Whether the invalid pixels take the last valid depth of the window.
+    bool temporal_persistence_;
+    HoleFillingMode hole_filling_mode_;
+    /// Half size of the window searched by the hole filling.
+    int hole_filling_radius_;
+};
+
+/// \class DepthFilter
+///
+/// \brief Preprocessing of a stream of float depth images of one size.
+///
+/// Process() runs, in place, the truncation to the depth range, the
+/// removal of the flying pixels on the depth discontinuities, the
+/// edge-aware smoothing, the temporal smoothing over a ring buffer of the
+/// previous frames and the hole filling. The invalid pixels are zero on
+/// output, as expected by PointCloud::CreateFromDepthImage; NaN inputs are
+/// invalid as well. 16 bit depth images are converted first with
+/// Image::ConvertDepthToFloatImage. The buffers are kept from one frame to
+/// the next, and the history is reset when the size of the frames changes.
+class DepthFilter {
+public:
+    DepthFilter(const DepthFilterOption &option = DepthFilterOption());
+    ~DepthFilter();
+
+    /// Filters \p depth, a single channel float image, in place.
+    void Process(Image &depth);
+    /// Forgets the previous frames.
+    void Reset();
+    /// Number of frames in the ring buffer.
+    int GetHistorySize() const { return history_size_; }
+    const DepthFilterOption &GetOption() const { return option_; }
+
+private:
+    DepthFilterOption option_;
+    Image buffer_;
+    /// temporal_window_ previous frames, inputs of the temporal smoothing.
+    utility::device_vector<float> history_;
+    int history_size_ = 0;
+    /// Slot of the next frame in history_.
+    int history_head_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -23,6 +23,13 @@ __host__ __device__ inline float PointAABBSquared(
         const Eigen::Vector3f &min_bound,
         const Eigen::Vector3f &max_bound);
 
+/// Point of the triangle (vert0, vert1, vert2) closest to \p p.
+__host__ __device__ inline Eigen::Vector3f ClosestPointTriangle(
+        const Eigen::Vector3f &p,
+        const Eigen::Vector3f &vert0,
+        const Eigen::Vector3f &vert1,
+        const Eigen::Vector3f &vert2);
+
 }  // namespace distance_test
 
 }  // namespace geometry
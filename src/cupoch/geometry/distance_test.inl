@@ -36,6 +36,39 @@ float PointAABBSquared(const Eigen::Vector3f &p,
     return dist2;
 }
 
+Eigen::Vector3f ClosestPointTriangle(const Eigen::Vector3f &p,
+                                     const Eigen::Vector3f &vert0,
+                                     const Eigen::Vector3f &vert1,
+                                     const Eigen::Vector3f &vert2) {
+    // Voronoi regions of the vertices, the edges and the face, as Ericson,
+    // "Real-Time Collision Detection" 5.1.5.
+    const Eigen::Vector3f ab = vert1 - vert0;
+    const Eigen::Vector3f ac = vert2 - vert0;
+    const Eigen::Vector3f ap = p - vert0;
+    const float d1 = ab.dot(ap);
+    const float d2 = ac.dot(ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return vert0;
+    const Eigen::Vector3f bp = p - vert1;
+    const float d3 = ab.dot(bp);
+    const float d4 = ac.dot(bp);
+    if (d3 >= 0.0f && d4 <= d3) return vert1;
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return vert0 + d1 / (d1 - d3) * ab;
+    const Eigen::Vector3f cp = p - vert2;
+    const float d5 = ab.dot(cp);
+    const float d6 = ac.dot(cp);
+    if (d6 >= 0.0f && d5 <= d6) return vert2;
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return vert0 + d2 / (d2 - d6) * ac;
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return vert1 + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (vert2 - vert1);
+    }
+    const float denom = va + vb + vc;
+    if (denom == 0.0f) return vert0;
+    return vert0 + ab * (vb / denom) + ac * (vc / denom);
+}
+
 }  // namespace distance_test
 
 }  // namespace geometry
@@ -1,9 +1,15 @@
 #include "cupoch/geometry/distancetransform.h"
 #include "cupoch/geometry/densegrid.inl"
 #include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/graph.h"
+#include "cupoch/geometry/occupancygrid.h"
 #include "cupoch/geometry/voxelgrid.h"
 
+#include <thrust/iterator/transform_iterator.h>
+
+#include "cupoch/utility/launch_tuner.h"
 #include "cupoch/utility/platform.h"
+#include "cupoch/utility/texture3d.h"
 
 #define BLOCKSIZE 8
 
@@ -181,7 +187,7 @@ struct compute_distance_functor {
         int yz = idx % (resolution_ * resolution_);
         int y = yz / resolution_;
         int z = yz % resolution_;
-        auto diff = voxels_[idx].nearest_index_ - Eigen::Vector3ui16(x, y, z);
+        auto diff = voxels_[idx].nearest_index_.cast<float>() - Eigen::Vector3f(x, y, z);
         voxels_[idx].distance_ = diff.norm();
     }
 };
@@ -202,6 +208,408 @@ struct compute_obstacle_cells_functor {
     };
 };
 
+__host__ __device__ DistanceVoxel ClearedVoxel(float distance = std::numeric_limits<float>::infinity()) {
+    DistanceVoxel v(Eigen::Vector3ui16::Zero(), DistanceVoxel::NotSite);
+    v.distance_ = distance;
+    return v;
+}
+
+__device__ bool IsSiteOf(const DistanceVoxel& v, const Eigen::Vector3ui16& idxs) {
+    return !v.IsNotSite() && v.nearest_index_ == idxs;
+}
+
+__device__ bool IsInside(const Eigen::Vector3i& idxs, int resolution) {
+    return !Eigen::device_any(idxs.array() < 0) && !Eigen::device_any(idxs.array() >= resolution);
+}
+
+struct remove_sites_functor {
+    remove_sites_functor(DistanceVoxel* voxels, int resolution, float cleared_distance)
+    : voxels_(voxels), resolution_(resolution), cleared_distance_(cleared_distance) {};
+    DistanceVoxel* voxels_;
+    const int resolution_;
+    const float cleared_distance_;
+    __device__ int operator() (const Eigen::Vector3i& idxs) {
+        if (!IsInside(idxs, resolution_)) return -1;
+        int i = IndexOf(idxs, resolution_);
+        if (!IsSiteOf(voxels_[i], idxs.cast<unsigned short>())) return -1;
+        voxels_[i] = ClearedVoxel(cleared_distance_);
+        return i;
+    }
+};
+
+struct add_sites_functor {
+    add_sites_functor(DistanceVoxel* voxels, int resolution)
+    : voxels_(voxels), resolution_(resolution) {};
+    DistanceVoxel* voxels_;
+    const int resolution_;
+    __device__ int operator() (const Eigen::Vector3i& idxs) {
+        if (!IsInside(idxs, resolution_)) return -1;
+        int i = IndexOf(idxs, resolution_);
+        if (IsSiteOf(voxels_[i], idxs.cast<unsigned short>())) return -1;
+        DistanceVoxel v(idxs.cast<unsigned short>(), 0);
+        v.distance_ = 0;
+        voxels_[i] = v;
+        return i;
+    }
+};
+
+struct expand_neighbors_functor {
+    expand_neighbors_functor(const int* cells, int* neighbors, int resolution)
+    : cells_(cells), neighbors_(neighbors), resolution_(resolution) {};
+    const int* cells_;
+    int* neighbors_;
+    const int resolution_;
+    __device__ void operator() (size_t idx) {
+        int c = cells_[idx];
+        int x = c / (resolution_ * resolution_);
+        int y = (c / resolution_) % resolution_;
+        int z = c % resolution_;
+        int n = 0;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    if (dx == 0 && dy == 0 && dz == 0) continue;
+                    Eigen::Vector3i nb(x + dx, y + dy, z + dz);
+                    neighbors_[idx * 26 + n++] = IsInside(nb, resolution_) ? IndexOf(nb, resolution_) : -1;
+                }
+            }
+        }
+    }
+};
+
+/// Clears the cell if its nearest site is not a site any more. The cells
+/// are unique and the sites are not written, so the update is in place.
+struct raise_functor {
+    raise_functor(DistanceVoxel* voxels, int resolution, float cleared_distance)
+    : voxels_(voxels), resolution_(resolution), cleared_distance_(cleared_distance) {};
+    DistanceVoxel* voxels_;
+    const int resolution_;
+    const float cleared_distance_;
+    __device__ int operator() (int c) {
+        const DistanceVoxel v = voxels_[c];
+        if (v.IsNotSite()) return -1;
+        const Eigen::Vector3ui16& s = v.nearest_index_;
+        if (IsSiteOf(voxels_[IndexOf(s[0], s[1], s[2], resolution_)], s)) return -1;
+        voxels_[c] = ClearedVoxel(cleared_distance_);
+        return c;
+    }
+};
+
+/// Pulls the nearest site of the 26 neighbors of the cell, ignoring the
+/// sites farther than max_distance. The results go to a buffer so that the
+/// neighbors are read before any of them is updated.
+struct lower_functor {
+    lower_functor(const DistanceVoxel* voxels, const int* cells,
+                  DistanceVoxel* next, int* changed, int resolution, float max_distance)
+    : voxels_(voxels), cells_(cells), next_(next), changed_(changed), resolution_(resolution),
+      max_distance_(max_distance) {};
+    const DistanceVoxel* voxels_;
+    const int* cells_;
+    DistanceVoxel* next_;
+    int* changed_;
+    const int resolution_;
+    const float max_distance_;
+    __device__ void operator() (size_t idx) {
+        int c = cells_[idx];
+        Eigen::Vector3i xyz(c / (resolution_ * resolution_),
+                            (c / resolution_) % resolution_,
+                            c % resolution_);
+        DistanceVoxel best = voxels_[c];
+        float best_dist = best.IsNotSite() ? std::numeric_limits<float>::infinity() : best.distance_;
+        bool is_changed = false;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    Eigen::Vector3i nb = xyz + Eigen::Vector3i(dx, dy, dz);
+                    if (!IsInside(nb, resolution_)) continue;
+                    const DistanceVoxel& nv = voxels_[IndexOf(nb, resolution_)];
+                    if (nv.IsNotSite()) continue;
+                    float dist = (nv.nearest_index_.cast<float>() - xyz.cast<float>()).norm();
+                    if (dist < best_dist && dist <= max_distance_) {
+                        best_dist = dist;
+                        best.nearest_index_ = nv.nearest_index_;
+                        is_changed = true;
+                    }
+                }
+            }
+        }
+        best.state_ = 0;
+        best.distance_ = best_dist;
+        next_[idx] = best;
+        changed_[idx] = (is_changed) ? c : -1;
+    }
+};
+
+struct apply_lower_functor {
+    apply_lower_functor(DistanceVoxel* voxels, const DistanceVoxel* next, const int* changed)
+    : voxels_(voxels), next_(next), changed_(changed) {};
+    DistanceVoxel* voxels_;
+    const DistanceVoxel* next_;
+    const int* changed_;
+    __device__ void operator() (size_t idx) {
+        if (changed_[idx] >= 0) voxels_[changed_[idx]] = next_[idx];
+    }
+};
+
+struct set_occupancy_sites_functor {
+    set_occupancy_sites_functor(const CompactOccupancyVoxel* occupancy,
+                                DistanceVoxel* voxels,
+                                const Eigen::Vector3i& ring_offset,
+                                int resolution, int16_t occ_prob_thres_log,
+                                bool free_sites)
+    : occupancy_(occupancy), voxels_(voxels), ring_offset_(ring_offset),
+      resolution_(resolution), occ_prob_thres_log_(occ_prob_thres_log),
+      free_sites_(free_sites) {};
+    const CompactOccupancyVoxel* occupancy_;
+    DistanceVoxel* voxels_;
+    const Eigen::Vector3i ring_offset_;
+    const int resolution_;
+    const int16_t occ_prob_thres_log_;
+    const bool free_sites_;
+    __device__ void operator() (size_t idx) {
+        Eigen::Vector3i xyz(idx / (resolution_ * resolution_),
+                            (idx / resolution_) % resolution_,
+                            idx % resolution_);
+        // Storage index in the circular buffer, see OccupancyGrid::ring_offset_.
+        Eigen::Vector3i v = xyz + ring_offset_;
+        for (int i = 0; i < 3; ++i) {
+            if (v[i] >= resolution_) v[i] -= resolution_;
+        }
+        const CompactOccupancyVoxel& ov = occupancy_[OccupancyGrid::LayoutType::StorageIndexOf(v, resolution_)];
+        bool occupied = !ov.IsUnknown() && ov.prob_log_q_ > occ_prob_thres_log_;
+        voxels_[idx] = (occupied != free_sites_) ? DistanceVoxel(xyz.cast<unsigned short>(), 0) : DistanceVoxel();
+    }
+};
+
+struct extract_distance_functor {
+    __device__ float operator() (const DistanceVoxel& v) const { return v.distance_; }
+};
+
+struct subtract_distance_functor {
+    __device__ DistanceVoxel operator() (const DistanceVoxel& v, float inside) const {
+        DistanceVoxel out = v;
+        out.distance_ -= inside;
+        return out;
+    }
+};
+
+struct interpolate_distance_functor {
+    interpolate_distance_functor(const DistanceVoxel* voxels, float voxel_size,
+                                 int resolution, const Eigen::Vector3f& origin,
+                                 float* distances, Eigen::Vector3f* gradients)
+    : voxels_(voxels), voxel_size_(voxel_size), resolution_(resolution),
+      origin_(origin), distances_(distances), gradients_(gradients) {};
+    const DistanceVoxel* voxels_;
+    const float voxel_size_;
+    const int resolution_;
+    const Eigen::Vector3f origin_;
+    float* distances_;
+    Eigen::Vector3f* gradients_;
+    __device__ void operator() (const thrust::tuple<size_t, Eigen::Vector3f>& x) const {
+        const size_t idx = thrust::get<0>(x);
+        // Continuous grid coordinates, the voxel centers at integers.
+        const Eigen::Vector3f u = (thrust::get<1>(x) - origin_) / voxel_size_ +
+                                  Eigen::Vector3f::Constant(resolution_ / 2 - 0.5f);
+        int i0[3];
+        int i1[3];
+        float t[3];
+        bool clamped[3];
+        for (int i = 0; i < 3; ++i) {
+            float f = floorf(u[i]);
+            i0[i] = (int)f;
+            t[i] = u[i] - f;
+            clamped[i] = i0[i] < 0 || i0[i] >= resolution_ - 1;
+            i0[i] = min(max(i0[i], 0), resolution_ - 1);
+            i1[i] = min(i0[i] + 1, resolution_ - 1);
+            if (clamped[i]) t[i] = 0.0f;
+        }
+        float c[2][2][2];
+        for (int a = 0; a < 2; ++a) {
+            for (int b = 0; b < 2; ++b) {
+                for (int d = 0; d < 2; ++d) {
+                    c[a][b][d] = voxels_[IndexOf(a ? i1[0] : i0[0], b ? i1[1] : i0[1],
+                                                 d ? i1[2] : i0[2], resolution_)].distance_;
+                }
+            }
+        }
+        // Interpolation along z, then y, then x.
+        float c00 = c[0][0][0] * (1 - t[2]) + c[0][0][1] * t[2];
+        float c01 = c[0][1][0] * (1 - t[2]) + c[0][1][1] * t[2];
+        float c10 = c[1][0][0] * (1 - t[2]) + c[1][0][1] * t[2];
+        float c11 = c[1][1][0] * (1 - t[2]) + c[1][1][1] * t[2];
+        float c0 = c00 * (1 - t[1]) + c01 * t[1];
+        float c1 = c10 * (1 - t[1]) + c11 * t[1];
+        distances_[idx] = (c0 * (1 - t[0]) + c1 * t[0]) * voxel_size_;
+        if (gradients_ == NULL) return;
+        Eigen::Vector3f g;
+        g[0] = c1 - c0;
+        g[1] = (c01 - c00) * (1 - t[0]) + (c11 - c10) * t[0];
+        float dz00 = c[0][0][1] - c[0][0][0];
+        float dz01 = c[0][1][1] - c[0][1][0];
+        float dz10 = c[1][0][1] - c[1][0][0];
+        float dz11 = c[1][1][1] - c[1][1][0];
+        g[2] = (dz00 * (1 - t[1]) + dz01 * t[1]) * (1 - t[0]) +
+               (dz10 * (1 - t[1]) + dz11 * t[1]) * t[0];
+        for (int i = 0; i < 3; ++i) {
+            if (clamped[i]) g[i] = 0.0f;
+        }
+        // The distances are in voxels, so the gradient is dimensionless.
+        gradients_[idx] = g;
+    }
+};
+
+struct texture_distance_functor {
+    texture_distance_functor(cudaTextureObject_t texture, float voxel_size,
+                             int resolution, const Eigen::Vector3f& origin,
+                             float* distances, Eigen::Vector3f* gradients)
+    : texture_(texture), voxel_size_(voxel_size), resolution_(resolution),
+      origin_(origin), distances_(distances), gradients_(gradients) {};
+    const cudaTextureObject_t texture_;
+    const float voxel_size_;
+    const int resolution_;
+    const Eigen::Vector3f origin_;
+    float* distances_;
+    Eigen::Vector3f* gradients_;
+    __device__ float Fetch(const Eigen::Vector3f& u) const {
+        return tex3D<float>(texture_, u[2], u[1], u[0]);
+    }
+    __device__ void operator() (const thrust::tuple<size_t, Eigen::Vector3f>& x) const {
+        const size_t idx = thrust::get<0>(x);
+        // Texture coordinates, the voxel centers at half integers.
+        const Eigen::Vector3f u = (thrust::get<1>(x) - origin_) / voxel_size_ +
+                                  Eigen::Vector3f::Constant(resolution_ / 2);
+        distances_[idx] = Fetch(u);
+        if (gradients_ == NULL) return;
+        Eigen::Vector3f g;
+        for (int i = 0; i < 3; ++i) {
+            Eigen::Vector3f h = Eigen::Vector3f::Zero();
+            h[i] = 0.5f;
+            g[i] = (Fetch(u + h) - Fetch(u - h)) / voxel_size_;
+        }
+        gradients_[idx] = g;
+    }
+};
+
+struct scaled_distance_functor {
+    scaled_distance_functor(float voxel_size) : voxel_size_(voxel_size) {};
+    const float voxel_size_;
+    __device__ float operator() (const DistanceVoxel& v) const { return v.distance_ * voxel_size_; }
+};
+
+void RemoveInvalidCells(utility::device_vector<int>& cells) {
+    cells.erase(thrust::remove(cells.begin(), cells.end(), -1), cells.end());
+}
+
+utility::device_vector<int> ExpandNeighbors(const utility::device_vector<int>& cells, int resolution) {
+    utility::device_vector<int> neighbors(cells.size() * 26);
+    expand_neighbors_functor func(thrust::raw_pointer_cast(cells.data()),
+                                  thrust::raw_pointer_cast(neighbors.data()),
+                                  resolution);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(cells.size()), func);
+    RemoveInvalidCells(neighbors);
+    thrust::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(thrust::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    return neighbors;
+}
+
+// A free voxel is on the skeleton if a face neighbor has a nearest site
+// farther than min_separation2 from its own, i.e. the two sites belong to
+// different obstacles or to distant parts of one, and it is at least as
+// far from its site as the neighbor, so that the skeleton is one voxel
+// thick on each side of the bisector.
+struct is_skeleton_voxel_functor {
+    is_skeleton_voxel_functor(const DistanceVoxel* voxels, int resolution,
+                              float min_clearance2, int min_separation2)
+    : voxels_(voxels), resolution_(resolution),
+    min_clearance2_(min_clearance2), min_separation2_(min_separation2) {};
+    const DistanceVoxel* voxels_;
+    const int resolution_;
+    const float min_clearance2_;
+    const int min_separation2_;
+    __device__ bool HasSite(const DistanceVoxel& v) const {
+        return !voxels_[IndexOf(v.nearest_index_.cast<int>(), resolution_)].IsNotSite();
+    }
+    __device__ bool operator() (size_t idx) const {
+        const DistanceVoxel& v = voxels_[idx];
+        if (!v.IsNotSite() || !HasSite(v)) return false;
+        const int x = idx / (resolution_ * resolution_);
+        const int yz = idx % (resolution_ * resolution_);
+        const Eigen::Vector3i p(x, yz / resolution_, yz % resolution_);
+        const Eigen::Vector3i s = v.nearest_index_.cast<int>();
+        const int d2 = (s - p).squaredNorm();
+        if (d2 < min_clearance2_) return false;
+        for (int i = 0; i < 6; ++i) {
+            Eigen::Vector3i q = p;
+            q[i / 2] += (i % 2 == 0) ? 1 : -1;
+            if (!IsInside(q, resolution_)) continue;
+            const DistanceVoxel& w = voxels_[IndexOf(q, resolution_)];
+            if (!w.IsNotSite() || !HasSite(w)) continue;
+            const Eigen::Vector3i t = w.nearest_index_.cast<int>();
+            if ((t - s).squaredNorm() > min_separation2_ && d2 >= (t - q).squaredNorm()) return true;
+        }
+        return false;
+    }
+};
+
+struct grid_to_linear_index_functor {
+    grid_to_linear_index_functor(int resolution) : resolution_(resolution) {};
+    const int resolution_;
+    __device__ int operator() (const Eigen::Vector3i& idxs) const { return IndexOf(idxs, resolution_); }
+};
+
+struct linear_index_to_grid_functor {
+    linear_index_to_grid_functor(int resolution) : resolution_(resolution) {};
+    const int resolution_;
+    __device__ Eigen::Vector3i operator() (int idx) const {
+        const int yz = idx % (resolution_ * resolution_);
+        return Eigen::Vector3i(idx / (resolution_ * resolution_), yz / resolution_, yz % resolution_);
+    }
+};
+
+struct grid_to_point_functor {
+    grid_to_point_functor(float voxel_size, int resolution, const Eigen::Vector3f& origin)
+    : voxel_size_(voxel_size), resolution_(resolution), origin_(origin) {};
+    const float voxel_size_;
+    const int resolution_;
+    const Eigen::Vector3f origin_;
+    __device__ Eigen::Vector3f operator() (const Eigen::Vector3i& idxs) const {
+        return origin_ + (idxs.cast<float>() - Eigen::Vector3f::Constant(resolution_ / 2 - 0.5f)) * voxel_size_;
+    }
+};
+
+// Edges to the skeleton voxels among the 13 neighbors of larger linear index
+// in the 26 neighborhood, so that each edge is generated once.
+struct skeleton_edges_functor {
+    skeleton_edges_functor(const Eigen::Vector3i* nodes, const int* node_of_voxel, int resolution,
+                           float voxel_size, Eigen::Vector2i* edges, float* weights)
+    : nodes_(nodes), node_of_voxel_(node_of_voxel), resolution_(resolution),
+    voxel_size_(voxel_size), edges_(edges), weights_(weights) {};
+    const Eigen::Vector3i* nodes_;
+    const int* node_of_voxel_;
+    const int resolution_;
+    const float voxel_size_;
+    Eigen::Vector2i* edges_;
+    float* weights_;
+    __device__ void operator() (size_t idx) const {
+        const Eigen::Vector3i& p = nodes_[idx];
+        int k = 0;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const int code = (dx * 3 + dy) * 3 + dz;
+                    if (code <= 0) continue;
+                    const Eigen::Vector3i q = p + Eigen::Vector3i(dx, dy, dz);
+                    const int j = IsInside(q, resolution_) ? node_of_voxel_[IndexOf(q, resolution_)] : -1;
+                    edges_[idx * 13 + k] = (j < 0) ? Eigen::Vector2i(-1, -1) : Eigen::Vector2i(idx, j);
+                    weights_[idx * 13 + k] = sqrtf(dx * dx + dy * dy + dz * dz) * voxel_size_;
+                    ++k;
+                }
+            }
+        }
+    }
+};
+
 }
 
 template class DenseGrid<DistanceVoxel>;
@@ -246,7 +654,10 @@ DistanceTransform &DistanceTransform::ComputeEDT(const VoxelGrid& voxelgrid) {
 DistanceTransform &DistanceTransform::ComputeVoronoiDiagram(const utility::device_vector<Eigen::Vector3i>& points) {
     set_points_functor func0(thrust::raw_pointer_cast(buffer_.data()), resolution_);
     thrust::for_each(points.begin(), points.end(), func0);
+    return ComputeVoronoiDiagramOfSites();
+}
 
+DistanceTransform &DistanceTransform::ComputeVoronoiDiagramOfSites() {
     flood_z_functor func1(thrust::raw_pointer_cast(buffer_.data()),
                           thrust::raw_pointer_cast(voxels_.data()),
                           resolution_);
@@ -254,27 +665,25 @@ DistanceTransform &DistanceTransform::ComputeVoronoiDiagram(const utility::devic
                               thrust::raw_pointer_cast(buffer_.data()),
                               resolution_);
 
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator<size_t>(resolution_ * resolution_), func1);
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator<size_t>(resolution_ * resolution_), func2);
+    const size_t n_columns = (size_t)resolution_ * resolution_;
+    utility::TunedForEach("DistanceTransform::FloodZ", n_columns, func1);
+    utility::TunedForEach("DistanceTransform::MaurerAxis", n_columns, func2);
 
     dim3 block1 = dim3(BLOCKSIZE, 2);
     dim3 grid1 = dim3(resolution_ / block1.x, resolution_);
     color_axis_kernel<<<grid1, block1>>>(thrust::raw_pointer_cast(buffer_.data()),
                                          thrust::raw_pointer_cast(voxels_.data()),
                                          resolution_);
-    cudaSafeCall(cudaDeviceSynchronize());
+    cudaSafeCall(cudaGetLastError());
 
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator<size_t>(resolution_ * resolution_), func2);
+    utility::TunedForEach("DistanceTransform::MaurerAxis", n_columns, func2);
 
     dim3 block2 = dim3(BLOCKSIZE, 2);
     dim3 grid2 = dim3(resolution_ / block2.x, resolution_);
     color_axis_kernel<<<grid2, block2>>>(thrust::raw_pointer_cast(buffer_.data()),
                                          thrust::raw_pointer_cast(voxels_.data()),
                                          resolution_);
-    cudaSafeCall(cudaDeviceSynchronize());
+    cudaSafeCall(cudaStreamSynchronize(0));
     return *this;
 }
 
@@ -289,5 +698,219 @@ DistanceTransform &DistanceTransform::ComputeVoronoiDiagram(const VoxelGrid& vox
     return ComputeVoronoiDiagram(obs_cells);
 }
 
+DistanceTransform &DistanceTransform::ClearEDT(float max_distance) {
+    thrust::fill(voxels_.begin(), voxels_.end(), ClearedVoxel(max_distance / voxel_size_));
+    return *this;
+}
+
+DistanceTransform &DistanceTransform::UpdateEDT(const utility::device_vector<Eigen::Vector3i>& added_points,
+                                                const utility::device_vector<Eigen::Vector3i>& removed_points,
+                                                float max_distance) {
+    const float max_dist = max_distance / voxel_size_;
+    // Raise: clears the cells whose nearest site was removed, outwards from
+    // the removed sites.
+    utility::device_vector<int> frontier(removed_points.size());
+    thrust::transform(removed_points.begin(), removed_points.end(), frontier.begin(),
+                      remove_sites_functor(thrust::raw_pointer_cast(voxels_.data()), resolution_, max_dist));
+    RemoveInvalidCells(frontier);
+    utility::device_vector<int> cleared = frontier;
+    raise_functor raise_func(thrust::raw_pointer_cast(voxels_.data()), resolution_, max_dist);
+    while (!frontier.empty()) {
+        utility::device_vector<int> candidates = ExpandNeighbors(frontier, resolution_);
+        frontier.resize(candidates.size());
+        thrust::transform(candidates.begin(), candidates.end(), frontier.begin(), raise_func);
+        RemoveInvalidCells(frontier);
+        cleared.insert(cleared.end(), frontier.begin(), frontier.end());
+    }
+
+    // Lower: the cleared cells and the neighbors of the added sites pull the
+    // nearest sites of their neighbors, until no cell changes.
+    utility::device_vector<int> added(added_points.size());
+    thrust::transform(added_points.begin(), added_points.end(), added.begin(),
+                      add_sites_functor(thrust::raw_pointer_cast(voxels_.data()), resolution_));
+    RemoveInvalidCells(added);
+    utility::device_vector<int> candidates = ExpandNeighbors(added, resolution_);
+    candidates.insert(candidates.end(), cleared.begin(), cleared.end());
+    thrust::sort(candidates.begin(), candidates.end());
+    candidates.erase(thrust::unique(candidates.begin(), candidates.end()), candidates.end());
+    utility::device_vector<DistanceVoxel> next;
+    utility::device_vector<int> changed;
+    while (!candidates.empty()) {
+        next.resize(candidates.size());
+        changed.resize(candidates.size());
+        lower_functor lower_func(thrust::raw_pointer_cast(voxels_.data()),
+                                 thrust::raw_pointer_cast(candidates.data()),
+                                 thrust::raw_pointer_cast(next.data()),
+                                 thrust::raw_pointer_cast(changed.data()),
+                                 resolution_, max_dist);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(candidates.size()), lower_func);
+        apply_lower_functor apply_func(thrust::raw_pointer_cast(voxels_.data()),
+                                       thrust::raw_pointer_cast(next.data()),
+                                       thrust::raw_pointer_cast(changed.data()));
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(candidates.size()), apply_func);
+        RemoveInvalidCells(changed);
+        candidates = ExpandNeighbors(changed, resolution_);
+    }
+    return *this;
+}
+
+DistanceTransform &DistanceTransform::UpdateEDT(const VoxelGrid& added_voxels,
+                                                const VoxelGrid& removed_voxels) {
+    if (std::abs(voxel_size_ - added_voxels.voxel_size_) > std::numeric_limits<float>::epsilon() ||
+        std::abs(voxel_size_ - removed_voxels.voxel_size_) > std::numeric_limits<float>::epsilon()) {
+        utility::LogError("Unsupport computing Voronoi diagrams from different voxel size.");
+        return *this;
+    }
+    utility::device_vector<Eigen::Vector3i> added_cells(added_voxels.voxels_keys_.size());
+    compute_obstacle_cells_functor func1(voxel_size_, resolution_, added_voxels.origin_, origin_);
+    thrust::transform(added_voxels.voxels_keys_.begin(), added_voxels.voxels_keys_.end(), added_cells.begin(), func1);
+    utility::device_vector<Eigen::Vector3i> removed_cells(removed_voxels.voxels_keys_.size());
+    compute_obstacle_cells_functor func2(voxel_size_, resolution_, removed_voxels.origin_, origin_);
+    thrust::transform(removed_voxels.voxels_keys_.begin(), removed_voxels.voxels_keys_.end(), removed_cells.begin(), func2);
+    return UpdateEDT(added_cells, removed_cells);
+}
+
+DistanceTransform &DistanceTransform::ComputeEDT(const OccupancyGrid& occupancygrid,
+                                                 bool signed_distance) {
+    if (std::abs(voxel_size_ - occupancygrid.voxel_size_) > std::numeric_limits<float>::epsilon() ||
+        resolution_ != occupancygrid.resolution_ ||
+        !origin_.isApprox(occupancygrid.origin_)) {
+        utility::LogError("Unsupport computing EDT from occupancy grid of different geometry.");
+        return *this;
+    }
+    // Same quantized threshold as OccupancyGrid::ExtractOccupiedVoxels().
+    int16_t thres = CompactOccupancyVoxel::Quantize(occupancygrid.occ_prob_thres_log_);
+    if (thres * CompactOccupancyVoxel::kProbLogResolution > occupancygrid.occ_prob_thres_log_) --thres;
+    const size_t n_total = voxels_.size();
+    utility::device_vector<float> inside_distances;
+    if (signed_distance) {
+        set_occupancy_sites_functor func(thrust::raw_pointer_cast(occupancygrid.voxels_.data()),
+                                         thrust::raw_pointer_cast(buffer_.data()),
+                                         occupancygrid.ring_offset_, resolution_, thres, true);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_total), func);
+        ComputeVoronoiDiagramOfSites();
+        compute_distance_functor dfunc(thrust::raw_pointer_cast(voxels_.data()), resolution_);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_total), dfunc);
+        inside_distances.resize(n_total);
+        thrust::transform(voxels_.begin(), voxels_.end(), inside_distances.begin(),
+                          extract_distance_functor());
+    }
+    set_occupancy_sites_functor func(thrust::raw_pointer_cast(occupancygrid.voxels_.data()),
+                                     thrust::raw_pointer_cast(buffer_.data()),
+                                     occupancygrid.ring_offset_, resolution_, thres, false);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_total), func);
+    ComputeVoronoiDiagramOfSites();
+    compute_distance_functor dfunc(thrust::raw_pointer_cast(voxels_.data()), resolution_);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_total), dfunc);
+    if (signed_distance) {
+        thrust::transform(voxels_.begin(), voxels_.end(), inside_distances.begin(),
+                          voxels_.begin(), subtract_distance_functor());
+    }
+    return *this;
+}
+
+utility::device_vector<Eigen::Vector3i> DistanceTransform::ExtractVoronoiSkeleton(float min_clearance,
+                                                                                 float min_site_separation) const {
+    const float min_clearance2 = (min_clearance / voxel_size_) * (min_clearance / voxel_size_);
+    const int min_separation2 = (int)ceilf(min_site_separation * min_site_separation);
+    utility::device_vector<int> cells(voxels_.size());
+    auto end = thrust::copy_if(thrust::make_counting_iterator<int>(0),
+                               thrust::make_counting_iterator<int>(voxels_.size()),
+                               thrust::make_counting_iterator<size_t>(0), cells.begin(),
+                               is_skeleton_voxel_functor(thrust::raw_pointer_cast(voxels_.data()), resolution_,
+                                                         min_clearance2, min_separation2));
+    cells.resize(thrust::distance(cells.begin(), end));
+    utility::device_vector<Eigen::Vector3i> skeleton(cells.size());
+    thrust::transform(cells.begin(), cells.end(), skeleton.begin(), linear_index_to_grid_functor(resolution_));
+    return skeleton;
+}
+
+std::shared_ptr<Graph> DistanceTransform::CreateVoronoiGraph(float min_clearance, float min_site_separation) const {
+    const utility::device_vector<Eigen::Vector3i> nodes = ExtractVoronoiSkeleton(min_clearance, min_site_separation);
+    utility::device_vector<Eigen::Vector3f> points(nodes.size());
+    thrust::transform(nodes.begin(), nodes.end(), points.begin(),
+                      grid_to_point_functor(voxel_size_, resolution_, origin_));
+    auto graph = std::make_shared<Graph>(points);
+    if (nodes.empty()) return graph;
+    utility::device_vector<int> node_of_voxel(voxels_.size(), -1);
+    thrust::scatter(thrust::make_counting_iterator<int>(0), thrust::make_counting_iterator<int>(nodes.size()),
+                    thrust::make_transform_iterator(nodes.begin(), grid_to_linear_index_functor(resolution_)),
+                    node_of_voxel.begin());
+    utility::device_vector<Eigen::Vector2i> edges(nodes.size() * 13);
+    utility::device_vector<float> weights(nodes.size() * 13);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0), thrust::make_counting_iterator(nodes.size()),
+                     skeleton_edges_functor(thrust::raw_pointer_cast(nodes.data()),
+                                            thrust::raw_pointer_cast(node_of_voxel.data()), resolution_,
+                                            voxel_size_, thrust::raw_pointer_cast(edges.data()),
+                                            thrust::raw_pointer_cast(weights.data())));
+    auto remove_fn = [] __device__ (const thrust::tuple<Eigen::Vector2i, float>& x) {
+        return thrust::get<0>(x)[0] < 0;
+    };
+    remove_if_vectors(remove_fn, edges, weights);
+    if (edges.empty()) {
+        graph->edge_index_offsets_.resize(nodes.size() + 1, 0);
+        return graph;
+    }
+    graph->AddEdges(edges, weights);
+    return graph;
+}
+
+DistanceTransform &DistanceTransform::UpdateTexture() {
+    if (!texture_ || texture_->GetResolution() != resolution_) {
+        texture_ = std::make_shared<utility::Texture3D>(resolution_);
+    }
+    utility::device_vector<float> distances(voxels_.size());
+    thrust::transform(voxels_.begin(), voxels_.end(), distances.begin(),
+                      scaled_distance_functor(voxel_size_));
+    texture_->CopyFrom(thrust::raw_pointer_cast(distances.data()));
+    return *this;
+}
+
+void DistanceTransform::GetDistances(const utility::device_vector<Eigen::Vector3f>& points,
+                                     utility::device_vector<float>& distances,
+                                     bool use_texture) const {
+    utility::device_vector<Eigen::Vector3f> gradients;
+    QueryDistances(points, distances, gradients, use_texture, false);
+}
+
+void DistanceTransform::GetDistancesAndGradients(const utility::device_vector<Eigen::Vector3f>& points,
+                                                 utility::device_vector<float>& distances,
+                                                 utility::device_vector<Eigen::Vector3f>& gradients,
+                                                 bool use_texture) const {
+    QueryDistances(points, distances, gradients, use_texture, true);
+}
+
+void DistanceTransform::QueryDistances(const utility::device_vector<Eigen::Vector3f>& points,
+                                       utility::device_vector<float>& distances,
+                                       utility::device_vector<Eigen::Vector3f>& gradients,
+                                       bool use_texture, bool compute_gradients) const {
+    if (use_texture && !texture_) {
+        utility::LogError("[DistanceTransform] UpdateTexture has not been called.");
+        return;
+    }
+    distances.resize(points.size());
+    if (compute_gradients) gradients.resize(points.size());
+    float* distances_ptr = thrust::raw_pointer_cast(distances.data());
+    Eigen::Vector3f* gradients_ptr = (compute_gradients) ? thrust::raw_pointer_cast(gradients.data()) : NULL;
+    auto begin = make_tuple_iterator(thrust::make_counting_iterator<size_t>(0), points.begin());
+    auto end = make_tuple_iterator(thrust::make_counting_iterator(points.size()), points.end());
+    if (use_texture) {
+        texture_distance_functor func(texture_->GetTextureObject(), voxel_size_,
+                                      resolution_, origin_, distances_ptr, gradients_ptr);
+        thrust::for_each(begin, end, func);
+    } else {
+        interpolate_distance_functor func(thrust::raw_pointer_cast(voxels_.data()),
+                                          voxel_size_, resolution_, origin_,
+                                          distances_ptr, gradients_ptr);
+        thrust::for_each(begin, end, func);
+    }
+}
+
 }
 }
\ No newline at end of file
@@ -1,9 +1,18 @@
 #pragma once
+#include <limits>
+#include <memory>
+
 #include "cupoch/geometry/densegrid.h"
 
 namespace cupoch {
+namespace utility {
+class Texture3D;
+}
+
 namespace geometry {
 class VoxelGrid;
+class OccupancyGrid;
+class Graph;
 
 class DistanceVoxel {
 public:
@@ -36,11 +45,84 @@ public:
 
     DistanceTransform &ComputeEDT(const utility::device_vector<Eigen::Vector3i>& points);
     DistanceTransform &ComputeEDT(const VoxelGrid& voxelgrid);
+    /// Computes the EDT to the occupied voxels of \p occupancygrid, read in
+    /// place, which must have the voxel size, the resolution and the origin
+    /// of the transform. With \p signed_distance, the occupied voxels get
+    /// minus their distance to the nearest voxel that is not occupied, free
+    /// or unknown. UpdateEDT() expects an unsigned field.
+    DistanceTransform &ComputeEDT(const OccupancyGrid& occupancygrid,
+                                  bool signed_distance = false);
     DistanceTransform &ComputeVoronoiDiagram(const utility::device_vector<Eigen::Vector3i>& points);
     DistanceTransform &ComputeVoronoiDiagram(const VoxelGrid& voxelgrid);
 
+    /// Updates the distance field of ComputeEDT() after the obstacle cells
+    /// \p added_points appeared and \p removed_points disappeared. As the
+    /// dynamic brushfire, the cells whose nearest site was removed are
+    /// cleared by a raise wavefront from the removed sites, then a lower
+    /// wavefront from the added sites and the border of the cleared cells
+    /// propagates the nearest sites through the 26 neighborhood. The work is
+    /// proportional to the cells whose nearest site changes, instead of to
+    /// resolution^3. On a newly constructed transform, it computes the field of
+    /// \p added_points. The wavefront stops at \p max_distance in metric
+    /// units from the sites, the farther cells keeping the distance of
+    /// ClearEDT(), as the ESDF of voxblox.
+    DistanceTransform &UpdateEDT(const utility::device_vector<Eigen::Vector3i>& added_points,
+                                 const utility::device_vector<Eigen::Vector3i>& removed_points,
+                                 float max_distance = std::numeric_limits<float>::infinity());
+    DistanceTransform &UpdateEDT(const VoxelGrid& added_voxels,
+                                 const VoxelGrid& removed_voxels);
+    /// Removes all the sites, every voxel taking \p max_distance, before
+    /// the UpdateEDT() calls bounded by \p max_distance.
+    DistanceTransform &ClearEDT(float max_distance = std::numeric_limits<float>::infinity());
+
+    /// Grid indices of the voxels of the generalized Voronoi diagram of the
+    /// sites of ComputeVoronoiDiagram() or ComputeEDT(): the free voxels
+    /// farther than \p min_clearance in metric units from their nearest
+    /// site, and having a face neighbor whose nearest site is more than
+    /// \p min_site_separation voxels away from theirs, i.e. the voxels
+    /// equidistant to two obstacles up to the discretization.
+    utility::device_vector<Eigen::Vector3i> ExtractVoronoiSkeleton(float min_clearance = 0.0,
+                                                                   float min_site_separation = 2.0) const;
+    /// Roadmap on the skeleton of ExtractVoronoiSkeleton(): one node at the
+    /// center of each skeleton voxel, and an edge weighted by its length
+    /// between each pair of skeleton voxels of the 26 neighborhood. The
+    /// paths of the graph, e.g. of Graph::AStarPath(), keep the largest
+    /// clearance from the obstacles.
+    std::shared_ptr<Graph> CreateVoronoiGraph(float min_clearance = 0.0,
+                                              float min_site_separation = 2.0) const;
+
+    /// Copies the distances to a 3D texture, read by the queries with
+    /// use_texture. The texture is not updated by the later computations.
+    DistanceTransform &UpdateTexture();
+    bool HasTexture() const { return bool(texture_); }
+
+    /// Distances in metric units at \p points, trilinearly interpolated
+    /// between the voxel centers. The points outside of the grid take the
+    /// values of the nearest border voxels, as the clamp mode of a texture.
+    /// With \p use_texture, the interpolation is done by the texture units
+    /// on the copy of UpdateTexture(), with 8 bit weights.
+    void GetDistances(const utility::device_vector<Eigen::Vector3f>& points,
+                      utility::device_vector<float>& distances,
+                      bool use_texture = false) const;
+    /// Same as GetDistances(), with the gradients of the interpolated
+    /// distance field, zero along the axes where a point is clamped. With
+    /// \p use_texture, the gradients are central differences of the texture
+    /// over one voxel.
+    void GetDistancesAndGradients(const utility::device_vector<Eigen::Vector3f>& points,
+                                  utility::device_vector<float>& distances,
+                                  utility::device_vector<Eigen::Vector3f>& gradients,
+                                  bool use_texture = false) const;
+
 private:
+    /// Computes the Voronoi diagram of the sites set in buffer_.
+    DistanceTransform &ComputeVoronoiDiagramOfSites();
+    void QueryDistances(const utility::device_vector<Eigen::Vector3f>& points,
+                        utility::device_vector<float>& distances,
+                        utility::device_vector<Eigen::Vector3f>& gradients,
+                        bool use_texture, bool compute_gradients) const;
+
     utility::device_vector<DistanceVoxel> buffer_;
+    std::shared_ptr<utility::Texture3D> texture_;
 };
 
 }
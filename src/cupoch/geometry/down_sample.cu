@@ -1,43 +1,169 @@
-#include <thrust/gather.h>
+#include <thrust/extrema.h>
+#include <thrust/iterator/counting_iterator.h>
 #include <thrust/iterator/discard_iterator.h>
+#include <thrust/sequence.h>
 
+#include "cupoch/geometry/boundingvolume.h"
 #include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/geometry/neighborhood_cache.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/voxel_hash_index.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/device_hash_map.inl"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/memory_tracker.h"
 #include "cupoch/utility/platform.h"
-#include "cupoch/utility/range.h"
+#include "cupoch/utility/profiler.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
 
 namespace {
 
-void SelectByIndexImpl(const geometry::PointCloud &src,
+struct select_by_index_functor {
+    select_by_index_functor(const size_t *indices,
+                            const Eigen::Vector3f *src_points,
+                            const Eigen::Vector3f *src_normals,
+                            const Eigen::Vector3f *src_colors,
+                            const float *src_attributes,
+                            Eigen::Vector3f *dst_points,
+                            Eigen::Vector3f *dst_normals,
+                            Eigen::Vector3f *dst_colors,
+                            float *dst_attributes,
+                            int n_attributes)
+        : indices_(indices),
+          src_points_(src_points),
+          src_normals_(src_normals),
+          src_colors_(src_colors),
+          src_attributes_(src_attributes),
+          dst_points_(dst_points),
+          dst_normals_(dst_normals),
+          dst_colors_(dst_colors),
+          dst_attributes_(dst_attributes),
+          n_attributes_(n_attributes){};
+    const size_t *indices_;
+    const Eigen::Vector3f *src_points_;
+    const Eigen::Vector3f *src_normals_;
+    const Eigen::Vector3f *src_colors_;
+    const float *src_attributes_;
+    Eigen::Vector3f *dst_points_;
+    Eigen::Vector3f *dst_normals_;
+    Eigen::Vector3f *dst_colors_;
+    float *dst_attributes_;
+    const int n_attributes_;
+    __device__ void operator()(size_t idx) {
+        const size_t i = indices_[idx];
+        dst_points_[idx] = src_points_[i];
+        if (dst_normals_) dst_normals_[idx] = src_normals_[i];
+        if (dst_colors_) dst_colors_[idx] = src_colors_[i];
+        for (int j = 0; j < n_attributes_; ++j) {
+            dst_attributes_[idx * n_attributes_ + j] =
+                    src_attributes_[i * n_attributes_ + j];
+        }
+    }
+};
+
+void SelectByIndexImpl(utility::ExecutionContext &ctx,
+                       const geometry::PointCloud &src,
                        geometry::PointCloud &dst,
                        const utility::device_vector<size_t> &indices) {
     const bool has_normals = src.HasNormals();
     const bool has_colors = src.HasColors();
-    if (has_normals) dst.normals_.resize(indices.size());
-    if (has_colors) dst.colors_.resize(indices.size());
+    const bool has_attributes = src.HasAttributes();
+    const int n_attributes = has_attributes ? src.GetAttributeDimension() : 0;
+    cudaStream_t stream = ctx.GetStream();
+    // dst may be a reused point cloud, so the channels src does not have
+    // are dropped.
     dst.points_.resize(indices.size());
-    thrust::gather(utility::exec_policy(utility::GetStream(0))
-                           ->on(utility::GetStream(0)),
-                   indices.begin(), indices.end(), src.points_.begin(),
-                   dst.points_.begin());
-    if (has_normals) {
-        thrust::gather(utility::exec_policy(utility::GetStream(1))
-                               ->on(utility::GetStream(1)),
-                       indices.begin(), indices.end(), src.normals_.begin(),
-                       dst.normals_.begin());
-    }
-    if (has_colors) {
-        thrust::gather(utility::exec_policy(utility::GetStream(2))
-                               ->on(utility::GetStream(2)),
-                       indices.begin(), indices.end(), src.colors_.begin(),
-                       dst.colors_.begin());
-    }
-    cudaSafeCall(cudaDeviceSynchronize());
+    dst.normals_.resize(has_normals ? indices.size() : 0);
+    dst.colors_.resize(has_colors ? indices.size() : 0);
+    dst.attributes_.resize(indices.size() * n_attributes);
+    dst.attribute_names_ = src.attribute_names_;
+    // All channels are copied by a single kernel so that the indices are
+    // only read once per point.
+    select_by_index_functor func(
+            thrust::raw_pointer_cast(indices.data()),
+            thrust::raw_pointer_cast(src.points_.data()),
+            thrust::raw_pointer_cast(src.normals_.data()),
+            thrust::raw_pointer_cast(src.colors_.data()),
+            thrust::raw_pointer_cast(src.attributes_.data()),
+            thrust::raw_pointer_cast(dst.points_.data()),
+            has_normals ? thrust::raw_pointer_cast(dst.normals_.data())
+                        : nullptr,
+            has_colors ? thrust::raw_pointer_cast(dst.colors_.data()) : nullptr,
+            thrust::raw_pointer_cast(dst.attributes_.data()), n_attributes);
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(indices.size()), func);
+    ctx.Synchronize();
+}
+
+struct average_attributes_functor {
+    average_attributes_functor(const float *src,
+                               const size_t *perm,
+                               const int *offsets,
+                               const int *counts,
+                               float *dst,
+                               int n_attributes)
+        : src_(src),
+          perm_(perm),
+          offsets_(offsets),
+          counts_(counts),
+          dst_(dst),
+          n_attributes_(n_attributes){};
+    const float *src_;
+    const size_t *perm_;
+    const int *offsets_;
+    const int *counts_;
+    float *dst_;
+    const int n_attributes_;
+    __device__ void operator()(size_t idx) {
+        const int offset = offsets_[idx];
+        const int count = counts_[idx];
+        for (int j = 0; j < n_attributes_; ++j) {
+            float sum = 0.0f;
+            for (int k = 0; k < count; ++k) {
+                sum += src_[perm_[offset + k] * n_attributes_ + j];
+            }
+            dst_[idx * n_attributes_ + j] = sum / count;
+        }
+    }
+};
+
+template <typename KeyType>
+void AverageAttributesByKey(cudaStream_t stream,
+                            utility::device_vector<KeyType> &keys,
+                            const geometry::PointCloud &src,
+                            geometry::PointCloud &dst) {
+    const size_t n = keys.size();
+    const int n_attributes = src.GetAttributeDimension();
+    utility::device_vector<size_t> perm(n);
+    thrust::sequence(utility::exec_policy(stream)->on(stream), perm.begin(),
+                     perm.end());
+    thrust::sort_by_key(utility::exec_policy(stream)->on(stream), keys.begin(),
+                        keys.end(), perm.begin());
+    utility::device_vector<int> counts(n);
+    auto end = thrust::reduce_by_key(
+            utility::exec_policy(stream)->on(stream), keys.begin(), keys.end(),
+            thrust::make_constant_iterator(1), thrust::make_discard_iterator(),
+            counts.begin());
+    const size_t n_out = thrust::distance(counts.begin(), end.second);
+    counts.resize(n_out);
+    utility::device_vector<int> offsets(n_out);
+    thrust::exclusive_scan(utility::exec_policy(stream)->on(stream),
+                           counts.begin(), counts.end(), offsets.begin());
+    dst.attributes_.resize(n_out * n_attributes);
+    dst.attribute_names_ = src.attribute_names_;
+    average_attributes_functor func(
+            thrust::raw_pointer_cast(src.attributes_.data()),
+            thrust::raw_pointer_cast(perm.data()),
+            thrust::raw_pointer_cast(offsets.data()),
+            thrust::raw_pointer_cast(counts.data()),
+            thrust::raw_pointer_cast(dst.attributes_.data()), n_attributes);
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_out), func);
 }
 
 struct compute_key_functor {
@@ -54,44 +180,374 @@ struct compute_key_functor {
     }
 };
 
-template <typename OutputIterator, class... Args>
-__host__ int CalcAverageByKey(utility::device_vector<Eigen::Vector3i> &keys,
+// Morton codes only use the lower 63 bits, so they never collide with the
+// reserved keys of the table.
+typedef utility::device_hash_map<MortonCode, int> voxel_table;
+
+struct compute_morton_key_functor {
+    compute_morton_key_functor(const Eigen::Vector3f &voxel_min_bound,
+                               float voxel_size)
+        : key_func_(voxel_min_bound, voxel_size){};
+    compute_key_functor key_func_;
+    __device__ MortonCode operator()(const Eigen::Vector3f &pt) {
+        const Eigen::Vector3i key = key_func_(pt);
+        return EncodeMorton(key[0], key[1], key[2]);
+    }
+};
+
+struct accumulate_voxel_functor {
+    accumulate_voxel_functor(const Eigen::Vector3f *points,
+                             const Eigen::Vector3f *normals,
+                             const Eigen::Vector3f *colors,
+                             const float *attributes,
+                             int n_attributes,
+                             const Eigen::Vector3f &voxel_min_bound,
+                             float voxel_size,
+                             const voxel_table &table,
+                             int *counts,
+                             Eigen::Vector3f *point_sums,
+                             Eigen::Vector3f *normal_sums,
+                             Eigen::Vector3f *color_sums,
+                             float *attribute_sums)
+        : points_(points),
+          normals_(normals),
+          colors_(colors),
+          attributes_(attributes),
+          n_attributes_(n_attributes),
+          key_func_(voxel_min_bound, voxel_size),
+          table_(table.view()),
+          counts_(counts),
+          point_sums_(point_sums),
+          normal_sums_(normal_sums),
+          color_sums_(color_sums),
+          attribute_sums_(attribute_sums){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3f *normals_;
+    const Eigen::Vector3f *colors_;
+    const float *attributes_;
+    const int n_attributes_;
+    compute_morton_key_functor key_func_;
+    const voxel_table::view_type table_;
+    int *counts_;
+    Eigen::Vector3f *point_sums_;
+    Eigen::Vector3f *normal_sums_;
+    Eigen::Vector3f *color_sums_;
+    float *attribute_sums_;
+    __device__ void AtomicAdd(Eigen::Vector3f &dst,
+                              const Eigen::Vector3f &src) const {
+        atomicAdd(&dst[0], src[0]);
+        atomicAdd(&dst[1], src[1]);
+        atomicAdd(&dst[2], src[2]);
+    }
+    __device__ void operator()(size_t idx) {
+        const int slot = table_.insert_slot(key_func_(points_[idx])).first;
+        atomicAdd(&counts_[slot], 1);
+        AtomicAdd(point_sums_[slot], points_[idx]);
+        if (normal_sums_) AtomicAdd(normal_sums_[slot], normals_[idx]);
+        if (color_sums_) AtomicAdd(color_sums_[slot], colors_[idx]);
+        for (int j = 0; j < n_attributes_; ++j) {
+            atomicAdd(&attribute_sums_[slot * n_attributes_ + j],
+                      attributes_[idx * n_attributes_ + j]);
+        }
+    }
+};
+
+struct finalize_voxel_functor {
+    finalize_voxel_functor(const int *slots,
+                           const int *counts,
+                           const Eigen::Vector3f *point_sums,
+                           const Eigen::Vector3f *normal_sums,
+                           const Eigen::Vector3f *color_sums,
+                           const float *attribute_sums,
+                           int n_attributes,
+                           Eigen::Vector3f *points,
+                           Eigen::Vector3f *normals,
+                           Eigen::Vector3f *colors,
+                           float *attributes)
+        : slots_(slots),
+          counts_(counts),
+          point_sums_(point_sums),
+          normal_sums_(normal_sums),
+          color_sums_(color_sums),
+          attribute_sums_(attribute_sums),
+          n_attributes_(n_attributes),
+          points_(points),
+          normals_(normals),
+          colors_(colors),
+          attributes_(attributes){};
+    const int *slots_;
+    const int *counts_;
+    const Eigen::Vector3f *point_sums_;
+    const Eigen::Vector3f *normal_sums_;
+    const Eigen::Vector3f *color_sums_;
+    const float *attribute_sums_;
+    const int n_attributes_;
+    Eigen::Vector3f *points_;
+    Eigen::Vector3f *normals_;
+    Eigen::Vector3f *colors_;
+    float *attributes_;
+    __device__ void operator()(size_t idx) {
+        const int slot = slots_[idx];
+        const float count = counts_[slot];
+        points_[idx] = point_sums_[slot] / count;
+        if (normals_) normals_[idx] = normal_sums_[slot].normalized();
+        if (colors_) colors_[idx] = color_sums_[slot] / count;
+        for (int j = 0; j < n_attributes_; ++j) {
+            attributes_[idx * n_attributes_ + j] =
+                    attribute_sums_[slot * n_attributes_ + j] / count;
+        }
+    }
+};
+
+struct is_occupied_slot_functor {
+    __device__ bool operator()(MortonCode key) const {
+        return key < voxel_table::view_type::kErasedKey;
+    }
+};
+
+void VoxelDownSampleByHash(cudaStream_t stream,
+                           const geometry::PointCloud &src,
+                           const Eigen::Vector3f &voxel_min_bound,
+                           float voxel_size,
+                           geometry::PointCloud &dst) {
+    const size_t n = src.points_.size();
+    const bool has_normals = src.HasNormals();
+    const bool has_colors = src.HasColors();
+    const int n_attributes =
+            src.HasAttributes() ? src.GetAttributeDimension() : 0;
+    voxel_table table(n);
+    const size_t table_size = table.bucket_count();
+    utility::device_vector<int> counts(table_size, 0);
+    utility::device_vector<Eigen::Vector3f> point_sums(
+            table_size, Eigen::Vector3f::Zero());
+    utility::device_vector<Eigen::Vector3f> normal_sums(
+            has_normals ? table_size : 0, Eigen::Vector3f::Zero());
+    utility::device_vector<Eigen::Vector3f> color_sums(
+            has_colors ? table_size : 0, Eigen::Vector3f::Zero());
+    utility::device_vector<float> attribute_sums(table_size * n_attributes,
+                                                 0.0f);
+    accumulate_voxel_functor acc_func(
+            thrust::raw_pointer_cast(src.points_.data()),
+            thrust::raw_pointer_cast(src.normals_.data()),
+            thrust::raw_pointer_cast(src.colors_.data()),
+            thrust::raw_pointer_cast(src.attributes_.data()), n_attributes,
+            voxel_min_bound, voxel_size, table,
+            thrust::raw_pointer_cast(counts.data()),
+            thrust::raw_pointer_cast(point_sums.data()),
+            has_normals ? thrust::raw_pointer_cast(normal_sums.data())
+                        : nullptr,
+            has_colors ? thrust::raw_pointer_cast(color_sums.data()) : nullptr,
+            thrust::raw_pointer_cast(attribute_sums.data()));
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n), acc_func);
+
+    utility::device_vector<int> slots(table_size);
+    auto end = thrust::copy_if(utility::exec_policy(stream)->on(stream),
+                               thrust::make_counting_iterator<int>(0),
+                               thrust::make_counting_iterator<int>(table_size),
+                               table.keys_.begin(), slots.begin(),
+                               is_occupied_slot_functor());
+    const size_t n_out = thrust::distance(slots.begin(), end);
+    dst.points_.resize(n_out);
+    if (has_normals) dst.normals_.resize(n_out);
+    if (has_colors) dst.colors_.resize(n_out);
+    if (n_attributes > 0) {
+        dst.attributes_.resize(n_out * n_attributes);
+        dst.attribute_names_ = src.attribute_names_;
+    }
+    finalize_voxel_functor fin_func(
+            thrust::raw_pointer_cast(slots.data()),
+            thrust::raw_pointer_cast(counts.data()),
+            thrust::raw_pointer_cast(point_sums.data()),
+            thrust::raw_pointer_cast(normal_sums.data()),
+            thrust::raw_pointer_cast(color_sums.data()),
+            thrust::raw_pointer_cast(attribute_sums.data()), n_attributes,
+            thrust::raw_pointer_cast(dst.points_.data()),
+            has_normals ? thrust::raw_pointer_cast(dst.normals_.data())
+                        : nullptr,
+            has_colors ? thrust::raw_pointer_cast(dst.colors_.data()) : nullptr,
+            thrust::raw_pointer_cast(dst.attributes_.data()));
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_out), fin_func);
+}
+
+template <typename KeyType, typename OutputIterator, class... Args>
+__host__ int CalcAverageByKey(cudaStream_t stream,
+                              utility::device_vector<KeyType> &keys,
                               OutputIterator buf_begins,
                               OutputIterator output_begins) {
     const size_t n = keys.size();
-    thrust::sort_by_key(keys.begin(), keys.end(), buf_begins);
+    thrust::sort_by_key(utility::exec_policy(stream)->on(stream), keys.begin(),
+                        keys.end(), buf_begins);
 
     utility::device_vector<int> counts(n);
     auto end1 = thrust::reduce_by_key(
-            keys.begin(), keys.end(), thrust::make_constant_iterator(1),
+            utility::exec_policy(stream)->on(stream), keys.begin(),
+            keys.end(), thrust::make_constant_iterator(1),
             thrust::make_discard_iterator(), counts.begin());
     int n_out = thrust::distance(counts.begin(), end1.second);
     counts.resize(n_out);
 
-    thrust::equal_to<Eigen::Vector3i> binary_pred;
+    thrust::equal_to<KeyType> binary_pred;
     add_tuple_functor<Args...> add_func;
-    auto end2 = thrust::reduce_by_key(keys.begin(), keys.end(), buf_begins,
+    auto end2 = thrust::reduce_by_key(utility::exec_policy(stream)->on(stream),
+                                      keys.begin(), keys.end(), buf_begins,
                                       thrust::make_discard_iterator(),
                                       output_begins, binary_pred, add_func);
 
     devide_tuple_functor<Args...> dv_func;
-    thrust::transform(output_begins, output_begins + n_out, counts.begin(),
-                      output_begins, dv_func);
+    thrust::transform(utility::exec_policy(stream)->on(stream), output_begins,
+                      output_begins + n_out, counts.begin(), output_begins,
+                      dv_func);
     return n_out;
 }
 
+struct normalize_functor {
+    __device__ void operator()(Eigen::Vector3f &nl) const { nl.normalize(); }
+};
+
+template <typename KeyType, typename KeyFunctor>
+void VoxelDownSampleBySort(cudaStream_t stream,
+                           const geometry::PointCloud &src,
+                           KeyFunctor key_func,
+                           geometry::PointCloud &output) {
+    const int n = src.points_.size();
+    const bool has_normals = src.HasNormals();
+    const bool has_colors = src.HasColors();
+    utility::device_vector<KeyType> keys(n);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      src.points_.begin(), src.points_.end(), keys.begin(),
+                      key_func);
+
+    if (src.HasAttributes()) {
+        // The voxels are enumerated in sorted key order, which is the same
+        // order as the one produced by CalcAverageByKey below.
+        utility::device_vector<KeyType> attr_keys = keys;
+        AverageAttributesByKey(stream, attr_keys, src, output);
+    }
+
+    utility::device_vector<Eigen::Vector3f> sorted_points = src.points_;
+    output.points_.resize(n);
+    if (!has_normals && !has_colors) {
+        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator>
+                IteratorTuple;
+        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
+        auto n_out = CalcAverageByKey<KeyType, ZipIterator, Eigen::Vector3f>(
+                stream, keys, make_tuple_begin(sorted_points),
+                make_tuple_begin(output.points_));
+        output.points_.resize(n_out);
+    } else if (has_normals && !has_colors) {
+        utility::device_vector<Eigen::Vector3f> sorted_normals = src.normals_;
+        output.normals_.resize(n);
+        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator,
+                              utility::device_vector<Eigen::Vector3f>::iterator>
+                IteratorTuple;
+        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
+        auto n_out =
+                CalcAverageByKey<KeyType, ZipIterator, Eigen::Vector3f, Eigen::Vector3f>(
+                        stream, keys,
+                        make_tuple_begin(sorted_points, sorted_normals),
+                        make_tuple_begin(output.points_, output.normals_));
+        resize_all(n_out, output.points_, output.normals_);
+        thrust::for_each(utility::exec_policy(stream)->on(stream),
+                         output.normals_.begin(), output.normals_.end(),
+                         normalize_functor());
+    } else if (!has_normals && has_colors) {
+        utility::device_vector<Eigen::Vector3f> sorted_colors = src.colors_;
+        output.colors_.resize(n);
+        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator,
+                              utility::device_vector<Eigen::Vector3f>::iterator>
+                IteratorTuple;
+        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
+        auto n_out =
+                CalcAverageByKey<KeyType, ZipIterator, Eigen::Vector3f, Eigen::Vector3f>(
+                        stream, keys,
+                        make_tuple_begin(sorted_points, sorted_colors),
+                        make_tuple_begin(output.points_, output.colors_));
+        resize_all(n_out, output.points_, output.colors_);
+    } else {
+        utility::device_vector<Eigen::Vector3f> sorted_normals = src.normals_;
+        utility::device_vector<Eigen::Vector3f> sorted_colors = src.colors_;
+        output.normals_.resize(n);
+        output.colors_.resize(n);
+        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator,
+                              utility::device_vector<Eigen::Vector3f>::iterator,
+                              utility::device_vector<Eigen::Vector3f>::iterator>
+                IteratorTuple;
+        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
+        auto n_out = CalcAverageByKey<KeyType, ZipIterator, Eigen::Vector3f,
+                                      Eigen::Vector3f, Eigen::Vector3f>(
+                stream, keys,
+                make_tuple_begin(sorted_points, sorted_normals,
+                                 sorted_colors),
+                make_tuple_begin(output.points_, output.normals_,
+                                 output.colors_));
+        resize_all(n_out, output.points_, output.normals_, output.colors_);
+        thrust::for_each(utility::exec_policy(stream)->on(stream),
+                         output.normals_.begin(), output.normals_.end(),
+                         normalize_functor());
+    }
+}
+
+template <typename KeyType, typename KeyFunctor>
+void FirstIndexPerVoxel(cudaStream_t stream,
+                        const utility::device_vector<Eigen::Vector3f> &points,
+                        KeyFunctor key_func,
+                        utility::device_vector<size_t> &indices) {
+    utility::device_vector<KeyType> keys(points.size());
+    thrust::transform(utility::exec_policy(stream)->on(stream), points.begin(),
+                      points.end(), keys.begin(), key_func);
+    indices.resize(points.size());
+    thrust::sequence(utility::exec_policy(stream)->on(stream), indices.begin(),
+                     indices.end());
+    // The stable sort keeps the smallest index of every voxel in front.
+    thrust::stable_sort_by_key(utility::exec_policy(stream)->on(stream),
+                               keys.begin(), keys.end(), indices.begin());
+    auto end = thrust::unique_by_key(utility::exec_policy(stream)->on(stream),
+                                     keys.begin(), keys.end(), indices.begin());
+    indices.resize(thrust::distance(indices.begin(), end.second));
+}
+
+struct random_key_functor {
+    random_key_functor(unsigned int seed) : seed_(seed){};
+    const unsigned int seed_;
+    __device__ unsigned int operator()(size_t idx) const {
+        unsigned long long key = ((unsigned long long)seed_ << 32) ^ idx;
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return (unsigned int)key;
+    }
+};
+
+struct wrap_index_functor {
+    wrap_index_functor(const size_t *perm, size_t n) : perm_(perm), n_(n){};
+    const size_t *perm_;
+    const size_t n_;
+    __device__ size_t operator()(size_t idx) const { return perm_[idx % n_]; }
+};
+
+struct update_min_distance_functor {
+    update_min_distance_functor(const Eigen::Vector3f *points, size_t farthest)
+        : points_(points), farthest_(farthest){};
+    const Eigen::Vector3f *points_;
+    const size_t farthest_;
+    __device__ float operator()(const Eigen::Vector3f &pt, float d2) const {
+        return min(d2, (pt - points_[farthest_]).squaredNorm());
+    }
+};
+
 struct has_radius_points_functor {
-    has_radius_points_functor(const int *indices, int n_points, int knn)
-        : indices_(indices), n_points_(n_points), knn_(knn){};
-    const int *indices_;
+    has_radius_points_functor(const int *offsets, int n_points)
+        : offsets_(offsets), n_points_(n_points){};
+    const int *offsets_;
     const int n_points_;
-    const int knn_;
     __device__ bool operator()(int idx) const {
-        int count = 0;
-        for (int i = 0; i < knn_; ++i) {
-            if (indices_[idx * knn_ + i] >= 0) count++;
-        }
-        return (count > n_points_);
+        return (offsets_[idx + 1] - offsets_[idx] > n_points_);
     }
 };
 
@@ -124,40 +580,132 @@ struct check_distance_threshold_functor {
     }
 };
 
+struct is_selected_functor {
+    is_selected_functor(const uint32_t *words, bool invert, int dim)
+        : words_(words), invert_(invert), dim_(dim){};
+    const uint32_t *words_;
+    const bool invert_;
+    const int dim_;
+    __device__ bool operator()(size_t idx) const {
+        return IsSelected(words_, idx / dim_) != invert_;
+    }
+};
+
+// Welford accumulation of the positive distances: their count, mean and
+// sum of squared deviations, plus the count of all valid (non negative)
+// ones.
+struct welford_state {
+    float n_valid_;
+    float n_;
+    float mean_;
+    float m2_;
+};
+
+struct welford_init_functor {
+    __device__ welford_state operator()(float x) const {
+        return welford_state{(x >= 0.0) ? 1.0f : 0.0f, (x > 0.0) ? 1.0f : 0.0f,
+                             (x > 0.0) ? x : 0.0f, 0.0f};
+    }
+};
+
+// Chan's update to merge two partial accumulations.
+struct welford_merge_functor {
+    __device__ welford_state operator()(const welford_state &a,
+                                        const welford_state &b) const {
+        const float n = a.n_ + b.n_;
+        if (n == 0.0) return welford_state{a.n_valid_ + b.n_valid_, 0, 0, 0};
+        const float delta = b.mean_ - a.mean_;
+        return welford_state{a.n_valid_ + b.n_valid_, n,
+                             a.mean_ + delta * b.n_ / n,
+                             a.m2_ + b.m2_ + delta * delta * a.n_ * b.n_ / n};
+    }
+};
+
+// Keeps the points whose mean neighbor distance is below the mean plus
+// std_ratio standard deviations of all valid (non negative) ones.
+SelectionMask ComputeStatisticalInlierMaskImpl(
+        const utility::device_vector<float> &avg_distances,
+        float std_ratio) {
+    const size_t n_pt = avg_distances.size();
+    const welford_state stats = thrust::transform_reduce(
+            avg_distances.begin(), avg_distances.end(),
+            welford_init_functor(), welford_state{0.0, 0.0, 0.0, 0.0},
+            welford_merge_functor());
+    if (stats.n_valid_ == 0.0) {
+        return SelectionMask(n_pt, false);
+    }
+    // The zero distances count in the mean but not in the deviations.
+    const float cloud_mean = stats.mean_ * stats.n_ / stats.n_valid_;
+    const float shift = stats.mean_ - cloud_mean;
+    const float sq_sum = stats.m2_ + stats.n_ * shift * shift;
+    // Bessel's correction
+    const float std_dev = std::sqrt(sq_sum / (stats.n_valid_ - 1));
+    const float distance_threshold = cloud_mean + std_ratio * std_dev;
+    check_distance_threshold_functor th_func(
+            thrust::raw_pointer_cast(avg_distances.data()), distance_threshold);
+    return SelectionMask::CreateFromPredicate(n_pt, th_func);
+}
+
 }  // namespace
 
 std::shared_ptr<PointCloud> PointCloud::SelectByIndex(
         const utility::device_vector<size_t> &indices, bool invert) const {
+    return SelectByIndex(utility::ExecutionContext::Default(), indices,
+                         invert);
+}
+
+std::shared_ptr<PointCloud> PointCloud::SelectByIndex(
+        utility::ExecutionContext &ctx,
+        const utility::device_vector<size_t> &indices,
+        bool invert) const {
     auto output = std::make_shared<PointCloud>();
+    cudaStream_t stream = ctx.GetStream();
 
     if (invert) {
         size_t n_out = points_.size() - indices.size();
         utility::device_vector<size_t> sorted_indices = indices;
-        thrust::sort(sorted_indices.begin(), sorted_indices.end());
+        thrust::sort(utility::exec_policy(stream)->on(stream),
+                     sorted_indices.begin(), sorted_indices.end());
         utility::device_vector<size_t> inv_indices(n_out);
-        thrust::set_difference(thrust::make_counting_iterator<size_t>(0),
+        thrust::set_difference(utility::exec_policy(stream)->on(stream),
+                               thrust::make_counting_iterator<size_t>(0),
                                thrust::make_counting_iterator(points_.size()),
                                sorted_indices.begin(), sorted_indices.end(),
                                inv_indices.begin());
-        SelectByIndexImpl(*this, *output, inv_indices);
+        SelectByIndexImpl(ctx, *this, *output, inv_indices);
     } else {
-        SelectByIndexImpl(*this, *output, indices);
+        SelectByIndexImpl(ctx, *this, *output, indices);
     }
     return output;
 }
 
 std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
-        float voxel_size) const {
+        float voxel_size, bool deterministic) const {
+    return VoxelDownSample(utility::ExecutionContext::Default(), voxel_size,
+                           deterministic);
+}
+
+std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
+        utility::ExecutionContext &ctx,
+        float voxel_size,
+        bool deterministic) const {
+    CUPOCH_PROFILE("PointCloud::VoxelDownSample", ctx.GetStream());
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
     auto output = std::make_shared<PointCloud>();
     if (voxel_size <= 0.0) {
         utility::LogWarning("[VoxelDownSample] voxel_size <= 0.\n");
         return output;
     }
 
+    cudaStream_t stream = ctx.GetStream();
     const Eigen::Vector3f voxel_size3 =
             Eigen::Vector3f(voxel_size, voxel_size, voxel_size);
-    const Eigen::Vector3f voxel_min_bound = GetMinBound() - voxel_size3 * 0.5;
-    const Eigen::Vector3f voxel_max_bound = GetMaxBound() + voxel_size3 * 0.5;
+    const PointStatistics stats = ComputePointStatistics(stream, points_);
+    const Eigen::Vector3f voxel_min_bound =
+            stats.min_bound_ - voxel_size3 * 0.5;
+    const Eigen::Vector3f voxel_max_bound =
+            stats.max_bound_ + voxel_size3 * 0.5;
 
     if (voxel_size * std::numeric_limits<int>::max() <
         (voxel_max_bound - voxel_min_bound).maxCoeff()) {
@@ -165,74 +713,31 @@ std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
         return output;
     }
 
-    const int n = points_.size();
-    const bool has_normals = HasNormals();
-    const bool has_colors = HasColors();
-    compute_key_functor ck_func(voxel_min_bound, voxel_size);
-    utility::device_vector<Eigen::Vector3i> keys(n);
-    thrust::transform(points_.begin(), points_.end(), keys.begin(), ck_func);
+    // Morton keys hold 21 bits per axis and sort as plain integers. The
+    // voxel indices are only used for the clouds with a larger extent.
+    const bool fits_morton = (voxel_max_bound - voxel_min_bound).maxCoeff() <
+                             voxel_size * ((1 << kMortonBitsPerAxis) - 1);
+    if (!deterministic && !ctx.IsDeterministic() && fits_morton) {
+        VoxelDownSampleByHash(stream, *this, voxel_min_bound, voxel_size,
+                              *output);
+        ctx.Synchronize();
+        utility::LogDebug(
+                "Pointcloud down sampled from {:d} points to {:d} points.\n",
+                (int)points_.size(), (int)output->points_.size());
+        return output;
+    }
 
-    utility::device_vector<Eigen::Vector3f> sorted_points = points_;
-    output->points_.resize(n);
-    if (!has_normals && !has_colors) {
-        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator>
-                IteratorTuple;
-        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
-        auto n_out = CalcAverageByKey<ZipIterator, Eigen::Vector3f>(
-                keys, make_tuple_begin(sorted_points),
-                make_tuple_begin(output->points_));
-        output->points_.resize(n_out);
-    } else if (has_normals && !has_colors) {
-        utility::device_vector<Eigen::Vector3f> sorted_normals = normals_;
-        output->normals_.resize(n);
-        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator,
-                              utility::device_vector<Eigen::Vector3f>::iterator>
-                IteratorTuple;
-        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
-        auto n_out =
-                CalcAverageByKey<ZipIterator, Eigen::Vector3f, Eigen::Vector3f>(
-                        keys,
-                        make_tuple_begin(sorted_points, sorted_normals),
-                        make_tuple_begin(output->points_, output->normals_));
-        resize_all(n_out, output->points_, output->normals_);
-        thrust::for_each(
-                output->normals_.begin(), output->normals_.end(),
-                [] __device__(Eigen::Vector3f & nl) { nl.normalize(); });
-    } else if (!has_normals && has_colors) {
-        utility::device_vector<Eigen::Vector3f> sorted_colors = colors_;
-        output->colors_.resize(n);
-        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator,
-                              utility::device_vector<Eigen::Vector3f>::iterator>
-                IteratorTuple;
-        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
-        auto n_out =
-                CalcAverageByKey<ZipIterator, Eigen::Vector3f, Eigen::Vector3f>(
-                        keys,
-                        make_tuple_begin(sorted_points, sorted_colors),
-                        make_tuple_begin(output->points_, output->colors_));
-        resize_all(n_out, output->points_, output->colors_);
+    if (fits_morton) {
+        VoxelDownSampleBySort<MortonCode>(
+                stream, *this,
+                compute_morton_key_functor(voxel_min_bound, voxel_size),
+                *output);
     } else {
-        utility::device_vector<Eigen::Vector3f> sorted_normals = normals_;
-        utility::device_vector<Eigen::Vector3f> sorted_colors = colors_;
-        output->normals_.resize(n);
-        output->colors_.resize(n);
-        typedef thrust::tuple<utility::device_vector<Eigen::Vector3f>::iterator,
-                              utility::device_vector<Eigen::Vector3f>::iterator,
-                              utility::device_vector<Eigen::Vector3f>::iterator>
-                IteratorTuple;
-        typedef thrust::zip_iterator<IteratorTuple> ZipIterator;
-        auto n_out = CalcAverageByKey<ZipIterator, Eigen::Vector3f,
-                                      Eigen::Vector3f, Eigen::Vector3f>(
-                keys,
-                make_tuple_begin(sorted_points, sorted_normals,
-                                 sorted_colors),
-                make_tuple_begin(output->points_, output->normals_,
-                                 output->colors_));
-        resize_all(n_out, output->points_, output->normals_, output->colors_);
-        thrust::for_each(
-                output->normals_.begin(), output->normals_.end(),
-                [] __device__(Eigen::Vector3f & nl) { nl.normalize(); });
+        VoxelDownSampleBySort<Eigen::Vector3i>(
+                stream, *this, compute_key_functor(voxel_min_bound, voxel_size),
+                *output);
     }
+    ctx.Synchronize();
 
     utility::LogDebug(
             "Pointcloud down sampled from {:d} points to {:d} points.\n",
@@ -242,121 +747,340 @@ std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
 
 std::shared_ptr<PointCloud> PointCloud::UniformDownSample(
         size_t every_k_points) const {
-    const bool has_normals = HasNormals();
-    const bool has_colors = HasColors();
+    return UniformDownSample(utility::ExecutionContext::Default(),
+                             every_k_points);
+}
+
+std::shared_ptr<PointCloud> PointCloud::UniformDownSample(
+        utility::ExecutionContext &ctx, size_t every_k_points) const {
     auto output = std::make_shared<PointCloud>();
     if (every_k_points == 0) {
         utility::LogError("[UniformDownSample] Illegal sample rate.");
         return output;
     }
-    const int n_out = points_.size() / every_k_points;
-    output->points_.resize(n_out);
-    if (has_normals) output->normals_.resize(n_out);
-    if (has_colors) output->colors_.resize(n_out);
-    thrust::strided_range<
-            utility::device_vector<Eigen::Vector3f>::const_iterator>
-            range_points(points_.begin(), points_.end(), every_k_points);
-    thrust::copy(utility::exec_policy(utility::GetStream(0))
-                         ->on(utility::GetStream(0)),
-                 range_points.begin(), range_points.end(),
-                 output->points_.begin());
-    if (has_normals) {
-        thrust::strided_range<
-                utility::device_vector<Eigen::Vector3f>::const_iterator>
-                range_normals(normals_.begin(), normals_.end(), every_k_points);
-        thrust::copy(utility::exec_policy(utility::GetStream(1))
-                             ->on(utility::GetStream(1)),
-                     range_normals.begin(), range_normals.end(),
-                     output->normals_.begin());
-    }
-    if (has_colors) {
-        thrust::strided_range<
-                utility::device_vector<Eigen::Vector3f>::const_iterator>
-                range_colors(colors_.begin(), colors_.end(), every_k_points);
-        thrust::copy(utility::exec_policy(utility::GetStream(2))
-                             ->on(utility::GetStream(2)),
-                     range_colors.begin(), range_colors.end(),
-                     output->colors_.begin());
-    }
-    cudaSafeCall(cudaDeviceSynchronize());
+    cudaStream_t stream = ctx.GetStream();
+    const size_t n_out = points_.size() / every_k_points;
+    utility::device_vector<size_t> indices(n_out);
+    thrust::sequence(utility::exec_policy(stream)->on(stream), indices.begin(),
+                     indices.end(), (size_t)0, every_k_points);
+    SelectByIndexImpl(ctx, *this, *output, indices);
     return output;
 }
 
-std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
-PointCloud::RemoveRadiusOutliers(size_t nb_points, float search_radius) const {
+std::shared_ptr<PointCloud> PointCloud::ApproximateVoxelDownSample(
+        float voxel_size) const {
+    auto output = std::make_shared<PointCloud>();
+    ApproximateVoxelDownSample(utility::ExecutionContext::Default(),
+                               voxel_size, *output);
+    return output;
+}
+
+void PointCloud::ApproximateVoxelDownSample(utility::ExecutionContext &ctx,
+                                            float voxel_size,
+                                            PointCloud &output) const {
+    CUPOCH_PROFILE("PointCloud::ApproximateVoxelDownSample",
+                   ctx.GetStream());
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    if (voxel_size <= 0.0) {
+        utility::LogWarning(
+                "[ApproximateVoxelDownSample] voxel_size <= 0.\n");
+        return;
+    }
+    if (!HasPoints()) {
+        output.Clear();
+        return;
+    }
+    cudaStream_t stream = ctx.GetStream();
+    const Eigen::Vector3f voxel_size3 =
+            Eigen::Vector3f(voxel_size, voxel_size, voxel_size);
+    const PointStatistics stats = ComputePointStatistics(stream, points_);
+    const Eigen::Vector3f voxel_min_bound =
+            stats.min_bound_ - voxel_size3 * 0.5;
+    const Eigen::Vector3f voxel_max_bound =
+            stats.max_bound_ + voxel_size3 * 0.5;
+    if (voxel_size * std::numeric_limits<int>::max() <
+        (voxel_max_bound - voxel_min_bound).maxCoeff()) {
+        utility::LogWarning(
+                "[ApproximateVoxelDownSample] voxel_size is too small.\n");
+        return;
+    }
+    utility::device_vector<size_t> indices;
+    if ((voxel_max_bound - voxel_min_bound).maxCoeff() <
+        voxel_size * ((1 << kMortonBitsPerAxis) - 1)) {
+        FirstIndexPerVoxel<MortonCode>(
+                stream, points_,
+                compute_morton_key_functor(voxel_min_bound, voxel_size),
+                indices);
+    } else {
+        FirstIndexPerVoxel<Eigen::Vector3i>(
+                stream, points_,
+                compute_key_functor(voxel_min_bound, voxel_size), indices);
+    }
+    SelectByIndexImpl(ctx, *this, output, indices);
+}
+
+std::shared_ptr<PointCloud> PointCloud::RandomDownSample(
+        size_t n_samples, unsigned int seed) const {
+    auto output = std::make_shared<PointCloud>();
+    RandomDownSample(utility::ExecutionContext::Default(), n_samples, seed,
+                     *output);
+    return output;
+}
+
+void PointCloud::RandomDownSample(utility::ExecutionContext &ctx,
+                                  size_t n_samples,
+                                  unsigned int seed,
+                                  PointCloud &output) const {
+    if (!HasPoints() || n_samples == 0) {
+        output.Clear();
+        return;
+    }
+    cudaStream_t stream = ctx.GetStream();
+    const size_t n_pt = points_.size();
+    // Sorting by hashed keys gives a random permutation in a single radix
+    // sort, without drawing one random number per sample.
+    utility::device_vector<unsigned int> keys(n_pt);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_pt), keys.begin(),
+                      random_key_functor(seed));
+    utility::device_vector<size_t> perm(n_pt);
+    thrust::sequence(utility::exec_policy(stream)->on(stream), perm.begin(),
+                     perm.end());
+    thrust::sort_by_key(utility::exec_policy(stream)->on(stream), keys.begin(),
+                        keys.end(), perm.begin());
+    utility::device_vector<size_t> indices(n_samples);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_samples),
+                      indices.begin(),
+                      wrap_index_functor(thrust::raw_pointer_cast(perm.data()),
+                                         n_pt));
+    SelectByIndexImpl(ctx, *this, output, indices);
+}
+
+std::shared_ptr<PointCloud> PointCloud::FarthestPointDownSample(
+        size_t n_samples, size_t start_index) const {
+    auto output = std::make_shared<PointCloud>();
+    FarthestPointDownSample(utility::ExecutionContext::Default(), n_samples,
+                            start_index, *output);
+    return output;
+}
+
+void PointCloud::FarthestPointDownSample(utility::ExecutionContext &ctx,
+                                         size_t n_samples,
+                                         size_t start_index,
+                                         PointCloud &output) const {
+    if (!HasPoints() || n_samples == 0) {
+        output.Clear();
+        return;
+    }
+    if (start_index >= points_.size()) {
+        utility::LogError("[FarthestPointDownSample] start_index is out of range.");
+        return;
+    }
+    cudaStream_t stream = ctx.GetStream();
+    utility::device_vector<float> min_distance2(
+            points_.size(), std::numeric_limits<float>::infinity());
+    thrust::host_vector<size_t> selected(n_samples);
+    size_t farthest = start_index;
+    for (size_t i = 0; i < n_samples; ++i) {
+        selected[i] = farthest;
+        thrust::transform(utility::exec_policy(stream)->on(stream),
+                          points_.begin(), points_.end(),
+                          min_distance2.begin(), min_distance2.begin(),
+                          update_min_distance_functor(
+                                  thrust::raw_pointer_cast(points_.data()),
+                                  farthest));
+        auto itr = thrust::max_element(utility::exec_policy(stream)->on(stream),
+                                       min_distance2.begin(),
+                                       min_distance2.end());
+        farthest = thrust::distance(min_distance2.begin(), itr);
+    }
+    utility::device_vector<size_t> indices = selected;
+    SelectByIndexImpl(ctx, *this, output, indices);
+}
+
+std::shared_ptr<PointCloud> PointCloud::SelectByMask(
+        const SelectionMask &mask, bool invert) const {
+    return SelectByMask(utility::ExecutionContext::Default(), mask, invert);
+}
+
+std::shared_ptr<PointCloud> PointCloud::SelectByMask(
+        utility::ExecutionContext &ctx,
+        const SelectionMask &mask,
+        bool invert) const {
+    if (mask.Size() != points_.size()) {
+        utility::LogError(
+                "[SelectByMask] The mask size {:d} does not match the number "
+                "of points {:d}.",
+                mask.Size(), points_.size());
+    }
+    auto output = std::make_shared<PointCloud>();
+    cudaStream_t stream = ctx.GetStream();
+    const uint32_t *words = thrust::raw_pointer_cast(mask.words_.data());
+    const size_t n_out =
+            invert ? points_.size() - mask.Count() : mask.Count();
+    auto compact = [&](const utility::device_vector<Eigen::Vector3f> &src,
+                       utility::device_vector<Eigen::Vector3f> &dst) {
+        dst.resize(n_out);
+        thrust::copy_if(utility::exec_policy(stream)->on(stream),
+                        src.begin(), src.end(),
+                        thrust::make_counting_iterator<size_t>(0),
+                        dst.begin(),
+                        is_selected_functor(words, invert, 1));
+    };
+    compact(points_, output->points_);
+    if (HasNormals()) compact(normals_, output->normals_);
+    if (HasColors()) compact(colors_, output->colors_);
+    if (HasAttributes()) {
+        const int dim = GetAttributeDimension();
+        output->attributes_.resize(n_out * dim);
+        output->attribute_names_ = attribute_names_;
+        thrust::copy_if(utility::exec_policy(stream)->on(stream),
+                        attributes_.begin(), attributes_.end(),
+                        thrust::make_counting_iterator<size_t>(0),
+                        output->attributes_.begin(),
+                        is_selected_functor(words, invert, dim));
+    }
+    ctx.Synchronize();
+    return output;
+}
+
+SelectionMask PointCloud::ComputeCropMask(
+        const AxisAlignedBoundingBox &bbox) const {
+    const Eigen::Vector3f min_bound = bbox.min_bound_;
+    const Eigen::Vector3f max_bound = bbox.max_bound_;
+    const Eigen::Vector3f *points = thrust::raw_pointer_cast(points_.data());
+    return SelectionMask::CreateFromPredicate(
+            points_.size(), [=] __device__(size_t idx) {
+                const Eigen::Vector3f &p = points[idx];
+                return (p.array() >= min_bound.array()).all() &&
+                       (p.array() <= max_bound.array()).all();
+            });
+}
+
+SelectionMask PointCloud::ComputeRadiusInlierMask(
+        size_t nb_points,
+        float search_radius,
+        SearchIndexType index_type) const {
     if (nb_points < 1 || search_radius <= 0) {
         utility::LogError(
                 "[RemoveRadiusOutliers] Illegal input parameters,"
                 "number of points and radius must be positive");
     }
-    KDTreeFlann kdtree;
-    kdtree.SetGeometry(*this);
+    // Only nb_points + 1 neighbors are needed to accept a point.
+    const int max_nn = std::min(int(nb_points) + 1, NUM_MAX_NN);
+    utility::device_vector<int> offsets;
     utility::device_vector<int> tmp_indices;
     utility::device_vector<float> dist;
-    kdtree.SearchRadius(points_, search_radius, tmp_indices, dist);
-    const size_t n_pt = points_.size();
-    utility::device_vector<size_t> indices(n_pt);
-    has_radius_points_functor func(thrust::raw_pointer_cast(tmp_indices.data()),
-                                   nb_points, NUM_MAX_NN);
-    auto end = thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
-                               thrust::make_counting_iterator(n_pt),
-                               indices.begin(), func);
-    indices.resize(thrust::distance(indices.begin(), end));
-    return std::make_tuple(SelectByIndex(indices), indices);
+    SearchNeighborsCSR(index_type, points_, points_, search_radius, max_nn,
+                       offsets, tmp_indices, dist);
+    has_radius_points_functor func(thrust::raw_pointer_cast(offsets.data()),
+                                   nb_points);
+    return SelectionMask::CreateFromPredicate(points_.size(), func);
 }
 
 std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
-PointCloud::RemoveStatisticalOutliers(size_t nb_neighbors,
-                                      float std_ratio) const {
+PointCloud::RemoveRadiusOutliers(size_t nb_points,
+                                 float search_radius,
+                                 SearchIndexType index_type) const {
+    const SelectionMask mask =
+            ComputeRadiusInlierMask(nb_points, search_radius, index_type);
+    return std::make_tuple(SelectByMask(mask), mask.GetIndices());
+}
+
+SelectionMask PointCloud::ComputeStatisticalInlierMask(
+        size_t nb_neighbors,
+        float std_ratio,
+        SearchIndexType index_type) const {
     if (nb_neighbors < 1 || std_ratio <= 0) {
         utility::LogError(
                 "[RemoveStatisticalOutliers] Illegal input parameters, number "
                 "of neighbors and standard deviation ratio must be positive");
     }
-    if (points_.empty()) {
-        return std::make_tuple(std::make_shared<PointCloud>(),
-                               utility::device_vector<size_t>());
+    if (points_.empty()) return SelectionMask();
+    if (index_type == SearchIndexType::VoxelHash) {
+        CUPOCH_PROFILE("PointCloud::RemoveStatisticalOutliers");
+        utility::ScopedMemorySubsystem memory_subsystem(
+                utility::MemorySubsystem::PointCloud);
+        // The mean distances are reduced in the search kernel, so the
+        // neighbor lists are never written out.
+        VoxelHashIndex index;
+        utility::device_vector<float> avg_distances;
+        if (!index.SetRawData(points_) ||
+            index.SearchKNNMeanDistance2(points_, int(nb_neighbors),
+                                         avg_distances) < 0) {
+            return SelectionMask(points_.size(), false);
+        }
+        return ComputeStatisticalInlierMaskImpl(avg_distances, std_ratio);
     }
     KDTreeFlann kdtree;
     kdtree.SetGeometry(*this);
-    const int n_pt = points_.size();
-    utility::device_vector<float> avg_distances(n_pt);
-    utility::device_vector<size_t> indices(n_pt);
     utility::device_vector<int> tmp_indices;
     utility::device_vector<float> dist;
     kdtree.SearchKNN(points_, int(nb_neighbors), tmp_indices, dist);
+    return ComputeStatisticalInlierMask(dist, nb_neighbors, std_ratio);
+}
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+PointCloud::RemoveStatisticalOutliers(size_t nb_neighbors,
+                                      float std_ratio,
+                                      SearchIndexType index_type) const {
+    const SelectionMask mask =
+            ComputeStatisticalInlierMask(nb_neighbors, std_ratio, index_type);
+    return std::make_tuple(SelectByMask(mask), mask.GetIndices());
+}
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+PointCloud::RemoveStatisticalOutliers(NeighborhoodCache &cache,
+                                      size_t nb_neighbors,
+                                      float std_ratio) const {
+    if (&cache.GetPointCloud() != this) {
+        utility::LogWarning(
+                "[RemoveStatisticalOutliers] The cache is built on another "
+                "point cloud.\n");
+        return std::make_tuple(std::make_shared<PointCloud>(),
+                               utility::device_vector<size_t>());
+    }
+    const auto &neighborhood =
+            cache.GetNeighborhood(KDTreeSearchParamKNN(int(nb_neighbors)));
+    return RemoveStatisticalOutliers(neighborhood.distance2_, nb_neighbors,
+                                     std_ratio);
+}
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+PointCloud::RemoveStatisticalOutliers(
+        const utility::device_vector<float> &dist,
+        size_t nb_neighbors,
+        float std_ratio) const {
+    const SelectionMask mask =
+            ComputeStatisticalInlierMask(dist, nb_neighbors, std_ratio);
+    return std::make_tuple(SelectByMask(mask), mask.GetIndices());
+}
+
+SelectionMask PointCloud::ComputeStatisticalInlierMask(
+        const utility::device_vector<float> &dist,
+        size_t nb_neighbors,
+        float std_ratio) const {
+    CUPOCH_PROFILE("PointCloud::RemoveStatisticalOutliers");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    if (nb_neighbors < 1 || std_ratio <= 0) {
+        utility::LogError(
+                "[RemoveStatisticalOutliers] Illegal input parameters, number "
+                "of neighbors and standard deviation ratio must be positive");
+    }
+    const int n_pt = points_.size();
+    if (points_.empty() || dist.size() != points_.size() * nb_neighbors) {
+        return SelectionMask(n_pt, false);
+    }
+    utility::device_vector<float> avg_distances(n_pt);
     average_distance_functor avg_func(thrust::raw_pointer_cast(dist.data()),
                                       nb_neighbors);
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
                       thrust::make_counting_iterator((size_t)n_pt),
                       avg_distances.begin(), avg_func);
-    const size_t valid_distances =
-            thrust::count_if(avg_distances.begin(), avg_distances.end(),
-                             [] __device__(float x) { return (x >= 0.0); });
-    if (valid_distances == 0) {
-        return std::make_tuple(std::make_shared<PointCloud>(),
-                               utility::device_vector<size_t>());
-    }
-    float cloud_mean =
-            thrust::reduce(avg_distances.begin(), avg_distances.end(), 0.0,
-                           [] __device__(float const &x, float const &y) {
-                               return (y > 0) ? x + y : x;
-                           });
-    cloud_mean /= valid_distances;
-    const float sq_sum = thrust::transform_reduce(
-            avg_distances.begin(), avg_distances.end(),
-            [cloud_mean] __device__(const float x) {
-                return (x > 0) ? (x - cloud_mean) * (x - cloud_mean) : 0;
-            },
-            0.0, thrust::plus<float>());
-    // Bessel's correction
-    const float std_dev = std::sqrt(sq_sum / (valid_distances - 1));
-    const float distance_threshold = cloud_mean + std_ratio * std_dev;
-    check_distance_threshold_functor th_func(
-            thrust::raw_pointer_cast(avg_distances.data()), distance_threshold);
-    auto end = thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
-                               thrust::make_counting_iterator((size_t)n_pt),
-                               indices.begin(), th_func);
-    indices.resize(thrust::distance(indices.begin(), end));
-    return std::make_tuple(SelectByIndex(indices), indices);
+    return ComputeStatisticalInlierMaskImpl(avg_distances, std_ratio);
 }
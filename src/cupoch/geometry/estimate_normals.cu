@@ -1,236 +1,183 @@
+#include <thrust/sort.h>
+
 #include <Eigen/Geometry>
+#include <limits>
 
+#include "cupoch/geometry/estimate_normals.h"
 #include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/neighborhood_cache.h"
+#include "cupoch/geometry/voxel_hash_index.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
 
 namespace {
 
-__device__ Eigen::Vector3f ComputeEigenvector0(const Eigen::Matrix3f &A,
-                                               float eval0) {
-    Eigen::Vector3f row0(A(0, 0) - eval0, A(0, 1), A(0, 2));
-    Eigen::Vector3f row1(A(0, 1), A(1, 1) - eval0, A(1, 2));
-    Eigen::Vector3f row2(A(0, 2), A(1, 2), A(2, 2) - eval0);
-    Eigen::Vector3f rxr[3];
-    rxr[0] = row0.cross(row1);
-    rxr[1] = row0.cross(row2);
-    rxr[2] = row1.cross(row2);
-    Eigen::Vector3f d;
-    d[0] = rxr[0].dot(rxr[0]);
-    d[1] = rxr[1].dot(rxr[1]);
-    d[2] = rxr[2].dot(rxr[2]);
-
-    int imax;
-    d.maxCoeff(&imax);
-    return rxr[imax] / std::sqrt(d[imax]);
-}
+constexpr int kNormalWarpSize = 32;
+constexpr int kNormalBlockSize = 128;
 
-__device__ Eigen::Vector3f ComputeEigenvector1(const Eigen::Matrix3f &A,
-                                               const Eigen::Vector3f &evec0,
-                                               float eval1) {
-    Eigen::Vector3f U, V;
-    if (std::abs(evec0(0)) > std::abs(evec0(1))) {
-        float inv_length =
-                1 / std::sqrt(evec0(0) * evec0(0) + evec0(2) * evec0(2));
-        U << -evec0(2) * inv_length, 0, evec0(0) * inv_length;
-    } else {
-        float inv_length =
-                1 / std::sqrt(evec0(1) * evec0(1) + evec0(2) * evec0(2));
-        U << 0, evec0(2) * inv_length, -evec0(1) * inv_length;
+// One warp per point: the lanes load the neighbor indices of the point
+// with coalesced reads, accumulate the moments of their share of the
+// neighbors and reduce them with warp shuffles. The first lane then solves
+// the 3x3 eigen problem.
+__global__ void compute_neighbor_normals_kernel(const Eigen::Vector3f *points,
+                                                const int *indices,
+                                                int knn,
+                                                int n_points,
+                                                Eigen::Vector3f *normals,
+                                                Eigen::Vector3f *eigenvalues,
+                                                float *curvatures) {
+    const int lane = threadIdx.x % kNormalWarpSize;
+    const int idx = (blockIdx.x * blockDim.x + threadIdx.x) / kNormalWarpSize;
+    if (idx >= n_points) return;
+    float cumulants[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    int count = 0;
+    for (int k = lane; k < knn; k += kNormalWarpSize) {
+        const int j = indices[idx * knn + k];
+        if (j < 0) continue;
+        const Eigen::Vector3f point = points[j];
+        cumulants[0] += point(0);
+        cumulants[1] += point(1);
+        cumulants[2] += point(2);
+        cumulants[3] += point(0) * point(0);
+        cumulants[4] += point(0) * point(1);
+        cumulants[5] += point(0) * point(2);
+        cumulants[6] += point(1) * point(1);
+        cumulants[7] += point(1) * point(2);
+        cumulants[8] += point(2) * point(2);
+        count++;
     }
-    V = evec0.cross(U);
-
-    Eigen::Vector3f AU(A(0, 0) * U(0) + A(0, 1) * U(1) + A(0, 2) * U(2),
-                       A(0, 1) * U(0) + A(1, 1) * U(1) + A(1, 2) * U(2),
-                       A(0, 2) * U(0) + A(1, 2) * U(1) + A(2, 2) * U(2));
-
-    Eigen::Vector3f AV = {A(0, 0) * V(0) + A(0, 1) * V(1) + A(0, 2) * V(2),
-                          A(0, 1) * V(0) + A(1, 1) * V(1) + A(1, 2) * V(2),
-                          A(0, 2) * V(0) + A(1, 2) * V(1) + A(2, 2) * V(2)};
-
-    float m00 = U(0) * AU(0) + U(1) * AU(1) + U(2) * AU(2) - eval1;
-    float m01 = U(0) * AV(0) + U(1) * AV(1) + U(2) * AV(2);
-    float m11 = V(0) * AV(0) + V(1) * AV(1) + V(2) * AV(2) - eval1;
-
-    float absM00 = std::abs(m00);
-    float absM01 = std::abs(m01);
-    float absM11 = std::abs(m11);
-    float max_abs_comp;
-    if (absM00 >= absM11) {
-        max_abs_comp = max(absM00, absM01);
-        if (max_abs_comp > 0) {
-            if (absM00 >= absM01) {
-                m01 /= m00;
-                m00 = 1 / std::sqrt(1 + m01 * m01);
-                m01 *= m00;
-            } else {
-                m00 /= m01;
-                m01 = 1 / std::sqrt(1 + m00 * m00);
-                m00 *= m01;
-            }
-            return m01 * U - m00 * V;
-        } else {
-            return U;
-        }
-    } else {
-        max_abs_comp = max(absM11, absM01);
-        if (max_abs_comp > 0) {
-            if (absM11 >= absM01) {
-                m01 /= m11;
-                m11 = 1 / std::sqrt(1 + m01 * m01);
-                m01 *= m11;
-            } else {
-                m11 /= m01;
-                m01 = 1 / std::sqrt(1 + m11 * m11);
-                m11 *= m01;
-            }
-            return m11 * U - m01 * V;
-        } else {
-            return U;
+    for (int offset = kNormalWarpSize / 2; offset > 0; offset /= 2) {
+        for (int i = 0; i < 9; ++i) {
+            cumulants[i] += __shfl_down_sync(0xffffffff, cumulants[i], offset);
         }
+        count += __shfl_down_sync(0xffffffff, count, offset);
     }
-}
-
-__device__ Eigen::Vector3f FastEigen3x3(Eigen::Matrix3f &A) {
-    // Previous version based on:
-    // https://en.wikipedia.org/wiki/Eigenvalue_algorithm#3.C3.973_matrices
-    // Current version based on
-    // https://www.geometrictools.com/Documentation/RobustEigenSymmetric3x3.pdf
-    // which handles edge cases like points on a plane
-
-    float max_coeff = A.maxCoeff();
-    if (max_coeff == 0) {
-        return Eigen::Vector3f::Zero();
-    }
-    A /= max_coeff;
-
-    float norm = A(0, 1) * A(0, 1) + A(0, 2) * A(0, 2) + A(1, 2) * A(1, 2);
-    if (norm > 0) {
-        Eigen::Vector3f eval;
-        Eigen::Vector3f evec0;
-        Eigen::Vector3f evec1;
-        Eigen::Vector3f evec2;
-
-        float q = (A(0, 0) + A(1, 1) + A(2, 2)) / 3;
+    if (lane != 0) return;
 
-        float b00 = A(0, 0) - q;
-        float b11 = A(1, 1) - q;
-        float b22 = A(2, 2) - q;
-
-        float p = std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + norm * 2) / 6);
-
-        float c00 = b11 * b22 - A(1, 2) * A(1, 2);
-        float c01 = A(0, 1) * b22 - A(1, 2) * A(0, 2);
-        float c02 = A(0, 1) * A(1, 2) - b11 * A(0, 2);
-        float det = (b00 * c00 - A(0, 1) * c01 + A(0, 2) * c02) / (p * p * p);
-
-        float half_det = det * 0.5;
-        half_det = min(max(half_det, -1.0), 1.0);
-
-        float angle = std::acos(half_det) / (float)3;
-        float const two_thirds_pi = 2.09439510239319549;
-        float beta2 = std::cos(angle) * 2;
-        float beta0 = std::cos(angle + two_thirds_pi) * 2;
-        float beta1 = -(beta0 + beta2);
-
-        eval(0) = q + p * beta0;
-        eval(1) = q + p * beta1;
-        eval(2) = q + p * beta2;
-
-        if (half_det >= 0) {
-            evec2 = ComputeEigenvector0(A, eval(2));
-            if (eval(2) < eval(0) && eval(2) < eval(1)) {
-                A *= max_coeff;
-                return evec2;
-            }
-            evec1 = ComputeEigenvector1(A, evec2, eval(1));
-            A *= max_coeff;
-            if (eval(1) < eval(0) && eval(1) < eval(2)) {
-                return evec1;
-            }
-            evec0 = evec1.cross(evec2);
-            return evec0;
-        } else {
-            evec0 = ComputeEigenvector0(A, eval(0));
-            if (eval(0) < eval(1) && eval(0) < eval(2)) {
-                A *= max_coeff;
-                return evec0;
-            }
-            evec1 = ComputeEigenvector1(A, evec0, eval(1));
-            A *= max_coeff;
-            if (eval(1) < eval(0) && eval(1) < eval(2)) {
-                return evec1;
-            }
-            evec2 = evec0.cross(evec1);
-            return evec2;
+    Eigen::Vector3f normal(0.0, 0.0, 1.0);
+    Eigen::Vector3f evals = Eigen::Vector3f::Zero();
+    if (count >= 3) {
+        for (int i = 0; i < 9; ++i) cumulants[i] /= (float)count;
+        Eigen::Matrix3f covariance;
+        covariance(0, 0) = cumulants[3] - cumulants[0] * cumulants[0];
+        covariance(1, 1) = cumulants[6] - cumulants[1] * cumulants[1];
+        covariance(2, 2) = cumulants[8] - cumulants[2] * cumulants[2];
+        covariance(0, 1) = cumulants[4] - cumulants[0] * cumulants[1];
+        covariance(1, 0) = covariance(0, 1);
+        covariance(0, 2) = cumulants[5] - cumulants[0] * cumulants[2];
+        covariance(2, 0) = covariance(0, 2);
+        covariance(1, 2) = cumulants[7] - cumulants[1] * cumulants[2];
+        covariance(2, 1) = covariance(1, 2);
+        normal = FastEigen3x3(covariance, evals);
+        if (normal.norm() == 0.0) {
+            normal = Eigen::Vector3f(0.0, 0.0, 1.0);
         }
-    } else {
-        A *= max_coeff;
-        int min_id;
-        A.diagonal().minCoeff(&min_id);
-        Eigen::Vector3f unit = Eigen::Vector3f::Zero();
-        unit[min_id] = 1.0;
-        return unit;
+    }
+    if (normals) normals[idx] = normal;
+    if (eigenvalues) eigenvalues[idx] = evals;
+    if (curvatures) {
+        const float sum = evals.sum();
+        curvatures[idx] = (sum > 0.0) ? evals(0) / sum : 0.0;
     }
 }
 
-__device__ Eigen::Vector3f ComputeNormal(const Eigen::Vector3f *points,
-                                         const KNNIndices &indices,
-                                         int knn) {
-    if (indices[0] < 0) return Eigen::Vector3f(0.0, 0.0, 1.0);
-
-    Eigen::Matrix3f covariance;
-    Eigen::Matrix<float, 9, 1> cumulants;
-    cumulants.setZero();
-    int count = 0;
-    for (size_t i = 0; i < knn; i++) {
-        if (indices[i] < 0) break;
-        const Eigen::Vector3f &point = points[indices[i]];
-        cumulants(0) += point(0);
-        cumulants(1) += point(1);
-        cumulants(2) += point(2);
-        cumulants(3) += point(0) * point(0);
-        cumulants(4) += point(0) * point(1);
-        cumulants(5) += point(0) * point(2);
-        cumulants(6) += point(1) * point(1);
-        cumulants(7) += point(1) * point(2);
-        cumulants(8) += point(2) * point(2);
-        count++;
-    }
-    if (count < 3) return Eigen::Vector3f(0.0, 0.0, 1.0);
-    cumulants /= (float)count;
-    covariance(0, 0) = cumulants(3) - cumulants(0) * cumulants(0);
-    covariance(1, 1) = cumulants(6) - cumulants(1) * cumulants(1);
-    covariance(2, 2) = cumulants(8) - cumulants(2) * cumulants(2);
-    covariance(0, 1) = cumulants(4) - cumulants(0) * cumulants(1);
-    covariance(1, 0) = covariance(0, 1);
-    covariance(0, 2) = cumulants(5) - cumulants(0) * cumulants(2);
-    covariance(2, 0) = covariance(0, 2);
-    covariance(1, 2) = cumulants(7) - cumulants(1) * cumulants(2);
-    covariance(2, 1) = covariance(1, 2);
+void LaunchNeighborNormalsKernel(cudaStream_t stream,
+                                 const Eigen::Vector3f *points,
+                                 const int *indices,
+                                 int knn,
+                                 int n_points,
+                                 Eigen::Vector3f *normals,
+                                 Eigen::Vector3f *eigenvalues,
+                                 float *curvatures) {
+    const int n_blocks =
+            ((size_t)n_points * kNormalWarpSize + kNormalBlockSize - 1) /
+            kNormalBlockSize;
+    compute_neighbor_normals_kernel<<<n_blocks, kNormalBlockSize, 0, stream>>>(
+            points, indices, knn, n_points, normals, eigenvalues, curvatures);
+    cudaSafeCall(cudaGetLastError());
+}
 
-    return FastEigen3x3(covariance);
+void ComputeNeighborNormals(const utility::device_vector<Eigen::Vector3f> &points,
+                            const utility::device_vector<int> &indices,
+                            int knn,
+                            utility::device_vector<Eigen::Vector3f> &normals,
+                            Eigen::Vector3f *eigenvalues,
+                            float *curvatures) {
+    const int n_points = points.size();
+    normals.resize(n_points);
+    if (n_points == 0) return;
+    LaunchNeighborNormalsKernel(0, thrust::raw_pointer_cast(points.data()),
+                                thrust::raw_pointer_cast(indices.data()), knn,
+                                n_points,
+                                thrust::raw_pointer_cast(normals.data()),
+                                eigenvalues, curvatures);
 }
 
-struct compute_normal_functor {
-    compute_normal_functor(const Eigen::Vector3f *points,
-                           const int *indices,
-                           int knn)
-        : points_(points), indices_(indices), knn_(knn){};
+struct compute_organized_normal_functor {
+    compute_organized_normal_functor(const Eigen::Vector3f *points,
+                                     int width,
+                                     int height,
+                                     int step)
+        : points_(points), width_(width), height_(height), step_(step){};
     const Eigen::Vector3f *points_;
-    const int *indices_;
-    const int knn_;
-    __device__ Eigen::Vector3f operator()(const int &idx) const {
-        KNNIndices idxs = KNNIndices::Constant(-1);
-        for (int k = 0; k < knn_; ++k) idxs[k] = indices_[idx * knn_ + k];
-        Eigen::Vector3f normal = ComputeNormal(points_, idxs, knn_);
-        if (normal.norm() == 0.0) {
-            normal = Eigen::Vector3f(0.0, 0.0, 1.0);
+    const int width_;
+    const int height_;
+    const int step_;
+    __device__ bool IsValid(int row, int col) const {
+        return row >= 0 && row < height_ && col >= 0 && col < width_ &&
+               points_[row * width_ + col].allFinite();
+    }
+    // Shorter of the forward and backward differences along (drow, dcol).
+    __device__ bool Difference(int row,
+                               int col,
+                               int drow,
+                               int dcol,
+                               Eigen::Vector3f &diff) const {
+        const Eigen::Vector3f &center = points_[row * width_ + col];
+        const bool has_forward = IsValid(row + drow, col + dcol);
+        const bool has_backward = IsValid(row - drow, col - dcol);
+        if (!has_forward && !has_backward) return false;
+        const Eigen::Vector3f forward =
+                (has_forward) ? points_[(row + drow) * width_ + col + dcol] -
+                                        center
+                              : Eigen::Vector3f::Zero();
+        const Eigen::Vector3f backward =
+                (has_backward) ? center -
+                                         points_[(row - drow) * width_ + col -
+                                                 dcol]
+                               : Eigen::Vector3f::Zero();
+        if (!has_backward ||
+            (has_forward && forward.squaredNorm() < backward.squaredNorm())) {
+            diff = forward;
+        } else {
+            diff = backward;
+        }
+        return true;
+    }
+    __device__ Eigen::Vector3f operator()(int idx) const {
+        const int row = idx / width_;
+        const int col = idx % width_;
+        if (!points_[idx].allFinite()) {
+            return Eigen::Vector3f::Constant(
+                    std::numeric_limits<float>::quiet_NaN());
+        }
+        Eigen::Vector3f dx, dy;
+        if (!Difference(row, col, 0, step_, dx) ||
+            !Difference(row, col, step_, 0, dy)) {
+            return Eigen::Vector3f(0.0, 0.0, 1.0);
         }
-        return normal;
+        // The image x axis is right and the y axis is down, so y x x faces
+        // the camera.
+        const Eigen::Vector3f normal = dy.cross(dx);
+        const float norm = normal.norm();
+        return (norm == 0.0) ? Eigen::Vector3f(0.0, 0.0, 1.0)
+                             : Eigen::Vector3f(normal / norm);
     }
 };
 
@@ -250,15 +197,42 @@ struct align_normals_direction_functor {
 
 }  // namespace
 
-bool PointCloud::EstimateNormals(const KDTreeSearchParam &search_param) {
+void cupoch::geometry::EstimateNormalsFromNeighbors(
+        cudaStream_t stream,
+        const Eigen::Vector3f *points,
+        const int *indices,
+        int knn,
+        int n_points,
+        Eigen::Vector3f *normals) {
+    if (n_points == 0) return;
+    LaunchNeighborNormalsKernel(stream, points, indices, knn, n_points, normals,
+                                nullptr, nullptr);
+}
+
+void cupoch::geometry::ComputeNeighborEigenvalues(
+        cudaStream_t stream,
+        const Eigen::Vector3f *points,
+        const int *indices,
+        int knn,
+        int n_points,
+        Eigen::Vector3f *eigenvalues) {
+    if (n_points == 0) return;
+    LaunchNeighborNormalsKernel(stream, points, indices, knn, n_points,
+                                nullptr, eigenvalues, nullptr);
+}
+
+bool PointCloud::EstimateNormals(const KDTreeSearchParam &search_param,
+                                 SearchIndexType index_type) {
+    CUPOCH_PROFILE("PointCloud::EstimateNormals");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
     if (HasNormals() == false) {
         normals_.resize(points_.size());
     }
-    KDTreeFlann kdtree;
-    kdtree.SetGeometry(*this);
     utility::device_vector<int> indices;
     utility::device_vector<float> distance2;
-    kdtree.Search(points_, search_param, indices, distance2);
+    SearchNeighbors(index_type, points_, points_, search_param, indices,
+                    distance2);
     int knn;
     switch (search_param.GetSearchType()) {
         case KDTreeSearchParam::SearchType::Knn:
@@ -274,8 +248,68 @@ bool PointCloud::EstimateNormals(const KDTreeSearchParam &search_param) {
             utility::LogError("Unknown search param type.");
             return false;
     }
-    compute_normal_functor func(thrust::raw_pointer_cast(points_.data()),
-                                thrust::raw_pointer_cast(indices.data()), knn);
+    ComputeNeighborNormals(points_, indices, knn, normals_, nullptr, nullptr);
+    return true;
+}
+
+bool PointCloud::EstimateNormals(const utility::device_vector<int> &indices,
+                                 int knn) {
+    if (knn < 1 || indices.size() != points_.size() * knn) {
+        utility::LogWarning(
+                "[EstimateNormals] The neighbor list does not match the "
+                "points.\n");
+        return false;
+    }
+    ComputeNeighborNormals(points_, indices, knn, normals_, nullptr, nullptr);
+    return true;
+}
+
+bool PointCloud::EstimateNormals(
+        const utility::device_vector<int> &indices,
+        int knn,
+        utility::device_vector<Eigen::Vector3f> &eigenvalues,
+        utility::device_vector<float> &curvatures) {
+    if (knn < 1 || indices.size() != points_.size() * knn) {
+        utility::LogWarning(
+                "[EstimateNormals] The neighbor list does not match the "
+                "points.\n");
+        return false;
+    }
+    eigenvalues.resize(points_.size());
+    curvatures.resize(points_.size());
+    ComputeNeighborNormals(points_, indices, knn, normals_,
+                           thrust::raw_pointer_cast(eigenvalues.data()),
+                           thrust::raw_pointer_cast(curvatures.data()));
+    return true;
+}
+
+bool PointCloud::EstimateNormals(NeighborhoodCache &cache,
+                                 const KDTreeSearchParam &search_param) {
+    if (&cache.GetPointCloud() != this) {
+        utility::LogWarning(
+                "[EstimateNormals] The cache is built on another point "
+                "cloud.\n");
+        return false;
+    }
+    const auto &neighborhood = cache.GetNeighborhood(search_param);
+    return EstimateNormals(neighborhood.indices_, neighborhood.knn_);
+}
+
+bool PointCloud::EstimateOrganizedNormals(int width, int height, int step) {
+    if (width <= 0 || height <= 0 ||
+        points_.size() != (size_t)width * (size_t)height) {
+        utility::LogWarning(
+                "[EstimateOrganizedNormals] The number of points does not "
+                "match the image size.\n");
+        return false;
+    }
+    if (step < 1) {
+        utility::LogWarning("[EstimateOrganizedNormals] step < 1.\n");
+        return false;
+    }
+    normals_.resize(points_.size());
+    compute_organized_normal_functor func(
+            thrust::raw_pointer_cast(points_.data()), width, height, step);
     thrust::transform(thrust::make_counting_iterator(0),
                       thrust::make_counting_iterator((int)points_.size()),
                       normals_.begin(), func);
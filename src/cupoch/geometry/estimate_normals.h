@@ -0,0 +1,216 @@
+#pragma once
+#include <cuda_runtime.h>
+
+#include <Eigen/Core>
+
+#ifdef __CUDACC__
+#include <thrust/execution_policy.h>
+#include <thrust/sort.h>
+
+#include <Eigen/Geometry>
+#endif
+
+namespace cupoch {
+namespace geometry {
+
+/// Fits the normal of every point to \p knn neighbor indices per point
+/// (row major, padded with -1), as EstimateNormals does after its search.
+/// Works on raw device pointers and only enqueues one kernel on \p stream,
+/// so it can be recorded in a utility::CUDAGraph. Points with less than 3
+/// neighbors get (0, 0, 1).
+void EstimateNormalsFromNeighbors(cudaStream_t stream,
+                                  const Eigen::Vector3f *points,
+                                  const int *indices,
+                                  int knn,
+                                  int n_points,
+                                  Eigen::Vector3f *normals);
+
+/// Eigenvalues, in ascending order, of the covariance of the \p knn
+/// neighbors of every point, from the kernel of EstimateNormalsFromNeighbors.
+/// They are zero for the points with less than 3 neighbors.
+void ComputeNeighborEigenvalues(cudaStream_t stream,
+                                const Eigen::Vector3f *points,
+                                const int *indices,
+                                int knn,
+                                int n_points,
+                                Eigen::Vector3f *eigenvalues);
+
+#ifdef __CUDACC__
+inline __device__ Eigen::Vector3f ComputeEigenvector0(
+        const Eigen::Matrix3f &A, float eval0) {
+    Eigen::Vector3f row0(A(0, 0) - eval0, A(0, 1), A(0, 2));
+    Eigen::Vector3f row1(A(0, 1), A(1, 1) - eval0, A(1, 2));
+    Eigen::Vector3f row2(A(0, 2), A(1, 2), A(2, 2) - eval0);
+    Eigen::Vector3f rxr[3];
+    rxr[0] = row0.cross(row1);
+    rxr[1] = row0.cross(row2);
+    rxr[2] = row1.cross(row2);
+    Eigen::Vector3f d;
+    d[0] = rxr[0].dot(rxr[0]);
+    d[1] = rxr[1].dot(rxr[1]);
+    d[2] = rxr[2].dot(rxr[2]);
+
+    int imax;
+    d.maxCoeff(&imax);
+    return rxr[imax] / std::sqrt(d[imax]);
+}
+
+inline __device__ Eigen::Vector3f ComputeEigenvector1(
+        const Eigen::Matrix3f &A, const Eigen::Vector3f &evec0, float eval1) {
+    Eigen::Vector3f U, V;
+    if (std::abs(evec0(0)) > std::abs(evec0(1))) {
+        float inv_length =
+                1 / std::sqrt(evec0(0) * evec0(0) + evec0(2) * evec0(2));
+        U << -evec0(2) * inv_length, 0, evec0(0) * inv_length;
+    } else {
+        float inv_length =
+                1 / std::sqrt(evec0(1) * evec0(1) + evec0(2) * evec0(2));
+        U << 0, evec0(2) * inv_length, -evec0(1) * inv_length;
+    }
+    V = evec0.cross(U);
+
+    Eigen::Vector3f AU(A(0, 0) * U(0) + A(0, 1) * U(1) + A(0, 2) * U(2),
+                       A(0, 1) * U(0) + A(1, 1) * U(1) + A(1, 2) * U(2),
+                       A(0, 2) * U(0) + A(1, 2) * U(1) + A(2, 2) * U(2));
+
+    Eigen::Vector3f AV = {A(0, 0) * V(0) + A(0, 1) * V(1) + A(0, 2) * V(2),
+                          A(0, 1) * V(0) + A(1, 1) * V(1) + A(1, 2) * V(2),
+                          A(0, 2) * V(0) + A(1, 2) * V(1) + A(2, 2) * V(2)};
+
+    float m00 = U(0) * AU(0) + U(1) * AU(1) + U(2) * AU(2) - eval1;
+    float m01 = U(0) * AV(0) + U(1) * AV(1) + U(2) * AV(2);
+    float m11 = V(0) * AV(0) + V(1) * AV(1) + V(2) * AV(2) - eval1;
+
+    float absM00 = std::abs(m00);
+    float absM01 = std::abs(m01);
+    float absM11 = std::abs(m11);
+    float max_abs_comp;
+    if (absM00 >= absM11) {
+        max_abs_comp = max(absM00, absM01);
+        if (max_abs_comp > 0) {
+            if (absM00 >= absM01) {
+                m01 /= m00;
+                m00 = 1 / std::sqrt(1 + m01 * m01);
+                m01 *= m00;
+            } else {
+                m00 /= m01;
+                m01 = 1 / std::sqrt(1 + m00 * m00);
+                m00 *= m01;
+            }
+            return m01 * U - m00 * V;
+        } else {
+            return U;
+        }
+    } else {
+        max_abs_comp = max(absM11, absM01);
+        if (max_abs_comp > 0) {
+            if (absM11 >= absM01) {
+                m01 /= m11;
+                m11 = 1 / std::sqrt(1 + m01 * m01);
+                m01 *= m11;
+            } else {
+                m11 /= m01;
+                m01 = 1 / std::sqrt(1 + m11 * m11);
+                m11 *= m01;
+            }
+            return m11 * U - m01 * V;
+        } else {
+            return U;
+        }
+    }
+}
+
+// Returns the eigenvector of the smallest eigenvalue, \p evals gets the
+// eigenvalues in ascending order.
+inline __device__ Eigen::Vector3f FastEigen3x3(Eigen::Matrix3f &A,
+                                               Eigen::Vector3f &evals) {
+    // Previous version based on:
+    // https://en.wikipedia.org/wiki/Eigenvalue_algorithm#3.C3.973_matrices
+    // Current version based on
+    // https://www.geometrictools.com/Documentation/RobustEigenSymmetric3x3.pdf
+    // which handles edge cases like points on a plane
+
+    float max_coeff = A.maxCoeff();
+    if (max_coeff == 0) {
+        evals = Eigen::Vector3f::Zero();
+        return Eigen::Vector3f::Zero();
+    }
+    A /= max_coeff;
+
+    float norm = A(0, 1) * A(0, 1) + A(0, 2) * A(0, 2) + A(1, 2) * A(1, 2);
+    if (norm > 0) {
+        Eigen::Vector3f eval;
+        Eigen::Vector3f evec0;
+        Eigen::Vector3f evec1;
+        Eigen::Vector3f evec2;
+
+        float q = (A(0, 0) + A(1, 1) + A(2, 2)) / 3;
+
+        float b00 = A(0, 0) - q;
+        float b11 = A(1, 1) - q;
+        float b22 = A(2, 2) - q;
+
+        float p = std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + norm * 2) / 6);
+
+        float c00 = b11 * b22 - A(1, 2) * A(1, 2);
+        float c01 = A(0, 1) * b22 - A(1, 2) * A(0, 2);
+        float c02 = A(0, 1) * A(1, 2) - b11 * A(0, 2);
+        float det = (b00 * c00 - A(0, 1) * c01 + A(0, 2) * c02) / (p * p * p);
+
+        float half_det = det * 0.5;
+        half_det = min(max(half_det, -1.0), 1.0);
+
+        float angle = std::acos(half_det) / (float)3;
+        float const two_thirds_pi = 2.09439510239319549;
+        float beta2 = std::cos(angle) * 2;
+        float beta0 = std::cos(angle + two_thirds_pi) * 2;
+        float beta1 = -(beta0 + beta2);
+
+        eval(0) = q + p * beta0;
+        eval(1) = q + p * beta1;
+        eval(2) = q + p * beta2;
+        // beta0 <= beta1 <= beta2, so the eigenvalues are already sorted.
+        evals = eval * max_coeff;
+
+        if (half_det >= 0) {
+            evec2 = ComputeEigenvector0(A, eval(2));
+            if (eval(2) < eval(0) && eval(2) < eval(1)) {
+                A *= max_coeff;
+                return evec2;
+            }
+            evec1 = ComputeEigenvector1(A, evec2, eval(1));
+            A *= max_coeff;
+            if (eval(1) < eval(0) && eval(1) < eval(2)) {
+                return evec1;
+            }
+            evec0 = evec1.cross(evec2);
+            return evec0;
+        } else {
+            evec0 = ComputeEigenvector0(A, eval(0));
+            if (eval(0) < eval(1) && eval(0) < eval(2)) {
+                A *= max_coeff;
+                return evec0;
+            }
+            evec1 = ComputeEigenvector1(A, evec0, eval(1));
+            A *= max_coeff;
+            if (eval(1) < eval(0) && eval(1) < eval(2)) {
+                return evec1;
+            }
+            evec2 = evec0.cross(evec1);
+            return evec2;
+        }
+    } else {
+        A *= max_coeff;
+        int min_id;
+        A.diagonal().minCoeff(&min_id);
+        evals = A.diagonal();
+        thrust::sort(thrust::seq, evals.data(), evals.data() + 3);
+        Eigen::Vector3f unit = Eigen::Vector3f::Zero();
+        unit[min_id] = 1.0;
+        return unit;
+    }
+}
+#endif
+
+}  // namespace geometry
+}  // namespace cupoch
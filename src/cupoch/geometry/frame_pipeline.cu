@@ -0,0 +1,314 @@
+#include <cub/device/device_radix_sort.cuh>
+#include <cub/device/device_reduce.cuh>
+#include <thrust/binary_search.h>
+
+#include <algorithm>
+
+#include "cupoch/geometry/estimate_normals.h"
+#include "cupoch/geometry/frame_pipeline.h"
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+constexpr int kKeyBits = 21;
+constexpr int kKeyOffset = 1 << (kKeyBits - 1);
+constexpr unsigned long long kEmptyKey = ~0ull;
+constexpr int kNumNeighborVoxels = 27;
+constexpr int kBlockSize = 128;
+
+__device__ unsigned long long PackVoxelKey(const Eigen::Vector3i &cell) {
+    for (int i = 0; i < 3; ++i) {
+        if (cell[i] < -kKeyOffset || cell[i] >= kKeyOffset) return kEmptyKey;
+    }
+    return ((unsigned long long)(cell[0] + kKeyOffset) << (2 * kKeyBits)) |
+           ((unsigned long long)(cell[1] + kKeyOffset) << kKeyBits) |
+           (unsigned long long)(cell[2] + kKeyOffset);
+}
+
+__device__ Eigen::Vector3i UnpackVoxelKey(unsigned long long key) {
+    const unsigned long long mask = (1ull << kKeyBits) - 1;
+    return Eigen::Vector3i(int((key >> (2 * kKeyBits)) & mask) - kKeyOffset,
+                           int((key >> kKeyBits) & mask) - kKeyOffset,
+                           int(key & mask) - kKeyOffset);
+}
+
+__global__ void unproject_depth_kernel(const uint8_t *depth,
+                                       int bytes_per_channel,
+                                       int width,
+                                       int n_pixels,
+                                       thrust::pair<float, float> focal_length,
+                                       thrust::pair<float, float> principal_point,
+                                       Eigen::Matrix4f camera_pose,
+                                       float depth_scale,
+                                       float depth_trunc,
+                                       float voxel_size,
+                                       Eigen::Vector3f *points,
+                                       unsigned long long *keys,
+                                       int *pixels) {
+    const int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (idx >= n_pixels) return;
+    float d;
+    if (bytes_per_channel == 2) {
+        d = ((const uint16_t *)depth)[idx] / depth_scale;
+        if (d >= depth_trunc) d = 0.0;
+    } else {
+        d = ((const float *)depth)[idx];
+    }
+    pixels[idx] = idx;
+    if (!(d > 0.0)) {
+        keys[idx] = kEmptyKey;
+        return;
+    }
+    const int row = idx / width;
+    const int col = idx % width;
+    const float x = (col - principal_point.first) * d / focal_length.first;
+    const float y = (row - principal_point.second) * d / focal_length.second;
+    const Eigen::Vector3f p = camera_pose.block<3, 3>(0, 0) *
+                                      Eigen::Vector3f(x, y, d) +
+                              camera_pose.block<3, 1>(0, 3);
+    points[idx] = p;
+    keys[idx] = PackVoxelKey(Eigen::Vector3i(int(floor(p(0) / voxel_size)),
+                                             int(floor(p(1) / voxel_size)),
+                                             int(floor(p(2) / voxel_size))));
+}
+
+struct point_sum_functor {
+    point_sum_functor(const Eigen::Vector3f *points) : points_(points){};
+    const Eigen::Vector3f *points_;
+    __device__ Eigen::Vector4f operator()(int pixel) const {
+        const Eigen::Vector3f &p = points_[pixel];
+        return Eigen::Vector4f(p(0), p(1), p(2), 1.0);
+    }
+};
+
+struct add_vector4f_functor {
+    __host__ __device__ Eigen::Vector4f operator()(
+            const Eigen::Vector4f &x, const Eigen::Vector4f &y) const {
+        return x + y;
+    }
+};
+
+// The invalid pixels share the largest key, so they form the last run.
+__global__ void finalize_voxels_kernel(const unsigned long long *voxel_keys,
+                                       const Eigen::Vector4f *voxel_sums,
+                                       const int *num_runs,
+                                       int capacity,
+                                       Eigen::Vector3f *out_points,
+                                       int *num_points) {
+    const int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (idx >= capacity) return;
+    const int n_runs = *num_runs;
+    const int n = (n_runs > 0 && voxel_keys[n_runs - 1] == kEmptyKey)
+                          ? n_runs - 1
+                          : n_runs;
+    if (idx == 0) *num_points = n;
+    if (idx >= n) return;
+    const Eigen::Vector4f &s = voxel_sums[idx];
+    out_points[idx] = s.head<3>() / s(3);
+}
+
+__global__ void voxel_neighbors_kernel(const unsigned long long *voxel_keys,
+                                       const int *num_points,
+                                       int capacity,
+                                       int *neighbors) {
+    const int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (idx >= capacity) return;
+    const int n = *num_points;
+    int *out = neighbors + idx * kNumNeighborVoxels;
+    if (idx >= n) {
+        for (int k = 0; k < kNumNeighborVoxels; ++k) out[k] = -1;
+        return;
+    }
+    const Eigen::Vector3i cell = UnpackVoxelKey(voxel_keys[idx]);
+    int k = 0;
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const unsigned long long key =
+                        PackVoxelKey(cell + Eigen::Vector3i(dx, dy, dz));
+                const int j = thrust::lower_bound(thrust::seq, voxel_keys,
+                                                  voxel_keys + n, key) -
+                              voxel_keys;
+                out[k++] = (key != kEmptyKey && j < n && voxel_keys[j] == key)
+                                   ? j
+                                   : -1;
+            }
+        }
+    }
+}
+
+int NumBlocks(size_t n) { return (n + kBlockSize - 1) / kBlockSize; }
+
+}  // namespace
+
+DepthFramePipeline::DepthFramePipeline(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        float voxel_size,
+        const Eigen::Matrix4f &extrinsic,
+        float depth_scale,
+        float depth_trunc,
+        bool estimate_normals)
+    : DepthFramePipeline(utility::ExecutionContext::Default(),
+                         intrinsic,
+                         voxel_size,
+                         extrinsic,
+                         depth_scale,
+                         depth_trunc,
+                         estimate_normals) {}
+
+DepthFramePipeline::DepthFramePipeline(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        float voxel_size,
+        const Eigen::Matrix4f &extrinsic,
+        float depth_scale,
+        float depth_trunc,
+        bool estimate_normals)
+    : context_(&ctx),
+      width_(std::max(intrinsic.width_, 0)),
+      height_(std::max(intrinsic.height_, 0)),
+      capacity_(width_ * height_),
+      focal_length_(intrinsic.GetFocalLength()),
+      principal_point_(intrinsic.GetPrincipalPoint()),
+      camera_pose_(extrinsic.inverse()),
+      voxel_size_(voxel_size),
+      depth_scale_(depth_scale),
+      depth_trunc_(depth_trunc),
+      estimate_normals_(estimate_normals),
+      depth_(capacity_ * sizeof(float)),
+      points_(capacity_),
+      keys_(capacity_),
+      sorted_keys_(capacity_),
+      pixels_(capacity_),
+      sorted_pixels_(capacity_),
+      voxel_keys_(capacity_),
+      voxel_sums_(capacity_),
+      num_runs_(1, 0),
+      num_points_(1, 0),
+      out_points_(capacity_),
+      out_normals_(estimate_normals ? capacity_ : 0),
+      neighbors_(estimate_normals ? capacity_ * kNumNeighborVoxels : 0) {
+    if (voxel_size <= 0.0) {
+        utility::LogError("[DepthFramePipeline] voxel_size must be positive.");
+    }
+    size_t sort_bytes = 0;
+    cudaSafeCall(cub::DeviceRadixSort::SortPairs(
+            NULL, sort_bytes, thrust::raw_pointer_cast(keys_.data()),
+            thrust::raw_pointer_cast(sorted_keys_.data()),
+            thrust::raw_pointer_cast(pixels_.data()),
+            thrust::raw_pointer_cast(sorted_pixels_.data()), capacity_));
+    size_t reduce_bytes = 0;
+    cudaSafeCall(cub::DeviceReduce::ReduceByKey(
+            NULL, reduce_bytes, thrust::raw_pointer_cast(sorted_keys_.data()),
+            thrust::raw_pointer_cast(voxel_keys_.data()),
+            thrust::make_transform_iterator(
+                    thrust::raw_pointer_cast(sorted_pixels_.data()),
+                    point_sum_functor(
+                            thrust::raw_pointer_cast(points_.data()))),
+            thrust::raw_pointer_cast(voxel_sums_.data()),
+            thrust::raw_pointer_cast(num_runs_.data()), add_vector4f_functor(),
+            capacity_));
+    temp_.resize(std::max(sort_bytes, reduce_bytes));
+}
+
+DepthFramePipeline::~DepthFramePipeline() {}
+
+bool DepthFramePipeline::Process(const Image &depth) {
+    if (depth.width_ != width_ || depth.height_ != height_ ||
+        depth.num_of_channels_ != 1 ||
+        (depth.bytes_per_channel_ != 2 && depth.bytes_per_channel_ != 4)) {
+        utility::LogError(
+                "[DepthFramePipeline] The depth image must be a 16 bit or "
+                "float image of the size of the intrinsic.");
+        return false;
+    }
+    if (capacity_ == 0 || voxel_size_ <= 0.0) return false;
+    cudaSafeCall(cudaMemcpyAsync(thrust::raw_pointer_cast(depth_.data()),
+                                 thrust::raw_pointer_cast(depth.data_.data()),
+                                 capacity_ * depth.bytes_per_channel_,
+                                 cudaMemcpyDeviceToDevice,
+                                 context_->GetStream()));
+    if (!graph_.IsCaptured() ||
+        bytes_per_channel_ != depth.bytes_per_channel_) {
+        bytes_per_channel_ = depth.bytes_per_channel_;
+        if (!graph_.Capture([this](cudaStream_t stream) { Enqueue(stream); })) {
+            return false;
+        }
+    }
+    return graph_.Launch(*context_);
+}
+
+std::shared_ptr<PointCloud> DepthFramePipeline::GetPointCloud() const {
+    auto pointcloud = std::make_shared<PointCloud>();
+    if (!graph_.IsCaptured()) return pointcloud;
+    int n_points = 0;
+    cudaSafeCall(cudaMemcpyAsync(&n_points,
+                                 thrust::raw_pointer_cast(num_points_.data()),
+                                 sizeof(int), cudaMemcpyDeviceToHost,
+                                 context_->GetStream()));
+    context_->Synchronize();
+    pointcloud->points_.assign(out_points_.begin(),
+                               out_points_.begin() + n_points);
+    if (estimate_normals_) {
+        pointcloud->normals_.assign(out_normals_.begin(),
+                                    out_normals_.begin() + n_points);
+    }
+    return pointcloud;
+}
+
+void DepthFramePipeline::Enqueue(cudaStream_t stream) {
+    unproject_depth_kernel<<<NumBlocks(capacity_), kBlockSize, 0, stream>>>(
+            thrust::raw_pointer_cast(depth_.data()), bytes_per_channel_,
+            width_, capacity_, focal_length_, principal_point_, camera_pose_,
+            depth_scale_, depth_trunc_, voxel_size_,
+            thrust::raw_pointer_cast(points_.data()),
+            thrust::raw_pointer_cast(keys_.data()),
+            thrust::raw_pointer_cast(pixels_.data()));
+    cudaSafeCall(cudaGetLastError());
+    size_t temp_bytes = temp_.size();
+    cudaSafeCall(cub::DeviceRadixSort::SortPairs(
+            thrust::raw_pointer_cast(temp_.data()), temp_bytes,
+            thrust::raw_pointer_cast(keys_.data()),
+            thrust::raw_pointer_cast(sorted_keys_.data()),
+            thrust::raw_pointer_cast(pixels_.data()),
+            thrust::raw_pointer_cast(sorted_pixels_.data()), capacity_, 0,
+            sizeof(unsigned long long) * 8, stream));
+    temp_bytes = temp_.size();
+    cudaSafeCall(cub::DeviceReduce::ReduceByKey(
+            thrust::raw_pointer_cast(temp_.data()), temp_bytes,
+            thrust::raw_pointer_cast(sorted_keys_.data()),
+            thrust::raw_pointer_cast(voxel_keys_.data()),
+            thrust::make_transform_iterator(
+                    thrust::raw_pointer_cast(sorted_pixels_.data()),
+                    point_sum_functor(
+                            thrust::raw_pointer_cast(points_.data()))),
+            thrust::raw_pointer_cast(voxel_sums_.data()),
+            thrust::raw_pointer_cast(num_runs_.data()), add_vector4f_functor(),
+            capacity_, stream));
+    finalize_voxels_kernel<<<NumBlocks(capacity_), kBlockSize, 0, stream>>>(
+            thrust::raw_pointer_cast(voxel_keys_.data()),
+            thrust::raw_pointer_cast(voxel_sums_.data()),
+            thrust::raw_pointer_cast(num_runs_.data()), capacity_,
+            thrust::raw_pointer_cast(out_points_.data()),
+            thrust::raw_pointer_cast(num_points_.data()));
+    cudaSafeCall(cudaGetLastError());
+    if (!estimate_normals_) return;
+    voxel_neighbors_kernel<<<NumBlocks(capacity_), kBlockSize, 0, stream>>>(
+            thrust::raw_pointer_cast(voxel_keys_.data()),
+            thrust::raw_pointer_cast(num_points_.data()), capacity_,
+            thrust::raw_pointer_cast(neighbors_.data()));
+    cudaSafeCall(cudaGetLastError());
+    // The slots past the number of voxels have no neighbors and get a dummy
+    // normal, so the launch size does not depend on the frame.
+    EstimateNormalsFromNeighbors(stream,
+                                 thrust::raw_pointer_cast(out_points_.data()),
+                                 thrust::raw_pointer_cast(neighbors_.data()),
+                                 kNumNeighborVoxels, capacity_,
+                                 thrust::raw_pointer_cast(out_normals_.data()));
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/utility/cuda_graph.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/execution_context.h"
+
+namespace cupoch {
+namespace geometry {
+
+class Image;
+class PointCloud;
+
+/// \class DepthFramePipeline
+///
+/// \brief CreateFromDepthImage, VoxelDownSample and EstimateNormals on a
+/// stream of depth frames of one size, replayed as one CUDA graph.
+///
+/// The buffers are allocated at construction with one point per pixel and
+/// the stages only use kernels and cub calls that neither synchronize nor
+/// allocate, so the whole frame is recorded once on the first Process()
+/// and replayed on the next ones after the new depth is copied into the
+/// input buffer. The number of points stays on the device until
+/// GetPointCloud().
+///
+/// Unlike VoxelDownSample, the voxels are anchored at the origin rather
+/// than at the minimum bound of the frame. The normal of a voxel is fit to
+/// the centers of the 3x3x3 voxels around it, which is close to
+/// EstimateNormals with a hybrid search within 1.5 voxels. The result can
+/// be registered with registration::RegistrationICPOnDevice(), which
+/// replays its own graph.
+class DepthFramePipeline {
+public:
+    DepthFramePipeline(const camera::PinholeCameraIntrinsic &intrinsic,
+                       float voxel_size,
+                       const Eigen::Matrix4f &extrinsic =
+                               Eigen::Matrix4f::Identity(),
+                       float depth_scale = 1000.0,
+                       float depth_trunc = 1000.0,
+                       bool estimate_normals = true);
+    DepthFramePipeline(utility::ExecutionContext &ctx,
+                       const camera::PinholeCameraIntrinsic &intrinsic,
+                       float voxel_size,
+                       const Eigen::Matrix4f &extrinsic =
+                               Eigen::Matrix4f::Identity(),
+                       float depth_scale = 1000.0,
+                       float depth_trunc = 1000.0,
+                       bool estimate_normals = true);
+    ~DepthFramePipeline();
+    DepthFramePipeline(const DepthFramePipeline &) = delete;
+    DepthFramePipeline &operator=(const DepthFramePipeline &) = delete;
+
+public:
+    /// Runs the pipeline on \p depth, a 16 bit or float depth image of the
+    /// size of the intrinsic. The work is only enqueued.
+    bool Process(const Image &depth);
+    /// Result of the last Process().
+    std::shared_ptr<PointCloud> GetPointCloud() const;
+    size_t GetCapacity() const { return capacity_; }
+
+private:
+    /// Enqueues one frame on \p stream without any synchronization.
+    void Enqueue(cudaStream_t stream);
+
+    utility::ExecutionContext *context_;
+    int width_;
+    int height_;
+    size_t capacity_;
+    thrust::pair<float, float> focal_length_;
+    thrust::pair<float, float> principal_point_;
+    Eigen::Matrix4f camera_pose_;
+    float voxel_size_;
+    float depth_scale_;
+    float depth_trunc_;
+    bool estimate_normals_;
+    /// Format of the recorded graph, 0 before the first frame.
+    int bytes_per_channel_ = 0;
+    utility::CUDAGraph graph_;
+
+    utility::device_vector<uint8_t> depth_;
+    utility::device_vector<Eigen::Vector3f> points_;
+    utility::device_vector<unsigned long long> keys_;
+    utility::device_vector<unsigned long long> sorted_keys_;
+    utility::device_vector<int> pixels_;
+    utility::device_vector<int> sorted_pixels_;
+    utility::device_vector<unsigned long long> voxel_keys_;
+    utility::device_vector<Eigen::Vector4f> voxel_sums_;
+    utility::device_vector<int> num_runs_;
+    utility::device_vector<int> num_points_;
+    utility::device_vector<Eigen::Vector3f> out_points_;
+    utility::device_vector<Eigen::Vector3f> out_normals_;
+    utility::device_vector<int> neighbors_;
+    utility::device_vector<char> temp_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -29,6 +29,53 @@ struct transform_normals_functor {
         nl = new_pt.head<3>();
     }
 };
+
+// The moments are taken relative to a point of the set, so that the
+// covariance of points far from the origin keeps its precision.
+struct point_moments {
+    Eigen::Vector3f min_;
+    Eigen::Vector3f max_;
+    Eigen::Vector3f sum_;
+    // xx, xy, xz, yy, yz, zz.
+    float sum2_[6];
+};
+
+template <bool ComputeSecondMoments>
+struct compute_point_moments_functor {
+    compute_point_moments_functor(const Eigen::Vector3f &ref) : ref_(ref){};
+    const Eigen::Vector3f ref_;
+    __device__ point_moments operator()(const Eigen::Vector3f &pt) const {
+        point_moments m;
+        m.min_ = pt;
+        m.max_ = pt;
+        const Eigen::Vector3f d = pt - ref_;
+        m.sum_ = d;
+        if (ComputeSecondMoments) {
+            m.sum2_[0] = d(0) * d(0);
+            m.sum2_[1] = d(0) * d(1);
+            m.sum2_[2] = d(0) * d(2);
+            m.sum2_[3] = d(1) * d(1);
+            m.sum2_[4] = d(1) * d(2);
+            m.sum2_[5] = d(2) * d(2);
+        } else {
+            for (int i = 0; i < 6; ++i) m.sum2_[i] = 0.0f;
+        }
+        return m;
+    }
+};
+
+struct add_point_moments_functor {
+    __device__ point_moments operator()(const point_moments &a,
+                                        const point_moments &b) const {
+        point_moments m;
+        m.min_ = a.min_.array().min(b.min_.array()).matrix();
+        m.max_ = a.max_.array().max(b.max_.array()).matrix();
+        m.sum_ = a.sum_ + b.sum_;
+        for (int i = 0; i < 6; ++i) m.sum2_[i] = a.sum2_[i] + b.sum2_[i];
+        return m;
+    }
+};
+
 }  // namespace
 
 Eigen::Vector3f Geometry3D::ComputeMinBound(
@@ -70,6 +117,57 @@ Eigen::Vector3f Geometry3D::ComputeCenter(
     return sum / points.size();
 }
 
+PointStatistics Geometry3D::ComputePointStatistics(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        bool compute_covariance) const {
+    return ComputePointStatistics(0, points, compute_covariance);
+}
+
+PointStatistics Geometry3D::ComputePointStatistics(
+        cudaStream_t stream,
+        const utility::device_vector<Eigen::Vector3f> &points,
+        bool compute_covariance) const {
+    PointStatistics stats;
+    if (points.empty()) return stats;
+    const Eigen::Vector3f ref = points[0];
+    point_moments init;
+    init.min_ = ref;
+    init.max_ = ref;
+    init.sum_ = Eigen::Vector3f::Zero();
+    for (int i = 0; i < 6; ++i) init.sum2_[i] = 0.0f;
+    point_moments m;
+    if (compute_covariance) {
+        m = thrust::transform_reduce(
+                utility::exec_policy(stream)->on(stream), points.begin(),
+                points.end(), compute_point_moments_functor<true>(ref), init,
+                add_point_moments_functor());
+    } else {
+        m = thrust::transform_reduce(
+                utility::exec_policy(stream)->on(stream), points.begin(),
+                points.end(), compute_point_moments_functor<false>(ref), init,
+                add_point_moments_functor());
+    }
+    const float n = points.size();
+    const Eigen::Vector3f mean_d = m.sum_ / n;
+    stats.min_bound_ = m.min_;
+    stats.max_bound_ = m.max_;
+    stats.mean_ = ref + mean_d;
+    stats.num_points_ = points.size();
+    if (compute_covariance) {
+        Eigen::Matrix3f &cov = stats.covariance_;
+        cov(0, 0) = m.sum2_[0] / n - mean_d(0) * mean_d(0);
+        cov(0, 1) = m.sum2_[1] / n - mean_d(0) * mean_d(1);
+        cov(0, 2) = m.sum2_[2] / n - mean_d(0) * mean_d(2);
+        cov(1, 1) = m.sum2_[3] / n - mean_d(1) * mean_d(1);
+        cov(1, 2) = m.sum2_[4] / n - mean_d(1) * mean_d(2);
+        cov(2, 2) = m.sum2_[5] / n - mean_d(2) * mean_d(2);
+        cov(1, 0) = cov(0, 1);
+        cov(2, 0) = cov(0, 2);
+        cov(2, 1) = cov(1, 2);
+    }
+    return stats;
+}
+
 void Geometry3D::ResizeAndPaintUniformColor(
         utility::device_vector<Eigen::Vector3f> &colors,
         const size_t size,
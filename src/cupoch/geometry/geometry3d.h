@@ -9,6 +9,16 @@ namespace geometry {
 class AxisAlignedBoundingBox;
 class OrientedBoundingBox;
 
+/// Bounds and moments of a set of points, computed in one pass.
+struct PointStatistics {
+    Eigen::Vector3f min_bound_ = Eigen::Vector3f::Zero();
+    Eigen::Vector3f max_bound_ = Eigen::Vector3f::Zero();
+    Eigen::Vector3f mean_ = Eigen::Vector3f::Zero();
+    /// Zero unless requested.
+    Eigen::Matrix3f covariance_ = Eigen::Matrix3f::Zero();
+    size_t num_points_ = 0;
+};
+
 class Geometry3D : public Geometry {
 public:
     __host__ __device__ ~Geometry3D(){};  // non-virtual
@@ -99,6 +109,16 @@ public:
     Eigen::Vector3f ComputeCenter(
             const utility::device_vector<Eigen::Vector3f> &points) const;
 
+    /// Min and max bounds, mean and, if \p compute_covariance, covariance of
+    /// \p points in a single reduction.
+    PointStatistics ComputePointStatistics(
+            const utility::device_vector<Eigen::Vector3f> &points,
+            bool compute_covariance = false) const;
+    PointStatistics ComputePointStatistics(
+            cudaStream_t stream,
+            const utility::device_vector<Eigen::Vector3f> &points,
+            bool compute_covariance = false) const;
+
     void ResizeAndPaintUniformColor(
             utility::device_vector<Eigen::Vector3f> &colors,
             const size_t size,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <limits>
 
 namespace cupoch {
 namespace geometry {
@@ -19,6 +20,52 @@ struct compute_grid_center_functor {
     }
 };
 
+/// Calls \p func with every cell of the unit grid crossed by the segment
+/// from \p start to \p end (Amanatides and Woo), both in cell units, from
+/// the cell of \p start to the cell of \p end.
+template <typename Func>
+__device__ void WalkGridCells(const Eigen::Vector3f &start,
+                              const Eigen::Vector3f &end,
+                              Func &func) {
+    const Eigen::Vector3f d = end - start;
+    Eigen::Vector3i cell, step;
+    Eigen::Vector3f t_max, t_delta;
+    int n_steps = 0;
+    for (int i = 0; i < 3; ++i) {
+        cell[i] = (int)floorf(start[i]);
+        step[i] = (d[i] > 0) ? 1 : -1;
+        if (d[i] == 0) {
+            t_max[i] = t_delta[i] = std::numeric_limits<float>::infinity();
+        } else {
+            const float bound = cell[i] + (d[i] > 0 ? 1 : 0);
+            t_max[i] = (bound - start[i]) / d[i];
+            t_delta[i] = 1.0 / fabsf(d[i]);
+        }
+        // One step per crossed cell face.
+        n_steps += abs((int)floorf(end[i]) - cell[i]);
+    }
+    for (int n = 0; n <= n_steps; ++n) {
+        func(cell);
+        int axis = (t_max[0] < t_max[1]) ? 0 : 1;
+        axis = (t_max[2] < t_max[axis]) ? 2 : axis;
+        cell[axis] += step[axis];
+        t_max[axis] += t_delta[axis];
+    }
+}
+
+/// Same as WalkGridCells(), stopping after the first cell for which
+/// \p func returns false.
+template <typename Func>
+__device__ void WalkGridCellsUntil(const Eigen::Vector3f &start,
+                                   const Eigen::Vector3f &end,
+                                   Func &func) {
+    bool running = true;
+    auto visit = [&](const Eigen::Vector3i &cell) {
+        if (running) running = func(cell);
+    };
+    WalkGridCells(start, end, visit);
+}
+
 template <typename TupleType, int Index, typename Func>
 struct tuple_element_compare_functor {
     __device__ bool operator() (const TupleType& rhs, const TupleType& lhs) {
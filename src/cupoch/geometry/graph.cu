@@ -2,7 +2,10 @@
 #include "cupoch/geometry/geometry_functor.h"
 #include "cupoch/geometry/kdtree_flann.h"
 
+#include <thrust/count.h>
 #include <thrust/gather.h>
+#include <thrust/sequence.h>
+#include <thrust/partition.h>
 #include <thrust/iterator/discard_iterator.h>
 
 namespace cupoch {
@@ -61,66 +64,192 @@ struct extract_near_edges_functor {
     }
 };
 
-struct relax_functor {
-    relax_functor(const Eigen::Vector2i* lines,
-                  const int* edge_index_offsets,
-                  const float* edge_weights,
-                  const int* edge_table,
-                  int* open_flags,
-                  const Graph::SSSPResult* res,
-                  Graph::SSSPResult* res_tmp)
-                  : lines_(lines), edge_index_offsets_(edge_index_offsets),
-                  edge_weights_(edge_weights), edge_table_(edge_table),
-                  open_flags_(open_flags), res_(res), res_tmp_(res_tmp) {};
+struct csr_to_edges_functor {
+    csr_to_edges_functor(const int* offsets, const int* indices,
+                         Eigen::Vector2i* edges)
+                         : offsets_(offsets), indices_(indices), edges_(edges) {};
+    const int* offsets_;
+    const int* indices_;
+    Eigen::Vector2i* edges_;
+    __device__ void operator() (size_t idx) const {
+        for (int k = offsets_[idx]; k < offsets_[idx + 1]; ++k) {
+            const int j = indices_[k];
+            edges_[k] = (j != idx) ? Eigen::Vector2i(idx, j) : Eigen::Vector2i(-1, -1);
+        }
+    }
+};
+
+// Distance and predecessor of a node packed so that one 64 bit atomicMin
+// relaxes both. The non negative floats are ordered as their bits.
+const unsigned long long kUnreachedNode = 0x7f800000ffffffffULL;
+
+__host__ __device__ unsigned long long PackDistance(float distance, int prev_index) {
+    unsigned int bits;
+    memcpy(&bits, &distance, sizeof(float));
+    return ((unsigned long long)bits << 32) | (unsigned int)prev_index;
+}
+
+__host__ __device__ float UnpackDistance(unsigned long long packed) {
+    const unsigned int bits = (unsigned int)(packed >> 32);
+    float distance;
+    memcpy(&distance, &bits, sizeof(float));
+    return distance;
+}
+
+// First edge of \p u in the sorted \p lines.
+__device__ int LowerBoundEdge(const Eigen::Vector2i* lines, int n_lines, int u) {
+    int lo = 0;
+    int hi = n_lines;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (lines[mid][0] < u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+struct relax_frontier_functor {
+    relax_frontier_functor(const Eigen::Vector2i* lines,
+                           const int* edge_index_offsets,
+                           const float* edge_weights,
+                           const Eigen::Vector2i* delta_lines,
+                           const float* delta_weights, int n_delta,
+                           unsigned long long* distances,
+                           int* stamps, int stamp,
+                           int* next_frontier, int* n_next)
+                           : lines_(lines), edge_index_offsets_(edge_index_offsets),
+                           edge_weights_(edge_weights), delta_lines_(delta_lines),
+                           delta_weights_(delta_weights), n_delta_(n_delta),
+                           distances_(distances),
+                           stamps_(stamps), stamp_(stamp),
+                           next_frontier_(next_frontier), n_next_(n_next) {};
     const Eigen::Vector2i* lines_;
     const int* edge_index_offsets_;
     const float* edge_weights_;
-    const int* edge_table_;
-    int* open_flags_;
-    const Graph::SSSPResult* res_;
-    Graph::SSSPResult* res_tmp_;
-    __device__ void operator() (size_t idx) {
-        if (open_flags_[idx] == 0) return;
-        open_flags_[idx] = 0;
-        int s_edge = edge_index_offsets_[idx];
-        int e_edge = edge_index_offsets_[idx + 1];
-        for (int j = s_edge; j < e_edge; ++j) {
-            int k = lines_[j][0];
-            res_tmp_[edge_table_[j]].shortest_distance_ = res_[k].shortest_distance_ + edge_weights_[j];
-            res_tmp_[edge_table_[j]].prev_index_ = k;
+    const Eigen::Vector2i* delta_lines_;
+    const float* delta_weights_;
+    const int n_delta_;
+    unsigned long long* distances_;
+    int* stamps_;
+    const int stamp_;
+    int* next_frontier_;
+    int* n_next_;
+    __device__ void Relax(int u, float du, int v, float w) const {
+        // Removed edges, see RemoveDeltaEdges().
+        if (isinf(w)) return;
+        const unsigned long long dv = PackDistance(du + w, u);
+        if (dv < atomicMin(distances_ + v, dv) &&
+            atomicExch(stamps_ + v, stamp_) != stamp_) {
+            next_frontier_[atomicAdd(n_next_, 1)] = v;
+        }
+    }
+    __device__ void operator() (int u) {
+        const float du = UnpackDistance(distances_[u]);
+        for (int j = edge_index_offsets_[u]; j < edge_index_offsets_[u + 1]; ++j) {
+            Relax(u, du, lines_[j][1], edge_weights_[j]);
+        }
+        for (int j = LowerBoundEdge(delta_lines_, n_delta_, u);
+             j < n_delta_ && delta_lines_[j][0] == u; ++j) {
+            Relax(u, du, delta_lines_[j][1], delta_weights_[j]);
         }
     }
 };
 
-struct update_shortest_distances_functor {
-    update_shortest_distances_functor(int* open_flags,
-                                      Graph::SSSPResult* res,
-                                      const Graph::SSSPResult* res_tmp)
-                                      : open_flags_(open_flags),
-                                      res_(res), res_tmp_(res_tmp) {};
-    int* open_flags_;
-    Graph::SSSPResult* res_;
-    const Graph::SSSPResult* res_tmp_;
-    __device__ void operator() (size_t idx) {
-        if (res_[idx].shortest_distance_ > res_tmp_[idx].shortest_distance_) {
-            res_[idx] = res_tmp_[idx];
-            open_flags_[idx] = 1;
+struct mark_removed_edges_functor {
+    mark_removed_edges_functor(const Eigen::Vector2i* lines,
+                               const int* edge_index_offsets,
+                               float* edge_weights,
+                               const Eigen::Vector2i* delta_lines,
+                               float* delta_weights, int n_delta, int n_nodes)
+                               : lines_(lines), edge_index_offsets_(edge_index_offsets),
+                               edge_weights_(edge_weights), delta_lines_(delta_lines),
+                               delta_weights_(delta_weights), n_delta_(n_delta),
+                               n_nodes_(n_nodes) {};
+    const Eigen::Vector2i* lines_;
+    const int* edge_index_offsets_;
+    float* edge_weights_;
+    const Eigen::Vector2i* delta_lines_;
+    float* delta_weights_;
+    const int n_delta_;
+    const int n_nodes_;
+    __device__ void operator() (const Eigen::Vector2i& edge) const {
+        const int u = edge[0];
+        if (u < 0 || u >= n_nodes_) return;
+        for (int j = edge_index_offsets_[u]; j < edge_index_offsets_[u + 1]; ++j) {
+            if (lines_[j][1] == edge[1]) edge_weights_[j] = std::numeric_limits<float>::infinity();
+        }
+        for (int j = LowerBoundEdge(delta_lines_, n_delta_, u);
+             j < n_delta_ && delta_lines_[j][0] == u; ++j) {
+            if (delta_lines_[j][1] == edge[1]) delta_weights_[j] = std::numeric_limits<float>::infinity();
         }
     }
 };
 
-struct compare_path_length_functor {
-    compare_path_length_functor(const Graph::SSSPResult* res,
-                                const int* open_flags, int end_node_index)
-    : res_(res), open_flags_(open_flags), end_node_index_(end_node_index) {}
-    const Graph::SSSPResult* res_;
-    const int* open_flags_;
+struct is_removed_edge_functor {
+    template <typename Tuple>
+    __device__ bool operator() (const Tuple& x) const { return isinf(thrust::get<1>(x)); }
+};
+
+struct finite_weight_functor {
+    __device__ float operator() (float w) const { return isinf(w) ? 0.0f : w; }
+};
+
+struct is_finite_functor {
+    __device__ bool operator() (float w) const { return !isinf(w); }
+};
+
+// Bucket key of a node: its distance, plus the Euclidean distance to the
+// goal for A*.
+struct node_priority_functor {
+    node_priority_functor(const unsigned long long* distances,
+                          const Eigen::Vector3f* points,
+                          int end_node_index, bool use_heuristic)
+                          : distances_(distances), points_(points),
+                          end_node_index_(end_node_index), use_heuristic_(use_heuristic) {};
+    const unsigned long long* distances_;
+    const Eigen::Vector3f* points_;
     const int end_node_index_;
-    __device__ bool operator()(size_t idx) const {
-        return (open_flags_[idx] && res_[idx].shortest_distance_ < res_[end_node_index_].shortest_distance_);
+    const bool use_heuristic_;
+    __device__ float operator() (int v) const {
+        float f = UnpackDistance(distances_[v]);
+        if (use_heuristic_) f += (points_[v] - points_[end_node_index_]).norm();
+        return f;
     }
 };
 
+struct is_near_functor {
+    is_near_functor(const node_priority_functor& priority, float threshold)
+    : priority_(priority), threshold_(threshold) {};
+    const node_priority_functor priority_;
+    const float threshold_;
+    __device__ bool operator() (int v) const { return priority_(v) < threshold_; }
+};
+
+struct unpack_sssp_result_functor {
+    __host__ __device__ Graph::SSSPResult operator() (unsigned long long packed) const {
+        const int prev_index = (int)(unsigned int)(packed & 0xffffffffULL);
+        return (prev_index < 0) ? Graph::SSSPResult() : Graph::SSSPResult(UnpackDistance(packed), prev_index);
+    }
+};
+
+std::shared_ptr<thrust::host_vector<int>> BacktrackPath(const Graph::SSSPResultArray& res,
+                                                        int start_node_index, int end_node_index) {
+    Graph::SSSPResultHostArray h_res = res;
+    auto path_nodes = std::make_shared<thrust::host_vector<int>>();
+    if (h_res[end_node_index].prev_index_ < 0) return path_nodes;
+    path_nodes->push_back(end_node_index);
+    int prev_index = h_res[end_node_index].prev_index_;
+    while (prev_index != start_node_index) {
+        path_nodes->push_back(prev_index);
+        prev_index = h_res[prev_index].prev_index_;
+    }
+    path_nodes->push_back(start_node_index);
+    thrust::reverse(path_nodes->begin(), path_nodes->end());
+    return path_nodes;
+}
 
 template <class... Args>
 struct check_edge_functor {
@@ -134,6 +263,109 @@ struct check_edge_functor {
     }
 };
 
+
+// Hooks the root of the larger label to the smaller one across each edge
+// joining two components. The labels only decrease, so no cycle forms.
+struct hook_components_functor {
+    hook_components_functor(const Eigen::Vector2i* lines, int* parent, int* changed)
+        : lines_(lines), parent_(parent), changed_(changed) {};
+    const Eigen::Vector2i* lines_;
+    int* parent_;
+    int* changed_;
+    __device__ void operator() (size_t idx) const {
+        const int pu = parent_[lines_[idx][0]];
+        const int pv = parent_[lines_[idx][1]];
+        if (pu == pv) return;
+        atomicMin(&parent_[max(pu, pv)], min(pu, pv));
+        *changed_ = 1;
+    }
+};
+
+struct jump_parent_functor {
+    jump_parent_functor(int* parent, int* changed) : parent_(parent), changed_(changed) {};
+    int* parent_;
+    int* changed_;
+    __device__ void operator() (size_t idx) const {
+        const int p = parent_[idx];
+        const int pp = parent_[p];
+        if (p != pp) {
+            parent_[idx] = pp;
+            *changed_ = 1;
+        }
+    }
+};
+
+constexpr unsigned long long kNoMSTEdge = ~0ull;
+
+// The weights are non negative, so their bits order as the floats, and the
+// edge index breaks the ties: the components joined by an edge pick it from
+// both sides.
+__device__ unsigned long long PackMSTEdgeKey(float weight, int edge) {
+    return ((unsigned long long)__float_as_uint(weight) << 32) | (unsigned int)edge;
+}
+
+struct find_lightest_edge_functor {
+    find_lightest_edge_functor(const Eigen::Vector2i* lines, const float* weights,
+                               const int* comp, unsigned long long* best)
+        : lines_(lines), weights_(weights), comp_(comp), best_(best) {};
+    const Eigen::Vector2i* lines_;
+    const float* weights_;
+    const int* comp_;
+    unsigned long long* best_;
+    __device__ void operator() (size_t idx) const {
+        const int cu = comp_[lines_[idx][0]];
+        const int cv = comp_[lines_[idx][1]];
+        if (cu == cv) return;
+        const unsigned long long key = PackMSTEdgeKey(weights_ ? fmaxf(weights_[idx], 0.0f) : 1.0f, idx);
+        atomicMin(&best_[cu], key);
+        atomicMin(&best_[cv], key);
+    }
+};
+
+// Hooks each component to the one across its lightest edge. Two components
+// picking each other keep the smaller as root, which leaves a forest.
+struct hook_lightest_edge_functor {
+    hook_lightest_edge_functor(const Eigen::Vector2i* lines, const int* comp,
+                               const unsigned long long* best, int* parent,
+                               int* in_tree, int* changed)
+        : lines_(lines), comp_(comp), best_(best), parent_(parent),
+          in_tree_(in_tree), changed_(changed) {};
+    const Eigen::Vector2i* lines_;
+    const int* comp_;
+    const unsigned long long* best_;
+    int* parent_;
+    int* in_tree_;
+    int* changed_;
+    __device__ void operator() (size_t c) const {
+        parent_[c] = comp_[c];
+        if (comp_[c] != c || best_[c] == kNoMSTEdge) return;
+        const int e = best_[c] & 0xffffffffULL;
+        const int cu = comp_[lines_[e][0]];
+        const int other = (cu == c) ? comp_[lines_[e][1]] : cu;
+        in_tree_[e] = 1;
+        if (best_[other] == best_[c] && c < other) return;
+        parent_[c] = other;
+        *changed_ = 1;
+    }
+};
+
+struct sort_edge_functor {
+    __device__ Eigen::Vector2i operator() (const Eigen::Vector2i& l) const {
+        return (l[0] < l[1]) ? l : Eigen::Vector2i(l[1], l[0]);
+    }
+};
+
+/// Replaces each label of \p parent by the root of its chain.
+void CompressLabels(utility::device_vector<int>& parent, utility::device_vector<int>& changed) {
+    do {
+        changed[0] = 0;
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(parent.size()),
+                         jump_parent_functor(thrust::raw_pointer_cast(parent.data()),
+                                             thrust::raw_pointer_cast(changed.data())));
+    } while (changed[0] != 0);
+}
+
 }
 
 Graph::Graph() : LineSet(Geometry::GeometryType::Graph) {}
@@ -145,13 +377,21 @@ Graph::~Graph() {}
  Graph::Graph(const Graph &other)
  : LineSet(Geometry::GeometryType::Graph, other.points_, other.lines_),
  edge_index_offsets_(other.edge_index_offsets_), edge_weights_(other.edge_weights_),
- is_directed_(other.is_directed_) {}
+ is_directed_(other.is_directed_), delta_lines_(other.delta_lines_),
+ delta_weights_(other.delta_weights_), max_delta_ratio_(other.max_delta_ratio_),
+ has_removed_edges_(other.has_removed_edges_) {}
 
 thrust::host_vector<int> Graph::GetEdgeIndexOffsets() const {
     thrust::host_vector<int> edge_index_offsets = edge_index_offsets_;
     return edge_index_offsets;
 }
 
+void Graph::GetEdgeIndexOffsets(
+        utility::pinned_host_vector<int> &edge_index_offsets,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(edge_index_offsets_, edge_index_offsets, stream);
+}
+
 void Graph::SetEdgeIndexOffsets(const thrust::host_vector<int>& edge_index_offsets) {
     edge_index_offsets_ = edge_index_offsets;
 }
@@ -161,6 +401,11 @@ thrust::host_vector<float> Graph::GetEdgeWeights() const {
     return edge_weights;
 }
 
+void Graph::GetEdgeWeights(utility::pinned_host_vector<float> &edge_weights,
+                           cudaStream_t stream) const {
+    utility::CopyToHostAsync(edge_weights_, edge_weights, stream);
+}
+
 void Graph::SetEdgeWeights(const thrust::host_vector<float>& edge_weights) {
     edge_weights_ = edge_weights;
 }
@@ -169,10 +414,14 @@ Graph &Graph::Clear() {
     LineSet::Clear();
     edge_index_offsets_.clear();
     edge_weights_.clear();
+    delta_lines_.clear();
+    delta_weights_.clear();
+    has_removed_edges_ = false;
     return *this;
 }
 
 Graph &Graph::ConstructGraph(bool set_edge_weights_from_distance) {
+    FlushDeltaEdges();
     if (lines_.empty()) {
         utility::LogError("[ConstructGraph] Graph has no edges.");
         return *this;
@@ -192,6 +441,7 @@ Graph &Graph::ConstructGraph(bool set_edge_weights_from_distance) {
         edge_weights_.resize(lines_.size(), 1.0);
     }
     edge_index_offsets_.resize(points_.size() + 1, 0);
+    thrust::fill(edge_index_offsets_.begin(), edge_index_offsets_.end(), 0);
     utility::device_vector<int> indices(lines_.size());
     utility::device_vector<int> counts(lines_.size());
     const auto begin = thrust::make_transform_iterator(lines_.begin(), extract_element_functor<int, 2, 0>());
@@ -208,19 +458,18 @@ Graph &Graph::ConstructGraph(bool set_edge_weights_from_distance) {
 }
 
 Graph &Graph::ConnectToNearestNeighbors(float max_edge_distance, int max_num_edges) {
+    utility::device_vector<int> offsets;
     utility::device_vector<int> indices;
     utility::device_vector<float> weights;
-    utility::device_vector<Eigen::Vector2i> new_edges(points_.size() * (max_num_edges + 1));
     geometry::KDTreeFlann kdtree;
     kdtree.SetRawData(points_);
-    kdtree.SearchHybrid(points_, max_edge_distance, max_num_edges + 1, indices, weights);
-    thrust::transform(thrust::make_counting_iterator(0),
-                      thrust::make_counting_iterator<int>(new_edges.size()),
-                      indices.begin(), new_edges.begin(),
-                      [max_num_edges] __device__ (int idx, int j) {
-                          int i = idx / max_num_edges;
-                          return (j >= 0 && i != j) ? Eigen::Vector2i(i, j) : Eigen::Vector2i(-1, -1);
-                      });
+    kdtree.SearchRadiusCSR(points_, max_edge_distance, max_num_edges + 1, offsets, indices, weights);
+    utility::device_vector<Eigen::Vector2i> new_edges(indices.size());
+    csr_to_edges_functor edge_func(thrust::raw_pointer_cast(offsets.data()),
+                                   thrust::raw_pointer_cast(indices.data()),
+                                   thrust::raw_pointer_cast(new_edges.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(points_.size()), edge_func);
     auto remove_fn = [] __device__ (const thrust::tuple<Eigen::Vector2i, float>& x) {
         return thrust::get<0>(x)[0] < 0;
     };
@@ -409,6 +658,81 @@ Graph &Graph::RemoveEdges(const thrust::host_vector<Eigen::Vector2i> &edges) {
     return RemoveEdges(d_edges);
 }
 
+Graph &Graph::AddDeltaEdges(const utility::device_vector<Eigen::Vector2i> &edges,
+                            const utility::device_vector<float> &weights) {
+    if (!weights.empty() && edges.size() != weights.size()) {
+        utility::LogError("[AddDeltaEdges] edges size is not equal to weights size.");
+        return *this;
+    }
+    const size_t n_old = delta_lines_.size();
+    delta_lines_.insert(delta_lines_.end(), edges.begin(), edges.end());
+    if (weights.empty()) {
+        delta_weights_.resize(delta_lines_.size());
+        Eigen::Vector3f *pt_ptr = thrust::raw_pointer_cast(points_.data());
+        thrust::transform(edges.begin(), edges.end(), delta_weights_.begin() + n_old,
+                          [pt_ptr] __device__ (const Eigen::Vector2i& edge) {
+                              return (pt_ptr[edge[0]] - pt_ptr[edge[1]]).norm();
+                          });
+    } else {
+        delta_weights_.insert(delta_weights_.end(), weights.begin(), weights.end());
+    }
+    if (!is_directed_) {
+        utility::device_vector<float> new_weights(delta_weights_.begin() + n_old, delta_weights_.end());
+        delta_lines_.insert(delta_lines_.end(),
+                            thrust::make_transform_iterator(edges.begin(), swap_index_functor<int>()),
+                            thrust::make_transform_iterator(edges.end(), swap_index_functor<int>()));
+        delta_weights_.insert(delta_weights_.end(), new_weights.begin(), new_weights.end());
+    }
+    thrust::sort_by_key(delta_lines_.begin(), delta_lines_.end(), delta_weights_.begin());
+    if (delta_lines_.size() > max_delta_ratio_ * lines_.size()) MergeDeltaEdges();
+    return *this;
+}
+
+Graph &Graph::RemoveDeltaEdges(const utility::device_vector<Eigen::Vector2i> &edges) {
+    if (!IsConstructed()) {
+        utility::LogError("[RemoveDeltaEdges] this graph is not constructed.");
+        return *this;
+    }
+    mark_removed_edges_functor func(thrust::raw_pointer_cast(lines_.data()),
+                                    thrust::raw_pointer_cast(edge_index_offsets_.data()),
+                                    thrust::raw_pointer_cast(edge_weights_.data()),
+                                    thrust::raw_pointer_cast(delta_lines_.data()),
+                                    thrust::raw_pointer_cast(delta_weights_.data()),
+                                    delta_lines_.size(), points_.size());
+    thrust::for_each(edges.begin(), edges.end(), func);
+    if (!is_directed_) {
+        thrust::for_each(thrust::make_transform_iterator(edges.begin(), swap_index_functor<int>()),
+                         thrust::make_transform_iterator(edges.end(), swap_index_functor<int>()),
+                         func);
+    }
+    has_removed_edges_ = has_removed_edges_ || !edges.empty();
+    return *this;
+}
+
+Graph &Graph::MergeDeltaEdges() {
+    if (!HasDeltaEdges()) return *this;
+    return ConstructGraph(false);
+}
+
+void Graph::FlushDeltaEdges() {
+    const bool has_colors = HasColors();
+    if (has_removed_edges_) {
+        if (has_colors) {
+            remove_if_vectors(is_removed_edge_functor(), lines_, edge_weights_, colors_);
+        } else {
+            remove_if_vectors(is_removed_edge_functor(), lines_, edge_weights_);
+        }
+        remove_if_vectors(is_removed_edge_functor(), delta_lines_, delta_weights_);
+        has_removed_edges_ = false;
+    }
+    if (delta_lines_.empty()) return;
+    lines_.insert(lines_.end(), delta_lines_.begin(), delta_lines_.end());
+    edge_weights_.insert(edge_weights_.end(), delta_weights_.begin(), delta_weights_.end());
+    if (has_colors) colors_.resize(lines_.size(), Eigen::Vector3f::Ones());
+    delta_lines_.clear();
+    delta_weights_.clear();
+}
+
 Graph &Graph::PaintEdgeColor(const Eigen::Vector2i &edge, const Eigen::Vector3f &color) {
     if (!HasColors()) {
         colors_.resize(lines_.size(), Eigen::Vector3f::Ones());
@@ -486,59 +810,110 @@ Graph &Graph::SetEdgeWeightsFromDistance() {
 }
 
 std::shared_ptr<Graph::SSSPResultArray> Graph::DijkstraPaths(int start_node_index, int end_node_index) const {
+    utility::Workspace workspace;
+    return DijkstraPaths(workspace, start_node_index, end_node_index);
+}
+
+std::shared_ptr<Graph::SSSPResultArray> Graph::DijkstraPaths(utility::Workspace &workspace,
+                                                             int start_node_index, int end_node_index) const {
+    return DeltaSteppingPaths(workspace, start_node_index, end_node_index);
+}
+
+std::shared_ptr<Graph::SSSPResultArray> Graph::DeltaSteppingPaths(int start_node_index, int end_node_index,
+                                                                  float delta, bool use_heuristic) const {
+    utility::Workspace workspace;
+    return DeltaSteppingPaths(workspace, start_node_index, end_node_index, delta, use_heuristic);
+}
+
+std::shared_ptr<Graph::SSSPResultArray> Graph::DeltaSteppingPaths(utility::Workspace &workspace,
+                                                                  int start_node_index, int end_node_index,
+                                                                  float delta, bool use_heuristic) const {
     auto out = std::make_shared<Graph::SSSPResultArray>();
     out->resize(points_.size());
 
     if (!IsConstructed()) {
-        utility::LogError("[DijkstraPath] this graph is not constructed.");
+        utility::LogError("[DeltaSteppingPaths] this graph is not constructed.");
+        return out;
+    }
+    if (use_heuristic && end_node_index < 0) {
+        utility::LogError("[DeltaSteppingPaths] the heuristic needs an end node.");
         return out;
     }
+    if (delta <= 0.0) {
+        // The removed edges do not count.
+        const size_t n_finite = thrust::count_if(edge_weights_.begin(), edge_weights_.end(),
+                                                 is_finite_functor());
+        delta = (n_finite == 0) ? 1.0 :
+                thrust::transform_reduce(edge_weights_.begin(), edge_weights_.end(),
+                                         finite_weight_functor(), 0.0f, thrust::plus<float>()) / n_finite;
+        if (delta <= 0.0) delta = 1.0;
+    }
 
-    utility::device_vector<Eigen::Vector2i> sorted_lines = lines_;
-    utility::device_vector<int> new_to_old_edge_table(lines_.size());
-    utility::device_vector<int> old_to_new_edge_table(lines_.size());
-    thrust::sequence(new_to_old_edge_table.begin(), new_to_old_edge_table.end(), 0);
-    thrust::sort_by_key(sorted_lines.begin(), sorted_lines.end(), new_to_old_edge_table.begin(),
-            [] __device__ (const Eigen::Vector2i &lhs, const Eigen::Vector2i &rhs) {
-                return lhs[1] < rhs[1];
-            });
-    thrust::scatter(thrust::make_counting_iterator<size_t>(0), thrust::make_counting_iterator(lines_.size()),
-            new_to_old_edge_table.begin(), old_to_new_edge_table.begin());
-    utility::device_vector<int> open_flags(points_.size(), 0);
-    utility::device_vector<size_t> indices(points_.size());
-    thrust::sequence(indices.begin(), indices.end(), 0);
-    SSSPResultArray res_tmp(lines_.size());
-    SSSPResultArray res_tmp_s(points_.size());
-    open_flags[start_node_index] = 1;
-    (*out)[start_node_index] = SSSPResult(0.0, start_node_index);
-    relax_functor func1(thrust::raw_pointer_cast(lines_.data()),
-                        thrust::raw_pointer_cast(edge_index_offsets_.data()),
-                        thrust::raw_pointer_cast(edge_weights_.data()),
-                        thrust::raw_pointer_cast(old_to_new_edge_table.data()),
-                        thrust::raw_pointer_cast(open_flags.data()),
-                        thrust::raw_pointer_cast(out->data()),
-                        thrust::raw_pointer_cast(res_tmp.data()));
-    update_shortest_distances_functor func2(thrust::raw_pointer_cast(open_flags.data()),
-                                            thrust::raw_pointer_cast(out->data()),
-                                            thrust::raw_pointer_cast(res_tmp_s.data()));
-    compare_path_length_functor func3(thrust::raw_pointer_cast(out->data()),
-                                      thrust::raw_pointer_cast(open_flags.data()),
-                                      end_node_index);
-    size_t nt = points_.size();
-    while (thrust::find(open_flags.begin(), open_flags.end(), 1) != open_flags.end()) {
-        if (end_node_index >= 0 &&
-            thrust::count_if(indices.begin(), indices.begin() + nt, func3) == 0) break;
-        thrust::for_each(indices.begin(), indices.begin() + nt, func1);
-        const auto begin = thrust::make_transform_iterator(sorted_lines.begin(), extract_element_functor<int, 2, 1>());
-        auto end = thrust::reduce_by_key(begin, begin + sorted_lines.size(), res_tmp.begin(),
-                                         indices.begin(), res_tmp_s.begin(),
-                                         thrust::equal_to<int>(),
-                                         [] __device__ (const SSSPResult& lhs, const SSSPResult& rhs) {
-                                             return (lhs.shortest_distance_<= rhs.shortest_distance_) ? lhs : rhs;
-                                         });
-        nt = thrust::distance(indices.begin(), end.first);
-        thrust::for_each(indices.begin(), indices.begin() + nt, func2);
+    const size_t n_nodes = points_.size();
+    auto &distances = workspace.GetBuffer<unsigned long long>("sssp_distances", n_nodes);
+    auto &stamps = workspace.GetBuffer<int>("sssp_stamps", n_nodes);
+    thrust::fill(distances.begin(), distances.end(), kUnreachedNode);
+    thrust::fill(stamps.begin(), stamps.end(), -1);
+    distances[start_node_index] = PackDistance(0.0f, start_node_index);
+    // A node is pushed at most once per relaxation round, so the next
+    // frontier holds at most n_nodes nodes.
+    auto &near = workspace.GetBuffer<int>("sssp_near", n_nodes);
+    auto &next = workspace.GetBuffer<int>("sssp_next", n_nodes);
+    auto &n_next = workspace.GetBuffer<int>("sssp_n_next", 1);
+    auto &far = workspace.GetBuffer<int>("sssp_far", 0);
+    near[0] = start_node_index;
+    size_t n_near = 1;
+
+    node_priority_functor priority(thrust::raw_pointer_cast(distances.data()),
+                                   thrust::raw_pointer_cast(points_.data()),
+                                   end_node_index, use_heuristic);
+    float threshold = delta;
+    if (use_heuristic) {
+        const Eigen::Vector3f start_point = points_[start_node_index];
+        const Eigen::Vector3f end_point = points_[end_node_index];
+        threshold += (start_point - end_point).norm();
     }
+    int stamp = 0;
+    while (true) {
+        // Rounds of relaxation of the nodes in the current bucket.
+        while (n_near > 0) {
+            n_next[0] = 0;
+            relax_frontier_functor func(thrust::raw_pointer_cast(lines_.data()),
+                                        thrust::raw_pointer_cast(edge_index_offsets_.data()),
+                                        thrust::raw_pointer_cast(edge_weights_.data()),
+                                        thrust::raw_pointer_cast(delta_lines_.data()),
+                                        thrust::raw_pointer_cast(delta_weights_.data()),
+                                        delta_lines_.size(),
+                                        thrust::raw_pointer_cast(distances.data()),
+                                        thrust::raw_pointer_cast(stamps.data()), stamp++,
+                                        thrust::raw_pointer_cast(next.data()),
+                                        thrust::raw_pointer_cast(n_next.data()));
+            thrust::for_each(near.begin(), near.begin() + n_near, func);
+            const int n_relaxed = n_next[0];
+            auto mid = thrust::partition(next.begin(), next.begin() + n_relaxed,
+                                         is_near_functor(priority, threshold));
+            n_near = thrust::distance(next.begin(), mid);
+            far.insert(far.end(), mid, next.begin() + n_relaxed);
+            thrust::copy(next.begin(), mid, near.begin());
+        }
+        if (end_node_index >= 0) {
+            Graph::SSSPResult end_res = unpack_sssp_result_functor()(distances[end_node_index]);
+            if (end_res.shortest_distance_ <= threshold) break;
+        }
+        if (far.empty()) break;
+        // Next non empty bucket.
+        thrust::sort(far.begin(), far.end());
+        far.erase(thrust::unique(far.begin(), far.end()), far.end());
+        const float min_priority = thrust::transform_reduce(far.begin(), far.end(), priority,
+                                                            std::numeric_limits<float>::infinity(),
+                                                            thrust::minimum<float>());
+        threshold = std::max(threshold, min_priority) + delta;
+        auto mid = thrust::partition(far.begin(), far.end(), is_near_functor(priority, threshold));
+        n_near = thrust::distance(far.begin(), mid);
+        thrust::copy(far.begin(), mid, near.begin());
+        far.erase(far.begin(), mid);
+    }
+    thrust::transform(distances.begin(), distances.end(), out->begin(), unpack_sssp_result_functor());
     return out;
 }
 
@@ -551,19 +926,85 @@ std::shared_ptr<Graph::SSSPResultHostArray> Graph::DijkstraPathsHost(int start_n
 
 std::shared_ptr<thrust::host_vector<int>> Graph::DijkstraPath(int start_node_index, int end_node_index) const {
     auto res = DijkstraPaths(start_node_index, end_node_index);
-    SSSPResultHostArray h_res = *res;
-    auto path_nodes = std::make_shared<thrust::host_vector<int>>();
-    if (h_res[end_node_index].prev_index_ < 0) return path_nodes;
-    path_nodes->push_back(end_node_index);
-    int prev_index = h_res[end_node_index].prev_index_;
-    while (prev_index != start_node_index) {
-        path_nodes->push_back(prev_index);
-        prev_index = h_res[prev_index].prev_index_;
+    return BacktrackPath(*res, start_node_index, end_node_index);
+}
+
+std::shared_ptr<thrust::host_vector<int>> Graph::AStarPath(int start_node_index, int end_node_index, float delta) const {
+    auto res = DeltaSteppingPaths(start_node_index, end_node_index, delta, true);
+    return BacktrackPath(*res, start_node_index, end_node_index);
+}
+
+utility::device_vector<int> Graph::ConnectedComponents() const {
+    utility::device_vector<int> labels(points_.size());
+    thrust::sequence(labels.begin(), labels.end());
+    utility::device_vector<int> changed(1);
+    while (true) {
+        changed[0] = 0;
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(lines_.size()),
+                         hook_components_functor(thrust::raw_pointer_cast(lines_.data()),
+                                                 thrust::raw_pointer_cast(labels.data()),
+                                                 thrust::raw_pointer_cast(changed.data())));
+        if (changed[0] == 0) break;
+        CompressLabels(labels, changed);
     }
-    path_nodes->push_back(start_node_index);
-    thrust::reverse(path_nodes->begin(), path_nodes->end());
-    return path_nodes;
+    return labels;
 }
 
+std::shared_ptr<Graph> Graph::MinimumSpanningTree() const {
+    const size_t n_nodes = points_.size();
+    auto tree = std::make_shared<Graph>();
+    tree->points_ = points_;
+    if (lines_.empty()) {
+        tree->edge_index_offsets_.resize(n_nodes + 1, 0);
+        return tree;
+    }
+    const float* weights = HasWeights() ? thrust::raw_pointer_cast(edge_weights_.data()) : nullptr;
+    utility::device_vector<int> comp(n_nodes);
+    thrust::sequence(comp.begin(), comp.end());
+    utility::device_vector<int> parent(n_nodes);
+    utility::device_vector<unsigned long long> best(n_nodes);
+    utility::device_vector<int> in_tree(lines_.size(), 0);
+    utility::device_vector<int> changed(1);
+    while (true) {
+        thrust::fill(best.begin(), best.end(), kNoMSTEdge);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(lines_.size()),
+                         find_lightest_edge_functor(thrust::raw_pointer_cast(lines_.data()), weights,
+                                                    thrust::raw_pointer_cast(comp.data()),
+                                                    thrust::raw_pointer_cast(best.data())));
+        changed[0] = 0;
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_nodes),
+                         hook_lightest_edge_functor(thrust::raw_pointer_cast(lines_.data()),
+                                                    thrust::raw_pointer_cast(comp.data()),
+                                                    thrust::raw_pointer_cast(best.data()),
+                                                    thrust::raw_pointer_cast(parent.data()),
+                                                    thrust::raw_pointer_cast(in_tree.data()),
+                                                    thrust::raw_pointer_cast(changed.data())));
+        if (changed[0] == 0) break;
+        CompressLabels(parent, changed);
+        comp.swap(parent);
+    }
+    const int n_tree = thrust::count(in_tree.begin(), in_tree.end(), 1);
+    utility::device_vector<Eigen::Vector2i> tree_edges(n_tree);
+    utility::device_vector<float> tree_weights(n_tree);
+    if (weights) {
+        thrust::copy_if(make_tuple_begin(lines_, edge_weights_), make_tuple_end(lines_, edge_weights_),
+                        in_tree.begin(), make_tuple_begin(tree_edges, tree_weights), thrust::identity<int>());
+    } else {
+        thrust::copy_if(lines_.begin(), lines_.end(), in_tree.begin(), tree_edges.begin(),
+                        thrust::identity<int>());
+        thrust::fill(tree_weights.begin(), tree_weights.end(), 1.0);
+    }
+    thrust::transform(tree_edges.begin(), tree_edges.end(), tree_edges.begin(), sort_edge_functor());
+    if (n_tree == 0) {
+        tree->edge_index_offsets_.resize(n_nodes + 1, 0);
+        return tree;
+    }
+    tree->AddEdges(tree_edges, tree_weights);
+    return tree;
+}
+
+}
 }
-}
\ No newline at end of file
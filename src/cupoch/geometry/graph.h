@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cupoch/geometry/lineset.h"
+#include "cupoch/utility/workspace.h"
 
 namespace cupoch {
 namespace geometry {
@@ -31,8 +32,15 @@ public:
     ~Graph();
 
     thrust::host_vector<int> GetEdgeIndexOffsets() const;
+    /// The pinned overloads of the getters enqueue the download on \p stream
+    /// and return at once; synchronize the stream before reading the data.
+    void GetEdgeIndexOffsets(
+            utility::pinned_host_vector<int> &edge_index_offsets,
+            cudaStream_t stream = 0) const;
     void SetEdgeIndexOffsets(const thrust::host_vector<int>& edge_index_offsets);
     thrust::host_vector<float> GetEdgeWeights() const;
+    void GetEdgeWeights(utility::pinned_host_vector<float> &edge_weights,
+                        cudaStream_t stream = 0) const;
     void SetEdgeWeights(const thrust::host_vector<float>& edge_weights);
 
     __host__ __device__
@@ -68,6 +76,23 @@ public:
     Graph &RemoveEdges(const utility::device_vector<Eigen::Vector2i> &edges);
     Graph &RemoveEdges(const thrust::host_vector<Eigen::Vector2i> &edges);
 
+    /// Adds edges to the delta buffer instead of lines_, at a cost in the
+    /// number of edges of the batch: the CSR of the base edges is kept, and
+    /// the shortest path searches read the delta, sorted by first node, in
+    /// addition to it. The delta is merged into lines_ by ConstructGraph(),
+    /// or here once it exceeds max_delta_ratio_ of the base edges. The
+    /// weights default to the lengths of the edges.
+    Graph &AddDeltaEdges(const utility::device_vector<Eigen::Vector2i> &edges,
+                         const utility::device_vector<float> &weights = utility::device_vector<float>());
+    /// Removes edges of the base or of the delta by marking them with an
+    /// infinite weight, the searches skipping them until the merge drops
+    /// them. Each edge scans the out edges of its first node only.
+    Graph &RemoveDeltaEdges(const utility::device_vector<Eigen::Vector2i> &edges);
+    /// Merges the delta into lines_ and rebuilds the CSR, keeping the
+    /// weights.
+    Graph &MergeDeltaEdges();
+    bool HasDeltaEdges() const { return !delta_lines_.empty() || has_removed_edges_; }
+
     Graph &PaintEdgeColor(const Eigen::Vector2i &edge, const Eigen::Vector3f &color);
     Graph &PaintEdgesColor(const utility::device_vector<Eigen::Vector2i> &edges, const Eigen::Vector3f &color);
     Graph &PaintEdgesColor(const thrust::host_vector<Eigen::Vector2i> &edges, const Eigen::Vector3f &color);
@@ -78,9 +103,43 @@ public:
 
     Graph &SetEdgeWeightsFromDistance();
 
+    /// Label of the connected component of each node, the smallest node
+    /// index of the component. The edges are taken as undirected. Computed by
+    /// union-find: every round hooks the larger root across each edge joining
+    /// two components to the smaller one, then pointer jumping compresses
+    /// the paths.
+    utility::device_vector<int> ConnectedComponents() const;
+    /// Minimum spanning forest of the undirected edges by Boruvka rounds,
+    /// each hooking every component to the one across its lightest edge. The
+    /// edges without weight count 1, and the ties are broken by edge index.
+    /// The forest has the nodes of this graph and one tree per component.
+    std::shared_ptr<Graph> MinimumSpanningTree() const;
+
+    /// Shortest paths from \p start_node_index, see DeltaSteppingPaths().
     std::shared_ptr<SSSPResultArray> DijkstraPaths(int start_node_index, int end_node_index = -1) const;
+    /// Same as DijkstraPaths(), with the temporary buffers taken from \p workspace.
+    std::shared_ptr<SSSPResultArray> DijkstraPaths(utility::Workspace &workspace,
+                                                   int start_node_index, int end_node_index = -1) const;
+    /// Single source shortest paths by delta stepping. The nodes are bucketed
+    /// by distance in steps of \p delta, the mean edge weight by default, and
+    /// each round relaxes the out edges of the nodes of the current bucket
+    /// only, with atomic updates of the distances. With \p end_node_index,
+    /// the search stops once the bucket reaches the end node distance. With
+    /// \p use_heuristic, the buckets are keyed by distance plus Euclidean
+    /// distance to the end node, as A*, which is exact when no edge weight
+    /// is less than the length of its edge, e.g. after
+    /// SetEdgeWeightsFromDistance(). Uses the edges sorted by
+    /// ConstructGraph() as they are.
+    std::shared_ptr<SSSPResultArray> DeltaSteppingPaths(int start_node_index, int end_node_index = -1,
+                                                        float delta = 0.0, bool use_heuristic = false) const;
+    std::shared_ptr<SSSPResultArray> DeltaSteppingPaths(utility::Workspace &workspace,
+                                                        int start_node_index, int end_node_index = -1,
+                                                        float delta = 0.0, bool use_heuristic = false) const;
     std::shared_ptr<SSSPResultHostArray> DijkstraPathsHost(int start_node_index, int end_node_index = -1) const;
     std::shared_ptr<thrust::host_vector<int>> DijkstraPath(int start_node_index, int end_node_index) const;
+    /// DeltaSteppingPaths() with the heuristic, as a path of node indices.
+    std::shared_ptr<thrust::host_vector<int>> AStarPath(int start_node_index, int end_node_index,
+                                                        float delta = 0.0) const;
 
     static std::shared_ptr<Graph> CreateFromTriangleMesh(const TriangleMesh &input);
     static std::shared_ptr<Graph> CreateFromAxisAlignedBoundingBox(const geometry::AxisAlignedBoundingBox& bbox,
@@ -94,6 +153,16 @@ public:
     utility::device_vector<float> edge_weights_;
     utility::device_vector<Eigen::Vector3f> node_colors_;
     bool is_directed_ = false;
+    /// Edges added by AddDeltaEdges() and not merged yet, sorted.
+    utility::device_vector<Eigen::Vector2i> delta_lines_;
+    utility::device_vector<float> delta_weights_;
+    float max_delta_ratio_ = 0.1;
+
+private:
+    /// Drops the removed edges and appends the delta to lines_.
+    void FlushDeltaEdges();
+
+    bool has_removed_edges_ = false;
 };
 
 }
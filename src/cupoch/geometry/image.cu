@@ -1,5 +1,7 @@
 #include "cupoch/geometry/image.h"
+#include "cupoch/geometry/image_view.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -10,56 +12,26 @@ namespace {
 /// two 1D kernels are applied in x and y direction.
 std::pair<utility::device_vector<float>, utility::device_vector<float>>
 GetFilterKernel(Image::FilterType ftype) {
+    static const float g3[] = {0.25, 0.5, 0.25};
+    static const float g5[] = {0.0625, 0.25, 0.375, 0.25, 0.0625};
+    static const float g7[] = {0.03125, 0.109375, 0.21875, 0.28125,
+                               0.21875, 0.109375, 0.03125};
+    static const float s31[] = {-1.0, 0.0, 1.0};
+    static const float s32[] = {1.0, 2.0, 1.0};
+    auto make_kernel = [](const float *k, int n) {
+        return utility::device_vector<float>(k, k + n);
+    };
     switch (ftype) {
-        case Image::FilterType::Gaussian3: {
-            utility::device_vector<float> g3(3);
-            g3[0] = 0.25;
-            g3[1] = 0.5;
-            g3[2] = 0.25;
-            return std::make_pair(g3, g3);
-        }
-        case Image::FilterType::Gaussian5: {
-            utility::device_vector<float> g5(5);
-            g5[0] = 0.0625;
-            g5[1] = 0.25;
-            g5[2] = 0.375;
-            g5[3] = 0.25;
-            g5[4] = 0.0625;
-            return std::make_pair(g5, g5);
-        }
-        case Image::FilterType::Gaussian7: {
-            utility::device_vector<float> g7(7);
-            g7[0] = 0.03125;
-            g7[1] = 0.109375;
-            g7[2] = 0.21875;
-            g7[3] = 0.28125;
-            g7[4] = 0.21875;
-            g7[5] = 0.109375;
-            g7[6] = 0.03125;
-            return std::make_pair(g7, g7);
-        }
-        case Image::FilterType::Sobel3Dx: {
-            utility::device_vector<float> s31(3);
-            utility::device_vector<float> s32(3);
-            s31[0] = -1.0;
-            s31[1] = 0.0;
-            s31[2] = 1.0;
-            s32[0] = 1.0;
-            s32[1] = 2.0;
-            s32[2] = 1.0;
-            return std::make_pair(s31, s32);
-        }
-        case Image::FilterType::Sobel3Dy: {
-            utility::device_vector<float> s31(3);
-            utility::device_vector<float> s32(3);
-            s31[0] = -1.0;
-            s31[1] = 0.0;
-            s31[2] = 1.0;
-            s32[0] = 1.0;
-            s32[1] = 2.0;
-            s32[2] = 1.0;
-            return std::make_pair(s32, s31);
-        }
+        case Image::FilterType::Gaussian3:
+            return std::make_pair(make_kernel(g3, 3), make_kernel(g3, 3));
+        case Image::FilterType::Gaussian5:
+            return std::make_pair(make_kernel(g5, 5), make_kernel(g5, 5));
+        case Image::FilterType::Gaussian7:
+            return std::make_pair(make_kernel(g7, 7), make_kernel(g7, 7));
+        case Image::FilterType::Sobel3Dx:
+            return std::make_pair(make_kernel(s31, 3), make_kernel(s32, 3));
+        case Image::FilterType::Sobel3Dy:
+            return std::make_pair(make_kernel(s32, 3), make_kernel(s31, 3));
         default: {
             utility::LogError("[Filter] Unsupported filter type.");
             return std::make_pair(utility::device_vector<float>(),
@@ -68,6 +40,67 @@ GetFilterKernel(Image::FilterType ftype) {
     }
 }
 
+constexpr int kFilterBlockWidth = 32;
+constexpr int kFilterBlockHeight = 8;
+/// Default limit of the shared memory of a block, beyond which the filters
+/// read the global memory.
+constexpr size_t kMaxFilterSharedBytes = 48 * 1024;
+
+/// Convolution of the rows of a float image with a kernel of
+/// 2 * half_kernel_size + 1 taps, the border pixels being replicated. Every
+/// block first loads its rows and their halo into shared memory, so each
+/// pixel is read once per block instead of once per tap.
+__global__ void filter_rows_kernel(ImageView<const float> src,
+                                   const float *kernel,
+                                   int half_kernel_size,
+                                   ImageView<float> dst) {
+    extern __shared__ float tile[];
+    const int width = src.width_;
+    const int height = src.height_;
+    const int tile_width = blockDim.x + 2 * half_kernel_size;
+    const int x0 = blockIdx.x * blockDim.x - half_kernel_size;
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    const float *src_row = src.RowAt(min(y, height - 1));
+    float *row = tile + threadIdx.y * tile_width;
+    for (int i = threadIdx.x; i < tile_width; i += blockDim.x) {
+        row[i] = src_row[min(max(x0 + i, 0), width - 1)];
+    }
+    __syncthreads();
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    if (x >= width || y >= height) return;
+    float temp = 0;
+    for (int i = 0; i <= 2 * half_kernel_size; ++i) {
+        temp += row[threadIdx.x + i] * kernel[i];
+    }
+    dst.At(x, y) = temp;
+}
+
+/// Same as filter_rows_kernel along the columns.
+__global__ void filter_columns_kernel(ImageView<const float> src,
+                                      const float *kernel,
+                                      int half_kernel_size,
+                                      ImageView<float> dst) {
+    extern __shared__ float tile[];
+    const int width = src.width_;
+    const int height = src.height_;
+    const int tile_height = blockDim.y + 2 * half_kernel_size;
+    const int x = blockIdx.x * blockDim.x + threadIdx.x;
+    const int y0 = blockIdx.y * blockDim.y - half_kernel_size;
+    const int xc = min(x, width - 1);
+    for (int j = threadIdx.y; j < tile_height; j += blockDim.y) {
+        tile[j * blockDim.x + threadIdx.x] =
+                src.At(xc, min(max(y0 + j, 0), height - 1));
+    }
+    __syncthreads();
+    const int y = blockIdx.y * blockDim.y + threadIdx.y;
+    if (x >= width || y >= height) return;
+    float temp = 0;
+    for (int i = 0; i <= 2 * half_kernel_size; ++i) {
+        temp += tile[(threadIdx.y + i) * blockDim.x + threadIdx.x] * kernel[i];
+    }
+    dst.At(x, y) = temp;
+}
+
 struct transpose_functor {
     transpose_functor(const uint8_t *src,
                       int width,
@@ -121,61 +154,133 @@ struct linear_transform_functor {
 };
 
 struct downsample_functor {
-    downsample_functor(const uint8_t *src,
-                       int src_width,
-                       uint8_t *dst,
-                       int dst_width)
-        : src_(src), src_width_(src_width), dst_(dst), dst_width_(dst_width){};
-    const uint8_t *src_;
-    const int src_width_;
-    uint8_t *dst_;
-    const int dst_width_;
+    downsample_functor(ImageView<const float> src, ImageView<float> dst)
+        : src_(src), dst_(dst){};
+    const ImageView<const float> src_;
+    const ImageView<float> dst_;
     __device__ void operator()(size_t idx) {
-        const int y = idx / dst_width_;
-        const int x = idx % dst_width_;
-        float *p1 =
-                (float *)(src_ + (y * 2 * src_width_ + x * 2) * sizeof(float));
-        float *p2 = (float *)(src_ +
-                              (y * 2 * src_width_ + x * 2 + 1) * sizeof(float));
-        float *p3 = (float *)(src_ + ((y * 2 + 1) * src_width_ + x * 2) *
-                                             sizeof(float));
-        float *p4 = (float *)(src_ + ((y * 2 + 1) * src_width_ + x * 2 + 1) *
-                                             sizeof(float));
-        float *p = (float *)(dst_ + idx * sizeof(float));
-        *p = (*p1 + *p2 + *p3 + *p4) / 4.0f;
+        const int y = idx / dst_.width_;
+        const int x = idx % dst_.width_;
+        const float *r1 = src_.RowAt(y * 2);
+        const float *r2 = src_.RowAt(y * 2 + 1);
+        dst_.At(x, y) =
+                (r1[x * 2] + r1[x * 2 + 1] + r2[x * 2] + r2[x * 2 + 1]) / 4.0f;
     }
 };
 
-struct filter_horizontal_functor {
-    filter_horizontal_functor(const uint8_t *src,
-                              int width,
-                              const float *kernel,
-                              int half_kernel_size,
-                              uint8_t *dst)
+/// Untiled convolution along the rows or the columns, for the kernels whose
+/// halo does not fit in shared memory.
+struct filter_axis_functor {
+    filter_axis_functor(ImageView<const float> src,
+                        const float *kernel,
+                        int half_kernel_size,
+                        bool vertical,
+                        ImageView<float> dst)
         : src_(src),
-          width_(width),
           kernel_(kernel),
           half_kernel_size_(half_kernel_size),
+          vertical_(vertical),
           dst_(dst){};
-    const uint8_t *src_;
-    const int width_;
+    const ImageView<const float> src_;
     const float *kernel_;
     const int half_kernel_size_;
-    uint8_t *dst_;
+    const bool vertical_;
+    const ImageView<float> dst_;
     __device__ void operator()(size_t idx) {
-        const int y = idx / width_;
-        const int x = idx % width_;
-        float *po = (float *)(dst_ + idx * sizeof(float));
+        const int y = idx / src_.width_;
+        const int x = idx % src_.width_;
         float temp = 0;
         for (int i = -half_kernel_size_; i <= half_kernel_size_; i++) {
-            int x_shift = x + i;
-            if (x_shift < 0) x_shift = 0;
-            if (x_shift > width_ - 1) x_shift = width_ - 1;
-            float *pi =
-                    (float *)(src_ + (y * width_ + x_shift) * sizeof(float));
-            temp += (*pi * kernel_[i + half_kernel_size_]);
+            const int xs =
+                    vertical_ ? x : min(max(x + i, 0), src_.width_ - 1);
+            const int ys =
+                    vertical_ ? min(max(y + i, 0), src_.height_ - 1) : y;
+            temp += src_.At(xs, ys) * kernel_[i + half_kernel_size_];
         }
-        *po = temp;
+        dst_.At(x, y) = temp;
+    }
+};
+
+void FilterAxis(const Image &src,
+                const utility::device_vector<float> &kernel,
+                bool vertical,
+                Image &dst) {
+    const int width = src.width_;
+    const int height = src.height_;
+    const int half_kernel_size = kernel.size() / 2;
+    const auto src_view = MakeImageView<float>(src);
+    const auto dst_view = MakeImageView<float>(dst);
+    const dim3 block(kFilterBlockWidth, kFilterBlockHeight);
+    const size_t shared_bytes =
+            (vertical ? (block.y + 2 * half_kernel_size) * block.x
+                      : (block.x + 2 * half_kernel_size) * block.y) *
+            sizeof(float);
+    if (shared_bytes > kMaxFilterSharedBytes) {
+        filter_axis_functor func(src_view,
+                                 thrust::raw_pointer_cast(kernel.data()),
+                                 half_kernel_size, vertical, dst_view);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator<size_t>(width * height),
+                         func);
+        return;
+    }
+    const dim3 grid((width + block.x - 1) / block.x,
+                    (height + block.y - 1) / block.y);
+    if (vertical) {
+        filter_columns_kernel<<<grid, block, shared_bytes>>>(
+                src_view, thrust::raw_pointer_cast(kernel.data()),
+                half_kernel_size, dst_view);
+    } else {
+        filter_rows_kernel<<<grid, block, shared_bytes>>>(
+                src_view, thrust::raw_pointer_cast(kernel.data()),
+                half_kernel_size, dst_view);
+    }
+    cudaSafeCall(cudaGetLastError());
+}
+
+/// Bilateral filter of a float depth image, the zero depths being invalid
+/// and left out of the averages.
+struct bilateral_depth_functor {
+    bilateral_depth_functor(ImageView<const float> src,
+                            int half_kernel_size,
+                            float sigma_space,
+                            float sigma_depth,
+                            ImageView<float> dst)
+        : src_(src),
+          half_kernel_size_(half_kernel_size),
+          inv_two_sigma_space2_(0.5f / (sigma_space * sigma_space)),
+          inv_two_sigma_depth2_(0.5f / (sigma_depth * sigma_depth)),
+          dst_(dst){};
+    const ImageView<const float> src_;
+    const int half_kernel_size_;
+    const float inv_two_sigma_space2_;
+    const float inv_two_sigma_depth2_;
+    const ImageView<float> dst_;
+    __device__ void operator()(size_t idx) {
+        const int y = idx / src_.width_;
+        const int x = idx % src_.width_;
+        const float d = src_.At(x, y);
+        if (d <= 0.0f) {
+            dst_.At(x, y) = 0.0f;
+            return;
+        }
+        float sum = 0.0f;
+        float weight = 0.0f;
+        for (int j = max(y - half_kernel_size_, 0);
+             j <= min(y + half_kernel_size_, src_.height_ - 1); ++j) {
+            for (int i = max(x - half_kernel_size_, 0);
+                 i <= min(x + half_kernel_size_, src_.width_ - 1); ++i) {
+                const float dq = src_.At(i, j);
+                if (dq <= 0.0f) continue;
+                const float r2 = (i - x) * (i - x) + (j - y) * (j - y);
+                const float w = __expf(-r2 * inv_two_sigma_space2_ -
+                                       (dq - d) * (dq - d) *
+                                               inv_two_sigma_depth2_);
+                sum += w * dq;
+                weight += w;
+            }
+        }
+        dst_.At(x, y) = sum / weight;
     }
 };
 
@@ -262,11 +367,41 @@ Eigen::Vector2f Image::GetMaxBound() const {
 }
 
 thrust::host_vector<uint8_t> Image::GetData() const {
-    thrust::host_vector<uint8_t> data = data_;
-    return data;
+    return data_mirror_.Download(data_);
+}
+
+void Image::GetData(utility::pinned_host_vector<uint8_t> &data,
+                    cudaStream_t stream) const {
+    utility::CopyToHostAsync(data_, data, stream);
+}
+
+void Image::SetData(const thrust::host_vector<uint8_t> &data) {
+    data_mirror_.Upload(data, data_);
 }
 
-void Image::SetData(const thrust::host_vector<uint8_t> &data) { data_ = data; }
+Image &Image::SetDataAsync(const void *data,
+                           int width,
+                           int height,
+                           int num_of_channels,
+                           int bytes_per_channel,
+                           cudaStream_t stream) {
+    const size_t size = (size_t)width * height * num_of_channels *
+                        bytes_per_channel;
+    if (data_.size() != size) {
+        Prepare(width, height, num_of_channels, bytes_per_channel);
+        // The resize initializes the buffer on the default stream.
+        cudaSafeCall(cudaDeviceSynchronize());
+    } else {
+        width_ = width;
+        height_ = height;
+        num_of_channels_ = num_of_channels;
+        bytes_per_channel_ = bytes_per_channel;
+    }
+    cudaSafeCall(cudaMemcpyAsync(thrust::raw_pointer_cast(data_.data()), data,
+                                 data_.size(), cudaMemcpyHostToDevice,
+                                 stream));
+    return *this;
+}
 
 bool Image::TestImageBoundary(float u,
                               float v,
@@ -327,9 +462,8 @@ std::shared_ptr<Image> Image::Downsample() const {
     int half_height = (int)floor((float)height_ / 2.0);
     output->Prepare(half_width, half_height, 1, 4);
 
-    downsample_functor func(thrust::raw_pointer_cast(data_.data()), width_,
-                            thrust::raw_pointer_cast(output->data_.data()),
-                            output->width_);
+    downsample_functor func(MakeImageView<float>(*this),
+                            MakeImageView<float>(*output));
     thrust::for_each(thrust::make_counting_iterator<size_t>(0),
                      thrust::make_counting_iterator<size_t>(output->width_ *
                                                             output->height_),
@@ -347,35 +481,34 @@ std::shared_ptr<Image> Image::FilterHorizontal(
                 "size.");
     }
     output->Prepare(width_, height_, 1, 4);
-
-    const int half_kernel_size = (int)(floor((float)kernel.size() / 2.0));
-
-    filter_horizontal_functor func(
-            thrust::raw_pointer_cast(data_.data()), width_,
-            thrust::raw_pointer_cast(kernel.data()), half_kernel_size,
-            thrust::raw_pointer_cast(output->data_.data()));
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator<size_t>(width_ * height_),
-                     func);
+    FilterAxis(*this, kernel, false, *output);
     return output;
 }
 
 std::shared_ptr<Image> Image::Filter(Image::FilterType type) const {
     auto output = std::make_shared<Image>();
+    Image buffer;
+    Filter(type, *output, buffer);
+    return output;
+}
+
+void Image::Filter(Image::FilterType type, Image &output, Image &buffer) const {
     if (num_of_channels_ != 1 || bytes_per_channel_ != 4) {
         utility::LogError("[Filter] Unsupported image format.");
     }
-
     auto kernels = GetFilterKernel(type);
-    output = Filter(kernels.first, kernels.second);
-    return output;
+    Filter(kernels.first, kernels.second, output, buffer);
 }
 
 ImagePyramid Image::FilterPyramid(const ImagePyramid &input,
                                   Image::FilterType type) {
     std::vector<std::shared_ptr<Image>> output;
+    auto kernels = GetFilterKernel(type);
+    Image buffer;
     for (size_t i = 0; i < input.size(); i++) {
-        auto layer_filtered = input[i]->Filter(type);
+        auto layer_filtered = std::make_shared<Image>();
+        input[i]->Filter(kernels.first, kernels.second, *layer_filtered,
+                         buffer);
         output.push_back(layer_filtered);
     }
     return output;
@@ -385,15 +518,59 @@ std::shared_ptr<Image> Image::Filter(
         const utility::device_vector<float> &dx,
         const utility::device_vector<float> &dy) const {
     auto output = std::make_shared<Image>();
-    if (num_of_channels_ != 1 || bytes_per_channel_ != 4) {
-        utility::LogError("[Filter] Unsupported image format.");
+    Image buffer;
+    Filter(dx, dy, *output, buffer);
+    return output;
+}
+
+void Image::Filter(const utility::device_vector<float> &dx,
+                   const utility::device_vector<float> &dy,
+                   Image &output,
+                   Image &buffer) const {
+    if (num_of_channels_ != 1 || bytes_per_channel_ != 4 ||
+        dx.size() % 2 != 1 || dy.size() % 2 != 1) {
+        utility::LogError(
+                "[Filter] Unsupported image format or kernel size.");
     }
+    if (&output == this || &buffer == this || &output == &buffer) {
+        utility::LogError("[Filter] output and buffer must be distinct images.");
+    }
+    buffer.Prepare(width_, height_, 1, 4);
+    output.Prepare(width_, height_, 1, 4);
+    FilterAxis(*this, dx, false, buffer);
+    FilterAxis(buffer, dy, true, output);
+}
 
-    auto temp1 = FilterHorizontal(dx);
-    auto temp2 = temp1->Transpose();
-    auto temp3 = temp2->FilterHorizontal(dy);
-    auto temp4 = temp3->Transpose();
-    return temp4;
+std::shared_ptr<Image> Image::BilateralFilter(int half_kernel_size,
+                                              float sigma_space,
+                                              float sigma_depth) const {
+    auto output = std::make_shared<Image>();
+    BilateralFilter(half_kernel_size, sigma_space, sigma_depth, *output);
+    return output;
+}
+
+void Image::BilateralFilter(int half_kernel_size,
+                            float sigma_space,
+                            float sigma_depth,
+                            Image &output) const {
+    if (num_of_channels_ != 1 || bytes_per_channel_ != 4) {
+        utility::LogError("[BilateralFilter] Unsupported image format.");
+    }
+    if (half_kernel_size < 0 || sigma_space <= 0 || sigma_depth <= 0) {
+        utility::LogError(
+                "[BilateralFilter] half_kernel_size must be non negative and "
+                "the sigmas positive.");
+    }
+    if (&output == this) {
+        utility::LogError("[BilateralFilter] output must be another image.");
+    }
+    output.Prepare(width_, height_, 1, 4);
+    bilateral_depth_functor func(MakeImageView<float>(*this), half_kernel_size,
+                                 sigma_space, sigma_depth,
+                                 MakeImageView<float>(output));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(width_ * height_),
+                     func);
 }
 
 std::shared_ptr<Image> Image::Transpose() const {
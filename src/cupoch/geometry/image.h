@@ -2,7 +2,9 @@
 #include <vector>
 
 #include "cupoch/geometry/geometry2d.h"
+#include "cupoch/geometry/image_view.h"
 #include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/host_mirror.h"
 
 namespace cupoch {
 
@@ -63,7 +65,22 @@ public:
     Eigen::Vector2f GetMaxBound() const override;
 
     thrust::host_vector<uint8_t> GetData() const;
+    /// The pinned overloads of the getters enqueue the download on \p stream
+    /// and return at once; synchronize the stream before reading the data.
+    void GetData(utility::pinned_host_vector<uint8_t> &data,
+                 cudaStream_t stream = 0) const;
     void SetData(const thrust::host_vector<uint8_t> &data);
+    /// Prepares the image and enqueues the copy of its pixels, packed rows,
+    /// from the host memory \p data on \p stream. The copy only overlaps
+    /// with the host and the other streams when \p data is pinned, e.g. a
+    /// utility::pinned_host_vector or memory registered with
+    /// cudaHostRegister; \p data must stay valid until it is done.
+    Image &SetDataAsync(const void *data,
+                        int width,
+                        int height,
+                        int num_of_channels,
+                        int bytes_per_channel,
+                        cudaStream_t stream = 0);
 
     /// \brief Test if coordinate `(u, v)` is located in the inner_marge of the
     /// image.
@@ -140,9 +157,34 @@ public:
             const utility::device_vector<float> &dx,
             const utility::device_vector<float> &dy) const;
 
+    /// Filters into \p output with the intermediate pass in \p buffer,
+    /// both prepared to the size of the image. Their memory is kept when the
+    /// size does not change, so they can be reused from frame to frame.
+    void Filter(Image::FilterType type, Image &output, Image &buffer) const;
+
+    /// Filters along the rows with \p dx then along the columns with \p dy
+    /// into \p output, through \p buffer, the border pixels being
+    /// replicated. The kernels have any odd number of taps.
+    void Filter(const utility::device_vector<float> &dx,
+                const utility::device_vector<float> &dy,
+                Image &output,
+                Image &buffer) const;
+
     std::shared_ptr<Image> FilterHorizontal(
             const utility::device_vector<float> &kernel) const;
 
+    /// Bilateral filter of a float depth image over the window of
+    /// (2 * half_kernel_size + 1)^2 pixels, with the spatial sigma in pixels
+    /// and the depth sigma in the units of the depths. The zero depths are
+    /// invalid: they stay zero and are left out of the averages.
+    std::shared_ptr<Image> BilateralFilter(int half_kernel_size,
+                                           float sigma_space,
+                                           float sigma_depth) const;
+    void BilateralFilter(int half_kernel_size,
+                         float sigma_space,
+                         float sigma_depth,
+                         Image &output) const;
+
     /// Function to 2x image downsample using simple 2x2 averaging.
     std::shared_ptr<Image> Downsample() const;
 
@@ -184,6 +226,10 @@ public:
     int bytes_per_channel_ = 0;
     /// Image storage buffer.
     utility::device_vector<uint8_t> data_;
+
+private:
+    /// Host copy of GetData() and SetData(), transferred only when stale.
+    mutable utility::HostMirror<uint8_t> data_mirror_;
 };
 
 template <typename T>
@@ -209,22 +255,12 @@ __host__ __device__ inline thrust::pair<bool, float> FloatValueAt(
         int height,
         int num_of_channels,
         int bytes_per_channel) {
-    if ((num_of_channels != 1) || (bytes_per_channel != 4) ||
-        (u < 0.0 || u > (float)(width - 1) || v < 0.0 ||
-         v > (float)(height - 1))) {
+    if ((num_of_channels != 1) || (bytes_per_channel != 4)) {
         return thrust::make_pair(false, 0.0);
     }
-    int ui = std::max(std::min((int)u, width - 2), 0);
-    int vi = std::max(std::min((int)v, height - 2), 0);
-    float pu = u - ui;
-    float pv = v - vi;
-    float value[4] = {*PointerAt<float>(data, width, ui, vi),
-                      *PointerAt<float>(data, width, ui, vi + 1),
-                      *PointerAt<float>(data, width, ui + 1, vi),
-                      *PointerAt<float>(data, width, ui + 1, vi + 1)};
-    return thrust::make_pair(
-            true, (value[0] * (1 - pv) + value[1] * pv) * (1 - pu) +
-                          (value[2] * (1 - pv) + value[3] * pv) * pu);
+    return ImageView<const float>((const float *)data, width, height,
+                                  width * sizeof(float))
+            .FloatValueAt(u, v);
 }
 
 }  // namespace geometry
@@ -1,5 +1,6 @@
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/geometry/image.h"
+#include "cupoch/geometry/image_pyramid.h"
 #include "cupoch/utility/platform.h"
 #include "cupoch/utility/console.h"
 
@@ -112,7 +113,7 @@ std::shared_ptr<Image> Image::CreateDepthToCameraDistanceMultiplierFloatImage(
                      yy.begin(), yy.end(), [=] __device__(int idx) {
                          return (idx - fpp1) * ffl_inv1;
                      });
-    cudaSafeCall(cudaDeviceSynchronize());
+    utility::SynchronizeStreams(2);
     compute_camera_distance_functor func(
             thrust::raw_pointer_cast(fimage->data_.data()), intrinsic.width_,
             thrust::raw_pointer_cast(xx.data()),
@@ -166,29 +167,11 @@ template std::shared_ptr<Image> Image::CreateImageFromFloatImage<uint16_t>()
 
 ImagePyramid Image::CreatePyramid(size_t num_of_levels,
                                   bool with_gaussian_filter /*= true*/) const {
-    std::vector<std::shared_ptr<Image>> pyramid_image;
-    pyramid_image.clear();
     if ((num_of_channels_ != 1) || (bytes_per_channel_ != 4)) {
         utility::LogError("[CreateImagePyramid] Unsupported image format.");
     }
-
-    for (size_t i = 0; i < num_of_levels; i++) {
-        if (i == 0) {
-            std::shared_ptr<Image> input_copy_ptr = std::make_shared<Image>();
-            *input_copy_ptr = *this;
-            pyramid_image.push_back(input_copy_ptr);
-        } else {
-            if (with_gaussian_filter) {
-                // https://en.wikipedia.org/wiki/Pyramid_(image_processing)
-                auto level_b = pyramid_image[i - 1]->Filter(
-                        Image::FilterType::Gaussian3);
-                auto level_bd = level_b->Downsample();
-                pyramid_image.push_back(level_bd);
-            } else {
-                auto level_d = pyramid_image[i - 1]->Downsample();
-                pyramid_image.push_back(level_d);
-            }
-        }
-    }
-    return pyramid_image;
-}
\ No newline at end of file
+    // https://en.wikipedia.org/wiki/Pyramid_(image_processing)
+    FloatImagePyramid pyramid;
+    pyramid.Build(*this, num_of_levels, with_gaussian_filter);
+    return pyramid.ToImagePyramid();
+}
@@ -0,0 +1,130 @@
+#include "cupoch/geometry/image_pyramid.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+/// One pixel of the next level, from the 4 x 4 (blurred) or 2 x 2 pixels of
+/// the previous level under it.
+struct pyramid_level_functor {
+    pyramid_level_functor(const float *src,
+                          int src_width,
+                          int src_height,
+                          float *dst,
+                          int dst_width,
+                          bool with_gaussian_filter)
+        : src_(src),
+          src_width_(src_width),
+          src_height_(src_height),
+          dst_(dst),
+          dst_width_(dst_width),
+          with_gaussian_filter_(with_gaussian_filter){};
+    const float *src_;
+    const int src_width_;
+    const int src_height_;
+    float *dst_;
+    const int dst_width_;
+    const bool with_gaussian_filter_;
+    __device__ void operator()(size_t idx) {
+        const int y = idx / dst_width_;
+        const int x = idx % dst_width_;
+        if (!with_gaussian_filter_) {
+            const float *p = src_ + 2 * y * src_width_ + 2 * x;
+            dst_[idx] = (p[0] + p[1] + p[src_width_] + p[src_width_ + 1]) /
+                        4.0f;
+            return;
+        }
+        const float weights[4] = {0.125f, 0.375f, 0.375f, 0.125f};
+        float temp = 0.0f;
+        for (int j = 0; j < 4; ++j) {
+            const int ys = min(max(2 * y - 1 + j, 0), src_height_ - 1);
+            const float *row = src_ + ys * src_width_;
+            float row_sum = 0.0f;
+            for (int i = 0; i < 4; ++i) {
+                const int xs = min(max(2 * x - 1 + i, 0), src_width_ - 1);
+                row_sum += weights[i] * row[xs];
+            }
+            temp += weights[j] * row_sum;
+        }
+        dst_[idx] = temp;
+    }
+};
+
+}  // namespace
+
+FloatImagePyramid::FloatImagePyramid() {}
+FloatImagePyramid::~FloatImagePyramid() {}
+
+FloatImagePyramid &FloatImagePyramid::Clear() {
+    data_.clear();
+    widths_.clear();
+    heights_.clear();
+    offsets_.clear();
+    return *this;
+}
+
+FloatImagePyramid &FloatImagePyramid::Build(const Image &input,
+                                            size_t num_of_levels,
+                                            bool with_gaussian_filter) {
+    if (input.num_of_channels_ != 1 || input.bytes_per_channel_ != 4) {
+        utility::LogError("[FloatImagePyramid] Unsupported image format.");
+        return *this;
+    }
+    if (num_of_levels == 0 || input.IsEmpty()) {
+        Clear();
+        return *this;
+    }
+    if (GetNumLevels() != num_of_levels || widths_[0] != input.width_ ||
+        heights_[0] != input.height_) {
+        widths_.resize(num_of_levels);
+        heights_.resize(num_of_levels);
+        offsets_.resize(num_of_levels);
+        size_t n_total = 0;
+        for (size_t i = 0; i < num_of_levels; ++i) {
+            widths_[i] = (i == 0) ? input.width_ : widths_[i - 1] / 2;
+            heights_[i] = (i == 0) ? input.height_ : heights_[i - 1] / 2;
+            offsets_[i] = n_total;
+            n_total += (size_t)widths_[i] * heights_[i];
+        }
+        data_.resize(n_total);
+    }
+    float *data = thrust::raw_pointer_cast(data_.data());
+    cudaSafeCall(cudaMemcpy(data, thrust::raw_pointer_cast(input.data_.data()),
+                            input.data_.size(), cudaMemcpyDeviceToDevice));
+    for (size_t i = 1; i < num_of_levels; ++i) {
+        const size_t n_pixels = (size_t)widths_[i] * heights_[i];
+        if (n_pixels == 0) continue;
+        pyramid_level_functor func(data + offsets_[i - 1], widths_[i - 1],
+                                   heights_[i - 1], data + offsets_[i],
+                                   widths_[i], with_gaussian_filter);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_pixels), func);
+    }
+    return *this;
+}
+
+void FloatImagePyramid::CopyLevel(size_t level, Image &output) const {
+    if (level >= GetNumLevels()) {
+        utility::LogError("[FloatImagePyramid] Level {:d} is out of range.",
+                          (int)level);
+        return;
+    }
+    output.Prepare(widths_[level], heights_[level], 1, 4);
+    if (output.data_.empty()) return;
+    cudaSafeCall(cudaMemcpy(thrust::raw_pointer_cast(output.data_.data()),
+                            GetLevelData(level), output.data_.size(),
+                            cudaMemcpyDeviceToDevice));
+}
+
+ImagePyramid FloatImagePyramid::ToImagePyramid() const {
+    ImagePyramid output;
+    for (size_t i = 0; i < GetNumLevels(); ++i) {
+        auto level = std::make_shared<Image>();
+        CopyLevel(i, *level);
+        output.push_back(level);
+    }
+    return output;
+}
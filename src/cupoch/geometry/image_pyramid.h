@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// \class FloatImagePyramid
+///
+/// \brief Pyramid of a single channel float image in one device buffer.
+///
+/// The levels are stored one after the other in data_. Every level is
+/// built from the previous one by a single kernel, which blurs and
+/// downsamples at once: the 3 tap Gaussian followed by the 2x2 average is
+/// the 4 x 4 kernel of the weights (1, 3, 3, 1) / 8 along both axes, the
+/// border pixels being replicated. Build() keeps the buffer when the size of
+/// the input and the number of levels are the same as for the previous
+/// call, so a pyramid can be rebuilt frame to frame without allocation.
+class FloatImagePyramid {
+public:
+    FloatImagePyramid();
+    ~FloatImagePyramid();
+
+    /// Builds \p num_of_levels levels of \p input, a single channel float
+    /// image, with the blur of Image::CreatePyramid when
+    /// \p with_gaussian_filter is true and the plain 2x2 average
+    /// otherwise.
+    FloatImagePyramid &Build(const Image &input,
+                             size_t num_of_levels,
+                             bool with_gaussian_filter = true);
+    FloatImagePyramid &Clear();
+
+    size_t GetNumLevels() const { return widths_.size(); }
+    int GetWidth(size_t level) const { return widths_[level]; }
+    int GetHeight(size_t level) const { return heights_[level]; }
+    /// Device pointer to the pixels of \p level, row major.
+    const float *GetLevelData(size_t level) const {
+        return thrust::raw_pointer_cast(data_.data()) + offsets_[level];
+    }
+
+    /// Copies \p level into \p output, reusing its memory when it already
+    /// has the size of the level.
+    void CopyLevel(size_t level, Image &output) const;
+    /// Copies of all the levels.
+    ImagePyramid ToImagePyramid() const;
+
+public:
+    /// Pixels of all the levels.
+    utility::device_vector<float> data_;
+    std::vector<int> widths_;
+    std::vector<int> heights_;
+    /// Offset of the first pixel of every level in data_.
+    std::vector<size_t> offsets_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
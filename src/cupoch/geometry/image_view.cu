@@ -0,0 +1,176 @@
+#include <type_traits>
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/image_view.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+template <typename T, int C>
+void CheckImageFormat(const Image &image) {
+    if (image.num_of_channels_ != C || image.bytes_per_channel_ != sizeof(T)) {
+        utility::LogError(
+                "[ImageView] Image of {} channels of {} bytes, expected {} "
+                "channels of {} bytes.",
+                image.num_of_channels_, image.bytes_per_channel_, C,
+                sizeof(T));
+    }
+}
+
+struct sample_texture_functor {
+    sample_texture_functor(cudaTextureObject_t texture, int width, int height)
+        : texture_(texture), width_(width), height_(height){};
+    const cudaTextureObject_t texture_;
+    const int width_;
+    const int height_;
+    __device__ float operator()(const Eigen::Vector2f &uv) const {
+        return TextureValueAt(texture_, width_, height_, uv[0], uv[1]).second;
+    }
+};
+
+}  // namespace
+
+namespace cupoch {
+namespace geometry {
+
+template <typename T, int C>
+ImageView<T, C> MakeImageView(Image &image) {
+    CheckImageFormat<T, C>(image);
+    return ImageView<T, C>((T *)thrust::raw_pointer_cast(image.data_.data()),
+                           image.width_, image.height_, image.BytesPerLine());
+}
+
+template <typename T, int C>
+ImageView<const T, C> MakeImageView(const Image &image) {
+    CheckImageFormat<T, C>(image);
+    return ImageView<const T, C>(
+            (const T *)thrust::raw_pointer_cast(image.data_.data()),
+            image.width_, image.height_, image.BytesPerLine());
+}
+
+template <typename T, int C>
+PitchedImage<T, C>::PitchedImage() {}
+
+template <typename T, int C>
+PitchedImage<T, C>::~PitchedImage() {
+    Clear();
+}
+
+template <typename T, int C>
+PitchedImage<T, C> &PitchedImage<T, C>::Prepare(int width, int height) {
+    if (data_ && width == width_ && height == height_) return *this;
+    Clear();
+    if (width <= 0 || height <= 0) return *this;
+    cudaSafeMalloc(cudaMallocPitch((void **)&data_, &pitch_,
+                                   width * C * sizeof(T), height));
+    width_ = width;
+    height_ = height;
+    return *this;
+}
+
+template <typename T, int C>
+PitchedImage<T, C> &PitchedImage<T, C>::Clear() {
+    if (texture_) {
+        cudaDestroyTextureObject(texture_);
+        texture_ = 0;
+    }
+    if (data_) cudaFree(data_);
+    data_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+    pitch_ = 0;
+    return *this;
+}
+
+template <typename T, int C>
+PitchedImage<T, C> &PitchedImage<T, C>::CopyFrom(const Image &image) {
+    CheckImageFormat<T, C>(image);
+    Prepare(image.width_, image.height_);
+    if (IsEmpty()) return *this;
+    cudaSafeCall(cudaMemcpy2D(data_, pitch_,
+                              thrust::raw_pointer_cast(image.data_.data()),
+                              image.BytesPerLine(), image.BytesPerLine(),
+                              height_, cudaMemcpyDeviceToDevice));
+    return *this;
+}
+
+template <typename T, int C>
+void PitchedImage<T, C>::CopyTo(Image &image) const {
+    if (image.width_ != width_ || image.height_ != height_ ||
+        image.num_of_channels_ != C || image.bytes_per_channel_ != sizeof(T) ||
+        !image.HasData()) {
+        image.Prepare(width_, height_, C, sizeof(T));
+    }
+    if (IsEmpty()) return;
+    cudaSafeCall(cudaMemcpy2D(thrust::raw_pointer_cast(image.data_.data()),
+                              image.BytesPerLine(), data_, pitch_,
+                              image.BytesPerLine(), height_,
+                              cudaMemcpyDeviceToDevice));
+}
+
+template <typename T, int C>
+cudaTextureObject_t PitchedImage<T, C>::GetTexture() const {
+    if (C != 1 || !std::is_same<T, float>::value) {
+        utility::LogError(
+                "[PitchedImage] Textures need a single channel float image.");
+    }
+    if (IsEmpty()) {
+        utility::LogError("[PitchedImage] Empty image.");
+    }
+    if (texture_) return texture_;
+    cudaResourceDesc res_desc = {};
+    res_desc.resType = cudaResourceTypePitch2D;
+    res_desc.res.pitch2D.devPtr = data_;
+    res_desc.res.pitch2D.desc = cudaCreateChannelDesc<float>();
+    res_desc.res.pitch2D.width = width_;
+    res_desc.res.pitch2D.height = height_;
+    res_desc.res.pitch2D.pitchInBytes = pitch_;
+    cudaTextureDesc tex_desc = {};
+    tex_desc.addressMode[0] = cudaAddressModeClamp;
+    tex_desc.addressMode[1] = cudaAddressModeClamp;
+    tex_desc.filterMode = cudaFilterModeLinear;
+    tex_desc.readMode = cudaReadModeElementType;
+    tex_desc.normalizedCoords = 0;
+    cudaSafeCall(
+            cudaCreateTextureObject(&texture_, &res_desc, &tex_desc, NULL));
+    return texture_;
+}
+
+utility::device_vector<float> SampleTexture(
+        const PitchedImage<float, 1> &image,
+        const utility::device_vector<Eigen::Vector2f> &uvs) {
+    utility::device_vector<float> values(uvs.size());
+    sample_texture_functor func(image.GetTexture(), image.width_,
+                                image.height_);
+    thrust::transform(uvs.begin(), uvs.end(), values.begin(), func);
+    return values;
+}
+
+template class PitchedImage<uint8_t, 1>;
+template class PitchedImage<uint8_t, 3>;
+template class PitchedImage<uint16_t, 1>;
+template class PitchedImage<float, 1>;
+template class PitchedImage<float, 3>;
+
+template ImageView<uint8_t, 1> MakeImageView<uint8_t, 1>(Image &image);
+template ImageView<const uint8_t, 1> MakeImageView<uint8_t, 1>(
+        const Image &image);
+template ImageView<uint8_t, 3> MakeImageView<uint8_t, 3>(Image &image);
+template ImageView<const uint8_t, 3> MakeImageView<uint8_t, 3>(
+        const Image &image);
+template ImageView<uint16_t, 1> MakeImageView<uint16_t, 1>(Image &image);
+template ImageView<const uint16_t, 1> MakeImageView<uint16_t, 1>(
+        const Image &image);
+template ImageView<float, 1> MakeImageView<float, 1>(Image &image);
+template ImageView<const float, 1> MakeImageView<float, 1>(
+        const Image &image);
+template ImageView<float, 3> MakeImageView<float, 3>(Image &image);
+template ImageView<const float, 3> MakeImageView<float, 3>(
+        const Image &image);
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class Image;
+
+/// \class ImageView
+///
+/// \brief Non owning view of an image of \p C channels of type \p T.
+///
+/// The pixel type and the number of channels are template parameters, so
+/// the kernels taking a view are specialized at compile time instead of
+/// computing the strides from num_of_channels_ and bytes_per_channel_. The
+/// rows are pitch_ bytes apart, which covers both the packed rows of Image
+/// and the padded rows of PitchedImage.
+template <typename T, int C = 1>
+class ImageView {
+public:
+    __host__ __device__ ImageView() {}
+    __host__ __device__ ImageView(T *data, int width, int height, size_t pitch)
+        : data_(data), width_(width), height_(height), pitch_(pitch) {}
+
+    /// First pixel of row \p v.
+    __host__ __device__ T *RowAt(int v) const {
+        return (T *)((char *)data_ + v * pitch_);
+    }
+    __host__ __device__ T &At(int u, int v, int ch = 0) const {
+        return RowAt(v)[u * C + ch];
+    }
+    __host__ __device__ bool IsInside(float u, float v) const {
+        return u >= 0.0 && u <= (float)(width_ - 1) && v >= 0.0 &&
+               v <= (float)(height_ - 1);
+    }
+
+    /// Bilinear interpolated value of a single channel image at (u, v),
+    /// with (0, 0) the center of the first pixel. The bool is false when
+    /// (u, v) is out of the image.
+    __host__ __device__ thrust::pair<bool, float> FloatValueAt(float u,
+                                                               float v) const {
+        static_assert(C == 1, "FloatValueAt needs a single channel image.");
+        if (!IsInside(u, v)) return thrust::make_pair(false, 0.0f);
+        int ui = std::max(std::min((int)u, width_ - 2), 0);
+        int vi = std::max(std::min((int)v, height_ - 2), 0);
+        float pu = u - ui;
+        float pv = v - vi;
+        const T *row0 = RowAt(vi);
+        const T *row1 = RowAt(std::min(vi + 1, height_ - 1));
+        const int ui1 = std::min(ui + 1, width_ - 1);
+        return thrust::make_pair(
+                true, ((float)row0[ui] * (1 - pv) + (float)row1[ui] * pv) *
+                                      (1 - pu) +
+                              ((float)row0[ui1] * (1 - pv) +
+                               (float)row1[ui1] * pv) *
+                                      pu);
+    }
+
+public:
+    T *data_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    /// Bytes between the first pixels of two rows.
+    size_t pitch_ = 0;
+};
+
+/// Views of the pixels of \p image, checked against its format.
+template <typename T, int C = 1>
+ImageView<T, C> MakeImageView(Image &image);
+template <typename T, int C = 1>
+ImageView<const T, C> MakeImageView(const Image &image);
+
+/// \class PitchedImage
+///
+/// \brief Image of \p C channels of type \p T in pitched device memory.
+///
+/// The rows are allocated with cudaMallocPitch, so every row starts on the
+/// alignment of the device and the accesses along the rows are coalesced.
+/// The single channel float images can be bound to a 2D texture, to be
+/// sampled with the bilinear interpolation of the texture units.
+template <typename T, int C = 1>
+class PitchedImage {
+public:
+    PitchedImage();
+    ~PitchedImage();
+    PitchedImage(const PitchedImage &) = delete;
+    PitchedImage &operator=(const PitchedImage &) = delete;
+
+    /// Allocates \p width x \p height pixels, keeping the memory when the
+    /// size does not change.
+    PitchedImage &Prepare(int width, int height);
+    PitchedImage &Clear();
+    bool IsEmpty() const { return data_ == nullptr; }
+
+    /// Copies from and to the packed rows of \p image.
+    PitchedImage &CopyFrom(const Image &image);
+    void CopyTo(Image &image) const;
+
+    ImageView<T, C> GetView() {
+        return ImageView<T, C>(data_, width_, height_, pitch_);
+    }
+    ImageView<const T, C> GetView() const {
+        return ImageView<const T, C>(data_, width_, height_, pitch_);
+    }
+
+    /// Texture of a single channel float image with bilinear filtering and
+    /// clamped borders, in pixel coordinates. It is created on the first
+    /// call and stays valid until the image is reallocated or cleared.
+    cudaTextureObject_t GetTexture() const;
+
+public:
+    T *data_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    size_t pitch_ = 0;
+
+private:
+    mutable cudaTextureObject_t texture_ = 0;
+};
+
+#ifdef __CUDACC__
+/// Same as ImageView::FloatValueAt on the texture of a PitchedImage. The
+/// texture units interpolate with 8 bits of fraction, so the values are
+/// within 1/256 of the pixel differences of the exact interpolation.
+__device__ inline thrust::pair<bool, float> TextureValueAt(
+        cudaTextureObject_t texture, int width, int height, float u, float v) {
+    if (u < 0.0 || u > (float)(width - 1) || v < 0.0 ||
+        v > (float)(height - 1)) {
+        return thrust::make_pair(false, 0.0f);
+    }
+    return thrust::make_pair(true, tex2D<float>(texture, u + 0.5f, v + 0.5f));
+}
+#endif
+
+/// Texture samples of \p image at \p uvs, zero out of the image.
+utility::device_vector<float> SampleTexture(
+        const PitchedImage<float, 1> &image,
+        const utility::device_vector<Eigen::Vector2f> &uvs);
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,282 @@
+#include <thrust/copy.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/sequence.h>
+
+#include <limits>
+
+#include "cupoch/geometry/incremental_kdtree_flann.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct mark_removed_functor {
+    mark_removed_functor(bool *removed, int n_points)
+        : removed_(removed), n_points_(n_points){};
+    bool *removed_;
+    const int n_points_;
+    __device__ void operator()(int idx) const {
+        if (idx >= 0 && idx < n_points_) removed_[idx] = true;
+    }
+};
+
+struct merge_neighbors_functor {
+    merge_neighbors_functor(const int *sub_indices,
+                            const float *sub_distance2,
+                            int sub_width,
+                            const int *tree_indices,
+                            const bool *removed,
+                            int width,
+                            int *indices,
+                            float *distance2)
+        : sub_indices_(sub_indices),
+          sub_distance2_(sub_distance2),
+          sub_width_(sub_width),
+          tree_indices_(tree_indices),
+          removed_(removed),
+          width_(width),
+          indices_(indices),
+          distance2_(distance2){};
+    const int *sub_indices_;
+    const float *sub_distance2_;
+    const int sub_width_;
+    const int *tree_indices_;
+    const bool *removed_;
+    const int width_;
+    int *indices_;
+    float *distance2_;
+    __device__ void operator()(size_t idx) const {
+        int *out_idx = indices_ + idx * width_;
+        float *out_d2 = distance2_ + idx * width_;
+        for (int j = 0; j < sub_width_; ++j) {
+            const int local = sub_indices_[idx * sub_width_ + j];
+            if (local < 0) continue;
+            const float d2 = sub_distance2_[idx * sub_width_ + j];
+            if (d2 >= out_d2[width_ - 1]) continue;
+            const int global = tree_indices_[local];
+            if (removed_[global]) continue;
+            int k = width_ - 1;
+            while (k > 0 && out_d2[k - 1] > d2) {
+                out_d2[k] = out_d2[k - 1];
+                out_idx[k] = out_idx[k - 1];
+                --k;
+            }
+            out_d2[k] = d2;
+            out_idx[k] = global;
+        }
+    }
+};
+
+utility::device_vector<int> SelectNotRemoved(
+        const utility::device_vector<int> &indices,
+        const utility::device_vector<bool> &removed) {
+    utility::device_vector<int> out(indices.size());
+    auto end = thrust::copy_if(
+            indices.begin(), indices.end(),
+            thrust::make_permutation_iterator(removed.begin(),
+                                              indices.begin()),
+            out.begin(), thrust::logical_not<bool>());
+    out.resize(thrust::distance(out.begin(), end));
+    return out;
+}
+
+}  // namespace
+
+IncrementalKDTreeFlann::IncrementalKDTreeFlann(float rebuild_ratio)
+    : rebuild_ratio_(rebuild_ratio) {}
+
+IncrementalKDTreeFlann::~IncrementalKDTreeFlann() {}
+
+void IncrementalKDTreeFlann::Clear() {
+    num_removed_ = 0;
+    points_.clear();
+    removed_.clear();
+    trees_.clear();
+}
+
+size_t IncrementalKDTreeFlann::InsertPoints(
+        const utility::device_vector<Eigen::Vector3f> &points) {
+    const size_t first = points_.size();
+    if (points.empty()) return first;
+    points_.insert(points_.end(), points.begin(), points.end());
+    removed_.resize(points_.size(), false);
+    utility::device_vector<int> indices(points.size());
+    thrust::sequence(indices.begin(), indices.end(), int(first));
+    PushSubTree(indices);
+    while (trees_.size() >= 2 &&
+           trees_[trees_.size() - 2]->indices_.size() <=
+                   2 * trees_.back()->indices_.size()) {
+        MergeLastSubTrees();
+    }
+    return first;
+}
+
+size_t IncrementalKDTreeFlann::RemovePoints(
+        const utility::device_vector<int> &indices) {
+    if (indices.empty() || points_.empty()) return 0;
+    thrust::for_each(indices.begin(), indices.end(),
+                     mark_removed_functor(
+                             thrust::raw_pointer_cast(removed_.data()),
+                             points_.size()));
+    const size_t total_removed =
+            thrust::count(removed_.begin(), removed_.end(), true);
+    const size_t n_removed = total_removed - num_removed_;
+    num_removed_ = total_removed;
+    if (num_removed_ > 0 && num_removed_ >= rebuild_ratio_ * points_.size()) {
+        Rebuild();
+    }
+    return n_removed;
+}
+
+void IncrementalKDTreeFlann::Rebuild() {
+    utility::device_vector<int> indices(points_.size());
+    thrust::sequence(indices.begin(), indices.end());
+    utility::device_vector<int> alive = SelectNotRemoved(indices, removed_);
+    trees_.clear();
+    PushSubTree(alive);
+}
+
+void IncrementalKDTreeFlann::PushSubTree(utility::device_vector<int> &indices) {
+    if (indices.empty()) return;
+    utility::device_vector<Eigen::Vector3f> points(indices.size());
+    thrust::gather(indices.begin(), indices.end(), points_.begin(),
+                   points.begin());
+    std::unique_ptr<SubTree> tree(new SubTree());
+    tree->indices_.swap(indices);
+    tree->kdtree_.SetRawData(points);
+    trees_.push_back(std::move(tree));
+}
+
+void IncrementalKDTreeFlann::MergeLastSubTrees() {
+    const auto &older = trees_[trees_.size() - 2]->indices_;
+    const auto &newer = trees_.back()->indices_;
+    utility::device_vector<int> indices(older.size() + newer.size());
+    thrust::copy(older.begin(), older.end(), indices.begin());
+    thrust::copy(newer.begin(), newer.end(), indices.begin() + older.size());
+    utility::device_vector<int> alive = SelectNotRemoved(indices, removed_);
+    trees_.pop_back();
+    trees_.pop_back();
+    PushSubTree(alive);
+}
+
+template <typename T>
+int IncrementalKDTreeFlann::Search(
+        const utility::device_vector<T> &query,
+        const KDTreeSearchParam &param,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    switch (param.GetSearchType()) {
+        case KDTreeSearchParam::SearchType::Knn:
+            return SearchKNN(query, ((const KDTreeSearchParamKNN &)param).knn_,
+                             indices, distance2);
+        case KDTreeSearchParam::SearchType::Radius:
+            return SearchRadius(
+                    query, ((const KDTreeSearchParamRadius &)param).radius_,
+                    indices, distance2);
+        case KDTreeSearchParam::SearchType::Hybrid:
+            return SearchHybrid(
+                    query, ((const KDTreeSearchParamHybrid &)param).radius_,
+                    ((const KDTreeSearchParamHybrid &)param).max_nn_, indices,
+                    distance2);
+        default:
+            return -1;
+    }
+    return -1;
+}
+
+template <typename T>
+int IncrementalKDTreeFlann::SearchKNN(
+        const utility::device_vector<T> &query,
+        int knn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    if (knn > NUM_MAX_NN) return -1;
+    return SearchImpl(query, 0.0, knn, true, indices, distance2);
+}
+
+template <typename T>
+int IncrementalKDTreeFlann::SearchRadius(
+        const utility::device_vector<T> &query,
+        float radius,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    return SearchImpl(query, radius, NUM_MAX_NN, false, indices, distance2);
+}
+
+template <typename T>
+int IncrementalKDTreeFlann::SearchHybrid(
+        const utility::device_vector<T> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    return SearchImpl(query, radius, max_nn, false, indices, distance2);
+}
+
+template <typename T>
+int IncrementalKDTreeFlann::SearchImpl(
+        const utility::device_vector<T> &query,
+        float radius,
+        int max_nn,
+        bool knn_mode,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    if (trees_.empty() || query.empty() || max_nn <= 0) return -1;
+    indices.resize(query.size() * max_nn);
+    distance2.resize(query.size() * max_nn);
+    thrust::fill(indices.begin(), indices.end(), -1);
+    thrust::fill(distance2.begin(), distance2.end(),
+                 std::numeric_limits<float>::infinity());
+    utility::device_vector<int> sub_indices;
+    utility::device_vector<float> sub_distance2;
+    for (const auto &tree : trees_) {
+        int sub_width = max_nn;
+        int result;
+        if (knn_mode) {
+            sub_width = std::min(max_nn, int(tree->indices_.size()));
+            result = tree->kdtree_.SearchKNN(query, sub_width, sub_indices,
+                                             sub_distance2);
+        } else {
+            result = tree->kdtree_.SearchHybrid(query, radius, sub_width,
+                                                sub_indices, sub_distance2);
+        }
+        if (result < 0) return -1;
+        merge_neighbors_functor func(
+                thrust::raw_pointer_cast(sub_indices.data()),
+                thrust::raw_pointer_cast(sub_distance2.data()), sub_width,
+                thrust::raw_pointer_cast(tree->indices_.data()),
+                thrust::raw_pointer_cast(removed_.data()), max_nn,
+                thrust::raw_pointer_cast(indices.data()),
+                thrust::raw_pointer_cast(distance2.data()));
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(query.size()), func);
+    }
+    return 1;
+}
+
+template int IncrementalKDTreeFlann::Search<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        const KDTreeSearchParam &param,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int IncrementalKDTreeFlann::SearchKNN<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        int knn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int IncrementalKDTreeFlann::SearchRadius<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int IncrementalKDTreeFlann::SearchHybrid<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
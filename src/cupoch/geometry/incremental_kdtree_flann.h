@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// \class IncrementalKDTreeFlann
+///
+/// \brief Nearest neighbor index for point sets that grow in batches.
+///
+/// The index is a forest of KDTreeFlann sub-trees over contiguous batches
+/// of inserted points. A new batch gets its own sub-tree, and the newest
+/// sub-trees are merged whenever the older one is not more than twice the
+/// size of the newer one, so every point is rebuilt O(log n) times and an
+/// insertion costs time proportional to the batch, amortized. Removed
+/// points are flagged and skipped by the queries, and are dropped from the
+/// sub-trees at the next merge or rebuild.
+///
+/// Point indices are the insertion order and stay valid across merges and
+/// rebuilds.
+class IncrementalKDTreeFlann {
+public:
+    /// The whole forest is rebuilt into a single tree once the ratio of
+    /// removed points reaches \p rebuild_ratio.
+    explicit IncrementalKDTreeFlann(float rebuild_ratio = 0.5);
+    ~IncrementalKDTreeFlann();
+    IncrementalKDTreeFlann(const IncrementalKDTreeFlann &) = delete;
+    IncrementalKDTreeFlann &operator=(const IncrementalKDTreeFlann &) = delete;
+
+public:
+    void Clear();
+
+    /// Appends \p points to the index and returns the index of the first
+    /// inserted point.
+    size_t InsertPoints(const utility::device_vector<Eigen::Vector3f> &points);
+
+    /// Removes the points with the given indices and returns the number of
+    /// points that were actually removed.
+    size_t RemovePoints(const utility::device_vector<int> &indices);
+
+    /// Rebuilds the forest into a single tree of the remaining points.
+    void Rebuild();
+
+    template <typename T>
+    int Search(const utility::device_vector<T> &query,
+               const KDTreeSearchParam &param,
+               utility::device_vector<int> &indices,
+               utility::device_vector<float> &distance2) const;
+
+    template <typename T>
+    int SearchKNN(const utility::device_vector<T> &query,
+                  int knn,
+                  utility::device_vector<int> &indices,
+                  utility::device_vector<float> &distance2) const;
+
+    template <typename T>
+    int SearchRadius(const utility::device_vector<T> &query,
+                     float radius,
+                     utility::device_vector<int> &indices,
+                     utility::device_vector<float> &distance2) const;
+
+    template <typename T>
+    int SearchHybrid(const utility::device_vector<T> &query,
+                     float radius,
+                     int max_nn,
+                     utility::device_vector<int> &indices,
+                     utility::device_vector<float> &distance2) const;
+
+    /// All inserted points, including the removed ones.
+    const utility::device_vector<Eigen::Vector3f> &GetPoints() const {
+        return points_;
+    }
+    size_t GetNumPoints() const { return points_.size() - num_removed_; }
+    size_t GetNumSubTrees() const { return trees_.size(); }
+
+protected:
+    struct SubTree {
+        utility::device_vector<int> indices_;
+        KDTreeFlann kdtree_;
+    };
+
+    void PushSubTree(utility::device_vector<int> &indices);
+    void MergeLastSubTrees();
+
+    template <typename T>
+    int SearchImpl(const utility::device_vector<T> &query,
+                   float radius,
+                   int max_nn,
+                   bool knn_mode,
+                   utility::device_vector<int> &indices,
+                   utility::device_vector<float> &distance2) const;
+
+    float rebuild_ratio_;
+    size_t num_removed_ = 0;
+    utility::device_vector<Eigen::Vector3f> points_;
+    utility::device_vector<bool> removed_;
+    std::vector<std::unique_ptr<SubTree>> trees_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
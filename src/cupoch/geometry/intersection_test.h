@@ -48,6 +48,31 @@ __host__ __device__ inline bool BoxBox(
         const Eigen::Matrix3f& rot2,
         const Eigen::Vector3f& center2);
 
+/// Ray parameter at which the ray origin + t * direction enters the box,
+/// \p inv_dir being the inverse of the direction; 0 from inside, infinity
+/// when the ray misses the box before \p t_max.
+__host__ __device__ inline float RayAABB(
+        const Eigen::Vector3f& origin,
+        const Eigen::Vector3f& inv_dir,
+        const Eigen::Vector3f& min_bound,
+        const Eigen::Vector3f& max_bound,
+        float t_max);
+
+/// Moller-Trumbore test of the ray origin + t * direction against the
+/// triangle, both faces, for t in [0, t_max). On a hit, \p t is the ray
+/// parameter and (\p u, \p v) the barycentric coordinates of vert1 and
+/// vert2.
+__host__ __device__ inline bool RayTriangle(
+        const Eigen::Vector3f& origin,
+        const Eigen::Vector3f& direction,
+        const Eigen::Vector3f& vert0,
+        const Eigen::Vector3f& vert1,
+        const Eigen::Vector3f& vert2,
+        float t_max,
+        float& t,
+        float& u,
+        float& v);
+
 }  // namespace intersection_test
 
 }  // namespace geometry
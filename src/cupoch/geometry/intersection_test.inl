@@ -1,3 +1,4 @@
+#include <thrust/swap.h>
 #include <tomasakeninemoeller/opttritri.h>
 #include <tomasakeninemoeller/tribox3.h>
 
@@ -139,6 +140,51 @@ bool BoxBox(const Eigen::Vector3f& extents1,
     return true;
 }
 
+float RayAABB(const Eigen::Vector3f& origin,
+              const Eigen::Vector3f& inv_dir,
+              const Eigen::Vector3f& min_bound,
+              const Eigen::Vector3f& max_bound,
+              float t_max) {
+    float t0 = 0.0f;
+    float t1 = t_max;
+    for (int i = 0; i < 3; ++i) {
+        float ta = (min_bound[i] - origin[i]) * inv_dir[i];
+        float tb = (max_bound[i] - origin[i]) * inv_dir[i];
+        // 0 * inf for the rays in the plane of a slab.
+        if (isnan(ta) || isnan(tb)) continue;
+        if (ta > tb) thrust::swap(ta, tb);
+        t0 = fmaxf(t0, ta);
+        t1 = fminf(t1, tb);
+        if (t0 > t1) return std::numeric_limits<float>::infinity();
+    }
+    return t0;
+}
+
+bool RayTriangle(const Eigen::Vector3f& origin,
+                 const Eigen::Vector3f& direction,
+                 const Eigen::Vector3f& vert0,
+                 const Eigen::Vector3f& vert1,
+                 const Eigen::Vector3f& vert2,
+                 float t_max,
+                 float& t,
+                 float& u,
+                 float& v) {
+    const Eigen::Vector3f e1 = vert1 - vert0;
+    const Eigen::Vector3f e2 = vert2 - vert0;
+    const Eigen::Vector3f p = direction.cross(e2);
+    const float det = e1.dot(p);
+    if (det == 0.0f) return false;
+    const float inv_det = 1.0f / det;
+    const Eigen::Vector3f s = origin - vert0;
+    u = s.dot(p) * inv_det;
+    if (u < 0.0f || u > 1.0f) return false;
+    const Eigen::Vector3f q = s.cross(e1);
+    v = direction.dot(q) * inv_det;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    t = e2.dot(q) * inv_det;
+    return t >= 0.0f && t < t_max;
+}
+
 }  // namespace intersection_test
 
 }  // namespace geometry
@@ -8,6 +8,8 @@
 #include "cupoch/utility/console.h"
 #include "cupoch/utility/eigen.h"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/profiler.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -20,11 +22,54 @@ struct convert_float4_functor {
     }
 };
 
+// Upper bound of the dense scratch entries used by SearchRadiusCSR.
+constexpr size_t kMaxCSRChunkEntries = 1 << 22;
+
+struct count_valid_neighbors_functor {
+    count_valid_neighbors_functor(const int *indices, int max_nn)
+        : indices_(indices), max_nn_(max_nn){};
+    const int *indices_;
+    const int max_nn_;
+    __device__ int operator()(size_t idx) const {
+        int count = 0;
+        for (int k = 0; k < max_nn_; ++k) {
+            if (indices_[idx * max_nn_ + k] >= 0) ++count;
+        }
+        return count;
+    }
+};
+
+struct is_valid_neighbor_functor {
+    __device__ bool operator()(const thrust::tuple<int, float> &x) const {
+        return thrust::get<0>(x) >= 0;
+    }
+};
+
+utility::device_vector<float4> &GetQueryBuffer(
+        utility::Workspace *workspace,
+        utility::device_vector<float4> &local_buffer,
+        size_t n) {
+    if (workspace) return workspace->GetBuffer<float4>("kdtree_query", n);
+    local_buffer.resize(n);
+    return local_buffer;
+}
+
 }  // namespace
 
-KDTreeFlann::KDTreeFlann() {}
+KDTreeFlann::KDTreeFlann()
+    : context_(&utility::ExecutionContext::Default()) {}
 
-KDTreeFlann::KDTreeFlann(const Geometry &data) { SetGeometry(data); }
+KDTreeFlann::KDTreeFlann(const Geometry &data)
+    : context_(&utility::ExecutionContext::Default()) {
+    SetGeometry(data);
+}
+
+KDTreeFlann::KDTreeFlann(utility::ExecutionContext &ctx) : context_(&ctx) {}
+
+KDTreeFlann::KDTreeFlann(utility::ExecutionContext &ctx, const Geometry &data)
+    : context_(&ctx) {
+    SetGeometry(data);
+}
 
 KDTreeFlann::~KDTreeFlann() {}
 
@@ -72,6 +117,9 @@ int KDTreeFlann::SearchKNN(const utility::device_vector<T> &query,
                            int knn,
                            utility::device_vector<int> &indices,
                            utility::device_vector<float> &distance2) const {
+    CUPOCH_PROFILE("KDTreeFlann::SearchKNN");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::KDTree);
     // This is optimized code for heavily repeated search.
     // Other flann::Index::knnSearch() implementations lose performance due to
     // memory allocation/deallocation.
@@ -81,8 +129,12 @@ int KDTreeFlann::SearchKNN(const utility::device_vector<T> &query,
     T query0 = query[0];
     if (size_t(query0.size()) != dimension_) return -1;
     convert_float4_functor func;
-    utility::device_vector<float4> query_f4(query.size());
-    thrust::transform(query.begin(), query.end(), query_f4.begin(), func);
+    cudaStream_t stream = context_->GetStream();
+    utility::device_vector<float4> local_f4;
+    utility::device_vector<float4> &query_f4 =
+            GetQueryBuffer(workspace_, local_f4, query.size());
+    thrust::transform(utility::exec_policy(stream)->on(stream), query.begin(),
+                      query.end(), query_f4.begin(), func);
     flann::Matrix<float> query_flann(
             (float *)(thrust::raw_pointer_cast(query_f4.data())), query.size(),
             dimension_, sizeof(float) * 4);
@@ -105,6 +157,9 @@ int KDTreeFlann::SearchRadius(const utility::device_vector<T> &query,
                               float radius,
                               utility::device_vector<int> &indices,
                               utility::device_vector<float> &distance2) const {
+    CUPOCH_PROFILE("KDTreeFlann::SearchRadius");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::KDTree);
     // This is optimized code for heavily repeated search.
     // Since max_nn is not given, we let flann to do its own memory management.
     // Other flann::Index::radiusSearch() implementations lose performance due
@@ -113,8 +168,12 @@ int KDTreeFlann::SearchRadius(const utility::device_vector<T> &query,
     T query0 = query[0];
     if (size_t(query0.size()) != dimension_) return -1;
     convert_float4_functor func;
-    utility::device_vector<float4> query_f4(query.size());
-    thrust::transform(query.begin(), query.end(), query_f4.begin(), func);
+    cudaStream_t stream = context_->GetStream();
+    utility::device_vector<float4> local_f4;
+    utility::device_vector<float4> &query_f4 =
+            GetQueryBuffer(workspace_, local_f4, query.size());
+    thrust::transform(utility::exec_policy(stream)->on(stream), query.begin(),
+                      query.end(), query_f4.begin(), func);
     flann::Matrix<float> query_flann(
             (float *)(thrust::raw_pointer_cast(query_f4.data())), query.size(),
             dimension_, sizeof(float) * 4);
@@ -138,6 +197,9 @@ int KDTreeFlann::SearchHybrid(const utility::device_vector<T> &query,
                               int max_nn,
                               utility::device_vector<int> &indices,
                               utility::device_vector<float> &distance2) const {
+    CUPOCH_PROFILE("KDTreeFlann::SearchHybrid");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::KDTree);
     // This is optimized code for heavily repeated search.
     // It is also the recommended setting for search.
     // Other flann::Index::radiusSearch() implementations lose performance due
@@ -147,8 +209,12 @@ int KDTreeFlann::SearchHybrid(const utility::device_vector<T> &query,
     T query0 = query[0];
     if (size_t(query0.size()) != dimension_) return -1;
     convert_float4_functor func;
-    utility::device_vector<float4> query_f4(query.size());
-    thrust::transform(query.begin(), query.end(), query_f4.begin(), func);
+    cudaStream_t stream = context_->GetStream();
+    utility::device_vector<float4> local_f4;
+    utility::device_vector<float4> &query_f4 =
+            GetQueryBuffer(workspace_, local_f4, query.size());
+    thrust::transform(utility::exec_policy(stream)->on(stream), query.begin(),
+                      query.end(), query_f4.begin(), func);
     flann::Matrix<float> query_flann(
             (float *)(thrust::raw_pointer_cast(query_f4.data())), query.size(),
             dimension_, sizeof(float) * 4);
@@ -166,8 +232,68 @@ int KDTreeFlann::SearchHybrid(const utility::device_vector<T> &query,
     return k;
 }
 
+template <typename T>
+int KDTreeFlann::SearchRadiusCSR(const utility::device_vector<T> &query,
+                                 float radius,
+                                 int max_nn,
+                                 utility::device_vector<int> &offsets,
+                                 utility::device_vector<int> &indices,
+                                 utility::device_vector<float> &distance2) const {
+    if (query.empty() || max_nn <= 0) return -1;
+    const size_t n_query = query.size();
+    const size_t chunk_size =
+            std::max(kMaxCSRChunkEntries / size_t(max_nn), size_t(1));
+    cudaStream_t stream = context_->GetStream();
+    utility::device_vector<int> counts(n_query + 1, 0);
+    utility::device_vector<T> chunk_query;
+    utility::device_vector<int> local_indices;
+    utility::device_vector<float> local_distance2;
+    utility::device_vector<int> &dense_indices =
+            workspace_ ? workspace_->GetBuffer<int>("kdtree_csr_indices", 0)
+                       : local_indices;
+    utility::device_vector<float> &dense_distance2 =
+            workspace_ ? workspace_->GetBuffer<float>("kdtree_csr_distance2", 0)
+                       : local_distance2;
+    indices.clear();
+    distance2.clear();
+    for (size_t start = 0; start < n_query; start += chunk_size) {
+        const size_t end = std::min(start + chunk_size, n_query);
+        chunk_query.resize(end - start);
+        thrust::copy(utility::exec_policy(stream)->on(stream),
+                     query.begin() + start, query.begin() + end,
+                     chunk_query.begin());
+        if (SearchHybrid(chunk_query, radius, max_nn, dense_indices,
+                         dense_distance2) < 0)
+            return -1;
+        count_valid_neighbors_functor func(
+                thrust::raw_pointer_cast(dense_indices.data()), max_nn);
+        thrust::transform(utility::exec_policy(stream)->on(stream),
+                          thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(end - start),
+                          counts.begin() + start, func);
+        const size_t n_valid =
+                thrust::reduce(utility::exec_policy(stream)->on(stream),
+                               counts.begin() + start, counts.begin() + end);
+        const size_t n_prev = indices.size();
+        indices.resize(n_prev + n_valid);
+        distance2.resize(n_prev + n_valid);
+        thrust::copy_if(utility::exec_policy(stream)->on(stream),
+                        make_tuple_begin(dense_indices, dense_distance2),
+                        make_tuple_end(dense_indices, dense_distance2),
+                        make_tuple_iterator(indices.begin() + n_prev,
+                                            distance2.begin() + n_prev),
+                        is_valid_neighbor_functor());
+    }
+    offsets.resize(n_query + 1);
+    thrust::exclusive_scan(utility::exec_policy(stream)->on(stream),
+                           counts.begin(), counts.end(), offsets.begin());
+    return indices.size();
+}
+
 template <typename T>
 bool KDTreeFlann::SetRawData(const utility::device_vector<T> &data) {
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::KDTree);
     dimension_ = T::SizeAtCompileTime;
     dataset_size_ = data.size();
     if (dimension_ == 0 || dataset_size_ == 0) {
@@ -177,7 +303,9 @@ bool KDTreeFlann::SetRawData(const utility::device_vector<T> &data) {
     }
     data_.resize(dataset_size_);
     convert_float4_functor func;
-    thrust::transform(data.begin(), data.end(), data_.begin(), func);
+    cudaStream_t stream = context_->GetStream();
+    thrust::transform(utility::exec_policy(stream)->on(stream), data.begin(),
+                      data.end(), data_.begin(), func);
     flann_dataset_.reset(new flann::Matrix<float>(
             (float *)thrust::raw_pointer_cast(data_.data()), dataset_size_,
             dimension_, sizeof(float) * 4));
@@ -288,5 +416,12 @@ template int KDTreeFlann::SearchHybrid<Eigen::Vector3f>(
         int max_nn,
         thrust::host_vector<int> &indices,
         thrust::host_vector<float> &distance2) const;
+template int KDTreeFlann::SearchRadiusCSR<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &offsets,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
 template bool KDTreeFlann::SetRawData<Eigen::Vector3f>(
         const utility::device_vector<Eigen::Vector3f> &data);
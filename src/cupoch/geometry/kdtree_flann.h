@@ -7,6 +7,8 @@
 
 #include "cupoch/geometry/kdtree_search_param.h"
 #include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/workspace.h"
 
 namespace flann {
 template <typename T>
@@ -26,6 +28,11 @@ class KDTreeFlann {
 public:
     KDTreeFlann();
     KDTreeFlann(const Geometry &geometry);
+    /// The data and query conversions of a tree created with \p ctx are
+    /// enqueued on the context stream. The FLANN search itself has no stream
+    /// argument and runs on the default stream.
+    explicit KDTreeFlann(utility::ExecutionContext &ctx);
+    KDTreeFlann(utility::ExecutionContext &ctx, const Geometry &geometry);
     ~KDTreeFlann();
     KDTreeFlann(const KDTreeFlann &) = delete;
     KDTreeFlann &operator=(const KDTreeFlann &) = delete;
@@ -33,6 +40,17 @@ public:
 public:
     bool SetGeometry(const Geometry &geometry);
 
+    void SetExecutionContext(utility::ExecutionContext &ctx) {
+        context_ = &ctx;
+    }
+    utility::ExecutionContext &GetExecutionContext() const {
+        return *context_;
+    }
+
+    /// Uses \p workspace for the query conversion buffers instead of
+    /// allocating them on every search. Pass nullptr to disable.
+    void SetWorkspace(utility::Workspace *workspace) { workspace_ = workspace; }
+
     template <typename T>
     int Search(const utility::device_vector<T> &query,
                const KDTreeSearchParam &param,
@@ -58,6 +76,19 @@ public:
                      utility::device_vector<int> &indices,
                      utility::device_vector<float> &distance2) const;
 
+    /// Radius search returning up to \p max_nn neighbors per query without
+    /// padding. The neighbors of query i are
+    /// indices[offsets[i]:offsets[i + 1]], sorted by distance. Queries are
+    /// processed in chunks so that the dense scratch buffer stays bounded.
+    /// Returns the total number of neighbors, or -1 on failure.
+    template <typename T>
+    int SearchRadiusCSR(const utility::device_vector<T> &query,
+                        float radius,
+                        int max_nn,
+                        utility::device_vector<int> &offsets,
+                        utility::device_vector<int> &indices,
+                        utility::device_vector<float> &distance2) const;
+
     template <typename T>
     int Search(const T &query,
                const KDTreeSearchParam &param,
@@ -92,6 +123,8 @@ protected:
     std::unique_ptr<flann::KDTreeCuda3dIndex<flann::L2<float>>> flann_index_;
     size_t dimension_ = 0;
     size_t dataset_size_ = 0;
+    utility::ExecutionContext *context_;
+    utility::Workspace *workspace_ = nullptr;
 };
 
 }  // namespace geometry
@@ -6,6 +6,12 @@ namespace geometry {
 static const int NUM_MAX_NN = 100;
 typedef Eigen::Matrix<int, NUM_MAX_NN, 1, Eigen::DontAlign> KNNIndices;
 
+/// Spatial index used by the neighbour searches of the point cloud filters.
+enum class SearchIndexType {
+    KDTreeFlann = 0,
+    VoxelHash = 1,
+};
+
 class KDTreeSearchParam {
 public:
     enum class SearchType {
@@ -0,0 +1,246 @@
+#include <thrust/copy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/transform_reduce.h>
+
+#include "cupoch/geometry/estimate_normals.h"
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/keypoint.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+const float kHarrisK = 0.04;
+
+struct nearest_distance_functor {
+    nearest_distance_functor(const float *distance2) : distance2_(distance2){};
+    const float *distance2_;
+    __device__ float operator()(size_t idx) const {
+        const float d2 = distance2_[idx * 2 + 1];
+        return isfinite(d2) ? sqrtf(d2) : 0.0f;
+    }
+};
+
+struct count_neighbors_functor {
+    count_neighbors_functor(const int *indices, int knn)
+        : indices_(indices), knn_(knn){};
+    const int *indices_;
+    const int knn_;
+    __device__ int operator()(size_t idx) const {
+        int count = 0;
+        for (int k = 0; k < knn_; ++k) {
+            if (indices_[idx * knn_ + k] >= 0) ++count;
+        }
+        return count;
+    }
+};
+
+struct iss_response_functor {
+    iss_response_functor(const Eigen::Vector3f *eigenvalues,
+                         const int *indices,
+                         int knn,
+                         int min_neighbors,
+                         float gamma_21,
+                         float gamma_32)
+        : eigenvalues_(eigenvalues),
+          count_(indices, knn),
+          min_neighbors_(min_neighbors),
+          gamma_21_(gamma_21),
+          gamma_32_(gamma_32){};
+    const Eigen::Vector3f *eigenvalues_;
+    const count_neighbors_functor count_;
+    const int min_neighbors_;
+    const float gamma_21_;
+    const float gamma_32_;
+    __device__ float operator()(size_t idx) const {
+        if (count_(idx) < min_neighbors_) return 0.0f;
+        // Ascending order, l3 = e(0).
+        const Eigen::Vector3f e = eigenvalues_[idx];
+        if (e(2) <= 0.0f || e(1) <= 0.0f) return 0.0f;
+        if (e(1) / e(2) >= gamma_21_ || e(0) / e(1) >= gamma_32_) return 0.0f;
+        return e(0);
+    }
+};
+
+struct harris_response_functor {
+    harris_response_functor(const Eigen::Vector3f *normals,
+                            const int *indices,
+                            int knn,
+                            int min_neighbors)
+        : normals_(normals),
+          indices_(indices),
+          knn_(knn),
+          min_neighbors_(min_neighbors){};
+    const Eigen::Vector3f *normals_;
+    const int *indices_;
+    const int knn_;
+    const int min_neighbors_;
+    __device__ float operator()(size_t idx) const {
+        Eigen::Matrix3f cov = Eigen::Matrix3f::Zero();
+        int count = 0;
+        for (int k = 0; k < knn_; ++k) {
+            const int j = indices_[idx * knn_ + k];
+            if (j < 0) continue;
+            const Eigen::Vector3f n = normals_[j];
+            cov += n * n.transpose();
+            ++count;
+        }
+        if (count < min_neighbors_) return -1.0f;
+        cov /= (float)count;
+        const float trace = cov.trace();
+        return cov.determinant() - kHarrisK * trace * trace;
+    }
+};
+
+// Ties are broken by the index, so that a plateau keeps a single point.
+struct is_local_max_functor {
+    is_local_max_functor(const float *response,
+                         const int *indices,
+                         int knn,
+                         float threshold)
+        : response_(response),
+          indices_(indices),
+          knn_(knn),
+          threshold_(threshold){};
+    const float *response_;
+    const int *indices_;
+    const int knn_;
+    const float threshold_;
+    __device__ bool operator()(size_t idx) const {
+        const float r = response_[idx];
+        if (!(r > threshold_)) return false;
+        for (int k = 0; k < knn_; ++k) {
+            const int j = indices_[idx * knn_ + k];
+            if (j < 0 || j == (int)idx) continue;
+            const float rj = response_[j];
+            if (rj > r || (rj == r && j < (int)idx)) return false;
+        }
+        return true;
+    }
+};
+
+float ComputeResolution(const PointCloud &input, const KDTreeFlann &kdtree) {
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    kdtree.SearchKNN(input.points_, 2, indices, distance2);
+    const float sum = thrust::transform_reduce(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(input.points_.size()),
+            nearest_distance_functor(thrust::raw_pointer_cast(distance2.data())),
+            0.0f, thrust::plus<float>());
+    return sum / input.points_.size();
+}
+
+utility::device_vector<size_t> SelectLocalMaxima(
+        const utility::device_vector<float> &response,
+        const utility::device_vector<int> &indices,
+        int knn,
+        float threshold) {
+    utility::device_vector<size_t> keypoints(response.size());
+    auto end = thrust::copy_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(response.size()),
+            keypoints.begin(),
+            is_local_max_functor(thrust::raw_pointer_cast(response.data()),
+                                 thrust::raw_pointer_cast(indices.data()), knn,
+                                 threshold));
+    keypoints.resize(thrust::distance(keypoints.begin(), end));
+    return keypoints;
+}
+
+}  // namespace
+
+utility::device_vector<size_t> cupoch::geometry::ComputeISSKeypointIndices(
+        const PointCloud &input,
+        float salient_radius /* = 0.0*/,
+        float non_max_radius /* = 0.0*/,
+        float gamma_21 /* = 0.975*/,
+        float gamma_32 /* = 0.975*/,
+        int min_neighbors /* = 5*/,
+        int max_nn /* = NUM_MAX_NN*/) {
+    CUPOCH_PROFILE("ComputeISSKeypoints");
+    if (!input.HasPoints()) return utility::device_vector<size_t>();
+    KDTreeFlann kdtree(input);
+    if (salient_radius <= 0.0 || non_max_radius <= 0.0) {
+        const float resolution = ComputeResolution(input, kdtree);
+        if (salient_radius <= 0.0) salient_radius = 6.0 * resolution;
+        if (non_max_radius <= 0.0) non_max_radius = 4.0 * resolution;
+    }
+    const size_t n_points = input.points_.size();
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    kdtree.SearchHybrid(input.points_, salient_radius, max_nn, indices,
+                        distance2);
+    utility::device_vector<Eigen::Vector3f> eigenvalues(n_points);
+    ComputeNeighborEigenvalues(0, thrust::raw_pointer_cast(input.points_.data()),
+                               thrust::raw_pointer_cast(indices.data()),
+                               max_nn, n_points,
+                               thrust::raw_pointer_cast(eigenvalues.data()));
+    utility::device_vector<float> response(n_points);
+    thrust::transform(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(n_points), response.begin(),
+            iss_response_functor(thrust::raw_pointer_cast(eigenvalues.data()),
+                                 thrust::raw_pointer_cast(indices.data()),
+                                 max_nn, min_neighbors, gamma_21, gamma_32));
+    if (non_max_radius != salient_radius) {
+        kdtree.SearchHybrid(input.points_, non_max_radius, max_nn, indices,
+                            distance2);
+    }
+    return SelectLocalMaxima(response, indices, max_nn, 0.0);
+}
+
+std::shared_ptr<PointCloud> cupoch::geometry::ComputeISSKeypoints(
+        const PointCloud &input,
+        float salient_radius /* = 0.0*/,
+        float non_max_radius /* = 0.0*/,
+        float gamma_21 /* = 0.975*/,
+        float gamma_32 /* = 0.975*/,
+        int min_neighbors /* = 5*/,
+        int max_nn /* = NUM_MAX_NN*/) {
+    return input.SelectByIndex(ComputeISSKeypointIndices(
+            input, salient_radius, non_max_radius, gamma_21, gamma_32,
+            min_neighbors, max_nn));
+}
+
+utility::device_vector<size_t> cupoch::geometry::ComputeHarris3DKeypointIndices(
+        const PointCloud &input,
+        float radius,
+        float threshold /* = 0.0*/,
+        int min_neighbors /* = 5*/,
+        int max_nn /* = NUM_MAX_NN*/) {
+    CUPOCH_PROFILE("ComputeHarris3DKeypoints");
+    if (!input.HasNormals()) {
+        utility::LogError(
+                "[ComputeHarris3DKeypoints] The point cloud has no normals.");
+        return utility::device_vector<size_t>();
+    }
+    const size_t n_points = input.points_.size();
+    KDTreeFlann kdtree(input);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    kdtree.SearchHybrid(input.points_, radius, max_nn, indices, distance2);
+    utility::device_vector<float> response(n_points);
+    thrust::transform(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(n_points), response.begin(),
+            harris_response_functor(
+                    thrust::raw_pointer_cast(input.normals_.data()),
+                    thrust::raw_pointer_cast(indices.data()), max_nn,
+                    min_neighbors));
+    return SelectLocalMaxima(response, indices, max_nn, threshold);
+}
+
+std::shared_ptr<PointCloud> cupoch::geometry::ComputeHarris3DKeypoints(
+        const PointCloud &input,
+        float radius,
+        float threshold /* = 0.0*/,
+        int min_neighbors /* = 5*/,
+        int max_nn /* = NUM_MAX_NN*/) {
+    return input.SelectByIndex(ComputeHarris3DKeypointIndices(
+            input, radius, threshold, min_neighbors, max_nn));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+
+/// Indices of the Intrinsic Shape Signature keypoints of \p input (Zhong,
+/// ICCV Workshops 2009). The eigenvalues l1 >= l2 >= l3 of the covariance
+/// of the neighbors within \p salient_radius come from the kernel of
+/// EstimateNormals(). The points with l2 / l1 < \p gamma_21, l3 / l2 <
+/// \p gamma_32 and at least \p min_neighbors neighbors are salient, and the
+/// keypoints are the salient points whose l3 is the largest within
+/// \p non_max_radius. The radii default to 6 and 4 times the mean distance
+/// of the points to their nearest neighbor. At most \p max_nn neighbors are
+/// used per point.
+utility::device_vector<size_t> ComputeISSKeypointIndices(
+        const PointCloud &input,
+        float salient_radius = 0.0,
+        float non_max_radius = 0.0,
+        float gamma_21 = 0.975,
+        float gamma_32 = 0.975,
+        int min_neighbors = 5,
+        int max_nn = NUM_MAX_NN);
+std::shared_ptr<PointCloud> ComputeISSKeypoints(const PointCloud &input,
+                                                float salient_radius = 0.0,
+                                                float non_max_radius = 0.0,
+                                                float gamma_21 = 0.975,
+                                                float gamma_32 = 0.975,
+                                                int min_neighbors = 5,
+                                                int max_nn = NUM_MAX_NN);
+
+/// Indices of the Harris 3D keypoints of \p input, which must have normals.
+/// The response of a point is det(C) - 0.04 trace(C)^2, C being the mean of
+/// n n^T over the normals n of its neighbors within \p radius, as in PCL.
+/// The keypoints are the points of at least \p min_neighbors neighbors
+/// whose response is above \p threshold and the largest of their
+/// neighbors.
+utility::device_vector<size_t> ComputeHarris3DKeypointIndices(
+        const PointCloud &input,
+        float radius,
+        float threshold = 0.0,
+        int min_neighbors = 5,
+        int max_nn = NUM_MAX_NN);
+std::shared_ptr<PointCloud> ComputeHarris3DKeypoints(const PointCloud &input,
+                                                     float radius,
+                                                     float threshold = 0.0,
+                                                     int min_neighbors = 5,
+                                                     int max_nn = NUM_MAX_NN);
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -46,6 +46,11 @@ thrust::host_vector<Eigen::Vector3f> LineSet::GetPoints() const {
     return points;
 }
 
+void LineSet::GetPoints(utility::pinned_host_vector<Eigen::Vector3f> &points,
+                        cudaStream_t stream) const {
+    utility::CopyToHostAsync(points_, points, stream);
+}
+
 void LineSet::SetLines(const thrust::host_vector<Eigen::Vector2i> &lines) {
     lines_ = lines;
 }
@@ -55,6 +60,11 @@ thrust::host_vector<Eigen::Vector2i> LineSet::GetLines() const {
     return lines;
 }
 
+void LineSet::GetLines(utility::pinned_host_vector<Eigen::Vector2i> &lines,
+                       cudaStream_t stream) const {
+    utility::CopyToHostAsync(lines_, lines, stream);
+}
+
 void LineSet::SetColors(const thrust::host_vector<Eigen::Vector3f> &colors) {
     colors_ = colors;
 }
@@ -64,6 +74,11 @@ thrust::host_vector<Eigen::Vector3f> LineSet::GetColors() const {
     return colors;
 }
 
+void LineSet::GetColors(utility::pinned_host_vector<Eigen::Vector3f> &colors,
+                        cudaStream_t stream) const {
+    utility::CopyToHostAsync(colors_, colors, stream);
+}
+
 LineSet &LineSet::Clear() {
     points_.clear();
     lines_.clear();
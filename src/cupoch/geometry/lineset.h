@@ -32,12 +32,20 @@ public:
 
     void SetPoints(const thrust::host_vector<Eigen::Vector3f> &points);
     thrust::host_vector<Eigen::Vector3f> GetPoints() const;
+    /// The pinned overloads of the getters enqueue the download on \p stream
+    /// and return at once; synchronize the stream before reading the data.
+    void GetPoints(utility::pinned_host_vector<Eigen::Vector3f> &points,
+                   cudaStream_t stream = 0) const;
 
     void SetLines(const thrust::host_vector<Eigen::Vector2i> &lines);
     thrust::host_vector<Eigen::Vector2i> GetLines() const;
+    void GetLines(utility::pinned_host_vector<Eigen::Vector2i> &lines,
+                  cudaStream_t stream = 0) const;
 
     void SetColors(const thrust::host_vector<Eigen::Vector3f> &colors);
     thrust::host_vector<Eigen::Vector3f> GetColors() const;
+    void GetColors(utility::pinned_host_vector<Eigen::Vector3f> &colors,
+                   cudaStream_t stream = 0) const;
 
 public:
     LineSet &Clear() override;
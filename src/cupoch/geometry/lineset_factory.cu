@@ -58,7 +58,7 @@ std::shared_ptr<LineSet> LineSet::CreateFromPointCloudCorrespondences(
                           return Eigen::Vector2i(corrs.first,
                                                  point0_size + corrs.second);
                       });
-    cudaSafeCall(cudaDeviceSynchronize());
+    utility::SynchronizeStreams(3);
     return lineset_ptr;
 }
 
@@ -85,7 +85,7 @@ std::shared_ptr<LineSet> LineSet::CreateFromTriangleMesh(
                               lineset_ptr->lines_.end());
     lineset_ptr->lines_.resize(
             thrust::distance(lineset_ptr->lines_.begin(), end));
-    cudaSafeCall(cudaDeviceSynchronize());
+    utility::SynchronizeStreams(2);
     return lineset_ptr;
 }
 
@@ -13,6 +13,12 @@ MeshBase::MeshBase(const MeshBase &other)
       vertex_normals_(other.vertex_normals_),
       vertex_colors_(other.vertex_colors_) {}
 
+MeshBase::MeshBase(MeshBase &&other)
+    : Geometry3D(Geometry::GeometryType::MeshBase),
+      vertices_(std::move(other.vertices_)),
+      vertex_normals_(std::move(other.vertex_normals_)),
+      vertex_colors_(std::move(other.vertex_colors_)) {}
+
 MeshBase &MeshBase::operator=(const MeshBase &other) {
     vertices_ = other.vertices_;
     vertex_normals_ = other.vertex_normals_;
@@ -20,34 +26,56 @@ MeshBase &MeshBase::operator=(const MeshBase &other) {
     return *this;
 }
 
+MeshBase &MeshBase::operator=(MeshBase &&other) {
+    vertices_ = std::move(other.vertices_);
+    vertex_normals_ = std::move(other.vertex_normals_);
+    vertex_colors_ = std::move(other.vertex_colors_);
+    return *this;
+}
+
 thrust::host_vector<Eigen::Vector3f> MeshBase::GetVertices() const {
-    thrust::host_vector<Eigen::Vector3f> vertices = vertices_;
-    return vertices;
+    return vertices_mirror_.Download(vertices_);
+}
+
+void MeshBase::GetVertices(
+        utility::pinned_host_vector<Eigen::Vector3f> &vertices,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(vertices_, vertices, stream);
 }
 
 void MeshBase::SetVertices(
         const thrust::host_vector<Eigen::Vector3f> &vertices) {
-    vertices_ = vertices;
+    vertices_mirror_.Upload(vertices, vertices_);
 }
 
 thrust::host_vector<Eigen::Vector3f> MeshBase::GetVertexNormals() const {
-    thrust::host_vector<Eigen::Vector3f> vertex_normals = vertex_normals_;
-    return vertex_normals;
+    return vertex_normals_mirror_.Download(vertex_normals_);
+}
+
+void MeshBase::GetVertexNormals(
+        utility::pinned_host_vector<Eigen::Vector3f> &vertex_normals,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(vertex_normals_, vertex_normals, stream);
 }
 
 void MeshBase::SetVertexNormals(
         const thrust::host_vector<Eigen::Vector3f> &vertex_normals) {
-    vertex_normals_ = vertex_normals;
+    vertex_normals_mirror_.Upload(vertex_normals, vertex_normals_);
 }
 
 thrust::host_vector<Eigen::Vector3f> MeshBase::GetVertexColors() const {
-    thrust::host_vector<Eigen::Vector3f> vertex_colors = vertex_colors_;
-    return vertex_colors;
+    return vertex_colors_mirror_.Download(vertex_colors_);
+}
+
+void MeshBase::GetVertexColors(
+        utility::pinned_host_vector<Eigen::Vector3f> &vertex_colors,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(vertex_colors_, vertex_colors, stream);
 }
 
 void MeshBase::SetVertexColors(
         const thrust::host_vector<Eigen::Vector3f> &vertex_colors) {
-    vertex_colors_ = vertex_colors;
+    vertex_colors_mirror_.Upload(vertex_colors, vertex_colors_);
 }
 
 MeshBase &MeshBase::Clear() {
@@ -76,7 +104,7 @@ AxisAlignedBoundingBox MeshBase::GetAxisAlignedBoundingBox() const {
 MeshBase &MeshBase::Transform(const Eigen::Matrix4f &transformation) {
     TransformPoints(utility::GetStream(0), transformation, vertices_);
     TransformNormals(utility::GetStream(1), transformation, vertex_normals_);
-    cudaDeviceSynchronize();
+    utility::SynchronizeStreams(2);
     return *this;
 }
 
@@ -94,7 +122,7 @@ MeshBase &MeshBase::Scale(const float scale, bool center) {
 MeshBase &MeshBase::Rotate(const Eigen::Matrix3f &R, bool center) {
     RotatePoints(utility::GetStream(0), R, vertices_, center);
     RotateNormals(utility::GetStream(0), R, vertex_normals_);
-    cudaDeviceSynchronize();
+    utility::SynchronizeStreams(1);
     return *this;
 }
 
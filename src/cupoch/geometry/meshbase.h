@@ -7,6 +7,7 @@
 #include "cupoch/geometry/geometry3d.h"
 #include "cupoch/utility/device_vector.h"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/host_mirror.h"
 
 namespace cupoch {
 namespace geometry {
@@ -36,16 +37,29 @@ public:
     MeshBase();
     virtual ~MeshBase();
     MeshBase(const MeshBase &other);
+    /// The moves hand the device buffers over without copying them.
+    MeshBase(MeshBase &&other);
     MeshBase &operator=(const MeshBase &other);
+    MeshBase &operator=(MeshBase &&other);
 
     thrust::host_vector<Eigen::Vector3f> GetVertices() const;
+    /// The pinned overloads of the getters enqueue the download on \p stream
+    /// and return at once; synchronize the stream before reading the data.
+    void GetVertices(utility::pinned_host_vector<Eigen::Vector3f> &vertices,
+                     cudaStream_t stream = 0) const;
     void SetVertices(const thrust::host_vector<Eigen::Vector3f> &vertices);
 
     thrust::host_vector<Eigen::Vector3f> GetVertexNormals() const;
+    void GetVertexNormals(
+            utility::pinned_host_vector<Eigen::Vector3f> &vertex_normals,
+            cudaStream_t stream = 0) const;
     void SetVertexNormals(
             const thrust::host_vector<Eigen::Vector3f> &vertex_normals);
 
     thrust::host_vector<Eigen::Vector3f> GetVertexColors() const;
+    void GetVertexColors(
+            utility::pinned_host_vector<Eigen::Vector3f> &vertex_colors,
+            cudaStream_t stream = 0) const;
     void SetVertexColors(
             const thrust::host_vector<Eigen::Vector3f> &vertex_colors);
 
@@ -104,6 +118,12 @@ public:
     utility::device_vector<Eigen::Vector3f> vertices_;
     utility::device_vector<Eigen::Vector3f> vertex_normals_;
     utility::device_vector<Eigen::Vector3f> vertex_colors_;
+
+private:
+    /// Host copies of the getters and setters, transferred only when stale.
+    mutable utility::HostMirror<Eigen::Vector3f> vertices_mirror_;
+    mutable utility::HostMirror<Eigen::Vector3f> vertex_normals_mirror_;
+    mutable utility::HostMirror<Eigen::Vector3f> vertex_colors_mirror_;
 };
 
 }  // namespace geometry
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+
+#include <Eigen/Core>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// 64-bit Morton (Z-order) code of a voxel index. The bits of the three axes
+/// are interleaved, 21 bits per axis, so voxels that are close in space are
+/// close in the code order, equal keys compare as a single integer and the
+/// codes sort with a radix sort.
+typedef unsigned long long MortonCode;
+
+constexpr int kMortonBitsPerAxis = 21;
+/// Signed voxel indices are stored with this offset, so EncodeMorton covers
+/// the indices in [-2^20, 2^20) on every axis.
+constexpr int kMortonKeyOffset = 1 << (kMortonBitsPerAxis - 1);
+
+__host__ __device__ inline MortonCode SpreadMortonBits(MortonCode x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+__host__ __device__ inline unsigned int CompactMortonBits(MortonCode x) {
+    x &= 0x1249249249249249ULL;
+    x = (x ^ (x >> 2)) & 0x10c30c30c30c30c3ULL;
+    x = (x ^ (x >> 4)) & 0x100f00f00f00f00fULL;
+    x = (x ^ (x >> 8)) & 0x1f0000ff0000ffULL;
+    x = (x ^ (x >> 16)) & 0x1f00000000ffffULL;
+    x = (x ^ (x >> 32)) & 0x1fffff;
+    return (unsigned int)x;
+}
+
+/// Interleaves three unsigned coordinates in [0, 2^21).
+__host__ __device__ inline MortonCode EncodeMorton(unsigned int x,
+                                                   unsigned int y,
+                                                   unsigned int z) {
+    return (SpreadMortonBits(x) << 2) | (SpreadMortonBits(y) << 1) |
+           SpreadMortonBits(z);
+}
+
+__host__ __device__ inline bool IsMortonEncodable(const Eigen::Vector3i &key) {
+    return key[0] >= -kMortonKeyOffset && key[0] < kMortonKeyOffset &&
+           key[1] >= -kMortonKeyOffset && key[1] < kMortonKeyOffset &&
+           key[2] >= -kMortonKeyOffset && key[2] < kMortonKeyOffset;
+}
+
+/// Morton code of a signed voxel index, see IsMortonEncodable for the range.
+__host__ __device__ inline MortonCode EncodeMorton(const Eigen::Vector3i &key) {
+    return EncodeMorton(key[0] + kMortonKeyOffset, key[1] + kMortonKeyOffset,
+                        key[2] + kMortonKeyOffset);
+}
+
+__host__ __device__ inline Eigen::Vector3i DecodeMorton(MortonCode code) {
+    return Eigen::Vector3i(int(CompactMortonBits(code >> 2)) - kMortonKeyOffset,
+                           int(CompactMortonBits(code >> 1)) - kMortonKeyOffset,
+                           int(CompactMortonBits(code)) - kMortonKeyOffset);
+}
+
+struct encode_morton_functor {
+    __device__ MortonCode operator()(const Eigen::Vector3i &key) const {
+        return EncodeMorton(key);
+    }
+};
+
+struct decode_morton_functor {
+    __device__ Eigen::Vector3i operator()(MortonCode code) const {
+        return DecodeMorton(code);
+    }
+};
+
+/// Sorts the voxel indices in Morton order with a radix sort on their codes
+/// and applies the same permutation to the values.
+template <typename ValueIterator>
+void SortByMortonCode(utility::device_vector<Eigen::Vector3i> &keys,
+                      ValueIterator values) {
+    utility::device_vector<MortonCode> codes(keys.size());
+    thrust::transform(keys.begin(), keys.end(), codes.begin(),
+                      encode_morton_functor());
+    thrust::sort_by_key(
+            codes.begin(), codes.end(),
+            thrust::make_zip_iterator(thrust::make_tuple(keys.begin(), values)));
+}
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,336 @@
+#include <thrust/binary_search.h>
+#include <thrust/gather.h>
+#include <thrust/scatter.h>
+#include <thrust/sort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/multi_device.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/streaming.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/multi_device.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct extract_axis_functor {
+    extract_axis_functor(int axis) : axis_(axis){};
+    const int axis_;
+    __device__ float operator()(const Eigen::Vector3f &pt) const {
+        return pt[axis_];
+    }
+};
+
+struct in_slab_functor {
+    in_slab_functor(const Eigen::Vector3f *points, int axis, float lo, float hi)
+        : points_(points), axis_(axis), lo_(lo), hi_(hi){};
+    const Eigen::Vector3f *points_;
+    const int axis_;
+    const float lo_;
+    const float hi_;
+    __device__ bool operator()(size_t idx) const {
+        const float x = points_[idx][axis_];
+        return x >= lo_ && x < hi_;
+    }
+};
+
+/// Indices of the points of one slab followed by the ones of its halo.
+struct Slab {
+    utility::device_vector<size_t> indices_;
+    size_t n_inner_ = 0;
+};
+
+std::vector<Slab> PartitionPointCloud(const PointCloud &input,
+                                      size_t n_slabs,
+                                      float halo_width,
+                                      float grid_size = 0.0f,
+                                      float grid_origin = 0.0f) {
+    const size_t n = input.points_.size();
+    const Eigen::Vector3f extent =
+            input.GetAxisAlignedBoundingBox().GetExtent();
+    int axis;
+    extent.maxCoeff(&axis);
+
+    // The borders are the quantiles of the coordinates on the longest axis,
+    // so that every slab gets the same number of points.
+    utility::device_vector<float> coords(n);
+    thrust::transform(input.points_.begin(), input.points_.end(),
+                      coords.begin(), extract_axis_functor(axis));
+    thrust::sort(coords.begin(), coords.end());
+    std::vector<float> bounds(n_slabs + 1);
+    bounds.front() = -std::numeric_limits<float>::infinity();
+    bounds.back() = std::numeric_limits<float>::infinity();
+    for (size_t i = 1; i < n_slabs; ++i) {
+        float bound = coords[i * n / n_slabs];
+        if (grid_size > 0) {
+            bound = grid_origin +
+                    std::floor((bound - grid_origin) / grid_size) * grid_size;
+        }
+        bounds[i] = std::max(bound, bounds[i - 1]);
+    }
+
+    const Eigen::Vector3f *points =
+            thrust::raw_pointer_cast(input.points_.data());
+    std::vector<Slab> slabs(n_slabs);
+    for (size_t i = 0; i < n_slabs; ++i) {
+        const float lo = bounds[i];
+        const float hi = bounds[i + 1];
+        Slab &slab = slabs[i];
+        slab.indices_.resize(n);
+        auto begin = slab.indices_.begin();
+        auto end = thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
+                                   thrust::make_counting_iterator(n), begin,
+                                   in_slab_functor(points, axis, lo, hi));
+        slab.n_inner_ = thrust::distance(begin, end);
+        if (halo_width > 0) {
+            end = thrust::copy_if(
+                    thrust::make_counting_iterator<size_t>(0),
+                    thrust::make_counting_iterator(n), end,
+                    in_slab_functor(points, axis, lo - halo_width, lo));
+            end = thrust::copy_if(
+                    thrust::make_counting_iterator<size_t>(0),
+                    thrust::make_counting_iterator(n), end,
+                    in_slab_functor(points, axis, hi, hi + halo_width));
+        }
+        slab.indices_.resize(thrust::distance(begin, end));
+    }
+    return slabs;
+}
+
+std::shared_ptr<PointCloud> SelectRange(
+        const PointCloud &input,
+        const utility::device_vector<size_t> &indices,
+        size_t begin,
+        size_t end) {
+    return input.SelectByIndex(utility::device_vector<size_t>(
+            indices.begin() + begin, indices.begin() + end));
+}
+
+void CopyFromDevice(const PointCloud &src, int src_device, PointCloud &dst) {
+    utility::CopyFromDevice(src.points_, src_device, dst.points_);
+    utility::CopyFromDevice(src.normals_, src_device, dst.normals_);
+    utility::CopyFromDevice(src.colors_, src_device, dst.colors_);
+    utility::CopyFromDevice(src.attributes_, src_device, dst.attributes_);
+    dst.attribute_names_ = src.attribute_names_;
+}
+
+void CopyToDevice(const PointCloud &src, int dst_device, PointCloud &dst) {
+    utility::CopyToDevice(src.points_, dst_device, dst.points_);
+    utility::CopyToDevice(src.normals_, dst_device, dst.normals_);
+    utility::CopyToDevice(src.colors_, dst_device, dst.colors_);
+    utility::CopyToDevice(src.attributes_, dst_device, dst.attributes_);
+    dst.attribute_names_ = src.attribute_names_;
+}
+
+/// Global indices, in ascending order, of the inliers of all the slabs.
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+SelectInliers(const PointCloud &input,
+              const std::vector<Slab> &slabs,
+              const std::vector<utility::device_vector<size_t>> &inliers) {
+    size_t n_inliers = 0;
+    for (const auto &slab_inliers : inliers) n_inliers += slab_inliers.size();
+    utility::device_vector<size_t> indices(n_inliers);
+    size_t offset = 0;
+    for (size_t i = 0; i < slabs.size(); ++i) {
+        thrust::gather(inliers[i].begin(), inliers[i].end(),
+                       slabs[i].indices_.begin(), indices.begin() + offset);
+        offset += inliers[i].size();
+    }
+    thrust::sort(indices.begin(), indices.end());
+    return std::make_tuple(input.SelectByIndex(indices), indices);
+}
+
+}  // namespace
+
+MultiDevicePointCloudProcessor::MultiDevicePointCloudProcessor(
+        const std::vector<int> &devices)
+    : devices_(utility::ResolveDevices(devices)) {
+    utility::EnablePeerAccess(devices_);
+}
+
+MultiDevicePointCloudProcessor::~MultiDevicePointCloudProcessor() {}
+
+std::shared_ptr<PointCloud> MultiDevicePointCloudProcessor::VoxelDownSample(
+        const PointCloud &input, float voxel_size) const {
+    auto output = std::make_shared<PointCloud>();
+    if (voxel_size <= 0.0) {
+        utility::LogWarning("[VoxelDownSample] voxel_size <= 0.\n");
+        return output;
+    }
+    if (!input.HasPoints()) return output;
+
+    // The grid of PointCloud::VoxelDownSample.
+    const AxisAlignedBoundingBox box = input.GetAxisAlignedBoundingBox();
+    const Eigen::Vector3f origin =
+            box.min_bound_ - Eigen::Vector3f::Constant(voxel_size * 0.5);
+    const Eigen::Vector3f extent = box.GetExtent();
+    int axis;
+    extent.maxCoeff(&axis);
+    const std::vector<Slab> slabs = PartitionPointCloud(
+            input, devices_.size(), 0.0f, voxel_size, origin[axis]);
+    std::vector<std::shared_ptr<PointCloud>> inputs;
+    for (const auto &slab : slabs) {
+        inputs.push_back(SelectRange(input, slab.indices_, 0, slab.n_inner_));
+    }
+
+    const int primary = utility::GetDevice();
+    std::vector<PointCloud> outputs(devices_.size());
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        PointCloud slab;
+        CopyFromDevice(*inputs[i], primary, slab);
+        StreamingVoxelDownSampler sampler(voxel_size, origin);
+        sampler.AddChunk(slab);
+        CopyToDevice(*sampler.GetPointCloud(), primary, outputs[i]);
+    });
+    for (const auto &slab_output : outputs) *output += slab_output;
+    return output;
+}
+
+bool MultiDevicePointCloudProcessor::EstimateNormals(
+        PointCloud &pointcloud,
+        const KDTreeSearchParam &search_param,
+        float halo_width) const {
+    if (!pointcloud.HasPoints()) return false;
+    if (search_param.GetSearchType() ==
+        KDTreeSearchParam::SearchType::Radius) {
+        halo_width = std::max(
+                halo_width,
+                static_cast<const KDTreeSearchParamRadius &>(search_param)
+                        .radius_);
+    } else if (search_param.GetSearchType() ==
+               KDTreeSearchParam::SearchType::Hybrid) {
+        halo_width = std::max(
+                halo_width,
+                static_cast<const KDTreeSearchParamHybrid &>(search_param)
+                        .radius_);
+    }
+    if (halo_width <= 0) {
+        utility::LogWarning(
+                "[EstimateNormals] halo_width <= 0, the normals at the slab "
+                "borders only use the points of their slab.\n");
+    }
+    const std::vector<Slab> slabs =
+            PartitionPointCloud(pointcloud, devices_.size(), halo_width);
+    std::vector<std::shared_ptr<PointCloud>> inputs;
+    for (const auto &slab : slabs) {
+        inputs.push_back(SelectRange(pointcloud, slab.indices_, 0,
+                                     slab.indices_.size()));
+    }
+
+    const int primary = utility::GetDevice();
+    std::vector<utility::device_vector<Eigen::Vector3f>> normals(
+            devices_.size());
+    std::vector<int> success(devices_.size(), 1);
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        if (slabs[i].n_inner_ == 0) return;
+        PointCloud slab;
+        CopyFromDevice(*inputs[i], primary, slab);
+        success[i] = slab.EstimateNormals(search_param);
+        slab.normals_.resize(slabs[i].n_inner_);
+        utility::CopyToDevice(slab.normals_, primary, normals[i]);
+    });
+
+    if (!pointcloud.HasNormals()) {
+        pointcloud.normals_.resize(pointcloud.points_.size(),
+                                   Eigen::Vector3f::Zero());
+    }
+    for (size_t i = 0; i < slabs.size(); ++i) {
+        thrust::scatter(normals[i].begin(), normals[i].end(),
+                        slabs[i].indices_.begin(), pointcloud.normals_.begin());
+    }
+    return std::all_of(success.begin(), success.end(),
+                       [](int s) { return s != 0; });
+}
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+MultiDevicePointCloudProcessor::RemoveRadiusOutliers(
+        const PointCloud &input, size_t nb_points, float search_radius) const {
+    if (nb_points < 1 || search_radius <= 0) {
+        utility::LogError(
+                "[RemoveRadiusOutliers] Illegal input parameters,"
+                "number of points and radius must be positive");
+    }
+    if (!input.HasPoints()) {
+        return std::make_tuple(std::make_shared<PointCloud>(),
+                               utility::device_vector<size_t>());
+    }
+    const std::vector<Slab> slabs =
+            PartitionPointCloud(input, devices_.size(), search_radius);
+    std::vector<std::shared_ptr<PointCloud>> inputs;
+    for (const auto &slab : slabs) {
+        inputs.push_back(
+                SelectRange(input, slab.indices_, 0, slab.indices_.size()));
+    }
+
+    const int primary = utility::GetDevice();
+    std::vector<utility::device_vector<size_t>> inliers(devices_.size());
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        if (slabs[i].n_inner_ == 0) return;
+        PointCloud slab;
+        CopyFromDevice(*inputs[i], primary, slab);
+        utility::device_vector<size_t> indices = std::get<1>(
+                slab.RemoveRadiusOutliers(nb_points, search_radius));
+        // The indices are sorted and the halo points come last.
+        indices.resize(thrust::distance(
+                indices.begin(), thrust::lower_bound(indices.begin(),
+                                                     indices.end(),
+                                                     slabs[i].n_inner_)));
+        utility::CopyToDevice(indices, primary, inliers[i]);
+    });
+    return SelectInliers(input, slabs, inliers);
+}
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+MultiDevicePointCloudProcessor::RemoveStatisticalOutliers(
+        const PointCloud &input,
+        size_t nb_neighbors,
+        float std_ratio,
+        float halo_width) const {
+    std::vector<StreamingStatisticalOutlierRemoval> removals(
+            devices_.size(),
+            StreamingStatisticalOutlierRemoval(nb_neighbors, std_ratio));
+    if (!input.HasPoints()) {
+        return std::make_tuple(std::make_shared<PointCloud>(),
+                               utility::device_vector<size_t>());
+    }
+    const std::vector<Slab> slabs =
+            PartitionPointCloud(input, devices_.size(), halo_width);
+    std::vector<std::shared_ptr<PointCloud>> tiles;
+    std::vector<std::shared_ptr<PointCloud>> halos;
+    for (const auto &slab : slabs) {
+        tiles.push_back(SelectRange(input, slab.indices_, 0, slab.n_inner_));
+        halos.push_back(SelectRange(input, slab.indices_, slab.n_inner_,
+                                    slab.indices_.size()));
+    }
+
+    // Two passes as StreamingStatisticalOutlierRemoval, the slabs stay on
+    // their device in between.
+    const int primary = utility::GetDevice();
+    std::vector<std::unique_ptr<PointCloud>> local_tiles(devices_.size());
+    std::vector<std::unique_ptr<PointCloud>> local_halos(devices_.size());
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        local_tiles[i].reset(new PointCloud());
+        local_halos[i].reset(new PointCloud());
+        CopyFromDevice(*tiles[i], primary, *local_tiles[i]);
+        CopyFromDevice(*halos[i], primary, *local_halos[i]);
+        removals[i].AccumulateTile(*local_tiles[i], *local_halos[i]);
+    });
+    StreamingStatisticalOutlierRemoval removal(nb_neighbors, std_ratio);
+    for (const auto &slab_removal : removals) removal.Merge(slab_removal);
+
+    std::vector<utility::device_vector<size_t>> inliers(devices_.size());
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        // Released on their own device.
+        const std::unique_ptr<PointCloud> tile = std::move(local_tiles[i]);
+        const std::unique_ptr<PointCloud> halo = std::move(local_halos[i]);
+        utility::CopyToDevice(removal.FilterTile(*tile, *halo), primary,
+                              inliers[i]);
+    });
+    return SelectInliers(input, slabs, inliers);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+
+/// \class MultiDevicePointCloudProcessor
+///
+/// \brief Runs the point cloud filters on several devices, one slab of the
+/// cloud per device.
+///
+/// The cloud is cut along the longest axis of its bounding box into slabs
+/// holding the same number of points. Each slab is copied to its device
+/// together with its halo, the points of the neighboring slabs within the
+/// halo width of the slab borders, with peer to peer copies when the devices
+/// support them. The devices are driven by one host thread each and the
+/// results are merged back on the current device of the caller, which holds
+/// the input. The halo points are only used as neighbors, so the results at
+/// the slab borders are the ones of the whole cloud as long as the
+/// neighborhoods fit in the halo width.
+class MultiDevicePointCloudProcessor {
+public:
+    /// Uses the devices in \p devices, all the visible devices when empty.
+    /// A device may be listed several times to split its work in more
+    /// slabs.
+    explicit MultiDevicePointCloudProcessor(
+            const std::vector<int> &devices = std::vector<int>());
+    ~MultiDevicePointCloudProcessor();
+
+public:
+    const std::vector<int> &GetDevices() const { return devices_; }
+
+    /// Same as PointCloud::VoxelDownSample. The slab borders are snapped to
+    /// the voxel grid, so no voxel is split between two devices.
+    std::shared_ptr<PointCloud> VoxelDownSample(const PointCloud &input,
+                                                float voxel_size) const;
+    /// Same as PointCloud::EstimateNormals on \p pointcloud. For the KNN
+    /// searches \p halo_width must exceed the distance to the farthest
+    /// neighbor, for the radius searches the radius is used when larger.
+    bool EstimateNormals(
+            PointCloud &pointcloud,
+            const KDTreeSearchParam &search_param = KDTreeSearchParamKNN(),
+            float halo_width = 0.0f) const;
+    /// Same as PointCloud::RemoveRadiusOutliers, with a halo of
+    /// \p search_radius.
+    std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+    RemoveRadiusOutliers(const PointCloud &input,
+                         size_t nb_points,
+                         float search_radius) const;
+    /// Same as PointCloud::RemoveStatisticalOutliers. The statistics of the
+    /// mean neighbor distances are gathered over all the devices before the
+    /// inliers are selected.
+    std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+    RemoveStatisticalOutliers(const PointCloud &input,
+                              size_t nb_neighbors,
+                              float std_ratio,
+                              float halo_width) const;
+
+private:
+    std::vector<int> devices_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,119 @@
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/neighborhood_cache.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/voxel_hash_index.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct slice_neighbors_functor {
+    slice_neighbors_functor(const int *indices,
+                            const float *distance2,
+                            int src_knn,
+                            int knn)
+        : indices_(indices),
+          distance2_(distance2),
+          src_knn_(src_knn),
+          knn_(knn){};
+    const int *indices_;
+    const float *distance2_;
+    const int src_knn_;
+    const int knn_;
+    __device__ thrust::tuple<int, float> operator()(size_t idx) const {
+        const size_t src = (idx / knn_) * src_knn_ + idx % knn_;
+        return thrust::make_tuple(indices_[src], distance2_[src]);
+    }
+};
+
+}  // namespace
+
+NeighborhoodCache::NeighborhoodCache(const PointCloud &pointcloud,
+                                     SearchIndexType index_type)
+    : pointcloud_(pointcloud), index_type_(index_type) {}
+
+NeighborhoodCache::~NeighborhoodCache() {}
+
+void NeighborhoodCache::Clear() {
+    kdtree_.reset();
+    voxel_hash_.reset();
+    neighborhoods_.clear();
+}
+
+const NeighborhoodCache::Neighborhood &NeighborhoodCache::GetNeighborhood(
+        const KDTreeSearchParam &param) {
+    Key key;
+    switch (param.GetSearchType()) {
+        case KDTreeSearchParam::SearchType::Knn:
+            key = Key(int(param.GetSearchType()),
+                      ((const KDTreeSearchParamKNN &)param).knn_, 0.0);
+            break;
+        case KDTreeSearchParam::SearchType::Radius:
+            key = Key(int(param.GetSearchType()), 0,
+                      ((const KDTreeSearchParamRadius &)param).radius_);
+            break;
+        case KDTreeSearchParam::SearchType::Hybrid:
+            key = Key(int(param.GetSearchType()),
+                      ((const KDTreeSearchParamHybrid &)param).max_nn_,
+                      ((const KDTreeSearchParamHybrid &)param).radius_);
+            break;
+        default:
+            utility::LogError("Unknown search param type.");
+    }
+    auto itr = neighborhoods_.find(key);
+    if (itr != neighborhoods_.end()) return itr->second;
+
+    Neighborhood &neighborhood = neighborhoods_[key];
+    const size_t n_points = pointcloud_.points_.size();
+    if (n_points == 0) return neighborhood;
+    if (param.GetSearchType() == KDTreeSearchParam::SearchType::Knn) {
+        // The KNN results are sorted by distance, so the ones with more
+        // neighbors hold the answer in their first columns.
+        const int knn = std::get<1>(key);
+        auto larger = neighborhoods_.upper_bound(key);
+        if (larger != neighborhoods_.end() &&
+            std::get<0>(larger->first) == std::get<0>(key) &&
+            larger->second.knn_ >= knn) {
+            neighborhood.knn_ = knn;
+            neighborhood.indices_.resize(n_points * knn);
+            neighborhood.distance2_.resize(n_points * knn);
+            slice_neighbors_functor func(
+                    thrust::raw_pointer_cast(larger->second.indices_.data()),
+                    thrust::raw_pointer_cast(larger->second.distance2_.data()),
+                    larger->second.knn_, knn);
+            thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                              thrust::make_counting_iterator(n_points * knn),
+                              make_tuple_begin(neighborhood.indices_,
+                                               neighborhood.distance2_),
+                              func);
+            return neighborhood;
+        }
+    }
+
+    if (index_type_ == SearchIndexType::VoxelHash) {
+        // The hash cell size follows the search radius, so the index is
+        // rebuilt when the radius changes.
+        const float cell_size = std::get<2>(key);
+        if (!voxel_hash_ || voxel_hash_cell_size_ != cell_size) {
+            voxel_hash_.reset(new VoxelHashIndex(cell_size));
+            voxel_hash_->SetRawData(pointcloud_.points_);
+            voxel_hash_cell_size_ = cell_size;
+        }
+        voxel_hash_->Search(pointcloud_.points_, param, neighborhood.indices_,
+                            neighborhood.distance2_);
+    } else {
+        if (!kdtree_) {
+            kdtree_.reset(new KDTreeFlann());
+            kdtree_->SetRawData(pointcloud_.points_);
+        }
+        kdtree_->Search(pointcloud_.points_, param, neighborhood.indices_,
+                        neighborhood.distance2_);
+    }
+    num_searches_++;
+    neighborhood.knn_ =
+            (n_points > 0) ? neighborhood.indices_.size() / n_points : 0;
+    return neighborhood;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class KDTreeFlann;
+class PointCloud;
+class VoxelHashIndex;
+
+/// \class NeighborhoodCache
+///
+/// \brief Search index on one point cloud with the neighborhoods of all its
+/// points, kept per search parameters.
+///
+/// The stages of a pipeline on the same frame (RemoveStatisticalOutliers,
+/// EstimateNormals, ComputeFPFHFeature) take the cache instead of building
+/// their own index, so the index is built once and every neighborhood is
+/// searched once. A KNN request is also served from a cached KNN result
+/// with more neighbors. The cache refers to the point cloud given at
+/// construction, which must outlive it and keep its points unchanged.
+class NeighborhoodCache {
+public:
+    struct Neighborhood {
+        /// Number of neighbor slots per point, padded with -1.
+        int knn_ = 0;
+        utility::device_vector<int> indices_;
+        utility::device_vector<float> distance2_;
+    };
+
+public:
+    explicit NeighborhoodCache(
+            const PointCloud &pointcloud,
+            SearchIndexType index_type = SearchIndexType::KDTreeFlann);
+    ~NeighborhoodCache();
+    NeighborhoodCache(const NeighborhoodCache &) = delete;
+    NeighborhoodCache &operator=(const NeighborhoodCache &) = delete;
+
+public:
+    /// Neighborhoods of all the points for \p param, searched on first use.
+    const Neighborhood &GetNeighborhood(const KDTreeSearchParam &param);
+    const PointCloud &GetPointCloud() const { return pointcloud_; }
+    /// Number of searches run on the index so far.
+    size_t GetNumSearches() const { return num_searches_; }
+    /// Drops the index and the neighborhoods.
+    void Clear();
+
+private:
+    /// Search type, number of neighbors and radius.
+    typedef std::tuple<int, int, float> Key;
+
+    const PointCloud &pointcloud_;
+    SearchIndexType index_type_;
+    std::unique_ptr<KDTreeFlann> kdtree_;
+    std::unique_ptr<VoxelHashIndex> voxel_hash_;
+    float voxel_hash_cell_size_ = 0.0;
+    std::map<Key, Neighborhood> neighborhoods_;
+    size_t num_searches_ = 0;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
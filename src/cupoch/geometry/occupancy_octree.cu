@@ -0,0 +1,646 @@
+#include "cupoch/geometry/geometry_functor.h"
+#include "cupoch/geometry/occupancy_octree.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/eigen.h"
+#include "cupoch/utility/helper.h"
+
+namespace cupoch {
+namespace geometry {
+
+namespace {
+
+// Code of the leaves that no Morton code reaches, to drop the misses.
+constexpr MortonCode kInvalidCode = ~0ULL;
+
+/// Number of leaves of a node of height \p height.
+__host__ __device__ MortonCode NodeSpan(int height) {
+    return 1ULL << (3 * height);
+}
+
+__device__ Eigen::Vector3i LeafKey(const Eigen::Vector3f &point,
+                                   float resolution) {
+    return Eigen::device_vectorize<float, 3, ::floor>(point / resolution)
+            .cast<int>();
+}
+
+// First index in [0, n) with codes[i] >= code.
+__device__ int LowerBound(const MortonCode *codes, int n, MortonCode code) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (codes[mid] < code) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Node that contains the leaf \p code, -1 if it is unknown.
+__device__ int FindNode(const MortonCode *codes,
+                        const uint8_t *heights,
+                        int n,
+                        MortonCode code) {
+    const int i = LowerBound(codes, n, code + 1) - 1;
+    if (i < 0) return -1;
+    return (code - codes[i] < NodeSpan(heights[i])) ? i : -1;
+}
+
+__device__ float UpdateLogOdds(float p,
+                               float delta,
+                               float thres_min,
+                               float thres_max) {
+    return min(max(p + delta, thres_min), thres_max);
+}
+
+struct compute_hit_update_functor {
+    compute_hit_update_functor(float resolution) : resolution_(resolution){};
+    const float resolution_;
+    __device__ thrust::tuple<MortonCode, uint8_t> operator()(
+            const thrust::tuple<Eigen::Vector3f, bool> &x) const {
+        const Eigen::Vector3i key = LeafKey(thrust::get<0>(x), resolution_);
+        if (!thrust::get<1>(x) || !IsMortonEncodable(key)) {
+            return thrust::make_tuple(kInvalidCode, uint8_t(0));
+        }
+        return thrust::make_tuple(EncodeMorton(key), uint8_t(1));
+    }
+};
+
+// Leaves crossed by the ray from the viewpoint to every point, counted
+// first and then written at the offsets of the rays.
+struct count_ray_leaves_functor {
+    count_ray_leaves_functor(const Eigen::Vector3f &viewpoint,
+                             float resolution)
+        : start_(viewpoint / resolution), resolution_(resolution){};
+    const Eigen::Vector3f start_;
+    const float resolution_;
+    __device__ int operator()(const Eigen::Vector3f &point) const {
+        int n = 0;
+        auto visit = [&](const Eigen::Vector3i &key) {
+            if (IsMortonEncodable(key)) ++n;
+        };
+        WalkGridCells(start_, Eigen::Vector3f(point / resolution_), visit);
+        return n;
+    }
+};
+
+struct fill_ray_leaves_functor {
+    fill_ray_leaves_functor(const Eigen::Vector3f &viewpoint,
+                            float resolution,
+                            MortonCode *codes)
+        : start_(viewpoint / resolution),
+          resolution_(resolution),
+          codes_(codes){};
+    const Eigen::Vector3f start_;
+    const float resolution_;
+    MortonCode *codes_;
+    __device__ void operator()(const thrust::tuple<Eigen::Vector3f, int> &x) {
+        int n = thrust::get<1>(x);
+        auto visit = [&](const Eigen::Vector3i &key) {
+            if (IsMortonEncodable(key)) codes_[n++] = EncodeMorton(key);
+        };
+        WalkGridCells(start_, Eigen::Vector3f(thrust::get<0>(x) / resolution_),
+                      visit);
+    }
+};
+
+// 8 if the pruned node has to be split for the updates, 1 otherwise.
+struct count_split_functor {
+    count_split_functor(const MortonCode *node_codes,
+                        const uint8_t *node_heights,
+                        const MortonCode *update_codes,
+                        int n_updates)
+        : node_codes_(node_codes),
+          node_heights_(node_heights),
+          update_codes_(update_codes),
+          n_updates_(n_updates){};
+    const MortonCode *node_codes_;
+    const uint8_t *node_heights_;
+    const MortonCode *update_codes_;
+    const int n_updates_;
+    __device__ int operator()(size_t idx) const {
+        const int h = node_heights_[idx];
+        if (h == 0) return 1;
+        const MortonCode code = node_codes_[idx];
+        const int j = LowerBound(update_codes_, n_updates_, code);
+        return (j < n_updates_ && update_codes_[j] - code < NodeSpan(h)) ? 8
+                                                                         : 1;
+    }
+};
+
+struct split_nodes_functor {
+    split_nodes_functor(const MortonCode *node_codes,
+                        const uint8_t *node_heights,
+                        const float *node_values,
+                        const int *counts,
+                        const int *offsets,
+                        MortonCode *out_codes,
+                        uint8_t *out_heights,
+                        float *out_values)
+        : node_codes_(node_codes),
+          node_heights_(node_heights),
+          node_values_(node_values),
+          counts_(counts),
+          offsets_(offsets),
+          out_codes_(out_codes),
+          out_heights_(out_heights),
+          out_values_(out_values){};
+    const MortonCode *node_codes_;
+    const uint8_t *node_heights_;
+    const float *node_values_;
+    const int *counts_;
+    const int *offsets_;
+    MortonCode *out_codes_;
+    uint8_t *out_heights_;
+    float *out_values_;
+    __device__ void operator()(size_t idx) {
+        const int offset = offsets_[idx];
+        if (counts_[idx] == 1) {
+            out_codes_[offset] = node_codes_[idx];
+            out_heights_[offset] = node_heights_[idx];
+            out_values_[offset] = node_values_[idx];
+            return;
+        }
+        const int h = node_heights_[idx] - 1;
+        for (int k = 0; k < 8; ++k) {
+            out_codes_[offset + k] = node_codes_[idx] + k * NodeSpan(h);
+            out_heights_[offset + k] = h;
+            out_values_[offset + k] = node_values_[idx];
+        }
+    }
+};
+
+// Applies the update of a leaf to its node, or returns true if the leaf is
+// new. The updates are unique, so no two of them write the same node.
+struct apply_updates_functor {
+    apply_updates_functor(const MortonCode *node_codes,
+                          const uint8_t *node_heights,
+                          float *node_values,
+                          int n_nodes,
+                          float clamping_thres_min,
+                          float clamping_thres_max,
+                          float prob_hit_log,
+                          float prob_miss_log)
+        : node_codes_(node_codes),
+          node_heights_(node_heights),
+          node_values_(node_values),
+          n_nodes_(n_nodes),
+          clamping_thres_min_(clamping_thres_min),
+          clamping_thres_max_(clamping_thres_max),
+          prob_hit_log_(prob_hit_log),
+          prob_miss_log_(prob_miss_log){};
+    const MortonCode *node_codes_;
+    const uint8_t *node_heights_;
+    float *node_values_;
+    const int n_nodes_;
+    const float clamping_thres_min_;
+    const float clamping_thres_max_;
+    const float prob_hit_log_;
+    const float prob_miss_log_;
+    __device__ float Update(float p, uint8_t hit) const {
+        return UpdateLogOdds(p, (hit) ? prob_hit_log_ : prob_miss_log_,
+                             clamping_thres_min_, clamping_thres_max_);
+    }
+    __device__ thrust::tuple<bool, float> operator()(
+            const thrust::tuple<MortonCode, uint8_t> &x) {
+        const int idx = FindNode(node_codes_, node_heights_, n_nodes_,
+                                 thrust::get<0>(x));
+        if (idx < 0) return thrust::make_tuple(true, Update(0, thrust::get<1>(x)));
+        node_values_[idx] = Update(node_values_[idx], thrust::get<1>(x));
+        return thrust::make_tuple(false, 0.0f);
+    }
+};
+
+// True for the first of 8 siblings of height height_ with the same value.
+struct is_prunable_functor {
+    is_prunable_functor(const MortonCode *node_codes,
+                        const uint8_t *node_heights,
+                        const float *node_values,
+                        int n_nodes,
+                        int height)
+        : node_codes_(node_codes),
+          node_heights_(node_heights),
+          node_values_(node_values),
+          n_nodes_(n_nodes),
+          height_(height){};
+    const MortonCode *node_codes_;
+    const uint8_t *node_heights_;
+    const float *node_values_;
+    const int n_nodes_;
+    const int height_;
+    __device__ bool operator()(size_t idx) const {
+        const MortonCode code = node_codes_[idx];
+        if (node_heights_[idx] != height_ || idx + 7 >= n_nodes_ ||
+            code % NodeSpan(height_ + 1) != 0) {
+            return false;
+        }
+        for (int k = 1; k < 8; ++k) {
+            if (node_heights_[idx + k] != height_ ||
+                node_codes_[idx + k] != code + k * NodeSpan(height_) ||
+                node_values_[idx + k] != node_values_[idx]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct prune_siblings_functor {
+    prune_siblings_functor(const uint8_t *prunable,
+                           uint8_t *node_heights,
+                           uint8_t *removed)
+        : prunable_(prunable), node_heights_(node_heights), removed_(removed){};
+    const uint8_t *prunable_;
+    uint8_t *node_heights_;
+    uint8_t *removed_;
+    __device__ void operator()(size_t idx) {
+        if (!prunable_[idx]) return;
+        node_heights_[idx] += 1;
+        for (int k = 1; k < 8; ++k) removed_[idx + k] = 1;
+    }
+};
+
+// Number of cells of height height_ in the occupied nodes.
+struct count_occupied_cells_functor {
+    count_occupied_cells_functor(const uint8_t *node_heights,
+                                 const float *node_values,
+                                 float occ_prob_thres_log,
+                                 int height)
+        : node_heights_(node_heights),
+          node_values_(node_values),
+          occ_prob_thres_log_(occ_prob_thres_log),
+          height_(height){};
+    const uint8_t *node_heights_;
+    const float *node_values_;
+    const float occ_prob_thres_log_;
+    const int height_;
+    __device__ int operator()(size_t idx) const {
+        if (node_values_[idx] <= occ_prob_thres_log_) return 0;
+        const int h = node_heights_[idx];
+        return (h <= height_) ? 1 : (int)NodeSpan(h - height_);
+    }
+};
+
+struct fill_occupied_cells_functor {
+    fill_occupied_cells_functor(const MortonCode *node_codes,
+                                const int *counts,
+                                const int *offsets,
+                                int height,
+                                Voxel *voxels)
+        : node_codes_(node_codes),
+          counts_(counts),
+          offsets_(offsets),
+          height_(height),
+          voxels_(voxels){};
+    const MortonCode *node_codes_;
+    const int *counts_;
+    const int *offsets_;
+    const int height_;
+    Voxel *voxels_;
+    __device__ void operator()(size_t idx) {
+        const int n = counts_[idx];
+        if (n == 0) return;
+        // The cells of height_ of the unsigned keys, shifted back.
+        const Eigen::Vector3i key = DecodeMorton(node_codes_[idx]);
+        Eigen::Vector3i first;
+        for (int i = 0; i < 3; ++i) {
+            first[i] = ((key[i] + kMortonKeyOffset) >> height_) -
+                       (kMortonKeyOffset >> height_);
+        }
+        for (int k = 0; k < n; ++k) {
+            const Eigen::Vector3i local(CompactMortonBits(k >> 2),
+                                        CompactMortonBits(k >> 1),
+                                        CompactMortonBits(k));
+            voxels_[offsets_[idx] + k] = Voxel(first + local);
+        }
+    }
+};
+
+}  // namespace
+
+OccupancyOctree::OccupancyOctree(float resolution /* = 0.05*/,
+                                 int max_height /* = 16*/)
+    : resolution_(resolution), max_height_(max_height) {
+    if (max_height_ < 0 || max_height_ >= kMortonBitsPerAxis) {
+        utility::LogWarning(
+                "[OccupancyOctree] max_height {:d} is out of [0, {:d}), "
+                "clamped.",
+                max_height_, kMortonBitsPerAxis);
+        max_height_ = std::min(std::max(max_height_, 0), kMortonBitsPerAxis - 1);
+    }
+}
+
+OccupancyOctree::~OccupancyOctree() {}
+
+OccupancyOctree::OccupancyOctree(const OccupancyOctree &other)
+    : resolution_(other.resolution_),
+      max_height_(other.max_height_),
+      clamping_thres_min_(other.clamping_thres_min_),
+      clamping_thres_max_(other.clamping_thres_max_),
+      prob_hit_log_(other.prob_hit_log_),
+      prob_miss_log_(other.prob_miss_log_),
+      occ_prob_thres_log_(other.occ_prob_thres_log_),
+      auto_prune_(other.auto_prune_),
+      node_codes_(other.node_codes_),
+      node_heights_(other.node_heights_),
+      node_values_(other.node_values_) {}
+
+OccupancyOctree &OccupancyOctree::Clear() {
+    node_codes_.clear();
+    node_heights_.clear();
+    node_values_.clear();
+    return *this;
+}
+
+bool OccupancyOctree::IsOccupied(const Eigen::Vector3f &point,
+                                 int height) const {
+    const auto res = GetProbLog(point, height);
+    return thrust::get<0>(res) && thrust::get<1>(res) > occ_prob_thres_log_;
+}
+
+bool OccupancyOctree::IsUnknown(const Eigen::Vector3f &point,
+                                int height) const {
+    return !thrust::get<0>(GetProbLog(point, height));
+}
+
+thrust::tuple<bool, float> OccupancyOctree::GetProbLog(
+        const Eigen::Vector3f &point, int height) const {
+    if (height < 0 || height > max_height_) {
+        utility::LogWarning(
+                "[OccupancyOctree::GetProbLog] height {:d} is out of [0, "
+                "{:d}].",
+                height, max_height_);
+        return thrust::make_tuple(false, 0.0f);
+    }
+    const Eigen::Vector3i key =
+            (Eigen::floor((point / resolution_).array())).matrix().cast<int>();
+    if (!IsMortonEncodable(key) || node_codes_.empty()) {
+        return thrust::make_tuple(false, 0.0f);
+    }
+    const MortonCode span = NodeSpan(height);
+    const MortonCode base = EncodeMorton(key) & ~(span - 1);
+    // The node before the cell may be coarser and contain it.
+    size_t i0 = thrust::distance(node_codes_.begin(),
+                                 thrust::lower_bound(node_codes_.begin(),
+                                                     node_codes_.end(), base));
+    if (i0 > 0) {
+        const MortonCode code = node_codes_[i0 - 1];
+        const int h = node_heights_[i0 - 1];
+        if (base - code < NodeSpan(h)) --i0;
+    }
+    const size_t i1 = thrust::distance(
+            node_codes_.begin(), thrust::lower_bound(node_codes_.begin(),
+                                                     node_codes_.end(),
+                                                     base + span));
+    if (i0 >= i1) return thrust::make_tuple(false, 0.0f);
+    const float value = thrust::reduce(
+            node_values_.begin() + i0, node_values_.begin() + i1,
+            -std::numeric_limits<float>::infinity(), thrust::maximum<float>());
+    return thrust::make_tuple(true, value);
+}
+
+OccupancyOctree &OccupancyOctree::Insert(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const Eigen::Vector3f &viewpoint,
+        float max_range) {
+    if (points.empty()) return *this;
+
+    utility::device_vector<Eigen::Vector3f> ranged_points(points.size());
+    utility::device_vector<bool> hit_flags(points.size());
+    thrust::transform(points.begin(), points.end(),
+                      make_tuple_begin(ranged_points, hit_flags),
+                      [viewpoint, max_range] __device__ (const Eigen::Vector3f &pt) {
+                          Eigen::Vector3f pt_vp = pt - viewpoint;
+                          float dist = pt_vp.norm();
+                          bool is_hit = max_range < 0 || dist <= max_range;
+                          return thrust::make_tuple((is_hit) ? pt : viewpoint + pt_vp / dist * max_range,
+                                                    is_hit);
+                      });
+
+    // One update per leaf of the scan, the hits over the misses.
+    utility::device_vector<int> ray_offsets(points.size());
+    thrust::transform(ranged_points.begin(), ranged_points.end(),
+                      ray_offsets.begin(),
+                      count_ray_leaves_functor(viewpoint, resolution_));
+    const int n_ray_leaves =
+            thrust::reduce(ray_offsets.begin(), ray_offsets.end(), 0);
+    thrust::exclusive_scan(ray_offsets.begin(), ray_offsets.end(),
+                           ray_offsets.begin());
+    utility::device_vector<MortonCode> update_codes(n_ray_leaves +
+                                                    points.size());
+    utility::device_vector<uint8_t> update_hits(update_codes.size(), 0);
+    fill_ray_leaves_functor fill_func(
+            viewpoint, resolution_,
+            thrust::raw_pointer_cast(update_codes.data()));
+    thrust::for_each(make_tuple_begin(ranged_points, ray_offsets),
+                     make_tuple_end(ranged_points, ray_offsets), fill_func);
+    thrust::transform(make_tuple_begin(ranged_points, hit_flags),
+                      make_tuple_end(ranged_points, hit_flags),
+                      make_tuple_iterator(update_codes.begin() + n_ray_leaves,
+                                          update_hits.begin() + n_ray_leaves),
+                      compute_hit_update_functor(resolution_));
+    thrust::sort_by_key(update_codes.begin(), update_codes.end(),
+                        update_hits.begin());
+    auto end = thrust::reduce_by_key(
+            update_codes.begin(), update_codes.end(), update_hits.begin(),
+            update_codes.begin(), update_hits.begin(),
+            thrust::equal_to<MortonCode>(), thrust::maximum<uint8_t>());
+    size_t n_updates = thrust::distance(update_codes.begin(), end.first);
+    if (n_updates > 0 && update_codes[n_updates - 1] == kInvalidCode) {
+        --n_updates;
+    }
+    resize_all(n_updates, update_codes, update_hits);
+    if (n_updates == 0) return *this;
+
+    // Splits the pruned nodes down to the updated leaves.
+    for (int h = max_height_; h > 0; --h) {
+        const size_t n_nodes = node_codes_.size();
+        utility::device_vector<int> counts(n_nodes);
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(n_nodes),
+                          counts.begin(),
+                          count_split_functor(
+                                  thrust::raw_pointer_cast(node_codes_.data()),
+                                  thrust::raw_pointer_cast(node_heights_.data()),
+                                  thrust::raw_pointer_cast(update_codes.data()),
+                                  n_updates));
+        const int n_out = thrust::reduce(counts.begin(), counts.end(), 0);
+        if (n_out == n_nodes) break;
+        utility::device_vector<int> offsets(n_nodes);
+        thrust::exclusive_scan(counts.begin(), counts.end(), offsets.begin());
+        utility::device_vector<MortonCode> codes(n_out);
+        utility::device_vector<uint8_t> heights(n_out);
+        utility::device_vector<float> values(n_out);
+        split_nodes_functor split_func(
+                thrust::raw_pointer_cast(node_codes_.data()),
+                thrust::raw_pointer_cast(node_heights_.data()),
+                thrust::raw_pointer_cast(node_values_.data()),
+                thrust::raw_pointer_cast(counts.data()),
+                thrust::raw_pointer_cast(offsets.data()),
+                thrust::raw_pointer_cast(codes.data()),
+                thrust::raw_pointer_cast(heights.data()),
+                thrust::raw_pointer_cast(values.data()));
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_nodes), split_func);
+        node_codes_.swap(codes);
+        node_heights_.swap(heights);
+        node_values_.swap(values);
+    }
+
+    // Updates the known leaves and merges the new ones.
+    utility::device_vector<bool> is_new(n_updates);
+    utility::device_vector<float> new_values(n_updates);
+    apply_updates_functor apply_func(
+            thrust::raw_pointer_cast(node_codes_.data()),
+            thrust::raw_pointer_cast(node_heights_.data()),
+            thrust::raw_pointer_cast(node_values_.data()),
+            node_codes_.size(), clamping_thres_min_, clamping_thres_max_,
+            prob_hit_log_, prob_miss_log_);
+    thrust::transform(make_tuple_begin(update_codes, update_hits),
+                      make_tuple_end(update_codes, update_hits),
+                      make_tuple_begin(is_new, new_values), apply_func);
+    auto remove_fn = [] __device__ (const thrust::tuple<bool, MortonCode, float>& x) {
+        return !thrust::get<0>(x);
+    };
+    const size_t n_new = remove_if_vectors(remove_fn, is_new, update_codes, new_values);
+    if (n_new > 0) {
+        utility::device_vector<uint8_t> new_heights(n_new, 0);
+        const size_t n_total = node_codes_.size() + n_new;
+        utility::device_vector<MortonCode> codes(n_total);
+        utility::device_vector<uint8_t> heights(n_total);
+        utility::device_vector<float> values(n_total);
+        thrust::merge_by_key(node_codes_.begin(), node_codes_.end(),
+                             update_codes.begin(), update_codes.end(),
+                             make_tuple_begin(node_heights_, node_values_),
+                             make_tuple_begin(new_heights, new_values),
+                             codes.begin(), make_tuple_begin(heights, values));
+        node_codes_.swap(codes);
+        node_heights_.swap(heights);
+        node_values_.swap(values);
+    }
+    if (auto_prune_) Prune();
+    return *this;
+}
+
+OccupancyOctree &OccupancyOctree::Insert(
+        const thrust::host_vector<Eigen::Vector3f> &points,
+        const Eigen::Vector3f &viewpoint,
+        float max_range) {
+    utility::device_vector<Eigen::Vector3f> dev_points = points;
+    return Insert(dev_points, viewpoint, max_range);
+}
+
+OccupancyOctree &OccupancyOctree::Insert(const PointCloud &pointcloud,
+                                         const Eigen::Vector3f &viewpoint,
+                                         float max_range) {
+    return Insert(pointcloud.points_, viewpoint, max_range);
+}
+
+OccupancyOctree &OccupancyOctree::Prune() {
+    for (int h = 0; h < max_height_; ++h) {
+        const size_t n_nodes = node_codes_.size();
+        if (n_nodes < 8) break;
+        utility::device_vector<uint8_t> prunable(n_nodes);
+        is_prunable_functor prunable_func(
+                thrust::raw_pointer_cast(node_codes_.data()),
+                thrust::raw_pointer_cast(node_heights_.data()),
+                thrust::raw_pointer_cast(node_values_.data()), n_nodes, h);
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(n_nodes),
+                          prunable.begin(), prunable_func);
+        if (thrust::count(prunable.begin(), prunable.end(), 1) == 0) continue;
+        utility::device_vector<uint8_t> removed(n_nodes, 0);
+        prune_siblings_functor prune_func(
+                thrust::raw_pointer_cast(prunable.data()),
+                thrust::raw_pointer_cast(node_heights_.data()),
+                thrust::raw_pointer_cast(removed.data()));
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_nodes), prune_func);
+        auto remove_fn = [] __device__ (const thrust::tuple<uint8_t, MortonCode, uint8_t, float>& x) {
+            return thrust::get<0>(x) != 0;
+        };
+        remove_if_vectors(remove_fn, removed, node_codes_, node_heights_,
+                          node_values_);
+    }
+    return *this;
+}
+
+std::shared_ptr<VoxelGrid> OccupancyOctree::ExtractOccupiedVoxels(
+        int height) const {
+    auto voxel_grid = std::make_shared<VoxelGrid>();
+    if (height < 0 || height > max_height_) {
+        utility::LogWarning(
+                "[OccupancyOctree::ExtractOccupiedVoxels] height {:d} is out "
+                "of [0, {:d}].",
+                height, max_height_);
+        return voxel_grid;
+    }
+    voxel_grid->voxel_size_ = resolution_ * (1 << height);
+    voxel_grid->origin_ = Eigen::Vector3f::Zero();
+    const size_t n_nodes = node_codes_.size();
+    utility::device_vector<int> counts(n_nodes);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_nodes), counts.begin(),
+                      count_occupied_cells_functor(
+                              thrust::raw_pointer_cast(node_heights_.data()),
+                              thrust::raw_pointer_cast(node_values_.data()),
+                              occ_prob_thres_log_, height));
+    const int n_cells = thrust::reduce(counts.begin(), counts.end(), 0);
+    if (n_cells == 0) return voxel_grid;
+    utility::device_vector<int> offsets(n_nodes);
+    thrust::exclusive_scan(counts.begin(), counts.end(), offsets.begin());
+    utility::device_vector<Voxel> voxels(n_cells);
+    fill_occupied_cells_functor fill_func(
+            thrust::raw_pointer_cast(node_codes_.data()),
+            thrust::raw_pointer_cast(counts.data()),
+            thrust::raw_pointer_cast(offsets.data()), height,
+            thrust::raw_pointer_cast(voxels.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_nodes), fill_func);
+    voxel_grid->AddVoxels(voxels);
+    return voxel_grid;
+}
+
+std::shared_ptr<OccupancyOctree> OccupancyOctree::CreateFromOccupancyGrid(
+        const OccupancyGrid &grid, int max_height /* = 16*/) {
+    auto octree = std::make_shared<OccupancyOctree>(grid.voxel_size_,
+                                                    max_height);
+    octree->clamping_thres_min_ = grid.clamping_thres_min_;
+    octree->clamping_thres_max_ = grid.clamping_thres_max_;
+    octree->prob_hit_log_ = grid.prob_hit_log_;
+    octree->prob_miss_log_ = grid.prob_miss_log_;
+    octree->occ_prob_thres_log_ = grid.occ_prob_thres_log_;
+    auto voxels = grid.ExtractKnownVoxels();
+    octree->node_codes_.resize(voxels->size());
+    octree->node_heights_.resize(voxels->size(), 0);
+    octree->node_values_.resize(voxels->size());
+    const Eigen::Vector3f offset =
+            grid.origin_ -
+            Eigen::Vector3f::Constant((grid.resolution_ / 2 - 0.5) * grid.voxel_size_);
+    const float voxel_size = grid.voxel_size_;
+    thrust::transform(voxels->begin(), voxels->end(),
+                      make_tuple_begin(octree->node_codes_, octree->node_values_),
+                      [offset, voxel_size] __device__ (const OccupancyVoxel& v) {
+                          // The key of the voxel center.
+                          const Eigen::Vector3f center = v.grid_index_.cast<float>() * voxel_size + offset;
+                          const Eigen::Vector3i key = LeafKey(center, voxel_size);
+                          return thrust::make_tuple(IsMortonEncodable(key) ? EncodeMorton(key) : kInvalidCode,
+                                                    v.prob_log_);
+                      });
+    thrust::sort_by_key(octree->node_codes_.begin(), octree->node_codes_.end(),
+                        octree->node_values_.begin());
+    auto remove_fn = [] __device__ (const thrust::tuple<MortonCode, uint8_t, float>& x) {
+        return thrust::get<0>(x) == kInvalidCode;
+    };
+    remove_if_vectors(remove_fn, octree->node_codes_, octree->node_heights_,
+                      octree->node_values_);
+    octree->Prune();
+    return octree;
+}
+
+}  // namespace geometry
+}  // namespace cupoch
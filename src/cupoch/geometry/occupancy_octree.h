@@ -0,0 +1,95 @@
+#pragma once
+
+#include <thrust/host_vector.h>
+#include <thrust/tuple.h>
+
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class OccupancyGrid;
+class PointCloud;
+class VoxelGrid;
+
+/// \class OccupancyOctree
+///
+/// \brief Occupancy map as a linear octree, with the semantics of OctoMap.
+///
+/// The tree is kept as its leaves in Morton order. A node of height h covers
+/// 2^h leaf voxels of size resolution_ along each axis and is stored with
+/// the Morton code of its first leaf. Prune() merges the 8 children of a
+/// node into the node when they have the same log odds, and Insert() splits
+/// the pruned nodes again where a scan updates them. A node at height h
+/// seen from a query at height H >= h is the maximum of its leaves, as the
+/// inner nodes of OctoMap, so the coarse queries are conservative for
+/// collision checks. The sensor model parameters have the same names and
+/// defaults as those of OccupancyGrid.
+class OccupancyOctree {
+public:
+    OccupancyOctree(float resolution = 0.05, int max_height = 16);
+    ~OccupancyOctree();
+    OccupancyOctree(const OccupancyOctree &other);
+
+public:
+    OccupancyOctree &Clear();
+    bool IsEmpty() const { return node_codes_.empty(); }
+    /// Number of leaves of the tree, of any height.
+    size_t GetNumNodes() const { return node_codes_.size(); }
+
+    /// Whether the cell of height \p height around \p point has an
+    /// occupied leaf.
+    bool IsOccupied(const Eigen::Vector3f &point, int height = 0) const;
+    bool IsUnknown(const Eigen::Vector3f &point, int height = 0) const;
+    /// Whether the cell of height \p height around \p point is known, and
+    /// the maximum log odds of its leaves.
+    thrust::tuple<bool, float> GetProbLog(const Eigen::Vector3f &point,
+                                          int height = 0) const;
+
+    /// Same update as OccupancyGrid::Insert(): the leaf of every point gets
+    /// one hit, and the leaves crossed by the rays from \p viewpoint get one
+    /// miss per scan. Prunes the tree afterwards if auto_prune_ is set.
+    OccupancyOctree &Insert(
+            const utility::device_vector<Eigen::Vector3f> &points,
+            const Eigen::Vector3f &viewpoint,
+            float max_range = -1.0);
+    OccupancyOctree &Insert(const thrust::host_vector<Eigen::Vector3f> &points,
+                            const Eigen::Vector3f &viewpoint,
+                            float max_range = -1.0);
+    OccupancyOctree &Insert(const PointCloud &pointcloud,
+                            const Eigen::Vector3f &viewpoint,
+                            float max_range = -1.0);
+
+    /// Merges the siblings with the same log odds, bottom up to max_height_.
+    OccupancyOctree &Prune();
+
+    /// Occupied cells of height \p height, as a VoxelGrid of voxel size
+    /// resolution_ * 2^height.
+    std::shared_ptr<VoxelGrid> ExtractOccupiedVoxels(int height = 0) const;
+
+    /// Octree of the known voxels of \p grid, with its voxel size and its
+    /// sensor model parameters, pruned.
+    static std::shared_ptr<OccupancyOctree> CreateFromOccupancyGrid(
+            const OccupancyGrid &grid, int max_height = 16);
+
+public:
+    float resolution_;
+    int max_height_;
+    float clamping_thres_min_ = -2.0;
+    float clamping_thres_max_ = 3.5;
+    float prob_hit_log_ = 0.85;
+    float prob_miss_log_ = -0.4;
+    float occ_prob_thres_log_ = 0.0;
+    bool auto_prune_ = true;
+    /// Morton code of the first leaf voxel of every node, sorted.
+    utility::device_vector<MortonCode> node_codes_;
+    utility::device_vector<uint8_t> node_heights_;
+    utility::device_vector<float> node_values_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
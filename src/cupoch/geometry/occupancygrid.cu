@@ -1,199 +1,609 @@
 #include "cupoch/geometry/occupancygrid.h"
 #include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/geometry/densegrid.inl"
-#include "cupoch/geometry/intersection_test.h"
 #include "cupoch/geometry/boundingvolume.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/geometry_functor.h"
+#include "cupoch/geometry/graph.h"
 
 #include "cupoch/utility/eigen.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/memory_tracker.h"
 #include <thrust/iterator/discard_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/scan.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace cupoch {
 namespace geometry {
 
 namespace {
 
-__constant__ float voxel_offset[7][3] = {{0, 0, 0}, {1, 0, 0}, {-1, 0, 0},
-                                         {0, 1, 0}, {0, -1, 0}, {0, 0, 1},
-                                         {0, 0, -1}};
+// Storage index of a logical voxel, see OccupancyGrid::ring_offset_.
+__host__ __device__ int RingIndexOf(const Eigen::Vector3i &voxel,
+                                    const Eigen::Vector3i &offset,
+                                    int resolution) {
+    Eigen::Vector3i v = voxel + offset;
+    for (int i = 0; i < 3; ++i) {
+        if (v[i] >= resolution) v[i] -= resolution;
+    }
+    return OccupancyGrid::LayoutType::StorageIndexOf(v, resolution);
+}
+
+// Log odds parameters of the grid in units of
+// CompactOccupancyVoxel::kProbLogResolution, so that the updates add
+// integers and do not accumulate rounding errors.
+struct quantized_log_odds {
+    quantized_log_odds(const OccupancyGrid &grid)
+        : hit_(CompactOccupancyVoxel::Quantize(grid.prob_hit_log_)),
+          miss_(CompactOccupancyVoxel::Quantize(grid.prob_miss_log_)),
+          min_(CompactOccupancyVoxel::Quantize(grid.clamping_thres_min_)),
+          max_(CompactOccupancyVoxel::Quantize(grid.clamping_thres_max_)){};
+    int hit_;
+    int miss_;
+    int min_;
+    int max_;
+    __host__ __device__ int16_t Update(int16_t p, int delta) const {
+        int v = (p == CompactOccupancyVoxel::kUnknown) ? 0 : p;
+        v += delta;
+        return (int16_t)((v < min_) ? min_ : ((v > max_) ? max_ : v));
+    }
+};
+
+// State of a voxel for the change tracking: 0 unknown, 1 free, 2 occupied.
+__host__ __device__ int OccupancyStateOf(int16_t prob_log_q,
+                                         int16_t occ_prob_thres_log) {
+    if (prob_log_q == CompactOccupancyVoxel::kUnknown) return 0;
+    return (prob_log_q > occ_prob_thres_log) ? 2 : 1;
+}
+
+// Stamps the voxels whose state changes with the version of the update,
+// see OccupancyGrid::EnableChangeTracking(). Does nothing without tracking.
+struct change_recorder {
+    change_recorder(unsigned int *versions,
+                    unsigned int version,
+                    int16_t occ_prob_thres_log)
+        : versions_(versions),
+          version_(version),
+          occ_prob_thres_log_(occ_prob_thres_log){};
+    unsigned int *versions_;
+    const unsigned int version_;
+    const int16_t occ_prob_thres_log_;
+    __device__ void Record(int idx, int16_t before, int16_t after) const {
+        if (versions_ && OccupancyStateOf(before, occ_prob_thres_log_) !=
+                                 OccupancyStateOf(after, occ_prob_thres_log_)) {
+            versions_[idx] = version_;
+        }
+    }
+};
 
+// Decodes the voxels in the bounds, extents_ voxels from min_bound_.
 struct extract_range_voxels_functor {
-    extract_range_voxels_functor(const OccupancyVoxel* voxels,
+    extract_range_voxels_functor(const CompactOccupancyVoxel* voxels,
                                  const Eigen::Vector3i& extents,
                                  int resolution,
-                                 const Eigen::Vector3i& min_bound)
+                                 const Eigen::Vector3i& min_bound,
+                                 const Eigen::Vector3i& ring_offset)
                                  : voxels_(voxels), extents_(extents),
-                                 resolution_(resolution), min_bound_(min_bound) {};
-    const OccupancyVoxel* voxels_;
+                                 resolution_(resolution), min_bound_(min_bound),
+                                 ring_offset_(ring_offset) {};
+    const CompactOccupancyVoxel* voxels_;
     const Eigen::Vector3i extents_;
     const int resolution_;
     const Eigen::Vector3i min_bound_;
-    __device__ OccupancyVoxel operator() (size_t idx) const {
+    const Eigen::Vector3i ring_offset_;
+    __device__ Eigen::Vector3i GridIndex(size_t idx) const {
         int x = idx / (extents_[1] * extents_[2]);
         int yz = idx % (extents_[1] * extents_[2]);
         int y = yz / extents_[2];
         int z = yz % extents_[2];
-        Eigen::Vector3i gidx = min_bound_ + Eigen::Vector3i(x, y, z);
-        return voxels_[IndexOf(gidx, resolution_)];
+        return min_bound_ + Eigen::Vector3i(x, y, z);
+    }
+    __device__ CompactOccupancyVoxel StoredVoxel(size_t idx) const {
+        return voxels_[RingIndexOf(GridIndex(idx), ring_offset_, resolution_)];
+    }
+    __device__ OccupancyVoxel operator() (size_t idx) const {
+        const Eigen::Vector3i gidx = GridIndex(idx);
+        const CompactOccupancyVoxel& v = voxels_[RingIndexOf(gidx, ring_offset_, resolution_)];
+        return OccupancyVoxel(gidx, v.GetProbLog());
     }
 };
 
-struct compute_intersect_voxel_segment_functor{
-    compute_intersect_voxel_segment_functor(const Eigen::Vector3f* points,
-                                            const Eigen::Vector3f* steps,
-                                            const Eigen::Vector3f& viewpoint,
-                                            const Eigen::Vector3i& half_resolution,
-                                            float voxel_size,
-                                            const Eigen::Vector3f& origin,
-                                            int n_div)
-                                            : points_(points), steps_(steps), viewpoint_(viewpoint),
-                                             half_resolution_(half_resolution), voxel_size_(voxel_size),
-                                             box_half_size_(Eigen::Vector3f(
-                                                voxel_size / 2, voxel_size / 2, voxel_size / 2)),
-                                             origin_(origin), n_div_(n_div) {};
-    const Eigen::Vector3f* points_;
-    const Eigen::Vector3f* steps_;
-    const Eigen::Vector3f viewpoint_;
-    const Eigen::Vector3i half_resolution_;
-    const float voxel_size_;
-    const Eigen::Vector3f box_half_size_;
+// Selects the known voxels of the bounds on their quantized log odds,
+// before any of them is decoded.
+struct select_range_voxels_functor {
+    select_range_voxels_functor(const extract_range_voxels_functor& range,
+                                int16_t occ_prob_thres_log,
+                                bool free, bool occupied)
+                                : range_(range), occ_prob_thres_log_(occ_prob_thres_log),
+                                free_(free), occupied_(occupied) {};
+    const extract_range_voxels_functor range_;
+    const int16_t occ_prob_thres_log_;
+    const bool free_;
+    const bool occupied_;
+    __device__ bool operator() (size_t idx) const {
+        const CompactOccupancyVoxel v = range_.StoredVoxel(idx);
+        if (v.IsUnknown()) return false;
+        return (v.prob_log_q_ > occ_prob_thres_log_) ? occupied_ : free_;
+    }
+};
+
+// Resets the voxels whose logical index along axis_ is in
+// [begin_, begin_ + n), n slabs of resolution^2 voxels.
+struct clear_slab_functor {
+    clear_slab_functor(CompactOccupancyVoxel* voxels,
+                       const Eigen::Vector3i& ring_offset,
+                       int resolution, int axis, int begin,
+                       const change_recorder& changes)
+                       : voxels_(voxels), ring_offset_(ring_offset),
+                       resolution_(resolution), axis_(axis), begin_(begin),
+                       changes_(changes) {};
+    CompactOccupancyVoxel* voxels_;
+    const Eigen::Vector3i ring_offset_;
+    const int resolution_;
+    const int axis_;
+    const int begin_;
+    const change_recorder changes_;
+    __device__ void operator() (size_t idx) {
+        const int res2 = resolution_ * resolution_;
+        Eigen::Vector3i v;
+        v[axis_] = begin_ + idx / res2;
+        v[(axis_ + 1) % 3] = (idx % res2) / resolution_;
+        v[(axis_ + 2) % 3] = idx % resolution_;
+        const int i = RingIndexOf(v, ring_offset_, resolution_);
+        changes_.Record(i, voxels_[i].prob_log_q_, CompactOccupancyVoxel::kUnknown);
+        voxels_[i] = CompactOccupancyVoxel();
+    }
+};
+
+// Bounds of the voxels updated by a scan, merged with atomics once per ray.
+struct scan_bounds {
+    int min_[3];
+    int max_[3];
+};
+
+__device__ void UpdateScanBounds(const Eigen::Vector3i &min_voxel,
+                                 const Eigen::Vector3i &max_voxel,
+                                 scan_bounds *bounds) {
+    for (int i = 0; i < 3; ++i) {
+        atomicMin(&bounds->min_[i], min_voxel[i]);
+        atomicMax(&bounds->max_[i], max_voxel[i]);
+    }
+}
+
+__device__ bool InGrid(const Eigen::Vector3i &voxel, int resolution) {
+    return voxel[0] >= 0 && voxel[1] >= 0 && voxel[2] >= 0 &&
+           voxel[0] < resolution && voxel[1] < resolution &&
+           voxel[2] < resolution;
+}
+
+// Sets the scan flag of the voxel, true for the first caller in the scan.
+__device__ bool MarkUpdated(unsigned int *flags, int idx) {
+    const unsigned int bit = 1u << (idx & 31);
+    return (atomicOr(&flags[idx >> 5], bit) & bit) == 0;
+}
+
+// Each hit point updates its voxel once per scan: the first point that
+// flags the voxel applies the hit.
+struct insert_hit_functor {
+    insert_hit_functor(CompactOccupancyVoxel *voxels,
+                       unsigned int *flags,
+                       scan_bounds *bounds,
+                       const Eigen::Vector3f &origin,
+                       float voxel_size,
+                       int resolution,
+                       const Eigen::Vector3i &ring_offset,
+                       const quantized_log_odds &log_odds,
+                       const change_recorder &changes)
+        : voxels_(voxels),
+          flags_(flags),
+          bounds_(bounds),
+          origin_(origin),
+          voxel_size_(voxel_size),
+          resolution_(resolution),
+          ring_offset_(ring_offset),
+          log_odds_(log_odds),
+          changes_(changes){};
+    CompactOccupancyVoxel *voxels_;
+    unsigned int *flags_;
+    scan_bounds *bounds_;
     const Eigen::Vector3f origin_;
-    const int n_div_;
-    __device__ Eigen::Vector3i operator() (size_t idx) {
-        int pidx = idx / (n_div_ * 7);
-        int svidx = idx % (n_div_ * 7);
-        int sidx = svidx / 7;
-        int vidx = svidx % 7;
-        Eigen::Vector3f center = sidx * steps_[pidx] + viewpoint_;
-        Eigen::Vector3f voxel_idx = Eigen::device_vectorize<float, 3, ::floor>((center - origin_) / voxel_size_);
-        Eigen::Vector3f voxel_center = voxel_size_ * (voxel_idx + Eigen::Vector3f(voxel_offset[vidx][0], voxel_offset[vidx][1], voxel_offset[vidx][2]));
-        bool is_intersect = intersection_test::LineSegmentAABB(viewpoint_, points_[pidx],
-                                                               voxel_center - box_half_size_,
-                                                               voxel_center + box_half_size_);
-        return (is_intersect) ? voxel_idx.cast<int>() + half_resolution_ :
-            Eigen::Vector3i(geometry::INVALID_VOXEL_INDEX, geometry::INVALID_VOXEL_INDEX, geometry::INVALID_VOXEL_INDEX);
+    const float voxel_size_;
+    const int resolution_;
+    const Eigen::Vector3i ring_offset_;
+    const quantized_log_odds log_odds_;
+    const change_recorder changes_;
+    __device__ void operator()(const thrust::tuple<Eigen::Vector3f, bool> &x) {
+        if (!thrust::get<1>(x)) return;
+        const Eigen::Vector3i voxel =
+                Eigen::device_vectorize<float, 3, ::floor>(
+                        (thrust::get<0>(x) - origin_) / voxel_size_)
+                        .cast<int>() +
+                Eigen::Vector3i::Constant(resolution_ / 2);
+        if (!InGrid(voxel, resolution_)) return;
+        const int idx = RingIndexOf(voxel, ring_offset_, resolution_);
+        if (!MarkUpdated(flags_, idx)) return;
+        const int16_t before = voxels_[idx].prob_log_q_;
+        voxels_[idx].prob_log_q_ = log_odds_.Update(before, log_odds_.hit_);
+        changes_.Record(idx, before, voxels_[idx].prob_log_q_);
+        UpdateScanBounds(voxel, voxel, bounds_);
     }
 };
 
-void ComputeFreeVoxels(const utility::device_vector<Eigen::Vector3f>& points,
-                       const Eigen::Vector3f& viewpoint,
-                       float voxel_size, int resolution, Eigen::Vector3f& origin,
-                       const utility::device_vector<Eigen::Vector3f>& steps, int n_div,
-                       utility::device_vector<Eigen::Vector3i>& free_voxels) {
-    if (points.empty()) return;
-    size_t n_points = points.size();
-    size_t max_idx = resolution * resolution * resolution;
-    Eigen::Vector3i half_resolution = Eigen::Vector3i::Constant(resolution / 2);
-    free_voxels.resize(n_div * n_points * 7);
-    compute_intersect_voxel_segment_functor func(thrust::raw_pointer_cast(points.data()),
-                                                 thrust::raw_pointer_cast(steps.data()),
-                                                 viewpoint, half_resolution,
-                                                 voxel_size, origin, n_div);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0), thrust::make_counting_iterator(n_div * n_points * 7),
-                      free_voxels.begin(), func);
-    auto end1 = thrust::remove_if(free_voxels.begin(), free_voxels.end(),
-             [max_idx] __device__(
-                    const Eigen::Vector3i &idx)
-                    -> bool {
-                return idx[0] < 0 || idx[1] < 0 || idx[2] < 0 || idx[0] >= max_idx || idx[1] >= max_idx || idx[2] >= max_idx;
-            });
-    free_voxels.resize(thrust::distance(free_voxels.begin(), end1));
-    thrust::sort(free_voxels.begin(), free_voxels.end());
-    auto end2 = thrust::unique(free_voxels.begin(), free_voxels.end());
-    free_voxels.resize(thrust::distance(free_voxels.begin(), end2));
-}
-
-struct create_occupancy_voxels_functor {
-    create_occupancy_voxels_functor(const Eigen::Vector3f &origin,
-                                    const Eigen::Vector3i &half_resolution,
-                                    float voxel_size)
-        : origin_(origin),
-          half_resolution_(half_resolution),
-          voxel_size_(voxel_size) {};
+// Walks the voxels of the segment from the viewpoint to the point, applying a miss to the voxels that neither a hit
+// nor another ray has updated in this scan.
+struct insert_free_ray_functor {
+    insert_free_ray_functor(CompactOccupancyVoxel *voxels,
+                            unsigned int *flags,
+                            scan_bounds *bounds,
+                            const Eigen::Vector3f &viewpoint,
+                            const Eigen::Vector3f &origin,
+                            float voxel_size,
+                            int resolution,
+                            const Eigen::Vector3i &ring_offset,
+                            const quantized_log_odds &log_odds,
+                            const change_recorder &changes)
+        : voxels_(voxels),
+          flags_(flags),
+          bounds_(bounds),
+          start_((viewpoint - origin) / voxel_size +
+                 Eigen::Vector3f::Constant(resolution / 2)),
+          origin_(origin),
+          voxel_size_(voxel_size),
+          resolution_(resolution),
+          ring_offset_(ring_offset),
+          log_odds_(log_odds),
+          changes_(changes){};
+    CompactOccupancyVoxel *voxels_;
+    unsigned int *flags_;
+    scan_bounds *bounds_;
+    const Eigen::Vector3f start_;
     const Eigen::Vector3f origin_;
-    const Eigen::Vector3i half_resolution_;
     const float voxel_size_;
-    __device__ Eigen::Vector3i operator()(const thrust::tuple<Eigen::Vector3f, bool> &x) const {
-        const Eigen::Vector3f& point = thrust::get<0>(x);
-        bool hit_flag = thrust::get<1>(x);
-        Eigen::Vector3f ref_coord = (point - origin_) / voxel_size_;
-        return (hit_flag) ? Eigen::device_vectorize<float, 3, ::floor>(ref_coord).cast<int>() + half_resolution_ :
-            Eigen::Vector3i(INVALID_VOXEL_INDEX,
-                INVALID_VOXEL_INDEX,
-                INVALID_VOXEL_INDEX);;
+    const int resolution_;
+    const Eigen::Vector3i ring_offset_;
+    const quantized_log_odds log_odds_;
+    const change_recorder changes_;
+    __device__ bool MarkFree(const Eigen::Vector3i &voxel) {
+        const int idx = RingIndexOf(voxel, ring_offset_, resolution_);
+        if (!MarkUpdated(flags_, idx)) return false;
+        const int16_t before = voxels_[idx].prob_log_q_;
+        voxels_[idx].prob_log_q_ = log_odds_.Update(before, log_odds_.miss_);
+        changes_.Record(idx, before, voxels_[idx].prob_log_q_);
+        return true;
+    }
+    __device__ void operator()(const Eigen::Vector3f &point) {
+        const Eigen::Vector3f end =
+                (point - origin_) / voxel_size_ +
+                Eigen::Vector3f::Constant(resolution_ / 2);
+        Eigen::Vector3i min_voxel = Eigen::Vector3i::Constant(resolution_);
+        Eigen::Vector3i max_voxel = Eigen::Vector3i::Constant(-1);
+        auto visit = [&](const Eigen::Vector3i &voxel) {
+            if (InGrid(voxel, resolution_) && MarkFree(voxel)) {
+                min_voxel = min_voxel.array().min(voxel.array());
+                max_voxel = max_voxel.array().max(voxel.array());
+            }
+        };
+        WalkGridCells(start_, end, visit);
+        if (max_voxel[0] >= 0) UpdateScanBounds(min_voxel, max_voxel, bounds_);
     }
 };
 
-void ComputeOccupiedVoxels(const utility::device_vector<Eigen::Vector3f>& points,
-    const utility::device_vector<bool> hit_flags,
-    float voxel_size, int resolution, Eigen::Vector3f& origin,
-    utility::device_vector<Eigen::Vector3i>& occupied_voxels) {
-    occupied_voxels.resize(points.size());
-    size_t max_idx = resolution * resolution * resolution;
-    Eigen::Vector3i half_resolution = Eigen::Vector3i::Constant(resolution / 2);
-    create_occupancy_voxels_functor func(origin, half_resolution, voxel_size);
-    thrust::transform(make_tuple_begin(points, hit_flags), make_tuple_end(points, hit_flags),
-                      occupied_voxels.begin(), func);
-    auto end1 = thrust::remove_if(occupied_voxels.begin(), occupied_voxels.end(),
-             [max_idx] __device__(
-                    const Eigen::Vector3i &idx)
-                    -> bool {
-                return idx[0] < 0 || idx[1] < 0 || idx[2] < 0 || idx[0] >= max_idx || idx[1] >= max_idx || idx[2] >= max_idx;
-            });
-    occupied_voxels.resize(thrust::distance(occupied_voxels.begin(), end1));
-    thrust::sort(occupied_voxels.begin(), occupied_voxels.end());
-    auto end2 = thrust::unique(occupied_voxels.begin(), occupied_voxels.end());
-    occupied_voxels.resize(thrust::distance(occupied_voxels.begin(), end2));
+// Quantized threshold q of the occupied voxels, q * kProbLogResolution >
+// occ_prob_thres_log iff q > thres.
+int16_t QuantizedOccupancyThreshold(float occ_prob_thres_log) {
+    int16_t thres = CompactOccupancyVoxel::Quantize(occ_prob_thres_log);
+    if (thres * CompactOccupancyVoxel::kProbLogResolution > occ_prob_thres_log) --thres;
+    return thres;
 }
 
+// Free voxels of the bounds with an unknown face neighbor in the grid.
+struct select_frontier_voxels_functor {
+    select_frontier_voxels_functor(const extract_range_voxels_functor& range,
+                                   int16_t occ_prob_thres_log)
+                                   : range_(range), occ_prob_thres_log_(occ_prob_thres_log) {};
+    const extract_range_voxels_functor range_;
+    const int16_t occ_prob_thres_log_;
+    __device__ bool operator() (size_t idx) const {
+        const CompactOccupancyVoxel v = range_.StoredVoxel(idx);
+        if (v.IsUnknown() || v.prob_log_q_ > occ_prob_thres_log_) return false;
+        const Eigen::Vector3i gidx = range_.GridIndex(idx);
+        for (int i = 0; i < 6; ++i) {
+            Eigen::Vector3i n = gidx;
+            n[i / 2] += (i % 2 == 0) ? 1 : -1;
+            if (!InGrid(n, range_.resolution_)) continue;
+            if (range_.voxels_[RingIndexOf(n, range_.ring_offset_, range_.resolution_)].IsUnknown()) return true;
+        }
+        return false;
+    }
+};
+
+// Edges to the frontier voxels among the 13 neighbors of larger linear
+// index in the 26 neighborhood, looked up in a dense map of the bounds.
+struct frontier_edges_functor {
+    frontier_edges_functor(const OccupancyVoxel* frontiers, const int* node_of_voxel,
+                           const Eigen::Vector3i& min_bound, const Eigen::Vector3i& extents,
+                           Eigen::Vector2i* edges)
+                           : frontiers_(frontiers), node_of_voxel_(node_of_voxel),
+                           min_bound_(min_bound), extents_(extents), edges_(edges) {};
+    const OccupancyVoxel* frontiers_;
+    const int* node_of_voxel_;
+    const Eigen::Vector3i min_bound_;
+    const Eigen::Vector3i extents_;
+    Eigen::Vector2i* edges_;
+    __device__ int NodeOf(const Eigen::Vector3i& gidx) const {
+        const Eigen::Vector3i l = gidx - min_bound_;
+        for (int i = 0; i < 3; ++i) {
+            if (l[i] < 0 || l[i] >= extents_[i]) return -1;
+        }
+        return node_of_voxel_[(l[0] * extents_[1] + l[1]) * extents_[2] + l[2]];
+    }
+    __device__ void operator() (size_t idx) const {
+        const Eigen::Vector3i p = frontiers_[idx].grid_index_.cast<int>();
+        int k = 0;
+        for (int code = 14; code < 27; ++code) {
+            const Eigen::Vector3i q = p + Eigen::Vector3i(code / 9 - 1, (code / 3) % 3 - 1, code % 3 - 1);
+            const int j = NodeOf(q);
+            edges_[idx * 13 + k++] = (j < 0) ? Eigen::Vector2i(-1, -1) : Eigen::Vector2i((int)idx, j);
+        }
+    }
+};
+
+struct frontier_linear_index_functor {
+    frontier_linear_index_functor(const Eigen::Vector3i& min_bound, const Eigen::Vector3i& extents)
+    : min_bound_(min_bound), extents_(extents) {};
+    const Eigen::Vector3i min_bound_;
+    const Eigen::Vector3i extents_;
+    __device__ int operator() (const OccupancyVoxel& v) const {
+        const Eigen::Vector3i l = v.grid_index_.cast<int>() - min_bound_;
+        return (l[0] * extents_[1] + l[1]) * extents_[2] + l[2];
+    }
+};
+
+struct count_cluster_functor {
+    count_cluster_functor(int* counts) : counts_(counts) {};
+    int* counts_;
+    __device__ void operator() (int label) const { atomicAdd(&counts_[label], 1); }
+};
+
+struct kept_root_functor {
+    kept_root_functor(const int* labels, const int* counts, int min_cluster_size)
+    : labels_(labels), counts_(counts), min_cluster_size_(min_cluster_size) {};
+    const int* labels_;
+    const int* counts_;
+    const int min_cluster_size_;
+    __device__ int operator() (int i) const {
+        return (labels_[i] == i && counts_[i] >= min_cluster_size_) ? 1 : 0;
+    }
+};
+
+struct relabel_cluster_functor {
+    relabel_cluster_functor(const int* kept, const int* cluster_ids)
+    : kept_(kept), cluster_ids_(cluster_ids) {};
+    const int* kept_;
+    const int* cluster_ids_;
+    __device__ int operator() (int label) const { return kept_[label] ? cluster_ids_[label] : -1; }
+};
+
+// Number of unknown voxels crossed by ray idx % n_rays of view
+// idx / n_rays before it leaves the grid, reaches max_range or enters an
+// occupied voxel.
+struct count_unknown_on_ray_functor {
+    count_unknown_on_ray_functor(const CompactOccupancyVoxel* voxels, const Eigen::Matrix4f_u* poses,
+                                 const Eigen::Vector3f* directions, int n_rays,
+                                 const Eigen::Vector3f& origin, float voxel_size, int resolution,
+                                 const Eigen::Vector3i& ring_offset, int16_t occ_prob_thres_log,
+                                 float max_range)
+                                 : voxels_(voxels), poses_(poses), directions_(directions),
+                                 n_rays_(n_rays), origin_(origin), voxel_size_(voxel_size),
+                                 resolution_(resolution), ring_offset_(ring_offset),
+                                 occ_prob_thres_log_(occ_prob_thres_log), max_range_(max_range) {};
+    const CompactOccupancyVoxel* voxels_;
+    const Eigen::Matrix4f_u* poses_;
+    const Eigen::Vector3f* directions_;
+    const int n_rays_;
+    const Eigen::Vector3f origin_;
+    const float voxel_size_;
+    const int resolution_;
+    const Eigen::Vector3i ring_offset_;
+    const int16_t occ_prob_thres_log_;
+    const float max_range_;
+    __device__ int operator() (size_t idx) const {
+        const Eigen::Matrix4f_u& pose = poses_[idx / n_rays_];
+        const Eigen::Vector3f dir = pose.block<3, 3>(0, 0) * directions_[idx % n_rays_].normalized();
+        const Eigen::Vector3f start = (pose.block<3, 1>(0, 3) - origin_) / voxel_size_ +
+                                      Eigen::Vector3f::Constant(resolution_ / 2);
+        const Eigen::Vector3f end = start + dir * (max_range_ / voxel_size_);
+        int n_unknown = 0;
+        auto visit = [&](const Eigen::Vector3i& voxel) {
+            if (!InGrid(voxel, resolution_)) return false;
+            const CompactOccupancyVoxel& v = voxels_[RingIndexOf(voxel, ring_offset_, resolution_)];
+            if (v.IsUnknown()) {
+                ++n_unknown;
+                return true;
+            }
+            return v.prob_log_q_ <= occ_prob_thres_log_;
+        };
+        WalkGridCellsUntil(start, end, visit);
+        return n_unknown;
+    }
+};
+
+struct ray_view_functor {
+    ray_view_functor(int n_rays) : n_rays_(n_rays) {};
+    const int n_rays_;
+    __device__ int operator() (size_t idx) const { return idx / n_rays_; }
+};
+
 struct add_occupancy_functor{
-    add_occupancy_functor(OccupancyVoxel* voxels, int resolution,
-                          float clamping_thres_min, float clamping_thres_max,
-                          float prob_miss_log, float prob_hit_log, bool occupied)
-     : voxels_(voxels), resolution_(resolution), clamping_thres_min_(clamping_thres_min), clamping_thres_max_(clamping_thres_max),
-     prob_miss_log_(prob_miss_log), prob_hit_log_(prob_hit_log), occupied_(occupied) {};
-    OccupancyVoxel* voxels_;
+    add_occupancy_functor(CompactOccupancyVoxel* voxels, int resolution,
+                          const Eigen::Vector3i& ring_offset,
+                          const quantized_log_odds& log_odds, bool occupied,
+                          const change_recorder& changes)
+     : voxels_(voxels), resolution_(resolution), ring_offset_(ring_offset),
+     log_odds_(log_odds), occupied_(occupied), changes_(changes) {};
+    CompactOccupancyVoxel* voxels_;
     const int resolution_;
-    const float clamping_thres_min_;
-    const float clamping_thres_max_;
-    const float prob_miss_log_;
-    const float prob_hit_log_;
+    const Eigen::Vector3i ring_offset_;
+    const quantized_log_odds log_odds_;
     const bool occupied_;
+    const change_recorder changes_;
     __device__ void operator() (const Eigen::Vector3i& voxel) {
-        size_t idx = IndexOf(voxel, resolution_);
-        float p = voxels_[idx].prob_log_;
-        p = (isnan(p)) ? 0 : p;
-        p += (occupied_) ? prob_hit_log_ : prob_miss_log_;
-        voxels_[idx].prob_log_ = min(max(p, clamping_thres_min_), clamping_thres_max_);
-        voxels_[idx].grid_index_ = voxel.cast<unsigned short>();
+        size_t idx = RingIndexOf(voxel, ring_offset_, resolution_);
+        const int16_t before = voxels_[idx].prob_log_q_;
+        voxels_[idx].prob_log_q_ = log_odds_.Update(
+                before, (occupied_) ? log_odds_.hit_ : log_odds_.miss_);
+        changes_.Record(idx, before, voxels_[idx].prob_log_q_);
+    }
+};
+
+// Grid index of a storage index, see OccupancyGrid::ring_offset_.
+__device__ Eigen::Vector3i GridIndexOfRing(int storage_index,
+                                           const Eigen::Vector3i &offset,
+                                           int resolution) {
+    Eigen::Vector3i v = OccupancyGrid::LayoutType::GridIndexOf(storage_index,
+                                                               resolution) -
+                        offset;
+    for (int i = 0; i < 3; ++i) {
+        if (v[i] < 0) v[i] += resolution;
+    }
+    return v;
+}
+
+struct changed_since_functor {
+    changed_since_functor(const unsigned int *versions, unsigned int since)
+        : versions_(versions), since_(since){};
+    const unsigned int *versions_;
+    const unsigned int since_;
+    __device__ bool operator()(int idx) const { return versions_[idx] > since_; }
+};
+
+// Packs the grid index and the log odds of a changed voxel.
+struct encode_delta_voxel_functor {
+    encode_delta_voxel_functor(const CompactOccupancyVoxel *voxels,
+                               int resolution,
+                               const Eigen::Vector3i &ring_offset)
+        : voxels_(voxels), resolution_(resolution), ring_offset_(ring_offset){};
+    const CompactOccupancyVoxel *voxels_;
+    const int resolution_;
+    const Eigen::Vector3i ring_offset_;
+    __device__ thrust::tuple<unsigned int, int16_t> operator()(int idx) const {
+        const Eigen::Vector3i v = GridIndexOfRing(idx, ring_offset_, resolution_);
+        return thrust::make_tuple(
+                (unsigned int)((v[0] * resolution_ + v[1]) * resolution_ + v[2]),
+                voxels_[idx].prob_log_q_);
+    }
+};
+
+__host__ __device__ Eigen::Vector3i DecodeDeltaIndex(unsigned int index,
+                                                     int resolution) {
+    return Eigen::Vector3i(index / (resolution * resolution),
+                           (index / resolution) % resolution,
+                           index % resolution);
+}
+
+struct apply_delta_voxel_functor {
+    apply_delta_voxel_functor(CompactOccupancyVoxel *voxels,
+                              int resolution,
+                              const Eigen::Vector3i &ring_offset,
+                              const change_recorder &changes)
+        : voxels_(voxels),
+          resolution_(resolution),
+          ring_offset_(ring_offset),
+          changes_(changes){};
+    CompactOccupancyVoxel *voxels_;
+    const int resolution_;
+    const Eigen::Vector3i ring_offset_;
+    const change_recorder changes_;
+    __device__ void operator()(
+            const thrust::tuple<unsigned int, int16_t> &x) const {
+        const int idx = RingIndexOf(
+                DecodeDeltaIndex(thrust::get<0>(x), resolution_), ring_offset_,
+                resolution_);
+        changes_.Record(idx, voxels_[idx].prob_log_q_, thrust::get<1>(x));
+        voxels_[idx].prob_log_q_ = thrust::get<1>(x);
+    }
+};
+
+// Bounds of the known voxels of a delta, empty ones for the others.
+struct delta_voxel_bounds_functor {
+    delta_voxel_bounds_functor(int resolution) : resolution_(resolution){};
+    const int resolution_;
+    __device__ thrust::tuple<Eigen::Vector3i, Eigen::Vector3i> operator()(
+            const thrust::tuple<unsigned int, int16_t> &x) const {
+        if (thrust::get<1>(x) == CompactOccupancyVoxel::kUnknown) {
+            return thrust::make_tuple(Eigen::Vector3i::Constant(resolution_),
+                                      Eigen::Vector3i::Constant(-1));
+        }
+        const Eigen::Vector3i v = DecodeDeltaIndex(thrust::get<0>(x), resolution_);
+        return thrust::make_tuple(v, v);
+    }
+};
+
+struct merge_bounds_functor {
+    __device__ thrust::tuple<Eigen::Vector3i, Eigen::Vector3i> operator()(
+            const thrust::tuple<Eigen::Vector3i, Eigen::Vector3i> &a,
+            const thrust::tuple<Eigen::Vector3i, Eigen::Vector3i> &b) const {
+        return thrust::make_tuple(
+                thrust::get<0>(a).cwiseMin(thrust::get<0>(b)),
+                thrust::get<1>(a).cwiseMax(thrust::get<1>(b)));
     }
 };
 
+// Header of OccupancyGridDelta::Serialize().
+struct delta_header {
+    char magic_[4];
+    unsigned int from_version_;
+    unsigned int to_version_;
+    unsigned int reset_;
+    float voxel_size_;
+    int resolution_;
+    float origin_[3];
+    unsigned int n_voxels_;
+};
+
+const char kDeltaMagic[4] = {'C', 'O', 'G', 'D'};
+
+// Recorder of the updates of the current version of \p grid.
+change_recorder MakeChangeRecorder(OccupancyGrid &grid) {
+    return change_recorder(
+            (grid.IsChangeTrackingEnabled())
+                    ? thrust::raw_pointer_cast(grid.change_versions_.data())
+                    : nullptr,
+            grid.version_, QuantizedOccupancyThreshold(grid.occ_prob_thres_log_));
+}
+
 }
 
-template class DenseGrid<OccupancyVoxel>;
+template class DenseGrid<CompactOccupancyVoxel>;
 
 OccupancyGrid::OccupancyGrid()
- : DenseGrid<OccupancyVoxel>(Geometry::GeometryType::OccupancyGrid, 0.05, 512, Eigen::Vector3f::Zero()),
+ : DenseGrid<CompactOccupancyVoxel>(Geometry::GeometryType::OccupancyGrid, 0.05, 512, Eigen::Vector3f::Zero()),
    min_bound_(Eigen::Vector3ui16::Constant(resolution_ / 2)),
    max_bound_(Eigen::Vector3ui16::Constant(resolution_ / 2)) {}
 OccupancyGrid::OccupancyGrid(float voxel_size, int resolution, const Eigen::Vector3f& origin)
- : DenseGrid<OccupancyVoxel>(Geometry::GeometryType::OccupancyGrid, voxel_size, resolution, origin),
+ : DenseGrid<CompactOccupancyVoxel>(Geometry::GeometryType::OccupancyGrid, voxel_size, resolution, origin),
    min_bound_(Eigen::Vector3ui16::Constant(resolution_ / 2)),
    max_bound_(Eigen::Vector3ui16::Constant(resolution_ / 2)) {}
 OccupancyGrid::~OccupancyGrid() {}
 OccupancyGrid::OccupancyGrid(const OccupancyGrid& other)
- : DenseGrid<OccupancyVoxel>(Geometry::GeometryType::OccupancyGrid, other),
+ : DenseGrid<CompactOccupancyVoxel>(Geometry::GeometryType::OccupancyGrid, other),
    min_bound_(other.min_bound_), max_bound_(other.max_bound_),
    clamping_thres_min_(other.clamping_thres_min_), clamping_thres_max_(other.clamping_thres_max_),
    prob_hit_log_(other.prob_hit_log_), prob_miss_log_(other.prob_miss_log_),
-   occ_prob_thres_log_(other.occ_prob_thres_log_), visualize_free_area_(other.visualize_free_area_) {}
+   occ_prob_thres_log_(other.occ_prob_thres_log_), visualize_free_area_(other.visualize_free_area_),
+   ring_offset_(other.ring_offset_), change_versions_(other.change_versions_),
+   version_(other.version_), reset_version_(other.reset_version_) {}
 
 OccupancyGrid &OccupancyGrid::Clear() {
     DenseGrid::Clear();
     min_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
     max_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+    ring_offset_ = Eigen::Vector3i::Zero();
+    change_versions_.clear();
+    reset_version_ = ++version_;
     return *this;
 }
 
@@ -205,25 +615,43 @@ Eigen::Vector3f OccupancyGrid::GetMaxBound() const {
     return (max_bound_.cast<int>() - Eigen::Vector3i::Constant(resolution_ / 2 - 1)).cast<float>() * voxel_size_ - origin_;
 }
 
+int OccupancyGrid::GetRingIndex(const Eigen::Vector3f &point) const {
+    const Eigen::Vector3i voxel =
+            (Eigen::floor(((point - origin_) / voxel_size_).array()))
+                    .matrix()
+                    .cast<int>() +
+            Eigen::Vector3i::Constant(resolution_ / 2);
+    if ((voxel.array() < 0).any() || (voxel.array() >= resolution_).any()) {
+        return -1;
+    }
+    return RingIndexOf(voxel, ring_offset_, resolution_);
+}
+
 bool OccupancyGrid::IsOccupied(const Eigen::Vector3f &point) const{
-    auto idx = GetVoxelIndex(point);
+    auto idx = GetRingIndex(point);
     if (idx < 0) return false;
-    OccupancyVoxel voxel = voxels_[idx];
-    return !std::isnan(voxel.prob_log_) && voxel.prob_log_ > occ_prob_thres_log_;
+    CompactOccupancyVoxel voxel = voxels_[idx];
+    return !voxel.IsUnknown() && voxel.GetProbLog() > occ_prob_thres_log_;
 }
 
 bool OccupancyGrid::IsUnknown(const Eigen::Vector3f &point) const{
-    auto idx = GetVoxelIndex(point);
+    auto idx = GetRingIndex(point);
     if (idx < 0) return true;
-    OccupancyVoxel voxel = voxels_[idx];
-    return std::isnan(voxel.prob_log_);
+    CompactOccupancyVoxel voxel = voxels_[idx];
+    return voxel.IsUnknown();
 }
 
 thrust::tuple<bool, OccupancyVoxel> OccupancyGrid::GetVoxel(const Eigen::Vector3f &point) const {
-    auto idx = GetVoxelIndex(point);
+    auto idx = GetRingIndex(point);
     if (idx < 0) return thrust::make_tuple(false, OccupancyVoxel());
-    OccupancyVoxel voxel = voxels_[idx];
-    return thrust::make_tuple(!std::isnan(voxel.prob_log_), voxel);
+    CompactOccupancyVoxel voxel = voxels_[idx];
+    const Eigen::Vector3i grid_index =
+            (Eigen::floor(((point - origin_) / voxel_size_).array()))
+                    .matrix()
+                    .cast<int>() +
+            Eigen::Vector3i::Constant(resolution_ / 2);
+    return thrust::make_tuple(!voxel.IsUnknown(),
+                              OccupancyVoxel(grid_index, voxel.GetProbLog()));
 }
 
 std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractBoundVoxels() const {
@@ -233,93 +661,250 @@ std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractBo
     extract_range_voxels_functor func(thrust::raw_pointer_cast(voxels_.data()),
                                       diff.cast<int>(),
                                       resolution_,
-                                      min_bound_.cast<int>());
+                                      min_bound_.cast<int>(),
+                                      ring_offset_);
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
         thrust::make_counting_iterator(out->size()), out->begin(), func);
     return out;
 }
 
-std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractKnownVoxels() const {
-    auto out = ExtractBoundVoxels();
-    auto remove_fn = [th = occ_prob_thres_log_] __device__ (const thrust::tuple<OccupancyVoxel>& x) {
-        const OccupancyVoxel& v = thrust::get<0>(x);
-        return isnan(v.prob_log_);
-    };
-    remove_if_vectors(remove_fn, *out);
+std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractVoxels(bool free, bool occupied) const {
+    Eigen::Vector3ui16 diff = max_bound_ - min_bound_ + Eigen::Vector3ui16::Ones();
+    const size_t n_bound = diff[0] * diff[1] * diff[2];
+    extract_range_voxels_functor func(thrust::raw_pointer_cast(voxels_.data()),
+                                      diff.cast<int>(),
+                                      resolution_,
+                                      min_bound_.cast<int>(),
+                                      ring_offset_);
+    select_range_voxels_functor select_func(func, QuantizedOccupancyThreshold(occ_prob_thres_log_),
+                                            free, occupied);
+    utility::device_vector<size_t> indices(n_bound);
+    auto end = thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
+                               thrust::make_counting_iterator(n_bound),
+                               indices.begin(), select_func);
+    indices.resize(thrust::distance(indices.begin(), end));
+    auto out = std::make_shared<utility::device_vector<OccupancyVoxel>>(indices.size());
+    thrust::transform(indices.begin(), indices.end(), out->begin(), func);
     return out;
 }
 
+std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractKnownVoxels() const {
+    return ExtractVoxels(true, true);
+}
+
 std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractFreeVoxels() const {
-    auto out = ExtractBoundVoxels();
-    auto remove_fn = [th = occ_prob_thres_log_] __device__ (const thrust::tuple<OccupancyVoxel>& x) {
-        const OccupancyVoxel& v = thrust::get<0>(x);
-        return isnan(v.prob_log_) || v.prob_log_ > th;
-    };
-    remove_if_vectors(remove_fn, *out);
-    return out;
+    return ExtractVoxels(true, false);
 }
 
 std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractOccupiedVoxels() const {
-    auto out = ExtractBoundVoxels();
-    auto remove_fn = [th = occ_prob_thres_log_] __device__ (const thrust::tuple<OccupancyVoxel>& x) {
-        const OccupancyVoxel& v = thrust::get<0>(x);
-        return isnan(v.prob_log_) || v.prob_log_ <= th;
-    };
-    remove_if_vectors(remove_fn, *out);
+    return ExtractVoxels(false, true);
+}
+
+std::shared_ptr<utility::device_vector<OccupancyVoxel>> OccupancyGrid::ExtractFrontierVoxels() const {
+    Eigen::Vector3ui16 diff = max_bound_ - min_bound_ + Eigen::Vector3ui16::Ones();
+    const size_t n_bound = diff[0] * diff[1] * diff[2];
+    extract_range_voxels_functor func(thrust::raw_pointer_cast(voxels_.data()),
+                                      diff.cast<int>(),
+                                      resolution_,
+                                      min_bound_.cast<int>(),
+                                      ring_offset_);
+    select_frontier_voxels_functor select_func(func, QuantizedOccupancyThreshold(occ_prob_thres_log_));
+    utility::device_vector<size_t> indices(n_bound);
+    auto end = thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
+                               thrust::make_counting_iterator(n_bound),
+                               indices.begin(), select_func);
+    indices.resize(thrust::distance(indices.begin(), end));
+    auto out = std::make_shared<utility::device_vector<OccupancyVoxel>>(indices.size());
+    thrust::transform(indices.begin(), indices.end(), out->begin(), func);
     return out;
 }
 
+utility::device_vector<int> OccupancyGrid::ClusterFrontierVoxels(
+        const utility::device_vector<OccupancyVoxel>& frontiers, int min_cluster_size) const {
+    const int n_nodes = frontiers.size();
+    utility::device_vector<int> labels(n_nodes, -1);
+    if (n_nodes == 0) return labels;
+    const Eigen::Vector3i min_bound = min_bound_.cast<int>();
+    const Eigen::Vector3i extents = (max_bound_ - min_bound_ + Eigen::Vector3ui16::Ones()).cast<int>();
+    utility::device_vector<int> node_of_voxel(extents[0] * extents[1] * extents[2], -1);
+    thrust::scatter(thrust::make_counting_iterator<int>(0), thrust::make_counting_iterator<int>(n_nodes),
+                    thrust::make_transform_iterator(frontiers.begin(),
+                                                    frontier_linear_index_functor(min_bound, extents)),
+                    node_of_voxel.begin());
+    utility::device_vector<Eigen::Vector2i> edges(n_nodes * 13);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0), thrust::make_counting_iterator<size_t>(n_nodes),
+                     frontier_edges_functor(thrust::raw_pointer_cast(frontiers.data()),
+                                            thrust::raw_pointer_cast(node_of_voxel.data()),
+                                            min_bound, extents, thrust::raw_pointer_cast(edges.data())));
+    edges.erase(thrust::remove_if(edges.begin(), edges.end(),
+                                  [] __device__ (const Eigen::Vector2i& e) { return e[0] < 0; }),
+                edges.end());
+    Graph graph;
+    graph.points_.resize(n_nodes);
+    graph.lines_ = edges;
+    const utility::device_vector<int> roots = graph.ConnectedComponents();
+    // Clusters of at least min_cluster_size voxels, numbered in the order
+    // of their smallest voxel.
+    utility::device_vector<int> counts(n_nodes, 0);
+    thrust::for_each(roots.begin(), roots.end(), count_cluster_functor(thrust::raw_pointer_cast(counts.data())));
+    utility::device_vector<int> kept(n_nodes);
+    thrust::transform(thrust::make_counting_iterator<int>(0), thrust::make_counting_iterator<int>(n_nodes),
+                      kept.begin(),
+                      kept_root_functor(thrust::raw_pointer_cast(roots.data()),
+                                        thrust::raw_pointer_cast(counts.data()), min_cluster_size));
+    utility::device_vector<int> cluster_ids(n_nodes);
+    thrust::exclusive_scan(kept.begin(), kept.end(), cluster_ids.begin());
+    thrust::transform(roots.begin(), roots.end(), labels.begin(),
+                      relabel_cluster_functor(thrust::raw_pointer_cast(kept.data()),
+                                              thrust::raw_pointer_cast(cluster_ids.data())));
+    return labels;
+}
+
+utility::device_vector<int> OccupancyGrid::ComputeInformationGain(
+        const utility::device_vector<Eigen::Matrix4f_u>& view_poses,
+        const utility::device_vector<Eigen::Vector3f>& ray_directions,
+        float max_range) const {
+    const int n_views = view_poses.size();
+    const int n_rays = ray_directions.size();
+    utility::device_vector<int> gains(n_views, 0);
+    if (n_views == 0 || n_rays == 0) return gains;
+    count_unknown_on_ray_functor func(thrust::raw_pointer_cast(voxels_.data()),
+                                      thrust::raw_pointer_cast(view_poses.data()),
+                                      thrust::raw_pointer_cast(ray_directions.data()), n_rays,
+                                      origin_, voxel_size_, resolution_, ring_offset_,
+                                      QuantizedOccupancyThreshold(occ_prob_thres_log_), max_range);
+    const size_t n_total = (size_t)n_views * n_rays;
+    // The rays of a view are consecutive, so one segmented reduction sums
+    // them without atomics.
+    thrust::reduce_by_key(thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0),
+                                                          ray_view_functor(n_rays)),
+                          thrust::make_transform_iterator(thrust::make_counting_iterator(n_total),
+                                                          ray_view_functor(n_rays)),
+                          thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func),
+                          thrust::make_discard_iterator(), gains.begin());
+    return gains;
+}
+
+DenseGridView<CompactOccupancyVoxel> OccupancyGrid::GetView() const {
+    DenseGridView<CompactOccupancyVoxel> view = DenseGrid<CompactOccupancyVoxel>::GetView();
+    view.ring_offset_ = ring_offset_;
+    return view;
+}
+
 OccupancyGrid& OccupancyGrid::Reconstruct(float voxel_size, int resolution) {
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::Occupancy);
     DenseGrid::Reconstruct(voxel_size, resolution);
+    ring_offset_ = Eigen::Vector3i::Zero();
+    reset_version_ = ++version_;
+    if (IsChangeTrackingEnabled()) {
+        change_versions_.resize(voxels_.size());
+        thrust::fill(change_versions_.begin(), change_versions_.end(), 0);
+    }
+    return *this;
+}
+
+OccupancyGrid& OccupancyGrid::MoveOrigin(const Eigen::Vector3f& origin) {
+    const Eigen::Vector3i shift =
+            (Eigen::round(((origin - origin_) / voxel_size_).array()))
+                    .matrix()
+                    .cast<int>();
+    if (shift.isZero()) return *this;
+    ++version_;
+    origin_ += shift.cast<float>() * voxel_size_;
+    if ((shift.array().abs() >= resolution_).any()) {
+        thrust::fill(voxels_.begin(), voxels_.end(), CompactOccupancyVoxel());
+        thrust::fill(change_versions_.begin(), change_versions_.end(), 0);
+        reset_version_ = version_;
+        min_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+        max_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+        ring_offset_ = Eigen::Vector3i::Zero();
+        return *this;
+    }
+    for (int i = 0; i < 3; ++i) {
+        ring_offset_[i] = ((ring_offset_[i] + shift[i]) % resolution_ + resolution_) % resolution_;
+    }
+    // The slabs that scroll in reuse the storage of those that scroll out.
+    for (int i = 0; i < 3; ++i) {
+        if (shift[i] == 0) continue;
+        const int n_slabs = std::abs(shift[i]);
+        const int begin = (shift[i] > 0) ? resolution_ - n_slabs : 0;
+        clear_slab_functor func(thrust::raw_pointer_cast(voxels_.data()),
+                                ring_offset_, resolution_, i, begin,
+                                MakeChangeRecorder(*this));
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator<size_t>(
+                                 (size_t)n_slabs * resolution_ * resolution_),
+                         func);
+    }
+    const Eigen::Vector3i lower = (min_bound_.cast<int>() - shift).cwiseMax(0);
+    const Eigen::Vector3i upper = (max_bound_.cast<int>() - shift).cwiseMin(resolution_ - 1);
+    if ((lower.array() > upper.array()).any()) {
+        min_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+        max_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+    } else {
+        min_bound_ = lower.cast<unsigned short>();
+        max_bound_ = upper.cast<unsigned short>();
+    }
     return *this;
 }
 
 OccupancyGrid& OccupancyGrid::Insert(const utility::device_vector<Eigen::Vector3f>& points,
                                      const Eigen::Vector3f& viewpoint, float max_range) {
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::Occupancy);
     if (points.empty()) return *this;
+    ++version_;
+    const change_recorder changes = MakeChangeRecorder(*this);
 
     utility::device_vector<Eigen::Vector3f> ranged_points(points.size());
-    utility::device_vector<float> ranged_dists(points.size());
     utility::device_vector<bool> hit_flags(points.size());
 
     thrust::transform(points.begin(), points.end(),
-                      make_tuple_begin(ranged_points, ranged_dists, hit_flags),
+                      make_tuple_begin(ranged_points, hit_flags),
                       [viewpoint, max_range] __device__ (const Eigen::Vector3f &pt) {
                           Eigen::Vector3f pt_vp = pt - viewpoint;
                           float dist = pt_vp.norm();
                           bool is_hit = max_range < 0 || dist <= max_range;
                           return thrust::make_tuple((is_hit) ? pt : viewpoint + pt_vp / dist * max_range,
-                                                    (is_hit) ? dist : max_range, is_hit);
+                                                    is_hit);
                       });
-    float max_dist = *(thrust::max_element(ranged_dists.begin(), ranged_dists.end()));
-    int n_div = int(std::ceil(max_dist / voxel_size_));
-
-    utility::device_vector<Eigen::Vector3i> free_voxels;
-    utility::device_vector<Eigen::Vector3i> occupied_voxels;
-    if (n_div > 0) {
-        utility::device_vector<Eigen::Vector3f> steps(points.size());
-        thrust::transform(ranged_points.begin(), ranged_points.end(), steps.begin(),
-                          [viewpoint, n_div] __device__ (const Eigen::Vector3f& pt) {
-                              return (pt - viewpoint) / n_div;
-                          });
-        // comupute free voxels
-        ComputeFreeVoxels(ranged_points, viewpoint, voxel_size_, resolution_, origin_, steps, n_div + 1, free_voxels);
-    } else {
-        thrust::copy(points.begin(), points.end(), ranged_points.begin());
-        thrust::fill(hit_flags.begin(), hit_flags.end(), true);
-    }
-    // compute occupied voxels
-    ComputeOccupiedVoxels(ranged_points, hit_flags, voxel_size_, resolution_, origin_, occupied_voxels);
 
-    if (n_div > 0) {
-        utility::device_vector<Eigen::Vector3i> free_voxels_res(free_voxels.size());
-        auto end = thrust::set_difference(free_voxels.begin(), free_voxels.end(),
-                                          occupied_voxels.begin(), occupied_voxels.end(),
-                                          free_voxels_res.begin());
-        free_voxels_res.resize(thrust::distance(free_voxels_res.begin(), end));
-        AddVoxels(free_voxels_res, false);
+    // The hits are applied first, so that the rays through an occupied
+    // voxel of the same scan leave it untouched.
+    scan_flags_.resize((voxels_.size() + 31) / 32);
+    thrust::fill(scan_flags_.begin(), scan_flags_.end(), 0);
+    scan_bounds h_bounds = {{resolution_, resolution_, resolution_}, {-1, -1, -1}};
+    utility::device_vector<scan_bounds> bounds(1, h_bounds);
+    const quantized_log_odds log_odds(*this);
+
+    insert_hit_functor hit_func(thrust::raw_pointer_cast(voxels_.data()),
+                                thrust::raw_pointer_cast(scan_flags_.data()),
+                                thrust::raw_pointer_cast(bounds.data()),
+                                origin_, voxel_size_, resolution_,
+                                ring_offset_, log_odds, changes);
+    thrust::for_each(make_tuple_begin(ranged_points, hit_flags),
+                     make_tuple_end(ranged_points, hit_flags), hit_func);
+    insert_free_ray_functor ray_func(thrust::raw_pointer_cast(voxels_.data()),
+                                     thrust::raw_pointer_cast(scan_flags_.data()),
+                                     thrust::raw_pointer_cast(bounds.data()),
+                                     viewpoint, origin_, voxel_size_, resolution_,
+                                     ring_offset_, log_odds, changes);
+    const Eigen::Vector3f *ranged_points_ptr =
+            thrust::raw_pointer_cast(ranged_points.data());
+    utility::TunedForEach(
+            "OccupancyGrid::InsertFreeRays", ranged_points.size(),
+            [ray_func, ranged_points_ptr] __device__(size_t idx) mutable {
+                ray_func(ranged_points_ptr[idx]);
+            });
+
+    h_bounds = bounds[0];
+    if (h_bounds.max_[0] >= 0) {
+        const Eigen::Vector3ui16 fvu = Eigen::Map<Eigen::Vector3i>(h_bounds.min_).cast<unsigned short>();
+        const Eigen::Vector3ui16 bvu = Eigen::Map<Eigen::Vector3i>(h_bounds.max_).cast<unsigned short>();
+        min_bound_ = min_bound_.array().min(fvu.array());
+        max_bound_ = max_bound_.array().max(bvu.array());
     }
-    AddVoxels(occupied_voxels, true);
     return *this;
 }
 
@@ -336,41 +921,191 @@ OccupancyGrid& OccupancyGrid::Insert(const geometry::PointCloud& pointcloud,
 }
 
 OccupancyGrid& OccupancyGrid::AddVoxel(const Eigen::Vector3i &voxel, bool occupied) {
-    int idx = IndexOf(voxel, resolution_);
-    size_t max_idx = resolution_ * resolution_ * resolution_;
-    if (idx < 0 || idx >= max_idx) {
+    if ((voxel.array() < 0).any() || (voxel.array() >= resolution_).any()) {
         utility::LogError(
             "[OccupancyGrid] a provided voxeld is not occupancy grid range.");
         return *this;
     } else {
-        OccupancyVoxel org_ov = voxels_[idx];
-        if (std::isnan(org_ov.prob_log_)) org_ov.prob_log_ = 0.0;
-        org_ov.prob_log_ += (occupied) ? prob_hit_log_ : prob_miss_log_;
-        org_ov.prob_log_ = std::min(std::max(org_ov.prob_log_, clamping_thres_min_), clamping_thres_max_);
-        org_ov.grid_index_ = voxel.cast<unsigned short>();
+        const int idx = RingIndexOf(voxel, ring_offset_, resolution_);
+        const quantized_log_odds log_odds(*this);
+        CompactOccupancyVoxel org_ov = voxels_[idx];
+        const int16_t before = org_ov.prob_log_q_;
+        org_ov.prob_log_q_ = log_odds.Update(
+                org_ov.prob_log_q_, (occupied) ? log_odds.hit_ : log_odds.miss_);
         voxels_[idx] = org_ov;
-        min_bound_ = (min_bound_.array() > org_ov.grid_index_.array()).select(org_ov.grid_index_, min_bound_);
-        max_bound_ = (max_bound_.array() < org_ov.grid_index_.array()).select(org_ov.grid_index_, max_bound_);
+        ++version_;
+        const int16_t thres = QuantizedOccupancyThreshold(occ_prob_thres_log_);
+        if (IsChangeTrackingEnabled() &&
+            OccupancyStateOf(before, thres) != OccupancyStateOf(org_ov.prob_log_q_, thres)) {
+            change_versions_[idx] = version_;
+        }
+        const Eigen::Vector3ui16 grid_index = voxel.cast<unsigned short>();
+        min_bound_ = (min_bound_.array() > grid_index.array()).select(grid_index, min_bound_);
+        max_bound_ = (max_bound_.array() < grid_index.array()).select(grid_index, max_bound_);
     }
     return *this;
 }
 
 OccupancyGrid& OccupancyGrid::AddVoxels(const utility::device_vector<Eigen::Vector3i>& voxels, bool occupied) {
     if (voxels.empty()) return *this;
-    Eigen::Vector3i fv = voxels.front();
-    Eigen::Vector3i bv = voxels.back();
+    ++version_;
+    Eigen::Vector3i init = voxels.front();
+    Eigen::Vector3i fv = thrust::reduce(voxels.begin(), voxels.end(), init,
+                                        thrust::elementwise_minimum<Eigen::Vector3i>());
+    Eigen::Vector3i bv = thrust::reduce(voxels.begin(), voxels.end(), init,
+                                        thrust::elementwise_maximum<Eigen::Vector3i>());
     Eigen::Vector3ui16 fvu = fv.cast<unsigned short>();
     Eigen::Vector3ui16 bvu = bv.cast<unsigned short>();
     min_bound_ = min_bound_.array().min(fvu.array());
-    min_bound_ = min_bound_.array().min(bvu.array());
-    max_bound_ = max_bound_.array().max(fvu.array());
     max_bound_ = max_bound_.array().max(bvu.array());
     add_occupancy_functor func(thrust::raw_pointer_cast(voxels_.data()),
-                               resolution_, clamping_thres_min_, clamping_thres_max_,
-                               prob_miss_log_, prob_hit_log_, occupied);
+                               resolution_, ring_offset_, quantized_log_odds(*this),
+                               occupied, MakeChangeRecorder(*this));
     thrust::for_each(voxels.begin(), voxels.end(), func);
     return *this;
 }
 
+OccupancyGrid& OccupancyGrid::EnableChangeTracking() {
+    if (IsChangeTrackingEnabled()) return *this;
+    ++version_;
+    change_versions_.resize(voxels_.size());
+    const unsigned int version = version_;
+    thrust::transform(voxels_.begin(), voxels_.end(), change_versions_.begin(),
+                      [version] __device__ (const CompactOccupancyVoxel& v) {
+                          return (v.IsUnknown()) ? 0u : version;
+                      });
+    return *this;
+}
+
+OccupancyGrid& OccupancyGrid::DisableChangeTracking() {
+    change_versions_.clear();
+    change_versions_.shrink_to_fit();
+    return *this;
+}
+
+OccupancyGridDelta OccupancyGrid::ExportDelta(unsigned int since_version) const {
+    OccupancyGridDelta delta;
+    delta.from_version_ = since_version;
+    delta.to_version_ = version_;
+    delta.reset_ = since_version < reset_version_;
+    delta.voxel_size_ = voxel_size_;
+    delta.resolution_ = resolution_;
+    delta.origin_ = origin_;
+    if (!IsChangeTrackingEnabled()) {
+        utility::LogError("[OccupancyGrid] change tracking is not enabled.");
+        return delta;
+    }
+    utility::device_vector<int> changed(change_versions_.size());
+    auto end = thrust::copy_if(thrust::make_counting_iterator<int>(0),
+                               thrust::make_counting_iterator<int>(change_versions_.size()),
+                               changed.begin(),
+                               changed_since_functor(thrust::raw_pointer_cast(change_versions_.data()),
+                                                     since_version));
+    changed.resize(thrust::distance(changed.begin(), end));
+    delta.indices_.resize(changed.size());
+    delta.prob_log_q_.resize(changed.size());
+    thrust::transform(changed.begin(), changed.end(),
+                      make_tuple_begin(delta.indices_, delta.prob_log_q_),
+                      encode_delta_voxel_functor(thrust::raw_pointer_cast(voxels_.data()),
+                                                 resolution_, ring_offset_));
+    return delta;
+}
+
+OccupancyGrid& OccupancyGrid::ApplyDelta(const OccupancyGridDelta& delta) {
+    if (delta.resolution_ != resolution_ || delta.voxel_size_ != voxel_size_ ||
+        delta.indices_.size() != delta.prob_log_q_.size()) {
+        utility::LogError(
+            "[OccupancyGrid] the delta does not match the voxel size and resolution of the grid.");
+        return *this;
+    }
+    if (delta.reset_) {
+        ++version_;
+        if (IsChangeTrackingEnabled()) {
+            const unsigned int version = version_;
+            thrust::transform(voxels_.begin(), voxels_.end(), change_versions_.begin(),
+                              change_versions_.begin(),
+                              [version] __device__ (const CompactOccupancyVoxel& v,
+                                                    unsigned int stamp) {
+                                  return (v.IsUnknown()) ? stamp : version;
+                              });
+        }
+        thrust::fill(voxels_.begin(), voxels_.end(), CompactOccupancyVoxel());
+        min_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+        max_bound_ = Eigen::Vector3ui16::Constant(resolution_ / 2);
+    }
+    MoveOrigin(delta.origin_);
+    if (delta.indices_.empty()) return *this;
+    ++version_;
+    thrust::for_each(make_tuple_begin(delta.indices_, delta.prob_log_q_),
+                     make_tuple_end(delta.indices_, delta.prob_log_q_),
+                     apply_delta_voxel_functor(thrust::raw_pointer_cast(voxels_.data()),
+                                               resolution_, ring_offset_,
+                                               MakeChangeRecorder(*this)));
+    const auto init = thrust::make_tuple(Eigen::Vector3i::Constant(resolution_).eval(),
+                                         Eigen::Vector3i::Constant(-1).eval());
+    const auto bounds = thrust::transform_reduce(
+            make_tuple_begin(delta.indices_, delta.prob_log_q_),
+            make_tuple_end(delta.indices_, delta.prob_log_q_),
+            delta_voxel_bounds_functor(resolution_), init, merge_bounds_functor());
+    if (thrust::get<1>(bounds)[0] >= 0) {
+        min_bound_ = min_bound_.array().min(thrust::get<0>(bounds).cast<unsigned short>().array());
+        max_bound_ = max_bound_.array().max(thrust::get<1>(bounds).cast<unsigned short>().array());
+    }
+    return *this;
+}
+
+std::vector<uint8_t> OccupancyGridDelta::Serialize() const {
+    delta_header header;
+    std::copy(kDeltaMagic, kDeltaMagic + 4, header.magic_);
+    header.from_version_ = from_version_;
+    header.to_version_ = to_version_;
+    header.reset_ = reset_;
+    header.voxel_size_ = voxel_size_;
+    header.resolution_ = resolution_;
+    Eigen::Map<Eigen::Vector3f>(header.origin_) = origin_;
+    header.n_voxels_ = indices_.size();
+    const size_t n = indices_.size();
+    std::vector<uint8_t> data(sizeof(delta_header) +
+                              n * (sizeof(unsigned int) + sizeof(int16_t)));
+    std::memcpy(data.data(), &header, sizeof(delta_header));
+    uint8_t* indices = data.data() + sizeof(delta_header);
+    uint8_t* values = indices + n * sizeof(unsigned int);
+    if (n > 0) {
+        cudaSafeCall(cudaMemcpy(indices, thrust::raw_pointer_cast(indices_.data()),
+                                n * sizeof(unsigned int), cudaMemcpyDeviceToHost));
+        cudaSafeCall(cudaMemcpy(values, thrust::raw_pointer_cast(prob_log_q_.data()),
+                                n * sizeof(int16_t), cudaMemcpyDeviceToHost));
+    }
+    return data;
+}
+
+bool OccupancyGridDelta::Deserialize(const std::vector<uint8_t>& data) {
+    delta_header header;
+    if (data.size() < sizeof(delta_header)) return false;
+    std::memcpy(&header, data.data(), sizeof(delta_header));
+    if (!std::equal(kDeltaMagic, kDeltaMagic + 4, header.magic_)) return false;
+    const size_t n = header.n_voxels_;
+    if (data.size() != sizeof(delta_header) + n * (sizeof(unsigned int) + sizeof(int16_t))) {
+        return false;
+    }
+    from_version_ = header.from_version_;
+    to_version_ = header.to_version_;
+    reset_ = header.reset_ != 0;
+    voxel_size_ = header.voxel_size_;
+    resolution_ = header.resolution_;
+    origin_ = Eigen::Map<const Eigen::Vector3f>(header.origin_);
+    const uint8_t* indices = data.data() + sizeof(delta_header);
+    const uint8_t* values = indices + n * sizeof(unsigned int);
+    indices_.resize(n);
+    prob_log_q_.resize(n);
+    if (n > 0) {
+        cudaSafeCall(cudaMemcpy(thrust::raw_pointer_cast(indices_.data()), indices,
+                                n * sizeof(unsigned int), cudaMemcpyHostToDevice));
+        cudaSafeCall(cudaMemcpy(thrust::raw_pointer_cast(prob_log_q_.data()), values,
+                                n * sizeof(int16_t), cudaMemcpyHostToDevice));
+    }
+    return true;
+}
+
+}
 }
-}
\ No newline at end of file
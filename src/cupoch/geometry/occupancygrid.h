@@ -1,5 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <vector>
+
 #include "cupoch/geometry/densegrid.h"
+#include "cupoch/utility/eigen.h"
 
 namespace cupoch {
 
@@ -33,7 +37,72 @@ inline OccupancyVoxel operator+(const OccupancyVoxel &lhs, const OccupancyVoxel&
     return out;
 }
 
-class OccupancyGrid : public DenseGrid<OccupancyVoxel> {
+/// Voxel as stored by OccupancyGrid: the grid index is implied by the
+/// position in the grid and the log odds are quantized to int16 in steps of
+/// kProbLogResolution, 2 bytes instead of the 20 of OccupancyVoxel.
+class CompactOccupancyVoxel {
+public:
+    static constexpr float kProbLogResolution = 1.0f / 1024.0f;
+    static constexpr int16_t kUnknown = -32768;
+
+    __host__ __device__ CompactOccupancyVoxel() {}
+    __host__ __device__ CompactOccupancyVoxel(int16_t prob_log_q)
+        : prob_log_q_(prob_log_q) {}
+    __host__ __device__ ~CompactOccupancyVoxel() {}
+
+    __host__ __device__ static int16_t Quantize(float prob_log) {
+        float q = prob_log / kProbLogResolution;
+        q = (q < -32767.0f) ? -32767.0f : ((q > 32767.0f) ? 32767.0f : q);
+        return (int16_t)((q < 0) ? q - 0.5f : q + 0.5f);
+    }
+    __host__ __device__ bool IsUnknown() const {
+        return prob_log_q_ == kUnknown;
+    }
+    /// NaN for the unknown voxels, like OccupancyVoxel::prob_log_.
+    __host__ __device__ float GetProbLog() const {
+        return IsUnknown() ? std::numeric_limits<float>::quiet_NaN()
+                           : prob_log_q_ * kProbLogResolution;
+    }
+
+public:
+    int16_t prob_log_q_ = kUnknown;
+};
+
+/// Voxels of an OccupancyGrid whose state, unknown, free or occupied,
+/// changed since a version, as given by OccupancyGrid::ExportDelta() and
+/// applied to another grid of the same voxel size and resolution by
+/// OccupancyGrid::ApplyDelta(), e.g. to stream a map between robots. A
+/// voxel takes 6 bytes: its grid index and its quantized log odds.
+class OccupancyGridDelta {
+public:
+    size_t GetNumVoxels() const { return indices_.size(); }
+    /// Byte stream of the delta in host byte order.
+    std::vector<uint8_t> Serialize() const;
+    /// Returns false, leaving the delta unchanged, if \p data is not a
+    /// stream of Serialize().
+    bool Deserialize(const std::vector<uint8_t> &data);
+
+public:
+    unsigned int from_version_ = 0;
+    unsigned int to_version_ = 0;
+    /// The grid was cleared after from_version_: the receiver discards its
+    /// voxels before applying the delta.
+    bool reset_ = false;
+    float voxel_size_ = 0.0;
+    int resolution_ = 0;
+    /// Origin of the grid at to_version_, which the receiver moves to.
+    Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    /// Grid indices (x * resolution_ + y) * resolution_ + z.
+    utility::device_vector<unsigned int> indices_;
+    /// CompactOccupancyVoxel::prob_log_q_ of the voxels, kUnknown for the
+    /// voxels that became unknown.
+    utility::device_vector<int16_t> prob_log_q_;
+};
+
+/// Dense occupancy map. The voxels are stored as CompactOccupancyVoxel and
+/// returned as OccupancyVoxel by the queries and the extraction functions,
+/// with the default color.
+class OccupancyGrid : public DenseGrid<CompactOccupancyVoxel> {
 public:
     OccupancyGrid();
     OccupancyGrid(float voxel_size, int resolution = 512, const Eigen::Vector3f& origin = Eigen::Vector3f::Zero());
@@ -56,9 +125,42 @@ public:
     std::shared_ptr<utility::device_vector<OccupancyVoxel>> ExtractKnownVoxels() const;
     std::shared_ptr<utility::device_vector<OccupancyVoxel>> ExtractFreeVoxels() const;
     std::shared_ptr<utility::device_vector<OccupancyVoxel>> ExtractOccupiedVoxels() const;
+    /// Frontiers for exploration: the free voxels in the bounds with an
+    /// unknown face neighbor.
+    std::shared_ptr<utility::device_vector<OccupancyVoxel>> ExtractFrontierVoxels() const;
+    /// Clusters of 26 connected voxels of \p frontiers, as given by
+    /// ExtractFrontierVoxels(), computed by Graph::ConnectedComponents() on
+    /// the device. Returns the cluster index of each voxel, numbered from 0,
+    /// or -1 for the voxels of the clusters smaller than
+    /// \p min_cluster_size.
+    utility::device_vector<int> ClusterFrontierVoxels(const utility::device_vector<OccupancyVoxel>& frontiers,
+                                                      int min_cluster_size = 1) const;
+    /// Information gain of candidate views: the number of unknown voxels
+    /// crossed by the rays of each view before they hit an occupied voxel,
+    /// leave the grid or reach \p max_range. The rays of a view are
+    /// \p ray_directions, in the sensor frame, rotated and translated by its
+    /// pose in \p view_poses. All the rays of all the views are walked in
+    /// one launch, one thread per ray.
+    utility::device_vector<int> ComputeInformationGain(const utility::device_vector<Eigen::Matrix4f_u>& view_poses,
+                                                       const utility::device_vector<Eigen::Vector3f>& ray_directions,
+                                                       float max_range) const;
 
     OccupancyGrid& Reconstruct(float voxel_size, int resolution);
 
+    /// View with the circular buffer offset, see ring_offset_.
+    DenseGridView<CompactOccupancyVoxel> GetView() const override;
+
+    /// Moves the grid to \p origin, rounded to whole voxels, keeping the
+    /// voxels that stay inside. The storage is a circular buffer, so only
+    /// the slabs that scroll in are cleared, e.g. to keep a local map
+    /// centered on a robot.
+    OccupancyGrid& MoveOrigin(const Eigen::Vector3f& origin);
+
+    /// Integrates a scan: the voxel of every point gets one hit, and the
+    /// voxels crossed by the rays from \p viewpoint get one miss, once per
+    /// scan however many rays cross them. The rays are walked voxel by
+    /// voxel on the device, so the temporaries are proportional to the
+    /// number of points instead of to the length of the rays.
     OccupancyGrid& Insert(const utility::device_vector<Eigen::Vector3f>& points,
                           const Eigen::Vector3f& viewpoint, float max_range = -1.0);
     OccupancyGrid& Insert(const thrust::host_vector<Eigen::Vector3f>& points,
@@ -68,6 +170,24 @@ public:
 
     OccupancyGrid& AddVoxel(const Eigen::Vector3i& voxels, bool occupied = false);
     OccupancyGrid& AddVoxels(const utility::device_vector<Eigen::Vector3i>& voxels, bool occupied = false);
+
+    /// Starts recording the version at which the state of each voxel last
+    /// changed, one 32 bit stamp per voxel. The voxels known at this point
+    /// are stamped, so that ExportDelta(0) holds the whole map. Clear()
+    /// stops the tracking.
+    OccupancyGrid& EnableChangeTracking();
+    OccupancyGrid& DisableChangeTracking();
+    bool IsChangeTrackingEnabled() const { return !change_versions_.empty(); }
+    /// Incremented by every update of the voxels.
+    unsigned int GetVersion() const { return version_; }
+    /// Voxels whose state changed after \p since_version, with their log
+    /// odds at GetVersion(). A receiver that applied the delta up to
+    /// version v asks for ExportDelta(v) next. Only the state changes are
+    /// sent, so the log odds of the voxels of the receiver may lag behind
+    /// while their states match.
+    OccupancyGridDelta ExportDelta(unsigned int since_version) const;
+    /// Moves the grid to the origin of \p delta and overwrites its voxels.
+    OccupancyGrid& ApplyDelta(const OccupancyGridDelta& delta);
 public:
     Eigen::Vector3ui16 min_bound_ = Eigen::Vector3ui16::Zero();
     Eigen::Vector3ui16 max_bound_ = Eigen::Vector3ui16::Zero();
@@ -77,6 +197,27 @@ public:
     float prob_miss_log_ = -0.4;
     float occ_prob_thres_log_ = 0.0;
     bool visualize_free_area_ = true;
+    /// Circular buffer offset: the voxel of grid index v is stored at
+    /// IndexOf((v + ring_offset_) % resolution_). Changed by MoveOrigin().
+    Eigen::Vector3i ring_offset_ = Eigen::Vector3i::Zero();
+    /// Version at which the state of each voxel last changed, in storage
+    /// order, empty unless change tracking is enabled.
+    utility::device_vector<unsigned int> change_versions_;
+    unsigned int version_ = 0;
+    /// Version of the last Reconstruct() or reset of MoveOrigin(), before
+    /// which the deltas cannot be exported.
+    unsigned int reset_version_ = 0;
+
+private:
+    /// Storage index of the voxel of \p point, -1 outside of the grid.
+    int GetRingIndex(const Eigen::Vector3f &point) const;
+    /// Known voxels in the bounds, keeping the free and/or occupied ones.
+    std::shared_ptr<utility::device_vector<OccupancyVoxel>> ExtractVoxels(
+            bool free, bool occupied) const;
+
+    /// One bit per voxel, set by the first update of the voxel in the
+    /// current Insert(). Allocated by the first Insert().
+    utility::device_vector<unsigned int> scan_flags_;
 };
 
 }
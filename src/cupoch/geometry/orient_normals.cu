@@ -0,0 +1,164 @@
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/scatter.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/unique.h>
+
+#include "cupoch/geometry/graph.h"
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct knn_to_edge_functor {
+    knn_to_edge_functor(const int *indices, int knn)
+        : indices_(indices), knn_(knn){};
+    const int *indices_;
+    const int knn_;
+    __device__ Eigen::Vector2i operator()(int idx) const {
+        const int i = idx / knn_;
+        const int j = indices_[idx];
+        if (j < 0 || j == i) return Eigen::Vector2i(-1, -1);
+        return (i < j) ? Eigen::Vector2i(i, j) : Eigen::Vector2i(j, i);
+    }
+};
+
+// Weight of Hoppe et al., small for the neighbors of parallel normals.
+struct tangent_plane_weight_functor {
+    tangent_plane_weight_functor(const Eigen::Vector3f *normals)
+        : normals_(normals){};
+    const Eigen::Vector3f *normals_;
+    __device__ float operator()(const Eigen::Vector2i &e) const {
+        return fmaxf(1.0f - fabsf(normals_[e[0]].dot(normals_[e[1]])), 0.0f);
+    }
+};
+
+struct is_root_functor {
+    is_root_functor(const int *labels) : labels_(labels){};
+    const int *labels_;
+    __device__ bool operator()(int i) const { return labels_[i] == i; }
+};
+
+// Each vertex of the frontier fixes the sign of its unvisited tree
+// neighbors. The neighbors have no other visited neighbor in a tree, so no
+// two threads write the same vertex.
+struct propagate_orientation_functor {
+    propagate_orientation_functor(const int *frontier,
+                                  const int *offsets,
+                                  const Eigen::Vector2i *lines,
+                                  int *visited,
+                                  Eigen::Vector3f *normals,
+                                  int *next,
+                                  int *n_next)
+        : frontier_(frontier),
+          offsets_(offsets),
+          lines_(lines),
+          visited_(visited),
+          normals_(normals),
+          next_(next),
+          n_next_(n_next){};
+    const int *frontier_;
+    const int *offsets_;
+    const Eigen::Vector2i *lines_;
+    int *visited_;
+    Eigen::Vector3f *normals_;
+    int *next_;
+    int *n_next_;
+    __device__ void operator()(int idx) const {
+        const int i = frontier_[idx];
+        for (int k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+            const int j = lines_[k][1];
+            if (visited_[j]) continue;
+            visited_[j] = 1;
+            if (normals_[i].dot(normals_[j]) < 0.0f) normals_[j] = -normals_[j];
+            next_[atomicAdd(n_next_, 1)] = j;
+        }
+    }
+};
+
+}  // namespace
+
+bool PointCloud::OrientNormalsConsistentTangentPlane(size_t k) {
+    CUPOCH_PROFILE("PointCloud::OrientNormalsConsistentTangentPlane");
+    if (HasNormals() == false) {
+        utility::LogWarning(
+                "[OrientNormalsConsistentTangentPlane] No normals in the "
+                "PointCloud. Call EstimateNormals() first.\n");
+        return false;
+    }
+    const int n_pt = points_.size();
+    if (n_pt < 2 || k < 1) return true;
+
+    // Riemannian graph of the k nearest neighbors.
+    const int knn = std::min<int>(k + 1, n_pt);
+    KDTreeFlann kdtree(*this);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    kdtree.SearchKNN(points_, knn, indices, distance2);
+    utility::device_vector<Eigen::Vector2i> edges(indices.size());
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(indices.size()),
+                      edges.begin(),
+                      knn_to_edge_functor(
+                              thrust::raw_pointer_cast(indices.data()), knn));
+    thrust::sort(edges.begin(), edges.end());
+    edges.erase(thrust::unique(edges.begin(), edges.end()), edges.end());
+    if (!edges.empty() && Eigen::Vector2i(edges[0]) == Eigen::Vector2i(-1, -1)) {
+        edges.erase(edges.begin());
+    }
+    const int n_edges = edges.size();
+    if (n_edges == 0) return true;
+    utility::device_vector<float> weights(n_edges);
+    thrust::transform(edges.begin(), edges.end(), weights.begin(),
+                      tangent_plane_weight_functor(
+                              thrust::raw_pointer_cast(normals_.data())));
+
+    Graph graph(points_);
+    graph.AddEdges(edges, weights);
+    auto tree = graph.MinimumSpanningTree();
+    if (tree->lines_.empty()) return true;
+
+    // One BFS from the root of each tree, the node labelling its component.
+    const utility::device_vector<int> labels = tree->ConnectedComponents();
+    utility::device_vector<int> frontier(n_pt);
+    auto frontier_end = thrust::copy_if(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(n_pt), frontier.begin(),
+            is_root_functor(thrust::raw_pointer_cast(labels.data())));
+    int n_frontier = thrust::distance(frontier.begin(), frontier_end);
+    utility::device_vector<int> visited(n_pt, 0);
+    thrust::scatter(thrust::make_constant_iterator(1),
+                    thrust::make_constant_iterator(1) + n_frontier,
+                    frontier.begin(), visited.begin());
+    utility::device_vector<int> next(n_pt);
+    utility::device_vector<int> counter(1);
+    while (n_frontier > 0) {
+        counter[0] = 0;
+        thrust::for_each(
+                thrust::make_counting_iterator(0),
+                thrust::make_counting_iterator(n_frontier),
+                propagate_orientation_functor(
+                        thrust::raw_pointer_cast(frontier.data()),
+                        thrust::raw_pointer_cast(
+                                tree->edge_index_offsets_.data()),
+                        thrust::raw_pointer_cast(tree->lines_.data()),
+                        thrust::raw_pointer_cast(visited.data()),
+                        thrust::raw_pointer_cast(normals_.data()),
+                        thrust::raw_pointer_cast(next.data()),
+                        thrust::raw_pointer_cast(counter.data())));
+        n_frontier = counter[0];
+        frontier.swap(next);
+    }
+    return true;
+}
@@ -1,4 +1,8 @@
 #include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/scatter.h>
+
+#include <algorithm>
 
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/geometry/boundingvolume.h"
@@ -7,6 +11,7 @@
 #include "cupoch/utility/console.h"
 #include "cupoch/utility/helper.h"
 #include "cupoch/utility/platform.h"
+#include "cupoch/utility/range.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -31,6 +36,72 @@ struct check_nan_functor {
     }
 };
 
+struct insert_attribute_functor {
+    insert_attribute_functor(const float *src,
+                             const float *values,
+                             float *dst,
+                             int src_dim,
+                             int channel)
+        : src_(src),
+          values_(values),
+          dst_(dst),
+          src_dim_(src_dim),
+          channel_(channel){};
+    const float *src_;
+    const float *values_;
+    float *dst_;
+    const int src_dim_;
+    const int channel_;
+    __device__ void operator()(size_t idx) {
+        const int dst_dim = src_dim_ + 1;
+        for (int j = 0; j < src_dim_; ++j) {
+            dst_[idx * dst_dim + j] = src_[idx * src_dim_ + j];
+        }
+        dst_[idx * dst_dim + channel_] = values_[idx];
+    }
+};
+
+struct attribute_mask_functor {
+    attribute_mask_functor(const bool *mask, int dim)
+        : mask_(mask), dim_(dim){};
+    const bool *mask_;
+    const int dim_;
+    __device__ bool operator()(size_t idx) const { return mask_[idx / dim_]; }
+};
+
+template <typename T>
+void CompactByMask(cudaStream_t stream,
+                   utility::device_vector<T> &values,
+                   const utility::device_vector<bool> &mask,
+                   bool invert) {
+    auto end = thrust::remove_if(
+            utility::exec_policy(stream)->on(stream), values.begin(),
+            values.end(), mask.begin(),
+            [invert] __device__(bool m) { return m == invert; });
+    values.resize(thrust::distance(values.begin(), end));
+}
+
+PointCloud &CropInPlaceImpl(utility::ExecutionContext &ctx,
+                            PointCloud &pcd,
+                            const utility::device_vector<size_t> &indices) {
+    cudaStream_t stream = ctx.GetStream();
+    utility::device_vector<bool> mask(pcd.points_.size(), false);
+    thrust::scatter(utility::exec_policy(stream)->on(stream),
+                    thrust::make_constant_iterator(true),
+                    thrust::make_constant_iterator(true) + indices.size(),
+                    indices.begin(), mask.begin());
+    return pcd.SelectByMaskInPlace(ctx, mask);
+}
+
+// Resizes to n, growing the capacity at least twofold when it is exceeded,
+// so that appending frames one by one copies each point O(1) times on
+// average.
+template <typename T>
+void GrowAndResize(utility::device_vector<T> &vec, size_t n) {
+    if (n > vec.capacity()) vec.reserve(std::max(n, 2 * vec.capacity()));
+    vec.resize(n);
+}
+
 }  // namespace
 
 PointCloud::PointCloud() : Geometry3D(Geometry::GeometryType::PointCloud) {}
@@ -42,7 +113,17 @@ PointCloud::PointCloud(const PointCloud &other)
     : Geometry3D(Geometry::GeometryType::PointCloud),
       points_(other.points_),
       normals_(other.normals_),
-      colors_(other.colors_) {}
+      colors_(other.colors_),
+      attributes_(other.attributes_),
+      attribute_names_(other.attribute_names_) {}
+
+PointCloud::PointCloud(PointCloud &&other)
+    : Geometry3D(Geometry::GeometryType::PointCloud),
+      points_(std::move(other.points_)),
+      normals_(std::move(other.normals_)),
+      colors_(std::move(other.colors_)),
+      attributes_(std::move(other.attributes_)),
+      attribute_names_(std::move(other.attribute_names_)) {}
 
 PointCloud::~PointCloud() {}
 
@@ -50,41 +131,131 @@ PointCloud &PointCloud::operator=(const PointCloud &other) {
     points_ = other.points_;
     normals_ = other.normals_;
     colors_ = other.colors_;
+    attributes_ = other.attributes_;
+    attribute_names_ = other.attribute_names_;
+    return *this;
+}
+
+PointCloud &PointCloud::operator=(PointCloud &&other) {
+    points_ = std::move(other.points_);
+    normals_ = std::move(other.normals_);
+    colors_ = std::move(other.colors_);
+    attributes_ = std::move(other.attributes_);
+    attribute_names_ = std::move(other.attribute_names_);
     return *this;
 }
 
 void PointCloud::SetPoints(const thrust::host_vector<Eigen::Vector3f> &points) {
-    points_ = points;
+    points_mirror_.Upload(points, points_);
 }
 
 thrust::host_vector<Eigen::Vector3f> PointCloud::GetPoints() const {
-    thrust::host_vector<Eigen::Vector3f> points = points_;
-    return points;
+    return points_mirror_.Download(points_);
+}
+
+void PointCloud::GetPoints(utility::pinned_host_vector<Eigen::Vector3f> &points,
+                           cudaStream_t stream) const {
+    utility::CopyToHostAsync(points_, points, stream);
 }
 
 void PointCloud::SetNormals(
         const thrust::host_vector<Eigen::Vector3f> &normals) {
-    normals_ = normals;
+    normals_mirror_.Upload(normals, normals_);
 }
 
 thrust::host_vector<Eigen::Vector3f> PointCloud::GetNormals() const {
-    thrust::host_vector<Eigen::Vector3f> normals = normals_;
-    return normals;
+    return normals_mirror_.Download(normals_);
+}
+
+void PointCloud::GetNormals(
+        utility::pinned_host_vector<Eigen::Vector3f> &normals,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(normals_, normals, stream);
 }
 
 void PointCloud::SetColors(const thrust::host_vector<Eigen::Vector3f> &colors) {
-    colors_ = colors;
+    colors_mirror_.Upload(colors, colors_);
 }
 
 thrust::host_vector<Eigen::Vector3f> PointCloud::GetColors() const {
-    thrust::host_vector<Eigen::Vector3f> colors = colors_;
-    return colors;
+    return colors_mirror_.Download(colors_);
+}
+
+void PointCloud::GetColors(utility::pinned_host_vector<Eigen::Vector3f> &colors,
+                           cudaStream_t stream) const {
+    utility::CopyToHostAsync(colors_, colors, stream);
+}
+
+void PointCloud::SetAttribute(const std::string &name,
+                              const thrust::host_vector<float> &values) {
+    utility::device_vector<float> values_dv = values;
+    SetAttribute(name, values_dv);
+}
+
+void PointCloud::SetAttribute(const std::string &name,
+                              const utility::device_vector<float> &values) {
+    if (values.size() != points_.size()) {
+        utility::LogError(
+                "[SetAttribute] The number of values must match the number "
+                "of points.");
+        return;
+    }
+    const int n_dim = attribute_names_.size();
+    const int channel = GetAttributeIndex(name);
+    if (channel >= 0) {
+        thrust::strided_range<utility::device_vector<float>::iterator> column(
+                attributes_.begin() + channel, attributes_.end(), n_dim);
+        thrust::copy(values.begin(), values.end(), column.begin());
+        return;
+    }
+    if (!HasAttributes()) attribute_names_.clear();
+    const int src_dim = attribute_names_.size();
+    utility::device_vector<float> new_attributes(points_.size() *
+                                                 (src_dim + 1));
+    insert_attribute_functor func(thrust::raw_pointer_cast(attributes_.data()),
+                                  thrust::raw_pointer_cast(values.data()),
+                                  thrust::raw_pointer_cast(new_attributes.data()),
+                                  src_dim, src_dim);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(points_.size()), func);
+    attributes_.swap(new_attributes);
+    attribute_names_.push_back(name);
+}
+
+thrust::host_vector<float> PointCloud::GetAttribute(
+        const std::string &name) const {
+    const int channel = GetAttributeIndex(name);
+    if (channel < 0 || !HasAttributes()) {
+        utility::LogWarning("[GetAttribute] Attribute {} is not found.", name);
+        return thrust::host_vector<float>();
+    }
+    thrust::strided_range<utility::device_vector<float>::const_iterator>
+            column(attributes_.begin() + channel, attributes_.end(),
+                   attribute_names_.size());
+    utility::device_vector<float> values(points_.size());
+    thrust::copy(column.begin(), column.end(), values.begin());
+    thrust::host_vector<float> h_values = values;
+    return h_values;
+}
+
+int PointCloud::GetAttributeIndex(const std::string &name) const {
+    for (size_t i = 0; i < attribute_names_.size(); ++i) {
+        if (attribute_names_[i] == name) return i;
+    }
+    return -1;
+}
+
+PointCloud &PointCloud::ClearAttributes() {
+    attributes_.clear();
+    attribute_names_.clear();
+    return *this;
 }
 
 PointCloud &PointCloud::Clear() {
     points_.clear();
     normals_.clear();
     colors_.clear();
+    ClearAttributes();
     return *this;
 }
 
@@ -104,6 +275,12 @@ AxisAlignedBoundingBox PointCloud::GetAxisAlignedBoundingBox() const {
     return AxisAlignedBoundingBox::CreateFromPoints(points_);
 }
 
+std::tuple<Eigen::Vector3f, Eigen::Matrix3f>
+PointCloud::ComputeMeanAndCovariance() const {
+    const PointStatistics stats = ComputePointStatistics(points_, true);
+    return std::make_tuple(stats.mean_, stats.covariance_);
+}
+
 PointCloud &PointCloud::Translate(const Eigen::Vector3f &translation,
                                   bool relative) {
     TranslatePoints(translation, points_, relative);
@@ -118,39 +295,78 @@ PointCloud &PointCloud::Scale(const float scale, bool center) {
 PointCloud &PointCloud::Rotate(const Eigen::Matrix3f &R, bool center) {
     RotatePoints(utility::GetStream(0), R, points_, center);
     RotateNormals(utility::GetStream(1), R, normals_);
-    cudaSafeCall(cudaDeviceSynchronize());
+    utility::SynchronizeStreams(2);
     return *this;
 }
 
 PointCloud &PointCloud::operator+=(const PointCloud &cloud) {
     // We do not use std::vector::insert to combine std::vector because it will
-    // crash if the pointcloud is added to itself.
+    // crash if the pointcloud is added to itself. For the same reason the
+    // source ranges are bounded by the sizes taken before the resizes.
     if (cloud.IsEmpty()) return (*this);
     size_t old_vert_num = points_.size();
     size_t add_vert_num = cloud.points_.size();
     size_t new_vert_num = old_vert_num + add_vert_num;
     if ((!HasPoints() || HasNormals()) && cloud.HasNormals()) {
-        normals_.resize(new_vert_num);
+        GrowAndResize(normals_, new_vert_num);
         thrust::copy(cloud.normals_.begin(),
-                     cloud.normals_.end(),
+                     cloud.normals_.begin() + add_vert_num,
                      normals_.begin() + old_vert_num);
     } else {
         normals_.clear();
     }
     if ((!HasPoints() || HasColors()) && cloud.HasColors()) {
-        colors_.resize(new_vert_num);
+        GrowAndResize(colors_, new_vert_num);
         thrust::copy(cloud.colors_.begin(),
-                     cloud.colors_.end(),
+                     cloud.colors_.begin() + add_vert_num,
                      colors_.begin() + old_vert_num);
     } else {
         colors_.clear();
     }
-    points_.resize(new_vert_num);
-    thrust::copy(cloud.points_.begin(), cloud.points_.end(),
+    if ((!HasPoints() || HasAttributes()) && cloud.HasAttributes() &&
+        (!HasPoints() || attribute_names_ == cloud.attribute_names_)) {
+        const size_t dim = cloud.attribute_names_.size();
+        GrowAndResize(attributes_, new_vert_num * dim);
+        thrust::copy(cloud.attributes_.begin(),
+                     cloud.attributes_.begin() + add_vert_num * dim,
+                     attributes_.begin() + old_vert_num * dim);
+        attribute_names_ = cloud.attribute_names_;
+    } else {
+        ClearAttributes();
+    }
+    GrowAndResize(points_, new_vert_num);
+    thrust::copy(cloud.points_.begin(), cloud.points_.begin() + add_vert_num,
                  points_.begin() + old_vert_num);
     return (*this);
 }
 
+PointCloud &PointCloud::Append(
+        const std::vector<std::shared_ptr<PointCloud>> &clouds) {
+    // One reservation for all the clouds, then the same rules as operator+=.
+    size_t n_total = points_.size();
+    for (const auto &cloud : clouds) n_total += cloud->points_.size();
+    if (n_total == points_.size()) return *this;
+    const PointCloud *first = (HasPoints()) ? this : nullptr;
+    for (const auto &cloud : clouds) {
+        if (!first && cloud->HasPoints()) first = cloud.get();
+    }
+    Reserve(n_total, first->HasNormals(), first->HasColors(),
+            first->attribute_names_.size());
+    for (const auto &cloud : clouds) *this += *cloud;
+    return *this;
+}
+
+PointCloud &PointCloud::Reserve(size_t n_points,
+                                bool normals,
+                                bool colors,
+                                size_t attribute_dim) {
+    points_.reserve(n_points);
+    if (normals) normals_.reserve(n_points);
+    if (colors) colors_.reserve(n_points);
+    if (attribute_dim > 0) attributes_.reserve(n_points * attribute_dim);
+    return *this;
+}
+
 PointCloud PointCloud::operator+(const PointCloud &cloud) const {
     return (PointCloud(*this) += cloud);
 }
@@ -169,28 +385,114 @@ PointCloud &PointCloud::PaintUniformColor(const Eigen::Vector3f &color) {
 PointCloud &PointCloud::Transform(const Eigen::Matrix4f &transformation) {
     TransformPoints(utility::GetStream(0), transformation, points_);
     TransformNormals(utility::GetStream(1), transformation, normals_);
-    cudaSafeCall(cudaDeviceSynchronize());
+    utility::SynchronizeStreams(2);
+    return *this;
+}
+
+PointCloud &PointCloud::Transform(utility::ExecutionContext &ctx,
+                                  const Eigen::Matrix4f &transformation) {
+    TransformPoints(ctx.GetStream(), transformation, points_);
+    TransformNormals(ctx.GetStream(), transformation, normals_);
+    ctx.Synchronize();
     return *this;
 }
 
 std::shared_ptr<PointCloud> PointCloud::Crop(
         const AxisAlignedBoundingBox &bbox) const {
+    return Crop(utility::ExecutionContext::Default(), bbox);
+}
+
+std::shared_ptr<PointCloud> PointCloud::Crop(
+        utility::ExecutionContext &ctx,
+        const AxisAlignedBoundingBox &bbox) const {
     if (bbox.IsEmpty()) {
         utility::LogError(
                 "[CropPointCloud] AxisAlignedBoundingBox either has zeros "
                 "size, or has wrong bounds.");
     }
-    return SelectByIndex(bbox.GetPointIndicesWithinBoundingBox(points_));
+    return SelectByIndex(ctx, bbox.GetPointIndicesWithinBoundingBox(points_));
+}
+
+std::shared_ptr<PointCloud> PointCloud::Crop(
+        const OrientedBoundingBox &bbox) const {
+    return Crop(utility::ExecutionContext::Default(), bbox);
 }
 
 std::shared_ptr<PointCloud> PointCloud::Crop(
+        utility::ExecutionContext &ctx,
         const OrientedBoundingBox &bbox) const {
     if (bbox.IsEmpty()) {
         utility::LogError(
                 "[CropPointCloud] AxisAlignedBoundingBox either has zeros "
                 "size, or has wrong bounds.");
     }
-    return SelectByIndex(bbox.GetPointIndicesWithinBoundingBox(points_));
+    return SelectByIndex(ctx, bbox.GetPointIndicesWithinBoundingBox(points_));
+}
+
+PointCloud &PointCloud::CropInPlace(const AxisAlignedBoundingBox &bbox) {
+    return CropInPlace(utility::ExecutionContext::Default(), bbox);
+}
+
+PointCloud &PointCloud::CropInPlace(utility::ExecutionContext &ctx,
+                                    const AxisAlignedBoundingBox &bbox) {
+    if (bbox.IsEmpty()) {
+        utility::LogError(
+                "[CropInPlace] AxisAlignedBoundingBox either has zeros "
+                "size, or has wrong bounds.");
+    }
+    return CropInPlaceImpl(ctx, *this,
+                           bbox.GetPointIndicesWithinBoundingBox(points_));
+}
+
+PointCloud &PointCloud::CropInPlace(const OrientedBoundingBox &bbox) {
+    return CropInPlace(utility::ExecutionContext::Default(), bbox);
+}
+
+PointCloud &PointCloud::CropInPlace(utility::ExecutionContext &ctx,
+                                    const OrientedBoundingBox &bbox) {
+    if (bbox.IsEmpty()) {
+        utility::LogError(
+                "[CropInPlace] OrientedBoundingBox either has zeros "
+                "size, or has wrong bounds.");
+    }
+    return CropInPlaceImpl(ctx, *this,
+                           bbox.GetPointIndicesWithinBoundingBox(points_));
+}
+
+PointCloud &PointCloud::SelectByMaskInPlace(
+        const utility::device_vector<bool> &mask, bool invert) {
+    return SelectByMaskInPlace(utility::ExecutionContext::Default(), mask,
+                               invert);
+}
+
+PointCloud &PointCloud::SelectByMaskInPlace(
+        utility::ExecutionContext &ctx,
+        const utility::device_vector<bool> &mask,
+        bool invert) {
+    if (mask.size() != points_.size()) {
+        utility::LogError(
+                "[SelectByMaskInPlace] The mask size {:d} does not match the "
+                "number of points {:d}.",
+                mask.size(), points_.size());
+    }
+    cudaStream_t stream = ctx.GetStream();
+    if (HasAttributes()) {
+        const int dim = GetAttributeDimension();
+        auto stencil = thrust::make_transform_iterator(
+                thrust::make_counting_iterator<size_t>(0),
+                attribute_mask_functor(thrust::raw_pointer_cast(mask.data()),
+                                       dim));
+        auto end = thrust::remove_if(
+                utility::exec_policy(stream)->on(stream), attributes_.begin(),
+                attributes_.end(), stencil,
+                [invert] __device__(bool m) { return m == invert; });
+        attributes_.resize(thrust::distance(attributes_.begin(), end));
+    }
+    if (HasNormals()) CompactByMask(stream, normals_, mask, invert);
+    if (HasColors()) CompactByMask(stream, colors_, mask, invert);
+    CompactByMask(stream, points_, mask, invert);
+    ctx.Synchronize();
+    return *this;
 }
 
 PointCloud &PointCloud::RemoveNoneFinitePoints(bool remove_nan,
@@ -199,7 +501,20 @@ PointCloud &PointCloud::RemoveNoneFinitePoints(bool remove_nan,
     bool has_color = HasColors();
     size_t old_point_num = points_.size();
     size_t k = 0;
-    if (!has_normal && !has_color) {
+    if (HasAttributes()) {
+        utility::device_vector<size_t> indices(old_point_num);
+        check_nan_functor<Eigen::Vector3f> func(remove_nan, remove_infinite);
+        auto end = thrust::copy_if(
+                thrust::make_counting_iterator<size_t>(0),
+                thrust::make_counting_iterator(old_point_num),
+                points_.begin(), indices.begin(),
+                [func] __device__(const Eigen::Vector3f &x) {
+                    return !func(thrust::make_tuple(x));
+                });
+        indices.resize(thrust::distance(indices.begin(), end));
+        *this = std::move(*SelectByIndex(indices));
+        k = points_.size();
+    } else if (!has_normal && !has_color) {
         remove_if_vectors(check_nan_functor<Eigen::Vector3f>(remove_nan, remove_infinite), points_);
     } else if (has_normal && !has_color) {
         remove_if_vectors(check_nan_functor<Eigen::Vector3f, Eigen::Vector3f>(remove_nan, remove_infinite),
@@ -1,10 +1,18 @@
 #pragma once
 #include <thrust/host_vector.h>
 
+#include <limits>
+#include <string>
+#include <vector>
+
 #include "cupoch/geometry/geometry3d.h"
 #include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/geometry/selection_mask.h"
 #include "cupoch/utility/device_vector.h"
 #include "cupoch/utility/eigen.h"
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/host_mirror.h"
+#include "cupoch/utility/workspace.h"
 
 namespace cupoch {
 
@@ -15,7 +23,37 @@ class PinholeCameraIntrinsic;
 namespace geometry {
 
 class Image;
+class NeighborhoodCache;
+class PointCloudPipeline;
 class RGBDImage;
+class RangeImageProjection;
+class TriangleMesh;
+
+/// \class GroundSegmentationOption
+///
+/// \brief Concentric zone model of PointCloud::SegmentGround().
+///
+/// The xy plane around the sensor is split into zones delimited by the
+/// radii \p zone_boundaries_, and zone i into \p num_rings_[i] rings and
+/// \p num_sectors_[i] sectors. The defaults are those of Patchwork for a
+/// 64 beam LiDAR.
+struct GroundSegmentationOption {
+    std::vector<float> zone_boundaries_ = {2.7, 12.3625, 22.025, 41.35, 80.0};
+    std::vector<int> num_rings_ = {2, 4, 4, 4};
+    std::vector<int> num_sectors_ = {16, 32, 54, 32};
+    /// The seeds of a bin are its points below the mean height of its
+    /// \p num_lowest_points_ lowest points plus \p seed_height_.
+    int num_lowest_points_ = 20;
+    float seed_height_ = 0.4;
+    /// Maximum distance of a ground point to the plane of its bin.
+    float distance_threshold_ = 0.125;
+    /// Minimum z component of the normal of a ground plane.
+    float uprightness_threshold_ = 0.707;
+    /// Number of refits of the planes to their inliers.
+    int num_iterations_ = 3;
+    /// Bins with fewer points have no ground.
+    int min_points_ = 10;
+};
 
 class PointCloud : public Geometry3D {
 public:
@@ -23,17 +61,40 @@ public:
     PointCloud(const thrust::host_vector<Eigen::Vector3f> &points);
     PointCloud(const utility::device_vector<Eigen::Vector3f> &points);
     PointCloud(const PointCloud &other);
+    /// The moves hand the device buffers over without copying them.
+    PointCloud(PointCloud &&other);
     ~PointCloud();
     PointCloud &operator=(const PointCloud &other);
+    PointCloud &operator=(PointCloud &&other);
 
     void SetPoints(const thrust::host_vector<Eigen::Vector3f> &points);
     thrust::host_vector<Eigen::Vector3f> GetPoints() const;
+    /// The pinned overloads of the getters enqueue the download on \p stream
+    /// and return at once; synchronize the stream before reading the data.
+    void GetPoints(utility::pinned_host_vector<Eigen::Vector3f> &points,
+                   cudaStream_t stream = 0) const;
 
     void SetNormals(const thrust::host_vector<Eigen::Vector3f> &normals);
     thrust::host_vector<Eigen::Vector3f> GetNormals() const;
+    void GetNormals(utility::pinned_host_vector<Eigen::Vector3f> &normals,
+                    cudaStream_t stream = 0) const;
 
     void SetColors(const thrust::host_vector<Eigen::Vector3f> &colors);
     thrust::host_vector<Eigen::Vector3f> GetColors() const;
+    void GetColors(utility::pinned_host_vector<Eigen::Vector3f> &colors,
+                   cudaStream_t stream = 0) const;
+
+    /// Sets the per-point scalar channel \p name (e.g. intensity, timestamp,
+    /// ring or label). The channel is added if it does not exist yet.
+    void SetAttribute(const std::string &name,
+                      const thrust::host_vector<float> &values);
+    void SetAttribute(const std::string &name,
+                      const utility::device_vector<float> &values);
+    thrust::host_vector<float> GetAttribute(const std::string &name) const;
+    /// Index of the channel \p name in attribute_names_, or -1.
+    int GetAttributeIndex(const std::string &name) const;
+    /// Removes all custom attribute channels.
+    PointCloud &ClearAttributes();
 
     PointCloud &Clear() override;
     bool IsEmpty() const override;
@@ -41,14 +102,65 @@ public:
     Eigen::Vector3f GetMaxBound() const override;
     Eigen::Vector3f GetCenter() const override;
     AxisAlignedBoundingBox GetAxisAlignedBoundingBox() const override;
+    /// Mean and covariance of the points, in the same pass as their bounds.
+    std::tuple<Eigen::Vector3f, Eigen::Matrix3f> ComputeMeanAndCovariance()
+            const;
     PointCloud &Transform(const Eigen::Matrix4f &transformation) override;
+    /// Same as Transform(), but enqueued on the stream of \p ctx.
+    PointCloud &Transform(utility::ExecutionContext &ctx,
+                          const Eigen::Matrix4f &transformation);
     PointCloud &Translate(const Eigen::Vector3f &translation,
                           bool relative = true) override;
     PointCloud &Scale(const float scale, bool center = true) override;
     PointCloud &Rotate(const Eigen::Matrix3f &R, bool center = true) override;
 
+    /// Transforms the point cloud by each of \p transformations into one
+    /// concatenated point cloud in a single launch, copy i being the points
+    /// [i * points_.size(), (i + 1) * points_.size()) of the output.
+    std::shared_ptr<PointCloud> TransformBatch(
+            const std::vector<Eigen::Matrix4f_u> &transformations) const;
+    /// Transforms clouds[i] by transformations[i] into one concatenated
+    /// point cloud in a single launch. Returns it with the offsets of the
+    /// clouds in it, clouds[i] being [offsets[i], offsets[i + 1]). The
+    /// normals, colors and attributes are kept when all the clouds have
+    /// them, with the same attribute names.
+    static std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<int>>
+    TransformBatch(const std::vector<std::shared_ptr<PointCloud>> &clouds,
+                   const std::vector<Eigen::Matrix4f_u> &transformations);
+
+    /// Motion distortion correction of a scan taken by a moving sensor, in
+    /// one kernel. The acquisition time of every point is read from the
+    /// attribute \p time_attribute and the sensor pose at that time is
+    /// interpolated from the \p poses at the increasing \p pose_times, by
+    /// slerp of the rotations and linear interpolation of the translations,
+    /// clamped out of the time range. The points and normals are moved to
+    /// the sensor frame at \p reference_time.
+    PointCloud &Deskew(const std::vector<float> &pose_times,
+                       const std::vector<Eigen::Matrix4f_u> &poses,
+                       float reference_time,
+                       const std::string &time_attribute = "time");
+    /// Same as above with the poses at the start and the end of the scan,
+    /// the points being moved to the sensor frame at \p start_time.
+    PointCloud &Deskew(const Eigen::Matrix4f &start_pose,
+                       const Eigen::Matrix4f &end_pose,
+                       float start_time = 0.0,
+                       float end_time = 1.0,
+                       const std::string &time_attribute = "time");
+
+    /// Appends \p cloud. The normals, colors and attributes are kept if
+    /// both clouds have them. The capacity grows geometrically, so that a
+    /// map accumulated frame by frame is not reallocated on every frame.
     PointCloud &operator+=(const PointCloud &cloud);
     PointCloud operator+(const PointCloud &cloud) const;
+    /// Same as operator+= over all of \p clouds, with the memory reserved
+    /// once for their total size.
+    PointCloud &Append(const std::vector<std::shared_ptr<PointCloud>> &clouds);
+    /// Reserves the memory of \p n_points points, and of their normals,
+    /// colors and \p attribute_dim attributes, without changing the size.
+    PointCloud &Reserve(size_t n_points,
+                        bool normals = true,
+                        bool colors = true,
+                        size_t attribute_dim = 0);
 
     /// Returns 'true' if the point cloud contains points.
     __host__ __device__ bool HasPoints() const { return !points_.empty(); }
@@ -63,12 +175,36 @@ public:
         return !points_.empty() && colors_.size() == points_.size();
     }
 
+    /// Returns `true` if the point cloud contains custom point attributes.
+    bool HasAttributes() const {
+        return !points_.empty() && !attribute_names_.empty() &&
+               attributes_.size() == points_.size() * attribute_names_.size();
+    }
+
+    /// Number of custom attribute channels per point.
+    size_t GetAttributeDimension() const { return attribute_names_.size(); }
+
     /// Normalize point normals to length 1.
     PointCloud &NormalizeNormals();
 
     /// Assigns each point in the PointCloud the same color \param color.
     PointCloud &PaintUniformColor(const Eigen::Vector3f &color);
 
+    /// Colors the points from the \p images of several cameras, of 1 or 3
+    /// channels of 8 bit or float, \p extrinsics mapping the points to each
+    /// camera frame. The points are splatted over (2 * splat_radius + 1)^2
+    /// pixels of a depth buffer per camera, and a camera only colors the
+    /// points within \p occlusion_tolerance of its buffer, the others
+    /// being hidden by nearer points. The colors of the cameras are blended
+    /// by the inverse depths, and the points seen by no camera keep their
+    /// color, black if the cloud had none. Runs in two launches.
+    PointCloud &ColorizeFromImages(
+            const std::vector<Image> &images,
+            const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+            const std::vector<Eigen::Matrix4f_u> &extrinsics,
+            float occlusion_tolerance = 0.1,
+            int splat_radius = 2);
+
     /// \brief Remove all points fromt he point cloud that have a nan entry, or
     /// infinite entries.
     ///
@@ -89,27 +225,127 @@ public:
     std::shared_ptr<PointCloud> SelectByIndex(
             const utility::device_vector<size_t> &indices,
             bool invert = false) const;
+    std::shared_ptr<PointCloud> SelectByIndex(
+            utility::ExecutionContext &ctx,
+            const utility::device_vector<size_t> &indices,
+            bool invert = false) const;
 
     /// Function to downsample \param input pointcloud into output pointcloud
     /// with a voxel \param voxel_size defines the resolution of the voxel grid,
     /// smaller value leads to denser output point cloud. Normals and colors are
     /// averaged if they exist.
-    std::shared_ptr<PointCloud> VoxelDownSample(float voxel_size) const;
+    /// If \param deterministic is false, the points are accumulated into a
+    /// hash table with atomics instead of being sorted by voxel. This is
+    /// faster, but the order of the output points and the rounding of the
+    /// averages may change from run to run. The deterministic mode of
+    /// utility::SetDeterministicMode() or of \p ctx forces the sort.
+    std::shared_ptr<PointCloud> VoxelDownSample(float voxel_size,
+                                                bool deterministic = true) const;
+    std::shared_ptr<PointCloud> VoxelDownSample(utility::ExecutionContext &ctx,
+                                                float voxel_size,
+                                                bool deterministic = true) const;
 
     /// Function to downsample \param input pointcloud into output pointcloud
     /// uniformly \param every_k_points indicates the sample rate.
     std::shared_ptr<PointCloud> UniformDownSample(size_t every_k_points) const;
+    std::shared_ptr<PointCloud> UniformDownSample(
+            utility::ExecutionContext &ctx, size_t every_k_points) const;
+
+    /// Function to downsample \param input pointcloud into output pointcloud
+    /// with a voxel, keeping the first point of every voxel instead of the
+    /// average. The output points are in voxel order.
+    std::shared_ptr<PointCloud> ApproximateVoxelDownSample(
+            float voxel_size) const;
+    void ApproximateVoxelDownSample(utility::ExecutionContext &ctx,
+                                    float voxel_size,
+                                    PointCloud &output) const;
+
+    /// Function to downsample \param input pointcloud into output pointcloud
+    /// with exactly \param n_samples points chosen at random. The points are
+    /// drawn without replacement until the input is exhausted, so a cloud
+    /// smaller than \param n_samples is padded with repeated points.
+    std::shared_ptr<PointCloud> RandomDownSample(size_t n_samples,
+                                                 unsigned int seed = 0) const;
+    void RandomDownSample(utility::ExecutionContext &ctx,
+                          size_t n_samples,
+                          unsigned int seed,
+                          PointCloud &output) const;
+
+    /// Function to downsample \param input pointcloud into output pointcloud
+    /// with exactly \param n_samples points by farthest point sampling,
+    /// starting from the point \param start_index. Once every point has been
+    /// chosen the sampling repeats points.
+    std::shared_ptr<PointCloud> FarthestPointDownSample(
+            size_t n_samples, size_t start_index = 0) const;
+    void FarthestPointDownSample(utility::ExecutionContext &ctx,
+                                 size_t n_samples,
+                                 size_t start_index,
+                                 PointCloud &output) const;
 
     std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
-    RemoveRadiusOutliers(size_t nb_points, float search_radius) const;
+    RemoveRadiusOutliers(size_t nb_points, float search_radius,
+                         SearchIndexType index_type =
+                                 SearchIndexType::KDTreeFlann) const;
 
+    /// With SearchIndexType::VoxelHash the mean neighbor distances are
+    /// reduced inside the KNN kernel, so the n * knn neighbor lists are
+    /// never materialized.
     std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
-    RemoveStatisticalOutliers(size_t nb_neighbors, float std_ratio) const;
+    RemoveStatisticalOutliers(size_t nb_neighbors,
+                              float std_ratio,
+                              SearchIndexType index_type =
+                                      SearchIndexType::KDTreeFlann) const;
+    /// Same as above, from the distances of a previous KNN search of
+    /// \p nb_neighbors neighbors per point, so that the search can be
+    /// shared with EstimateNormals.
+    std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+    RemoveStatisticalOutliers(const utility::device_vector<float> &distance2,
+                              size_t nb_neighbors,
+                              float std_ratio) const;
+    /// Same as above, from the KNN neighborhood in \p cache, which must be
+    /// built on this point cloud.
+    std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<size_t>>
+    RemoveStatisticalOutliers(NeighborhoodCache &cache,
+                              size_t nb_neighbors,
+                              float std_ratio) const;
+
+    /// Masks of the inliers of the filters above, one bit per point. Masks
+    /// of several filters can be combined and applied with one
+    /// SelectByMask() compaction instead of gathering by index after each.
+    SelectionMask ComputeRadiusInlierMask(
+            size_t nb_points,
+            float search_radius,
+            SearchIndexType index_type = SearchIndexType::KDTreeFlann) const;
+    SelectionMask ComputeStatisticalInlierMask(
+            size_t nb_neighbors,
+            float std_ratio,
+            SearchIndexType index_type = SearchIndexType::KDTreeFlann) const;
+    SelectionMask ComputeStatisticalInlierMask(
+            const utility::device_vector<float> &distance2,
+            size_t nb_neighbors,
+            float std_ratio) const;
+    /// Mask of the points within \p bbox, as Crop().
+    SelectionMask ComputeCropMask(const AxisAlignedBoundingBox &bbox) const;
+
+    /// Compacts the points selected by \p mask (the others if \p invert)
+    /// into a new point cloud, keeping their order.
+    std::shared_ptr<PointCloud> SelectByMask(const SelectionMask &mask,
+                                             bool invert = false) const;
+    std::shared_ptr<PointCloud> SelectByMask(utility::ExecutionContext &ctx,
+                                             const SelectionMask &mask,
+                                             bool invert = false) const;
+
+    /// Starts a lazy chain of transforms, crops and a final voxel down
+    /// sampling that is fused into a few kernels when run. See
+    /// PointCloudPipeline.
+    PointCloudPipeline Pipeline() const;
 
     /// Function to crop pointcloud into output pointcloud
     /// All points with coordinates outside the bounding box \param bbox are
     /// clipped.
     std::shared_ptr<PointCloud> Crop(const AxisAlignedBoundingBox &bbox) const;
+    std::shared_ptr<PointCloud> Crop(utility::ExecutionContext &ctx,
+                                     const AxisAlignedBoundingBox &bbox) const;
 
     /// \brief Function to crop pointcloud into output pointcloud
     ///
@@ -118,15 +354,62 @@ public:
     ///
     /// \param bbox OrientedBoundingBox to crop points.
     std::shared_ptr<PointCloud> Crop(const OrientedBoundingBox &bbox) const;
+    std::shared_ptr<PointCloud> Crop(utility::ExecutionContext &ctx,
+                                     const OrientedBoundingBox &bbox) const;
+
+    /// In-place variants of Crop(). The points outside \p bbox are compacted
+    /// away in the buffers of this point cloud, keeping the order of the
+    /// remaining points, instead of being gathered into a new point cloud.
+    PointCloud &CropInPlace(const AxisAlignedBoundingBox &bbox);
+    PointCloud &CropInPlace(utility::ExecutionContext &ctx,
+                            const AxisAlignedBoundingBox &bbox);
+    PointCloud &CropInPlace(const OrientedBoundingBox &bbox);
+    PointCloud &CropInPlace(utility::ExecutionContext &ctx,
+                            const OrientedBoundingBox &bbox);
+
+    /// Keeps the points whose \p mask entry is true (false if \p invert),
+    /// compacting the points, normals, colors and attributes in place.
+    PointCloud &SelectByMaskInPlace(const utility::device_vector<bool> &mask,
+                                    bool invert = false);
+    PointCloud &SelectByMaskInPlace(utility::ExecutionContext &ctx,
+                                    const utility::device_vector<bool> &mask,
+                                    bool invert = false);
 
     /// Function to compute the normals of a point cloud
     /// \param cloud is the input point cloud. It also stores the output
     /// normals. Normals are oriented with respect to the input point cloud if
     /// normals exist in the input. \param search_param The KDTree search
-    /// parameters
+    /// parameters \param index_type The spatial index used for the search
     bool EstimateNormals(
+            const KDTreeSearchParam &search_param = KDTreeSearchParamKNN(),
+            SearchIndexType index_type = SearchIndexType::KDTreeFlann);
+    /// Same as EstimateNormals(), from the neighbor list of a previous KNN
+    /// or hybrid search, e.g. the one of RemoveStatisticalOutliers.
+    /// \p indices holds \p knn neighbors per point, padded with -1.
+    bool EstimateNormals(const utility::device_vector<int> &indices, int knn);
+    /// Same as above, also returning the eigenvalues of the neighborhood
+    /// covariances in ascending order and the curvature (surface
+    /// variation) l0 / (l0 + l1 + l2) of every point.
+    bool EstimateNormals(const utility::device_vector<int> &indices,
+                         int knn,
+                         utility::device_vector<Eigen::Vector3f> &eigenvalues,
+                         utility::device_vector<float> &curvatures);
+    /// Same as EstimateNormals(), from the neighborhood for \p search_param
+    /// in \p cache, which must be built on this point cloud.
+    bool EstimateNormals(
+            NeighborhoodCache &cache,
             const KDTreeSearchParam &search_param = KDTreeSearchParamKNN());
 
+    /// Function to compute the normals of an organized point cloud, which
+    /// holds one point per pixel of a \p width x \p height image in row
+    /// major order, as created from a depth image with
+    /// project_valid_depth_only = false. The normal of each pixel is the
+    /// cross product of its horizontal and vertical differences to the
+    /// pixels \p step away, so no neighbor search is needed. On each axis the
+    /// shorter of the forward and backward differences is used, which keeps
+    /// the normals at depth discontinuities. The normals face the camera.
+    bool EstimateOrganizedNormals(int width, int height, int step = 1);
+
     /// Function to orient the normals of a point cloud
     /// \param cloud is the input point cloud. It must have normals.
     /// Normals are oriented with respect to \param orientation_reference
@@ -134,13 +417,95 @@ public:
             const Eigen::Vector3f &orientation_reference =
                     Eigen::Vector3f(0.0, 0.0, 1.0));
 
+    /// Function to orient the normals consistently over the surface, as in
+    /// Hoppe et al., "Surface Reconstruction from Unorganized Points", 1992.
+    /// The normals are propagated from a root point along the minimum
+    /// spanning tree of the graph of the \p k nearest neighbors weighted by
+    /// 1 - |n_i . n_j|, each normal being flipped to agree with its parent.
+    /// The tree is built by a parallel Boruvka algorithm and traversed by a
+    /// parallel BFS. The root keeps its normal, one per connected component
+    /// of the graph, so OrientNormalsToAlignWithDirection() beforehand
+    /// chooses the side of the roots.
+    bool OrientNormalsConsistentTangentPlane(size_t k);
+
     /// Cluster PointCloud using the DBSCAN algorithm
     /// Ester et al., "A Density-Based Algorithm for Discovering Clusters
     /// in Large Spatial Databases with Noise", 1996
     /// Returns a vector of point labels, -1 indicates noise according to
     /// the algorithm.
     utility::device_vector<int> ClusterDBSCAN(
-            float eps, size_t min_points, bool print_progress = false, size_t max_edges = NUM_MAX_NN) const;
+            float eps, size_t min_points, bool print_progress = false, size_t max_edges = NUM_MAX_NN,
+            SearchIndexType index_type = SearchIndexType::KDTreeFlann) const;
+    /// Same as ClusterDBSCAN(), with the temporary buffers taken from
+    /// \p workspace.
+    utility::device_vector<int> ClusterDBSCAN(
+            utility::Workspace &workspace,
+            float eps, size_t min_points, bool print_progress = false, size_t max_edges = NUM_MAX_NN,
+            SearchIndexType index_type = SearchIndexType::KDTreeFlann) const;
+
+    /// Euclidean cluster extraction. The points are voxelized with a voxel
+    /// size of \p tolerance and the clusters are the 26-connected components
+    /// of the occupied voxels, so points closer than \p tolerance always end
+    /// up in the same cluster. Clusters with fewer than \p min_size or more
+    /// than \p max_size points are dropped.
+    /// Returns the point indices grouped by cluster and the offsets of the
+    /// clusters in it; cluster i is indices[offsets[i]:offsets[i + 1]].
+    std::tuple<utility::device_vector<int>, utility::device_vector<int>>
+    ClusterEuclidean(float tolerance,
+                     size_t min_size = 1,
+                     size_t max_size = std::numeric_limits<size_t>::max()) const;
+
+    /// Convex hull of the points by QuickHull, and the indices of its
+    /// vertices in the points. The points are assigned to the faces and the
+    /// farthest point of each face is found on the device; only the faces
+    /// around the new vertices are updated on the host. The hull is empty
+    /// if the points are coplanar.
+    std::tuple<std::shared_ptr<TriangleMesh>, utility::device_vector<size_t>>
+    ComputeConvexHull() const;
+    /// Convex hulls of the clusters given by \p labels, e.g. by
+    /// ClusterDBSCAN(), all grown in the same passes over the points. The
+    /// hull of label l is at index l, and the noise points, labeled -1, are
+    /// ignored.
+    std::vector<std::shared_ptr<TriangleMesh>> ComputeConvexHulls(
+            const utility::device_vector<int> &labels) const;
+
+    /// Katz et al., "Direct Visibility of Point Sets", 2007. The points seen
+    /// from \p camera_location are flipped about the sphere of \p radius
+    /// around it, which must enclose the points, and the points visible are
+    /// the vertices of the convex hull of the flipped points and of the
+    /// camera. Returns this hull, with the points at their positions, and
+    /// the indices of the visible points.
+    std::tuple<std::shared_ptr<TriangleMesh>, utility::device_vector<size_t>>
+    HiddenPointRemoval(const Eigen::Vector3f &camera_location,
+                       float radius) const;
+    /// Indices of the points visible from each of \p camera_locations, the
+    /// hulls of all the viewpoints being computed in the same passes.
+    std::vector<utility::device_vector<size_t>> HiddenPointRemovalBatch(
+            const std::vector<Eigen::Vector3f> &camera_locations,
+            float radius) const;
+
+    /// Segments the dominant plane with RANSAC. The \p num_iterations plane
+    /// hypotheses, each fitted to \p ransac_n random points, are scored in
+    /// parallel in one launch, one thread per hypothesis, and the best one
+    /// is refitted to its inliers by least squares.
+    /// Returns the plane (a, b, c, d), with ax + by + cz + d = 0 and a unit
+    /// normal, and the indices of the inliers.
+    std::tuple<Eigen::Vector4f, utility::device_vector<size_t>> SegmentPlane(
+            float distance_threshold = 0.01,
+            int ransac_n = 3,
+            int num_iterations = 100,
+            unsigned int seed = 0) const;
+
+    /// Ground segmentation of a LiDAR scan in the sensor frame (z up) for
+    /// uneven terrain, after Lim et al., "Patchwork: Concentric Zone-based
+    /// Region-wise Ground Segmentation with Ground Likelihood Estimation
+    /// Using a 3D LiDAR Sensor", 2021. A plane is fitted to every bin of the
+    /// concentric zone model, all bins at once, and the points close to an
+    /// upright plane are ground. Returns the indices of the ground points
+    /// in increasing order.
+    utility::device_vector<size_t> SegmentGround(
+            const GroundSegmentationOption &option =
+                    GroundSegmentationOption()) const;
 
     /// Factory function to create a pointcloud from a depth image and a camera
     /// model (PointCloudFactory.cpp)
@@ -155,7 +520,8 @@ public:
             const Eigen::Matrix4f &extrinsic = Eigen::Matrix4f::Identity(),
             float depth_scale = 1000.0,
             float depth_trunc = 1000.0,
-            int stride = 1);
+            int stride = 1,
+            bool project_valid_depth_only = true);
 
     /// Factory function to create a pointcloud from an RGB-D image and a camera
     /// model (PointCloudFactory.cpp)
@@ -170,10 +536,90 @@ public:
             const Eigen::Matrix4f &extrinsic = Eigen::Matrix4f::Identity(),
             bool project_valid_depth_only = true);
 
+    /// Same as CreateFromDepthImage() with project_valid_depth_only, into
+    /// this point cloud, whose capacity is kept from frame to frame. The
+    /// back-projection, the truncation, the stride, the extrinsic transform
+    /// and the compaction of the valid pixels are done in one kernel, and
+    /// the float depth is also truncated at \p depth_trunc. The points of a
+    /// warp stay in pixel order, but the warps are written in any order.
+    /// The normals, colors and attributes are cleared. Returns false if the
+    /// image format is not supported.
+    bool UnprojectDepthImage(
+            const Image &depth,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic = Eigen::Matrix4f::Identity(),
+            float depth_scale = 1000.0,
+            float depth_trunc = 1000.0,
+            int stride = 1);
+
+    /// Same as UnprojectDepthImage() for CreateFromRGBDImage(), with the
+    /// colors of the valid pixels.
+    bool UnprojectRGBDImage(
+            const RGBDImage &image,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic = Eigen::Matrix4f::Identity(),
+            float depth_trunc = 1000.0,
+            int stride = 1);
+
+    /// Renders the points seen by a camera of \p intrinsic at \p extrinsic,
+    /// the transformation from the world to the camera frame as in
+    /// CreateFromDepthImage(), into a float depth image of the size of the
+    /// intrinsic. Every point goes to its nearest pixel and the nearest point
+    /// of a pixel wins; the pixels without points are zero.
+    std::shared_ptr<Image> ProjectToDepthImage(
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic =
+                    Eigen::Matrix4f::Identity()) const;
+
+    /// Same as ProjectToDepthImage() with the index of the nearest point of
+    /// every pixel, in a single channel int image, -1 for the pixels without
+    /// points. This is the projective data association of the pixels of a
+    /// frame with the points, e.g. for occlusion tests or projective ICP.
+    std::shared_ptr<Image> ProjectToIndexImage(
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic =
+                    Eigen::Matrix4f::Identity()) const;
+
+    /// Factory function to create a pointcloud from the float range image
+    /// \p range of a spinning LiDAR. Each pixel with a range in the limits
+    /// of \p projection gives the point along the beam through its center.
+    /// If \p project_valid_range_only is false, every pixel gives a point,
+    /// NaN for the invalid ones, and the organized point cloud can be passed
+    /// to EstimateOrganizedNormals() with the width and height of \p range
+    /// for normals from the image neighbors.
+    static std::shared_ptr<PointCloud> CreateFromRangeImage(
+            const Image &range,
+            const RangeImageProjection &projection,
+            bool project_valid_range_only = true);
+
+    /// Projects the points onto the float range image of \p projection.
+    /// The nearest point of a pixel wins and the pixels without points are
+    /// zero.
+    std::shared_ptr<Image> ToRangeImage(
+            const RangeImageProjection &projection) const;
+
+    /// Same as ToRangeImage() with the index of the nearest point of every
+    /// pixel, in a single channel int image, -1 for the pixels without
+    /// points. It maps the labels of the range image operations back to the
+    /// points.
+    std::shared_ptr<Image> ToRangeIndexImage(
+            const RangeImageProjection &projection) const;
+
 public:
     utility::device_vector<Eigen::Vector3f> points_;
     utility::device_vector<Eigen::Vector3f> normals_;
     utility::device_vector<Eigen::Vector3f> colors_;
+    /// Custom per-point attributes stored in one interleaved allocation of
+    /// size points_.size() x attribute_names_.size(). All filters gather them
+    /// together with points, normals and colors in a single kernel.
+    utility::device_vector<float> attributes_;
+    std::vector<std::string> attribute_names_;
+
+private:
+    /// Host copies of the getters and setters, transferred only when stale.
+    mutable utility::HostMirror<Eigen::Vector3f> points_mirror_;
+    mutable utility::HostMirror<Eigen::Vector3f> normals_mirror_;
+    mutable utility::HostMirror<Eigen::Vector3f> colors_mirror_;
 };
 
 }  // namespace geometry
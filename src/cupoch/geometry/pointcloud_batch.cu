@@ -0,0 +1,587 @@
+#include <thrust/binary_search.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <limits>
+#include <tuple>
+
+#include "cupoch/geometry/batched_search.h"
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/estimate_normals.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/pointcloud_batch.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+// Output point i comes from the segment s with offsets[s] <= i <
+// offsets[s + 1], read from the source arrays of s and transformed by
+// transforms[s]. The null arrays are skipped.
+struct transform_batch_functor {
+    transform_batch_functor(const int *offsets,
+                            int n_segments,
+                            const Eigen::Matrix4f_u *transforms,
+                            const Eigen::Vector3f *const *src_points,
+                            const Eigen::Vector3f *const *src_normals,
+                            const Eigen::Vector3f *const *src_colors,
+                            const float *const *src_attributes,
+                            int attribute_dim,
+                            Eigen::Vector3f *points,
+                            Eigen::Vector3f *normals,
+                            Eigen::Vector3f *colors,
+                            float *attributes)
+        : offsets_(offsets),
+          n_segments_(n_segments),
+          transforms_(transforms),
+          src_points_(src_points),
+          src_normals_(src_normals),
+          src_colors_(src_colors),
+          src_attributes_(src_attributes),
+          attribute_dim_(attribute_dim),
+          points_(points),
+          normals_(normals),
+          colors_(colors),
+          attributes_(attributes){};
+    const int *offsets_;
+    const int n_segments_;
+    const Eigen::Matrix4f_u *transforms_;
+    const Eigen::Vector3f *const *src_points_;
+    const Eigen::Vector3f *const *src_normals_;
+    const Eigen::Vector3f *const *src_colors_;
+    const float *const *src_attributes_;
+    const int attribute_dim_;
+    Eigen::Vector3f *points_;
+    Eigen::Vector3f *normals_;
+    Eigen::Vector3f *colors_;
+    float *attributes_;
+    __device__ void operator()(int idx) {
+        int lo = 0;
+        int hi = n_segments_;
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) / 2;
+            if (offsets_[mid] <= idx) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const int local = idx - offsets_[lo];
+        const Eigen::Matrix4f_u &t = transforms_[lo];
+        const Eigen::Vector4f p = t * src_points_[lo][local].homogeneous();
+        points_[idx] = p.head<3>() / p(3);
+        if (normals_) {
+            normals_[idx] = t.block<3, 3>(0, 0) * src_normals_[lo][local];
+        }
+        if (colors_) colors_[idx] = src_colors_[lo][local];
+        for (int k = 0; k < attribute_dim_; ++k) {
+            attributes_[idx * attribute_dim_ + k] =
+                    src_attributes_[lo][local * attribute_dim_ + k];
+        }
+    }
+};
+
+// Key of the voxel of a point of cloud label: the label, then the voxel
+// index, so that the voxels of a cloud are contiguous once sorted.
+struct compute_batch_key_functor {
+    compute_batch_key_functor(const Eigen::Vector3f &voxel_min_bound,
+                              float voxel_size)
+        : voxel_min_bound_(voxel_min_bound), voxel_size_(voxel_size){};
+    const Eigen::Vector3f voxel_min_bound_;
+    const float voxel_size_;
+    __device__ Eigen::Vector4i operator()(const Eigen::Vector3f &pt,
+                                          int label) const {
+        const Eigen::Vector3f ref_coord = (pt - voxel_min_bound_) / voxel_size_;
+        return Eigen::Vector4i(label, int(floor(ref_coord(0))),
+                               int(floor(ref_coord(1))),
+                               int(floor(ref_coord(2))));
+    }
+};
+
+// Averages the points, normals and colors of the sorted points
+// [offsets[idx], offsets[idx] + counts[idx]) of voxel idx. The null arrays
+// are skipped.
+struct average_voxel_functor {
+    average_voxel_functor(const size_t *perm,
+                          const int *offsets,
+                          const int *counts,
+                          const Eigen::Vector3f *src_points,
+                          const Eigen::Vector3f *src_normals,
+                          const Eigen::Vector3f *src_colors,
+                          Eigen::Vector3f *points,
+                          Eigen::Vector3f *normals,
+                          Eigen::Vector3f *colors)
+        : perm_(perm),
+          offsets_(offsets),
+          counts_(counts),
+          src_points_(src_points),
+          src_normals_(src_normals),
+          src_colors_(src_colors),
+          points_(points),
+          normals_(normals),
+          colors_(colors){};
+    const size_t *perm_;
+    const int *offsets_;
+    const int *counts_;
+    const Eigen::Vector3f *src_points_;
+    const Eigen::Vector3f *src_normals_;
+    const Eigen::Vector3f *src_colors_;
+    Eigen::Vector3f *points_;
+    Eigen::Vector3f *normals_;
+    Eigen::Vector3f *colors_;
+    __device__ void operator()(size_t idx) {
+        const int offset = offsets_[idx];
+        const int count = counts_[idx];
+        Eigen::Vector3f p = Eigen::Vector3f::Zero();
+        Eigen::Vector3f n = Eigen::Vector3f::Zero();
+        Eigen::Vector3f c = Eigen::Vector3f::Zero();
+        for (int k = 0; k < count; ++k) {
+            const size_t j = perm_[offset + k];
+            p += src_points_[j];
+            if (normals_) n += src_normals_[j];
+            if (colors_) c += src_colors_[j];
+        }
+        points_[idx] = p / count;
+        if (normals_) normals_[idx] = n.normalized();
+        if (colors_) colors_[idx] = c / count;
+    }
+};
+
+// Neighbors of point idx from the CSR result of SearchKNNBatched, padded
+// with -1 to knn per point.
+struct pad_neighbors_functor {
+    pad_neighbors_functor(const int *result_offsets,
+                          const int *indices,
+                          int knn,
+                          int *padded)
+        : result_offsets_(result_offsets),
+          indices_(indices),
+          knn_(knn),
+          padded_(padded){};
+    const int *result_offsets_;
+    const int *indices_;
+    const int knn_;
+    int *padded_;
+    __device__ void operator()(size_t idx) {
+        const int begin = result_offsets_[idx];
+        const int count = result_offsets_[idx + 1] - begin;
+        for (int k = 0; k < knn_; ++k) {
+            padded_[idx * knn_ + k] = (k < count) ? indices_[begin + k] : -1;
+        }
+    }
+};
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<int>>
+TransformBatchImpl(const std::vector<const PointCloud *> &clouds,
+                   const std::vector<Eigen::Matrix4f_u> &transformations) {
+    CUPOCH_PROFILE("PointCloud::TransformBatch");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    const int n_segments = clouds.size();
+    if (transformations.size() != clouds.size()) {
+        utility::LogError(
+                "[TransformBatch] The numbers of clouds and transformations "
+                "do not match.");
+    }
+    auto output = std::make_shared<PointCloud>();
+    if (n_segments == 0) {
+        return std::make_tuple(output, utility::device_vector<int>(1, 0));
+    }
+    bool has_normals = true;
+    bool has_colors = true;
+    bool has_attributes = clouds[0]->HasAttributes();
+    std::vector<int> offsets(n_segments + 1, 0);
+    for (int i = 0; i < n_segments; ++i) {
+        const PointCloud &cloud = *clouds[i];
+        offsets[i + 1] = offsets[i] + cloud.points_.size();
+        has_normals &= cloud.HasNormals();
+        has_colors &= cloud.HasColors();
+        has_attributes &= cloud.HasAttributes() &&
+                          cloud.attribute_names_ == clouds[0]->attribute_names_;
+    }
+    const int n_points = offsets.back();
+    const int attribute_dim =
+            (has_attributes) ? clouds[0]->attribute_names_.size() : 0;
+
+    std::vector<const Eigen::Vector3f *> h_points(n_segments);
+    std::vector<const Eigen::Vector3f *> h_normals(n_segments, nullptr);
+    std::vector<const Eigen::Vector3f *> h_colors(n_segments, nullptr);
+    std::vector<const float *> h_attributes(n_segments, nullptr);
+    for (int i = 0; i < n_segments; ++i) {
+        const PointCloud &cloud = *clouds[i];
+        h_points[i] = thrust::raw_pointer_cast(cloud.points_.data());
+        if (has_normals) {
+            h_normals[i] = thrust::raw_pointer_cast(cloud.normals_.data());
+        }
+        if (has_colors) {
+            h_colors[i] = thrust::raw_pointer_cast(cloud.colors_.data());
+        }
+        if (has_attributes) {
+            h_attributes[i] =
+                    thrust::raw_pointer_cast(cloud.attributes_.data());
+        }
+    }
+    const utility::device_vector<const Eigen::Vector3f *> src_points(
+            h_points.begin(), h_points.end());
+    const utility::device_vector<const Eigen::Vector3f *> src_normals(
+            h_normals.begin(), h_normals.end());
+    const utility::device_vector<const Eigen::Vector3f *> src_colors(
+            h_colors.begin(), h_colors.end());
+    const utility::device_vector<const float *> src_attributes(
+            h_attributes.begin(), h_attributes.end());
+    const utility::device_vector<Eigen::Matrix4f_u> transforms(
+            transformations.begin(), transformations.end());
+    utility::device_vector<int> d_offsets(offsets.begin(), offsets.end());
+
+    output->points_.resize(n_points);
+    if (has_normals) output->normals_.resize(n_points);
+    if (has_colors) output->colors_.resize(n_points);
+    if (has_attributes) {
+        output->attribute_names_ = clouds[0]->attribute_names_;
+        output->attributes_.resize(n_points * attribute_dim);
+    }
+    transform_batch_functor func(
+            thrust::raw_pointer_cast(d_offsets.data()), n_segments,
+            thrust::raw_pointer_cast(transforms.data()),
+            thrust::raw_pointer_cast(src_points.data()),
+            thrust::raw_pointer_cast(src_normals.data()),
+            thrust::raw_pointer_cast(src_colors.data()),
+            thrust::raw_pointer_cast(src_attributes.data()), attribute_dim,
+            thrust::raw_pointer_cast(output->points_.data()),
+            (has_normals) ? thrust::raw_pointer_cast(output->normals_.data())
+                          : nullptr,
+            (has_colors) ? thrust::raw_pointer_cast(output->colors_.data())
+                         : nullptr,
+            thrust::raw_pointer_cast(output->attributes_.data()));
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_points), func);
+    return std::make_tuple(output, std::move(d_offsets));
+}
+
+}  // namespace
+
+std::shared_ptr<PointCloud> PointCloud::TransformBatch(
+        const std::vector<Eigen::Matrix4f_u> &transformations) const {
+    const std::vector<const PointCloud *> clouds(transformations.size(),
+                                                 this);
+    return std::get<0>(TransformBatchImpl(clouds, transformations));
+}
+
+std::tuple<std::shared_ptr<PointCloud>, utility::device_vector<int>>
+PointCloud::TransformBatch(
+        const std::vector<std::shared_ptr<PointCloud>> &clouds,
+        const std::vector<Eigen::Matrix4f_u> &transformations) {
+    std::vector<const PointCloud *> ptrs(clouds.size());
+    for (size_t i = 0; i < clouds.size(); ++i) ptrs[i] = clouds[i].get();
+    return TransformBatchImpl(ptrs, transformations);
+}
+
+PointCloudBatch::PointCloudBatch(
+        const std::vector<std::shared_ptr<PointCloud>> &clouds) {
+    const std::vector<Eigen::Matrix4f_u> identities(
+            clouds.size(), Eigen::Matrix4f_u::Identity());
+    std::shared_ptr<PointCloud> concatenated;
+    std::tie(concatenated, offsets_) =
+            PointCloud::TransformBatch(clouds, identities);
+    points_ = std::move(concatenated->points_);
+    normals_ = std::move(concatenated->normals_);
+    colors_ = std::move(concatenated->colors_);
+}
+
+std::shared_ptr<PointCloudBatch> PointCloudBatch::CreateFromLabels(
+        const PointCloud &cloud, const utility::device_vector<int> &labels) {
+    CUPOCH_PROFILE("PointCloudBatch::CreateFromLabels");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    auto output = std::make_shared<PointCloudBatch>();
+    if (labels.size() != cloud.points_.size()) {
+        utility::LogError(
+                "[CreateFromLabels] The numbers of labels and points do not "
+                "match.");
+        return output;
+    }
+    if (labels.empty()) return output;
+    const int max_label = thrust::reduce(labels.begin(), labels.end(), -1,
+                                         thrust::maximum<int>());
+    if (max_label < 0) return output;
+
+    utility::device_vector<int> sorted_labels = labels;
+    utility::device_vector<size_t> perm(labels.size());
+    thrust::sequence(perm.begin(), perm.end());
+    thrust::stable_sort_by_key(sorted_labels.begin(), sorted_labels.end(),
+                               perm.begin());
+    // The noise points come first once sorted.
+    const int n_noise =
+            thrust::distance(sorted_labels.begin(),
+                             thrust::lower_bound(sorted_labels.begin(),
+                                                 sorted_labels.end(), 0));
+    const int n = labels.size() - n_noise;
+    output->offsets_.resize(max_label + 2);
+    thrust::lower_bound(sorted_labels.begin() + n_noise, sorted_labels.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(max_label + 2),
+                        output->offsets_.begin());
+    output->points_.resize(n);
+    thrust::gather(perm.begin() + n_noise, perm.end(), cloud.points_.begin(),
+                   output->points_.begin());
+    if (cloud.HasNormals()) {
+        output->normals_.resize(n);
+        thrust::gather(perm.begin() + n_noise, perm.end(),
+                       cloud.normals_.begin(), output->normals_.begin());
+    }
+    if (cloud.HasColors()) {
+        output->colors_.resize(n);
+        thrust::gather(perm.begin() + n_noise, perm.end(),
+                       cloud.colors_.begin(), output->colors_.begin());
+    }
+    return output;
+}
+
+void PointCloudBatch::Clear() {
+    points_.clear();
+    normals_.clear();
+    colors_.clear();
+    offsets_.assign(1, 0);
+}
+
+thrust::host_vector<int> PointCloudBatch::GetOffsets() const {
+    return thrust::host_vector<int>(offsets_);
+}
+
+utility::device_vector<int> PointCloudBatch::GetLabels() const {
+    const int n = points_.size();
+    utility::device_vector<int> labels(n);
+    thrust::upper_bound(offsets_.begin() + 1, offsets_.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(n), labels.begin());
+    return labels;
+}
+
+std::shared_ptr<PointCloud> PointCloudBatch::GetCloud(int i) const {
+    auto output = std::make_shared<PointCloud>();
+    if (i < 0 || i >= GetNumClouds()) {
+        utility::LogError("[GetCloud] Index {:d} out of range.", i);
+        return output;
+    }
+    const thrust::host_vector<int> offsets(offsets_.begin() + i,
+                                           offsets_.begin() + i + 2);
+    output->points_.assign(points_.begin() + offsets[0],
+                           points_.begin() + offsets[1]);
+    if (HasNormals()) {
+        output->normals_.assign(normals_.begin() + offsets[0],
+                                normals_.begin() + offsets[1]);
+    }
+    if (HasColors()) {
+        output->colors_.assign(colors_.begin() + offsets[0],
+                               colors_.begin() + offsets[1]);
+    }
+    return output;
+}
+
+std::vector<std::shared_ptr<PointCloud>> PointCloudBatch::Split() const {
+    const thrust::host_vector<int> offsets = GetOffsets();
+    std::vector<std::shared_ptr<PointCloud>> clouds(GetNumClouds());
+    for (int i = 0; i < GetNumClouds(); ++i) {
+        clouds[i] = std::make_shared<PointCloud>();
+        clouds[i]->points_.assign(points_.begin() + offsets[i],
+                                  points_.begin() + offsets[i + 1]);
+        if (HasNormals()) {
+            clouds[i]->normals_.assign(normals_.begin() + offsets[i],
+                                       normals_.begin() + offsets[i + 1]);
+        }
+        if (HasColors()) {
+            clouds[i]->colors_.assign(colors_.begin() + offsets[i],
+                                      colors_.begin() + offsets[i + 1]);
+        }
+    }
+    return clouds;
+}
+
+std::shared_ptr<PointCloud> PointCloudBatch::ToPointCloud() const {
+    auto output = std::make_shared<PointCloud>();
+    output->points_ = points_;
+    output->normals_ = normals_;
+    output->colors_ = colors_;
+    return output;
+}
+
+PointCloudBatch &PointCloudBatch::Transform(
+        const std::vector<Eigen::Matrix4f_u> &transformations) {
+    CUPOCH_PROFILE("PointCloudBatch::Transform");
+    const int n_clouds = GetNumClouds();
+    if ((int)transformations.size() != n_clouds) {
+        utility::LogError(
+                "[Transform] The numbers of clouds and transformations do not "
+                "match.");
+        return *this;
+    }
+    const int n_points = points_.size();
+    if (n_points == 0) return *this;
+    // Transformed in place: the source arrays of the clouds point into the
+    // concatenated ones.
+    const bool has_normals = HasNormals();
+    const thrust::host_vector<int> offsets = GetOffsets();
+    std::vector<const Eigen::Vector3f *> h_points(n_clouds);
+    std::vector<const Eigen::Vector3f *> h_normals(n_clouds, nullptr);
+    for (int i = 0; i < n_clouds; ++i) {
+        h_points[i] = thrust::raw_pointer_cast(points_.data()) + offsets[i];
+        if (has_normals) {
+            h_normals[i] =
+                    thrust::raw_pointer_cast(normals_.data()) + offsets[i];
+        }
+    }
+    const utility::device_vector<const Eigen::Vector3f *> src_points(
+            h_points.begin(), h_points.end());
+    const utility::device_vector<const Eigen::Vector3f *> src_normals(
+            h_normals.begin(), h_normals.end());
+    const utility::device_vector<Eigen::Matrix4f_u> transforms(
+            transformations.begin(), transformations.end());
+    transform_batch_functor func(
+            thrust::raw_pointer_cast(offsets_.data()), n_clouds,
+            thrust::raw_pointer_cast(transforms.data()),
+            thrust::raw_pointer_cast(src_points.data()),
+            thrust::raw_pointer_cast(src_normals.data()), nullptr, nullptr, 0,
+            thrust::raw_pointer_cast(points_.data()),
+            (has_normals) ? thrust::raw_pointer_cast(normals_.data())
+                          : nullptr,
+            nullptr, nullptr);
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_points), func);
+    return *this;
+}
+
+std::shared_ptr<PointCloudBatch> PointCloudBatch::VoxelDownSample(
+        float voxel_size) const {
+    CUPOCH_PROFILE("PointCloudBatch::VoxelDownSample");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    auto output = std::make_shared<PointCloudBatch>();
+    if (voxel_size <= 0.0) {
+        utility::LogWarning("[VoxelDownSample] voxel_size <= 0.\n");
+        return output;
+    }
+    const int n_clouds = GetNumClouds();
+    if (points_.empty()) {
+        output->offsets_.assign(n_clouds + 1, 0);
+        return output;
+    }
+    const Eigen::Vector3f voxel_size3 =
+            Eigen::Vector3f(voxel_size, voxel_size, voxel_size);
+    const Eigen::Vector3f init = points_[0];
+    const Eigen::Vector3f voxel_min_bound =
+            thrust::reduce(points_.begin(), points_.end(), init,
+                           thrust::elementwise_minimum<Eigen::Vector3f>()) -
+            voxel_size3 * 0.5;
+    const Eigen::Vector3f voxel_max_bound =
+            thrust::reduce(points_.begin(), points_.end(), init,
+                           thrust::elementwise_maximum<Eigen::Vector3f>()) +
+            voxel_size3 * 0.5;
+    if (voxel_size * std::numeric_limits<int>::max() <
+        (voxel_max_bound - voxel_min_bound).maxCoeff()) {
+        utility::LogWarning("[VoxelDownSample] voxel_size is too small.\n");
+        return output;
+    }
+
+    const size_t n = points_.size();
+    const utility::device_vector<int> labels = GetLabels();
+    utility::device_vector<Eigen::Vector4i> keys(n);
+    thrust::transform(points_.begin(), points_.end(), labels.begin(),
+                      keys.begin(),
+                      compute_batch_key_functor(voxel_min_bound, voxel_size));
+    utility::device_vector<size_t> perm(n);
+    thrust::sequence(perm.begin(), perm.end());
+    thrust::sort_by_key(keys.begin(), keys.end(), perm.begin());
+    utility::device_vector<Eigen::Vector4i> voxel_keys(n);
+    utility::device_vector<int> counts(n);
+    auto end = thrust::reduce_by_key(keys.begin(), keys.end(),
+                                     thrust::make_constant_iterator(1),
+                                     voxel_keys.begin(), counts.begin());
+    const size_t n_out = thrust::distance(counts.begin(), end.second);
+    resize_all(n_out, voxel_keys, counts);
+    utility::device_vector<int> voxel_offsets(n_out);
+    thrust::exclusive_scan(counts.begin(), counts.end(),
+                           voxel_offsets.begin());
+
+    const bool has_normals = HasNormals();
+    const bool has_colors = HasColors();
+    output->points_.resize(n_out);
+    if (has_normals) output->normals_.resize(n_out);
+    if (has_colors) output->colors_.resize(n_out);
+    average_voxel_functor func(
+            thrust::raw_pointer_cast(perm.data()),
+            thrust::raw_pointer_cast(voxel_offsets.data()),
+            thrust::raw_pointer_cast(counts.data()),
+            thrust::raw_pointer_cast(points_.data()),
+            thrust::raw_pointer_cast(normals_.data()),
+            thrust::raw_pointer_cast(colors_.data()),
+            thrust::raw_pointer_cast(output->points_.data()),
+            (has_normals) ? thrust::raw_pointer_cast(output->normals_.data())
+                          : nullptr,
+            (has_colors) ? thrust::raw_pointer_cast(output->colors_.data())
+                         : nullptr);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_out), func);
+
+    // The voxels of cloud l start at the first key of label l.
+    utility::device_vector<int> voxel_labels(n_out);
+    thrust::transform(voxel_keys.begin(), voxel_keys.end(),
+                      voxel_labels.begin(),
+                      [] __device__(const Eigen::Vector4i &key) {
+                          return key[0];
+                      });
+    output->offsets_.resize(n_clouds + 1);
+    thrust::lower_bound(voxel_labels.begin(), voxel_labels.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(n_clouds + 1),
+                        output->offsets_.begin());
+    utility::LogDebug(
+            "PointCloudBatch down sampled from {:d} points to {:d} points.\n",
+            (int)n, (int)n_out);
+    return output;
+}
+
+bool PointCloudBatch::EstimateNormals(int knn) {
+    CUPOCH_PROFILE("PointCloudBatch::EstimateNormals");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    if (knn < 1) {
+        utility::LogWarning("[EstimateNormals] knn must be positive.\n");
+        return false;
+    }
+    const int n = points_.size();
+    normals_.resize(n);
+    if (n == 0) return true;
+    utility::device_vector<int> result_offsets;
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    SearchKNNBatched(points_, offsets_, knn, result_offsets, indices,
+                     distance2);
+    utility::device_vector<int> padded(n * knn);
+    pad_neighbors_functor func(thrust::raw_pointer_cast(result_offsets.data()),
+                               thrust::raw_pointer_cast(indices.data()), knn,
+                               thrust::raw_pointer_cast(padded.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(n), func);
+    EstimateNormalsFromNeighbors(0, thrust::raw_pointer_cast(points_.data()),
+                                 thrust::raw_pointer_cast(padded.data()), knn,
+                                 n, thrust::raw_pointer_cast(normals_.data()));
+    cudaSafeCall(cudaStreamSynchronize(0));
+    return true;
+}
+
+std::vector<OrientedBoundingBox> PointCloudBatch::GetOrientedBoundingBoxes()
+        const {
+    std::vector<OrientedBoundingBox> boxes =
+            OrientedBoundingBox::CreateFromPointClusters(points_, GetLabels());
+    boxes.resize(GetNumClouds());
+    return boxes;
+}
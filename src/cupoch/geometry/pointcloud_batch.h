@@ -0,0 +1,88 @@
+#pragma once
+
+#include <thrust/host_vector.h>
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+class OrientedBoundingBox;
+
+/// \class PointCloudBatch
+///
+/// \brief Many small point clouds, e.g. the segments of a scene, stored as
+/// one concatenated cloud so that every operation runs over all of them in
+/// a single launch. Cloud i is [offsets_[i], offsets_[i + 1]) and offsets_
+/// ends with the total number of points. The normals and colors are either
+/// empty or given for all the points.
+class PointCloudBatch {
+public:
+    PointCloudBatch() : offsets_(1, 0) {}
+    /// Concatenates \p clouds. The normals and colors are kept when all the
+    /// clouds have them.
+    explicit PointCloudBatch(
+            const std::vector<std::shared_ptr<PointCloud>> &clouds);
+    ~PointCloudBatch() {}
+
+public:
+    /// Batch of the clusters of \p cloud given by \p labels, e.g. by
+    /// PointCloud::ClusterDBSCAN. Cloud l holds the points of label l in
+    /// their original order and the noise points, labeled -1, are dropped.
+    static std::shared_ptr<PointCloudBatch> CreateFromLabels(
+            const PointCloud &cloud, const utility::device_vector<int> &labels);
+
+    int GetNumClouds() const { return offsets_.size() - 1; }
+    size_t GetNumPoints() const { return points_.size(); }
+    bool HasNormals() const {
+        return !points_.empty() && normals_.size() == points_.size();
+    }
+    bool HasColors() const {
+        return !points_.empty() && colors_.size() == points_.size();
+    }
+    bool IsEmpty() const { return points_.empty(); }
+    void Clear();
+
+    thrust::host_vector<int> GetOffsets() const;
+    /// Index of the cloud of every point.
+    utility::device_vector<int> GetLabels() const;
+
+    std::shared_ptr<PointCloud> GetCloud(int i) const;
+    std::vector<std::shared_ptr<PointCloud>> Split() const;
+    /// The concatenated cloud.
+    std::shared_ptr<PointCloud> ToPointCloud() const;
+
+    /// Transforms cloud i by transformations[i], its normals included.
+    PointCloudBatch &Transform(
+            const std::vector<Eigen::Matrix4f_u> &transformations);
+
+    /// Voxel down sampling of every cloud on a grid shared by all of them,
+    /// the points of different clouds never being merged. The output
+    /// voxels of each cloud are sorted by their index.
+    std::shared_ptr<PointCloudBatch> VoxelDownSample(float voxel_size) const;
+
+    /// Normals from the \p knn nearest neighbors of every point within its
+    /// own cloud, found by SearchKNNBatched. The points of the clouds with
+    /// less than 3 points get (0, 0, 1).
+    bool EstimateNormals(int knn = 30);
+
+    /// Box aligned with the principal axes of every cloud, from
+    /// OrientedBoundingBox::CreateFromPointClusters. The boxes of the empty
+    /// clouds are empty.
+    std::vector<OrientedBoundingBox> GetOrientedBoundingBoxes() const;
+
+public:
+    utility::device_vector<Eigen::Vector3f> points_;
+    utility::device_vector<Eigen::Vector3f> normals_;
+    utility::device_vector<Eigen::Vector3f> colors_;
+    utility::device_vector<int> offsets_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
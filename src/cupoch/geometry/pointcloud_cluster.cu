@@ -1,6 +1,22 @@
+#include <thrust/binary_search.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <climits>
+
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/geometry/voxel_hash_index.h"
+#include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/profiler.h"
+#include "cupoch/utility/union_find.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -8,88 +24,149 @@ using namespace cupoch::geometry;
 namespace {
 
 struct compute_vertex_degree_functor {
-    compute_vertex_degree_functor(int *indices, int min_points, int max_edges)
-     : indices_(indices), min_points_(min_points), max_edges_(max_edges) {};
+    compute_vertex_degree_functor(const int *offsets, int *indices, int min_points)
+     : offsets_(offsets), indices_(indices), min_points_(min_points) {};
+    const int *offsets_;
     int *indices_;
     const int min_points_;
-    const int max_edges_;
     __device__ int operator() (size_t idx) const {
         int count = 0;
-        for (int k = 0; k < max_edges_; k++) {
-            if (indices_[idx * max_edges_ + k] >= 0) {
-                if (indices_[idx * max_edges_ + k] == idx) {
-                    indices_[idx * max_edges_ + k] = -1;
-                } else {
-                    count++;
-                }
+        for (int k = offsets_[idx]; k < offsets_[idx + 1]; k++) {
+            if (indices_[k] == idx) {
+                indices_[k] = -1;
+            } else {
+                count++;
             }
         }
         if (count >= min_points_) return count;
-        for (int k = 0; k < max_edges_; k++) {
-            indices_[idx * max_edges_ + k] = -1;
+        for (int k = offsets_[idx]; k < offsets_[idx + 1]; k++) {
+            indices_[k] = -1;
         }
         return 0;
     }
 };
 
-struct bfs_functor {
-    bfs_functor(const int *vertex_degrees, const int *exscan_vd,
-                const int *indices, int* xa, int *fa)
-                : vertex_degrees_(vertex_degrees), exscan_vd_(exscan_vd),
-                  indices_(indices), xa_(xa), fa_(fa) {};
+struct union_core_points_functor {
+    union_core_points_functor(const int *vertex_degrees, const int *exscan_vd,
+                              const int *indices, int min_points, int *parents)
+                              : vertex_degrees_(vertex_degrees), exscan_vd_(exscan_vd),
+                                indices_(indices), min_points_(min_points), parents_(parents) {};
     const int *vertex_degrees_;
     const int *exscan_vd_;
     const int *indices_;
-    int* xa_;
-    int* fa_;
+    const int min_points_;
+    int *parents_;
     __device__ void operator() (size_t idx) const {
-        if (fa_[idx] == 1) {
-            fa_[idx] = 0;
-            xa_[idx] = 1;
-            for (int i = 0; i < vertex_degrees_[idx]; i++) {
-                if (xa_[indices_[exscan_vd_[idx] + i]] == 0) {
-                    fa_[indices_[exscan_vd_[idx] + i]] = 1;
-                }
-            }
+        if (vertex_degrees_[idx] < min_points_) return;
+        for (int i = 0; i < vertex_degrees_[idx]; i++) {
+            const int j = indices_[exscan_vd_[idx] + i];
+            if (vertex_degrees_[j] < min_points_) continue;
+            utility::UnionRoots(parents_, idx, j);
         }
     }
 };
 
-struct set_label_functor {
-    set_label_functor(const int *xa, int cluster, int *clusters, int *visited)
-     : xa_(xa), cluster_(cluster), clusters_(clusters), visited_(visited) {};
-    const int *xa_;
-    const int cluster_;
-    int *clusters_;
-    int *visited_;
+struct assign_border_points_functor {
+    assign_border_points_functor(const int *vertex_degrees, const int *exscan_vd,
+                                 const int *indices, int min_points, int *parents,
+                                 int *border_roots)
+                                 : vertex_degrees_(vertex_degrees), exscan_vd_(exscan_vd),
+                                   indices_(indices), min_points_(min_points), parents_(parents),
+                                   border_roots_(border_roots) {};
+    const int *vertex_degrees_;
+    const int *exscan_vd_;
+    const int *indices_;
+    const int min_points_;
+    int *parents_;
+    int *border_roots_;
     __device__ void operator() (size_t idx) const {
-        if (xa_[idx] == 1) {
-            clusters_[idx] = cluster_;
-            visited_[idx] = 1;
+        if (vertex_degrees_[idx] < min_points_) return;
+        const int root = utility::FindRoot(parents_, idx);
+        parents_[idx] = root;
+        border_roots_[idx] = root;
+        for (int i = 0; i < vertex_degrees_[idx]; i++) {
+            const int j = indices_[exscan_vd_[idx] + i];
+            if (vertex_degrees_[j] < min_points_) atomicMin(&border_roots_[j], root);
         }
     }
 };
 
+struct is_cluster_root_functor {
+    is_cluster_root_functor(const int *border_roots) : border_roots_(border_roots) {};
+    const int *border_roots_;
+    __device__ int operator() (size_t idx) const {
+        return (border_roots_[idx] == idx) ? 1 : 0;
+    }
+};
+
+struct set_label_functor {
+    set_label_functor(const int *border_roots, const int *cluster_ids)
+     : border_roots_(border_roots), cluster_ids_(cluster_ids) {};
+    const int *border_roots_;
+    const int *cluster_ids_;
+    __device__ int operator() (size_t idx) const {
+        const int root = border_roots_[idx];
+        return (root == INT_MAX) ? -1 : cluster_ids_[root];
+    }
+};
+
+struct compute_voxel_code_functor {
+    compute_voxel_code_functor(const Eigen::Vector3f &origin, float voxel_size)
+        : origin_(origin), voxel_size_(voxel_size) {};
+    const Eigen::Vector3f origin_;
+    const float voxel_size_;
+    __device__ MortonCode operator() (const Eigen::Vector3f &pt) const {
+        const Eigen::Vector3f ref_coord = (pt - origin_) / voxel_size_;
+        return EncodeMorton(Eigen::Vector3i(int(floor(ref_coord(0))),
+                                            int(floor(ref_coord(1))),
+                                            int(floor(ref_coord(2)))));
+    }
+};
+
+struct cluster_size_in_range_functor {
+    cluster_size_in_range_functor(int min_size, int max_size)
+     : min_size_(min_size), max_size_(max_size) {};
+    const int min_size_;
+    const int max_size_;
+    __device__ bool operator() (int count) const {
+        return count >= min_size_ && count <= max_size_;
+    }
+};
+
 }  // namespace
 
 // https://www.sciencedirect.com/science/article/pii/S1877050913003438
 utility::device_vector<int> PointCloud::ClusterDBSCAN(
-        float eps, size_t min_points, bool print_progress, size_t max_edges) const {
+        float eps, size_t min_points, bool print_progress, size_t max_edges,
+        SearchIndexType index_type) const {
+    utility::Workspace workspace;
+    return ClusterDBSCAN(workspace, eps, min_points, print_progress, max_edges,
+                         index_type);
+}
+
+utility::device_vector<int> PointCloud::ClusterDBSCAN(
+        utility::Workspace &workspace,
+        float eps, size_t min_points, bool print_progress, size_t max_edges,
+        SearchIndexType index_type) const {
+    CUPOCH_PROFILE("PointCloud::ClusterDBSCAN");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
     // precompute all neighbours
     utility::LogDebug("Precompute Neighbours");
-    utility::ConsoleProgressBar progress_bar(
-            points_.size(), "Precompute Neighbours", print_progress);
+    utility::ConsoleProgressBar progress_bar(2, "Clustering", print_progress);
 
     const size_t n_pt = points_.size();
     // Graph construction
-    utility::device_vector<int> vertex_degrees(n_pt);
-    utility::device_vector<int> exscan_vd(n_pt);
-    utility::device_vector<int> indices;
-    utility::device_vector<float> distances;
-    KDTreeFlann kdtree(*this);
-    kdtree.SearchHybrid(points_, eps, max_edges + 1, indices, distances);
-    compute_vertex_degree_functor vd_func(thrust::raw_pointer_cast(indices.data()),
-                                          min_points, max_edges + 1);
+    auto &vertex_degrees = workspace.GetBuffer<int>("dbscan_vertex_degrees", n_pt);
+    auto &exscan_vd = workspace.GetBuffer<int>("dbscan_exscan_vd", n_pt);
+    auto &offsets = workspace.GetBuffer<int>("dbscan_offsets", 0);
+    auto &indices = workspace.GetBuffer<int>("dbscan_indices", 0);
+    auto &distances = workspace.GetBuffer<float>("dbscan_distances", 0);
+    SearchNeighborsCSR(index_type, points_, points_, eps, max_edges + 1,
+                       offsets, indices, distances, &workspace);
+    compute_vertex_degree_functor vd_func(thrust::raw_pointer_cast(offsets.data()),
+                                          thrust::raw_pointer_cast(indices.data()),
+                                          min_points);
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
                       thrust::make_counting_iterator(n_pt), vertex_degrees.begin(), vd_func);
     thrust::exclusive_scan(vertex_degrees.begin(), vertex_degrees.end(), exscan_vd.begin(), 0);
@@ -97,38 +174,96 @@ utility::device_vector<int> PointCloud::ClusterDBSCAN(
                                  [] __device__ (int idx) {return idx < 0;});
     indices.resize(thrust::distance(indices.begin(), end));
 
+    ++progress_bar;
+
     // Cluster identification
-    int cluster = 0;
-    utility::device_vector<int> visited(n_pt, 0);
-    utility::pinned_host_vector<int> h_visited(n_pt, 0);
-    utility::device_vector<int> clusters(n_pt, -1);
-    utility::device_vector<int> xa(n_pt);
-    utility::device_vector<int> fa(n_pt);
-    for (int i = 0; i < n_pt; i++) {
-        ++progress_bar;
-        if (h_visited[i] != 1) {
-            thrust::fill_n(make_tuple_iterator(visited.begin() + i, clusters.begin() + i),
-                           1, thrust::make_tuple(1, cluster));
-            thrust::fill(make_tuple_begin(xa, fa), make_tuple_end(xa, fa), thrust::make_tuple(0, 0));
-            fa[i] = 1;
-            while (thrust::find(fa.begin(), fa.end(), 1) != fa.end()) {
-                bfs_functor bfs_func(thrust::raw_pointer_cast(vertex_degrees.data()),
-                                     thrust::raw_pointer_cast(exscan_vd.data()),
-                                     thrust::raw_pointer_cast(indices.data()),
-                                     thrust::raw_pointer_cast(xa.data()),
-                                     thrust::raw_pointer_cast(fa.data()));
-                thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                                 thrust::make_counting_iterator(n_pt),
-                                 bfs_func);
-            }
-            set_label_functor sl_func(thrust::raw_pointer_cast(xa.data()), cluster,
-                                      thrust::raw_pointer_cast(clusters.data()),
-                                      thrust::raw_pointer_cast(visited.data()));
-            thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                             thrust::make_counting_iterator(n_pt), sl_func);
-            h_visited = visited;
-            cluster++;
-        }
-    }
+    // Core points are joined by a union-find over the core-core edges and
+    // each border point takes the cluster of one of its core neighbors, so
+    // the number of kernel launches does not depend on the cluster count.
+    utility::LogDebug("Union Core Points");
+    auto &parents = workspace.GetBuffer<int>("dbscan_parents", n_pt);
+    thrust::sequence(parents.begin(), parents.end());
+    union_core_points_functor uc_func(thrust::raw_pointer_cast(vertex_degrees.data()),
+                                      thrust::raw_pointer_cast(exscan_vd.data()),
+                                      thrust::raw_pointer_cast(indices.data()),
+                                      min_points,
+                                      thrust::raw_pointer_cast(parents.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_pt), uc_func);
+    auto &border_roots = workspace.GetBuffer<int>("dbscan_border_roots", n_pt);
+    thrust::fill(border_roots.begin(), border_roots.end(), INT_MAX);
+    assign_border_points_functor ab_func(thrust::raw_pointer_cast(vertex_degrees.data()),
+                                         thrust::raw_pointer_cast(exscan_vd.data()),
+                                         thrust::raw_pointer_cast(indices.data()),
+                                         min_points,
+                                         thrust::raw_pointer_cast(parents.data()),
+                                         thrust::raw_pointer_cast(border_roots.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_pt), ab_func);
+    auto &cluster_ids = workspace.GetBuffer<int>("dbscan_cluster_ids", n_pt);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_pt), cluster_ids.begin(),
+                      is_cluster_root_functor(thrust::raw_pointer_cast(border_roots.data())));
+    thrust::exclusive_scan(cluster_ids.begin(), cluster_ids.end(), cluster_ids.begin(), 0);
+    utility::device_vector<int> clusters(n_pt);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_pt), clusters.begin(),
+                      set_label_functor(thrust::raw_pointer_cast(border_roots.data()),
+                                        thrust::raw_pointer_cast(cluster_ids.data())));
+    ++progress_bar;
     return clusters;
-}
\ No newline at end of file
+}
+
+std::tuple<utility::device_vector<int>, utility::device_vector<int>>
+PointCloud::ClusterEuclidean(float tolerance, size_t min_size, size_t max_size) const {
+    utility::device_vector<int> indices;
+    utility::device_vector<int> offsets(1, 0);
+    if (tolerance <= 0.0) {
+        utility::LogError("[ClusterEuclidean] tolerance must be positive.");
+        return std::make_tuple(indices, offsets);
+    }
+    if (!HasPoints()) return std::make_tuple(indices, offsets);
+    const size_t n_pt = points_.size();
+
+    // Label the voxels and map every point to the label of its voxel.
+    auto voxel_grid = VoxelGrid::CreateFromPointCloud(*this, tolerance);
+    const utility::device_vector<int> voxel_labels = voxel_grid->ConnectedComponents(26);
+    utility::device_vector<MortonCode> voxel_codes(voxel_grid->voxels_keys_.size());
+    thrust::transform(voxel_grid->voxels_keys_.begin(), voxel_grid->voxels_keys_.end(),
+                      voxel_codes.begin(), encode_morton_functor());
+    utility::device_vector<MortonCode> point_codes(n_pt);
+    thrust::transform(points_.begin(), points_.end(), point_codes.begin(),
+                      compute_voxel_code_functor(voxel_grid->origin_, voxel_grid->voxel_size_));
+    utility::device_vector<int> voxel_indices(n_pt);
+    thrust::lower_bound(voxel_codes.begin(), voxel_codes.end(),
+                        point_codes.begin(), point_codes.end(), voxel_indices.begin());
+    utility::device_vector<int> labels(n_pt);
+    thrust::gather(voxel_indices.begin(), voxel_indices.end(), voxel_labels.begin(),
+                   labels.begin());
+
+    // Group the points by cluster and drop the clusters out of the size range.
+    indices.resize(n_pt);
+    thrust::sequence(indices.begin(), indices.end());
+    thrust::sort_by_key(labels.begin(), labels.end(), indices.begin());
+    utility::device_vector<int> counts(n_pt);
+    auto end = thrust::reduce_by_key(labels.begin(), labels.end(),
+                                     thrust::make_constant_iterator(1),
+                                     thrust::make_discard_iterator(), counts.begin());
+    counts.resize(thrust::distance(counts.begin(), end.second));
+    const int max_size_i = int(std::min(max_size, size_t(std::numeric_limits<int>::max())));
+    cluster_size_in_range_functor range_func(int(min_size), max_size_i);
+    utility::device_vector<int> kept_indices(n_pt);
+    auto end_idx = thrust::copy_if(indices.begin(), indices.end(),
+                                   thrust::make_permutation_iterator(counts.begin(), labels.begin()),
+                                   kept_indices.begin(), range_func);
+    kept_indices.resize(thrust::distance(kept_indices.begin(), end_idx));
+    utility::device_vector<int> kept_counts(counts.size() + 1, 0);
+    auto end_cnt = thrust::copy_if(counts.begin(), counts.end(), kept_counts.begin(), range_func);
+    const size_t n_clusters = thrust::distance(kept_counts.begin(), end_cnt);
+    kept_counts.resize(n_clusters + 1);
+    kept_counts[n_clusters] = 0;
+    offsets.resize(n_clusters + 1);
+    thrust::exclusive_scan(kept_counts.begin(), kept_counts.end(), offsets.begin());
+    utility::LogDebug("[ClusterEuclidean] {:d} clusters are extracted.", (int)n_clusters);
+    return std::make_tuple(kept_indices, offsets);
+}
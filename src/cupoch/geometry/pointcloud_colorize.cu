@@ -0,0 +1,202 @@
+#include <thrust/fill.h>
+
+#include <algorithm>
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/launch_tuner.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct colorize_camera {
+    Eigen::Matrix4f_u extrinsic_;
+    float fx_;
+    float fy_;
+    float cx_;
+    float cy_;
+    int width_;
+    int height_;
+    int num_of_channels_;
+    int bytes_per_channel_;
+    const uint8_t *image_;
+    /// Depth buffer of the camera, the bits of the positive float depths.
+    unsigned int *depth_buffer_;
+
+    /// Pixel and depth of \p point, the depth being zero behind the camera.
+    __device__ Eigen::Vector3f Project(const Eigen::Vector3f &point) const {
+        const Eigen::Vector4f q = extrinsic_ * point.homogeneous();
+        if (!(q[2] > 0.0f)) return Eigen::Vector3f::Zero();
+        return Eigen::Vector3f(fx_ * q[0] / q[2] + cx_,
+                               fy_ * q[1] / q[2] + cy_, q[2]);
+    }
+
+    __device__ Eigen::Vector3f ColorAt(int u, int v) const {
+        const int i = (v * width_ + u) * num_of_channels_;
+        if (bytes_per_channel_ == 1) {
+            const float inv = 1.0f / 255.0f;
+            if (num_of_channels_ == 1) {
+                return Eigen::Vector3f::Constant(image_[i] * inv);
+            }
+            return Eigen::Vector3f(image_[i], image_[i + 1], image_[i + 2]) *
+                   inv;
+        }
+        const float *image = (const float *)image_;
+        if (num_of_channels_ == 1) return Eigen::Vector3f::Constant(image[i]);
+        return Eigen::Vector3f(image[i], image[i + 1], image[i + 2]);
+    }
+};
+
+// Thread idx splats the point idx % n_points into the camera
+// idx / n_points, so that the threads of a warp read consecutive points.
+struct splat_depth_functor {
+    splat_depth_functor(const Eigen::Vector3f *points,
+                        int n_points,
+                        const colorize_camera *cameras,
+                        int splat_radius)
+        : points_(points),
+          n_points_(n_points),
+          cameras_(cameras),
+          splat_radius_(splat_radius){};
+    const Eigen::Vector3f *points_;
+    const int n_points_;
+    const colorize_camera *cameras_;
+    const int splat_radius_;
+    __device__ void operator()(size_t idx) const {
+        const colorize_camera &cam = cameras_[idx / n_points_];
+        const Eigen::Vector3f uvz = cam.Project(points_[idx % n_points_]);
+        if (uvz[2] <= 0.0f) return;
+        const int u = floorf(uvz[0] + 0.5f);
+        const int v = floorf(uvz[1] + 0.5f);
+        if (u < 0 || u >= cam.width_ || v < 0 || v >= cam.height_) return;
+        const unsigned int z = __float_as_uint(uvz[2]);
+        for (int y = max(v - splat_radius_, 0);
+             y <= min(v + splat_radius_, cam.height_ - 1); ++y) {
+            for (int x = max(u - splat_radius_, 0);
+                 x <= min(u + splat_radius_, cam.width_ - 1); ++x) {
+                atomicMin(&cam.depth_buffer_[y * cam.width_ + x], z);
+            }
+        }
+    }
+};
+
+struct blend_colors_functor {
+    blend_colors_functor(const Eigen::Vector3f *points,
+                         const colorize_camera *cameras,
+                         int n_cameras,
+                         float occlusion_tolerance,
+                         Eigen::Vector3f *colors)
+        : points_(points),
+          cameras_(cameras),
+          n_cameras_(n_cameras),
+          occlusion_tolerance_(occlusion_tolerance),
+          colors_(colors){};
+    const Eigen::Vector3f *points_;
+    const colorize_camera *cameras_;
+    const int n_cameras_;
+    const float occlusion_tolerance_;
+    Eigen::Vector3f *colors_;
+    __device__ void operator()(size_t idx) const {
+        Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+        float weight = 0.0f;
+        for (int c = 0; c < n_cameras_; ++c) {
+            const colorize_camera &cam = cameras_[c];
+            const Eigen::Vector3f uvz = cam.Project(points_[idx]);
+            if (uvz[2] <= 0.0f) continue;
+            const int u = floorf(uvz[0] + 0.5f);
+            const int v = floorf(uvz[1] + 0.5f);
+            if (u < 0 || u >= cam.width_ || v < 0 || v >= cam.height_) {
+                continue;
+            }
+            const float nearest = __uint_as_float(
+                    cam.depth_buffer_[v * cam.width_ + u]);
+            if (uvz[2] > nearest + occlusion_tolerance_) continue;
+            const float w = 1.0f / uvz[2];
+            sum += w * cam.ColorAt(u, v);
+            weight += w;
+        }
+        if (weight > 0.0f) colors_[idx] = sum / weight;
+    }
+};
+
+}  // namespace
+
+PointCloud &PointCloud::ColorizeFromImages(
+        const std::vector<Image> &images,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f_u> &extrinsics,
+        float occlusion_tolerance,
+        int splat_radius) {
+    if (images.size() != intrinsics.size() ||
+        images.size() != extrinsics.size()) {
+        utility::LogError(
+                "[ColorizeFromImages] images, intrinsics and extrinsics must "
+                "have the same size.");
+    }
+    if (!HasColors()) {
+        colors_.resize(points_.size());
+        thrust::fill(colors_.begin(), colors_.end(), Eigen::Vector3f::Zero());
+    }
+    const int n_points = points_.size();
+    const int n_cameras = images.size();
+    if (n_points == 0 || n_cameras == 0) return *this;
+
+    thrust::host_vector<colorize_camera> h_cameras(n_cameras);
+    std::vector<size_t> buffer_offsets(n_cameras + 1, 0);
+    for (int c = 0; c < n_cameras; ++c) {
+        const Image &image = images[c];
+        if ((image.num_of_channels_ != 1 && image.num_of_channels_ != 3) ||
+            (image.bytes_per_channel_ != 1 && image.bytes_per_channel_ != 4)) {
+            utility::LogError(
+                    "[ColorizeFromImages] Unsupported image format of camera "
+                    "{}.",
+                    c);
+        }
+        if (image.width_ != intrinsics[c].width_ ||
+            image.height_ != intrinsics[c].height_) {
+            utility::LogError(
+                    "[ColorizeFromImages] The image of camera {} does not "
+                    "match its intrinsic.",
+                    c);
+        }
+        buffer_offsets[c + 1] =
+                buffer_offsets[c] + size_t(image.width_) * image.height_;
+    }
+    utility::device_vector<unsigned int> depth_buffers(
+            buffer_offsets[n_cameras], ~0u);
+    for (int c = 0; c < n_cameras; ++c) {
+        const Image &image = images[c];
+        colorize_camera &cam = h_cameras[c];
+        cam.extrinsic_ = extrinsics[c];
+        cam.fx_ = intrinsics[c].intrinsic_matrix_(0, 0);
+        cam.fy_ = intrinsics[c].intrinsic_matrix_(1, 1);
+        cam.cx_ = intrinsics[c].intrinsic_matrix_(0, 2);
+        cam.cy_ = intrinsics[c].intrinsic_matrix_(1, 2);
+        cam.width_ = image.width_;
+        cam.height_ = image.height_;
+        cam.num_of_channels_ = image.num_of_channels_;
+        cam.bytes_per_channel_ = image.bytes_per_channel_;
+        cam.image_ = thrust::raw_pointer_cast(image.data_.data());
+        cam.depth_buffer_ = thrust::raw_pointer_cast(depth_buffers.data()) +
+                            buffer_offsets[c];
+    }
+    utility::device_vector<colorize_camera> cameras = h_cameras;
+
+    splat_depth_functor splat(thrust::raw_pointer_cast(points_.data()),
+                              n_points,
+                              thrust::raw_pointer_cast(cameras.data()),
+                              std::max(splat_radius, 0));
+    utility::TunedForEach("PointCloud::ColorizeFromImages::Splat",
+                          size_t(n_points) * n_cameras, splat);
+    blend_colors_functor blend(thrust::raw_pointer_cast(points_.data()),
+                               thrust::raw_pointer_cast(cameras.data()),
+                               n_cameras, occlusion_tolerance,
+                               thrust::raw_pointer_cast(colors_.data()));
+    utility::TunedForEach("PointCloud::ColorizeFromImages::Blend", n_points,
+                          blend);
+    return *this;
+}
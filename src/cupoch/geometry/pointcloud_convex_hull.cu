@@ -0,0 +1,686 @@
+#include <thrust/copy.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/scatter.h>
+#include <thrust/sort.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+/// Distance from a face above which a point is outside, relative to the
+/// diameter of its cluster.
+constexpr float kHullTolerance = 1.0e-5f;
+constexpr int kUnassignedFace = -2;
+
+struct hull_face {
+    Eigen::Vector3i vertices_;
+    /// Face across the edge (vertices_[i], vertices_[i + 1]).
+    Eigen::Vector3i neighbors_;
+    /// Outward unit normal and offset, in the frame of the cluster.
+    Eigen::Vector4f plane_;
+    int cluster_;
+    bool alive_;
+};
+
+struct hull_horizon_edge {
+    int start_;
+    int end_;
+    int neighbor_;
+};
+
+struct argmax_score_functor {
+    __device__ thrust::tuple<float, int> operator()(
+            const thrust::tuple<float, int> &a,
+            const thrust::tuple<float, int> &b) const {
+        const bool take_b = thrust::get<0>(b) > thrust::get<0>(a) ||
+                            (thrust::get<0>(b) == thrust::get<0>(a) &&
+                             thrust::get<1>(b) < thrust::get<1>(a));
+        return take_b ? b : a;
+    }
+};
+
+// Scores of the points for the vertices of the initial simplex: the lowest
+// x, then the farthest from the first vertex, from the line of the first
+// two and from the plane of the first three.
+struct simplex_score_functor {
+    simplex_score_functor(const Eigen::Vector3f *points,
+                          const int *labels,
+                          const Eigen::Vector3f *origins,
+                          const Eigen::Vector3f *directions,
+                          int stage)
+        : points_(points),
+          labels_(labels),
+          origins_(origins),
+          directions_(directions),
+          stage_(stage){};
+    const Eigen::Vector3f *points_;
+    const int *labels_;
+    const Eigen::Vector3f *origins_;
+    const Eigen::Vector3f *directions_;
+    const int stage_;
+    __device__ thrust::tuple<float, int> operator()(int idx) const {
+        const int c = labels_[idx];
+        const Eigen::Vector3f d = points_[idx] - origins_[c];
+        float score;
+        switch (stage_) {
+            case 0:
+                score = -points_[idx][0];
+                break;
+            case 1:
+                score = d.squaredNorm();
+                break;
+            case 2:
+                score = d.cross(directions_[c]).squaredNorm();
+                break;
+            default:
+                score = abs(d.dot(directions_[c]));
+                break;
+        }
+        return thrust::make_tuple(score, idx);
+    }
+};
+
+// Assigns the points of the dead faces to the farthest candidate face they
+// are above, if any, and keeps the farthest point of each face.
+struct assign_hull_face_functor {
+    assign_hull_face_functor(const Eigen::Vector3f *points,
+                             const int *labels,
+                             const Eigen::Vector4f *planes,
+                             const bool *alive,
+                             const int *candidate_offsets,
+                             const int *candidates,
+                             const float *tolerances,
+                             int *faces,
+                             unsigned long long *farthest)
+        : points_(points),
+          labels_(labels),
+          planes_(planes),
+          alive_(alive),
+          candidate_offsets_(candidate_offsets),
+          candidates_(candidates),
+          tolerances_(tolerances),
+          faces_(faces),
+          farthest_(farthest){};
+    const Eigen::Vector3f *points_;
+    const int *labels_;
+    const Eigen::Vector4f *planes_;
+    const bool *alive_;
+    const int *candidate_offsets_;
+    const int *candidates_;
+    const float *tolerances_;
+    int *faces_;
+    unsigned long long *farthest_;
+    __device__ void operator()(int idx) const {
+        int f = faces_[idx];
+        if (f == -1) return;
+        const Eigen::Vector4f p = points_[idx].homogeneous();
+        float d;
+        if (f >= 0 && alive_[f]) {
+            d = planes_[f].dot(p);
+        } else {
+            const int c = labels_[idx];
+            f = -1;
+            d = tolerances_[c];
+            for (int k = candidate_offsets_[c]; k < candidate_offsets_[c + 1];
+                 ++k) {
+                const int g = candidates_[k];
+                if (!alive_[g]) continue;
+                const float dg = planes_[g].dot(p);
+                if (dg > d) {
+                    d = dg;
+                    f = g;
+                }
+            }
+            faces_[idx] = f;
+            if (f < 0) return;
+        }
+        // Positive floats order like their bits.
+        const unsigned long long key =
+                (static_cast<unsigned long long>(__float_as_uint(d)) << 32) |
+                static_cast<unsigned int>(idx);
+        atomicMax(&farthest_[f], key);
+    }
+};
+
+// Point idx % (n + 1) of the cloud seen from the viewpoint idx / (n + 1)
+// flipped about the sphere of radius, the last one being the viewpoint.
+struct spherical_flip_functor {
+    spherical_flip_functor(const Eigen::Vector3f *points,
+                           const Eigen::Vector3f *viewpoints,
+                           int n_points,
+                           float radius)
+        : points_(points),
+          viewpoints_(viewpoints),
+          n_points_(n_points),
+          radius_(radius){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3f *viewpoints_;
+    const int n_points_;
+    const float radius_;
+    __device__ thrust::tuple<Eigen::Vector3f, int> operator()(int idx) const {
+        const int v = idx / (n_points_ + 1);
+        const int i = idx % (n_points_ + 1);
+        if (i == n_points_) {
+            return thrust::make_tuple(Eigen::Vector3f::Zero().eval(), v);
+        }
+        const Eigen::Vector3f p = points_[i] - viewpoints_[v];
+        const float norm = p.norm();
+        // The points at the viewpoint stay on it, inside the hull.
+        if (norm == 0.0f) return thrust::make_tuple(p, v);
+        return thrust::make_tuple(
+                (p + 2.0f * (radius_ - norm) / norm * p).eval(), v);
+    }
+};
+
+// Farthest point of each cluster by the scores of stage, -1 for the empty
+// clusters.
+void FindSimplexVertices(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<int> &labels,
+        const utility::device_vector<Eigen::Vector3f> &origins,
+        const utility::device_vector<Eigen::Vector3f> &directions,
+        int stage,
+        size_t n_clusters,
+        thrust::host_vector<float> &scores,
+        thrust::host_vector<int> &vertices) {
+    utility::device_vector<int> keys(n_clusters);
+    utility::device_vector<float> best_scores(n_clusters);
+    utility::device_vector<int> best_vertices(n_clusters);
+    auto end = thrust::reduce_by_key(
+            labels.begin(), labels.end(),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<int>(0),
+                    simplex_score_functor(
+                            thrust::raw_pointer_cast(points.data()),
+                            thrust::raw_pointer_cast(labels.data()),
+                            thrust::raw_pointer_cast(origins.data()),
+                            thrust::raw_pointer_cast(directions.data()),
+                            stage)),
+            keys.begin(), make_tuple_begin(best_scores, best_vertices),
+            thrust::equal_to<int>(), argmax_score_functor());
+    const size_t n_keys = thrust::distance(keys.begin(), end.first);
+    resize_all(n_keys, keys, best_scores, best_vertices);
+    thrust::host_vector<int> h_keys = keys;
+    thrust::host_vector<float> h_scores = best_scores;
+    thrust::host_vector<int> h_vertices = best_vertices;
+    scores.assign(n_clusters, 0.0f);
+    vertices.assign(n_clusters, -1);
+    for (size_t i = 0; i < n_keys; ++i) {
+        scores[h_keys[i]] = h_scores[i];
+        vertices[h_keys[i]] = h_vertices[i];
+    }
+}
+
+thrust::host_vector<Eigen::Vector3f> GatherPoints(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const thrust::host_vector<int> &indices) {
+    thrust::host_vector<int> valid = indices;
+    for (auto &i : valid) i = std::max(i, 0);
+    utility::device_vector<int> d_indices = valid;
+    utility::device_vector<Eigen::Vector3f> res(valid.size());
+    thrust::gather(d_indices.begin(), d_indices.end(), points.begin(),
+                   res.begin());
+    return res;
+}
+
+Eigen::Vector4f FacePlane(const Eigen::Vector3f &a,
+                          const Eigen::Vector3f &b,
+                          const Eigen::Vector3f &c) {
+    Eigen::Vector3f n = (b - a).cross(c - a);
+    const float norm = n.norm();
+    // Slivers never see a point.
+    n = (norm > 0.0f) ? (n / norm).eval() : Eigen::Vector3f::Zero();
+    return Eigen::Vector4f(n[0], n[1], n[2], -n.dot(a));
+}
+
+class QuickHull {
+public:
+    int AddFace(int a, int b, int c, int cluster) {
+        hull_face f;
+        f.vertices_ = Eigen::Vector3i(a, b, c);
+        f.neighbors_ = Eigen::Vector3i::Constant(-1);
+        f.plane_ = FacePlane(positions_.at(a), positions_.at(b),
+                             positions_.at(c));
+        f.cluster_ = cluster;
+        f.alive_ = true;
+        faces_.push_back(f);
+        return int(faces_.size()) - 1;
+    }
+
+    /// Tetrahedron of a, b, c, d, with d below the face a, b, c.
+    void AddSimplex(int a, int b, int c, int d, int cluster,
+                    std::vector<int> &new_faces) {
+        const int f[4] = {AddFace(a, b, c, cluster), AddFace(a, d, b, cluster),
+                          AddFace(b, d, c, cluster), AddFace(a, c, d, cluster)};
+        std::unordered_map<unsigned long long, int> edges;
+        auto edge_key = [](int s, int e) {
+            return (static_cast<unsigned long long>(s) << 32) |
+                   static_cast<unsigned int>(e);
+        };
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                const Eigen::Vector3i &v = faces_[f[i]].vertices_;
+                edges[edge_key(v[j], v[(j + 1) % 3])] = f[i];
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                const Eigen::Vector3i &v = faces_[f[i]].vertices_;
+                faces_[f[i]].neighbors_[j] =
+                        edges.at(edge_key(v[(j + 1) % 3], v[j]));
+            }
+            new_faces.push_back(f[i]);
+        }
+    }
+
+    /// Replaces the faces visible from the point eye, above face, by the
+    /// cone of the horizon to eye.
+    void AddPoint(int face, int eye, std::vector<int> &new_faces) {
+        const Eigen::Vector4f p = positions_.at(eye).homogeneous();
+        const int cluster = faces_[face].cluster_;
+        std::unordered_set<int> visible = {face};
+        std::vector<int> stack = {face};
+        std::vector<hull_horizon_edge> horizon;
+        while (!stack.empty()) {
+            const int f = stack.back();
+            stack.pop_back();
+            for (int i = 0; i < 3; ++i) {
+                const int g = faces_[f].neighbors_[i];
+                if (g < 0 || visible.count(g) > 0) continue;
+                if (faces_[g].plane_.dot(p) > 0.0f) {
+                    visible.insert(g);
+                    stack.push_back(g);
+                }
+            }
+        }
+        for (int f : visible) {
+            const hull_face &hf = faces_[f];
+            for (int i = 0; i < 3; ++i) {
+                if (visible.count(hf.neighbors_[i]) > 0) continue;
+                horizon.push_back({hf.vertices_[i], hf.vertices_[(i + 1) % 3],
+                                   hf.neighbors_[i]});
+            }
+        }
+        for (int f : visible) faces_[f].alive_ = false;
+
+        std::unordered_map<int, int> by_start, by_end;
+        std::vector<int> cone;
+        for (const auto &h : horizon) {
+            const int id = AddFace(h.start_, h.end_, eye, cluster);
+            faces_[id].neighbors_[0] = h.neighbor_;
+            if (h.neighbor_ >= 0) {
+                hull_face &g = faces_[h.neighbor_];
+                for (int j = 0; j < 3; ++j) {
+                    if (g.vertices_[j] == h.end_ &&
+                        g.vertices_[(j + 1) % 3] == h.start_) {
+                        g.neighbors_[j] = id;
+                    }
+                }
+            }
+            by_start[h.start_] = id;
+            by_end[h.end_] = id;
+            cone.push_back(id);
+        }
+        for (int id : cone) {
+            hull_face &f = faces_[id];
+            auto next = by_start.find(f.vertices_[1]);
+            auto prev = by_end.find(f.vertices_[0]);
+            f.neighbors_[1] = (next != by_start.end()) ? next->second : -1;
+            f.neighbors_[2] = (prev != by_end.end()) ? prev->second : -1;
+            new_faces.push_back(id);
+        }
+    }
+
+    std::vector<hull_face> faces_;
+    /// Positions of the vertices, in the frames of their clusters.
+    std::unordered_map<int, Eigen::Vector3f> positions_;
+};
+
+/// QuickHull of each cluster, all clusters at once. The device assigns the
+/// points to the faces and finds the farthest point of each face, the host
+/// updates the handful of faces around the new vertices.
+void ComputeConvexHullsImpl(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<int> &labels,
+        size_t n_clusters,
+        std::vector<std::shared_ptr<TriangleMesh>> &meshes,
+        std::vector<thrust::host_vector<size_t>> &indices) {
+    meshes.resize(n_clusters);
+    indices.resize(n_clusters);
+    for (auto &m : meshes) m = std::make_shared<TriangleMesh>();
+    if (n_clusters == 0) return;
+
+    // Points of the clusters, grouped by cluster.
+    utility::device_vector<int> order(points.size());
+    utility::device_vector<int> sorted_labels(points.size());
+    auto end = thrust::copy_if(
+            make_tuple_iterator(labels.begin(),
+                                thrust::make_counting_iterator<int>(0)),
+            make_tuple_iterator(labels.end(),
+                                thrust::make_counting_iterator<int>(
+                                        points.size())),
+            labels.begin(), make_tuple_begin(sorted_labels, order),
+            [] __device__(int l) { return l >= 0; });
+    const size_t n = thrust::distance(make_tuple_begin(sorted_labels, order),
+                                      end);
+    resize_all(n, sorted_labels, order);
+    thrust::stable_sort_by_key(sorted_labels.begin(), sorted_labels.end(),
+                               order.begin());
+    utility::device_vector<Eigen::Vector3f> local(n);
+    thrust::gather(order.begin(), order.end(), points.begin(), local.begin());
+
+    // Initial simplex, in the frames of the clusters centered on their
+    // first vertex.
+    utility::device_vector<Eigen::Vector3f> origins(n_clusters,
+                                                    Eigen::Vector3f::Zero());
+    utility::device_vector<Eigen::Vector3f> directions(
+            n_clusters, Eigen::Vector3f::Zero());
+    thrust::host_vector<float> scores;
+    thrust::host_vector<int> v0, v1, v2, v3;
+    FindSimplexVertices(local, sorted_labels, origins, directions, 0,
+                        n_clusters, scores, v0);
+    const thrust::host_vector<Eigen::Vector3f> h_origins =
+            GatherPoints(local, v0);
+    origins = h_origins;
+    const Eigen::Vector3f *origins_ptr =
+            thrust::raw_pointer_cast(origins.data());
+    thrust::transform(local.begin(), local.end(), sorted_labels.begin(),
+                      local.begin(),
+                      [origins_ptr] __device__(const Eigen::Vector3f &p,
+                                               int c) {
+                          return (p - origins_ptr[c]).eval();
+                      });
+    thrust::fill(origins.begin(), origins.end(), Eigen::Vector3f::Zero());
+    FindSimplexVertices(local, sorted_labels, origins, directions, 1,
+                        n_clusters, scores, v1);
+    thrust::host_vector<float> tolerances(n_clusters);
+    for (size_t c = 0; c < n_clusters; ++c) {
+        tolerances[c] = kHullTolerance * std::sqrt(scores[c]);
+    }
+    const thrust::host_vector<Eigen::Vector3f> p1 = GatherPoints(local, v1);
+    thrust::host_vector<Eigen::Vector3f> h_directions(n_clusters);
+    for (size_t c = 0; c < n_clusters; ++c) {
+        h_directions[c] = p1[c].normalized();
+    }
+    directions = h_directions;
+    FindSimplexVertices(local, sorted_labels, origins, directions, 2,
+                        n_clusters, scores, v2);
+    const thrust::host_vector<Eigen::Vector3f> p2 = GatherPoints(local, v2);
+    thrust::host_vector<bool> valid(n_clusters);
+    for (size_t c = 0; c < n_clusters; ++c) {
+        valid[c] = v0[c] >= 0 && tolerances[c] > 0.0f &&
+                   std::sqrt(scores[c]) > tolerances[c];
+        h_directions[c] = p1[c].cross(p2[c]).normalized();
+    }
+    directions = h_directions;
+    FindSimplexVertices(local, sorted_labels, origins, directions, 3,
+                        n_clusters, scores, v3);
+    const thrust::host_vector<Eigen::Vector3f> p3 = GatherPoints(local, v3);
+
+    QuickHull hull;
+    std::vector<std::vector<int>> new_faces(n_clusters);
+    size_t n_degenerate = 0;
+    for (size_t c = 0; c < n_clusters; ++c) {
+        if (v0[c] < 0) continue;
+        if (!valid[c] || scores[c] <= tolerances[c]) {
+            ++n_degenerate;
+            continue;
+        }
+        hull.positions_[v0[c]] = Eigen::Vector3f::Zero();
+        hull.positions_[v1[c]] = p1[c];
+        hull.positions_[v2[c]] = p2[c];
+        hull.positions_[v3[c]] = p3[c];
+        if (p1[c].cross(p2[c]).dot(p3[c]) > 0.0f) {
+            hull.AddSimplex(v0[c], v2[c], v1[c], v3[c], c, new_faces[c]);
+        } else {
+            hull.AddSimplex(v0[c], v1[c], v2[c], v3[c], c, new_faces[c]);
+        }
+    }
+    if (n_degenerate > 0) {
+        utility::LogWarning(
+                "[ComputeConvexHull] {:d} clusters are flat, their hulls are "
+                "empty.",
+                n_degenerate);
+    }
+
+    utility::device_vector<float> d_tolerances = tolerances;
+    utility::device_vector<int> faces(n, kUnassignedFace);
+    utility::device_vector<Eigen::Vector4f> planes;
+    utility::device_vector<bool> alive;
+    utility::device_vector<unsigned long long> farthest;
+    utility::device_vector<int> candidate_offsets;
+    utility::device_vector<int> candidates;
+    while (true) {
+        const size_t n_uploaded = planes.size();
+        thrust::host_vector<Eigen::Vector4f> new_planes;
+        for (size_t f = n_uploaded; f < hull.faces_.size(); ++f) {
+            new_planes.push_back(hull.faces_[f].plane_);
+        }
+        planes.resize(hull.faces_.size());
+        thrust::copy(new_planes.begin(), new_planes.end(),
+                     planes.begin() + n_uploaded);
+        thrust::host_vector<bool> h_alive(hull.faces_.size());
+        for (size_t f = 0; f < hull.faces_.size(); ++f) {
+            h_alive[f] = hull.faces_[f].alive_;
+        }
+        alive = h_alive;
+        thrust::host_vector<int> h_offsets(n_clusters + 1, 0);
+        thrust::host_vector<int> h_candidates;
+        for (size_t c = 0; c < n_clusters; ++c) {
+            for (int f : new_faces[c]) {
+                if (hull.faces_[f].alive_) h_candidates.push_back(f);
+            }
+            h_offsets[c + 1] = h_candidates.size();
+        }
+        candidate_offsets = h_offsets;
+        candidates = h_candidates;
+        farthest.resize(hull.faces_.size());
+        thrust::fill(farthest.begin(), farthest.end(), 0);
+        thrust::for_each(
+                thrust::make_counting_iterator<int>(0),
+                thrust::make_counting_iterator<int>(n),
+                assign_hull_face_functor(
+                        thrust::raw_pointer_cast(local.data()),
+                        thrust::raw_pointer_cast(sorted_labels.data()),
+                        thrust::raw_pointer_cast(planes.data()),
+                        thrust::raw_pointer_cast(alive.data()),
+                        thrust::raw_pointer_cast(candidate_offsets.data()),
+                        thrust::raw_pointer_cast(candidates.data()),
+                        thrust::raw_pointer_cast(d_tolerances.data()),
+                        thrust::raw_pointer_cast(faces.data()),
+                        thrust::raw_pointer_cast(farthest.data())));
+
+        const thrust::host_vector<unsigned long long> h_farthest = farthest;
+        thrust::host_vector<int> eye_faces, eyes;
+        for (size_t f = 0; f < hull.faces_.size(); ++f) {
+            if (h_alive[f] && h_farthest[f] != 0) {
+                eye_faces.push_back(f);
+                eyes.push_back(int(h_farthest[f] & 0xffffffffull));
+            }
+        }
+        if (eyes.empty()) break;
+        const thrust::host_vector<Eigen::Vector3f> eye_positions =
+                GatherPoints(local, eyes);
+        for (auto &nf : new_faces) nf.clear();
+        thrust::host_vector<int> added;
+        for (size_t k = 0; k < eyes.size(); ++k) {
+            const int f = eye_faces[k];
+            // Eaten by the cone of a previous point of the pass.
+            if (!hull.faces_[f].alive_) continue;
+            hull.positions_[eyes[k]] = eye_positions[k];
+            hull.AddPoint(f, eyes[k], new_faces[hull.faces_[f].cluster_]);
+            added.push_back(eyes[k]);
+        }
+        utility::device_vector<int> d_added = added;
+        thrust::scatter(thrust::make_constant_iterator(-1),
+                        thrust::make_constant_iterator(-1) + d_added.size(),
+                        d_added.begin(), faces.begin());
+    }
+
+    // Meshes of the remaining faces, in the frame of the points.
+    std::vector<std::unordered_map<int, int>> vertex_maps(n_clusters);
+    std::vector<thrust::host_vector<Eigen::Vector3f>> vertices(n_clusters);
+    std::vector<thrust::host_vector<Eigen::Vector3i>> triangles(n_clusters);
+    thrust::host_vector<int> hull_vertices;
+    for (const auto &f : hull.faces_) {
+        if (!f.alive_) continue;
+        const int c = f.cluster_;
+        Eigen::Vector3i tri;
+        for (int i = 0; i < 3; ++i) {
+            auto res = vertex_maps[c].emplace(f.vertices_[i],
+                                              int(vertices[c].size()));
+            if (res.second) {
+                vertices[c].push_back(hull.positions_.at(f.vertices_[i]) +
+                                      h_origins[c]);
+            }
+            tri[i] = res.first->second;
+        }
+        triangles[c].push_back(tri);
+    }
+    for (size_t c = 0; c < n_clusters; ++c) {
+        thrust::host_vector<int> sorted(vertices[c].size());
+        for (const auto &kv : vertex_maps[c]) sorted[kv.second] = kv.first;
+        hull_vertices.insert(hull_vertices.end(), sorted.begin(),
+                             sorted.end());
+    }
+    utility::device_vector<int> d_hull_vertices = hull_vertices;
+    utility::device_vector<int> d_original(hull_vertices.size());
+    thrust::gather(d_hull_vertices.begin(), d_hull_vertices.end(),
+                   order.begin(), d_original.begin());
+    const thrust::host_vector<int> original = d_original;
+    size_t offset = 0;
+    for (size_t c = 0; c < n_clusters; ++c) {
+        if (triangles[c].empty()) continue;
+        meshes[c] = std::make_shared<TriangleMesh>(vertices[c], triangles[c]);
+        indices[c].assign(original.begin() + offset,
+                          original.begin() + offset + vertices[c].size());
+        offset += vertices[c].size();
+    }
+}
+
+/// Katz et al., hulls of the clouds seen from the viewpoints, flipped about
+/// the sphere of radius, with the viewpoints. The indices of the cloud of
+/// viewpoint v are offset by v * (n + 1), n + 1 being the viewpoint.
+void HiddenPointRemovalImpl(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const std::vector<Eigen::Vector3f> &viewpoints,
+        float radius,
+        std::vector<std::shared_ptr<TriangleMesh>> &meshes,
+        std::vector<thrust::host_vector<size_t>> &indices) {
+    if (radius <= 0.0f) {
+        utility::LogError("[HiddenPointRemoval] radius must be positive.");
+        return;
+    }
+    if (points.empty() || viewpoints.empty()) return;
+    const size_t n = points.size();
+    const size_t n_total = viewpoints.size() * (n + 1);
+    const utility::device_vector<Eigen::Vector3f> d_viewpoints(
+            viewpoints.begin(), viewpoints.end());
+    utility::device_vector<Eigen::Vector3f> flipped(n_total);
+    utility::device_vector<int> labels(n_total);
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(n_total),
+                      make_tuple_begin(flipped, labels),
+                      spherical_flip_functor(
+                              thrust::raw_pointer_cast(points.data()),
+                              thrust::raw_pointer_cast(d_viewpoints.data()),
+                              n, radius));
+    ComputeConvexHullsImpl(flipped, labels, viewpoints.size(), meshes,
+                           indices);
+}
+
+}  // namespace
+
+std::tuple<std::shared_ptr<TriangleMesh>, utility::device_vector<size_t>>
+PointCloud::ComputeConvexHull() const {
+    std::vector<std::shared_ptr<TriangleMesh>> meshes;
+    std::vector<thrust::host_vector<size_t>> indices;
+    const utility::device_vector<int> labels(points_.size(), 0);
+    ComputeConvexHullsImpl(points_, labels, points_.empty() ? 0 : 1, meshes,
+                           indices);
+    if (meshes.empty()) {
+        return std::make_tuple(std::make_shared<TriangleMesh>(),
+                               utility::device_vector<size_t>());
+    }
+    return std::make_tuple(meshes[0],
+                           utility::device_vector<size_t>(indices[0]));
+}
+
+std::vector<std::shared_ptr<TriangleMesh>> PointCloud::ComputeConvexHulls(
+        const utility::device_vector<int> &labels) const {
+    std::vector<std::shared_ptr<TriangleMesh>> meshes;
+    std::vector<thrust::host_vector<size_t>> indices;
+    if (labels.size() != points_.size()) {
+        utility::LogError(
+                "[ComputeConvexHulls] points and labels must have the same "
+                "size.");
+        return meshes;
+    }
+    const int max_label =
+            labels.empty() ? -1
+                           : thrust::reduce(labels.begin(), labels.end(), -1,
+                                            thrust::maximum<int>());
+    ComputeConvexHullsImpl(points_, labels, max_label + 1, meshes, indices);
+    return meshes;
+}
+
+std::tuple<std::shared_ptr<TriangleMesh>, utility::device_vector<size_t>>
+PointCloud::HiddenPointRemoval(const Eigen::Vector3f &camera_location,
+                               float radius) const {
+    std::vector<std::shared_ptr<TriangleMesh>> meshes;
+    std::vector<thrust::host_vector<size_t>> indices;
+    HiddenPointRemovalImpl(points_, {camera_location}, radius, meshes,
+                           indices);
+    if (meshes.empty()) {
+        return std::make_tuple(std::make_shared<TriangleMesh>(),
+                               utility::device_vector<size_t>());
+    }
+    // Hull of the visible points and of the camera, in the frame of the
+    // points.
+    const size_t n = points_.size();
+    const thrust::host_vector<Eigen::Vector3f> h_points = points_;
+    thrust::host_vector<Eigen::Vector3f> vertices(indices[0].size());
+    thrust::host_vector<size_t> visible;
+    for (size_t i = 0; i < indices[0].size(); ++i) {
+        const size_t k = indices[0][i];
+        vertices[i] = (k < n) ? h_points[k] : camera_location;
+        if (k < n) visible.push_back(k);
+    }
+    std::sort(visible.begin(), visible.end());
+    meshes[0]->SetVertices(vertices);
+    return std::make_tuple(meshes[0], utility::device_vector<size_t>(visible));
+}
+
+std::vector<utility::device_vector<size_t>>
+PointCloud::HiddenPointRemovalBatch(
+        const std::vector<Eigen::Vector3f> &camera_locations,
+        float radius) const {
+    std::vector<std::shared_ptr<TriangleMesh>> meshes;
+    std::vector<thrust::host_vector<size_t>> indices;
+    HiddenPointRemovalImpl(points_, camera_locations, radius, meshes,
+                           indices);
+    const size_t n = points_.size();
+    std::vector<utility::device_vector<size_t>> res(camera_locations.size());
+    for (size_t v = 0; v < indices.size(); ++v) {
+        thrust::host_vector<size_t> visible;
+        for (size_t k : indices[v]) {
+            const size_t i = k - v * (n + 1);
+            if (i < n) visible.push_back(i);
+        }
+        std::sort(visible.begin(), visible.end());
+        res[v] = visible;
+    }
+    return res;
+}
@@ -0,0 +1,140 @@
+#include <thrust/iterator/counting_iterator.h>
+
+#include <Eigen/Geometry>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+// Pose at time t from the poses at the increasing times, with a spherical
+// linear interpolation of the rotation and a linear one of the translation,
+// clamped to the first and last poses.
+__host__ __device__ Eigen::Matrix4f InterpolatePose(
+        const Eigen::Matrix4f_u *poses, const float *times, int n, float t) {
+    if (n == 1 || t <= times[0]) return poses[0];
+    if (t >= times[n - 1]) return poses[n - 1];
+    int lo = 0;
+    int hi = n - 1;
+    while (hi - lo > 1) {
+        const int mid = (lo + hi) / 2;
+        if (times[mid] <= t) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const float s = (t - times[lo]) / (times[hi] - times[lo]);
+    const Eigen::Matrix4f p0 = poses[lo];
+    const Eigen::Matrix4f p1 = poses[hi];
+    const Eigen::Quaternionf q0(Eigen::Matrix3f(p0.block<3, 3>(0, 0)));
+    const Eigen::Quaternionf q1(Eigen::Matrix3f(p1.block<3, 3>(0, 0)));
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    pose.block<3, 3>(0, 0) = q0.slerp(s, q1).toRotationMatrix();
+    pose.block<3, 1>(0, 3) = (1.0f - s) * p0.block<3, 1>(0, 3) +
+                             s * p1.block<3, 1>(0, 3);
+    return pose;
+}
+
+struct deskew_functor {
+    deskew_functor(const Eigen::Matrix4f_u *poses,
+                   const float *times,
+                   int n_poses,
+                   const float *attributes,
+                   int attribute_dim,
+                   int time_channel,
+                   Eigen::Vector3f *points,
+                   Eigen::Vector3f *normals)
+        : poses_(poses),
+          times_(times),
+          n_poses_(n_poses),
+          attributes_(attributes),
+          attribute_dim_(attribute_dim),
+          time_channel_(time_channel),
+          points_(points),
+          normals_(normals){};
+    const Eigen::Matrix4f_u *poses_;
+    const float *times_;
+    const int n_poses_;
+    const float *attributes_;
+    const int attribute_dim_;
+    const int time_channel_;
+    Eigen::Vector3f *points_;
+    Eigen::Vector3f *normals_;
+    __device__ void operator()(size_t idx) {
+        const float t = attributes_[idx * attribute_dim_ + time_channel_];
+        const Eigen::Matrix4f pose =
+                InterpolatePose(poses_, times_, n_poses_, t);
+        points_[idx] = pose.block<3, 3>(0, 0) * points_[idx] +
+                       pose.block<3, 1>(0, 3);
+        if (normals_) normals_[idx] = pose.block<3, 3>(0, 0) * normals_[idx];
+    }
+};
+
+}  // namespace
+
+PointCloud &PointCloud::Deskew(const std::vector<float> &pose_times,
+                               const std::vector<Eigen::Matrix4f_u> &poses,
+                               float reference_time,
+                               const std::string &time_attribute) {
+    CUPOCH_PROFILE("PointCloud::Deskew");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    const int n_poses = poses.size();
+    if (n_poses == 0 || pose_times.size() != poses.size()) {
+        utility::LogError(
+                "[Deskew] There must be one time per pose and at least one "
+                "pose.");
+    }
+    for (int i = 1; i < n_poses; ++i) {
+        if (!(pose_times[i] > pose_times[i - 1])) {
+            utility::LogError("[Deskew] The pose times must be increasing.");
+        }
+    }
+    const int time_channel = GetAttributeIndex(time_attribute);
+    if (time_channel < 0 || !HasAttributes()) {
+        utility::LogError("[Deskew] Attribute {} is not found.",
+                          time_attribute);
+    }
+
+    // Poses relative to the reference one, so that the points end up in the
+    // sensor frame at the reference time.
+    const Eigen::Matrix4f reference_inv =
+            InterpolatePose(poses.data(), pose_times.data(), n_poses,
+                            reference_time)
+                    .inverse();
+    std::vector<Eigen::Matrix4f_u> relative_poses(n_poses);
+    for (int i = 0; i < n_poses; ++i) {
+        relative_poses[i] = reference_inv * Eigen::Matrix4f(poses[i]);
+    }
+    const utility::device_vector<Eigen::Matrix4f_u> d_poses(
+            relative_poses.begin(), relative_poses.end());
+    const utility::device_vector<float> d_times(pose_times.begin(),
+                                                pose_times.end());
+    deskew_functor func(thrust::raw_pointer_cast(d_poses.data()),
+                        thrust::raw_pointer_cast(d_times.data()), n_poses,
+                        thrust::raw_pointer_cast(attributes_.data()),
+                        attribute_names_.size(), time_channel,
+                        thrust::raw_pointer_cast(points_.data()),
+                        (HasNormals()) ? thrust::raw_pointer_cast(
+                                                 normals_.data())
+                                       : nullptr);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(points_.size()), func);
+    return *this;
+}
+
+PointCloud &PointCloud::Deskew(const Eigen::Matrix4f &start_pose,
+                               const Eigen::Matrix4f &end_pose,
+                               float start_time,
+                               float end_time,
+                               const std::string &time_attribute) {
+    const std::vector<float> pose_times = {start_time, end_time};
+    const std::vector<Eigen::Matrix4f_u> poses = {start_pose, end_pose};
+    return Deskew(pose_times, poses, start_time, time_attribute);
+}
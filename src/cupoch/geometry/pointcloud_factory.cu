@@ -4,9 +4,11 @@
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/geometry/image.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/range_image.h"
 #include "cupoch/geometry/rgbdimage.h"
 #include "cupoch/utility/console.h"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -45,9 +47,9 @@ struct depth_to_pointcloud_functor {
         const float d = *(float *)(&depth_[idx * num_of_channels_ *
                                            bytes_per_channel_ * stride_]);
         if (d <= 0.0) {
-            return Eigen::Vector3f(std::numeric_limits<float>::infinity(),
-                                   std::numeric_limits<float>::infinity(),
-                                   std::numeric_limits<float>::infinity());
+            return Eigen::Vector3f(std::numeric_limits<float>::quiet_NaN(),
+                                   std::numeric_limits<float>::quiet_NaN(),
+                                   std::numeric_limits<float>::quiet_NaN());
         } else {
             float z = d;
             float x = (col - principal_point_.first) * z / focal_length_.first;
@@ -64,7 +66,8 @@ std::shared_ptr<PointCloud> CreatePointCloudFromFloatDepthImage(
         const Image &depth,
         const camera::PinholeCameraIntrinsic &intrinsic,
         const Eigen::Matrix4f &extrinsic,
-        int stride) {
+        int stride,
+        bool project_valid_depth_only) {
     auto pointcloud = std::make_shared<PointCloud>();
     const Eigen::Matrix4f camera_pose = extrinsic.inverse();
     const auto focal_length = intrinsic.GetFocalLength();
@@ -78,7 +81,7 @@ std::shared_ptr<PointCloud> CreatePointCloudFromFloatDepthImage(
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
                       thrust::make_counting_iterator(depth_size),
                       pointcloud->points_.begin(), func);
-    pointcloud->RemoveNoneFinitePoints(true, true);
+    pointcloud->RemoveNoneFinitePoints(project_valid_depth_only, true);
     return pointcloud;
 }
 
@@ -175,6 +178,245 @@ std::shared_ptr<PointCloud> CreatePointCloudFromRGBDImageT(
     return pointcloud;
 }
 
+constexpr int kUnprojectWarpSize = 32;
+constexpr int kUnprojectBlockSize = 256;
+
+// Output slot of the lanes with \p valid set. The first valid lane of the
+// warp reserves the slots of all of them with one atomicAdd, and the lanes
+// take theirs in lane order. All the lanes of the warp must call it.
+__device__ int WarpAggregatedIncrement(int *counter, bool valid) {
+    const unsigned int mask = __ballot_sync(0xffffffff, valid);
+    if (!valid) return -1;
+    const int lane = threadIdx.x % kUnprojectWarpSize;
+    const int leader = __ffs(mask) - 1;
+    int base = 0;
+    if (lane == leader) base = atomicAdd(counter, __popc(mask));
+    base = __shfl_sync(mask, base, leader);
+    return base + __popc(mask & ((1u << lane) - 1));
+}
+
+// One thread per pixel of the strided grid. TD is uint16_t for the depth
+// scaled by depth_scale and float for the metric depth; NC = 0 for no
+// colors.
+template <typename TD, typename TC, int NC>
+__global__ void unproject_valid_depth_kernel(
+        const TD *depth,
+        const TC *color,
+        int width,
+        int stride,
+        int grid_width,
+        int n_grid,
+        thrust::pair<float, float> focal_length,
+        thrust::pair<float, float> principal_point,
+        Eigen::Matrix4f camera_pose,
+        float depth_scale,
+        float depth_trunc,
+        float color_scale,
+        Eigen::Vector3f *points,
+        Eigen::Vector3f *colors,
+        int *counter) {
+    const int idx = blockIdx.x * blockDim.x + threadIdx.x;
+    const int row = (idx / grid_width) * stride;
+    const int col = (idx % grid_width) * stride;
+    const int pixel = row * width + col;
+    float d = 0.0f;
+    if (idx < n_grid) {
+        d = (sizeof(TD) == 2) ? depth[pixel] / depth_scale
+                              : (float)depth[pixel];
+    }
+    const bool valid = d > 0.0f && d < depth_trunc;
+    const int slot = WarpAggregatedIncrement(counter, valid);
+    if (!valid) return;
+    const float x = (col - principal_point.first) * d / focal_length.first;
+    const float y = (row - principal_point.second) * d / focal_length.second;
+    points[slot] = camera_pose.block<3, 3>(0, 0) * Eigen::Vector3f(x, y, d) +
+                   camera_pose.block<3, 1>(0, 3);
+    if (NC > 0) {
+        const TC *pc = color + pixel * NC;
+        colors[slot] =
+                Eigen::Vector3f(pc[0], pc[(NC - 1) / 2], pc[NC - 1]) /
+                color_scale;
+    }
+}
+
+// Runs the kernel into the points and colors of \p output, resized to one
+// point per pixel of the strided grid beforehand and to the valid pixels
+// after.
+template <typename TD, typename TC, int NC>
+void UnprojectValidDepth(PointCloud &output,
+                         const uint8_t *depth,
+                         const uint8_t *color,
+                         int width,
+                         int height,
+                         const camera::PinholeCameraIntrinsic &intrinsic,
+                         const Eigen::Matrix4f &extrinsic,
+                         float depth_scale,
+                         float depth_trunc,
+                         int stride) {
+    const int grid_width = (width + stride - 1) / stride;
+    const int grid_height = (height + stride - 1) / stride;
+    const int n_grid = grid_width * grid_height;
+    output.normals_.clear();
+    output.ClearAttributes();
+    output.points_.resize(n_grid);
+    if (NC > 0) {
+        output.colors_.resize(n_grid);
+    } else {
+        output.colors_.clear();
+    }
+    if (n_grid == 0) return;
+    utility::device_vector<int> counter(1, 0);
+    const int n_blocks = (n_grid + kUnprojectBlockSize - 1) /
+                         kUnprojectBlockSize;
+    unproject_valid_depth_kernel<TD, TC, NC>
+            <<<n_blocks, kUnprojectBlockSize>>>(
+                    (const TD *)depth, (const TC *)color, width, stride,
+                    grid_width, n_grid, intrinsic.GetFocalLength(),
+                    intrinsic.GetPrincipalPoint(), extrinsic.inverse(),
+                    depth_scale, depth_trunc, (sizeof(TC) == 1) ? 255.0 : 1.0,
+                    thrust::raw_pointer_cast(output.points_.data()),
+                    (NC > 0) ? thrust::raw_pointer_cast(output.colors_.data())
+                             : nullptr,
+                    thrust::raw_pointer_cast(counter.data()));
+    cudaSafeCall(cudaGetLastError());
+    const int n_points = counter[0];
+    output.points_.resize(n_points);
+    if (NC > 0) output.colors_.resize(n_points);
+}
+
+/// Depth of a point packed above its index: the bits of the positive floats
+/// are ordered as the floats, so the minimum key of a pixel is its nearest
+/// point, the index breaking the ties.
+struct project_to_zbuffer_functor {
+    project_to_zbuffer_functor(
+            const Eigen::Matrix4f &extrinsic,
+            const thrust::pair<float, float> &principal_point,
+            const thrust::pair<float, float> &focal_length,
+            int width,
+            int height,
+            unsigned long long *zbuffer)
+        : extrinsic_(extrinsic),
+          principal_point_(principal_point),
+          focal_length_(focal_length),
+          width_(width),
+          height_(height),
+          zbuffer_(zbuffer){};
+    const Eigen::Matrix4f extrinsic_;
+    const thrust::pair<float, float> principal_point_;
+    const thrust::pair<float, float> focal_length_;
+    const int width_;
+    const int height_;
+    unsigned long long *zbuffer_;
+    __device__ void operator()(
+            const thrust::tuple<size_t, Eigen::Vector3f> &x) const {
+        const Eigen::Vector3f p = extrinsic_.block<3, 3>(0, 0) *
+                                          thrust::get<1>(x) +
+                                  extrinsic_.block<3, 1>(0, 3);
+        if (!(p[2] > 0.0f) || !isfinite(p[0]) || !isfinite(p[1])) return;
+        const int u = __float2int_rn(
+                p[0] * focal_length_.first / p[2] + principal_point_.first);
+        const int v = __float2int_rn(
+                p[1] * focal_length_.second / p[2] + principal_point_.second);
+        if (u < 0 || u >= width_ || v < 0 || v >= height_) return;
+        const unsigned long long key =
+                ((unsigned long long)__float_as_uint(p[2]) << 32) |
+                (unsigned int)thrust::get<0>(x);
+        atomicMin(zbuffer_ + v * width_ + u, key);
+    }
+};
+
+struct zbuffer_to_depth_functor {
+    __device__ float operator()(unsigned long long key) const {
+        return (key == std::numeric_limits<unsigned long long>::max())
+                       ? 0.0f
+                       : __uint_as_float((unsigned int)(key >> 32));
+    }
+};
+
+struct zbuffer_to_index_functor {
+    __device__ int operator()(unsigned long long key) const {
+        return (key == std::numeric_limits<unsigned long long>::max())
+                       ? -1
+                       : (int)(key & 0xffffffffull);
+    }
+};
+
+utility::device_vector<unsigned long long> RenderZBuffer(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) {
+    utility::device_vector<unsigned long long> zbuffer(
+            intrinsic.width_ * intrinsic.height_,
+            std::numeric_limits<unsigned long long>::max());
+    project_to_zbuffer_functor func(
+            extrinsic, intrinsic.GetPrincipalPoint(),
+            intrinsic.GetFocalLength(), intrinsic.width_, intrinsic.height_,
+            thrust::raw_pointer_cast(zbuffer.data()));
+    thrust::for_each(
+            make_tuple_iterator(thrust::make_counting_iterator<size_t>(0),
+                                points.begin()),
+            make_tuple_iterator(thrust::make_counting_iterator(points.size()),
+                                points.end()),
+            func);
+    return zbuffer;
+}
+
+struct project_to_range_zbuffer_functor {
+    project_to_range_zbuffer_functor(const RangeImageProjection &projection,
+                                     unsigned long long *zbuffer)
+        : projection_(projection), zbuffer_(zbuffer){};
+    const RangeImageProjection projection_;
+    unsigned long long *zbuffer_;
+    __device__ void operator()(
+            const thrust::tuple<size_t, Eigen::Vector3f> &x) const {
+        int row, col;
+        float range;
+        if (!projection_.ProjectToPixel(thrust::get<1>(x), row, col, range)) {
+            return;
+        }
+        const unsigned long long key =
+                ((unsigned long long)__float_as_uint(range) << 32) |
+                (unsigned int)thrust::get<0>(x);
+        atomicMin(zbuffer_ + row * projection_.num_columns_ + col, key);
+    }
+};
+
+utility::device_vector<unsigned long long> RenderRangeZBuffer(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const RangeImageProjection &projection) {
+    utility::device_vector<unsigned long long> zbuffer(
+            projection.num_rings_ * projection.num_columns_,
+            std::numeric_limits<unsigned long long>::max());
+    project_to_range_zbuffer_functor func(
+            projection, thrust::raw_pointer_cast(zbuffer.data()));
+    thrust::for_each(
+            make_tuple_iterator(thrust::make_counting_iterator<size_t>(0),
+                                points.begin()),
+            make_tuple_iterator(thrust::make_counting_iterator(points.size()),
+                                points.end()),
+            func);
+    return zbuffer;
+}
+
+struct range_to_pointcloud_functor {
+    range_to_pointcloud_functor(const float *range,
+                                const RangeImageProjection &projection)
+        : range_(range), projection_(projection){};
+    const float *range_;
+    const RangeImageProjection projection_;
+    __device__ Eigen::Vector3f operator()(size_t idx) const {
+        const float r = range_[idx];
+        if (!(r > 0.0f) || r < projection_.min_range_ ||
+            r > projection_.max_range_) {
+            return Eigen::Vector3f::Constant(
+                    std::numeric_limits<float>::quiet_NaN());
+        }
+        return r * projection_.GetBeamDirection(
+                           idx / projection_.num_columns_,
+                           idx % projection_.num_columns_);
+    }
+};
+
 }  // namespace
 
 std::shared_ptr<PointCloud> PointCloud::CreateFromDepthImage(
@@ -183,16 +425,19 @@ std::shared_ptr<PointCloud> PointCloud::CreateFromDepthImage(
         const Eigen::Matrix4f &extrinsic /* = Eigen::Matrix4f::Identity()*/,
         float depth_scale /* = 1000.0*/,
         float depth_trunc /* = 1000.0*/,
-        int stride /* = 1*/) {
+        int stride /* = 1*/,
+        bool project_valid_depth_only /* = true*/) {
     if (depth.num_of_channels_ == 1) {
         if (depth.bytes_per_channel_ == 2) {
             auto float_depth =
                     depth.ConvertDepthToFloatImage(depth_scale, depth_trunc);
-            return CreatePointCloudFromFloatDepthImage(*float_depth, intrinsic,
-                                                       extrinsic, stride);
+            return CreatePointCloudFromFloatDepthImage(
+                    *float_depth, intrinsic, extrinsic, stride,
+                    project_valid_depth_only);
         } else if (depth.bytes_per_channel_ == 4) {
-            return CreatePointCloudFromFloatDepthImage(depth, intrinsic,
-                                                       extrinsic, stride);
+            return CreatePointCloudFromFloatDepthImage(
+                    depth, intrinsic, extrinsic, stride,
+                    project_valid_depth_only);
         }
     }
     utility::LogError(
@@ -221,3 +466,142 @@ std::shared_ptr<PointCloud> PointCloud::CreateFromRGBDImage(
             "[CreatePointCloudFromRGBDImage] Unsupported image format.");
     return std::make_shared<PointCloud>();
 }
+
+bool PointCloud::UnprojectDepthImage(
+        const Image &depth,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic /* = Eigen::Matrix4f::Identity()*/,
+        float depth_scale /* = 1000.0*/,
+        float depth_trunc /* = 1000.0*/,
+        int stride /* = 1*/) {
+    if (stride < 1) {
+        utility::LogError("[UnprojectDepthImage] stride must be positive.");
+    }
+    if (depth.num_of_channels_ != 1 ||
+        (depth.bytes_per_channel_ != 2 && depth.bytes_per_channel_ != 4)) {
+        utility::LogWarning("[UnprojectDepthImage] Unsupported image format.");
+        return false;
+    }
+    const uint8_t *data = thrust::raw_pointer_cast(depth.data_.data());
+    if (depth.bytes_per_channel_ == 2) {
+        UnprojectValidDepth<uint16_t, uint8_t, 0>(
+                *this, data, nullptr, depth.width_, depth.height_, intrinsic,
+                extrinsic, depth_scale, depth_trunc, stride);
+    } else {
+        UnprojectValidDepth<float, uint8_t, 0>(
+                *this, data, nullptr, depth.width_, depth.height_, intrinsic,
+                extrinsic, depth_scale, depth_trunc, stride);
+    }
+    return true;
+}
+
+bool PointCloud::UnprojectRGBDImage(
+        const RGBDImage &image,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic /* = Eigen::Matrix4f::Identity()*/,
+        float depth_trunc /* = 1000.0*/,
+        int stride /* = 1*/) {
+    if (stride < 1) {
+        utility::LogError("[UnprojectRGBDImage] stride must be positive.");
+    }
+    const uint8_t *depth = thrust::raw_pointer_cast(image.depth_.data_.data());
+    const uint8_t *color = thrust::raw_pointer_cast(image.color_.data_.data());
+    if (image.depth_.num_of_channels_ == 1 &&
+        image.depth_.bytes_per_channel_ == 4) {
+        if (image.color_.bytes_per_channel_ == 1 &&
+            image.color_.num_of_channels_ == 3) {
+            UnprojectValidDepth<float, uint8_t, 3>(
+                    *this, depth, color, image.depth_.width_,
+                    image.depth_.height_, intrinsic, extrinsic, 1.0,
+                    depth_trunc, stride);
+            return true;
+        } else if (image.color_.bytes_per_channel_ == 4 &&
+                   image.color_.num_of_channels_ == 1) {
+            UnprojectValidDepth<float, float, 1>(
+                    *this, depth, color, image.depth_.width_,
+                    image.depth_.height_, intrinsic, extrinsic, 1.0,
+                    depth_trunc, stride);
+            return true;
+        }
+    }
+    utility::LogWarning("[UnprojectRGBDImage] Unsupported image format.");
+    return false;
+}
+
+std::shared_ptr<Image> PointCloud::ProjectToDepthImage(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) const {
+    auto zbuffer = RenderZBuffer(points_, intrinsic, extrinsic);
+    auto depth = std::make_shared<Image>();
+    depth->Prepare(intrinsic.width_, intrinsic.height_, 1, 4);
+    thrust::transform(zbuffer.begin(), zbuffer.end(),
+                      thrust::device_pointer_cast(
+                              (float *)thrust::raw_pointer_cast(
+                                      depth->data_.data())),
+                      zbuffer_to_depth_functor());
+    return depth;
+}
+
+std::shared_ptr<Image> PointCloud::ProjectToIndexImage(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) const {
+    auto zbuffer = RenderZBuffer(points_, intrinsic, extrinsic);
+    auto index = std::make_shared<Image>();
+    index->Prepare(intrinsic.width_, intrinsic.height_, 1, 4);
+    thrust::transform(zbuffer.begin(), zbuffer.end(),
+                      thrust::device_pointer_cast(
+                              (int *)thrust::raw_pointer_cast(
+                                      index->data_.data())),
+                      zbuffer_to_index_functor());
+    return index;
+}
+
+std::shared_ptr<PointCloud> PointCloud::CreateFromRangeImage(
+        const Image &range,
+        const RangeImageProjection &projection,
+        bool project_valid_range_only) {
+    if (range.num_of_channels_ != 1 || range.bytes_per_channel_ != 4 ||
+        range.width_ != projection.num_columns_ ||
+        range.height_ != projection.num_rings_) {
+        utility::LogError(
+                "[CreateFromRangeImage] The range image must be a single "
+                "channel float image of the projection size.");
+    }
+    auto pointcloud = std::make_shared<PointCloud>();
+    const size_t n_pixels = range.width_ * range.height_;
+    pointcloud->points_.resize(n_pixels);
+    range_to_pointcloud_functor func(
+            (const float *)thrust::raw_pointer_cast(range.data_.data()),
+            projection);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_pixels),
+                      pointcloud->points_.begin(), func);
+    pointcloud->RemoveNoneFinitePoints(project_valid_range_only, true);
+    return pointcloud;
+}
+
+std::shared_ptr<Image> PointCloud::ToRangeImage(
+        const RangeImageProjection &projection) const {
+    auto zbuffer = RenderRangeZBuffer(points_, projection);
+    auto range = std::make_shared<Image>();
+    range->Prepare(projection.num_columns_, projection.num_rings_, 1, 4);
+    thrust::transform(zbuffer.begin(), zbuffer.end(),
+                      thrust::device_pointer_cast(
+                              (float *)thrust::raw_pointer_cast(
+                                      range->data_.data())),
+                      zbuffer_to_depth_functor());
+    return range;
+}
+
+std::shared_ptr<Image> PointCloud::ToRangeIndexImage(
+        const RangeImageProjection &projection) const {
+    auto zbuffer = RenderRangeZBuffer(points_, projection);
+    auto index = std::make_shared<Image>();
+    index->Prepare(projection.num_columns_, projection.num_rings_, 1, 4);
+    thrust::transform(zbuffer.begin(), zbuffer.end(),
+                      thrust::device_pointer_cast(
+                              (int *)thrust::raw_pointer_cast(
+                                      index->data_.data())),
+                      zbuffer_to_index_functor());
+    return index;
+}
@@ -0,0 +1,310 @@
+#include <thrust/iterator/counting_iterator.h>
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/pointcloud_pipeline.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+typedef PointCloudPipeline::Stage Stage;
+typedef PointCloudPipeline::StageType StageType;
+
+struct pipeline_stages {
+    Stage stages_[PointCloudPipeline::kMaxStages];
+    int n_stages_;
+};
+
+__device__ bool IsNonFinite(const Eigen::Vector3f &v,
+                            bool remove_nan,
+                            bool remove_infinite) {
+    for (int i = 0; i < 3; ++i) {
+        if (remove_nan && isnan(v(i))) return true;
+        if (remove_infinite && isinf(v(i))) return true;
+    }
+    return false;
+}
+
+// Runs the stages on one point, the normal being transformed too when it
+// is checked by a later stage.
+struct select_pipeline_points_functor {
+    select_pipeline_points_functor(const pipeline_stages &stages,
+                                   const Eigen::Vector3f *points,
+                                   const Eigen::Vector3f *normals,
+                                   const Eigen::Vector3f *colors)
+        : stages_(stages),
+          points_(points),
+          normals_(normals),
+          colors_(colors){};
+    const pipeline_stages stages_;
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3f *normals_;
+    const Eigen::Vector3f *colors_;
+    __device__ bool operator()(size_t idx) const {
+        Eigen::Vector3f p = points_[idx];
+        Eigen::Vector3f n = normals_ ? normals_[idx] : Eigen::Vector3f::Zero();
+        for (int s = 0; s < stages_.n_stages_; ++s) {
+            const Stage &stage = stages_.stages_[s];
+            switch (stage.type_) {
+                case StageType::Transform: {
+                    const Eigen::Matrix4f T = stage.transformation_;
+                    const Eigen::Vector4f hp =
+                            T * Eigen::Vector4f(p(0), p(1), p(2), 1.0f);
+                    p = hp.head<3>() / hp(3);
+                    if (normals_) n = T.block<3, 3>(0, 0) * n;
+                    break;
+                }
+                case StageType::CropAxisAligned:
+                    if ((p.array() < stage.min_bound_.array()).any() ||
+                        (p.array() > stage.max_bound_.array()).any()) {
+                        return false;
+                    }
+                    break;
+                case StageType::CropOriented: {
+                    const Eigen::Vector3f d =
+                            stage.R_.transpose() * (p - stage.min_bound_);
+                    if ((d.array().abs() > stage.max_bound_.array()).any()) {
+                        return false;
+                    }
+                    break;
+                }
+                case StageType::RemoveNonFinite:
+                    if (IsNonFinite(p, stage.remove_nan_,
+                                    stage.remove_infinite_) ||
+                        (normals_ && IsNonFinite(n, stage.remove_nan_,
+                                                 stage.remove_infinite_)) ||
+                        (colors_ && IsNonFinite(colors_[idx],
+                                                stage.remove_nan_,
+                                                stage.remove_infinite_))) {
+                        return false;
+                    }
+                    break;
+            }
+        }
+        return true;
+    }
+};
+
+// Gathers the selected points with all the transforms of the pipeline
+// applied at once.
+struct gather_pipeline_points_functor {
+    gather_pipeline_points_functor(const Eigen::Matrix4f &transformation,
+                                   const size_t *indices,
+                                   const Eigen::Vector3f *src_points,
+                                   const Eigen::Vector3f *src_normals,
+                                   const Eigen::Vector3f *src_colors,
+                                   const float *src_attributes,
+                                   Eigen::Vector3f *dst_points,
+                                   Eigen::Vector3f *dst_normals,
+                                   Eigen::Vector3f *dst_colors,
+                                   float *dst_attributes,
+                                   int n_attributes)
+        : transformation_(transformation),
+          indices_(indices),
+          src_points_(src_points),
+          src_normals_(src_normals),
+          src_colors_(src_colors),
+          src_attributes_(src_attributes),
+          dst_points_(dst_points),
+          dst_normals_(dst_normals),
+          dst_colors_(dst_colors),
+          dst_attributes_(dst_attributes),
+          n_attributes_(n_attributes){};
+    const Eigen::Matrix4f transformation_;
+    const size_t *indices_;
+    const Eigen::Vector3f *src_points_;
+    const Eigen::Vector3f *src_normals_;
+    const Eigen::Vector3f *src_colors_;
+    const float *src_attributes_;
+    Eigen::Vector3f *dst_points_;
+    Eigen::Vector3f *dst_normals_;
+    Eigen::Vector3f *dst_colors_;
+    float *dst_attributes_;
+    const int n_attributes_;
+    __device__ void operator()(size_t idx) {
+        const size_t i = indices_ ? indices_[idx] : idx;
+        const Eigen::Vector3f &p = src_points_[i];
+        const Eigen::Vector4f hp =
+                transformation_ * Eigen::Vector4f(p(0), p(1), p(2), 1.0f);
+        dst_points_[idx] = hp.head<3>() / hp(3);
+        if (dst_normals_) {
+            dst_normals_[idx] =
+                    transformation_.block<3, 3>(0, 0) * src_normals_[i];
+        }
+        if (dst_colors_) dst_colors_[idx] = src_colors_[i];
+        for (int j = 0; j < n_attributes_; ++j) {
+            dst_attributes_[idx * n_attributes_ + j] =
+                    src_attributes_[i * n_attributes_ + j];
+        }
+    }
+};
+
+}  // namespace
+
+PointCloudPipeline::PointCloudPipeline(const PointCloud &input)
+    : input_(input) {}
+
+void PointCloudPipeline::AddStage(const Stage &stage) {
+    if (voxel_size_ > 0.0f) {
+        utility::LogError(
+                "[PointCloudPipeline] VoxelDownSample must be the last "
+                "stage.");
+    }
+    if (stages_.size() >= kMaxStages) {
+        utility::LogError("[PointCloudPipeline] More than {:d} stages.",
+                          kMaxStages);
+    }
+    stages_.push_back(stage);
+}
+
+PointCloudPipeline &PointCloudPipeline::Transform(
+        const Eigen::Matrix4f &transformation) {
+    if (!stages_.empty() && stages_.back().type_ == StageType::Transform &&
+        voxel_size_ <= 0.0f) {
+        stages_.back().transformation_ =
+                transformation * Eigen::Matrix4f(stages_.back().transformation_);
+        return *this;
+    }
+    Stage stage = {};
+    stage.type_ = StageType::Transform;
+    stage.transformation_ = transformation;
+    AddStage(stage);
+    return *this;
+}
+
+PointCloudPipeline &PointCloudPipeline::Crop(
+        const AxisAlignedBoundingBox &bbox) {
+    if (bbox.IsEmpty()) {
+        utility::LogError(
+                "[PointCloudPipeline::Crop] AxisAlignedBoundingBox either has "
+                "zeros size, or has wrong bounds.");
+    }
+    Stage stage = {};
+    stage.type_ = StageType::CropAxisAligned;
+    stage.min_bound_ = bbox.min_bound_;
+    stage.max_bound_ = bbox.max_bound_;
+    AddStage(stage);
+    return *this;
+}
+
+PointCloudPipeline &PointCloudPipeline::Crop(const OrientedBoundingBox &bbox) {
+    if (bbox.IsEmpty()) {
+        utility::LogError(
+                "[PointCloudPipeline::Crop] OrientedBoundingBox either has "
+                "zeros size, or has wrong bounds.");
+    }
+    Stage stage = {};
+    stage.type_ = StageType::CropOriented;
+    stage.min_bound_ = bbox.center_;
+    stage.max_bound_ = bbox.extent_ * 0.5f;
+    stage.R_ = bbox.R_;
+    AddStage(stage);
+    return *this;
+}
+
+PointCloudPipeline &PointCloudPipeline::RemoveNonFinite(bool remove_nan,
+                                                        bool remove_infinite) {
+    Stage stage = {};
+    stage.type_ = StageType::RemoveNonFinite;
+    stage.remove_nan_ = remove_nan;
+    stage.remove_infinite_ = remove_infinite;
+    AddStage(stage);
+    return *this;
+}
+
+PointCloudPipeline &PointCloudPipeline::VoxelDownSample(float voxel_size,
+                                                        bool deterministic) {
+    if (voxel_size <= 0.0f) {
+        utility::LogError("[PointCloudPipeline] voxel_size <= 0.");
+    }
+    voxel_size_ = voxel_size;
+    deterministic_ = deterministic;
+    return *this;
+}
+
+std::shared_ptr<PointCloud> PointCloudPipeline::Run() const {
+    return Run(utility::ExecutionContext::Default());
+}
+
+std::shared_ptr<PointCloud> PointCloudPipeline::Run(
+        utility::ExecutionContext &ctx) const {
+    CUPOCH_PROFILE("PointCloudPipeline::Run", ctx.GetStream());
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    cudaStream_t stream = ctx.GetStream();
+    const bool has_normals = input_.HasNormals();
+    const bool has_colors = input_.HasColors();
+    const bool has_attributes = input_.HasAttributes();
+    const int n_attributes =
+            has_attributes ? input_.GetAttributeDimension() : 0;
+
+    Eigen::Matrix4f transformation = Eigen::Matrix4f::Identity();
+    pipeline_stages stages;
+    stages.n_stages_ = 0;
+    bool has_selection = false;
+    for (const auto &stage : stages_) {
+        stages.stages_[stages.n_stages_++] = stage;
+        if (stage.type_ == StageType::Transform) {
+            transformation =
+                    Eigen::Matrix4f(stage.transformation_) * transformation;
+        } else {
+            has_selection = true;
+        }
+    }
+
+    utility::device_vector<size_t> indices;
+    size_t n_out = input_.points_.size();
+    if (has_selection) {
+        indices.resize(input_.points_.size());
+        select_pipeline_points_functor select_func(
+                stages, thrust::raw_pointer_cast(input_.points_.data()),
+                has_normals ? thrust::raw_pointer_cast(input_.normals_.data())
+                            : nullptr,
+                has_colors ? thrust::raw_pointer_cast(input_.colors_.data())
+                           : nullptr);
+        auto end = thrust::copy_if(
+                utility::exec_policy(stream)->on(stream),
+                thrust::make_counting_iterator<size_t>(0),
+                thrust::make_counting_iterator(input_.points_.size()),
+                indices.begin(), select_func);
+        n_out = thrust::distance(indices.begin(), end);
+    }
+
+    auto output = std::make_shared<PointCloud>();
+    output->points_.resize(n_out);
+    output->normals_.resize(has_normals ? n_out : 0);
+    output->colors_.resize(has_colors ? n_out : 0);
+    output->attributes_.resize(n_out * n_attributes);
+    if (has_attributes) output->attribute_names_ = input_.attribute_names_;
+    gather_pipeline_points_functor gather_func(
+            transformation,
+            has_selection ? thrust::raw_pointer_cast(indices.data()) : nullptr,
+            thrust::raw_pointer_cast(input_.points_.data()),
+            thrust::raw_pointer_cast(input_.normals_.data()),
+            thrust::raw_pointer_cast(input_.colors_.data()),
+            thrust::raw_pointer_cast(input_.attributes_.data()),
+            thrust::raw_pointer_cast(output->points_.data()),
+            has_normals ? thrust::raw_pointer_cast(output->normals_.data())
+                        : nullptr,
+            has_colors ? thrust::raw_pointer_cast(output->colors_.data())
+                       : nullptr,
+            thrust::raw_pointer_cast(output->attributes_.data()),
+            n_attributes);
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_out), gather_func);
+    if (voxel_size_ > 0.0f && !output->IsEmpty()) {
+        return output->VoxelDownSample(ctx, voxel_size_, deterministic_);
+    }
+    ctx.Synchronize();
+    return output;
+}
+
+PointCloudPipeline PointCloud::Pipeline() const {
+    return PointCloudPipeline(*this);
+}
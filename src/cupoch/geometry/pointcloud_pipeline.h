@@ -0,0 +1,79 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/eigen.h"
+#include "cupoch/utility/execution_context.h"
+
+namespace cupoch {
+namespace geometry {
+
+class AxisAlignedBoundingBox;
+class OrientedBoundingBox;
+
+/// \class PointCloudPipeline
+///
+/// \brief Lazy chain of point operations on a PointCloud, run by Run().
+///
+/// The elementwise stages (transforms, crops and the removal of the non
+/// finite points) are fused. One kernel evaluates all of them to select the
+/// points, and a second gathers the selected points with their transform
+/// applied, so the intermediate clouds of the chained calls are never
+/// allocated. A VoxelDownSample() stage then reduces the result. The input
+/// is referenced, not copied, and must outlive the pipeline.
+class PointCloudPipeline {
+public:
+    static constexpr int kMaxStages = 8;
+
+    enum class StageType : int {
+        Transform = 0,
+        CropAxisAligned = 1,
+        CropOriented = 2,
+        RemoveNonFinite = 3,
+    };
+
+    struct Stage {
+        StageType type_;
+        /// Transform.
+        Eigen::Matrix4f_u transformation_;
+        /// CropAxisAligned: the bounds. CropOriented: the center and the half
+        /// extent in the frame of R_.
+        Eigen::Vector3f min_bound_;
+        Eigen::Vector3f max_bound_;
+        Eigen::Matrix3f R_;
+        /// RemoveNonFinite.
+        bool remove_nan_;
+        bool remove_infinite_;
+    };
+
+    explicit PointCloudPipeline(const PointCloud &input);
+
+    /// Consecutive transforms are composed into one stage.
+    PointCloudPipeline &Transform(const Eigen::Matrix4f &transformation);
+    PointCloudPipeline &Crop(const AxisAlignedBoundingBox &bbox);
+    PointCloudPipeline &Crop(const OrientedBoundingBox &bbox);
+    /// Removes the points whose coordinates, normal or color are not finite,
+    /// as PointCloud::RemoveNoneFinitePoints().
+    PointCloudPipeline &RemoveNonFinite(bool remove_nan = true,
+                                        bool remove_infinite = true);
+    /// Last stage of the pipeline, as PointCloud::VoxelDownSample().
+    PointCloudPipeline &VoxelDownSample(float voxel_size,
+                                        bool deterministic = true);
+
+    std::shared_ptr<PointCloud> Run() const;
+    std::shared_ptr<PointCloud> Run(utility::ExecutionContext &ctx) const;
+
+    const std::vector<Stage> &GetStages() const { return stages_; }
+
+private:
+    void AddStage(const Stage &stage);
+
+    const PointCloud &input_;
+    std::vector<Stage> stages_;
+    float voxel_size_ = 0.0f;
+    bool deterministic_ = true;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,468 @@
+#include <thrust/binary_search.h>
+#include <thrust/extrema.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/random.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <Eigen/Eigenvalues>
+
+#include "cupoch/geometry/estimate_normals.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+constexpr int kMaxRansacN = 16;
+constexpr int kMaxGroundZones = 8;
+
+__device__ unsigned int HashSeed(unsigned int seed, unsigned int idx) {
+    unsigned int h = seed ^ (idx * 0x9e3779b9u);
+    h = (h ^ 61) ^ (h >> 16);
+    h *= 9;
+    h = h ^ (h >> 4);
+    h *= 0x27d4eb2d;
+    return h ^ (h >> 15);
+}
+
+// Least squares plane of the points with the given moments around the
+// origin, false if they do not span a plane.
+__device__ bool FitPlaneFromMoments(float n,
+                                    const Eigen::Vector3f &sum,
+                                    const Eigen::Matrix3f &outer,
+                                    Eigen::Vector4f &plane) {
+    if (n < 3.0) return false;
+    const Eigen::Vector3f centroid = sum / n;
+    Eigen::Matrix3f covariance = outer / n - centroid * centroid.transpose();
+    Eigen::Vector3f evals;
+    Eigen::Vector3f normal = FastEigen3x3(covariance, evals);
+    const float norm = normal.norm();
+    if (norm == 0.0) return false;
+    normal /= norm;
+    plane << normal, -normal.dot(centroid);
+    return true;
+}
+
+struct plane_hypothesis_functor {
+    plane_hypothesis_functor(const Eigen::Vector3f *points,
+                             int n_points,
+                             int ransac_n,
+                             float distance_threshold,
+                             unsigned int seed)
+        : points_(points),
+          n_points_(n_points),
+          ransac_n_(ransac_n),
+          distance_threshold_(distance_threshold),
+          seed_(seed){};
+    const Eigen::Vector3f *points_;
+    const int n_points_;
+    const int ransac_n_;
+    const float distance_threshold_;
+    const unsigned int seed_;
+    __device__ thrust::tuple<int, Eigen::Vector4f_u> operator()(
+            unsigned int idx) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        thrust::uniform_int_distribution<int> dist(0, n_points_ - 1);
+        int samples[kMaxRansacN];
+        for (int k = 0; k < ransac_n_; ++k) {
+            bool unique;
+            do {
+                samples[k] = dist(rng);
+                unique = true;
+                for (int j = 0; j < k; ++j) unique &= samples[j] != samples[k];
+            } while (!unique);
+        }
+        Eigen::Vector4f plane = Eigen::Vector4f::Zero();
+        const Eigen::Vector3f &p0 = points_[samples[0]];
+        if (ransac_n_ == 3) {
+            Eigen::Vector3f normal = (points_[samples[1]] - p0)
+                                             .cross(points_[samples[2]] - p0);
+            const float norm = normal.norm();
+            if (norm == 0.0) {
+                return thrust::make_tuple(0, Eigen::Vector4f_u(plane));
+            }
+            normal /= norm;
+            plane << normal, -normal.dot(p0);
+        } else {
+            // Moments relative to the first sample to keep the precision.
+            Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+            Eigen::Matrix3f outer = Eigen::Matrix3f::Zero();
+            for (int k = 0; k < ransac_n_; ++k) {
+                const Eigen::Vector3f p = points_[samples[k]] - p0;
+                sum += p;
+                outer += p * p.transpose();
+            }
+            if (!FitPlaneFromMoments(ransac_n_, sum, outer, plane)) {
+                return thrust::make_tuple(0, Eigen::Vector4f_u(plane));
+            }
+            plane(3) -= plane.head<3>().dot(p0);
+        }
+        int count = 0;
+        for (int i = 0; i < n_points_; ++i) {
+            const float d = plane.head<3>().dot(points_[i]) + plane(3);
+            if (abs(d) < distance_threshold_) ++count;
+        }
+        return thrust::make_tuple(count, Eigen::Vector4f_u(plane));
+    }
+};
+
+struct ground_zones {
+    int n_zones_;
+    float boundaries_[kMaxGroundZones + 1];
+    int num_rings_[kMaxGroundZones];
+    int num_sectors_[kMaxGroundZones];
+    int bin_offsets_[kMaxGroundZones];
+};
+
+// Bin of the concentric zone model, -1 outside of the zones.
+struct compute_ground_bin_functor {
+    compute_ground_bin_functor(const ground_zones &zones) : zones_(zones){};
+    const ground_zones zones_;
+    __device__ int operator()(const Eigen::Vector3f &p) const {
+        const float r = sqrt(p(0) * p(0) + p(1) * p(1));
+        for (int z = 0; z < zones_.n_zones_; ++z) {
+            const float r0 = zones_.boundaries_[z];
+            const float r1 = zones_.boundaries_[z + 1];
+            if (r < r0 || r >= r1) continue;
+            const int ring =
+                    min(int((r - r0) / (r1 - r0) * zones_.num_rings_[z]),
+                        zones_.num_rings_[z] - 1);
+            const float theta = atan2(p(1), p(0)) + M_PI;
+            const int sector =
+                    min(int(theta / (2.0 * M_PI) * zones_.num_sectors_[z]),
+                        zones_.num_sectors_[z] - 1);
+            return zones_.bin_offsets_[z] + ring * zones_.num_sectors_[z] +
+                   sector;
+        }
+        return -1;
+    }
+};
+
+struct plane_moments {
+    float n_;
+    Eigen::Vector3f sum_;
+    Eigen::Matrix3f outer_;
+};
+
+struct plane_moments_plus {
+    __device__ plane_moments operator()(const plane_moments &a,
+                                        const plane_moments &b) const {
+        return plane_moments{a.n_ + b.n_, a.sum_ + b.sum_,
+                             a.outer_ + b.outer_};
+    }
+};
+
+// Moments of the selected points of a bin, relative to the lowest point of
+// the bin.
+struct selected_moments_functor {
+    selected_moments_functor(const Eigen::Vector3f *points,
+                             const int *segments,
+                             const int *starts,
+                             const bool *selected)
+        : points_(points),
+          segments_(segments),
+          starts_(starts),
+          selected_(selected){};
+    const Eigen::Vector3f *points_;
+    const int *segments_;
+    const int *starts_;
+    const bool *selected_;
+    __device__ plane_moments operator()(size_t idx) const {
+        if (!selected_[idx]) {
+            return plane_moments{0.0, Eigen::Vector3f::Zero(),
+                                 Eigen::Matrix3f::Zero()};
+        }
+        const Eigen::Vector3f p =
+                points_[idx] - points_[starts_[segments_[idx]]];
+        return plane_moments{1.0, p, p * p.transpose()};
+    }
+};
+
+// Fits the plane of a bin to its selected points. The planes are stored
+// relative to the lowest point of the bin, with the normal facing up.
+struct fit_bin_plane_functor {
+    fit_bin_plane_functor(const plane_moments *moments,
+                          Eigen::Vector4f *planes)
+        : moments_(moments), planes_(planes){};
+    const plane_moments *moments_;
+    Eigen::Vector4f *planes_;
+    __device__ void operator()(size_t idx) {
+        const plane_moments &m = moments_[idx];
+        Eigen::Vector4f plane;
+        if (!FitPlaneFromMoments(m.n_, m.sum_, m.outer_, plane)) {
+            planes_[idx] = Eigen::Vector4f::Zero();
+            return;
+        }
+        planes_[idx] = (plane(2) < 0.0) ? Eigen::Vector4f(-plane) : plane;
+    }
+};
+
+struct select_plane_inliers_functor {
+    select_plane_inliers_functor(const Eigen::Vector3f *points,
+                                 const int *segments,
+                                 const int *starts,
+                                 const Eigen::Vector4f *planes,
+                                 float distance_threshold)
+        : points_(points),
+          segments_(segments),
+          starts_(starts),
+          planes_(planes),
+          distance_threshold_(distance_threshold){};
+    const Eigen::Vector3f *points_;
+    const int *segments_;
+    const int *starts_;
+    const Eigen::Vector4f *planes_;
+    const float distance_threshold_;
+    __device__ bool operator()(size_t idx) const {
+        const int s = segments_[idx];
+        const Eigen::Vector4f &plane = planes_[s];
+        if (plane(2) == 0.0) return false;
+        const Eigen::Vector3f p = points_[idx] - points_[starts_[s]];
+        return abs(plane.head<3>().dot(p) + plane(3)) < distance_threshold_;
+    }
+};
+
+}  // namespace
+
+std::tuple<Eigen::Vector4f, utility::device_vector<size_t>>
+PointCloud::SegmentPlane(float distance_threshold,
+                         int ransac_n,
+                         int num_iterations,
+                         unsigned int seed) const {
+    CUPOCH_PROFILE("PointCloud::SegmentPlane");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    if (ransac_n < 3 || ransac_n > kMaxRansacN) {
+        utility::LogError(
+                "[SegmentPlane] ransac_n must be between 3 and {:d}.",
+                kMaxRansacN);
+    }
+    if (distance_threshold <= 0.0 || num_iterations <= 0) {
+        utility::LogError(
+                "[SegmentPlane] Illegal input parameters, distance threshold "
+                "and number of iterations must be positive.");
+    }
+    const int n_points = points_.size();
+    if (n_points < ransac_n) {
+        utility::LogWarning(
+                "[SegmentPlane] There must be at least ransac_n points.\n");
+        return std::make_tuple(Eigen::Vector4f::Zero().eval(),
+                               utility::device_vector<size_t>());
+    }
+
+    utility::device_vector<int> counts(num_iterations);
+    utility::device_vector<Eigen::Vector4f_u> planes(num_iterations);
+    plane_hypothesis_functor func(thrust::raw_pointer_cast(points_.data()),
+                                  n_points, ransac_n, distance_threshold,
+                                  seed);
+    thrust::transform(thrust::make_counting_iterator<unsigned int>(0),
+                      thrust::make_counting_iterator<unsigned int>(
+                              num_iterations),
+                      make_tuple_begin(counts, planes), func);
+    auto itr = thrust::max_element(counts.begin(), counts.end());
+    if (*itr < 3) {
+        return std::make_tuple(Eigen::Vector4f::Zero().eval(),
+                               utility::device_vector<size_t>());
+    }
+    const Eigen::Vector4f_u best_plane =
+            planes[thrust::distance(counts.begin(), itr)];
+
+    utility::device_vector<size_t> inliers(n_points);
+    const Eigen::Vector3f *points = thrust::raw_pointer_cast(points_.data());
+    auto end = thrust::copy_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator<size_t>(n_points), inliers.begin(),
+            [points, best_plane, distance_threshold] __device__(size_t i) {
+                return abs(best_plane.head<3>().dot(points[i]) +
+                           best_plane(3)) < distance_threshold;
+            });
+    inliers.resize(thrust::distance(inliers.begin(), end));
+
+    // Least squares refit on the inliers.
+    utility::device_vector<Eigen::Vector3f> inlier_points(inliers.size());
+    thrust::gather(inliers.begin(), inliers.end(), points_.begin(),
+                   inlier_points.begin());
+    const PointStatistics stats =
+            ComputePointStatistics(inlier_points, true);
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver(stats.covariance_);
+    Eigen::Vector3f normal = solver.eigenvectors().col(0);
+    if (normal.dot(best_plane.head<3>()) < 0.0) normal = -normal;
+    Eigen::Vector4f plane;
+    plane << normal, -normal.dot(stats.mean_);
+    return std::make_tuple(plane, inliers);
+}
+
+utility::device_vector<size_t> PointCloud::SegmentGround(
+        const GroundSegmentationOption &option) const {
+    CUPOCH_PROFILE("PointCloud::SegmentGround");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
+    const int n_zones = option.num_rings_.size();
+    if (n_zones == 0 || n_zones > kMaxGroundZones ||
+        option.num_sectors_.size() != n_zones ||
+        option.zone_boundaries_.size() != n_zones + 1) {
+        utility::LogError(
+                "[SegmentGround] There must be 1 to {:d} zones, with one ring "
+                "and sector count per zone and one more boundary.",
+                kMaxGroundZones);
+    }
+    ground_zones zones;
+    zones.n_zones_ = n_zones;
+    int n_bins = 0;
+    for (int z = 0; z < n_zones; ++z) {
+        if (option.num_rings_[z] <= 0 || option.num_sectors_[z] <= 0 ||
+            option.zone_boundaries_[z] >= option.zone_boundaries_[z + 1]) {
+            utility::LogError(
+                    "[SegmentGround] The ring and sector counts must be "
+                    "positive and the boundaries increasing.");
+        }
+        zones.boundaries_[z] = option.zone_boundaries_[z];
+        zones.num_rings_[z] = option.num_rings_[z];
+        zones.num_sectors_[z] = option.num_sectors_[z];
+        zones.bin_offsets_[z] = n_bins;
+        n_bins += option.num_rings_[z] * option.num_sectors_[z];
+    }
+    zones.boundaries_[n_zones] = option.zone_boundaries_[n_zones];
+
+    // Points in the zones, sorted by bin and by height within a bin.
+    const size_t n_points = points_.size();
+    utility::device_vector<int> bins(n_points);
+    thrust::transform(points_.begin(), points_.end(), bins.begin(),
+                      compute_ground_bin_functor(zones));
+    utility::device_vector<size_t> indices(n_points);
+    auto end = thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
+                               thrust::make_counting_iterator(n_points),
+                               bins.begin(), indices.begin(),
+                               [] __device__(int b) { return b >= 0; });
+    indices.resize(thrust::distance(indices.begin(), end));
+    const size_t n_valid = indices.size();
+    if (n_valid == 0) return utility::device_vector<size_t>();
+    utility::device_vector<float> heights(n_valid);
+    const Eigen::Vector3f *src_points =
+            thrust::raw_pointer_cast(points_.data());
+    thrust::transform(indices.begin(), indices.end(), heights.begin(),
+                      [src_points] __device__(size_t i) {
+                          return src_points[i](2);
+                      });
+    thrust::stable_sort_by_key(heights.begin(), heights.end(),
+                               indices.begin());
+    utility::device_vector<int> sorted_bins(n_valid);
+    thrust::gather(indices.begin(), indices.end(), bins.begin(),
+                   sorted_bins.begin());
+    thrust::stable_sort_by_key(sorted_bins.begin(), sorted_bins.end(),
+                               indices.begin());
+    utility::device_vector<Eigen::Vector3f> points(n_valid);
+    thrust::gather(indices.begin(), indices.end(), points_.begin(),
+                   points.begin());
+
+    // Contiguous range of every occupied bin.
+    utility::device_vector<int> unique_bins(n_valid);
+    utility::device_vector<int> bin_counts(n_valid);
+    auto bin_end = thrust::reduce_by_key(
+            sorted_bins.begin(), sorted_bins.end(),
+            thrust::make_constant_iterator(1), unique_bins.begin(),
+            bin_counts.begin());
+    const size_t n_segments =
+            thrust::distance(unique_bins.begin(), bin_end.first);
+    unique_bins.resize(n_segments);
+    bin_counts.resize(n_segments);
+    utility::device_vector<int> starts(n_segments);
+    thrust::exclusive_scan(bin_counts.begin(), bin_counts.end(),
+                           starts.begin());
+    utility::device_vector<int> segments(n_valid);
+    thrust::lower_bound(unique_bins.begin(), unique_bins.end(),
+                        sorted_bins.begin(), sorted_bins.end(),
+                        segments.begin());
+
+    // The seeds are the points close to the lowest ones of their bin.
+    const Eigen::Vector3f *points_ptr = thrust::raw_pointer_cast(points.data());
+    const int *starts_ptr = thrust::raw_pointer_cast(starts.data());
+    const int *counts_ptr = thrust::raw_pointer_cast(bin_counts.data());
+    const int *segments_ptr = thrust::raw_pointer_cast(segments.data());
+    utility::device_vector<float> seed_heights(n_segments);
+    const int num_lowest = std::max(option.num_lowest_points_, 1);
+    const float seed_height = option.seed_height_;
+    thrust::transform(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(n_segments), seed_heights.begin(),
+            [points_ptr, starts_ptr, counts_ptr, num_lowest,
+             seed_height] __device__(size_t s) {
+                const int n = min(counts_ptr[s], num_lowest);
+                float sum = 0.0;
+                for (int k = 0; k < n; ++k) {
+                    sum += points_ptr[starts_ptr[s] + k](2);
+                }
+                return sum / n + seed_height;
+            });
+    utility::device_vector<bool> selected(n_valid);
+    const float *seed_heights_ptr =
+            thrust::raw_pointer_cast(seed_heights.data());
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_valid),
+                      selected.begin(),
+                      [points_ptr, segments_ptr,
+                       seed_heights_ptr] __device__(size_t i) {
+                          return points_ptr[i](2) <
+                                 seed_heights_ptr[segments_ptr[i]];
+                      });
+
+    // Plane fits of all bins at once, each refitted to its inliers.
+    utility::device_vector<plane_moments> moments(n_segments);
+    utility::device_vector<Eigen::Vector4f> planes(n_segments);
+    selected_moments_functor moments_func(
+            points_ptr, segments_ptr, starts_ptr,
+            thrust::raw_pointer_cast(selected.data()));
+    select_plane_inliers_functor inliers_func(
+            points_ptr, segments_ptr, starts_ptr,
+            thrust::raw_pointer_cast(planes.data()),
+            option.distance_threshold_);
+    for (int it = 0; it < std::max(option.num_iterations_, 1); ++it) {
+        thrust::reduce_by_key(
+                segments.begin(), segments.end(),
+                thrust::make_transform_iterator(
+                        thrust::make_counting_iterator<size_t>(0),
+                        moments_func),
+                thrust::make_discard_iterator(), moments.begin(),
+                thrust::equal_to<int>(), plane_moments_plus());
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_segments),
+                         fit_bin_plane_functor(
+                                 thrust::raw_pointer_cast(moments.data()),
+                                 thrust::raw_pointer_cast(planes.data())));
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(n_valid),
+                          selected.begin(), inliers_func);
+    }
+
+    // Ground points are the inliers of the upright planes of the bins with
+    // enough points.
+    const Eigen::Vector4f *planes_ptr = thrust::raw_pointer_cast(planes.data());
+    const float uprightness = option.uprightness_threshold_;
+    const int min_points = option.min_points_;
+    utility::device_vector<size_t> ground(n_valid);
+    auto ground_end = thrust::copy_if(
+            indices.begin(), indices.end(),
+            thrust::make_zip_iterator(
+                    thrust::make_tuple(selected.begin(), segments.begin())),
+            ground.begin(),
+            [planes_ptr, counts_ptr, uprightness, min_points] __device__(
+                    const thrust::tuple<bool, int> &x) {
+                const int s = thrust::get<1>(x);
+                return thrust::get<0>(x) && counts_ptr[s] >= min_points &&
+                       planes_ptr[s](2) >= uprightness;
+            });
+    ground.resize(thrust::distance(ground.begin(), ground_end));
+    thrust::sort(ground.begin(), ground.end());
+    return ground;
+}
@@ -0,0 +1,226 @@
+#include <thrust/fill.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+
+#include "cupoch/geometry/range_image.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/union_find.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+void CheckRangeImage(const Image &range,
+                     const RangeImageProjection &projection,
+                     const char *name) {
+    if (range.num_of_channels_ != 1 || range.bytes_per_channel_ != 4 ||
+        range.width_ != projection.num_columns_ ||
+        range.height_ != projection.num_rings_) {
+        utility::LogError(
+                "[{}] The range image must be a single channel float image "
+                "of the projection size.",
+                name);
+    }
+}
+
+__device__ bool IsValidRange(float r) { return r > 0.0f && isfinite(r); }
+
+struct label_ground_column_functor {
+    label_ground_column_functor(const float *range,
+                                const RangeImageProjection &projection,
+                                float max_slope,
+                                uint8_t *labels)
+        : range_(range),
+          projection_(projection),
+          max_slope_(max_slope),
+          labels_(labels){};
+    const float *range_;
+    const RangeImageProjection projection_;
+    const float max_slope_;
+    uint8_t *labels_;
+    __device__ void operator()(int col) const {
+        const int width = projection_.num_columns_;
+        bool has_prev = false;
+        bool seed_pending = false;
+        int seed_idx = 0;
+        Eigen::Vector3f prev;
+        for (int row = projection_.num_rings_ - 1; row >= 0; --row) {
+            const int idx = row * width + col;
+            const float r = range_[idx];
+            if (!IsValidRange(r)) continue;
+            const Eigen::Vector3f p =
+                    r * projection_.GetBeamDirection(row, col);
+            if (!has_prev) {
+                // The lowest pixel is ground if the next one confirms it.
+                has_prev = true;
+                seed_pending = true;
+                seed_idx = idx;
+                prev = p;
+                continue;
+            }
+            const Eigen::Vector3f diff = p - prev;
+            const float slope = atan2f(abs(diff(2)), diff.head<2>().norm());
+            const bool ground = slope < max_slope_;
+            if (seed_pending) {
+                labels_[seed_idx] = ground;
+                seed_pending = false;
+            }
+            if (ground) {
+                labels_[idx] = 1;
+                prev = p;
+            }
+        }
+    }
+};
+
+// Bogoslavskyi's criterion: the angle at the farther point between its beam
+// and the line to the nearer one.
+__device__ bool IsSameObject(float ra,
+                             float rb,
+                             float sin_alpha,
+                             float cos_alpha,
+                             float angle_threshold) {
+    const float d1 = max(ra, rb);
+    const float d2 = min(ra, rb);
+    return atan2f(d2 * sin_alpha, d1 - d2 * cos_alpha) > angle_threshold;
+}
+
+struct union_range_pixels_functor {
+    union_range_pixels_functor(const float *range,
+                               const uint8_t *ground,
+                               const RangeImageProjection &projection,
+                               float angle_threshold,
+                               int *parents)
+        : range_(range),
+          ground_(ground),
+          width_(projection.num_columns_),
+          height_(projection.num_rings_),
+          sin_azimuth_(sinf(projection.GetAzimuthStep())),
+          cos_azimuth_(cosf(projection.GetAzimuthStep())),
+          sin_elevation_(sinf(projection.GetElevationStep())),
+          cos_elevation_(cosf(projection.GetElevationStep())),
+          angle_threshold_(angle_threshold),
+          parents_(parents){};
+    const float *range_;
+    const uint8_t *ground_;
+    const int width_;
+    const int height_;
+    const float sin_azimuth_;
+    const float cos_azimuth_;
+    const float sin_elevation_;
+    const float cos_elevation_;
+    const float angle_threshold_;
+    int *parents_;
+    __device__ bool IsForeground(int idx) const {
+        return IsValidRange(range_[idx]) && (!ground_ || ground_[idx] == 0);
+    }
+    __device__ void operator()(int idx) const {
+        if (!IsForeground(idx)) return;
+        const int row = idx / width_;
+        const int col = idx % width_;
+        const float r = range_[idx];
+        const int right = row * width_ + (col + 1) % width_;
+        if (right != idx && IsForeground(right) &&
+            IsSameObject(r, range_[right], sin_azimuth_, cos_azimuth_,
+                         angle_threshold_)) {
+            utility::UnionRoots(parents_, idx, right);
+        }
+        if (row + 1 < height_) {
+            const int down = idx + width_;
+            if (IsForeground(down) &&
+                IsSameObject(r, range_[down], sin_elevation_, cos_elevation_,
+                             angle_threshold_)) {
+                utility::UnionRoots(parents_, idx, down);
+            }
+        }
+    }
+};
+
+struct compress_range_pixel_functor {
+    compress_range_pixel_functor(int *parents) : parents_(parents){};
+    int *parents_;
+    __device__ void operator()(int idx) const {
+        parents_[idx] = utility::FindRoot(parents_, idx);
+    }
+};
+
+}  // namespace
+
+std::shared_ptr<Image> geometry::LabelRangeImageGround(
+        const Image &range,
+        const RangeImageProjection &projection,
+        float max_slope) {
+    CheckRangeImage(range, projection, "LabelRangeImageGround");
+    auto labels = std::make_shared<Image>();
+    labels->Prepare(range.width_, range.height_, 1, 1);
+    thrust::fill(labels->data_.begin(), labels->data_.end(), 0);
+    label_ground_column_functor func(
+            (const float *)thrust::raw_pointer_cast(range.data_.data()),
+            projection, max_slope,
+            thrust::raw_pointer_cast(labels->data_.data()));
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(range.width_), func);
+    return labels;
+}
+
+std::shared_ptr<Image> geometry::ClusterRangeImage(
+        const Image &range,
+        const RangeImageProjection &projection,
+        float angle_threshold,
+        const Image &ground) {
+    CheckRangeImage(range, projection, "ClusterRangeImage");
+    const bool has_ground = ground.HasData();
+    if (has_ground &&
+        (ground.width_ != range.width_ || ground.height_ != range.height_ ||
+         ground.num_of_channels_ != 1 || ground.bytes_per_channel_ != 1)) {
+        utility::LogError(
+                "[ClusterRangeImage] The ground labels must be a single "
+                "channel uint8 image of the range image size.");
+    }
+    const int n_pixels = range.width_ * range.height_;
+    const float *ranges =
+            (const float *)thrust::raw_pointer_cast(range.data_.data());
+    const uint8_t *ground_labels =
+            (has_ground) ? thrust::raw_pointer_cast(ground.data_.data())
+                         : nullptr;
+    utility::device_vector<int> parents(n_pixels);
+    thrust::sequence(parents.begin(), parents.end());
+    int *parents_ptr = thrust::raw_pointer_cast(parents.data());
+    union_range_pixels_functor union_func(ranges, ground_labels, projection,
+                                          angle_threshold, parents_ptr);
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_pixels), union_func);
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_pixels),
+                     compress_range_pixel_functor(parents_ptr));
+
+    // Cluster ids numbered by their root pixels.
+    utility::device_vector<int> cluster_ids(n_pixels);
+    thrust::transform(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(n_pixels), cluster_ids.begin(),
+            [union_func, parents_ptr] __device__(int idx) {
+                return (union_func.IsForeground(idx) &&
+                        parents_ptr[idx] == idx)
+                               ? 1
+                               : 0;
+            });
+    thrust::exclusive_scan(cluster_ids.begin(), cluster_ids.end(),
+                           cluster_ids.begin());
+    auto labels = std::make_shared<Image>();
+    labels->Prepare(range.width_, range.height_, 1, 4);
+    const int *cluster_ids_ptr = thrust::raw_pointer_cast(cluster_ids.data());
+    thrust::transform(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(n_pixels),
+            thrust::device_pointer_cast(
+                    (int *)thrust::raw_pointer_cast(labels->data_.data())),
+            [union_func, parents_ptr, cluster_ids_ptr] __device__(int idx) {
+                return (union_func.IsForeground(idx))
+                               ? cluster_ids_ptr[parents_ptr[idx]]
+                               : -1;
+            });
+    return labels;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+#include <memory>
+
+#include "cupoch/geometry/image.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// \class RangeImageProjection
+///
+/// \brief Spherical projection of a spinning LiDAR scan onto a range image
+/// of num_rings_ rows and num_columns_ columns.
+///
+/// Row 0 is the ring at max_elevation_ and the last row the ring at
+/// min_elevation_, the rings being evenly spaced in between. The azimuth
+/// decreases from pi at column 0, so that the columns run from left to right
+/// as seen from the sensor, as the pixels of a camera image. The angles are
+/// in radians and the points in the sensor frame, z up. The defaults are
+/// those of a 64 beam LiDAR.
+class RangeImageProjection {
+public:
+    RangeImageProjection(int num_rings = 64,
+                         int num_columns = 1024,
+                         float min_elevation = -0.4346,
+                         float max_elevation = 0.0349,
+                         float min_range = 0.0,
+                         float max_range = 1000.0)
+        : num_rings_(num_rings),
+          num_columns_(num_columns),
+          min_elevation_(min_elevation),
+          max_elevation_(max_elevation),
+          min_range_(min_range),
+          max_range_(max_range) {}
+
+    /// Elevation between two consecutive rings.
+    __host__ __device__ float GetElevationStep() const {
+        return (num_rings_ > 1)
+                       ? (max_elevation_ - min_elevation_) / (num_rings_ - 1)
+                       : 0.0f;
+    }
+    /// Azimuth between two consecutive columns.
+    __host__ __device__ float GetAzimuthStep() const {
+        return 2.0f * M_PI / num_columns_;
+    }
+
+    /// Pixel of the point \p p and its range, false if it is out of the
+    /// image or of the range limits.
+    __host__ __device__ bool ProjectToPixel(const Eigen::Vector3f &p,
+                                            int &row,
+                                            int &col,
+                                            float &range) const {
+        range = p.norm();
+        if (!(range > 0.0f) || range < min_range_ || range > max_range_) {
+            return false;
+        }
+        const float elevation = asinf(p(2) / range);
+        const float elevation_step = GetElevationStep();
+        row = (elevation_step > 0.0f)
+                      ? (int)roundf((max_elevation_ - elevation) /
+                                    elevation_step)
+                      : 0;
+        if (row < 0 || row >= num_rings_) return false;
+        col = (int)((M_PI - atan2f(p(1), p(0))) / GetAzimuthStep());
+        col = (col < 0) ? 0 : ((col >= num_columns_) ? num_columns_ - 1 : col);
+        return true;
+    }
+    /// Unit vector along the beam through the center of a pixel.
+    __host__ __device__ Eigen::Vector3f GetBeamDirection(int row,
+                                                         int col) const {
+        const float elevation = max_elevation_ - row * GetElevationStep();
+        const float azimuth = M_PI - (col + 0.5f) * GetAzimuthStep();
+        return Eigen::Vector3f(cosf(elevation) * cosf(azimuth),
+                               cosf(elevation) * sinf(azimuth),
+                               sinf(elevation));
+    }
+
+public:
+    int num_rings_;
+    int num_columns_;
+    float min_elevation_;
+    float max_elevation_;
+    /// Points with a range out of [min_range_, max_range_] are not projected.
+    float min_range_;
+    float max_range_;
+};
+
+/// Labels the ground pixels of the float range image \p range of
+/// \p projection, scanning every column upward from its lowest valid
+/// pixel: a pixel is ground while the slope from the last ground pixel of
+/// its column stays below \p max_slope. A column scan therefore skips the
+/// objects standing on the ground and resumes on the ground beyond them.
+/// Returns a single channel uint8 image, 1 for ground and 0 otherwise.
+std::shared_ptr<Image> LabelRangeImageGround(
+        const Image &range,
+        const RangeImageProjection &projection,
+        float max_slope = 0.1745);
+
+/// Segments the float range image \p range of \p projection into objects,
+/// after Bogoslavskyi and Stachniss, "Fast Range Image-Based Segmentation
+/// of Sparse 3D Laser Scans for Online Operation", 2016. Two 4-connected
+/// valid pixels, the columns wrapping around, are in the same cluster when
+/// the angle between the beam of the farther one and the line through both
+/// points exceeds \p angle_threshold. The pixels that are non zero in the
+/// optional uint8 image \p ground, e.g. from LabelRangeImageGround(), are
+/// left out. Returns a single channel int image of the cluster labels,
+/// numbered from 0, and -1 for the invalid and ground pixels.
+std::shared_ptr<Image> ClusterRangeImage(
+        const Image &range,
+        const RangeImageProjection &projection,
+        float angle_threshold = 0.1745,
+        const Image &ground = Image());
+
+}  // namespace geometry
+}  // namespace cupoch
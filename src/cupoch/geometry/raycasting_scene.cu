@@ -0,0 +1,434 @@
+#include <thrust/binary_search.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/sequence.h>
+
+#include "cupoch/geometry/intersection_test.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/raycasting_scene.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+namespace cupoch {
+namespace geometry {
+
+namespace {
+
+struct shift_triangle_functor {
+    shift_triangle_functor(int offset) : offset_(offset){};
+    const int offset_;
+    __device__ Eigen::Vector3i operator()(const Eigen::Vector3i &tri) const {
+        return tri + Eigen::Vector3i::Constant(offset_);
+    }
+};
+
+struct nearest_triangle {
+    int index_ = -1;
+    float t_ = std::numeric_limits<float>::infinity();
+    float u_ = 0.0f;
+    float v_ = 0.0f;
+};
+
+struct triangle_node_test {
+    __device__ triangle_node_test(const Eigen::Vector3f &origin,
+                                  const Eigen::Vector3f &direction,
+                                  const float *t_max)
+        : origin_(origin), inv_dir_(direction.cwiseInverse()), t_max_(t_max){};
+    const Eigen::Vector3f origin_;
+    const Eigen::Vector3f inv_dir_;
+    const float *t_max_;
+    __device__ bool operator()(const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) const {
+        return intersection_test::RayAABB(origin_, inv_dir_, min_bound,
+                                          max_bound, *t_max_) < *t_max_;
+    }
+};
+
+struct nearest_triangle_leaf {
+    __device__ nearest_triangle_leaf(const Eigen::Vector3f &origin,
+                                     const Eigen::Vector3f &direction,
+                                     const Eigen::Vector3f *vertices,
+                                     const Eigen::Vector3i *triangles,
+                                     nearest_triangle *best)
+        : origin_(origin),
+          direction_(direction),
+          vertices_(vertices),
+          triangles_(triangles),
+          best_(best){};
+    const Eigen::Vector3f origin_;
+    const Eigen::Vector3f direction_;
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3i *triangles_;
+    nearest_triangle *best_;
+    __device__ bool operator()(int box,
+                               const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) {
+        const Eigen::Vector3i &tri = triangles_[box];
+        float t, u, v;
+        if (intersection_test::RayTriangle(
+                    origin_, direction_, vertices_[tri[0]], vertices_[tri[1]],
+                    vertices_[tri[2]], best_->t_, t, u, v)) {
+            best_->index_ = box;
+            best_->t_ = t;
+            best_->u_ = u;
+            best_->v_ = v;
+        }
+        return true;
+    }
+};
+
+struct count_triangle_leaf {
+    __device__ count_triangle_leaf(const Eigen::Vector3f &origin,
+                                   const Eigen::Vector3f &direction,
+                                   const Eigen::Vector3f *vertices,
+                                   const Eigen::Vector3i *triangles,
+                                   float t_max)
+        : origin_(origin),
+          direction_(direction),
+          vertices_(vertices),
+          triangles_(triangles),
+          t_max_(t_max){};
+    const Eigen::Vector3f origin_;
+    const Eigen::Vector3f direction_;
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3i *triangles_;
+    const float t_max_;
+    /// Ray parameters of the hits, written when not null.
+    float *t_hits_ = nullptr;
+    int count_ = 0;
+    __device__ bool operator()(int box,
+                               const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound) {
+        const Eigen::Vector3i &tri = triangles_[box];
+        float t, u, v;
+        if (intersection_test::RayTriangle(
+                    origin_, direction_, vertices_[tri[0]], vertices_[tri[1]],
+                    vertices_[tri[2]], t_max_, t, u, v)) {
+            if (t_hits_) t_hits_[count_] = t;
+            ++count_;
+        }
+        return true;
+    }
+};
+
+struct cast_ray_functor {
+    cast_ray_functor(const AABBTreeView &view,
+                     const Eigen::Vector3f *vertices,
+                     const Eigen::Vector3i *triangles,
+                     const unsigned int *geometry_ids,
+                     const unsigned int *primitive_ids,
+                     float max_distance)
+        : view_(view),
+          vertices_(vertices),
+          triangles_(triangles),
+          geometry_ids_(geometry_ids),
+          primitive_ids_(primitive_ids),
+          max_distance_(max_distance){};
+    const AABBTreeView view_;
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3i *triangles_;
+    const unsigned int *geometry_ids_;
+    const unsigned int *primitive_ids_;
+    const float max_distance_;
+    __device__ thrust::tuple<float, unsigned int, unsigned int, Eigen::Vector2f,
+                             Eigen::Vector3f>
+    operator()(const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> &x) const {
+        const Eigen::Vector3f &origin = thrust::get<0>(x);
+        const Eigen::Vector3f &direction = thrust::get<1>(x);
+        nearest_triangle best;
+        best.t_ = max_distance_;
+        triangle_node_test test(origin, direction, &best.t_);
+        nearest_triangle_leaf leaf(origin, direction, vertices_, triangles_,
+                                   &best);
+        view_.Traverse(test, leaf);
+        if (best.index_ < 0) {
+            return thrust::make_tuple(std::numeric_limits<float>::infinity(),
+                                      RaycastingScene::kInvalidId,
+                                      RaycastingScene::kInvalidId,
+                                      Eigen::Vector2f::Zero().eval(),
+                                      Eigen::Vector3f::Zero().eval());
+        }
+        const Eigen::Vector3i &tri = triangles_[best.index_];
+        const Eigen::Vector3f n =
+                (vertices_[tri[1]] - vertices_[tri[0]])
+                        .cross(vertices_[tri[2]] - vertices_[tri[0]])
+                        .normalized();
+        return thrust::make_tuple(best.t_, geometry_ids_[best.index_],
+                                  primitive_ids_[best.index_],
+                                  Eigen::Vector2f(best.u_, best.v_), n);
+    }
+};
+
+struct count_intersections_functor {
+    count_intersections_functor(const AABBTreeView &view,
+                                const Eigen::Vector3f *vertices,
+                                const Eigen::Vector3i *triangles,
+                                float max_distance,
+                                const int *offsets = nullptr,
+                                float *t_hits = nullptr)
+        : view_(view),
+          vertices_(vertices),
+          triangles_(triangles),
+          max_distance_(max_distance),
+          offsets_(offsets),
+          t_hits_(t_hits){};
+    const AABBTreeView view_;
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3i *triangles_;
+    const float max_distance_;
+    const int *offsets_;
+    float *t_hits_;
+    __device__ int operator()(
+            const thrust::tuple<size_t, Eigen::Vector3f, Eigen::Vector3f> &x)
+            const {
+        const Eigen::Vector3f &origin = thrust::get<1>(x);
+        const Eigen::Vector3f &direction = thrust::get<2>(x);
+        triangle_node_test test(origin, direction, &max_distance_);
+        count_triangle_leaf leaf(origin, direction, vertices_, triangles_,
+                                 max_distance_);
+        if (t_hits_) leaf.t_hits_ = t_hits_ + offsets_[thrust::get<0>(x)];
+        view_.Traverse(test, leaf);
+        return leaf.count_;
+    }
+};
+
+/// Unit direction of the beam idx in the sensor frame, x forward and z up.
+struct lidar_ray_functor {
+    lidar_ray_functor(int n_horizontal,
+                      int n_vertical,
+                      float fov_up,
+                      float fov_down)
+        : n_horizontal_(n_horizontal),
+          n_vertical_(n_vertical),
+          fov_up_(fov_up),
+          fov_down_(fov_down){};
+    const int n_horizontal_;
+    const int n_vertical_;
+    const float fov_up_;
+    const float fov_down_;
+    __device__ Eigen::Vector3f operator()(int idx) const {
+        const int i = idx / n_horizontal_;
+        const int j = idx % n_horizontal_;
+        const float elevation =
+                (n_vertical_ > 1) ? fov_down_ + (fov_up_ - fov_down_) * i /
+                                                        (n_vertical_ - 1)
+                                  : fov_down_;
+        const float azimuth = 2.0f * M_PI * j / n_horizontal_;
+        const float ce = cosf(elevation);
+        return Eigen::Vector3f(ce * cosf(azimuth), ce * sinf(azimuth),
+                               sinf(elevation));
+    }
+};
+
+struct lidar_hit_functor {
+    lidar_hit_functor(const Eigen::Matrix3f &rotation) : rotation_(rotation){};
+    const Eigen::Matrix3f rotation_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            const thrust::tuple<Eigen::Vector3f, float, Eigen::Vector3f> &x)
+            const {
+        return thrust::make_tuple(
+                (thrust::get<0>(x) * thrust::get<1>(x)).eval(),
+                (rotation_.transpose() * thrust::get<2>(x)).eval());
+    }
+};
+
+struct lidar_miss_functor {
+    __device__ bool operator()(
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, float> &x)
+            const {
+        return isinf(thrust::get<2>(x));
+    }
+};
+
+}  // namespace
+
+RaycastingScene::RaycastingScene() {}
+RaycastingScene::~RaycastingScene() {}
+
+unsigned int RaycastingScene::AddTriangles(const TriangleMesh &mesh) {
+    const unsigned int id = geometry_offsets_.size();
+    const size_t n_old_vertices = vertices_.size();
+    const size_t n_old = triangles_.size();
+    const size_t n_new = mesh.triangles_.size();
+    geometry_offsets_.push_back(n_old);
+    vertices_.insert(vertices_.end(), mesh.vertices_.begin(),
+                     mesh.vertices_.end());
+    triangles_.resize(n_old + n_new);
+    thrust::transform(mesh.triangles_.begin(), mesh.triangles_.end(),
+                      triangles_.begin() + n_old,
+                      shift_triangle_functor(n_old_vertices));
+    triangle_geometry_ids_.resize(n_old + n_new, id);
+    triangle_primitive_ids_.resize(n_old + n_new);
+    thrust::sequence(triangle_primitive_ids_.begin() + n_old,
+                     triangle_primitive_ids_.end());
+    AABBTree::AppendBoxes(mesh, min_bounds_, max_bounds_);
+    tree_updated_ = false;
+    return id;
+}
+
+RaycastingScene &RaycastingScene::Clear() {
+    vertices_.clear();
+    triangles_.clear();
+    triangle_geometry_ids_.clear();
+    triangle_primitive_ids_.clear();
+    min_bounds_.clear();
+    max_bounds_.clear();
+    geometry_offsets_.clear();
+    tree_.Clear();
+    tree_updated_ = true;
+    return *this;
+}
+
+void RaycastingScene::UpdateTree() const {
+    if (tree_updated_) return;
+    tree_.Build(min_bounds_, max_bounds_);
+    tree_updated_ = true;
+}
+
+void RaycastingScene::CastRays(
+        const utility::device_vector<Eigen::Vector3f> &origins,
+        const utility::device_vector<Eigen::Vector3f> &directions,
+        RayCastResult &result,
+        float max_distance) const {
+    if (origins.size() != directions.size()) {
+        utility::LogError(
+                "[RaycastingScene::CastRays] origins and directions have "
+                "different sizes.");
+        return;
+    }
+    UpdateTree();
+    const size_t n = origins.size();
+    resize_all(n, result.t_hit_, result.geometry_ids_, result.primitive_ids_,
+               result.primitive_uvs_, result.primitive_normals_);
+    if (n == 0) return;
+    cast_ray_functor func(tree_.GetView(),
+                          thrust::raw_pointer_cast(vertices_.data()),
+                          thrust::raw_pointer_cast(triangles_.data()),
+                          thrust::raw_pointer_cast(triangle_geometry_ids_.data()),
+                          thrust::raw_pointer_cast(
+                                  triangle_primitive_ids_.data()),
+                          max_distance);
+    thrust::transform(make_tuple_begin(origins, directions),
+                      make_tuple_end(origins, directions),
+                      make_tuple_begin(result.t_hit_, result.geometry_ids_,
+                                       result.primitive_ids_,
+                                       result.primitive_uvs_,
+                                       result.primitive_normals_),
+                      func);
+}
+
+utility::device_vector<int> RaycastingScene::CountIntersections(
+        const utility::device_vector<Eigen::Vector3f> &origins,
+        const utility::device_vector<Eigen::Vector3f> &directions,
+        float max_distance) const {
+    utility::device_vector<int> counts;
+    if (origins.size() != directions.size()) {
+        utility::LogError(
+                "[RaycastingScene::CountIntersections] origins and directions "
+                "have different sizes.");
+        return counts;
+    }
+    UpdateTree();
+    counts.resize(origins.size());
+    if (origins.empty()) return counts;
+    count_intersections_functor func(
+            tree_.GetView(), thrust::raw_pointer_cast(vertices_.data()),
+            thrust::raw_pointer_cast(triangles_.data()), max_distance);
+    thrust::transform(
+            make_tuple_iterator(thrust::make_counting_iterator<size_t>(0),
+                                origins.begin(), directions.begin()),
+            make_tuple_iterator(
+                    thrust::make_counting_iterator(origins.size()),
+                    origins.end(), directions.end()),
+            counts.begin(), func);
+    return counts;
+}
+
+void RaycastingScene::ListIntersections(
+        const utility::device_vector<Eigen::Vector3f> &origins,
+        const utility::device_vector<Eigen::Vector3f> &directions,
+        utility::device_vector<int> &offsets,
+        utility::device_vector<float> &t_hits,
+        float max_distance) const {
+    if (origins.size() != directions.size()) {
+        utility::LogError(
+                "[RaycastingScene::ListIntersections] origins and directions "
+                "have different sizes.");
+        return;
+    }
+    const size_t n = origins.size();
+    offsets = CountIntersections(origins, directions, max_distance);
+    offsets.resize(n + 1, 0);
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    const int n_hits = offsets.back();
+    t_hits.resize(n_hits);
+    if (n_hits == 0) return;
+    count_intersections_functor func(
+            tree_.GetView(), thrust::raw_pointer_cast(vertices_.data()),
+            thrust::raw_pointer_cast(triangles_.data()), max_distance,
+            thrust::raw_pointer_cast(offsets.data()),
+            thrust::raw_pointer_cast(t_hits.data()));
+    thrust::transform(
+            make_tuple_iterator(thrust::make_counting_iterator<size_t>(0),
+                                origins.begin(), directions.begin()),
+            make_tuple_iterator(thrust::make_counting_iterator(n),
+                                origins.end(), directions.end()),
+            thrust::make_discard_iterator(), func);
+    // The hits are found in traversal order, sorted by ray then distance.
+    utility::device_vector<int> ray_indices(n_hits);
+    thrust::upper_bound(offsets.begin() + 1, offsets.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(n_hits),
+                        ray_indices.begin());
+    thrust::sort_by_key(t_hits.begin(), t_hits.end(), ray_indices.begin());
+    thrust::stable_sort_by_key(ray_indices.begin(), ray_indices.end(),
+                               t_hits.begin());
+}
+
+std::shared_ptr<PointCloud> RaycastingScene::SimulateLidar(
+        const Eigen::Matrix4f &sensor_pose,
+        int n_horizontal,
+        int n_vertical,
+        float fov_up,
+        float fov_down,
+        float max_range) const {
+    auto output = std::make_shared<PointCloud>();
+    if (n_horizontal <= 0 || n_vertical <= 0) {
+        utility::LogError(
+                "[RaycastingScene::SimulateLidar] n_horizontal and n_vertical "
+                "must be positive.");
+        return output;
+    }
+    const size_t n = n_horizontal * n_vertical;
+    utility::device_vector<Eigen::Vector3f> local_dirs(n);
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(n),
+                      local_dirs.begin(),
+                      lidar_ray_functor(n_horizontal, n_vertical,
+                                        fov_up * M_PI / 180.0,
+                                        fov_down * M_PI / 180.0));
+    const Eigen::Matrix3f rot = sensor_pose.block<3, 3>(0, 0);
+    const Eigen::Vector3f origin = sensor_pose.block<3, 1>(0, 3);
+    utility::device_vector<Eigen::Vector3f> origins(n, origin);
+    utility::device_vector<Eigen::Vector3f> directions(n);
+    thrust::transform(local_dirs.begin(), local_dirs.end(), directions.begin(),
+                      [rot] __device__(const Eigen::Vector3f &d) {
+                          return (rot * d).eval();
+                      });
+    RayCastResult result;
+    CastRays(origins, directions, result, max_range);
+    output->points_.resize(n);
+    output->normals_.resize(n);
+    thrust::transform(make_tuple_begin(local_dirs, result.t_hit_,
+                                       result.primitive_normals_),
+                      make_tuple_end(local_dirs, result.t_hit_,
+                                     result.primitive_normals_),
+                      make_tuple_begin(output->points_, output->normals_),
+                      lidar_hit_functor(rot));
+    remove_if_vectors(lidar_miss_functor(), output->points_, output->normals_,
+                      result.t_hit_);
+    return output;
+}
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "cupoch/geometry/aabb_tree.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+class TriangleMesh;
+
+/// Per ray results of RaycastingScene::CastRays().
+class RayCastResult {
+public:
+    /// Ray parameter of the first hit, infinity for the misses.
+    utility::device_vector<float> t_hit_;
+    /// Id of the hit geometry, as returned by AddTriangles(), and index of
+    /// the hit triangle in it; kInvalidId for the misses.
+    utility::device_vector<unsigned int> geometry_ids_;
+    utility::device_vector<unsigned int> primitive_ids_;
+    /// Barycentric coordinates of the second and third vertices of the hit
+    /// triangle.
+    utility::device_vector<Eigen::Vector2f> primitive_uvs_;
+    /// Unit normal of the hit triangle, facing the side of its winding
+    /// order.
+    utility::device_vector<Eigen::Vector3f> primitive_normals_;
+};
+
+/// \class RaycastingScene
+///
+/// \brief Batched ray casting against triangle meshes.
+///
+/// The triangles of the added meshes are gathered in one AABBTree, built on
+/// the first query after the meshes change. Every ray traverses the tree in
+/// its own thread, front to back with the triangles hit so far pruning the
+/// nodes, so a batch of rays is a single launch.
+class RaycastingScene {
+public:
+    static constexpr unsigned int kInvalidId = ~0u;
+
+    RaycastingScene();
+    ~RaycastingScene();
+
+    /// Adds the triangles of \p mesh and returns the id of the geometry.
+    unsigned int AddTriangles(const TriangleMesh &mesh);
+    RaycastingScene &Clear();
+    size_t GetNumGeometries() const { return geometry_offsets_.size(); }
+    size_t GetNumTriangles() const { return triangles_.size(); }
+
+    /// First hits of the rays origins[i] + t * directions[i] with t in
+    /// [0, max_distance). The directions need not be normalized, t_hit_ is
+    /// in units of their lengths.
+    void CastRays(const utility::device_vector<Eigen::Vector3f> &origins,
+                  const utility::device_vector<Eigen::Vector3f> &directions,
+                  RayCastResult &result,
+                  float max_distance =
+                          std::numeric_limits<float>::infinity()) const;
+
+    /// Number of triangles crossed by every ray for t in [0, max_distance),
+    /// e.g. odd for the origins inside of closed meshes.
+    utility::device_vector<int> CountIntersections(
+            const utility::device_vector<Eigen::Vector3f> &origins,
+            const utility::device_vector<Eigen::Vector3f> &directions,
+            float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    /// All the hits of every ray for t in [0, max_distance): the ray
+    /// parameters of the hits of ray i are t_hits[offsets[i]] to
+    /// t_hits[offsets[i + 1] - 1], in increasing order. The hits are counted
+    /// before being written, so the memory is in the number of hits.
+    void ListIntersections(
+            const utility::device_vector<Eigen::Vector3f> &origins,
+            const utility::device_vector<Eigen::Vector3f> &directions,
+            utility::device_vector<int> &offsets,
+            utility::device_vector<float> &t_hits,
+            float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    /// Simulated scan of a spinning LiDAR at \p sensor_pose: \p n_vertical
+    /// beams evenly spread in elevation from \p fov_down to \p fov_up
+    /// degrees times \p n_horizontal azimuths over a full turn. The hits
+    /// closer than \p max_range are returned in the sensor frame, ordered by
+    /// beam then azimuth, with the normals of the hit triangles.
+    std::shared_ptr<PointCloud> SimulateLidar(
+            const Eigen::Matrix4f &sensor_pose,
+            int n_horizontal,
+            int n_vertical,
+            float fov_up,
+            float fov_down,
+            float max_range) const;
+
+private:
+    void UpdateTree() const;
+
+    utility::device_vector<Eigen::Vector3f> vertices_;
+    utility::device_vector<Eigen::Vector3i> triangles_;
+    /// Geometry of every triangle and its index in the geometry.
+    utility::device_vector<unsigned int> triangle_geometry_ids_;
+    utility::device_vector<unsigned int> triangle_primitive_ids_;
+    /// Bounds of the triangles, appended with them.
+    utility::device_vector<Eigen::Vector3f> min_bounds_;
+    utility::device_vector<Eigen::Vector3f> max_bounds_;
+    /// First triangle of every geometry.
+    std::vector<unsigned int> geometry_offsets_;
+    mutable AABBTree tree_;
+    mutable bool tree_updated_ = true;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
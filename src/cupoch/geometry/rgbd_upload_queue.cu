@@ -0,0 +1,112 @@
+#include <cstring>
+
+#include "cupoch/geometry/rgbd_upload_queue.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+bool IsPinned(const void *ptr) {
+    cudaPointerAttributes attributes;
+    if (cudaPointerGetAttributes(&attributes, ptr) != cudaSuccess) {
+        // Older runtimes fail on the pointers they do not know.
+        cudaGetLastError();
+        return false;
+    }
+    return attributes.type == cudaMemoryTypeHost;
+}
+
+/// Copies \p size bytes of \p src into \p dst on \p stream, staged in
+/// \p staging when \p src is pageable.
+void UploadAsync(uint8_t *dst,
+                 const void *src,
+                 size_t size,
+                 utility::pinned_host_vector<uint8_t> &staging,
+                 cudaEvent_t staging_free,
+                 cudaStream_t stream) {
+    if (!IsPinned(src)) {
+        // The previous upload of the buffer may still read the staging.
+        cudaSafeCall(cudaEventSynchronize(staging_free));
+        staging.resize(size);
+        std::memcpy(staging.data(), src, size);
+        src = staging.data();
+    }
+    cudaSafeCall(cudaMemcpyAsync(dst, src, size, cudaMemcpyHostToDevice,
+                                 stream));
+}
+
+}  // namespace
+
+RGBDUploadQueue::RGBDUploadQueue(int width,
+                                 int height,
+                                 int color_num_of_channels,
+                                 int color_bytes_per_channel,
+                                 int depth_bytes_per_channel,
+                                 size_t num_buffers)
+    : width_(width),
+      height_(height),
+      color_num_of_channels_(color_num_of_channels),
+      color_bytes_per_channel_(color_bytes_per_channel),
+      depth_bytes_per_channel_(depth_bytes_per_channel),
+      slots_(num_buffers) {
+    if (num_buffers < 2) {
+        utility::LogError("[RGBDUploadQueue] At least two buffers needed.");
+    }
+    cudaSafeCall(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+    for (auto &slot : slots_) {
+        slot.image_.color_.Prepare(width_, height_, color_num_of_channels_,
+                                   color_bytes_per_channel_);
+        slot.image_.depth_.Prepare(width_, height_, 1,
+                                   depth_bytes_per_channel_);
+        cudaSafeCall(cudaEventCreateWithFlags(&slot.uploaded_,
+                                              cudaEventDisableTiming));
+        cudaSafeCall(cudaEventCreateWithFlags(&slot.released_,
+                                              cudaEventDisableTiming));
+    }
+    // The buffers are initialized on the default stream.
+    cudaSafeCall(cudaDeviceSynchronize());
+}
+
+RGBDUploadQueue::~RGBDUploadQueue() {
+    cudaStreamSynchronize(stream_);
+    for (auto &slot : slots_) {
+        cudaEventDestroy(slot.uploaded_);
+        cudaEventDestroy(slot.released_);
+    }
+    cudaStreamDestroy(stream_);
+}
+
+bool RGBDUploadQueue::Push(const void *color, const void *depth) {
+    if (size_ == slots_.size()) return false;
+    const size_t index = (head_ + size_) % slots_.size();
+    if ((int)index == popped_) return false;
+    Slot &slot = slots_[index];
+    // The frame before in this buffer may still be read by the work
+    // queued on the default stream.
+    cudaSafeCall(cudaEventRecord(slot.released_, 0));
+    cudaSafeCall(cudaStreamWaitEvent(stream_, slot.released_, 0));
+    auto &color_image = slot.image_.color_;
+    auto &depth_image = slot.image_.depth_;
+    UploadAsync(thrust::raw_pointer_cast(color_image.data_.data()), color,
+                color_image.data_.size(), slot.color_staging_, slot.uploaded_,
+                stream_);
+    UploadAsync(thrust::raw_pointer_cast(depth_image.data_.data()), depth,
+                depth_image.data_.size(), slot.depth_staging_, slot.uploaded_,
+                stream_);
+    cudaSafeCall(cudaEventRecord(slot.uploaded_, stream_));
+    ++size_;
+    return true;
+}
+
+const RGBDImage *RGBDUploadQueue::Pop() {
+    if (size_ == 0) return nullptr;
+    Slot &slot = slots_[head_];
+    cudaSafeCall(cudaStreamWaitEvent(0, slot.uploaded_, 0));
+    popped_ = (int)head_;
+    head_ = (head_ + 1) % slots_.size();
+    --size_;
+    return &slot.image_;
+}
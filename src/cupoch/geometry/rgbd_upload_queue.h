@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include <vector>
+
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+/// \class RGBDUploadQueue
+///
+/// \brief Ring of device RGBDImages uploaded from sensor memory on a
+/// dedicated stream, so that the upload of a frame overlaps with the
+/// processing of the previous one.
+///
+/// Push() enqueues the copy of a frame and returns at once: the color and
+/// depth are copied straight from the sensor memory when it is pinned, and
+/// through pinned staging buffers of the queue otherwise. Pop() returns the
+/// oldest frame, with the raw pixels of the sensor, and makes the default
+/// stream wait for its upload without blocking the host, so the kernels
+/// launched on it afterwards see the new frame. A popped frame stays valid
+/// until the next Pop(); its buffer is then reused by a later Push(), after
+/// the work already queued on the default stream. With the default two
+/// buffers, frame k + 1 is uploaded while frame k is processed.
+class RGBDUploadQueue {
+public:
+    RGBDUploadQueue(int width,
+                    int height,
+                    int color_num_of_channels = 3,
+                    int color_bytes_per_channel = 1,
+                    int depth_bytes_per_channel = 2,
+                    size_t num_buffers = 2);
+    ~RGBDUploadQueue();
+    RGBDUploadQueue(const RGBDUploadQueue &) = delete;
+    RGBDUploadQueue &operator=(const RGBDUploadQueue &) = delete;
+
+    /// Enqueues the upload of a frame from \p color and \p depth, packed rows
+    /// in host memory of the format of the queue. Returns false, without
+    /// copying, when every buffer holds a frame not yet popped or the frame
+    /// popped last. Pinned memory must stay valid until the frame is
+    /// popped.
+    bool Push(const void *color, const void *depth);
+    /// Oldest pushed frame, or nullptr when the queue is empty.
+    const RGBDImage *Pop();
+
+    size_t GetNumBuffers() const { return slots_.size(); }
+    /// Number of frames pushed and not yet popped.
+    size_t GetSize() const { return size_; }
+
+private:
+    struct Slot {
+        RGBDImage image_;
+        utility::pinned_host_vector<uint8_t> color_staging_;
+        utility::pinned_host_vector<uint8_t> depth_staging_;
+        /// Recorded after the upload of the frame.
+        cudaEvent_t uploaded_ = nullptr;
+        /// Recorded on the default stream before the buffer is reused.
+        cudaEvent_t released_ = nullptr;
+    };
+
+    int width_;
+    int height_;
+    int color_num_of_channels_;
+    int color_bytes_per_channel_;
+    int depth_bytes_per_channel_;
+    cudaStream_t stream_;
+    std::vector<Slot> slots_;
+    /// Slot of the oldest pushed frame.
+    size_t head_ = 0;
+    size_t size_ = 0;
+    /// Slot of the frame popped last, in use by the caller.
+    int popped_ = -1;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
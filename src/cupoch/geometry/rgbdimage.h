@@ -42,6 +42,31 @@ public:
             float depth_trunc = 3.0,
             bool convert_rgb_to_intensity = true);
 
+    /// Registers \p depth, of 16 bit or float, to the color camera of
+    /// \p color_intrinsic, at its resolution. Each depth pixel is projected
+    /// with its footprint into the color image, and the nearest depth wins
+    /// on a z-buffer. The registered depths are the z of the color camera,
+    /// in the units of \p depth, \p depth_scale per meter, and zero where no
+    /// depth lands. The depth image must be undistorted.
+    static std::shared_ptr<Image> RegisterDepthToColor(
+            const Image &depth,
+            const camera::PinholeCameraIntrinsic &depth_intrinsic,
+            const camera::PinholeCameraIntrinsic &color_intrinsic,
+            const Eigen::Matrix4f &depth_to_color,
+            float depth_scale = 1000.0);
+
+    /// Same as CreateFromColorAndDepth on the depth registered to the color
+    /// camera by RegisterDepthToColor.
+    static std::shared_ptr<RGBDImage> CreateFromColorAndDepth(
+            const Image &color,
+            const Image &depth,
+            const camera::PinholeCameraIntrinsic &color_intrinsic,
+            const camera::PinholeCameraIntrinsic &depth_intrinsic,
+            const Eigen::Matrix4f &depth_to_color,
+            float depth_scale = 1000.0,
+            float depth_trunc = 3.0,
+            bool convert_rgb_to_intensity = true);
+
     /// Factory function to create an RGBD Image from Redwood dataset
     static std::shared_ptr<RGBDImage> CreateFromRedwoodFormat(
             const Image &color,
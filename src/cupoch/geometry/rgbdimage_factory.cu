@@ -1,3 +1,8 @@
+#include <thrust/transform.h>
+
+#include <type_traits>
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/geometry/rgbdimage.h"
 #include "cupoch/utility/console.h"
 
@@ -33,8 +38,179 @@ struct convert_nyu_format_functor {
     }
 };
 
+__device__ inline float ReadDepth(const float *depth, size_t idx) {
+    return depth[idx];
+}
+
+__device__ inline float ReadDepth(const uint16_t *depth, size_t idx) {
+    return depth[idx];
+}
+
+/// The positive floats compare as their bit patterns, so the z-buffer keeps
+/// the nearest depth with one atomicMin per covered pixel.
+template <typename T>
+struct register_depth_functor {
+    register_depth_functor(const T *depth,
+                           int depth_width,
+                           const Eigen::Matrix3f &depth_intrinsic,
+                           const Eigen::Matrix3f &color_intrinsic,
+                           int color_width,
+                           int color_height,
+                           const Eigen::Matrix4f &depth_to_color,
+                           float depth_scale_inv,
+                           unsigned int *zbuffer)
+        : depth_(depth),
+          depth_width_(depth_width),
+          fx_inv_(1.0f / depth_intrinsic(0, 0)),
+          fy_inv_(1.0f / depth_intrinsic(1, 1)),
+          cx_(depth_intrinsic(0, 2)),
+          cy_(depth_intrinsic(1, 2)),
+          color_intrinsic_(color_intrinsic),
+          color_width_(color_width),
+          color_height_(color_height),
+          rotation_(depth_to_color.block<3, 3>(0, 0)),
+          translation_(depth_to_color.block<3, 1>(0, 3)),
+          depth_scale_inv_(depth_scale_inv),
+          zbuffer_(zbuffer){};
+    const T *depth_;
+    const int depth_width_;
+    const float fx_inv_;
+    const float fy_inv_;
+    const float cx_;
+    const float cy_;
+    const Eigen::Matrix3f color_intrinsic_;
+    const int color_width_;
+    const int color_height_;
+    const Eigen::Matrix3f rotation_;
+    const Eigen::Vector3f translation_;
+    const float depth_scale_inv_;
+    unsigned int *zbuffer_;
+    /// Pixel of the color camera seeing the point of the depth pixel (u, v).
+    __device__ Eigen::Vector3f Project(float u, float v, float d) const {
+        const Eigen::Vector3f p((u - cx_) * fx_inv_ * d,
+                                (v - cy_) * fy_inv_ * d, d);
+        const Eigen::Vector3f q = rotation_ * p + translation_;
+        const Eigen::Vector3f uvz = color_intrinsic_ * q;
+        return Eigen::Vector3f(uvz[0] / q[2], uvz[1] / q[2], q[2]);
+    }
+    __device__ void operator()(size_t idx) const {
+        const float d = ReadDepth(depth_, idx) * depth_scale_inv_;
+        if (!(d > 0.0f) || isinf(d)) return;
+        const float u = idx % depth_width_;
+        const float v = idx / depth_width_;
+        const Eigen::Vector3f center = Project(u, v, d);
+        const Eigen::Vector3f lo = Project(u - 0.5f, v - 0.5f, d);
+        const Eigen::Vector3f hi = Project(u + 0.5f, v + 0.5f, d);
+        if (center[2] <= 0.0f || lo[2] <= 0.0f || hi[2] <= 0.0f) return;
+        // The pixel centers within the footprint, or the nearest one if
+        // the footprint is smaller than a color pixel, at most 8 x 8.
+        int u0 = ceilf(fminf(lo[0], hi[0]));
+        int u1 = ceilf(fmaxf(lo[0], hi[0])) - 1;
+        int v0 = ceilf(fminf(lo[1], hi[1]));
+        int v1 = ceilf(fmaxf(lo[1], hi[1])) - 1;
+        if (u1 < u0) u0 = u1 = floorf(center[0] + 0.5f);
+        if (v1 < v0) v0 = v1 = floorf(center[1] + 0.5f);
+        u1 = min(u1, u0 + 7);
+        v1 = min(v1, v0 + 7);
+        u0 = max(u0, 0);
+        v0 = max(v0, 0);
+        u1 = min(u1, color_width_ - 1);
+        v1 = min(v1, color_height_ - 1);
+        const unsigned int z = __float_as_uint(center[2]);
+        for (int y = v0; y <= v1; ++y) {
+            for (int x = u0; x <= u1; ++x) {
+                atomicMin(&zbuffer_[y * color_width_ + x], z);
+            }
+        }
+    }
+};
+
+template <typename T>
+struct write_registered_depth_functor {
+    write_registered_depth_functor(float depth_scale)
+        : depth_scale_(depth_scale){};
+    const float depth_scale_;
+    __device__ T operator()(unsigned int z) const {
+        if (z == ~0u) return T(0);
+        return T(__uint_as_float(z) * depth_scale_ +
+                 (std::is_integral<T>::value ? 0.5f : 0.0f));
+    }
+};
+
+template <typename T>
+void RegisterDepth(const Image &depth,
+                   const camera::PinholeCameraIntrinsic &depth_intrinsic,
+                   const camera::PinholeCameraIntrinsic &color_intrinsic,
+                   const Eigen::Matrix4f &depth_to_color,
+                   float depth_scale,
+                   Image &registered) {
+    utility::device_vector<unsigned int> zbuffer(
+            color_intrinsic.width_ * color_intrinsic.height_, ~0u);
+    register_depth_functor<T> func(
+            (const T *)thrust::raw_pointer_cast(depth.data_.data()),
+            depth.width_, depth_intrinsic.intrinsic_matrix_,
+            color_intrinsic.intrinsic_matrix_, color_intrinsic.width_,
+            color_intrinsic.height_, depth_to_color, 1.0f / depth_scale,
+            thrust::raw_pointer_cast(zbuffer.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(depth.width_ *
+                                                            depth.height_),
+                     func);
+    registered.Prepare(color_intrinsic.width_, color_intrinsic.height_, 1,
+                       sizeof(T));
+    T *registered_ptr = (T *)thrust::raw_pointer_cast(registered.data_.data());
+    thrust::transform(zbuffer.begin(), zbuffer.end(),
+                      thrust::device_pointer_cast(registered_ptr),
+                      write_registered_depth_functor<T>(depth_scale));
+}
+
 }  // namespace
 
+std::shared_ptr<Image> RGBDImage::RegisterDepthToColor(
+        const Image &depth,
+        const camera::PinholeCameraIntrinsic &depth_intrinsic,
+        const camera::PinholeCameraIntrinsic &color_intrinsic,
+        const Eigen::Matrix4f &depth_to_color,
+        float depth_scale) {
+    auto registered = std::make_shared<Image>();
+    if (depth.num_of_channels_ != 1 ||
+        (depth.bytes_per_channel_ != 2 && depth.bytes_per_channel_ != 4)) {
+        utility::LogError(
+                "[RegisterDepthToColor] Unsupported depth image format.");
+    }
+    if (depth.width_ != depth_intrinsic.width_ ||
+        depth.height_ != depth_intrinsic.height_ ||
+        !color_intrinsic.IsValid()) {
+        utility::LogError(
+                "[RegisterDepthToColor] The image sizes do not match the "
+                "intrinsics.");
+    }
+    if (depth.bytes_per_channel_ == 2) {
+        RegisterDepth<uint16_t>(depth, depth_intrinsic, color_intrinsic,
+                                depth_to_color, depth_scale, *registered);
+    } else {
+        RegisterDepth<float>(depth, depth_intrinsic, color_intrinsic,
+                             depth_to_color, depth_scale, *registered);
+    }
+    return registered;
+}
+
+std::shared_ptr<RGBDImage> RGBDImage::CreateFromColorAndDepth(
+        const Image &color,
+        const Image &depth,
+        const camera::PinholeCameraIntrinsic &color_intrinsic,
+        const camera::PinholeCameraIntrinsic &depth_intrinsic,
+        const Eigen::Matrix4f &depth_to_color,
+        float depth_scale /* = 1000.0*/,
+        float depth_trunc /* = 3.0*/,
+        bool convert_rgb_to_intensity /* = true*/) {
+    const auto registered = RegisterDepthToColor(
+            depth, depth_intrinsic, color_intrinsic, depth_to_color,
+            depth_scale);
+    return CreateFromColorAndDepth(color, *registered, depth_scale,
+                                   depth_trunc, convert_rgb_to_intensity);
+}
+
 std::shared_ptr<RGBDImage> RGBDImage::CreateFromColorAndDepth(
         const Image &color,
         const Image &depth,
@@ -0,0 +1,92 @@
+#include <thrust/iterator/counting_iterator.h>
+
+#include "cupoch/geometry/selection_mask.h"
+#include "cupoch/utility/console.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+// Mask of the valid bits of the last word.
+uint32_t TailMask(size_t size) {
+    const int n_bits = size % 32;
+    return (n_bits == 0) ? ~0u : (1u << n_bits) - 1u;
+}
+
+void CheckSameSize(const SelectionMask &a, const SelectionMask &b) {
+    if (a.size_ != b.size_) {
+        utility::LogError(
+                "[SelectionMask] The mask sizes {:d} and {:d} do not match.",
+                a.size_, b.size_);
+    }
+}
+
+}  // namespace
+
+SelectionMask::SelectionMask(size_t size, bool value)
+    : size_(size), words_(NumWords(size), value ? ~0u : 0u) {
+    if (value && !words_.empty()) words_.back() = TailMask(size);
+}
+
+SelectionMask::SelectionMask(const thrust::host_vector<bool> &mask)
+    : size_(mask.size()) {
+    thrust::host_vector<uint32_t> words(NumWords(size_), 0);
+    for (size_t i = 0; i < size_; ++i) {
+        if (mask[i]) words[i / 32] |= 1u << (i % 32);
+    }
+    words_ = words;
+}
+
+size_t SelectionMask::Count() const {
+    return thrust::transform_reduce(
+            words_.begin(), words_.end(),
+            [] __device__(uint32_t w) -> size_t { return __popc(w); },
+            size_t(0), thrust::plus<size_t>());
+}
+
+thrust::host_vector<bool> SelectionMask::GetMask() const {
+    const thrust::host_vector<uint32_t> words = words_;
+    thrust::host_vector<bool> mask(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        mask[i] = (words[i / 32] >> (i % 32)) & 1u;
+    }
+    return mask;
+}
+
+utility::device_vector<size_t> SelectionMask::GetIndices() const {
+    utility::device_vector<size_t> indices(size_);
+    const uint32_t *words = thrust::raw_pointer_cast(words_.data());
+    auto end = thrust::copy_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(size_), indices.begin(),
+            [words] __device__(size_t idx) {
+                return IsSelected(words, idx);
+            });
+    indices.resize(thrust::distance(indices.begin(), end));
+    return indices;
+}
+
+SelectionMask &SelectionMask::And(const SelectionMask &other) {
+    CheckSameSize(*this, other);
+    thrust::transform(words_.begin(), words_.end(), other.words_.begin(),
+                      words_.begin(), thrust::bit_and<uint32_t>());
+    return *this;
+}
+
+SelectionMask &SelectionMask::Or(const SelectionMask &other) {
+    CheckSameSize(*this, other);
+    thrust::transform(words_.begin(), words_.end(), other.words_.begin(),
+                      words_.begin(), thrust::bit_or<uint32_t>());
+    return *this;
+}
+
+SelectionMask &SelectionMask::Invert() {
+    thrust::transform(words_.begin(), words_.end(), words_.begin(),
+                      [] __device__(uint32_t w) { return ~w; });
+    if (!words_.empty()) {
+        const uint32_t last = words_.back();
+        words_.back() = last & TailMask(size_);
+    }
+    return *this;
+}
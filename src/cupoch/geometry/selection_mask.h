@@ -0,0 +1,82 @@
+#pragma once
+#include <thrust/host_vector.h>
+
+#include "cupoch/utility/device_vector.h"
+
+#ifdef __CUDACC__
+#include <thrust/iterator/counting_iterator.h>
+
+#include "cupoch/utility/platform.h"
+#endif
+
+namespace cupoch {
+namespace geometry {
+
+/// \class SelectionMask
+///
+/// \brief Selection of points packed with one bit per point.
+///
+/// The masks of several filters are combined with And() and Or() and
+/// applied with a single compaction, e.g. PointCloud::SelectByMask().
+class SelectionMask {
+public:
+    SelectionMask() = default;
+    /// Mask of \p size points, all set to \p value.
+    explicit SelectionMask(size_t size, bool value = true);
+    SelectionMask(const thrust::host_vector<bool> &mask);
+
+    size_t Size() const { return size_; }
+    /// Number of selected points.
+    size_t Count() const;
+    thrust::host_vector<bool> GetMask() const;
+    /// Indices of the selected points, in increasing order.
+    utility::device_vector<size_t> GetIndices() const;
+
+    SelectionMask &And(const SelectionMask &other);
+    SelectionMask &Or(const SelectionMask &other);
+    SelectionMask &Invert();
+
+    static size_t NumWords(size_t size) { return (size + 31) / 32; }
+
+#ifdef __CUDACC__
+    /// Mask of the indices [0, size) for which \p pred is true. Each thread
+    /// fills one word, so no atomics are needed.
+    template <typename Predicate>
+    static SelectionMask CreateFromPredicate(size_t size,
+                                             Predicate pred,
+                                             cudaStream_t stream = 0);
+#endif
+
+public:
+    size_t size_ = 0;
+    utility::device_vector<uint32_t> words_;
+};
+
+#ifdef __CUDACC__
+__host__ __device__ inline bool IsSelected(const uint32_t *words, size_t idx) {
+    return (words[idx >> 5] >> (idx & 31)) & 1u;
+}
+
+template <typename Predicate>
+SelectionMask SelectionMask::CreateFromPredicate(size_t size,
+                                                 Predicate pred,
+                                                 cudaStream_t stream) {
+    SelectionMask mask(size, false);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(NumWords(size)),
+                      mask.words_.begin(),
+                      [pred, size] __device__(size_t w) {
+                          uint32_t word = 0;
+                          for (int b = 0; b < 32; ++b) {
+                              const size_t idx = w * 32 + b;
+                              if (idx < size && pred(idx)) word |= 1u << b;
+                          }
+                          return word;
+                      });
+    return mask;
+}
+#endif
+
+}  // namespace geometry
+}  // namespace cupoch
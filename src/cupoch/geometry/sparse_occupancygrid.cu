@@ -0,0 +1,416 @@
+#include "cupoch/geometry/geometry_functor.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/sparse_occupancygrid.h"
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/device_hash_map.inl"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+namespace geometry {
+
+namespace {
+
+constexpr int kBlockResolution = SparseOccupancyGrid::kBlockResolution;
+constexpr int kBlockVoxels =
+        kBlockResolution * kBlockResolution * kBlockResolution;
+
+__host__ __device__ int FloorDiv(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+__host__ __device__ Eigen::Vector3i BlockOf(const Eigen::Vector3i &voxel) {
+    return Eigen::Vector3i(FloorDiv(voxel[0], kBlockResolution),
+                           FloorDiv(voxel[1], kBlockResolution),
+                           FloorDiv(voxel[2], kBlockResolution));
+}
+
+__device__ Eigen::Vector3i VoxelOf(const Eigen::Vector3f &point,
+                                   float voxel_size) {
+    const Eigen::Vector3f p = point / voxel_size;
+    return Eigen::Vector3i((int)floorf(p[0]), (int)floorf(p[1]),
+                           (int)floorf(p[2]));
+}
+
+// Read only view of the block table.
+struct block_table_view {
+    block_table_view(
+            const utility::device_hash_map<unsigned long long, int> &table)
+        : table_(table.view()){};
+    const utility::device_hash_map<unsigned long long, int>::view_type table_;
+
+    __device__ int FindBlock(const Eigen::Vector3i &block) const {
+        const int *b = table_.find(PackCellKey(block));
+        return (b) ? *b : -1;
+    }
+
+    /// Index of the voxel \p v in the pool, -1 if its block is not
+    /// allocated.
+    __device__ int FindVoxel(const Eigen::Vector3i &v) const {
+        const Eigen::Vector3i block = BlockOf(v);
+        const int b = FindBlock(block);
+        if (b < 0) return -1;
+        return b * kBlockVoxels +
+               IndexOf(v - block * kBlockResolution, kBlockResolution);
+    }
+};
+
+// Allocates the blocks crossed by the segment from the viewpoint to every
+// point, walking the grid of the blocks.
+struct allocate_ray_blocks_functor {
+    allocate_ray_blocks_functor(
+            const Eigen::Vector3f &viewpoint,
+            float block_length,
+            const utility::device_hash_map<unsigned long long, int> &table,
+            Eigen::Vector3i *block_coords,
+            int *block_counter,
+            int max_num_blocks)
+        : start_(viewpoint / block_length),
+          block_length_(block_length),
+          table_(table.view()),
+          block_coords_(block_coords),
+          block_counter_(block_counter),
+          max_num_blocks_(max_num_blocks){};
+    const Eigen::Vector3f start_;
+    const float block_length_;
+    const utility::device_hash_map<unsigned long long, int>::view_type table_;
+    Eigen::Vector3i *block_coords_;
+    int *block_counter_;
+    const int max_num_blocks_;
+
+    __device__ void Insert(const Eigen::Vector3i &block) {
+        const thrust::pair<int, bool> res =
+                table_.insert_slot(PackCellKey(block));
+        if (!res.second) return;
+        const int b = atomicAdd(block_counter_, 1);
+        if (b < max_num_blocks_) {
+            table_.values_[res.first] = b;
+            block_coords_[b] = block;
+        } else {
+            table_.values_[res.first] = -1;
+        }
+    }
+
+    __device__ void operator()(const Eigen::Vector3f &point) {
+        auto visit = [&](const Eigen::Vector3i &block) { Insert(block); };
+        WalkGridCells(start_, Eigen::Vector3f(point / block_length_), visit);
+    }
+};
+
+__device__ float UpdateLogOdds(float p,
+                               float delta,
+                               float thres_min,
+                               float thres_max) {
+    p = (isnan(p)) ? 0 : p;
+    return min(max(p + delta, thres_min), thres_max);
+}
+
+// Same stamps as OccupancyGrid::Insert(): the first point that stamps a
+// voxel with the hit stamp of the scan applies the hit.
+struct insert_hit_functor {
+    insert_hit_functor(const block_table_view &table,
+                       SparseOccupancyVoxel *voxels,
+                       float voxel_size,
+                       unsigned int hit_stamp,
+                       float clamping_thres_min,
+                       float clamping_thres_max,
+                       float prob_hit_log)
+        : table_(table),
+          voxels_(voxels),
+          voxel_size_(voxel_size),
+          hit_stamp_(hit_stamp),
+          clamping_thres_min_(clamping_thres_min),
+          clamping_thres_max_(clamping_thres_max),
+          prob_hit_log_(prob_hit_log){};
+    const block_table_view table_;
+    SparseOccupancyVoxel *voxels_;
+    const float voxel_size_;
+    const unsigned int hit_stamp_;
+    const float clamping_thres_min_;
+    const float clamping_thres_max_;
+    const float prob_hit_log_;
+    __device__ void operator()(const thrust::tuple<Eigen::Vector3f, bool> &x) {
+        if (!thrust::get<1>(x)) return;
+        const int idx = table_.FindVoxel(VoxelOf(thrust::get<0>(x), voxel_size_));
+        if (idx < 0) return;
+        if (atomicExch(&voxels_[idx].scan_stamp_, hit_stamp_) == hit_stamp_)
+            return;
+        voxels_[idx].prob_log_ =
+                UpdateLogOdds(voxels_[idx].prob_log_, prob_hit_log_,
+                              clamping_thres_min_, clamping_thres_max_);
+    }
+};
+
+struct insert_free_ray_functor {
+    insert_free_ray_functor(const block_table_view &table,
+                            SparseOccupancyVoxel *voxels,
+                            const Eigen::Vector3f &viewpoint,
+                            float voxel_size,
+                            unsigned int free_stamp,
+                            unsigned int hit_stamp,
+                            float clamping_thres_min,
+                            float clamping_thres_max,
+                            float prob_miss_log)
+        : table_(table),
+          voxels_(voxels),
+          start_(viewpoint / voxel_size),
+          voxel_size_(voxel_size),
+          free_stamp_(free_stamp),
+          hit_stamp_(hit_stamp),
+          clamping_thres_min_(clamping_thres_min),
+          clamping_thres_max_(clamping_thres_max),
+          prob_miss_log_(prob_miss_log){};
+    const block_table_view table_;
+    SparseOccupancyVoxel *voxels_;
+    const Eigen::Vector3f start_;
+    const float voxel_size_;
+    const unsigned int free_stamp_;
+    const unsigned int hit_stamp_;
+    const float clamping_thres_min_;
+    const float clamping_thres_max_;
+    const float prob_miss_log_;
+    __device__ void MarkFree(int idx) {
+        unsigned int *stamp_ptr = &voxels_[idx].scan_stamp_;
+        unsigned int stamp = *stamp_ptr;
+        while (stamp != free_stamp_ && stamp != hit_stamp_) {
+            const unsigned int old = atomicCAS(stamp_ptr, stamp, free_stamp_);
+            if (old == stamp) {
+                voxels_[idx].prob_log_ =
+                        UpdateLogOdds(voxels_[idx].prob_log_, prob_miss_log_,
+                                      clamping_thres_min_, clamping_thres_max_);
+                return;
+            }
+            stamp = old;
+        }
+    }
+    __device__ void operator()(const Eigen::Vector3f &point) {
+        // Consecutive voxels mostly share their block, so the block found
+        // last is tried before the table.
+        Eigen::Vector3i last_block = Eigen::Vector3i::Constant(INT_MIN);
+        int last_b = -1;
+        auto visit = [&](const Eigen::Vector3i &voxel) {
+            const Eigen::Vector3i block = BlockOf(voxel);
+            if (block != last_block) {
+                last_block = block;
+                last_b = table_.FindBlock(block);
+            }
+            if (last_b < 0) return;
+            MarkFree(last_b * kBlockVoxels +
+                     IndexOf(voxel - block * kBlockResolution,
+                             kBlockResolution));
+        };
+        WalkGridCells(start_, Eigen::Vector3f(point / voxel_size_), visit);
+    }
+};
+
+struct extract_voxels_functor {
+    extract_voxels_functor(const Eigen::Vector3i *block_coords,
+                           const SparseOccupancyVoxel *voxels,
+                           float occ_prob_thres_log,
+                           bool occupied)
+        : block_coords_(block_coords),
+          voxels_(voxels),
+          occ_prob_thres_log_(occ_prob_thres_log),
+          occupied_(occupied){};
+    const Eigen::Vector3i *block_coords_;
+    const SparseOccupancyVoxel *voxels_;
+    const float occ_prob_thres_log_;
+    const bool occupied_;
+    __device__ bool IsSelected(size_t idx) const {
+        const float p = voxels_[idx].prob_log_;
+        if (isnan(p)) return false;
+        return occupied_ ? p > occ_prob_thres_log_ : p <= occ_prob_thres_log_;
+    }
+    __device__ Voxel operator()(size_t idx) const {
+        const int b = idx / kBlockVoxels;
+        const int l = idx % kBlockVoxels;
+        const Eigen::Vector3i local(l / (kBlockResolution * kBlockResolution),
+                                    (l / kBlockResolution) % kBlockResolution,
+                                    l % kBlockResolution);
+        return Voxel(block_coords_[b] * kBlockResolution + local);
+    }
+};
+
+struct is_selected_voxel_functor {
+    is_selected_voxel_functor(const extract_voxels_functor &func)
+        : func_(func){};
+    const extract_voxels_functor func_;
+    __device__ bool operator()(size_t idx) const {
+        return func_.IsSelected(idx);
+    }
+};
+
+}  // namespace
+
+SparseOccupancyGrid::SparseOccupancyGrid(float voxel_size /* = 0.05*/,
+                                         int max_num_blocks /* = 65536*/)
+    : voxel_size_(voxel_size),
+      max_num_blocks_(max_num_blocks),
+      block_table_(max_num_blocks) {
+    block_coords_.resize(max_num_blocks_);
+    block_counter_.resize(1);
+    Clear();
+}
+
+SparseOccupancyGrid::~SparseOccupancyGrid() {}
+
+SparseOccupancyGrid::SparseOccupancyGrid(const SparseOccupancyGrid &other)
+    : voxel_size_(other.voxel_size_),
+      max_num_blocks_(other.max_num_blocks_),
+      clamping_thres_min_(other.clamping_thres_min_),
+      clamping_thres_max_(other.clamping_thres_max_),
+      prob_hit_log_(other.prob_hit_log_),
+      prob_miss_log_(other.prob_miss_log_),
+      occ_prob_thres_log_(other.occ_prob_thres_log_),
+      block_table_(other.block_table_),
+      block_coords_(other.block_coords_),
+      voxels_(other.voxels_),
+      block_counter_(other.block_counter_),
+      num_blocks_(other.num_blocks_),
+      scan_count_(other.scan_count_) {}
+
+SparseOccupancyGrid &SparseOccupancyGrid::Clear() {
+    block_table_.clear();
+    block_counter_[0] = 0;
+    num_blocks_ = 0;
+    scan_count_ = 0;
+    voxels_.clear();
+    return *this;
+}
+
+bool SparseOccupancyGrid::IsOccupied(const Eigen::Vector3f &point) const {
+    const auto res = GetProbLog(point);
+    return thrust::get<0>(res) && thrust::get<1>(res) > occ_prob_thres_log_;
+}
+
+bool SparseOccupancyGrid::IsUnknown(const Eigen::Vector3f &point) const {
+    return !thrust::get<0>(GetProbLog(point));
+}
+
+thrust::tuple<bool, float> SparseOccupancyGrid::GetProbLog(
+        const Eigen::Vector3f &point) const {
+    const Eigen::Vector3f p = point / voxel_size_;
+    const Eigen::Vector3i voxel((int)std::floor(p[0]), (int)std::floor(p[1]),
+                                (int)std::floor(p[2]));
+    const Eigen::Vector3i block = BlockOf(voxel);
+    const unsigned long long key = PackCellKey(block);
+    if (key == kEmptyCellKey || num_blocks_ == 0) {
+        return thrust::make_tuple(false, 0.0f);
+    }
+    const utility::device_vector<unsigned long long> keys(1, key);
+    const int b = block_table_.find(keys, -1)[0];
+    if (b < 0) return thrust::make_tuple(false, 0.0f);
+    const SparseOccupancyVoxel v =
+            voxels_[b * kBlockVoxels +
+                    IndexOf(voxel - block * kBlockResolution,
+                            kBlockResolution)];
+    return thrust::make_tuple(!std::isnan(v.prob_log_), v.prob_log_);
+}
+
+SparseOccupancyGrid &SparseOccupancyGrid::Insert(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const Eigen::Vector3f &viewpoint,
+        float max_range) {
+    if (points.empty()) return *this;
+
+    utility::device_vector<Eigen::Vector3f> ranged_points(points.size());
+    utility::device_vector<bool> hit_flags(points.size());
+    thrust::transform(points.begin(), points.end(),
+                      make_tuple_begin(ranged_points, hit_flags),
+                      [viewpoint, max_range] __device__ (const Eigen::Vector3f &pt) {
+                          Eigen::Vector3f pt_vp = pt - viewpoint;
+                          float dist = pt_vp.norm();
+                          bool is_hit = max_range < 0 || dist <= max_range;
+                          return thrust::make_tuple((is_hit) ? pt : viewpoint + pt_vp / dist * max_range,
+                                                    is_hit);
+                      });
+
+    // Allocate the blocks crossed by the rays.
+    allocate_ray_blocks_functor alloc_func(
+            viewpoint, voxel_size_ * kBlockResolution,
+            block_table_, thrust::raw_pointer_cast(block_coords_.data()),
+            thrust::raw_pointer_cast(block_counter_.data()), max_num_blocks_);
+    thrust::for_each(ranged_points.begin(), ranged_points.end(), alloc_func);
+    const int n_requested = block_counter_[0];
+    if (n_requested > max_num_blocks_) {
+        utility::LogWarning(
+                "[SparseOccupancyGrid::Insert] {:d} blocks requested, only "
+                "{:d} are allocated.",
+                n_requested, max_num_blocks_);
+    }
+    num_blocks_ = std::min(n_requested, max_num_blocks_);
+    voxels_.resize((size_t)num_blocks_ * kBlockVoxels);
+
+    // The stamps of a scan are above those of all the previous ones.
+    if (scan_count_ >= (~0u >> 1)) {
+        thrust::fill(voxels_.begin(), voxels_.end(), SparseOccupancyVoxel());
+        utility::LogWarning(
+                "[SparseOccupancyGrid::Insert] Scan counter wrapped around, "
+                "the map is cleared.");
+        scan_count_ = 0;
+    }
+    ++scan_count_;
+    const unsigned int free_stamp = 2 * scan_count_;
+    const unsigned int hit_stamp = 2 * scan_count_ + 1;
+    block_table_view table(block_table_);
+    insert_hit_functor hit_func(table, thrust::raw_pointer_cast(voxels_.data()),
+                                voxel_size_, hit_stamp, clamping_thres_min_,
+                                clamping_thres_max_, prob_hit_log_);
+    thrust::for_each(make_tuple_begin(ranged_points, hit_flags),
+                     make_tuple_end(ranged_points, hit_flags), hit_func);
+    insert_free_ray_functor ray_func(
+            table, thrust::raw_pointer_cast(voxels_.data()), viewpoint,
+            voxel_size_, free_stamp, hit_stamp, clamping_thres_min_,
+            clamping_thres_max_, prob_miss_log_);
+    thrust::for_each(ranged_points.begin(), ranged_points.end(), ray_func);
+    return *this;
+}
+
+SparseOccupancyGrid &SparseOccupancyGrid::Insert(
+        const thrust::host_vector<Eigen::Vector3f> &points,
+        const Eigen::Vector3f &viewpoint,
+        float max_range) {
+    utility::device_vector<Eigen::Vector3f> dev_points = points;
+    return Insert(dev_points, viewpoint, max_range);
+}
+
+SparseOccupancyGrid &SparseOccupancyGrid::Insert(
+        const PointCloud &pointcloud,
+        const Eigen::Vector3f &viewpoint,
+        float max_range) {
+    return Insert(pointcloud.points_, viewpoint, max_range);
+}
+
+std::shared_ptr<VoxelGrid> SparseOccupancyGrid::ExtractOccupiedVoxels() const {
+    return ExtractVoxels(true);
+}
+
+std::shared_ptr<VoxelGrid> SparseOccupancyGrid::ExtractFreeVoxels() const {
+    return ExtractVoxels(false);
+}
+
+std::shared_ptr<VoxelGrid> SparseOccupancyGrid::ExtractVoxels(
+        bool occupied) const {
+    auto voxel_grid = std::make_shared<VoxelGrid>();
+    voxel_grid->voxel_size_ = voxel_size_;
+    voxel_grid->origin_ = Eigen::Vector3f::Zero();
+    extract_voxels_functor func(thrust::raw_pointer_cast(block_coords_.data()),
+                                thrust::raw_pointer_cast(voxels_.data()),
+                                occ_prob_thres_log_, occupied);
+    const size_t n_voxels = thrust::count_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(voxels_.size()),
+            is_selected_voxel_functor(func));
+    utility::device_vector<size_t> indices(n_voxels);
+    thrust::copy_if(thrust::make_counting_iterator<size_t>(0),
+                    thrust::make_counting_iterator(voxels_.size()),
+                    indices.begin(), is_selected_voxel_functor(func));
+    utility::device_vector<Voxel> voxels(n_voxels);
+    thrust::transform(indices.begin(), indices.end(), voxels.begin(), func);
+    voxel_grid->AddVoxels(voxels);
+    return voxel_grid;
+}
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <thrust/host_vector.h>
+#include <thrust/tuple.h>
+
+#include <Eigen/Core>
+#include <limits>
+#include <memory>
+
+#include "cupoch/utility/device_hash_map.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+class VoxelGrid;
+
+/// Voxel of SparseOccupancyGrid. The grid index is implied by the position
+/// in the block pool, so it is not stored.
+class SparseOccupancyVoxel {
+public:
+    __host__ __device__ SparseOccupancyVoxel() {}
+    __host__ __device__ ~SparseOccupancyVoxel() {}
+
+public:
+    float prob_log_ = std::numeric_limits<float>::quiet_NaN();
+    /// Last scan that updated the voxel, see SparseOccupancyGrid::Insert().
+    unsigned int scan_stamp_ = 0;
+};
+
+/// \class SparseOccupancyGrid
+///
+/// \brief Occupancy map made of blocks of kBlockResolution^3 voxels
+/// allocated on demand.
+///
+/// The blocks are kept in an open addressing hash table on the device,
+/// keyed by their integer coordinates, and their voxels in one pool. Insert()
+/// first allocates the blocks crossed by the rays, so the memory grows with
+/// the observed space instead of with a bounding box fixed in advance, up to
+/// max_num_blocks_ blocks. The voxel of a point p is floor(p / voxel_size_),
+/// within [-2^20, 2^20) blocks along each axis.
+class SparseOccupancyGrid {
+public:
+    static constexpr int kBlockResolution = 8;
+
+    SparseOccupancyGrid(float voxel_size = 0.05, int max_num_blocks = 65536);
+    ~SparseOccupancyGrid();
+    SparseOccupancyGrid(const SparseOccupancyGrid &other);
+
+public:
+    SparseOccupancyGrid &Clear();
+    bool IsEmpty() const { return num_blocks_ == 0; }
+
+    bool IsOccupied(const Eigen::Vector3f &point) const;
+    bool IsUnknown(const Eigen::Vector3f &point) const;
+    /// Whether the voxel of \p point is known, and its log odds.
+    thrust::tuple<bool, float> GetProbLog(const Eigen::Vector3f &point) const;
+
+    /// Same update as OccupancyGrid::Insert(): the voxel of every point gets
+    /// one hit, and the voxels crossed by the rays from \p viewpoint get one
+    /// miss per scan.
+    SparseOccupancyGrid &Insert(
+            const utility::device_vector<Eigen::Vector3f> &points,
+            const Eigen::Vector3f &viewpoint,
+            float max_range = -1.0);
+    SparseOccupancyGrid &Insert(
+            const thrust::host_vector<Eigen::Vector3f> &points,
+            const Eigen::Vector3f &viewpoint,
+            float max_range = -1.0);
+    SparseOccupancyGrid &Insert(const PointCloud &pointcloud,
+                                const Eigen::Vector3f &viewpoint,
+                                float max_range = -1.0);
+
+    /// Voxels above occ_prob_thres_log_ as a VoxelGrid of the same voxel
+    /// size, e.g. for the visualization or the collision checks.
+    std::shared_ptr<VoxelGrid> ExtractOccupiedVoxels() const;
+    /// Known voxels at or below occ_prob_thres_log_.
+    std::shared_ptr<VoxelGrid> ExtractFreeVoxels() const;
+
+    /// Number of allocated blocks.
+    int GetNumBlocks() const { return num_blocks_; }
+
+public:
+    float voxel_size_;
+    int max_num_blocks_;
+    float clamping_thres_min_ = -2.0;
+    float clamping_thres_max_ = 3.5;
+    float prob_hit_log_ = 0.85;
+    float prob_miss_log_ = -0.4;
+    float occ_prob_thres_log_ = 0.0;
+    /// Block of each packed block key, -1 for the keys whose block could
+    /// not be allocated.
+    utility::device_hash_map<unsigned long long, int> block_table_;
+    /// Coordinates of the allocated blocks, in units of the block length.
+    utility::device_vector<Eigen::Vector3i> block_coords_;
+    /// kBlockResolution^3 voxels per allocated block, in the order of
+    /// block_coords_.
+    utility::device_vector<SparseOccupancyVoxel> voxels_;
+
+private:
+    std::shared_ptr<VoxelGrid> ExtractVoxels(bool occupied) const;
+
+    utility::device_vector<int> block_counter_;
+    int num_blocks_ = 0;
+    unsigned int scan_count_ = 0;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
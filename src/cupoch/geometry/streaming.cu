@@ -0,0 +1,295 @@
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/merge.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/streaming.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+constexpr MortonCode kInvalidVoxelCode = ~0ull;
+
+struct compute_voxel_sum_functor {
+    compute_voxel_sum_functor(const Eigen::Vector3f *points,
+                              const Eigen::Vector3f *normals,
+                              const Eigen::Vector3f *colors,
+                              const Eigen::Vector3f &origin,
+                              float voxel_size)
+        : points_(points),
+          normals_(normals),
+          colors_(colors),
+          origin_(origin),
+          voxel_size_(voxel_size){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3f *normals_;
+    const Eigen::Vector3f *colors_;
+    const Eigen::Vector3f origin_;
+    const float voxel_size_;
+    __device__ thrust::tuple<MortonCode, VoxelSum> operator()(
+            size_t idx) const {
+        const Eigen::Vector3f ref_coord = (points_[idx] - origin_) / voxel_size_;
+        const Eigen::Vector3i key(int(floor(ref_coord(0))),
+                                  int(floor(ref_coord(1))),
+                                  int(floor(ref_coord(2))));
+        VoxelSum sum;
+        sum.count_ = 1;
+        sum.point_ = points_[idx];
+        sum.normal_ = (normals_) ? normals_[idx] : Eigen::Vector3f::Zero();
+        sum.color_ = (colors_) ? colors_[idx] : Eigen::Vector3f::Zero();
+        return thrust::make_tuple(
+                IsMortonEncodable(key) ? EncodeMorton(key) : kInvalidVoxelCode,
+                sum);
+    }
+};
+
+struct add_voxel_sum_functor {
+    __device__ VoxelSum operator()(const VoxelSum &x, const VoxelSum &y) const {
+        VoxelSum ans;
+        ans.count_ = x.count_ + y.count_;
+        ans.point_ = x.point_ + y.point_;
+        ans.normal_ = x.normal_ + y.normal_;
+        ans.color_ = x.color_ + y.color_;
+        return ans;
+    }
+};
+
+struct is_invalid_voxel_functor {
+    __device__ bool operator()(
+            const thrust::tuple<MortonCode, VoxelSum> &x) const {
+        return thrust::get<0>(x) == kInvalidVoxelCode;
+    }
+};
+
+struct average_voxel_sum_functor {
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector3f>
+    operator()(const VoxelSum &sum) const {
+        return thrust::make_tuple(sum.point_ / sum.count_,
+                                  sum.normal_.normalized(),
+                                  sum.color_ / sum.count_);
+    }
+};
+
+struct average_distance_functor {
+    average_distance_functor(const float *distance, int knn)
+        : distance_(distance), knn_(knn){};
+    const float *distance_;
+    const int knn_;
+    __device__ float operator()(size_t idx) const {
+        int count = 0;
+        float avg = 0;
+        for (int i = 0; i < knn_; ++i) {
+            const float d = distance_[idx * knn_ + i];
+            if (isinf(d) || d < 0.0) continue;
+            avg += d;
+            count++;
+        }
+        return (count == 0) ? -1.0 : avg / (float)count;
+    }
+};
+
+struct distance_moments_functor {
+    __device__ thrust::tuple<int, int, double, double> operator()(
+            float x) const {
+        return (x > 0) ? thrust::make_tuple(1, 1, double(x), double(x) * x)
+                       : thrust::make_tuple((x >= 0) ? 1 : 0, 0, 0.0, 0.0);
+    }
+};
+
+struct check_distance_threshold_functor {
+    check_distance_threshold_functor(const float *distances,
+                                     float distance_threshold)
+        : distances_(distances), distance_threshold_(distance_threshold){};
+    const float *distances_;
+    const float distance_threshold_;
+    __device__ bool operator()(size_t idx) const {
+        return (distances_[idx] > 0 && distances_[idx] < distance_threshold_);
+    }
+};
+
+}  // namespace
+
+StreamingVoxelDownSampler::StreamingVoxelDownSampler(
+        float voxel_size, const Eigen::Vector3f &origin)
+    : voxel_size_(voxel_size), origin_(origin) {
+    if (voxel_size <= 0.0) {
+        utility::LogError("[StreamingVoxelDownSampler] voxel_size <= 0.");
+    }
+}
+
+StreamingVoxelDownSampler::~StreamingVoxelDownSampler() {}
+
+void StreamingVoxelDownSampler::Clear() {
+    has_normals_ = false;
+    has_colors_ = false;
+    codes_.clear();
+    sums_.clear();
+}
+
+void StreamingVoxelDownSampler::AddChunk(const PointCloud &chunk) {
+    if (!chunk.HasPoints()) return;
+    if (codes_.empty()) {
+        has_normals_ = chunk.HasNormals();
+        has_colors_ = chunk.HasColors();
+    } else if (has_normals_ != chunk.HasNormals() ||
+               has_colors_ != chunk.HasColors()) {
+        utility::LogWarning(
+                "[StreamingVoxelDownSampler] The chunks have different "
+                "channels.\n");
+    }
+    const size_t n = chunk.points_.size();
+    utility::device_vector<MortonCode> codes(n);
+    utility::device_vector<VoxelSum> sums(n);
+    compute_voxel_sum_functor func(
+            thrust::raw_pointer_cast(chunk.points_.data()),
+            has_normals_ && chunk.HasNormals()
+                    ? thrust::raw_pointer_cast(chunk.normals_.data())
+                    : nullptr,
+            has_colors_ && chunk.HasColors()
+                    ? thrust::raw_pointer_cast(chunk.colors_.data())
+                    : nullptr,
+            origin_, voxel_size_);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n),
+                      make_tuple_begin(codes, sums), func);
+    remove_if_vectors(is_invalid_voxel_functor(), codes, sums);
+    if (codes.size() < n) {
+        utility::LogWarning(
+                "[StreamingVoxelDownSampler] {:d} points are out of the voxel "
+                "grid range.\n",
+                int(n - codes.size()));
+    }
+
+    // Reduce the chunk to its voxels and merge them with the sorted voxels
+    // of the previous chunks.
+    thrust::sort_by_key(codes.begin(), codes.end(), sums.begin());
+    utility::device_vector<MortonCode> merged_codes(codes_.size() +
+                                                    codes.size());
+    utility::device_vector<VoxelSum> merged_sums(merged_codes.size());
+    thrust::merge_by_key(codes_.begin(), codes_.end(), codes.begin(),
+                         codes.end(), sums_.begin(), sums.begin(),
+                         merged_codes.begin(), merged_sums.begin());
+    codes_.resize(merged_codes.size());
+    sums_.resize(merged_codes.size());
+    auto end = thrust::reduce_by_key(
+            merged_codes.begin(), merged_codes.end(), merged_sums.begin(),
+            codes_.begin(), sums_.begin(), thrust::equal_to<MortonCode>(),
+            add_voxel_sum_functor());
+    resize_all(thrust::distance(codes_.begin(), end.first), codes_, sums_);
+}
+
+std::shared_ptr<PointCloud> StreamingVoxelDownSampler::GetPointCloud() const {
+    auto output = std::make_shared<PointCloud>();
+    const size_t n = sums_.size();
+    utility::device_vector<Eigen::Vector3f> normals(n);
+    utility::device_vector<Eigen::Vector3f> colors(n);
+    output->points_.resize(n);
+    thrust::transform(sums_.begin(), sums_.end(),
+                      make_tuple_begin(output->points_, normals, colors),
+                      average_voxel_sum_functor());
+    if (has_normals_) output->normals_.swap(normals);
+    if (has_colors_) output->colors_.swap(colors);
+    return output;
+}
+
+StreamingStatisticalOutlierRemoval::StreamingStatisticalOutlierRemoval(
+        size_t nb_neighbors, float std_ratio)
+    : nb_neighbors_(nb_neighbors), std_ratio_(std_ratio) {
+    if (nb_neighbors < 1 || std_ratio <= 0) {
+        utility::LogError(
+                "[StreamingStatisticalOutlierRemoval] Illegal input "
+                "parameters, number of neighbors and standard deviation "
+                "ratio must be positive");
+    }
+}
+
+StreamingStatisticalOutlierRemoval::~StreamingStatisticalOutlierRemoval() {}
+
+void StreamingStatisticalOutlierRemoval::Clear() {
+    n_valid_ = 0;
+    n_positive_ = 0;
+    sum_ = 0.0;
+    sq_sum_ = 0.0;
+}
+
+utility::device_vector<float>
+StreamingStatisticalOutlierRemoval::ComputeAverageDistances(
+        const PointCloud &tile, const PointCloud &halo) const {
+    utility::device_vector<Eigen::Vector3f> points(tile.points_.size() +
+                                                   halo.points_.size());
+    thrust::copy(tile.points_.begin(), tile.points_.end(), points.begin());
+    thrust::copy(halo.points_.begin(), halo.points_.end(),
+                 points.begin() + tile.points_.size());
+    KDTreeFlann kdtree;
+    kdtree.SetRawData(points);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> dist;
+    kdtree.SearchKNN(tile.points_, int(nb_neighbors_), indices, dist);
+    utility::device_vector<float> avg_distances(tile.points_.size());
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(tile.points_.size()),
+                      avg_distances.begin(),
+                      average_distance_functor(
+                              thrust::raw_pointer_cast(dist.data()),
+                              nb_neighbors_));
+    return avg_distances;
+}
+
+void StreamingStatisticalOutlierRemoval::AccumulateTile(
+        const PointCloud &tile, const PointCloud &halo) {
+    if (!tile.HasPoints()) return;
+    const utility::device_vector<float> avg_distances =
+            ComputeAverageDistances(tile, halo);
+    const auto moments = thrust::transform_reduce(
+            avg_distances.begin(), avg_distances.end(),
+            distance_moments_functor(), thrust::make_tuple(0, 0, 0.0, 0.0),
+            add_tuple_functor<int, int, double, double>());
+    n_valid_ += thrust::get<0>(moments);
+    n_positive_ += thrust::get<1>(moments);
+    sum_ += thrust::get<2>(moments);
+    sq_sum_ += thrust::get<3>(moments);
+}
+
+void StreamingStatisticalOutlierRemoval::Merge(
+        const StreamingStatisticalOutlierRemoval &other) {
+    n_valid_ += other.n_valid_;
+    n_positive_ += other.n_positive_;
+    sum_ += other.sum_;
+    sq_sum_ += other.sq_sum_;
+}
+
+float StreamingStatisticalOutlierRemoval::GetDistanceThreshold() const {
+    if (n_valid_ < 2) return 0.0;
+    // Same statistics as PointCloud::RemoveStatisticalOutliers, from the
+    // moments of the positive distances.
+    const double mean = sum_ / n_valid_;
+    const double sq_sum =
+            sq_sum_ - 2.0 * mean * sum_ + n_positive_ * mean * mean;
+    const double std_dev = std::sqrt(std::max(sq_sum, 0.0) / (n_valid_ - 1));
+    return float(mean + std_ratio_ * std_dev);
+}
+
+utility::device_vector<size_t> StreamingStatisticalOutlierRemoval::FilterTile(
+        const PointCloud &tile, const PointCloud &halo) const {
+    utility::device_vector<size_t> indices;
+    if (!tile.HasPoints()) return indices;
+    const utility::device_vector<float> avg_distances =
+            ComputeAverageDistances(tile, halo);
+    indices.resize(tile.points_.size());
+    check_distance_threshold_functor func(
+            thrust::raw_pointer_cast(avg_distances.data()),
+            GetDistanceThreshold());
+    auto end = thrust::copy_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(tile.points_.size()),
+            indices.begin(), func);
+    indices.resize(thrust::distance(indices.begin(), end));
+    return indices;
+}
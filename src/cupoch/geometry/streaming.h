@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+
+/// Running sums of the points falling into one voxel.
+struct VoxelSum {
+    int count_;
+    Eigen::Vector3f point_;
+    Eigen::Vector3f normal_;
+    Eigen::Vector3f color_;
+};
+
+/// \class StreamingVoxelDownSampler
+///
+/// \brief VoxelDownSample over a point cloud given as a sequence of chunks,
+/// e.g. the chunks of io::PointCloudStreamReader.
+///
+/// The voxels are defined on a fixed grid anchored at \p origin, so a voxel
+/// that is cut by a chunk border gets the sum of all its points and the
+/// result is the same as down sampling the whole cloud at once. Only the
+/// per-voxel sums are kept on the device. The grid covers 2^20 voxels on
+/// every side of the origin, the points outside are dropped.
+class StreamingVoxelDownSampler {
+public:
+    explicit StreamingVoxelDownSampler(
+            float voxel_size,
+            const Eigen::Vector3f &origin = Eigen::Vector3f::Zero());
+    ~StreamingVoxelDownSampler();
+
+public:
+    void Clear();
+    void AddChunk(const PointCloud &chunk);
+    /// Averages of the voxels accumulated so far, in Morton order.
+    std::shared_ptr<PointCloud> GetPointCloud() const;
+    size_t GetNumVoxels() const { return codes_.size(); }
+
+private:
+    float voxel_size_;
+    Eigen::Vector3f origin_;
+    bool has_normals_ = false;
+    bool has_colors_ = false;
+    utility::device_vector<MortonCode> codes_;
+    utility::device_vector<VoxelSum> sums_;
+};
+
+/// \class StreamingStatisticalOutlierRemoval
+///
+/// \brief RemoveStatisticalOutliers over a point cloud split into spatial
+/// tiles.
+///
+/// Every tile is given with a halo, the points of the neighboring tiles
+/// within the neighborhood size of the tile border. The halo points are
+/// only used as neighbors, so the mean neighbor distances of the points at
+/// the tile borders are the ones of the whole cloud. The statistics of the
+/// whole cloud are accumulated over a first pass on all the tiles in
+/// AccumulateTile, then FilterTile selects the inliers of each tile in a
+/// second pass.
+class StreamingStatisticalOutlierRemoval {
+public:
+    StreamingStatisticalOutlierRemoval(size_t nb_neighbors, float std_ratio);
+    ~StreamingStatisticalOutlierRemoval();
+
+public:
+    void Clear();
+    void AccumulateTile(const PointCloud &tile, const PointCloud &halo);
+    /// Adds the statistics accumulated by \p other, e.g. over the tiles of
+    /// another device.
+    void Merge(const StreamingStatisticalOutlierRemoval &other);
+    /// Returns the indices of the inliers of \p tile.
+    utility::device_vector<size_t> FilterTile(const PointCloud &tile,
+                                              const PointCloud &halo) const;
+    float GetDistanceThreshold() const;
+
+private:
+    utility::device_vector<float> ComputeAverageDistances(
+            const PointCloud &tile, const PointCloud &halo) const;
+
+    size_t nb_neighbors_;
+    float std_ratio_;
+    size_t n_valid_ = 0;
+    size_t n_positive_ = 0;
+    double sum_ = 0.0;
+    double sq_sum_ = 0.0;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -1,15 +1,20 @@
-#include <thrust/iterator/discard_iterator.h>
+#include <thrust/binary_search.h>
 #include <thrust/random/linear_congruential_engine.h>
 #include <thrust/random/uniform_real_distribution.h>
 #include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/sequence.h>
 
+#include "cupoch/geometry/aabb_tree.h"
 #include "cupoch/geometry/intersection_test.h"
 #include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/geometry_functor.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/device_hash_map.inl"
 #include "cupoch/utility/helper.h"
-#include "cupoch/utility/range.h"
+#include "cupoch/utility/union_find.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -48,25 +53,135 @@ struct compute_edge_list_functor {
     }
 };
 
-struct compute_old_to_new_index_functor {
-    compute_old_to_new_index_functor(const int* idx_offsets,
-                                     const int* index_new_to_old,
-                                     int* index_old_to_new)
-     : idx_offsets_(idx_offsets),
-       index_new_to_old_(index_new_to_old),
-       index_old_to_new_(index_old_to_new) {};
-    const int* idx_offsets_;
-    const int* index_new_to_old_;
-    int* index_old_to_new_;
-    __device__ void operator() (size_t idx) {
-        int si = idx_offsets_[idx];
-        int ei = idx_offsets_[idx + 1];
-        for (int i = si; i < ei; ++i) {
-            index_old_to_new_[index_new_to_old_[i]] = idx;
+struct corner_triangle_functor {
+    __device__ int operator() (int idx) const { return idx / 3; }
+};
+
+/// Sum of the normals of the triangles of every vertex, gathered over its
+/// row of the vertex to triangle adjacency.
+struct sum_triangle_normals_functor {
+    sum_triangle_normals_functor(const int *offsets, const int *triangles,
+                                 const Eigen::Vector3f *triangle_normals)
+                                 : offsets_(offsets), triangles_(triangles),
+                                 triangle_normals_(triangle_normals) {};
+    const int *offsets_;
+    const int *triangles_;
+    const Eigen::Vector3f *triangle_normals_;
+    __device__ Eigen::Vector3f operator() (size_t idx) const {
+        Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+        for (int k = offsets_[idx]; k < offsets_[idx + 1]; ++k) {
+            sum += triangle_normals_[triangles_[k]];
+        }
+        return sum;
+    }
+};
+
+/// Hashes and equalities of the vertices and the aligned triangles. The
+/// vertices compare by the bits hashed, -0 being normalized to 0, so that a
+/// NaN vertex equals its copies instead of no vertex at all.
+struct hash_vertex_functor {
+    __device__ unsigned int operator() (const Eigen::Vector3f& v) const {
+        const Eigen::Vector3f u = v + Eigen::Vector3f::Zero();
+        const unsigned long long h = ((unsigned long long)__float_as_uint(u[0]) << 32) ^
+                                     ((unsigned long long)__float_as_uint(u[1]) << 16) ^
+                                     (unsigned long long)__float_as_uint(u[2]);
+        return HashCellKey(h);
+    }
+    __device__ bool Equal(const Eigen::Vector3f& a, const Eigen::Vector3f& b) const {
+        const Eigen::Vector3f u = a + Eigen::Vector3f::Zero();
+        const Eigen::Vector3f w = b + Eigen::Vector3f::Zero();
+        return __float_as_uint(u[0]) == __float_as_uint(w[0]) &&
+               __float_as_uint(u[1]) == __float_as_uint(w[1]) &&
+               __float_as_uint(u[2]) == __float_as_uint(w[2]);
+    }
+};
+
+struct hash_triangle_functor {
+    __device__ unsigned int operator() (const Eigen::Vector3i& t) const {
+        const unsigned long long h = ((unsigned long long)(unsigned int)t[0] << 42) ^
+                                     ((unsigned long long)(unsigned int)t[1] << 21) ^
+                                     (unsigned long long)(unsigned int)t[2];
+        return HashCellKey(h);
+    }
+    __device__ bool Equal(const Eigen::Vector3i& a, const Eigen::Vector3i& b) const {
+        return a == b;
+    }
+};
+
+/// Inserts the element indices in an open addressing hash table of the
+/// elements, the slot of equal elements keeping the smallest index.
+template <class T, class Hash>
+struct insert_first_occurrence_functor {
+    insert_first_occurrence_functor(const T* elements, int* table, unsigned int mask)
+    : elements_(elements), table_(table), mask_(mask) {};
+    const T* elements_;
+    int* table_;
+    const unsigned int mask_;
+    __device__ void operator() (int idx) const {
+        const T& e = elements_[idx];
+        unsigned int slot = Hash()(e) & mask_;
+        while (true) {
+            const int prev = atomicCAS(&table_[slot], -1, idx);
+            if (prev == -1) return;
+            if (Hash().Equal(elements_[prev], e)) {
+                atomicMin(&table_[slot], idx);
+                return;
+            }
+            slot = (slot + 1) & mask_;
         }
     }
 };
 
+template <class T, class Hash>
+struct find_first_occurrence_functor {
+    find_first_occurrence_functor(const T* elements, const int* table, unsigned int mask)
+    : elements_(elements), table_(table), mask_(mask) {};
+    const T* elements_;
+    const int* table_;
+    const unsigned int mask_;
+    __device__ int operator() (int idx) const {
+        const T& e = elements_[idx];
+        unsigned int slot = Hash()(e) & mask_;
+        while (true) {
+            const int j = table_[slot];
+            // Every element was inserted, so an empty slot is not reached
+            // unless the equality disagrees with the hash.
+            if (j == -1) return idx;
+            if (Hash().Equal(elements_[j], e)) return j;
+            slot = (slot + 1) & mask_;
+        }
+    }
+};
+
+/// Index of the first element equal to every element, through a hash
+/// table of twice the number of elements, so the elements are neither
+/// sorted nor moved.
+template <class T, class Hash>
+utility::device_vector<int> FirstOccurrences(const utility::device_vector<T>& elements) {
+    const size_t n = elements.size();
+    size_t table_size = 1;
+    while (table_size < 2 * n) table_size <<= 1;
+    utility::device_vector<int> table(table_size, -1);
+    const unsigned int mask = table_size - 1;
+    const T* elements_ptr = thrust::raw_pointer_cast(elements.data());
+    insert_first_occurrence_functor<T, Hash> insert_func(elements_ptr,
+                                                         thrust::raw_pointer_cast(table.data()), mask);
+    thrust::for_each(thrust::make_counting_iterator<int>(0),
+                     thrust::make_counting_iterator<int>(n), insert_func);
+    utility::device_vector<int> firsts(n);
+    find_first_occurrence_functor<T, Hash> find_func(elements_ptr,
+                                                     thrust::raw_pointer_cast(table.data()), mask);
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(n), firsts.begin(), find_func);
+    return firsts;
+}
+
+struct is_first_occurrence_functor {
+    __device__ int operator() (const thrust::tuple<int, int>& x) const {
+        return (thrust::get<0>(x) == thrust::get<1>(x)) ? 1 : 0;
+    }
+};
+
 struct align_triangle_functor {
     __device__ Eigen::Vector3i operator() (const Eigen::Vector3i& tri) const {
         if (tri(0) <= tri(1)) {
@@ -77,77 +192,110 @@ struct align_triangle_functor {
     }
 };
 
-struct edge_first_eq_functor {
-    __device__ bool operator() (const Eigen::Vector2i& lhs, const Eigen::Vector2i& rhs) { return lhs[0] == rhs[0]; };
+/// Inverse distances to the neighbours, in the order of the adjacency.
+struct compute_adjacency_weights_functor {
+    compute_adjacency_weights_functor(const Eigen::Vector3f* vertices, const int* offsets,
+                                      const int* indices, float* weights)
+                                      : vertices_(vertices), offsets_(offsets),
+                                      indices_(indices), weights_(weights) {};
+    const Eigen::Vector3f* vertices_;
+    const int* offsets_;
+    const int* indices_;
+    float* weights_;
+    __device__ void operator() (size_t idx) {
+        for (int k = offsets_[idx]; k < offsets_[idx + 1]; ++k) {
+            const float dist = (vertices_[idx] - vertices_[indices_[k]]).norm();
+            weights_[k] = 1. / (dist + 1e-12);
+        }
+    }
 };
 
-struct weighted_vec_functor {
-    __device__ Eigen::Vector3f operator() (const thrust::tuple<Eigen::Vector3f, float>& x) {
-       return thrust::get<1>(x) * thrust::get<0>(x);
-    };
+struct sharpen_filter {
+    sharpen_filter(float strength) : strength_(strength) {};
+    const float strength_;
+    __device__ Eigen::Vector3f operator() (const Eigen::Vector3f& prv, const Eigen::Vector3f& sum,
+                                           float total) const {
+        return prv + strength_ * (prv * total - sum);
+    }
 };
 
-struct compute_weights_from_edges_functor {
-    compute_weights_from_edges_functor(const Eigen::Vector3f* vertices) : vertices_(vertices) {};
-    const Eigen::Vector3f* vertices_;
-    __device__ float operator() (const Eigen::Vector2i& edge) {
-        const auto dist = (vertices_[edge[0]] - vertices_[edge[1]]).norm();
-        return 1. / (dist + 1e-12);
+struct smooth_simple_filter {
+    __device__ Eigen::Vector3f operator() (const Eigen::Vector3f& prv, const Eigen::Vector3f& sum,
+                                           float total) const {
+        return (prv + sum) / (1.0 + total);
     }
 };
 
-void FilterSmoothLaplacianHelper(
-        std::shared_ptr<TriangleMesh> &mesh,
-        utility::device_vector<Eigen::Vector3f> &prev_vertices,
-        utility::device_vector<Eigen::Vector3f> &prev_vertex_normals,
-        utility::device_vector<Eigen::Vector3f> &prev_vertex_colors,
-        utility::device_vector<Eigen::Vector3f> &vertex_sums,
-        utility::device_vector<Eigen::Vector3f> &normal_sums,
-        utility::device_vector<Eigen::Vector3f> &color_sums,
-        utility::device_vector<float> &weights,
-        utility::device_vector<float> &total_weights,
-        float lambda,
-        bool filter_vertex,
-        bool filter_normal,
-        bool filter_color) {
-    typedef utility::device_vector<Eigen::Vector3f>::iterator ElementIterator;
-    auto filter_fn = [lambda] __device__ (const thrust::tuple<Eigen::Vector3f, float, Eigen::Vector3f>& x) -> Eigen::Vector3f {
-            const Eigen::Vector3f& prv = thrust::get<0>(x);
-            const Eigen::Vector3f& sum = thrust::get<2>(x);
-            return prv + lambda * (sum / thrust::get<1>(x) - prv);
-        };
+struct smooth_laplacian_filter {
+    smooth_laplacian_filter(float lambda) : lambda_(lambda) {};
+    const float lambda_;
+    __device__ Eigen::Vector3f operator() (const Eigen::Vector3f& prv, const Eigen::Vector3f& sum,
+                                           float total) const {
+        return (total > 0) ? Eigen::Vector3f(prv + lambda_ * (sum / total - prv)) : prv;
+    }
+};
+
+/// One thread per vertex gathers the (weighted) sum of the values of its
+/// neighbours over its row of the adjacency and applies the filter.
+template <class Filter>
+struct filter_neighbours_functor {
+    filter_neighbours_functor(const int* offsets, const int* indices, const float* weights,
+                              const Eigen::Vector3f* values, const Filter& filter)
+                              : offsets_(offsets), indices_(indices), weights_(weights),
+                              values_(values), filter_(filter) {};
+    const int* offsets_;
+    const int* indices_;
+    const float* weights_;
+    const Eigen::Vector3f* values_;
+    const Filter filter_;
+    __device__ Eigen::Vector3f operator() (size_t idx) const {
+        Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+        float total = 0.0;
+        for (int k = offsets_[idx]; k < offsets_[idx + 1]; ++k) {
+            const float w = (weights_) ? weights_[k] : 1.0f;
+            sum += w * values_[indices_[k]];
+            total += w;
+        }
+        return filter_(values_[idx], sum, total);
+    }
+};
+
+template <class Filter>
+void FilterNeighbours(const CompressedAdjacency& adjacency,
+                      const utility::device_vector<float>& weights,
+                      const utility::device_vector<Eigen::Vector3f>& prev_values,
+                      utility::device_vector<Eigen::Vector3f>& values,
+                      const Filter& filter) {
+    filter_neighbours_functor<Filter> func(thrust::raw_pointer_cast(adjacency.offsets_.data()),
+                                           thrust::raw_pointer_cast(adjacency.indices_.data()),
+                                           weights.empty() ? NULL : thrust::raw_pointer_cast(weights.data()),
+                                           thrust::raw_pointer_cast(prev_values.data()), filter);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(prev_values.size()),
+                      values.begin(), func);
+}
+
+/// One pass of the filter over the values selected by the scope, from the
+/// prev_ values to the mesh.
+template <class Filter>
+void FilterMeshHelper(std::shared_ptr<TriangleMesh> &mesh,
+                      const CompressedAdjacency& adjacency,
+                      const utility::device_vector<float>& weights,
+                      const utility::device_vector<Eigen::Vector3f> &prev_vertices,
+                      const utility::device_vector<Eigen::Vector3f> &prev_vertex_normals,
+                      const utility::device_vector<Eigen::Vector3f> &prev_vertex_colors,
+                      const Filter& filter,
+                      bool filter_vertex,
+                      bool filter_normal,
+                      bool filter_color) {
     if (filter_vertex) {
-        auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-        thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertices.begin(), tritr);
-        thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                              thrust::make_transform_iterator(make_tuple_iterator(pmitr, weights.begin()), weighted_vec_functor()),
-                              thrust::make_discard_iterator(),
-                              vertex_sums.begin(), edge_first_eq_functor());
-        thrust::transform(make_tuple_begin(prev_vertices, total_weights, vertex_sums),
-                          make_tuple_end(prev_vertices, total_weights, vertex_sums),
-                          mesh->vertices_.begin(), filter_fn);
+        FilterNeighbours(adjacency, weights, prev_vertices, mesh->vertices_, filter);
     }
     if (filter_normal) {
-        auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-        thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertex_normals.begin(), tritr);
-        thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                              thrust::make_transform_iterator(make_tuple_iterator(pmitr, weights.begin()), weighted_vec_functor()),
-                              thrust::make_discard_iterator(),
-                              normal_sums.begin(), edge_first_eq_functor());
-        thrust::transform(make_tuple_begin(prev_vertex_normals, total_weights, normal_sums),
-                          make_tuple_end(prev_vertex_normals, total_weights, normal_sums),
-                          mesh->vertex_normals_.begin(), filter_fn);
+        FilterNeighbours(adjacency, weights, prev_vertex_normals, mesh->vertex_normals_, filter);
     }
     if (filter_color) {
-        auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-        thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertex_colors.begin(), tritr);
-        thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                              thrust::make_transform_iterator(make_tuple_iterator(pmitr, weights.begin()), weighted_vec_functor()),
-                              thrust::make_discard_iterator(),
-                              color_sums.begin(), edge_first_eq_functor());
-        thrust::transform(make_tuple_begin(prev_vertex_colors, total_weights, color_sums),
-                          make_tuple_end(prev_vertex_colors, total_weights, color_sums),
-                          mesh->vertex_colors_.begin(), filter_fn);
+        FilterNeighbours(adjacency, weights, prev_vertex_colors, mesh->vertex_colors_, filter);
     }
 }
 
@@ -215,43 +363,141 @@ struct sample_points_functor {
     }
 };
 
+// Pairs (i, j) with j > i of the triangles that intersect the triangle i
+// without sharing a vertex. The candidates j are the triangles whose bounds
+// overlap those of i in the tree. Counts the pairs when pairs_ is NULL.
 struct check_self_intersecting_triangles {
-    check_self_intersecting_triangles(const Eigen::Vector3i *triangles,
+    check_self_intersecting_triangles(const AABBTreeView &tree,
+                                      const Eigen::Vector3i *triangles,
                                       const Eigen::Vector3f *vertices,
-                                      int n_triangles)
-        : triangles_(triangles),
+                                      const int *offsets,
+                                      Eigen::Vector2i *pairs)
+        : tree_(tree),
+          triangles_(triangles),
           vertices_(vertices),
-          n_triangles_(n_triangles){};
+          offsets_(offsets),
+          pairs_(pairs){};
+    const AABBTreeView tree_;
     const Eigen::Vector3i *triangles_;
     const Eigen::Vector3f *vertices_;
-    const int n_triangles_;
-    __device__ Eigen::Vector2i operator()(size_t idx) const {
-        int tidx0 = idx / n_triangles_;
-        int tidx1 = idx % n_triangles_;
-        if (tidx0 >= tidx1 || tidx0 == n_triangles_ - 1) {
-            return Eigen::Vector2i(-1, -1);
+    const int *offsets_;
+    Eigen::Vector2i *pairs_;
+
+    struct node_test {
+        __device__ node_test(const Eigen::Vector3f &min_bound,
+                             const Eigen::Vector3f &max_bound)
+            : min_bound_(min_bound), max_bound_(max_bound){};
+        const Eigen::Vector3f min_bound_;
+        const Eigen::Vector3f max_bound_;
+        __device__ bool operator()(const Eigen::Vector3f &min_bound,
+                                   const Eigen::Vector3f &max_bound) const {
+            return intersection_test::AABBAABB(min_bound_, max_bound_,
+                                               min_bound, max_bound);
         }
-        const Eigen::Vector3i &tria_p = triangles_[tidx0];
-        const Eigen::Vector3f &p0 = vertices_[tria_p(0)];
-        const Eigen::Vector3f &p1 = vertices_[tria_p(1)];
-        const Eigen::Vector3f &p2 = vertices_[tria_p(2)];
-        const Eigen::Vector3i &tria_q = triangles_[tidx1];
-        // check if neighbour triangle
-        if (tria_p(0) == tria_q(0) || tria_p(0) == tria_q(1) ||
-            tria_p(0) == tria_q(2) || tria_p(1) == tria_q(0) ||
-            tria_p(1) == tria_q(1) || tria_p(1) == tria_q(2) ||
-            tria_p(2) == tria_q(0) || tria_p(2) == tria_q(1) ||
-            tria_p(2) == tria_q(2)) {
-            return Eigen::Vector2i(-1, -1);
+    };
+
+    struct leaf_func {
+        __device__ leaf_func(const check_self_intersecting_triangles &parent,
+                             int tidx0)
+            : parent_(parent), tidx0_(tidx0){};
+        const check_self_intersecting_triangles &parent_;
+        const int tidx0_;
+        int n_ = 0;
+        __device__ bool operator()(int tidx1,
+                                   const Eigen::Vector3f &,
+                                   const Eigen::Vector3f &) {
+            if (tidx1 <= tidx0_) return true;
+            const Eigen::Vector3i &tria_p = parent_.triangles_[tidx0_];
+            const Eigen::Vector3i &tria_q = parent_.triangles_[tidx1];
+            // check if neighbour triangle
+            for (int k = 0; k < 3; ++k) {
+                if (tria_p(k) == tria_q(0) || tria_p(k) == tria_q(1) ||
+                    tria_p(k) == tria_q(2)) {
+                    return true;
+                }
+            }
+            // check for intersection
+            const Eigen::Vector3f *v = parent_.vertices_;
+            if (intersection_test::TriangleTriangle3d(
+                        v[tria_p(0)], v[tria_p(1)], v[tria_p(2)],
+                        v[tria_q(0)], v[tria_q(1)], v[tria_q(2)])) {
+                if (parent_.pairs_) {
+                    parent_.pairs_[parent_.offsets_[tidx0_] + n_] =
+                            Eigen::Vector2i(tidx0_, tidx1);
+                }
+                ++n_;
+            }
+            return true;
         }
-        // check for intersection
-        const Eigen::Vector3f &q0 = vertices_[tria_q(0)];
-        const Eigen::Vector3f &q1 = vertices_[tria_q(1)];
-        const Eigen::Vector3f &q2 = vertices_[tria_q(2)];
-        if (intersection_test::TriangleTriangle3d(p0, p1, p2, q0, q1, q2)) {
-            return Eigen::Vector2i(tidx0, tidx1);
+    };
+
+    __device__ int operator()(size_t idx) const {
+        const Eigen::Vector3i &tria = triangles_[idx];
+        const Eigen::Vector3f &p0 = vertices_[tria(0)];
+        const Eigen::Vector3f &p1 = vertices_[tria(1)];
+        const Eigen::Vector3f &p2 = vertices_[tria(2)];
+        node_test test(p0.cwiseMin(p1).cwiseMin(p2),
+                       p0.cwiseMax(p1).cwiseMax(p2));
+        leaf_func leaf(*this, idx);
+        tree_.Traverse(test, leaf);
+        return leaf.n_;
+    }
+};
+
+void ComputeEdges(const utility::device_vector<Eigen::Vector3i> &triangles,
+                  utility::device_vector<Eigen::Vector2i> &edges) {
+    edges.clear();
+    edges.resize(triangles.size() * 6);
+    compute_edge_list_functor func(
+            thrust::raw_pointer_cast(triangles.data()),
+            thrust::raw_pointer_cast(edges.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(triangles.size()), func);
+    thrust::sort(edges.begin(), edges.end());
+    auto end = thrust::unique(edges.begin(), edges.end());
+    size_t n_out = thrust::distance(edges.begin(), end);
+    edges.resize(n_out);
+}
+
+// Vertices of the edges of the triangles, the smaller one in the high bits,
+// indexed by 3 * triangle + corner.
+struct triangle_edge_key_functor {
+    triangle_edge_key_functor(const Eigen::Vector3i *triangles)
+        : triangles_(triangles){};
+    const Eigen::Vector3i *triangles_;
+    __device__ unsigned long long operator()(size_t idx) const {
+        const Eigen::Vector3i &t = triangles_[idx / 3];
+        const int a = t[idx % 3];
+        const int b = t[(idx + 1) % 3];
+        return ((unsigned long long)min(a, b) << 32) |
+               (unsigned int)max(a, b);
+    }
+};
+
+// Joins every triangle with the first triangle of each of its edges.
+struct union_edge_triangles_functor {
+    union_edge_triangles_functor(
+            const utility::device_hash_map<unsigned long long, int> &edges,
+            const unsigned long long *keys,
+            int *parents)
+        : edges_(edges.view()), keys_(keys), parents_(parents){};
+    const utility::device_hash_map<unsigned long long, int>::view_type edges_;
+    const unsigned long long *keys_;
+    int *parents_;
+    __device__ void operator()(size_t idx) const {
+        const int *first = edges_.find(keys_[idx]);
+        const int t = idx / 3;
+        if (first && *first != t) {
+            utility::UnionRoots(parents_, t, *first);
         }
-        return Eigen::Vector2i(-1, -1);
+    }
+};
+
+struct flatten_triangle_roots_functor {
+    flatten_triangle_roots_functor(int *parents) : parents_(parents){};
+    int *parents_;
+    __device__ int operator()(size_t idx) const {
+        return utility::FindRoot(parents_, idx);
     }
 };
 
@@ -281,7 +527,14 @@ TriangleMesh::TriangleMesh(const geometry::TriangleMesh &other)
       triangle_normals_(other.triangle_normals_),
       edge_list_(other.edge_list_),
       triangle_uvs_(other.triangle_uvs_),
-      texture_(other.texture_) {}
+      texture_(other.texture_),
+      vertex_adjacency_(other.vertex_adjacency_),
+      vertex_triangle_adjacency_(other.vertex_triangle_adjacency_) {}
+
+TriangleMesh::TriangleMesh(geometry::TriangleMesh &&other)
+    : MeshBase(Geometry::GeometryType::TriangleMesh) {
+    *this = std::move(other);
+}
 
 TriangleMesh &TriangleMesh::operator=(const TriangleMesh &other) {
     MeshBase::operator=(other);
@@ -290,17 +543,37 @@ TriangleMesh &TriangleMesh::operator=(const TriangleMesh &other) {
     edge_list_ = other.edge_list_;
     triangle_uvs_ = other.triangle_uvs_;
     texture_ = other.texture_;
+    vertex_adjacency_ = other.vertex_adjacency_;
+    vertex_triangle_adjacency_ = other.vertex_triangle_adjacency_;
+    return *this;
+}
+
+TriangleMesh &TriangleMesh::operator=(TriangleMesh &&other) {
+    MeshBase::operator=(std::move(other));
+    triangles_ = std::move(other.triangles_);
+    triangle_normals_ = std::move(other.triangle_normals_);
+    edge_list_ = std::move(other.edge_list_);
+    triangle_uvs_ = std::move(other.triangle_uvs_);
+    texture_ = std::move(other.texture_);
+    vertex_adjacency_ = std::move(other.vertex_adjacency_);
+    vertex_triangle_adjacency_ = std::move(other.vertex_triangle_adjacency_);
     return *this;
 }
 
 thrust::host_vector<Eigen::Vector3i> TriangleMesh::GetTriangles() const {
-    thrust::host_vector<Eigen::Vector3i> triangles = triangles_;
-    return triangles;
+    return triangles_mirror_.Download(triangles_);
+}
+
+void TriangleMesh::GetTriangles(
+        utility::pinned_host_vector<Eigen::Vector3i> &triangles,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(triangles_, triangles, stream);
 }
 
 void TriangleMesh::SetTriangles(
         const thrust::host_vector<Eigen::Vector3i> &triangles) {
-    triangles_ = triangles;
+    triangles_mirror_.Upload(triangles, triangles_);
+    InvalidateAdjacency();
 }
 
 thrust::host_vector<Eigen::Vector3f> TriangleMesh::GetTriangleNormals() const {
@@ -308,6 +581,12 @@ thrust::host_vector<Eigen::Vector3f> TriangleMesh::GetTriangleNormals() const {
     return triangle_normals;
 }
 
+void TriangleMesh::GetTriangleNormals(
+        utility::pinned_host_vector<Eigen::Vector3f> &triangle_normals,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(triangle_normals_, triangle_normals, stream);
+}
+
 void TriangleMesh::SetTriangleNormals(
         const thrust::host_vector<Eigen::Vector3f> &triangle_normals) {
     triangle_normals_ = triangle_normals;
@@ -318,6 +597,12 @@ thrust::host_vector<Eigen::Vector2i> TriangleMesh::GetEdgeList() const {
     return edge_list;
 }
 
+void TriangleMesh::GetEdgeList(
+        utility::pinned_host_vector<Eigen::Vector2i> &edge_list,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(edge_list_, edge_list, stream);
+}
+
 void TriangleMesh::SetEdgeList(
         const thrust::host_vector<Eigen::Vector2i> &edge_list) {
     edge_list_ = edge_list;
@@ -328,6 +613,12 @@ thrust::host_vector<Eigen::Vector2f> TriangleMesh::GetTriangleUVs() const {
     return triangle_uvs;
 }
 
+void TriangleMesh::GetTriangleUVs(
+        utility::pinned_host_vector<Eigen::Vector2f> &triangle_uvs,
+        cudaStream_t stream) const {
+    utility::CopyToHostAsync(triangle_uvs_, triangle_uvs, stream);
+}
+
 void TriangleMesh::SetTriangleUVs(
         thrust::host_vector<Eigen::Vector2f> &triangle_uvs) {
     triangle_uvs_ = triangle_uvs;
@@ -340,6 +631,7 @@ TriangleMesh &TriangleMesh::Clear() {
     edge_list_.clear();
     triangle_uvs_.clear();
     texture_.Clear();
+    InvalidateAdjacency();
     return *this;
 }
 
@@ -380,6 +672,7 @@ TriangleMesh &TriangleMesh::operator+=(const TriangleMesh &mesh) {
                       [=] __device__(const Eigen::Vector3i &tri) {
                           return tri + index_shift;
                       });
+    InvalidateAdjacency();
     if (HasEdgeList()) {
         ComputeEdgeList();
     }
@@ -425,21 +718,13 @@ TriangleMesh &TriangleMesh::ComputeVertexNormals(bool normalized /* = true*/) {
         ComputeTriangleNormals(false);
     }
     vertex_normals_.resize(vertices_.size());
-    thrust::repeated_range<utility::device_vector<Eigen::Vector3f>::iterator>
-            range(triangle_normals_.begin(), triangle_normals_.end(), 3);
-    utility::device_vector<Eigen::Vector3f> nm_thrice(triangle_normals_.size() *
-                                                      3);
-    thrust::copy(range.begin(), range.end(), nm_thrice.begin());
-    utility::device_vector<Eigen::Vector3i> copy_tri = triangles_;
-    int *tri_ptr = (int *)(thrust::raw_pointer_cast(copy_tri.data()));
-    thrust::sort_by_key(thrust::device, tri_ptr,
-                        tri_ptr + copy_tri.size() * 3, nm_thrice.begin());
-    auto end = thrust::reduce_by_key(
-            thrust::device, tri_ptr, tri_ptr + copy_tri.size() * 3,
-            nm_thrice.begin(), thrust::make_discard_iterator(),
-            vertex_normals_.begin());
-    size_t n_out = thrust::distance(vertex_normals_.begin(), end.second);
-    vertex_normals_.resize(n_out);
+    auto adjacency = GetVertexTriangleAdjacency();
+    sum_triangle_normals_functor func(thrust::raw_pointer_cast(adjacency->offsets_.data()),
+                                      thrust::raw_pointer_cast(adjacency->indices_.data()),
+                                      thrust::raw_pointer_cast(triangle_normals_.data()));
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(vertices_.size()),
+                      vertex_normals_.begin(), func);
     if (normalized) {
         NormalizeNormals();
     }
@@ -447,20 +732,64 @@ TriangleMesh &TriangleMesh::ComputeVertexNormals(bool normalized /* = true*/) {
 }
 
 TriangleMesh &TriangleMesh::ComputeEdgeList() {
-    edge_list_.clear();
-    edge_list_.resize(triangles_.size() * 6);
-    compute_edge_list_functor func(
-            thrust::raw_pointer_cast(triangles_.data()),
-            thrust::raw_pointer_cast(edge_list_.data()));
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator(triangles_.size()), func);
-    thrust::sort(edge_list_.begin(), edge_list_.end());
-    auto end = thrust::unique(edge_list_.begin(), edge_list_.end());
-    size_t n_out = thrust::distance(edge_list_.begin(), end);
-    edge_list_.resize(n_out);
+    ComputeEdges(triangles_, edge_list_);
+    InvalidateAdjacency();
     return *this;
 }
 
+std::shared_ptr<const CompressedAdjacency> TriangleMesh::GetVertexAdjacency() const {
+    if (vertex_adjacency_ && vertex_adjacency_->offsets_.size() == vertices_.size() + 1) {
+        return vertex_adjacency_;
+    }
+    // The edge list holds both directions sorted by their first vertex, so
+    // the rows are the runs of equal first vertices.
+    utility::device_vector<Eigen::Vector2i> computed_edges;
+    if (!HasEdgeList()) ComputeEdges(triangles_, computed_edges);
+    const utility::device_vector<Eigen::Vector2i> &edges = (HasEdgeList()) ? edge_list_ : computed_edges;
+    auto adjacency = std::make_shared<CompressedAdjacency>();
+    adjacency->indices_.resize(edges.size());
+    thrust::transform(edges.begin(), edges.end(), adjacency->indices_.begin(),
+                      extract_element_functor<int, 2, 1>());
+    adjacency->offsets_.resize(vertices_.size() + 1);
+    auto firsts = thrust::make_transform_iterator(edges.begin(), extract_element_functor<int, 2, 0>());
+    thrust::lower_bound(firsts, firsts + edges.size(),
+                        thrust::make_counting_iterator<int>(0),
+                        thrust::make_counting_iterator<int>(vertices_.size() + 1),
+                        adjacency->offsets_.begin());
+    vertex_adjacency_ = adjacency;
+    return vertex_adjacency_;
+}
+
+std::shared_ptr<const CompressedAdjacency> TriangleMesh::GetVertexTriangleAdjacency() const {
+    if (vertex_triangle_adjacency_ &&
+        vertex_triangle_adjacency_->offsets_.size() == vertices_.size() + 1) {
+        return vertex_triangle_adjacency_;
+    }
+    // The corners are sorted by vertex, the stable sort keeping the
+    // triangles of every vertex in increasing order.
+    auto adjacency = std::make_shared<CompressedAdjacency>();
+    utility::device_vector<int> corners(triangles_.size() * 3);
+    const int *tri_ptr = (const int *)thrust::raw_pointer_cast(triangles_.data());
+    thrust::copy(thrust::device, tri_ptr, tri_ptr + corners.size(), corners.begin());
+    adjacency->indices_.resize(corners.size());
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(corners.size()),
+                      adjacency->indices_.begin(), corner_triangle_functor());
+    thrust::stable_sort_by_key(corners.begin(), corners.end(), adjacency->indices_.begin());
+    adjacency->offsets_.resize(vertices_.size() + 1);
+    thrust::lower_bound(corners.begin(), corners.end(),
+                        thrust::make_counting_iterator<int>(0),
+                        thrust::make_counting_iterator<int>(vertices_.size() + 1),
+                        adjacency->offsets_.begin());
+    vertex_triangle_adjacency_ = adjacency;
+    return vertex_triangle_adjacency_;
+}
+
+void TriangleMesh::InvalidateAdjacency() {
+    vertex_adjacency_.reset();
+    vertex_triangle_adjacency_.reset();
+}
+
 std::shared_ptr<TriangleMesh> TriangleMesh::FilterSharpen(
         int number_of_iterations, float strength, FilterScope scope) const {
     bool filter_vertex =
@@ -477,66 +806,25 @@ std::shared_ptr<TriangleMesh> TriangleMesh::FilterSharpen(
     utility::device_vector<Eigen::Vector3f> prev_vertex_colors = vertex_colors_;
 
     std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
-    mesh->vertices_.resize(vertices_.size());
-    mesh->vertex_normals_.resize(vertex_normals_.size());
-    mesh->vertex_colors_.resize(vertex_colors_.size());
+    mesh->vertices_ = vertices_;
+    mesh->vertex_normals_ = vertex_normals_;
+    mesh->vertex_colors_ = vertex_colors_;
     mesh->triangles_ = triangles_;
     mesh->edge_list_ = edge_list_;
-    if (!mesh->HasEdgeList()) {
-        mesh->ComputeEdgeList();
-    }
-
-    utility::device_vector<Eigen::Vector3f> vertex_sums(vertices_.size());
-    utility::device_vector<Eigen::Vector3f> normal_sums(vertex_normals_.size());
-    utility::device_vector<Eigen::Vector3f> color_sums(vertex_colors_.size());
-    utility::device_vector<int> counts(vertices_.size());
-    typedef utility::device_vector<Eigen::Vector3f>::iterator ElementIterator;
-    auto filter_fn = [strength] __device__ (const thrust::tuple<Eigen::Vector3f, int, Eigen::Vector3f>& x) -> Eigen::Vector3f {
-            const Eigen::Vector3f& prv = thrust::get<0>(x);
-            const Eigen::Vector3f& sum = thrust::get<2>(x);
-            return prv + strength * (prv * thrust::get<1>(x) - sum);
-        };
-    thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                          thrust::make_constant_iterator(1), thrust::make_discard_iterator(),
-                          counts.begin(), edge_first_eq_functor());
+    mesh->vertex_adjacency_ = GetVertexAdjacency();
+    const CompressedAdjacency &adjacency = *mesh->vertex_adjacency_;
+    const utility::device_vector<float> weights;
     for (int iter = 0; iter < number_of_iterations; ++iter) {
-        if (filter_vertex) {
-            auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-            thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertices.begin(), tritr);
-            thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                                  pmitr, thrust::make_discard_iterator(),
-                                  vertex_sums.begin(), edge_first_eq_functor());
-            thrust::transform(make_tuple_begin(prev_vertices, counts, vertex_sums),
-                              make_tuple_end(prev_vertices, counts, vertex_sums),
-                              mesh->vertices_.begin(), filter_fn);
-        }
-        if (filter_normal) {
-            auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-            thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertex_normals.begin(), tritr);
-            thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                                  pmitr, thrust::make_discard_iterator(),
-                                  normal_sums.begin(), edge_first_eq_functor());
-            thrust::transform(make_tuple_begin(prev_vertex_normals, counts, normal_sums),
-                              make_tuple_end(prev_vertex_normals, counts, normal_sums),
-                              mesh->vertex_normals_.begin(), filter_fn);
-        }
-        if (filter_color) {
-            auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-            thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertex_colors.begin(), tritr);
-            thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                                  pmitr, thrust::make_discard_iterator(),
-                                  color_sums.begin(), edge_first_eq_functor());
-            thrust::transform(make_tuple_begin(prev_vertex_colors, counts, color_sums),
-                              make_tuple_end(prev_vertex_colors, counts, color_sums),
-                              mesh->vertex_colors_.begin(), filter_fn);
-        }
+        FilterMeshHelper(mesh, adjacency, weights, prev_vertices,
+                         prev_vertex_normals, prev_vertex_colors,
+                         sharpen_filter(strength), filter_vertex, filter_normal,
+                         filter_color);
         if (iter < number_of_iterations - 1) {
             thrust::swap(mesh->vertices_, prev_vertices);
             thrust::swap(mesh->vertex_normals_, prev_vertex_normals);
             thrust::swap(mesh->vertex_colors_, prev_vertex_colors);
         }
     }
-
     return mesh;
 }
 
@@ -556,66 +844,25 @@ std::shared_ptr<TriangleMesh> TriangleMesh::FilterSmoothSimple(
     utility::device_vector<Eigen::Vector3f> prev_vertex_colors = vertex_colors_;
 
     std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
-    mesh->vertices_.resize(vertices_.size());
-    mesh->vertex_normals_.resize(vertex_normals_.size());
-    mesh->vertex_colors_.resize(vertex_colors_.size());
+    mesh->vertices_ = vertices_;
+    mesh->vertex_normals_ = vertex_normals_;
+    mesh->vertex_colors_ = vertex_colors_;
     mesh->triangles_ = triangles_;
     mesh->edge_list_ = edge_list_;
-    if (!mesh->HasEdgeList()) {
-        mesh->ComputeEdgeList();
-    }
-
-    utility::device_vector<Eigen::Vector3f> vertex_sums(vertices_.size());
-    utility::device_vector<Eigen::Vector3f> normal_sums(vertex_normals_.size());
-    utility::device_vector<Eigen::Vector3f> color_sums(vertex_colors_.size());
-    utility::device_vector<int> counts(vertices_.size());
-    typedef utility::device_vector<Eigen::Vector3f>::iterator ElementIterator;
-    auto filter_fn = [] __device__ (const thrust::tuple<Eigen::Vector3f, int, Eigen::Vector3f>& x) -> Eigen::Vector3f {
-            const Eigen::Vector3f& prv = thrust::get<0>(x);
-            const Eigen::Vector3f& sum = thrust::get<2>(x);
-            return (prv + sum) / (1.0 + thrust::get<1>(x));
-        };
-    thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                          thrust::make_constant_iterator(1), thrust::make_discard_iterator(),
-                          counts.begin(), edge_first_eq_functor());
+    mesh->vertex_adjacency_ = GetVertexAdjacency();
+    const CompressedAdjacency &adjacency = *mesh->vertex_adjacency_;
+    const utility::device_vector<float> weights;
     for (int iter = 0; iter < number_of_iterations; ++iter) {
-        if (filter_vertex) {
-            auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-            thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertices.begin(), tritr);
-            thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                                  pmitr, thrust::make_discard_iterator(),
-                                  vertex_sums.begin(), edge_first_eq_functor());
-            thrust::transform(make_tuple_begin(prev_vertices, counts, vertex_sums),
-                              make_tuple_end(prev_vertices, counts, vertex_sums),
-                              mesh->vertices_.begin(), filter_fn);
-        }
-        if (filter_normal) {
-            auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-            thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertex_normals.begin(), tritr);
-            thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                                  pmitr, thrust::make_discard_iterator(),
-                                  normal_sums.begin(), edge_first_eq_functor());
-            thrust::transform(make_tuple_begin(prev_vertex_normals, counts, normal_sums),
-                              make_tuple_end(prev_vertex_normals, counts, normal_sums),
-                              mesh->vertex_normals_.begin(), filter_fn);
-        }
-        if (filter_color) {
-            auto tritr = thrust::make_transform_iterator(mesh->edge_list_.begin(), extract_element_functor<int, 2, 1>());
-            thrust::permutation_iterator<ElementIterator, decltype(tritr)> pmitr(prev_vertex_colors.begin(), tritr);
-            thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                                  pmitr, thrust::make_discard_iterator(),
-                                  color_sums.begin(), edge_first_eq_functor());
-            thrust::transform(make_tuple_begin(prev_vertex_colors, counts, color_sums),
-                              make_tuple_end(prev_vertex_colors, counts, color_sums),
-                              mesh->vertex_colors_.begin(), filter_fn);
-        }
+        FilterMeshHelper(mesh, adjacency, weights, prev_vertices,
+                         prev_vertex_normals, prev_vertex_colors,
+                         smooth_simple_filter(), filter_vertex, filter_normal,
+                         filter_color);
         if (iter < number_of_iterations - 1) {
             thrust::swap(mesh->vertices_, prev_vertices);
             thrust::swap(mesh->vertex_normals_, prev_vertex_normals);
             thrust::swap(mesh->vertex_colors_, prev_vertex_colors);
         }
     }
-
     return mesh;
 }
 
@@ -635,37 +882,29 @@ std::shared_ptr<TriangleMesh> TriangleMesh::FilterSmoothLaplacian(
     utility::device_vector<Eigen::Vector3f> prev_vertex_colors = vertex_colors_;
 
     std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
-    mesh->vertices_.resize(vertices_.size());
-    mesh->vertex_normals_.resize(vertex_normals_.size());
-    mesh->vertex_colors_.resize(vertex_colors_.size());
+    mesh->vertices_ = vertices_;
+    mesh->vertex_normals_ = vertex_normals_;
+    mesh->vertex_colors_ = vertex_colors_;
     mesh->triangles_ = triangles_;
     mesh->edge_list_ = edge_list_;
-    if (!mesh->HasEdgeList()) {
-        mesh->ComputeEdgeList();
-    }
-
-    utility::device_vector<Eigen::Vector3f> vertex_sums(mesh->vertices_.size());
-    utility::device_vector<Eigen::Vector3f> normal_sums(mesh->vertex_normals_.size());
-    utility::device_vector<Eigen::Vector3f> color_sums(mesh->vertex_colors_.size());
-    utility::device_vector<float> weights(mesh->edge_list_.size());
-    utility::device_vector<float> total_weights(mesh->vertices_.size());
-    compute_weights_from_edges_functor func(thrust::raw_pointer_cast(prev_vertices.data()));
-    thrust::transform(mesh->edge_list_.begin(), mesh->edge_list_.end(), weights.begin(), func);
-    thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                          weights.begin(), thrust::make_discard_iterator(),
-                          total_weights.begin(), edge_first_eq_functor());
-
+    mesh->vertex_adjacency_ = GetVertexAdjacency();
+    const CompressedAdjacency &adjacency = *mesh->vertex_adjacency_;
+    utility::device_vector<float> weights(adjacency.indices_.size());
+    compute_adjacency_weights_functor func(thrust::raw_pointer_cast(prev_vertices.data()),
+                                           thrust::raw_pointer_cast(adjacency.offsets_.data()),
+                                           thrust::raw_pointer_cast(adjacency.indices_.data()),
+                                           thrust::raw_pointer_cast(weights.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(prev_vertices.size()), func);
     for (int iter = 0; iter < number_of_iterations; ++iter) {
-        FilterSmoothLaplacianHelper(mesh, prev_vertices, prev_vertex_normals,
-                                    prev_vertex_colors, vertex_sums,
-                                    normal_sums, color_sums,
-                                    weights, total_weights,
-                                    lambda, filter_vertex, filter_normal,
-                                    filter_color);
+        FilterMeshHelper(mesh, adjacency, weights, prev_vertices,
+                         prev_vertex_normals, prev_vertex_colors,
+                         smooth_laplacian_filter(lambda), filter_vertex, filter_normal,
+                         filter_color);
         if (iter < number_of_iterations - 1) {
-            std::swap(mesh->vertices_, prev_vertices);
-            std::swap(mesh->vertex_normals_, prev_vertex_normals);
-            std::swap(mesh->vertex_colors_, prev_vertex_colors);
+            thrust::swap(mesh->vertices_, prev_vertices);
+            thrust::swap(mesh->vertex_normals_, prev_vertex_normals);
+            thrust::swap(mesh->vertex_colors_, prev_vertex_colors);
         }
     }
     return mesh;
@@ -690,41 +929,32 @@ std::shared_ptr<TriangleMesh> TriangleMesh::FilterSmoothTaubin(
     utility::device_vector<Eigen::Vector3f> prev_vertex_colors = vertex_colors_;
 
     std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>();
-    mesh->vertices_.resize(vertices_.size());
-    mesh->vertex_normals_.resize(vertex_normals_.size());
-    mesh->vertex_colors_.resize(vertex_colors_.size());
+    mesh->vertices_ = vertices_;
+    mesh->vertex_normals_ = vertex_normals_;
+    mesh->vertex_colors_ = vertex_colors_;
     mesh->triangles_ = triangles_;
     mesh->edge_list_ = edge_list_;
-    if (!mesh->HasEdgeList()) {
-        mesh->ComputeEdgeList();
-    }
-
-    utility::device_vector<Eigen::Vector3f> vertex_sums(mesh->vertices_.size());
-    utility::device_vector<Eigen::Vector3f> normal_sums(mesh->vertex_normals_.size());
-    utility::device_vector<Eigen::Vector3f> color_sums(mesh->vertex_colors_.size());
-    utility::device_vector<float> weights(mesh->edge_list_.size());
-    utility::device_vector<float> total_weights(mesh->vertices_.size());
-    compute_weights_from_edges_functor func(thrust::raw_pointer_cast(prev_vertices.data()));
-    thrust::transform(mesh->edge_list_.begin(), mesh->edge_list_.end(), weights.begin(), func);
-    thrust::reduce_by_key(mesh->edge_list_.begin(), mesh->edge_list_.end(),
-                          weights.begin(), thrust::make_discard_iterator(),
-                          total_weights.begin(), edge_first_eq_functor());
+    mesh->vertex_adjacency_ = GetVertexAdjacency();
+    const CompressedAdjacency &adjacency = *mesh->vertex_adjacency_;
+    utility::device_vector<float> weights(adjacency.indices_.size());
+    compute_adjacency_weights_functor func(thrust::raw_pointer_cast(prev_vertices.data()),
+                                           thrust::raw_pointer_cast(adjacency.offsets_.data()),
+                                           thrust::raw_pointer_cast(adjacency.indices_.data()),
+                                           thrust::raw_pointer_cast(weights.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(prev_vertices.size()), func);
     for (int iter = 0; iter < number_of_iterations; ++iter) {
-        FilterSmoothLaplacianHelper(mesh, prev_vertices, prev_vertex_normals,
-                                    prev_vertex_colors, vertex_sums,
-                                    normal_sums, color_sums,
-                                    weights, total_weights,
-                                    lambda, filter_vertex, filter_normal,
-                                    filter_color);
+        FilterMeshHelper(mesh, adjacency, weights, prev_vertices,
+                         prev_vertex_normals, prev_vertex_colors,
+                         smooth_laplacian_filter(lambda), filter_vertex,
+                         filter_normal, filter_color);
         thrust::swap(mesh->vertices_, prev_vertices);
         thrust::swap(mesh->vertex_normals_, prev_vertex_normals);
         thrust::swap(mesh->vertex_colors_, prev_vertex_colors);
-        FilterSmoothLaplacianHelper(mesh, prev_vertices, prev_vertex_normals,
-                                    prev_vertex_colors, vertex_sums,
-                                    normal_sums, color_sums,
-                                    weights, total_weights,
-                                    mu, filter_vertex, filter_normal,
-                                    filter_color);
+        FilterMeshHelper(mesh, adjacency, weights, prev_vertices,
+                         prev_vertex_normals, prev_vertex_colors,
+                         smooth_laplacian_filter(mu), filter_vertex,
+                         filter_normal, filter_color);
         if (iter < number_of_iterations - 1) {
             thrust::swap(mesh->vertices_, prev_vertices);
             thrust::swap(mesh->vertex_normals_, prev_vertex_normals);
@@ -826,70 +1056,38 @@ std::shared_ptr<PointCloud> TriangleMesh::SamplePointsUniformly(
 }
 
 TriangleMesh &TriangleMesh::RemoveDuplicatedVertices() {
-    size_t old_vertex_num = vertices_.size();
-    utility::device_vector<int> index_new_to_old(old_vertex_num);
-    thrust::sequence(index_new_to_old.begin(), index_new_to_old.end());
-    utility::device_vector<int> idx_offsets(old_vertex_num, 0);
-    bool has_vert_normal = HasVertexNormals();
-    bool has_vert_color = HasVertexColors();
-    size_t k = 0;
-    if (has_vert_normal && has_vert_color) {
-        thrust::sort_by_key(vertices_.begin(), vertices_.end(),
-                            make_tuple_begin(index_new_to_old, vertex_normals_, vertex_colors_));
-        auto end0 = thrust::reduce_by_key(vertices_.begin(), vertices_.end(), thrust::make_constant_iterator<int>(1),
-                                          thrust::make_discard_iterator(), idx_offsets.begin());
-        idx_offsets.resize(thrust::distance(idx_offsets.begin(), end0.second) + 1);
-        thrust::exclusive_scan(idx_offsets.begin(), idx_offsets.end(), idx_offsets.begin());
-        auto begin = make_tuple_begin(vertex_normals_, vertex_colors_);
-        auto end1 = thrust::unique_by_key(vertices_.begin(), vertices_.end(), begin);
-        k = thrust::distance(begin, end1.second);
-    } else if (has_vert_normal) {
-        thrust::sort_by_key(vertices_.begin(), vertices_.end(),
-                            make_tuple_begin(index_new_to_old, vertex_normals_));
-        auto end0 = thrust::reduce_by_key(vertices_.begin(), vertices_.end(), thrust::make_constant_iterator<int>(1),
-                                          thrust::make_discard_iterator(), idx_offsets.begin());
-        idx_offsets.resize(thrust::distance(idx_offsets.begin(), end0.second) + 1);
-        thrust::exclusive_scan(idx_offsets.begin(), idx_offsets.end(), idx_offsets.begin());
-        auto end1 = thrust::unique_by_key(vertices_.begin(), vertices_.end(), vertex_normals_.begin());
-        k = thrust::distance(vertex_normals_.begin(), end1.second);
-    } else if (has_vert_color) {
-        thrust::sort_by_key(vertices_.begin(), vertices_.end(),
-                            make_tuple_begin(index_new_to_old, vertex_colors_));
-        auto end0 = thrust::reduce_by_key(vertices_.begin(), vertices_.end(), thrust::make_constant_iterator<int>(1),
-                                          thrust::make_discard_iterator(), idx_offsets.begin());
-        idx_offsets.resize(thrust::distance(idx_offsets.begin(), end0.second) + 1);
-        thrust::exclusive_scan(idx_offsets.begin(), idx_offsets.end(), idx_offsets.begin());
-        auto end1 = thrust::unique_by_key(vertices_.begin(), vertices_.end(), vertex_colors_.begin());
-        k = thrust::distance(vertex_colors_.begin(), end1.second);
-    } else {
-        thrust::sort_by_key(vertices_.begin(), vertices_.end(), index_new_to_old.begin());
-        auto end0 = thrust::reduce_by_key(vertices_.begin(), vertices_.end(), thrust::make_constant_iterator<int>(1),
-                                          thrust::make_discard_iterator(), idx_offsets.begin());
-        idx_offsets.resize(thrust::distance(idx_offsets.begin(), end0.second) + 1);
-        thrust::exclusive_scan(idx_offsets.begin(), idx_offsets.end(), idx_offsets.begin());
-        auto end1 = thrust::unique(vertices_.begin(), vertices_.end());
-        k = thrust::distance(vertices_.begin(), end1);
-    }
+    const size_t old_vertex_num = vertices_.size();
+    if (old_vertex_num == 0) return *this;
+    const bool has_vert_normal = HasVertexNormals();
+    const bool has_vert_color = HasVertexColors();
+    // The first occurrence of every vertex is kept, in the original order,
+    // and its new index is the number of first occurrences before it.
+    utility::device_vector<int> firsts = FirstOccurrences<Eigen::Vector3f, hash_vertex_functor>(vertices_);
+    utility::device_vector<int> new_indices(old_vertex_num);
+    thrust::transform(make_tuple_iterator(firsts.begin(), thrust::make_counting_iterator<int>(0)),
+                      make_tuple_iterator(firsts.end(), thrust::make_counting_iterator<int>(old_vertex_num)),
+                      new_indices.begin(), is_first_occurrence_functor());
+    thrust::exclusive_scan(new_indices.begin(), new_indices.end(), new_indices.begin());
+    // One scatter pass over the corners: old index -> first occurrence -> new index.
+    const int* firsts_ptr = thrust::raw_pointer_cast(firsts.data());
+    const int* new_indices_ptr = thrust::raw_pointer_cast(new_indices.data());
+    int* tri_ptr = (int*)thrust::raw_pointer_cast(triangles_.data());
+    thrust::transform(thrust::device, tri_ptr, tri_ptr + triangles_.size() * 3, tri_ptr,
+                      [firsts_ptr, new_indices_ptr] __device__ (int idx) {
+                          return new_indices_ptr[firsts_ptr[idx]];
+                      });
+    auto is_duplicated = [firsts_ptr] __device__ (int idx) { return firsts_ptr[idx] != idx; };
+    auto begin = thrust::make_counting_iterator<int>(0);
+    size_t k = thrust::remove_if(vertices_.begin(), vertices_.end(), begin, is_duplicated) - vertices_.begin();
+    if (has_vert_normal) thrust::remove_if(vertex_normals_.begin(), vertex_normals_.end(), begin, is_duplicated);
+    if (has_vert_color) thrust::remove_if(vertex_colors_.begin(), vertex_colors_.end(), begin, is_duplicated);
     vertices_.resize(k);
     if (has_vert_normal) vertex_normals_.resize(k);
     if (has_vert_color) vertex_colors_.resize(k);
-    utility::device_vector<int> index_old_to_new(old_vertex_num);
-    compute_old_to_new_index_functor func(thrust::raw_pointer_cast(idx_offsets.data()),
-                                          thrust::raw_pointer_cast(index_new_to_old.data()),
-                                          thrust::raw_pointer_cast(index_old_to_new.data()));
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0), thrust::make_counting_iterator(k), func);
-    utility::device_vector<Eigen::Vector3i> new_tri(triangles_.size());
-    int* tri_ptr = (int*)thrust::raw_pointer_cast(triangles_.data());
-    int* tri_new_ptr = (int*)thrust::raw_pointer_cast(new_tri.data());
-    int* index_old_to_new_ptr = thrust::raw_pointer_cast(index_old_to_new.data());
-    thrust::transform(thrust::device, tri_ptr, tri_ptr + triangles_.size() * 3, tri_new_ptr,
-                      [index_old_to_new_ptr] __device__ (int idx) {
-                          return index_old_to_new_ptr[idx];
-                      });
-    triangles_ = new_tri;
-    if (HasEdgeList()) {
+    if (k < old_vertex_num && HasEdgeList()) {
         ComputeEdgeList();
     }
+    InvalidateAdjacency();
     utility::LogDebug(
             "[RemoveDuplicatedVertices] {:d} vertices have been removed.",
             (int)(old_vertex_num - k));
@@ -903,26 +1101,25 @@ TriangleMesh &TriangleMesh::RemoveDuplicatedTriangles() {
                 "[RemoveDuplicatedTriangles] This mesh contains triangle uvs "
                 "that are not handled in this function");
     }
-    bool has_tri_normal = HasTriangleNormals();
-    size_t old_triangle_num = triangles_.size();
-    size_t k = 0;
-    utility::device_vector<Eigen::Vector3i> new_triangles(old_triangle_num);
-    thrust::transform(triangles_.begin(), triangles_.end(), new_triangles.begin(), align_triangle_functor());
-    if (has_tri_normal) {
-        thrust::sort_by_key(new_triangles.begin(), new_triangles.end(), triangle_normals_.begin());
-        auto end = thrust::unique_by_key(new_triangles.begin(), new_triangles.end(), triangle_normals_.begin());
-        k = thrust::distance(new_triangles.begin(), end.first);
-    } else {
-        thrust::sort(new_triangles.begin(), new_triangles.end());
-        auto end = thrust::unique(new_triangles.begin(), new_triangles.end());
-        k = thrust::distance(new_triangles.begin(), end);
-    }
-    new_triangles.resize(k);
-    thrust::swap(triangles_, new_triangles);
+    const bool has_tri_normal = HasTriangleNormals();
+    const size_t old_triangle_num = triangles_.size();
+    if (old_triangle_num == 0) return *this;
+    // The triangles are compared up to a rotation of their corners, and the
+    // first occurrence is kept in the original order.
+    utility::device_vector<Eigen::Vector3i> aligned(old_triangle_num);
+    thrust::transform(triangles_.begin(), triangles_.end(), aligned.begin(), align_triangle_functor());
+    utility::device_vector<int> firsts = FirstOccurrences<Eigen::Vector3i, hash_triangle_functor>(aligned);
+    const int* firsts_ptr = thrust::raw_pointer_cast(firsts.data());
+    auto is_duplicated = [firsts_ptr] __device__ (int idx) { return firsts_ptr[idx] != idx; };
+    auto begin = thrust::make_counting_iterator<int>(0);
+    size_t k = thrust::remove_if(triangles_.begin(), triangles_.end(), begin, is_duplicated) - triangles_.begin();
+    if (has_tri_normal) thrust::remove_if(triangle_normals_.begin(), triangle_normals_.end(), begin, is_duplicated);
+    triangles_.resize(k);
     if (has_tri_normal) triangle_normals_.resize(k);
     if (k < old_triangle_num && HasEdgeList()) {
         ComputeEdgeList();
     }
+    InvalidateAdjacency();
     utility::LogDebug(
             "[RemoveDuplicatedTriangles] {:d} triangles have been removed.",
             (int)(old_triangle_num - k));
@@ -976,6 +1173,7 @@ TriangleMesh &TriangleMesh::RemoveUnreferencedVertices() {
             ComputeEdgeList();
         }
     }
+    InvalidateAdjacency();
     utility::LogDebug(
             "[RemoveUnreferencedVertices] {:d} vertices have been removed.",
             (int)(old_vertex_num - k));
@@ -1013,6 +1211,7 @@ TriangleMesh &TriangleMesh::RemoveDegenerateTriangles() {
     if (k < old_triangle_num && HasEdgeList()) {
         ComputeEdgeList();
     }
+    InvalidateAdjacency();
     utility::LogDebug(
             "[RemoveDegenerateTriangles] {:d} triangles have been "
             "removed.",
@@ -1020,22 +1219,141 @@ TriangleMesh &TriangleMesh::RemoveDegenerateTriangles() {
     return *this;
 }
 
+std::tuple<utility::device_vector<int>,
+           utility::device_vector<size_t>,
+           utility::device_vector<float>>
+TriangleMesh::ClusterConnectedTriangles() const {
+    const size_t n = triangles_.size();
+    utility::device_vector<int> labels(n);
+    utility::device_vector<size_t> cluster_n_triangles;
+    utility::device_vector<float> cluster_areas;
+    if (n == 0) {
+        return std::make_tuple(labels, cluster_n_triangles, cluster_areas);
+    }
+    utility::device_vector<unsigned long long> keys(3 * n);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(3 * n), keys.begin(),
+                      triangle_edge_key_functor(
+                              thrust::raw_pointer_cast(triangles_.data())));
+    utility::device_vector<int> edge_triangles(3 * n);
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(3 * n),
+                      edge_triangles.begin(), corner_triangle_functor());
+    utility::device_hash_map<unsigned long long, int> edges(3 * n);
+    edges.insert(keys, edge_triangles);
+    utility::device_vector<int> parents(n);
+    thrust::sequence(parents.begin(), parents.end());
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(3 * n),
+                     union_edge_triangles_functor(
+                             edges, thrust::raw_pointer_cast(keys.data()),
+                             thrust::raw_pointer_cast(parents.data())));
+    utility::device_vector<int> roots(n);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n), roots.begin(),
+                      flatten_triangle_roots_functor(
+                              thrust::raw_pointer_cast(parents.data())));
+    // The labels are consecutive in the order of the roots, the smallest
+    // triangle of each cluster.
+    utility::device_vector<int> ids(n);
+    const int *roots_ptr = thrust::raw_pointer_cast(roots.data());
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(n), ids.begin(),
+                      [roots_ptr] __device__(int idx) {
+                          return (roots_ptr[idx] == idx) ? 1 : 0;
+                      });
+    thrust::exclusive_scan(ids.begin(), ids.end(), ids.begin());
+    thrust::gather(roots.begin(), roots.end(), ids.begin(), labels.begin());
+
+    utility::device_vector<float> areas;
+    GetSurfaceArea(areas);
+    utility::device_vector<int> sorted_labels = labels;
+    thrust::sort_by_key(sorted_labels.begin(), sorted_labels.end(),
+                        areas.begin());
+    const size_t n_clusters = ids.back() + (roots.back() == n - 1);
+    cluster_n_triangles.resize(n_clusters);
+    cluster_areas.resize(n_clusters);
+    thrust::reduce_by_key(
+            sorted_labels.begin(), sorted_labels.end(),
+            make_tuple_iterator(thrust::make_constant_iterator<size_t>(1),
+                                areas.begin()),
+            thrust::make_discard_iterator(),
+            make_tuple_begin(cluster_n_triangles, cluster_areas),
+            thrust::equal_to<int>(), add_tuple_functor<size_t, float>());
+    return std::make_tuple(labels, cluster_n_triangles, cluster_areas);
+}
+
+TriangleMesh &TriangleMesh::RemoveSmallTriangleClusters(
+        size_t min_num_triangles, float min_area) {
+    if (HasTriangleUvs()) {
+        utility::LogWarning(
+                "[RemoveSmallTriangleClusters] This mesh contains triangle "
+                "uvs that are not handled in this function");
+    }
+    const size_t old_triangle_num = triangles_.size();
+    if (old_triangle_num == 0) return *this;
+    auto clusters = ClusterConnectedTriangles();
+    const int *labels = thrust::raw_pointer_cast(std::get<0>(clusters).data());
+    const size_t *n_triangles =
+            thrust::raw_pointer_cast(std::get<1>(clusters).data());
+    const float *areas = thrust::raw_pointer_cast(std::get<2>(clusters).data());
+    utility::device_vector<bool> is_kept(old_triangle_num);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(old_triangle_num),
+                      is_kept.begin(),
+                      [=] __device__(size_t idx) {
+                          const int c = labels[idx];
+                          return n_triangles[c] >= min_num_triangles &&
+                                 areas[c] >= min_area;
+                      });
+    if (!HasTriangleNormals()) {
+        remove_if_vectors(check_ref_functor<bool, Eigen::Vector3i>(), is_kept,
+                          triangles_);
+    } else {
+        remove_if_vectors(
+                check_ref_functor<bool, Eigen::Vector3i, Eigen::Vector3f>(),
+                is_kept, triangles_, triangle_normals_);
+    }
+    const size_t k = triangles_.size();
+    if (k < old_triangle_num && HasEdgeList()) {
+        ComputeEdgeList();
+    }
+    InvalidateAdjacency();
+    utility::LogDebug(
+            "[RemoveSmallTriangleClusters] {:d} triangles have been removed.",
+            (int)(old_triangle_num - k));
+    return *this;
+}
+
 utility::device_vector<Eigen::Vector2i>
 TriangleMesh::GetSelfIntersectingTriangles() const {
-    const size_t n_triangles2 = triangles_.size() * triangles_.size();
-    utility::device_vector<Eigen::Vector2i> self_intersecting_triangles(
-            n_triangles2);
-    check_self_intersecting_triangles func(
-            thrust::raw_pointer_cast(triangles_.data()),
-            thrust::raw_pointer_cast(vertices_.data()), triangles_.size());
+    // The candidate pairs come from a BVH over the triangle bounds instead
+    // of all the triangles^2 pairs, and are counted before being written.
+    utility::device_vector<Eigen::Vector2i> self_intersecting_triangles;
+    if (triangles_.size() < 2) return self_intersecting_triangles;
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
+    AABBTree::AppendBoxes(*this, min_bounds, max_bounds);
+    AABBTree tree;
+    tree.Build(min_bounds, max_bounds);
+    utility::device_vector<int> offsets(triangles_.size() + 1, 0);
+    check_self_intersecting_triangles count_func(
+            tree.GetView(), thrust::raw_pointer_cast(triangles_.data()),
+            thrust::raw_pointer_cast(vertices_.data()), NULL, NULL);
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_triangles2),
-                      self_intersecting_triangles.begin(), func);
-    auto end = thrust::remove_if(
-            self_intersecting_triangles.begin(),
-            self_intersecting_triangles.end(),
-            [] __device__(const Eigen::Vector2i &idxs) { return idxs[0] < 0; });
-    self_intersecting_triangles.resize(
-            thrust::distance(self_intersecting_triangles.begin(), end));
+                      thrust::make_counting_iterator(triangles_.size()),
+                      offsets.begin(), count_func);
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    self_intersecting_triangles.resize(offsets.back());
+    check_self_intersecting_triangles write_func(
+            tree.GetView(), thrust::raw_pointer_cast(triangles_.data()),
+            thrust::raw_pointer_cast(vertices_.data()),
+            thrust::raw_pointer_cast(offsets.data()),
+            thrust::raw_pointer_cast(self_intersecting_triangles.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(triangles_.size()),
+                     write_func);
+    thrust::sort(self_intersecting_triangles.begin(),
+                 self_intersecting_triangles.end());
     return self_intersecting_triangles;
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <Eigen/Geometry>
+#include <tuple>
+#include <vector>
 
 #include "cupoch/geometry/image.h"
 #include "cupoch/geometry/meshbase.h"
@@ -7,6 +9,14 @@
 namespace cupoch {
 namespace geometry {
 
+/// Adjacency in compressed sparse rows: the neighbours of element i are
+/// indices_[offsets_[i], offsets_[i + 1]).
+class CompressedAdjacency {
+public:
+    utility::device_vector<int> offsets_;
+    utility::device_vector<int> indices_;
+};
+
 class TriangleMesh : public MeshBase {
 public:
     TriangleMesh();
@@ -15,20 +25,35 @@ public:
     TriangleMesh(const thrust::host_vector<Eigen::Vector3f> &vertices,
                  const thrust::host_vector<Eigen::Vector3i> &triangles);
     TriangleMesh(const geometry::TriangleMesh &other);
+    /// The moves hand the device buffers over without copying them.
+    TriangleMesh(geometry::TriangleMesh &&other);
     ~TriangleMesh() override;
     TriangleMesh &operator=(const TriangleMesh &other);
+    TriangleMesh &operator=(TriangleMesh &&other);
 
     thrust::host_vector<Eigen::Vector3i> GetTriangles() const;
+    /// The pinned overloads of the getters enqueue the download on \p stream
+    /// and return at once; synchronize the stream before reading the data.
+    void GetTriangles(utility::pinned_host_vector<Eigen::Vector3i> &triangles,
+                      cudaStream_t stream = 0) const;
     void SetTriangles(const thrust::host_vector<Eigen::Vector3i> &triangles);
 
     thrust::host_vector<Eigen::Vector3f> GetTriangleNormals() const;
+    void GetTriangleNormals(
+            utility::pinned_host_vector<Eigen::Vector3f> &triangle_normals,
+            cudaStream_t stream = 0) const;
     void SetTriangleNormals(
             const thrust::host_vector<Eigen::Vector3f> &triangle_normals);
 
     thrust::host_vector<Eigen::Vector2i> GetEdgeList() const;
+    void GetEdgeList(utility::pinned_host_vector<Eigen::Vector2i> &edge_list,
+                     cudaStream_t stream = 0) const;
     void SetEdgeList(const thrust::host_vector<Eigen::Vector2i> &edge_list);
 
     thrust::host_vector<Eigen::Vector2f> GetTriangleUVs() const;
+    void GetTriangleUVs(
+            utility::pinned_host_vector<Eigen::Vector2f> &triangle_uvs,
+            cudaStream_t stream = 0) const;
     void SetTriangleUVs(thrust::host_vector<Eigen::Vector2f> &triangle_uvs);
 
 public:
@@ -64,16 +89,21 @@ public:
     /// Function to compute triangle normals, usually called before rendering
     TriangleMesh &ComputeTriangleNormals(bool normalized = true);
 
-    /// Function to compute vertex normals, usually called before rendering
+    /// Function to compute vertex normals, usually called before rendering.
+    /// Every vertex sums the normals of its triangles in increasing order,
+    /// so the result does not depend on the scheduling.
     TriangleMesh &ComputeVertexNormals(bool normalized = true);
 
     /// \brief Function that removes duplicated verties, i.e., vertices that
-    /// have identical coordinates.
+    /// have identical coordinates. The first occurrence of every vertex is
+    /// kept, in the original order, found through a hash table of the
+    /// vertices.
     TriangleMesh &RemoveDuplicatedVertices();
 
     /// \brief Function that removes duplicated triangles, i.e., removes
-    /// triangles that reference the same three vertices, independent of their
-    /// order.
+    /// triangles that reference the same three vertices up to a rotation of
+    /// their corners, so that the triangles of opposite orientations are
+    /// kept. The first occurrence is kept, in the original order.
     TriangleMesh &RemoveDuplicatedTriangles();
 
     /// \brief This function removes vertices from the triangle mesh that are
@@ -86,6 +116,25 @@ public:
     /// They are usually the product of removing duplicated vertices.
     TriangleMesh &RemoveDegenerateTriangles();
 
+    /// \brief Function that clusters the triangles connected through shared
+    /// edges, joined by a union-find over a hash table of the edges.
+    ///
+    /// Returns the cluster of every triangle, with the clusters numbered
+    /// from 0 in the order of their first triangle, and the number of
+    /// triangles and the surface area of every cluster.
+    std::tuple<utility::device_vector<int>,
+               utility::device_vector<size_t>,
+               utility::device_vector<float>>
+    ClusterConnectedTriangles() const;
+
+    /// \brief Function that removes in one pass the triangles of the
+    /// clusters of ClusterConnectedTriangles() with fewer than
+    /// \p min_num_triangles triangles or an area below \p min_area, e.g. the
+    /// floating fragments of a TSDF extraction. The vertices are kept, see
+    /// RemoveUnreferencedVertices().
+    TriangleMesh &RemoveSmallTriangleClusters(size_t min_num_triangles,
+                                              float min_area = 0.0);
+
     /// \brief Function to sharpen triangle mesh.
     ///
     /// The output value ($v_o$) is the input value ($v_i$) plus strength times
@@ -143,10 +192,43 @@ public:
             float mu = -0.53,
             FilterScope scope = FilterScope::All) const;
 
+    /// \brief Function to simplify the mesh using Quadric Error Metric
+    /// Decimation by Garland and Heckbert.
+    ///
+    /// The edges are collapsed in rounds: every round collapses in parallel
+    /// the edges of smallest cost among those touching their endpoints and
+    /// the neighbours of their endpoints, so that no triangle is changed by
+    /// two collapses. Collapses that flip a triangle are skipped. The vertex
+    /// normals and colors of the collapsed vertices are averaged, the
+    /// triangle uvs are not kept.
+    ///
+    /// \param target_number_of_triangles defines the number of triangles
+    /// that the simplified mesh should have. It is not guaranteed that this
+    /// number will be reached.
+    /// \param maximum_error defines the maximum error where a vertex is
+    /// allowed to be merged.
+    std::shared_ptr<TriangleMesh> SimplifyQuadricDecimation(
+            int target_number_of_triangles,
+            float maximum_error = std::numeric_limits<float>::infinity()) const;
+
     /// Function to compute edge list, call before edge list is
     /// needed
     TriangleMesh &ComputeEdgeList();
 
+    /// Vertex adjacency of the mesh, computed from the edge list or the
+    /// triangles on the first call and cached until the topology is changed
+    /// by a member function. The filters share it with the meshes they
+    /// return.
+    std::shared_ptr<const CompressedAdjacency> GetVertexAdjacency() const;
+
+    /// Triangles of every vertex in increasing order, cached as the vertex
+    /// adjacency.
+    std::shared_ptr<const CompressedAdjacency> GetVertexTriangleAdjacency() const;
+
+    /// Drops the cached adjacencies, to be called after modifying
+    /// triangles_ directly.
+    void InvalidateAdjacency();
+
     /// Function that computes the surface area of the mesh, i.e. the sum of
     /// the individual triangle surfaces.
     float GetSurfaceArea() const;
@@ -171,11 +253,72 @@ public:
     std::shared_ptr<PointCloud> SamplePointsUniformly(
         size_t number_of_points, bool use_triangle_normal = false);
 
+    /// Function to sample \param number_of_points points with a density
+    /// proportional to the area of the triangles times \param
+    /// triangle_weights, e.g. the curvatures of ComputeTriangleCurvatures()
+    /// to sample the details densely. Every point draws its own triangle
+    /// from the cumulative distribution, so exactly number_of_points points
+    /// are returned. \param use_triangle_normal Set to true to assign the
+    /// triangle normals to the returned points instead of the interpolated
+    /// vertex normals.
+    std::shared_ptr<PointCloud> SamplePointsByImportance(
+            size_t number_of_points,
+            const utility::device_vector<float> &triangle_weights,
+            bool use_triangle_normal = false,
+            unsigned int seed = 0) const;
+
+    /// Function to sample \param number_of_points points by the weighted
+    /// sample elimination of Yuksel, "Sample Elimination for Generating
+    /// Poisson Disk Sample Sets", 2015. \param init_factor times
+    /// number_of_points points are sampled uniformly, then the points with
+    /// the closest neighbours, found through a spatial hash of the points,
+    /// are eliminated in parallel rounds until number_of_points remain.
+    std::shared_ptr<PointCloud> SamplePointsPoissonDisk(
+            size_t number_of_points,
+            float init_factor = 5,
+            bool use_triangle_normal = false,
+            unsigned int seed = 0) const;
+
+    /// Function to sample \param number_of_points_per_mesh points uniformly
+    /// from every mesh in one pass, the points of mesh i being at
+    /// [i * number_of_points_per_mesh, (i + 1) * number_of_points_per_mesh).
+    /// The normals and the colors are interpolated when all the meshes have
+    /// them.
+    static std::shared_ptr<PointCloud> SamplePointsUniformlyBatch(
+            const std::vector<std::shared_ptr<const TriangleMesh>> &meshes,
+            size_t number_of_points_per_mesh,
+            bool use_triangle_normal = false,
+            unsigned int seed = 0);
+
+    /// Function that computes a curvature of every triangle, the mean of
+    /// 1 - n_t . n_v over its corners with n_t the triangle normal and n_v
+    /// the area weighted vertex normals. It is 0 on the flat regions.
+    utility::device_vector<float> ComputeTriangleCurvatures() const;
+
     /// Function that returns a list of triangles that are intersecting the
     /// mesh.
     utility::device_vector<Eigen::Vector2i> GetSelfIntersectingTriangles()
             const;
 
+    /// Factory function to create a mesh from an oriented point cloud by
+    /// screened Poisson reconstruction (trianglemesh_poisson.cu). The
+    /// indicator function is solved on a regular grid of 2^depth + 1 nodes
+    /// per axis spanning \p scale times the bounding box, coarse to fine
+    /// from depth - 3 with Jacobi preconditioned conjugate gradients, and
+    /// its level set at the samples is extracted by marching cubes.
+    /// \p point_weight is the screening weight that pulls the surface to
+    /// the samples, 0 for the unscreened reconstruction. Also returns the
+    /// sample density at each vertex, low where the surface was
+    /// extrapolated.
+    static std::tuple<std::shared_ptr<TriangleMesh>,
+                      utility::device_vector<float>>
+    CreateFromPointCloudPoisson(const PointCloud &pcd,
+                                size_t depth = 8,
+                                float scale = 1.1,
+                                float point_weight = 4.0,
+                                int max_iterations = 200,
+                                float tolerance = 1.0e-4);
+
     /// Factory function to create a tetrahedron mesh (trianglemeshfactory.cpp).
     /// the mesh centroid will be at (0,0,0) and \param radius defines the
     /// distance from the center to the mesh vertices.
@@ -285,6 +428,11 @@ public:
     utility::device_vector<Eigen::Vector2i> edge_list_;
     utility::device_vector<Eigen::Vector2f> triangle_uvs_;
     Image texture_;
+
+private:
+    mutable std::shared_ptr<const CompressedAdjacency> vertex_adjacency_;
+    mutable std::shared_ptr<const CompressedAdjacency> vertex_triangle_adjacency_;
+    mutable utility::HostMirror<Eigen::Vector3i> triangles_mirror_;
 };
 
     /// Function that computes the area of a mesh triangle
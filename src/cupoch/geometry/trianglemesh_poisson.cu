@@ -0,0 +1,597 @@
+#include <thrust/binary_search.h>
+#include <thrust/count.h>
+#include <thrust/inner_product.h>
+#include <thrust/remove.h>
+#include <thrust/sort.h>
+#include <thrust/unique.h>
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/integration/marching_cubes_const.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+// Order of the corners of the triangles of tri_table, which are wound for
+// the negative values inside.
+__constant__ int poisson_vert_table[3] = {0, 2, 1};
+
+// Regular grid of the solve: resolution_ nodes along each axis, node
+// (0, 0, 0) at origin_, stored at IndexOf(node, resolution_).
+struct poisson_grid {
+    Eigen::Vector3f origin_;
+    float spacing_;
+    int resolution_;
+    __host__ __device__ int NumNodes() const {
+        return resolution_ * resolution_ * resolution_;
+    }
+    // Lower node of the cell of p and the position of p in the cell.
+    __device__ Eigen::Vector3i CellOf(const Eigen::Vector3f &p,
+                                      Eigen::Vector3f &frac) const {
+        const Eigen::Vector3f g = (p - origin_) / spacing_;
+        Eigen::Vector3i cell;
+        for (int i = 0; i < 3; ++i) {
+            cell[i] = min(max((int)floorf(g[i]), 0), resolution_ - 2);
+            frac[i] = min(max(g[i] - cell[i], 0.0f), 1.0f);
+        }
+        return cell;
+    }
+};
+
+__device__ float TrilinearWeight(const Eigen::Vector3f &frac, int corner) {
+    float w = 1.0;
+    for (int i = 0; i < 3; ++i) {
+        w *= ((corner >> i) & 1) ? frac[i] : 1.0f - frac[i];
+    }
+    return w;
+}
+
+__device__ Eigen::Vector3i GridIndexOf(size_t idx, int resolution) {
+    return Eigen::Vector3i(idx / (resolution * resolution),
+                           (idx / resolution) % resolution, idx % resolution);
+}
+
+__device__ Eigen::Vector3i CornerOffset(int corner) {
+    return Eigen::Vector3i(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+}
+
+// Trilinear interpolation of a node field.
+__device__ float Interpolate(const poisson_grid &grid,
+                             const float *field,
+                             const Eigen::Vector3f &p) {
+    Eigen::Vector3f frac;
+    const Eigen::Vector3i cell = grid.CellOf(p, frac);
+    float v = 0.0;
+    for (int c = 0; c < 8; ++c) {
+        v += TrilinearWeight(frac, c) *
+             field[IndexOf(cell + CornerOffset(c), grid.resolution_)];
+    }
+    return v;
+}
+
+// Splats the normal and the unit weight of each sample on the 8 nodes
+// around it.
+struct splat_samples_functor {
+    splat_samples_functor(const Eigen::Vector3f *points,
+                          const Eigen::Vector3f *normals,
+                          const poisson_grid &grid,
+                          float *field,
+                          float *density)
+        : points_(points),
+          normals_(normals),
+          grid_(grid),
+          field_(field),
+          density_(density){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3f *normals_;
+    const poisson_grid grid_;
+    float *field_;
+    float *density_;
+    __device__ void operator()(size_t idx) const {
+        Eigen::Vector3f frac;
+        const Eigen::Vector3i cell = grid_.CellOf(points_[idx], frac);
+        const Eigen::Vector3f n = normals_[idx].normalized();
+        for (int c = 0; c < 8; ++c) {
+            const float w = TrilinearWeight(frac, c);
+            const int node = IndexOf(cell + CornerOffset(c), grid_.resolution_);
+            for (int i = 0; i < 3; ++i) {
+                atomicAdd(&field_[3 * node + i], w * n[i]);
+            }
+            atomicAdd(&density_[node], w);
+        }
+    }
+};
+
+struct sample_cell_functor {
+    sample_cell_functor(const poisson_grid &grid) : grid_(grid){};
+    const poisson_grid grid_;
+    __device__ int operator()(const Eigen::Vector3f &p) const {
+        Eigen::Vector3f frac;
+        return IndexOf(grid_.CellOf(p, frac), grid_.resolution_);
+    }
+};
+
+// Right hand side of the normal equations of
+// E = sum_edges (x_b - x_a - V_ab)^2 + screening, with V_ab the mean of the
+// field of the two nodes along the edge. The edges leaving the grid are
+// dropped, which gives Neumann boundaries.
+struct divergence_functor {
+    divergence_functor(const float *field, int resolution, float area)
+        : field_(field), resolution_(resolution), area_(area){};
+    const float *field_;
+    const int resolution_;
+    const float area_;
+    __device__ float operator()(size_t idx) const {
+        const Eigen::Vector3i v = GridIndexOf(idx, resolution_);
+        float b = 0.0;
+        for (int i = 0; i < 3; ++i) {
+            const float f = field_[3 * idx + i];
+            Eigen::Vector3i u = v;
+            if (v[i] > 0) {
+                u[i] = v[i] - 1;
+                b += 0.5 * (field_[3 * IndexOf(u, resolution_) + i] + f);
+            }
+            if (v[i] + 1 < resolution_) {
+                u[i] = v[i] + 1;
+                b -= 0.5 * (field_[3 * IndexOf(u, resolution_) + i] + f);
+            }
+        }
+        return area_ * b;
+    }
+};
+
+// y = (L + screening * diag(density)) x, with L the graph Laplacian of the
+// grid.
+struct apply_poisson_functor {
+    apply_poisson_functor(const float *x,
+                          const float *density,
+                          int resolution,
+                          float screening)
+        : x_(x),
+          density_(density),
+          resolution_(resolution),
+          screening_(screening){};
+    const float *x_;
+    const float *density_;
+    const int resolution_;
+    const float screening_;
+    __device__ float operator()(size_t idx) const {
+        const Eigen::Vector3i v = GridIndexOf(idx, resolution_);
+        const float xi = x_[idx];
+        float y = screening_ * density_[idx] * xi;
+        for (int i = 0; i < 3; ++i) {
+            Eigen::Vector3i u = v;
+            if (v[i] > 0) {
+                u[i] = v[i] - 1;
+                y += xi - x_[IndexOf(u, resolution_)];
+            }
+            if (v[i] + 1 < resolution_) {
+                u[i] = v[i] + 1;
+                y += xi - x_[IndexOf(u, resolution_)];
+            }
+        }
+        return y;
+    }
+};
+
+struct poisson_diagonal_functor {
+    poisson_diagonal_functor(const float *density,
+                             int resolution,
+                             float screening)
+        : density_(density), resolution_(resolution), screening_(screening){};
+    const float *density_;
+    const int resolution_;
+    const float screening_;
+    __device__ float operator()(size_t idx) const {
+        const Eigen::Vector3i v = GridIndexOf(idx, resolution_);
+        int degree = 0;
+        for (int i = 0; i < 3; ++i) {
+            degree += (v[i] > 0) + (v[i] + 1 < resolution_);
+        }
+        return degree + screening_ * density_[idx];
+    }
+};
+
+// x = a * x + y
+struct scale_add_functor {
+    scale_add_functor(float a) : a_(a){};
+    const float a_;
+    __device__ float operator()(float x, float y) const { return a_ * x + y; }
+};
+
+struct divides_functor {
+    __device__ float operator()(float x, float d) const {
+        return (d > 0.0f) ? x / d : 0.0f;
+    }
+};
+
+// Trilinear prolongation of the solution of the coarser grid, whose nodes
+// are every second node of the finer one.
+struct prolongate_functor {
+    prolongate_functor(const float *coarse,
+                       int coarse_resolution,
+                       int resolution)
+        : coarse_(coarse),
+          coarse_resolution_(coarse_resolution),
+          resolution_(resolution){};
+    const float *coarse_;
+    const int coarse_resolution_;
+    const int resolution_;
+    __device__ float operator()(size_t idx) const {
+        const Eigen::Vector3i v = GridIndexOf(idx, resolution_);
+        float x = 0.0;
+        const int n = ((v[0] & 1) + 1) * ((v[1] & 1) + 1) * ((v[2] & 1) + 1);
+        for (int c = 0; c < 8; ++c) {
+            const Eigen::Vector3i o = CornerOffset(c);
+            bool used = true;
+            for (int i = 0; i < 3; ++i) used &= o[i] <= (v[i] & 1);
+            if (!used) continue;
+            x += coarse_[IndexOf((v + o) / 2, coarse_resolution_)];
+        }
+        return x / n;
+    }
+};
+
+struct interpolate_functor {
+    interpolate_functor(const poisson_grid &grid, const float *field)
+        : grid_(grid), field_(field){};
+    const poisson_grid grid_;
+    const float *field_;
+    __device__ float operator()(const Eigen::Vector3f &p) const {
+        return Interpolate(grid_, field_, p);
+    }
+};
+
+// Jacobi preconditioned conjugate gradients on the system of
+// apply_poisson_functor, starting from x.
+int SolvePoisson(const poisson_grid &grid,
+                 const utility::device_vector<float> &b,
+                 const utility::device_vector<float> &density,
+                 float screening,
+                 int max_iterations,
+                 float tolerance,
+                 utility::device_vector<float> &x) {
+    const size_t n = grid.NumNodes();
+    utility::device_vector<float> diag(n), r(n), z(n), p(n), Ap(n);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n), diag.begin(),
+                      poisson_diagonal_functor(
+                              thrust::raw_pointer_cast(density.data()),
+                              grid.resolution_, screening));
+    auto apply = [&](const utility::device_vector<float> &in,
+                     utility::device_vector<float> &out) {
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(n), out.begin(),
+                          apply_poisson_functor(
+                                  thrust::raw_pointer_cast(in.data()),
+                                  thrust::raw_pointer_cast(density.data()),
+                                  grid.resolution_, screening));
+    };
+    apply(x, Ap);
+    thrust::transform(b.begin(), b.end(), Ap.begin(), r.begin(),
+                      thrust::minus<float>());
+    thrust::transform(r.begin(), r.end(), diag.begin(), z.begin(),
+                      divides_functor());
+    p = z;
+    float rz = thrust::inner_product(r.begin(), r.end(), z.begin(), 0.0f);
+    const float b_norm2 =
+            thrust::inner_product(b.begin(), b.end(), b.begin(), 0.0f);
+    const float threshold = tolerance * tolerance * b_norm2;
+    int iter = 0;
+    for (; iter < max_iterations; ++iter) {
+        const float r_norm2 =
+                thrust::inner_product(r.begin(), r.end(), r.begin(), 0.0f);
+        if (r_norm2 <= threshold || rz <= 0.0f) break;
+        apply(p, Ap);
+        const float alpha = rz / thrust::inner_product(p.begin(), p.end(),
+                                                       Ap.begin(), 0.0f);
+        thrust::transform(p.begin(), p.end(), x.begin(), x.begin(),
+                          scale_add_functor(alpha));
+        thrust::transform(Ap.begin(), Ap.end(), r.begin(), r.begin(),
+                          scale_add_functor(-alpha));
+        thrust::transform(r.begin(), r.end(), diag.begin(), z.begin(),
+                          divides_functor());
+        const float rz_new =
+                thrust::inner_product(r.begin(), r.end(), z.begin(), 0.0f);
+        thrust::transform(p.begin(), p.end(), z.begin(), p.begin(),
+                          scale_add_functor(rz_new / rz));
+        rz = rz_new;
+    }
+    return iter;
+}
+
+// Marching cubes index of each cell, -1 for the cells the surface does not
+// cross. The negative values are inside.
+struct poisson_cube_index_functor {
+    poisson_cube_index_functor(const float *f, int resolution)
+        : f_(f), resolution_(resolution){};
+    const float *f_;
+    const int resolution_;
+    __device__ int operator()(const Eigen::Vector3i &key) const {
+        int cube_index = 0;
+        for (int i = 0; i < 8; ++i) {
+            const Eigen::Vector3i v = key + Eigen::Vector3i(shift[i][0],
+                                                            shift[i][1],
+                                                            shift[i][2]);
+            if (f_[IndexOf(v, resolution_)] < 0.0f) cube_index |= (1 << i);
+        }
+        return (cube_index == 0 || cube_index == 255) ? -1 : cube_index;
+    }
+};
+
+struct cell_key_functor {
+    cell_key_functor(int resolution) : resolution_(resolution){};
+    const int resolution_;
+    __device__ Eigen::Vector3i operator()(size_t idx) const {
+        const int r = resolution_ - 1;
+        return Eigen::Vector3i(idx / (r * r), (idx / r) % r, idx % r);
+    }
+};
+
+struct is_crossed_cube_functor {
+    __device__ bool operator()(
+            const thrust::tuple<Eigen::Vector3i, int> &x) const {
+        return thrust::get<1>(x) >= 0;
+    }
+};
+
+__device__ int PoissonEdgeIdOf(const Eigen::Vector3i &key,
+                               int edge,
+                               int resolution) {
+    const Eigen::Vector3i v =
+            key + Eigen::Vector3i(edge_shift[edge][0], edge_shift[edge][1],
+                                  edge_shift[edge][2]);
+    return IndexOf(v, resolution) * 3 + edge_shift[edge][3];
+}
+
+struct mark_poisson_edges_functor {
+    mark_poisson_edges_functor(const Eigen::Vector3i *keys,
+                               const int *cube_indices,
+                               int resolution,
+                               uint8_t *edge_flags)
+        : keys_(keys),
+          cube_indices_(cube_indices),
+          resolution_(resolution),
+          edge_flags_(edge_flags){};
+    const Eigen::Vector3i *keys_;
+    const int *cube_indices_;
+    const int resolution_;
+    uint8_t *edge_flags_;
+    __device__ void operator()(size_t idx) const {
+        const int j = idx / 12;
+        const int i = idx % 12;
+        if (edge_table[cube_indices_[j]] & (1 << i)) {
+            edge_flags_[PoissonEdgeIdOf(keys_[j], i, resolution_)] = 1;
+        }
+    }
+};
+
+struct poisson_edge_vertex_functor {
+    poisson_edge_vertex_functor(const float *f, const poisson_grid &grid)
+        : f_(f), grid_(grid){};
+    const float *f_;
+    const poisson_grid grid_;
+    __device__ Eigen::Vector3f operator()(int edge_id) const {
+        const int axis = edge_id % 3;
+        const Eigen::Vector3i v0 = GridIndexOf(edge_id / 3, grid_.resolution_);
+        Eigen::Vector3i v1 = v0;
+        v1(axis) += 1;
+        const float f0 = abs(f_[IndexOf(v0, grid_.resolution_)]);
+        const float f1 = abs(f_[IndexOf(v1, grid_.resolution_)]);
+        Eigen::Vector3f pt = v0.cast<float>();
+        pt(axis) += f0 / (f0 + f1);
+        return grid_.origin_ + pt * grid_.spacing_;
+    }
+};
+
+struct poisson_triangles_functor {
+    poisson_triangles_functor(const Eigen::Vector3i *keys,
+                              const int *cube_indices,
+                              const int *edge_ids,
+                              int n_edges,
+                              int resolution,
+                              Eigen::Vector3i *triangles)
+        : keys_(keys),
+          cube_indices_(cube_indices),
+          edge_ids_(edge_ids),
+          n_edges_(n_edges),
+          resolution_(resolution),
+          triangles_(triangles){};
+    const Eigen::Vector3i *keys_;
+    const int *cube_indices_;
+    const int *edge_ids_;
+    const int n_edges_;
+    const int resolution_;
+    Eigen::Vector3i *triangles_;
+    __device__ void operator()(size_t j) const {
+        const int cube_index = cube_indices_[j];
+        for (int i = 0; tri_table[cube_index][i] != -1; ++i) {
+            const int e = PoissonEdgeIdOf(keys_[j], tri_table[cube_index][i],
+                                          resolution_);
+            const int *it = thrust::lower_bound(thrust::seq, edge_ids_,
+                                                edge_ids_ + n_edges_, e);
+            triangles_[j * 5 + i / 3][poisson_vert_table[i % 3]] =
+                    it - edge_ids_;
+        }
+    }
+};
+
+// Splats the samples on the grid and builds the right hand side and the
+// screening density of its system.
+void BuildPoissonSystem(const PointCloud &pcd,
+                        const poisson_grid &grid,
+                        utility::device_vector<float> &b,
+                        utility::device_vector<float> &density) {
+    const size_t n_nodes = grid.NumNodes();
+    const size_t n_points = pcd.points_.size();
+    utility::device_vector<float> field(3 * n_nodes, 0.0f);
+    density.resize(n_nodes);
+    thrust::fill(density.begin(), density.end(), 0.0f);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_points),
+                     splat_samples_functor(
+                             thrust::raw_pointer_cast(pcd.points_.data()),
+                             thrust::raw_pointer_cast(pcd.normals_.data()),
+                             grid, thrust::raw_pointer_cast(field.data()),
+                             thrust::raw_pointer_cast(density.data())));
+    // Surface area per sample in cells, from the number of cells holding
+    // samples, which turns the sums of the splats into densities.
+    utility::device_vector<int> cells(n_points);
+    thrust::transform(pcd.points_.begin(), pcd.points_.end(), cells.begin(),
+                      sample_cell_functor(grid));
+    thrust::sort(cells.begin(), cells.end());
+    const size_t n_cells = thrust::distance(
+            cells.begin(), thrust::unique(cells.begin(), cells.end()));
+    const float area = (float)n_cells / n_points;
+    b.resize(n_nodes);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_nodes), b.begin(),
+                      divergence_functor(thrust::raw_pointer_cast(field.data()),
+                                         grid.resolution_, area));
+    thrust::transform(density.begin(), density.end(), density.begin(),
+                      [area] __device__(float d) { return area * d; });
+}
+
+}  // namespace
+
+std::tuple<std::shared_ptr<TriangleMesh>, utility::device_vector<float>>
+TriangleMesh::CreateFromPointCloudPoisson(const PointCloud &pcd,
+                                          size_t depth,
+                                          float scale,
+                                          float point_weight,
+                                          int max_iterations,
+                                          float tolerance) {
+    CUPOCH_PROFILE("TriangleMesh::CreateFromPointCloudPoisson");
+    auto mesh = std::make_shared<TriangleMesh>();
+    utility::device_vector<float> densities;
+    if (!pcd.HasNormals()) {
+        utility::LogError("[CreateFromPointCloudPoisson] pcd has no normals");
+        return std::make_tuple(mesh, densities);
+    }
+    if (pcd.IsEmpty() || depth < 2 || depth > 9) {
+        utility::LogWarning(
+                "[CreateFromPointCloudPoisson] an empty point cloud or a "
+                "depth out of [2, 9] is given.");
+        return std::make_tuple(mesh, densities);
+    }
+    const AxisAlignedBoundingBox bbox = pcd.GetAxisAlignedBoundingBox();
+    const float size = std::max(bbox.GetMaxExtent(), 1.0e-6f) * scale;
+    const Eigen::Vector3f origin =
+            bbox.GetCenter() - Eigen::Vector3f::Constant(0.5 * size);
+
+    // Cascadic multigrid: each level starts from the prolongated solution
+    // of the coarser one, so the fine levels only need a few iterations.
+    poisson_grid grid;
+    utility::device_vector<float> x, b, density;
+    const int min_depth = std::max((int)depth - 3, 2);
+    for (int d = min_depth; d <= (int)depth; ++d) {
+        const int resolution = (1 << d) + 1;
+        grid.origin_ = origin;
+        grid.spacing_ = size / (resolution - 1);
+        grid.resolution_ = resolution;
+        utility::device_vector<float> x_init(grid.NumNodes(), 0.0f);
+        if (d > min_depth) {
+            thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                              thrust::make_counting_iterator<size_t>(
+                                      grid.NumNodes()),
+                              x_init.begin(),
+                              prolongate_functor(
+                                      thrust::raw_pointer_cast(x.data()),
+                                      (resolution + 1) / 2, resolution));
+        }
+        x.swap(x_init);
+        BuildPoissonSystem(pcd, grid, b, density);
+        const int n_iter = SolvePoisson(grid, b, density, point_weight,
+                                        max_iterations, tolerance, x);
+        utility::LogDebug(
+                "[CreateFromPointCloudPoisson] depth {:d}: {:d} iterations",
+                d, n_iter);
+    }
+    b.clear();
+    b.shrink_to_fit();
+
+    // The surface is the level set of the mean value at the samples.
+    const float iso_value =
+            thrust::transform_reduce(
+                    pcd.points_.begin(), pcd.points_.end(),
+                    interpolate_functor(grid,
+                                        thrust::raw_pointer_cast(x.data())),
+                    0.0f, thrust::plus<float>()) /
+            pcd.points_.size();
+    thrust::transform(
+            x.begin(), x.end(), x.begin(),
+            [iso_value] __device__(float v) { return v - iso_value; });
+
+    // Marching cubes with the vertices shared through the edge ids, as in
+    // integration::UniformTSDFVolume::ExtractTriangleMesh().
+    const int res = grid.resolution_;
+    const size_t n_cubes_all = (size_t)(res - 1) * (res - 1) * (res - 1);
+    utility::device_vector<Eigen::Vector3i> keys(n_cubes_all);
+    utility::device_vector<int> cube_indices(n_cubes_all);
+    poisson_cube_index_functor cube_func(thrust::raw_pointer_cast(x.data()),
+                                         res);
+    auto key_begin = thrust::make_transform_iterator(
+            thrust::make_counting_iterator<size_t>(0), cell_key_functor(res));
+    auto end_c = thrust::copy_if(
+            thrust::make_zip_iterator(thrust::make_tuple(
+                    key_begin, thrust::make_transform_iterator(key_begin,
+                                                               cube_func))),
+            thrust::make_zip_iterator(thrust::make_tuple(
+                    key_begin + n_cubes_all,
+                    thrust::make_transform_iterator(key_begin + n_cubes_all,
+                                                    cube_func))),
+            make_tuple_begin(keys, cube_indices), is_crossed_cube_functor());
+    const size_t n_cubes =
+            thrust::distance(make_tuple_begin(keys, cube_indices), end_c);
+    resize_all(n_cubes, keys, cube_indices);
+
+    const size_t n_edge_slots = (size_t)grid.NumNodes() * 3;
+    utility::device_vector<uint8_t> edge_flags(n_edge_slots, 0);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_cubes * 12),
+                     mark_poisson_edges_functor(
+                             thrust::raw_pointer_cast(keys.data()),
+                             thrust::raw_pointer_cast(cube_indices.data()),
+                             res, thrust::raw_pointer_cast(edge_flags.data())));
+    const size_t n_vertices =
+            thrust::count(edge_flags.begin(), edge_flags.end(), 1);
+    utility::device_vector<int> edge_ids(n_vertices);
+    thrust::copy_if(thrust::make_counting_iterator(0),
+                    thrust::make_counting_iterator((int)n_edge_slots),
+                    edge_flags.begin(), edge_ids.begin(),
+                    thrust::identity<uint8_t>());
+    edge_flags.clear();
+    edge_flags.shrink_to_fit();
+
+    mesh->vertices_.resize(n_vertices);
+    thrust::transform(edge_ids.begin(), edge_ids.end(), mesh->vertices_.begin(),
+                      poisson_edge_vertex_functor(
+                              thrust::raw_pointer_cast(x.data()), grid));
+    mesh->triangles_.resize(n_cubes * 5, Eigen::Vector3i(-1, -1, -1));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_cubes),
+                     poisson_triangles_functor(
+                             thrust::raw_pointer_cast(keys.data()),
+                             thrust::raw_pointer_cast(cube_indices.data()),
+                             thrust::raw_pointer_cast(edge_ids.data()),
+                             n_vertices, res,
+                             thrust::raw_pointer_cast(
+                                     mesh->triangles_.data())));
+    auto end_t = thrust::remove_if(
+            mesh->triangles_.begin(), mesh->triangles_.end(),
+            [] __device__(const Eigen::Vector3i &t) { return t[0] < 0; });
+    mesh->triangles_.resize(thrust::distance(mesh->triangles_.begin(), end_t));
+
+    densities.resize(n_vertices);
+    thrust::transform(mesh->vertices_.begin(), mesh->vertices_.end(),
+                      densities.begin(),
+                      interpolate_functor(
+                              grid, thrust::raw_pointer_cast(density.data())));
+    return std::make_tuple(mesh, densities);
+}
@@ -0,0 +1,386 @@
+#include <thrust/binary_search.h>
+#include <thrust/execution_policy.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/random.h>
+#include <thrust/scatter.h>
+#include <thrust/sort.h>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+__device__ unsigned int HashSeed(unsigned int seed, unsigned int idx) {
+    unsigned int h = seed ^ (idx * 0x9e3779b9u);
+    h = (h ^ 61) ^ (h >> 16);
+    h *= 9;
+    h = h ^ (h >> 4);
+    h *= 0x27d4eb2d;
+    return h ^ (h >> 15);
+}
+
+/// Area times weight of every triangle.
+struct weighted_area_functor {
+    weighted_area_functor(const Eigen::Vector3f *vertices, const Eigen::Vector3i *triangles,
+                          const float *weights)
+                          : vertices_(vertices), triangles_(triangles), weights_(weights) {};
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3i *triangles_;
+    const float *weights_;
+    __device__ float operator() (size_t idx) const {
+        const float area = GetTriangleArea(vertices_, triangles_, idx);
+        return (weights_) ? area * fmaxf(weights_[idx], 0.0f) : area;
+    }
+};
+
+/// Every point draws its triangle from the cumulative weights of the
+/// triangles of its mesh, the triangles of mesh b being
+/// [triangle_offsets_[b], triangle_offsets_[b + 1]), and its barycentric
+/// coordinates, from its own random sequence.
+struct sample_points_by_cdf_functor {
+    sample_points_by_cdf_functor(const Eigen::Vector3f *vertices, const Eigen::Vector3f *vertex_normals,
+                                 const Eigen::Vector3f *vertex_colors, const Eigen::Vector3i *triangles,
+                                 const float *cdf, const int *triangle_offsets,
+                                 size_t n_points_per_mesh, unsigned int seed, bool use_triangle_normal,
+                                 Eigen::Vector3f *points, Eigen::Vector3f *normals, Eigen::Vector3f *colors)
+                                 : vertices_(vertices), vertex_normals_(vertex_normals),
+                                 vertex_colors_(vertex_colors), triangles_(triangles), cdf_(cdf),
+                                 triangle_offsets_(triangle_offsets), n_points_per_mesh_(n_points_per_mesh),
+                                 seed_(seed), use_triangle_normal_(use_triangle_normal),
+                                 points_(points), normals_(normals), colors_(colors) {};
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3f *vertex_normals_;
+    const Eigen::Vector3f *vertex_colors_;
+    const Eigen::Vector3i *triangles_;
+    const float *cdf_;
+    const int *triangle_offsets_;
+    const size_t n_points_per_mesh_;
+    const unsigned int seed_;
+    const bool use_triangle_normal_;
+    Eigen::Vector3f *points_;
+    Eigen::Vector3f *normals_;
+    Eigen::Vector3f *colors_;
+    __device__ void operator() (size_t idx) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        thrust::uniform_real_distribution<float> dist(0.0, 1.0);
+        const int b = idx / n_points_per_mesh_;
+        const int begin = triangle_offsets_[b];
+        const int end = triangle_offsets_[b + 1];
+        const float u = dist(rng) * cdf_[end - 1];
+        const int t = min((int)(thrust::upper_bound(thrust::seq, cdf_ + begin, cdf_ + end, u) - cdf_), end - 1);
+        const float r1 = sqrtf(dist(rng));
+        const float r2 = dist(rng);
+        const float a = 1 - r1;
+        const float bc = r1 * (1 - r2);
+        const float c = r1 * r2;
+        const Eigen::Vector3i &triangle = triangles_[t];
+        const Eigen::Vector3f &p0 = vertices_[triangle(0)];
+        const Eigen::Vector3f &p1 = vertices_[triangle(1)];
+        const Eigen::Vector3f &p2 = vertices_[triangle(2)];
+        points_[idx] = a * p0 + bc * p1 + c * p2;
+        if (use_triangle_normal_) {
+            normals_[idx] = (p1 - p0).cross(p2 - p0).normalized();
+        } else if (vertex_normals_) {
+            normals_[idx] = a * vertex_normals_[triangle(0)] +
+                            bc * vertex_normals_[triangle(1)] +
+                            c * vertex_normals_[triangle(2)];
+        }
+        if (vertex_colors_) {
+            colors_[idx] = a * vertex_colors_[triangle(0)] +
+                           bc * vertex_colors_[triangle(1)] +
+                           c * vertex_colors_[triangle(2)];
+        }
+    }
+};
+
+/// Samples \p n_points_per_mesh points on every mesh of the concatenated
+/// triangles, with the cumulative weights \p cdf of every mesh.
+std::shared_ptr<PointCloud> SamplePointsByCdf(
+        const utility::device_vector<Eigen::Vector3f> &vertices,
+        const utility::device_vector<Eigen::Vector3f> &vertex_normals,
+        const utility::device_vector<Eigen::Vector3f> &vertex_colors,
+        const utility::device_vector<Eigen::Vector3i> &triangles,
+        const utility::device_vector<float> &cdf,
+        const utility::device_vector<int> &triangle_offsets,
+        size_t n_points_per_mesh, bool use_triangle_normal, unsigned int seed) {
+    const size_t n_meshes = triangle_offsets.size() - 1;
+    const size_t n_points = n_meshes * n_points_per_mesh;
+    const bool has_vert_normal = vertex_normals.size() == vertices.size();
+    const bool has_vert_color = vertex_colors.size() == vertices.size();
+    auto pcd = std::make_shared<PointCloud>();
+    pcd->points_.resize(n_points);
+    if (has_vert_normal || use_triangle_normal) pcd->normals_.resize(n_points);
+    if (has_vert_color) pcd->colors_.resize(n_points);
+    sample_points_by_cdf_functor func(thrust::raw_pointer_cast(vertices.data()),
+                                      has_vert_normal ? thrust::raw_pointer_cast(vertex_normals.data()) : NULL,
+                                      has_vert_color ? thrust::raw_pointer_cast(vertex_colors.data()) : NULL,
+                                      thrust::raw_pointer_cast(triangles.data()),
+                                      thrust::raw_pointer_cast(cdf.data()),
+                                      thrust::raw_pointer_cast(triangle_offsets.data()),
+                                      n_points_per_mesh, seed, use_triangle_normal,
+                                      thrust::raw_pointer_cast(pcd->points_.data()),
+                                      thrust::raw_pointer_cast(pcd->normals_.data()),
+                                      thrust::raw_pointer_cast(pcd->colors_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_points), func);
+    return pcd;
+}
+
+struct cell_key_functor {
+    cell_key_functor(float cell_size) : cell_size_(cell_size) {};
+    const float cell_size_;
+    __device__ unsigned long long operator() (const Eigen::Vector3f &p) const {
+        return PackCellKey(Eigen::Vector3i(floorf(p[0] / cell_size_), floorf(p[1] / cell_size_),
+                                           floorf(p[2] / cell_size_)));
+    }
+};
+
+/// Elimination weights of Yuksel, sum over the neighbours closer than
+/// d_max of (1 - d / d_max)^8, and whether the point has the largest
+/// (weight, index) among its neighbours. The neighbours are found in the
+/// 27 cells of size d_max around the point, the points being sorted by
+/// cell key.
+struct elimination_functor {
+    elimination_functor(const Eigen::Vector3f *points, const unsigned long long *sorted_keys,
+                        const int *sorted_indices, int n_points, float d_max,
+                        const float *weights)
+                        : points_(points), sorted_keys_(sorted_keys), sorted_indices_(sorted_indices),
+                        n_points_(n_points), d_max_(d_max), weights_(weights) {};
+    const Eigen::Vector3f *points_;
+    const unsigned long long *sorted_keys_;
+    const int *sorted_indices_;
+    const int n_points_;
+    const float d_max_;
+    const float *weights_;  // NULL to compute the weights
+
+    __device__ float Weight(int i) const {
+        const Eigen::Vector3f &p = points_[i];
+        const Eigen::Vector3i c(floorf(p[0] / d_max_), floorf(p[1] / d_max_), floorf(p[2] / d_max_));
+        float w = 0.0f;
+        bool is_max = true;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const unsigned long long key = PackCellKey(c + Eigen::Vector3i(dx, dy, dz));
+                    if (key == kEmptyCellKey) continue;
+                    for (int k = thrust::lower_bound(thrust::seq, sorted_keys_, sorted_keys_ + n_points_, key) - sorted_keys_;
+                         k < n_points_ && sorted_keys_[k] == key; ++k) {
+                        const int j = sorted_indices_[k];
+                        if (j == i) continue;
+                        const float d = (points_[j] - p).norm();
+                        if (d >= d_max_) continue;
+                        if (weights_) {
+                            if (weights_[j] > weights_[i] || (weights_[j] == weights_[i] && j > i)) {
+                                is_max = false;
+                            }
+                        } else {
+                            const float x = 1.0f - d / d_max_;
+                            const float x2 = x * x;
+                            const float x4 = x2 * x2;
+                            w += x4 * x4;
+                        }
+                    }
+                }
+            }
+        }
+        return (weights_) ? (is_max ? 1.0f : 0.0f) : w;
+    }
+
+    __device__ float operator() (int i) const { return Weight(i); }
+};
+
+struct is_positive_functor {
+    __device__ bool operator() (float x) const { return x > 0.0f; }
+};
+
+}  // namespace
+
+std::shared_ptr<PointCloud> TriangleMesh::SamplePointsByImportance(
+        size_t number_of_points,
+        const utility::device_vector<float> &triangle_weights,
+        bool use_triangle_normal, unsigned int seed) const {
+    if (number_of_points <= 0) {
+        utility::LogError("[SamplePointsByImportance] number_of_points <= 0");
+        return std::make_shared<PointCloud>();
+    }
+    if (triangles_.size() == 0) {
+        utility::LogError("[SamplePointsByImportance] input mesh has no triangles");
+        return std::make_shared<PointCloud>();
+    }
+    if (!triangle_weights.empty() && triangle_weights.size() != triangles_.size()) {
+        utility::LogError("[SamplePointsByImportance] The number of weights {} is different from the number of triangles {}.",
+                          triangle_weights.size(), triangles_.size());
+        return std::make_shared<PointCloud>();
+    }
+    utility::device_vector<float> cdf(triangles_.size());
+    weighted_area_functor func(thrust::raw_pointer_cast(vertices_.data()),
+                               thrust::raw_pointer_cast(triangles_.data()),
+                               triangle_weights.empty() ? NULL : thrust::raw_pointer_cast(triangle_weights.data()));
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(triangles_.size()),
+                      cdf.begin(), func);
+    thrust::inclusive_scan(cdf.begin(), cdf.end(), cdf.begin());
+    if (cdf.back() <= 0.0f) {
+        utility::LogError("[SamplePointsByImportance] The total weight of the triangles is not positive.");
+        return std::make_shared<PointCloud>();
+    }
+    utility::device_vector<int> triangle_offsets(2, 0);
+    triangle_offsets[1] = triangles_.size();
+    return SamplePointsByCdf(vertices_, vertex_normals_, vertex_colors_, triangles_, cdf,
+                             triangle_offsets, number_of_points, use_triangle_normal, seed);
+}
+
+std::shared_ptr<PointCloud> TriangleMesh::SamplePointsPoissonDisk(
+        size_t number_of_points, float init_factor,
+        bool use_triangle_normal, unsigned int seed) const {
+    if (number_of_points <= 0) {
+        utility::LogError("[SamplePointsPoissonDisk] number_of_points <= 0");
+        return std::make_shared<PointCloud>();
+    }
+    if (init_factor < 1) {
+        utility::LogError("[SamplePointsPoissonDisk] init_factor must be at least 1");
+        return std::make_shared<PointCloud>();
+    }
+    const size_t n_init = (size_t)(init_factor * number_of_points);
+    auto samples = SamplePointsByImportance(n_init, utility::device_vector<float>(),
+                                            use_triangle_normal, seed);
+    if (samples->points_.size() <= number_of_points) return samples;
+
+    // Maximum Poisson disk radius of number_of_points points on the
+    // surface, the weights vanishing at twice this radius.
+    const float d_max = 2.0f * std::sqrt(GetSurfaceArea() / (2.0f * std::sqrt(3.0f) * number_of_points));
+    utility::device_vector<Eigen::Vector3f> points = samples->points_;
+    utility::device_vector<size_t> ids(n_init);
+    thrust::sequence(ids.begin(), ids.end());
+    utility::device_vector<unsigned long long> keys;
+    utility::device_vector<int> sorted_indices;
+    utility::device_vector<float> weights;
+    utility::device_vector<float> is_max;
+    utility::device_vector<int> candidates;
+    while (points.size() > number_of_points) {
+        const int n = points.size();
+        resize_all(n, keys, sorted_indices, weights, is_max, candidates);
+        thrust::transform(points.begin(), points.end(), keys.begin(), cell_key_functor(d_max));
+        thrust::sequence(sorted_indices.begin(), sorted_indices.end());
+        thrust::sort_by_key(keys.begin(), keys.end(), sorted_indices.begin());
+        const Eigen::Vector3f *points_ptr = thrust::raw_pointer_cast(points.data());
+        elimination_functor weight_func(points_ptr, thrust::raw_pointer_cast(keys.data()),
+                                        thrust::raw_pointer_cast(sorted_indices.data()), n, d_max, NULL);
+        thrust::transform(thrust::make_counting_iterator<int>(0),
+                          thrust::make_counting_iterator<int>(n), weights.begin(), weight_func);
+        // The local maxima of the weights are eliminated together, as the
+        // weights of the other points only decrease by their elimination.
+        elimination_functor max_func(points_ptr, thrust::raw_pointer_cast(keys.data()),
+                                     thrust::raw_pointer_cast(sorted_indices.data()), n, d_max,
+                                     thrust::raw_pointer_cast(weights.data()));
+        thrust::transform(thrust::make_counting_iterator<int>(0),
+                          thrust::make_counting_iterator<int>(n), is_max.begin(), max_func);
+        auto end = thrust::copy_if(thrust::make_counting_iterator<int>(0),
+                                   thrust::make_counting_iterator<int>(n),
+                                   is_max.begin(), candidates.begin(), is_positive_functor());
+        size_t n_candidates = thrust::distance(candidates.begin(), end);
+        const size_t n_remove = std::min(n_candidates, points.size() - number_of_points);
+        if (n_candidates > n_remove) {
+            utility::device_vector<float> candidate_weights(n_candidates);
+            thrust::gather(candidates.begin(), end, weights.begin(), candidate_weights.begin());
+            thrust::sort_by_key(candidate_weights.begin(), candidate_weights.end(),
+                                candidates.begin(), thrust::greater<float>());
+        }
+        thrust::fill(is_max.begin(), is_max.end(), 0.0f);
+        thrust::scatter(thrust::make_constant_iterator(1.0f), thrust::make_constant_iterator(1.0f) + n_remove,
+                        candidates.begin(), is_max.begin());
+        remove_if_vectors([] __device__ (const thrust::tuple<float, Eigen::Vector3f, size_t> &x) {
+                              return thrust::get<0>(x) > 0.0f;
+                          }, is_max, points, ids);
+    }
+    return samples->SelectByIndex(ids);
+}
+
+std::shared_ptr<PointCloud> TriangleMesh::SamplePointsUniformlyBatch(
+        const std::vector<std::shared_ptr<const TriangleMesh>> &meshes,
+        size_t number_of_points_per_mesh, bool use_triangle_normal, unsigned int seed) {
+    if (meshes.empty() || number_of_points_per_mesh <= 0) {
+        return std::make_shared<PointCloud>();
+    }
+    size_t n_vertices = 0;
+    size_t n_triangles = 0;
+    bool has_vert_normal = true;
+    bool has_vert_color = true;
+    for (const auto &mesh : meshes) {
+        if (!mesh || mesh->triangles_.empty()) {
+            utility::LogError("[SamplePointsUniformlyBatch] input mesh has no triangles");
+            return std::make_shared<PointCloud>();
+        }
+        n_vertices += mesh->vertices_.size();
+        n_triangles += mesh->triangles_.size();
+        has_vert_normal &= mesh->HasVertexNormals();
+        has_vert_color &= mesh->HasVertexColors();
+    }
+    // Concatenation of the meshes, the cumulative areas restarting at every
+    // mesh.
+    utility::device_vector<Eigen::Vector3f> vertices(n_vertices);
+    utility::device_vector<Eigen::Vector3f> vertex_normals(has_vert_normal ? n_vertices : 0);
+    utility::device_vector<Eigen::Vector3f> vertex_colors(has_vert_color ? n_vertices : 0);
+    utility::device_vector<Eigen::Vector3i> triangles(n_triangles);
+    utility::device_vector<float> cdf(n_triangles);
+    thrust::host_vector<int> triangle_offsets(meshes.size() + 1, 0);
+    size_t v_offset = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const TriangleMesh &mesh = *meshes[i];
+        const int t_offset = triangle_offsets[i];
+        thrust::copy(mesh.vertices_.begin(), mesh.vertices_.end(), vertices.begin() + v_offset);
+        if (has_vert_normal) {
+            thrust::copy(mesh.vertex_normals_.begin(), mesh.vertex_normals_.end(),
+                         vertex_normals.begin() + v_offset);
+        }
+        if (has_vert_color) {
+            thrust::copy(mesh.vertex_colors_.begin(), mesh.vertex_colors_.end(),
+                         vertex_colors.begin() + v_offset);
+        }
+        const Eigen::Vector3i shift = Eigen::Vector3i::Constant((int)v_offset);
+        thrust::transform(mesh.triangles_.begin(), mesh.triangles_.end(),
+                          triangles.begin() + t_offset,
+                          [shift] __device__ (const Eigen::Vector3i &tri) { return tri + shift; });
+        weighted_area_functor func(thrust::raw_pointer_cast(mesh.vertices_.data()),
+                                   thrust::raw_pointer_cast(mesh.triangles_.data()), NULL);
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(mesh.triangles_.size()),
+                          cdf.begin() + t_offset, func);
+        v_offset += mesh.vertices_.size();
+        triangle_offsets[i + 1] = t_offset + mesh.triangles_.size();
+    }
+    utility::device_vector<int> d_triangle_offsets = triangle_offsets;
+    utility::device_vector<int> mesh_ids(n_triangles);
+    thrust::upper_bound(d_triangle_offsets.begin() + 1, d_triangle_offsets.end(),
+                        thrust::make_counting_iterator<int>(0),
+                        thrust::make_counting_iterator<int>(n_triangles),
+                        mesh_ids.begin());
+    thrust::inclusive_scan_by_key(mesh_ids.begin(), mesh_ids.end(), cdf.begin(), cdf.begin());
+    return SamplePointsByCdf(vertices, vertex_normals, vertex_colors, triangles, cdf,
+                             d_triangle_offsets, number_of_points_per_mesh,
+                             use_triangle_normal, seed);
+}
+
+utility::device_vector<float> TriangleMesh::ComputeTriangleCurvatures() const {
+    TriangleMesh mesh(vertices_, triangles_);
+    mesh.ComputeVertexNormals();
+    utility::device_vector<float> curvatures(triangles_.size());
+    const Eigen::Vector3f *vn_ptr = thrust::raw_pointer_cast(mesh.vertex_normals_.data());
+    thrust::transform(make_tuple_begin(mesh.triangles_, mesh.triangle_normals_),
+                      make_tuple_end(mesh.triangles_, mesh.triangle_normals_),
+                      curvatures.begin(),
+                      [vn_ptr] __device__ (const thrust::tuple<Eigen::Vector3i, Eigen::Vector3f> &x) {
+                          const Eigen::Vector3i &tri = thrust::get<0>(x);
+                          const Eigen::Vector3f &n = thrust::get<1>(x);
+                          float c = 0.0f;
+                          for (int j = 0; j < 3; ++j) c += 1.0f - n.dot(vn_ptr[tri[j]]);
+                          return c / 3.0f;
+                      });
+    return curvatures;
+}
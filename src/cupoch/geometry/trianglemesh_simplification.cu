@@ -0,0 +1,389 @@
+#include <thrust/binary_search.h>
+#include <thrust/gather.h>
+#include <thrust/sort.h>
+#include <thrust/unique.h>
+
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+/// Symmetric 4x4 quadric stored as its 10 upper triangular coefficients
+/// (a2, ab, ac, ad, b2, bc, bd, c2, cd, d2).
+constexpr int kQuadricSize = 10;
+constexpr unsigned long long kInvalidEdgeKey = ~0ull;
+
+__device__ float EvaluateQuadric(const float* q, const Eigen::Vector3f& v) {
+    const float x = v[0], y = v[1], z = v[2];
+    return q[0] * x * x + 2.0f * q[1] * x * y + 2.0f * q[2] * x * z + 2.0f * q[3] * x +
+           q[4] * y * y + 2.0f * q[5] * y * z + 2.0f * q[6] * y +
+           q[7] * z * z + 2.0f * q[8] * z + q[9];
+}
+
+/// Area weighted plane quadrics of the triangles, accumulated on their
+/// vertices.
+struct accumulate_quadrics_functor {
+    accumulate_quadrics_functor(const Eigen::Vector3f* vertices,
+                                const Eigen::Vector3i* triangles, float* quadrics)
+                                : vertices_(vertices), triangles_(triangles), quadrics_(quadrics) {};
+    const Eigen::Vector3f* vertices_;
+    const Eigen::Vector3i* triangles_;
+    float* quadrics_;
+    __device__ void operator() (size_t idx) {
+        const Eigen::Vector3i& tri = triangles_[idx];
+        const Eigen::Vector3f& p0 = vertices_[tri[0]];
+        Eigen::Vector3f n = (vertices_[tri[1]] - p0).cross(vertices_[tri[2]] - p0);
+        const float area2 = n.norm();
+        if (area2 == 0.0f) return;
+        n /= area2;
+        const float d = -n.dot(p0);
+        const float w = 0.5f * area2;
+        const float q[kQuadricSize] = {n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d,
+                                       n[1] * n[1], n[1] * n[2], n[1] * d,
+                                       n[2] * n[2], n[2] * d, d * d};
+        for (int j = 0; j < 3; ++j) {
+            float* qv = quadrics_ + tri[j] * kQuadricSize;
+            for (int k = 0; k < kQuadricSize; ++k) atomicAdd(qv + k, w * q[k]);
+        }
+    }
+};
+
+struct undirected_edges_functor {
+    undirected_edges_functor(const Eigen::Vector3i* triangles, Eigen::Vector2i* edges)
+        : triangles_(triangles), edges_(edges) {};
+    const Eigen::Vector3i* triangles_;
+    Eigen::Vector2i* edges_;
+    __device__ void operator() (size_t idx) {
+        const Eigen::Vector3i& tri = triangles_[idx];
+        for (int j = 0; j < 3; ++j) {
+            const int a = tri[j];
+            const int b = tri[(j + 1) % 3];
+            edges_[3 * idx + j] = Eigen::Vector2i(min(a, b), max(a, b));
+        }
+    }
+};
+
+/// Optimal position and cost of the collapse of every edge, and the key
+/// packing the cost and the edge index that orders the collapses. The
+/// costs are non negative, so their bits order them as unsigned integers.
+struct edge_cost_functor {
+    edge_cost_functor(const Eigen::Vector3f* vertices, const float* quadrics,
+                      const Eigen::Vector2i* edges, float maximum_error,
+                      Eigen::Vector3f* positions, unsigned long long* keys)
+                      : vertices_(vertices), quadrics_(quadrics), edges_(edges),
+                      maximum_error_(maximum_error), positions_(positions), keys_(keys) {};
+    const Eigen::Vector3f* vertices_;
+    const float* quadrics_;
+    const Eigen::Vector2i* edges_;
+    const float maximum_error_;
+    Eigen::Vector3f* positions_;
+    unsigned long long* keys_;
+    __device__ void operator() (size_t idx) {
+        const Eigen::Vector2i& e = edges_[idx];
+        float q[kQuadricSize];
+        for (int k = 0; k < kQuadricSize; ++k) {
+            q[k] = quadrics_[e[0] * kQuadricSize + k] + quadrics_[e[1] * kQuadricSize + k];
+        }
+        const Eigen::Vector3f& pa = vertices_[e[0]];
+        const Eigen::Vector3f& pb = vertices_[e[1]];
+        const Eigen::Vector3f mid = 0.5f * (pa + pb);
+        Eigen::Vector3f best = mid;
+        float cost = EvaluateQuadric(q, mid);
+        const Eigen::Vector3f cands[2] = {pa, pb};
+        for (int j = 0; j < 2; ++j) {
+            const float c = EvaluateQuadric(q, cands[j]);
+            if (c < cost) { cost = c; best = cands[j]; }
+        }
+        Eigen::Matrix3f a;
+        a << q[0], q[1], q[2], q[1], q[4], q[5], q[2], q[5], q[7];
+        const float det = a.determinant();
+        const float scale = a.trace();
+        if (fabsf(det) > 1.0e-6f * scale * scale * scale) {
+            const Eigen::Vector3f opt = a.inverse() * Eigen::Vector3f(-q[3], -q[6], -q[8]);
+            // Ill conditioned solutions far from the edge are dropped.
+            const float c = EvaluateQuadric(q, opt);
+            if ((opt - mid).norm() <= (pa - pb).norm() && c < cost) {
+                cost = c;
+                best = opt;
+            }
+        }
+        cost = fmaxf(cost, 0.0f);
+        positions_[idx] = best;
+        keys_[idx] = (cost <= maximum_error_) ?
+                     ((unsigned long long)__float_as_uint(cost) << 32) | (unsigned long long)idx :
+                     kInvalidEdgeKey;
+    }
+};
+
+/// Smallest key of the edges of every vertex.
+struct vertex_min_key_functor {
+    vertex_min_key_functor(const Eigen::Vector2i* edges, const unsigned long long* keys,
+                           unsigned long long* vertex_keys)
+                           : edges_(edges), keys_(keys), vertex_keys_(vertex_keys) {};
+    const Eigen::Vector2i* edges_;
+    const unsigned long long* keys_;
+    unsigned long long* vertex_keys_;
+    __device__ void operator() (size_t idx) {
+        if (keys_[idx] == kInvalidEdgeKey) return;
+        atomicMin(vertex_keys_ + edges_[idx][0], keys_[idx]);
+        atomicMin(vertex_keys_ + edges_[idx][1], keys_[idx]);
+    }
+};
+
+/// Smallest key of the vertex keys of the neighbours of every vertex.
+struct neighbor_min_key_functor {
+    neighbor_min_key_functor(const Eigen::Vector2i* edges, const unsigned long long* vertex_keys,
+                             unsigned long long* neighbor_keys)
+                             : edges_(edges), vertex_keys_(vertex_keys), neighbor_keys_(neighbor_keys) {};
+    const Eigen::Vector2i* edges_;
+    const unsigned long long* vertex_keys_;
+    unsigned long long* neighbor_keys_;
+    __device__ void operator() (size_t idx) {
+        const Eigen::Vector2i& e = edges_[idx];
+        atomicMin(neighbor_keys_ + e[0], vertex_keys_[e[1]]);
+        atomicMin(neighbor_keys_ + e[1], vertex_keys_[e[0]]);
+    }
+};
+
+/// An edge is collapsed when its key is the smallest around its endpoints
+/// and their neighbours, so that the stars of the collapsed edges do not
+/// overlap, and when moving its endpoints does not flip their triangles.
+struct select_collapse_functor {
+    select_collapse_functor(const Eigen::Vector3f* vertices, const Eigen::Vector3i* triangles,
+                            const Eigen::Vector2i* edges, const unsigned long long* keys,
+                            const unsigned long long* neighbor_keys,
+                            const Eigen::Vector3f* positions,
+                            const int* vertex_triangles, const int* offsets)
+                            : vertices_(vertices), triangles_(triangles), edges_(edges),
+                            keys_(keys), neighbor_keys_(neighbor_keys), positions_(positions),
+                            vertex_triangles_(vertex_triangles), offsets_(offsets) {};
+    const Eigen::Vector3f* vertices_;
+    const Eigen::Vector3i* triangles_;
+    const Eigen::Vector2i* edges_;
+    const unsigned long long* keys_;
+    const unsigned long long* neighbor_keys_;
+    const Eigen::Vector3f* positions_;
+    const int* vertex_triangles_;
+    const int* offsets_;
+    __device__ bool operator() (size_t idx) const {
+        const unsigned long long key = keys_[idx];
+        const Eigen::Vector2i& e = edges_[idx];
+        if (key == kInvalidEdgeKey || key != neighbor_keys_[e[0]] ||
+            key != neighbor_keys_[e[1]]) return false;
+        const Eigen::Vector3f& v = positions_[idx];
+        for (int j = 0; j < 2; ++j) {
+            for (int i = offsets_[e[j]]; i < offsets_[e[j] + 1]; ++i) {
+                const Eigen::Vector3i& tri = triangles_[vertex_triangles_[i]];
+                Eigen::Vector3f p[3];
+                bool removed = false;
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = vertices_[tri[k]];
+                    if (tri[k] == e[1 - j]) removed = true;
+                }
+                if (removed) continue;
+                const Eigen::Vector3f n_old = (p[1] - p[0]).cross(p[2] - p[0]);
+                for (int k = 0; k < 3; ++k) {
+                    if (tri[k] == e[j]) p[k] = v;
+                }
+                const Eigen::Vector3f n_new = (p[1] - p[0]).cross(p[2] - p[0]);
+                if (n_old.dot(n_new) <= 0.0f) return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// Moves the first endpoint of every collapsed edge to the optimal
+/// position, the second one being mapped to it.
+struct collapse_edge_functor {
+    collapse_edge_functor(const Eigen::Vector2i* edges, const Eigen::Vector3f* positions,
+                          Eigen::Vector3f* vertices, Eigen::Vector3f* normals,
+                          Eigen::Vector3f* colors, float* quadrics, int* remap)
+                          : edges_(edges), positions_(positions), vertices_(vertices),
+                          normals_(normals), colors_(colors), quadrics_(quadrics), remap_(remap) {};
+    const Eigen::Vector2i* edges_;
+    const Eigen::Vector3f* positions_;
+    Eigen::Vector3f* vertices_;
+    Eigen::Vector3f* normals_;
+    Eigen::Vector3f* colors_;
+    float* quadrics_;
+    int* remap_;
+    __device__ void operator() (int idx) {
+        const int a = edges_[idx][0];
+        const int b = edges_[idx][1];
+        vertices_[a] = positions_[idx];
+        if (normals_) {
+            const Eigen::Vector3f n = normals_[a] + normals_[b];
+            const float norm = n.norm();
+            if (norm > 0.0f) normals_[a] = n / norm;
+        }
+        if (colors_) colors_[a] = 0.5f * (colors_[a] + colors_[b]);
+        for (int k = 0; k < kQuadricSize; ++k) {
+            quadrics_[a * kQuadricSize + k] += quadrics_[b * kQuadricSize + k];
+        }
+        remap_[b] = a;
+    }
+};
+
+struct remap_triangle_functor {
+    remap_triangle_functor(const int* remap) : remap_(remap) {};
+    const int* remap_;
+    __device__ Eigen::Vector3i operator() (const Eigen::Vector3i& tri) const {
+        return Eigen::Vector3i(remap_[tri[0]], remap_[tri[1]], remap_[tri[2]]);
+    }
+};
+
+struct is_degenerate_triangle_functor {
+    __device__ bool operator() (const Eigen::Vector3i& tri) const {
+        return tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0];
+    }
+};
+
+struct vertex_triangle_functor {
+    vertex_triangle_functor(const Eigen::Vector3i* triangles, int* vertices, int* triangle_indices)
+        : triangles_(triangles), vertices_(vertices), triangle_indices_(triangle_indices) {};
+    const Eigen::Vector3i* triangles_;
+    int* vertices_;
+    int* triangle_indices_;
+    __device__ void operator() (size_t idx) {
+        for (int j = 0; j < 3; ++j) {
+            vertices_[3 * idx + j] = triangles_[idx][j];
+            triangle_indices_[3 * idx + j] = idx;
+        }
+    }
+};
+
+}  // namespace
+
+std::shared_ptr<TriangleMesh> TriangleMesh::SimplifyQuadricDecimation(
+        int target_number_of_triangles, float maximum_error) const {
+    auto mesh = std::make_shared<TriangleMesh>();
+    if (HasTriangleUvs()) {
+        utility::LogWarning(
+                "[SimplifyQuadricDecimation] This mesh contains triangle uvs "
+                "that are not handled in this function");
+    }
+    if (target_number_of_triangles < 0) {
+        utility::LogError("[SimplifyQuadricDecimation] target_number_of_triangles must be non negative.");
+        return mesh;
+    }
+    mesh->vertices_ = vertices_;
+    mesh->vertex_normals_ = vertex_normals_;
+    mesh->vertex_colors_ = vertex_colors_;
+    mesh->triangles_ = triangles_;
+    const size_t n_vertices = vertices_.size();
+    if (n_vertices == 0) return mesh;
+
+    utility::device_vector<float> quadrics(n_vertices * kQuadricSize, 0.0f);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(mesh->triangles_.size()),
+                     accumulate_quadrics_functor(thrust::raw_pointer_cast(mesh->vertices_.data()),
+                                                 thrust::raw_pointer_cast(mesh->triangles_.data()),
+                                                 thrust::raw_pointer_cast(quadrics.data())));
+
+    utility::device_vector<Eigen::Vector2i> edges;
+    utility::device_vector<Eigen::Vector3f> positions;
+    utility::device_vector<unsigned long long> keys;
+    utility::device_vector<unsigned long long> vertex_keys(n_vertices);
+    utility::device_vector<unsigned long long> neighbor_keys(n_vertices);
+    utility::device_vector<int> vt_vertices;
+    utility::device_vector<int> vt_triangles;
+    utility::device_vector<int> offsets(n_vertices + 1);
+    utility::device_vector<int> collapsed;
+    utility::device_vector<int> remap(n_vertices);
+    while (mesh->triangles_.size() > (size_t)target_number_of_triangles) {
+        const size_t n_tri = mesh->triangles_.size();
+        const Eigen::Vector3i* tri_ptr = thrust::raw_pointer_cast(mesh->triangles_.data());
+        // Undirected edges and their collapse costs.
+        edges.resize(3 * n_tri);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_tri),
+                         undirected_edges_functor(tri_ptr, thrust::raw_pointer_cast(edges.data())));
+        thrust::sort(edges.begin(), edges.end());
+        edges.resize(thrust::distance(edges.begin(), thrust::unique(edges.begin(), edges.end())));
+        const size_t n_edges = edges.size();
+        resize_all(n_edges, positions, keys);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_edges),
+                         edge_cost_functor(thrust::raw_pointer_cast(mesh->vertices_.data()),
+                                           thrust::raw_pointer_cast(quadrics.data()),
+                                           thrust::raw_pointer_cast(edges.data()), maximum_error,
+                                           thrust::raw_pointer_cast(positions.data()),
+                                           thrust::raw_pointer_cast(keys.data())));
+        // Independent set of the cheapest edges.
+        thrust::fill(vertex_keys.begin(), vertex_keys.end(), kInvalidEdgeKey);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_edges),
+                         vertex_min_key_functor(thrust::raw_pointer_cast(edges.data()),
+                                                thrust::raw_pointer_cast(keys.data()),
+                                                thrust::raw_pointer_cast(vertex_keys.data())));
+        thrust::copy(vertex_keys.begin(), vertex_keys.end(), neighbor_keys.begin());
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_edges),
+                         neighbor_min_key_functor(thrust::raw_pointer_cast(edges.data()),
+                                                  thrust::raw_pointer_cast(vertex_keys.data()),
+                                                  thrust::raw_pointer_cast(neighbor_keys.data())));
+        // Triangles of every vertex for the flip test.
+        resize_all(3 * n_tri, vt_vertices, vt_triangles);
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(n_tri),
+                         vertex_triangle_functor(tri_ptr, thrust::raw_pointer_cast(vt_vertices.data()),
+                                                 thrust::raw_pointer_cast(vt_triangles.data())));
+        thrust::sort_by_key(vt_vertices.begin(), vt_vertices.end(), vt_triangles.begin());
+        thrust::lower_bound(vt_vertices.begin(), vt_vertices.end(),
+                            thrust::make_counting_iterator<int>(0),
+                            thrust::make_counting_iterator<int>(n_vertices + 1),
+                            offsets.begin());
+        collapsed.resize(n_edges);
+        select_collapse_functor select_func(thrust::raw_pointer_cast(mesh->vertices_.data()), tri_ptr,
+                                            thrust::raw_pointer_cast(edges.data()),
+                                            thrust::raw_pointer_cast(keys.data()),
+                                            thrust::raw_pointer_cast(neighbor_keys.data()),
+                                            thrust::raw_pointer_cast(positions.data()),
+                                            thrust::raw_pointer_cast(vt_triangles.data()),
+                                            thrust::raw_pointer_cast(offsets.data()));
+        auto end = thrust::copy_if(thrust::make_counting_iterator<int>(0),
+                                   thrust::make_counting_iterator<int>(n_edges),
+                                   collapsed.begin(), select_func);
+        size_t n_collapsed = thrust::distance(collapsed.begin(), end);
+        if (n_collapsed == 0) break;
+        // An interior collapse removes two triangles, the cheapest ones are
+        // kept when the round would go below the target.
+        const size_t n_needed = (n_tri - target_number_of_triangles + 1) / 2;
+        if (n_collapsed > n_needed) {
+            utility::device_vector<unsigned long long> collapsed_keys(n_collapsed);
+            thrust::gather(collapsed.begin(), collapsed.begin() + n_collapsed,
+                           keys.begin(), collapsed_keys.begin());
+            thrust::sort_by_key(collapsed_keys.begin(), collapsed_keys.end(), collapsed.begin());
+            n_collapsed = n_needed;
+        }
+        thrust::sequence(remap.begin(), remap.end());
+        thrust::for_each(collapsed.begin(), collapsed.begin() + n_collapsed,
+                         collapse_edge_functor(thrust::raw_pointer_cast(edges.data()),
+                                               thrust::raw_pointer_cast(positions.data()),
+                                               thrust::raw_pointer_cast(mesh->vertices_.data()),
+                                               mesh->HasVertexNormals() ? thrust::raw_pointer_cast(mesh->vertex_normals_.data()) : NULL,
+                                               mesh->HasVertexColors() ? thrust::raw_pointer_cast(mesh->vertex_colors_.data()) : NULL,
+                                               thrust::raw_pointer_cast(quadrics.data()),
+                                               thrust::raw_pointer_cast(remap.data())));
+        thrust::transform(mesh->triangles_.begin(), mesh->triangles_.end(), mesh->triangles_.begin(),
+                          remap_triangle_functor(thrust::raw_pointer_cast(remap.data())));
+        auto tri_end = thrust::remove_if(mesh->triangles_.begin(), mesh->triangles_.end(),
+                                         is_degenerate_triangle_functor());
+        mesh->triangles_.resize(thrust::distance(mesh->triangles_.begin(), tri_end));
+    }
+
+    mesh->RemoveDuplicatedTriangles();
+    mesh->RemoveUnreferencedVertices();
+    if (HasTriangleNormals()) {
+        mesh->ComputeTriangleNormals();
+    }
+    utility::LogDebug(
+            "[SimplifyQuadricDecimation] {:d} triangles have been simplified to {:d}.",
+            (int)triangles_.size(), (int)mesh->triangles_.size());
+    return mesh;
+}
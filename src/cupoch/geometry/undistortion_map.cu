@@ -0,0 +1,256 @@
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/transform.h>
+
+#include <algorithm>
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/undistortion_map.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/texture2d.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+struct compute_undistortion_map_functor {
+    compute_undistortion_map_functor(
+            const Eigen::Matrix3f &intrinsic,
+            camera::DistortionModel model,
+            const camera::DistortionCoefficients &coeffs,
+            const Eigen::Matrix3f &undistorted,
+            int width)
+        : fx_(intrinsic(0, 0)),
+          fy_(intrinsic(1, 1)),
+          cx_(intrinsic(0, 2)),
+          cy_(intrinsic(1, 2)),
+          skew_(intrinsic(0, 1)),
+          model_(model),
+          coeffs_(coeffs),
+          ufx_(undistorted(0, 0)),
+          ufy_(undistorted(1, 1)),
+          ucx_(undistorted(0, 2)),
+          ucy_(undistorted(1, 2)),
+          uskew_(undistorted(0, 1)),
+          width_(width){};
+    const float fx_;
+    const float fy_;
+    const float cx_;
+    const float cy_;
+    const float skew_;
+    const camera::DistortionModel model_;
+    const camera::DistortionCoefficients coeffs_;
+    const float ufx_;
+    const float ufy_;
+    const float ucx_;
+    const float ucy_;
+    const float uskew_;
+    const int width_;
+    __device__ Eigen::Vector2f operator()(size_t idx) const {
+        const float u = idx % width_;
+        const float v = idx / width_;
+        const float y = (v - ucy_) / ufy_;
+        const float x = (u - ucx_ - uskew_ * y) / ufx_;
+        const Eigen::Vector2f xy_d = camera::DistortNormalizedPoint(
+                model_, coeffs_, Eigen::Vector2f(x, y));
+        return Eigen::Vector2f(fx_ * xy_d[0] + skew_ * xy_d[1] + cx_,
+                               fy_ * xy_d[1] + cy_);
+    }
+};
+
+template <typename T>
+struct pad_to_four_channels_functor {
+    pad_to_four_channels_functor(const T *image, T *padded)
+        : image_(image), padded_(padded){};
+    const T *image_;
+    T *padded_;
+    __device__ void operator()(size_t idx) const {
+        padded_[4 * idx] = image_[3 * idx];
+        padded_[4 * idx + 1] = image_[3 * idx + 1];
+        padded_[4 * idx + 2] = image_[3 * idx + 2];
+        padded_[4 * idx + 3] = 0;
+    }
+};
+
+/// The normalized reads of the integer textures are scaled back by
+/// \p scale and rounded.
+template <typename T, int C>
+struct remap_functor {
+    remap_functor(cudaTextureObject_t texture,
+                  const Eigen::Vector2f *map,
+                  int source_width,
+                  int source_height,
+                  float scale,
+                  float offset,
+                  T *output)
+        : texture_(texture),
+          map_(map),
+          source_width_(source_width),
+          source_height_(source_height),
+          scale_(scale),
+          offset_(offset),
+          output_(output){};
+    const cudaTextureObject_t texture_;
+    const Eigen::Vector2f *map_;
+    const int source_width_;
+    const int source_height_;
+    const float scale_;
+    const float offset_;
+    T *output_;
+    __device__ void operator()(size_t idx) const {
+        const Eigen::Vector2f uv = map_[idx];
+        T *out = output_ + idx * C;
+        if (!(uv[0] >= -0.5f && uv[0] <= source_width_ - 0.5f &&
+              uv[1] >= -0.5f && uv[1] <= source_height_ - 0.5f)) {
+            for (int c = 0; c < C; ++c) out[c] = 0;
+            return;
+        }
+        if (C == 1) {
+            out[0] = T(tex2D<float>(texture_, uv[0] + 0.5f, uv[1] + 0.5f) *
+                               scale_ +
+                       offset_);
+        } else {
+            const float4 value =
+                    tex2D<float4>(texture_, uv[0] + 0.5f, uv[1] + 0.5f);
+            out[0] = T(value.x * scale_ + offset_);
+            out[1] = T(value.y * scale_ + offset_);
+            out[2] = T(value.z * scale_ + offset_);
+        }
+    }
+};
+
+template <typename T, int C>
+void LaunchRemap(cudaTextureObject_t texture,
+                 const UndistortionMap &map,
+                 float scale,
+                 float offset,
+                 Image &output,
+                 cudaStream_t stream) {
+    remap_functor<T, C> func(
+            texture, thrust::raw_pointer_cast(map.map_.data()),
+            map.source_width_, map.source_height_, scale, offset,
+            (T *)thrust::raw_pointer_cast(output.data_.data()));
+    utility::TunedForEach("UndistortionMap::Remap", map.map_.size(), func,
+                          stream);
+}
+
+}  // namespace
+
+UndistortionMap::UndistortionMap(
+        const camera::PinholeCameraIntrinsic &intrinsic) {
+    Compute(intrinsic, intrinsic);
+}
+
+UndistortionMap::UndistortionMap(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const camera::PinholeCameraIntrinsic &undistorted) {
+    Compute(intrinsic, undistorted);
+}
+
+UndistortionMap::~UndistortionMap() {}
+
+void UndistortionMap::Compute(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const camera::PinholeCameraIntrinsic &undistorted) {
+    if (!intrinsic.IsValid()) {
+        utility::LogError("[UndistortionMap] Invalid intrinsic.");
+    }
+    width_ = std::max(undistorted.width_, 0);
+    height_ = std::max(undistorted.height_, 0);
+    source_width_ = intrinsic.width_;
+    source_height_ = intrinsic.height_;
+    map_.resize(width_ * height_);
+    compute_undistortion_map_functor func(
+            intrinsic.intrinsic_matrix_, intrinsic.distortion_model_,
+            intrinsic.distortion_coeffs_, undistorted.intrinsic_matrix_,
+            width_);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(map_.size()),
+                      map_.begin(), func);
+}
+
+std::shared_ptr<Image> UndistortionMap::Remap(const Image &image,
+                                              bool linear_filter,
+                                              cudaStream_t stream) const {
+    auto output = std::make_shared<Image>();
+    Remap(image, *output, linear_filter, stream);
+    return output;
+}
+
+void UndistortionMap::Remap(const Image &image,
+                            Image &output,
+                            bool linear_filter,
+                            cudaStream_t stream) const {
+    const int channels = image.num_of_channels_;
+    const int bytes = image.bytes_per_channel_;
+    const bool is_integer = bytes != 4;
+    if (!((channels == 1 && (bytes == 1 || bytes == 2 || bytes == 4)) ||
+          (channels == 3 && (bytes == 1 || bytes == 4)))) {
+        utility::LogError(
+                "[UndistortionMap::Remap] Unsupported image of {} channels of "
+                "{} bytes.",
+                channels, bytes);
+    }
+    if (image.width_ != source_width_ || image.height_ != source_height_) {
+        utility::LogError(
+                "[UndistortionMap::Remap] Image of {} x {}, expected {} x {}.",
+                image.width_, image.height_, source_width_, source_height_);
+    }
+    if (!texture_ || texture_channels_ != channels || texture_bytes_ != bytes ||
+        texture_linear_ != linear_filter) {
+        const int texture_channels = (channels == 3) ? 4 : 1;
+        const int bits = 8 * bytes;
+        const cudaChannelFormatDesc desc = cudaCreateChannelDesc(
+                bits, (texture_channels > 1) ? bits : 0,
+                (texture_channels > 1) ? bits : 0,
+                (texture_channels > 1) ? bits : 0,
+                is_integer ? cudaChannelFormatKindUnsigned
+                           : cudaChannelFormatKindFloat);
+        texture_ = std::make_shared<utility::Texture2D>(
+                source_width_, source_height_, desc, linear_filter,
+                is_integer);
+        texture_channels_ = channels;
+        texture_bytes_ = bytes;
+        texture_linear_ = linear_filter;
+    }
+    if (channels == 3) {
+        const size_t n_pixels = size_t(source_width_) * source_height_;
+        padded_.resize(n_pixels * 4 * bytes);
+        if (bytes == 1) {
+            pad_to_four_channels_functor<uint8_t> func(
+                    thrust::raw_pointer_cast(image.data_.data()),
+                    thrust::raw_pointer_cast(padded_.data()));
+            utility::TunedForEach("UndistortionMap::Pad", n_pixels, func,
+                                  stream);
+        } else {
+            pad_to_four_channels_functor<float> func(
+                    (const float *)thrust::raw_pointer_cast(
+                            image.data_.data()),
+                    (float *)thrust::raw_pointer_cast(padded_.data()));
+            utility::TunedForEach("UndistortionMap::Pad", n_pixels, func,
+                                  stream);
+        }
+        texture_->CopyFrom(thrust::raw_pointer_cast(padded_.data()),
+                           source_width_ * 4 * bytes, stream);
+    } else {
+        texture_->CopyFrom(thrust::raw_pointer_cast(image.data_.data()),
+                           image.BytesPerLine(), stream);
+    }
+    output.Prepare(width_, height_, channels, bytes);
+    const cudaTextureObject_t texture = texture_->GetTextureObject();
+    if (channels == 1 && bytes == 1) {
+        LaunchRemap<uint8_t, 1>(texture, *this, 255.0, 0.5, output, stream);
+    } else if (channels == 1 && bytes == 2) {
+        LaunchRemap<uint16_t, 1>(texture, *this, 65535.0, 0.5, output,
+                                 stream);
+    } else if (channels == 1) {
+        LaunchRemap<float, 1>(texture, *this, 1.0, 0.0, output, stream);
+    } else if (bytes == 1) {
+        LaunchRemap<uint8_t, 3>(texture, *this, 255.0, 0.5, output, stream);
+    } else {
+        LaunchRemap<float, 3>(texture, *this, 1.0, 0.0, output, stream);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+
+namespace camera {
+class PinholeCameraIntrinsic;
+}
+
+namespace utility {
+class Texture2D;
+}
+
+namespace geometry {
+
+class Image;
+
+/// \class UndistortionMap
+///
+/// \brief Lookup table of the distorted pixel seen by each pixel of an ideal
+/// pinhole camera, computed once on the device for the undistortion of the
+/// frames of a camera.
+///
+/// Remap() copies the frame into a texture and samples it at the table in
+/// one kernel, bilinearly in hardware, or at the nearest pixel for the depth
+/// images, whose edges must not be blended. The pixels seeing out of the
+/// frame are zero. The texture is kept from frame to frame, so a map must
+/// not remap on several threads at once.
+class UndistortionMap {
+public:
+    /// Map of the frames of \p intrinsic to the pinhole camera of the same
+    /// matrix and size without distortion.
+    explicit UndistortionMap(const camera::PinholeCameraIntrinsic &intrinsic);
+    /// Map to the pinhole camera \p undistorted, e.g. of a shorter focal
+    /// length keeping the borders of a fisheye, whose distortion is ignored.
+    UndistortionMap(const camera::PinholeCameraIntrinsic &intrinsic,
+                    const camera::PinholeCameraIntrinsic &undistorted);
+    ~UndistortionMap();
+
+public:
+    /// Undistorts \p image, of 1 channel of 8 bit, 16 bit or float, or of 3
+    /// channels of 8 bit or float.
+    std::shared_ptr<Image> Remap(const Image &image,
+                                 bool linear_filter = true,
+                                 cudaStream_t stream = 0) const;
+    /// Undistorts \p image into \p output, whose memory is kept when the
+    /// format does not change.
+    void Remap(const Image &image,
+               Image &output,
+               bool linear_filter = true,
+               cudaStream_t stream = 0) const;
+
+public:
+    /// Size of the undistorted images.
+    int width_;
+    int height_;
+    /// Size of the distorted frames.
+    int source_width_;
+    int source_height_;
+    /// Distorted pixel of each undistorted pixel, in row major order.
+    utility::device_vector<Eigen::Vector2f> map_;
+
+private:
+    void Compute(const camera::PinholeCameraIntrinsic &intrinsic,
+                 const camera::PinholeCameraIntrinsic &undistorted);
+
+    mutable std::shared_ptr<utility::Texture2D> texture_;
+    mutable int texture_channels_ = 0;
+    mutable int texture_bytes_ = 0;
+    mutable bool texture_linear_ = false;
+    /// The 3 channel frames padded to the 4 channels of the textures.
+    mutable utility::device_vector<uint8_t> padded_;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,560 @@
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <limits>
+
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/geometry/voxel_hash_index.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+// Capacity of the per-thread candidate list. Hybrid searches of
+// ClusterDBSCAN ask for NUM_MAX_NN + 1 neighbours.
+constexpr int kMaxNN = 2 * NUM_MAX_NN;
+
+__device__ Eigen::Vector3i ComputeCell(const Eigen::Vector3f &pt,
+                                       const Eigen::Vector3f &origin,
+                                       float cell_size) {
+    const Eigen::Vector3f ref = (pt - origin) / cell_size;
+    return Eigen::Vector3i(int(floor(ref(0))), int(floor(ref(1))),
+                           int(floor(ref(2))));
+}
+
+struct compute_cell_key_functor {
+    compute_cell_key_functor(const Eigen::Vector3f &origin, float cell_size)
+        : origin_(origin), cell_size_(cell_size){};
+    const Eigen::Vector3f origin_;
+    const float cell_size_;
+    __device__ unsigned long long operator()(const Eigen::Vector3f &pt) const {
+        return PackCellKey(ComputeCell(pt, origin_, cell_size_));
+    }
+};
+
+struct insert_cell_functor {
+    insert_cell_functor(const unsigned long long *cell_keys,
+                        const int *cell_starts,
+                        const int *cell_counts,
+                        unsigned long long *table_keys,
+                        Eigen::Vector2i *table_values,
+                        unsigned int table_mask)
+        : cell_keys_(cell_keys),
+          cell_starts_(cell_starts),
+          cell_counts_(cell_counts),
+          table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask){};
+    const unsigned long long *cell_keys_;
+    const int *cell_starts_;
+    const int *cell_counts_;
+    unsigned long long *table_keys_;
+    Eigen::Vector2i *table_values_;
+    const unsigned int table_mask_;
+    __device__ void operator()(size_t idx) {
+        const unsigned long long key = cell_keys_[idx];
+        unsigned int slot = HashCellKey(key) & table_mask_;
+        while (true) {
+            const unsigned long long prev =
+                    atomicCAS(&table_keys_[slot], kEmptyCellKey, key);
+            if (prev == kEmptyCellKey || prev == key) {
+                table_values_[slot] =
+                        Eigen::Vector2i(cell_starts_[idx], cell_counts_[idx]);
+                return;
+            }
+            slot = (slot + 1) & table_mask_;
+        }
+    }
+};
+
+struct voxel_hash_search_functor {
+    voxel_hash_search_functor(const Eigen::Vector3f *query,
+                              const Eigen::Vector3f *points,
+                              const int *point_indices,
+                              const unsigned long long *table_keys,
+                              const Eigen::Vector2i *table_values,
+                              unsigned int table_mask,
+                              const Eigen::Vector3f &origin,
+                              float cell_size,
+                              float radius2,
+                              int max_nn,
+                              int max_rings,
+                              bool knn_mode,
+                              int *indices,
+                              float *distance2,
+                              const int *offsets = NULL,
+                              int *counts = NULL,
+                              float *mean_distance2 = NULL)
+        : query_(query),
+          points_(points),
+          point_indices_(point_indices),
+          table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask),
+          origin_(origin),
+          cell_size_(cell_size),
+          radius2_(radius2),
+          max_nn_(max_nn),
+          max_rings_(max_rings),
+          knn_mode_(knn_mode),
+          indices_(indices),
+          distance2_(distance2),
+          offsets_(offsets),
+          counts_(counts),
+          mean_distance2_(mean_distance2){};
+    const Eigen::Vector3f *query_;
+    const Eigen::Vector3f *points_;
+    const int *point_indices_;
+    const unsigned long long *table_keys_;
+    const Eigen::Vector2i *table_values_;
+    const unsigned int table_mask_;
+    const Eigen::Vector3f origin_;
+    const float cell_size_;
+    const float radius2_;
+    const int max_nn_;
+    const int max_rings_;
+    const bool knn_mode_;
+    int *indices_;
+    float *distance2_;
+    // If counts_ is set only the number of neighbors is written. If offsets_
+    // is set the neighbors are written packed at offsets_[idx].
+    const int *offsets_;
+    int *counts_;
+    // If mean_distance2_ is set only the mean squared distance of the
+    // neighbors is written, -1 if there are none.
+    float *mean_distance2_;
+
+    __device__ Eigen::Vector2i LookUp(const Eigen::Vector3i &cell) const {
+        const unsigned long long key = PackCellKey(cell);
+        if (key == kEmptyCellKey) return Eigen::Vector2i(0, 0);
+        unsigned int slot = HashCellKey(key) & table_mask_;
+        while (true) {
+            const unsigned long long k = table_keys_[slot];
+            if (k == key) return table_values_[slot];
+            if (k == kEmptyCellKey) return Eigen::Vector2i(0, 0);
+            slot = (slot + 1) & table_mask_;
+        }
+    }
+
+    __device__ void operator()(size_t idx) const {
+        float best_d[kMaxNN];
+        int best_i[kMaxNN];
+        int count = 0;
+        const Eigen::Vector3f &q = query_[idx];
+        const Eigen::Vector3i center = ComputeCell(q, origin_, cell_size_);
+        for (int r = 0; r <= max_rings_; ++r) {
+            // Points in the shell at Chebyshev distance r are at least
+            // (r - 1) cells away from the query.
+            if (knn_mode_ && count == max_nn_) {
+                const float bound = (r - 1) * cell_size_;
+                if (r > 1 && best_d[count - 1] <= bound * bound) break;
+            }
+            for (int dz = -r; dz <= r; ++dz) {
+                for (int dy = -r; dy <= r; ++dy) {
+                    const int step =
+                            (r == 0 || abs(dy) == r || abs(dz) == r) ? 1
+                                                                     : 2 * r;
+                    for (int dx = -r; dx <= r; dx += step) {
+                        const Eigen::Vector2i range = LookUp(
+                                center + Eigen::Vector3i(dx, dy, dz));
+                        for (int k = range[0]; k < range[0] + range[1]; ++k) {
+                            const float d2 = (points_[k] - q).squaredNorm();
+                            if (d2 > radius2_) continue;
+                            if (counts_) {
+                                count = min(count + 1, max_nn_);
+                                continue;
+                            }
+                            int pos;
+                            if (count < max_nn_) {
+                                pos = count++;
+                            } else if (d2 < best_d[max_nn_ - 1]) {
+                                pos = max_nn_ - 1;
+                            } else {
+                                continue;
+                            }
+                            while (pos > 0 && best_d[pos - 1] > d2) {
+                                best_d[pos] = best_d[pos - 1];
+                                best_i[pos] = best_i[pos - 1];
+                                --pos;
+                            }
+                            best_d[pos] = d2;
+                            best_i[pos] = point_indices_[k];
+                        }
+                    }
+                }
+            }
+        }
+        if (counts_) {
+            counts_[idx] = count;
+            return;
+        }
+        if (mean_distance2_) {
+            float sum = 0.0;
+            for (int k = 0; k < count; ++k) sum += best_d[k];
+            mean_distance2_[idx] = (count > 0) ? sum / count : -1.0;
+            return;
+        }
+        if (offsets_) {
+            for (int k = 0; k < count; ++k) {
+                indices_[offsets_[idx] + k] = best_i[k];
+                distance2_[offsets_[idx] + k] = best_d[k];
+            }
+            return;
+        }
+        for (int k = 0; k < max_nn_; ++k) {
+            indices_[idx * max_nn_ + k] = (k < count) ? best_i[k] : -1;
+            distance2_[idx * max_nn_ + k] =
+                    (k < count) ? best_d[k]
+                                : std::numeric_limits<float>::infinity();
+        }
+    }
+};
+
+}  // namespace
+
+VoxelHashIndex::VoxelHashIndex(float cell_size) : cell_size_(cell_size) {}
+
+VoxelHashIndex::VoxelHashIndex(float cell_size, const Geometry &geometry)
+    : cell_size_(cell_size) {
+    SetGeometry(geometry);
+}
+
+VoxelHashIndex::~VoxelHashIndex() {}
+
+bool VoxelHashIndex::SetGeometry(const Geometry &geometry) {
+    switch (geometry.GetGeometryType()) {
+        case Geometry::GeometryType::PointCloud:
+            return SetRawData(((const PointCloud &)geometry).points_);
+        case Geometry::GeometryType::TriangleMesh:
+            return SetRawData(((const TriangleMesh &)geometry).vertices_);
+        case Geometry::GeometryType::Image:
+        case Geometry::GeometryType::Unspecified:
+        default:
+            utility::LogWarning(
+                    "[VoxelHashIndex::SetGeometry] Unsupported Geometry "
+                    "type.");
+            return false;
+    }
+}
+
+template <typename T>
+bool VoxelHashIndex::SetRawData(const utility::device_vector<T> &data) {
+    const size_t n = data.size();
+    if (n == 0) {
+        utility::LogWarning(
+                "[VoxelHashIndex::SetRawData] Failed due to no data.");
+        return false;
+    }
+    const Eigen::Vector3f init_min =
+            Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+    const Eigen::Vector3f init_max =
+            Eigen::Vector3f::Constant(-std::numeric_limits<float>::max());
+    origin_ = thrust::reduce(data.begin(), data.end(), init_min,
+                             thrust::elementwise_minimum<Eigen::Vector3f>());
+    const Eigen::Vector3f max_bound =
+            thrust::reduce(data.begin(), data.end(), init_max,
+                           thrust::elementwise_maximum<Eigen::Vector3f>());
+    const Eigen::Vector3f extent = max_bound - origin_;
+    if (cell_size_ <= 0.0) {
+        // Aim at about 8 points per occupied cell.
+        float volume = 1.0;
+        int dim = 0;
+        for (int i = 0; i < 3; ++i) {
+            if (extent[i] > 0.0) {
+                volume *= extent[i];
+                ++dim;
+            }
+        }
+        cell_size_ = (dim == 0) ? 1.0
+                                : std::pow(volume * 8.0f / n, 1.0f / dim);
+    }
+    max_rings_ = int(std::ceil(extent.maxCoeff() / cell_size_)) + 1;
+    if (max_rings_ >= kCellKeyOffset) {
+        utility::LogWarning(
+                "[VoxelHashIndex::SetRawData] cell_size is too small.");
+        return false;
+    }
+
+    utility::device_vector<unsigned long long> keys(n);
+    thrust::transform(data.begin(), data.end(), keys.begin(),
+                      compute_cell_key_functor(origin_, cell_size_));
+    sorted_indices_.resize(n);
+    thrust::sequence(sorted_indices_.begin(), sorted_indices_.end());
+    thrust::sort_by_key(keys.begin(), keys.end(), sorted_indices_.begin());
+    sorted_points_.resize(n);
+    thrust::gather(sorted_indices_.begin(), sorted_indices_.end(),
+                   data.begin(), sorted_points_.begin());
+
+    utility::device_vector<unsigned long long> cell_keys(n);
+    utility::device_vector<int> cell_counts(n);
+    auto end = thrust::reduce_by_key(keys.begin(), keys.end(),
+                                     thrust::make_constant_iterator(1),
+                                     cell_keys.begin(), cell_counts.begin());
+    num_cells_ = thrust::distance(cell_keys.begin(), end.first);
+    utility::device_vector<int> cell_starts(num_cells_);
+    thrust::exclusive_scan(cell_counts.begin(),
+                           cell_counts.begin() + num_cells_,
+                           cell_starts.begin());
+
+    size_t table_size = 1;
+    while (table_size < 2 * num_cells_) table_size <<= 1;
+    table_keys_.resize(table_size);
+    thrust::fill(table_keys_.begin(), table_keys_.end(), kEmptyCellKey);
+    table_values_.resize(table_size);
+    insert_cell_functor func(thrust::raw_pointer_cast(cell_keys.data()),
+                             thrust::raw_pointer_cast(cell_starts.data()),
+                             thrust::raw_pointer_cast(cell_counts.data()),
+                             thrust::raw_pointer_cast(table_keys_.data()),
+                             thrust::raw_pointer_cast(table_values_.data()),
+                             table_size - 1);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(num_cells_), func);
+    return true;
+}
+
+template <typename T>
+int VoxelHashIndex::SearchImpl(const utility::device_vector<T> &query,
+                               float radius,
+                               int max_nn,
+                               bool knn_mode,
+                               utility::device_vector<int> &indices,
+                               utility::device_vector<float> &distance2) const {
+    if (sorted_points_.empty() || query.empty() || max_nn <= 0 ||
+        max_nn > kMaxNN)
+        return -1;
+    const float radius2 = knn_mode ? std::numeric_limits<float>::infinity()
+                                   : radius * radius;
+    const int max_rings =
+            knn_mode ? max_rings_
+                     : std::min(max_rings_,
+                                int(std::ceil(radius / cell_size_)));
+    indices.resize(query.size() * max_nn);
+    distance2.resize(query.size() * max_nn);
+    voxel_hash_search_functor func(
+            thrust::raw_pointer_cast(query.data()),
+            thrust::raw_pointer_cast(sorted_points_.data()),
+            thrust::raw_pointer_cast(sorted_indices_.data()),
+            thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()),
+            table_keys_.size() - 1, origin_, cell_size_, radius2, max_nn,
+            max_rings, knn_mode, thrust::raw_pointer_cast(indices.data()),
+            thrust::raw_pointer_cast(distance2.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(query.size()), func);
+    return 1;
+}
+
+template <typename T>
+int VoxelHashIndex::Search(const utility::device_vector<T> &query,
+                           const KDTreeSearchParam &param,
+                           utility::device_vector<int> &indices,
+                           utility::device_vector<float> &distance2) const {
+    switch (param.GetSearchType()) {
+        case KDTreeSearchParam::SearchType::Knn:
+            return SearchKNN(query, ((const KDTreeSearchParamKNN &)param).knn_,
+                             indices, distance2);
+        case KDTreeSearchParam::SearchType::Radius:
+            return SearchRadius(
+                    query, ((const KDTreeSearchParamRadius &)param).radius_,
+                    indices, distance2);
+        case KDTreeSearchParam::SearchType::Hybrid:
+            return SearchHybrid(
+                    query, ((const KDTreeSearchParamHybrid &)param).radius_,
+                    ((const KDTreeSearchParamHybrid &)param).max_nn_, indices,
+                    distance2);
+        default:
+            return -1;
+    }
+    return -1;
+}
+
+template <typename T>
+int VoxelHashIndex::SearchKNN(const utility::device_vector<T> &query,
+                              int knn,
+                              utility::device_vector<int> &indices,
+                              utility::device_vector<float> &distance2) const {
+    return SearchImpl(query, 0.0, knn, true, indices, distance2);
+}
+
+template <typename T>
+int VoxelHashIndex::SearchRadius(
+        const utility::device_vector<T> &query,
+        float radius,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    return SearchImpl(query, radius, NUM_MAX_NN, false, indices, distance2);
+}
+
+template <typename T>
+int VoxelHashIndex::SearchHybrid(
+        const utility::device_vector<T> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    return SearchImpl(query, radius, max_nn, false, indices, distance2);
+}
+
+template <typename T>
+int VoxelHashIndex::SearchRadiusCSR(
+        const utility::device_vector<T> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &offsets,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const {
+    if (sorted_points_.empty() || query.empty() || max_nn <= 0 ||
+        max_nn > kMaxNN)
+        return -1;
+    const int max_rings =
+            std::min(max_rings_, int(std::ceil(radius / cell_size_)));
+    const size_t n_query = query.size();
+    utility::device_vector<int> counts(n_query + 1, 0);
+    voxel_hash_search_functor count_func(
+            thrust::raw_pointer_cast(query.data()),
+            thrust::raw_pointer_cast(sorted_points_.data()),
+            thrust::raw_pointer_cast(sorted_indices_.data()),
+            thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()),
+            table_keys_.size() - 1, origin_, cell_size_, radius * radius,
+            max_nn, max_rings, false, NULL, NULL, NULL,
+            thrust::raw_pointer_cast(counts.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_query), count_func);
+    offsets.resize(n_query + 1);
+    thrust::exclusive_scan(counts.begin(), counts.end(), offsets.begin());
+    const int total = offsets.back();
+    indices.resize(total);
+    distance2.resize(total);
+    voxel_hash_search_functor fill_func(
+            thrust::raw_pointer_cast(query.data()),
+            thrust::raw_pointer_cast(sorted_points_.data()),
+            thrust::raw_pointer_cast(sorted_indices_.data()),
+            thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()),
+            table_keys_.size() - 1, origin_, cell_size_, radius * radius,
+            max_nn, max_rings, false, thrust::raw_pointer_cast(indices.data()),
+            thrust::raw_pointer_cast(distance2.data()),
+            thrust::raw_pointer_cast(offsets.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_query), fill_func);
+    return total;
+}
+
+template <typename T>
+int VoxelHashIndex::SearchKNNMeanDistance2(
+        const utility::device_vector<T> &query,
+        int knn,
+        utility::device_vector<float> &mean_distance2) const {
+    if (sorted_points_.empty() || query.empty() || knn <= 0 || knn > kMaxNN)
+        return -1;
+    mean_distance2.resize(query.size());
+    voxel_hash_search_functor func(
+            thrust::raw_pointer_cast(query.data()),
+            thrust::raw_pointer_cast(sorted_points_.data()),
+            thrust::raw_pointer_cast(sorted_indices_.data()),
+            thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()),
+            table_keys_.size() - 1, origin_, cell_size_,
+            std::numeric_limits<float>::infinity(), knn, max_rings_, true,
+            NULL, NULL, NULL, NULL,
+            thrust::raw_pointer_cast(mean_distance2.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(query.size()), func);
+    return 1;
+}
+
+int cupoch::geometry::SearchNeighbors(
+        SearchIndexType index_type,
+        const utility::device_vector<Eigen::Vector3f> &data,
+        const utility::device_vector<Eigen::Vector3f> &query,
+        const KDTreeSearchParam &param,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2,
+        utility::Workspace *workspace) {
+    if (index_type == SearchIndexType::VoxelHash) {
+        float cell_size = 0.0;
+        switch (param.GetSearchType()) {
+            case KDTreeSearchParam::SearchType::Radius:
+                cell_size = ((const KDTreeSearchParamRadius &)param).radius_;
+                break;
+            case KDTreeSearchParam::SearchType::Hybrid:
+                cell_size = ((const KDTreeSearchParamHybrid &)param).radius_;
+                break;
+            default:
+                break;
+        }
+        VoxelHashIndex index(cell_size);
+        index.SetRawData(data);
+        return index.Search(query, param, indices, distance2);
+    }
+    KDTreeFlann kdtree;
+    kdtree.SetWorkspace(workspace);
+    kdtree.SetRawData(data);
+    return kdtree.Search(query, param, indices, distance2);
+}
+
+int cupoch::geometry::SearchNeighborsCSR(
+        SearchIndexType index_type,
+        const utility::device_vector<Eigen::Vector3f> &data,
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &offsets,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2,
+        utility::Workspace *workspace) {
+    if (index_type == SearchIndexType::VoxelHash) {
+        VoxelHashIndex index(radius);
+        index.SetRawData(data);
+        return index.SearchRadiusCSR(query, radius, max_nn, offsets, indices,
+                                     distance2);
+    }
+    KDTreeFlann kdtree;
+    kdtree.SetWorkspace(workspace);
+    kdtree.SetRawData(data);
+    return kdtree.SearchRadiusCSR(query, radius, max_nn, offsets, indices,
+                                  distance2);
+}
+
+template bool VoxelHashIndex::SetRawData<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &data);
+template int VoxelHashIndex::Search<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        const KDTreeSearchParam &param,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int VoxelHashIndex::SearchKNN<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        int knn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int VoxelHashIndex::SearchRadius<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int VoxelHashIndex::SearchHybrid<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int VoxelHashIndex::SearchRadiusCSR<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        float radius,
+        int max_nn,
+        utility::device_vector<int> &offsets,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distance2) const;
+template int VoxelHashIndex::SearchKNNMeanDistance2<Eigen::Vector3f>(
+        const utility::device_vector<Eigen::Vector3f> &query,
+        int knn,
+        utility::device_vector<float> &mean_distance2) const;
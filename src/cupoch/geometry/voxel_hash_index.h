@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "cupoch/geometry/kdtree_search_param.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/workspace.h"
+
+namespace cupoch {
+namespace geometry {
+
+class Geometry;
+
+/// \class VoxelHashIndex
+///
+/// \brief Uniform grid spatial index stored in a GPU hash table.
+///
+/// Points are sorted by cell so that each cell is a contiguous range, and
+/// the occupied cells are kept in an open addressing hash table. The build
+/// is a radix sort plus a linear pass, which makes it cheaper than
+/// KDTreeFlann for clouds that change every frame. Radius searches are
+/// fastest when the cell size is close to the search radius.
+class VoxelHashIndex {
+public:
+    /// If \p cell_size is not positive, it is estimated from the point
+    /// density when the data is set.
+    explicit VoxelHashIndex(float cell_size = 0.0);
+    VoxelHashIndex(float cell_size, const Geometry &geometry);
+    ~VoxelHashIndex();
+    VoxelHashIndex(const VoxelHashIndex &) = delete;
+    VoxelHashIndex &operator=(const VoxelHashIndex &) = delete;
+
+public:
+    bool SetGeometry(const Geometry &geometry);
+
+    template <typename T>
+    int Search(const utility::device_vector<T> &query,
+               const KDTreeSearchParam &param,
+               utility::device_vector<int> &indices,
+               utility::device_vector<float> &distance2) const;
+
+    template <typename T>
+    int SearchKNN(const utility::device_vector<T> &query,
+                  int knn,
+                  utility::device_vector<int> &indices,
+                  utility::device_vector<float> &distance2) const;
+
+    template <typename T>
+    int SearchRadius(const utility::device_vector<T> &query,
+                     float radius,
+                     utility::device_vector<int> &indices,
+                     utility::device_vector<float> &distance2) const;
+
+    template <typename T>
+    int SearchHybrid(const utility::device_vector<T> &query,
+                     float radius,
+                     int max_nn,
+                     utility::device_vector<int> &indices,
+                     utility::device_vector<float> &distance2) const;
+
+    /// Radius search returning up to \p max_nn neighbors per query packed in
+    /// CSR layout, see KDTreeFlann::SearchRadiusCSR. The neighbors are
+    /// counted in a first pass, so no padded buffer is allocated.
+    template <typename T>
+    int SearchRadiusCSR(const utility::device_vector<T> &query,
+                        float radius,
+                        int max_nn,
+                        utility::device_vector<int> &offsets,
+                        utility::device_vector<int> &indices,
+                        utility::device_vector<float> &distance2) const;
+
+    /// KNN search that only writes the mean squared distance of the \p knn
+    /// nearest neighbors of every query (-1 if there are none). The
+    /// neighbors stay in registers, so the memory is O(n) instead of the
+    /// O(n * knn) of SearchKNN.
+    template <typename T>
+    int SearchKNNMeanDistance2(const utility::device_vector<T> &query,
+                               int knn,
+                               utility::device_vector<float> &mean_distance2)
+            const;
+
+    template <typename T>
+    bool SetRawData(const utility::device_vector<T> &data);
+
+    float GetCellSize() const { return cell_size_; }
+    size_t GetNumCells() const { return num_cells_; }
+
+protected:
+    template <typename T>
+    int SearchImpl(const utility::device_vector<T> &query,
+                   float radius,
+                   int max_nn,
+                   bool knn_mode,
+                   utility::device_vector<int> &indices,
+                   utility::device_vector<float> &distance2) const;
+
+    float cell_size_;
+    Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    int max_rings_ = 0;
+    size_t num_cells_ = 0;
+    utility::device_vector<Eigen::Vector3f> sorted_points_;
+    utility::device_vector<int> sorted_indices_;
+    utility::device_vector<unsigned long long> table_keys_;
+    utility::device_vector<Eigen::Vector2i> table_values_;
+};
+
+/// Builds the index selected by \p index_type on \p data and runs \p param
+/// for every point of \p query. The voxel hash uses the search radius as
+/// cell size for radius and hybrid searches.
+int SearchNeighbors(SearchIndexType index_type,
+                    const utility::device_vector<Eigen::Vector3f> &data,
+                    const utility::device_vector<Eigen::Vector3f> &query,
+                    const KDTreeSearchParam &param,
+                    utility::device_vector<int> &indices,
+                    utility::device_vector<float> &distance2,
+                    utility::Workspace *workspace = nullptr);
+
+/// Radius search with the index selected by \p index_type returning up to
+/// \p max_nn neighbors per query in CSR layout.
+int SearchNeighborsCSR(SearchIndexType index_type,
+                       const utility::device_vector<Eigen::Vector3f> &data,
+                       const utility::device_vector<Eigen::Vector3f> &query,
+                       float radius,
+                       int max_nn,
+                       utility::device_vector<int> &offsets,
+                       utility::device_vector<int> &indices,
+                       utility::device_vector<float> &distance2,
+                       utility::Workspace *workspace = nullptr);
+
+}  // namespace geometry
+}  // namespace cupoch
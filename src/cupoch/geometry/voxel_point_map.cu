@@ -0,0 +1,369 @@
+#include <thrust/copy.h>
+#include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/scan.h>
+#include <thrust/transform_reduce.h>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/voxel_point_map.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+namespace cupoch {
+namespace geometry {
+
+namespace {
+
+__device__ Eigen::Vector3i VoxelOf(const Eigen::Vector3f &point,
+                                   float voxel_size) {
+    const Eigen::Vector3f p = point / voxel_size;
+    return Eigen::Vector3i((int)floorf(p[0]), (int)floorf(p[1]),
+                           (int)floorf(p[2]));
+}
+
+__device__ int FindVoxel(const unsigned long long *table_keys,
+                         const int *table_values,
+                         unsigned int table_mask,
+                         const Eigen::Vector3i &voxel) {
+    const unsigned long long key = PackCellKey(voxel);
+    if (key == kEmptyCellKey) return -1;
+    unsigned int slot = HashCellKey(key) & table_mask;
+    for (unsigned int probe = 0; probe <= table_mask; ++probe) {
+        const unsigned long long k = table_keys[slot];
+        if (k == key) return table_values[slot];
+        if (k == kEmptyCellKey) return -1;
+        slot = (slot + 1) & table_mask;
+    }
+    return -1;
+}
+
+// Allocates the voxel of every point.
+struct allocate_voxel_functor {
+    allocate_voxel_functor(float voxel_size,
+                           unsigned long long *table_keys,
+                           int *table_values,
+                           unsigned int table_mask,
+                           Eigen::Vector3i *voxel_coords,
+                           int *voxel_counter,
+                           int max_num_voxels)
+        : voxel_size_(voxel_size),
+          table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask),
+          voxel_coords_(voxel_coords),
+          voxel_counter_(voxel_counter),
+          max_num_voxels_(max_num_voxels){};
+    const float voxel_size_;
+    unsigned long long *table_keys_;
+    int *table_values_;
+    const unsigned int table_mask_;
+    Eigen::Vector3i *voxel_coords_;
+    int *voxel_counter_;
+    const int max_num_voxels_;
+
+    __device__ void operator()(const Eigen::Vector3f &point) const {
+        const Eigen::Vector3i voxel = VoxelOf(point, voxel_size_);
+        const unsigned long long key = PackCellKey(voxel);
+        if (key == kEmptyCellKey) return;
+        unsigned int slot = HashCellKey(key) & table_mask_;
+        for (unsigned int probe = 0; probe <= table_mask_; ++probe) {
+            const unsigned long long prev =
+                    atomicCAS(&table_keys_[slot], kEmptyCellKey, key);
+            if (prev == kEmptyCellKey) {
+                const int v = atomicAdd(voxel_counter_, 1);
+                if (v < max_num_voxels_) {
+                    table_values_[slot] = v;
+                    voxel_coords_[v] = voxel;
+                }
+                return;
+            }
+            if (prev == key) return;
+            slot = (slot + 1) & table_mask_;
+        }
+    }
+};
+
+// Reinserts the voxel idx of the compacted voxel_coords_ in the cleared
+// table.
+struct reinsert_voxel_functor {
+    reinsert_voxel_functor(const Eigen::Vector3i *voxel_coords,
+                           unsigned long long *table_keys,
+                           int *table_values,
+                           unsigned int table_mask)
+        : voxel_coords_(voxel_coords),
+          table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask){};
+    const Eigen::Vector3i *voxel_coords_;
+    unsigned long long *table_keys_;
+    int *table_values_;
+    const unsigned int table_mask_;
+    __device__ void operator()(int idx) const {
+        const unsigned long long key = PackCellKey(voxel_coords_[idx]);
+        unsigned int slot = HashCellKey(key) & table_mask_;
+        while (atomicCAS(&table_keys_[slot], kEmptyCellKey, key) !=
+               kEmptyCellKey) {
+            slot = (slot + 1) & table_mask_;
+        }
+        table_values_[slot] = idx;
+    }
+};
+
+// Writes every point in a slot of its voxel. The slots are handed out by
+// the insertion count of the voxel, wrapping around onto the oldest points
+// with the ReplaceOldest policy. The count of a full voxel is then kept in
+// [max_points_per_voxel, 2 * max_points_per_voxel), its residue being the
+// next slot.
+struct insert_point_functor {
+    insert_point_functor(const unsigned long long *table_keys,
+                         const int *table_values,
+                         unsigned int table_mask,
+                         float voxel_size,
+                         int max_points_per_voxel,
+                         bool replace,
+                         int *voxel_counts,
+                         Eigen::Vector3f *points)
+        : table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask),
+          voxel_size_(voxel_size),
+          max_points_per_voxel_(max_points_per_voxel),
+          replace_(replace),
+          voxel_counts_(voxel_counts),
+          points_(points){};
+    const unsigned long long *table_keys_;
+    const int *table_values_;
+    const unsigned int table_mask_;
+    const float voxel_size_;
+    const int max_points_per_voxel_;
+    const bool replace_;
+    int *voxel_counts_;
+    Eigen::Vector3f *points_;
+    __device__ void operator()(const Eigen::Vector3f &point) const {
+        const int v = FindVoxel(table_keys_, table_values_, table_mask_,
+                                VoxelOf(point, voxel_size_));
+        if (v < 0) return;
+        if (!replace_ && voxel_counts_[v] >= max_points_per_voxel_) return;
+        const int n = atomicAdd(&voxel_counts_[v], 1);
+        if (n >= max_points_per_voxel_ && !replace_) return;
+        if (n >= 2 * max_points_per_voxel_) {
+            atomicSub(&voxel_counts_[v], max_points_per_voxel_);
+        }
+        points_[v * max_points_per_voxel_ + n % max_points_per_voxel_] = point;
+    }
+};
+
+// Slot of the pool of the point idx of the compacted voxels src.
+struct pool_index_functor {
+    pool_index_functor(const int *src, int max_points_per_voxel)
+        : src_(src), max_points_per_voxel_(max_points_per_voxel){};
+    const int *src_;
+    const int max_points_per_voxel_;
+    __device__ int operator()(int idx) const {
+        return src_[idx / max_points_per_voxel_] * max_points_per_voxel_ +
+               idx % max_points_per_voxel_;
+    }
+};
+
+struct is_held_point_functor {
+    is_held_point_functor(const int *voxel_counts, int max_points_per_voxel)
+        : voxel_counts_(voxel_counts),
+          max_points_per_voxel_(max_points_per_voxel){};
+    const int *voxel_counts_;
+    const int max_points_per_voxel_;
+    __device__ bool operator()(size_t idx) const {
+        return (int)(idx % max_points_per_voxel_) <
+               voxel_counts_[idx / max_points_per_voxel_];
+    }
+};
+
+}  // namespace
+
+VoxelPointMap::VoxelPointMap(
+        float voxel_size /* = 0.5*/,
+        int max_points_per_voxel /* = 20*/,
+        int max_num_voxels /* = 1 << 18*/,
+        ReplacementPolicy policy /* = ReplacementPolicy::KeepOldest*/)
+    : voxel_size_(voxel_size),
+      max_points_per_voxel_(max_points_per_voxel),
+      max_num_voxels_(max_num_voxels),
+      policy_(policy) {
+    if (voxel_size_ <= 0.0 || max_points_per_voxel_ <= 0 ||
+        max_num_voxels_ <= 0) {
+        utility::LogError(
+                "[VoxelPointMap] voxel_size, max_points_per_voxel and "
+                "max_num_voxels must be positive.");
+    }
+    // Keep the load factor of the table at most 1/2.
+    size_t capacity = 1;
+    while (capacity < 2 * (size_t)max_num_voxels_) capacity <<= 1;
+    table_keys_.resize(capacity);
+    table_values_.resize(capacity);
+    voxel_coords_.resize(max_num_voxels_);
+    voxel_counts_.resize(max_num_voxels_);
+    points_.resize((size_t)max_num_voxels_ * max_points_per_voxel_);
+    voxel_counter_.resize(1);
+    Clear();
+}
+
+VoxelPointMap::~VoxelPointMap() {}
+
+VoxelPointMap::VoxelPointMap(const VoxelPointMap &other)
+    : voxel_size_(other.voxel_size_),
+      max_points_per_voxel_(other.max_points_per_voxel_),
+      max_num_voxels_(other.max_num_voxels_),
+      policy_(other.policy_),
+      table_keys_(other.table_keys_),
+      table_values_(other.table_values_),
+      voxel_coords_(other.voxel_coords_),
+      voxel_counts_(other.voxel_counts_),
+      points_(other.points_),
+      voxel_counter_(other.voxel_counter_),
+      num_voxels_(other.num_voxels_) {}
+
+VoxelPointMap &VoxelPointMap::Clear() {
+    thrust::fill(table_keys_.begin(), table_keys_.end(), kEmptyCellKey);
+    thrust::fill(table_values_.begin(), table_values_.end(), -1);
+    thrust::fill(voxel_counts_.begin(), voxel_counts_.end(), 0);
+    voxel_counter_[0] = 0;
+    num_voxels_ = 0;
+    return *this;
+}
+
+size_t VoxelPointMap::GetNumPoints() const {
+    const int max_points = max_points_per_voxel_;
+    return thrust::transform_reduce(
+            voxel_counts_.begin(), voxel_counts_.begin() + num_voxels_,
+            [max_points] __device__(int n) {
+                return (size_t)min(n, max_points);
+            },
+            (size_t)0, thrust::plus<size_t>());
+}
+
+VoxelPointMap &VoxelPointMap::Insert(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const Eigen::Matrix4f &pose) {
+    if (points.empty()) return *this;
+    utility::device_vector<Eigen::Vector3f> map_points(points.size());
+    const Eigen::Matrix3f rot = pose.block<3, 3>(0, 0);
+    const Eigen::Vector3f trans = pose.block<3, 1>(0, 3);
+    thrust::transform(points.begin(), points.end(), map_points.begin(),
+                      [rot, trans] __device__(const Eigen::Vector3f &pt) {
+                          return Eigen::Vector3f(rot * pt + trans);
+                      });
+
+    const unsigned int table_mask = table_keys_.size() - 1;
+    allocate_voxel_functor alloc_func(
+            voxel_size_, thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()), table_mask,
+            thrust::raw_pointer_cast(voxel_coords_.data()),
+            thrust::raw_pointer_cast(voxel_counter_.data()), max_num_voxels_);
+    thrust::for_each(map_points.begin(), map_points.end(), alloc_func);
+    const int n_requested = voxel_counter_[0];
+    if (n_requested > max_num_voxels_) {
+        utility::LogWarning(
+                "[VoxelPointMap::Insert] {:d} voxels requested, only {:d} are "
+                "allocated.",
+                n_requested, max_num_voxels_);
+    }
+    num_voxels_ = std::min(n_requested, max_num_voxels_);
+
+    insert_point_functor point_func(
+            thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()), table_mask,
+            voxel_size_, max_points_per_voxel_,
+            policy_ == ReplacementPolicy::ReplaceOldest,
+            thrust::raw_pointer_cast(voxel_counts_.data()),
+            thrust::raw_pointer_cast(points_.data()));
+    thrust::for_each(map_points.begin(), map_points.end(), point_func);
+    return *this;
+}
+
+VoxelPointMap &VoxelPointMap::Insert(
+        const thrust::host_vector<Eigen::Vector3f> &points,
+        const Eigen::Matrix4f &pose) {
+    utility::device_vector<Eigen::Vector3f> dev_points = points;
+    return Insert(dev_points, pose);
+}
+
+VoxelPointMap &VoxelPointMap::Insert(const PointCloud &pointcloud,
+                                     const Eigen::Matrix4f &pose) {
+    return Insert(pointcloud.points_, pose);
+}
+
+VoxelPointMap &VoxelPointMap::RemoveFarVoxels(const Eigen::Vector3f &center,
+                                              float radius) {
+    if (num_voxels_ == 0) return *this;
+    const float voxel_size = voxel_size_;
+    const float radius2 = radius * radius;
+    utility::device_vector<int> kept(num_voxels_);
+    utility::device_vector<int> new_indices(num_voxels_);
+    thrust::transform(voxel_coords_.begin(),
+                      voxel_coords_.begin() + num_voxels_, kept.begin(),
+                      [center, voxel_size, radius2] __device__(
+                              const Eigen::Vector3i &v) {
+                          const Eigen::Vector3f c =
+                                  (v.cast<float>() +
+                                   Eigen::Vector3f::Constant(0.5)) *
+                                  voxel_size;
+                          return ((c - center).squaredNorm() <= radius2) ? 1
+                                                                         : 0;
+                      });
+    thrust::exclusive_scan(kept.begin(), kept.end(), new_indices.begin());
+    const int n_kept = new_indices.back() + kept.back();
+    if (n_kept == num_voxels_) return *this;
+
+    // Gathers the kept voxels and their points to the front of the pools.
+    utility::device_vector<int> src(n_kept);
+    thrust::copy_if(thrust::make_counting_iterator(0),
+                    thrust::make_counting_iterator(num_voxels_), kept.begin(),
+                    src.begin(), thrust::identity<int>());
+    utility::device_vector<Eigen::Vector3i> voxel_coords(max_num_voxels_);
+    utility::device_vector<int> voxel_counts(max_num_voxels_, 0);
+    thrust::gather(src.begin(), src.end(),
+                   make_tuple_begin(voxel_coords_, voxel_counts_),
+                   make_tuple_begin(voxel_coords, voxel_counts));
+    utility::device_vector<Eigen::Vector3f> points(points_.size());
+    pool_index_functor index_func(thrust::raw_pointer_cast(src.data()),
+                                  max_points_per_voxel_);
+    thrust::gather(
+            thrust::make_transform_iterator(thrust::make_counting_iterator(0),
+                                            index_func),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator(n_kept *
+                                                   max_points_per_voxel_),
+                    index_func),
+            points_.begin(), points.begin());
+    voxel_coords_.swap(voxel_coords);
+    voxel_counts_.swap(voxel_counts);
+    points_.swap(points);
+
+    thrust::fill(table_keys_.begin(), table_keys_.end(), kEmptyCellKey);
+    thrust::fill(table_values_.begin(), table_values_.end(), -1);
+    reinsert_voxel_functor func(thrust::raw_pointer_cast(voxel_coords_.data()),
+                                thrust::raw_pointer_cast(table_keys_.data()),
+                                thrust::raw_pointer_cast(table_values_.data()),
+                                (unsigned int)(table_keys_.size() - 1));
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_kept), func);
+    voxel_counter_[0] = n_kept;
+    num_voxels_ = n_kept;
+    return *this;
+}
+
+std::shared_ptr<PointCloud> VoxelPointMap::ExtractPointCloud() const {
+    auto pointcloud = std::make_shared<PointCloud>();
+    const size_t n_slots = (size_t)num_voxels_ * max_points_per_voxel_;
+    is_held_point_functor func(thrust::raw_pointer_cast(voxel_counts_.data()),
+                               max_points_per_voxel_);
+    pointcloud->points_.resize(GetNumPoints());
+    thrust::copy_if(points_.begin(), points_.begin() + n_slots,
+                    thrust::make_counting_iterator<size_t>(0),
+                    pointcloud->points_.begin(), func);
+    return pointcloud;
+}
+
+}  // namespace geometry
+}  // namespace cupoch
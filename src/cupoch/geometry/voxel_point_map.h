@@ -0,0 +1,94 @@
+#pragma once
+
+#include <thrust/host_vector.h>
+
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class PointCloud;
+
+/// \class VoxelPointMap
+///
+/// \brief Point map of bounded memory for long runs, holding at most
+/// max_points_per_voxel_ points in each of at most max_num_voxels_ voxels.
+///
+/// The voxels are kept in an open addressing hash table on the device,
+/// keyed by their integer coordinates floor(p / voxel_size_), and their
+/// points in one pool of max_num_voxels_ * max_points_per_voxel_ slots
+/// allocated up front. Unlike accumulating the scans with operator+= and
+/// VoxelDownSample(), the map does not grow with the run: Insert() adds the
+/// points of a registered scan until their voxel is full, then keeps or
+/// replaces them by the ReplacementPolicy, and RemoveFarVoxels() frees the
+/// voxels left behind by the robot. ExtractPointCloud() gives the target of
+/// RegistrationICP() or of a KDTreeFlann.
+class VoxelPointMap {
+public:
+    enum class ReplacementPolicy {
+        /// The points of a full voxel are kept, the new ones dropped.
+        KeepOldest = 0,
+        /// The new points of a full voxel overwrite its oldest ones.
+        ReplaceOldest = 1,
+    };
+
+    VoxelPointMap(float voxel_size = 0.5,
+                  int max_points_per_voxel = 20,
+                  int max_num_voxels = 1 << 18,
+                  ReplacementPolicy policy = ReplacementPolicy::KeepOldest);
+    ~VoxelPointMap();
+    VoxelPointMap(const VoxelPointMap &other);
+
+public:
+    VoxelPointMap &Clear();
+    bool IsEmpty() const { return num_voxels_ == 0; }
+    int GetNumVoxels() const { return num_voxels_; }
+    /// Number of points held by the voxels.
+    size_t GetNumPoints() const;
+
+    /// Adds \p points, transformed by \p pose into the map frame. The
+    /// points whose voxel cannot be allocated, the map being full, are
+    /// dropped.
+    VoxelPointMap &Insert(const utility::device_vector<Eigen::Vector3f> &points,
+                          const Eigen::Matrix4f &pose =
+                                  Eigen::Matrix4f::Identity());
+    VoxelPointMap &Insert(const thrust::host_vector<Eigen::Vector3f> &points,
+                          const Eigen::Matrix4f &pose =
+                                  Eigen::Matrix4f::Identity());
+    VoxelPointMap &Insert(const PointCloud &pointcloud,
+                          const Eigen::Matrix4f &pose =
+                                  Eigen::Matrix4f::Identity());
+    /// Frees the voxels whose center is farther than \p radius from
+    /// \p center. The remaining voxels are compacted and the table rebuilt.
+    VoxelPointMap &RemoveFarVoxels(const Eigen::Vector3f &center,
+                                   float radius);
+
+    /// Points of all the voxels.
+    std::shared_ptr<PointCloud> ExtractPointCloud() const;
+
+public:
+    float voxel_size_;
+    int max_points_per_voxel_;
+    int max_num_voxels_;
+    ReplacementPolicy policy_;
+    utility::device_vector<unsigned long long> table_keys_;
+    /// Voxel of each slot of the table, -1 for the empty slots.
+    utility::device_vector<int> table_values_;
+    /// Coordinates of the allocated voxels.
+    utility::device_vector<Eigen::Vector3i> voxel_coords_;
+    /// Number of points inserted in each voxel, of which at most
+    /// max_points_per_voxel_ are held.
+    utility::device_vector<int> voxel_counts_;
+    /// max_points_per_voxel_ slots per voxel, in the order of voxel_coords_.
+    utility::device_vector<Eigen::Vector3f> points_;
+
+private:
+    utility::device_vector<int> voxel_counter_;
+    int num_voxels_ = 0;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -1,10 +1,17 @@
 #include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/merge.h>
+#include <thrust/scatter.h>
+#include <thrust/sequence.h>
 
 #include "cupoch/camera/pinhole_camera_parameters.h"
 #include "cupoch/geometry/boundingvolume.h"
 #include "cupoch/geometry/image.h"
 #include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/geometry/voxelgrid_hash_map.h"
 #include "cupoch/geometry/geometry_functor.h"
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/utility/union_find.h"
 
 using namespace cupoch;
 using namespace cupoch::geometry;
@@ -26,6 +33,17 @@ struct add_voxel_color_functor {
     }
 };
 
+struct add_keyed_voxel_color_functor {
+    __device__ thrust::tuple<Eigen::Vector3i, Voxel> operator()(
+            const thrust::tuple<Eigen::Vector3i, Voxel> &x,
+            const thrust::tuple<Eigen::Vector3i, Voxel> &y) const {
+        return thrust::make_tuple(
+                thrust::get<0>(x),
+                add_voxel_color_functor()(thrust::get<1>(x),
+                                          thrust::get<1>(y)));
+    }
+};
+
 struct devide_voxel_color_functor {
     __device__ Voxel operator()(const Voxel &x, int y) const {
         Voxel ans;
@@ -35,6 +53,137 @@ struct devide_voxel_color_functor {
     }
 };
 
+// Morton codes of the keys, sorting the keys and values by them first
+// unless they already are in Morton order (e.g. after SetVoxels).
+utility::device_vector<MortonCode> SortVoxelsByMortonCode(
+        utility::device_vector<Eigen::Vector3i> &keys,
+        utility::device_vector<Voxel> &values) {
+    utility::device_vector<MortonCode> codes(keys.size());
+    thrust::transform(keys.begin(), keys.end(), codes.begin(),
+                      encode_morton_functor());
+    if (!thrust::is_sorted(codes.begin(), codes.end())) {
+        thrust::sort_by_key(codes.begin(), codes.end(),
+                            make_tuple_begin(keys, values));
+    }
+    return codes;
+}
+
+// Merges the voxels of \p keys and \p values, sorted by \p codes, into the
+// voxels of \p voxelgrid in O(n + m) with a parallel merge, without sorting
+// the combined voxels again. The merge is stable, so for an equal key the
+// voxels of \p voxelgrid come first. With \p average_colors the voxels of
+// an equal key are combined into their mean color, otherwise the first one
+// is kept.
+void MergeVoxels(VoxelGrid &voxelgrid,
+                 const utility::device_vector<MortonCode> &codes,
+                 const utility::device_vector<Eigen::Vector3i> &keys,
+                 const utility::device_vector<Voxel> &values,
+                 bool average_colors) {
+    auto grid_codes = SortVoxelsByMortonCode(voxelgrid.voxels_keys_,
+                                             voxelgrid.voxels_values_);
+    const size_t n = grid_codes.size() + codes.size();
+    utility::device_vector<MortonCode> merged_codes(n);
+    utility::device_vector<Eigen::Vector3i> merged_keys(n);
+    utility::device_vector<Voxel> merged_values(n);
+    thrust::merge_by_key(
+            grid_codes.begin(), grid_codes.end(), codes.begin(), codes.end(),
+            make_tuple_begin(voxelgrid.voxels_keys_, voxelgrid.voxels_values_),
+            make_tuple_begin(keys, values), merged_codes.begin(),
+            make_tuple_begin(merged_keys, merged_values));
+    if (average_colors) {
+        utility::device_vector<int> counts(n);
+        auto end1 = thrust::reduce_by_key(
+                merged_codes.begin(), merged_codes.end(),
+                thrust::make_constant_iterator(1),
+                thrust::make_discard_iterator(), counts.begin());
+        const size_t n_out = thrust::distance(counts.begin(), end1.second);
+        counts.resize(n_out);
+        resize_all(n_out, voxelgrid.voxels_keys_, voxelgrid.voxels_values_);
+        thrust::reduce_by_key(merged_codes.begin(), merged_codes.end(),
+                              make_tuple_begin(merged_keys, merged_values),
+                              thrust::make_discard_iterator(),
+                              make_tuple_begin(voxelgrid.voxels_keys_,
+                                               voxelgrid.voxels_values_),
+                              thrust::equal_to<MortonCode>(),
+                              add_keyed_voxel_color_functor());
+        thrust::transform(voxelgrid.voxels_values_.begin(),
+                          voxelgrid.voxels_values_.end(), counts.begin(),
+                          voxelgrid.voxels_values_.begin(),
+                          devide_voxel_color_functor());
+    } else {
+        auto end = thrust::unique_by_key(
+                merged_codes.begin(), merged_codes.end(),
+                make_tuple_begin(merged_keys, merged_values));
+        const size_t n_out = thrust::distance(merged_codes.begin(), end.first);
+        resize_all(n_out, merged_keys, merged_values);
+        voxelgrid.voxels_keys_.swap(merged_keys);
+        voxelgrid.voxels_values_.swap(merged_values);
+    }
+}
+
+struct union_voxel_neighbors_functor {
+    union_voxel_neighbors_functor(const MortonCode *codes,
+                                  int n_codes,
+                                  int connectivity,
+                                  int *parents)
+        : codes_(codes),
+          n_codes_(n_codes),
+          connectivity_(connectivity),
+          parents_(parents){};
+    const MortonCode *codes_;
+    const int n_codes_;
+    const int connectivity_;
+    int *parents_;
+    __device__ int Find(const Eigen::Vector3i &key) const {
+        if (!IsMortonEncodable(key)) return -1;
+        const MortonCode code = EncodeMorton(key);
+        int lo = 0;
+        int hi = n_codes_;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (codes_[mid] < code) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return (lo < n_codes_ && codes_[lo] == code) ? lo : -1;
+    }
+    __device__ void operator()(size_t idx) const {
+        const Eigen::Vector3i key = DecodeMorton(codes_[idx]);
+        // Only the neighbors in one half space are visited, the others
+        // visit this voxel.
+        for (int dx = 0; dx <= 1; ++dx) {
+            for (int dy = (dx == 0) ? 0 : -1; dy <= 1; ++dy) {
+                for (int dz = (dx == 0 && dy == 0) ? 1 : -1; dz <= 1; ++dz) {
+                    const int n_offsets = abs(dx) + abs(dy) + abs(dz);
+                    if ((connectivity_ == 6 && n_offsets > 1) ||
+                        (connectivity_ == 18 && n_offsets > 2))
+                        continue;
+                    const int j = Find(key + Eigen::Vector3i(dx, dy, dz));
+                    if (j >= 0) utility::UnionRoots(parents_, idx, j);
+                }
+            }
+        }
+    }
+};
+
+struct flatten_roots_functor {
+    flatten_roots_functor(int *parents) : parents_(parents){};
+    int *parents_;
+    __device__ int operator()(size_t idx) const {
+        return utility::FindRoot(parents_, idx);
+    }
+};
+
+struct is_root_functor {
+    is_root_functor(const int *roots) : roots_(roots){};
+    const int *roots_;
+    __device__ int operator()(size_t idx) const {
+        return (roots_[idx] == idx) ? 1 : 0;
+    }
+};
+
 __host__ __device__ void GetVoxelBoundingPoints(const Eigen::Vector3f &x,
                                                 float r,
                                                 Eigen::Vector3f points[8]) {
@@ -48,43 +197,57 @@ __host__ __device__ void GetVoxelBoundingPoints(const Eigen::Vector3f &x,
     points[7] = x + Eigen::Vector3f(r, r, r);
 }
 
+// Image and camera of a view, with the world to camera transform.
+template <typename T>
+struct carve_view {
+    ImageView<const T> image_;
+    Eigen::Matrix3f intrinsic_;
+    Eigen::Matrix3f rot_;
+    Eigen::Vector3f trans_;
+};
+
+// True if the voxel is carved by any of the views, tested in order until
+// one carves it. A depth map keeps the voxels with a boundary point at or
+// behind its depth, a silhouette mask those with a boundary point on a
+// pixel > 0.
+template <typename T, bool Silhouette>
 struct compute_carve_functor {
-    compute_carve_functor(const uint8_t *image,
-                          int width,
-                          int height,
-                          int num_of_channels,
-                          int bytes_per_channel,
+    compute_carve_functor(const carve_view<T> *views,
+                          int n_views,
                           float voxel_size,
                           const Eigen::Vector3f &origin,
-                          const Eigen::Matrix3f &intrinsic,
-                          const Eigen::Matrix3f &rot,
-                          const Eigen::Vector3f &trans,
                           bool keep_voxels_outside_image)
-        : image_(image),
-          width_(width),
-          height_(height),
-          num_of_channels_(num_of_channels),
-          bytes_per_channel_(bytes_per_channel),
+        : views_(views),
+          n_views_(n_views),
           voxel_size_(voxel_size),
           origin_(origin),
-          intrinsic_(intrinsic),
-          rot_(rot),
-          trans_(trans),
           keep_voxels_outside_image_(keep_voxels_outside_image){};
-    const uint8_t *image_;
-    const int width_;
-    const int height_;
-    const int num_of_channels_;
-    const int bytes_per_channel_;
+    const carve_view<T> *views_;
+    const int n_views_;
     const float voxel_size_;
     const Eigen::Vector3f origin_;
-    const Eigen::Matrix3f intrinsic_;
-    const Eigen::Matrix3f rot_;
-    const Eigen::Vector3f trans_;
     bool keep_voxels_outside_image_;
+    __device__ bool IsCarvedBy(const carve_view<T> &view,
+                               const Eigen::Vector3f pts[8]) const {
+        for (int i = 0; i < 8; ++i) {
+            auto x_trans = view.rot_ * pts[i] + view.trans_;
+            auto uvz = view.intrinsic_ * x_trans;
+            float z = uvz(2);
+            float u = uvz(0) / z;
+            float v = uvz(1) / z;
+            float d;
+            bool within_boundary;
+            thrust::tie(within_boundary, d) = view.image_.FloatValueAt(u, v);
+            if (!within_boundary && keep_voxels_outside_image_) return false;
+            if (within_boundary &&
+                (Silhouette ? d > 0 : (d > 0 && z >= d))) {
+                return false;
+            }
+        }
+        return true;
+    }
     __device__ bool operator()(
             const thrust::tuple<Eigen::Vector3i, Voxel> &voxel) const {
-        bool carve = true;
         float r = voxel_size_ / 2.0;
         const Voxel& vxl = thrust::get<1>(voxel);
         auto x = ((vxl.grid_index_.cast<float>() +
@@ -93,27 +256,42 @@ struct compute_carve_functor {
                  origin_;
         Eigen::Vector3f pts[8];
         GetVoxelBoundingPoints(x, r, pts);
-        for (int i = 0; i < 8; ++i) {
-            auto x_trans = rot_ * pts[i] + trans_;
-            auto uvz = intrinsic_ * x_trans;
-            float z = uvz(2);
-            float u = uvz(0) / z;
-            float v = uvz(1) / z;
-            float d;
-            bool within_boundary;
-            thrust::tie(within_boundary, d) =
-                    FloatValueAt(image_, u, v, width_, height_,
-                                 num_of_channels_, bytes_per_channel_);
-            if ((!within_boundary && keep_voxels_outside_image_) ||
-                (within_boundary && d > 0 && z >= d)) {
-                carve = false;
-                break;
-            }
+        for (int i = 0; i < n_views_; ++i) {
+            if (IsCarvedBy(views_[i], pts)) return true;
         }
-        return carve;
+        return false;
     }
 };
 
+template <typename T, bool Silhouette>
+void CarveViews(VoxelGrid &voxelgrid,
+                const std::vector<const Image *> &images,
+                const std::vector<camera::PinholeCameraParameters>
+                        &camera_parameters,
+                bool keep_voxels_outside_image) {
+    std::vector<carve_view<T>> h_views(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        const auto &param = camera_parameters[i];
+        if (images[i]->height_ != param.intrinsic_.height_ ||
+            images[i]->width_ != param.intrinsic_.width_) {
+            utility::LogError(
+                    "[VoxelGrid] provided image {:d} dimensions are not "
+                    "compatible with the provided camera_parameters",
+                    i);
+        }
+        h_views[i].image_ = MakeImageView<T>(*images[i]);
+        h_views[i].intrinsic_ = param.intrinsic_.intrinsic_matrix_;
+        h_views[i].rot_ = param.extrinsic_.block<3, 3>(0, 0);
+        h_views[i].trans_ = param.extrinsic_.block<3, 1>(0, 3);
+    }
+    utility::device_vector<carve_view<T>> views = h_views;
+    compute_carve_functor<T, Silhouette> func(
+            thrust::raw_pointer_cast(views.data()), views.size(),
+            voxelgrid.voxel_size_, voxelgrid.origin_,
+            keep_voxels_outside_image);
+    remove_if_vectors(func, voxelgrid.voxels_keys_, voxelgrid.voxels_values_);
+}
+
 }  // namespace
 
 VoxelGrid::VoxelGrid() : Geometry3D(Geometry::GeometryType::VoxelGrid) {}
@@ -125,6 +303,29 @@ origin_(src_voxel_grid.origin_),
 voxels_keys_(src_voxel_grid.voxels_keys_),
 voxels_values_(src_voxel_grid.voxels_values_) {}
 
+VoxelGrid::VoxelGrid(VoxelGrid &&src_voxel_grid)
+    : Geometry3D(Geometry::GeometryType::VoxelGrid),
+      voxel_size_(src_voxel_grid.voxel_size_),
+      origin_(src_voxel_grid.origin_),
+      voxels_keys_(std::move(src_voxel_grid.voxels_keys_)),
+      voxels_values_(std::move(src_voxel_grid.voxels_values_)) {}
+
+VoxelGrid &VoxelGrid::operator=(const VoxelGrid &src_voxel_grid) {
+    voxel_size_ = src_voxel_grid.voxel_size_;
+    origin_ = src_voxel_grid.origin_;
+    voxels_keys_ = src_voxel_grid.voxels_keys_;
+    voxels_values_ = src_voxel_grid.voxels_values_;
+    return *this;
+}
+
+VoxelGrid &VoxelGrid::operator=(VoxelGrid &&src_voxel_grid) {
+    voxel_size_ = src_voxel_grid.voxel_size_;
+    origin_ = src_voxel_grid.origin_;
+    voxels_keys_ = std::move(src_voxel_grid.voxels_keys_);
+    voxels_values_ = std::move(src_voxel_grid.voxels_values_);
+    return *this;
+}
+
 thrust::pair<thrust::host_vector<Eigen::Vector3i>, thrust::host_vector<Voxel>> VoxelGrid::GetVoxels() const {
     thrust::host_vector<Eigen::Vector3i> h_keys = voxels_keys_;
     thrust::host_vector<Voxel> h_values = voxels_values_;
@@ -235,34 +436,20 @@ VoxelGrid &VoxelGrid::operator+=(const VoxelGrid &voxelgrid) {
                 "[VoxelGrid] Could not combine VoxelGrid one has colors and "
                 "the other not.");
     }
-    if (voxelgrid.HasColors()) {
-        voxels_keys_.insert(voxels_keys_.end(), voxelgrid.voxels_keys_.begin(),
-                            voxelgrid.voxels_keys_.end());
-        voxels_values_.insert(voxels_values_.end(),
-                              voxelgrid.voxels_values_.begin(),
-                              voxelgrid.voxels_values_.end());
-        thrust::sort_by_key(voxels_keys_.begin(), voxels_keys_.end(),
-                            voxels_values_.begin());
-        utility::device_vector<int> counts(voxels_keys_.size());
-        utility::device_vector<Eigen::Vector3i> new_keys(voxels_keys_.size());
-        auto end1 = thrust::reduce_by_key(
-                voxels_keys_.begin(), voxels_keys_.end(),
-                thrust::make_constant_iterator(1),
-                thrust::make_discard_iterator(), counts.begin());
-        int n_out = thrust::distance(counts.begin(), end1.second);
-        counts.resize(n_out);
-        auto end2 = thrust::reduce_by_key(
-                voxels_keys_.begin(), voxels_keys_.end(),
-                voxels_values_.begin(), new_keys.begin(),
-                voxels_values_.begin(), thrust::equal_to<Eigen::Vector3i>(),
-                add_voxel_color_functor());
-        resize_all(n_out, new_keys, voxels_values_);
-        thrust::swap(voxels_keys_, new_keys);
-        thrust::transform(voxels_values_.begin(), voxels_values_.end(),
-                          counts.begin(), voxels_values_.begin(),
-                          devide_voxel_color_functor());
+    utility::device_vector<Eigen::Vector3i> keys;
+    utility::device_vector<Voxel> values;
+    utility::device_vector<MortonCode> codes(voxelgrid.voxels_keys_.size());
+    thrust::transform(voxelgrid.voxels_keys_.begin(),
+                      voxelgrid.voxels_keys_.end(), codes.begin(),
+                      encode_morton_functor());
+    if (thrust::is_sorted(codes.begin(), codes.end())) {
+        MergeVoxels(*this, codes, voxelgrid.voxels_keys_,
+                    voxelgrid.voxels_values_, voxelgrid.HasColors());
     } else {
-        this->AddVoxels(voxelgrid.voxels_values_);
+        keys = voxelgrid.voxels_keys_;
+        values = voxelgrid.voxels_values_;
+        codes = SortVoxelsByMortonCode(keys, values);
+        MergeVoxels(*this, codes, keys, values, voxelgrid.HasColors());
     }
     return *this;
 }
@@ -272,27 +459,19 @@ VoxelGrid VoxelGrid::operator+(const VoxelGrid &voxelgrid) const {
 }
 
 void VoxelGrid::AddVoxel(const Voxel &voxel) {
-    voxels_keys_.push_back(voxel.grid_index_);
-    voxels_values_.push_back(voxel);
-    thrust::sort_by_key(voxels_keys_.begin(), voxels_keys_.end(),
-                        voxels_values_.begin());
-    auto end = thrust::unique_by_key(voxels_keys_.begin(), voxels_keys_.end(),
-                                     voxels_values_.begin());
-    resize_all(thrust::distance(voxels_keys_.begin(), end.first), voxels_keys_, voxels_values_);
+    utility::device_vector<Eigen::Vector3i> keys(1, voxel.grid_index_);
+    utility::device_vector<Voxel> values(1, voxel);
+    utility::device_vector<MortonCode> codes(1, EncodeMorton(voxel.grid_index_));
+    MergeVoxels(*this, codes, keys, values, false);
 }
 
 void VoxelGrid::AddVoxels(const utility::device_vector<Voxel> &voxels) {
-    voxels_keys_.insert(voxels_keys_.end(),
-                        thrust::make_transform_iterator(
-                                voxels.begin(), extract_grid_index_functor()),
-                        thrust::make_transform_iterator(
-                                voxels.end(), extract_grid_index_functor()));
-    voxels_values_.insert(voxels_values_.end(), voxels.begin(), voxels.end());
-    thrust::sort_by_key(voxels_keys_.begin(), voxels_keys_.end(),
-                        voxels_values_.begin());
-    auto end = thrust::unique_by_key(voxels_keys_.begin(), voxels_keys_.end(),
-                                     voxels_values_.begin());
-    resize_all(thrust::distance(voxels_keys_.begin(), end.first), voxels_keys_, voxels_values_);
+    utility::device_vector<Eigen::Vector3i> keys(voxels.size());
+    thrust::transform(voxels.begin(), voxels.end(), keys.begin(),
+                      extract_grid_index_functor());
+    utility::device_vector<Voxel> values = voxels;
+    auto codes = SortVoxelsByMortonCode(keys, values);
+    MergeVoxels(*this, codes, keys, values, false);
 }
 
 void VoxelGrid::AddVoxels(const thrust::host_vector<Voxel> &voxels) {
@@ -329,40 +508,62 @@ std::array<Eigen::Vector3f, 8> VoxelGrid::GetVoxelBoundingPoints(
 
 thrust::host_vector<bool> VoxelGrid::CheckIfIncluded(
         const thrust::host_vector<Eigen::Vector3f> &queries) {
-    thrust::host_vector<bool> output;
-    output.resize(queries.size());
-    for (size_t i = 0; i < queries.size(); ++i) {
-        auto query = GetVoxel(queries[i]);
-        auto itr =
-                thrust::find(voxels_keys_.begin(), voxels_keys_.end(), query);
-        output[i] = (itr != voxels_keys_.end());
-    }
+    utility::device_vector<Eigen::Vector3f> d_queries = queries;
+    thrust::host_vector<bool> output = CheckIfIncluded(d_queries);
     return output;
 }
 
+utility::device_vector<bool> VoxelGrid::CheckIfIncluded(
+        const utility::device_vector<Eigen::Vector3f> &queries) const {
+    return VoxelGridHashMap(*this).CheckIfIncluded(queries);
+}
+
+utility::device_vector<int> VoxelGrid::ConnectedComponents(
+        int connectivity) const {
+    if (connectivity != 6 && connectivity != 18 && connectivity != 26) {
+        utility::LogError(
+                "[ConnectedComponents] connectivity must be 6, 18 or 26.");
+        return utility::device_vector<int>();
+    }
+    const size_t n = voxels_keys_.size();
+    utility::device_vector<MortonCode> codes(n);
+    thrust::transform(voxels_keys_.begin(), voxels_keys_.end(), codes.begin(),
+                      encode_morton_functor());
+    utility::device_vector<int> perm(n);
+    thrust::sequence(perm.begin(), perm.end());
+    thrust::sort_by_key(codes.begin(), codes.end(), perm.begin());
+    utility::device_vector<int> parents(n);
+    thrust::sequence(parents.begin(), parents.end());
+    union_voxel_neighbors_functor func(
+            thrust::raw_pointer_cast(codes.data()), n, connectivity,
+            thrust::raw_pointer_cast(parents.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n), func);
+    utility::device_vector<int> roots(n);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n), roots.begin(),
+                      flatten_roots_functor(
+                              thrust::raw_pointer_cast(parents.data())));
+    utility::device_vector<int> ids(n);
+    thrust::transform(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(n), ids.begin(),
+            is_root_functor(thrust::raw_pointer_cast(roots.data())));
+    thrust::exclusive_scan(ids.begin(), ids.end(), ids.begin());
+    utility::device_vector<int> labels(n);
+    thrust::scatter(thrust::make_permutation_iterator(ids.begin(),
+                                                      roots.begin()),
+                    thrust::make_permutation_iterator(ids.begin(), roots.end()),
+                    perm.begin(), labels.begin());
+    return labels;
+}
+
 VoxelGrid &VoxelGrid::CarveDepthMap(
         const Image &depth_map,
         const camera::PinholeCameraParameters &camera_parameter,
         bool keep_voxels_outside_image) {
-    if (depth_map.height_ != camera_parameter.intrinsic_.height_ ||
-        depth_map.width_ != camera_parameter.intrinsic_.width_) {
-        utility::LogError(
-                "[VoxelGrid] provided depth_map dimensions are not compatible "
-                "with the provided camera_parameters");
-    }
-
-    auto rot = camera_parameter.extrinsic_.block<3, 3>(0, 0);
-    auto trans = camera_parameter.extrinsic_.block<3, 1>(0, 3);
-    auto intrinsic = camera_parameter.intrinsic_.intrinsic_matrix_;
-
-    // get for each voxel if it projects to a valid pixel and check if the voxel
-    // depth is behind the depth of the depth map at the projected pixel.
-    compute_carve_functor func(
-            thrust::raw_pointer_cast(depth_map.data_.data()), depth_map.width_,
-            depth_map.height_, depth_map.num_of_channels_,
-            depth_map.bytes_per_channel_, voxel_size_, origin_, intrinsic, rot,
-            trans, keep_voxels_outside_image);
-    remove_if_vectors(func, voxels_keys_, voxels_values_);
+    CarveViews<float, false>(*this, {&depth_map}, {camera_parameter},
+                             keep_voxels_outside_image);
     return *this;
 }
 
@@ -370,25 +571,57 @@ VoxelGrid &VoxelGrid::CarveSilhouette(
         const Image &silhouette_mask,
         const camera::PinholeCameraParameters &camera_parameter,
         bool keep_voxels_outside_image) {
-    if (silhouette_mask.height_ != camera_parameter.intrinsic_.height_ ||
-        silhouette_mask.width_ != camera_parameter.intrinsic_.width_) {
-        utility::LogError(
-                "[VoxelGrid] provided silhouette_mask dimensions are not "
-                "compatible with the provided camera_parameters");
+    if (silhouette_mask.bytes_per_channel_ == 1) {
+        CarveViews<uint8_t, true>(*this, {&silhouette_mask}, {camera_parameter},
+                                  keep_voxels_outside_image);
+    } else {
+        CarveViews<float, true>(*this, {&silhouette_mask}, {camera_parameter},
+                                keep_voxels_outside_image);
     }
+    return *this;
+}
 
-    auto rot = camera_parameter.extrinsic_.block<3, 3>(0, 0);
-    auto trans = camera_parameter.extrinsic_.block<3, 1>(0, 3);
-    auto intrinsic = camera_parameter.intrinsic_.intrinsic_matrix_;
+VoxelGrid &VoxelGrid::CarveDepthMaps(
+        const std::vector<std::shared_ptr<Image>> &depth_maps,
+        const std::vector<camera::PinholeCameraParameters> &camera_parameters,
+        bool keep_voxels_outside_image) {
+    if (depth_maps.size() != camera_parameters.size()) {
+        utility::LogError(
+                "[VoxelGrid] The numbers of depth maps ({}) and camera "
+                "parameters ({}) differ.",
+                depth_maps.size(), camera_parameters.size());
+    }
+    if (depth_maps.empty()) return *this;
+    // get for each voxel if it projects to a valid pixel and check if the voxel
+    // depth is behind the depth of the depth map at the projected pixel.
+    std::vector<const Image *> images;
+    for (const auto &depth_map : depth_maps) images.push_back(depth_map.get());
+    CarveViews<float, false>(*this, images, camera_parameters,
+                             keep_voxels_outside_image);
+    return *this;
+}
 
+VoxelGrid &VoxelGrid::CarveSilhouettes(
+        const std::vector<std::shared_ptr<Image>> &silhouette_masks,
+        const std::vector<camera::PinholeCameraParameters> &camera_parameters,
+        bool keep_voxels_outside_image) {
+    if (silhouette_masks.size() != camera_parameters.size()) {
+        utility::LogError(
+                "[VoxelGrid] The numbers of silhouette masks ({}) and camera "
+                "parameters ({}) differ.",
+                silhouette_masks.size(), camera_parameters.size());
+    }
+    if (silhouette_masks.empty()) return *this;
     // get for each voxel if it projects to a valid pixel and check if the pixel
     // is set (>0).
-    compute_carve_functor func(
-            thrust::raw_pointer_cast(silhouette_mask.data_.data()),
-            silhouette_mask.width_, silhouette_mask.height_,
-            silhouette_mask.num_of_channels_,
-            silhouette_mask.bytes_per_channel_, voxel_size_, origin_, intrinsic,
-            rot, trans, keep_voxels_outside_image);
-    remove_if_vectors(func, voxels_keys_, voxels_values_);
+    std::vector<const Image *> images;
+    for (const auto &mask : silhouette_masks) images.push_back(mask.get());
+    if (images[0]->bytes_per_channel_ == 1) {
+        CarveViews<uint8_t, true>(*this, images, camera_parameters,
+                                  keep_voxels_outside_image);
+    } else {
+        CarveViews<float, true>(*this, images, camera_parameters,
+                                keep_voxels_outside_image);
+    }
     return *this;
 }
@@ -4,6 +4,7 @@
 
 #include <Eigen/Core>
 #include <memory>
+#include <vector>
 
 #include "cupoch/geometry/geometry3d.h"
 #include "cupoch/utility/console.h"
@@ -44,7 +45,11 @@ class VoxelGrid : public Geometry3D {
 public:
     VoxelGrid();
     VoxelGrid(const VoxelGrid &src_voxel_grid);
+    /// The moves hand the device buffers over without copying them.
+    VoxelGrid(VoxelGrid &&src_voxel_grid);
     ~VoxelGrid();
+    VoxelGrid &operator=(const VoxelGrid &src_voxel_grid);
+    VoxelGrid &operator=(VoxelGrid &&src_voxel_grid);
 
     thrust::pair<thrust::host_vector<Eigen::Vector3i>, thrust::host_vector<Voxel>> GetVoxels() const;
     void SetVoxels(const thrust::host_vector<Eigen::Vector3i>& voxels_keys, const thrust::host_vector<Voxel>& voxels_values);
@@ -87,6 +92,19 @@ public:
     // Queries are double precision and are mapped to the closest voxel.
     thrust::host_vector<bool> CheckIfIncluded(
             const thrust::host_vector<Eigen::Vector3f> &queries);
+    /// Same as above for queries on the device, looked up in a
+    /// VoxelGridHashMap of the grid. Build the VoxelGridHashMap once to
+    /// look up many batches.
+    utility::device_vector<bool> CheckIfIncluded(
+            const utility::device_vector<Eigen::Vector3f> &queries) const;
+
+    /// Labels the connected components of the occupied voxels.
+    /// \param connectivity is 6 (faces), 18 (faces and edges) or 26 (faces,
+    /// edges and corners).
+    /// Returns the component label of every voxel in voxels_keys_ order.
+    /// Labels are consecutive from 0 and ordered by the smallest voxel key of
+    /// each component.
+    utility::device_vector<int> ConnectedComponents(int connectivity = 26) const;
 
     /// Remove all voxels from the VoxelGrid where none of the boundary points
     /// of the voxel projects to depth value that is smaller, or equal than the
@@ -107,6 +125,23 @@ public:
             const camera::PinholeCameraParameters &camera_parameter,
             bool keep_voxels_outside_image);
 
+    /// Same as CarveDepthMap() for all the views at once. Every voxel is
+    /// tested against the views in order until one carves it, in a single
+    /// pass over the voxels.
+    VoxelGrid &CarveDepthMaps(
+            const std::vector<std::shared_ptr<Image>> &depth_maps,
+            const std::vector<camera::PinholeCameraParameters>
+                    &camera_parameters,
+            bool keep_voxels_outside_image);
+
+    /// Same as CarveSilhouette() for all the views at once, as in
+    /// CarveDepthMaps(). The masks are all uint8 or all float images.
+    VoxelGrid &CarveSilhouettes(
+            const std::vector<std::shared_ptr<Image>> &silhouette_masks,
+            const std::vector<camera::PinholeCameraParameters>
+                    &camera_parameters,
+            bool keep_voxels_outside_image);
+
     // Creates a voxel grid where every voxel is set (hence dense). This is a
     // useful starting point for voxel carving.
     static std::shared_ptr<VoxelGrid> CreateDense(const Eigen::Vector3f &origin,
@@ -147,9 +182,39 @@ public:
             const Eigen::Vector3f &min_bound,
             const Eigen::Vector3f &max_bound);
 
+    // Creates a VoxelGrid of the voxels of a given TriangleMesh and of the
+    // voxels whose centers are inside of it, by the majority of the parities
+    // of the crossings of rays along the three axes. The mesh should be
+    // closed. The bounds of the created VoxelGrid are computed from the
+    // TriangleMesh.
+    static std::shared_ptr<VoxelGrid> CreateSolidFromTriangleMesh(
+            const TriangleMesh &input, float voxel_size);
+
+    // Same as CreateSolidFromTriangleMesh, with the bounds of the created
+    // VoxelGrid defined by the given parameters.
+    static std::shared_ptr<VoxelGrid> CreateSolidFromTriangleMeshWithinBounds(
+            const TriangleMesh &input,
+            float voxel_size,
+            const Eigen::Vector3f &min_bound,
+            const Eigen::Vector3f &max_bound);
+
+    // Dense mask of the voxels of CreateSolidFromTriangleMeshWithinBounds, 1
+    // in the solid. The voxel (w, h, d) is at (w * num_h + h) * num_d + d,
+    // num_h and num_d being the rounded numbers of voxels in y and z, as in
+    // CreateDense.
+    static utility::device_vector<uint8_t> ComputeSolidMaskFromTriangleMesh(
+            const TriangleMesh &input,
+            float voxel_size,
+            const Eigen::Vector3f &min_bound,
+            const Eigen::Vector3f &max_bound);
+
 public:
     float voxel_size_ = 0.0;
     Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    /// Voxel indices. The factories, AddVoxels and operator+= keep them
+    /// unique and sorted in Morton order (see morton_code.h), so that
+    /// AddVoxels and operator+= merge the sorted voxels in O(n + m) instead
+    /// of sorting all of them again.
     utility::device_vector<Eigen::Vector3i> voxels_keys_;
     utility::device_vector<Voxel> voxels_values_;
 };
@@ -1,9 +1,13 @@
+#include <thrust/binary_search.h>
 #include <thrust/iterator/discard_iterator.h>
 
 #include <numeric>
 
+#include "cupoch/geometry/boundingvolume.h"
 #include "cupoch/geometry/intersection_test.h"
+#include "cupoch/geometry/morton_code.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/raycasting_scene.h"
 #include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/utility/console.h"
@@ -66,59 +70,337 @@ struct create_from_pointcloud_functor {
     }
 };
 
-struct create_from_trianglemesh_functor {
-    create_from_trianglemesh_functor(const Eigen::Vector3f *vertices,
-                                     const Eigen::Vector3i *triangles,
-                                     int n_triangles,
-                                     const Eigen::Vector3f &min_bound,
-                                     float voxel_size,
-                                     int num_h,
-                                     int num_d)
-        : vertices_(vertices),
-          triangles_(triangles),
-          n_triangles_(n_triangles),
-          min_bound_(min_bound),
+/// Edge, in voxels, of the tiles binning the triangles before the voxel
+/// tests.
+constexpr int kVoxelizerTileSize = 8;
+
+struct voxelizer_grid {
+    voxelizer_grid(const Eigen::Vector3f &min_bound,
+                   float voxel_size,
+                   const Eigen::Vector3i &resolution)
+        : min_bound_(min_bound),
           voxel_size_(voxel_size),
-          box_half_size_(Eigen::Vector3f(
-                  voxel_size / 2, voxel_size / 2, voxel_size / 2)),
-          num_h_(num_h),
-          num_d_(num_d){};
+          resolution_(resolution){};
+    const Eigen::Vector3f min_bound_;
+    const float voxel_size_;
+    const Eigen::Vector3i resolution_;
+
+    /// Inclusive range of the voxels covered by the bounds of the
+    /// triangle, false when the bounds miss the grid.
+    __device__ bool TriangleRange(const Eigen::Vector3f &v0,
+                                  const Eigen::Vector3f &v1,
+                                  const Eigen::Vector3f &v2,
+                                  Eigen::Vector3i &lo,
+                                  Eigen::Vector3i &hi) const {
+        const Eigen::Vector3f tmin = v0.cwiseMin(v1).cwiseMin(v2);
+        const Eigen::Vector3f tmax = v0.cwiseMax(v1).cwiseMax(v2);
+        for (int i = 0; i < 3; ++i) {
+            const float fmin = floorf((tmin[i] - min_bound_[i]) / voxel_size_);
+            const float fmax = floorf((tmax[i] - min_bound_[i]) / voxel_size_);
+            if (fmax < 0.0f || fmin > resolution_[i] - 1) return false;
+            lo[i] = (int)fmaxf(fmin, 0.0f);
+            hi[i] = (int)fminf(fmax, resolution_[i] - 1);
+        }
+        return true;
+    }
+    /// Overlap of the triangle and the box of the inclusive voxel range.
+    __device__ bool Overlaps(const Eigen::Vector3i &lo,
+                             const Eigen::Vector3i &hi,
+                             const Eigen::Vector3f &v0,
+                             const Eigen::Vector3f &v1,
+                             const Eigen::Vector3f &v2) const {
+        const Eigen::Vector3f half =
+                (hi - lo + Eigen::Vector3i::Ones()).cast<float>() *
+                (0.5f * voxel_size_);
+        const Eigen::Vector3f center =
+                min_bound_ + lo.cast<float>() * voxel_size_ + half;
+        return intersection_test::TriangleAABB(center, half, v0, v1, v2);
+    }
+};
+
+/// Tiles overlapped by every triangle, counted, then written from the
+/// offsets.
+struct bin_triangles_functor {
+    bin_triangles_functor(const voxelizer_grid &grid,
+                          const Eigen::Vector3f *vertices,
+                          const Eigen::Vector3i *triangles,
+                          const int *offsets = nullptr,
+                          int *pair_triangles = nullptr,
+                          Eigen::Vector3i *pair_tiles = nullptr)
+        : grid_(grid),
+          vertices_(vertices),
+          triangles_(triangles),
+          offsets_(offsets),
+          pair_triangles_(pair_triangles),
+          pair_tiles_(pair_tiles){};
+    const voxelizer_grid grid_;
+    const Eigen::Vector3f *vertices_;
+    const Eigen::Vector3i *triangles_;
+    const int *offsets_;
+    int *pair_triangles_;
+    Eigen::Vector3i *pair_tiles_;
+    __device__ int operator()(size_t idx) const {
+        const Eigen::Vector3i &tri = triangles_[idx];
+        const Eigen::Vector3f &v0 = vertices_[tri[0]];
+        const Eigen::Vector3f &v1 = vertices_[tri[1]];
+        const Eigen::Vector3f &v2 = vertices_[tri[2]];
+        Eigen::Vector3i lo, hi;
+        if (!grid_.TriangleRange(v0, v1, v2, lo, hi)) return 0;
+        const Eigen::Vector3i tlo = lo / kVoxelizerTileSize;
+        const Eigen::Vector3i thi = hi / kVoxelizerTileSize;
+        int n = 0;
+        for (int x = tlo[0]; x <= thi[0]; ++x) {
+            for (int y = tlo[1]; y <= thi[1]; ++y) {
+                for (int z = tlo[2]; z <= thi[2]; ++z) {
+                    const Eigen::Vector3i tile(x, y, z);
+                    const Eigen::Vector3i tile_lo = tile * kVoxelizerTileSize;
+                    const Eigen::Vector3i tile_hi =
+                            tile_lo + Eigen::Vector3i::Constant(
+                                              kVoxelizerTileSize - 1);
+                    if (!grid_.Overlaps(tile_lo.cwiseMax(lo),
+                                        tile_hi.cwiseMin(hi), v0, v1, v2)) {
+                        continue;
+                    }
+                    if (pair_tiles_) {
+                        pair_triangles_[offsets_[idx] + n] = idx;
+                        pair_tiles_[offsets_[idx] + n] = tile;
+                    }
+                    ++n;
+                }
+            }
+        }
+        return n;
+    }
+};
+
+/// Voxels of a tile overlapped by a triangle, counted, then written from
+/// the offsets.
+struct voxelize_tile_functor {
+    voxelize_tile_functor(const voxelizer_grid &grid,
+                          const Eigen::Vector3f *vertices,
+                          const Eigen::Vector3i *triangles,
+                          const int *offsets = nullptr,
+                          Eigen::Vector3i *voxel_keys = nullptr)
+        : grid_(grid),
+          vertices_(vertices),
+          triangles_(triangles),
+          offsets_(offsets),
+          voxel_keys_(voxel_keys){};
+    const voxelizer_grid grid_;
     const Eigen::Vector3f *vertices_;
     const Eigen::Vector3i *triangles_;
-    const int n_triangles_;
+    const int *offsets_;
+    Eigen::Vector3i *voxel_keys_;
+    __device__ int operator()(
+            const thrust::tuple<size_t, int, Eigen::Vector3i> &x) const {
+        const Eigen::Vector3i &tri = triangles_[thrust::get<1>(x)];
+        const Eigen::Vector3f &v0 = vertices_[tri[0]];
+        const Eigen::Vector3f &v1 = vertices_[tri[1]];
+        const Eigen::Vector3f &v2 = vertices_[tri[2]];
+        Eigen::Vector3i lo, hi;
+        grid_.TriangleRange(v0, v1, v2, lo, hi);
+        const Eigen::Vector3i tile_lo = thrust::get<2>(x) * kVoxelizerTileSize;
+        lo = lo.cwiseMax(tile_lo);
+        hi = hi.cwiseMin(tile_lo +
+                         Eigen::Vector3i::Constant(kVoxelizerTileSize - 1));
+        int n = 0;
+        for (int i = lo[0]; i <= hi[0]; ++i) {
+            for (int j = lo[1]; j <= hi[1]; ++j) {
+                for (int k = lo[2]; k <= hi[2]; ++k) {
+                    const Eigen::Vector3i key(i, j, k);
+                    if (!grid_.Overlaps(key, key, v0, v1, v2)) continue;
+                    if (voxel_keys_) {
+                        voxel_keys_[offsets_[thrust::get<0>(x)] + n] = key;
+                    }
+                    ++n;
+                }
+            }
+        }
+        return n;
+    }
+};
+
+/// Origin of the ray along the axis of the column idx of the grid, below
+/// the mesh. The rays are shifted off the voxel centers by a small
+/// fraction of a voxel, so that they miss the edges and vertices of the
+/// meshes aligned with the grid.
+struct column_ray_functor {
+    column_ray_functor(const Eigen::Vector3f &min_bound,
+                       float voxel_size,
+                       int axis,
+                       int n_c,
+                       float start)
+        : min_bound_(min_bound),
+          voxel_size_(voxel_size),
+          axis_(axis),
+          n_c_(n_c),
+          start_(start){};
     const Eigen::Vector3f min_bound_;
     const float voxel_size_;
-    const Eigen::Vector3f box_half_size_;
-    const int num_h_;
-    const int num_d_;
-    __device__ thrust::tuple<Eigen::Vector3i, geometry::Voxel> operator()(
-            size_t idx) const {
-        int widx = idx / (num_h_ * num_d_);
-        int hdidx = idx % (num_h_ * num_d_);
-        int hidx = hdidx / num_d_;
-        int didx = hdidx % num_d_;
+    const int axis_;
+    const int n_c_;
+    const float start_;
+    __device__ Eigen::Vector3f operator()(size_t idx) const {
+        const int b = (axis_ + 1) % 3;
+        const int c = (axis_ + 2) % 3;
+        Eigen::Vector3f origin;
+        origin[axis_] = start_;
+        origin[b] = min_bound_[b] + (idx / n_c_ + 0.5113f) * voxel_size_;
+        origin[c] = min_bound_[c] + (idx % n_c_ + 0.5071f) * voxel_size_;
+        return origin;
+    }
+};
 
-        const Eigen::Vector3f box_center =
-                min_bound_ + Eigen::Vector3f(widx, hidx, didx) * voxel_size_;
-        for (int i = 0; i < n_triangles_; ++i) {
-            Eigen::Vector3i tri = triangles_[i];
-            const Eigen::Vector3f &v0 = vertices_[tri(0)];
-            const Eigen::Vector3f &v1 = vertices_[tri(1)];
-            const Eigen::Vector3f &v2 = vertices_[tri(2)];
-            if (intersection_test::TriangleAABB(box_center, box_half_size_, v0,
-                                                v1, v2)) {
-                Eigen::Vector3i grid_index(widx, hidx, didx);
-                return thrust::make_tuple(grid_index,
-                                          geometry::Voxel(grid_index));
-            }
+/// Inside of the mesh by the majority of the parities of the hits below
+/// the voxel center along the three axes.
+struct solid_mask_functor {
+    solid_mask_functor(const Eigen::Vector3f &min_bound,
+                       float voxel_size,
+                       const Eigen::Vector3i &resolution,
+                       const Eigen::Vector3f &starts,
+                       const int *offsets0,
+                       const float *t_hits0,
+                       const int *offsets1,
+                       const float *t_hits1,
+                       const int *offsets2,
+                       const float *t_hits2)
+        : min_bound_(min_bound),
+          voxel_size_(voxel_size),
+          resolution_(resolution),
+          starts_(starts),
+          offsets_{offsets0, offsets1, offsets2},
+          t_hits_{t_hits0, t_hits1, t_hits2} {};
+    const Eigen::Vector3f min_bound_;
+    const float voxel_size_;
+    const Eigen::Vector3i resolution_;
+    const Eigen::Vector3f starts_;
+    const int *offsets_[3];
+    const float *t_hits_[3];
+    __device__ uint8_t operator()(size_t idx, uint8_t surface) const {
+        if (surface) return 1;
+        const int num_h = resolution_[1];
+        const int num_d = resolution_[2];
+        const Eigen::Vector3i key(idx / (num_h * num_d),
+                                  (idx % (num_h * num_d)) / num_d,
+                                  idx % num_d);
+        int votes = 0;
+        for (int a = 0; a < 3; ++a) {
+            const int b = (a + 1) % 3;
+            const int c = (a + 2) % 3;
+            const int col = key[b] * resolution_[c] + key[c];
+            const float t = min_bound_[a] + (key[a] + 0.5f) * voxel_size_ -
+                            starts_[a];
+            const float *begin = t_hits_[a] + offsets_[a][col];
+            const float *end = t_hits_[a] + offsets_[a][col + 1];
+            const int n_below =
+                    thrust::lower_bound(thrust::seq, begin, end, t) - begin;
+            votes += n_below & 1;
         }
-        return thrust::make_tuple(Eigen::Vector3i(INVALID_VOXEL_INDEX,
-                                                  INVALID_VOXEL_INDEX,
-                                                  INVALID_VOXEL_INDEX),
-                                  geometry::Voxel());
+        return votes >= 2;
+    }
+};
+
+struct mask_voxel_functor {
+    mask_voxel_functor(int num_h, int num_d, uint8_t *mask)
+        : num_h_(num_h), num_d_(num_d), mask_(mask){};
+    const int num_h_;
+    const int num_d_;
+    uint8_t *mask_;
+    __device__ void operator()(const Eigen::Vector3i &key) const {
+        mask_[(key[0] * num_h_ + key[1]) * num_d_ + key[2]] = 1;
     }
 };
 
+/// Unique keys of the voxels within the resolution overlapped by the
+/// triangles, in Morton order. The triangles are first binned into the
+/// tiles of kVoxelizerTileSize^3 voxels that they overlap, then tested
+/// against the voxels of every tile, so the work follows the surface of the
+/// triangles rather than the volume of their bounds.
+utility::device_vector<Eigen::Vector3i> VoxelizeTriangles(
+        const TriangleMesh &input,
+        const Eigen::Vector3f &min_bound,
+        float voxel_size,
+        const Eigen::Vector3i &resolution) {
+    utility::device_vector<Eigen::Vector3i> keys;
+    const size_t n_tri = input.triangles_.size();
+    if (n_tri == 0 || (resolution.array() <= 0).any()) return keys;
+    const voxelizer_grid grid(min_bound, voxel_size, resolution);
+    const Eigen::Vector3f *vertices =
+            thrust::raw_pointer_cast(input.vertices_.data());
+    const Eigen::Vector3i *triangles =
+            thrust::raw_pointer_cast(input.triangles_.data());
+
+    utility::device_vector<int> offsets(n_tri + 1, 0);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_tri), offsets.begin(),
+                      bin_triangles_functor(grid, vertices, triangles));
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    const int n_pairs = offsets.back();
+    if (n_pairs == 0) return keys;
+    utility::device_vector<int> pair_triangles(n_pairs);
+    utility::device_vector<Eigen::Vector3i> pair_tiles(n_pairs);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_tri),
+                      thrust::make_discard_iterator(),
+                      bin_triangles_functor(
+                              grid, vertices, triangles,
+                              thrust::raw_pointer_cast(offsets.data()),
+                              thrust::raw_pointer_cast(pair_triangles.data()),
+                              thrust::raw_pointer_cast(pair_tiles.data())));
+
+    auto pairs_begin = make_tuple_iterator(
+            thrust::make_counting_iterator<size_t>(0), pair_triangles.begin(),
+            pair_tiles.begin());
+    auto pairs_end = make_tuple_iterator(
+            thrust::make_counting_iterator<size_t>(n_pairs),
+            pair_triangles.end(), pair_tiles.end());
+    offsets.resize(n_pairs + 1);
+    offsets.back() = 0;
+    thrust::transform(pairs_begin, pairs_end, offsets.begin(),
+                      voxelize_tile_functor(grid, vertices, triangles));
+    thrust::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    keys.resize(offsets.back());
+    thrust::transform(pairs_begin, pairs_end, thrust::make_discard_iterator(),
+                      voxelize_tile_functor(
+                              grid, vertices, triangles,
+                              thrust::raw_pointer_cast(offsets.data()),
+                              thrust::raw_pointer_cast(keys.data())));
+    // The keys are unique once their codes are.
+    utility::device_vector<MortonCode> codes(keys.size());
+    thrust::transform(keys.begin(), keys.end(), codes.begin(),
+                      encode_morton_functor());
+    thrust::sort(codes.begin(), codes.end());
+    codes.resize(thrust::distance(codes.begin(),
+                                  thrust::unique(codes.begin(), codes.end())));
+    keys.resize(codes.size());
+    thrust::transform(codes.begin(), codes.end(), keys.begin(),
+                      decode_morton_functor());
+    return keys;
+}
+
+Eigen::Vector3i GridResolution(const Eigen::Vector3f &min_bound,
+                               const Eigen::Vector3f &max_bound,
+                               float voxel_size) {
+    const Eigen::Vector3f grid_size = max_bound - min_bound;
+    return Eigen::Vector3i(int(std::round(grid_size(0) / voxel_size)),
+                           int(std::round(grid_size(1) / voxel_size)),
+                           int(std::round(grid_size(2) / voxel_size)));
+}
+
+bool CheckTriangleMeshBounds(float voxel_size,
+                             const Eigen::Vector3f &min_bound,
+                             const Eigen::Vector3f &max_bound) {
+    if (voxel_size <= 0.0) {
+        utility::LogError("[CreateFromTriangleMesh] voxel_size <= 0.");
+        return false;
+    }
+    if (voxel_size * kMortonKeyOffset < (max_bound - min_bound).maxCoeff()) {
+        utility::LogError("[CreateFromTriangleMesh] voxel_size is too small.");
+        return false;
+    }
+    return true;
+}
+
 }  // namespace
 
 std::shared_ptr<VoxelGrid> VoxelGrid::CreateDense(const Eigen::Vector3f &origin,
@@ -139,9 +421,7 @@ std::shared_ptr<VoxelGrid> VoxelGrid::CreateDense(const Eigen::Vector3f &origin,
                       thrust::make_counting_iterator<size_t>(n_total),
                       make_tuple_begin(output->voxels_keys_, output->voxels_values_),
                       func);
-    thrust::sort_by_key(output->voxels_keys_.begin(),
-                        output->voxels_keys_.end(),
-                        output->voxels_values_.begin());
+    SortByMortonCode(output->voxels_keys_, output->voxels_values_.begin());
     auto end = thrust::unique_by_key(output->voxels_keys_.begin(),
                                      output->voxels_keys_.end(),
                                      output->voxels_values_.begin());
@@ -160,8 +440,7 @@ std::shared_ptr<VoxelGrid> VoxelGrid::CreateFromPointCloudWithinBounds(
         utility::LogError("[VoxelGridFromPointCloud] voxel_size <= 0.");
     }
 
-    if (voxel_size * std::numeric_limits<int>::max() <
-        (max_bound - min_bound).maxCoeff()) {
+    if (voxel_size * kMortonKeyOffset < (max_bound - min_bound).maxCoeff()) {
         utility::LogError("[VoxelGridFromPointCloud] voxel_size is too small.");
     }
     output->voxel_size_ = voxel_size;
@@ -183,8 +462,7 @@ std::shared_ptr<VoxelGrid> VoxelGrid::CreateFromPointCloudWithinBounds(
                 make_tuple_begin(voxels_keys, voxels_values),
                 func);
     }
-    thrust::sort_by_key(voxels_keys.begin(), voxels_keys.end(),
-                        voxels_values.begin());
+    SortByMortonCode(voxels_keys, voxels_values.begin());
 
     utility::device_vector<int> counts(voxels_keys.size());
     auto end = thrust::reduce_by_key(voxels_keys.begin(), voxels_keys.end(),
@@ -210,8 +488,9 @@ std::shared_ptr<VoxelGrid> VoxelGrid::CreateFromPointCloudWithinBounds(
 std::shared_ptr<VoxelGrid> VoxelGrid::CreateFromPointCloud(
         const PointCloud &input, float voxel_size) {
     Eigen::Vector3f voxel_size3(voxel_size, voxel_size, voxel_size);
-    Eigen::Vector3f min_bound = input.GetMinBound() - voxel_size3 * 0.5;
-    Eigen::Vector3f max_bound = input.GetMaxBound() + voxel_size3 * 0.5;
+    const AxisAlignedBoundingBox box = input.GetAxisAlignedBoundingBox();
+    Eigen::Vector3f min_bound = box.min_bound_ - voxel_size3 * 0.5;
+    Eigen::Vector3f max_bound = box.max_bound_ + voxel_size3 * 0.5;
     return CreateFromPointCloudWithinBounds(input, voxel_size, min_bound,
                                             max_bound);
 }
@@ -222,46 +501,124 @@ std::shared_ptr<VoxelGrid> VoxelGrid::CreateFromTriangleMeshWithinBounds(
         const Eigen::Vector3f &min_bound,
         const Eigen::Vector3f &max_bound) {
     auto output = std::make_shared<VoxelGrid>();
-    if (voxel_size <= 0.0) {
-        utility::LogError("[CreateFromTriangleMesh] voxel_size <= 0.");
-    }
-
-    if (voxel_size * std::numeric_limits<int>::max() <
-        (max_bound - min_bound).maxCoeff()) {
-        utility::LogError("[CreateFromTriangleMesh] voxel_size is too small.");
+    if (!CheckTriangleMeshBounds(voxel_size, min_bound, max_bound)) {
+        return output;
     }
     output->voxel_size_ = voxel_size;
     output->origin_ = min_bound;
-
-    Eigen::Vector3f grid_size = max_bound - min_bound;
-    int num_w = int(std::round(grid_size(0) / voxel_size));
-    int num_h = int(std::round(grid_size(1) / voxel_size));
-    int num_d = int(std::round(grid_size(2) / voxel_size));
-    size_t n_total = num_w * num_h * num_d;
-    create_from_trianglemesh_functor func(
-            thrust::raw_pointer_cast(input.vertices_.data()),
-            thrust::raw_pointer_cast(input.triangles_.data()),
-            input.triangles_.size(), min_bound, voxel_size, num_h, num_d);
-    resize_all(n_total, output->voxels_keys_, output->voxels_values_);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_total),
-                      make_tuple_begin(output->voxels_keys_, output->voxels_values_),
-                      func);
-    auto check_fn = [] __device__(const thrust::tuple<Eigen::Vector3i, geometry::Voxel> &x) -> bool {
-        Eigen::Vector3i idxs = thrust::get<0>(x);
-        return idxs == Eigen::Vector3i(INVALID_VOXEL_INDEX,
-                                       INVALID_VOXEL_INDEX,
-                                       INVALID_VOXEL_INDEX);
-    };
-    remove_if_vectors(check_fn, output->voxels_keys_, output->voxels_values_);
+    output->voxels_keys_ = VoxelizeTriangles(
+            input, min_bound, voxel_size,
+            GridResolution(min_bound, max_bound, voxel_size));
+    output->voxels_values_.resize(output->voxels_keys_.size());
+    thrust::transform(output->voxels_keys_.begin(), output->voxels_keys_.end(),
+                      output->voxels_values_.begin(),
+                      [] __device__(const Eigen::Vector3i &key) {
+                          return geometry::Voxel(key);
+                      });
     return output;
 }
 
 std::shared_ptr<VoxelGrid> VoxelGrid::CreateFromTriangleMesh(
         const TriangleMesh &input, float voxel_size) {
     Eigen::Vector3f voxel_size3(voxel_size, voxel_size, voxel_size);
-    Eigen::Vector3f min_bound = input.GetMinBound() - voxel_size3 * 0.5;
-    Eigen::Vector3f max_bound = input.GetMaxBound() + voxel_size3 * 0.5;
+    const AxisAlignedBoundingBox box = input.GetAxisAlignedBoundingBox();
+    Eigen::Vector3f min_bound = box.min_bound_ - voxel_size3 * 0.5;
+    Eigen::Vector3f max_bound = box.max_bound_ + voxel_size3 * 0.5;
     return CreateFromTriangleMeshWithinBounds(input, voxel_size, min_bound,
                                               max_bound);
-}
\ No newline at end of file
+}
+
+utility::device_vector<uint8_t> VoxelGrid::ComputeSolidMaskFromTriangleMesh(
+        const TriangleMesh &input,
+        float voxel_size,
+        const Eigen::Vector3f &min_bound,
+        const Eigen::Vector3f &max_bound) {
+    utility::device_vector<uint8_t> mask;
+    if (!CheckTriangleMeshBounds(voxel_size, min_bound, max_bound)) {
+        return mask;
+    }
+    const Eigen::Vector3i resolution =
+            GridResolution(min_bound, max_bound, voxel_size);
+    if ((resolution.array() <= 0).any()) return mask;
+    const size_t n_total = resolution.cast<size_t>().prod();
+    mask.resize(n_total, 0);
+    if (input.triangles_.empty()) return mask;
+    const auto surface =
+            VoxelizeTriangles(input, min_bound, voxel_size, resolution);
+    thrust::for_each(surface.begin(), surface.end(),
+                     mask_voxel_functor(resolution[1], resolution[2],
+                                        thrust::raw_pointer_cast(mask.data())));
+
+    // One ray per column of the grid along every axis, from below the mesh.
+    RaycastingScene scene;
+    scene.AddTriangles(input);
+    const Eigen::Vector3f starts =
+            input.GetMinBound().cwiseMin(min_bound) -
+            Eigen::Vector3f::Constant(voxel_size);
+    utility::device_vector<int> offsets[3];
+    utility::device_vector<float> t_hits[3];
+    for (int a = 0; a < 3; ++a) {
+        const int n_b = resolution[(a + 1) % 3];
+        const int n_c = resolution[(a + 2) % 3];
+        const size_t n_cols = n_b * n_c;
+        utility::device_vector<Eigen::Vector3f> origins(n_cols);
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(n_cols),
+                          origins.begin(),
+                          column_ray_functor(min_bound, voxel_size, a, n_c,
+                                             starts[a]));
+        utility::device_vector<Eigen::Vector3f> directions(
+                n_cols, Eigen::Vector3f::Unit(a));
+        scene.ListIntersections(origins, directions, offsets[a], t_hits[a]);
+    }
+    solid_mask_functor func(min_bound, voxel_size, resolution, starts,
+                            thrust::raw_pointer_cast(offsets[0].data()),
+                            thrust::raw_pointer_cast(t_hits[0].data()),
+                            thrust::raw_pointer_cast(offsets[1].data()),
+                            thrust::raw_pointer_cast(t_hits[1].data()),
+                            thrust::raw_pointer_cast(offsets[2].data()),
+                            thrust::raw_pointer_cast(t_hits[2].data()));
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_total), mask.begin(),
+                      mask.begin(), func);
+    return mask;
+}
+
+std::shared_ptr<VoxelGrid> VoxelGrid::CreateSolidFromTriangleMeshWithinBounds(
+        const TriangleMesh &input,
+        float voxel_size,
+        const Eigen::Vector3f &min_bound,
+        const Eigen::Vector3f &max_bound) {
+    auto output = std::make_shared<VoxelGrid>();
+    const auto mask = ComputeSolidMaskFromTriangleMesh(input, voxel_size,
+                                                       min_bound, max_bound);
+    if (mask.empty()) return output;
+    output->voxel_size_ = voxel_size;
+    output->origin_ = min_bound;
+    const Eigen::Vector3i resolution =
+            GridResolution(min_bound, max_bound, voxel_size);
+    const size_t n_solid = thrust::count(mask.begin(), mask.end(), 1);
+    resize_all(n_solid, output->voxels_keys_, output->voxels_values_);
+    thrust::copy_if(thrust::make_transform_iterator(
+                            thrust::make_counting_iterator<size_t>(0),
+                            create_dense_functor(resolution[1], resolution[2])),
+                    thrust::make_transform_iterator(
+                            thrust::make_counting_iterator(mask.size()),
+                            create_dense_functor(resolution[1], resolution[2])),
+                    mask.begin(),
+                    make_tuple_begin(output->voxels_keys_,
+                                     output->voxels_values_),
+                    thrust::identity<uint8_t>());
+    SortByMortonCode(output->voxels_keys_, output->voxels_values_.begin());
+    return output;
+}
+
+std::shared_ptr<VoxelGrid> VoxelGrid::CreateSolidFromTriangleMesh(
+        const TriangleMesh &input, float voxel_size) {
+    Eigen::Vector3f voxel_size3(voxel_size, voxel_size, voxel_size);
+    const AxisAlignedBoundingBox box = input.GetAxisAlignedBoundingBox();
+    Eigen::Vector3f min_bound = box.min_bound_ - voxel_size3 * 0.5;
+    Eigen::Vector3f max_bound = box.max_bound_ + voxel_size3 * 0.5;
+    return CreateSolidFromTriangleMeshWithinBounds(input, voxel_size,
+                                                   min_bound, max_bound);
+}
@@ -0,0 +1,155 @@
+#include <thrust/iterator/counting_iterator.h>
+
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/geometry/voxelgrid_hash_map.h"
+#include "cupoch/utility/helper.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+
+namespace {
+
+__device__ int FindSlotValue(const unsigned long long *table_keys,
+                             const int *table_values,
+                             unsigned int table_mask,
+                             const Eigen::Vector3i &voxel) {
+    const unsigned long long key = PackCellKey(voxel);
+    if (key == kEmptyCellKey) return -1;
+    unsigned int slot = HashCellKey(key) & table_mask;
+    for (unsigned int probe = 0; probe <= table_mask; ++probe) {
+        const unsigned long long k = table_keys[slot];
+        if (k == key) return table_values[slot];
+        if (k == kEmptyCellKey) return -1;
+        slot = (slot + 1) & table_mask;
+    }
+    return -1;
+}
+
+// Inserts the voxel idx of voxels_keys_, which are unique, in the table.
+// The voxels out of the range of PackCellKey are left out.
+struct insert_voxel_functor {
+    insert_voxel_functor(const Eigen::Vector3i *voxels,
+                         unsigned long long *table_keys,
+                         int *table_values,
+                         unsigned int table_mask)
+        : voxels_(voxels),
+          table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask){};
+    const Eigen::Vector3i *voxels_;
+    unsigned long long *table_keys_;
+    int *table_values_;
+    const unsigned int table_mask_;
+    __device__ void operator()(int idx) const {
+        const unsigned long long key = PackCellKey(voxels_[idx]);
+        if (key == kEmptyCellKey) return;
+        unsigned int slot = HashCellKey(key) & table_mask_;
+        while (atomicCAS(&table_keys_[slot], kEmptyCellKey, key) !=
+               kEmptyCellKey) {
+            slot = (slot + 1) & table_mask_;
+        }
+        table_values_[slot] = idx;
+    }
+};
+
+struct find_voxel_functor {
+    find_voxel_functor(const unsigned long long *table_keys,
+                       const int *table_values,
+                       unsigned int table_mask)
+        : table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask){};
+    const unsigned long long *table_keys_;
+    const int *table_values_;
+    const unsigned int table_mask_;
+    __device__ int operator()(const Eigen::Vector3i &voxel) const {
+        return FindSlotValue(table_keys_, table_values_, table_mask_, voxel);
+    }
+};
+
+struct find_point_functor {
+    find_point_functor(const unsigned long long *table_keys,
+                       const int *table_values,
+                       unsigned int table_mask,
+                       float voxel_size,
+                       const Eigen::Vector3f &origin)
+        : table_keys_(table_keys),
+          table_values_(table_values),
+          table_mask_(table_mask),
+          voxel_size_(voxel_size),
+          origin_(origin){};
+    const unsigned long long *table_keys_;
+    const int *table_values_;
+    const unsigned int table_mask_;
+    const float voxel_size_;
+    const Eigen::Vector3f origin_;
+    __device__ int operator()(const Eigen::Vector3f &point) const {
+        const Eigen::Vector3f v = (point - origin_) / voxel_size_;
+        const Eigen::Vector3i voxel((int)floorf(v[0]), (int)floorf(v[1]),
+                                    (int)floorf(v[2]));
+        return FindSlotValue(table_keys_, table_values_, table_mask_, voxel);
+    }
+};
+
+}  // namespace
+
+VoxelGridHashMap::VoxelGridHashMap()
+    : table_keys_(1, kEmptyCellKey), table_values_(1, -1) {}
+
+VoxelGridHashMap::VoxelGridHashMap(const VoxelGrid &voxelgrid) {
+    SetVoxelGrid(voxelgrid);
+}
+
+VoxelGridHashMap::~VoxelGridHashMap() {}
+
+VoxelGridHashMap &VoxelGridHashMap::SetVoxelGrid(const VoxelGrid &voxelgrid) {
+    voxel_size_ = voxelgrid.voxel_size_;
+    origin_ = voxelgrid.origin_;
+    num_voxels_ = voxelgrid.voxels_keys_.size();
+    size_t capacity = 1;
+    while (capacity < 2 * num_voxels_) capacity <<= 1;
+    table_keys_.resize(capacity);
+    table_values_.resize(capacity);
+    thrust::fill(table_keys_.begin(), table_keys_.end(), kEmptyCellKey);
+    thrust::fill(table_values_.begin(), table_values_.end(), -1);
+    insert_voxel_functor func(
+            thrust::raw_pointer_cast(voxelgrid.voxels_keys_.data()),
+            thrust::raw_pointer_cast(table_keys_.data()),
+            thrust::raw_pointer_cast(table_values_.data()), capacity - 1);
+    thrust::for_each(thrust::make_counting_iterator<int>(0),
+                     thrust::make_counting_iterator<int>(num_voxels_), func);
+    return *this;
+}
+
+utility::device_vector<int> VoxelGridHashMap::Find(
+        const utility::device_vector<Eigen::Vector3i> &voxels) const {
+    utility::device_vector<int> indices(voxels.size());
+    find_voxel_functor func(thrust::raw_pointer_cast(table_keys_.data()),
+                            thrust::raw_pointer_cast(table_values_.data()),
+                            table_keys_.size() - 1);
+    thrust::transform(voxels.begin(), voxels.end(), indices.begin(), func);
+    return indices;
+}
+
+utility::device_vector<int> VoxelGridHashMap::FindPoints(
+        const utility::device_vector<Eigen::Vector3f> &queries) const {
+    utility::device_vector<int> indices(queries.size());
+    find_point_functor func(thrust::raw_pointer_cast(table_keys_.data()),
+                            thrust::raw_pointer_cast(table_values_.data()),
+                            table_keys_.size() - 1, voxel_size_, origin_);
+    thrust::transform(queries.begin(), queries.end(), indices.begin(), func);
+    return indices;
+}
+
+utility::device_vector<bool> VoxelGridHashMap::CheckIfIncluded(
+        const utility::device_vector<Eigen::Vector3f> &queries) const {
+    utility::device_vector<bool> included(queries.size());
+    find_point_functor func(thrust::raw_pointer_cast(table_keys_.data()),
+                            thrust::raw_pointer_cast(table_values_.data()),
+                            table_keys_.size() - 1, voxel_size_, origin_);
+    thrust::transform(queries.begin(), queries.end(), included.begin(),
+                      [func] __device__(const Eigen::Vector3f &query) {
+                          return func(query) >= 0;
+                      });
+    return included;
+}
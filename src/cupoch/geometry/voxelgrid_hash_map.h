@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace geometry {
+
+class VoxelGrid;
+
+/// \class VoxelGridHashMap
+///
+/// \brief Open addressing hash table on the device from the voxel indices
+/// of a VoxelGrid to their positions in voxels_keys_.
+///
+/// The table holds at least twice as many slots as voxels, so a lookup is
+/// a few probes whatever the size of the grid, and the queries are looked
+/// up in one pass with the results left on the device. The positions index
+/// voxels_values_ as well, e.g. to gather per-point voxel labels. The map
+/// does not follow later changes of the grid and has to be built again.
+class VoxelGridHashMap {
+public:
+    VoxelGridHashMap();
+    explicit VoxelGridHashMap(const VoxelGrid &voxelgrid);
+    ~VoxelGridHashMap();
+
+public:
+    VoxelGridHashMap &SetVoxelGrid(const VoxelGrid &voxelgrid);
+    size_t GetNumVoxels() const { return num_voxels_; }
+
+    /// Position in voxels_keys_ of every voxel index of \p voxels, -1 for
+    /// the voxels not in the grid.
+    utility::device_vector<int> Find(
+            const utility::device_vector<Eigen::Vector3i> &voxels) const;
+    /// Position in voxels_keys_ of the voxel of every point of \p queries,
+    /// mapped as in VoxelGrid::GetVoxel, -1 for the points out of the grid.
+    utility::device_vector<int> FindPoints(
+            const utility::device_vector<Eigen::Vector3f> &queries) const;
+    /// Element-wise check if a query is included in the grid, as in
+    /// VoxelGrid::CheckIfIncluded.
+    utility::device_vector<bool> CheckIfIncluded(
+            const utility::device_vector<Eigen::Vector3f> &queries) const;
+
+public:
+    float voxel_size_ = 0.0;
+    Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    utility::device_vector<unsigned long long> table_keys_;
+    /// Position in voxels_keys_ of the voxel of each slot of the table.
+    utility::device_vector<int> table_values_;
+
+private:
+    size_t num_voxels_ = 0;
+};
+
+}  // namespace geometry
+}  // namespace cupoch
@@ -0,0 +1,223 @@
+#include <thrust/sort.h>
+#include <thrust/unique.h>
+
+#include <algorithm>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/integration/multi_device_tsdfvolume.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/multi_device.h"
+
+using namespace cupoch;
+using namespace cupoch::integration;
+
+namespace {
+
+// Keys of the 26 neighbors of every block.
+struct neighbor_block_keys_functor {
+    neighbor_block_keys_functor(const Eigen::Vector3i *block_coords)
+        : block_coords_(block_coords){};
+    const Eigen::Vector3i *block_coords_;
+    __device__ unsigned long long operator()(size_t idx) const {
+        const Eigen::Vector3i &block = block_coords_[idx / 26];
+        int k = idx % 26;
+        if (k >= 13) ++k;
+        const Eigen::Vector3i offset(k / 9 - 1, (k / 3) % 3 - 1, k % 3 - 1);
+        return PackCellKey(block + offset);
+    }
+};
+
+struct unpack_cell_key_functor {
+    __device__ Eigen::Vector3i operator()(unsigned long long key) const {
+        return UnpackCellKey(key);
+    }
+};
+
+void CopyImageFromDevice(const geometry::Image &src,
+                         int src_device,
+                         geometry::Image &dst) {
+    dst.width_ = src.width_;
+    dst.height_ = src.height_;
+    dst.num_of_channels_ = src.num_of_channels_;
+    dst.bytes_per_channel_ = src.bytes_per_channel_;
+    utility::CopyFromDevice(src.data_, src_device, dst.data_);
+}
+
+void CopyToDevice(const geometry::PointCloud &src,
+                  int dst_device,
+                  geometry::PointCloud &dst) {
+    utility::CopyToDevice(src.points_, dst_device, dst.points_);
+    utility::CopyToDevice(src.normals_, dst_device, dst.normals_);
+    utility::CopyToDevice(src.colors_, dst_device, dst.colors_);
+}
+
+void CopyToDevice(const geometry::TriangleMesh &src,
+                  int dst_device,
+                  geometry::TriangleMesh &dst) {
+    utility::CopyToDevice(src.vertices_, dst_device, dst.vertices_);
+    utility::CopyToDevice(src.vertex_colors_, dst_device, dst.vertex_colors_);
+    utility::CopyToDevice(src.triangles_, dst_device, dst.triangles_);
+}
+
+}  // namespace
+
+MultiDeviceScalableTSDFVolume::MultiDeviceScalableTSDFVolume(
+        float voxel_length,
+        float sdf_trunc,
+        TSDFVolumeColorType color_type,
+        const std::vector<int> &devices,
+        int max_num_blocks,
+        int depth_sampling_stride)
+    : TSDFVolume(voxel_length, sdf_trunc, color_type),
+      devices_(utility::ResolveDevices(devices)) {
+    utility::EnablePeerAccess(devices_);
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        utility::DeviceScope scope(devices_[i]);
+        shards_.emplace_back(new ScalableTSDFVolume(voxel_length, sdf_trunc,
+                                                    color_type, max_num_blocks,
+                                                    depth_sampling_stride));
+        shards_.back()->SetShard(int(i), int(devices_.size()));
+    }
+}
+
+MultiDeviceScalableTSDFVolume::~MultiDeviceScalableTSDFVolume() {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        utility::DeviceScope scope(devices_[i]);
+        shards_[i].reset();
+    }
+}
+
+void MultiDeviceScalableTSDFVolume::Reset() {
+    utility::ParallelForDevices(devices_,
+                                [this](size_t i) { shards_[i]->Reset(); });
+}
+
+void MultiDeviceScalableTSDFVolume::Integrate(
+        const geometry::RGBDImage &image,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) {
+    const int primary = utility::GetDevice();
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        geometry::RGBDImage frame;
+        CopyImageFromDevice(image.color_, primary, frame.color_);
+        CopyImageFromDevice(image.depth_, primary, frame.depth_);
+        shards_[i]->Integrate(frame, intrinsic, extrinsic);
+    });
+}
+
+int MultiDeviceScalableTSDFVolume::GetNumBlocks() const {
+    int n_blocks = 0;
+    for (const auto &shard : shards_) n_blocks += shard->GetNumBlocks();
+    return n_blocks;
+}
+
+void MultiDeviceScalableTSDFVolume::ForEachShardWithHalo(
+        const std::function<void(size_t, ScalableTSDFVolume &, int)> &func)
+        const {
+    const size_t n_shards = shards_.size();
+
+    // The neighbors of the blocks of every shard.
+    std::vector<utility::device_vector<Eigen::Vector3i>> neighbors(n_shards);
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        const ScalableTSDFVolume &shard = *shards_[i];
+        utility::device_vector<unsigned long long> keys(
+                (size_t)shard.GetNumBlocks() * 26);
+        thrust::transform(
+                thrust::make_counting_iterator<size_t>(0),
+                thrust::make_counting_iterator(keys.size()), keys.begin(),
+                neighbor_block_keys_functor(
+                        thrust::raw_pointer_cast(shard.block_coords_.data())));
+        thrust::sort(keys.begin(), keys.end());
+        keys.resize(thrust::distance(
+                keys.begin(), thrust::unique(keys.begin(), keys.end())));
+        // The keys out of the grid sort last.
+        if (!keys.empty() && keys.back() == kEmptyCellKey) keys.pop_back();
+        neighbors[i].resize(keys.size());
+        thrust::transform(keys.begin(), keys.end(), neighbors[i].begin(),
+                          unpack_cell_key_functor());
+    });
+
+    // Halo exchange: every shard looks the neighbors of the others up in its
+    // table and sends the blocks it holds to their device. halo_*[i][j] are
+    // the blocks of shard j for shard i, on the device of shard i.
+    std::vector<std::vector<utility::device_vector<Eigen::Vector3i>>>
+            halo_coords(n_shards, std::vector<utility::device_vector<
+                                          Eigen::Vector3i>>(n_shards));
+    std::vector<std::vector<utility::device_vector<ScalableTSDFVoxel>>>
+            halo_voxels(n_shards, std::vector<utility::device_vector<
+                                          ScalableTSDFVoxel>>(n_shards));
+    utility::ParallelForDevices(devices_, [&](size_t j) {
+        for (size_t i = 0; i < n_shards; ++i) {
+            if (i == j) continue;
+            utility::device_vector<Eigen::Vector3i> coords;
+            utility::CopyFromDevice(neighbors[i], devices_[i], coords);
+            utility::device_vector<Eigen::Vector3i> found_coords;
+            utility::device_vector<ScalableTSDFVoxel> voxels;
+            shards_[j]->GetBlocks(coords, found_coords, voxels);
+            utility::CopyToDevice(found_coords, devices_[i],
+                                  halo_coords[i][j]);
+            utility::CopyToDevice(voxels, devices_[i], halo_voxels[i][j]);
+        }
+    });
+
+    utility::ParallelForDevices(devices_, [&](size_t i) {
+        const ScalableTSDFVolume &shard = *shards_[i];
+        const int n_own = shard.GetNumBlocks();
+        // Released on this device.
+        std::vector<utility::device_vector<Eigen::Vector3i>> coords;
+        std::vector<utility::device_vector<ScalableTSDFVoxel>> voxels;
+        coords.swap(halo_coords[i]);
+        voxels.swap(halo_voxels[i]);
+        utility::device_vector<Eigen::Vector3i>().swap(neighbors[i]);
+        int n_blocks = n_own;
+        for (const auto &c : coords) n_blocks += int(c.size());
+
+        ScalableTSDFVolume volume(voxel_length_, sdf_trunc_, color_type_,
+                                  std::max(n_blocks, 1),
+                                  shard.depth_sampling_stride_);
+        volume.InsertBlocks(utility::device_vector<Eigen::Vector3i>(
+                                    shard.block_coords_.begin(),
+                                    shard.block_coords_.begin() + n_own),
+                            shard.voxels_);
+        for (size_t j = 0; j < n_shards; ++j) {
+            if (!coords[j].empty()) volume.InsertBlocks(coords[j], voxels[j]);
+        }
+        func(i, volume, n_own);
+    });
+}
+
+std::shared_ptr<geometry::PointCloud>
+MultiDeviceScalableTSDFVolume::ExtractPointCloud() {
+    const int primary = utility::GetDevice();
+    std::vector<geometry::PointCloud> pointclouds(shards_.size());
+    ForEachShardWithHalo(
+            [&](size_t i, ScalableTSDFVolume &volume, int num_blocks) {
+                CopyToDevice(*volume.ExtractPointCloud(num_blocks), primary,
+                             pointclouds[i]);
+            });
+    auto pointcloud = std::make_shared<geometry::PointCloud>();
+    for (const auto &shard_pointcloud : pointclouds) {
+        *pointcloud += shard_pointcloud;
+    }
+    return pointcloud;
+}
+
+std::shared_ptr<geometry::TriangleMesh>
+MultiDeviceScalableTSDFVolume::ExtractTriangleMesh() {
+    const int primary = utility::GetDevice();
+    std::vector<geometry::TriangleMesh> meshes(shards_.size());
+    ForEachShardWithHalo(
+            [&](size_t i, ScalableTSDFVolume &volume, int num_blocks) {
+                CopyToDevice(*volume.ExtractTriangleMesh(num_blocks), primary,
+                             meshes[i]);
+            });
+    // Every cube has vertices of its own as in ScalableTSDFVolume, so the
+    // meshes of the shards are joined by concatenation.
+    auto mesh = std::make_shared<geometry::TriangleMesh>();
+    for (const auto &shard_mesh : meshes) *mesh += shard_mesh;
+    return mesh;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "cupoch/integration/tsdfvolume.h"
+
+namespace cupoch {
+namespace integration {
+
+class ScalableTSDFVolume;
+
+/// \class MultiDeviceScalableTSDFVolume
+///
+/// \brief ScalableTSDFVolume sharded over several devices by block hash.
+///
+/// Every frame is copied to all the devices, and each device allocates and
+/// integrates only the blocks of its shard, so that the memory and the work
+/// of the integration are split between the devices. The extractions run on
+/// every device over the voxels of its blocks, with copies of the
+/// neighboring blocks of the other shards exchanged between the devices,
+/// and the results are merged on the current device of the caller, which
+/// holds the frames.
+class MultiDeviceScalableTSDFVolume : public TSDFVolume {
+public:
+    /// Uses the devices in \p devices, all the visible devices when empty,
+    /// with at most \p max_num_blocks blocks on each.
+    MultiDeviceScalableTSDFVolume(
+            float voxel_length,
+            float sdf_trunc,
+            TSDFVolumeColorType color_type,
+            const std::vector<int> &devices = std::vector<int>(),
+            int max_num_blocks = 65536,
+            int depth_sampling_stride = 4);
+    ~MultiDeviceScalableTSDFVolume() override;
+
+public:
+    void Reset() override;
+    void Integrate(const geometry::RGBDImage &image,
+                   const camera::PinholeCameraIntrinsic &intrinsic,
+                   const Eigen::Matrix4f &extrinsic) override;
+    std::shared_ptr<geometry::PointCloud> ExtractPointCloud() override;
+    std::shared_ptr<geometry::TriangleMesh> ExtractTriangleMesh() override;
+
+    const std::vector<int> &GetDevices() const { return devices_; }
+    /// Number of allocated blocks over all the shards.
+    int GetNumBlocks() const;
+    /// Volume of shard \p i, on device GetDevices()[i].
+    const ScalableTSDFVolume &GetShard(size_t i) const { return *shards_[i]; }
+
+private:
+    /// Runs func(i, volume, num_blocks) on every device, volume holding the
+    /// num_blocks blocks of shard i followed by the neighboring blocks of the
+    /// other shards.
+    void ForEachShardWithHalo(
+            const std::function<void(size_t, ScalableTSDFVolume &, int)>
+                    &func) const;
+
+    std::vector<int> devices_;
+    std::vector<std::unique_ptr<ScalableTSDFVolume>> shards_;
+};
+
+}  // namespace integration
+}  // namespace cupoch
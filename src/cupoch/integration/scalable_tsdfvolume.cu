@@ -0,0 +1,1190 @@
+#include "cupoch/integration/marching_cubes_const.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/device_hash_map.inl"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+
+#include <thrust/iterator/discard_iterator.h>
+
+using namespace cupoch;
+using namespace cupoch::integration;
+
+namespace {
+
+constexpr int kBlockResolution = ScalableTSDFVolume::kBlockResolution;
+constexpr int kBlockVoxels =
+        kBlockResolution * kBlockResolution * kBlockResolution;
+
+__device__ int FloorDiv(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// Read only view of the block table and the voxel pool.
+struct block_table_view {
+    block_table_view(
+            const utility::device_hash_map<unsigned long long, int> &table,
+            const ScalableTSDFVoxel *voxels,
+            float voxel_length)
+        : table_(table.view()), voxels_(voxels), voxel_length_(voxel_length){};
+    const utility::device_hash_map<unsigned long long, int>::view_type table_;
+    const ScalableTSDFVoxel *voxels_;
+    const float voxel_length_;
+
+    __device__ int FindBlock(const Eigen::Vector3i &block) const {
+        const int *b = table_.find(PackCellKey(block));
+        return (b) ? *b : -1;
+    }
+
+    /// Voxel at global grid index \p v, or NULL if its block is not
+    /// allocated.
+    __device__ const ScalableTSDFVoxel *FindVoxel(
+            const Eigen::Vector3i &v) const {
+        const Eigen::Vector3i block(FloorDiv(v(0), kBlockResolution),
+                                    FloorDiv(v(1), kBlockResolution),
+                                    FloorDiv(v(2), kBlockResolution));
+        const int b = FindBlock(block);
+        if (b < 0) return NULL;
+        const Eigen::Vector3i local = v - block * kBlockResolution;
+        return &voxels_[b * kBlockVoxels + IndexOf(local, kBlockResolution)];
+    }
+
+    /// Trilinear interpolation of the TSDF, with the voxels of unallocated
+    /// blocks read as 0 as in UniformTSDFVolume.
+    __device__ float GetTSDFAt(const Eigen::Vector3f &p) const {
+        const Eigen::Vector3f p_grid =
+                p / voxel_length_ - Eigen::Vector3f(0.5, 0.5, 0.5);
+        Eigen::Vector3i idx;
+        for (int i = 0; i < 3; i++) idx(i) = (int)floor(p_grid(i));
+        const Eigen::Vector3f r = p_grid - idx.cast<float>();
+        float tsdf = 0;
+        for (int i = 0; i < 8; ++i) {
+            const Eigen::Vector3i s(shift[i][0], shift[i][1], shift[i][2]);
+            const ScalableTSDFVoxel *voxel = FindVoxel(idx + s);
+            if (!voxel) continue;
+            float w = 1.0;
+            for (int j = 0; j < 3; ++j) w *= (s(j) == 1) ? r(j) : 1 - r(j);
+            tsdf += w * voxel->tsdf_;
+        }
+        return tsdf;
+    }
+
+    __device__ Eigen::Vector3f GetNormalAt(const Eigen::Vector3f &p) const {
+        Eigen::Vector3f n;
+        const float half_gap = 0.99 * voxel_length_;
+        for (int i = 0; i < 3; i++) {
+            Eigen::Vector3f p0 = p;
+            p0(i) -= half_gap;
+            Eigen::Vector3f p1 = p;
+            p1(i) += half_gap;
+            n(i) = GetTSDFAt(p1) - GetTSDFAt(p0);
+        }
+        return n.normalized();
+    }
+};
+
+__device__ Eigen::Vector3i GlobalVoxelIndex(const Eigen::Vector3i *block_coords,
+                                            size_t idx) {
+    const int b = idx / kBlockVoxels;
+    const int l = idx % kBlockVoxels;
+    return block_coords[b] * kBlockResolution +
+           Eigen::Vector3i(l / (kBlockResolution * kBlockResolution),
+                           (l / kBlockResolution) % kBlockResolution,
+                           l % kBlockResolution);
+}
+
+/// Shard of a block, from another hash than the one of the table slots so
+/// that the blocks of one shard still spread over the whole table.
+__device__ int BlockShard(unsigned long long key, int num_shards) {
+    return HashCellKey(key * 0x9e3779b97f4a7c15ull) % num_shards;
+}
+
+__device__ bool IsSurfaceVoxel(const ScalableTSDFVoxel &v) {
+    return v.weight_ != 0.0f && v.tsdf_ < 0.98f && v.tsdf_ >= -0.98f;
+}
+
+// Allocates the blocks along the truncation band of one sampled pixel.
+struct allocate_blocks_functor {
+    allocate_blocks_functor(const uint8_t *depth,
+                            int width,
+                            int sampled_width,
+                            int stride,
+                            float fx,
+                            float fy,
+                            float cx,
+                            float cy,
+                            const Eigen::Matrix4f &camera_to_world,
+                            float sdf_trunc,
+                            float block_length,
+                            const utility::device_hash_map<unsigned long long,
+                                                           int> &table,
+                            Eigen::Vector3i *block_coords,
+                            int *block_counter,
+                            int max_num_blocks,
+                            int shard_index,
+                            int num_shards)
+        : depth_(depth),
+          width_(width),
+          sampled_width_(sampled_width),
+          stride_(stride),
+          fx_(fx),
+          fy_(fy),
+          cx_(cx),
+          cy_(cy),
+          R_(camera_to_world.block<3, 3>(0, 0)),
+          t_(camera_to_world.block<3, 1>(0, 3)),
+          sdf_trunc_(sdf_trunc),
+          block_length_(block_length),
+          table_(table.view()),
+          block_coords_(block_coords),
+          block_counter_(block_counter),
+          max_num_blocks_(max_num_blocks),
+          shard_index_(shard_index),
+          num_shards_(num_shards){};
+    const uint8_t *depth_;
+    const int width_;
+    const int sampled_width_;
+    const int stride_;
+    const float fx_;
+    const float fy_;
+    const float cx_;
+    const float cy_;
+    const Eigen::Matrix3f R_;
+    const Eigen::Vector3f t_;
+    const float sdf_trunc_;
+    const float block_length_;
+    const utility::device_hash_map<unsigned long long, int>::view_type table_;
+    Eigen::Vector3i *block_coords_;
+    int *block_counter_;
+    const int max_num_blocks_;
+    const int shard_index_;
+    const int num_shards_;
+
+    __device__ void Insert(const Eigen::Vector3i &block) {
+        const unsigned long long key = PackCellKey(block);
+        if (key == kEmptyCellKey) return;
+        if (num_shards_ > 1 && BlockShard(key, num_shards_) != shard_index_) {
+            return;
+        }
+        const thrust::pair<int, bool> res = table_.insert_slot(key);
+        if (!res.second) return;
+        const int b = atomicAdd(block_counter_, 1);
+        if (b < max_num_blocks_) {
+            table_.values_[res.first] = b;
+            block_coords_[b] = block;
+        } else {
+            table_.values_[res.first] = -1;
+        }
+    }
+
+    __device__ void operator()(size_t idx) {
+        const int x = (idx % sampled_width_) * stride_;
+        const int y = (idx / sampled_width_) * stride_;
+        const float d = *geometry::PointerAt<float>(depth_, width_, x, y);
+        if (!(d > 0.0f)) return;
+        const Eigen::Vector3f ray((x - cx_) / fx_, (y - cy_) / fy_, 1.0);
+        const float z0 = max(d - sdf_trunc_, 0.0f);
+        const float z1 = d + sdf_trunc_;
+        // Half a block per step, so that no crossed block is skipped.
+        const float step = 0.5 * block_length_ / ray.norm();
+        Eigen::Vector3i prev_block(kCellKeyOffset, 0, 0);
+        for (float z = z0;; z += step) {
+            const float zc = min(z, z1);
+            const Eigen::Vector3f p = (R_ * (zc * ray) + t_) / block_length_;
+            const Eigen::Vector3i block(int(floor(p(0))), int(floor(p(1))),
+                                        int(floor(p(2))));
+            if (block != prev_block) Insert(block);
+            prev_block = block;
+            if (zc >= z1) break;
+        }
+    }
+};
+
+struct find_block_functor {
+    find_block_functor(const block_table_view &table) : table_(table){};
+    const block_table_view table_;
+    __device__ int operator()(const Eigen::Vector3i &block) const {
+        return table_.FindBlock(block);
+    }
+};
+
+struct is_missing_block_functor {
+    __device__ bool operator()(
+            const thrust::tuple<Eigen::Vector3i, int> &x) const {
+        return thrust::get<1>(x) < 0;
+    }
+};
+
+struct gather_block_voxels_functor {
+    gather_block_voxels_functor(const ScalableTSDFVoxel *voxels,
+                                const int *blocks)
+        : voxels_(voxels), blocks_(blocks){};
+    const ScalableTSDFVoxel *voxels_;
+    const int *blocks_;
+    __device__ ScalableTSDFVoxel operator()(size_t idx) const {
+        return voxels_[blocks_[idx / kBlockVoxels] * kBlockVoxels +
+                       idx % kBlockVoxels];
+    }
+};
+
+// Adds the idx-th block of coords as the block first_block + idx.
+struct insert_blocks_functor {
+    insert_blocks_functor(
+            const Eigen::Vector3i *coords,
+            const utility::device_hash_map<unsigned long long, int> &table,
+            Eigen::Vector3i *block_coords,
+            int first_block)
+        : coords_(coords),
+          table_(table.view()),
+          block_coords_(block_coords),
+          first_block_(first_block){};
+    const Eigen::Vector3i *coords_;
+    const utility::device_hash_map<unsigned long long, int>::view_type table_;
+    Eigen::Vector3i *block_coords_;
+    const int first_block_;
+    __device__ void operator()(size_t idx) {
+        const Eigen::Vector3i block = coords_[idx];
+        const int b = first_block_ + idx;
+        block_coords_[b] = block;
+        table_.insert(PackCellKey(block), b);
+    }
+};
+
+struct block_in_frustum_functor {
+    block_in_frustum_functor(const Eigen::Vector3i *block_coords,
+                             const Eigen::Matrix4f &extrinsic,
+                             float fx,
+                             float fy,
+                             float cx,
+                             float cy,
+                             int width,
+                             int height,
+                             float block_length)
+        : block_coords_(block_coords),
+          R_(extrinsic.block<3, 3>(0, 0)),
+          t_(extrinsic.block<3, 1>(0, 3)),
+          fx_(fx),
+          fy_(fy),
+          cx_(cx),
+          cy_(cy),
+          width_(width),
+          height_(height),
+          block_length_(block_length),
+          radius_(0.87 * block_length){};
+    const Eigen::Vector3i *block_coords_;
+    const Eigen::Matrix3f R_;
+    const Eigen::Vector3f t_;
+    const float fx_;
+    const float fy_;
+    const float cx_;
+    const float cy_;
+    const int width_;
+    const int height_;
+    const float block_length_;
+    const float radius_;
+    __device__ bool operator()(int b) const {
+        const Eigen::Vector3f center =
+                (block_coords_[b].cast<float>() +
+                 Eigen::Vector3f::Constant(0.5)) *
+                block_length_;
+        const Eigen::Vector3f pc = R_ * center + t_;
+        if (pc(2) <= -radius_) return false;
+        if (pc(2) <= radius_) return true;
+        const float u = pc(0) * fx_ / pc(2) + cx_;
+        const float v = pc(1) * fy_ / pc(2) + cy_;
+        const float mu = radius_ * fx_ / pc(2);
+        const float mv = radius_ * fy_ / pc(2);
+        return u > -mu && u < width_ + mu && v > -mv && v < height_ + mv;
+    }
+};
+
+struct integrate_block_functor {
+    integrate_block_functor(const int *active_blocks,
+                            const Eigen::Vector3i *block_coords,
+                            float fx,
+                            float fy,
+                            float cx,
+                            float cy,
+                            const Eigen::Matrix4f &extrinsic,
+                            float voxel_length,
+                            float sdf_trunc,
+                            float safe_width,
+                            float safe_height,
+                            const uint8_t *color,
+                            const uint8_t *depth,
+                            const uint8_t *depth_to_camera_distance_multiplier,
+                            int width,
+                            int num_of_channels,
+                            TSDFVolumeColorType color_type,
+                            ScalableTSDFVoxel *voxels)
+        : active_blocks_(active_blocks),
+          block_coords_(block_coords),
+          fx_(fx),
+          fy_(fy),
+          cx_(cx),
+          cy_(cy),
+          R_(extrinsic.block<3, 3>(0, 0)),
+          t_(extrinsic.block<3, 1>(0, 3)),
+          voxel_length_(voxel_length),
+          sdf_trunc_(sdf_trunc),
+          sdf_trunc_inv_(1.0 / sdf_trunc),
+          safe_width_(safe_width),
+          safe_height_(safe_height),
+          color_(color),
+          depth_(depth),
+          depth_to_camera_distance_multiplier_(
+                  depth_to_camera_distance_multiplier),
+          width_(width),
+          num_of_channels_(num_of_channels),
+          color_type_(color_type),
+          voxels_(voxels){};
+    const int *active_blocks_;
+    const Eigen::Vector3i *block_coords_;
+    const float fx_;
+    const float fy_;
+    const float cx_;
+    const float cy_;
+    const Eigen::Matrix3f R_;
+    const Eigen::Vector3f t_;
+    const float voxel_length_;
+    const float sdf_trunc_;
+    const float sdf_trunc_inv_;
+    const float safe_width_;
+    const float safe_height_;
+    const uint8_t *color_;
+    const uint8_t *depth_;
+    const uint8_t *depth_to_camera_distance_multiplier_;
+    const int width_;
+    const int num_of_channels_;
+    const TSDFVolumeColorType color_type_;
+    ScalableTSDFVoxel *voxels_;
+    __device__ void operator()(size_t idx) {
+        const int b = active_blocks_[idx / kBlockVoxels];
+        const size_t voxel_idx = b * kBlockVoxels + idx % kBlockVoxels;
+        const Eigen::Vector3i v = GlobalVoxelIndex(block_coords_, voxel_idx);
+        const Eigen::Vector3f pt =
+                (v.cast<float>() + Eigen::Vector3f::Constant(0.5)) *
+                voxel_length_;
+        const Eigen::Vector3f pt_camera = R_ * pt + t_;
+        // Skip if negative depth after projection
+        if (pt_camera(2) <= 0) return;
+        // Skip if x-y coordinate not in range
+        float u_f = pt_camera(0) * fx_ / pt_camera(2) + cx_ + 0.5f;
+        float v_f = pt_camera(1) * fy_ / pt_camera(2) + cy_ + 0.5f;
+        if (!(u_f >= 0.0001f && u_f < safe_width_ && v_f >= 0.0001f &&
+              v_f < safe_height_)) {
+            return;
+        }
+        // Skip if negative depth in depth image
+        int u = (int)u_f;
+        int vp = (int)v_f;
+        float d = *geometry::PointerAt<float>(depth_, width_, u, vp);
+        if (d <= 0.0f) return;
+
+        float sdf = (d - pt_camera(2)) *
+                    (*geometry::PointerAt<float>(
+                            depth_to_camera_distance_multiplier_, width_, u,
+                            vp));
+        if (sdf > -sdf_trunc_) {
+            ScalableTSDFVoxel &voxel = voxels_[voxel_idx];
+            float tsdf = min(1.0f, sdf * sdf_trunc_inv_);
+            voxel.tsdf_ = (voxel.tsdf_ * voxel.weight_ + tsdf) /
+                          (voxel.weight_ + 1.0f);
+            if (color_type_ == TSDFVolumeColorType::RGB8) {
+                const uint8_t *rgb = geometry::PointerAt<uint8_t>(
+                        color_, width_, num_of_channels_, u, vp, 0);
+                Eigen::Vector3f rgb_f(rgb[0], rgb[1], rgb[2]);
+                voxel.color_ = (voxel.color_ * voxel.weight_ + rgb_f) /
+                               (voxel.weight_ + 1.0f);
+            } else if (color_type_ == TSDFVolumeColorType::Gray32) {
+                const float *intensity = geometry::PointerAt<float>(
+                        color_, width_, num_of_channels_, u, vp, 0);
+                voxel.color_ =
+                        (voxel.color_.array() * voxel.weight_ + (*intensity)) /
+                        (voxel.weight_ + 1.0f);
+            }
+            voxel.weight_ += 1.0f;
+        }
+    }
+};
+
+struct extract_pointcloud_functor {
+    extract_pointcloud_functor(const block_table_view &table,
+                               const Eigen::Vector3i *block_coords,
+                               TSDFVolumeColorType color_type)
+        : table_(table),
+          block_coords_(block_coords),
+          color_type_(color_type){};
+    const block_table_view table_;
+    const Eigen::Vector3i *block_coords_;
+    const TSDFVolumeColorType color_type_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector3f>
+    operator()(size_t idx) const {
+        const size_t voxel_idx = idx / 3;
+        const int i = idx % 3;
+        const Eigen::Vector3f nan_v = Eigen::Vector3f::Constant(
+                std::numeric_limits<float>::quiet_NaN());
+        const ScalableTSDFVoxel &v0 = table_.voxels_[voxel_idx];
+        if (!IsSurfaceVoxel(v0)) {
+            return thrust::make_tuple(nan_v, nan_v, nan_v);
+        }
+        const Eigen::Vector3i idx0 = GlobalVoxelIndex(block_coords_, voxel_idx);
+        Eigen::Vector3i idx1 = idx0;
+        idx1(i) += 1;
+        const ScalableTSDFVoxel *v1 = table_.FindVoxel(idx1);
+        if (!v1 || !IsSurfaceVoxel(*v1) || v0.tsdf_ * v1->tsdf_ >= 0) {
+            return thrust::make_tuple(nan_v, nan_v, nan_v);
+        }
+        const float voxel_length = table_.voxel_length_;
+        const Eigen::Vector3f p0 =
+                (idx0.cast<float>() + Eigen::Vector3f::Constant(0.5)) *
+                voxel_length;
+        const float r0 = std::fabs(v0.tsdf_);
+        const float r1 = std::fabs(v1->tsdf_);
+        Eigen::Vector3f p = p0;
+        p(i) = (p0(i) * r1 + (p0(i) + voxel_length) * r0) / (r0 + r1);
+        Eigen::Vector3f color = nan_v;
+        if (color_type_ == TSDFVolumeColorType::RGB8) {
+            color = (v0.color_ * r1 + v1->color_ * r0) / (r0 + r1) / 255.0f;
+        } else if (color_type_ == TSDFVolumeColorType::Gray32) {
+            color = (v0.color_ * r1 + v1->color_ * r0) / (r0 + r1);
+        }
+        return thrust::make_tuple(p, table_.GetNormalAt(p), color);
+    }
+};
+
+struct extract_mesh_phase0_functor {
+    extract_mesh_phase0_functor(const block_table_view &table,
+                                const Eigen::Vector3i *block_coords)
+        : table_(table), block_coords_(block_coords){};
+    const block_table_view table_;
+    const Eigen::Vector3i *block_coords_;
+    __device__ thrust::tuple<Eigen::Vector3i, int> operator()(
+            size_t idx) const {
+        const Eigen::Vector3i key = GlobalVoxelIndex(block_coords_, idx);
+        int cube_index = 0;
+        for (int i = 0; i < 8; ++i) {
+            const ScalableTSDFVoxel *voxel = table_.FindVoxel(
+                    key + Eigen::Vector3i(shift[i][0], shift[i][1],
+                                          shift[i][2]));
+            if (!voxel || voxel->weight_ == 0.0f) {
+                return thrust::make_tuple(key, -1);
+            }
+            if (voxel->tsdf_ < 0.0f) cube_index |= (1 << i);
+        }
+        return thrust::make_tuple(key, cube_index);
+    }
+};
+
+struct extract_mesh_phase1_functor {
+    extract_mesh_phase1_functor(const block_table_view &table,
+                                const Eigen::Vector3i *keys,
+                                TSDFVolumeColorType color_type)
+        : table_(table), keys_(keys), color_type_(color_type){};
+    const block_table_view table_;
+    const Eigen::Vector3i *keys_;
+    const TSDFVolumeColorType color_type_;
+    __device__ thrust::tuple<float, Eigen::Vector3f> operator()(
+            size_t idx) const {
+        const int j = idx / 8;
+        const int i = idx % 8;
+        const ScalableTSDFVoxel *voxel = table_.FindVoxel(
+                keys_[j] +
+                Eigen::Vector3i(shift[i][0], shift[i][1], shift[i][2]));
+        Eigen::Vector3f c = Eigen::Vector3f::Zero();
+        if (color_type_ == TSDFVolumeColorType::RGB8) {
+            c = voxel->color_ / 255.0;
+        } else if (color_type_ == TSDFVolumeColorType::Gray32) {
+            c = voxel->color_;
+        }
+        return thrust::make_tuple(voxel->tsdf_, c);
+    }
+};
+
+struct extract_mesh_phase2_functor {
+    extract_mesh_phase2_functor(const Eigen::Vector3i *keys,
+                                const int *cube_indices,
+                                float voxel_length,
+                                const float *fs,
+                                const Eigen::Vector3f *cs,
+                                TSDFVolumeColorType color_type)
+        : keys_(keys),
+          cube_indices_(cube_indices),
+          voxel_length_(voxel_length),
+          fs_(fs),
+          cs_(cs),
+          color_type_(color_type){};
+    const Eigen::Vector3i *keys_;
+    const int *cube_indices_;
+    const float voxel_length_;
+    const float *fs_;
+    const Eigen::Vector3f *cs_;
+    const TSDFVolumeColorType color_type_;
+    __device__ thrust::
+            tuple<Eigen::Vector3i, int, int, Eigen::Vector3f, Eigen::Vector3f>
+            operator()(size_t idx) const {
+        const int j = idx / 12;
+        const int i = idx % 12;
+        const Eigen::Vector3i &xyz = keys_[j];
+        const int cube_index = cube_indices_[j];
+        const int offset = j * 8;
+        Eigen::Vector3f vertex = Eigen::Vector3f::Zero();
+        Eigen::Vector3f vertex_color = Eigen::Vector3f::Zero();
+        if (!(edge_table[cube_index] & (1 << i))) {
+            return thrust::make_tuple(xyz, cube_index, -1, vertex,
+                                      vertex_color);
+        }
+        const Eigen::Vector4i edge_index =
+                Eigen::Vector4i(xyz[0], xyz[1], xyz[2], 0) +
+                Eigen::Vector4i(edge_shift[i][0], edge_shift[i][1],
+                                edge_shift[i][2], edge_shift[i][3]);
+        vertex = (edge_index.head<3>().cast<float>() +
+                  Eigen::Vector3f::Constant(0.5)) *
+                 voxel_length_;
+        const float f0 = abs(fs_[offset + edge_to_vert[i][0]]);
+        const float f1 = abs(fs_[offset + edge_to_vert[i][1]]);
+        vertex(edge_index(3)) += f0 * voxel_length_ / (f0 + f1);
+        if (color_type_ != TSDFVolumeColorType::NoColor) {
+            const auto &c0 = cs_[offset + edge_to_vert[i][0]];
+            const auto &c1 = cs_[offset + edge_to_vert[i][1]];
+            vertex_color = (f1 * c0 + f0 * c1) / (f0 + f1);
+        }
+        return thrust::make_tuple(xyz, cube_index, i, vertex, vertex_color);
+    }
+};
+
+__constant__ int vert_table[3] = {0, 2, 1};
+
+struct extract_mesh_phase3_functor {
+    extract_mesh_phase3_functor(const int *cube_index,
+                                const int *vert_no,
+                                const int *key_index,
+                                Eigen::Vector3i *triangles)
+        : cube_index_(cube_index),
+          vert_no_(vert_no),
+          key_index_(key_index),
+          triangles_(triangles){};
+    const int *cube_index_;
+    const int *vert_no_;
+    const int *key_index_;
+    Eigen::Vector3i *triangles_;
+    __device__ void operator()(size_t idx) {
+        const int j = key_index_[idx];
+        for (int i = 0; tri_table[cube_index_[j]][i] != -1; ++i) {
+            const int tri_idx = tri_table[cube_index_[j]][i];
+            for (int l = key_index_[idx]; l < key_index_[idx + 1]; ++l) {
+                if (vert_no_[l] == tri_idx) {
+                    triangles_[idx * 4 + i / 3][vert_table[i % 3]] = l;
+                }
+            }
+        }
+    }
+};
+
+struct extract_voxel_pointcloud_functor {
+    extract_voxel_pointcloud_functor(const ScalableTSDFVoxel *voxels,
+                                     const Eigen::Vector3i *block_coords,
+                                     float voxel_length)
+        : voxels_(voxels),
+          block_coords_(block_coords),
+          voxel_length_(voxel_length){};
+    const ScalableTSDFVoxel *voxels_;
+    const Eigen::Vector3i *block_coords_;
+    const float voxel_length_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            size_t idx) const {
+        const ScalableTSDFVoxel &v = voxels_[idx];
+        if (IsSurfaceVoxel(v)) {
+            const Eigen::Vector3f pt =
+                    (GlobalVoxelIndex(block_coords_, idx).cast<float>() +
+                     Eigen::Vector3f::Constant(0.5)) *
+                    voxel_length_;
+            const float c = (v.tsdf_ + 1.0) * 0.5;
+            return thrust::make_tuple(pt, Eigen::Vector3f(c, c, c));
+        }
+        const Eigen::Vector3f nan_v = Eigen::Vector3f::Constant(
+                std::numeric_limits<float>::quiet_NaN());
+        return thrust::make_tuple(nan_v, nan_v);
+    }
+};
+
+// Rays through the hash table: the unallocated blocks are empty space and
+// are crossed in one step.
+struct raycast_functor {
+    raycast_functor(const block_table_view &table,
+                    float voxel_length,
+                    float sdf_trunc,
+                    const Eigen::Matrix3f &intrinsic,
+                    const Eigen::Matrix4f &extrinsic,
+                    int width,
+                    float max_depth,
+                    TSDFVolumeColorType color_type,
+                    uint8_t *depth_map,
+                    uint8_t *rgb_map)
+        : table_(table),
+          voxel_length_(voxel_length),
+          sdf_trunc_(sdf_trunc),
+          intrinsic_inv_(intrinsic.inverse()),
+          R_(extrinsic.block<3, 3>(0, 0)),
+          t_(extrinsic.block<3, 1>(0, 3)),
+          width_(width),
+          max_depth_(max_depth),
+          color_type_(color_type),
+          depth_map_(depth_map),
+          rgb_map_(rgb_map){};
+    const block_table_view table_;
+    const float voxel_length_;
+    const float sdf_trunc_;
+    const Eigen::Matrix3f intrinsic_inv_;
+    const Eigen::Matrix3f R_;
+    const Eigen::Vector3f t_;
+    const int width_;
+    const float max_depth_;
+    const TSDFVolumeColorType color_type_;
+    uint8_t *depth_map_;
+    uint8_t *rgb_map_;
+    __device__ void WriteColor(int x, int y, const Eigen::Vector3f &c) const {
+        if (!rgb_map_) return;
+        for (int i = 0; i < 3; ++i) {
+            *geometry::PointerAt<uint8_t>(rgb_map_, width_, 3, x, y, i) =
+                    (uint8_t)(max(0.0f, min(c(i), 1.0f)) * 255.0f + 0.5f);
+        }
+    }
+    __device__ void operator()(size_t idx) {
+        const int y = idx / width_;
+        const int x = idx % width_;
+        if (depth_map_) *geometry::PointerAt<float>(depth_map_, width_, x, y) = 0.0f;
+        WriteColor(x, y, Eigen::Vector3f::Zero());
+
+        // Ray in world coordinates, parametrized by the camera depth.
+        const Eigen::Vector3f ray_c = intrinsic_inv_ * Eigen::Vector3f(x, y, 1.0);
+        const Eigen::Vector3f o = -R_.transpose() * t_;
+        const Eigen::Vector3f d = R_.transpose() * ray_c;
+        const float inv_d_norm = 1.0 / d.norm();
+        const float min_step = 0.5 * voxel_length_ * inv_d_norm;
+        const float block_length = kBlockResolution * voxel_length_;
+        float t_prev = -1.0;
+        float f_prev = 0.0;
+        for (float t = min_step; t <= max_depth_;) {
+            const Eigen::Vector3f p = o + t * d;
+            Eigen::Vector3i vi;
+            for (int i = 0; i < 3; ++i) vi(i) = (int)floor(p(i) / voxel_length_);
+            const ScalableTSDFVoxel *voxel = table_.FindVoxel(vi);
+            if (!voxel) {
+                // Jump to where the ray leaves the unallocated block.
+                float t_exit = max_depth_;
+                for (int i = 0; i < 3; ++i) {
+                    if (d(i) == 0.0) continue;
+                    const int b = FloorDiv(vi(i), kBlockResolution);
+                    const float bound = (b + (d(i) > 0.0 ? 1 : 0)) * block_length;
+                    t_exit = min(t_exit, (bound - o(i)) / d(i));
+                }
+                t_prev = -1.0;
+                t = max(t_exit, t) + 0.01f * min_step;
+                continue;
+            }
+            if (voxel->weight_ == 0.0f) {
+                t_prev = -1.0;
+                t += max(0.8f * sdf_trunc_ * inv_d_norm, min_step);
+                continue;
+            }
+            const float f = table_.GetTSDFAt(p);
+            if (t_prev >= 0.0 && f_prev < 0.0 && f >= 0.0) return;
+            if (t_prev >= 0.0 && f_prev > 0.0 && f <= 0.0) {
+                const float t_hit = t_prev + (t - t_prev) * f_prev / (f_prev - f);
+                if (depth_map_) {
+                    *geometry::PointerAt<float>(depth_map_, width_, x, y) =
+                            t_hit;
+                }
+                if (rgb_map_) {
+                    const Eigen::Vector3f p_hit = o + t_hit * d;
+                    Eigen::Vector3i ci;
+                    for (int i = 0; i < 3; ++i) {
+                        ci(i) = (int)floor(p_hit(i) / voxel_length_);
+                    }
+                    const ScalableTSDFVoxel *hit = table_.FindVoxel(ci);
+                    if (hit) {
+                        WriteColor(x, y,
+                                   color_type_ == TSDFVolumeColorType::RGB8
+                                           ? Eigen::Vector3f(hit->color_ / 255.0)
+                                           : hit->color_);
+                    }
+                }
+                return;
+            }
+            t_prev = t;
+            f_prev = f;
+            t += max(0.8f * f * sdf_trunc_ * inv_d_norm, min_step);
+        }
+    }
+};
+
+}  // namespace
+
+ScalableTSDFVolume::ScalableTSDFVolume(float voxel_length,
+                                       float sdf_trunc,
+                                       TSDFVolumeColorType color_type,
+                                       int max_num_blocks /* = 65536*/,
+                                       int depth_sampling_stride /* = 4*/)
+    : TSDFVolume(voxel_length, sdf_trunc, color_type),
+      max_num_blocks_(max_num_blocks),
+      depth_sampling_stride_(std::max(depth_sampling_stride, 1)) {
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+    block_table_.rehash(max_num_blocks_);
+    block_coords_.resize(max_num_blocks_);
+    block_counter_.resize(1);
+    Reset();
+}
+
+ScalableTSDFVolume::~ScalableTSDFVolume() {}
+
+ScalableTSDFVolume::ScalableTSDFVolume(const ScalableTSDFVolume &other)
+    : TSDFVolume(other),
+      max_num_blocks_(other.max_num_blocks_),
+      depth_sampling_stride_(other.depth_sampling_stride_),
+      block_table_(other.block_table_),
+      block_coords_(other.block_coords_),
+      voxels_(other.voxels_),
+      block_counter_(other.block_counter_),
+      num_blocks_(other.num_blocks_),
+      shard_index_(other.shard_index_),
+      num_shards_(other.num_shards_) {}
+
+void ScalableTSDFVolume::Reset() {
+    block_table_.clear();
+    block_counter_[0] = 0;
+    num_blocks_ = 0;
+    voxels_.clear();
+}
+
+void ScalableTSDFVolume::Integrate(
+        const geometry::RGBDImage &image,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) {
+    Integrate(utility::ExecutionContext::Default(), image, intrinsic,
+              extrinsic);
+}
+
+void ScalableTSDFVolume::Integrate(
+        utility::ExecutionContext &ctx,
+        const geometry::RGBDImage &image,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) {
+    CUPOCH_PROFILE("ScalableTSDFVolume::Integrate", ctx.GetStream());
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+    if ((image.depth_.num_of_channels_ != 1) ||
+        (image.depth_.bytes_per_channel_ != 4) ||
+        (image.depth_.width_ != intrinsic.width_) ||
+        (image.depth_.height_ != intrinsic.height_) ||
+        (color_type_ == TSDFVolumeColorType::RGB8 &&
+         image.color_.num_of_channels_ != 3) ||
+        (color_type_ == TSDFVolumeColorType::RGB8 &&
+         image.color_.bytes_per_channel_ != 1) ||
+        (color_type_ == TSDFVolumeColorType::Gray32 &&
+         image.color_.num_of_channels_ != 1) ||
+        (color_type_ == TSDFVolumeColorType::Gray32 &&
+         image.color_.bytes_per_channel_ != 4) ||
+        (color_type_ != TSDFVolumeColorType::NoColor &&
+         image.color_.width_ != intrinsic.width_) ||
+        (color_type_ != TSDFVolumeColorType::NoColor &&
+         image.color_.height_ != intrinsic.height_)) {
+        utility::LogError(
+                "[ScalableTSDFVolume::Integrate] Unsupported image format.");
+    }
+    const float fx = intrinsic.GetFocalLength().first;
+    const float fy = intrinsic.GetFocalLength().second;
+    const float cx = intrinsic.GetPrincipalPoint().first;
+    const float cy = intrinsic.GetPrincipalPoint().second;
+    const int width = intrinsic.width_;
+    const int height = intrinsic.height_;
+    const float block_length = voxel_length_ * kBlockResolution;
+    cudaStream_t stream = ctx.GetStream();
+
+    // Allocate the blocks of the truncation band.
+    const int sampled_width =
+            (width + depth_sampling_stride_ - 1) / depth_sampling_stride_;
+    const int sampled_height =
+            (height + depth_sampling_stride_ - 1) / depth_sampling_stride_;
+    allocate_blocks_functor alloc_func(
+            thrust::raw_pointer_cast(image.depth_.data_.data()), width,
+            sampled_width, depth_sampling_stride_, fx, fy, cx, cy,
+            extrinsic.inverse(), sdf_trunc_, block_length,
+            block_table_, thrust::raw_pointer_cast(block_coords_.data()),
+            thrust::raw_pointer_cast(block_counter_.data()), max_num_blocks_,
+            shard_index_, num_shards_);
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(sampled_width *
+                                                            sampled_height),
+                     alloc_func);
+    int n_requested = 0;
+    cudaSafeCall(cudaMemcpyAsync(&n_requested,
+                                 thrust::raw_pointer_cast(block_counter_.data()),
+                                 sizeof(int), cudaMemcpyDeviceToHost, stream));
+    ctx.Synchronize();
+    if (n_requested > max_num_blocks_) {
+        utility::LogWarning(
+                "[ScalableTSDFVolume::Integrate] {:d} blocks requested, only "
+                "{:d} are allocated.",
+                n_requested, max_num_blocks_);
+    }
+    num_blocks_ = std::min(n_requested, max_num_blocks_);
+    voxels_.resize((size_t)num_blocks_ * kBlockVoxels);
+
+    // Update the voxels of the allocated blocks in the frustum.
+    utility::device_vector<int> active_blocks(num_blocks_);
+    block_in_frustum_functor frustum_func(
+            thrust::raw_pointer_cast(block_coords_.data()), extrinsic, fx, fy,
+            cx, cy, width, height, block_length);
+    auto end = thrust::copy_if(utility::exec_policy(stream)->on(stream),
+                               thrust::make_counting_iterator(0),
+                               thrust::make_counting_iterator(num_blocks_),
+                               active_blocks.begin(), frustum_func);
+    const size_t n_active = thrust::distance(active_blocks.begin(), end);
+    auto depth2cameradistance =
+            geometry::Image::CreateDepthToCameraDistanceMultiplierFloatImage(
+                    intrinsic);
+    integrate_block_functor func(
+            thrust::raw_pointer_cast(active_blocks.data()),
+            thrust::raw_pointer_cast(block_coords_.data()), fx, fy, cx, cy,
+            extrinsic, voxel_length_, sdf_trunc_, width - 0.0001f,
+            height - 0.0001f,
+            thrust::raw_pointer_cast(image.color_.data_.data()),
+            thrust::raw_pointer_cast(image.depth_.data_.data()),
+            thrust::raw_pointer_cast(depth2cameradistance->data_.data()),
+            image.depth_.width_, image.color_.num_of_channels_, color_type_,
+            thrust::raw_pointer_cast(voxels_.data()));
+    utility::TunedForEach("ScalableTSDFVolume::Integrate",
+                          n_active * kBlockVoxels, func, stream);
+    ctx.Synchronize();
+}
+
+std::shared_ptr<geometry::PointCloud> ScalableTSDFVolume::ExtractPointCloud() {
+    return ExtractPointCloud(num_blocks_);
+}
+
+std::shared_ptr<geometry::PointCloud> ScalableTSDFVolume::ExtractPointCloud(
+        int num_blocks) {
+    CUPOCH_PROFILE("ScalableTSDFVolume::ExtractPointCloud");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+    auto pointcloud = std::make_shared<geometry::PointCloud>();
+    const size_t n_voxels =
+            (size_t)std::min(std::max(num_blocks, 0), num_blocks_) *
+            kBlockVoxels;
+    const size_t n_valid_voxels =
+            thrust::count_if(voxels_.begin(), voxels_.begin() + n_voxels,
+                             [] __device__(const ScalableTSDFVoxel &v) {
+                                 return IsSurfaceVoxel(v);
+                             });
+    // Each voxel gives at most one point per axis.
+    resize_all(n_valid_voxels * 3, pointcloud->points_, pointcloud->normals_,
+               pointcloud->colors_);
+    block_table_view table(block_table_,
+                           thrust::raw_pointer_cast(voxels_.data()),
+                           voxel_length_);
+    extract_pointcloud_functor func(
+            table, thrust::raw_pointer_cast(block_coords_.data()),
+            color_type_);
+    auto begin = make_tuple_begin(pointcloud->points_, pointcloud->normals_,
+                                  pointcloud->colors_);
+    auto end_p = thrust::copy_if(
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0), func),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator(n_voxels * 3), func),
+            begin,
+            [] __device__(const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f,
+                                              Eigen::Vector3f> &x) {
+                const Eigen::Vector3f &pt = thrust::get<0>(x);
+                return !(isnan(pt(0)) || isnan(pt(1)) || isnan(pt(2)));
+            });
+    resize_all(thrust::distance(begin, end_p), pointcloud->points_,
+               pointcloud->normals_, pointcloud->colors_);
+    if (color_type_ == TSDFVolumeColorType::NoColor)
+        pointcloud->colors_.clear();
+    return pointcloud;
+}
+
+std::shared_ptr<geometry::TriangleMesh>
+ScalableTSDFVolume::ExtractTriangleMesh() {
+    return ExtractTriangleMesh(num_blocks_);
+}
+
+std::shared_ptr<geometry::TriangleMesh> ScalableTSDFVolume::ExtractTriangleMesh(
+        int num_blocks) {
+    CUPOCH_PROFILE("ScalableTSDFVolume::ExtractTriangleMesh");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+    // Marching cubes of UniformTSDFVolume on the global voxel grid, with the
+    // corners of the cubes on the block borders found through the table.
+    auto mesh = std::make_shared<geometry::TriangleMesh>();
+    block_table_view table(block_table_,
+                           thrust::raw_pointer_cast(voxels_.data()),
+                           voxel_length_);
+    const size_t n_voxels =
+            (size_t)std::min(std::max(num_blocks, 0), num_blocks_) *
+            kBlockVoxels;
+
+    // compute cube indices for each voxels
+    utility::device_vector<Eigen::Vector3i> keys(n_voxels);
+    utility::device_vector<int> cube_indices(n_voxels);
+    extract_mesh_phase0_functor func0(
+            table, thrust::raw_pointer_cast(block_coords_.data()));
+    auto end0 = thrust::copy_if(
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0), func0),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator(n_voxels), func0),
+            make_tuple_begin(keys, cube_indices),
+            [] __device__(const thrust::tuple<Eigen::Vector3i, int> &x) {
+                const int cidx = thrust::get<1>(x);
+                return cidx > 0 && cidx < 255;
+            });
+    const size_t n_cubes = thrust::distance(make_tuple_begin(keys, cube_indices), end0);
+    resize_all(n_cubes, keys, cube_indices);
+
+    utility::device_vector<float> fs(n_cubes * 8);
+    utility::device_vector<Eigen::Vector3f> cs(n_cubes * 8);
+    extract_mesh_phase1_functor func1(
+            table, thrust::raw_pointer_cast(keys.data()), color_type_);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_cubes * 8),
+                      make_tuple_begin(fs, cs), func1);
+
+    // compute vertices and vertex_colors
+    int *ci_p = thrust::raw_pointer_cast(cube_indices.data());
+    const size_t n_vertices = thrust::count_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(n_cubes * 12),
+            [ci_p] __device__(size_t idx) {
+                int i = idx / 12;
+                int j = idx % 12;
+                return (edge_table[ci_p[i]] & (1 << j)) > 0;
+            });
+    resize_all(n_vertices, mesh->vertices_, mesh->vertex_colors_);
+    utility::device_vector<Eigen::Vector3i> repeat_keys(n_vertices);
+    utility::device_vector<int> repeat_cube_indices(n_vertices);
+    utility::device_vector<int> vert_no(n_vertices);
+    extract_mesh_phase2_functor func2(
+            thrust::raw_pointer_cast(keys.data()),
+            thrust::raw_pointer_cast(cube_indices.data()), voxel_length_,
+            thrust::raw_pointer_cast(fs.data()),
+            thrust::raw_pointer_cast(cs.data()), color_type_);
+    thrust::copy_if(
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0), func2),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator(n_cubes * 12), func2),
+            make_tuple_begin(repeat_keys, repeat_cube_indices, vert_no,
+                             mesh->vertices_, mesh->vertex_colors_),
+            [] __device__(const thrust::tuple<Eigen::Vector3i, int, int,
+                                              Eigen::Vector3f,
+                                              Eigen::Vector3f> &x) {
+                return thrust::get<2>(x) >= 0;
+            });
+
+    // compute triangles
+    utility::device_vector<int> vt_offsets(n_vertices + 1, 0);
+    auto end2 = thrust::reduce_by_key(repeat_keys.begin(), repeat_keys.end(),
+                                      thrust::make_constant_iterator<int>(1),
+                                      thrust::make_discard_iterator(),
+                                      vt_offsets.begin());
+    const size_t n_result2 = thrust::distance(vt_offsets.begin(), end2.second);
+    vt_offsets.resize(n_result2 + 1);
+    thrust::exclusive_scan(vt_offsets.begin(), vt_offsets.end(),
+                           vt_offsets.begin());
+    mesh->triangles_.resize(n_result2 * 4, Eigen::Vector3i(-1, -1, -1));
+    extract_mesh_phase3_functor func3(
+            thrust::raw_pointer_cast(repeat_cube_indices.data()),
+            thrust::raw_pointer_cast(vert_no.data()),
+            thrust::raw_pointer_cast(vt_offsets.data()),
+            thrust::raw_pointer_cast(mesh->triangles_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_result2), func3);
+    auto end3 = thrust::remove_if(
+            mesh->triangles_.begin(), mesh->triangles_.end(),
+            [] __device__(const Eigen::Vector3i &idxs) { return idxs[0] < 0; });
+    mesh->triangles_.resize(thrust::distance(mesh->triangles_.begin(), end3));
+    if (color_type_ == TSDFVolumeColorType::NoColor)
+        mesh->vertex_colors_.clear();
+    return mesh;
+}
+
+std::shared_ptr<geometry::PointCloud>
+ScalableTSDFVolume::ExtractVoxelPointCloud() const {
+    auto voxel = std::make_shared<geometry::PointCloud>();
+    resize_all(voxels_.size(), voxel->points_, voxel->colors_);
+    extract_voxel_pointcloud_functor func(
+            thrust::raw_pointer_cast(voxels_.data()),
+            thrust::raw_pointer_cast(block_coords_.data()), voxel_length_);
+    auto begin = make_tuple_begin(voxel->points_, voxel->colors_);
+    auto end = thrust::copy_if(
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0), func),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator(voxels_.size()), func),
+            begin,
+            [] __device__(
+                    const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> &x) {
+                return !isnan(thrust::get<0>(x)(0));
+            });
+    resize_all(thrust::distance(begin, end), voxel->points_, voxel->colors_);
+    return voxel;
+}
+
+geometry::AxisAlignedBoundingBox ScalableTSDFVolume::GetAxisAlignedBoundingBox()
+        const {
+    if (num_blocks_ == 0) return geometry::AxisAlignedBoundingBox();
+    const Eigen::Vector3i init = block_coords_[0];
+    const Eigen::Vector3i min_block = thrust::reduce(
+            block_coords_.begin(), block_coords_.begin() + num_blocks_, init,
+            thrust::elementwise_minimum<Eigen::Vector3i>());
+    const Eigen::Vector3i max_block = thrust::reduce(
+            block_coords_.begin(), block_coords_.begin() + num_blocks_, init,
+            thrust::elementwise_maximum<Eigen::Vector3i>());
+    const float block_length = voxel_length_ * kBlockResolution;
+    return geometry::AxisAlignedBoundingBox(
+            min_block.cast<float>() * block_length,
+            (max_block + Eigen::Vector3i::Ones()).cast<float>() * block_length);
+}
+
+void ScalableTSDFVolume::SetShard(int shard_index, int num_shards) {
+    if (num_shards < 1 || shard_index < 0 || shard_index >= num_shards) {
+        utility::LogError("[ScalableTSDFVolume::SetShard] Invalid shard.");
+    }
+    shard_index_ = shard_index;
+    num_shards_ = num_shards;
+}
+
+void ScalableTSDFVolume::GetBlocks(
+        const utility::device_vector<Eigen::Vector3i> &coords,
+        utility::device_vector<Eigen::Vector3i> &found_coords,
+        utility::device_vector<ScalableTSDFVoxel> &voxels) const {
+    block_table_view table(block_table_,
+                           thrust::raw_pointer_cast(voxels_.data()),
+                           voxel_length_);
+    utility::device_vector<int> blocks(coords.size());
+    thrust::transform(coords.begin(), coords.end(), blocks.begin(),
+                      find_block_functor(table));
+    found_coords = coords;
+    const size_t n_found =
+            remove_if_vectors(is_missing_block_functor(), found_coords, blocks);
+    voxels.resize(n_found * kBlockVoxels);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(voxels.size()),
+                      voxels.begin(),
+                      gather_block_voxels_functor(
+                              thrust::raw_pointer_cast(voxels_.data()),
+                              thrust::raw_pointer_cast(blocks.data())));
+}
+
+void ScalableTSDFVolume::InsertBlocks(
+        const utility::device_vector<Eigen::Vector3i> &coords,
+        const utility::device_vector<ScalableTSDFVoxel> &voxels) {
+    if (voxels.size() != coords.size() * kBlockVoxels) {
+        utility::LogError(
+                "[ScalableTSDFVolume::InsertBlocks] The number of voxels "
+                "does not match the number of blocks.");
+    }
+    int n_blocks = (int)coords.size();
+    if (num_blocks_ + n_blocks > max_num_blocks_) {
+        utility::LogWarning(
+                "[ScalableTSDFVolume::InsertBlocks] {:d} blocks requested, "
+                "only {:d} are allocated.",
+                num_blocks_ + n_blocks, max_num_blocks_);
+        n_blocks = max_num_blocks_ - num_blocks_;
+    }
+    insert_blocks_functor func(
+            thrust::raw_pointer_cast(coords.data()), block_table_,
+            thrust::raw_pointer_cast(block_coords_.data()), num_blocks_);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(n_blocks), func);
+    voxels_.resize((size_t)(num_blocks_ + n_blocks) * kBlockVoxels);
+    thrust::copy(voxels.begin(),
+                 voxels.begin() + (size_t)n_blocks * kBlockVoxels,
+                 voxels_.begin() + (size_t)num_blocks_ * kBlockVoxels);
+    num_blocks_ += n_blocks;
+    block_counter_[0] = num_blocks_;
+}
+
+std::shared_ptr<geometry::Image> ScalableTSDFVolume::RaycastDepth(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    return RaycastDepth(utility::ExecutionContext::Default(), intrinsic,
+                        extrinsic, max_depth);
+}
+
+std::shared_ptr<geometry::Image> ScalableTSDFVolume::RaycastDepth(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    auto depth = std::make_shared<geometry::Image>();
+    if (intrinsic.width_ <= 0 || intrinsic.height_ <= 0) {
+        utility::LogWarning("[ScalableTSDFVolume::RaycastDepth] Empty camera.");
+        return depth;
+    }
+    depth->Prepare(intrinsic.width_, intrinsic.height_, 1, 4);
+    RaycastMaps(ctx, intrinsic, extrinsic, max_depth, depth.get(), nullptr);
+    return depth;
+}
+
+std::shared_ptr<geometry::Image> ScalableTSDFVolume::RaycastColor(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    return RaycastColor(utility::ExecutionContext::Default(), intrinsic,
+                        extrinsic, max_depth);
+}
+
+std::shared_ptr<geometry::Image> ScalableTSDFVolume::RaycastColor(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    auto color = std::make_shared<geometry::Image>();
+    if (intrinsic.width_ <= 0 || intrinsic.height_ <= 0 ||
+        color_type_ == TSDFVolumeColorType::NoColor) {
+        utility::LogWarning(
+                "[ScalableTSDFVolume::RaycastColor] Empty camera or no "
+                "color.");
+        return color;
+    }
+    color->Prepare(intrinsic.width_, intrinsic.height_, 3, 1);
+    RaycastMaps(ctx, intrinsic, extrinsic, max_depth, nullptr, color.get());
+    return color;
+}
+
+void ScalableTSDFVolume::RaycastMaps(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth,
+        geometry::Image *depth_map,
+        geometry::Image *rgb_map) const {
+    block_table_view table(block_table_,
+                           thrust::raw_pointer_cast(voxels_.data()),
+                           voxel_length_);
+    raycast_functor func(
+            table, voxel_length_, sdf_trunc_, intrinsic.intrinsic_matrix_,
+            extrinsic, intrinsic.width_, max_depth, color_type_,
+            depth_map ? thrust::raw_pointer_cast(depth_map->data_.data())
+                      : nullptr,
+            rgb_map ? thrust::raw_pointer_cast(rgb_map->data_.data())
+                    : nullptr);
+    cudaStream_t stream = ctx.GetStream();
+    thrust::for_each(
+            utility::exec_policy(stream)->on(stream),
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator<size_t>(intrinsic.width_ *
+                                                   intrinsic.height_),
+            func);
+    ctx.Synchronize();
+}
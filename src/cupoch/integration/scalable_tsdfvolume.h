@@ -0,0 +1,145 @@
+#pragma once
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/integration/tsdfvolume.h"
+#include "cupoch/utility/device_hash_map.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/execution_context.h"
+
+namespace cupoch {
+namespace integration {
+
+/// Voxel of ScalableTSDFVolume. The grid index is implied by the position
+/// in the block pool, so it is not stored.
+class ScalableTSDFVoxel {
+public:
+    __host__ __device__ ScalableTSDFVoxel() {}
+    __host__ __device__ ~ScalableTSDFVoxel() {}
+
+public:
+    float tsdf_ = 0;
+    float weight_ = 0;
+    Eigen::Vector3f color_ = Eigen::Vector3f::Zero();
+};
+
+/// \class ScalableTSDFVolume
+///
+/// \brief TSDF volume made of blocks of kBlockResolution^3 voxels allocated
+/// on demand.
+///
+/// The blocks are kept in an open addressing hash table on the device,
+/// keyed by their integer coordinates, and their voxels in one pool. Each
+/// Integrate() call first allocates the blocks that the truncation band of
+/// every depth_sampling_stride_-th pixel falls into, and then updates the
+/// voxels of the allocated blocks that lie in the camera frustum. The
+/// memory grows with the observed surface instead of with the bounding box
+/// of the scene, up to max_num_blocks_ blocks.
+class ScalableTSDFVolume : public TSDFVolume {
+public:
+    static constexpr int kBlockResolution = 8;
+
+    ScalableTSDFVolume(float voxel_length,
+                       float sdf_trunc,
+                       TSDFVolumeColorType color_type,
+                       int max_num_blocks = 65536,
+                       int depth_sampling_stride = 4);
+    ~ScalableTSDFVolume() override;
+    ScalableTSDFVolume(const ScalableTSDFVolume &other);
+
+public:
+    void Reset() override;
+    void Integrate(const geometry::RGBDImage &image,
+                   const camera::PinholeCameraIntrinsic &intrinsic,
+                   const Eigen::Matrix4f &extrinsic) override;
+    /// Same as Integrate(), with the allocation and the voxel update
+    /// enqueued on the stream of \p ctx.
+    void Integrate(utility::ExecutionContext &ctx,
+                   const geometry::RGBDImage &image,
+                   const camera::PinholeCameraIntrinsic &intrinsic,
+                   const Eigen::Matrix4f &extrinsic);
+    std::shared_ptr<geometry::PointCloud> ExtractPointCloud() override;
+    std::shared_ptr<geometry::TriangleMesh> ExtractTriangleMesh() override;
+    /// Same as above over the voxels of the first \p num_blocks blocks, the
+    /// other blocks only being read as neighbors.
+    std::shared_ptr<geometry::PointCloud> ExtractPointCloud(int num_blocks);
+    std::shared_ptr<geometry::TriangleMesh> ExtractTriangleMesh(int num_blocks);
+
+    /// Debug function to extract the voxel data into a point cloud
+    std::shared_ptr<geometry::PointCloud> ExtractVoxelPointCloud() const;
+
+    /// Casts one ray per pixel of the camera \p intrinsic at \p extrinsic
+    /// (world to camera) and returns a 1 channel float image of the depth
+    /// of the first zero crossing of the TSDF, 0 where the ray misses the
+    /// surface within \p max_depth. The rays cross the unallocated blocks
+    /// in one step.
+    std::shared_ptr<geometry::Image> RaycastDepth(
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    std::shared_ptr<geometry::Image> RaycastDepth(
+            utility::ExecutionContext &ctx,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    /// Same rays as RaycastDepth(), returning a 3 channel 8 bit image of the
+    /// color of the surface. Empty for TSDFVolumeColorType::NoColor.
+    std::shared_ptr<geometry::Image> RaycastColor(
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    std::shared_ptr<geometry::Image> RaycastColor(
+            utility::ExecutionContext &ctx,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+
+    /// Number of allocated blocks.
+    int GetNumBlocks() const { return num_blocks_; }
+    /// Bounds of the allocated blocks, empty if there is none.
+    geometry::AxisAlignedBoundingBox GetAxisAlignedBoundingBox() const;
+
+    /// Restricts the allocation to the blocks of shard \p shard_index out of
+    /// \p num_shards, the blocks being split by hash, as done by
+    /// MultiDeviceScalableTSDFVolume.
+    void SetShard(int shard_index, int num_shards);
+    /// Copies the blocks of \p coords that are allocated, with their voxels.
+    void GetBlocks(const utility::device_vector<Eigen::Vector3i> &coords,
+                   utility::device_vector<Eigen::Vector3i> &found_coords,
+                   utility::device_vector<ScalableTSDFVoxel> &voxels) const;
+    /// Appends the blocks of \p coords, which must not be allocated yet,
+    /// with their kBlockResolution^3 voxels each in \p voxels.
+    void InsertBlocks(const utility::device_vector<Eigen::Vector3i> &coords,
+                      const utility::device_vector<ScalableTSDFVoxel> &voxels);
+
+public:
+    int max_num_blocks_;
+    /// Only one pixel in depth_sampling_stride_ along each axis allocates
+    /// blocks. The blocks are much larger than the footprint of a pixel, so
+    /// the skipped pixels fall into the same blocks.
+    int depth_sampling_stride_;
+    /// Block of each packed block key, -1 for the keys whose block could
+    /// not be allocated.
+    utility::device_hash_map<unsigned long long, int> block_table_;
+    /// Coordinates of the allocated blocks, in units of the block length.
+    utility::device_vector<Eigen::Vector3i> block_coords_;
+    /// kBlockResolution^3 voxels per allocated block, in the order of
+    /// block_coords_.
+    utility::device_vector<ScalableTSDFVoxel> voxels_;
+
+private:
+    /// Casts the rays of RaycastDepth() into the maps that are not NULL.
+    void RaycastMaps(utility::ExecutionContext &ctx,
+                     const camera::PinholeCameraIntrinsic &intrinsic,
+                     const Eigen::Matrix4f &extrinsic,
+                     float max_depth,
+                     geometry::Image *depth_map,
+                     geometry::Image *rgb_map) const;
+
+    utility::device_vector<int> block_counter_;
+    int num_blocks_ = 0;
+    int shard_index_ = 0;
+    int num_shards_ = 1;
+};
+
+}  // namespace integration
+}  // namespace cupoch
@@ -1,17 +1,99 @@
+#include "cupoch/geometry/distancetransform.h"
 #include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/integration/marching_cubes_const.h"
 #include "cupoch/integration/uniform_tsdfvolume.h"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/profiler.h"
 
+#include <thrust/binary_search.h>
 #include <thrust/iterator/discard_iterator.h>
 
+#include <type_traits>
+
 using namespace cupoch;
 using namespace cupoch::integration;
 
 namespace {
 
+// Accessors shared by the full and the compact voxels. The colors are read
+// in [0, 1] and integrated in the units of the input image.
+__device__ float GetVoxelTSDF(const geometry::TSDFVoxel &v) { return v.tsdf_; }
+
+__device__ float GetVoxelTSDF(const geometry::CompactTSDFVoxel &v) {
+    return v.tsdf_ / geometry::CompactTSDFVoxel::kTSDFScale;
+}
+
+__device__ float GetVoxelWeight(const geometry::TSDFVoxel &v) {
+    return v.weight_;
+}
+
+__device__ float GetVoxelWeight(const geometry::CompactTSDFVoxel &v) {
+    return v.weight_;
+}
+
+__device__ Eigen::Vector3f GetVoxelColor(const geometry::TSDFVoxel &v,
+                                         TSDFVolumeColorType color_type) {
+    return (color_type == TSDFVolumeColorType::RGB8)
+                   ? Eigen::Vector3f(v.color_ / 255.0f)
+                   : v.color_;
+}
+
+__device__ Eigen::Vector3f GetVoxelColor(const geometry::CompactTSDFVoxel &v,
+                                         TSDFVolumeColorType color_type) {
+    return Eigen::Vector3f(v.color_[0], v.color_[1], v.color_[2]) / 255.0f;
+}
+
+__device__ void SetVoxelGridIndex(geometry::TSDFVoxel &v,
+                                  const Eigen::Vector3i &grid_index) {
+    v.grid_index_ = grid_index;
+}
+
+__device__ void SetVoxelGridIndex(geometry::CompactTSDFVoxel &v,
+                                  const Eigen::Vector3i &grid_index) {}
+
+__device__ void UpdateVoxel(geometry::TSDFVoxel &v,
+                            float tsdf,
+                            const Eigen::Vector3f *color) {
+    v.tsdf_ = (v.tsdf_ * v.weight_ + tsdf) / (v.weight_ + 1.0f);
+    if (color) {
+        v.color_ = (v.color_ * v.weight_ + *color) / (v.weight_ + 1.0f);
+    }
+    v.weight_ += 1.0f;
+}
+
+__device__ void UpdateVoxel(geometry::CompactTSDFVoxel &v,
+                            float tsdf,
+                            const Eigen::Vector3f *color) {
+    const float w = v.weight_;
+    const float f = (GetVoxelTSDF(v) * w + tsdf) / (w + 1.0f);
+    v.tsdf_ = __float2int_rn(f * geometry::CompactTSDFVoxel::kTSDFScale);
+    if (color) {
+        for (int i = 0; i < 3; ++i) {
+            const int c = __float2int_rn((v.color_[i] * w + (*color)(i)) /
+                                         (w + 1.0f));
+            v.color_[i] = min(max(c, 0), 255);
+        }
+    }
+    if (v.weight_ < geometry::CompactTSDFVoxel::kMaxWeight) v.weight_ += 1;
+}
+
+template <typename VoxelType>
+__device__ bool IsSurfaceVoxel(const VoxelType &v) {
+    const float f = GetVoxelTSDF(v);
+    return GetVoxelWeight(v) != 0.0f && f < 0.98f && f >= -0.98f;
+}
+
+__device__ Eigen::Vector3i GridIndexOf(size_t idx, int resolution) {
+    const int res2 = resolution * resolution;
+    const int yz = idx % res2;
+    return Eigen::Vector3i(idx / res2, yz / resolution, yz % resolution);
+}
+
+template <typename VoxelType>
 __device__ float GetTSDFAt(const Eigen::Vector3f &p,
-                           const geometry::TSDFVoxel *voxels,
+                           const VoxelType *voxels,
                            float voxel_length,
                            int resolution) {
     Eigen::Vector3i idx;
@@ -22,27 +104,18 @@ __device__ float GetTSDFAt(const Eigen::Vector3f &p,
     Eigen::Vector3f r = p_grid - idx.cast<float>();
 
     float tsdf = 0;
-    tsdf += (1 - r(0)) * (1 - r(1)) * (1 - r(2)) *
-            voxels[IndexOf(idx + Eigen::Vector3i(0, 0, 0), resolution)].tsdf_;
-    tsdf += (1 - r(0)) * (1 - r(1)) * r(2) *
-            voxels[IndexOf(idx + Eigen::Vector3i(0, 0, 1), resolution)].tsdf_;
-    tsdf += (1 - r(0)) * r(1) * (1 - r(2)) *
-            voxels[IndexOf(idx + Eigen::Vector3i(0, 1, 0), resolution)].tsdf_;
-    tsdf += (1 - r(0)) * r(1) * r(2) *
-            voxels[IndexOf(idx + Eigen::Vector3i(0, 1, 1), resolution)].tsdf_;
-    tsdf += r(0) * (1 - r(1)) * (1 - r(2)) *
-            voxels[IndexOf(idx + Eigen::Vector3i(1, 0, 0), resolution)].tsdf_;
-    tsdf += r(0) * (1 - r(1)) * r(2) *
-            voxels[IndexOf(idx + Eigen::Vector3i(1, 0, 1), resolution)].tsdf_;
-    tsdf += r(0) * r(1) * (1 - r(2)) *
-            voxels[IndexOf(idx + Eigen::Vector3i(1, 1, 0), resolution)].tsdf_;
-    tsdf += r(0) * r(1) * r(2) *
-            voxels[IndexOf(idx + Eigen::Vector3i(1, 1, 1), resolution)].tsdf_;
+    for (int i = 0; i < 8; ++i) {
+        const Eigen::Vector3i s(shift[i][0], shift[i][1], shift[i][2]);
+        float w = 1.0;
+        for (int j = 0; j < 3; ++j) w *= (s(j) == 1) ? r(j) : 1 - r(j);
+        tsdf += w * GetVoxelTSDF(voxels[IndexOf(idx + s, resolution)]);
+    }
     return tsdf;
 }
 
+template <typename VoxelType>
 __device__ Eigen::Vector3f GetNormalAt(const Eigen::Vector3f &p,
-                                       const geometry::TSDFVoxel *voxels,
+                                       const VoxelType *voxels,
                                        float voxel_length,
                                        int resolution) {
     Eigen::Vector3f n;
@@ -58,8 +131,24 @@ __device__ Eigen::Vector3f GetNormalAt(const Eigen::Vector3f &p,
     return n.normalized();
 }
 
+template <typename VoxelType>
+struct is_surface_voxel_functor {
+    __device__ bool operator()(const VoxelType &v) const {
+        return IsSurfaceVoxel(v);
+    }
+};
+
+struct is_finite_point_functor {
+    template <typename Tuple>
+    __device__ bool operator()(const Tuple &x) const {
+        const Eigen::Vector3f &pt = thrust::get<0>(x);
+        return !(isnan(pt(0)) || isnan(pt(1)) || isnan(pt(2)));
+    }
+};
+
+template <typename VoxelType>
 struct extract_pointcloud_functor {
-    extract_pointcloud_functor(const geometry::TSDFVoxel* voxels,
+    extract_pointcloud_functor(const VoxelType* voxels,
                                int resolution,
                                float voxel_length,
                                const Eigen::Vector3f &origin,
@@ -69,7 +158,7 @@ struct extract_pointcloud_functor {
           origin_(origin),
           half_voxel_length_(0.5 * voxel_length_),
           color_type_(color_type){};
-    const geometry::TSDFVoxel* voxels_;
+    const VoxelType* voxels_;
     const int resolution_;
     const float voxel_length_;
     const Eigen::Vector3f origin_;
@@ -95,12 +184,11 @@ struct extract_pointcloud_functor {
                               std::numeric_limits<float>::quiet_NaN(),
                               std::numeric_limits<float>::quiet_NaN());
         Eigen::Vector3i idx0(x, y, z);
-        float w0 = voxels_[IndexOf(idx0, resolution_)].weight_;
-        float f0 = voxels_[IndexOf(idx0, resolution_)].tsdf_;
-        const Eigen::Vector3f &c0 = voxels_[IndexOf(idx0, resolution_)].color_;
-        if (!(w0 != 0.0f && f0 < 0.98f && f0 >= -0.98f)) {
+        const VoxelType &v0 = voxels_[IndexOf(idx0, resolution_)];
+        if (!IsSurfaceVoxel(v0)) {
             return thrust::make_tuple(point, normal, color);
         }
+        float f0 = GetVoxelTSDF(v0);
         Eigen::Vector3f p0(half_voxel_length_ + voxel_length_ * x,
                            half_voxel_length_ + voxel_length_ * y,
                            half_voxel_length_ + voxel_length_ * z);
@@ -109,20 +197,18 @@ struct extract_pointcloud_functor {
         Eigen::Vector3i idx1 = idx0;
         idx1(i) += 1;
         if (idx1(i) < resolution_ - 1) {
-            float w1 = voxels_[IndexOf(idx1, resolution_)].weight_;
-            float f1 = voxels_[IndexOf(idx1, resolution_)].tsdf_;
-            const Eigen::Vector3f &c1 =
-                    voxels_[IndexOf(idx1, resolution_)].color_;
-            if (w1 != 0.0f && f1 < 0.98f && f1 >= -0.98f && f0 * f1 < 0) {
+            const VoxelType &v1 = voxels_[IndexOf(idx1, resolution_)];
+            float f1 = GetVoxelTSDF(v1);
+            if (IsSurfaceVoxel(v1) && f0 * f1 < 0) {
                 float r0 = std::fabs(f0);
                 float r1 = std::fabs(f1);
                 Eigen::Vector3f p = p0;
                 p(i) = (p0(i) * r1 + p1(i) * r0) / (r0 + r1);
                 point = p + origin_;
-                if (color_type_ == TSDFVolumeColorType::RGB8) {
-                    color = (c0 * r1 + c1 * r0) / (r0 + r1) / 255.0f;
-                } else if (color_type_ == TSDFVolumeColorType::Gray32) {
-                    color = (c0 * r1 + c1 * r0) / (r0 + r1);
+                if (color_type_ != TSDFVolumeColorType::NoColor) {
+                    color = (GetVoxelColor(v0, color_type_) * r1 +
+                             GetVoxelColor(v1, color_type_) * r0) /
+                            (r0 + r1);
                 }
                 // has_normal
                 normal = GetNormalAt(p, voxels_, voxel_length_, resolution_);
@@ -132,46 +218,174 @@ struct extract_pointcloud_functor {
     }
 };
 
+template <typename VoxelType>
 struct count_valid_voxels_functor {
-    count_valid_voxels_functor(const geometry::TSDFVoxel* voxels, int resolution)
+    count_valid_voxels_functor(const VoxelType* voxels, int resolution)
     : voxels_(voxels), resolution_(resolution) {};
-    const geometry::TSDFVoxel* voxels_;
+    const VoxelType* voxels_;
     const int resolution_;
-    __device__ bool operator() (const geometry::TSDFVoxel& v) const {
-        if (v.grid_index_[0] == resolution_ - 1 ||
-            v.grid_index_[1] == resolution_ - 1 ||
-            v.grid_index_[2] == resolution_ - 1)
+    __device__ bool operator() (size_t idx) const {
+        const Eigen::Vector3i grid_index = GridIndexOf(idx, resolution_);
+        if (grid_index[0] == resolution_ - 1 ||
+            grid_index[1] == resolution_ - 1 ||
+            grid_index[2] == resolution_ - 1)
             return false;
         for (int i = 0; i < 8; ++i) {
-           Eigen::Vector3i idx = v.grid_index_ + Eigen::Vector3i(shift[i][0], shift[i][1], shift[i][2]);
-           if (voxels_[IndexOf(idx, resolution_)].weight_ == 0.0f) return false;
+           Eigen::Vector3i idx = grid_index + Eigen::Vector3i(shift[i][0], shift[i][1], shift[i][2]);
+           if (GetVoxelWeight(voxels_[IndexOf(idx, resolution_)]) == 0.0f) return false;
         }
         return true;
     }
 };
 
-struct extract_mesh_phase0_functor {
-    extract_mesh_phase0_functor(const geometry::TSDFVoxel *voxels,
-                                int resolution)
-        : voxels_(voxels), resolution_(resolution) {};
-    const geometry::TSDFVoxel *voxels_;
+// Min corners of the cubes of the whole volume.
+struct dense_cube_key_functor {
+    dense_cube_key_functor(int resolution) : resolution_(resolution){};
     const int resolution_;
-    __device__ thrust::tuple<Eigen::Vector3i, int> operator()(size_t idx) {
+    __device__ Eigen::Vector3i operator()(size_t idx) const {
         int res2 = (resolution_ - 1) * (resolution_ - 1);
         int x = idx / res2;
         int yz = idx % res2;
         int y = yz / (resolution_ - 1);
         int z = yz % (resolution_ - 1);
+        return Eigen::Vector3i(x, y, z);
+    }
+};
+
+// Min corners of the cubes of the mesh blocks in \p blocks, (-1, -1, -1)
+// past the last cube of the volume.
+struct block_cube_key_functor {
+    block_cube_key_functor(const int *blocks, int resolution, int block_size)
+        : blocks_(blocks),
+          resolution_(resolution),
+          block_size_(block_size),
+          block_resolution_((resolution + block_size - 1) / block_size){};
+    const int *blocks_;
+    const int resolution_;
+    const int block_size_;
+    const int block_resolution_;
+    __device__ Eigen::Vector3i operator()(size_t idx) const {
+        const int n_block_cubes = block_size_ * block_size_ * block_size_;
+        const Eigen::Vector3i key =
+                GridIndexOf(blocks_[idx / n_block_cubes], block_resolution_) *
+                        block_size_ +
+                GridIndexOf(idx % n_block_cubes, block_size_);
+        if ((key.array() >= resolution_ - 1).any()) {
+            return Eigen::Vector3i::Constant(-1);
+        }
+        return key;
+    }
+};
+
+// Voxels of the mesh blocks in \p blocks, (-1, -1, -1) past the last voxel
+// of the volume.
+struct block_voxel_key_functor {
+    block_voxel_key_functor(const int *blocks, int resolution, int block_size)
+        : blocks_(blocks),
+          resolution_(resolution),
+          block_size_(block_size),
+          block_resolution_((resolution + block_size - 1) / block_size){};
+    const int *blocks_;
+    const int resolution_;
+    const int block_size_;
+    const int block_resolution_;
+    __device__ Eigen::Vector3i operator()(size_t idx) const {
+        const int n_block_voxels = block_size_ * block_size_ * block_size_;
+        const Eigen::Vector3i key =
+                GridIndexOf(blocks_[idx / n_block_voxels], block_resolution_) *
+                        block_size_ +
+                GridIndexOf(idx % n_block_voxels, block_size_);
+        if ((key.array() >= resolution_).any()) {
+            return Eigen::Vector3i::Constant(-1);
+        }
+        return key;
+    }
+};
+
+// The sites of the ESDF are the observed voxels within one voxel of the
+// surface. Returns 1 for the voxels becoming sites, 2 for the sites that
+// are not any more and 0 otherwise.
+template <typename VoxelType>
+struct esdf_site_change_functor {
+    esdf_site_change_functor(const VoxelType *voxels,
+                             const geometry::DistanceVoxel *esdf,
+                             int resolution,
+                             float surface_tsdf)
+        : voxels_(voxels),
+          esdf_(esdf),
+          resolution_(resolution),
+          surface_tsdf_(surface_tsdf){};
+    const VoxelType *voxels_;
+    const geometry::DistanceVoxel *esdf_;
+    const int resolution_;
+    const float surface_tsdf_;
+    __device__ int operator()(const Eigen::Vector3i &key) const {
+        if (key[0] < 0) return 0;
+        const int i = IndexOf(key, resolution_);
+        const VoxelType &v = voxels_[i];
+        const bool seed = GetVoxelWeight(v) > 0 &&
+                          fabsf(GetVoxelTSDF(v)) <= surface_tsdf_;
+        const geometry::DistanceVoxel &d = esdf_[i];
+        const bool site = !d.IsNotSite() &&
+                          d.nearest_index_ == key.cast<unsigned short>();
+        return (seed == site) ? 0 : (seed ? 1 : 2);
+    }
+};
 
+template <typename VoxelType>
+void UpdateESDFSites(const UniformTSDFVolume &volume,
+                     const utility::device_vector<VoxelType> &voxels,
+                     const utility::device_vector<int> &blocks,
+                     geometry::DistanceTransform &esdf,
+                     float max_distance) {
+    const int bs = UniformTSDFVolume::kMeshBlockSize;
+    const size_t n_candidates = blocks.size() * bs * bs * bs;
+    utility::device_vector<Eigen::Vector3i> keys(n_candidates);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_candidates),
+                      keys.begin(),
+                      block_voxel_key_functor(
+                              thrust::raw_pointer_cast(blocks.data()),
+                              volume.resolution_, bs));
+    utility::device_vector<int> changes(n_candidates);
+    thrust::transform(keys.begin(), keys.end(), changes.begin(),
+                      esdf_site_change_functor<VoxelType>(
+                              thrust::raw_pointer_cast(voxels.data()),
+                              thrust::raw_pointer_cast(esdf.voxels_.data()),
+                              volume.resolution_,
+                              volume.voxel_length_ / volume.sdf_trunc_));
+    utility::device_vector<Eigen::Vector3i> added(n_candidates);
+    auto end_a = thrust::copy_if(keys.begin(), keys.end(), changes.begin(),
+                                 added.begin(),
+                                 [] __device__(int c) { return c == 1; });
+    added.resize(thrust::distance(added.begin(), end_a));
+    utility::device_vector<Eigen::Vector3i> removed(n_candidates);
+    auto end_r = thrust::copy_if(keys.begin(), keys.end(), changes.begin(),
+                                 removed.begin(),
+                                 [] __device__(int c) { return c == 2; });
+    removed.resize(thrust::distance(removed.begin(), end_r));
+    esdf.UpdateEDT(added, removed, max_distance);
+}
+
+template <typename VoxelType>
+struct extract_mesh_phase0_functor {
+    extract_mesh_phase0_functor(const VoxelType *voxels,
+                                int resolution)
+        : voxels_(voxels), resolution_(resolution) {};
+    const VoxelType *voxels_;
+    const int resolution_;
+    __device__ thrust::tuple<Eigen::Vector3i, int> operator()(
+            const Eigen::Vector3i &key) {
+        if (key[0] < 0) return thrust::make_tuple(key, -1);
         int cube_index = 0;
-        Eigen::Vector3i key = Eigen::Vector3i(x, y, z);
         for (int i = 0; i < 8; ++i) {
             Eigen::Vector3i idxs =
                     key + Eigen::Vector3i(shift[i][0], shift[i][1], shift[i][2]);
-            if (voxels_[IndexOf(idxs, resolution_)].weight_ == 0.0f) {
+            const VoxelType &v = voxels_[IndexOf(idxs, resolution_)];
+            if (GetVoxelWeight(v) == 0.0f) {
                 return thrust::make_tuple(key, -1);
             } else {
-                float f = voxels_[IndexOf(idxs, resolution_)].tsdf_;
+                float f = GetVoxelTSDF(v);
                 if (f < 0.0f) {
                     cube_index |= (1 << i);
                 }
@@ -181,15 +395,29 @@ struct extract_mesh_phase0_functor {
     }
 };
 
+struct is_observed_cube_functor {
+    __device__ bool operator()(const thrust::tuple<Eigen::Vector3i, int> &x) const {
+        return thrust::get<1>(x) >= 0;
+    }
+};
+
+struct is_empty_cube_functor {
+    __device__ bool operator()(const thrust::tuple<Eigen::Vector3i, int> &x) const {
+        int cidx = thrust::get<1>(x);
+        return (cidx <= 0 || cidx >= 255);
+    }
+};
+
+template <typename VoxelType>
 struct extract_mesh_phase1_functor {
-    extract_mesh_phase1_functor(const geometry::TSDFVoxel *voxels,
+    extract_mesh_phase1_functor(const VoxelType *voxels,
                                 const Eigen::Vector3i *keys,
                                 int resolution,
                                 TSDFVolumeColorType color_type)
         : voxels_(voxels), keys_(keys),
         resolution_(resolution),
         color_type_(color_type) {};
-    const geometry::TSDFVoxel *voxels_;
+    const VoxelType *voxels_;
     const Eigen::Vector3i* keys_;
     const int resolution_;
     TSDFVolumeColorType color_type_;
@@ -201,14 +429,13 @@ struct extract_mesh_phase1_functor {
         Eigen::Vector3i idxs =
                 key + Eigen::Vector3i(shift[i][0], shift[i][1], shift[i][2]);
         Eigen::Vector3f c = Eigen::Vector3f::Zero();
-        if (voxels_[IndexOf(idxs, resolution_)].weight_ == 0.0f) {
+        const VoxelType &v = voxels_[IndexOf(idxs, resolution_)];
+        if (GetVoxelWeight(v) == 0.0f) {
             return thrust::make_tuple(0.0f, c);
         } else {
-            float f = voxels_[IndexOf(idxs, resolution_)].tsdf_;
-            if (color_type_ == TSDFVolumeColorType::RGB8) {
-                c = voxels_[IndexOf(idxs, resolution_)].color_ / 255.0;
-            } else if (color_type_ == TSDFVolumeColorType::Gray32) {
-                c = voxels_[IndexOf(idxs, resolution_)].color_;
+            float f = GetVoxelTSDF(v);
+            if (color_type_ != TSDFVolumeColorType::NoColor) {
+                c = GetVoxelColor(v, color_type_);
             }
             return thrust::make_tuple(f, c);
         }
@@ -306,7 +533,7 @@ struct extract_mesh_phase3_functor {
                 int tri_idx = tri_table[cube_index_[j]][i];
                 for (int l = key_index_[idx]; l < key_index_[idx + 1]; ++l) {
                     if (vert_no_[l] == tri_idx) {
-                        triangles_[idx * 4 + i / 3][vert_table[i % 3]] = l;
+                        triangles_[idx * 5 + i / 3][vert_table[i % 3]] = l;
                     }
                 }
             }
@@ -314,28 +541,34 @@ struct extract_mesh_phase3_functor {
     }
 };
 
+template <typename VoxelType>
 struct extract_voxel_pointcloud_functor {
-    extract_voxel_pointcloud_functor(const Eigen::Vector3f &origin,
+    extract_voxel_pointcloud_functor(const VoxelType *voxels,
+                                     const Eigen::Vector3f &origin,
                                      int resolution,
                                      float voxel_length)
-        : origin_(origin),
+        : voxels_(voxels),
+          origin_(origin),
           resolution_(resolution),
           voxel_length_(voxel_length),
           half_voxel_length_(0.5 * voxel_length){};
+    const VoxelType *voxels_;
     const Eigen::Vector3f origin_;
     const int resolution_;
     const float voxel_length_;
     const float half_voxel_length_;
     __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
-            const geometry::TSDFVoxel& v) {
-        int x = v.grid_index_[0];
-        int y = v.grid_index_[1];
-        int z = v.grid_index_[2];
+            size_t idx) {
+        const VoxelType &v = voxels_[idx];
+        const Eigen::Vector3i grid_index = GridIndexOf(idx, resolution_);
+        int x = grid_index[0];
+        int y = grid_index[1];
+        int z = grid_index[2];
         Eigen::Vector3f pt(half_voxel_length_ + voxel_length_ * x,
                            half_voxel_length_ + voxel_length_ * y,
                            half_voxel_length_ + voxel_length_ * z);
-        if (v.weight_ != 0.0f && v.tsdf_ < 0.98f && v.tsdf_ >= -0.98f) {
-            float c = (v.tsdf_ + 1.0) * 0.5;
+        if (IsSurfaceVoxel(v)) {
+            float c = (GetVoxelTSDF(v) + 1.0) * 0.5;
             return thrust::make_tuple(pt + origin_, Eigen::Vector3f(c, c, c));
         }
         return thrust::make_tuple(
@@ -348,18 +581,20 @@ struct extract_voxel_pointcloud_functor {
     }
 };
 
+template <typename VoxelType>
 struct extract_voxel_grid_functor {
-    extract_voxel_grid_functor(int resolution)
-        : resolution_(resolution){};
+    extract_voxel_grid_functor(const VoxelType *voxels, int resolution)
+        : voxels_(voxels), resolution_(resolution){};
+    const VoxelType *voxels_;
     const int resolution_;
     __device__ thrust::tuple<Eigen::Vector3i, geometry::Voxel> operator()(
-            const geometry::TSDFVoxel& v) {
-        const float w = v.weight_;
-        const float f = v.tsdf_;
-        if (w != 0.0f && f < 0.98f && f >= -0.98f) {
-            float c = (f + 1.0) * 0.5;
-            return thrust::make_tuple(v.grid_index_,
-                                      geometry::Voxel(v.grid_index_, Eigen::Vector3f(c, c, c)));
+            size_t idx) {
+        const VoxelType &v = voxels_[idx];
+        if (IsSurfaceVoxel(v)) {
+            const Eigen::Vector3i grid_index = GridIndexOf(idx, resolution_);
+            float c = (GetVoxelTSDF(v) + 1.0) * 0.5;
+            return thrust::make_tuple(grid_index,
+                                      geometry::Voxel(grid_index, Eigen::Vector3f(c, c, c)));
         }
         return thrust::make_tuple(Eigen::Vector3i(geometry::INVALID_VOXEL_INDEX,
                                                   geometry::INVALID_VOXEL_INDEX,
@@ -368,6 +603,28 @@ struct extract_voxel_grid_functor {
     }
 };
 
+struct is_valid_voxel_grid_entry_functor {
+    __device__ bool operator()(
+            const thrust::tuple<Eigen::Vector3i, geometry::Voxel> &x) const {
+        return thrust::get<0>(x) != Eigen::Vector3i(geometry::INVALID_VOXEL_INDEX,
+            geometry::INVALID_VOXEL_INDEX, geometry::INVALID_VOXEL_INDEX);
+    }
+};
+
+// Depth of the pixel \p p in meters, 0 if it is not valid.
+__device__ float ReadDepth(const float *p, float depth_scale_inv) { return *p; }
+
+__device__ float ReadDepth(const uint16_t *p, float depth_scale_inv) {
+    return *p * depth_scale_inv;
+}
+
+// The color type, the depth format and the source of the depth to camera
+// distance multipliers are template parameters, so that the voxel loop has
+// no runtime branch on them and only keeps the registers of its case.
+template <typename VoxelType,
+          TSDFVolumeColorType ColorType,
+          typename DepthType,
+          bool UseMultiplier>
 struct integrate_functor {
     integrate_functor(const Eigen::Vector3f &origin,
                       float fx,
@@ -384,20 +641,23 @@ struct integrate_functor {
                       const uint8_t *depth,
                       const uint8_t *depth_to_camera_distance_multiplier,
                       int width,
-                      int num_of_channels,
-                      TSDFVolumeColorType color_type,
-                      geometry::TSDFVoxel *voxels)
+                      float depth_scale,
+                      VoxelType *voxels,
+                      uint8_t *dirty_blocks,
+                      uint8_t *observed_blocks,
+                      uint8_t *esdf_dirty_blocks)
         : origin_(origin),
           fx_(fx),
           fy_(fy),
           cx_(cx),
           cy_(cy),
+          fx_inv_(1.0f / fx),
+          fy_inv_(1.0f / fy),
           extrinsic_(extrinsic),
           voxel_length_(voxel_length),
           half_voxel_length_(0.5 * voxel_length),
           sdf_trunc_(sdf_trunc),
           sdf_trunc_inv_(1.0 / sdf_trunc),
-          extrinsic_scaled_(voxel_length * extrinsic),
           safe_width_(safe_width),
           safe_height_(safe_height),
           resolution_(resolution),
@@ -406,96 +666,1023 @@ struct integrate_functor {
           depth_to_camera_distance_multiplier_(
                   depth_to_camera_distance_multiplier),
           width_(width),
-          num_of_channels_(num_of_channels),
-          color_type_(color_type),
-          voxels_(voxels){};
+          depth_scale_inv_(1.0f / depth_scale),
+          voxels_(voxels),
+          dirty_blocks_(dirty_blocks),
+          observed_blocks_(observed_blocks),
+          esdf_dirty_blocks_(esdf_dirty_blocks),
+          block_resolution_(UniformTSDFVolume::GetMeshBlockResolution(
+                  resolution)){};
+    static constexpr int kNumOfChannels =
+            (ColorType == TSDFVolumeColorType::RGB8) ? 3 : 1;
     const Eigen::Vector3f origin_;
     const float fx_;
     const float fy_;
     const float cx_;
     const float cy_;
+    const float fx_inv_;
+    const float fy_inv_;
     const Eigen::Matrix4f extrinsic_;
     const float voxel_length_;
     const float half_voxel_length_;
     const float sdf_trunc_;
     const float sdf_trunc_inv_;
-    const Eigen::Matrix4f extrinsic_scaled_;
     const float safe_width_;
     const float safe_height_;
     const int resolution_;
     const uint8_t *color_;
     const uint8_t *depth_;
+    /// Read if UseMultiplier, computed from the intrinsic otherwise.
     const uint8_t *depth_to_camera_distance_multiplier_;
     const int width_;
-    const int num_of_channels_;
-    const TSDFVolumeColorType color_type_;
-    geometry::TSDFVoxel *voxels_;
-    __device__ void operator()(size_t idx) {
-        int res2 = resolution_ * resolution_;
-        int x = idx / res2;
-        int yz = idx % res2;
-        int y = yz / resolution_;
-        int z = yz % resolution_;
-        voxels_[idx].grid_index_ = Eigen::Vector3i(x, y, z);
-
-        Eigen::Vector4f pt_3d_homo(
-                float(half_voxel_length_ + voxel_length_ * x + origin_(0)),
-                float(half_voxel_length_ + voxel_length_ * y + origin_(1)),
-                float(half_voxel_length_ + origin_(2)), 1.f);
-        Eigen::Vector4f pt_camera = extrinsic_ * pt_3d_homo;
-        pt_camera(0) += z * extrinsic_scaled_(0, 2);
-        pt_camera(1) += z * extrinsic_scaled_(1, 2);
-        pt_camera(2) += z * extrinsic_scaled_(2, 2);
+    const float depth_scale_inv_;
+    VoxelType *voxels_;
+    uint8_t *dirty_blocks_;
+    /// NULL while the observed blocks are not known.
+    uint8_t *observed_blocks_;
+    /// NULL until the first ESDF extraction.
+    uint8_t *esdf_dirty_blocks_;
+    const int block_resolution_;
+    /// Same values as Image::CreateDepthToCameraDistanceMultiplierFloatImage().
+    __device__ float DepthToCameraDistanceMultiplier(int u, int v) const {
+        if (UseMultiplier) {
+            return *geometry::PointerAt<float>(
+                    depth_to_camera_distance_multiplier_, width_, u, v);
+        }
+        const float x = (u - cx_) * fx_inv_;
+        const float y = (v - cy_) * fy_inv_;
+        return sqrtf(x * x + y * y + 1.0f);
+    }
+    /// Updates \p voxel at \p pt with the frame (\p color, \p depth) seen
+    /// from \p extrinsic. Returns false if the frame does not change it.
+    __device__ bool IntegrateFrame(VoxelType &voxel,
+                                   const Eigen::Vector4f &pt_3d_homo,
+                                   const Eigen::Matrix4f &extrinsic,
+                                   const uint8_t *color,
+                                   const uint8_t *depth) const {
+        Eigen::Vector4f pt_camera = extrinsic * pt_3d_homo;
         // Skip if negative depth after projection
         if (pt_camera(2) <= 0) {
-            return;
+            return false;
         }
         // Skip if x-y coordinate not in range
         float u_f = pt_camera(0) * fx_ / pt_camera(2) + cx_ + 0.5f;
         float v_f = pt_camera(1) * fy_ / pt_camera(2) + cy_ + 0.5f;
         if (!(u_f >= 0.0001f && u_f < safe_width_ && v_f >= 0.0001f &&
               v_f < safe_height_)) {
-            return;
+            return false;
         }
         // Skip if negative depth in depth image
         int u = (int)u_f;
         int v = (int)v_f;
-        float d = *geometry::PointerAt<float>(depth_, width_, u, v);
+        float d = ReadDepth(geometry::PointerAt<DepthType>(depth, width_, u, v),
+                            depth_scale_inv_);
         if (d <= 0.0f) {
-            return;
-        }
-
-        float sdf =
-                (d - pt_camera(2)) *
-                (*geometry::PointerAt<float>(
-                        depth_to_camera_distance_multiplier_, width_, u, v));
-        if (sdf > -sdf_trunc_) {
-            // integrate
-            float tsdf = min(1.0f, sdf * sdf_trunc_inv_);
-            voxels_[idx].tsdf_ =
-                    (voxels_[idx].tsdf_ * voxels_[idx].weight_ + tsdf) /
-                    (voxels_[idx].weight_ + 1.0f);
-            if (color_type_ == TSDFVolumeColorType::RGB8) {
-                const uint8_t *rgb = geometry::PointerAt<uint8_t>(
-                        color_, width_, num_of_channels_, u, v, 0);
-                Eigen::Vector3f rgb_f(rgb[0], rgb[1], rgb[2]);
-                voxels_[idx].color_ =
-                        (voxels_[idx].color_ * voxels_[idx].weight_ +
-                         rgb_f) /
-                        (voxels_[idx].weight_ + 1.0f);
-            } else if (color_type_ == TSDFVolumeColorType::Gray32) {
-                const float *intensity = geometry::PointerAt<float>(
-                        color_, width_, num_of_channels_, u, v, 0);
-                voxels_[idx].color_ = (voxels_[idx].color_.array() *
-                                                voxels_[idx].weight_ +
-                                         (*intensity)) /
-                                        (voxels_[idx].weight_ + 1.0f);
+            return false;
+        }
+
+        float sdf = (d - pt_camera(2)) * DepthToCameraDistanceMultiplier(u, v);
+        if (sdf <= -sdf_trunc_) return false;
+        // integrate
+        float tsdf = min(1.0f, sdf * sdf_trunc_inv_);
+        if (ColorType == TSDFVolumeColorType::RGB8) {
+            const uint8_t *rgb = geometry::PointerAt<uint8_t>(
+                    color, width_, kNumOfChannels, u, v, 0);
+            Eigen::Vector3f rgb_f(rgb[0], rgb[1], rgb[2]);
+            UpdateVoxel(voxel, tsdf, &rgb_f);
+        } else if (ColorType == TSDFVolumeColorType::Gray32) {
+            const float *intensity = geometry::PointerAt<float>(
+                    color, width_, kNumOfChannels, u, v, 0);
+            // The compact voxels keep the intensity in 8 bits.
+            const float color_scale =
+                    std::is_same<VoxelType, geometry::CompactTSDFVoxel>::value
+                            ? 255.0f
+                            : 1.0f;
+            Eigen::Vector3f gray_f =
+                    Eigen::Vector3f::Constant((*intensity) * color_scale);
+            UpdateVoxel(voxel, tsdf, &gray_f);
+        } else {
+            UpdateVoxel(voxel, tsdf, NULL);
+        }
+        return true;
+    }
+    __device__ Eigen::Vector4f VoxelPosition(
+            const Eigen::Vector3i &xyz) const {
+        return Eigen::Vector4f(
+                half_voxel_length_ + voxel_length_ * xyz(0) + origin_(0),
+                half_voxel_length_ + voxel_length_ * xyz(1) + origin_(1),
+                half_voxel_length_ + voxel_length_ * xyz(2) + origin_(2), 1.f);
+    }
+    __device__ void MarkDirty(const Eigen::Vector3i &xyz) const {
+        const int bs = UniformTSDFVolume::kMeshBlockSize;
+        const int b = IndexOf(xyz / bs, block_resolution_);
+        dirty_blocks_[b] = 1;
+        if (observed_blocks_) observed_blocks_[b] = 1;
+        if (esdf_dirty_blocks_) esdf_dirty_blocks_[b] = 1;
+    }
+    __device__ void operator()(size_t idx) {
+        const Eigen::Vector3i xyz = GridIndexOf(idx, resolution_);
+        SetVoxelGridIndex(voxels_[idx], xyz);
+        if (IntegrateFrame(voxels_[idx], VoxelPosition(xyz), extrinsic_,
+                           color_, depth_)) {
+            MarkDirty(xyz);
+        }
+    }
+};
+
+struct integration_frame {
+    const uint8_t *color_;
+    const uint8_t *depth_;
+    Eigen::Matrix4f_u extrinsic_;
+};
+
+// Integrates all the frames into a voxel kept in registers, so that every
+// voxel is read and written once per batch instead of once per frame.
+template <typename Base>
+struct integrate_batch_functor : public Base {
+    integrate_batch_functor(const Base &base,
+                            const integration_frame *frames,
+                            int n_frames)
+        : Base(base), frames_(frames), n_frames_(n_frames){};
+    const integration_frame *frames_;
+    const int n_frames_;
+    __device__ void operator()(size_t idx) {
+        const Eigen::Vector3i xyz = GridIndexOf(idx, this->resolution_);
+        const Eigen::Vector4f pt = this->VoxelPosition(xyz);
+        auto voxel = this->voxels_[idx];
+        bool updated = false;
+        for (int i = 0; i < n_frames_; ++i) {
+            const integration_frame &frame = frames_[i];
+            updated |= this->IntegrateFrame(voxel, pt, frame.extrinsic_,
+                                            frame.color_, frame.depth_);
+        }
+        if (!updated) return;
+        SetVoxelGridIndex(voxel, xyz);
+        this->voxels_[idx] = voxel;
+        this->MarkDirty(xyz);
+    }
+};
+
+template <typename VoxelType>
+struct raycast_functor {
+    raycast_functor(const VoxelType *voxels,
+                    const uint8_t *observed_blocks,
+                    int resolution,
+                    float voxel_length,
+                    float sdf_trunc,
+                    const Eigen::Vector3f &origin,
+                    const Eigen::Matrix3f &intrinsic,
+                    const Eigen::Matrix4f &extrinsic,
+                    int width,
+                    float max_depth,
+                    TSDFVolumeColorType color_type,
+                    uint8_t *vertex_map,
+                    uint8_t *normal_map,
+                    uint8_t *color_map,
+                    uint8_t *depth_map,
+                    uint8_t *rgb_map)
+        : voxels_(voxels),
+          observed_blocks_(observed_blocks),
+          resolution_(resolution),
+          block_resolution_(
+                  UniformTSDFVolume::GetMeshBlockResolution(resolution)),
+          voxel_length_(voxel_length),
+          sdf_trunc_(sdf_trunc),
+          origin_(origin),
+          intrinsic_inv_(intrinsic.inverse()),
+          R_(extrinsic.block<3, 3>(0, 0)),
+          t_(extrinsic.block<3, 1>(0, 3)),
+          width_(width),
+          max_depth_(max_depth),
+          color_type_(color_type),
+          vertex_map_(vertex_map),
+          normal_map_(normal_map),
+          color_map_(color_map),
+          depth_map_(depth_map),
+          rgb_map_(rgb_map){};
+    const VoxelType *voxels_;
+    const uint8_t *observed_blocks_;
+    const int resolution_;
+    const int block_resolution_;
+    const float voxel_length_;
+    const float sdf_trunc_;
+    const Eigen::Vector3f origin_;
+    const Eigen::Matrix3f intrinsic_inv_;
+    const Eigen::Matrix3f R_;
+    const Eigen::Vector3f t_;
+    const int width_;
+    const float max_depth_;
+    const TSDFVolumeColorType color_type_;
+    uint8_t *vertex_map_;
+    uint8_t *normal_map_;
+    uint8_t *color_map_;
+    uint8_t *depth_map_;
+    uint8_t *rgb_map_;
+    __device__ void Write(uint8_t *image, int x, int y,
+                          const Eigen::Vector3f &v) const {
+        if (!image) return;
+        for (int i = 0; i < 3; ++i) {
+            *geometry::PointerAt<float>(image, width_, 3, x, y, i) = v(i);
+        }
+    }
+    __device__ void WriteColor(int x, int y, const Eigen::Vector3f &c) const {
+        Write(color_map_, x, y, c);
+        if (!rgb_map_) return;
+        for (int i = 0; i < 3; ++i) {
+            *geometry::PointerAt<uint8_t>(rgb_map_, width_, 3, x, y, i) =
+                    (uint8_t)(max(0.0f, min(c(i), 1.0f)) * 255.0f + 0.5f);
+        }
+    }
+    /// Camera depth at which the ray leaves the block \p bi.
+    __device__ float BlockExit(const Eigen::Vector3f &o,
+                               const Eigen::Vector3f &d,
+                               const Eigen::Vector3i &bi) const {
+        const float block_length =
+                UniformTSDFVolume::kMeshBlockSize * voxel_length_;
+        float t_exit = max_depth_;
+        for (int i = 0; i < 3; ++i) {
+            if (d(i) == 0.0) continue;
+            const float bound = (bi(i) + (d(i) > 0.0 ? 1 : 0)) * block_length;
+            t_exit = min(t_exit, (bound - o(i)) / d(i));
+        }
+        return t_exit;
+    }
+    __device__ void operator()(size_t idx) {
+        const int y = idx / width_;
+        const int x = idx % width_;
+        const Eigen::Vector3f nan_v = Eigen::Vector3f::Constant(
+                std::numeric_limits<float>::quiet_NaN());
+        Write(vertex_map_, x, y, nan_v);
+        Write(normal_map_, x, y, nan_v);
+        WriteColor(x, y, Eigen::Vector3f::Zero());
+        if (depth_map_) *geometry::PointerAt<float>(depth_map_, width_, x, y) = 0.0f;
+
+        // Ray in volume coordinates, parametrized by the camera depth.
+        const Eigen::Vector3f ray_c = intrinsic_inv_ * Eigen::Vector3f(x, y, 1.0);
+        const Eigen::Vector3f o = -R_.transpose() * t_ - origin_;
+        const Eigen::Vector3f d = R_.transpose() * ray_c;
+        // The trilinear interpolation and the central differences of the
+        // normal read one voxel around the sample.
+        const float lo = 1.5 * voxel_length_;
+        const float hi = (resolution_ - 1.5) * voxel_length_;
+        float t_near = 0.0;
+        float t_far = max_depth_;
+        for (int i = 0; i < 3; ++i) {
+            if (d(i) == 0.0) {
+                if (o(i) < lo || o(i) > hi) return;
+                continue;
             }
-            voxels_[idx].weight_ += 1.0f;
+            float t0 = (lo - o(i)) / d(i);
+            float t1 = (hi - o(i)) / d(i);
+            t_near = max(t_near, min(t0, t1));
+            t_far = min(t_far, max(t0, t1));
+        }
+        if (t_near >= t_far) return;
+
+        // Steps are taken in camera depth, which moves |d| times further.
+        const float inv_d_norm = 1.0 / d.norm();
+        const float min_step = 0.5 * voxel_length_ * inv_d_norm;
+        float t_prev = -1.0;
+        float f_prev = 0.0;
+        for (float t = t_near; t <= t_far;) {
+            const Eigen::Vector3f p = o + t * d;
+            const Eigen::Vector3i vi = (p / voxel_length_).cast<int>();
+            // Empty space skipping: none of the voxels of an unobserved
+            // block has a weight, so the ray jumps over the whole block.
+            const Eigen::Vector3i bi = vi / UniformTSDFVolume::kMeshBlockSize;
+            if (!observed_blocks_[IndexOf(bi, block_resolution_)]) {
+                t_prev = -1.0;
+                t = max(BlockExit(o, d, bi), t) + 0.01f * min_step;
+                continue;
+            }
+            const VoxelType &voxel = voxels_[IndexOf(vi, resolution_)];
+            if (GetVoxelWeight(voxel) == 0.0f) {
+                t_prev = -1.0;
+                t += max(0.8f * sdf_trunc_ * inv_d_norm, min_step);
+                continue;
+            }
+            const float f = GetTSDFAt(p, voxels_, voxel_length_, resolution_);
+            if (t_prev >= 0.0 && f_prev < 0.0 && f >= 0.0) return;
+            if (t_prev >= 0.0 && f_prev > 0.0 && f <= 0.0) {
+                const float t_hit = t_prev + (t - t_prev) * f_prev / (f_prev - f);
+                const Eigen::Vector3f p_hit = o + t_hit * d;
+                Write(vertex_map_, x, y, t_hit * ray_c);
+                if (normal_map_) {
+                    const Eigen::Vector3f n = GetNormalAt(
+                            p_hit, voxels_, voxel_length_, resolution_);
+                    Write(normal_map_, x, y, R_ * n);
+                }
+                if (depth_map_) {
+                    *geometry::PointerAt<float>(depth_map_, width_, x, y) =
+                            t_hit;
+                }
+                if (color_map_ || rgb_map_) {
+                    const Eigen::Vector3i ci =
+                            (p_hit / voxel_length_).cast<int>();
+                    WriteColor(x, y,
+                               GetVoxelColor(voxels_[IndexOf(ci, resolution_)],
+                                             color_type_));
+                }
+                return;
+            }
+            t_prev = t;
+            f_prev = f;
+            t += max(0.8f * f * sdf_trunc_ * inv_d_norm, min_step);
         }
     }
 };
 
+template <typename VoxelType>
+struct observed_blocks_functor {
+    observed_blocks_functor(const VoxelType *voxels,
+                            int resolution,
+                            uint8_t *observed_blocks)
+        : voxels_(voxels),
+          resolution_(resolution),
+          block_resolution_(
+                  UniformTSDFVolume::GetMeshBlockResolution(resolution)),
+          observed_blocks_(observed_blocks){};
+    const VoxelType *voxels_;
+    const int resolution_;
+    const int block_resolution_;
+    uint8_t *observed_blocks_;
+    __device__ void operator()(size_t idx) {
+        if (GetVoxelWeight(voxels_[idx]) == 0.0f) return;
+        const Eigen::Vector3i xyz = GridIndexOf(idx, resolution_);
+        const int bs = UniformTSDFVolume::kMeshBlockSize;
+        observed_blocks_[IndexOf(xyz / bs, block_resolution_)] = 1;
+    }
+};
+
+template <typename VoxelType>
+size_t CountSurfaceVoxels(const utility::device_vector<VoxelType> &voxels) {
+    return thrust::count_if(voxels.begin(), voxels.end(),
+                            is_surface_voxel_functor<VoxelType>());
+}
+
+template <typename VoxelType>
+void ExtractPointCloudImpl(const UniformTSDFVolume &volume,
+                           const utility::device_vector<VoxelType> &voxels,
+                           geometry::PointCloud &pointcloud) {
+    size_t n_valid_voxels = CountSurfaceVoxels(voxels);
+    extract_pointcloud_functor<VoxelType> func(
+            thrust::raw_pointer_cast(voxels.data()), volume.resolution_,
+            volume.voxel_length_, volume.origin_, volume.color_type_);
+    resize_all(n_valid_voxels, pointcloud.points_, pointcloud.normals_,
+               pointcloud.colors_);
+    const int res = volume.resolution_;
+    size_t n_total = (res - 2) * (res - 2) * (res - 2) * 3;
+    auto begin = make_tuple_begin(pointcloud.points_, pointcloud.normals_,
+                                  pointcloud.colors_);
+    auto end_p = thrust::copy_if(thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func),
+                                 thrust::make_transform_iterator(thrust::make_counting_iterator(n_total), func),
+                                 begin, is_finite_point_functor());
+    resize_all(thrust::distance(begin, end_p), pointcloud.points_,
+               pointcloud.normals_, pointcloud.colors_);
+}
+
+/// Keys, cube indices and corner values of the cubes crossed by the surface,
+/// among the \p n_candidates cubes of \p candidates. At most \p n_alloc
+/// cubes are observed.
+template <typename VoxelType, typename KeyIterator>
+size_t ExtractSurfaceCubes(const UniformTSDFVolume &volume,
+                           const utility::device_vector<VoxelType> &voxels,
+                           KeyIterator candidates,
+                           size_t n_candidates,
+                           size_t n_alloc,
+                           utility::device_vector<Eigen::Vector3i> &keys,
+                           utility::device_vector<int> &cube_indices,
+                           utility::device_vector<float> &fs,
+                           utility::device_vector<Eigen::Vector3f> &cs,
+                           bool with_corners = true) {
+    const int res = volume.resolution_;
+    const VoxelType *voxels_p = thrust::raw_pointer_cast(voxels.data());
+
+    // compute cube indices for each voxels
+    resize_all(n_alloc, keys, cube_indices);
+    extract_mesh_phase0_functor<VoxelType> func0(voxels_p, res);
+    auto end0 = thrust::copy_if(
+            thrust::make_transform_iterator(candidates, func0),
+            thrust::make_transform_iterator(candidates + n_candidates, func0),
+            make_tuple_begin(keys, cube_indices), is_observed_cube_functor());
+    resize_all(thrust::distance(make_tuple_begin(keys, cube_indices), end0),
+               keys, cube_indices);
+    size_t n_result1 =
+            remove_if_vectors(is_empty_cube_functor(), keys, cube_indices);
+    if (!with_corners) return n_result1;
+
+    fs.resize(n_result1 * 8);
+    cs.resize(n_result1 * 8);
+    extract_mesh_phase1_functor<VoxelType> func1(
+            voxels_p, thrust::raw_pointer_cast(keys.data()), res,
+            volume.color_type_);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_result1 * 8),
+                      make_tuple_begin(fs, cs), func1);
+    return n_result1;
+}
+
+template <typename VoxelType>
+size_t ExtractAllSurfaceCubes(const UniformTSDFVolume &volume,
+                              const utility::device_vector<VoxelType> &voxels,
+                              utility::device_vector<Eigen::Vector3i> &keys,
+                              utility::device_vector<int> &cube_indices,
+                              utility::device_vector<float> &fs,
+                              utility::device_vector<Eigen::Vector3f> &cs,
+                              bool with_corners = true) {
+    const int res = volume.resolution_;
+    size_t n_valid_voxels = thrust::count_if(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(voxels.size()),
+            count_valid_voxels_functor<VoxelType>(
+                    thrust::raw_pointer_cast(voxels.data()), res));
+    size_t res3 = (res - 1) * (res - 1) * (res - 1);
+    return ExtractSurfaceCubes(
+            volume, voxels,
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0),
+                    dense_cube_key_functor(res)),
+            res3, n_valid_voxels, keys, cube_indices, fs, cs, with_corners);
+}
+
+template <typename VoxelType>
+size_t ExtractBlockSurfaceCubes(const UniformTSDFVolume &volume,
+                                const utility::device_vector<VoxelType> &voxels,
+                                const utility::device_vector<int> &blocks,
+                                utility::device_vector<Eigen::Vector3i> &keys,
+                                utility::device_vector<int> &cube_indices,
+                                utility::device_vector<float> &fs,
+                                utility::device_vector<Eigen::Vector3f> &cs) {
+    const int bs = UniformTSDFVolume::kMeshBlockSize;
+    const size_t n_candidates = blocks.size() * bs * bs * bs;
+    return ExtractSurfaceCubes(
+            volume, voxels,
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator<size_t>(0),
+                    block_cube_key_functor(
+                            thrust::raw_pointer_cast(blocks.data()),
+                            volume.resolution_, bs)),
+            n_candidates, n_candidates, keys, cube_indices, fs, cs);
+}
+
+// The edges of the grid are numbered 3 * voxel + axis, for the edge from the
+// voxel to its next voxel along the axis.
+__device__ int EdgeIdOf(const Eigen::Vector3i &key, int edge, int resolution) {
+    const Eigen::Vector3i v =
+            key + Eigen::Vector3i(edge_shift[edge][0], edge_shift[edge][1],
+                                  edge_shift[edge][2]);
+    return IndexOf(v, resolution) * 3 + edge_shift[edge][3];
+}
+
+struct mark_cube_edges_functor {
+    mark_cube_edges_functor(const Eigen::Vector3i *keys,
+                            const int *cube_indices,
+                            int resolution,
+                            uint8_t *edge_flags)
+        : keys_(keys),
+          cube_indices_(cube_indices),
+          resolution_(resolution),
+          edge_flags_(edge_flags){};
+    const Eigen::Vector3i *keys_;
+    const int *cube_indices_;
+    const int resolution_;
+    uint8_t *edge_flags_;
+    __device__ void operator()(size_t idx) {
+        const int j = idx / 12;
+        const int i = idx % 12;
+        if (edge_table[cube_indices_[j]] & (1 << i)) {
+            edge_flags_[EdgeIdOf(keys_[j], i, resolution_)] = 1;
+        }
+    }
+};
+
+template <typename VoxelType>
+struct edge_vertex_functor {
+    edge_vertex_functor(const VoxelType *voxels,
+                        int resolution,
+                        float voxel_length,
+                        const Eigen::Vector3f &origin,
+                        TSDFVolumeColorType color_type)
+        : voxels_(voxels),
+          resolution_(resolution),
+          voxel_length_(voxel_length),
+          origin_(origin),
+          color_type_(color_type){};
+    const VoxelType *voxels_;
+    const int resolution_;
+    const float voxel_length_;
+    const Eigen::Vector3f origin_;
+    const TSDFVolumeColorType color_type_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f> operator()(
+            int edge_id) const {
+        const int axis = edge_id % 3;
+        const Eigen::Vector3i v0 = GridIndexOf(edge_id / 3, resolution_);
+        Eigen::Vector3i v1 = v0;
+        v1(axis) += 1;
+        const VoxelType &voxel0 = voxels_[IndexOf(v0, resolution_)];
+        const VoxelType &voxel1 = voxels_[IndexOf(v1, resolution_)];
+        const float f0 = abs(GetVoxelTSDF(voxel0));
+        const float f1 = abs(GetVoxelTSDF(voxel1));
+        Eigen::Vector3f pt =
+                (v0.cast<float>() + Eigen::Vector3f::Constant(0.5)) *
+                voxel_length_;
+        pt(axis) += f0 * voxel_length_ / (f0 + f1);
+        Eigen::Vector3f color = Eigen::Vector3f::Zero();
+        if (color_type_ != TSDFVolumeColorType::NoColor) {
+            color = (f1 * GetVoxelColor(voxel0, color_type_) +
+                     f0 * GetVoxelColor(voxel1, color_type_)) /
+                    (f0 + f1);
+        }
+        return thrust::make_tuple(pt + origin_, color);
+    }
+};
+
+// Up to 5 triangles per cube, indexing the vertices of the sorted edge ids.
+struct cube_triangles_functor {
+    cube_triangles_functor(const Eigen::Vector3i *keys,
+                           const int *cube_indices,
+                           const int *edge_ids,
+                           int n_edges,
+                           int resolution,
+                           Eigen::Vector3i *triangles)
+        : keys_(keys),
+          cube_indices_(cube_indices),
+          edge_ids_(edge_ids),
+          n_edges_(n_edges),
+          resolution_(resolution),
+          triangles_(triangles){};
+    const Eigen::Vector3i *keys_;
+    const int *cube_indices_;
+    const int *edge_ids_;
+    const int n_edges_;
+    const int resolution_;
+    Eigen::Vector3i *triangles_;
+    __device__ void operator()(size_t j) {
+        const int cube_index = cube_indices_[j];
+        for (int i = 0; tri_table[cube_index][i] != -1; ++i) {
+            const int e = EdgeIdOf(keys_[j], tri_table[cube_index][i],
+                                   resolution_);
+            const int *it = thrust::lower_bound(thrust::seq, edge_ids_,
+                                                edge_ids_ + n_edges_, e);
+            triangles_[j * 5 + i / 3][vert_table[i % 3]] = it - edge_ids_;
+        }
+    }
+};
+
+/// Marching cubes with the vertices shared by the cubes around an edge:
+/// the edges crossed by the surface are flagged in a per edge array and
+/// compacted in order, which numbers the vertices without sorting them.
+template <typename VoxelType>
+void BuildIndexedMesh(const UniformTSDFVolume &volume,
+                      const utility::device_vector<VoxelType> &voxels,
+                      const utility::device_vector<Eigen::Vector3i> &keys,
+                      const utility::device_vector<int> &cube_indices,
+                      size_t n_cubes,
+                      geometry::TriangleMesh &mesh) {
+    const int res = volume.resolution_;
+    const size_t n_edge_slots = (size_t)volume.voxel_num_ * 3;
+    utility::device_vector<uint8_t> edge_flags(n_edge_slots, 0);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_cubes * 12),
+                     mark_cube_edges_functor(
+                             thrust::raw_pointer_cast(keys.data()),
+                             thrust::raw_pointer_cast(cube_indices.data()),
+                             res, thrust::raw_pointer_cast(edge_flags.data())));
+    const size_t n_vertices =
+            thrust::count(edge_flags.begin(), edge_flags.end(), 1);
+    utility::device_vector<int> edge_ids(n_vertices);
+    thrust::copy_if(thrust::make_counting_iterator(0),
+                    thrust::make_counting_iterator((int)n_edge_slots),
+                    edge_flags.begin(), edge_ids.begin(),
+                    thrust::identity<uint8_t>());
+    edge_flags.clear();
+    edge_flags.shrink_to_fit();
+
+    resize_all(n_vertices, mesh.vertices_, mesh.vertex_colors_);
+    thrust::transform(edge_ids.begin(), edge_ids.end(),
+                      make_tuple_begin(mesh.vertices_, mesh.vertex_colors_),
+                      edge_vertex_functor<VoxelType>(
+                              thrust::raw_pointer_cast(voxels.data()), res,
+                              volume.voxel_length_, volume.origin_,
+                              volume.color_type_));
+
+    mesh.triangles_.resize(n_cubes * 5, Eigen::Vector3i(-1, -1, -1));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_cubes),
+                     cube_triangles_functor(
+                             thrust::raw_pointer_cast(keys.data()),
+                             thrust::raw_pointer_cast(cube_indices.data()),
+                             thrust::raw_pointer_cast(edge_ids.data()),
+                             n_vertices, res,
+                             thrust::raw_pointer_cast(mesh.triangles_.data())));
+    auto end = thrust::remove_if(mesh.triangles_.begin(),
+                                 mesh.triangles_.end(),
+                                 is_invalid_triangle_functor());
+    mesh.triangles_.resize(thrust::distance(mesh.triangles_.begin(), end));
+}
+
+struct has_edge_vertex_functor {
+    has_edge_vertex_functor(const int *cube_indices)
+        : cube_indices_(cube_indices){};
+    const int *cube_indices_;
+    __device__ bool operator()(size_t idx) const {
+        int i = idx / 12;
+        int j = idx % 12;
+        return (edge_table[cube_indices_[i]] & (1 << j)) > 0;
+    }
+};
+
+struct is_edge_vertex_functor {
+    template <typename Tuple>
+    __device__ bool operator()(const Tuple &x) const {
+        return thrust::get<0>(x)[0] >= 0;
+    }
+};
+
+struct is_invalid_triangle_functor {
+    __device__ bool operator()(const Eigen::Vector3i &idxs) const {
+        return idxs[0] < 0;
+    }
+    __device__ bool operator()(
+            const thrust::tuple<Eigen::Vector3i, Eigen::Vector3i> &x) const {
+        return thrust::get<0>(x)[0] < 0;
+    }
+};
+
+struct triangle_key_functor {
+    triangle_key_functor(const Eigen::Vector3i *repeat_keys,
+                         const int *vt_offsets)
+        : repeat_keys_(repeat_keys), vt_offsets_(vt_offsets){};
+    const Eigen::Vector3i *repeat_keys_;
+    const int *vt_offsets_;
+    __device__ Eigen::Vector3i operator()(size_t idx) const {
+        return repeat_keys_[vt_offsets_[idx / 5]];
+    }
+};
+
+/// Vertices and triangles of the cubes from ExtractSurfaceCubes(). If
+/// \p vertex_keys and \p triangle_keys are given, they receive the cube of
+/// every vertex and triangle.
+void BuildMeshFromCubes(
+        const UniformTSDFVolume &volume,
+        const utility::device_vector<Eigen::Vector3i> &keys,
+        const utility::device_vector<int> &cube_indices,
+        const utility::device_vector<float> &fs,
+        const utility::device_vector<Eigen::Vector3f> &cs,
+        size_t n_cubes,
+        geometry::TriangleMesh &mesh,
+        utility::device_vector<Eigen::Vector3i> *vertex_keys = NULL,
+        utility::device_vector<Eigen::Vector3i> *triangle_keys = NULL) {
+    // compute vertices and vertex_colors
+    const int *ci_p = thrust::raw_pointer_cast(cube_indices.data());
+    size_t n_valid_cubes = thrust::count_if(thrust::make_counting_iterator<size_t>(0),
+                                            thrust::make_counting_iterator(n_cubes * 12),
+                                            has_edge_vertex_functor(ci_p));
+    resize_all(n_valid_cubes, mesh.vertices_, mesh.vertex_colors_);
+    utility::device_vector<Eigen::Vector3i> repeat_keys(n_valid_cubes);
+    utility::device_vector<int> repeat_cube_indices(n_valid_cubes);
+    utility::device_vector<int> vert_no(n_valid_cubes);
+    extract_mesh_phase2_functor func2(thrust::raw_pointer_cast(keys.data()), ci_p,
+                                      volume.origin_, volume.resolution_,
+                                      volume.voxel_length_,
+                                      thrust::raw_pointer_cast(fs.data()),
+                                      thrust::raw_pointer_cast(cs.data()),
+                                      volume.color_type_);
+    thrust::copy_if(
+            thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func2),
+            thrust::make_transform_iterator(thrust::make_counting_iterator(n_cubes * 12), func2),
+            make_tuple_begin(repeat_keys, repeat_cube_indices, vert_no,
+                             mesh.vertices_, mesh.vertex_colors_),
+            is_edge_vertex_functor());
+
+    // compute triangles
+    utility::device_vector<int> vt_offsets(n_valid_cubes + 1, 0);
+    auto end2 = thrust::reduce_by_key(repeat_keys.begin(), repeat_keys.end(),
+                                      thrust::make_constant_iterator<int>(1),
+                                      thrust::make_discard_iterator(), vt_offsets.begin());
+    size_t n_result2 = thrust::distance(vt_offsets.begin(), end2.second);
+    vt_offsets.resize(n_result2 + 1);
+    thrust::exclusive_scan(vt_offsets.begin(), vt_offsets.end(), vt_offsets.begin());
+    mesh.triangles_.resize(n_result2 * 5, Eigen::Vector3i(-1, -1, -1));
+    extract_mesh_phase3_functor func3(
+            thrust::raw_pointer_cast(repeat_cube_indices.data()),
+            thrust::raw_pointer_cast(vert_no.data()),
+            thrust::raw_pointer_cast(vt_offsets.data()),
+            thrust::raw_pointer_cast(mesh.triangles_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_result2), func3);
+    if (triangle_keys) {
+        triangle_keys->resize(mesh.triangles_.size());
+        thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                          thrust::make_counting_iterator(mesh.triangles_.size()),
+                          triangle_keys->begin(),
+                          triangle_key_functor(
+                                  thrust::raw_pointer_cast(repeat_keys.data()),
+                                  thrust::raw_pointer_cast(vt_offsets.data())));
+        remove_if_vectors(is_invalid_triangle_functor(), mesh.triangles_,
+                          *triangle_keys);
+    } else {
+        auto end3 = thrust::remove_if(mesh.triangles_.begin(),
+                                      mesh.triangles_.end(),
+                                      is_invalid_triangle_functor());
+        mesh.triangles_.resize(
+                thrust::distance(mesh.triangles_.begin(), end3));
+    }
+    if (vertex_keys) vertex_keys->swap(repeat_keys);
+}
+
+template <typename VoxelType>
+void ExtractVoxelPointCloudImpl(const UniformTSDFVolume &volume,
+                                const utility::device_vector<VoxelType> &voxels,
+                                geometry::PointCloud &voxel) {
+    size_t n_valid_voxels = CountSurfaceVoxels(voxels);
+    extract_voxel_pointcloud_functor<VoxelType> func(
+            thrust::raw_pointer_cast(voxels.data()), volume.origin_,
+            volume.resolution_, volume.voxel_length_);
+    resize_all(n_valid_voxels, voxel.points_, voxel.colors_);
+    thrust::copy_if(
+            thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func),
+            thrust::make_transform_iterator(thrust::make_counting_iterator(voxels.size()), func),
+            make_tuple_begin(voxel.points_, voxel.colors_),
+            is_finite_point_functor());
+}
+
+template <typename VoxelType>
+void ExtractVoxelGridImpl(const UniformTSDFVolume &volume,
+                          const utility::device_vector<VoxelType> &voxels,
+                          geometry::VoxelGrid &voxel_grid) {
+    size_t n_valid_voxels = CountSurfaceVoxels(voxels);
+    resize_all(n_valid_voxels, voxel_grid.voxels_keys_, voxel_grid.voxels_values_);
+    extract_voxel_grid_functor<VoxelType> func(
+            thrust::raw_pointer_cast(voxels.data()), volume.resolution_);
+    thrust::copy_if(thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func),
+                    thrust::make_transform_iterator(thrust::make_counting_iterator(voxels.size()), func),
+                    make_tuple_begin(voxel_grid.voxels_keys_, voxel_grid.voxels_values_),
+                    is_valid_voxel_grid_entry_functor());
+}
+
+bool IsSupportedImage(const geometry::RGBDImage &image,
+                      const camera::PinholeCameraIntrinsic &intrinsic,
+                      TSDFVolumeColorType color_type) {
+    return !((image.depth_.num_of_channels_ != 1) ||
+             (image.depth_.bytes_per_channel_ != 4 &&
+              image.depth_.bytes_per_channel_ != 2) ||
+             (image.depth_.width_ != intrinsic.width_) ||
+             (image.depth_.height_ != intrinsic.height_) ||
+             (color_type == TSDFVolumeColorType::RGB8 &&
+              image.color_.num_of_channels_ != 3) ||
+             (color_type == TSDFVolumeColorType::RGB8 &&
+              image.color_.bytes_per_channel_ != 1) ||
+             (color_type == TSDFVolumeColorType::Gray32 &&
+              image.color_.num_of_channels_ != 1) ||
+             (color_type == TSDFVolumeColorType::Gray32 &&
+              image.color_.bytes_per_channel_ != 4) ||
+             (color_type != TSDFVolumeColorType::NoColor &&
+              image.color_.width_ != intrinsic.width_) ||
+             (color_type != TSDFVolumeColorType::NoColor &&
+              image.color_.height_ != intrinsic.height_));
+}
+
+// Runtime arguments of an integration, the same for all the kernel
+// specializations. A single frame is integrated by integrate_functor, more
+// by integrate_batch_functor.
+template <typename VoxelType>
+struct integration_call {
+    const UniformTSDFVolume *volume_;
+    const camera::PinholeCameraIntrinsic *intrinsic_;
+    std::vector<integration_frame> frames_;
+    /// NULL to compute the multipliers in the kernel.
+    const uint8_t *depth_to_camera_distance_multiplier_;
+    utility::device_vector<VoxelType> *voxels_;
+    uint8_t *dirty_blocks_;
+    uint8_t *observed_blocks_;
+    uint8_t *esdf_dirty_blocks_;
+};
+
+template <typename VoxelType,
+          TSDFVolumeColorType ColorType,
+          typename DepthType,
+          bool UseMultiplier>
+void LaunchIntegration(utility::ExecutionContext &ctx,
+                       const integration_call<VoxelType> &call) {
+    const UniformTSDFVolume &volume = *call.volume_;
+    const camera::PinholeCameraIntrinsic &intrinsic = *call.intrinsic_;
+    const integration_frame &first = call.frames_[0];
+    integrate_functor<VoxelType, ColorType, DepthType, UseMultiplier> func(
+            volume.origin_, intrinsic.GetFocalLength().first,
+            intrinsic.GetFocalLength().second,
+            intrinsic.GetPrincipalPoint().first,
+            intrinsic.GetPrincipalPoint().second, first.extrinsic_,
+            volume.voxel_length_, volume.sdf_trunc_,
+            intrinsic.width_ - 0.0001f, intrinsic.height_ - 0.0001f,
+            volume.resolution_, first.color_, first.depth_,
+            call.depth_to_camera_distance_multiplier_, intrinsic.width_,
+            volume.depth_scale_, thrust::raw_pointer_cast(call.voxels_->data()),
+            call.dirty_blocks_, call.observed_blocks_,
+            call.esdf_dirty_blocks_);
+    if (call.frames_.size() == 1) {
+        utility::TunedForEach("UniformTSDFVolume::Integrate",
+                              volume.voxel_num_, func, ctx.GetStream());
+    } else {
+        utility::device_vector<integration_frame> frames = call.frames_;
+        integrate_batch_functor<decltype(func)> batch_func(
+                func, thrust::raw_pointer_cast(frames.data()), frames.size());
+        utility::TunedForEach("UniformTSDFVolume::IntegrateBatch",
+                              volume.voxel_num_, batch_func, ctx.GetStream());
+    }
+    ctx.Synchronize();
+}
+
+template <typename VoxelType, TSDFVolumeColorType ColorType, typename DepthType>
+void DispatchIntegrationMultiplier(utility::ExecutionContext &ctx,
+                                   const integration_call<VoxelType> &call) {
+    if (call.depth_to_camera_distance_multiplier_) {
+        LaunchIntegration<VoxelType, ColorType, DepthType, true>(ctx, call);
+    } else {
+        LaunchIntegration<VoxelType, ColorType, DepthType, false>(ctx, call);
+    }
+}
+
+template <typename VoxelType, TSDFVolumeColorType ColorType>
+void DispatchIntegrationDepth(utility::ExecutionContext &ctx,
+                              const integration_call<VoxelType> &call,
+                              int depth_bytes) {
+    if (depth_bytes == 2) {
+        DispatchIntegrationMultiplier<VoxelType, ColorType, uint16_t>(ctx,
+                                                                      call);
+    } else {
+        DispatchIntegrationMultiplier<VoxelType, ColorType, float>(ctx, call);
+    }
+}
+
+// Selects the kernel of the color type of the volume and of the depth
+// format of the images, once per call.
+template <typename VoxelType>
+void IntegrateImpl(utility::ExecutionContext &ctx,
+                   const UniformTSDFVolume &volume,
+                   const std::vector<const geometry::RGBDImage *> &images,
+                   const camera::PinholeCameraIntrinsic &intrinsic,
+                   const std::vector<Eigen::Matrix4f_u> &extrinsics,
+                   const geometry::Image *depth_to_camera_distance_multiplier,
+                   utility::device_vector<VoxelType> &voxels,
+                   utility::device_vector<uint8_t> &dirty_blocks,
+                   utility::device_vector<uint8_t> &observed_blocks,
+                   utility::device_vector<uint8_t> &esdf_dirty_blocks) {
+    voxels.resize(volume.voxel_num_);
+    integration_call<VoxelType> call;
+    call.volume_ = &volume;
+    call.intrinsic_ = &intrinsic;
+    call.frames_.resize(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        call.frames_[i].color_ =
+                thrust::raw_pointer_cast(images[i]->color_.data_.data());
+        call.frames_[i].depth_ =
+                thrust::raw_pointer_cast(images[i]->depth_.data_.data());
+        call.frames_[i].extrinsic_ = extrinsics[i];
+    }
+    call.depth_to_camera_distance_multiplier_ =
+            (depth_to_camera_distance_multiplier &&
+             !depth_to_camera_distance_multiplier->IsEmpty())
+                    ? thrust::raw_pointer_cast(
+                              depth_to_camera_distance_multiplier->data_.data())
+                    : nullptr;
+    call.voxels_ = &voxels;
+    call.dirty_blocks_ = thrust::raw_pointer_cast(dirty_blocks.data());
+    call.observed_blocks_ =
+            observed_blocks.empty()
+                    ? nullptr
+                    : thrust::raw_pointer_cast(observed_blocks.data());
+    call.esdf_dirty_blocks_ =
+            esdf_dirty_blocks.empty()
+                    ? nullptr
+                    : thrust::raw_pointer_cast(esdf_dirty_blocks.data());
+    const int depth_bytes = images[0]->depth_.bytes_per_channel_;
+    switch (volume.color_type_) {
+        case TSDFVolumeColorType::RGB8:
+            DispatchIntegrationDepth<VoxelType, TSDFVolumeColorType::RGB8>(
+                    ctx, call, depth_bytes);
+            break;
+        case TSDFVolumeColorType::Gray32:
+            DispatchIntegrationDepth<VoxelType, TSDFVolumeColorType::Gray32>(
+                    ctx, call, depth_bytes);
+            break;
+        default:
+            DispatchIntegrationDepth<VoxelType, TSDFVolumeColorType::NoColor>(
+                    ctx, call, depth_bytes);
+            break;
+    }
+}
+
+uint8_t *ImageData(geometry::Image *image) {
+    return image ? thrust::raw_pointer_cast(image->data_.data()) : nullptr;
+}
+
+template <typename VoxelType>
+void ComputeObservedBlocks(const UniformTSDFVolume &volume,
+                           const utility::device_vector<VoxelType> &voxels,
+                           utility::device_vector<uint8_t> &observed_blocks) {
+    const int block_resolution =
+            UniformTSDFVolume::GetMeshBlockResolution(volume.resolution_);
+    observed_blocks.resize(block_resolution * block_resolution *
+                           block_resolution);
+    thrust::fill(observed_blocks.begin(), observed_blocks.end(), 0);
+    observed_blocks_functor<VoxelType> func(
+            thrust::raw_pointer_cast(voxels.data()), volume.resolution_,
+            thrust::raw_pointer_cast(observed_blocks.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(voxels.size()),
+                     func);
+}
+
+/// The maps that are NULL are not written.
+template <typename VoxelType>
+void RaycastImpl(utility::ExecutionContext &ctx,
+                 const UniformTSDFVolume &volume,
+                 const utility::device_vector<VoxelType> &voxels,
+                 const utility::device_vector<uint8_t> &observed_blocks,
+                 const camera::PinholeCameraIntrinsic &intrinsic,
+                 const Eigen::Matrix4f &extrinsic,
+                 float max_depth,
+                 geometry::Image *vertex_map,
+                 geometry::Image *normal_map,
+                 geometry::Image *color_map,
+                 geometry::Image *depth_map,
+                 geometry::Image *rgb_map) {
+    const int width = intrinsic.width_;
+    const int height = intrinsic.height_;
+    raycast_functor<VoxelType> func(
+            thrust::raw_pointer_cast(voxels.data()),
+            thrust::raw_pointer_cast(observed_blocks.data()),
+            volume.resolution_, volume.voxel_length_, volume.sdf_trunc_,
+            volume.origin_, intrinsic.intrinsic_matrix_, extrinsic, width,
+            max_depth, volume.color_type_, ImageData(vertex_map),
+            ImageData(normal_map), ImageData(color_map), ImageData(depth_map),
+            ImageData(rgb_map));
+    cudaStream_t stream = ctx.GetStream();
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(width * height),
+                     func);
+    ctx.Synchronize();
+}
+
+// A cube reads the voxels of its block and of the next block along every
+// axis, so a block is remeshed if any of these eight blocks changed.
+struct dilate_dirty_blocks_functor {
+    dilate_dirty_blocks_functor(const uint8_t *dirty_blocks,
+                                int block_resolution)
+        : dirty_blocks_(dirty_blocks), block_resolution_(block_resolution){};
+    const uint8_t *dirty_blocks_;
+    const int block_resolution_;
+    __device__ uint8_t operator()(size_t idx) const {
+        const Eigen::Vector3i b = GridIndexOf(idx, block_resolution_);
+        for (int i = 0; i < 8; ++i) {
+            const Eigen::Vector3i bi =
+                    b + Eigen::Vector3i(shift[i][0], shift[i][1], shift[i][2]);
+            if ((bi.array() >= block_resolution_).any()) continue;
+            if (dirty_blocks_[IndexOf(bi, block_resolution_)]) return 1;
+        }
+        return 0;
+    }
+};
+
+struct key_to_block_functor {
+    key_to_block_functor(int block_resolution)
+        : block_resolution_(block_resolution){};
+    const int block_resolution_;
+    __device__ int operator()(const Eigen::Vector3i &key) const {
+        return IndexOf(key / UniformTSDFVolume::kMeshBlockSize,
+                       block_resolution_);
+    }
+};
+
+struct is_remeshed_functor {
+    is_remeshed_functor(const uint8_t *remesh) : remesh_(remesh){};
+    const uint8_t *remesh_;
+    __device__ bool operator()(int block) const { return remesh_[block] != 0; }
+    template <typename Tuple>
+    __device__ bool operator()(const Tuple &x) const {
+        return remesh_[thrust::get<0>(x)] != 0;
+    }
+};
+
+struct remap_triangle_functor {
+    remap_triangle_functor(const int *new_index) : new_index_(new_index){};
+    const int *new_index_;
+    __device__ Eigen::Vector3i operator()(const Eigen::Vector3i &t) const {
+        return Eigen::Vector3i(new_index_[t[0]], new_index_[t[1]],
+                               new_index_[t[2]]);
+    }
+};
+
+struct offset_triangle_functor {
+    offset_triangle_functor(int offset) : offset_(offset){};
+    const int offset_;
+    __device__ Eigen::Vector3i operator()(const Eigen::Vector3i &t) const {
+        return t + Eigen::Vector3i::Constant(offset_);
+    }
+};
+
 }  // namespace
 
 UniformTSDFVolume::UniformTSDFVolume(
@@ -503,80 +1690,199 @@ UniformTSDFVolume::UniformTSDFVolume(
         int resolution,
         float sdf_trunc,
         TSDFVolumeColorType color_type,
-        const Eigen::Vector3f &origin /* = Eigen::Vector3f::Zero()*/)
+        const Eigen::Vector3f &origin /* = Eigen::Vector3f::Zero()*/,
+        bool use_compact_voxels /* = false*/)
     : TSDFVolume(length / (float)resolution, sdf_trunc, color_type),
+      use_compact_voxels_(use_compact_voxels),
       origin_(origin),
       length_(length),
       resolution_(resolution),
       voxel_num_(resolution * resolution * resolution) {
-    voxels_.resize(voxel_num_);
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+    if (use_compact_voxels_) {
+        compact_voxels_ =
+                utility::MakeVolumeVector<geometry::CompactTSDFVoxel>(
+                        voxel_num_);
+    } else {
+        voxels_ = utility::MakeVolumeVector<geometry::TSDFVoxel>(voxel_num_);
+    }
+    ResizeMeshBlocks();
 }
 
 UniformTSDFVolume::~UniformTSDFVolume() {}
 
 UniformTSDFVolume::UniformTSDFVolume(const UniformTSDFVolume &other)
- : TSDFVolume(other), voxels_(other.voxels_), origin_(other.origin_),
- length_(other.length_), resolution_(other.resolution_), voxel_num_(other.voxel_num_)
+ : TSDFVolume(other), voxels_(other.voxels_),
+ compact_voxels_(other.compact_voxels_),
+ use_compact_voxels_(other.use_compact_voxels_),
+ depth_scale_(other.depth_scale_), origin_(other.origin_),
+ length_(other.length_), resolution_(other.resolution_), voxel_num_(other.voxel_num_),
+ dirty_blocks_(other.dirty_blocks_),
+ observed_blocks_(other.observed_blocks_),
+ incremental_mesh_(other.incremental_mesh_
+                           ? std::make_shared<geometry::TriangleMesh>(
+                                     *other.incremental_mesh_)
+                           : nullptr),
+ mesh_vertex_blocks_(other.mesh_vertex_blocks_),
+ mesh_triangle_blocks_(other.mesh_triangle_blocks_),
+ esdf_(other.esdf_ ? std::make_shared<geometry::DistanceTransform>(*other.esdf_)
+                   : nullptr),
+ esdf_max_distance_(other.esdf_max_distance_),
+ esdf_dirty_blocks_(other.esdf_dirty_blocks_)
 {}
 
-void UniformTSDFVolume::Reset() { voxels_.clear(); }
+void UniformTSDFVolume::Reset() {
+    voxels_.clear();
+    compact_voxels_.clear();
+    incremental_mesh_.reset();
+    ResizeMeshBlocks();
+}
+
+size_t UniformTSDFVolume::GetMemorySize() const {
+    return voxels_.size() * sizeof(geometry::TSDFVoxel) +
+           compact_voxels_.size() * sizeof(geometry::CompactTSDFVoxel);
+}
+
+void UniformTSDFVolume::PrefetchFrustum(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth /* = 0.0*/) const {
+    const void *data =
+            (use_compact_voxels_)
+                    ? (const void *)thrust::raw_pointer_cast(
+                              compact_voxels_.data())
+                    : (const void *)thrust::raw_pointer_cast(voxels_.data());
+    if (!utility::IsManagedMemory(data)) return;
+    const Eigen::Matrix4f camera_to_world = extrinsic.inverse();
+    const Eigen::Vector3f center = camera_to_world.block<3, 1>(0, 3);
+    if (max_depth <= 0.0) {
+        // Distance to the farthest corner of the volume.
+        for (int i = 0; i < 8; ++i) {
+            const Eigen::Vector3f corner =
+                    origin_ + length_ * Eigen::Vector3f(i & 1, (i >> 1) & 1,
+                                                        (i >> 2) & 1);
+            max_depth = std::max(max_depth, (corner - center).norm());
+        }
+    }
+    const float fx = intrinsic.GetFocalLength().first;
+    const float fy = intrinsic.GetFocalLength().second;
+    const float cx = intrinsic.GetPrincipalPoint().first;
+    const float cy = intrinsic.GetPrincipalPoint().second;
+    // The voxels are ordered by x first, so the frustum covers the slabs
+    // between the smallest and the largest x of its corners.
+    float x_min = center[0];
+    float x_max = center[0];
+    for (int i = 0; i < 4; ++i) {
+        const float u = (i & 1) ? intrinsic.width_ : 0.0f;
+        const float v = (i & 2) ? intrinsic.height_ : 0.0f;
+        const Eigen::Vector3f p =
+                camera_to_world.block<3, 3>(0, 0) *
+                        Eigen::Vector3f((u - cx) / fx * max_depth,
+                                        (v - cy) / fy * max_depth, max_depth) +
+                center;
+        x_min = std::min(x_min, p[0]);
+        x_max = std::max(x_max, p[0]);
+    }
+    const int i_min = std::max(
+            (int)std::floor((x_min - origin_[0]) / voxel_length_), 0);
+    const int i_max = std::min(
+            (int)std::floor((x_max - origin_[0]) / voxel_length_) + 1,
+            resolution_);
+    const size_t voxel_bytes = (use_compact_voxels_)
+                                       ? sizeof(geometry::CompactTSDFVoxel)
+                                       : sizeof(geometry::TSDFVoxel);
+    const size_t slab_bytes =
+            (size_t)resolution_ * resolution_ * voxel_bytes;
+    utility::PrefetchManagedRegion(data, (size_t)voxel_num_ * voxel_bytes,
+                                   std::max(i_min, 0) * slab_bytes,
+                                   std::max(i_max, i_min) * slab_bytes,
+                                   ctx.GetStream());
+}
+
+void UniformTSDFVolume::Integrate(
+        const geometry::RGBDImage &image,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic) {
+    Integrate(utility::ExecutionContext::Default(), image, intrinsic,
+              extrinsic);
+}
 
 void UniformTSDFVolume::Integrate(
+        utility::ExecutionContext &ctx,
         const geometry::RGBDImage &image,
         const camera::PinholeCameraIntrinsic &intrinsic,
         const Eigen::Matrix4f &extrinsic) {
+    CUPOCH_PROFILE("UniformTSDFVolume::Integrate", ctx.GetStream());
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
     // This function goes through the voxels, and scan convert the relative
     // depth/color value into the voxel.
     // The following implementation is a highly optimized version.
-    if ((image.depth_.num_of_channels_ != 1) ||
-        (image.depth_.bytes_per_channel_ != 4) ||
-        (image.depth_.width_ != intrinsic.width_) ||
-        (image.depth_.height_ != intrinsic.height_) ||
-        (color_type_ == TSDFVolumeColorType::RGB8 &&
-         image.color_.num_of_channels_ != 3) ||
-        (color_type_ == TSDFVolumeColorType::RGB8 &&
-         image.color_.bytes_per_channel_ != 1) ||
-        (color_type_ == TSDFVolumeColorType::Gray32 &&
-         image.color_.num_of_channels_ != 1) ||
-        (color_type_ == TSDFVolumeColorType::Gray32 &&
-         image.color_.bytes_per_channel_ != 4) ||
-        (color_type_ != TSDFVolumeColorType::NoColor &&
-         image.color_.width_ != intrinsic.width_) ||
-        (color_type_ != TSDFVolumeColorType::NoColor &&
-         image.color_.height_ != intrinsic.height_)) {
+    if (!IsSupportedImage(image, intrinsic, color_type_)) {
         utility::LogError(
                 "[UniformTSDFVolume::Integrate] Unsupported image format.");
     }
-    auto depth2cameradistance =
-            geometry::Image::CreateDepthToCameraDistanceMultiplierFloatImage(
-                    intrinsic);
-    IntegrateWithDepthToCameraDistanceMultiplier(image, intrinsic, extrinsic,
-                                                 *depth2cameradistance);
+    // The multipliers are computed by the kernel.
+    IntegrateWithDepthToCameraDistanceMultiplier(ctx, image, intrinsic,
+                                                 extrinsic, geometry::Image());
+}
+
+void UniformTSDFVolume::IntegrateBatch(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &images,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const std::vector<Eigen::Matrix4f_u> &extrinsics) {
+    IntegrateBatch(utility::ExecutionContext::Default(), images, intrinsic,
+                   extrinsics);
+}
+
+void UniformTSDFVolume::IntegrateBatch(
+        utility::ExecutionContext &ctx,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &images,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const std::vector<Eigen::Matrix4f_u> &extrinsics) {
+    if (images.size() != extrinsics.size()) {
+        utility::LogError(
+                "[UniformTSDFVolume::IntegrateBatch] The numbers of images "
+                "({}) and extrinsics ({}) differ.",
+                images.size(), extrinsics.size());
+    }
+    if (images.empty()) return;
+    std::vector<const geometry::RGBDImage *> frames;
+    for (const auto &image : images) {
+        // One kernel integrates the batch, for one depth format.
+        if (!image || !IsSupportedImage(*image, intrinsic, color_type_) ||
+            image->depth_.bytes_per_channel_ !=
+                    images[0]->depth_.bytes_per_channel_) {
+            utility::LogError(
+                    "[UniformTSDFVolume::IntegrateBatch] Unsupported image "
+                    "format.");
+        }
+        frames.push_back(image.get());
+    }
+    ResizeMeshBlocks();
+    if (use_compact_voxels_) {
+        IntegrateImpl(ctx, *this, frames, intrinsic, extrinsics, nullptr,
+                      compact_voxels_, dirty_blocks_, observed_blocks_,
+                      esdf_dirty_blocks_);
+    } else {
+        IntegrateImpl(ctx, *this, frames, intrinsic, extrinsics, nullptr,
+                      voxels_, dirty_blocks_, observed_blocks_,
+                      esdf_dirty_blocks_);
+    }
 }
 
 std::shared_ptr<geometry::PointCloud> UniformTSDFVolume::ExtractPointCloud() {
     auto pointcloud = std::make_shared<geometry::PointCloud>();
-    size_t n_valid_voxels = thrust::count_if(voxels_.begin(), voxels_.end(),
-                                             [] __device__ (const geometry::TSDFVoxel& v) {
-                                                 return (v.weight_ != 0.0f && v.tsdf_ < 0.98f && v.tsdf_ >= -0.98f);
-                                             });
-    extract_pointcloud_functor func(thrust::raw_pointer_cast(voxels_.data()),
-                                    resolution_, voxel_length_, origin_,
-                                    color_type_);
-    pointcloud->points_.resize(n_valid_voxels);
-    pointcloud->normals_.resize(n_valid_voxels);
-    pointcloud->colors_.resize(n_valid_voxels);
-    size_t n_total = (resolution_ - 2) * (resolution_ - 2) * (resolution_ - 2) * 3;
-    auto begin = make_tuple_begin(pointcloud->points_, pointcloud->normals_,
-                                  pointcloud->colors_);
-    auto end_p = thrust::copy_if(thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func),
-                                 thrust::make_transform_iterator(thrust::make_counting_iterator(n_total), func),
-                                 begin,
-                                 [] __device__ (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector3f>& x) {
-                                     const Eigen::Vector3f& pt = thrust::get<0>(x);
-                                     return !(isnan(pt(0)) || isnan(pt(1)) || isnan(pt(2)));
-                                 });
-    resize_all(thrust::distance(begin, end_p), pointcloud->points_, pointcloud->normals_, pointcloud->colors_);
+    if (use_compact_voxels_) {
+    CUPOCH_PROFILE("UniformTSDFVolume::ExtractPointCloud");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+        ExtractPointCloudImpl(*this, compact_voxels_, *pointcloud);
+    } else {
+        ExtractPointCloudImpl(*this, voxels_, *pointcloud);
+    }
     if (color_type_ == TSDFVolumeColorType::NoColor) pointcloud->colors_.clear();
     return pointcloud;
 }
@@ -586,110 +1892,171 @@ UniformTSDFVolume::ExtractTriangleMesh() {
     // implementation of marching cubes, based on
     // http://paulbourke.net/geometry/polygonise/
     auto mesh = std::make_shared<geometry::TriangleMesh>();
-    size_t n_valid_voxels = thrust::count_if(voxels_.begin(), voxels_.end(),
-            count_valid_voxels_functor(thrust::raw_pointer_cast(voxels_.data()),
-                                                                resolution_));
-    size_t res3 = (resolution_ - 1) * (resolution_ - 1) * (resolution_ - 1);
+    utility::device_vector<Eigen::Vector3i> keys;
+    utility::device_vector<int> cube_indices;
+    utility::device_vector<float> fs;
+    utility::device_vector<Eigen::Vector3f> cs;
+    if (use_compact_voxels_) {
+    CUPOCH_PROFILE("UniformTSDFVolume::ExtractTriangleMesh");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::TSDF);
+        size_t n_cubes = ExtractAllSurfaceCubes(
+                *this, compact_voxels_, keys, cube_indices, fs, cs, false);
+        BuildIndexedMesh(*this, compact_voxels_, keys, cube_indices, n_cubes,
+                         *mesh);
+    } else {
+        size_t n_cubes = ExtractAllSurfaceCubes(*this, voxels_, keys,
+                                                cube_indices, fs, cs, false);
+        BuildIndexedMesh(*this, voxels_, keys, cube_indices, n_cubes, *mesh);
+    }
+    return mesh;
+}
 
-    // compute cube indices for each voxels
-    utility::device_vector<Eigen::Vector3i> keys(n_valid_voxels);
-    utility::device_vector<int> cube_indices(n_valid_voxels);
-    extract_mesh_phase0_functor func0(thrust::raw_pointer_cast(voxels_.data()),
-                                      resolution_);
-    thrust::copy_if(
-            thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func0),
-            thrust::make_transform_iterator(thrust::make_counting_iterator(res3), func0),
-            make_tuple_begin(keys, cube_indices),
-            [] __device__ (const thrust::tuple<Eigen::Vector3i, int>& x) {
-                return thrust::get<1>(x) >= 0;
-            });
-    auto check_fn = [] __device__(const thrust::tuple<Eigen::Vector3i, int> &x) -> bool {
-        int cidx = thrust::get<1>(x);
-        return (cidx <= 0 || cidx >= 255);
-    };
-    size_t n_result1 = remove_if_vectors(check_fn, keys, cube_indices);
-
-    utility::device_vector<float> fs(n_result1 * 8);
-    utility::device_vector<Eigen::Vector3f> cs(n_result1 * 8);
-    extract_mesh_phase1_functor func1(thrust::raw_pointer_cast(voxels_.data()),
-                                      thrust::raw_pointer_cast(keys.data()),
-                                      resolution_, color_type_);
+std::shared_ptr<geometry::TriangleMesh>
+UniformTSDFVolume::ExtractTriangleMeshIncremental() {
+    ResizeMeshBlocks();
+    const size_t n_voxels = use_compact_voxels_ ? compact_voxels_.size()
+                                                : voxels_.size();
+    if (n_voxels != (size_t)voxel_num_) return incremental_mesh_;
+    const int block_resolution = GetMeshBlockResolution(resolution_);
+    const size_t n_blocks = dirty_blocks_.size();
+    utility::device_vector<uint8_t> remesh(n_blocks);
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_result1 * 8),
-                      make_tuple_begin(fs, cs), func1);
+                      thrust::make_counting_iterator(n_blocks), remesh.begin(),
+                      dilate_dirty_blocks_functor(
+                              thrust::raw_pointer_cast(dirty_blocks_.data()),
+                              block_resolution));
+    utility::device_vector<int> blocks(n_blocks);
+    auto end_b = thrust::copy_if(thrust::make_counting_iterator(0),
+                                 thrust::make_counting_iterator((int)n_blocks),
+                                 remesh.begin(), blocks.begin(),
+                                 thrust::identity<uint8_t>());
+    blocks.resize(thrust::distance(blocks.begin(), end_b));
+    if (blocks.empty()) return incremental_mesh_;
 
-    // compute vertices and vertex_colors
-    int* ci_p = thrust::raw_pointer_cast(cube_indices.data());
-    size_t n_valid_cubes = thrust::count_if(thrust::make_counting_iterator<size_t>(0),
-                                            thrust::make_counting_iterator(n_result1 * 12),
-                                            [ci_p] __device__ (size_t idx) {
-                                                int i = idx / 12;
-                                                int j = idx % 12;
-                                                return (edge_table[ci_p[i]] & (1 << j)) > 0;
-                                            });
-    resize_all(n_valid_cubes, mesh->vertices_, mesh->vertex_colors_);
-    utility::device_vector<Eigen::Vector3i> repeat_keys(n_valid_cubes);
-    utility::device_vector<int> repeat_cube_indices(n_valid_cubes);
-    utility::device_vector<int> vert_no(n_valid_cubes);
-    extract_mesh_phase2_functor func2(thrust::raw_pointer_cast(keys.data()),
-                                      thrust::raw_pointer_cast(cube_indices.data()),
-                                      origin_, voxel_length_, resolution_,
-                                      thrust::raw_pointer_cast(fs.data()),
-                                      thrust::raw_pointer_cast(cs.data()),
-                                      color_type_);
-    thrust::copy_if(
-            thrust::make_transform_iterator(thrust::make_counting_iterator<size_t>(0), func2),
-            thrust::make_transform_iterator(thrust::make_counting_iterator(n_result1 * 12), func2),
-            make_tuple_begin(repeat_keys, repeat_cube_indices, vert_no,
-                             mesh->vertices_, mesh->vertex_colors_),
-            [] __device__ (const thrust::tuple<Eigen::Vector3i, int, int, Eigen::Vector3f, Eigen::Vector3f>& x) {
-                return thrust::get<0>(x)[0] >= 0;
-            });
+    // Drop the vertices and the triangles of the remeshed blocks. The
+    // triangles only refer to the vertices of their own block.
+    geometry::TriangleMesh &mesh = *incremental_mesh_;
+    is_remeshed_functor is_remeshed(thrust::raw_pointer_cast(remesh.data()));
+    const size_t n_old_vertices = mesh.vertices_.size();
+    utility::device_vector<int> new_index(n_old_vertices);
+    thrust::transform(mesh_vertex_blocks_.begin(), mesh_vertex_blocks_.end(),
+                      new_index.begin(),
+                      [is_remeshed] __device__(int b) {
+                          return is_remeshed(b) ? 0 : 1;
+                      });
+    thrust::exclusive_scan(new_index.begin(), new_index.end(),
+                           new_index.begin());
+    remove_if_vectors(is_remeshed, mesh_triangle_blocks_, mesh.triangles_);
+    thrust::transform(mesh.triangles_.begin(), mesh.triangles_.end(),
+                      mesh.triangles_.begin(),
+                      remap_triangle_functor(
+                              thrust::raw_pointer_cast(new_index.data())));
+    if (mesh.HasVertexColors()) {
+        remove_if_vectors(is_remeshed, mesh_vertex_blocks_, mesh.vertices_,
+                          mesh.vertex_colors_);
+    } else {
+        remove_if_vectors(is_remeshed, mesh_vertex_blocks_, mesh.vertices_);
+    }
 
+    // Mesh the cubes of the remeshed blocks and append them.
+    utility::device_vector<Eigen::Vector3i> keys;
+    utility::device_vector<int> cube_indices;
+    utility::device_vector<float> fs;
+    utility::device_vector<Eigen::Vector3f> cs;
+    size_t n_cubes =
+            use_compact_voxels_
+                    ? ExtractBlockSurfaceCubes(*this, compact_voxels_, blocks,
+                                               keys, cube_indices, fs, cs)
+                    : ExtractBlockSurfaceCubes(*this, voxels_, blocks, keys,
+                                               cube_indices, fs, cs);
+    geometry::TriangleMesh patch;
+    utility::device_vector<Eigen::Vector3i> vertex_keys, triangle_keys;
+    BuildMeshFromCubes(*this, keys, cube_indices, fs, cs, n_cubes, patch,
+                       &vertex_keys, &triangle_keys);
+    const size_t n_vertices = mesh.vertices_.size();
+    const size_t n_triangles = mesh.triangles_.size();
+    mesh.vertices_.insert(mesh.vertices_.end(), patch.vertices_.begin(),
+                          patch.vertices_.end());
+    if (color_type_ != TSDFVolumeColorType::NoColor) {
+        mesh.vertex_colors_.insert(mesh.vertex_colors_.end(),
+                                   patch.vertex_colors_.begin(),
+                                   patch.vertex_colors_.end());
+    }
+    mesh.triangles_.resize(n_triangles + patch.triangles_.size());
+    thrust::transform(patch.triangles_.begin(), patch.triangles_.end(),
+                      mesh.triangles_.begin() + n_triangles,
+                      offset_triangle_functor(n_vertices));
+    key_to_block_functor to_block(block_resolution);
+    mesh_vertex_blocks_.resize(mesh.vertices_.size());
+    thrust::transform(vertex_keys.begin(), vertex_keys.end(),
+                      mesh_vertex_blocks_.begin() + n_vertices, to_block);
+    mesh_triangle_blocks_.resize(mesh.triangles_.size());
+    thrust::transform(triangle_keys.begin(), triangle_keys.end(),
+                      mesh_triangle_blocks_.begin() + n_triangles, to_block);
+    thrust::fill(dirty_blocks_.begin(), dirty_blocks_.end(), 0);
+    return incremental_mesh_;
+}
 
-    // compute triangles
-    utility::device_vector<int> vt_offsets(n_valid_cubes + 1, 0);
-    auto end2 = thrust::reduce_by_key(repeat_keys.begin(), repeat_keys.end(),
-                                      thrust::make_constant_iterator<int>(1),
-                                      thrust::make_discard_iterator(), vt_offsets.begin());
-    size_t n_result2 = thrust::distance(vt_offsets.begin(), end2.second);
-    vt_offsets.resize(n_result2 + 1);
-    thrust::exclusive_scan(vt_offsets.begin(), vt_offsets.end(), vt_offsets.begin());
-    mesh->triangles_.resize(n_result2 * 4, Eigen::Vector3i(-1, -1, -1));
-    extract_mesh_phase3_functor func3(
-            thrust::raw_pointer_cast(repeat_cube_indices.data()),
-            thrust::raw_pointer_cast(vert_no.data()),
-            thrust::raw_pointer_cast(vt_offsets.data()),
-            thrust::raw_pointer_cast(mesh->triangles_.data()));
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator(n_result2), func3);
-    auto end3 = thrust::remove_if(
-            mesh->triangles_.begin(), mesh->triangles_.end(),
-            [] __device__(const Eigen::Vector3i &idxs) { return idxs[0] < 0; });
-    mesh->triangles_.resize(thrust::distance(mesh->triangles_.begin(), end3));
-    return mesh;
+std::shared_ptr<geometry::DistanceTransform>
+UniformTSDFVolume::ExtractESDFIncremental(float max_distance) {
+    ResizeMeshBlocks();
+    if (!esdf_ || esdf_max_distance_ != max_distance) {
+        // The voxel centers of the transform are those of the volume.
+        esdf_ = std::make_shared<geometry::DistanceTransform>(
+                voxel_length_, resolution_,
+                origin_ + Eigen::Vector3f::Constant((resolution_ / 2) *
+                                                    voxel_length_));
+        esdf_->ClearEDT(max_distance);
+        esdf_max_distance_ = max_distance;
+        esdf_dirty_blocks_.resize(dirty_blocks_.size());
+        thrust::fill(esdf_dirty_blocks_.begin(), esdf_dirty_blocks_.end(), 1);
+    }
+    const size_t n_voxels = use_compact_voxels_ ? compact_voxels_.size()
+                                                : voxels_.size();
+    if (n_voxels != (size_t)voxel_num_) return esdf_;
+    const size_t n_blocks = esdf_dirty_blocks_.size();
+    utility::device_vector<int> blocks(n_blocks);
+    auto end_b = thrust::copy_if(thrust::make_counting_iterator(0),
+                                 thrust::make_counting_iterator((int)n_blocks),
+                                 esdf_dirty_blocks_.begin(), blocks.begin(),
+                                 thrust::identity<uint8_t>());
+    blocks.resize(thrust::distance(blocks.begin(), end_b));
+    if (blocks.empty()) return esdf_;
+    if (use_compact_voxels_) {
+        UpdateESDFSites(*this, compact_voxels_, blocks, *esdf_, max_distance);
+    } else {
+        UpdateESDFSites(*this, voxels_, blocks, *esdf_, max_distance);
+    }
+    thrust::fill(esdf_dirty_blocks_.begin(), esdf_dirty_blocks_.end(), 0);
+    return esdf_;
+}
+
+void UniformTSDFVolume::ResizeMeshBlocks() {
+    const int block_resolution = GetMeshBlockResolution(resolution_);
+    const size_t n_blocks =
+            block_resolution * block_resolution * block_resolution;
+    if (dirty_blocks_.size() == n_blocks && incremental_mesh_) return;
+    // A new block grid invalidates the cached mesh.
+    dirty_blocks_.resize(n_blocks);
+    thrust::fill(dirty_blocks_.begin(), dirty_blocks_.end(), 1);
+    // Recomputed from the voxels by the next raycast.
+    observed_blocks_.clear();
+    esdf_.reset();
+    esdf_dirty_blocks_.clear();
+    incremental_mesh_ = std::make_shared<geometry::TriangleMesh>();
+    mesh_vertex_blocks_.clear();
+    mesh_triangle_blocks_.clear();
 }
 
 std::shared_ptr<geometry::PointCloud>
 UniformTSDFVolume::ExtractVoxelPointCloud() const {
     auto voxel = std::make_shared<geometry::PointCloud>();
-    // const float *p_tsdf = (const float *)tsdf_.data();
-    // const float *p_weight = (const float *)weight_.data();
-    // const float *p_color = (const float *)color_.data();
-    size_t n_valid_voxels = thrust::count_if(voxels_.begin(), voxels_.end(),
-                                             [] __device__ (const geometry::TSDFVoxel& v) {
-                                                 return (v.weight_ != 0.0f && v.tsdf_ < 0.98f && v.tsdf_ >= -0.98f);
-                                             });
-    extract_voxel_pointcloud_functor func(origin_, resolution_, voxel_length_);
-    resize_all(n_valid_voxels, voxel->points_, voxel->colors_);
-    thrust::copy_if(
-            thrust::make_transform_iterator(voxels_.begin(), func),
-            thrust::make_transform_iterator(voxels_.end(), func),
-            make_tuple_begin(voxel->points_, voxel->colors_),
-            [] __device__ (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f>& x) {
-                const Eigen::Vector3f& pt = thrust::get<0>(x);
-                return !(isnan(pt(0)) || isnan(pt(1)) || isnan(pt(2)));
-            });
+    if (use_compact_voxels_) {
+        ExtractVoxelPointCloudImpl(*this, compact_voxels_, *voxel);
+    } else {
+        ExtractVoxelPointCloudImpl(*this, voxels_, *voxel);
+    }
     voxel->RemoveNoneFinitePoints(true, false);
     return voxel;
 }
@@ -699,19 +2066,11 @@ std::shared_ptr<geometry::VoxelGrid> UniformTSDFVolume::ExtractVoxelGrid()
     auto voxel_grid = std::make_shared<geometry::VoxelGrid>();
     voxel_grid->voxel_size_ = voxel_length_;
     voxel_grid->origin_ = origin_;
-    size_t n_valid_voxels = thrust::count_if(voxels_.begin(), voxels_.end(),
-                                             [] __device__ (const geometry::TSDFVoxel& v) {
-                                                 return (v.weight_ != 0.0f && v.tsdf_ < 0.98f && v.tsdf_ >= -0.98f);
-                                             });
-    resize_all(n_valid_voxels, voxel_grid->voxels_keys_, voxel_grid->voxels_values_);
-    extract_voxel_grid_functor func(resolution_);
-    thrust::copy_if(thrust::make_transform_iterator(voxels_.begin(), func),
-                    thrust::make_transform_iterator(voxels_.end(), func),
-                    make_tuple_begin(voxel_grid->voxels_keys_, voxel_grid->voxels_values_),
-                    [] __device__ (const thrust::tuple<Eigen::Vector3i, geometry::Voxel>& x) {
-                        return thrust::get<0>(x) != Eigen::Vector3i(geometry::INVALID_VOXEL_INDEX,
-                            geometry::INVALID_VOXEL_INDEX, geometry::INVALID_VOXEL_INDEX);
-                    });
+    if (use_compact_voxels_) {
+        ExtractVoxelGridImpl(*this, compact_voxels_, *voxel_grid);
+    } else {
+        ExtractVoxelGridImpl(*this, voxels_, *voxel_grid);
+    }
     return voxel_grid;
 }
 
@@ -720,24 +2079,152 @@ void UniformTSDFVolume::IntegrateWithDepthToCameraDistanceMultiplier(
         const camera::PinholeCameraIntrinsic &intrinsic,
         const Eigen::Matrix4f &extrinsic,
         const geometry::Image &depth_to_camera_distance_multiplier) {
-    const float fx = intrinsic.GetFocalLength().first;
-    const float fy = intrinsic.GetFocalLength().second;
-    const float cx = intrinsic.GetPrincipalPoint().first;
-    const float cy = intrinsic.GetPrincipalPoint().second;
-    const float safe_width = intrinsic.width_ - 0.0001f;
-    const float safe_height = intrinsic.height_ - 0.0001f;
-    voxels_.resize(voxel_num_);
-    integrate_functor func(
-            origin_, fx, fy, cx, cy, extrinsic, voxel_length_, sdf_trunc_,
-            safe_width, safe_height, resolution_,
-            thrust::raw_pointer_cast(image.color_.data_.data()),
-            thrust::raw_pointer_cast(image.depth_.data_.data()),
-            thrust::raw_pointer_cast(
-                    depth_to_camera_distance_multiplier.data_.data()),
-            image.depth_.width_, image.color_.num_of_channels_, color_type_,
-            thrust::raw_pointer_cast(voxels_.data()));
-    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
-                     thrust::make_counting_iterator<size_t>(
-                             resolution_ * resolution_ * resolution_),
-                     func);
-}
\ No newline at end of file
+    IntegrateWithDepthToCameraDistanceMultiplier(
+            utility::ExecutionContext::Default(), image, intrinsic, extrinsic,
+            depth_to_camera_distance_multiplier);
+}
+
+void UniformTSDFVolume::IntegrateWithDepthToCameraDistanceMultiplier(
+        utility::ExecutionContext &ctx,
+        const geometry::RGBDImage &image,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        const geometry::Image &depth_to_camera_distance_multiplier) {
+    ResizeMeshBlocks();
+    PrefetchFrustum(ctx, intrinsic, extrinsic);
+    const std::vector<const geometry::RGBDImage *> frames(1, &image);
+    const std::vector<Eigen::Matrix4f_u> extrinsics(1, extrinsic);
+    if (use_compact_voxels_) {
+        IntegrateImpl(ctx, *this, frames, intrinsic, extrinsics,
+                      &depth_to_camera_distance_multiplier, compact_voxels_,
+                      dirty_blocks_, observed_blocks_, esdf_dirty_blocks_);
+    } else {
+        IntegrateImpl(ctx, *this, frames, intrinsic, extrinsics,
+                      &depth_to_camera_distance_multiplier, voxels_,
+                      dirty_blocks_, observed_blocks_, esdf_dirty_blocks_);
+    }
+}
+
+std::tuple<std::shared_ptr<geometry::Image>,
+           std::shared_ptr<geometry::Image>,
+           std::shared_ptr<geometry::Image>>
+UniformTSDFVolume::Raycast(const camera::PinholeCameraIntrinsic &intrinsic,
+                           const Eigen::Matrix4f &extrinsic,
+                           float max_depth) const {
+    return Raycast(utility::ExecutionContext::Default(), intrinsic, extrinsic,
+                   max_depth);
+}
+
+std::tuple<std::shared_ptr<geometry::Image>,
+           std::shared_ptr<geometry::Image>,
+           std::shared_ptr<geometry::Image>>
+UniformTSDFVolume::Raycast(utility::ExecutionContext &ctx,
+                           const camera::PinholeCameraIntrinsic &intrinsic,
+                           const Eigen::Matrix4f &extrinsic,
+                           float max_depth) const {
+    auto vertex_map = std::make_shared<geometry::Image>();
+    auto normal_map = std::make_shared<geometry::Image>();
+    auto color_map = std::make_shared<geometry::Image>();
+    if (!CheckRaycast(intrinsic, "Raycast")) {
+        return std::make_tuple(vertex_map, normal_map, color_map);
+    }
+    const int width = intrinsic.width_;
+    const int height = intrinsic.height_;
+    vertex_map->Prepare(width, height, 3, 4);
+    normal_map->Prepare(width, height, 3, 4);
+    const bool has_color = color_type_ != TSDFVolumeColorType::NoColor;
+    if (has_color) color_map->Prepare(width, height, 3, 4);
+    RaycastMaps(ctx, intrinsic, extrinsic, max_depth, vertex_map.get(),
+                normal_map.get(), has_color ? color_map.get() : nullptr,
+                nullptr, nullptr);
+    return std::make_tuple(vertex_map, normal_map, color_map);
+}
+
+std::shared_ptr<geometry::Image> UniformTSDFVolume::RaycastDepth(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    return RaycastDepth(utility::ExecutionContext::Default(), intrinsic,
+                        extrinsic, max_depth);
+}
+
+std::shared_ptr<geometry::Image> UniformTSDFVolume::RaycastDepth(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    auto depth = std::make_shared<geometry::Image>();
+    if (!CheckRaycast(intrinsic, "RaycastDepth")) return depth;
+    depth->Prepare(intrinsic.width_, intrinsic.height_, 1, 4);
+    RaycastMaps(ctx, intrinsic, extrinsic, max_depth, nullptr, nullptr,
+                nullptr, depth.get(), nullptr);
+    return depth;
+}
+
+std::shared_ptr<geometry::Image> UniformTSDFVolume::RaycastColor(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    return RaycastColor(utility::ExecutionContext::Default(), intrinsic,
+                        extrinsic, max_depth);
+}
+
+std::shared_ptr<geometry::Image> UniformTSDFVolume::RaycastColor(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth) const {
+    auto color = std::make_shared<geometry::Image>();
+    if (!CheckRaycast(intrinsic, "RaycastColor")) return color;
+    if (color_type_ == TSDFVolumeColorType::NoColor) {
+        utility::LogWarning(
+                "[UniformTSDFVolume::RaycastColor] The volume has no color.");
+        return color;
+    }
+    color->Prepare(intrinsic.width_, intrinsic.height_, 3, 1);
+    RaycastMaps(ctx, intrinsic, extrinsic, max_depth, nullptr, nullptr,
+                nullptr, nullptr, color.get());
+    return color;
+}
+
+bool UniformTSDFVolume::CheckRaycast(
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const char *name) const {
+    const size_t n_voxels = use_compact_voxels_ ? compact_voxels_.size()
+                                                : voxels_.size();
+    if (n_voxels != (size_t)voxel_num_ || intrinsic.width_ <= 0 ||
+        intrinsic.height_ <= 0) {
+        utility::LogWarning("[UniformTSDFVolume::{}] Empty volume or camera.",
+                            name);
+        return false;
+    }
+    return true;
+}
+
+void UniformTSDFVolume::RaycastMaps(
+        utility::ExecutionContext &ctx,
+        const camera::PinholeCameraIntrinsic &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        float max_depth,
+        geometry::Image *vertex_map,
+        geometry::Image *normal_map,
+        geometry::Image *color_map,
+        geometry::Image *depth_map,
+        geometry::Image *rgb_map) const {
+    PrefetchFrustum(ctx, intrinsic, extrinsic, max_depth);
+    if (use_compact_voxels_) {
+        if (observed_blocks_.empty()) {
+            ComputeObservedBlocks(*this, compact_voxels_, observed_blocks_);
+        }
+        RaycastImpl(ctx, *this, compact_voxels_, observed_blocks_, intrinsic,
+                    extrinsic, max_depth, vertex_map, normal_map, color_map,
+                    depth_map, rgb_map);
+    } else {
+        if (observed_blocks_.empty()) {
+            ComputeObservedBlocks(*this, voxels_, observed_blocks_);
+        }
+        RaycastImpl(ctx, *this, voxels_, observed_blocks_, intrinsic,
+                    extrinsic, max_depth, vertex_map, normal_map, color_map,
+                    depth_map, rgb_map);
+    }
+}
@@ -1,12 +1,20 @@
 #pragma once
 
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
 #include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/integration/tsdfvolume.h"
+#include "cupoch/utility/eigen.h"
+#include "cupoch/utility/execution_context.h"
 
 namespace cupoch {
 
 namespace geometry {
 
+class DistanceTransform;
+
 class TSDFVoxel : public Voxel {
 public:
     __host__ __device__ TSDFVoxel() : Voxel() {}
@@ -22,17 +30,47 @@ public:
     float weight_ = 0;
 };
 
+/// \class CompactTSDFVoxel
+///
+/// \brief 8 byte voxel of UniformTSDFVolume with compact voxels: the TSDF
+/// in [-1, 1] as a 16 bit fixed point number, the weight as a 16 bit
+/// integer saturating at kMaxWeight, and the color as 8 bit RGB (the
+/// intensity times 255 for TSDFVolumeColorType::Gray32). The grid index is
+/// implied by the position in the volume.
+class CompactTSDFVoxel {
+public:
+    static constexpr float kTSDFScale = 32767.0f;
+    static constexpr int kMaxWeight = 65535;
+
+    __host__ __device__ CompactTSDFVoxel() {}
+    __host__ __device__ ~CompactTSDFVoxel() {}
+
+public:
+    int16_t tsdf_ = 0;
+    uint16_t weight_ = 0;
+    uint8_t color_[3] = {0, 0, 0};
+    uint8_t padding_ = 0;
+};
+
 }  // namespace geometry
 
 namespace integration {
 
 class UniformTSDFVolume : public TSDFVolume {
 public:
+    /// Edge length, in voxels, of the blocks whose changes are tracked for
+    /// ExtractTriangleMeshIncremental().
+    static constexpr int kMeshBlockSize = 16;
+    static int GetMeshBlockResolution(int resolution) {
+        return (resolution + kMeshBlockSize - 1) / kMeshBlockSize;
+    }
+
     UniformTSDFVolume(float length,
                       int resolution,
                       float sdf_trunc,
                       TSDFVolumeColorType color_type,
-                      const Eigen::Vector3f &origin = Eigen::Vector3f::Zero());
+                      const Eigen::Vector3f &origin = Eigen::Vector3f::Zero(),
+                      bool use_compact_voxels = false);
     ~UniformTSDFVolume() override;
     UniformTSDFVolume(const UniformTSDFVolume &other);
 
@@ -41,27 +79,183 @@ public:
     void Integrate(const geometry::RGBDImage &image,
                    const camera::PinholeCameraIntrinsic &intrinsic,
                    const Eigen::Matrix4f &extrinsic) override;
+    /// Same as Integrate(), with the voxel update enqueued on the stream of
+    /// \p ctx.
+    void Integrate(utility::ExecutionContext &ctx,
+                   const geometry::RGBDImage &image,
+                   const camera::PinholeCameraIntrinsic &intrinsic,
+                   const Eigen::Matrix4f &extrinsic);
+    /// Integrates \p images seen from \p extrinsics in one sweep over the
+    /// volume: each voxel is loaded once, updated with the frames in order
+    /// and stored once, so the result matches calling Integrate() on each
+    /// frame while the volume is read and written once per batch.
+    void IntegrateBatch(
+            const std::vector<std::shared_ptr<geometry::RGBDImage>> &images,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const std::vector<Eigen::Matrix4f_u> &extrinsics);
+    void IntegrateBatch(
+            utility::ExecutionContext &ctx,
+            const std::vector<std::shared_ptr<geometry::RGBDImage>> &images,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const std::vector<Eigen::Matrix4f_u> &extrinsics);
     std::shared_ptr<geometry::PointCloud> ExtractPointCloud() override;
+    /// Marching cubes with one vertex per crossed edge of the grid, shared
+    /// by the triangles of the cubes around the edge.
     std::shared_ptr<geometry::TriangleMesh> ExtractTriangleMesh() override;
+    /// Same mesh as ExtractTriangleMesh(), kept between calls: Integrate()
+    /// marks the blocks of kMeshBlockSize^3 voxels it changes, and only the
+    /// cubes of these blocks and of their neighbors are meshed again and
+    /// patched into the mesh of the previous call. The returned mesh is
+    /// owned by the volume and updated in place by the next call; copy it
+    /// to keep it. Unlike ExtractTriangleMesh(), the vertices are not shared
+    /// between cubes, so that the triangles of a block only refer to its own
+    /// vertices.
+    std::shared_ptr<geometry::TriangleMesh> ExtractTriangleMeshIncremental();
+    /// ESDF of the volume for planning, as in voxblox, kept between calls
+    /// like ExtractTriangleMeshIncremental(). The sites are the observed
+    /// voxels within one voxel of the surface, and the distances are
+    /// propagated from them by the wavefront of
+    /// DistanceTransform::UpdateEDT() up to \p max_distance, the farther
+    /// voxels taking \p max_distance. Only the voxels of the blocks changed
+    /// by Integrate() since the previous call are compared to the sites, so
+    /// the update work follows the changed surface. The transform has the
+    /// voxels of the volume and is owned by it.
+    std::shared_ptr<geometry::DistanceTransform> ExtractESDFIncremental(
+            float max_distance = 1.0);
+
+    /// Casts one ray per pixel of the camera \p intrinsic at \p extrinsic
+    /// (world to camera, as in Integrate()) and returns the vertex, normal
+    /// and color maps of the first zero crossing of the TSDF, up to
+    /// \p max_depth. The vertex and normal maps are 3 channel float images
+    /// in the camera frame, NaN where the ray misses the surface, and can
+    /// be the target of odometry::ComputeDepthICPOdometry(). The color map
+    /// is a 3 channel float image in [0, 1], empty for
+    /// TSDFVolumeColorType::NoColor. The rays jump over the blocks of
+    /// kMeshBlockSize^3 voxels that were never observed and march in steps
+    /// of the sampled distance elsewhere, so the cost does not depend on the
+    /// resolution of the volume but on the free space in front of the
+    /// surface.
+    std::tuple<std::shared_ptr<geometry::Image>,
+               std::shared_ptr<geometry::Image>,
+               std::shared_ptr<geometry::Image>>
+    Raycast(const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    std::tuple<std::shared_ptr<geometry::Image>,
+               std::shared_ptr<geometry::Image>,
+               std::shared_ptr<geometry::Image>>
+    Raycast(utility::ExecutionContext &ctx,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    /// Same rays as Raycast(), for previews of the volume: returns a 1
+    /// channel float image of the depth of the surface along the camera
+    /// axis, 0 where the ray misses it, like the depth of an RGBDImage.
+    std::shared_ptr<geometry::Image> RaycastDepth(
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    std::shared_ptr<geometry::Image> RaycastDepth(
+            utility::ExecutionContext &ctx,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    /// Same rays as Raycast(), for previews of the volume: returns a 3
+    /// channel 8 bit image of the color of the surface, black where the ray
+    /// misses it. Empty for TSDFVolumeColorType::NoColor.
+    std::shared_ptr<geometry::Image> RaycastColor(
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
+    std::shared_ptr<geometry::Image> RaycastColor(
+            utility::ExecutionContext &ctx,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            float max_depth = 3.0) const;
 
     /// Debug function to extract the voxel data into a VoxelGrid
     std::shared_ptr<geometry::PointCloud> ExtractVoxelPointCloud() const;
     std::shared_ptr<geometry::VoxelGrid> ExtractVoxelGrid() const;
 
     /// Faster Integrate function that uses depth_to_camera_distance_multiplier
-    /// precomputed from camera intrinsic
+    /// precomputed from camera intrinsic. The multipliers are computed in the
+    /// kernel if the image is empty, as Integrate() does.
+    void IntegrateWithDepthToCameraDistanceMultiplier(
+            const geometry::RGBDImage &image,
+            const camera::PinholeCameraIntrinsic &intrinsic,
+            const Eigen::Matrix4f &extrinsic,
+            const geometry::Image &depth_to_camera_distance_multiplier);
     void IntegrateWithDepthToCameraDistanceMultiplier(
+            utility::ExecutionContext &ctx,
             const geometry::RGBDImage &image,
             const camera::PinholeCameraIntrinsic &intrinsic,
             const Eigen::Matrix4f &extrinsic,
             const geometry::Image &depth_to_camera_distance_multiplier);
 
+    /// Device memory of the voxels, in bytes.
+    size_t GetMemorySize() const;
+
+    /// If the voxels are in managed memory, see EnableVolumeOversubscription()
+    /// in utility, enqueues on the stream of \p ctx the migration to the
+    /// device of the slabs of voxels overlapping the frustum of the camera up
+    /// to \p max_depth, the volume behind if it is not positive, and the
+    /// eviction of the others to the host. Integrate() and the raycasts call
+    /// it with their camera, so that a volume larger than the device memory
+    /// only keeps the region in view resident.
+    void PrefetchFrustum(utility::ExecutionContext &ctx,
+                         const camera::PinholeCameraIntrinsic &intrinsic,
+                         const Eigen::Matrix4f &extrinsic,
+                         float max_depth = 0.0) const;
+
 public:
+    /// Voxels of the volume, empty if use_compact_voxels_.
     utility::device_vector<geometry::TSDFVoxel> voxels_;
+    /// Voxels of the volume if use_compact_voxels_, empty otherwise. They
+    /// take 8 bytes instead of 32, which makes Integrate() and the
+    /// extraction about four times lighter on memory traffic, at the cost of
+    /// quantizing the TSDF and the color.
+    utility::device_vector<geometry::CompactTSDFVoxel> compact_voxels_;
+    bool use_compact_voxels_;
+    /// Depth units per meter of the 16 bit depth images, which Integrate()
+    /// reads without converting them to float images first.
+    float depth_scale_ = 1000.0;
     Eigen::Vector3f origin_;
     float length_;
     int resolution_;
     int voxel_num_;
+
+private:
+    /// Sizes the block grid for resolution_, marking every block as changed
+    /// if it was resized.
+    void ResizeMeshBlocks();
+    bool CheckRaycast(const camera::PinholeCameraIntrinsic &intrinsic,
+                      const char *name) const;
+    /// Casts the rays of Raycast() into the maps that are not NULL.
+    void RaycastMaps(utility::ExecutionContext &ctx,
+                     const camera::PinholeCameraIntrinsic &intrinsic,
+                     const Eigen::Matrix4f &extrinsic,
+                     float max_depth,
+                     geometry::Image *vertex_map,
+                     geometry::Image *normal_map,
+                     geometry::Image *color_map,
+                     geometry::Image *depth_map,
+                     geometry::Image *rgb_map) const;
+
+    /// Nonzero for the blocks changed since the last incremental extraction.
+    utility::device_vector<uint8_t> dirty_blocks_;
+    /// Nonzero for the blocks with an observed voxel, for the empty space
+    /// skipping of the raycasts. Integrate() keeps it up to date once a
+    /// raycast has computed it, and it is dropped with the block grid.
+    mutable utility::device_vector<uint8_t> observed_blocks_;
+    std::shared_ptr<geometry::TriangleMesh> incremental_mesh_;
+    /// Block of every vertex and triangle of incremental_mesh_.
+    utility::device_vector<int> mesh_vertex_blocks_;
+    utility::device_vector<int> mesh_triangle_blocks_;
+    std::shared_ptr<geometry::DistanceTransform> esdf_;
+    float esdf_max_distance_ = 0;
+    /// Nonzero for the blocks changed since the last ESDF update, empty
+    /// until the first one.
+    utility::device_vector<uint8_t> esdf_dirty_blocks_;
 };
 
 }  // namespace integration
@@ -0,0 +1,208 @@
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/io/class_io/async_writer.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/filesystem.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::io;
+
+namespace {
+
+std::future<bool> MakeReadyFuture(bool value) {
+    std::promise<bool> promise;
+    promise.set_value(value);
+    return promise.get_future();
+}
+
+}  // namespace
+
+AsyncWriter::AsyncWriter(size_t num_threads) {
+    if (num_threads == 0) {
+        utility::LogError("[AsyncWriter] At least one thread needed.");
+    }
+    cudaSafeCall(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&AsyncWriter::Run, this);
+    }
+}
+
+AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    task_cv_.notify_all();
+    // The workers drain the queue before they exit.
+    for (auto &worker : workers_) worker.join();
+    cudaStreamDestroy(stream_);
+}
+
+std::future<bool> AsyncWriter::WritePointCloud(
+        const std::string &filename,
+        const geometry::PointCloud &pointcloud,
+        bool write_ascii,
+        bool compressed) {
+    const std::string ext =
+            utility::filesystem::GetFileExtensionInLowerCase(filename);
+    if (ext != "ply" && ext != "pcd") {
+        return MakeReadyFuture(io::WritePointCloud(filename, pointcloud,
+                                                   write_ascii, compressed));
+    }
+    if (pointcloud.IsEmpty()) {
+        utility::LogWarning("[AsyncWriter] Point cloud has 0 points.");
+        return MakeReadyFuture(false);
+    }
+    std::unique_ptr<HostPointCloud> host_pc = AcquirePointCloudBuffer();
+    BeginSnapshot();
+    utility::CopyToHostAsync(pointcloud.points_, host_pc->points_, stream_);
+    utility::CopyToHostAsync(pointcloud.normals_, host_pc->normals_, stream_);
+    utility::CopyToHostAsync(pointcloud.colors_, host_pc->colors_, stream_);
+    cudaEvent_t copied = RecordSnapshot();
+    auto task = std::make_shared<std::packaged_task<bool()>>(
+            [this, filename, ext, write_ascii, compressed, copied,
+             host_pc = std::move(host_pc)]() mutable {
+                cudaSafeCall(cudaEventSynchronize(copied));
+                cudaEventDestroy(copied);
+                const bool success =
+                        (ext == "ply") ? WriteHostPointCloudToPLY(
+                                                 filename, *host_pc,
+                                                 write_ascii, compressed)
+                                       : WriteHostPointCloudToPCD(
+                                                 filename, *host_pc,
+                                                 write_ascii, compressed);
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_pointclouds_.push_back(std::move(host_pc));
+                return success;
+            });
+    std::future<bool> result = task->get_future();
+    Enqueue([task]() { (*task)(); });
+    return result;
+}
+
+std::future<bool> AsyncWriter::WriteTriangleMesh(
+        const std::string &filename,
+        const geometry::TriangleMesh &mesh,
+        bool write_ascii,
+        bool compressed,
+        bool write_vertex_normals,
+        bool write_vertex_colors) {
+    const std::string ext =
+            utility::filesystem::GetFileExtensionInLowerCase(filename);
+    if (ext != "ply") {
+        return MakeReadyFuture(io::WriteTriangleMesh(
+                filename, mesh, write_ascii, compressed, write_vertex_normals,
+                write_vertex_colors));
+    }
+    if (mesh.IsEmpty()) {
+        utility::LogWarning("[AsyncWriter] Mesh has 0 vertices.");
+        return MakeReadyFuture(false);
+    }
+    // Only the buffers written to PLY are copied.
+    std::unique_ptr<HostTriangleMesh> host_mesh = AcquireTriangleMeshBuffer();
+    BeginSnapshot();
+    utility::CopyToHostAsync(mesh.vertices_, host_mesh->vertices_, stream_);
+    utility::CopyToHostAsync(mesh.triangles_, host_mesh->triangles_, stream_);
+    if (write_vertex_normals) {
+        utility::CopyToHostAsync(mesh.vertex_normals_,
+                                 host_mesh->vertex_normals_, stream_);
+    } else {
+        host_mesh->vertex_normals_.clear();
+    }
+    if (write_vertex_colors) {
+        utility::CopyToHostAsync(mesh.vertex_colors_,
+                                 host_mesh->vertex_colors_, stream_);
+    } else {
+        host_mesh->vertex_colors_.clear();
+    }
+    cudaEvent_t copied = RecordSnapshot();
+    auto task = std::make_shared<std::packaged_task<bool()>>(
+            [this, filename, write_ascii, compressed, write_vertex_normals,
+             write_vertex_colors, copied,
+             host_mesh = std::move(host_mesh)]() mutable {
+                cudaSafeCall(cudaEventSynchronize(copied));
+                cudaEventDestroy(copied);
+                const bool success = WriteHostTriangleMeshToPLY(
+                        filename, *host_mesh, write_ascii, compressed,
+                        write_vertex_normals, write_vertex_colors, false);
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_meshes_.push_back(std::move(host_mesh));
+                return success;
+            });
+    std::future<bool> result = task->get_future();
+    Enqueue([task]() { (*task)(); });
+    return result;
+}
+
+void AsyncWriter::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return num_pending_ == 0; });
+}
+
+size_t AsyncWriter::GetNumPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_pending_;
+}
+
+void AsyncWriter::Enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        ++num_pending_;
+    }
+    task_cv_.notify_one();
+}
+
+void AsyncWriter::Run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --num_pending_;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+std::unique_ptr<HostPointCloud> AsyncWriter::AcquirePointCloudBuffer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_pointclouds_.empty()) return std::make_unique<HostPointCloud>();
+    std::unique_ptr<HostPointCloud> buffer =
+            std::move(free_pointclouds_.back());
+    free_pointclouds_.pop_back();
+    return buffer;
+}
+
+std::unique_ptr<HostTriangleMesh> AsyncWriter::AcquireTriangleMeshBuffer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_meshes_.empty()) return std::make_unique<HostTriangleMesh>();
+    std::unique_ptr<HostTriangleMesh> buffer = std::move(free_meshes_.back());
+    free_meshes_.pop_back();
+    return buffer;
+}
+
+void AsyncWriter::BeginSnapshot() {
+    cudaEvent_t ready;
+    cudaSafeCall(cudaEventCreateWithFlags(&ready, cudaEventDisableTiming));
+    cudaSafeCall(cudaEventRecord(ready, 0));
+    cudaSafeCall(cudaStreamWaitEvent(stream_, ready, 0));
+    cudaSafeCall(cudaEventDestroy(ready));
+}
+
+cudaEvent_t AsyncWriter::RecordSnapshot() {
+    cudaEvent_t copied;
+    cudaSafeCall(cudaEventCreateWithFlags(&copied, cudaEventDisableTiming));
+    cudaSafeCall(cudaEventRecord(copied, stream_));
+    // The kernels launched afterwards may modify the geometry.
+    cudaSafeCall(cudaStreamWaitEvent(0, copied, 0));
+    return copied;
+}
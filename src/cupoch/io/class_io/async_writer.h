@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/class_io/trianglemesh_io.h"
+
+namespace cupoch {
+
+namespace io {
+
+/// \class AsyncWriter
+///
+/// \brief Writes point clouds and meshes to files on background threads, so
+/// that a capture or reconstruction loop does not stall on the disk.
+///
+/// A write call enqueues the copy of the geometry into pinned host buffers
+/// on a stream of the writer, after the work already queued on the default
+/// stream, and makes the default stream wait for that copy, so the geometry
+/// can be modified by the kernels launched afterwards. The call returns at
+/// once; a worker thread waits for the copy, then encodes and compresses
+/// the file. The returned future holds the result of the write. The pinned
+/// buffers are recycled from one write to the next.
+///
+/// Point clouds are written asynchronously to .ply and .pcd files and
+/// meshes to .ply files; the other formats are written synchronously by
+/// the calling thread.
+class AsyncWriter {
+public:
+    explicit AsyncWriter(size_t num_threads = 2);
+    /// Waits for the pending writes.
+    ~AsyncWriter();
+    AsyncWriter(const AsyncWriter &) = delete;
+    AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+public:
+    std::future<bool> WritePointCloud(const std::string &filename,
+                                      const geometry::PointCloud &pointcloud,
+                                      bool write_ascii = false,
+                                      bool compressed = false);
+    std::future<bool> WriteTriangleMesh(const std::string &filename,
+                                        const geometry::TriangleMesh &mesh,
+                                        bool write_ascii = false,
+                                        bool compressed = false,
+                                        bool write_vertex_normals = true,
+                                        bool write_vertex_colors = true);
+
+    /// Blocks until every write enqueued so far is done.
+    void Wait();
+    /// Number of writes enqueued and not yet done.
+    size_t GetNumPending() const;
+    size_t GetNumThreads() const { return workers_.size(); }
+
+private:
+    void Enqueue(std::function<void()> task);
+    void Run();
+    std::unique_ptr<HostPointCloud> AcquirePointCloudBuffer();
+    std::unique_ptr<HostTriangleMesh> AcquireTriangleMeshBuffer();
+    /// Orders stream_ after the work queued on the default stream.
+    void BeginSnapshot();
+    /// Records the end of the copies enqueued on stream_ and orders the
+    /// default stream after them.
+    cudaEvent_t RecordSnapshot();
+
+    cudaStream_t stream_;
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    size_t num_pending_ = 0;
+    bool stop_ = false;
+    mutable std::mutex mutex_;
+    std::condition_variable task_cv_;
+    std::condition_variable done_cv_;
+    std::vector<std::unique_ptr<HostPointCloud>> free_pointclouds_;
+    std::vector<std::unique_ptr<HostTriangleMesh>> free_meshes_;
+};
+
+}  // namespace io
+}  // namespace cupoch
@@ -5,6 +5,7 @@
 
 #include "cupoch/utility/console.h"
 #include "cupoch/utility/filesystem.h"
+#include "cupoch/utility/profiler.h"
 
 namespace cupoch {
 
@@ -48,6 +49,7 @@ std::shared_ptr<geometry::Image> CreateImageFromFile(
 }
 
 bool ReadImage(const std::string &filename, geometry::Image &image) {
+    CUPOCH_PROFILE("ReadImage");
     std::string filename_ext =
             utility::filesystem::GetFileExtensionInLowerCase(filename);
     if (filename_ext.empty()) {
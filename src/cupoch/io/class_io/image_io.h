@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 #include <cupoch/utility/device_vector.h>
 
 namespace cupoch {
@@ -63,8 +65,22 @@ bool WriteHostImageToPNG(const std::string &filename,
                          const HostImage &image,
                          int quality);
 
+/// Decodes the JPG file on the GPU with nvJPEG when cupoch is built with
+/// USE_NVJPEG, with libjpeg otherwise or when nvJPEG fails.
 bool ReadImageFromJPG(const std::string &filename, geometry::Image &image);
 
+/// Decodes a JPG file with nvJPEG straight into the device memory of
+/// \p image. Returns false without a warning when cupoch is built without
+/// nvJPEG or when the file is not decoded, e.g. for CMYK images.
+bool ReadImageFromJPGWithNvJPEG(const std::string &filename,
+                                geometry::Image &image);
+
+/// Reads JPG files, the color ones in a single batched nvJPEG decoding
+/// when available and the others with ReadImageFromJPG. Returns whether all
+/// the files were read; the images of the others are empty.
+bool ReadImagesFromJPG(const std::vector<std::string> &filenames,
+                       std::vector<std::shared_ptr<geometry::Image>> &images);
+
 bool WriteImageToJPG(const std::string &filename,
                      const geometry::Image &image,
                      int quality = 90);
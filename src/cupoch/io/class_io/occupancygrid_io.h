@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+#include "cupoch/geometry/occupancygrid.h"
+
+namespace cupoch {
+namespace io {
+
+/// Reads an OccupancyGrid saved with WriteOccupancyGridToCBF, the parameters
+/// of the grid are overwritten by the ones of the file.
+bool ReadOccupancyGridFromCBF(const std::string &filename,
+                              geometry::OccupancyGrid &occupancygrid);
+
+bool WriteOccupancyGridToCBF(const std::string &filename,
+                             const geometry::OccupancyGrid &occupancygrid,
+                             bool compressed = false);
+
+}  // namespace io
+}  // namespace cupoch
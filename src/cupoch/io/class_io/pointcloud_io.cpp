@@ -6,6 +6,8 @@
 #include "cupoch/utility/platform.h"
 #include "cupoch/utility/console.h"
 #include "cupoch/utility/filesystem.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/profiler.h"
 
 namespace cupoch {
 
@@ -18,6 +20,13 @@ static const std::unordered_map<
         file_extension_to_pointcloud_read_function{
                 {"ply", ReadPointCloudFromPLY},
                 {"pcd", ReadPointCloudFromPCD},
+                {"cbf", ReadPointCloudFromCBF},
+                {"xyz", ReadPointCloudFromXYZ},
+                {"xyzn", ReadPointCloudFromXYZN},
+                {"xyzrgb", ReadPointCloudFromXYZRGB},
+                {"pts", ReadPointCloudFromPTS},
+                {"las", ReadPointCloudFromLAS},
+                {"laz", ReadPointCloudFromLAS},
         };
 
 static const std::unordered_map<std::string,
@@ -29,6 +38,11 @@ static const std::unordered_map<std::string,
         file_extension_to_pointcloud_write_function{
                 {"ply", WritePointCloudToPLY},
                 {"pcd", WritePointCloudToPCD},
+                {"cbf", WritePointCloudToCBF},
+                {"xyz", WritePointCloudToXYZ},
+                {"xyzn", WritePointCloudToXYZN},
+                {"xyzrgb", WritePointCloudToXYZRGB},
+                {"pts", WritePointCloudToPTS},
         };
 }  // unnamed namespace
 
@@ -49,6 +63,9 @@ bool ReadPointCloud(const std::string &filename,
                     bool remove_nan_points,
                     bool remove_infinite_points,
                     bool print_progress) {
+    CUPOCH_PROFILE("ReadPointCloud");
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::PointCloud);
     std::string filename_ext;
     if (format == "auto") {
         filename_ext =
@@ -83,6 +100,7 @@ bool WritePointCloud(const std::string &filename,
                      bool write_ascii /* = false*/,
                      bool compressed /* = false*/,
                      bool print_progress) {
+    CUPOCH_PROFILE("WritePointCloud");
     std::string filename_ext =
             utility::filesystem::GetFileExtensionInLowerCase(filename);
     if (filename_ext.empty()) {
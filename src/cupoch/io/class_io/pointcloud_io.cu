@@ -13,6 +13,9 @@ void HostPointCloud::FromDevice(const geometry::PointCloud& pointcloud) {
     thrust::copy(pointcloud.points_.begin(), pointcloud.points_.end(), points_.begin());
     thrust::copy(pointcloud.normals_.begin(), pointcloud.normals_.end(), normals_.begin());
     thrust::copy(pointcloud.colors_.begin(), pointcloud.colors_.end(), colors_.begin());
+    attributes_.resize(pointcloud.attributes_.size());
+    thrust::copy(pointcloud.attributes_.begin(), pointcloud.attributes_.end(), attributes_.begin());
+    attribute_names_ = pointcloud.attribute_names_;
 }
 
 void HostPointCloud::ToDevice(geometry::PointCloud& pointcloud) const {
@@ -22,10 +25,15 @@ void HostPointCloud::ToDevice(geometry::PointCloud& pointcloud) const {
     thrust::copy(points_.begin(), points_.end(), pointcloud.points_.begin());
     thrust::copy(normals_.begin(), normals_.end(), pointcloud.normals_.begin());
     thrust::copy(colors_.begin(), colors_.end(), pointcloud.colors_.begin());
+    pointcloud.attributes_.resize(attributes_.size());
+    thrust::copy(attributes_.begin(), attributes_.end(), pointcloud.attributes_.begin());
+    pointcloud.attribute_names_ = attribute_names_;
 }
 
 void HostPointCloud::Clear() {
     points_.clear();
     normals_.clear();
     colors_.clear();
+    attributes_.clear();
+    attribute_names_.clear();
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <memory>
 #include <string>
+#include <vector>
 #include <cupoch/utility/device_vector.h>
 
 namespace cupoch {
@@ -21,6 +23,9 @@ struct HostPointCloud {
     utility::pinned_host_vector<Eigen::Vector3f> points_;
     utility::pinned_host_vector<Eigen::Vector3f> normals_;
     utility::pinned_host_vector<Eigen::Vector3f> colors_;
+    /// Interleaved custom attributes, as PointCloud::attributes_.
+    utility::pinned_host_vector<float> attributes_;
+    std::vector<std::string> attribute_names_;
 };
 
 /// Factory function to create a pointcloud from a file (PointCloudFactory.cpp)
@@ -61,6 +66,13 @@ bool WritePointCloudToPLY(const std::string &filename,
                           bool compressed = false,
                           bool print_progress = false);
 
+/// Writes a point cloud already copied to the host, e.g. by AsyncWriter.
+bool WriteHostPointCloudToPLY(const std::string &filename,
+                              const HostPointCloud &host_pc,
+                              bool write_ascii = false,
+                              bool compressed = false,
+                              bool print_progress = false);
+
 bool ReadPointCloudFromPCD(const std::string &filename,
                            geometry::PointCloud &pointcloud,
                            bool print_progress = false);
@@ -71,5 +83,111 @@ bool WritePointCloudToPCD(const std::string &filename,
                           bool compressed = false,
                           bool print_progress = false);
 
+bool WriteHostPointCloudToPCD(const std::string &filename,
+                              const HostPointCloud &host_pc,
+                              bool write_ascii = false,
+                              bool compressed = false,
+                              bool print_progress = false);
+
+/// The cupoch binary format stores the device buffers of the point cloud as
+/// they are, optionally LZF compressed, with the custom attributes.
+bool ReadPointCloudFromCBF(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress = false);
+
+bool WritePointCloudToCBF(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii = false,
+                          bool compressed = false,
+                          bool print_progress = false);
+
+/// LAS and LAZ point clouds, e.g. from aerial surveys. The intensity and
+/// the classification of the points are stored in the "intensity" and
+/// "classification" attributes and the 16 bit colors are scaled to [0, 1].
+/// LAZ files need cupoch to be built with LASzip.
+bool ReadPointCloudFromLAS(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress = false);
+
+/// The ASCII formats of one point per line: the XYZ family (.xyz, .xyzn,
+/// .xyzrgb) and PTS.
+bool ReadPointCloudFromXYZ(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress = false);
+
+bool WritePointCloudToXYZ(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii = false,
+                          bool compressed = false,
+                          bool print_progress = false);
+
+bool ReadPointCloudFromXYZN(const std::string &filename,
+                            geometry::PointCloud &pointcloud,
+                            bool print_progress = false);
+
+bool WritePointCloudToXYZN(const std::string &filename,
+                           const geometry::PointCloud &pointcloud,
+                           bool write_ascii = false,
+                           bool compressed = false,
+                           bool print_progress = false);
+
+bool ReadPointCloudFromXYZRGB(const std::string &filename,
+                              geometry::PointCloud &pointcloud,
+                              bool print_progress = false);
+
+bool WritePointCloudToXYZRGB(const std::string &filename,
+                             const geometry::PointCloud &pointcloud,
+                             bool write_ascii = false,
+                             bool compressed = false,
+                             bool print_progress = false);
+
+bool ReadPointCloudFromPTS(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress = false);
+
+bool WritePointCloudToPTS(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii = false,
+                          bool compressed = false,
+                          bool print_progress = false);
+
+/// \class PointCloudStreamReader
+///
+/// \brief Reads a point cloud file in chunks of at most \p chunk_size points,
+/// so that files larger than the device memory can be processed chunk by
+/// chunk.
+///
+/// The chunks are decoded into two pinned staging buffers in turn. While a
+/// chunk is copied to the device, the next one is decoded into the other
+/// buffer, so the file reads overlap with the transfers. Uncompressed
+/// (ascii and binary) PCD files and LAS files can be streamed, and LAZ files
+/// when cupoch is built with LASzip.
+class PointCloudStreamReader {
+public:
+    explicit PointCloudStreamReader(size_t chunk_size = 1 << 22);
+    ~PointCloudStreamReader();
+    PointCloudStreamReader(const PointCloudStreamReader &) = delete;
+    PointCloudStreamReader &operator=(const PointCloudStreamReader &) = delete;
+
+public:
+    bool Open(const std::string &filename);
+    void Close();
+    bool IsOpen() const;
+
+    /// Reads the next chunk into \p chunk, reusing its buffers. Returns
+    /// false once the whole file has been read.
+    bool ReadChunk(geometry::PointCloud &chunk);
+
+    /// Number of points in the file.
+    size_t GetNumPoints() const;
+    /// Number of points returned by ReadChunk so far.
+    size_t GetNumReadPoints() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    size_t chunk_size_;
+};
+
 }  // namespace io
 }  // namespace cupoch
\ No newline at end of file
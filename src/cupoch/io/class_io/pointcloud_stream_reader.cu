@@ -0,0 +1,116 @@
+#include <algorithm>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/file_format/point_chunk_decoder.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/filesystem.h"
+
+namespace cupoch {
+namespace io {
+
+namespace {
+
+template <typename T>
+void UploadAsync(const utility::pinned_host_vector<T> &src,
+                 utility::device_vector<T> &dst,
+                 cudaStream_t stream) {
+    dst.resize(src.size());
+    cudaMemcpyAsync(thrust::raw_pointer_cast(dst.data()), src.data(),
+                    src.size() * sizeof(T), cudaMemcpyHostToDevice, stream);
+}
+
+}  // unnamed namespace
+
+struct PointCloudStreamReader::Impl {
+    std::unique_ptr<PointChunkDecoder> decoder_;
+    size_t n_decoded_ = 0;
+    size_t n_read_ = 0;
+    HostPointCloud staging_[2];
+    int current_ = 0;
+    utility::ExecutionContext ctx_;
+
+    void DecodeNext(size_t chunk_size) {
+        HostPointCloud &host_pc = staging_[current_];
+        const size_t n_points = std::min(
+                chunk_size, decoder_->GetNumPoints() - n_decoded_);
+        if (n_points == 0) {
+            host_pc.Clear();
+            return;
+        }
+        if (!decoder_->DecodeNext(n_points, host_pc)) {
+            utility::LogWarning(
+                    "[PointCloudStreamReader] Failed to read data record.\n");
+            host_pc.Clear();
+            n_decoded_ = decoder_->GetNumPoints();
+            return;
+        }
+        n_decoded_ += n_points;
+    }
+};
+
+PointCloudStreamReader::PointCloudStreamReader(size_t chunk_size)
+    : chunk_size_(std::max(chunk_size, (size_t)1)) {}
+
+PointCloudStreamReader::~PointCloudStreamReader() { Close(); }
+
+bool PointCloudStreamReader::Open(const std::string &filename) {
+    Close();
+    const std::string ext =
+            utility::filesystem::GetFileExtensionInLowerCase(filename);
+    std::unique_ptr<PointChunkDecoder> decoder;
+    if (ext == "pcd") {
+        decoder = CreatePCDChunkDecoder(filename);
+    } else if (ext == "las" || ext == "laz") {
+        decoder = CreateLASChunkDecoder(filename);
+    } else {
+        utility::LogWarning(
+                "[PointCloudStreamReader] Only PCD, LAS and LAZ files can be "
+                "streamed.\n");
+        return false;
+    }
+    if (!decoder) return false;
+    std::unique_ptr<Impl> impl(new Impl());
+    impl->decoder_ = std::move(decoder);
+    impl->DecodeNext(chunk_size_);
+    impl_.swap(impl);
+    return true;
+}
+
+void PointCloudStreamReader::Close() {
+    if (!impl_) return;
+    impl_->ctx_.Synchronize();
+    impl_.reset();
+}
+
+bool PointCloudStreamReader::IsOpen() const { return (bool)impl_; }
+
+bool PointCloudStreamReader::ReadChunk(geometry::PointCloud &chunk) {
+    if (!impl_) return false;
+    const HostPointCloud &host_pc = impl_->staging_[impl_->current_];
+    if (host_pc.points_.empty()) return false;
+    cudaStream_t stream = impl_->ctx_.GetStream();
+    UploadAsync(host_pc.points_, chunk.points_, stream);
+    UploadAsync(host_pc.normals_, chunk.normals_, stream);
+    UploadAsync(host_pc.colors_, chunk.colors_, stream);
+    UploadAsync(host_pc.attributes_, chunk.attributes_, stream);
+    chunk.attribute_names_ = host_pc.attribute_names_;
+    // Decode the next chunk into the other buffer while the copy runs.
+    impl_->current_ ^= 1;
+    impl_->DecodeNext(chunk_size_);
+    impl_->ctx_.Synchronize();
+    impl_->n_read_ += chunk.points_.size();
+    return true;
+}
+
+size_t PointCloudStreamReader::GetNumPoints() const {
+    return (impl_) ? impl_->decoder_->GetNumPoints() : 0;
+}
+
+size_t PointCloudStreamReader::GetNumReadPoints() const {
+    return (impl_) ? impl_->n_read_ : 0;
+}
+
+}  // namespace io
+}  // namespace cupoch
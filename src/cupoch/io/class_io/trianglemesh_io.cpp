@@ -2,6 +2,7 @@
 #include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/utility/filesystem.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/profiler.h"
 #include <Eigen/Geometry>
 #include <unordered_map>
 
@@ -17,6 +18,7 @@ static const std::unordered_map<
         file_extension_to_trianglemesh_read_function{
                 {"ply", ReadTriangleMeshFromPLY},
                 {"obj", ReadTriangleMeshFromOBJ},
+                {"cbf", ReadTriangleMeshFromCBF},
         };
 
 static const std::unordered_map<
@@ -32,6 +34,7 @@ static const std::unordered_map<
         file_extension_to_trianglemesh_write_function{
                 {"ply", WriteTriangleMeshToPLY},
                 {"obj", WriteTriangleMeshToOBJ},
+                {"cbf", WriteTriangleMeshToCBF},
         };
 
 // Reference: https://stackoverflow.com/a/43896965
@@ -75,6 +78,7 @@ std::shared_ptr<geometry::TriangleMesh> CreateMeshFromFile(
 bool ReadTriangleMesh(const std::string &filename,
                       geometry::TriangleMesh &mesh,
                       bool print_progress /* = false */) {
+    CUPOCH_PROFILE("ReadTriangleMesh");
     std::string filename_ext =
             utility::filesystem::GetFileExtensionInLowerCase(filename);
     if (filename_ext.empty()) {
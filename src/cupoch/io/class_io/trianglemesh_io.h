@@ -69,6 +69,15 @@ bool WriteTriangleMeshToPLY(const std::string &filename,
                             bool write_triangle_uvs,
                             bool print_progress);
 
+/// Writes a mesh already copied to the host, e.g. by AsyncWriter.
+bool WriteHostTriangleMeshToPLY(const std::string &filename,
+                                const HostTriangleMesh &host_mesh,
+                                bool write_ascii,
+                                bool compressed,
+                                bool write_vertex_normals,
+                                bool write_vertex_colors,
+                                bool write_triangle_uvs,
+                                bool print_progress);
 
 bool ReadTriangleMeshFromOBJ(const std::string &filename,
                              geometry::TriangleMesh &mesh,
@@ -83,6 +92,21 @@ bool WriteTriangleMeshToOBJ(const std::string &filename,
                             bool write_triangle_uvs,
                             bool print_progress);
 
+/// The cupoch binary format stores the device buffers of the mesh as they
+/// are, optionally LZF compressed. The texture is not stored.
+bool ReadTriangleMeshFromCBF(const std::string &filename,
+                             geometry::TriangleMesh &mesh,
+                             bool print_progress);
+
+bool WriteTriangleMeshToCBF(const std::string &filename,
+                            const geometry::TriangleMesh &mesh,
+                            bool write_ascii,
+                            bool compressed,
+                            bool write_vertex_normals,
+                            bool write_vertex_colors,
+                            bool write_triangle_uvs,
+                            bool print_progress);
+
 /// Function to convert a polygon into a collection of
 /// triangles whose vertices are only those of the polygon.
 /// Assume that the vertices are connected by edges based on their order, and
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+#include "cupoch/integration/uniform_tsdfvolume.h"
+
+namespace cupoch {
+namespace io {
+
+/// Reads a UniformTSDFVolume saved with WriteUniformTSDFVolumeToCBF, the
+/// parameters of the volume are overwritten by the ones of the file.
+bool ReadUniformTSDFVolumeFromCBF(const std::string &filename,
+                                  integration::UniformTSDFVolume &volume);
+
+bool WriteUniformTSDFVolumeToCBF(const std::string &filename,
+                                 const integration::UniformTSDFVolume &volume,
+                                 bool compressed = false);
+
+}  // namespace io
+}  // namespace cupoch
@@ -15,6 +15,7 @@ static const std::unordered_map<
         std::function<bool(const std::string &, geometry::VoxelGrid &, bool)>>
         file_extension_to_voxelgrid_read_function{
                 {"ply", ReadVoxelGridFromPLY},
+                {"cbf", ReadVoxelGridFromCBF},
         };
 
 static const std::unordered_map<std::string,
@@ -25,6 +26,7 @@ static const std::unordered_map<std::string,
                                                    const bool)>>
         file_extension_to_voxelgrid_write_function{
                 {"ply", WriteVoxelGridToPLY},
+                {"cbf", WriteVoxelGridToCBF},
         };
 }  // unnamed namespace
 
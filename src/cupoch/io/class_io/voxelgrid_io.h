@@ -53,5 +53,17 @@ bool WriteVoxelGridToPLY(const std::string &filename,
                          bool compressed = false,
                          bool print_progress = false);
 
+/// The cupoch binary format stores the device buffers of the voxel grid as
+/// they are, optionally LZF compressed.
+bool ReadVoxelGridFromCBF(const std::string &filename,
+                          geometry::VoxelGrid &voxelgrid,
+                          bool print_progress = false);
+
+bool WriteVoxelGridToCBF(const std::string &filename,
+                         const geometry::VoxelGrid &voxelgrid,
+                         bool write_ascii = false,
+                         bool compressed = false,
+                         bool print_progress = false);
+
 }  // namespace io
 }  // namespace cupoch
\ No newline at end of file
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/file_format/ascii_records.h"
+
+using namespace cupoch;
+using namespace cupoch::io;
+
+namespace {
+
+/// Chunks smaller than this are not worth a thread.
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char *SkipBlanks(const char *p, const char *end) {
+    while (p < end && IsBlank(*p)) ++p;
+    return p;
+}
+
+inline const char *SkipToken(const char *p, const char *end) {
+    while (p < end && !IsBlank(*p) && *p != '\n') ++p;
+    return p;
+}
+
+/// Whether the line starting at \p p holds a row.
+inline bool IsRow(const char *p, const char *end) {
+    p = SkipBlanks(p, end);
+    return p < end && *p != '\n' && *p != '#';
+}
+
+inline const char *NextLine(const char *p, const char *end) {
+    p = (const char *)std::memchr(p, '\n', end - p);
+    return (p) ? p + 1 : end;
+}
+
+/// Parses the token [begin, end) with the C library, for the numbers out of
+/// the fast path: nan, inf, hexadecimal and overlong numbers.
+bool ParseTokenSlow(const char *begin,
+                    const char *end,
+                    char type,
+                    double &value) {
+    const std::string token(begin, end);
+    char *parsed;
+    if (type == 'I') {
+        value = (double)std::strtoll(token.c_str(), &parsed, 0);
+    } else if (type == 'U') {
+        value = (double)std::strtoull(token.c_str(), &parsed, 0);
+    } else {
+        value = std::strtod(token.c_str(), &parsed);
+    }
+    return parsed == token.c_str() + token.size() && !token.empty();
+}
+
+/// Parses the decimal number of the token [begin, end).
+bool ParseToken(const char *begin, const char *end, char type, double &value) {
+    static const double powers_of_ten[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int n_significant = 0;
+    int n_digits = 0;
+    for (; p < end && IsDigit(*p); ++p, ++n_digits) {
+        if (n_significant < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa > 0) ++n_significant;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && IsDigit(*p); ++p, ++n_digits) {
+            if (n_significant < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa > 0) ++n_significant;
+                --exponent;
+            }
+        }
+    }
+    if (n_digits == 0) return ParseTokenSlow(begin, end, type, value);
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative_exponent = (*p++ == '-');
+        }
+        if (p == end || !IsDigit(*p)) return false;
+        int e = 0;
+        for (; p < end && IsDigit(*p); ++p) {
+            e = std::min(e * 10 + (*p - '0'), 9999);
+        }
+        exponent += (negative_exponent) ? -e : e;
+    }
+    if (p != end || n_significant > 15) {
+        return ParseTokenSlow(begin, end, type, value);
+    }
+    value = (double)mantissa;
+    if (exponent < 0) {
+        value = (exponent >= -22) ? value / powers_of_ten[-exponent]
+                                  : value * std::pow(10.0, exponent);
+    } else if (exponent > 0) {
+        value = (exponent <= 22) ? value * powers_of_ten[exponent]
+                                 : value * std::pow(10.0, exponent);
+    }
+    if (negative) value = -value;
+    return true;
+}
+
+Eigen::Vector3f UnpackColor(const char *begin, const char *end, char type) {
+    std::uint8_t data[4] = {0, 0, 0, 0};
+    const std::string token(begin, end);
+    char *parsed;
+    if (type == 'I') {
+        std::int32_t value = std::strtol(token.c_str(), &parsed, 0);
+        memcpy(data, &value, 4);
+    } else if (type == 'U') {
+        std::uint32_t value = std::strtoul(token.c_str(), &parsed, 0);
+        memcpy(data, &value, 4);
+    } else {
+        // The bits of the float are the color, so it must be exact.
+        std::float_t value = std::strtof(token.c_str(), &parsed);
+        memcpy(data, &value, 4);
+    }
+    // color data is packed in BGR order.
+    return Eigen::Vector3f((float)data[2] / 255.0, (float)data[1] / 255.0,
+                           (float)data[0] / 255.0);
+}
+
+class AsciiRowParser {
+public:
+    AsciiRowParser(const AsciiRecordLayout &layout, HostPointCloud &host_pc)
+        : layout_(layout), host_pc_(host_pc) {
+        has_normals_ = layout.HasNormals();
+        has_colors_ = layout.HasColors();
+        for (int i = 0; i < PackedRecordLayout::NumChannels; ++i) {
+            const int column = layout.fields_[i].column_;
+            if (column < 0) continue;
+            if (column >= (int)channels_.size()) {
+                channels_.resize(column + 1, -1);
+            }
+            channels_[column] = i;
+        }
+    }
+
+    /// Parses the row starting at \p p into point \p idx.
+    bool Parse(const char *p, const char *end, size_t idx) const {
+        float values[PackedRecordLayout::NumChannels] = {};
+        Eigen::Vector3f packed_color = Eigen::Vector3f::Zero();
+        for (size_t column = 0; column < channels_.size(); ++column) {
+            p = SkipBlanks(p, end);
+            const char *token_end = SkipToken(p, end);
+            if (token_end == p) return false;
+            const int channel = channels_[column];
+            if (channel >= 0) {
+                const char type = layout_.fields_[channel].type_;
+                if (layout_.packed_color_ &&
+                    channel == PackedRecordLayout::Red) {
+                    packed_color = UnpackColor(p, token_end, type);
+                } else {
+                    double value;
+                    if (!ParseToken(p, token_end, type, value)) return false;
+                    values[channel] = (float)value;
+                }
+            }
+            p = token_end;
+        }
+        host_pc_.points_[idx] =
+                Eigen::Vector3f(values[PackedRecordLayout::X],
+                                values[PackedRecordLayout::Y],
+                                values[PackedRecordLayout::Z]);
+        if (has_normals_) {
+            host_pc_.normals_[idx] =
+                    Eigen::Vector3f(values[PackedRecordLayout::NormalX],
+                                    values[PackedRecordLayout::NormalY],
+                                    values[PackedRecordLayout::NormalZ]);
+        }
+        if (has_colors_ && layout_.packed_color_) {
+            host_pc_.colors_[idx] = packed_color;
+        } else if (has_colors_) {
+            host_pc_.colors_[idx] =
+                    layout_.color_scale_ *
+                    Eigen::Vector3f(values[PackedRecordLayout::Red],
+                                    values[PackedRecordLayout::Green],
+                                    values[PackedRecordLayout::Blue]);
+        }
+        return true;
+    }
+
+private:
+    const AsciiRecordLayout &layout_;
+    HostPointCloud &host_pc_;
+    /// Channel of each column, -1 for the skipped ones.
+    std::vector<int> channels_;
+    bool has_normals_;
+    bool has_colors_;
+};
+
+template <typename Func>
+void ParallelForChunks(size_t n_chunks, Func func) {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n_chunks; ++i) threads.emplace_back(func, i);
+    func(0);
+    for (auto &thread : threads) thread.join();
+}
+
+}  // namespace
+
+namespace cupoch {
+namespace io {
+
+bool ReadAsciiRecords(const char *data,
+                      size_t n_bytes,
+                      size_t max_points,
+                      const AsciiRecordLayout &layout,
+                      HostPointCloud &host_pc,
+                      size_t num_threads) {
+    host_pc.Clear();
+    if (!layout.HasPoints()) return false;
+    const char *end = data + n_bytes;
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    const size_t n_chunks = std::max<size_t>(
+            std::min(num_threads, n_bytes / MIN_CHUNK_SIZE), 1);
+    // The chunks start at line beginnings.
+    std::vector<const char *> bounds(n_chunks + 1, end);
+    bounds[0] = data;
+    for (size_t i = 1; i < n_chunks; ++i) {
+        bounds[i] = std::max(NextLine(data + i * n_bytes / n_chunks - 1, end),
+                             bounds[i - 1]);
+    }
+
+    std::vector<size_t> offsets(n_chunks + 1, 0);
+    ParallelForChunks(n_chunks, [&](size_t i) {
+        size_t n_rows = 0;
+        for (const char *p = bounds[i]; p < bounds[i + 1];
+             p = NextLine(p, bounds[i + 1])) {
+            if (IsRow(p, bounds[i + 1])) ++n_rows;
+        }
+        offsets[i + 1] = n_rows;
+    });
+    for (size_t i = 0; i < n_chunks; ++i) offsets[i + 1] += offsets[i];
+    const size_t n_points = std::min(offsets[n_chunks], max_points);
+
+    host_pc.points_.resize(n_points);
+    if (layout.HasNormals()) host_pc.normals_.resize(n_points);
+    if (layout.HasColors()) host_pc.colors_.resize(n_points);
+    const AsciiRowParser parser(layout, host_pc);
+    std::atomic<bool> success(true);
+    ParallelForChunks(n_chunks, [&](size_t i) {
+        size_t idx = offsets[i];
+        for (const char *p = bounds[i]; p < bounds[i + 1] && idx < n_points;
+             p = NextLine(p, bounds[i + 1])) {
+            if (!IsRow(p, bounds[i + 1])) continue;
+            if (!parser.Parse(p, bounds[i + 1], idx++)) {
+                success = false;
+                return;
+            }
+        }
+    });
+    if (!success) host_pc.Clear();
+    return success;
+}
+
+int CountAsciiColumns(const char *data, size_t n_bytes) {
+    const char *end = data + n_bytes;
+    const char *p = data;
+    while (p < end && !IsRow(p, end)) p = NextLine(p, end);
+    int n_columns = 0;
+    while (true) {
+        p = SkipBlanks(p, end);
+        if (p == end || *p == '\n') break;
+        p = SkipToken(p, end);
+        ++n_columns;
+    }
+    return n_columns;
+}
+
+}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+
+#include "cupoch/io/file_format/packed_records.h"
+
+namespace cupoch {
+namespace io {
+
+struct HostPointCloud;
+
+/// Column of one scalar in the whitespace separated rows of an ASCII file.
+/// \p type_ is 'I', 'U' or 'F' as in the PCD TYPE line and a negative
+/// \p column_ marks a missing field.
+struct AsciiField {
+    int column_ = -1;
+    char type_ = 'F';
+};
+
+struct AsciiRecordLayout {
+    /// Indexed by PackedRecordLayout::Channel.
+    AsciiField fields_[PackedRecordLayout::NumChannels];
+    /// The color is a single 4 byte BGR(A) value stored in fields_[Red], as
+    /// the rgb field of PCD.
+    bool packed_color_ = false;
+    /// Factor of the unpacked color channels.
+    float color_scale_ = 1.0f / 255.0f;
+
+    bool HasPoints() const {
+        return fields_[PackedRecordLayout::X].column_ >= 0 &&
+               fields_[PackedRecordLayout::Y].column_ >= 0 &&
+               fields_[PackedRecordLayout::Z].column_ >= 0;
+    }
+    bool HasNormals() const {
+        return fields_[PackedRecordLayout::NormalX].column_ >= 0 &&
+               fields_[PackedRecordLayout::NormalY].column_ >= 0 &&
+               fields_[PackedRecordLayout::NormalZ].column_ >= 0;
+    }
+    bool HasColors() const {
+        const bool has_red = fields_[PackedRecordLayout::Red].column_ >= 0;
+        if (packed_color_) return has_red;
+        return has_red && fields_[PackedRecordLayout::Green].column_ >= 0 &&
+               fields_[PackedRecordLayout::Blue].column_ >= 0;
+    }
+};
+
+/// Parses the rows of an ASCII point file into \p host_pc, keeping at most
+/// \p max_points of them. Blank lines and lines starting with '#' are not
+/// rows. The data is split into chunks at line boundaries, which are parsed
+/// by \p num_threads threads (0 for one per core): the rows of each chunk
+/// are counted first, and an exclusive prefix sum of the counts gives the
+/// index of the first point of every chunk, so the threads then write their
+/// points in place. Returns false when a row lacks a column or holds a
+/// malformed number.
+bool ReadAsciiRecords(const char *data,
+                      size_t n_bytes,
+                      size_t max_points,
+                      const AsciiRecordLayout &layout,
+                      HostPointCloud &host_pc,
+                      size_t num_threads = 0);
+
+/// Number of columns of the first row of \p data, 0 if there is none.
+int CountAsciiColumns(const char *data, size_t n_bytes);
+
+}  // namespace io
+}  // namespace cupoch
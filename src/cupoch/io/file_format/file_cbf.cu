@@ -0,0 +1,504 @@
+#include <lzf.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/integration/uniform_tsdfvolume.h"
+#include "cupoch/io/class_io/occupancygrid_io.h"
+#include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/class_io/trianglemesh_io.h"
+#include "cupoch/io/class_io/tsdfvolume_io.h"
+#include "cupoch/io/class_io/voxelgrid_io.h"
+#include "cupoch/io/file_format/file_cbf.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+
+namespace {
+using namespace io;
+
+size_t AlignCBFOffset(size_t offset) {
+    return (offset + kCBFAlignment - 1) / kCBFAlignment * kCBFAlignment;
+}
+
+struct CBFVoxelGridMetadata {
+    float voxel_size_;
+    Eigen::Vector3f origin_;
+};
+
+struct CBFOccupancyGridMetadata {
+    float voxel_size_;
+    int resolution_;
+    Eigen::Vector3f origin_;
+    Eigen::Vector3ui16 min_bound_;
+    Eigen::Vector3ui16 max_bound_;
+    float clamping_thres_min_;
+    float clamping_thres_max_;
+    float prob_hit_log_;
+    float prob_miss_log_;
+    float occ_prob_thres_log_;
+    bool visualize_free_area_;
+    Eigen::Vector3i ring_offset_;
+};
+
+struct CBFUniformTSDFVolumeMetadata {
+    float voxel_length_;
+    float sdf_trunc_;
+    integration::TSDFVolumeColorType color_type_;
+    Eigen::Vector3f origin_;
+    float length_;
+    int resolution_;
+    int voxel_num_;
+};
+
+}  // unnamed namespace
+
+namespace io {
+
+void CBFWriter::AddColumn(const std::string &name,
+                          const void *device_data,
+                          size_t element_size,
+                          size_t n_elements) {
+    Column column;
+    memset(&column.entry_, 0, sizeof(CBFColumnEntry));
+    if (name.size() >= sizeof(column.entry_.name_)) {
+        utility::LogWarning("[CBFWriter] Column name {} is too long.\n", name);
+    }
+    strncpy(column.entry_.name_, name.c_str(),
+            sizeof(column.entry_.name_) - 1);
+    column.entry_.element_size_ = element_size;
+    column.entry_.n_elements_ = n_elements;
+    column.data_.resize(element_size * n_elements);
+    if (!column.data_.empty()) {
+        cudaSafeCall(cudaMemcpy(thrust::raw_pointer_cast(column.data_.data()),
+                                device_data, column.data_.size(),
+                                cudaMemcpyDeviceToHost));
+    }
+    columns_.push_back(std::move(column));
+}
+
+bool CBFWriter::Write(const std::string &filename, bool compressed) const {
+    std::vector<CBFColumnEntry> entries;
+    std::vector<CBFChunkEntry> chunks;
+    std::vector<const char *> chunk_data;
+    std::vector<std::vector<char>> compressed_data;
+    for (const auto &column : columns_) {
+        CBFColumnEntry entry = column.entry_;
+        entry.first_chunk_ = chunks.size();
+        const size_t chunk_bytes =
+                std::max<size_t>(kCBFChunkBytes / entry.element_size_, 1) *
+                entry.element_size_;
+        const char *data = thrust::raw_pointer_cast(column.data_.data());
+        for (size_t begin = 0; begin < column.data_.size();
+             begin += chunk_bytes) {
+            CBFChunkEntry chunk;
+            memset(&chunk, 0, sizeof(CBFChunkEntry));
+            chunk.raw_size_ = std::min(chunk_bytes, column.data_.size() - begin);
+            chunk.stored_size_ = chunk.raw_size_;
+            chunk.compression_ = CBFCompression::None;
+            const char *stored = data + begin;
+            if (compressed) {
+                // Chunks that do not get smaller are stored raw.
+                std::vector<char> buffer(chunk.raw_size_);
+                const unsigned int size = lzf_compress(
+                        stored, (unsigned int)chunk.raw_size_, buffer.data(),
+                        (unsigned int)chunk.raw_size_ - 1);
+                if (size > 0) {
+                    buffer.resize(size);
+                    compressed_data.push_back(std::move(buffer));
+                    stored = compressed_data.back().data();
+                    chunk.stored_size_ = size;
+                    chunk.compression_ = CBFCompression::LZF;
+                }
+            }
+            chunks.push_back(chunk);
+            chunk_data.push_back(stored);
+        }
+        entry.n_chunks_ = chunks.size() - entry.first_chunk_;
+        entries.push_back(entry);
+    }
+
+    CBFHeader header;
+    memset(&header, 0, sizeof(CBFHeader));
+    memcpy(header.magic_, kCBFMagic, sizeof(kCBFMagic));
+    header.version_ = kCBFVersion;
+    header.content_type_ = content_type_;
+    header.metadata_size_ = metadata_.size();
+    header.n_columns_ = entries.size();
+    header.n_chunks_ = chunks.size();
+    size_t offset = AlignCBFOffset(
+            sizeof(CBFHeader) + metadata_.size() +
+            entries.size() * sizeof(CBFColumnEntry) +
+            chunks.size() * sizeof(CBFChunkEntry));
+    for (auto &chunk : chunks) {
+        chunk.offset_ = offset;
+        offset = AlignCBFOffset(offset + chunk.stored_size_);
+    }
+
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (file == NULL) {
+        utility::LogWarning("Write CBF failed: unable to open file: {}\n",
+                            filename);
+        return false;
+    }
+    bool success = fwrite(&header, sizeof(CBFHeader), 1, file) == 1;
+    success = success && fwrite(metadata_.data(), 1, metadata_.size(),
+                                file) == metadata_.size();
+    success = success && fwrite(entries.data(), sizeof(CBFColumnEntry),
+                                entries.size(), file) == entries.size();
+    success = success && fwrite(chunks.data(), sizeof(CBFChunkEntry),
+                                chunks.size(), file) == chunks.size();
+    const char zeros[kCBFAlignment] = {0};
+    for (size_t i = 0; i < chunks.size() && success; ++i) {
+        const size_t padding = chunks[i].offset_ - ftell(file);
+        success = fwrite(zeros, 1, padding, file) == padding &&
+                  fwrite(chunk_data[i], 1, chunks[i].stored_size_, file) ==
+                          chunks[i].stored_size_;
+    }
+    fclose(file);
+    if (!success) {
+        utility::LogWarning("Write CBF failed: unable to write file: {}\n",
+                            filename);
+    }
+    return success;
+}
+
+bool CBFReader::Open(const std::string &filename,
+                     CBFContentType content_type) {
+    metadata_.clear();
+    columns_.clear();
+    chunks_.clear();
+    if (!mapped_.Open(filename)) {
+        utility::LogWarning("Read CBF failed: unable to open file: {}\n",
+                            filename);
+        return false;
+    }
+    const char *data = mapped_.GetData();
+    const size_t size = mapped_.GetSize();
+    CBFHeader header;
+    if (size < sizeof(CBFHeader)) {
+        utility::LogWarning("Read CBF failed: unable to parse header.\n");
+        return false;
+    }
+    memcpy(&header, data, sizeof(CBFHeader));
+    if (memcmp(header.magic_, kCBFMagic, sizeof(kCBFMagic)) != 0 ||
+        header.version_ != kCBFVersion) {
+        utility::LogWarning("Read CBF failed: unable to parse header.\n");
+        return false;
+    }
+    if (header.content_type_ != content_type) {
+        utility::LogWarning("Read CBF failed: the file stores another type.\n");
+        return false;
+    }
+    const size_t tables_size = header.metadata_size_ +
+                               header.n_columns_ * sizeof(CBFColumnEntry) +
+                               header.n_chunks_ * sizeof(CBFChunkEntry);
+    if (size - sizeof(CBFHeader) < tables_size) {
+        utility::LogWarning("Read CBF failed: unable to parse header.\n");
+        return false;
+    }
+    data += sizeof(CBFHeader);
+    metadata_.assign(data, header.metadata_size_);
+    data += header.metadata_size_;
+    columns_.resize(header.n_columns_);
+    memcpy(columns_.data(), data, header.n_columns_ * sizeof(CBFColumnEntry));
+    data += header.n_columns_ * sizeof(CBFColumnEntry);
+    chunks_.resize(header.n_chunks_);
+    memcpy(chunks_.data(), data, header.n_chunks_ * sizeof(CBFChunkEntry));
+    for (const auto &chunk : chunks_) {
+        if (chunk.offset_ > size || size - chunk.offset_ < chunk.stored_size_) {
+            utility::LogWarning("Read CBF failed: the file is truncated.\n");
+            return false;
+        }
+    }
+    for (auto &column : columns_) {
+        column.name_[sizeof(column.name_) - 1] = '\0';
+        if (column.first_chunk_ + column.n_chunks_ > chunks_.size()) {
+            utility::LogWarning("Read CBF failed: unable to parse header.\n");
+            return false;
+        }
+        size_t raw_size = 0;
+        for (size_t i = 0; i < column.n_chunks_; ++i) {
+            raw_size += chunks_[column.first_chunk_ + i].raw_size_;
+        }
+        if (raw_size != column.element_size_ * column.n_elements_) {
+            utility::LogWarning("Read CBF failed: unable to parse header.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+const CBFColumnEntry *CBFReader::FindColumn(const std::string &name) const {
+    for (const auto &column : columns_) {
+        if (name == column.name_) return &column;
+    }
+    return nullptr;
+}
+
+bool CBFReader::ReadColumn(const CBFColumnEntry &entry,
+                           void *device_data) const {
+    char *output = (char *)device_data;
+    for (size_t i = 0; i < entry.n_chunks_; ++i) {
+        const CBFChunkEntry &chunk = chunks_[entry.first_chunk_ + i];
+        const char *stored = mapped_.GetData() + chunk.offset_;
+        if (chunk.compression_ == CBFCompression::None) {
+            // Raw chunks are copied straight from the mapping.
+            cudaSafeCall(cudaMemcpyAsync(output, stored, chunk.raw_size_,
+                                         cudaMemcpyHostToDevice));
+        } else if (chunk.compression_ == CBFCompression::LZF) {
+            utility::device_vector<char> buffer;
+            if (!DecompressLZF(stored, chunk.stored_size_, chunk.raw_size_,
+                               buffer)) {
+                return false;
+            }
+            cudaSafeCall(cudaMemcpy(output,
+                                    thrust::raw_pointer_cast(buffer.data()),
+                                    chunk.raw_size_, cudaMemcpyDeviceToDevice));
+        } else {
+            utility::LogWarning("[CBFReader] Unknown chunk compression.\n");
+            return false;
+        }
+        output += chunk.raw_size_;
+    }
+    cudaSafeCall(cudaStreamSynchronize(0));
+    return true;
+}
+
+bool ReadPointCloudFromCBF(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress) {
+    CBFReader reader;
+    if (!reader.Open(filename, CBFContentType::PointCloud)) return false;
+    pointcloud.Clear();
+    if (!reader.ReadColumn("points", pointcloud.points_) ||
+        !reader.ReadColumn("normals", pointcloud.normals_) ||
+        !reader.ReadColumn("colors", pointcloud.colors_) ||
+        !reader.ReadColumn("attributes", pointcloud.attributes_)) {
+        pointcloud.Clear();
+        return false;
+    }
+    // The metadata holds the attribute names, one per line.
+    utility::SplitString(pointcloud.attribute_names_, reader.GetMetadata(),
+                         "\n");
+    return true;
+}
+
+bool WritePointCloudToCBF(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii /* = false*/,
+                          bool compressed /* = false*/,
+                          bool print_progress) {
+    CBFWriter writer(CBFContentType::PointCloud);
+    std::string attribute_names;
+    for (const auto &name : pointcloud.attribute_names_) {
+        attribute_names += name + "\n";
+    }
+    writer.SetMetadata(attribute_names);
+    writer.AddColumn("points", pointcloud.points_);
+    writer.AddColumn("normals", pointcloud.normals_);
+    writer.AddColumn("colors", pointcloud.colors_);
+    writer.AddColumn("attributes", pointcloud.attributes_);
+    return writer.Write(filename, compressed);
+}
+
+bool ReadTriangleMeshFromCBF(const std::string &filename,
+                             geometry::TriangleMesh &mesh,
+                             bool print_progress) {
+    CBFReader reader;
+    if (!reader.Open(filename, CBFContentType::TriangleMesh)) return false;
+    mesh.Clear();
+    if (!reader.ReadColumn("vertices", mesh.vertices_) ||
+        !reader.ReadColumn("vertex_normals", mesh.vertex_normals_) ||
+        !reader.ReadColumn("vertex_colors", mesh.vertex_colors_) ||
+        !reader.ReadColumn("triangles", mesh.triangles_) ||
+        !reader.ReadColumn("triangle_normals", mesh.triangle_normals_) ||
+        !reader.ReadColumn("edge_list", mesh.edge_list_) ||
+        !reader.ReadColumn("triangle_uvs", mesh.triangle_uvs_)) {
+        mesh.Clear();
+        return false;
+    }
+    return true;
+}
+
+bool WriteTriangleMeshToCBF(const std::string &filename,
+                            const geometry::TriangleMesh &mesh,
+                            bool write_ascii /* = false*/,
+                            bool compressed /* = false*/,
+                            bool write_vertex_normals /* = true*/,
+                            bool write_vertex_colors /* = true*/,
+                            bool write_triangle_uvs /* = true*/,
+                            bool print_progress) {
+    CBFWriter writer(CBFContentType::TriangleMesh);
+    writer.AddColumn("vertices", mesh.vertices_);
+    if (write_vertex_normals) {
+        writer.AddColumn("vertex_normals", mesh.vertex_normals_);
+    }
+    if (write_vertex_colors) {
+        writer.AddColumn("vertex_colors", mesh.vertex_colors_);
+    }
+    writer.AddColumn("triangles", mesh.triangles_);
+    writer.AddColumn("triangle_normals", mesh.triangle_normals_);
+    writer.AddColumn("edge_list", mesh.edge_list_);
+    if (write_triangle_uvs) {
+        writer.AddColumn("triangle_uvs", mesh.triangle_uvs_);
+    }
+    return writer.Write(filename, compressed);
+}
+
+bool ReadVoxelGridFromCBF(const std::string &filename,
+                          geometry::VoxelGrid &voxelgrid,
+                          bool print_progress) {
+    CBFReader reader;
+    CBFVoxelGridMetadata metadata;
+    if (!reader.Open(filename, CBFContentType::VoxelGrid) ||
+        !reader.GetMetadata(metadata)) {
+        return false;
+    }
+    voxelgrid.Clear();
+    voxelgrid.voxel_size_ = metadata.voxel_size_;
+    voxelgrid.origin_ = metadata.origin_;
+    if (!reader.ReadColumn("voxels_keys", voxelgrid.voxels_keys_) ||
+        !reader.ReadColumn("voxels_values", voxelgrid.voxels_values_) ||
+        voxelgrid.voxels_keys_.size() != voxelgrid.voxels_values_.size()) {
+        voxelgrid.Clear();
+        return false;
+    }
+    return true;
+}
+
+bool WriteVoxelGridToCBF(const std::string &filename,
+                         const geometry::VoxelGrid &voxelgrid,
+                         bool write_ascii /* = false*/,
+                         bool compressed /* = false*/,
+                         bool print_progress) {
+    CBFWriter writer(CBFContentType::VoxelGrid);
+    CBFVoxelGridMetadata metadata;
+    // Zeroed so that the padding bytes are written deterministically.
+    memset(&metadata, 0, sizeof(CBFVoxelGridMetadata));
+    metadata.voxel_size_ = voxelgrid.voxel_size_;
+    metadata.origin_ = voxelgrid.origin_;
+    writer.SetMetadata(metadata);
+    writer.AddColumn("voxels_keys", voxelgrid.voxels_keys_);
+    writer.AddColumn("voxels_values", voxelgrid.voxels_values_);
+    return writer.Write(filename, compressed);
+}
+
+bool ReadOccupancyGridFromCBF(const std::string &filename,
+                              geometry::OccupancyGrid &occupancygrid) {
+    CBFReader reader;
+    CBFOccupancyGridMetadata metadata;
+    if (!reader.Open(filename, CBFContentType::OccupancyGrid) ||
+        !reader.GetMetadata(metadata)) {
+        return false;
+    }
+    occupancygrid.voxel_size_ = metadata.voxel_size_;
+    occupancygrid.resolution_ = metadata.resolution_;
+    occupancygrid.origin_ = metadata.origin_;
+    occupancygrid.min_bound_ = metadata.min_bound_;
+    occupancygrid.max_bound_ = metadata.max_bound_;
+    occupancygrid.clamping_thres_min_ = metadata.clamping_thres_min_;
+    occupancygrid.clamping_thres_max_ = metadata.clamping_thres_max_;
+    occupancygrid.prob_hit_log_ = metadata.prob_hit_log_;
+    occupancygrid.prob_miss_log_ = metadata.prob_miss_log_;
+    occupancygrid.occ_prob_thres_log_ = metadata.occ_prob_thres_log_;
+    occupancygrid.visualize_free_area_ = metadata.visualize_free_area_;
+    occupancygrid.ring_offset_ = metadata.ring_offset_;
+    const size_t n_total = (size_t)metadata.resolution_ *
+                           metadata.resolution_ * metadata.resolution_;
+    if (!reader.ReadColumn("voxels", occupancygrid.voxels_) ||
+        occupancygrid.voxels_.size() != n_total) {
+        utility::LogWarning("Read CBF failed: invalid number of voxels.\n");
+        occupancygrid.Reconstruct(metadata.voxel_size_, metadata.resolution_);
+        return false;
+    }
+    return true;
+}
+
+bool WriteOccupancyGridToCBF(const std::string &filename,
+                             const geometry::OccupancyGrid &occupancygrid,
+                             bool compressed /* = false*/) {
+    CBFWriter writer(CBFContentType::OccupancyGrid);
+    CBFOccupancyGridMetadata metadata;
+    // Zeroed so that the padding bytes are written deterministically.
+    memset(&metadata, 0, sizeof(CBFOccupancyGridMetadata));
+    metadata.voxel_size_ = occupancygrid.voxel_size_;
+    metadata.resolution_ = occupancygrid.resolution_;
+    metadata.origin_ = occupancygrid.origin_;
+    metadata.min_bound_ = occupancygrid.min_bound_;
+    metadata.max_bound_ = occupancygrid.max_bound_;
+    metadata.clamping_thres_min_ = occupancygrid.clamping_thres_min_;
+    metadata.clamping_thres_max_ = occupancygrid.clamping_thres_max_;
+    metadata.prob_hit_log_ = occupancygrid.prob_hit_log_;
+    metadata.prob_miss_log_ = occupancygrid.prob_miss_log_;
+    metadata.occ_prob_thres_log_ = occupancygrid.occ_prob_thres_log_;
+    metadata.visualize_free_area_ = occupancygrid.visualize_free_area_;
+    metadata.ring_offset_ = occupancygrid.ring_offset_;
+    writer.SetMetadata(metadata);
+    writer.AddColumn("voxels", occupancygrid.voxels_);
+    return writer.Write(filename, compressed);
+}
+
+bool ReadUniformTSDFVolumeFromCBF(const std::string &filename,
+                                  integration::UniformTSDFVolume &volume) {
+    CBFReader reader;
+    CBFUniformTSDFVolumeMetadata metadata;
+    if (!reader.Open(filename, CBFContentType::UniformTSDFVolume) ||
+        !reader.GetMetadata(metadata)) {
+        return false;
+    }
+    // Also drops the mesh cached for incremental extraction.
+    volume.Reset();
+    volume.voxel_length_ = metadata.voxel_length_;
+    volume.sdf_trunc_ = metadata.sdf_trunc_;
+    volume.color_type_ = metadata.color_type_;
+    volume.origin_ = metadata.origin_;
+    volume.length_ = metadata.length_;
+    volume.resolution_ = metadata.resolution_;
+    volume.voxel_num_ = metadata.voxel_num_;
+    // Only one of the columns is stored, depending on the voxel layout.
+    if (!reader.ReadColumn("voxels", volume.voxels_) ||
+        !reader.ReadColumn("compact_voxels", volume.compact_voxels_)) {
+        volume.Reset();
+        return false;
+    }
+    volume.use_compact_voxels_ = !volume.compact_voxels_.empty();
+    if (volume.voxels_.size() + volume.compact_voxels_.size() !=
+        (size_t)metadata.voxel_num_) {
+        utility::LogWarning("Read CBF failed: invalid number of voxels.\n");
+        volume.Reset();
+        return false;
+    }
+    return true;
+}
+
+bool WriteUniformTSDFVolumeToCBF(const std::string &filename,
+                                 const integration::UniformTSDFVolume &volume,
+                                 bool compressed /* = false*/) {
+    CBFWriter writer(CBFContentType::UniformTSDFVolume);
+    CBFUniformTSDFVolumeMetadata metadata;
+    // Zeroed so that the padding bytes are written deterministically.
+    memset(&metadata, 0, sizeof(CBFUniformTSDFVolumeMetadata));
+    metadata.voxel_length_ = volume.voxel_length_;
+    metadata.sdf_trunc_ = volume.sdf_trunc_;
+    metadata.color_type_ = volume.color_type_;
+    metadata.origin_ = volume.origin_;
+    metadata.length_ = volume.length_;
+    metadata.resolution_ = volume.resolution_;
+    metadata.voxel_num_ = volume.voxel_num_;
+    writer.SetMetadata(metadata);
+    if (volume.use_compact_voxels_) {
+        writer.AddColumn("compact_voxels", volume.compact_voxels_);
+    } else {
+        writer.AddColumn("voxels", volume.voxels_);
+    }
+    return writer.Write(filename, compressed);
+}
+
+}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "cupoch/io/file_format/packed_records.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace io {
+
+// Cupoch binary format (.cbf). The file stores the device buffers of one
+// object as columns, so reading is a copy of every column without parsing:
+//
+//   CBFHeader
+//   metadata bytes (the scalar members of the object)
+//   CBFColumnEntry x n_columns_
+//   CBFChunkEntry x n_chunks_
+//   chunk data, every chunk aligned to kCBFAlignment
+//
+// Every column is split into chunks of about kCBFChunkBytes, each chunk is
+// stored raw or LZF compressed.
+
+enum class CBFContentType : std::uint32_t {
+    PointCloud = 1,
+    VoxelGrid = 2,
+    OccupancyGrid = 3,
+    TriangleMesh = 8,
+    UniformTSDFVolume = 100,
+};
+
+enum class CBFCompression : std::uint32_t {
+    None = 0,
+    LZF = 1,
+};
+
+constexpr char kCBFMagic[8] = {'C', 'U', 'P', 'O', 'C', 'H', 'B', 'F'};
+constexpr std::uint32_t kCBFVersion = 1;
+constexpr size_t kCBFAlignment = 64;
+constexpr size_t kCBFChunkBytes = 1 << 22;
+
+struct CBFHeader {
+    char magic_[8];
+    std::uint32_t version_;
+    CBFContentType content_type_;
+    std::uint64_t metadata_size_;
+    std::uint64_t n_columns_;
+    std::uint64_t n_chunks_;
+};
+
+struct CBFColumnEntry {
+    char name_[32];
+    std::uint64_t element_size_;
+    std::uint64_t n_elements_;
+    std::uint64_t first_chunk_;
+    std::uint64_t n_chunks_;
+};
+
+struct CBFChunkEntry {
+    std::uint64_t offset_;
+    std::uint64_t stored_size_;
+    std::uint64_t raw_size_;
+    CBFCompression compression_;
+    std::uint32_t padding_;
+};
+
+class CBFWriter {
+public:
+    explicit CBFWriter(CBFContentType content_type)
+        : content_type_(content_type){};
+
+public:
+    void SetMetadata(const std::string &metadata) { metadata_ = metadata; }
+    template <typename T>
+    void SetMetadata(const T &metadata) {
+        metadata_.assign((const char *)&metadata, sizeof(T));
+    }
+    /// The column is copied to the host right away.
+    template <typename T>
+    void AddColumn(const std::string &name,
+                   const utility::device_vector<T> &column) {
+        AddColumn(name, thrust::raw_pointer_cast(column.data()), sizeof(T),
+                  column.size());
+    }
+    void AddColumn(const std::string &name,
+                   const void *device_data,
+                   size_t element_size,
+                   size_t n_elements);
+    bool Write(const std::string &filename, bool compressed) const;
+
+private:
+    struct Column {
+        CBFColumnEntry entry_;
+        utility::pinned_host_vector<char> data_;
+    };
+    CBFContentType content_type_;
+    std::string metadata_;
+    std::vector<Column> columns_;
+};
+
+class CBFReader {
+public:
+    CBFReader() = default;
+
+public:
+    bool Open(const std::string &filename, CBFContentType content_type);
+    const std::string &GetMetadata() const { return metadata_; }
+    template <typename T>
+    bool GetMetadata(T &metadata) const {
+        if (metadata_.size() != sizeof(T)) {
+            utility::LogWarning("[CBFReader] Invalid metadata size.\n");
+            return false;
+        }
+        memcpy(&metadata, metadata_.data(), sizeof(T));
+        return true;
+    }
+    /// Reads the column \p name into \p column. A missing column reads as
+    /// empty.
+    template <typename T>
+    bool ReadColumn(const std::string &name,
+                    utility::device_vector<T> &column) const {
+        const CBFColumnEntry *entry = FindColumn(name);
+        if (entry == nullptr) {
+            column.clear();
+            return true;
+        }
+        if (entry->element_size_ != sizeof(T)) {
+            utility::LogWarning(
+                    "[CBFReader] Column {} has an invalid element size.\n",
+                    name);
+            return false;
+        }
+        column.resize(entry->n_elements_);
+        return ReadColumn(*entry, thrust::raw_pointer_cast(column.data()));
+    }
+
+private:
+    const CBFColumnEntry *FindColumn(const std::string &name) const;
+    bool ReadColumn(const CBFColumnEntry &entry, void *device_data) const;
+
+    MappedFile mapped_;
+    std::string metadata_;
+    std::vector<CBFColumnEntry> columns_;
+    std::vector<CBFChunkEntry> chunks_;
+};
+
+}  // namespace io
+}  // namespace cupoch
@@ -12,6 +12,8 @@ namespace cupoch {
 namespace io {
 
 bool ReadImageFromJPG(const std::string &filename, geometry::Image &image) {
+    if (ReadImageFromJPGWithNvJPEG(filename, image)) return true;
+
     struct jpeg_decompress_struct cinfo;
     struct jpeg_error_mgr jerr;
     FILE *file_in;
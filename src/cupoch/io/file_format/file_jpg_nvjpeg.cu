@@ -0,0 +1,187 @@
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#ifdef USE_NVJPEG
+#include <nvjpeg.h>
+#endif
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/io/class_io/image_io.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+namespace io {
+
+#ifdef USE_NVJPEG
+namespace {
+
+/// nvJPEG handle and decoding state, shared by the reads of all threads.
+class NvJPEGContext {
+public:
+    static NvJPEGContext &Get() {
+        static NvJPEGContext context;
+        return context;
+    }
+    bool IsValid() const { return valid_; }
+
+public:
+    nvjpegHandle_t handle_ = nullptr;
+    nvjpegJpegState_t state_ = nullptr;
+    std::mutex mutex_;
+
+private:
+    NvJPEGContext() {
+        valid_ = nvjpegCreateSimple(&handle_) == NVJPEG_STATUS_SUCCESS &&
+                 nvjpegJpegStateCreate(handle_, &state_) ==
+                         NVJPEG_STATUS_SUCCESS;
+        if (!valid_) {
+            utility::LogWarning(
+                    "nvJPEG initialization failed, JPG images are decoded on "
+                    "the CPU.");
+        }
+    }
+    ~NvJPEGContext() {
+        if (state_) nvjpegJpegStateDestroy(state_);
+        if (handle_) nvjpegDestroy(handle_);
+    }
+    bool valid_ = false;
+};
+
+bool ReadFileData(const std::string &filename,
+                  std::vector<unsigned char> &data) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    const std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+    data.resize(size);
+    file.seekg(0, std::ios::beg);
+    return (bool)file.read((char *)data.data(), size);
+}
+
+/// Prepares \p image to the size of the JPG in \p data, with 3 channels
+/// for the color images and 1 for the gray ones. Returns false for the
+/// formats left to libjpeg, e.g. CMYK.
+bool PrepareImage(const std::vector<unsigned char> &data,
+                  geometry::Image &image) {
+    int num_of_components;
+    nvjpegChromaSubsampling_t subsampling;
+    int widths[NVJPEG_MAX_COMPONENT];
+    int heights[NVJPEG_MAX_COMPONENT];
+    if (nvjpegGetImageInfo(NvJPEGContext::Get().handle_, data.data(),
+                           data.size(), &num_of_components, &subsampling,
+                           widths, heights) != NVJPEG_STATUS_SUCCESS) {
+        return false;
+    }
+    int num_of_channels;
+    if (num_of_components == 1 || subsampling == NVJPEG_CSS_GRAY) {
+        num_of_channels = 1;
+    } else if (num_of_components == 3) {
+        num_of_channels = 3;
+    } else {
+        return false;
+    }
+    image.Prepare(widths[0], heights[0], num_of_channels, 1);
+    return true;
+}
+
+/// Interleaved output into the packed rows of \p image.
+nvjpegImage_t GetDestination(geometry::Image &image) {
+    nvjpegImage_t destination = {};
+    destination.channel[0] = thrust::raw_pointer_cast(image.data_.data());
+    destination.pitch[0] = image.BytesPerLine();
+    return destination;
+}
+
+}  // namespace
+#endif
+
+bool ReadImageFromJPGWithNvJPEG(const std::string &filename,
+                                geometry::Image &image) {
+#ifdef USE_NVJPEG
+    auto &context = NvJPEGContext::Get();
+    if (!context.IsValid()) return false;
+    std::vector<unsigned char> data;
+    if (!ReadFileData(filename, data)) return false;
+    std::lock_guard<std::mutex> lock(context.mutex_);
+    if (!PrepareImage(data, image)) return false;
+    nvjpegImage_t destination = GetDestination(image);
+    const nvjpegOutputFormat_t format = (image.num_of_channels_ == 3)
+                                                ? NVJPEG_OUTPUT_RGBI
+                                                : NVJPEG_OUTPUT_Y;
+    const bool success =
+            nvjpegDecode(context.handle_, context.state_, data.data(),
+                         data.size(), format, &destination,
+                         0) == NVJPEG_STATUS_SUCCESS;
+    // The compressed data must outlive the decoding.
+    cudaSafeCall(cudaStreamSynchronize(0));
+    if (!success) image.Clear();
+    return success;
+#else
+    return false;
+#endif
+}
+
+bool ReadImagesFromJPG(const std::vector<std::string> &filenames,
+                       std::vector<std::shared_ptr<geometry::Image>> &images) {
+    images.resize(filenames.size());
+    for (auto &image : images) image = std::make_shared<geometry::Image>();
+    std::vector<bool> decoded(filenames.size(), false);
+#ifdef USE_NVJPEG
+    auto &context = NvJPEGContext::Get();
+    if (context.IsValid()) {
+        // The color images are decoded in one batch, the others one by one
+        // below.
+        std::vector<std::vector<unsigned char>> data(filenames.size());
+        std::vector<size_t> batch;
+        std::vector<const unsigned char *> batch_data;
+        std::vector<size_t> batch_lengths;
+        std::vector<nvjpegImage_t> batch_destinations;
+        std::lock_guard<std::mutex> lock(context.mutex_);
+        for (size_t i = 0; i < filenames.size(); ++i) {
+            if (!ReadFileData(filenames[i], data[i]) ||
+                !PrepareImage(data[i], *images[i]) ||
+                images[i]->num_of_channels_ != 3) {
+                images[i]->Clear();
+                continue;
+            }
+            batch.push_back(i);
+            batch_data.push_back(data[i].data());
+            batch_lengths.push_back(data[i].size());
+            batch_destinations.push_back(GetDestination(*images[i]));
+        }
+        if (!batch.empty()) {
+            const bool success =
+                    nvjpegDecodeBatchedInitialize(
+                            context.handle_, context.state_, batch.size(), 1,
+                            NVJPEG_OUTPUT_RGBI) == NVJPEG_STATUS_SUCCESS &&
+                    nvjpegDecodeBatched(context.handle_, context.state_,
+                                        batch_data.data(),
+                                        batch_lengths.data(),
+                                        batch_destinations.data(),
+                                        0) == NVJPEG_STATUS_SUCCESS;
+            cudaSafeCall(cudaStreamSynchronize(0));
+            for (size_t i : batch) {
+                if (success) {
+                    decoded[i] = true;
+                } else {
+                    images[i]->Clear();
+                }
+            }
+        }
+    }
+#endif
+    bool success = true;
+    for (size_t i = 0; i < filenames.size(); ++i) {
+        if (decoded[i]) continue;
+        if (!ReadImageFromJPG(filenames[i], *images[i])) {
+            images[i]->Clear();
+            success = false;
+        }
+    }
+    return success;
+}
+
+}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,272 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef USE_LASZIP
+#include <laszip/laszip_api.h>
+#endif
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/file_format/point_chunk_decoder.h"
+#include "cupoch/utility/console.h"
+
+// References for LAS file IO
+// https://www.asprs.org/wp-content/uploads/2019/07/LAS_1_4_r15.pdf
+
+namespace cupoch {
+
+namespace {
+using namespace io;
+
+const char *const LAS_ATTRIBUTE_NAMES[] = {"intensity", "classification"};
+const size_t LAS_ATTRIBUTE_DIMENSION = 2;
+
+template <typename T>
+T ReadLittleEndian(const char *data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+struct LASHeader {
+    int point_format_;
+    int record_length_;
+    size_t point_data_offset_;
+    size_t points_;
+    Eigen::Vector3d scale_;
+    Eigen::Vector3d offset_;
+    bool compressed_;
+};
+
+bool ReadLASHeader(FILE *file, LASHeader &header) {
+    // Large enough for the LAS 1.4 header.
+    char data[375] = {};
+    const size_t size = fread(data, 1, sizeof(data), file);
+    if (size < 227 || memcmp(data, "LASF", 4) != 0) return false;
+    const int version_minor = (uint8_t)data[25];
+    const size_t header_size = ReadLittleEndian<uint16_t>(data + 94);
+    header.point_data_offset_ = ReadLittleEndian<uint32_t>(data + 96);
+    const uint8_t point_format = (uint8_t)data[104];
+    // LAZ files set one of the two high bits of the format.
+    header.compressed_ = (point_format & 0xc0) != 0;
+    header.point_format_ = point_format & 0x3f;
+    header.record_length_ = ReadLittleEndian<uint16_t>(data + 105);
+    header.points_ = ReadLittleEndian<uint32_t>(data + 107);
+    if (version_minor >= 4 && header_size >= 375 && size >= 375) {
+        const uint64_t points = ReadLittleEndian<uint64_t>(data + 247);
+        if (points > 0) header.points_ = points;
+    }
+    for (int i = 0; i < 3; ++i) {
+        header.scale_(i) = ReadLittleEndian<double>(data + 131 + 8 * i);
+        header.offset_(i) = ReadLittleEndian<double>(data + 155 + 8 * i);
+    }
+    return header.point_format_ <= 10;
+}
+
+/// Byte offset of the RGB channels in the records of \p point_format, or -1.
+int GetLASColorOffset(int point_format) {
+    switch (point_format) {
+        case 2:
+            return 20;
+        case 3:
+        case 5:
+            return 28;
+        case 7:
+        case 8:
+        case 10:
+            return 30;
+        default:
+            return -1;
+    }
+}
+
+void ResizeLASChunk(size_t n_points, bool has_colors, HostPointCloud &host_pc) {
+    host_pc.points_.resize(n_points);
+    host_pc.normals_.clear();
+    host_pc.colors_.resize(has_colors ? n_points : 0);
+    host_pc.attributes_.resize(n_points * LAS_ATTRIBUTE_DIMENSION);
+    host_pc.attribute_names_.assign(
+            LAS_ATTRIBUTE_NAMES, LAS_ATTRIBUTE_NAMES + LAS_ATTRIBUTE_DIMENSION);
+}
+
+class LASChunkDecoder : public PointChunkDecoder {
+public:
+    LASChunkDecoder(FILE *file, const LASHeader &header)
+        : file_(file), header_(header) {}
+    ~LASChunkDecoder() override { fclose(file_); }
+
+    size_t GetNumPoints() const override { return header_.points_; }
+    bool DecodeNext(size_t n_points, HostPointCloud &host_pc) override {
+        const size_t record_length = header_.record_length_;
+        buffer_.resize(n_points * record_length);
+        if (fread(buffer_.data(), record_length, n_points, file_) !=
+            n_points) {
+            return false;
+        }
+        const int color_offset = GetLASColorOffset(header_.point_format_);
+        // The classification has a byte of its own from format 6 on.
+        const bool extended = header_.point_format_ >= 6;
+        ResizeLASChunk(n_points, color_offset >= 0, host_pc);
+        for (size_t i = 0; i < n_points; ++i) {
+            const char *record = buffer_.data() + i * record_length;
+            const Eigen::Vector3d xyz(ReadLittleEndian<int32_t>(record),
+                                      ReadLittleEndian<int32_t>(record + 4),
+                                      ReadLittleEndian<int32_t>(record + 8));
+            host_pc.points_[i] =
+                    (xyz.cwiseProduct(header_.scale_) + header_.offset_)
+                            .cast<float>();
+            host_pc.attributes_[i * LAS_ATTRIBUTE_DIMENSION] =
+                    ReadLittleEndian<uint16_t>(record + 12);
+            host_pc.attributes_[i * LAS_ATTRIBUTE_DIMENSION + 1] =
+                    (extended) ? (uint8_t)record[16] : record[15] & 0x1f;
+            if (color_offset >= 0) {
+                const char *rgb = record + color_offset;
+                host_pc.colors_[i] =
+                        Eigen::Vector3f(ReadLittleEndian<uint16_t>(rgb),
+                                        ReadLittleEndian<uint16_t>(rgb + 2),
+                                        ReadLittleEndian<uint16_t>(rgb + 4)) /
+                        65535.0f;
+            }
+        }
+        return true;
+    }
+
+private:
+    FILE *file_;
+    LASHeader header_;
+    std::vector<char> buffer_;
+};
+
+#ifdef USE_LASZIP
+class LAZChunkDecoder : public PointChunkDecoder {
+public:
+    LAZChunkDecoder() {}
+    ~LAZChunkDecoder() override {
+        if (!reader_) return;
+        if (opened_) laszip_close_reader(reader_);
+        laszip_destroy(reader_);
+    }
+
+    bool Open(const std::string &filename) {
+        laszip_BOOL is_compressed;
+        if (laszip_create(&reader_) != 0 ||
+            laszip_open_reader(reader_, filename.c_str(), &is_compressed) !=
+                    0) {
+            return false;
+        }
+        opened_ = true;
+        laszip_header *header;
+        if (laszip_get_header_pointer(reader_, &header) != 0 ||
+            laszip_get_point_pointer(reader_, &point_) != 0) {
+            return false;
+        }
+        points_ = (header->number_of_point_records > 0)
+                          ? header->number_of_point_records
+                          : header->extended_number_of_point_records;
+        point_format_ = header->point_data_format;
+        scale_ = Eigen::Vector3d(header->x_scale_factor,
+                                 header->y_scale_factor,
+                                 header->z_scale_factor);
+        offset_ = Eigen::Vector3d(header->x_offset, header->y_offset,
+                                  header->z_offset);
+        return true;
+    }
+
+    size_t GetNumPoints() const override { return points_; }
+    bool DecodeNext(size_t n_points, HostPointCloud &host_pc) override {
+        const bool has_colors = GetLASColorOffset(point_format_) >= 0;
+        ResizeLASChunk(n_points, has_colors, host_pc);
+        for (size_t i = 0; i < n_points; ++i) {
+            if (laszip_read_point(reader_) != 0) return false;
+            const Eigen::Vector3d xyz(point_->X, point_->Y, point_->Z);
+            host_pc.points_[i] =
+                    (xyz.cwiseProduct(scale_) + offset_).cast<float>();
+            host_pc.attributes_[i * LAS_ATTRIBUTE_DIMENSION] =
+                    point_->intensity;
+            host_pc.attributes_[i * LAS_ATTRIBUTE_DIMENSION + 1] =
+                    (point_format_ >= 6) ? point_->extended_classification
+                                         : point_->classification;
+            if (has_colors) {
+                host_pc.colors_[i] = Eigen::Vector3f(point_->rgb[0],
+                                                     point_->rgb[1],
+                                                     point_->rgb[2]) /
+                                     65535.0f;
+            }
+        }
+        return true;
+    }
+
+private:
+    laszip_POINTER reader_ = nullptr;
+    bool opened_ = false;
+    laszip_point *point_ = nullptr;
+    size_t points_ = 0;
+    int point_format_ = 0;
+    Eigen::Vector3d scale_;
+    Eigen::Vector3d offset_;
+};
+#endif
+
+}  // unnamed namespace
+
+namespace io {
+
+std::unique_ptr<PointChunkDecoder> CreateLASChunkDecoder(
+        const std::string &filename) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL) {
+        utility::LogWarning("Read LAS failed: unable to open file: {}",
+                            filename);
+        return nullptr;
+    }
+    LASHeader header;
+    if (!ReadLASHeader(file, header)) {
+        utility::LogWarning("Read LAS failed: unable to parse header.");
+        fclose(file);
+        return nullptr;
+    }
+    if (header.compressed_) {
+        fclose(file);
+#ifdef USE_LASZIP
+        std::unique_ptr<LAZChunkDecoder> decoder(new LAZChunkDecoder());
+        if (!decoder->Open(filename)) {
+            utility::LogWarning("Read LAZ failed: unable to open file: {}",
+                                filename);
+            return nullptr;
+        }
+        return decoder;
+#else
+        utility::LogWarning(
+                "Read LAZ failed: cupoch is built without LASzip, only "
+                "uncompressed LAS files can be read.");
+        return nullptr;
+#endif
+    }
+    if (fseek(file, header.point_data_offset_, SEEK_SET) != 0) {
+        utility::LogWarning("Read LAS failed: unable to read data.");
+        fclose(file);
+        return nullptr;
+    }
+    return std::unique_ptr<PointChunkDecoder>(
+            new LASChunkDecoder(file, header));
+}
+
+bool ReadPointCloudFromLAS(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress) {
+    std::unique_ptr<PointChunkDecoder> decoder =
+            CreateLASChunkDecoder(filename);
+    if (!decoder) return false;
+    HostPointCloud host_pc;
+    if (!decoder->DecodeNext(decoder->GetNumPoints(), host_pc)) {
+        utility::LogWarning("Read LAS failed: unable to read data.");
+        return false;
+    }
+    host_pc.ToDevice(pointcloud);
+    return true;
+}
+
+}  // namespace io
+}  // namespace cupoch
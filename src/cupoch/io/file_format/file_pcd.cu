@@ -1,12 +1,15 @@
 #include <lzf.h>
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <sstream>
 
 #include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/file_format/ascii_records.h"
+#include "cupoch/io/file_format/packed_records.h"
+#include "cupoch/io/file_format/point_chunk_decoder.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/utility/console.h"
-#include "cupoch/utility/filesystem.h"
 #include "cupoch/utility/helper.h"
 
 // References for PCD file IO
@@ -307,6 +310,81 @@ Eigen::Vector3f UnpackASCIIPCDColor(const char *data_ptr,
     }
 }
 
+void UnpackASCIIPCDRecord(const std::vector<std::string> &strs,
+                          const PCDHeader &header,
+                          int idx,
+                          HostPointCloud &host_pc) {
+    for (size_t i = 0; i < header.fields.size(); i++) {
+        const auto &field = header.fields[i];
+        if (field.name == "x") {
+            host_pc.points_[idx](0) = UnpackASCIIPCDElement(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        } else if (field.name == "y") {
+            host_pc.points_[idx](1) = UnpackASCIIPCDElement(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        } else if (field.name == "z") {
+            host_pc.points_[idx](2) = UnpackASCIIPCDElement(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        } else if (field.name == "normal_x") {
+            host_pc.normals_[idx](0) = UnpackASCIIPCDElement(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        } else if (field.name == "normal_y") {
+            host_pc.normals_[idx](1) = UnpackASCIIPCDElement(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        } else if (field.name == "normal_z") {
+            host_pc.normals_[idx](2) = UnpackASCIIPCDElement(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        } else if (field.name == "rgb" || field.name == "rgba") {
+            host_pc.colors_[idx] = UnpackASCIIPCDColor(
+                    strs[field.count_offset].c_str(), field.type,
+                    field.size);
+        }
+    }
+}
+
+void UnpackBinaryPCDRecord(const char *record,
+                           const PCDHeader &header,
+                           int idx,
+                           HostPointCloud &host_pc) {
+    for (const auto &field : header.fields) {
+        if (field.name == "x") {
+            host_pc.points_[idx](0) =
+                    UnpackBinaryPCDElement(record + field.offset,
+                                           field.type, field.size);
+        } else if (field.name == "y") {
+            host_pc.points_[idx](1) =
+                    UnpackBinaryPCDElement(record + field.offset,
+                                           field.type, field.size);
+        } else if (field.name == "z") {
+            host_pc.points_[idx](2) =
+                    UnpackBinaryPCDElement(record + field.offset,
+                                           field.type, field.size);
+        } else if (field.name == "normal_x") {
+            host_pc.normals_[idx](0) =
+                    UnpackBinaryPCDElement(record + field.offset,
+                                           field.type, field.size);
+        } else if (field.name == "normal_y") {
+            host_pc.normals_[idx](1) =
+                    UnpackBinaryPCDElement(record + field.offset,
+                                           field.type, field.size);
+        } else if (field.name == "normal_z") {
+            host_pc.normals_[idx](2) =
+                    UnpackBinaryPCDElement(record + field.offset,
+                                           field.type, field.size);
+        } else if (field.name == "rgb" || field.name == "rgba") {
+            host_pc.colors_[idx] =
+                    UnpackBinaryPCDColor(record + field.offset,
+                                         field.type, field.size);
+        }
+    }
+}
+
 bool ReadPCDData(FILE *file,
                  const PCDHeader &header,
                  geometry::PointCloud &pointcloud) {
@@ -336,38 +414,7 @@ bool ReadPCDData(FILE *file,
             if ((int)strs.size() < header.elementnum) {
                 continue;
             }
-            for (size_t i = 0; i < header.fields.size(); i++) {
-                const auto &field = header.fields[i];
-                if (field.name == "x") {
-                    host_pc.points_[idx](0) = UnpackASCIIPCDElement(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                } else if (field.name == "y") {
-                    host_pc.points_[idx](1) = UnpackASCIIPCDElement(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                } else if (field.name == "z") {
-                    host_pc.points_[idx](2) = UnpackASCIIPCDElement(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                } else if (field.name == "normal_x") {
-                    host_pc.normals_[idx](0) = UnpackASCIIPCDElement(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                } else if (field.name == "normal_y") {
-                    host_pc.normals_[idx](1) = UnpackASCIIPCDElement(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                } else if (field.name == "normal_z") {
-                    host_pc.normals_[idx](2) = UnpackASCIIPCDElement(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                } else if (field.name == "rgb" || field.name == "rgba") {
-                    host_pc.colors_[idx] = UnpackASCIIPCDColor(
-                            strs[field.count_offset].c_str(), field.type,
-                            field.size);
-                }
-            }
+            UnpackASCIIPCDRecord(strs, header, idx, host_pc);
             idx++;
         }
     } else if (header.datatype == PCD_DATA_BINARY) {
@@ -379,37 +426,7 @@ bool ReadPCDData(FILE *file,
                 pointcloud.Clear();
                 return false;
             }
-            for (const auto &field : header.fields) {
-                if (field.name == "x") {
-                    host_pc.points_[i](0) =
-                            UnpackBinaryPCDElement(buffer.get() + field.offset,
-                                                   field.type, field.size);
-                } else if (field.name == "y") {
-                    host_pc.points_[i](1) =
-                            UnpackBinaryPCDElement(buffer.get() + field.offset,
-                                                   field.type, field.size);
-                } else if (field.name == "z") {
-                    host_pc.points_[i](2) =
-                            UnpackBinaryPCDElement(buffer.get() + field.offset,
-                                                   field.type, field.size);
-                } else if (field.name == "normal_x") {
-                    host_pc.normals_[i](0) =
-                            UnpackBinaryPCDElement(buffer.get() + field.offset,
-                                                   field.type, field.size);
-                } else if (field.name == "normal_y") {
-                    host_pc.normals_[i](1) =
-                            UnpackBinaryPCDElement(buffer.get() + field.offset,
-                                                   field.type, field.size);
-                } else if (field.name == "normal_z") {
-                    host_pc.normals_[i](2) =
-                            UnpackBinaryPCDElement(buffer.get() + field.offset,
-                                                   field.type, field.size);
-                } else if (field.name == "rgb" || field.name == "rgba") {
-                    host_pc.colors_[i] =
-                            UnpackBinaryPCDColor(buffer.get() + field.offset,
-                                                 field.type, field.size);
-                }
-            }
+            UnpackBinaryPCDRecord(buffer.get(), header, i, host_pc);
         }
     } else if (header.datatype == PCD_DATA_BINARY_COMPRESSED) {
         std::uint32_t compressed_size;
@@ -496,15 +513,15 @@ bool ReadPCDData(FILE *file,
     return true;
 }
 
-bool GenerateHeader(const geometry::PointCloud &pointcloud,
+bool GenerateHeader(const HostPointCloud &host_pc,
                     const bool write_ascii,
                     const bool compressed,
                     PCDHeader &header) {
-    if (pointcloud.HasPoints() == false) {
+    if (host_pc.points_.empty()) {
         return false;
     }
     header.version = "0.7";
-    header.width = (int)pointcloud.points_.size();
+    header.width = (int)host_pc.points_.size();
     header.height = 1;
     header.points = header.width;
     header.fields.clear();
@@ -520,7 +537,9 @@ bool GenerateHeader(const geometry::PointCloud &pointcloud,
     header.fields.push_back(field);
     header.elementnum = 3;
     header.pointsize = 12;
-    if (pointcloud.HasNormals()) {
+    header.has_normals = host_pc.normals_.size() == host_pc.points_.size();
+    header.has_colors = host_pc.colors_.size() == host_pc.points_.size();
+    if (header.has_normals) {
         field.name = "normal_x";
         header.fields.push_back(field);
         field.name = "normal_y";
@@ -530,7 +549,7 @@ bool GenerateHeader(const geometry::PointCloud &pointcloud,
         header.elementnum += 3;
         header.pointsize += 12;
     }
-    if (pointcloud.HasColors()) {
+    if (header.has_colors) {
         field.name = "rgb";
         header.fields.push_back(field);
         header.elementnum++;
@@ -604,11 +623,9 @@ float ConvertRGBToFloat(const Eigen::Vector3f &color) {
 
 bool WritePCDData(FILE *file,
                   const PCDHeader &header,
-                  const geometry::PointCloud &pointcloud) {
-    bool has_normal = pointcloud.HasNormals();
-    bool has_color = pointcloud.HasColors();
-    HostPointCloud host_pc;
-    host_pc.FromDevice(pointcloud);
+                  const HostPointCloud &host_pc) {
+    bool has_normal = header.has_normals;
+    bool has_color = header.has_colors;
     if (header.datatype == PCD_DATA_ASCII) {
         for (size_t i = 0; i < host_pc.points_.size(); i++) {
             const auto &point = host_pc.points_[i];
@@ -687,6 +704,205 @@ bool WritePCDData(FILE *file,
     return true;
 }
 
+// Decodes the next n_points records of an uncompressed PCD file.
+bool ReadPCDChunk(FILE *file,
+                  const PCDHeader &header,
+                  int n_points,
+                  HostPointCloud &host_pc) {
+    host_pc.points_.resize(n_points);
+    host_pc.normals_.resize(header.has_normals ? n_points : 0);
+    host_pc.colors_.resize(header.has_colors ? n_points : 0);
+    if (header.datatype == PCD_DATA_ASCII) {
+        char line_buffer[DEFAULT_IO_BUFFER_SIZE];
+        int idx = 0;
+        while (idx < n_points &&
+               fgets(line_buffer, DEFAULT_IO_BUFFER_SIZE, file)) {
+            std::string line(line_buffer);
+            std::vector<std::string> strs;
+            utility::SplitString(strs, line, "\t\r\n ");
+            if ((int)strs.size() < header.elementnum) {
+                continue;
+            }
+            UnpackASCIIPCDRecord(strs, header, idx, host_pc);
+            idx++;
+        }
+        return idx == n_points;
+    } else if (header.datatype == PCD_DATA_BINARY) {
+        std::unique_ptr<char[]> buffer(
+                new char[(size_t)n_points * header.pointsize]);
+        if (fread(buffer.get(), header.pointsize, n_points, file) !=
+            (size_t)n_points) {
+            return false;
+        }
+        for (int i = 0; i < n_points; i++) {
+            UnpackBinaryPCDRecord(buffer.get() + (size_t)i * header.pointsize,
+                                  header, i, host_pc);
+        }
+        return true;
+    }
+    return false;
+}
+
+class PCDChunkDecoder : public PointChunkDecoder {
+public:
+    explicit PCDChunkDecoder(FILE *file) : file_(file) {}
+    ~PCDChunkDecoder() override { fclose(file_); }
+
+    size_t GetNumPoints() const override { return header_.points; }
+    bool DecodeNext(size_t n_points, HostPointCloud &host_pc) override {
+        return ReadPCDChunk(file_, header_, (int)n_points, host_pc);
+    }
+
+    FILE *file_;
+    PCDHeader header_;
+};
+
+// Layout of the point records of a binary PCD file. Binary data store the
+// records one after the other, binary_compressed data store every field of
+// all the points one after the other.
+PackedRecordLayout MakePCDRecordLayout(const PCDHeader &header) {
+    PackedRecordLayout layout;
+    for (const auto &field : header.fields) {
+        PackedField packed;
+        packed.type_ = field.type;
+        packed.size_ = field.size;
+        if (header.datatype == PCD_DATA_BINARY_COMPRESSED) {
+            packed.offset_ = (size_t)field.offset * header.points;
+            packed.stride_ = field.size * field.count;
+        } else {
+            packed.offset_ = field.offset;
+            packed.stride_ = header.pointsize;
+        }
+        if (field.name == "x") {
+            layout.fields_[PackedRecordLayout::X] = packed;
+        } else if (field.name == "y") {
+            layout.fields_[PackedRecordLayout::Y] = packed;
+        } else if (field.name == "z") {
+            layout.fields_[PackedRecordLayout::Z] = packed;
+        } else if (field.name == "normal_x") {
+            layout.fields_[PackedRecordLayout::NormalX] = packed;
+        } else if (field.name == "normal_y") {
+            layout.fields_[PackedRecordLayout::NormalY] = packed;
+        } else if (field.name == "normal_z") {
+            layout.fields_[PackedRecordLayout::NormalZ] = packed;
+        } else if (field.name == "rgb" || field.name == "rgba") {
+            layout.fields_[PackedRecordLayout::Red] = packed;
+            layout.packed_color_ = true;
+        }
+    }
+    return layout;
+}
+
+// Reads the binary or binary_compressed data starting at data_offset of the
+// mapped file. The records are uploaded as they are and decoded on the
+// device.
+bool ReadMappedPCDData(const MappedFile &mapped,
+                       size_t data_offset,
+                       const PCDHeader &header,
+                       geometry::PointCloud &pointcloud) {
+    if (!header.has_points) {
+        utility::LogWarning(
+                "[ReadPCDData] Fields for point data are not complete.\n");
+        return false;
+    }
+    const size_t n_bytes = (size_t)header.points * header.pointsize;
+    const PackedRecordLayout layout = MakePCDRecordLayout(header);
+    const char *data = mapped.GetData() + data_offset;
+    const size_t size = mapped.GetSize() - std::min(data_offset,
+                                                    mapped.GetSize());
+    if (header.datatype == PCD_DATA_BINARY) {
+        if (size < n_bytes) {
+            utility::LogWarning("[ReadPCDData] Failed to read data record.\n");
+            pointcloud.Clear();
+            return false;
+        }
+        return ReadPackedRecords(data, n_bytes, header.points, layout,
+                                 pointcloud);
+    } else if (header.datatype == PCD_DATA_BINARY_COMPRESSED) {
+        std::uint32_t compressed_size;
+        std::uint32_t uncompressed_size;
+        if (size < sizeof(compressed_size) + sizeof(uncompressed_size)) {
+            utility::LogWarning("[ReadPCDData] Failed to read data record.\n");
+            pointcloud.Clear();
+            return false;
+        }
+        memcpy(&compressed_size, data, sizeof(compressed_size));
+        memcpy(&uncompressed_size, data + sizeof(compressed_size),
+               sizeof(uncompressed_size));
+        data += sizeof(compressed_size) + sizeof(uncompressed_size);
+        if (size - sizeof(compressed_size) - sizeof(uncompressed_size) <
+                    compressed_size ||
+            uncompressed_size < n_bytes) {
+            utility::LogWarning("[ReadPCDData] Failed to read data record.\n");
+            pointcloud.Clear();
+            return false;
+        }
+        // Decompressed on the device, the records never come back to the
+        // host.
+        utility::device_vector<char> buffer;
+        if (!DecompressLZF(data, compressed_size, uncompressed_size, buffer)) {
+            utility::LogWarning("[ReadPCDData] Uncompression failed.\n");
+            pointcloud.Clear();
+            return false;
+        }
+        return DeinterleavePackedRecords(buffer, header.points, layout,
+                                         pointcloud);
+    }
+    return false;
+}
+
+// Columns of the point records of an ASCII PCD file.
+AsciiRecordLayout MakePCDAsciiLayout(const PCDHeader &header) {
+    AsciiRecordLayout layout;
+    for (const auto &field : header.fields) {
+        AsciiField ascii;
+        ascii.column_ = field.count_offset;
+        ascii.type_ = field.type;
+        if (field.name == "x") {
+            layout.fields_[PackedRecordLayout::X] = ascii;
+        } else if (field.name == "y") {
+            layout.fields_[PackedRecordLayout::Y] = ascii;
+        } else if (field.name == "z") {
+            layout.fields_[PackedRecordLayout::Z] = ascii;
+        } else if (field.name == "normal_x") {
+            layout.fields_[PackedRecordLayout::NormalX] = ascii;
+        } else if (field.name == "normal_y") {
+            layout.fields_[PackedRecordLayout::NormalY] = ascii;
+        } else if (field.name == "normal_z") {
+            layout.fields_[PackedRecordLayout::NormalZ] = ascii;
+        } else if ((field.name == "rgb" || field.name == "rgba") &&
+                   field.size == 4) {
+            layout.fields_[PackedRecordLayout::Red] = ascii;
+            layout.packed_color_ = true;
+        }
+    }
+    return layout;
+}
+
+// Parses the ASCII data starting at data_offset of the mapped file on
+// several threads. Returns false for the files left to ReadPCDData, with
+// missing records or malformed rows.
+bool ReadMappedAsciiPCDData(const MappedFile &mapped,
+                            size_t data_offset,
+                            const PCDHeader &header,
+                            geometry::PointCloud &pointcloud) {
+    const AsciiRecordLayout layout = MakePCDAsciiLayout(header);
+    if (!header.has_points || data_offset > mapped.GetSize() ||
+        layout.HasNormals() != header.has_normals ||
+        layout.HasColors() != header.has_colors) {
+        return false;
+    }
+    HostPointCloud host_pc;
+    if (!ReadAsciiRecords(mapped.GetData() + data_offset,
+                          mapped.GetSize() - data_offset, header.points,
+                          layout, host_pc) ||
+        host_pc.points_.size() != (size_t)header.points) {
+        return false;
+    }
+    host_pc.ToDevice(pointcloud);
+    return true;
+}
+
 }  // unnamed namespace
 
 namespace io {
@@ -719,6 +935,26 @@ bool ReadPointCloudFromPCD(const std::string &filename,
                       header.has_points ? "yes" : "no",
                       header.has_normals ? "yes" : "no",
                       header.has_colors ? "yes" : "no");
+    if (header.datatype != PCD_DATA_ASCII) {
+        MappedFile mapped;
+        if (mapped.Open(filename)) {
+            const bool success =
+                    ReadMappedPCDData(mapped, ftell(file), header, pointcloud);
+            fclose(file);
+            if (!success) {
+                utility::LogWarning("Read PCD failed: unable to read data.\n");
+            }
+            return success;
+        }
+    }
+    if (header.datatype == PCD_DATA_ASCII) {
+        MappedFile mapped;
+        if (mapped.Open(filename) &&
+            ReadMappedAsciiPCDData(mapped, ftell(file), header, pointcloud)) {
+            fclose(file);
+            return true;
+        }
+    }
     if (ReadPCDData(file, header, pointcloud) == false) {
         utility::LogWarning("Read PCD failed: unable to read data.\n");
         fclose(file);
@@ -728,13 +964,13 @@ bool ReadPointCloudFromPCD(const std::string &filename,
     return true;
 }
 
-bool WritePointCloudToPCD(const std::string &filename,
-                          const geometry::PointCloud &pointcloud,
-                          bool write_ascii /* = false*/,
-                          bool compressed /* = false*/,
-                          bool print_progress) {
+bool WriteHostPointCloudToPCD(const std::string &filename,
+                              const HostPointCloud &host_pc,
+                              bool write_ascii /* = false*/,
+                              bool compressed /* = false*/,
+                              bool print_progress) {
     PCDHeader header;
-    if (GenerateHeader(pointcloud, write_ascii, compressed, header) == false) {
+    if (GenerateHeader(host_pc, write_ascii, compressed, header) == false) {
         utility::LogWarning("Write PCD failed: unable to generate header.\n");
         return false;
     }
@@ -748,7 +984,7 @@ bool WritePointCloudToPCD(const std::string &filename,
         fclose(file);
         return false;
     }
-    if (WritePCDData(file, header, pointcloud) == false) {
+    if (WritePCDData(file, header, host_pc) == false) {
         utility::LogWarning("Write PCD failed: unable to write data.\n");
         fclose(file);
         return false;
@@ -757,5 +993,40 @@ bool WritePointCloudToPCD(const std::string &filename,
     return true;
 }
 
+bool WritePointCloudToPCD(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii /* = false*/,
+                          bool compressed /* = false*/,
+                          bool print_progress) {
+    HostPointCloud host_pc;
+    host_pc.FromDevice(pointcloud);
+    return WriteHostPointCloudToPCD(filename, host_pc, write_ascii, compressed,
+                                    print_progress);
+}
+
+std::unique_ptr<PointChunkDecoder> CreatePCDChunkDecoder(
+        const std::string &filename) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL) {
+        utility::LogWarning(
+                "[PointCloudStreamReader] Unable to open file: {}\n",
+                filename);
+        return nullptr;
+    }
+    std::unique_ptr<PCDChunkDecoder> decoder(new PCDChunkDecoder(file));
+    if (ReadPCDHeader(file, decoder->header_) == false) {
+        utility::LogWarning(
+                "[PointCloudStreamReader] Unable to parse header.\n");
+        return nullptr;
+    }
+    if (decoder->header_.datatype == PCD_DATA_BINARY_COMPRESSED) {
+        utility::LogWarning(
+                "[PointCloudStreamReader] Compressed PCD can not be "
+                "streamed.\n");
+        return nullptr;
+    }
+    return decoder;
+}
+
 }  // namespace io
-}  // namespace cupoch
\ No newline at end of file
+}  // namespace cupoch
@@ -1,10 +1,17 @@
 #include <rply.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/io/class_io/pointcloud_io.h"
 #include "cupoch/io/class_io/trianglemesh_io.h"
 #include "cupoch/io/class_io/voxelgrid_io.h"
+#include "cupoch/io/file_format/ascii_records.h"
+#include "cupoch/io/file_format/packed_records.h"
 #include "cupoch/utility/console.h"
 
 namespace cupoch {
@@ -78,6 +85,160 @@ int ReadColorCallback(p_ply_argument argument) {
     return 1;
 }
 
+bool GetPLYPropertyType(const std::string &name, char &type, int &size) {
+    if (name == "char" || name == "int8") {
+        type = 'I';
+        size = 1;
+    } else if (name == "uchar" || name == "uint8") {
+        type = 'U';
+        size = 1;
+    } else if (name == "short" || name == "int16") {
+        type = 'I';
+        size = 2;
+    } else if (name == "ushort" || name == "uint16") {
+        type = 'U';
+        size = 2;
+    } else if (name == "int" || name == "int32") {
+        type = 'I';
+        size = 4;
+    } else if (name == "uint" || name == "uint32") {
+        type = 'U';
+        size = 4;
+    } else if (name == "float" || name == "float32") {
+        type = 'F';
+        size = 4;
+    } else if (name == "double" || name == "float64") {
+        type = 'F';
+        size = 8;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Parses the header of a binary little endian PLY file for the fast path.
+// Returns false for the files that have to go through rply: other formats,
+// list properties in or before the vertex element.
+bool ParseBinaryPLYHeader(const MappedFile &mapped,
+                          size_t &data_offset,
+                          size_t &vertex_num,
+                          PackedRecordLayout &layout) {
+    const char *begin = mapped.GetData();
+    const char *end = begin + mapped.GetSize();
+    const char end_header[] = "end_header";
+    const char *header_end =
+            std::search(begin, end, end_header, end_header + 10);
+    if (header_end == end) return false;
+    header_end = std::find(header_end, end, '\n');
+    if (header_end == end) return false;
+    data_offset = header_end + 1 - begin;
+
+    std::istringstream header(std::string(begin, header_end));
+    std::string line;
+    bool binary_little_endian = false;
+    bool in_vertex = false;
+    bool found_vertex = false;
+    size_t element_num = 0;
+    size_t record_size = 0;
+    while (std::getline(header, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            words >> format;
+            binary_little_endian = (format == "binary_little_endian");
+        } else if (keyword == "element") {
+            if (in_vertex) break;
+            // Fixed size elements before the vertices are skipped.
+            data_offset += element_num * record_size;
+            std::string name;
+            words >> name >> element_num;
+            record_size = 0;
+            in_vertex = (name == "vertex");
+            found_vertex = found_vertex || in_vertex;
+        } else if (keyword == "property") {
+            std::string type_name, name;
+            words >> type_name >> name;
+            PackedField field;
+            if (!GetPLYPropertyType(type_name, field.type_, field.size_)) {
+                return false;
+            }
+            field.offset_ = record_size;
+            record_size += field.size_;
+            if (!in_vertex) continue;
+            const char *names[] = {"x",  "y",   "z",     "nx",  "ny",
+                                   "nz", "red", "green", "blue"};
+            for (int i = 0; i < PackedRecordLayout::NumChannels; ++i) {
+                if (name == names[i]) layout.fields_[i] = field;
+            }
+        }
+    }
+    if (!binary_little_endian || !found_vertex || !layout.HasPoints()) {
+        return false;
+    }
+    for (auto &field : layout.fields_) field.stride_ = record_size;
+    vertex_num = element_num;
+    return data_offset + vertex_num * record_size <= mapped.GetSize();
+}
+
+// Parses the header of an ASCII PLY file for the parallel parser. Returns
+// false for the files that have to go through rply: other formats, vertex
+// element after another element or with list properties.
+bool ParseAsciiPLYHeader(const MappedFile &mapped,
+                         size_t &data_offset,
+                         size_t &vertex_num,
+                         AsciiRecordLayout &layout) {
+    const char *begin = mapped.GetData();
+    const char *end = begin + mapped.GetSize();
+    const char end_header[] = "end_header";
+    const char *header_end =
+            std::search(begin, end, end_header, end_header + 10);
+    if (header_end == end) return false;
+    header_end = std::find(header_end, end, '\n');
+    if (header_end == end) return false;
+    data_offset = header_end + 1 - begin;
+
+    std::istringstream header(std::string(begin, header_end));
+    std::string line;
+    bool ascii = false;
+    bool in_vertex = false;
+    bool found_vertex = false;
+    int column = 0;
+    while (std::getline(header, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            words >> format;
+            ascii = (format == "ascii");
+        } else if (keyword == "element") {
+            // The rows of the vertices have to come first.
+            if (found_vertex) break;
+            std::string name;
+            words >> name >> vertex_num;
+            if (name != "vertex") return false;
+            in_vertex = found_vertex = true;
+        } else if (keyword == "property" && in_vertex) {
+            std::string type_name, name;
+            words >> type_name >> name;
+            AsciiField field;
+            int size;
+            if (!GetPLYPropertyType(type_name, field.type_, size)) {
+                return false;
+            }
+            field.column_ = column++;
+            const char *names[] = {"x",  "y",   "z",     "nx",  "ny",
+                                   "nz", "red", "green", "blue"};
+            for (int i = 0; i < PackedRecordLayout::NumChannels; ++i) {
+                if (name == names[i]) layout.fields_[i] = field;
+            }
+        }
+    }
+    return ascii && found_vertex && layout.HasPoints();
+}
+
 }  // namespace ply_pointcloud_reader
 
 namespace ply_trianglemesh_reader {
@@ -265,6 +426,42 @@ bool ReadPointCloudFromPLY(const std::string &filename,
                            bool print_progress) {
     using namespace ply_pointcloud_reader;
 
+    {
+        // Binary little endian vertices are uploaded as they are and
+        // decoded on the device, the other files go through rply.
+        MappedFile mapped;
+        size_t data_offset, vertex_num;
+        PackedRecordLayout layout;
+        if (mapped.Open(filename) &&
+            ParseBinaryPLYHeader(mapped, data_offset, vertex_num, layout)) {
+            if (vertex_num == 0) {
+                utility::LogWarning("Read PLY failed: number of vertex <= 0.");
+                return false;
+            }
+            return ReadPackedRecords(
+                    mapped.GetData() + data_offset,
+                    vertex_num * layout.fields_[PackedRecordLayout::X].stride_,
+                    vertex_num, layout, pointcloud);
+        }
+        // ASCII vertices are parsed by several threads.
+        AsciiRecordLayout ascii_layout;
+        HostPointCloud host_pc;
+        if (mapped.GetData() &&
+            ParseAsciiPLYHeader(mapped, data_offset, vertex_num,
+                                ascii_layout) &&
+            ReadAsciiRecords(mapped.GetData() + data_offset,
+                             mapped.GetSize() - data_offset, vertex_num,
+                             ascii_layout, host_pc) &&
+            host_pc.points_.size() == vertex_num) {
+            if (vertex_num == 0) {
+                utility::LogWarning("Read PLY failed: number of vertex <= 0.");
+                return false;
+            }
+            host_pc.ToDevice(pointcloud);
+            return true;
+        }
+    }
+
     p_ply ply_file = ply_open(filename.c_str(), NULL, 0, NULL);
     if (!ply_file) {
         utility::LogWarning("Read PLY failed: unable to open file: %s",
@@ -327,12 +524,16 @@ bool ReadPointCloudFromPLY(const std::string &filename,
     return true;
 }
 
-bool WritePointCloudToPLY(const std::string &filename,
-                          const geometry::PointCloud &pointcloud,
-                          bool write_ascii /* = false*/,
-                          bool compressed /* = false*/,
-                          bool print_progress) {
-    if (pointcloud.IsEmpty()) {
+bool WriteHostPointCloudToPLY(const std::string &filename,
+                              const HostPointCloud &host_pc,
+                              bool write_ascii /* = false*/,
+                              bool compressed /* = false*/,
+                              bool print_progress) {
+    const bool has_normals = !host_pc.points_.empty() &&
+                             host_pc.normals_.size() == host_pc.points_.size();
+    const bool has_colors = !host_pc.points_.empty() &&
+                            host_pc.colors_.size() == host_pc.points_.size();
+    if (host_pc.points_.empty()) {
         utility::LogWarning("Write PLY failed: point cloud has 0 points.");
         return false;
     }
@@ -347,16 +548,16 @@ bool WritePointCloudToPLY(const std::string &filename,
     }
     ply_add_comment(ply_file, "Created by Cupoch");
     ply_add_element(ply_file, "vertex",
-                    static_cast<long>(pointcloud.points_.size()));
+                    static_cast<long>(host_pc.points_.size()));
     ply_add_property(ply_file, "x", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
     ply_add_property(ply_file, "y", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
     ply_add_property(ply_file, "z", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
-    if (pointcloud.HasNormals()) {
+    if (has_normals) {
         ply_add_property(ply_file, "nx", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
         ply_add_property(ply_file, "ny", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
         ply_add_property(ply_file, "nz", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
     }
-    if (pointcloud.HasColors()) {
+    if (has_colors) {
         ply_add_property(ply_file, "red", PLY_UCHAR, PLY_UCHAR, PLY_UCHAR);
         ply_add_property(ply_file, "green", PLY_UCHAR, PLY_UCHAR, PLY_UCHAR);
         ply_add_property(ply_file, "blue", PLY_UCHAR, PLY_UCHAR, PLY_UCHAR);
@@ -368,24 +569,22 @@ bool WritePointCloudToPLY(const std::string &filename,
     }
 
     utility::ConsoleProgressBar progress_bar(
-            static_cast<size_t>(pointcloud.points_.size()),
+            static_cast<size_t>(host_pc.points_.size()),
             "Writing PLY: ", print_progress);
 
     bool printed_color_warning = false;
-    HostPointCloud host_pc;
-    host_pc.FromDevice(pointcloud);
-    for (size_t i = 0; i < pointcloud.points_.size(); i++) {
+    for (size_t i = 0; i < host_pc.points_.size(); i++) {
         const Eigen::Vector3f &point = host_pc.points_[i];
         ply_write(ply_file, point(0));
         ply_write(ply_file, point(1));
         ply_write(ply_file, point(2));
-        if (pointcloud.HasNormals()) {
+        if (has_normals) {
             const Eigen::Vector3f &normal = host_pc.normals_[i];
             ply_write(ply_file, normal(0));
             ply_write(ply_file, normal(1));
             ply_write(ply_file, normal(2));
         }
-        if (pointcloud.HasColors()) {
+        if (has_colors) {
             const Eigen::Vector3f &color = host_pc.colors_[i];
             if (!printed_color_warning &&
                 (color(0) < 0 || color(0) > 1 || color(1) < 0 || color(1) > 1 ||
@@ -408,6 +607,17 @@ bool WritePointCloudToPLY(const std::string &filename,
     return true;
 }
 
+bool WritePointCloudToPLY(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii /* = false*/,
+                          bool compressed /* = false*/,
+                          bool print_progress) {
+    HostPointCloud host_pc;
+    host_pc.FromDevice(pointcloud);
+    return WriteHostPointCloudToPLY(filename, host_pc, write_ascii, compressed,
+                                    print_progress);
+}
+
 bool ReadTriangleMeshFromPLY(const std::string &filename,
                              geometry::TriangleMesh &mesh,
                              bool print_progress) {
@@ -482,21 +692,24 @@ bool ReadTriangleMeshFromPLY(const std::string &filename,
     return true;
 }
 
-bool WriteTriangleMeshToPLY(const std::string &filename,
-                            const geometry::TriangleMesh &mesh,
-                            bool write_ascii /* = false*/,
-                            bool compressed /* = false*/,
-                            bool write_vertex_normals /* = true*/,
-                            bool write_vertex_colors /* = true*/,
-                            bool write_triangle_uvs /* = true*/,
-                            bool print_progress) {
-    if (write_triangle_uvs && mesh.HasTriangleUvs()) {
+bool WriteHostTriangleMeshToPLY(const std::string &filename,
+                                const HostTriangleMesh &host_mesh,
+                                bool write_ascii /* = false*/,
+                                bool compressed /* = false*/,
+                                bool write_vertex_normals /* = true*/,
+                                bool write_vertex_colors /* = true*/,
+                                bool write_triangle_uvs /* = true*/,
+                                bool print_progress) {
+    const size_t n_vertices = host_mesh.vertices_.size();
+    const size_t n_triangles = host_mesh.triangles_.size();
+    if (write_triangle_uvs && n_triangles > 0 &&
+        host_mesh.triangle_uvs_.size() == 3 * n_triangles) {
         utility::LogWarning(
                 "This file format currently does not support writing textures "
                 "and uv coordinates. Consider using .obj");
     }
 
-    if (mesh.IsEmpty()) {
+    if (n_vertices == 0) {
         utility::LogWarning("Write PLY failed: mesh has 0 vertices.");
         return false;
     }
@@ -510,12 +723,14 @@ bool WriteTriangleMeshToPLY(const std::string &filename,
         return false;
     }
 
-    write_vertex_normals = write_vertex_normals && mesh.HasVertexNormals();
-    write_vertex_colors = write_vertex_colors && mesh.HasVertexColors();
+    write_vertex_normals = write_vertex_normals &&
+                           host_mesh.vertex_normals_.size() == n_vertices;
+    write_vertex_colors = write_vertex_colors &&
+                          host_mesh.vertex_colors_.size() == n_vertices;
 
     ply_add_comment(ply_file, "Created by Open3D");
     ply_add_element(ply_file, "vertex",
-                    static_cast<long>(mesh.vertices_.size()));
+                    static_cast<long>(n_vertices));
     ply_add_property(ply_file, "x", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
     ply_add_property(ply_file, "y", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
     ply_add_property(ply_file, "z", PLY_DOUBLE, PLY_DOUBLE, PLY_DOUBLE);
@@ -530,7 +745,7 @@ bool WriteTriangleMeshToPLY(const std::string &filename,
         ply_add_property(ply_file, "blue", PLY_UCHAR, PLY_UCHAR, PLY_UCHAR);
     }
     ply_add_element(ply_file, "face",
-                    static_cast<long>(mesh.triangles_.size()));
+                    static_cast<long>(n_triangles));
     ply_add_property(ply_file, "vertex_indices", PLY_LIST, PLY_UCHAR, PLY_UINT);
     if (!ply_write_header(ply_file)) {
         utility::LogWarning("Write PLY failed: unable to write header.");
@@ -539,12 +754,10 @@ bool WriteTriangleMeshToPLY(const std::string &filename,
     }
 
     utility::ConsoleProgressBar progress_bar(
-            static_cast<size_t>(mesh.vertices_.size() + mesh.triangles_.size()),
+            static_cast<size_t>(n_vertices + n_triangles),
             "Writing PLY: ", print_progress);
     bool printed_color_warning = false;
-    HostTriangleMesh host_mesh;
-    host_mesh.FromDevice(mesh);
-    for (size_t i = 0; i < mesh.vertices_.size(); i++) {
+    for (size_t i = 0; i < n_vertices; i++) {
         const auto &vertex = host_mesh.vertices_[i];
         ply_write(ply_file, vertex(0));
         ply_write(ply_file, vertex(1));
@@ -573,7 +786,7 @@ bool WriteTriangleMeshToPLY(const std::string &filename,
         }
         ++progress_bar;
     }
-    for (size_t i = 0; i < mesh.triangles_.size(); i++) {
+    for (size_t i = 0; i < n_triangles; i++) {
         const auto &triangle = host_mesh.triangles_[i];
         ply_write(ply_file, 3);
         ply_write(ply_file, triangle(0));
@@ -586,6 +799,22 @@ bool WriteTriangleMeshToPLY(const std::string &filename,
     return true;
 }
 
+bool WriteTriangleMeshToPLY(const std::string &filename,
+                            const geometry::TriangleMesh &mesh,
+                            bool write_ascii /* = false*/,
+                            bool compressed /* = false*/,
+                            bool write_vertex_normals /* = true*/,
+                            bool write_vertex_colors /* = true*/,
+                            bool write_triangle_uvs /* = true*/,
+                            bool print_progress) {
+    HostTriangleMesh host_mesh;
+    host_mesh.FromDevice(mesh);
+    return WriteHostTriangleMeshToPLY(filename, host_mesh, write_ascii,
+                                      compressed, write_vertex_normals,
+                                      write_vertex_colors, write_triangle_uvs,
+                                      print_progress);
+}
+
 bool ReadVoxelGridFromPLY(const std::string &filename,
                           geometry::VoxelGrid &voxelgrid,
                           bool print_progress) {
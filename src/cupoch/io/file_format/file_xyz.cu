@@ -0,0 +1,181 @@
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/file_format/ascii_records.h"
+#include "cupoch/utility/console.h"
+
+// The XYZ family stores one point per line: "x y z" for .xyz, followed by
+// the normal for .xyzn and by the color in [0, 1] for .xyzrgb. PTS files
+// start with the number of points, then "x y z [intensity] [r g b]" with
+// 8 bit colors.
+
+namespace cupoch {
+
+namespace {
+using namespace io;
+
+bool ReadXYZFamily(const std::string &filename,
+                   const std::string &format,
+                   geometry::PointCloud &pointcloud) {
+    MappedFile mapped;
+    if (!mapped.Open(filename)) {
+        utility::LogWarning("Read {} failed: unable to open file: {}", format,
+                            filename);
+        return false;
+    }
+    const char *data = mapped.GetData();
+    size_t n_bytes = mapped.GetSize();
+    size_t max_points = std::numeric_limits<size_t>::max();
+    AsciiRecordLayout layout;
+    for (int i = 0; i < 3; ++i) layout.fields_[i].column_ = i;
+    if (format == "XYZN") {
+        for (int i = 0; i < 3; ++i) {
+            layout.fields_[PackedRecordLayout::NormalX + i].column_ = 3 + i;
+        }
+    } else if (format == "XYZRGB") {
+        for (int i = 0; i < 3; ++i) {
+            layout.fields_[PackedRecordLayout::Red + i].column_ = 3 + i;
+        }
+        layout.color_scale_ = 1.0f;
+    } else if (format == "PTS") {
+        const char *line_end = (const char *)memchr(data, '\n', n_bytes);
+        if (line_end == NULL ||
+            sscanf(std::string(data, line_end).c_str(), "%zu",
+                   &max_points) != 1) {
+            utility::LogWarning("Read PTS failed: unable to read header.");
+            return false;
+        }
+        n_bytes -= line_end + 1 - data;
+        data = line_end + 1;
+        const int n_columns = CountAsciiColumns(data, n_bytes);
+        if (n_columns >= 6) {
+            // The intensity, if any, is skipped.
+            const int first = (n_columns >= 7) ? 4 : 3;
+            for (int i = 0; i < 3; ++i) {
+                layout.fields_[PackedRecordLayout::Red + i].column_ =
+                        first + i;
+            }
+        }
+    }
+    HostPointCloud host_pc;
+    if (!ReadAsciiRecords(data, n_bytes, max_points, layout, host_pc)) {
+        utility::LogWarning("Read {} failed: unable to read data.", format);
+        return false;
+    }
+    host_pc.ToDevice(pointcloud);
+    return true;
+}
+
+bool WriteXYZFamily(const std::string &filename,
+                    const std::string &format,
+                    const geometry::PointCloud &pointcloud) {
+    if (format == "XYZN" && !pointcloud.HasNormals()) {
+        utility::LogWarning("Write XYZN failed: point cloud has no normals.");
+        return false;
+    }
+    if (format == "XYZRGB" && !pointcloud.HasColors()) {
+        utility::LogWarning("Write XYZRGB failed: point cloud has no colors.");
+        return false;
+    }
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == NULL) {
+        utility::LogWarning("Write {} failed: unable to open file: {}", format,
+                            filename);
+        return false;
+    }
+    HostPointCloud host_pc;
+    host_pc.FromDevice(pointcloud);
+    const bool has_colors = pointcloud.HasColors();
+    if (format == "PTS") fprintf(file, "%zu\n", host_pc.points_.size());
+    for (size_t i = 0; i < host_pc.points_.size(); ++i) {
+        const Eigen::Vector3f &point = host_pc.points_[i];
+        fprintf(file, "%.10g %.10g %.10g", point(0), point(1), point(2));
+        if (format == "XYZN") {
+            const Eigen::Vector3f &normal = host_pc.normals_[i];
+            fprintf(file, " %.10g %.10g %.10g", normal(0), normal(1),
+                    normal(2));
+        } else if (format == "XYZRGB") {
+            const Eigen::Vector3f &color = host_pc.colors_[i];
+            fprintf(file, " %.10g %.10g %.10g", color(0), color(1), color(2));
+        } else if (format == "PTS" && has_colors) {
+            const Eigen::Vector3i color =
+                    (host_pc.colors_[i] * 255.0f)
+                            .array()
+                            .round()
+                            .max(0.0f)
+                            .min(255.0f)
+                            .cast<int>();
+            fprintf(file, " 0 %d %d %d", color(0), color(1), color(2));
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    return true;
+}
+
+}  // unnamed namespace
+
+namespace io {
+
+bool ReadPointCloudFromXYZ(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress) {
+    return ReadXYZFamily(filename, "XYZ", pointcloud);
+}
+
+bool WritePointCloudToXYZ(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii /* = false*/,
+                          bool compressed /* = false*/,
+                          bool print_progress) {
+    return WriteXYZFamily(filename, "XYZ", pointcloud);
+}
+
+bool ReadPointCloudFromXYZN(const std::string &filename,
+                            geometry::PointCloud &pointcloud,
+                            bool print_progress) {
+    return ReadXYZFamily(filename, "XYZN", pointcloud);
+}
+
+bool WritePointCloudToXYZN(const std::string &filename,
+                           const geometry::PointCloud &pointcloud,
+                           bool write_ascii /* = false*/,
+                           bool compressed /* = false*/,
+                           bool print_progress) {
+    return WriteXYZFamily(filename, "XYZN", pointcloud);
+}
+
+bool ReadPointCloudFromXYZRGB(const std::string &filename,
+                              geometry::PointCloud &pointcloud,
+                              bool print_progress) {
+    return ReadXYZFamily(filename, "XYZRGB", pointcloud);
+}
+
+bool WritePointCloudToXYZRGB(const std::string &filename,
+                             const geometry::PointCloud &pointcloud,
+                             bool write_ascii /* = false*/,
+                             bool compressed /* = false*/,
+                             bool print_progress) {
+    return WriteXYZFamily(filename, "XYZRGB", pointcloud);
+}
+
+bool ReadPointCloudFromPTS(const std::string &filename,
+                           geometry::PointCloud &pointcloud,
+                           bool print_progress) {
+    return ReadXYZFamily(filename, "PTS", pointcloud);
+}
+
+bool WritePointCloudToPTS(const std::string &filename,
+                          const geometry::PointCloud &pointcloud,
+                          bool write_ascii /* = false*/,
+                          bool compressed /* = false*/,
+                          bool print_progress) {
+    return WriteXYZFamily(filename, "PTS", pointcloud);
+}
+
+}  // namespace io
+}  // namespace cupoch
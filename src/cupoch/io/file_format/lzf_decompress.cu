@@ -0,0 +1,144 @@
+#include <thrust/binary_search.h>
+#include <thrust/gather.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "cupoch/io/file_format/packed_records.h"
+#include "cupoch/utility/console.h"
+
+using namespace cupoch;
+using namespace cupoch::io;
+
+namespace {
+
+// Splits the LZF block into its literal runs and back references. The
+// source of a literal run is its offset in the compressed block, the one of
+// a back reference is minus its distance.
+bool ScanLZFTokens(const std::uint8_t *input,
+                   size_t input_size,
+                   size_t output_size,
+                   std::vector<unsigned int> &begins,
+                   std::vector<long long> &sources) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < input_size) {
+        const unsigned int ctrl = input[ip++];
+        if (ctrl < (1 << 5)) {
+            const size_t len = ctrl + 1;
+            if (ip + len > input_size || op + len > output_size) return false;
+            begins.push_back(op);
+            sources.push_back(ip);
+            ip += len;
+            op += len;
+        } else {
+            size_t len = ctrl >> 5;
+            if (len == 7) {
+                if (ip >= input_size) return false;
+                len += input[ip++];
+            }
+            len += 2;
+            if (ip >= input_size) return false;
+            const size_t distance = ((ctrl & 0x1f) << 8) + input[ip++] + 1;
+            if (distance > op || op + len > output_size) return false;
+            begins.push_back(op);
+            sources.push_back(-(long long)distance);
+            op += len;
+        }
+    }
+    return op == output_size;
+}
+
+struct expand_lzf_tokens_functor {
+    expand_lzf_tokens_functor(const char *input,
+                              const unsigned int *begins,
+                              const long long *sources,
+                              size_t n_tokens,
+                              char *bytes)
+        : input_(input),
+          begins_(begins),
+          sources_(sources),
+          n_tokens_(n_tokens),
+          bytes_(bytes){};
+    const char *input_;
+    const unsigned int *begins_;
+    const long long *sources_;
+    const size_t n_tokens_;
+    char *bytes_;
+    __device__ unsigned int operator()(unsigned int idx) const {
+        const size_t t = thrust::upper_bound(thrust::seq, begins_,
+                                             begins_ + n_tokens_, idx) -
+                         begins_ - 1;
+        const long long source = sources_[t];
+        if (source >= 0) {
+            bytes_[idx] = input_[source + idx - begins_[t]];
+            return idx;
+        }
+        // A back reference copies bytewise, so every byte refers to the one
+        // at the token distance even when the copy overlaps itself.
+        return (unsigned int)(idx + source);
+    }
+};
+
+struct jump_parent_functor {
+    jump_parent_functor(const unsigned int *parents) : parents_(parents){};
+    const unsigned int *parents_;
+    __device__ unsigned int operator()(unsigned int parent) const {
+        return parents_[parent];
+    }
+};
+
+}  // namespace
+
+namespace cupoch {
+namespace io {
+
+bool DecompressLZF(const char *compressed,
+                   size_t compressed_size,
+                   size_t uncompressed_size,
+                   utility::device_vector<char> &output) {
+    std::vector<unsigned int> begins;
+    std::vector<long long> sources;
+    if (uncompressed_size >= (1ull << 32) ||
+        !ScanLZFTokens((const std::uint8_t *)compressed, compressed_size,
+                       uncompressed_size, begins, sources)) {
+        utility::LogWarning("[DecompressLZF] Corrupted LZF data.\n");
+        return false;
+    }
+    output.resize(uncompressed_size);
+    if (uncompressed_size == 0) return true;
+
+    utility::device_vector<char> input(compressed, compressed + compressed_size);
+    utility::device_vector<unsigned int> d_begins(begins.begin(), begins.end());
+    utility::device_vector<long long> d_sources(sources.begin(), sources.end());
+    utility::device_vector<char> bytes(uncompressed_size);
+    utility::device_vector<unsigned int> parents(uncompressed_size);
+    expand_lzf_tokens_functor expand_func(
+            thrust::raw_pointer_cast(input.data()),
+            thrust::raw_pointer_cast(d_begins.data()),
+            thrust::raw_pointer_cast(d_sources.data()), begins.size(),
+            thrust::raw_pointer_cast(bytes.data()));
+    thrust::transform(thrust::make_counting_iterator<unsigned int>(0),
+                      thrust::make_counting_iterator<unsigned int>(
+                              uncompressed_size),
+                      parents.begin(), expand_func);
+
+    // The literal bytes are the roots, every pass halves the remaining
+    // distance of the bytes to their literal.
+    utility::device_vector<unsigned int> next(uncompressed_size);
+    while (true) {
+        thrust::transform(parents.begin(), parents.end(), next.begin(),
+                          jump_parent_functor(
+                                  thrust::raw_pointer_cast(parents.data())));
+        const bool converged =
+                thrust::equal(parents.begin(), parents.end(), next.begin());
+        parents.swap(next);
+        if (converged) break;
+    }
+    thrust::gather(parents.begin(), parents.end(), bytes.begin(),
+                   output.begin());
+    return true;
+}
+
+}  // namespace io
+}  // namespace cupoch
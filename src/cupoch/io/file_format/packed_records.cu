@@ -0,0 +1,332 @@
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/file_format/packed_records.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::io;
+
+namespace {
+
+__device__ float UnpackPackedField(const char *record, char type, int size) {
+    // The records are not aligned, so the values are copied out bytewise.
+    if (type == 'I') {
+        if (size == 1) {
+            int8_t data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        } else if (size == 2) {
+            int16_t data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        } else if (size == 4) {
+            int32_t data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        }
+    } else if (type == 'U') {
+        if (size == 1) {
+            uint8_t data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        } else if (size == 2) {
+            uint16_t data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        } else if (size == 4) {
+            uint32_t data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        }
+    } else if (type == 'F') {
+        if (size == 4) {
+            float data;
+            memcpy(&data, record, sizeof(data));
+            return data;
+        } else if (size == 8) {
+            double data;
+            memcpy(&data, record, sizeof(data));
+            return (float)data;
+        }
+    }
+    return 0.0;
+}
+
+struct deinterleave_records_functor {
+    deinterleave_records_functor(const char *data,
+                                 const PackedRecordLayout &layout)
+        : data_(data), layout_(layout){};
+    const char *data_;
+    const PackedRecordLayout layout_;
+    __device__ float Unpack(int channel, size_t idx) const {
+        const PackedField &field = layout_.fields_[channel];
+        return UnpackPackedField(data_ + field.offset_ + idx * field.stride_,
+                                 field.type_, field.size_);
+    }
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector3f>
+    operator()(size_t idx) const {
+        const Eigen::Vector3f point(Unpack(PackedRecordLayout::X, idx),
+                                    Unpack(PackedRecordLayout::Y, idx),
+                                    Unpack(PackedRecordLayout::Z, idx));
+        Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+        if (layout_.HasNormals()) {
+            normal << Unpack(PackedRecordLayout::NormalX, idx),
+                    Unpack(PackedRecordLayout::NormalY, idx),
+                    Unpack(PackedRecordLayout::NormalZ, idx);
+        }
+        Eigen::Vector3f color = Eigen::Vector3f::Zero();
+        if (layout_.packed_color_) {
+            const PackedField &field =
+                    layout_.fields_[PackedRecordLayout::Red];
+            const uint8_t *bgr = (const uint8_t *)(data_ + field.offset_ +
+                                                   idx * field.stride_);
+            color << bgr[2] / 255.0, bgr[1] / 255.0, bgr[0] / 255.0;
+        } else if (layout_.HasColors()) {
+            color << Unpack(PackedRecordLayout::Red, idx) / 255.0,
+                    Unpack(PackedRecordLayout::Green, idx) / 255.0,
+                    Unpack(PackedRecordLayout::Blue, idx) / 255.0;
+        }
+        return thrust::make_tuple(point, normal, color);
+    }
+};
+
+__device__ void PackPackedField(char *record,
+                                char type,
+                                int size,
+                                float value) {
+    if (type == 'F') {
+        if (size == 4) {
+            memcpy(record, &value, sizeof(value));
+        } else if (size == 8) {
+            const double data = value;
+            memcpy(record, &data, sizeof(data));
+        }
+        return;
+    }
+    const float rounded = rintf(value);
+    if (type == 'I') {
+        if (size == 1) {
+            const int8_t data = fminf(fmaxf(rounded, -128.0f), 127.0f);
+            memcpy(record, &data, sizeof(data));
+        } else if (size == 2) {
+            const int16_t data = fminf(fmaxf(rounded, -32768.0f), 32767.0f);
+            memcpy(record, &data, sizeof(data));
+        } else if (size == 4) {
+            const int32_t data = rounded;
+            memcpy(record, &data, sizeof(data));
+        }
+    } else if (type == 'U') {
+        if (size == 1) {
+            const uint8_t data = fminf(fmaxf(rounded, 0.0f), 255.0f);
+            memcpy(record, &data, sizeof(data));
+        } else if (size == 2) {
+            const uint16_t data = fminf(fmaxf(rounded, 0.0f), 65535.0f);
+            memcpy(record, &data, sizeof(data));
+        } else if (size == 4) {
+            const uint32_t data = fmaxf(rounded, 0.0f);
+            memcpy(record, &data, sizeof(data));
+        }
+    }
+}
+
+struct interleave_records_functor {
+    interleave_records_functor(const Eigen::Vector3f *points,
+                               const Eigen::Vector3f *normals,
+                               const Eigen::Vector3f *colors,
+                               const PackedRecordLayout &layout,
+                               char *data)
+        : points_(points),
+          normals_(normals),
+          colors_(colors),
+          layout_(layout),
+          data_(data){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3f *normals_;
+    const Eigen::Vector3f *colors_;
+    const PackedRecordLayout layout_;
+    char *data_;
+    __device__ void Pack(int channel, size_t idx, float value) const {
+        const PackedField &field = layout_.fields_[channel];
+        if (field.size_ == 0) return;
+        PackPackedField(data_ + field.offset_ + idx * field.stride_,
+                        field.type_, field.size_, value);
+    }
+    __device__ void operator()(size_t idx) const {
+        for (int i = 0; i < 3; ++i) {
+            Pack(PackedRecordLayout::X + i, idx, points_[idx](i));
+        }
+        if (normals_) {
+            for (int i = 0; i < 3; ++i) {
+                Pack(PackedRecordLayout::NormalX + i, idx, normals_[idx](i));
+            }
+        }
+        if (!colors_) return;
+        if (layout_.packed_color_) {
+            const PackedField &field =
+                    layout_.fields_[PackedRecordLayout::Red];
+            uint8_t *bgr = (uint8_t *)(data_ + field.offset_ +
+                                       idx * field.stride_);
+            for (int i = 0; i < 3; ++i) {
+                const float value = rintf(colors_[idx](i) * 255.0f);
+                bgr[2 - i] = fminf(fmaxf(value, 0.0f), 255.0f);
+            }
+        } else {
+            for (int i = 0; i < 3; ++i) {
+                Pack(PackedRecordLayout::Red + i, idx,
+                     colors_[idx](i) * 255.0f);
+            }
+        }
+    }
+};
+
+}  // namespace
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string &filename) {
+    Close();
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    data_ = (const char *)data;
+    size_ = st.st_size;
+    mapped_ = true;
+    return true;
+#else
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL) return false;
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(file);
+        return false;
+    }
+    buffer_.resize(size);
+    const bool success = fread(buffer_.data(), 1, size, file) == size_t(size);
+    fclose(file);
+    if (!success) {
+        buffer_.clear();
+        return false;
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+#endif
+}
+
+void MappedFile::Close() {
+#ifndef _WIN32
+    if (mapped_) munmap((void *)data_, size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+namespace cupoch {
+namespace io {
+
+bool ReadPackedRecords(const char *data,
+                       size_t n_bytes,
+                       size_t n_points,
+                       const PackedRecordLayout &layout,
+                       geometry::PointCloud &pointcloud) {
+    utility::pinned_host_vector<char> pinned(n_bytes);
+    memcpy(thrust::raw_pointer_cast(pinned.data()), data, n_bytes);
+    return ReadPackedRecords(pinned, n_points, layout, pointcloud);
+}
+
+bool ReadPackedRecords(const utility::pinned_host_vector<char> &data,
+                       size_t n_points,
+                       const PackedRecordLayout &layout,
+                       geometry::PointCloud &pointcloud) {
+    utility::device_vector<char> records(data.size());
+    cudaSafeCall(cudaMemcpy(thrust::raw_pointer_cast(records.data()),
+                            thrust::raw_pointer_cast(data.data()),
+                            data.size(), cudaMemcpyHostToDevice));
+    return DeinterleavePackedRecords(records, n_points, layout, pointcloud);
+}
+
+bool DeinterleavePackedRecords(const utility::device_vector<char> &records,
+                               size_t n_points,
+                               const PackedRecordLayout &layout,
+                               geometry::PointCloud &pointcloud) {
+    pointcloud.Clear();
+    if (!layout.HasPoints()) {
+        utility::LogWarning(
+                "[DeinterleavePackedRecords] Fields for point data are not "
+                "complete.\n");
+        return false;
+    }
+    if (n_points == 0) return true;
+    // All the channels come out of the same pass over the records, the
+    // missing ones are dropped afterwards.
+    utility::device_vector<Eigen::Vector3f> normals(n_points);
+    utility::device_vector<Eigen::Vector3f> colors(n_points);
+    pointcloud.points_.resize(n_points);
+    deinterleave_records_functor func(
+            thrust::raw_pointer_cast(records.data()), layout);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_points),
+                      make_tuple_begin(pointcloud.points_, normals, colors),
+                      func);
+    if (layout.HasNormals()) pointcloud.normals_.swap(normals);
+    if (layout.HasColors()) pointcloud.colors_.swap(colors);
+    return true;
+}
+
+bool InterleavePackedRecords(const geometry::PointCloud &pointcloud,
+                             const PackedRecordLayout &layout,
+                             size_t record_size,
+                             utility::device_vector<char> &records) {
+    if (!layout.HasPoints()) {
+        utility::LogWarning(
+                "[InterleavePackedRecords] Fields for point data are not "
+                "complete.\n");
+        return false;
+    }
+    const size_t n_points = pointcloud.points_.size();
+    records.resize(n_points * record_size);
+    thrust::fill(records.begin(), records.end(), 0);
+    if (n_points == 0) return true;
+    PackedRecordLayout strided = layout;
+    for (auto &field : strided.fields_) field.stride_ = record_size;
+    interleave_records_functor func(
+            thrust::raw_pointer_cast(pointcloud.points_.data()),
+            (pointcloud.HasNormals())
+                    ? thrust::raw_pointer_cast(pointcloud.normals_.data())
+                    : nullptr,
+            (pointcloud.HasColors())
+                    ? thrust::raw_pointer_cast(pointcloud.colors_.data())
+                    : nullptr,
+            strided, thrust::raw_pointer_cast(records.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator(n_points), func);
+    return true;
+}
+
+}  // namespace io
+}  // namespace cupoch}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+
+namespace geometry {
+class PointCloud;
+}
+
+namespace io {
+
+/// Read-only view of a whole file. The file is memory mapped where mmap is
+/// available and read into memory otherwise.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+public:
+    bool Open(const std::string &filename);
+    void Close();
+    const char *GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+};
+
+/// Location of one scalar of the point records in a binary file. The value
+/// of point i is at offset_ + i * stride_, \p type_ is 'I', 'U' or 'F' as in
+/// the PCD TYPE line and a zero \p size_ marks a missing field.
+struct PackedField {
+    size_t offset_ = 0;
+    int stride_ = 0;
+    char type_ = 'F';
+    int size_ = 0;
+};
+
+struct PackedRecordLayout {
+    enum Channel {
+        X = 0,
+        Y,
+        Z,
+        NormalX,
+        NormalY,
+        NormalZ,
+        Red,
+        Green,
+        Blue,
+        NumChannels
+    };
+    PackedField fields_[NumChannels];
+    /// The color is a single 4 byte BGR(A) field stored in fields_[Red], as
+    /// the rgb field of PCD.
+    bool packed_color_ = false;
+
+    __host__ __device__ bool HasPoints() const {
+        return fields_[X].size_ > 0 && fields_[Y].size_ > 0 &&
+               fields_[Z].size_ > 0;
+    }
+    __host__ __device__ bool HasNormals() const {
+        return fields_[NormalX].size_ > 0 && fields_[NormalY].size_ > 0 &&
+               fields_[NormalZ].size_ > 0;
+    }
+    __host__ __device__ bool HasColors() const {
+        return (packed_color_) ? fields_[Red].size_ == 4
+                               : fields_[Red].size_ > 0 &&
+                                         fields_[Green].size_ > 0 &&
+                                         fields_[Blue].size_ > 0;
+    }
+};
+
+/// Uploads \p n_bytes of packed point records and deinterleaves the points,
+/// normals and colors on the device in a single kernel. The records are
+/// staged in pinned memory so that the upload runs at full bus speed.
+bool ReadPackedRecords(const char *data,
+                       size_t n_bytes,
+                       size_t n_points,
+                       const PackedRecordLayout &layout,
+                       geometry::PointCloud &pointcloud);
+bool ReadPackedRecords(const utility::pinned_host_vector<char> &data,
+                       size_t n_points,
+                       const PackedRecordLayout &layout,
+                       geometry::PointCloud &pointcloud);
+/// Deinterleaves packed point records that are already on the device.
+bool DeinterleavePackedRecords(const utility::device_vector<char> &records,
+                               size_t n_points,
+                               const PackedRecordLayout &layout,
+                               geometry::PointCloud &pointcloud);
+
+/// Packs the points, normals and colors into \p n_points records of
+/// \p record_size bytes on the device, the reverse of
+/// DeinterleavePackedRecords. The fields of \p layout missing in the point
+/// cloud and the bytes between the fields are zero.
+bool InterleavePackedRecords(const geometry::PointCloud &pointcloud,
+                             const PackedRecordLayout &layout,
+                             size_t record_size,
+                             utility::device_vector<char> &records);
+
+/// Decompresses a LZF block, as the payload of binary_compressed PCD files,
+/// on the device. The host only walks the control bytes to locate the
+/// literal runs and back references. The device then expands them into
+/// the output bytes and resolves the chains of back references by pointer
+/// jumping, in a number of passes logarithmic in the chain length.
+bool DecompressLZF(const char *compressed,
+                   size_t compressed_size,
+                   size_t uncompressed_size,
+                   utility::device_vector<char> &output);
+
+}  // namespace io
+}  // namespace cupoch
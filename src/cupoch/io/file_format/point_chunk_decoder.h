@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace cupoch {
+namespace io {
+
+struct HostPointCloud;
+
+/// \class PointChunkDecoder
+///
+/// \brief Sequential reader of the point records of one file format, the
+/// back end of PointCloudStreamReader.
+class PointChunkDecoder {
+public:
+    virtual ~PointChunkDecoder() {}
+
+public:
+    /// Number of points in the file.
+    virtual size_t GetNumPoints() const = 0;
+    /// Decodes the next \p n_points records into \p host_pc, reusing its
+    /// buffers. Returns false on a read error.
+    virtual bool DecodeNext(size_t n_points, HostPointCloud &host_pc) = 0;
+};
+
+/// Decoders of uncompressed PCD files, and of LAS and LAZ files. Return
+/// nullptr, with a warning, for the files they cannot stream.
+std::unique_ptr<PointChunkDecoder> CreatePCDChunkDecoder(
+        const std::string &filename);
+std::unique_ptr<PointChunkDecoder> CreateLASChunkDecoder(
+        const std::string &filename);
+
+}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,156 @@
+#include "cupoch/geometry/image.h"
+#include "cupoch/io/ros/image_msg.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+
+namespace {
+using namespace io;
+
+bool GetEncodingFormat(const std::string &encoding,
+                       int &num_of_channels,
+                       int &bytes_per_channel,
+                       bool &swap_red_blue) {
+    swap_red_blue = encoding == "bgr8" || encoding == "bgra8";
+    if (encoding == "rgb8" || encoding == "bgr8") {
+        num_of_channels = 3;
+        bytes_per_channel = 1;
+    } else if (encoding == "rgba8" || encoding == "bgra8") {
+        num_of_channels = 4;
+        bytes_per_channel = 1;
+    } else if (encoding == "mono8" || encoding == "8UC1") {
+        num_of_channels = 1;
+        bytes_per_channel = 1;
+    } else if (encoding == "mono16" || encoding == "16UC1") {
+        num_of_channels = 1;
+        bytes_per_channel = 2;
+    } else if (encoding == "32FC1") {
+        num_of_channels = 1;
+        bytes_per_channel = 4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+struct swap_red_blue_functor {
+    swap_red_blue_functor(uint8_t *data, int num_of_channels)
+        : data_(data), num_of_channels_(num_of_channels){};
+    uint8_t *data_;
+    const int num_of_channels_;
+    __device__ void operator()(size_t idx) const {
+        uint8_t *pixel = data_ + idx * num_of_channels_;
+        const uint8_t red = pixel[0];
+        pixel[0] = pixel[2];
+        pixel[2] = red;
+    }
+};
+
+void SwapRedBlue(geometry::Image &image) {
+    swap_red_blue_functor func(thrust::raw_pointer_cast(image.data_.data()),
+                               image.num_of_channels_);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(image.width_ *
+                                                            image.height_),
+                     func);
+}
+
+}  // unnamed namespace
+
+namespace io {
+
+ImageMsgInfo::ImageMsgInfo(uint32_t width,
+                           uint32_t height,
+                           const std::string &encoding,
+                           bool is_bigendian,
+                           uint32_t step)
+    : height_(height),
+      width_(width),
+      encoding_(encoding),
+      is_bigendian_(is_bigendian),
+      step_(step) {
+    int num_of_channels, bytes_per_channel;
+    bool swap_red_blue;
+    if (step_ == 0 && GetEncodingFormat(encoding, num_of_channels,
+                                        bytes_per_channel, swap_red_blue)) {
+        step_ = width * num_of_channels * bytes_per_channel;
+    }
+}
+
+std::shared_ptr<geometry::Image> CreateFromImageMsg(const uint8_t *data,
+                                                    const ImageMsgInfo &info) {
+    auto image = std::make_shared<geometry::Image>();
+    int num_of_channels, bytes_per_channel;
+    bool swap_red_blue;
+    if (!GetEncodingFormat(info.encoding_, num_of_channels, bytes_per_channel,
+                           swap_red_blue)) {
+        utility::LogWarning("[CreateFromImageMsg] Unsupported encoding: {}",
+                            info.encoding_);
+        return image;
+    }
+    if (info.is_bigendian_ && bytes_per_channel > 1) {
+        utility::LogWarning(
+                "[CreateFromImageMsg] Big endian data is not supported.");
+        return image;
+    }
+    image->Prepare(info.width_, info.height_, num_of_channels,
+                   bytes_per_channel);
+    const size_t line_size = image->BytesPerLine();
+    if (info.step_ < line_size) {
+        utility::LogWarning("[CreateFromImageMsg] Invalid step.");
+        image->Clear();
+        return image;
+    }
+    if (image->data_.empty()) return image;
+    cudaSafeCall(cudaMemcpy2D(thrust::raw_pointer_cast(image->data_.data()),
+                              line_size, data, info.step_, line_size,
+                              info.height_, cudaMemcpyHostToDevice));
+    if (swap_red_blue) SwapRedBlue(*image);
+    return image;
+}
+
+bool CreateToImageMsg(uint8_t *data,
+                      const ImageMsgInfo &info,
+                      const geometry::Image &image) {
+    int num_of_channels, bytes_per_channel;
+    bool swap_red_blue;
+    if (!GetEncodingFormat(info.encoding_, num_of_channels, bytes_per_channel,
+                           swap_red_blue)) {
+        utility::LogWarning("[CreateToImageMsg] Unsupported encoding: {}",
+                            info.encoding_);
+        return false;
+    }
+    if (info.is_bigendian_ && bytes_per_channel > 1) {
+        utility::LogWarning(
+                "[CreateToImageMsg] Big endian data is not supported.");
+        return false;
+    }
+    const size_t line_size = image.BytesPerLine();
+    if (image.width_ != int(info.width_) ||
+        image.height_ != int(info.height_) ||
+        image.num_of_channels_ != num_of_channels ||
+        image.bytes_per_channel_ != bytes_per_channel ||
+        info.step_ < line_size) {
+        utility::LogWarning(
+                "[CreateToImageMsg] The message layout does not match the "
+                "image.");
+        return false;
+    }
+    if (image.data_.empty()) return true;
+    const geometry::Image *source = &image;
+    geometry::Image swapped;
+    if (swap_red_blue) {
+        swapped = image;
+        SwapRedBlue(swapped);
+        source = &swapped;
+    }
+    cudaSafeCall(cudaMemcpy2D(data, info.step_,
+                              thrust::raw_pointer_cast(source->data_.data()),
+                              line_size, line_size, info.height_,
+                              cudaMemcpyDeviceToHost));
+    return true;
+}
+
+}  // namespace io
+}  // namespace cupoch
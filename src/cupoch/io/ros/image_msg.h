@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace cupoch {
+
+namespace geometry {
+class Image;
+}
+
+namespace io {
+
+/// Layout of the data buffer of a sensor_msgs/Image message, without the
+/// header. The encodings rgb8, bgr8, rgba8, bgra8, mono8, 8UC1, mono16,
+/// 16UC1 and 32FC1 are supported.
+struct ImageMsgInfo {
+    ImageMsgInfo() = default;
+    ImageMsgInfo(uint32_t width,
+                 uint32_t height,
+                 const std::string &encoding,
+                 bool is_bigendian = false,
+                 uint32_t step = 0);
+    /// Number of bytes of the data buffer.
+    size_t GetSize() const { return size_t(height_) * step_; }
+
+    uint32_t height_ = 0;
+    uint32_t width_ = 0;
+    std::string encoding_;
+    bool is_bigendian_ = false;
+    /// Bytes per row, packed rows when it is 0 at construction.
+    uint32_t step_ = 0;
+};
+
+/// Creates an image from the data buffer of a sensor_msgs/Image message.
+/// Padded rows are packed by the upload and bgr(a) pixels are reordered to
+/// rgb(a) on the device.
+std::shared_ptr<geometry::Image> CreateFromImageMsg(const uint8_t *data,
+                                                    const ImageMsgInfo &info);
+
+/// Downloads \p image into \p data, the buffer of info.GetSize() bytes of a
+/// sensor_msgs/Image message described by \p info. The channels and the
+/// depth of the encoding must match the image.
+bool CreateToImageMsg(uint8_t *data,
+                      const ImageMsgInfo &info,
+                      const geometry::Image &image);
+
+}  // namespace io
+}  // namespace cupoch
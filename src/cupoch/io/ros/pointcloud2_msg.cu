@@ -0,0 +1,176 @@
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/file_format/packed_records.h"
+#include "cupoch/io/ros/pointcloud2_msg.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+
+namespace {
+using namespace io;
+
+bool GetPackedType(uint8_t datatype, char &type, int &size) {
+    switch (datatype) {
+        case PointField::INT8:
+            type = 'I';
+            size = 1;
+            return true;
+        case PointField::UINT8:
+            type = 'U';
+            size = 1;
+            return true;
+        case PointField::INT16:
+            type = 'I';
+            size = 2;
+            return true;
+        case PointField::UINT16:
+            type = 'U';
+            size = 2;
+            return true;
+        case PointField::INT32:
+            type = 'I';
+            size = 4;
+            return true;
+        case PointField::UINT32:
+            type = 'U';
+            size = 4;
+            return true;
+        case PointField::FLOAT32:
+            type = 'F';
+            size = 4;
+            return true;
+        case PointField::FLOAT64:
+            type = 'F';
+            size = 8;
+            return true;
+        default:
+            return false;
+    }
+}
+
+int GetChannel(const std::string &name) {
+    static const char *const names[PackedRecordLayout::NumChannels] = {
+            "x", "y", "z", "normal_x", "normal_y", "normal_z", "r", "g", "b"};
+    for (int i = 0; i < PackedRecordLayout::NumChannels; ++i) {
+        if (name == names[i]) return i;
+    }
+    return -1;
+}
+
+PackedRecordLayout MakePointCloud2Layout(const PointCloud2MsgInfo &info) {
+    PackedRecordLayout layout;
+    for (const auto &field : info.fields_) {
+        char type;
+        int size;
+        if (!GetPackedType(field.datatype_, type, size)) continue;
+        PackedField packed;
+        packed.offset_ = field.offset_;
+        packed.stride_ = info.point_step_;
+        packed.type_ = type;
+        packed.size_ = size;
+        if (field.name_ == "rgb" || field.name_ == "rgba") {
+            if (size != 4) continue;
+            layout.fields_[PackedRecordLayout::Red] = packed;
+            layout.packed_color_ = true;
+            continue;
+        }
+        const int channel = GetChannel(field.name_);
+        if (channel < 0 || (layout.packed_color_ &&
+                            channel >= PackedRecordLayout::Red)) {
+            continue;
+        }
+        layout.fields_[channel] = packed;
+    }
+    return layout;
+}
+
+}  // unnamed namespace
+
+namespace io {
+
+PointCloud2MsgInfo PointCloud2MsgInfo::Default(uint32_t width,
+                                               bool has_colors,
+                                               bool has_normals) {
+    PointCloud2MsgInfo info;
+    info.width_ = width;
+    info.fields_ = {PointField("x", 0, PointField::FLOAT32),
+                    PointField("y", 4, PointField::FLOAT32),
+                    PointField("z", 8, PointField::FLOAT32)};
+    // The rgb field of PCL, 4 bytes after the point so that the records of
+    // the points with and without colors align the same way.
+    if (has_colors) {
+        info.fields_.push_back(PointField("rgb", 12, PointField::FLOAT32));
+    }
+    info.point_step_ = 16;
+    if (has_normals) {
+        info.fields_.push_back(PointField("normal_x", 16, PointField::FLOAT32));
+        info.fields_.push_back(PointField("normal_y", 20, PointField::FLOAT32));
+        info.fields_.push_back(PointField("normal_z", 24, PointField::FLOAT32));
+        info.point_step_ = 32;
+    }
+    info.row_step_ = info.point_step_ * width;
+    return info;
+}
+
+std::shared_ptr<geometry::PointCloud> CreateFromPointCloud2Msg(
+        const uint8_t *data, const PointCloud2MsgInfo &info) {
+    auto pointcloud = std::make_shared<geometry::PointCloud>();
+    if (info.is_bigendian_) {
+        utility::LogWarning(
+                "[CreateFromPointCloud2Msg] Big endian data is not "
+                "supported.");
+        return pointcloud;
+    }
+    if (info.row_step_ < info.width_ * info.point_step_) {
+        utility::LogWarning("[CreateFromPointCloud2Msg] Invalid row_step.");
+        return pointcloud;
+    }
+    const PackedRecordLayout layout = MakePointCloud2Layout(info);
+    const size_t n_points = size_t(info.width_) * info.height_;
+    const size_t line_size = size_t(info.width_) * info.point_step_;
+    utility::device_vector<char> records(n_points * info.point_step_);
+    if (n_points > 0) {
+        // The padding at the end of the rows is dropped by the copy.
+        cudaSafeCall(cudaMemcpy2D(thrust::raw_pointer_cast(records.data()),
+                                  line_size, data, info.row_step_, line_size,
+                                  info.height_, cudaMemcpyHostToDevice));
+    }
+    if (!DeinterleavePackedRecords(records, n_points, layout, *pointcloud)) {
+        return pointcloud;
+    }
+    if (!info.is_dense_) pointcloud->RemoveNoneFinitePoints();
+    return pointcloud;
+}
+
+bool CreateToPointCloud2Msg(uint8_t *data,
+                            const PointCloud2MsgInfo &info,
+                            const geometry::PointCloud &pointcloud) {
+    if (info.is_bigendian_) {
+        utility::LogWarning(
+                "[CreateToPointCloud2Msg] Big endian data is not supported.");
+        return false;
+    }
+    const size_t n_points = size_t(info.width_) * info.height_;
+    if (n_points != pointcloud.points_.size() ||
+        info.row_step_ < info.width_ * info.point_step_) {
+        utility::LogWarning(
+                "[CreateToPointCloud2Msg] The message layout does not match "
+                "the point cloud.");
+        return false;
+    }
+    utility::device_vector<char> records;
+    if (!InterleavePackedRecords(pointcloud, MakePointCloud2Layout(info),
+                                 info.point_step_, records)) {
+        return false;
+    }
+    if (n_points == 0) return true;
+    const size_t line_size = size_t(info.width_) * info.point_step_;
+    cudaSafeCall(cudaMemcpy2D(data, info.row_step_,
+                              thrust::raw_pointer_cast(records.data()),
+                              line_size, line_size, info.height_,
+                              cudaMemcpyDeviceToHost));
+    return true;
+}
+
+}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cupoch {
+
+namespace geometry {
+class PointCloud;
+}
+
+namespace io {
+
+/// Description of one field of a sensor_msgs/PointField.
+struct PointField {
+    enum DataType {
+        INT8 = 1,
+        UINT8 = 2,
+        INT16 = 3,
+        UINT16 = 4,
+        INT32 = 5,
+        UINT32 = 6,
+        FLOAT32 = 7,
+        FLOAT64 = 8
+    };
+    PointField() = default;
+    PointField(const std::string &name,
+               uint32_t offset,
+               uint8_t datatype,
+               uint32_t count = 1)
+        : name_(name), offset_(offset), datatype_(datatype), count_(count) {}
+
+    std::string name_;
+    uint32_t offset_ = 0;
+    uint8_t datatype_ = FLOAT32;
+    uint32_t count_ = 1;
+};
+
+/// Layout of the data buffer of a sensor_msgs/PointCloud2 message, without
+/// the header.
+struct PointCloud2MsgInfo {
+    /// Layout of \p width points packed as x, y, z float32 followed, when
+    /// requested, by the rgb field of PCL and the normal_x, normal_y,
+    /// normal_z float32 fields, as published by the ROS drivers.
+    static PointCloud2MsgInfo Default(uint32_t width,
+                                      bool has_colors = false,
+                                      bool has_normals = false);
+    /// Number of bytes of the data buffer.
+    size_t GetSize() const { return size_t(height_) * row_step_; }
+
+    uint32_t height_ = 1;
+    uint32_t width_ = 0;
+    std::vector<PointField> fields_;
+    bool is_bigendian_ = false;
+    uint32_t point_step_ = 0;
+    uint32_t row_step_ = 0;
+    bool is_dense_ = true;
+};
+
+/// Creates a point cloud from the data buffer of a sensor_msgs/PointCloud2
+/// message. The buffer is uploaded as is, rows included when row_step pads
+/// them, and the x/y/z, normal_x/y/z and rgb/rgba (or r/g/b) fields of all
+/// the points are unpacked on the device in a single kernel.
+std::shared_ptr<geometry::PointCloud> CreateFromPointCloud2Msg(
+        const uint8_t *data, const PointCloud2MsgInfo &info);
+
+/// Packs \p pointcloud into \p data, the buffer of info.GetSize() bytes of a
+/// sensor_msgs/PointCloud2 message described by \p info, e.g. from
+/// PointCloud2MsgInfo::Default. The records are packed on the device and
+/// downloaded in one copy.
+bool CreateToPointCloud2Msg(uint8_t *data,
+                            const PointCloud2MsgInfo &info,
+                            const geometry::PointCloud &pointcloud);
+
+}  // namespace io
+}  // namespace cupoch
@@ -0,0 +1,383 @@
+#include <thrust/binary_search.h>
+#include <thrust/extrema.h>
+#include <thrust/find.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/random.h>
+#include <thrust/reduce.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/localization/monte_carlo_localization.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::localization;
+
+namespace {
+
+__device__ unsigned int HashSeed(unsigned int seed, unsigned int idx) {
+    unsigned int h = seed ^ (idx * 0x9e3779b9u);
+    h = (h ^ 61) ^ (h >> 16);
+    h *= 9;
+    h = h ^ (h >> 4);
+    h *= 0x27d4eb2d;
+    return h ^ (h >> 15);
+}
+
+__device__ float NormalizeAngle(float a) { return atan2f(sinf(a), cosf(a)); }
+
+struct initialize_particles_functor {
+    initialize_particles_functor(const Eigen::Vector3f &mean,
+                                 const Eigen::Vector3f &stddev,
+                                 unsigned int seed)
+        : mean_(mean), stddev_(stddev), seed_(seed){};
+    const Eigen::Vector3f mean_;
+    const Eigen::Vector3f stddev_;
+    const unsigned int seed_;
+    __device__ Eigen::Vector3f operator()(size_t idx) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        thrust::random::normal_distribution<float> dist(0.0, 1.0);
+        Eigen::Vector3f p;
+        for (int i = 0; i < 3; ++i) p[i] = mean_[i] + stddev_[i] * dist(rng);
+        p[2] = NormalizeAngle(p[2]);
+        return p;
+    }
+};
+
+// Sample of the odometry motion model of Probabilistic Robotics, 5.4.
+struct predict_particle_functor {
+    predict_particle_functor(float rot1,
+                             float trans,
+                             float rot2,
+                             const Eigen::Vector4f_u &alphas,
+                             unsigned int seed)
+        : rot1_(rot1),
+          trans_(trans),
+          rot2_(rot2),
+          alphas_(alphas),
+          seed_(seed){};
+    const float rot1_;
+    const float trans_;
+    const float rot2_;
+    const Eigen::Vector4f_u alphas_;
+    const unsigned int seed_;
+    __device__ Eigen::Vector3f operator()(size_t idx,
+                                          const Eigen::Vector3f &p) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        thrust::random::normal_distribution<float> dist(0.0, 1.0);
+        const float rot1 =
+                rot1_ - dist(rng) * sqrtf(alphas_[0] * rot1_ * rot1_ +
+                                          alphas_[1] * trans_ * trans_);
+        const float trans =
+                trans_ - dist(rng) * sqrtf(alphas_[2] * trans_ * trans_ +
+                                           alphas_[3] * (rot1_ * rot1_ +
+                                                         rot2_ * rot2_));
+        const float rot2 =
+                rot2_ - dist(rng) * sqrtf(alphas_[0] * rot2_ * rot2_ +
+                                          alphas_[1] * trans_ * trans_);
+        return Eigen::Vector3f(p[0] + trans * cosf(p[2] + rot1),
+                               p[1] + trans * sinf(p[2] + rot1),
+                               NormalizeAngle(p[2] + rot1 + rot2));
+    }
+};
+
+// Beam end j of particle i is the element i * n_beams + j.
+struct beam_end_functor {
+    beam_end_functor(const Eigen::Vector3f *particles,
+                     const Eigen::Vector3f *scan,
+                     int n_beams)
+        : particles_(particles), scan_(scan), n_beams_(n_beams){};
+    const Eigen::Vector3f *particles_;
+    const Eigen::Vector3f *scan_;
+    const int n_beams_;
+    __device__ Eigen::Vector3f operator()(size_t idx) const {
+        const Eigen::Vector3f &p = particles_[idx / n_beams_];
+        const Eigen::Vector3f &s = scan_[idx % n_beams_];
+        const float c = cosf(p[2]);
+        const float sn = sinf(p[2]);
+        return Eigen::Vector3f(p[0] + c * s[0] - sn * s[1],
+                               p[1] + sn * s[0] + c * s[1], s[2]);
+    }
+};
+
+struct beam_log_likelihood_functor {
+    beam_log_likelihood_functor(float sigma_hit, float z_hit, float z_rand)
+        : inv_two_sigma2_(0.5 / (sigma_hit * sigma_hit)),
+          z_hit_(z_hit),
+          z_rand_(z_rand){};
+    const float inv_two_sigma2_;
+    const float z_hit_;
+    const float z_rand_;
+    __device__ float operator()(float d) const {
+        return logf(z_hit_ * expf(-d * d * inv_two_sigma2_) + z_rand_);
+    }
+};
+
+struct divide_functor {
+    divide_functor(int n) : n_(n){};
+    const int n_;
+    __device__ int operator()(int idx) const { return idx / n_; }
+};
+
+// Bin of a pose over the KLD sampling histogram, 21 bits per coordinate.
+struct pose_bin_functor {
+    pose_bin_functor(float bin_size_xy, float bin_size_yaw)
+        : bin_size_xy_(bin_size_xy), bin_size_yaw_(bin_size_yaw){};
+    const float bin_size_xy_;
+    const float bin_size_yaw_;
+    __device__ unsigned long long operator()(const Eigen::Vector3f &p) const {
+        const unsigned long long mask = (1ull << 21) - 1;
+        const unsigned long long bx =
+                (unsigned long long)(floorf(p[0] / bin_size_xy_) + (1 << 20));
+        const unsigned long long by =
+                (unsigned long long)(floorf(p[1] / bin_size_xy_) + (1 << 20));
+        const unsigned long long byaw =
+                (unsigned long long)(floorf(p[2] / bin_size_yaw_) + (1 << 20));
+        return ((bx & mask) << 42) | ((by & mask) << 21) | (byaw & mask);
+    }
+};
+
+// 1 at the first of the sorted samples of each bin.
+struct first_in_bin_functor {
+    first_in_bin_functor(const unsigned long long *bins) : bins_(bins){};
+    const unsigned long long *bins_;
+    __device__ int operator()(int k) const {
+        return (k == 0 || bins_[k] != bins_[k - 1]) ? 1 : 0;
+    }
+};
+
+// Fox's bound on the number of samples for k occupied bins.
+__host__ __device__ float KLDSampleSize(int k, float error, float z) {
+    if (k <= 1) return 0.0f;
+    const float a = 2.0f / (9.0f * (k - 1));
+    const float b = 1.0f - a + sqrtf(a) * z;
+    return (k - 1) / (2.0f * error) * b * b * b;
+}
+
+struct kld_satisfied_functor {
+    kld_satisfied_functor(const int *n_bins,
+                          int min_particles,
+                          float error,
+                          float z)
+        : n_bins_(n_bins),
+          min_particles_(min_particles),
+          error_(error),
+          z_(z){};
+    const int *n_bins_;
+    const int min_particles_;
+    const float error_;
+    const float z_;
+    __device__ bool operator()(int j) const {
+        const int n = j + 1;
+        return n >= min_particles_ &&
+               n >= KLDSampleSize(n_bins_[j], error_, z_);
+    }
+};
+
+}  // namespace
+
+MonteCarloLocalization::MonteCarloLocalization(
+        const std::shared_ptr<geometry::DistanceTransform> &map,
+        const MonteCarloLocalizationOption &option,
+        unsigned int seed)
+    : map_(map), option_(option), seed_(seed) {
+    if (!map_) {
+        utility::LogError("[MonteCarloLocalization] The map is null.");
+    }
+}
+
+MonteCarloLocalization::~MonteCarloLocalization() {}
+
+void MonteCarloLocalization::Initialize(const Eigen::Vector3f &mean,
+                                        const Eigen::Vector3f &stddev,
+                                        int num_particles) {
+    if (num_particles <= 0) {
+        utility::LogError(
+                "[MonteCarloLocalization] The number of particles must be "
+                "positive.");
+    }
+    particles_.resize(num_particles);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator<size_t>(num_particles),
+                      particles_.begin(),
+                      initialize_particles_functor(mean, stddev,
+                                                   seed_ + step_++));
+    weights_.assign(num_particles, 1.0f / num_particles);
+}
+
+void MonteCarloLocalization::Predict(const Eigen::Vector3f &delta) {
+    const float trans = delta.head<2>().norm();
+    const float rot1 = (trans < 1.0e-6) ? 0.0f : std::atan2(delta[1], delta[0]);
+    const float rot2 = delta[2] - rot1;
+    predict_particle_functor func(rot1, trans, rot2, option_.motion_noise_,
+                                  seed_ + step_++);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(particles_.size()),
+                      particles_.begin(), particles_.begin(), func);
+}
+
+void MonteCarloLocalization::Update(
+        const utility::device_vector<Eigen::Vector3f> &scan) {
+    CUPOCH_PROFILE("MonteCarloLocalization::Update");
+    const int n_particles = particles_.size();
+    const int n_beams = scan.size();
+    if (n_particles == 0 || n_beams == 0) {
+        utility::LogWarning(
+                "[MonteCarloLocalization] No particles or no beams.\n");
+        return;
+    }
+    // All the beam ends of all the particles are scored in one batch.
+    const size_t n_ends = (size_t)n_particles * n_beams;
+    utility::device_vector<Eigen::Vector3f> ends(n_ends);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_ends), ends.begin(),
+                      beam_end_functor(
+                              thrust::raw_pointer_cast(particles_.data()),
+                              thrust::raw_pointer_cast(scan.data()),
+                              n_beams));
+    utility::device_vector<float> distances;
+    map_->GetDistances(ends, distances);
+    utility::device_vector<float> log_likelihoods(n_particles);
+    thrust::reduce_by_key(
+            thrust::make_transform_iterator(thrust::make_counting_iterator(0),
+                                            divide_functor(n_beams)),
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator((int)n_ends),
+                    divide_functor(n_beams)),
+            thrust::make_transform_iterator(
+                    distances.begin(),
+                    beam_log_likelihood_functor(option_.sigma_hit_,
+                                                option_.z_hit_,
+                                                option_.z_rand_)),
+            thrust::make_discard_iterator(), log_likelihoods.begin());
+
+    // Normalized in the log domain, the likelihoods of many beams underflow.
+    thrust::transform(weights_.begin(), weights_.end(),
+                      log_likelihoods.begin(), log_likelihoods.begin(),
+                      [] __device__(float w, float ll) {
+                          return (w > 0.0f) ? logf(w) + ll : -INFINITY;
+                      });
+    const float max_log = *thrust::max_element(log_likelihoods.begin(),
+                                               log_likelihoods.end());
+    thrust::transform(log_likelihoods.begin(), log_likelihoods.end(),
+                      weights_.begin(), [max_log] __device__(float lw) {
+                          return expf(lw - max_log);
+                      });
+    const float total = thrust::reduce(weights_.begin(), weights_.end());
+    thrust::transform(weights_.begin(), weights_.end(), weights_.begin(),
+                      [total] __device__(float w) { return w / total; });
+}
+
+void MonteCarloLocalization::Resample() {
+    CUPOCH_PROFILE("MonteCarloLocalization::Resample");
+    const int n_particles = particles_.size();
+    if (n_particles == 0) return;
+    utility::device_vector<float> cumulative(n_particles);
+    thrust::inclusive_scan(weights_.begin(), weights_.end(),
+                           cumulative.begin());
+    const float total = cumulative.back();
+
+    // KLD sampling: the number of samples is the first n for which the
+    // bound of the bins occupied by n i.i.d. samples is reached. The
+    // samples are drawn at once and the bins counted by a prefix scan.
+    const int max_particles = std::max(option_.max_particles_, 1);
+    const unsigned int kld_seed = seed_ + step_++;
+    utility::device_vector<float> draws(max_particles);
+    thrust::transform(thrust::make_counting_iterator(0),
+                      thrust::make_counting_iterator(max_particles),
+                      draws.begin(), [kld_seed, total] __device__(int j) {
+                          thrust::default_random_engine rng(
+                                  HashSeed(kld_seed, j));
+                          thrust::uniform_real_distribution<float> dist(
+                                  0.0, total);
+                          return dist(rng);
+                      });
+    utility::device_vector<int> indices(max_particles);
+    thrust::lower_bound(cumulative.begin(), cumulative.end(), draws.begin(),
+                        draws.end(), indices.begin());
+    utility::device_vector<unsigned long long> bins(max_particles);
+    const Eigen::Vector3f *particles =
+            thrust::raw_pointer_cast(particles_.data());
+    pose_bin_functor bin_func(option_.kld_bin_size_xy_,
+                              option_.kld_bin_size_yaw_);
+    thrust::transform(indices.begin(), indices.end(), bins.begin(),
+                      [particles, bin_func, n_particles] __device__(int i) {
+                          return bin_func(particles[min(i, n_particles - 1)]);
+                      });
+    utility::device_vector<int> order(max_particles);
+    thrust::sequence(order.begin(), order.end());
+    thrust::stable_sort_by_key(bins.begin(), bins.end(), order.begin());
+    utility::device_vector<int> n_bins(max_particles, 0);
+    first_in_bin_functor first_func(thrust::raw_pointer_cast(bins.data()));
+    thrust::scatter(thrust::make_transform_iterator(
+                            thrust::make_counting_iterator(0), first_func),
+                    thrust::make_transform_iterator(
+                            thrust::make_counting_iterator(max_particles),
+                            first_func),
+                    order.begin(), n_bins.begin());
+    thrust::inclusive_scan(n_bins.begin(), n_bins.end(), n_bins.begin());
+    auto itr = thrust::find_if(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(max_particles),
+            kld_satisfied_functor(thrust::raw_pointer_cast(n_bins.data()),
+                                  option_.min_particles_, option_.kld_error_,
+                                  option_.kld_z_));
+    const int n_next = std::min(*itr + 1, max_particles);
+
+    // Low variance resampling of n_next particles.
+    thrust::default_random_engine rng(seed_ + step_++);
+    thrust::uniform_real_distribution<float> dist(0.0, 1.0 / n_next);
+    const float r = dist(rng);
+    draws.resize(n_next);
+    thrust::transform(thrust::make_counting_iterator(0),
+                      thrust::make_counting_iterator(n_next), draws.begin(),
+                      [r, n_next, total] __device__(int i) {
+                          return (r + float(i) / n_next) * total;
+                      });
+    indices.resize(n_next);
+    thrust::lower_bound(cumulative.begin(), cumulative.end(), draws.begin(),
+                        draws.end(), indices.begin());
+    utility::device_vector<Eigen::Vector3f> next(n_next);
+    thrust::transform(indices.begin(), indices.end(), next.begin(),
+                      [particles, n_particles] __device__(int i) {
+                          return particles[min(i, n_particles - 1)];
+                      });
+    particles_.swap(next);
+    weights_.assign(n_next, 1.0f / n_next);
+}
+
+Eigen::Vector3f MonteCarloLocalization::GetMeanPose() const {
+    if (particles_.empty()) return Eigen::Vector3f::Zero();
+    const Eigen::Vector4f sum = thrust::transform_reduce(
+            make_tuple_begin(particles_, weights_),
+            make_tuple_end(particles_, weights_),
+            [] __device__(const thrust::tuple<Eigen::Vector3f, float> &x) {
+                const Eigen::Vector3f &p = thrust::get<0>(x);
+                const float w = thrust::get<1>(x);
+                return Eigen::Vector4f(w * p[0], w * p[1], w * cosf(p[2]),
+                                       w * sinf(p[2]));
+            },
+            Eigen::Vector4f::Zero().eval(), thrust::plus<Eigen::Vector4f>());
+    const float total = thrust::reduce(weights_.begin(), weights_.end());
+    return Eigen::Vector3f(sum[0] / total, sum[1] / total,
+                           std::atan2(sum[3], sum[2]));
+}
+
+float MonteCarloLocalization::GetEffectiveSampleSize() const {
+    const float sum2 = thrust::transform_reduce(
+            weights_.begin(), weights_.end(),
+            [] __device__(float w) { return w * w; }, 0.0f,
+            thrust::plus<float>());
+    return (sum2 > 0.0f) ? 1.0f / sum2 : 0.0f;
+}
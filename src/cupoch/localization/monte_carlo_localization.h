@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+class DistanceTransform;
+}
+
+namespace localization {
+
+class MonteCarloLocalizationOption {
+public:
+    MonteCarloLocalizationOption(float sigma_hit = 0.2,
+                                 float z_hit = 0.95,
+                                 float z_rand = 0.05,
+                                 const Eigen::Vector4f_u &motion_noise =
+                                         Eigen::Vector4f_u(0.2, 0.2, 0.2, 0.2),
+                                 int min_particles = 100,
+                                 int max_particles = 10000,
+                                 float kld_error = 0.05,
+                                 float kld_z = 2.33,
+                                 float kld_bin_size_xy = 0.5,
+                                 float kld_bin_size_yaw = 0.1745)
+        : sigma_hit_(sigma_hit),
+          z_hit_(z_hit),
+          z_rand_(z_rand),
+          motion_noise_(motion_noise),
+          min_particles_(min_particles),
+          max_particles_(max_particles),
+          kld_error_(kld_error),
+          kld_z_(kld_z),
+          kld_bin_size_xy_(kld_bin_size_xy),
+          kld_bin_size_yaw_(kld_bin_size_yaw) {}
+    ~MonteCarloLocalizationOption() {}
+
+public:
+    /// Likelihood field model: a beam end at distance d from the nearest
+    /// obstacle has the likelihood z_hit_ N(d; 0, sigma_hit_) + z_rand_.
+    float sigma_hit_;
+    float z_hit_;
+    float z_rand_;
+    /// Noise of the odometry motion model, alpha1 to alpha4 of
+    /// Thrun et al., "Probabilistic Robotics", 2005.
+    Eigen::Vector4f_u motion_noise_;
+    /// Bounds of the number of particles chosen by the KLD sampling.
+    int min_particles_;
+    int max_particles_;
+    /// KLD sampling: with probability of the quantile kld_z_, the error of
+    /// the sampled distribution stays below kld_error_, measured over bins
+    /// of kld_bin_size_xy_ x kld_bin_size_xy_ x kld_bin_size_yaw_.
+    float kld_error_;
+    float kld_z_;
+    float kld_bin_size_xy_;
+    float kld_bin_size_yaw_;
+};
+
+/// \class MonteCarloLocalization
+///
+/// \brief Particle filter localization of a planar robot on the distance
+/// field of a map.
+///
+/// The particles are poses (x, y, yaw) of the robot. All the particles are
+/// moved, scored and resampled on the device: Update() scores every
+/// particle against every beam end of the scan in one batch, with the
+/// likelihood field model on the DistanceTransform of the map, e.g. from
+/// DistanceTransform::ComputeEDT of an OccupancyGrid. Resample() draws the
+/// next particles by low variance resampling, their number being chosen
+/// by KLD sampling (Fox, "Adapting the Sample Size in Particle Filters
+/// Through KLD-Sampling", 2003).
+class MonteCarloLocalization {
+public:
+    MonteCarloLocalization(
+            const std::shared_ptr<geometry::DistanceTransform> &map,
+            const MonteCarloLocalizationOption &option =
+                    MonteCarloLocalizationOption(),
+            unsigned int seed = 0);
+    ~MonteCarloLocalization();
+
+    /// Draws \p num_particles particles from the normal distribution of
+    /// \p mean and the standard deviations \p stddev, with equal weights.
+    void Initialize(const Eigen::Vector3f &mean,
+                    const Eigen::Vector3f &stddev,
+                    int num_particles);
+    /// Moves the particles by the odometry motion \p delta, (dx, dy, dyaw)
+    /// in the robot frame at the previous pose, with sampled noise.
+    void Predict(const Eigen::Vector3f &delta);
+    /// Multiplies the weights by the likelihood of the beam ends \p scan,
+    /// in the robot frame, and normalizes them. The z of the beam ends is
+    /// kept, so that a 2D scan is scored at its height in the map.
+    void Update(const utility::device_vector<Eigen::Vector3f> &scan);
+    /// Draws the next particles, with equal weights.
+    void Resample();
+    /// Weighted mean pose, the yaw being the circular mean.
+    Eigen::Vector3f GetMeanPose() const;
+    /// Effective number of particles, 1 / sum(w^2).
+    float GetEffectiveSampleSize() const;
+    size_t GetNumParticles() const { return particles_.size(); }
+    const MonteCarloLocalizationOption &GetOption() const { return option_; }
+
+public:
+    utility::device_vector<Eigen::Vector3f> particles_;
+    /// Normalized weights of the particles.
+    utility::device_vector<float> weights_;
+
+private:
+    std::shared_ptr<geometry::DistanceTransform> map_;
+    MonteCarloLocalizationOption option_;
+    unsigned int seed_;
+    /// Incremented by every random draw, so that each draws new numbers.
+    unsigned int step_ = 0;
+};
+
+}  // namespace localization
+}  // namespace cupoch
@@ -1,11 +1,13 @@
 #include <Eigen/Dense>
 
 #include "cupoch/geometry/image.h"
+#include "cupoch/geometry/image_pyramid.h"
 #include "cupoch/geometry/rgbdimage.h"
 #include "cupoch/odometry/odometry.h"
 #include "cupoch/odometry/rgbdodometry_jacobian.h"
 
 #include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
 
 namespace cupoch {
 namespace odometry {
@@ -359,25 +361,24 @@ struct compute_gtg_functor {
     }
 };
 
+/// Same as below with \p xyz_t, the XYZ image of \p depth_t, given.
 Eigen::Matrix6f CreateInformationMatrix(
         const Eigen::Matrix4f &extrinsic,
         const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
         const geometry::Image &depth_s,
         const geometry::Image &depth_t,
+        const geometry::Image &xyz_t,
         const OdometryOption &option) {
     CorrespondenceSetPixelWise correspondence;
     ComputeCorrespondence(pinhole_camera_intrinsic.intrinsic_matrix_, extrinsic,
                           depth_s, depth_t, option, correspondence);
 
-    auto xyz_t = ConvertDepthImageToXYZImage(
-            depth_t, pinhole_camera_intrinsic.intrinsic_matrix_);
-
     // write q^*
     // see http://redwood-data.org/indoor/registration.html
     // note: I comes first and q_skew is scaled by factor 2.
     compute_gtg_functor func(thrust::raw_pointer_cast(correspondence.data()),
-                             thrust::raw_pointer_cast(xyz_t->data_.data()),
-                             xyz_t->width_);
+                             thrust::raw_pointer_cast(xyz_t.data_.data()),
+                             xyz_t.width_);
     Eigen::Matrix6f init = Eigen::Matrix6f::Identity();
     Eigen::Matrix6f GTG = thrust::transform_reduce(
             thrust::make_counting_iterator<size_t>(0),
@@ -386,6 +387,18 @@ Eigen::Matrix6f CreateInformationMatrix(
     return GTG;
 }
 
+Eigen::Matrix6f CreateInformationMatrix(
+        const Eigen::Matrix4f &extrinsic,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
+        const geometry::Image &depth_s,
+        const geometry::Image &depth_t,
+        const OdometryOption &option) {
+    auto xyz_t = ConvertDepthImageToXYZImage(
+            depth_t, pinhole_camera_intrinsic.intrinsic_matrix_);
+    return CreateInformationMatrix(extrinsic, pinhole_camera_intrinsic,
+                                   depth_s, depth_t, *xyz_t, option);
+}
+
 struct compute_mean_functor {
     compute_mean_functor(const Eigen::Vector4i *corres,
                          const uint8_t *image_s,
@@ -419,9 +432,11 @@ struct add_tuple2f_functor {
     }
 };
 
-void NormalizeIntensity(geometry::Image &image_s,
-                        geometry::Image &image_t,
-                        CorrespondenceSetPixelWise &correspondence) {
+/// Means of the intensities of both images over the correspondences.
+thrust::tuple<float, float> ComputeIntensityMeans(
+        const geometry::Image &image_s,
+        const geometry::Image &image_t,
+        const CorrespondenceSetPixelWise &correspondence) {
     if (image_s.width_ != image_t.width_ ||
         image_s.height_ != image_t.height_) {
         utility::LogError(
@@ -436,8 +451,17 @@ void NormalizeIntensity(geometry::Image &image_s,
             thrust::make_counting_iterator<size_t>(0),
             thrust::make_counting_iterator(correspondence.size()), func_tf,
             thrust::make_tuple(0.0f, 0.0f), add_tuple2f_functor());
-    float mean_s = thrust::get<0>(means) / (float)correspondence.size();
-    float mean_t = thrust::get<1>(means) / (float)correspondence.size();
+    return thrust::make_tuple(
+            thrust::get<0>(means) / (float)correspondence.size(),
+            thrust::get<1>(means) / (float)correspondence.size());
+}
+
+void NormalizeIntensity(geometry::Image &image_s,
+                        geometry::Image &image_t,
+                        CorrespondenceSetPixelWise &correspondence) {
+    float mean_s, mean_t;
+    thrust::tie(mean_s, mean_t) =
+            ComputeIntensityMeans(image_s, image_t, correspondence);
     image_s.LinearTransform(0.5 / mean_s, 0.0);
     image_t.LinearTransform(0.5 / mean_t, 0.0);
 }
@@ -510,27 +534,29 @@ InitializeRGBDOdometry(
         const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
         const Eigen::Matrix4f &odo_init,
         const OdometryOption &option) {
-    auto source_gray =
-            source.color_.Filter(geometry::Image::FilterType::Gaussian3);
-    auto target_gray =
-            target.color_.Filter(geometry::Image::FilterType::Gaussian3);
+    // The images are filtered in place in the outputs, through one buffer.
+    auto source_out = std::make_shared<geometry::RGBDImage>();
+    auto target_out = std::make_shared<geometry::RGBDImage>();
+    geometry::Image buffer;
+    source.color_.Filter(geometry::Image::FilterType::Gaussian3,
+                         source_out->color_, buffer);
+    target.color_.Filter(geometry::Image::FilterType::Gaussian3,
+                         target_out->color_, buffer);
     auto source_depth_preprocessed =
             PreprocessDepth(utility::GetStream(0), source.depth_, option);
     auto target_depth_preprocessed =
             PreprocessDepth(utility::GetStream(1), target.depth_, option);
-    cudaSafeCall(cudaDeviceSynchronize());
-    auto source_depth = source_depth_preprocessed->Filter(
-            geometry::Image::FilterType::Gaussian3);
-    auto target_depth = target_depth_preprocessed->Filter(
-            geometry::Image::FilterType::Gaussian3);
+    utility::SynchronizeStreams(2);
+    source_depth_preprocessed->Filter(geometry::Image::FilterType::Gaussian3,
+                                      source_out->depth_, buffer);
+    target_depth_preprocessed->Filter(geometry::Image::FilterType::Gaussian3,
+                                      target_out->depth_, buffer);
 
     CorrespondenceSetPixelWise correspondence;
     ComputeCorrespondence(pinhole_camera_intrinsic.intrinsic_matrix_, odo_init,
-                          *source_depth, *target_depth, option, correspondence);
-    NormalizeIntensity(*source_gray, *target_gray, correspondence);
-
-    auto source_out = PackRGBDImage(*source_gray, *source_depth);
-    auto target_out = PackRGBDImage(*target_gray, *target_depth);
+                          source_out->depth_, target_out->depth_, option,
+                          correspondence);
+    NormalizeIntensity(source_out->color_, target_out->color_, correspondence);
     return std::make_tuple(source_out, target_out);
 }
 
@@ -588,6 +614,162 @@ struct compute_jacobian_and_residual_functor
     }
 };
 
+// Images and motion of one source/target pair at one pyramid level, as
+// read by the fused Jacobian functors.
+struct fused_odometry_pair {
+    const uint8_t *source_color_;
+    const uint8_t *source_depth_;
+    const uint8_t *target_color_;
+    const uint8_t *target_depth_;
+    const uint8_t *source_xyz_;
+    const uint8_t *target_dx_color_;
+    const uint8_t *target_dx_depth_;
+    const uint8_t *target_dy_color_;
+    const uint8_t *target_dy_depth_;
+    int width_;
+    int height_;
+    Eigen::Matrix3f intrinsic_;
+    Eigen::Matrix4f_u extrinsic_;
+    Eigen::Vector3f Kt_;
+    Eigen::Matrix3f KRK_inv_;
+};
+
+fused_odometry_pair MakeFusedOdometryPair(
+        const geometry::RGBDImage &source,
+        const geometry::RGBDImage &target,
+        const geometry::Image &source_xyz,
+        const geometry::RGBDImage &target_dx,
+        const geometry::RGBDImage &target_dy,
+        const Eigen::Matrix3f &intrinsic,
+        const Eigen::Matrix4f &extrinsic) {
+    fused_odometry_pair pair;
+    pair.source_color_ = thrust::raw_pointer_cast(source.color_.data_.data());
+    pair.source_depth_ = thrust::raw_pointer_cast(source.depth_.data_.data());
+    pair.target_color_ = thrust::raw_pointer_cast(target.color_.data_.data());
+    pair.target_depth_ = thrust::raw_pointer_cast(target.depth_.data_.data());
+    pair.source_xyz_ = thrust::raw_pointer_cast(source_xyz.data_.data());
+    pair.target_dx_color_ =
+            thrust::raw_pointer_cast(target_dx.color_.data_.data());
+    pair.target_dx_depth_ =
+            thrust::raw_pointer_cast(target_dx.depth_.data_.data());
+    pair.target_dy_color_ =
+            thrust::raw_pointer_cast(target_dy.color_.data_.data());
+    pair.target_dy_depth_ =
+            thrust::raw_pointer_cast(target_dy.depth_.data_.data());
+    pair.width_ = source.depth_.width_;
+    pair.height_ = source.depth_.height_;
+    pair.intrinsic_ = intrinsic;
+    pair.extrinsic_ = extrinsic;
+    pair.KRK_inv_ =
+            intrinsic * extrinsic.block<3, 3>(0, 0) * intrinsic.inverse();
+    pair.Kt_ = intrinsic * extrinsic.block<3, 1>(0, 3);
+    return pair;
+}
+
+// Warps source pixel idx into the target exactly as
+// compute_correspondence_map does and evaluates the two rows of the
+// Jacobian at the resulting correspondence, so that the correspondence
+// image never has to be written. Returns false if the pixel has no
+// correspondence. The call is qualified so that the Jacobian, built on the
+// host, is not dispatched through its virtual table.
+template <typename JacobianType>
+__device__ bool ComputeFusedJacobianAndResidual(
+        const JacobianType &jacobian,
+        const fused_odometry_pair &p,
+        float max_depth_diff,
+        int idx,
+        Eigen::Vector6f J_r[2],
+        float r[2]) {
+    int v_s = idx / p.width_;
+    int u_s = idx % p.width_;
+    float d_s = *geometry::PointerAt<float>(p.source_depth_, p.width_, u_s, v_s);
+    if (isnan(d_s)) return false;
+    Eigen::Vector3f uv_in_s =
+            d_s * p.KRK_inv_ * Eigen::Vector3f(u_s, v_s, 1.0) + p.Kt_;
+    float transformed_d_s = uv_in_s(2);
+    int u_t = (int)(uv_in_s(0) / transformed_d_s + 0.5);
+    int v_t = (int)(uv_in_s(1) / transformed_d_s + 0.5);
+    if (u_t < 0 || u_t >= p.width_ || v_t < 0 || v_t >= p.height_) {
+        return false;
+    }
+    float d_t = *geometry::PointerAt<float>(p.target_depth_, p.width_, u_t, v_t);
+    if (isnan(d_t) || std::abs(transformed_d_s - d_t) > max_depth_diff) {
+        return false;
+    }
+    const Eigen::Vector4i corres(u_s, v_s, u_t, v_t);
+    jacobian.JacobianType::ComputeJacobianAndResidual(
+            0, J_r, r, p.source_color_, p.source_depth_, p.target_color_,
+            p.target_depth_, p.source_xyz_, p.target_dx_color_,
+            p.target_dx_depth_, p.target_dy_color_, p.target_dy_depth_,
+            p.width_, p.intrinsic_, p.extrinsic_, &corres);
+    return true;
+}
+
+template <typename JacobianType>
+struct fused_jacobian_and_residual_functor {
+    fused_jacobian_and_residual_functor(const fused_odometry_pair &pair,
+                                        float max_depth_diff)
+        : pair_(pair), max_depth_diff_(max_depth_diff){};
+    const fused_odometry_pair pair_;
+    const float max_depth_diff_;
+    JacobianType jacobian_;
+    __device__ bool operator()(int idx,
+                               Eigen::Vector6f J_r[2],
+                               float r[2]) const {
+        return ComputeFusedJacobianAndResidual(jacobian_, pair_,
+                                               max_depth_diff_, idx, J_r, r);
+    }
+};
+
+// fused_jacobian_and_residual_functor of the pair of each system of
+// utility::ReduceJTJandJTrBatch().
+template <typename JacobianType>
+struct batch_fused_jacobian_and_residual_functor {
+    batch_fused_jacobian_and_residual_functor(const fused_odometry_pair *pairs,
+                                              float max_depth_diff)
+        : pairs_(pairs), max_depth_diff_(max_depth_diff){};
+    const fused_odometry_pair *pairs_;
+    const float max_depth_diff_;
+    JacobianType jacobian_;
+    __device__ bool operator()(int system,
+                               int idx,
+                               Eigen::Vector6f J_r[2],
+                               float r[2]) const {
+        return ComputeFusedJacobianAndResidual(
+                jacobian_, pairs_[system], max_depth_diff_, idx, J_r, r);
+    }
+};
+
+template <int NumJ, typename FuncType>
+std::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int> ReduceFusedJTJandJTr(
+        const FuncType &func, int n_pixels) {
+    auto res = utility::ReduceJTJandJTr<NumJ>(func, n_pixels);
+    return std::make_tuple(thrust::get<0>(res), thrust::get<1>(res),
+                           thrust::get<2>(res), thrust::get<3>(res));
+}
+
+// One pass over the source pixels that finds the correspondences, evaluates
+// the Jacobians and reduces JTJ, JTr and r2, without the correspondence
+// map, the correspondence list and the per pixel 6x6 matrices of
+// ComputeCorrespondence() followed by utility::ComputeJTJandJTr().
+template <typename JacobianType>
+std::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int> ComputeFusedJTJandJTr(
+        const geometry::RGBDImage &source,
+        const geometry::RGBDImage &target,
+        const geometry::Image &source_xyz,
+        const geometry::RGBDImage &target_dx,
+        const geometry::RGBDImage &target_dy,
+        const Eigen::Matrix3f &intrinsic,
+        const Eigen::Matrix4f &extrinsic,
+        const OdometryOption &option) {
+    fused_jacobian_and_residual_functor<JacobianType> func(
+            MakeFusedOdometryPair(source, target, source_xyz, target_dx,
+                                  target_dy, intrinsic, extrinsic),
+            option.max_depth_diff_);
+    return ReduceFusedJTJandJTr<2>(
+            func, source.depth_.width_ * source.depth_.height_);
+}
+
 template <typename JacobianType>
 std::tuple<bool, Eigen::Matrix4f> DoSingleIteration(
         int iter,
@@ -600,30 +782,16 @@ std::tuple<bool, Eigen::Matrix4f> DoSingleIteration(
         const Eigen::Matrix3f &intrinsic,
         const Eigen::Matrix4f &extrinsic_initial,
         const OdometryOption &option) {
-    CorrespondenceSetPixelWise correspondence;
-    ComputeCorrespondence(intrinsic, extrinsic_initial, source.depth_,
-                          target.depth_, option, correspondence);
-    int corresps_count = (int)correspondence.size();
-
-    compute_jacobian_and_residual_functor<JacobianType> func(
-            thrust::raw_pointer_cast(source.color_.data_.data()),
-            thrust::raw_pointer_cast(source.depth_.data_.data()),
-            thrust::raw_pointer_cast(target.color_.data_.data()),
-            thrust::raw_pointer_cast(target.depth_.data_.data()),
-            thrust::raw_pointer_cast(source_xyz.data_.data()),
-            thrust::raw_pointer_cast(target_dx.color_.data_.data()),
-            thrust::raw_pointer_cast(target_dx.depth_.data_.data()),
-            thrust::raw_pointer_cast(target_dy.color_.data_.data()),
-            thrust::raw_pointer_cast(target_dy.depth_.data_.data()),
-            source.color_.width_, intrinsic, extrinsic_initial,
-            thrust::raw_pointer_cast(correspondence.data()));
-    utility::LogDebug("Iter : {:d}, Level : {:d}, ", iter, level);
     Eigen::Matrix6f JTJ;
     Eigen::Vector6f JTr;
     float r2;
-    thrust::tie(JTJ, JTr, r2) =
-            utility::ComputeJTJandJTr<Eigen::Matrix6f, Eigen::Vector6f, 2>(
-                    func, corresps_count);
+    int corresps_count;
+    std::tie(JTJ, JTr, r2, corresps_count) =
+            ComputeFusedJTJandJTr<JacobianType>(
+                    source, target, source_xyz, target_dx, target_dy,
+                    intrinsic, extrinsic_initial, option);
+    utility::LogDebug("Iter : {:d}, Level : {:d}, Correspondences : {:d}",
+                      iter, level, corresps_count);
 
     bool is_success;
     Eigen::Matrix4f extrinsic;
@@ -709,37 +877,40 @@ std::tuple<bool, Eigen::Matrix4f, float> DoSingleIterationWeighted(
     }
 }
 
+/// XYZ images of the depth levels of \p pyramid.
+std::vector<std::shared_ptr<geometry::Image>> CreateXYZImagePyramid(
+        const geometry::RGBDImagePyramid &pyramid,
+        const std::vector<Eigen::Matrix3f> &pyramid_camera_matrix) {
+    std::vector<std::shared_ptr<geometry::Image>> xyz_pyramid;
+    for (size_t level = 0; level < pyramid.size(); level++) {
+        xyz_pyramid.push_back(ConvertDepthImageToXYZImage(
+                pyramid[level]->depth_, pyramid_camera_matrix[level]));
+    }
+    return xyz_pyramid;
+}
+
 template <typename JacobianType>
-std::tuple<bool, Eigen::Matrix4f> ComputeMultiscale(
-        const geometry::RGBDImage &source,
-        const geometry::RGBDImage &target,
-        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
+std::tuple<bool, Eigen::Matrix4f> ComputeMultiscaleFromPyramids(
+        const geometry::RGBDImagePyramid &source_pyramid,
+        const std::vector<std::shared_ptr<geometry::Image>> &source_xyz,
+        const geometry::RGBDImagePyramid &target_pyramid,
+        const geometry::RGBDImagePyramid &target_pyramid_dx,
+        const geometry::RGBDImagePyramid &target_pyramid_dy,
+        const std::vector<Eigen::Matrix3f> &pyramid_camera_matrix,
         const Eigen::Matrix4f &extrinsic_initial,
         const OdometryOption &option) {
     std::vector<int> iter_counts = option.iteration_number_per_pyramid_level_;
     int num_levels = (int)iter_counts.size();
 
-    auto source_pyramid = source.CreatePyramid(num_levels);
-    auto target_pyramid = target.CreatePyramid(num_levels);
-    auto target_pyramid_dx = geometry::RGBDImage::FilterPyramid(
-            target_pyramid, geometry::Image::FilterType::Sobel3Dx);
-    auto target_pyramid_dy = geometry::RGBDImage::FilterPyramid(
-            target_pyramid, geometry::Image::FilterType::Sobel3Dy);
-
     Eigen::Matrix4f result_odo = extrinsic_initial.isZero()
                                          ? Eigen::Matrix4f::Identity()
                                          : extrinsic_initial;
 
-    std::vector<Eigen::Matrix3f> pyramid_camera_matrix =
-            CreateCameraMatrixPyramid(pinhole_camera_intrinsic,
-                                      (int)iter_counts.size());
-
     for (int level = num_levels - 1; level >= 0; level--) {
         const Eigen::Matrix3f level_camera_matrix =
                 pyramid_camera_matrix[level];
 
-        auto source_xyz_level = ConvertDepthImageToXYZImage(
-                source_pyramid[level]->depth_, level_camera_matrix);
+        const auto &source_xyz_level = source_xyz[level];
         auto source_level = PackRGBDImage(source_pyramid[level]->color_,
                                           source_pyramid[level]->depth_);
         auto target_level = PackRGBDImage(target_pyramid[level]->color_,
@@ -767,6 +938,31 @@ std::tuple<bool, Eigen::Matrix4f> ComputeMultiscale(
     return std::make_tuple(true, result_odo);
 }
 
+template <typename JacobianType>
+std::tuple<bool, Eigen::Matrix4f> ComputeMultiscale(
+        const geometry::RGBDImage &source,
+        const geometry::RGBDImage &target,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
+        const Eigen::Matrix4f &extrinsic_initial,
+        const OdometryOption &option) {
+    int num_levels = (int)option.iteration_number_per_pyramid_level_.size();
+
+    auto source_pyramid = source.CreatePyramid(num_levels);
+    auto target_pyramid = target.CreatePyramid(num_levels);
+    auto target_pyramid_dx = geometry::RGBDImage::FilterPyramid(
+            target_pyramid, geometry::Image::FilterType::Sobel3Dx);
+    auto target_pyramid_dy = geometry::RGBDImage::FilterPyramid(
+            target_pyramid, geometry::Image::FilterType::Sobel3Dy);
+    std::vector<Eigen::Matrix3f> pyramid_camera_matrix =
+            CreateCameraMatrixPyramid(pinhole_camera_intrinsic, num_levels);
+    auto source_xyz =
+            CreateXYZImagePyramid(source_pyramid, pyramid_camera_matrix);
+    return ComputeMultiscaleFromPyramids<JacobianType>(
+            source_pyramid, source_xyz, target_pyramid, target_pyramid_dx,
+            target_pyramid_dy, pyramid_camera_matrix, extrinsic_initial,
+            option);
+}
+
 template <typename JacobianType>
 std::tuple<bool, Eigen::Matrix4f, Eigen::Vector6f> ComputeMultiscaleWeighted(
         const geometry::RGBDImage &source,
@@ -895,6 +1091,539 @@ ComputeRGBDOdometryT<RGBDOdometryJacobianFromHybridTerm>(
         const OdometryOption &option,
         bool is_weighted);
 
+typedef std::vector<thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int>>
+        BatchSystems;
+
+// Pair of the batched odometry, preprocessed by InitializeRGBDOdometry() and
+// ComputeMultiscale() as a single pair.
+struct BatchOdometryPair {
+    std::shared_ptr<geometry::RGBDImage> source_processed_;
+    std::shared_ptr<geometry::RGBDImage> target_processed_;
+    geometry::RGBDImagePyramid source_pyramid_;
+    geometry::RGBDImagePyramid target_pyramid_;
+    geometry::RGBDImagePyramid target_pyramid_dx_;
+    geometry::RGBDImagePyramid target_pyramid_dy_;
+    std::vector<Eigen::Matrix3f> pyramid_camera_matrix_;
+    std::vector<std::shared_ptr<geometry::Image>> source_xyz_;
+};
+
+BatchOdometryPair PrepareBatchOdometryPair(
+        const geometry::RGBDImage &source,
+        const geometry::RGBDImage &target,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
+        const Eigen::Matrix4f &odo_init,
+        const OdometryOption &option) {
+    const int num_levels =
+            (int)option.iteration_number_per_pyramid_level_.size();
+    BatchOdometryPair pair;
+    std::tie(pair.source_processed_, pair.target_processed_) =
+            InitializeRGBDOdometry(source, target, pinhole_camera_intrinsic,
+                                   odo_init, option);
+    pair.source_pyramid_ = pair.source_processed_->CreatePyramid(num_levels);
+    pair.target_pyramid_ = pair.target_processed_->CreatePyramid(num_levels);
+    pair.target_pyramid_dx_ = geometry::RGBDImage::FilterPyramid(
+            pair.target_pyramid_, geometry::Image::FilterType::Sobel3Dx);
+    pair.target_pyramid_dy_ = geometry::RGBDImage::FilterPyramid(
+            pair.target_pyramid_, geometry::Image::FilterType::Sobel3Dy);
+    pair.pyramid_camera_matrix_ =
+            CreateCameraMatrixPyramid(pinhole_camera_intrinsic, num_levels);
+    pair.source_xyz_ = CreateXYZImagePyramid(pair.source_pyramid_,
+                                             pair.pyramid_camera_matrix_);
+    return pair;
+}
+
+// Iterations of ComputeMultiscaleFromPyramids() for all the pairs at once:
+// each iteration reduces the normal equations of the active pairs, at their
+// current motions, in one utility::ReduceJTJandJTrBatch(), and \p update
+// turns them into the next motions and active pairs.
+template <typename JacobianType, typename UpdateFunc>
+void ComputeMultiscaleBatch(const std::vector<BatchOdometryPair> &pairs,
+                            std::vector<Eigen::Matrix4f> &motions,
+                            std::vector<bool> &active,
+                            const OdometryOption &option,
+                            const UpdateFunc &update) {
+    const std::vector<int> &iter_counts =
+            option.iteration_number_per_pyramid_level_;
+    const int num_levels = (int)iter_counts.size();
+    const int n_pairs = (int)pairs.size();
+    std::vector<fused_odometry_pair> h_pairs(n_pairs);
+    utility::device_vector<fused_odometry_pair> d_pairs(n_pairs);
+    std::vector<int> counts(n_pairs);
+    batch_fused_jacobian_and_residual_functor<JacobianType> func(
+            thrust::raw_pointer_cast(d_pairs.data()), option.max_depth_diff_);
+
+    for (int level = num_levels - 1; level >= 0; level--) {
+        std::vector<std::shared_ptr<geometry::RGBDImage>> levels;
+        levels.reserve(4 * n_pairs);
+        for (const auto &pair : pairs) {
+            levels.push_back(PackRGBDImage(pair.source_pyramid_[level]->color_,
+                                           pair.source_pyramid_[level]->depth_));
+            levels.push_back(PackRGBDImage(pair.target_pyramid_[level]->color_,
+                                           pair.target_pyramid_[level]->depth_));
+            levels.push_back(
+                    PackRGBDImage(pair.target_pyramid_dx_[level]->color_,
+                                  pair.target_pyramid_dx_[level]->depth_));
+            levels.push_back(
+                    PackRGBDImage(pair.target_pyramid_dy_[level]->color_,
+                                  pair.target_pyramid_dy_[level]->depth_));
+        }
+        for (int iter = 0; iter < iter_counts[num_levels - level - 1]; iter++) {
+            bool any_active = false;
+            for (int i = 0; i < n_pairs; ++i) {
+                const geometry::RGBDImage &source = *levels[4 * i];
+                h_pairs[i] = MakeFusedOdometryPair(
+                        source, *levels[4 * i + 1],
+                        *pairs[i].source_xyz_[level], *levels[4 * i + 2],
+                        *levels[4 * i + 3],
+                        pairs[i].pyramid_camera_matrix_[level], motions[i]);
+                counts[i] = (active[i]) ? source.depth_.width_ *
+                                                  source.depth_.height_
+                                        : 0;
+                any_active |= active[i];
+            }
+            if (!any_active) return;
+            cudaSafeCall(cudaMemcpyAsync(
+                    thrust::raw_pointer_cast(d_pairs.data()), h_pairs.data(),
+                    n_pairs * sizeof(fused_odometry_pair),
+                    cudaMemcpyHostToDevice, cudaStreamPerThread));
+            const BatchSystems systems =
+                    utility::ReduceJTJandJTrBatch<2>(func, counts);
+            for (int i = 0; i < n_pairs; ++i) {
+                utility::LogDebug(
+                        "Iter : {:d}, Level : {:d}, Pair : {:d}, "
+                        "Correspondences : {:d}",
+                        iter, level, i, thrust::get<3>(systems[i]));
+            }
+            update(systems, motions, active);
+        }
+    }
+}
+
+// Each pair solves its own motion, and stops at its first failure.
+struct independent_batch_update {
+    void operator()(const BatchSystems &systems,
+                    std::vector<Eigen::Matrix4f> &motions,
+                    std::vector<bool> &active) const {
+        for (size_t i = 0; i < systems.size(); ++i) {
+            if (!active[i]) continue;
+            bool is_success;
+            Eigen::Matrix4f curr_odo;
+            thrust::tie(is_success, curr_odo) =
+                    utility::SolveJacobianSystemAndObtainExtrinsicMatrix(
+                            thrust::get<0>(systems[i]),
+                            thrust::get<1>(systems[i]));
+            if (!is_success) {
+                utility::LogWarning("[ComputeRGBDOdometryBatch] no solution!");
+                active[i] = false;
+                motions[i] = Eigen::Matrix4f::Identity();
+            } else {
+                motions[i] = curr_odo * motions[i];
+            }
+        }
+    }
+};
+
+// Maps a twist of the rig frame to the twist of a camera of pose
+// camera_to_rig in the rig, both applied on the left of the motions.
+Eigen::Matrix6f RigToCameraTwist(const Eigen::Matrix4f &camera_to_rig) {
+    const Eigen::Matrix3f Rt = camera_to_rig.block<3, 3>(0, 0).transpose();
+    Eigen::Matrix3f t_skew;
+    t_skew << 0.0, -camera_to_rig(2, 3), camera_to_rig(1, 3),
+            camera_to_rig(2, 3), 0.0, -camera_to_rig(0, 3),
+            -camera_to_rig(1, 3), camera_to_rig(0, 3), 0.0;
+    Eigen::Matrix6f A = Eigen::Matrix6f::Zero();
+    A.block<3, 3>(0, 0) = Rt;
+    A.block<3, 3>(3, 0) = -Rt * t_skew;
+    A.block<3, 3>(3, 3) = Rt;
+    return A;
+}
+
+// The cameras share the motion of the rig: the normal equations of the
+// cameras are mapped to the rig twist and summed.
+struct rigid_batch_update {
+    rigid_batch_update(const std::vector<Eigen::Matrix4f> &camera_to_rig,
+                       Eigen::Matrix4f &rig_motion)
+        : rig_motion_(rig_motion) {
+        for (const auto &E : camera_to_rig) {
+            camera_to_rig_.push_back(E);
+            rig_to_camera_.push_back(E.inverse());
+            twist_maps_.push_back(RigToCameraTwist(E));
+        }
+    }
+    std::vector<Eigen::Matrix4f> camera_to_rig_;
+    std::vector<Eigen::Matrix4f> rig_to_camera_;
+    std::vector<Eigen::Matrix6f> twist_maps_;
+    Eigen::Matrix4f &rig_motion_;
+    void operator()(const BatchSystems &systems,
+                    std::vector<Eigen::Matrix4f> &motions,
+                    std::vector<bool> &active) const {
+        Eigen::Matrix6f JTJ = Eigen::Matrix6f::Zero();
+        Eigen::Vector6f JTr = Eigen::Vector6f::Zero();
+        for (size_t i = 0; i < systems.size(); ++i) {
+            const Eigen::Matrix6f &A = twist_maps_[i];
+            JTJ += A.transpose() * thrust::get<0>(systems[i]) * A;
+            JTr += A.transpose() * thrust::get<1>(systems[i]);
+        }
+        bool is_success;
+        Eigen::Matrix4f curr_odo;
+        thrust::tie(is_success, curr_odo) =
+                utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ, JTr);
+        if (!is_success) {
+            utility::LogWarning(
+                    "[ComputeMultiCameraRGBDOdometry] no solution!");
+            std::fill(active.begin(), active.end(), false);
+            return;
+        }
+        rig_motion_ = curr_odo * rig_motion_;
+        for (size_t i = 0; i < motions.size(); ++i) {
+            motions[i] = rig_to_camera_[i] * rig_motion_ * camera_to_rig_[i];
+        }
+    }
+};
+
+// Checks the inputs of the batched odometry. The pairs may differ in size.
+bool CheckBatchOdometryInput(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        size_t n_poses) {
+    if (sources.empty() || sources.size() != targets.size() ||
+        sources.size() != intrinsics.size() || sources.size() != n_poses) {
+        utility::LogWarning(
+                "[RGBDOdometry] One target, intrinsic and pose per source is "
+                "required.");
+        return false;
+    }
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (!sources[i] || !targets[i] ||
+            !CheckRGBDImagePair(*sources[i], *targets[i])) {
+            utility::LogWarning(
+                    "[RGBDOdometry] Two RGBD pairs should be same in size.");
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename JacobianType>
+std::vector<std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>>
+ComputeRGBDOdometryBatchT(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f> &odo_inits,
+        const OdometryOption &option) {
+    const size_t n_pairs = sources.size();
+    std::vector<BatchOdometryPair> pairs;
+    std::vector<Eigen::Matrix4f> motions;
+    for (size_t i = 0; i < n_pairs; ++i) {
+        pairs.push_back(PrepareBatchOdometryPair(*sources[i], *targets[i],
+                                                 intrinsics[i], odo_inits[i],
+                                                 option));
+        motions.push_back(odo_inits[i].isZero() ? Eigen::Matrix4f::Identity()
+                                                : odo_inits[i]);
+    }
+    std::vector<bool> active(n_pairs, true);
+    ComputeMultiscaleBatch<JacobianType>(pairs, motions, active, option,
+                                         independent_batch_update());
+    std::vector<std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>> res;
+    for (size_t i = 0; i < n_pairs; ++i) {
+        if (active[i]) {
+            res.emplace_back(true, motions[i],
+                             CreateInformationMatrix(
+                                     motions[i], intrinsics[i],
+                                     pairs[i].source_processed_->depth_,
+                                     pairs[i].target_processed_->depth_,
+                                     option));
+        } else {
+            res.emplace_back(false, Eigen::Matrix4f::Identity(),
+                             Eigen::Matrix6f::Identity());
+        }
+    }
+    return res;
+}
+
+template <typename JacobianType>
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>
+ComputeMultiCameraRGBDOdometryT(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f> &camera_to_rig,
+        const Eigen::Matrix4f &odo_init,
+        const OdometryOption &option) {
+    const size_t n_pairs = sources.size();
+    Eigen::Matrix4f rig_motion =
+            odo_init.isZero() ? Eigen::Matrix4f::Identity() : odo_init;
+    std::vector<BatchOdometryPair> pairs;
+    std::vector<Eigen::Matrix4f> motions;
+    for (size_t i = 0; i < n_pairs; ++i) {
+        motions.push_back(camera_to_rig[i].inverse() * rig_motion *
+                          camera_to_rig[i]);
+        pairs.push_back(PrepareBatchOdometryPair(
+                *sources[i], *targets[i], intrinsics[i], motions[i], option));
+    }
+    std::vector<bool> active(n_pairs, true);
+    const rigid_batch_update update(camera_to_rig, rig_motion);
+    ComputeMultiscaleBatch<JacobianType>(pairs, motions, active, option,
+                                         update);
+    if (!active[0]) {
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    Eigen::Matrix6f information = Eigen::Matrix6f::Zero();
+    for (size_t i = 0; i < n_pairs; ++i) {
+        const Eigen::Matrix6f &A = update.twist_maps_[i];
+        information += A.transpose() *
+                       CreateInformationMatrix(
+                               motions[i], intrinsics[i],
+                               pairs[i].source_processed_->depth_,
+                               pairs[i].target_processed_->depth_, option) *
+                       A;
+    }
+    return std::make_tuple(true, rig_motion, information);
+}
+
+struct compute_normal_map_functor {
+    compute_normal_map_functor(const uint8_t *xyz,
+                               int width,
+                               int height,
+                               uint8_t *normal)
+        : xyz_(xyz), width_(width), height_(height), normal_(normal){};
+    const uint8_t *xyz_;
+    const int width_;
+    const int height_;
+    uint8_t *normal_;
+    __device__ Eigen::Vector3f Vertex(int x, int y) const {
+        return Eigen::Vector3f(
+                *geometry::PointerAt<float>(xyz_, width_, 3, x, y, 0),
+                *geometry::PointerAt<float>(xyz_, width_, 3, x, y, 1),
+                *geometry::PointerAt<float>(xyz_, width_, 3, x, y, 2));
+    }
+    __device__ void operator()(size_t idx) {
+        int y = idx / width_;
+        int x = idx % width_;
+        Eigen::Vector3f n = Eigen::Vector3f::Constant(
+                std::numeric_limits<float>::quiet_NaN());
+        if (x + 1 < width_ && y + 1 < height_) {
+            const Eigen::Vector3f p = Vertex(x, y);
+            const Eigen::Vector3f px = Vertex(x + 1, y);
+            const Eigen::Vector3f py = Vertex(x, y + 1);
+            if (!isnan(p(2)) && !isnan(px(2)) && !isnan(py(2))) {
+                const Eigen::Vector3f c = (px - p).cross(py - p);
+                const float norm = c.norm();
+                if (norm > 0.0) n = c / norm;
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            *geometry::PointerAt<float>(normal_, width_, 3, x, y, i) = n(i);
+        }
+    }
+};
+
+/// Normal map of a vertex map, from the cross product of the differences
+/// to the right and lower neighbors. Pixels without both neighbors are NaN.
+std::shared_ptr<geometry::Image> ComputeNormalMap(const geometry::Image &xyz) {
+    auto normal = std::make_shared<geometry::Image>();
+    normal->Prepare(xyz.width_, xyz.height_, 3, 4);
+    compute_normal_map_functor func(
+            thrust::raw_pointer_cast(xyz.data_.data()), xyz.width_,
+            xyz.height_, thrust::raw_pointer_cast(normal->data_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(xyz.width_ *
+                                                            xyz.height_),
+                     func);
+    return normal;
+}
+
+// Projective data association of KinectFusion: the transformed source
+// vertex is projected into the target vertex map and paired with the vertex
+// found there, if it is within max_distance. The residual is the distance
+// to the target plane and the Jacobian is taken for a (rotation,
+// translation) perturbation applied after extrinsic.
+struct depth_icp_jacobian_and_residual_functor {
+    depth_icp_jacobian_and_residual_functor(const uint8_t *source_xyz,
+                                            const uint8_t *target_xyz,
+                                            const uint8_t *target_normal,
+                                            int width,
+                                            int height,
+                                            const Eigen::Matrix3f &intrinsic,
+                                            const Eigen::Matrix4f &extrinsic,
+                                            float max_distance)
+        : source_xyz_(source_xyz),
+          target_xyz_(target_xyz),
+          target_normal_(target_normal),
+          width_(width),
+          height_(height),
+          intrinsic_(intrinsic),
+          R_(extrinsic.block<3, 3>(0, 0)),
+          t_(extrinsic.block<3, 1>(0, 3)),
+          max_distance_(max_distance){};
+    const uint8_t *source_xyz_;
+    const uint8_t *target_xyz_;
+    const uint8_t *target_normal_;
+    const int width_;
+    const int height_;
+    const Eigen::Matrix3f intrinsic_;
+    const Eigen::Matrix3f R_;
+    const Eigen::Vector3f t_;
+    const float max_distance_;
+    __device__ Eigen::Vector3f At(const uint8_t *image, int x, int y) const {
+        return Eigen::Vector3f(
+                *geometry::PointerAt<float>(image, width_, 3, x, y, 0),
+                *geometry::PointerAt<float>(image, width_, 3, x, y, 1),
+                *geometry::PointerAt<float>(image, width_, 3, x, y, 2));
+    }
+    __device__ bool operator()(int idx,
+                               Eigen::Vector6f J_r[1],
+                               float r[1]) const {
+        int v_s = idx / width_;
+        int u_s = idx % width_;
+        const Eigen::Vector3f p_s = At(source_xyz_, u_s, v_s);
+        if (isnan(p_s(2))) return false;
+        const Eigen::Vector3f p = R_ * p_s + t_;
+        if (p(2) <= 0.0) return false;
+        int u_t = (int)(intrinsic_(0, 0) * p(0) / p(2) + intrinsic_(0, 2) + 0.5);
+        int v_t = (int)(intrinsic_(1, 1) * p(1) / p(2) + intrinsic_(1, 2) + 0.5);
+        if (u_t < 0 || u_t >= width_ || v_t < 0 || v_t >= height_) return false;
+        const Eigen::Vector3f q = At(target_xyz_, u_t, v_t);
+        const Eigen::Vector3f n = At(target_normal_, u_t, v_t);
+        if (isnan(q(2)) || isnan(n(0))) return false;
+        const Eigen::Vector3f d = p - q;
+        if (d.squaredNorm() > max_distance_ * max_distance_) return false;
+        J_r[0].head<3>() = p.cross(n);
+        J_r[0].tail<3>() = n;
+        r[0] = n.dot(d);
+        return true;
+    }
+};
+
+inline bool IsFloatDepth(const geometry::Image &image) {
+    return image.num_of_channels_ == 1 && image.bytes_per_channel_ == 4;
+}
+
+inline bool IsFloatMap(const geometry::Image &image) {
+    return image.num_of_channels_ == 3 && image.bytes_per_channel_ == 4;
+}
+
+struct subsample_map_functor {
+    subsample_map_functor(const uint8_t *src,
+                          int src_width,
+                          uint8_t *dst,
+                          int dst_width)
+        : src_(src), src_width_(src_width), dst_(dst), dst_width_(dst_width){};
+    const uint8_t *src_;
+    const int src_width_;
+    uint8_t *dst_;
+    const int dst_width_;
+    __device__ void operator()(size_t idx) {
+        int y = idx / dst_width_;
+        int x = idx % dst_width_;
+        for (int i = 0; i < 3; ++i) {
+            *geometry::PointerAt<float>(dst_, dst_width_, 3, x, y, i) =
+                    *geometry::PointerAt<float>(src_, src_width_, 3, 2 * x,
+                                                2 * y, i);
+        }
+    }
+};
+
+/// Every second pixel of a 3 channel float map, which at the intrinsics
+/// of the next pyramid level is the same ray.
+std::shared_ptr<geometry::Image> SubsampleMap(const geometry::Image &map) {
+    auto output = std::make_shared<geometry::Image>();
+    output->Prepare(map.width_ / 2, map.height_ / 2, 3, 4);
+    subsample_map_functor func(thrust::raw_pointer_cast(map.data_.data()),
+                               map.width_,
+                               thrust::raw_pointer_cast(output->data_.data()),
+                               output->width_);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(output->width_ *
+                                                            output->height_),
+                     func);
+    return output;
+}
+
+struct convert_xyz_to_depth_image_functor {
+    convert_xyz_to_depth_image_functor(const uint8_t *xyz,
+                                       int width,
+                                       uint8_t *depth)
+        : xyz_(xyz), width_(width), depth_(depth){};
+    const uint8_t *xyz_;
+    const int width_;
+    uint8_t *depth_;
+    __device__ void operator()(size_t idx) {
+        int y = idx / width_;
+        int x = idx % width_;
+        *geometry::PointerAt<float>(depth_, width_, x, y) =
+                *geometry::PointerAt<float>(xyz_, width_, 3, x, y, 2);
+    }
+};
+
+std::shared_ptr<geometry::Image> ConvertXYZImageToDepthImage(
+        const geometry::Image &xyz) {
+    auto depth = std::make_shared<geometry::Image>();
+    depth->Prepare(xyz.width_, xyz.height_, 1, 4);
+    convert_xyz_to_depth_image_functor func(
+            thrust::raw_pointer_cast(xyz.data_.data()), xyz.width_,
+            thrust::raw_pointer_cast(depth->data_.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(xyz.width_ *
+                                                            xyz.height_),
+                     func);
+    return depth;
+}
+
+/// Coarse to fine point-to-plane iterations of the source depth pyramid
+/// against per level target vertex and normal maps.
+std::tuple<bool, Eigen::Matrix4f> ComputeDepthICPMultiscale(
+        const geometry::ImagePyramid &source_pyramid,
+        const std::vector<std::shared_ptr<geometry::Image>> &target_xyz,
+        const std::vector<std::shared_ptr<geometry::Image>> &target_normal,
+        const std::vector<Eigen::Matrix3f> &pyramid_camera_matrix,
+        const Eigen::Matrix4f &extrinsic_initial,
+        const OdometryOption &option) {
+    std::vector<int> iter_counts = option.iteration_number_per_pyramid_level_;
+    const int num_levels = (int)iter_counts.size();
+    Eigen::Matrix4f result_odo = extrinsic_initial.isZero()
+                                         ? Eigen::Matrix4f::Identity()
+                                         : extrinsic_initial;
+    for (int level = num_levels - 1; level >= 0; level--) {
+        const Eigen::Matrix3f &level_camera_matrix =
+                pyramid_camera_matrix[level];
+        auto source_xyz = ConvertDepthImageToXYZImage(*source_pyramid[level],
+                                                      level_camera_matrix);
+        for (int iter = 0; iter < iter_counts[num_levels - level - 1]; iter++) {
+            depth_icp_jacobian_and_residual_functor func(
+                    thrust::raw_pointer_cast(source_xyz->data_.data()),
+                    thrust::raw_pointer_cast(target_xyz[level]->data_.data()),
+                    thrust::raw_pointer_cast(
+                            target_normal[level]->data_.data()),
+                    source_xyz->width_, source_xyz->height_,
+                    level_camera_matrix, result_odo, option.max_depth_diff_);
+            Eigen::Matrix6f JTJ;
+            Eigen::Vector6f JTr;
+            float r2;
+            int corresps_count;
+            std::tie(JTJ, JTr, r2, corresps_count) = ReduceFusedJTJandJTr<1>(
+                    func, source_xyz->width_ * source_xyz->height_);
+            utility::LogDebug(
+                    "Iter : {:d}, Level : {:d}, Correspondences : {:d}", iter,
+                    level, corresps_count);
+            bool is_success;
+            Eigen::Matrix4f curr_odo;
+            thrust::tie(is_success, curr_odo) =
+                    utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ,
+                                                                          JTr);
+            if (!is_success) {
+                utility::LogWarning("[ComputeDepthICPOdometry] no solution!");
+                return std::make_tuple(false, Eigen::Matrix4f::Identity());
+            }
+            result_odo = curr_odo * result_odo;
+        }
+    }
+    return std::make_tuple(true, result_odo);
+}
+
 }  // unnamed namespace
 
 std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> ComputeRGBDOdometry(
@@ -906,6 +1635,7 @@ std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> ComputeRGBDOdometry(
         const RGBDOdometryJacobian &jacobian_method
         /*=RGBDOdometryJacobianFromHybridTerm*/,
         const OdometryOption &option /*= OdometryOption()*/) {
+    CUPOCH_PROFILE("ComputeRGBDOdometry");
     if (jacobian_method.jacobian_type_ == RGBDOdometryJacobian::COLOR_TERM) {
         auto res = ComputeRGBDOdometryT<RGBDOdometryJacobianFromColorTerm>(
                 source, target, pinhole_camera_intrinsic, odo_init, Eigen::Vector6f::Zero(), option, false);
@@ -931,5 +1661,345 @@ std::tuple<bool, Eigen::Matrix4f, Eigen::Vector6f, Eigen::Matrix6f> ComputeWeigh
         source, target, pinhole_camera_intrinsic, odo_init, prev_twist, option, true);
 }
 
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> ComputeDepthICPOdometry(
+        const geometry::Image &source_depth,
+        const geometry::Image &target_depth,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic
+        /*= camera::PinholeCameraIntrinsic()*/,
+        const Eigen::Matrix4f &odo_init /*= Eigen::Matrix4f::Identity()*/,
+        const OdometryOption &option /*= OdometryOption()*/) {
+    if (!CheckImagePair(source_depth, target_depth) ||
+        !IsFloatDepth(source_depth) || !IsFloatDepth(target_depth)) {
+        utility::LogWarning(
+                "[ComputeDepthICPOdometry] Two float depth images of the "
+                "same size are required.");
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    auto source_preprocessed =
+            PreprocessDepth(utility::GetStream(0), source_depth, option);
+    auto target_preprocessed =
+            PreprocessDepth(utility::GetStream(1), target_depth, option);
+    utility::SynchronizeStreams(2);
+    auto source = source_preprocessed->Filter(
+            geometry::Image::FilterType::Gaussian3);
+    auto target = target_preprocessed->Filter(
+            geometry::Image::FilterType::Gaussian3);
+
+    const int num_levels =
+            (int)option.iteration_number_per_pyramid_level_.size();
+    auto source_pyramid = source->CreatePyramid(num_levels, false);
+    auto target_pyramid = target->CreatePyramid(num_levels, false);
+    std::vector<Eigen::Matrix3f> pyramid_camera_matrix =
+            CreateCameraMatrixPyramid(pinhole_camera_intrinsic, num_levels);
+    std::vector<std::shared_ptr<geometry::Image>> target_xyz, target_normal;
+    for (int level = 0; level < num_levels; level++) {
+        target_xyz.push_back(ConvertDepthImageToXYZImage(
+                *target_pyramid[level], pyramid_camera_matrix[level]));
+        target_normal.push_back(ComputeNormalMap(*target_xyz.back()));
+    }
+
+    bool is_success;
+    Eigen::Matrix4f extrinsic;
+    std::tie(is_success, extrinsic) =
+            ComputeDepthICPMultiscale(source_pyramid, target_xyz, target_normal,
+                                      pyramid_camera_matrix, odo_init, option);
+    if (!is_success) {
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    Eigen::Matrix6f info = CreateInformationMatrix(
+            extrinsic, pinhole_camera_intrinsic, *source, *target,
+            *target_xyz[0], option);
+    return std::make_tuple(true, extrinsic, info);
+}
+
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> ComputeDepthICPOdometry(
+        const geometry::Image &source_depth,
+        const geometry::Image &target_vertex_map,
+        const geometry::Image &target_normal_map,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic
+        /*= camera::PinholeCameraIntrinsic()*/,
+        const Eigen::Matrix4f &odo_init /*= Eigen::Matrix4f::Identity()*/,
+        const OdometryOption &option /*= OdometryOption()*/) {
+    if (!CheckImagePair(source_depth, target_vertex_map) ||
+        !CheckImagePair(source_depth, target_normal_map) ||
+        !IsFloatDepth(source_depth) || !IsFloatMap(target_vertex_map) ||
+        !IsFloatMap(target_normal_map)) {
+        utility::LogWarning(
+                "[ComputeDepthICPOdometry] A float depth image and 3 channel "
+                "float vertex and normal maps of the same size are "
+                "required.");
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    auto source_preprocessed =
+            PreprocessDepth(utility::GetStream(0), source_depth, option);
+    utility::SynchronizeStreams(1);
+    auto source = source_preprocessed->Filter(
+            geometry::Image::FilterType::Gaussian3);
+
+    const int num_levels =
+            (int)option.iteration_number_per_pyramid_level_.size();
+    auto source_pyramid = source->CreatePyramid(num_levels, false);
+    std::vector<Eigen::Matrix3f> pyramid_camera_matrix =
+            CreateCameraMatrixPyramid(pinhole_camera_intrinsic, num_levels);
+    // The maps are subsampled rather than smoothed: a vertex keeps lying on
+    // the surface and the level intrinsics project it to the same pixel.
+    std::vector<std::shared_ptr<geometry::Image>> target_xyz, target_normal;
+    target_xyz.push_back(std::make_shared<geometry::Image>(target_vertex_map));
+    target_normal.push_back(
+            std::make_shared<geometry::Image>(target_normal_map));
+    for (int level = 1; level < num_levels; level++) {
+        target_xyz.push_back(SubsampleMap(*target_xyz.back()));
+        target_normal.push_back(SubsampleMap(*target_normal.back()));
+    }
+
+    bool is_success;
+    Eigen::Matrix4f extrinsic;
+    std::tie(is_success, extrinsic) =
+            ComputeDepthICPMultiscale(source_pyramid, target_xyz, target_normal,
+                                      pyramid_camera_matrix, odo_init, option);
+    if (!is_success) {
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    auto target_depth = ConvertXYZImageToDepthImage(target_vertex_map);
+    Eigen::Matrix6f info = CreateInformationMatrix(
+            extrinsic, pinhole_camera_intrinsic, *source, *target_depth,
+            target_vertex_map, option);
+    return std::make_tuple(true, extrinsic, info);
+}
+
+std::vector<std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>>
+ComputeRGBDOdometryBatch(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f_u> &odo_inits
+        /*= std::vector<Eigen::Matrix4f_u>()*/,
+        const RGBDOdometryJacobian &jacobian_method
+        /*=RGBDOdometryJacobianFromHybridTerm*/,
+        const OdometryOption &option /*= OdometryOption()*/) {
+    CUPOCH_PROFILE("ComputeRGBDOdometryBatch");
+    std::vector<Eigen::Matrix4f> inits(odo_inits.begin(), odo_inits.end());
+    if (inits.empty()) {
+        inits.resize(sources.size(), Eigen::Matrix4f::Identity());
+    }
+    if (!CheckBatchOdometryInput(sources, targets, intrinsics, inits.size())) {
+        return std::vector<std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>>(
+                sources.size(),
+                std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                                Eigen::Matrix6f::Identity()));
+    }
+    if (jacobian_method.jacobian_type_ == RGBDOdometryJacobian::COLOR_TERM) {
+        return ComputeRGBDOdometryBatchT<RGBDOdometryJacobianFromColorTerm>(
+                sources, targets, intrinsics, inits, option);
+    } else {
+        return ComputeRGBDOdometryBatchT<RGBDOdometryJacobianFromHybridTerm>(
+                sources, targets, intrinsics, inits, option);
+    }
+}
+
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>
+ComputeMultiCameraRGBDOdometry(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f_u> &camera_to_rig,
+        const Eigen::Matrix4f &odo_init /*= Eigen::Matrix4f::Identity()*/,
+        const RGBDOdometryJacobian &jacobian_method
+        /*=RGBDOdometryJacobianFromHybridTerm*/,
+        const OdometryOption &option /*= OdometryOption()*/) {
+    CUPOCH_PROFILE("ComputeMultiCameraRGBDOdometry");
+    if (!CheckBatchOdometryInput(sources, targets, intrinsics,
+                                 camera_to_rig.size())) {
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    const std::vector<Eigen::Matrix4f> extrinsics(camera_to_rig.begin(),
+                                                  camera_to_rig.end());
+    if (jacobian_method.jacobian_type_ == RGBDOdometryJacobian::COLOR_TERM) {
+        return ComputeMultiCameraRGBDOdometryT<
+                RGBDOdometryJacobianFromColorTerm>(
+                sources, targets, intrinsics, extrinsics, odo_init, option);
+    } else {
+        return ComputeMultiCameraRGBDOdometryT<
+                RGBDOdometryJacobianFromHybridTerm>(
+                sources, targets, intrinsics, extrinsics, odo_init, option);
+    }
+}
+
+namespace {
+
+/// Levels of \p pyramid, added or dropped to \p num_levels.
+void ResizeLevels(geometry::RGBDImagePyramid &pyramid, size_t num_levels) {
+    while (pyramid.size() < num_levels) {
+        pyramid.push_back(std::make_shared<geometry::RGBDImage>());
+    }
+    pyramid.resize(num_levels);
+}
+
+}  // namespace
+
+/// Part of the preprocessing of ComputeRGBDOdometry() that depends only on
+/// one frame. The color levels are kept scaled by color_scale_.
+struct RGBDOdometryTracker::Frame {
+    geometry::RGBDImagePyramid pyramid_;
+    std::vector<std::shared_ptr<geometry::Image>> xyz_pyramid_;
+    /// Gradient pyramids, built when the frame becomes the target.
+    geometry::RGBDImagePyramid pyramid_dx_;
+    geometry::RGBDImagePyramid pyramid_dy_;
+    bool has_gradients_ = false;
+    float color_scale_ = 1.0;
+    /// Buffers of the preprocessing, kept when the frame is recycled.
+    geometry::Image gray_;
+    geometry::Image depth_;
+    geometry::Image filter_buffer_;
+    geometry::FloatImagePyramid color_levels_;
+    geometry::FloatImagePyramid depth_levels_;
+
+    /// Same preprocessing as InitializeRGBDOdometry() and
+    /// ComputeMultiscale(), without the intensity normalization.
+    void Build(const geometry::RGBDImage &frame,
+               const std::vector<Eigen::Matrix3f> &pyramid_camera_matrix,
+               const OdometryOption &option) {
+        const size_t num_levels = pyramid_camera_matrix.size();
+        frame.color_.Filter(geometry::Image::FilterType::Gaussian3, gray_,
+                            filter_buffer_);
+        auto depth_preprocessed =
+                PreprocessDepth(utility::GetStream(0), frame.depth_, option);
+        utility::SynchronizeStreams(1);
+        depth_preprocessed->Filter(geometry::Image::FilterType::Gaussian3,
+                                   depth_, filter_buffer_);
+        // As RGBDImage::CreatePyramid(), the depth is not blurred.
+        color_levels_.Build(gray_, num_levels, true);
+        depth_levels_.Build(depth_, num_levels, false);
+        ResizeLevels(pyramid_, num_levels);
+        for (size_t level = 0; level < num_levels; ++level) {
+            color_levels_.CopyLevel(level, pyramid_[level]->color_);
+            depth_levels_.CopyLevel(level, pyramid_[level]->depth_);
+        }
+        xyz_pyramid_ = CreateXYZImagePyramid(pyramid_, pyramid_camera_matrix);
+        has_gradients_ = false;
+        color_scale_ = 1.0;
+    }
+
+    void BuildGradients() {
+        if (has_gradients_) return;
+        ResizeLevels(pyramid_dx_, pyramid_.size());
+        ResizeLevels(pyramid_dy_, pyramid_.size());
+        for (size_t level = 0; level < pyramid_.size(); ++level) {
+            const auto &in = *pyramid_[level];
+            in.color_.Filter(geometry::Image::FilterType::Sobel3Dx,
+                             pyramid_dx_[level]->color_, filter_buffer_);
+            in.depth_.Filter(geometry::Image::FilterType::Sobel3Dx,
+                             pyramid_dx_[level]->depth_, filter_buffer_);
+            in.color_.Filter(geometry::Image::FilterType::Sobel3Dy,
+                             pyramid_dy_[level]->color_, filter_buffer_);
+            in.depth_.Filter(geometry::Image::FilterType::Sobel3Dy,
+                             pyramid_dy_[level]->depth_, filter_buffer_);
+        }
+        has_gradients_ = true;
+    }
+
+    void SetColorScale(float scale) {
+        const float factor = scale / color_scale_;
+        for (auto &level : pyramid_) level->color_.LinearTransform(factor);
+        if (has_gradients_) {
+            for (auto &level : pyramid_dx_) {
+                level->color_.LinearTransform(factor);
+            }
+            for (auto &level : pyramid_dy_) {
+                level->color_.LinearTransform(factor);
+            }
+        }
+        color_scale_ = scale;
+    }
+};
+
+RGBDOdometryTracker::RGBDOdometryTracker(
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
+        const RGBDOdometryJacobian &jacobian_method,
+        const OdometryOption &option)
+    : pinhole_camera_intrinsic_(pinhole_camera_intrinsic),
+      jacobian_type_(jacobian_method.jacobian_type_),
+      option_(option) {}
+
+RGBDOdometryTracker::~RGBDOdometryTracker() {}
+
+void RGBDOdometryTracker::Reset() {
+    previous_.reset();
+    spare_.reset();
+}
+
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> RGBDOdometryTracker::Track(
+        const geometry::RGBDImage &frame, const Eigen::Matrix4f &odo_init) {
+    if (!CheckRGBDImagePair(frame, frame)) {
+        utility::LogWarning("[RGBDOdometryTracker] Unsupported image format.");
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    const int num_levels =
+            (int)option_.iteration_number_per_pyramid_level_.size();
+    const std::vector<Eigen::Matrix3f> pyramid_camera_matrix =
+            CreateCameraMatrixPyramid(pinhole_camera_intrinsic_, num_levels);
+
+    std::unique_ptr<Frame> current =
+            spare_ ? std::move(spare_) : std::unique_ptr<Frame>(new Frame());
+    current->Build(frame, pyramid_camera_matrix, option_);
+
+    if (!previous_ || !CheckImagePair(previous_->pyramid_[0]->depth_,
+                                      current->pyramid_[0]->depth_)) {
+        spare_ = std::move(previous_);
+        previous_ = std::move(current);
+        return std::make_tuple(false, Eigen::Matrix4f::Identity(),
+                               Eigen::Matrix6f::Identity());
+    }
+    Frame &target = *previous_;
+    target.BuildGradients();
+
+    const geometry::Image &source_depth = current->pyramid_[0]->depth_;
+    const geometry::Image &target_depth = target.pyramid_[0]->depth_;
+    CorrespondenceSetPixelWise correspondence;
+    ComputeCorrespondence(pinhole_camera_intrinsic_.intrinsic_matrix_,
+                          odo_init, source_depth, target_depth, option_,
+                          correspondence);
+    float mean_s, mean_t;
+    thrust::tie(mean_s, mean_t) = ComputeIntensityMeans(
+            current->pyramid_[0]->color_, target.pyramid_[0]->color_,
+            correspondence);
+    current->SetColorScale(0.5 / mean_s);
+    target.SetColorScale(0.5 * target.color_scale_ / mean_t);
+
+    Eigen::Matrix4f extrinsic;
+    bool is_success;
+    if (jacobian_type_ == RGBDOdometryJacobian::COLOR_TERM) {
+        std::tie(is_success, extrinsic) =
+                ComputeMultiscaleFromPyramids<RGBDOdometryJacobianFromColorTerm>(
+                        current->pyramid_, current->xyz_pyramid_,
+                        target.pyramid_, target.pyramid_dx_,
+                        target.pyramid_dy_, pyramid_camera_matrix, odo_init,
+                        option_);
+    } else {
+        std::tie(is_success, extrinsic) = ComputeMultiscaleFromPyramids<
+                RGBDOdometryJacobianFromHybridTerm>(
+                current->pyramid_, current->xyz_pyramid_, target.pyramid_,
+                target.pyramid_dx_, target.pyramid_dy_, pyramid_camera_matrix,
+                odo_init, option_);
+    }
+    Eigen::Matrix6f information = Eigen::Matrix6f::Identity();
+    if (is_success) {
+        information = CreateInformationMatrix(
+                extrinsic, pinhole_camera_intrinsic_, source_depth,
+                target_depth, *target.xyz_pyramid_[0], option_);
+    } else {
+        extrinsic = Eigen::Matrix4f::Identity();
+    }
+    spare_ = std::move(previous_);
+    previous_ = std::move(current);
+    return std::make_tuple(is_success, extrinsic, information);
+}
+
 }  // namespace odometry
 }  // namespace cupoch
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>
 #include <tuple>
+#include <vector>
 
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/odometry/odometry_option.h"
@@ -10,6 +12,7 @@
 namespace cupoch {
 
 namespace geometry {
+class Image;
 class RGBDImage;
 }
 
@@ -37,5 +40,124 @@ std::tuple<bool, Eigen::Matrix4f, Eigen::Vector6f, Eigen::Matrix6f> ComputeWeigh
                 RGBDOdometryJacobianFromHybridTerm(),
         const OdometryOption &option = OdometryOption());
 
+/// Depth only odometry for scenes without texture: point-to-plane ICP with
+/// the projective association of KinectFusion. Every source pixel is
+/// transformed, projected into the target and paired with the target vertex
+/// at that pixel if they are closer than OdometryOption::max_depth_diff_,
+/// so no KD-tree is built. The vertex and normal maps are computed per
+/// pyramid level, and each iteration is one pass over the pixels.
+/// \p source_depth and \p target_depth are float depth images in meters,
+/// as in RGBDImage::depth_.
+/// output: is_success, 4x4 motion matrix, 6x6 information matrix
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> ComputeDepthICPOdometry(
+        const geometry::Image &source_depth,
+        const geometry::Image &target_depth,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic =
+                camera::PinholeCameraIntrinsic(),
+        const Eigen::Matrix4f &odo_init = Eigen::Matrix4f::Identity(),
+        const OdometryOption &option = OdometryOption());
+
+/// Frame to model variant of ComputeDepthICPOdometry(): the target is given
+/// by the vertex and normal maps of a model seen from the target camera,
+/// such as the ones of integration::UniformTSDFVolume::Raycast(), so that
+/// tracking and integration form a loop without extracting a mesh. The maps
+/// are 3 channel float images in the target camera frame, NaN where there
+/// is no surface, of the size of \p source_depth.
+/// output: is_success, 4x4 motion matrix, 6x6 information matrix
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> ComputeDepthICPOdometry(
+        const geometry::Image &source_depth,
+        const geometry::Image &target_vertex_map,
+        const geometry::Image &target_normal_map,
+        const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic =
+                camera::PinholeCameraIntrinsic(),
+        const Eigen::Matrix4f &odo_init = Eigen::Matrix4f::Identity(),
+        const OdometryOption &option = OdometryOption());
+
+/// ComputeRGBDOdometry() of several independent pairs, e.g. the cameras of
+/// a rig, in the same launches: each Gauss-Newton iteration evaluates and
+/// reduces the normal equations of all the pairs in one kernel, which fills
+/// the GPU at resolutions where a single pair does not. The filtering and
+/// the pyramids are built per pair. The pairs may differ in size and
+/// intrinsics, and \p odo_inits is empty or has one initial motion per pair.
+/// A pair without solution stops iterating and fails alone.
+/// output: is_success, 4x4 motion matrix, 6x6 information matrix per pair
+std::vector<std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>>
+ComputeRGBDOdometryBatch(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f_u> &odo_inits =
+                std::vector<Eigen::Matrix4f_u>(),
+        const RGBDOdometryJacobian &jacobian_method =
+                RGBDOdometryJacobianFromHybridTerm(),
+        const OdometryOption &option = OdometryOption());
+
+/// Odometry of rigidly coupled cameras sharing one motion, batched as
+/// ComputeRGBDOdometryBatch(). \p camera_to_rig holds the pose of each
+/// camera in the rig frame, the motion of camera i being
+/// camera_to_rig[i]^-1 * T * camera_to_rig[i] for the rig motion T. The
+/// normal equations of the cameras are mapped to the twist of the rig and
+/// summed, so a camera looking at a textureless wall is constrained by the
+/// others.
+/// output: is_success, 4x4 rig motion matrix, 6x6 information matrix
+std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f>
+ComputeMultiCameraRGBDOdometry(
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &sources,
+        const std::vector<std::shared_ptr<geometry::RGBDImage>> &targets,
+        const std::vector<camera::PinholeCameraIntrinsic> &intrinsics,
+        const std::vector<Eigen::Matrix4f_u> &camera_to_rig,
+        const Eigen::Matrix4f &odo_init = Eigen::Matrix4f::Identity(),
+        const RGBDOdometryJacobian &jacobian_method =
+                RGBDOdometryJacobianFromHybridTerm(),
+        const OdometryOption &option = OdometryOption());
+
+/// \class RGBDOdometryTracker
+///
+/// \brief Frame to frame RGB-D odometry that keeps the preprocessed previous
+/// frame.
+///
+/// ComputeRGBDOdometry() filters both images, builds their pyramids and the
+/// gradient pyramids of the target on every call. In tracking, the source of
+/// one call is the target of the next, so Track() preprocesses only the new
+/// frame and takes the previous one from the cache. Only the intensity
+/// normalization, which depends on the pair, is redone, as a scale of the
+/// cached color levels. The result is the same as ComputeRGBDOdometry(frame,
+/// previous frame). The frames are recycled, so once the size of the images
+/// is known the preprocessing and the pyramids do not allocate.
+class RGBDOdometryTracker {
+public:
+    RGBDOdometryTracker(
+            const camera::PinholeCameraIntrinsic &pinhole_camera_intrinsic,
+            const RGBDOdometryJacobian &jacobian_method =
+                    RGBDOdometryJacobianFromHybridTerm(),
+            const OdometryOption &option = OdometryOption());
+    ~RGBDOdometryTracker();
+    RGBDOdometryTracker(const RGBDOdometryTracker &) = delete;
+    RGBDOdometryTracker &operator=(const RGBDOdometryTracker &) = delete;
+
+public:
+    /// Odometry from \p frame to the previous frame, which \p frame then
+    /// replaces. The first frame, or a frame of another size than the
+    /// previous one, only fills the cache and returns is_success false.
+    /// output: is_success, 4x4 motion matrix, 6x6 information matrix
+    std::tuple<bool, Eigen::Matrix4f, Eigen::Matrix6f> Track(
+            const geometry::RGBDImage &frame,
+            const Eigen::Matrix4f &odo_init = Eigen::Matrix4f::Identity());
+    bool HasPreviousFrame() const { return bool(previous_); }
+    /// Drops the previous frame.
+    void Reset();
+
+private:
+    struct Frame;
+
+    camera::PinholeCameraIntrinsic pinhole_camera_intrinsic_;
+    RGBDOdometryJacobian::OdometryJacobianType jacobian_type_;
+    OdometryOption option_;
+    std::unique_ptr<Frame> previous_;
+    /// Previous target, recycled for the next frame so that the buffers of
+    /// its images and pyramids are reused.
+    std::unique_ptr<Frame> spare_;
+};
+
 }  // namespace odometry
 }  // namespace cupoch
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "cupoch/planning/planner.h"
+#include "cupoch/geometry/aabb_tree.h"
 #include "cupoch/collision/collision.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/occupancygrid.h"
 #include "cupoch/geometry/voxelgrid.h"
 #include "cupoch/utility/console.h"
 
@@ -8,6 +11,140 @@
 namespace cupoch {
 namespace planning {
 
+namespace {
+
+const unsigned int kInfCost = 0x7f800000;
+
+struct is_hit_functor {
+    __device__ bool operator() (int hit) const { return hit >= 0; }
+};
+
+struct block_near_sites_functor {
+    block_near_sites_functor(const geometry::DistanceVoxel* voxels, float min_distance)
+    : voxels_(voxels), min_distance_(min_distance) {};
+    const geometry::DistanceVoxel* voxels_;
+    const float min_distance_;
+    __device__ uint8_t operator() (size_t idx) const {
+        const geometry::DistanceVoxel& v = voxels_[idx];
+        return (!v.IsNotSite() && v.distance_ < min_distance_) ? 1 : 0;
+    }
+};
+
+struct block_unknown_functor {
+    block_unknown_functor(const geometry::DenseGridView<geometry::CompactOccupancyVoxel>& view,
+                          uint8_t* blocked)
+    : view_(view), blocked_(blocked) {};
+    const geometry::DenseGridView<geometry::CompactOccupancyVoxel> view_;
+    uint8_t* blocked_;
+    __device__ void operator() (size_t idx) const {
+        const int r = view_.resolution_;
+        Eigen::Vector3i xyz(idx / (r * r), (idx / r) % r, idx % r);
+        if (view_.voxels_[view_.GetStorageIndex(xyz)].IsUnknown()) blocked_[idx] = 1;
+    }
+};
+
+struct relax_grid_frontier_functor {
+    relax_grid_frontier_functor(const uint8_t* blocked, unsigned int* costs,
+                                int* stamps, int stamp,
+                                int* next_frontier, int* n_next,
+                                int resolution, float voxel_size)
+    : blocked_(blocked), costs_(costs), stamps_(stamps), stamp_(stamp),
+      next_frontier_(next_frontier), n_next_(n_next),
+      resolution_(resolution), voxel_size_(voxel_size) {};
+    const uint8_t* blocked_;
+    unsigned int* costs_;
+    int* stamps_;
+    const int stamp_;
+    int* next_frontier_;
+    int* n_next_;
+    const int resolution_;
+    const float voxel_size_;
+    __device__ void operator() (int c) {
+        const int r = resolution_;
+        const int x = c / (r * r);
+        const int y = (c / r) % r;
+        const int z = c % r;
+        const float dc = __uint_as_float(costs_[c]);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const int nx = x + dx;
+                    const int ny = y + dy;
+                    const int nz = z + dz;
+                    if ((dx == 0 && dy == 0 && dz == 0) ||
+                        nx < 0 || nx >= r || ny < 0 || ny >= r || nz < 0 || nz >= r) continue;
+                    const int n = IndexOf(nx, ny, nz, r);
+                    if (blocked_[n]) continue;
+                    const unsigned int dn = __float_as_uint(
+                            dc + voxel_size_ * sqrtf(dx * dx + dy * dy + dz * dz));
+                    if (dn < atomicMin(costs_ + n, dn) &&
+                        atomicExch(stamps_ + n, stamp_) != stamp_) {
+                        next_frontier_[atomicAdd(n_next_, 1)] = n;
+                    }
+                }
+            }
+        }
+    }
+};
+
+/// Descent of the cost field from the start voxel, by a single thread.
+struct descend_cost_functor {
+    descend_cost_functor(const unsigned int* costs, int start_index, int goal_index,
+                         int resolution, float voxel_size, int max_length,
+                         int* path, int* length)
+    : costs_(costs), start_index_(start_index), goal_index_(goal_index),
+      resolution_(resolution), voxel_size_(voxel_size), max_length_(max_length),
+      path_(path), length_(length) {};
+    const unsigned int* costs_;
+    const int start_index_;
+    const int goal_index_;
+    const int resolution_;
+    const float voxel_size_;
+    const int max_length_;
+    int* path_;
+    int* length_;
+    __device__ void operator() (size_t idx) {
+        const int r = resolution_;
+        int c = start_index_;
+        int n_path = 0;
+        if (costs_[c] == kInfCost) {
+            *length_ = 0;
+            return;
+        }
+        path_[n_path++] = c;
+        while (c != goal_index_ && n_path < max_length_) {
+            const int x = c / (r * r);
+            const int y = (c / r) % r;
+            const int z = c % r;
+            float best = __uint_as_float(costs_[c]);
+            int best_n = -1;
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dz = -1; dz <= 1; ++dz) {
+                        const int nx = x + dx;
+                        const int ny = y + dy;
+                        const int nz = z + dz;
+                        if ((dx == 0 && dy == 0 && dz == 0) ||
+                            nx < 0 || nx >= r || ny < 0 || ny >= r || nz < 0 || nz >= r) continue;
+                        const int n = IndexOf(nx, ny, nz, r);
+                        const float d = __uint_as_float(costs_[n]);
+                        if (d < best) {
+                            best = d;
+                            best_n = n;
+                        }
+                    }
+                }
+            }
+            if (best_n < 0) break;
+            c = best_n;
+            path_[n_path++] = c;
+        }
+        *length_ = (c == goal_index_) ? n_path : 0;
+    }
+};
+
+}
+
 PlannerBase &PlannerBase::AddObstacle(const std::shared_ptr<geometry::Geometry>& obstacle) {
     obstacles_.push_back(obstacle);
     return *this;
@@ -20,27 +157,36 @@ SimplePlanner::SimplePlanner(const geometry::Graph& graph, float object_radius)
 SimplePlanner::~SimplePlanner() {}
 
 SimplePlanner &SimplePlanner::UpdateGraph() {
+    // All the obstacles go to one tree, so that the edges are tested against
+    // them in a single launch.
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
     for (const auto& obstacle : obstacles_) {
-        auto res = std::make_shared<collision::CollisionResult>();
         switch (obstacle->GetGeometryType()) {
             case geometry::Geometry::GeometryType::VoxelGrid: {
                 const geometry::VoxelGrid& voxel_grid = (const geometry::VoxelGrid&)(*obstacle);
-                res = collision::ComputeIntersection(voxel_grid, graph_, object_radius_);
+                geometry::AABBTree::AppendBoxes(voxel_grid, min_bounds, max_bounds);
+                break;
+            }
+            case geometry::Geometry::GeometryType::OccupancyGrid: {
+                const geometry::OccupancyGrid& occ_grid = (const geometry::OccupancyGrid&)(*obstacle);
+                geometry::AABBTree::AppendBoxes(occ_grid, min_bounds, max_bounds);
+                break;
             }
             default: {
                 utility::LogError("Unsupported obstacle type.");
             }
         }
-        if (res->IsCollided()) {
-            utility::device_vector<Eigen::Vector2i> remove_edges(res->collision_index_pairs_.size());
-            thrust::gather(thrust::make_transform_iterator(res->collision_index_pairs_.begin(),
-                                                           extract_element_functor<int, 2, 1>()),
-                           thrust::make_transform_iterator(res->collision_index_pairs_.end(),
-                                                           extract_element_functor<int, 2, 1>()),
-                           graph_.lines_.begin(), remove_edges.begin());
-            graph_.RemoveEdges(remove_edges);
-        }
     }
+    if (min_bounds.empty() || graph_.lines_.empty()) return *this;
+    geometry::AABBTree tree;
+    tree.Build(min_bounds, max_bounds);
+    auto hits = tree.IntersectLineSegments(graph_.points_, graph_.lines_, object_radius_);
+    utility::device_vector<Eigen::Vector2i> remove_edges(graph_.lines_.size());
+    auto end = thrust::copy_if(graph_.lines_.begin(), graph_.lines_.end(), hits.begin(),
+                               remove_edges.begin(), is_hit_functor());
+    remove_edges.resize(thrust::distance(remove_edges.begin(), end));
+    if (!remove_edges.empty()) graph_.RemoveEdges(remove_edges);
     return *this;
 }
 
@@ -51,7 +197,7 @@ std::shared_ptr<Path> SimplePlanner::FindPath(const Eigen::Vector3f& start, cons
     ex_graph.AddNodeAndConnect(start, max_edge_distance_, false);
     ex_graph.AddNodeAndConnect(goal, max_edge_distance_, false);
     ex_graph.ConstructGraph();
-    auto path_idxs = ex_graph.DijkstraPath(n_start, n_goal);
+    auto path_idxs = ex_graph.AStarPath(n_start, n_goal);
     utility::pinned_host_vector<Eigen::Vector3f> h_points = ex_graph.points_;
     auto out = std::make_shared<Path>();
     for (const auto& i : *path_idxs) {
@@ -61,5 +207,119 @@ std::shared_ptr<Path> SimplePlanner::FindPath(const Eigen::Vector3f& start, cons
 }
 
 
+GridPlanner::GridPlanner(float object_radius) : object_radius_(object_radius) {}
+
+GridPlanner::~GridPlanner() {}
+
+GridPlanner &GridPlanner::UpdateMap(const geometry::OccupancyGrid &grid) {
+    geometry::DistanceTransform dt(grid.voxel_size_, grid.resolution_, grid.origin_);
+    dt.ComputeEDT(grid);
+    UpdateMap(dt);
+    if (!unknown_as_free_) {
+        block_unknown_functor func(grid.GetView(), thrust::raw_pointer_cast(blocked_.data()));
+        thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                         thrust::make_counting_iterator(blocked_.size()), func);
+    }
+    return *this;
+}
+
+GridPlanner &GridPlanner::UpdateMap(const geometry::DistanceTransform &distance_transform) {
+    voxel_size_ = distance_transform.voxel_size_;
+    resolution_ = distance_transform.resolution_;
+    origin_ = distance_transform.origin_;
+    blocked_.resize(distance_transform.voxels_.size());
+    // The distances of the transform are in voxels.
+    block_near_sites_functor func(thrust::raw_pointer_cast(distance_transform.voxels_.data()),
+                                  object_radius_ / voxel_size_);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(blocked_.size()),
+                      blocked_.begin(), func);
+    goal_index_ = -1;
+    return *this;
+}
+
+int GridPlanner::GetCellIndex(const Eigen::Vector3f& point) const {
+    const Eigen::Vector3i idx = (Eigen::floor(((point - origin_) / voxel_size_).array()))
+                                        .matrix().cast<int>() +
+                                Eigen::Vector3i::Constant(resolution_ / 2);
+    if ((idx.array() < 0).any() || (idx.array() >= resolution_).any()) return -1;
+    return IndexOf(idx, resolution_);
+}
+
+bool GridPlanner::IsBlocked(const Eigen::Vector3f& point) const {
+    const int idx = GetCellIndex(point);
+    return idx < 0 || blocked_[idx] != 0;
+}
+
+void GridPlanner::ComputeCostToGoal(int goal_index) const {
+    const size_t n_cells = blocked_.size();
+    cost_to_goal_.resize(n_cells);
+    thrust::fill(cost_to_goal_.begin(), cost_to_goal_.end(), kInfCost);
+    cost_to_goal_[goal_index] = 0;
+    utility::device_vector<int> stamps(n_cells, -1);
+    utility::device_vector<int> frontier(n_cells);
+    utility::device_vector<int> next(n_cells);
+    utility::device_vector<int> n_next(1);
+    frontier[0] = goal_index;
+    int n_frontier = 1;
+    int stamp = 0;
+    while (n_frontier > 0) {
+        n_next[0] = 0;
+        relax_grid_frontier_functor func(thrust::raw_pointer_cast(blocked_.data()),
+                                         thrust::raw_pointer_cast(cost_to_goal_.data()),
+                                         thrust::raw_pointer_cast(stamps.data()), stamp++,
+                                         thrust::raw_pointer_cast(next.data()),
+                                         thrust::raw_pointer_cast(n_next.data()),
+                                         resolution_, voxel_size_);
+        thrust::for_each(frontier.begin(), frontier.begin() + n_frontier, func);
+        n_frontier = n_next[0];
+        frontier.swap(next);
+    }
+    goal_index_ = goal_index;
+}
+
+std::shared_ptr<Path> GridPlanner::FindPath(const Eigen::Vector3f& start, const Eigen::Vector3f& goal) const {
+    auto out = std::make_shared<Path>();
+    if (blocked_.empty()) {
+        utility::LogError("[GridPlanner] UpdateMap has not been called.");
+        return out;
+    }
+    const int start_index = GetCellIndex(start);
+    const int goal_index = GetCellIndex(goal);
+    if (start_index < 0 || goal_index < 0 || blocked_[start_index] || blocked_[goal_index]) {
+        utility::LogWarning("[GridPlanner] The start or the goal is blocked.");
+        return out;
+    }
+    if (goal_index != goal_index_) ComputeCostToGoal(goal_index);
+
+    const unsigned int start_bits = cost_to_goal_[start_index];
+    if (start_bits == kInfCost) return out;
+    float start_cost;
+    memcpy(&start_cost, &start_bits, sizeof(float));
+    // Every step of the descent lowers the cost by at least one voxel size.
+    const int max_length = (int)(start_cost / voxel_size_) + 2;
+    utility::device_vector<int> path(max_length);
+    utility::device_vector<int> length(1);
+    descend_cost_functor func(thrust::raw_pointer_cast(cost_to_goal_.data()),
+                              start_index, goal_index, resolution_, voxel_size_, max_length,
+                              thrust::raw_pointer_cast(path.data()),
+                              thrust::raw_pointer_cast(length.data()));
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(1), func);
+    const int n_path = length[0];
+    if (n_path == 0) return out;
+    thrust::host_vector<int> h_path(path.begin(), path.begin() + n_path);
+    const int r = resolution_;
+    out->push_back(start);
+    for (int i = 1; i < n_path - 1; ++i) {
+        const int c = h_path[i];
+        Eigen::Vector3i xyz(c / (r * r), (c / r) % r, c % r);
+        out->push_back(((xyz - Eigen::Vector3i::Constant(r / 2)).cast<float>() +
+                        Eigen::Vector3f::Constant(0.5)) * voxel_size_ + origin_);
+    }
+    out->push_back(goal);
+    return out;
+}
+
 }
 }
\ No newline at end of file
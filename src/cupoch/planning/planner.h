@@ -3,6 +3,11 @@
 #include <vector>
 
 namespace cupoch {
+namespace geometry {
+class OccupancyGrid;
+class DistanceTransform;
+}
+
 namespace planning {
 
 typedef std::vector<Eigen::Vector3f> Path;
@@ -32,5 +37,51 @@ public:
     float max_edge_distance_ = 1.0;
 };
 
+/// \class GridPlanner
+///
+/// \brief Planner over the implicit 26 neighbor graph of the voxels of a
+/// dense map, without an explicit Graph.
+///
+/// UpdateMap() marks the voxels closer than object_radius_ to an obstacle
+/// as blocked. FindPath() computes the cost to the goal of every reachable
+/// voxel by a wavefront from the goal on the device, and follows its
+/// descent from the start. The cost field is kept until the goal or the map
+/// changes, so replanning from a moving start is a single descent. The
+/// obstacles_ of PlannerBase are not used.
+class GridPlanner : public PlannerBase {
+public:
+    GridPlanner(float object_radius = 0.1);
+    ~GridPlanner();
+
+    /// Blocks the voxels near the occupied ones of \p grid, and the unknown
+    /// ones unless unknown_as_free_. The resolution of \p grid must be a
+    /// multiple of 8 for its EDT.
+    GridPlanner &UpdateMap(const geometry::OccupancyGrid &grid);
+    /// Blocks the voxels of \p distance_transform closer than
+    /// object_radius_ to a site.
+    GridPlanner &UpdateMap(const geometry::DistanceTransform &distance_transform);
+
+    std::shared_ptr<Path> FindPath(const Eigen::Vector3f& start, const Eigen::Vector3f& goal) const;
+
+    bool IsBlocked(const Eigen::Vector3f& point) const;
+
+public:
+    float object_radius_;
+    bool unknown_as_free_ = false;
+
+private:
+    int GetCellIndex(const Eigen::Vector3f& point) const;
+    void ComputeCostToGoal(int goal_index) const;
+
+    float voxel_size_ = 0.0;
+    int resolution_ = 0;
+    Eigen::Vector3f origin_ = Eigen::Vector3f::Zero();
+    utility::device_vector<uint8_t> blocked_;
+    /// Cost to goal_index_ of every voxel in metric units, as the bits of
+    /// the floats for atomicMin.
+    mutable utility::device_vector<unsigned int> cost_to_goal_;
+    mutable int goal_index_ = -1;
+};
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include <thrust/gather.h>
+#include <thrust/random.h>
+#include <thrust/scatter.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "cupoch/planning/sampling_planner.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+
+namespace cupoch {
+namespace planning {
+
+namespace {
+
+__device__ unsigned int HashSeed(unsigned int seed, unsigned int idx) {
+    unsigned int h = seed ^ (idx * 0x9e3779b9u);
+    h = (h ^ 61) ^ (h >> 16);
+    h *= 9;
+    h = h ^ (h >> 4);
+    h *= 0x27d4eb2d;
+    return h ^ (h >> 15);
+}
+
+struct sample_uniform_functor {
+    sample_uniform_functor(const Eigen::Vector3f& min_bound,
+                           const Eigen::Vector3f& extent,
+                           unsigned int seed)
+    : min_bound_(min_bound), extent_(extent), seed_(seed) {};
+    const Eigen::Vector3f min_bound_;
+    const Eigen::Vector3f extent_;
+    const unsigned int seed_;
+    __device__ Eigen::Vector3f operator() (size_t idx) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        thrust::uniform_real_distribution<float> dist(0.0, 1.0);
+        const float x = dist(rng);
+        const float y = dist(rng);
+        const float z = dist(rng);
+        return min_bound_ + extent_.cwiseProduct(Eigen::Vector3f(x, y, z));
+    }
+};
+
+struct is_invalid_functor {
+    __device__ bool operator() (uint8_t valid) const { return valid == 0; }
+};
+
+struct touches_node_functor {
+    touches_node_functor(int first_node) : first_node_(first_node) {};
+    const int first_node_;
+    __device__ bool operator() (const Eigen::Vector2i& line) const {
+        return line[0] >= first_node_ || line[1] >= first_node_;
+    }
+};
+
+/// Brute force nearest node, the trees of a query being small next to the
+/// batches.
+struct nearest_node_functor {
+    nearest_node_functor(const Eigen::Vector3f* nodes, int n_nodes)
+    : nodes_(nodes), n_nodes_(n_nodes) {};
+    const Eigen::Vector3f* nodes_;
+    const int n_nodes_;
+    __device__ int operator() (const Eigen::Vector3f& point) const {
+        int best = 0;
+        float best_dist = (nodes_[0] - point).squaredNorm();
+        for (int i = 1; i < n_nodes_; ++i) {
+            const float d = (nodes_[i] - point).squaredNorm();
+            if (d < best_dist) {
+                best_dist = d;
+                best = i;
+            }
+        }
+        return best;
+    }
+};
+
+struct steer_functor {
+    steer_functor(const Eigen::Vector3f* nodes, float step_size)
+    : nodes_(nodes), step_size_(step_size) {};
+    const Eigen::Vector3f* nodes_;
+    const float step_size_;
+    __device__ Eigen::Vector3f operator() (const thrust::tuple<Eigen::Vector3f, int>& x) const {
+        const Eigen::Vector3f& from = nodes_[thrust::get<1>(x)];
+        const Eigen::Vector3f d = thrust::get<0>(x) - from;
+        const float len = d.norm();
+        return (len <= step_size_) ? thrust::get<0>(x) : Eigen::Vector3f(from + d * (step_size_ / len));
+    }
+};
+
+/// Removes the invalid edges of the nodes from \p first_node, the others
+/// being already checked.
+void RemoveInvalidEdges(geometry::Graph& graph, const ValidityChecker& checker, int first_node) {
+    const size_t n_lines = graph.lines_.size();
+    const bool has_weights = graph.HasWeights();
+    const bool has_colors = graph.HasColors();
+    utility::device_vector<int> indices(n_lines);
+    auto end = thrust::copy_if(thrust::make_counting_iterator<int>(0),
+                               thrust::make_counting_iterator<int>(n_lines),
+                               graph.lines_.begin(), indices.begin(),
+                               touches_node_functor(first_node));
+    indices.resize(thrust::distance(indices.begin(), end));
+    utility::device_vector<Eigen::Vector2i> lines(indices.size());
+    thrust::gather(indices.begin(), indices.end(), graph.lines_.begin(), lines.begin());
+    utility::device_vector<uint8_t> valid;
+    checker.CheckLines(graph.points_, lines, valid);
+    utility::device_vector<uint8_t> keep(n_lines, 1);
+    thrust::scatter(valid.begin(), valid.end(), indices.begin(), keep.begin());
+    auto end_lines = thrust::remove_if(graph.lines_.begin(), graph.lines_.end(),
+                                       keep.begin(), is_invalid_functor());
+    graph.lines_.resize(thrust::distance(graph.lines_.begin(), end_lines));
+    if (has_weights) {
+        auto end_weights = thrust::remove_if(graph.edge_weights_.begin(), graph.edge_weights_.end(),
+                                             keep.begin(), is_invalid_functor());
+        graph.edge_weights_.resize(thrust::distance(graph.edge_weights_.begin(), end_weights));
+    }
+    if (has_colors) {
+        auto end_colors = thrust::remove_if(graph.colors_.begin(), graph.colors_.end(),
+                                            keep.begin(), is_invalid_functor());
+        graph.colors_.resize(thrust::distance(graph.colors_.begin(), end_colors));
+    }
+    if (!graph.lines_.empty()) graph.ConstructGraph();
+}
+
+bool IsValidPoint(const ValidityChecker& checker, const Eigen::Vector3f& point) {
+    utility::device_vector<Eigen::Vector3f> points(1, point);
+    utility::device_vector<uint8_t> valid;
+    checker.CheckPoints(points, valid);
+    return valid[0] != 0;
+}
+
+}  // namespace
+
+PRMStarPlanner::PRMStarPlanner(const Eigen::Vector3f& min_bound,
+                               const Eigen::Vector3f& max_bound,
+                               const std::shared_ptr<ValidityChecker>& checker,
+                               int n_samples, unsigned int seed)
+    : min_bound_(min_bound), max_bound_(max_bound), checker_(checker),
+      n_samples_(n_samples), seed_(seed) {}
+
+PRMStarPlanner::~PRMStarPlanner() {}
+
+float PRMStarPlanner::GetConnectionRadius(size_t n) const {
+    // gamma of Karaman and Frazzoli for d = 3, the unit ball being 4/3 pi.
+    const float volume = (max_bound_ - min_bound_).prod();
+    const float gamma = 2.0 * std::cbrt(4.0 / 3.0) * std::cbrt(volume / (4.0 / 3.0 * M_PI));
+    const float n_f = std::max<float>(n, 2);
+    return radius_scale_ * gamma * std::cbrt(std::log(n_f) / n_f);
+}
+
+PRMStarPlanner &PRMStarPlanner::Build() {
+    if (!checker_) {
+        utility::LogError("[PRMStarPlanner::Build] The validity checker is not set.");
+        return *this;
+    }
+    utility::device_vector<Eigen::Vector3f> samples(n_samples_);
+    sample_uniform_functor func(min_bound_, max_bound_ - min_bound_, seed_);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator<size_t>(n_samples_),
+                      samples.begin(), func);
+    utility::device_vector<uint8_t> valid;
+    checker_->CheckPoints(samples, valid);
+    auto end = thrust::remove_if(samples.begin(), samples.end(), valid.begin(), is_invalid_functor());
+    samples.resize(thrust::distance(samples.begin(), end));
+    graph_ = geometry::Graph(samples);
+    if (samples.size() < 2) {
+        utility::LogWarning("[PRMStarPlanner::Build] Less than 2 valid samples.");
+        return *this;
+    }
+    graph_.ConnectToNearestNeighbors(GetConnectionRadius(samples.size()), max_num_edges_);
+    if (!graph_.lines_.empty()) RemoveInvalidEdges(graph_, *checker_, 0);
+    return *this;
+}
+
+std::shared_ptr<Path> PRMStarPlanner::FindPath(const Eigen::Vector3f& start, const Eigen::Vector3f& goal) const {
+    auto out = std::make_shared<Path>();
+    if (graph_.points_.empty()) {
+        utility::LogError("[PRMStarPlanner] Build has not been called.");
+        return out;
+    }
+    if (!IsValidPoint(*checker_, start) || !IsValidPoint(*checker_, goal)) {
+        utility::LogWarning("[PRMStarPlanner] The start or the goal is invalid.");
+        return out;
+    }
+    auto ex_graph = graph_;
+    const int n_start = ex_graph.points_.size();
+    const int n_goal = n_start + 1;
+    const float radius = GetConnectionRadius(n_start);
+    ex_graph.AddNodeAndConnect(start, radius, true);
+    ex_graph.AddNodeAndConnect(goal, radius, true);
+    RemoveInvalidEdges(ex_graph, *checker_, n_start);
+    if (ex_graph.lines_.empty()) return out;
+    auto path_idxs = ex_graph.AStarPath(n_start, n_goal);
+    utility::pinned_host_vector<Eigen::Vector3f> h_points = ex_graph.points_;
+    for (const auto& i : *path_idxs) {
+        out->push_back(h_points[i]);
+    }
+    return out;
+}
+
+RRTConnectPlanner::RRTConnectPlanner(const Eigen::Vector3f& min_bound,
+                                     const Eigen::Vector3f& max_bound,
+                                     const std::shared_ptr<ValidityChecker>& checker,
+                                     float step_size, unsigned int seed)
+    : min_bound_(min_bound), max_bound_(max_bound), checker_(checker),
+      step_size_(step_size), seed_(seed) {}
+
+RRTConnectPlanner::~RRTConnectPlanner() {}
+
+std::shared_ptr<Path> RRTConnectPlanner::FindPath(const Eigen::Vector3f& start, const Eigen::Vector3f& goal) const {
+    auto out = std::make_shared<Path>();
+    if (!checker_) {
+        utility::LogError("[RRTConnectPlanner] The validity checker is not set.");
+        return out;
+    }
+    if (!IsValidPoint(*checker_, start) || !IsValidPoint(*checker_, goal)) {
+        utility::LogWarning("[RRTConnectPlanner] The start or the goal is invalid.");
+        return out;
+    }
+    // Tree 0 grows from the start and tree 1 from the goal.
+    utility::device_vector<Eigen::Vector3f> nodes[2] = {
+            utility::device_vector<Eigen::Vector3f>(1, start),
+            utility::device_vector<Eigen::Vector3f>(1, goal)};
+    utility::device_vector<int> parents[2] = {utility::device_vector<int>(1, -1),
+                                              utility::device_vector<int>(1, -1)};
+    utility::device_vector<uint8_t> valid;
+    checker_->CheckSegments(nodes[0], nodes[1], valid);
+    if (valid[0]) {
+        out->push_back(start);
+        out->push_back(goal);
+        return out;
+    }
+
+    utility::device_vector<Eigen::Vector3f> samples(n_batch_);
+    utility::device_vector<int> near_indices(n_batch_);
+    utility::device_vector<Eigen::Vector3f> froms(n_batch_);
+    utility::device_vector<Eigen::Vector3f> new_nodes(n_batch_);
+    sample_uniform_functor sample_func(min_bound_, max_bound_ - min_bound_, seed_);
+    for (int it = 0; it < max_iterations_; ++it) {
+        const int a = it % 2;
+        const int b = 1 - a;
+        // Extends tree a towards a batch of samples.
+        samples.resize(n_batch_);
+        near_indices.resize(n_batch_);
+        froms.resize(n_batch_);
+        new_nodes.resize(n_batch_);
+        const size_t offset = (size_t)it * n_batch_;
+        thrust::transform(thrust::make_counting_iterator<size_t>(offset),
+                          thrust::make_counting_iterator<size_t>(offset + n_batch_),
+                          samples.begin(), sample_func);
+        nearest_node_functor near_a(thrust::raw_pointer_cast(nodes[a].data()), nodes[a].size());
+        thrust::transform(samples.begin(), samples.end(), near_indices.begin(), near_a);
+        steer_functor steer_func(thrust::raw_pointer_cast(nodes[a].data()), step_size_);
+        thrust::transform(make_tuple_begin(samples, near_indices),
+                          make_tuple_end(samples, near_indices),
+                          new_nodes.begin(), steer_func);
+        thrust::gather(near_indices.begin(), near_indices.end(), nodes[a].begin(), froms.begin());
+        checker_->CheckSegments(froms, new_nodes, valid);
+        auto end = thrust::remove_if(make_tuple_begin(new_nodes, near_indices),
+                                     make_tuple_end(new_nodes, near_indices),
+                                     valid.begin(), is_invalid_functor());
+        const size_t n_new = thrust::distance(make_tuple_begin(new_nodes, near_indices), end);
+        if (n_new == 0) continue;
+        resize_all(n_new, new_nodes, near_indices);
+        const size_t n_old = nodes[a].size();
+        nodes[a].insert(nodes[a].end(), new_nodes.begin(), new_nodes.end());
+        parents[a].insert(parents[a].end(), near_indices.begin(), near_indices.end());
+
+        // Tries to join the new nodes to tree b.
+        nearest_node_functor near_b(thrust::raw_pointer_cast(nodes[b].data()), nodes[b].size());
+        thrust::transform(new_nodes.begin(), new_nodes.end(), near_indices.begin(), near_b);
+        froms.resize(n_new);
+        thrust::gather(near_indices.begin(), near_indices.end(), nodes[b].begin(), froms.begin());
+        checker_->CheckSegments(new_nodes, froms, valid);
+        auto found = thrust::find(valid.begin(), valid.end(), (uint8_t)1);
+        if (found == valid.end()) continue;
+
+        const int k = thrust::distance(valid.begin(), found);
+        int ends[2];
+        ends[a] = n_old + k;
+        ends[b] = near_indices[k];
+        std::vector<Eigen::Vector3f> chains[2];
+        for (int t = 0; t < 2; ++t) {
+            utility::pinned_host_vector<Eigen::Vector3f> h_nodes = nodes[t];
+            utility::pinned_host_vector<int> h_parents = parents[t];
+            for (int i = ends[t]; i >= 0; i = h_parents[i]) {
+                chains[t].push_back(h_nodes[i]);
+            }
+        }
+        out->insert(out->end(), chains[0].rbegin(), chains[0].rend());
+        out->insert(out->end(), chains[1].begin(), chains[1].end());
+        return out;
+    }
+    utility::LogWarning("[RRTConnectPlanner] No path found in {:d} iterations.", max_iterations_);
+    return out;
+}
+
+}  // namespace planning
+}  // namespace cupoch
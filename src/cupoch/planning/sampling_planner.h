@@ -0,0 +1,76 @@
+#pragma once
+#include "cupoch/planning/planner.h"
+#include "cupoch/planning/validity_checker.h"
+
+namespace cupoch {
+namespace planning {
+
+/// \class PRMStarPlanner
+///
+/// \brief PRM* over the positions in the box from min_bound_ to max_bound_.
+///
+/// Build() samples n_samples_ points at once, drops the invalid ones and
+/// connects the others within the PRM* radius
+/// radius_scale_ * gamma * (log n / n)^(1/3), all the edges being checked
+/// by checker_ in one batch. FindPath() connects the start and the goal to
+/// the roadmap in the same way and searches it by A*. The obstacles_ of
+/// PlannerBase are not used, the maps and the primitives are those of
+/// checker_.
+class PRMStarPlanner : public PlannerBase {
+public:
+    PRMStarPlanner(const Eigen::Vector3f& min_bound,
+                   const Eigen::Vector3f& max_bound,
+                   const std::shared_ptr<ValidityChecker>& checker,
+                   int n_samples = 10000, unsigned int seed = 0);
+    ~PRMStarPlanner();
+
+    PRMStarPlanner &Build();
+    std::shared_ptr<Path> FindPath(const Eigen::Vector3f& start, const Eigen::Vector3f& goal) const;
+
+    /// Connection radius of the PRM* for \p n nodes in the bounds.
+    float GetConnectionRadius(size_t n) const;
+
+public:
+    Eigen::Vector3f min_bound_;
+    Eigen::Vector3f max_bound_;
+    std::shared_ptr<ValidityChecker> checker_;
+    int n_samples_;
+    unsigned int seed_;
+    float radius_scale_ = 1.1;
+    int max_num_edges_ = 30;
+    geometry::Graph graph_;
+};
+
+/// \class RRTConnectPlanner
+///
+/// \brief RRT-Connect over the positions in the box from min_bound_ to
+/// max_bound_, growing the trees by batches.
+///
+/// Every iteration extends the current tree towards n_batch_ samples at
+/// once, by at most step_size_ from their nearest nodes, and tries to join
+/// every new node to its nearest node of the other tree by a straight
+/// segment, the greedy connection of RRT-Connect, before the trees swap. The
+/// nearest neighbor searches and the segment checks of a batch are single
+/// launches.
+class RRTConnectPlanner : public PlannerBase {
+public:
+    RRTConnectPlanner(const Eigen::Vector3f& min_bound,
+                      const Eigen::Vector3f& max_bound,
+                      const std::shared_ptr<ValidityChecker>& checker,
+                      float step_size = 0.1, unsigned int seed = 0);
+    ~RRTConnectPlanner();
+
+    std::shared_ptr<Path> FindPath(const Eigen::Vector3f& start, const Eigen::Vector3f& goal) const;
+
+public:
+    Eigen::Vector3f min_bound_;
+    Eigen::Vector3f max_bound_;
+    std::shared_ptr<ValidityChecker> checker_;
+    float step_size_;
+    unsigned int seed_;
+    int n_batch_ = 256;
+    int max_iterations_ = 1000;
+};
+
+}  // namespace planning
+}  // namespace cupoch
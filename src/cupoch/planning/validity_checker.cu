@@ -0,0 +1,174 @@
+#include "cupoch/planning/validity_checker.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/utility/console.h"
+
+namespace cupoch {
+namespace planning {
+
+namespace {
+
+struct state_checker {
+    state_checker(const geometry::DenseGridView<geometry::DistanceVoxel>& dt_view,
+                  bool has_dt,
+                  const geometry::DenseGridView<geometry::CompactOccupancyVoxel>& og_view,
+                  bool has_og, int16_t occ_thres_q, bool unknown_as_free,
+                  const collision::PrimitiveShape* shapes, int n_shapes, float radius)
+    : dt_view_(dt_view), has_dt_(has_dt), og_view_(og_view), has_og_(has_og),
+      occ_thres_q_(occ_thres_q), unknown_as_free_(unknown_as_free),
+      shapes_(shapes), n_shapes_(n_shapes), radius_(radius) {};
+    const geometry::DenseGridView<geometry::DistanceVoxel> dt_view_;
+    const bool has_dt_;
+    const geometry::DenseGridView<geometry::CompactOccupancyVoxel> og_view_;
+    const bool has_og_;
+    const int16_t occ_thres_q_;
+    const bool unknown_as_free_;
+    const collision::PrimitiveShape* shapes_;
+    const int n_shapes_;
+    const float radius_;
+    __device__ bool IsValid(const Eigen::Vector3f& p) const {
+        if (has_dt_) {
+            const geometry::DistanceVoxel* v = dt_view_.GetVoxel(p);
+            if (v != NULL && !v->IsNotSite() &&
+                v->distance_ * dt_view_.voxel_size_ < radius_) return false;
+        }
+        if (has_og_) {
+            const geometry::CompactOccupancyVoxel* v = og_view_.GetVoxel(p);
+            if (v == NULL || v->IsUnknown()) {
+                if (!unknown_as_free_) return false;
+            } else if (v->prob_log_q_ > occ_thres_q_) {
+                return false;
+            }
+        }
+        for (int i = 0; i < n_shapes_; ++i) {
+            if (shapes_[i].SignedDistance(p) < radius_) return false;
+        }
+        return true;
+    }
+};
+
+struct check_points_functor {
+    check_points_functor(const state_checker& checker) : checker_(checker) {};
+    const state_checker checker_;
+    __device__ uint8_t operator() (const Eigen::Vector3f& p) const {
+        return checker_.IsValid(p) ? 1 : 0;
+    }
+};
+
+struct check_segments_functor {
+    check_segments_functor(const state_checker& checker, float resolution)
+    : checker_(checker), resolution_(resolution) {};
+    const state_checker checker_;
+    const float resolution_;
+    __device__ uint8_t operator() (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f>& x) const {
+        const Eigen::Vector3f& start = thrust::get<0>(x);
+        const Eigen::Vector3f& end = thrust::get<1>(x);
+        const int n = max((int)ceilf((end - start).norm() / resolution_), 1);
+        for (int i = 0; i <= n; ++i) {
+            if (!checker_.IsValid(start + (end - start) * ((float)i / n))) return 0;
+        }
+        return 1;
+    }
+};
+
+struct line_end_functor {
+    line_end_functor(const Eigen::Vector3f* points, int end) : points_(points), end_(end) {};
+    const Eigen::Vector3f* points_;
+    const int end_;
+    __device__ Eigen::Vector3f operator() (const Eigen::Vector2i& line) const {
+        return points_[line[end_]];
+    }
+};
+
+}  // namespace
+
+ValidityChecker::ValidityChecker(float object_radius, float check_resolution)
+    : object_radius_(object_radius), check_resolution_(check_resolution) {}
+
+ValidityChecker::~ValidityChecker() {}
+
+ValidityChecker &ValidityChecker::SetDistanceTransform(
+        const std::shared_ptr<const geometry::DistanceTransform> &distance_transform) {
+    distance_transform_ = distance_transform;
+    return *this;
+}
+
+ValidityChecker &ValidityChecker::SetOccupancyGrid(
+        const std::shared_ptr<const geometry::OccupancyGrid> &occupancy_grid) {
+    occupancy_grid_ = occupancy_grid;
+    return *this;
+}
+
+ValidityChecker &ValidityChecker::AddPrimitive(const collision::Primitive &primitive) {
+    shapes_.push_back(collision::CreatePrimitiveShape(primitive));
+    return *this;
+}
+
+ValidityChecker &ValidityChecker::ClearPrimitives() {
+    shapes_.clear();
+    return *this;
+}
+
+namespace {
+
+state_checker MakeStateChecker(
+        const std::shared_ptr<const geometry::DistanceTransform>& dt,
+        const std::shared_ptr<const geometry::OccupancyGrid>& og,
+        const utility::device_vector<collision::PrimitiveShape>& shapes,
+        float radius, bool unknown_as_free) {
+    geometry::DenseGridView<geometry::DistanceVoxel> dt_view;
+    if (dt) dt_view = dt->GetView();
+    geometry::DenseGridView<geometry::CompactOccupancyVoxel> og_view;
+    int16_t thres_q = 0;
+    if (og) {
+        og_view = og->GetView();
+        // Same test as OccupancyGrid::IsOccupied() on the quantized log odds.
+        thres_q = geometry::CompactOccupancyVoxel::Quantize(og->occ_prob_thres_log_);
+        if (thres_q * geometry::CompactOccupancyVoxel::kProbLogResolution > og->occ_prob_thres_log_) --thres_q;
+    }
+    return state_checker(dt_view, (bool)dt, og_view, (bool)og, thres_q,
+                         unknown_as_free,
+                         thrust::raw_pointer_cast(shapes.data()),
+                         shapes.size(), radius);
+}
+
+}  // namespace
+
+void ValidityChecker::CheckPoints(const utility::device_vector<Eigen::Vector3f> &points,
+                                  utility::device_vector<uint8_t> &valid) const {
+    valid.resize(points.size());
+    check_points_functor func(MakeStateChecker(distance_transform_, occupancy_grid_,
+                                               shapes_, object_radius_, unknown_as_free_));
+    thrust::transform(points.begin(), points.end(), valid.begin(), func);
+}
+
+void ValidityChecker::CheckSegments(const utility::device_vector<Eigen::Vector3f> &starts,
+                                    const utility::device_vector<Eigen::Vector3f> &ends,
+                                    utility::device_vector<uint8_t> &valid) const {
+    if (starts.size() != ends.size()) {
+        utility::LogError("[ValidityChecker::CheckSegments] The sizes of starts and ends are different.");
+    }
+    if (check_resolution_ <= 0) {
+        utility::LogError("[ValidityChecker::CheckSegments] check_resolution_ must be positive.");
+    }
+    valid.resize(starts.size());
+    check_segments_functor func(MakeStateChecker(distance_transform_, occupancy_grid_,
+                                                 shapes_, object_radius_, unknown_as_free_),
+                                check_resolution_);
+    thrust::transform(make_tuple_begin(starts, ends), make_tuple_end(starts, ends),
+                      valid.begin(), func);
+}
+
+void ValidityChecker::CheckLines(const utility::device_vector<Eigen::Vector3f> &points,
+                                 const utility::device_vector<Eigen::Vector2i> &lines,
+                                 utility::device_vector<uint8_t> &valid) const {
+    utility::device_vector<Eigen::Vector3f> starts(lines.size());
+    utility::device_vector<Eigen::Vector3f> ends(lines.size());
+    const Eigen::Vector3f* points_ptr = thrust::raw_pointer_cast(points.data());
+    thrust::transform(lines.begin(), lines.end(), starts.begin(), line_end_functor(points_ptr, 0));
+    thrust::transform(lines.begin(), lines.end(), ends.begin(), line_end_functor(points_ptr, 1));
+    CheckSegments(starts, ends, valid);
+}
+
+}  // namespace planning
+}  // namespace cupoch
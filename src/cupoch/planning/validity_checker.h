@@ -0,0 +1,65 @@
+#pragma once
+#include <Eigen/Core>
+#include <memory>
+
+#include "cupoch/collision/primitives.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace geometry {
+class OccupancyGrid;
+class DistanceTransform;
+}
+
+namespace planning {
+
+/// \class ValidityChecker
+///
+/// \brief Batched state and motion validity checks of a sphere of radius
+/// object_radius_ against the maps and primitives it is given.
+///
+/// A point is valid when its clearance in the DistanceTransform is at least
+/// object_radius_, its voxel in the OccupancyGrid is not occupied, nor
+/// unknown unless unknown_as_free_, and the sphere does not intersect any
+/// primitive. The OccupancyGrid is tested at the voxel of the point only,
+/// the DistanceTransform gives the clearance. A segment is valid when its
+/// points are, sampled every check_resolution_. The maps are shared and not
+/// copied, so their updates are seen by the next checks.
+class ValidityChecker {
+public:
+    ValidityChecker(float object_radius = 0.1, float check_resolution = 0.05);
+    ~ValidityChecker();
+
+    ValidityChecker &SetDistanceTransform(
+            const std::shared_ptr<const geometry::DistanceTransform> &distance_transform);
+    ValidityChecker &SetOccupancyGrid(
+            const std::shared_ptr<const geometry::OccupancyGrid> &occupancy_grid);
+    ValidityChecker &AddPrimitive(const collision::Primitive &primitive);
+    ValidityChecker &ClearPrimitives();
+
+    /// 1 for the valid points, 0 for the others.
+    void CheckPoints(const utility::device_vector<Eigen::Vector3f> &points,
+                     utility::device_vector<uint8_t> &valid) const;
+    /// Validity of the segments from starts[i] to ends[i].
+    void CheckSegments(const utility::device_vector<Eigen::Vector3f> &starts,
+                       const utility::device_vector<Eigen::Vector3f> &ends,
+                       utility::device_vector<uint8_t> &valid) const;
+    /// Validity of the segments between the points of \p lines.
+    void CheckLines(const utility::device_vector<Eigen::Vector3f> &points,
+                    const utility::device_vector<Eigen::Vector2i> &lines,
+                    utility::device_vector<uint8_t> &valid) const;
+
+public:
+    float object_radius_;
+    float check_resolution_;
+    bool unknown_as_free_ = false;
+
+private:
+    std::shared_ptr<const geometry::DistanceTransform> distance_transform_;
+    std::shared_ptr<const geometry::OccupancyGrid> occupancy_grid_;
+    utility::device_vector<collision::PrimitiveShape> shapes_;
+};
+
+}  // namespace planning
+}  // namespace cupoch
@@ -24,8 +24,10 @@ public:
             const override {
         return type_;
     };
-    TransformationEstimationForColoredICP(float lambda_geometric = 0.968)
-        : lambda_geometric_(lambda_geometric) {
+    TransformationEstimationForColoredICP(
+            float lambda_geometric = 0.968,
+            const RobustKernel &kernel = RobustKernel())
+        : lambda_geometric_(lambda_geometric), kernel_(kernel) {
         if (lambda_geometric_ < 0 || lambda_geometric_ > 1.0)
             lambda_geometric_ = 0.968;
     }
@@ -42,6 +44,7 @@ public:
 
 public:
     float lambda_geometric_;
+    RobustKernel kernel_;
 
 private:
     const TransformationEstimationType type_ =
@@ -97,15 +100,14 @@ struct compute_color_gradient_functor {
     }
 };
 
-std::shared_ptr<PointCloudForColoredICP> InitializePointCloudForColoredICP(
+std::unique_ptr<PointCloudForColoredICP> InitializePointCloudForColoredICP(
         const geometry::PointCloud &target,
+        const geometry::KDTreeFlann &tree,
         const geometry::KDTreeSearchParamHybrid &search_param) {
     utility::LogDebug("InitializePointCloudForColoredICP");
 
-    geometry::KDTreeFlann tree;
-    tree.SetGeometry(target);
-
-    auto output = std::make_shared<PointCloudForColoredICP>();
+    std::unique_ptr<PointCloudForColoredICP> output(
+            new PointCloudForColoredICP());
     output->colors_ = target.colors_;
     output->normals_ = target.normals_;
     output->points_ = target.points_;
@@ -140,7 +142,8 @@ struct compute_jacobian_and_residual_functor
             const Eigen::Vector3f *target_color_gradient,
             const Eigen::Vector2i *corres,
             float sqrt_lambda_geometric,
-            float sqrt_lambda_photometric)
+            float sqrt_lambda_photometric,
+            const RobustKernel &kernel)
         : source_points_(source_points),
           source_colors_(source_colors),
           target_points_(target_points),
@@ -149,7 +152,8 @@ struct compute_jacobian_and_residual_functor
           target_color_gradient_(target_color_gradient),
           corres_(corres),
           sqrt_lambda_geometric_(sqrt_lambda_geometric),
-          sqrt_lambda_photometric_(sqrt_lambda_photometric){};
+          sqrt_lambda_photometric_(sqrt_lambda_photometric),
+          kernel_(kernel){};
     const Eigen::Vector3f *source_points_;
     const Eigen::Vector3f *source_colors_;
     const Eigen::Vector3f *target_points_;
@@ -159,6 +163,7 @@ struct compute_jacobian_and_residual_functor
     const Eigen::Vector2i *corres_;
     const float sqrt_lambda_geometric_;
     const float sqrt_lambda_photometric_;
+    const RobustKernel kernel_;
     __device__ void operator()(int i,
                                Eigen::Vector6f J_r[2],
                                float r[2]) const {
@@ -194,6 +199,13 @@ struct compute_jacobian_and_residual_functor
         J_r[1].block<3, 1>(0, 0) = sqrt_lambda_photometric_ * vs.cross(ditM);
         J_r[1].block<3, 1>(3, 0) = sqrt_lambda_photometric_ * ditM;
         r[1] = sqrt_lambda_photometric_ * (is - is0_proj);
+
+        // The geometric and photometric residuals are weighted separately.
+        for (int k = 0; k < 2; ++k) {
+            const float sqrt_w = sqrt(kernel_.Weight(r[k]));
+            J_r[k] *= sqrt_w;
+            r[k] *= sqrt_w;
+        }
     }
 };
 
@@ -219,7 +231,7 @@ Eigen::Matrix4f TransformationEstimationForColoredICP::ComputeTransformation(
             thrust::raw_pointer_cast(target.colors_.data()),
             thrust::raw_pointer_cast(target_c.color_gradient_.data()),
             thrust::raw_pointer_cast(corres.data()), sqrt_lambda_geometric,
-            sqrt_lambda_photometric);
+            sqrt_lambda_photometric, kernel_);
     Eigen::Matrix6f JTJ;
     Eigen::Vector6f JTr;
     float r2;
@@ -319,10 +331,41 @@ RegistrationResult cupoch::registration::RegistrationColoredICP(
         float max_distance,
         const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
         const ICPConvergenceCriteria &criteria /* = ICPConvergenceCriteria()*/,
-        float lambda_geometric /* = 0.968*/) {
-    auto target_c = InitializePointCloudForColoredICP(
+        float lambda_geometric /* = 0.968*/,
+        const RobustKernel &kernel /* = RobustKernel()*/) {
+    ColoredICPTarget target_c(
             target, geometry::KDTreeSearchParamHybrid(max_distance * 2.0, 30));
+    return RegistrationColoredICP(source, target_c, max_distance, init,
+                                  criteria, lambda_geometric, kernel);
+}
+
+ColoredICPTarget::ColoredICPTarget(
+        const geometry::PointCloud &target,
+        const geometry::KDTreeSearchParamHybrid &search_param)
+    : kdtree_(new geometry::KDTreeFlann()) {
+    kdtree_->SetWorkspace(&workspace_);
+    kdtree_->SetGeometry(target);
+    target_ = InitializePointCloudForColoredICP(target, *kdtree_, search_param);
+}
+
+ColoredICPTarget::~ColoredICPTarget() {}
+
+const utility::device_vector<Eigen::Vector3f>
+        &ColoredICPTarget::GetColorGradients() const {
+    return ((const PointCloudForColoredICP &)*target_).color_gradient_;
+}
+
+RegistrationResult cupoch::registration::RegistrationColoredICP(
+        const geometry::PointCloud &source,
+        ColoredICPTarget &target,
+        float max_distance,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const ICPConvergenceCriteria &criteria /* = ICPConvergenceCriteria()*/,
+        float lambda_geometric /* = 0.968*/,
+        const RobustKernel &kernel /* = RobustKernel()*/) {
     return RegistrationICP(
-            source, *target_c, max_distance, init,
-            TransformationEstimationForColoredICP(lambda_geometric), criteria);
-}
\ No newline at end of file
+            utility::ExecutionContext::Default(), target.workspace_, source,
+            *target.target_, *target.kdtree_, max_distance, init,
+            TransformationEstimationForColoredICP(lambda_geometric, kernel),
+            criteria);
+}
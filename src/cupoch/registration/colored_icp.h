@@ -1,17 +1,22 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <memory>
 
+#include "cupoch/geometry/kdtree_search_param.h"
 #include "cupoch/registration/registration.h"
+#include "cupoch/registration/robust_kernel.h"
 
 namespace cupoch {
 
 namespace geometry {
 class PointCloud;
+class KDTreeFlann;
 }
 
 namespace registration {
 class RegistrationResult;
+class ColoredICPTarget;
 
 /// Function to align colored point clouds
 /// This is implementation of following paper
@@ -23,7 +28,57 @@ RegistrationResult RegistrationColoredICP(
         float max_distance,
         const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
         const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria(),
-        float lambda_geometric = 0.968);
+        float lambda_geometric = 0.968,
+        const RobustKernel &kernel = RobustKernel());
+
+/// Same as above against a ColoredICPTarget. The gradients of \p target
+/// are kept whatever \p max_distance.
+RegistrationResult RegistrationColoredICP(
+        const geometry::PointCloud &source,
+        ColoredICPTarget &target,
+        float max_distance,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria(),
+        float lambda_geometric = 0.968,
+        const RobustKernel &kernel = RobustKernel());
+
+/// \class ColoredICPTarget
+///
+/// \brief Target of RegistrationColoredICP() prepared once: a copy of the
+/// point cloud, its KD-tree and its color gradients.
+///
+/// RegistrationColoredICP() on a plain point cloud builds a KD-tree and fits
+/// the color gradient of every target point on each call. A keyframe
+/// registered against many sources is better kept as a ColoredICPTarget,
+/// whose KD-tree serves both the gradient neighborhoods and the
+/// correspondence searches. RegistrationColoredICP() uses
+/// KDTreeSearchParamHybrid(2 * max_distance, 30) for the gradients.
+class ColoredICPTarget {
+public:
+    ColoredICPTarget(const geometry::PointCloud &target,
+                     const geometry::KDTreeSearchParamHybrid &search_param);
+    ~ColoredICPTarget();
+    ColoredICPTarget(const ColoredICPTarget &) = delete;
+    ColoredICPTarget &operator=(const ColoredICPTarget &) = delete;
+
+public:
+    const geometry::PointCloud &GetPointCloud() const { return *target_; }
+    const utility::device_vector<Eigen::Vector3f> &GetColorGradients() const;
+
+private:
+    friend RegistrationResult RegistrationColoredICP(
+            const geometry::PointCloud &source,
+            ColoredICPTarget &target,
+            float max_distance,
+            const Eigen::Matrix4f &init,
+            const ICPConvergenceCriteria &criteria,
+            float lambda_geometric,
+            const RobustKernel &kernel);
+
+    std::unique_ptr<geometry::PointCloud> target_;
+    std::unique_ptr<geometry::KDTreeFlann> kdtree_;
+    utility::Workspace workspace_;
+};
 
 }  // namespace registration
 }  // namespace cupoch
\ No newline at end of file
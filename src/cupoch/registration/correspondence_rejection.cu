@@ -0,0 +1,206 @@
+#include <thrust/binary_search.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+
+#include <cmath>
+#include <limits>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/registration/correspondence_rejection.h"
+
+using namespace cupoch;
+using namespace cupoch::registration;
+
+namespace {
+
+__device__ unsigned long long PackDistanceKey(float distance2, int idx) {
+    // Non negative floats order as their bit patterns.
+    return ((unsigned long long)__float_as_uint(distance2) << 32) |
+           (unsigned int)idx;
+}
+
+struct reject_pair_functor {
+    reject_pair_functor(const Eigen::Vector3f *source_normals,
+                        const Eigen::Vector3f *target_normals,
+                        float min_cos,
+                        unsigned long long *best,
+                        int *indices,
+                        float *distances2)
+        : source_normals_(source_normals),
+          target_normals_(target_normals),
+          min_cos_(min_cos),
+          best_(best),
+          indices_(indices),
+          distances2_(distances2){};
+    const Eigen::Vector3f *source_normals_;
+    const Eigen::Vector3f *target_normals_;
+    const float min_cos_;
+    unsigned long long *best_;
+    int *indices_;
+    float *distances2_;
+    __device__ void operator()(int idx) const {
+        const int j = indices_[idx];
+        if (j < 0) return;
+        if (source_normals_ &&
+            fabsf(source_normals_[idx].dot(target_normals_[j])) < min_cos_) {
+            indices_[idx] = -1;
+            distances2_[idx] = std::numeric_limits<float>::infinity();
+            return;
+        }
+        if (best_) atomicMin(&best_[j], PackDistanceKey(distances2_[idx], idx));
+    }
+};
+
+struct reject_non_closest_functor {
+    reject_non_closest_functor(const unsigned long long *best,
+                               int *indices,
+                               float *distances2)
+        : best_(best), indices_(indices), distances2_(distances2){};
+    const unsigned long long *best_;
+    int *indices_;
+    float *distances2_;
+    __device__ void operator()(int idx) const {
+        const int j = indices_[idx];
+        if (j < 0 || best_[j] == PackDistanceKey(distances2_[idx], idx)) return;
+        indices_[idx] = -1;
+        distances2_[idx] = std::numeric_limits<float>::infinity();
+    }
+};
+
+struct valid_distance_functor {
+    valid_distance_functor(const int *indices, const float *distances2)
+        : indices_(indices), distances2_(distances2){};
+    const int *indices_;
+    const float *distances2_;
+    __device__ float operator()(int idx) const {
+        return (indices_[idx] < 0) ? std::numeric_limits<float>::infinity()
+                                   : distances2_[idx];
+    }
+};
+
+struct distance_threshold_functor {
+    distance_threshold_functor(const float *sorted,
+                               int n,
+                               float median_factor2,
+                               float trim_ratio,
+                               float *threshold2)
+        : sorted_(sorted),
+          n_(n),
+          median_factor2_(median_factor2),
+          trim_ratio_(trim_ratio),
+          threshold2_(threshold2){};
+    const float *sorted_;
+    const int n_;
+    const float median_factor2_;
+    const float trim_ratio_;
+    float *threshold2_;
+    __device__ void operator()(int) const {
+        const int n_valid =
+                thrust::lower_bound(thrust::seq, sorted_, sorted_ + n_,
+                                    std::numeric_limits<float>::infinity()) -
+                sorted_;
+        float th = std::numeric_limits<float>::infinity();
+        if (n_valid > 0) {
+            if (median_factor2_ > 0.0) {
+                th = fminf(th, median_factor2_ * sorted_[(n_valid - 1) / 2]);
+            }
+            if (trim_ratio_ < 1.0) {
+                const int n_keep = max(int(ceilf(trim_ratio_ * n_valid)), 1);
+                th = fminf(th, sorted_[n_keep - 1]);
+            }
+        }
+        *threshold2_ = th;
+    }
+};
+
+struct reject_far_functor {
+    reject_far_functor(const float *threshold2, int *indices, float *distances2)
+        : threshold2_(threshold2), indices_(indices), distances2_(distances2){};
+    const float *threshold2_;
+    int *indices_;
+    float *distances2_;
+    __device__ void operator()(int idx) const {
+        if (indices_[idx] < 0 || distances2_[idx] <= *threshold2_) return;
+        indices_[idx] = -1;
+        distances2_[idx] = std::numeric_limits<float>::infinity();
+    }
+};
+
+}  // namespace
+
+void cupoch::registration::RejectCorrespondences(
+        cudaStream_t stream,
+        utility::Workspace &workspace,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceRejection &rejection,
+        utility::device_vector<int> &indices,
+        utility::device_vector<float> &distances2) {
+    const int n_pt = indices.size();
+    if (!rejection.IsEnabled() || n_pt == 0) return;
+    const bool check_normals = rejection.max_normal_angle_ > 0.0 &&
+                               source.HasNormals() && target.HasNormals();
+    if (check_normals || rejection.one_to_one_) {
+        unsigned long long *best = nullptr;
+        if (rejection.one_to_one_) {
+            auto &best_buf = workspace.GetBuffer<unsigned long long>(
+                    "icp_rejection_best", target.points_.size());
+            thrust::fill(utility::exec_policy(stream)->on(stream),
+                         best_buf.begin(), best_buf.end(), ~0ull);
+            best = thrust::raw_pointer_cast(best_buf.data());
+        }
+        reject_pair_functor func(
+                check_normals ? thrust::raw_pointer_cast(source.normals_.data())
+                              : nullptr,
+                thrust::raw_pointer_cast(target.normals_.data()),
+                std::cos(rejection.max_normal_angle_), best,
+                thrust::raw_pointer_cast(indices.data()),
+                thrust::raw_pointer_cast(distances2.data()));
+        thrust::for_each(utility::exec_policy(stream)->on(stream),
+                         thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(n_pt), func);
+        if (best) {
+            thrust::for_each(utility::exec_policy(stream)->on(stream),
+                             thrust::make_counting_iterator(0),
+                             thrust::make_counting_iterator(n_pt),
+                             reject_non_closest_functor(
+                                     best,
+                                     thrust::raw_pointer_cast(indices.data()),
+                                     thrust::raw_pointer_cast(
+                                             distances2.data())));
+        }
+    }
+    if (rejection.median_distance_factor_ <= 0.0 &&
+        rejection.trim_ratio_ >= 1.0) {
+        return;
+    }
+    auto &sorted = workspace.GetBuffer<float>("icp_rejection_sorted", n_pt);
+    auto &threshold2 =
+            workspace.GetBuffer<float>("icp_rejection_threshold", 1);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator(0),
+                      thrust::make_counting_iterator(n_pt), sorted.begin(),
+                      valid_distance_functor(
+                              thrust::raw_pointer_cast(indices.data()),
+                              thrust::raw_pointer_cast(distances2.data())));
+    thrust::sort(utility::exec_policy(stream)->on(stream), sorted.begin(),
+                 sorted.end());
+    const float factor = rejection.median_distance_factor_;
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(1),
+                     distance_threshold_functor(
+                             thrust::raw_pointer_cast(sorted.data()), n_pt,
+                             factor * factor, rejection.trim_ratio_,
+                             thrust::raw_pointer_cast(threshold2.data())));
+    thrust::for_each(utility::exec_policy(stream)->on(stream),
+                     thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(n_pt),
+                     reject_far_functor(
+                             thrust::raw_pointer_cast(threshold2.data()),
+                             thrust::raw_pointer_cast(indices.data()),
+                             thrust::raw_pointer_cast(distances2.data())));
+}
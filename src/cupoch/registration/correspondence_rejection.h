@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/workspace.h"
+
+namespace cupoch {
+
+namespace geometry {
+class PointCloud;
+}
+
+namespace registration {
+
+/// \class CorrespondenceRejection
+///
+/// \brief Filters applied to the nearest neighbours of the ICP iterations
+/// on top of the max correspondence distance. The defaults reject nothing.
+class CorrespondenceRejection {
+public:
+    CorrespondenceRejection(float max_normal_angle = 0.0,
+                            float median_distance_factor = 0.0,
+                            bool one_to_one = false,
+                            float trim_ratio = 1.0)
+        : max_normal_angle_(max_normal_angle),
+          median_distance_factor_(median_distance_factor),
+          one_to_one_(one_to_one),
+          trim_ratio_(trim_ratio) {}
+    ~CorrespondenceRejection() {}
+
+    bool IsEnabled() const {
+        return max_normal_angle_ > 0.0 || median_distance_factor_ > 0.0 ||
+               one_to_one_ || trim_ratio_ < 1.0;
+    }
+
+public:
+    /// Rejects the pairs whose normals make an angle above this value in
+    /// radians, the normals being unoriented. 0 disables the test, which is
+    /// also skipped if a cloud has no normals.
+    float max_normal_angle_;
+    /// Rejects the pairs farther than this factor times the median distance
+    /// of the pairs. 0 disables the test.
+    float median_distance_factor_;
+    /// Keeps only the closest source point of each target point.
+    bool one_to_one_;
+    /// Keeps the closest \p trim_ratio_ of the pairs, as in trimmed ICP.
+    float trim_ratio_;
+};
+
+/// Applies \p rejection to the nearest neighbours \p indices of the points
+/// of \p source in \p target, at the squared distances \p distances2. The
+/// rejected pairs get the index -1 and the distance infinity, as the points
+/// without a neighbour. The work stays on \p stream: the thresholds of the
+/// median and trimming tests are computed on the device from one sort of
+/// the distances.
+void RejectCorrespondences(cudaStream_t stream,
+                           utility::Workspace &workspace,
+                           const geometry::PointCloud &source,
+                           const geometry::PointCloud &target,
+                           const CorrespondenceRejection &rejection,
+                           utility::device_vector<int> &indices,
+                           utility::device_vector<float> &distances2);
+
+}  // namespace registration
+}  // namespace cupoch
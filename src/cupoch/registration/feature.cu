@@ -1,6 +1,13 @@
+#include <cuda_fp16.h>
+#include <thrust/gather.h>
+#include <thrust/scatter.h>
+#include <thrust/sort.h>
+#include <thrust/unique.h>
+
 #include <Eigen/Geometry>
 
 #include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/neighborhood_cache.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/registration/feature.h"
 #include "cupoch/utility/console.h"
@@ -45,27 +52,34 @@ __device__ Eigen::Vector4f ComputePairFeatures(const Eigen::Vector3f &p1,
     return result;
 }
 
+// The histogram of row idx is the one of the point rows_[idx], or of the
+// point idx if rows_ is NULL, its neighbors being the row idx of indices_.
 struct compute_spfh_functor {
     compute_spfh_functor(const Eigen::Vector3f *points,
                          const Eigen::Vector3f *normals,
                          const int *indices,
                          int knn,
-                         float hist_incr)
+                         float hist_incr,
+                         const int *rows = nullptr)
         : points_(points),
           normals_(normals),
           indices_(indices),
           knn_(knn),
-          hist_incr_(hist_incr){};
+          hist_incr_(hist_incr),
+          rows_(rows){};
     const Eigen::Vector3f *points_;
     const Eigen::Vector3f *normals_;
     const int *indices_;
     const int knn_;
     const float hist_incr_;
+    const int *rows_;
     __device__ Feature<33>::FeatureType operator()(size_t idx) const {
         Feature<33>::FeatureType ft = Feature<33>::FeatureType::Zero();
+        const int i = (rows_) ? rows_[idx] : idx;
         for (size_t k = 1; k < knn_; k++) {
             // skip the point itself, compute histogram
-            auto pf = ComputePairFeatures(points_[idx], normals_[idx],
+            if (indices_[idx * knn_ + k] < 0) continue;
+            auto pf = ComputePairFeatures(points_[i], normals_[i],
                                           points_[indices_[idx * knn_ + k]],
                                           normals_[indices_[idx * knn_ + k]]);
             int h_index = (int)(floor(11 * (pf(0) + M_PI) / (2.0 * M_PI)));
@@ -86,49 +100,62 @@ struct compute_spfh_functor {
 };
 
 std::shared_ptr<Feature<33>> ComputeSPFHFeature(
-        const geometry::PointCloud &input,
-        const geometry::KDTreeFlann &kdtree,
-        const geometry::KDTreeSearchParam &search_param) {
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<Eigen::Vector3f> &normals,
+        const utility::device_vector<int> &indices,
+        int knn,
+        const utility::device_vector<int> *rows = nullptr) {
+    const size_t n = (rows) ? rows->size() : points.size();
     auto feature = std::make_shared<Feature<33>>();
-    feature->Resize((int)input.points_.size());
+    feature->Resize((int)n);
 
-    utility::device_vector<int> indices;
-    utility::device_vector<float> distance2;
-    auto knn = ((const geometry::KDTreeSearchParamKNN &)search_param).knn_;
-    kdtree.SearchKNN(input.points_, knn, indices, distance2);
     float hist_incr = 100.0 / (float)(knn - 1);
-    compute_spfh_functor func(thrust::raw_pointer_cast(input.points_.data()),
-                              thrust::raw_pointer_cast(input.normals_.data()),
-                              thrust::raw_pointer_cast(indices.data()), knn,
-                              hist_incr);
+    compute_spfh_functor func(
+            thrust::raw_pointer_cast(points.data()),
+            thrust::raw_pointer_cast(normals.data()),
+            thrust::raw_pointer_cast(indices.data()), knn, hist_incr,
+            (rows) ? thrust::raw_pointer_cast(rows->data()) : nullptr);
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(input.points_.size()),
+                      thrust::make_counting_iterator(n),
                       feature->data_.begin(), func);
     return feature;
 }
 
+// The feature of row idx is the one of the point rows_[idx], or of the
+// point idx if rows_ is NULL. The SPFH of the point i is spfh_data_[i], or
+// spfh_data_[spfh_slots_[i]] if spfh_slots_ is not NULL.
 struct compute_fpfh_functor {
     compute_fpfh_functor(const Feature<33>::FeatureType *spfh_data,
                          const int *indices,
                          const float *distance2,
-                         int knn)
+                         int knn,
+                         const int *rows = nullptr,
+                         const int *spfh_slots = nullptr)
         : spfh_data_(spfh_data),
           indices_(indices),
           distance2_(distance2),
-          knn_(knn){};
+          knn_(knn),
+          rows_(rows),
+          spfh_slots_(spfh_slots){};
     const Feature<33>::FeatureType *spfh_data_;
     const int *indices_;
     const float *distance2_;
     const int knn_;
+    const int *rows_;
+    const int *spfh_slots_;
+    __device__ const Feature<33>::FeatureType &SPFH(int i) const {
+        return spfh_data_[(spfh_slots_) ? spfh_slots_[i] : i];
+    }
     __device__ Feature<33>::FeatureType operator()(size_t idx) const {
-        Feature<33>::FeatureType ft;
+        Feature<33>::FeatureType ft = Feature<33>::FeatureType::Zero();
         float sum[3] = {0.0, 0.0, 0.0};
         for (size_t k = 1; k < knn_; k++) {
             // skip the point itself
+            if (indices_[idx * knn_ + k] < 0) continue;
             float dist = distance2_[idx * knn_ + k];
             if (dist == 0.0) continue;
             for (int j = 0; j < 33; j++) {
-                float val = spfh_data_[indices_[idx * knn_ + k]][j] / dist;
+                float val = SPFH(indices_[idx * knn_ + k])[j] / dist;
                 sum[j / 11] += val;
                 ft[j] += val;
             }
@@ -142,21 +169,60 @@ struct compute_fpfh_functor {
             // Our initial test shows that the full fpfh function in the
             // paper seems to be better than PCL implementation. Further
             // test required.
-            ft[j] += spfh_data_[idx][j];
+            ft[j] += SPFH((rows_) ? rows_[idx] : idx)[j];
         }
         return ft;
     }
 };
 
+std::shared_ptr<Feature<33>> ComputeFPFHFeature(
+        const utility::device_vector<Eigen::Vector3f> &points,
+        const utility::device_vector<Eigen::Vector3f> &normals,
+        const utility::device_vector<int> &indices,
+        const utility::device_vector<float> &distance2,
+        int knn) {
+    // The SPFH of the points and their FPFH are computed from the same
+    // neighborhoods.
+    auto spfh = ComputeSPFHFeature(points, normals, indices, knn);
+    auto feature = std::make_shared<Feature<33>>();
+    feature->Resize((int)points.size());
+    compute_fpfh_functor func(thrust::raw_pointer_cast(spfh->data_.data()),
+                              thrust::raw_pointer_cast(indices.data()),
+                              thrust::raw_pointer_cast(distance2.data()), knn);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(points.size()),
+                      feature->data_.begin(), func);
+    return feature;
+}
+
+struct offset_indices_functor {
+    offset_indices_functor(int offset) : offset_(offset){};
+    const int offset_;
+    __device__ int operator()(int idx) const {
+        return (idx < 0) ? idx : idx + offset_;
+    }
+};
+
+struct float_to_half_functor {
+    __device__ __half operator()(float x) const { return __float2half(x); }
+};
+
+struct half_to_feature_functor {
+    half_to_feature_functor(const __half *data) : data_(data){};
+    const __half *data_;
+    __device__ Feature<33>::FeatureType operator()(size_t idx) const {
+        Feature<33>::FeatureType ft;
+        for (int j = 0; j < 33; j++) ft[j] = __half2float(data_[idx * 33 + j]);
+        return ft;
+    }
+};
+
 }  // namespace
 
 std::shared_ptr<Feature<33>> ComputeFPFHFeature(
         const geometry::PointCloud &input,
         const geometry::KDTreeSearchParam
                 &search_param /* = geometry::KDTreeSearchParamKNN()*/) {
-    auto feature = std::make_shared<Feature<33>>();
-    feature->Resize((int)input.points_.size());
-
     if (!input.HasNormals()) {
         utility::LogError(
                 "[ComputeFPFHFeature] Failed because input point cloud has no "
@@ -164,20 +230,173 @@ std::shared_ptr<Feature<33>> ComputeFPFHFeature(
     }
 
     geometry::KDTreeFlann kdtree(input);
-    auto spfh = ComputeSPFHFeature(input, kdtree, search_param);
     utility::device_vector<int> indices;
     utility::device_vector<float> distance2;
-    kdtree.SearchKNN(
-            input.points_,
-            ((const geometry::KDTreeSearchParamKNN &)search_param).knn_,
-            indices, distance2);
-    compute_fpfh_functor func(
-            thrust::raw_pointer_cast(spfh->data_.data()),
-            thrust::raw_pointer_cast(indices.data()),
-            thrust::raw_pointer_cast(distance2.data()),
-            ((const geometry::KDTreeSearchParamKNN &)search_param).knn_);
+    const int knn = ((const geometry::KDTreeSearchParamKNN &)search_param).knn_;
+    kdtree.SearchKNN(input.points_, knn, indices, distance2);
+    return ComputeFPFHFeature(input.points_, input.normals_, indices,
+                              distance2, knn);
+}
+
+std::shared_ptr<Feature<33>> ComputeFPFHFeature(
+        const geometry::PointCloud &input,
+        geometry::NeighborhoodCache &cache,
+        const geometry::KDTreeSearchParam
+                &search_param /* = geometry::KDTreeSearchParamKNN()*/) {
+    if (!input.HasNormals()) {
+        utility::LogError(
+                "[ComputeFPFHFeature] Failed because input point cloud has no "
+                "normal.");
+    }
+    if (&cache.GetPointCloud() != &input) {
+        utility::LogWarning(
+                "[ComputeFPFHFeature] The cache is built on another point "
+                "cloud.\n");
+        return std::make_shared<Feature<33>>();
+    }
+    const auto &neighborhood = cache.GetNeighborhood(search_param);
+    return ComputeFPFHFeature(input.points_, input.normals_,
+                              neighborhood.indices_, neighborhood.distance2_,
+                              neighborhood.knn_);
+}
+
+std::shared_ptr<Feature<33>> ComputeFPFHFeature(
+        const geometry::PointCloud &input,
+        const utility::device_vector<size_t> &indices,
+        const geometry::KDTreeSearchParam
+                &search_param /* = geometry::KDTreeSearchParamKNN()*/) {
+    if (!input.HasNormals()) {
+        utility::LogError(
+                "[ComputeFPFHFeature] Failed because input point cloud has no "
+                "normal.");
+    }
+    auto feature = std::make_shared<Feature<33>>();
+    if (indices.empty()) return feature;
+    const int knn = ((const geometry::KDTreeSearchParamKNN &)search_param).knn_;
+    geometry::KDTreeFlann kdtree(input);
+
+    // Neighbors of the selected points.
+    utility::device_vector<int> rows(indices.size());
+    thrust::copy(indices.begin(), indices.end(), rows.begin());
+    utility::device_vector<Eigen::Vector3f> points(rows.size());
+    thrust::gather(rows.begin(), rows.end(), input.points_.begin(),
+                   points.begin());
+    utility::device_vector<int> nn_indices;
+    utility::device_vector<float> nn_distance2;
+    kdtree.SearchKNN(points, knn, nn_indices, nn_distance2);
+
+    // The SPFH are needed at the selected points and at their neighbors,
+    // whose neighbors are searched in turn.
+    utility::device_vector<int> spfh_rows(rows.size() + nn_indices.size());
+    thrust::copy(rows.begin(), rows.end(), spfh_rows.begin());
+    thrust::copy(nn_indices.begin(), nn_indices.end(),
+                 spfh_rows.begin() + rows.size());
+    thrust::sort(spfh_rows.begin(), spfh_rows.end());
+    auto end = thrust::unique(spfh_rows.begin(), spfh_rows.end());
+    spfh_rows.resize(thrust::distance(spfh_rows.begin(), end));
+    if (!spfh_rows.empty() && spfh_rows[0] < 0) {
+        spfh_rows.erase(spfh_rows.begin());
+    }
+    utility::device_vector<Eigen::Vector3f> spfh_points(spfh_rows.size());
+    thrust::gather(spfh_rows.begin(), spfh_rows.end(), input.points_.begin(),
+                   spfh_points.begin());
+    utility::device_vector<int> spfh_indices;
+    utility::device_vector<float> spfh_distance2;
+    kdtree.SearchKNN(spfh_points, knn, spfh_indices, spfh_distance2);
+    auto spfh = ComputeSPFHFeature(input.points_, input.normals_, spfh_indices,
+                                   knn, &spfh_rows);
+    utility::device_vector<int> spfh_slots(input.points_.size(), -1);
+    thrust::scatter(thrust::make_counting_iterator<int>(0),
+                    thrust::make_counting_iterator((int)spfh_rows.size()),
+                    spfh_rows.begin(), spfh_slots.begin());
+
+    feature->Resize((int)rows.size());
+    compute_fpfh_functor func(thrust::raw_pointer_cast(spfh->data_.data()),
+                              thrust::raw_pointer_cast(nn_indices.data()),
+                              thrust::raw_pointer_cast(nn_distance2.data()),
+                              knn, thrust::raw_pointer_cast(rows.data()),
+                              thrust::raw_pointer_cast(spfh_slots.data()));
     thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(input.points_.size()),
+                      thrust::make_counting_iterator(rows.size()),
                       feature->data_.begin(), func);
     return feature;
-}
\ No newline at end of file
+}
+
+std::shared_ptr<Feature<33>> FPFHFeatureBatch::GetFeature(size_t i) const {
+    auto feature = std::make_shared<Feature<33>>();
+    if (i + 1 >= offsets_.size()) {
+        utility::LogWarning("[GetFeature] Invalid point cloud index {}.\n", i);
+        return feature;
+    }
+    const size_t begin = offsets_[i];
+    const size_t end = offsets_[i + 1];
+    feature->Resize((int)(end - begin));
+    if (half_precision_) {
+        half_to_feature_functor func(thrust::raw_pointer_cast(half_data_.data()));
+        thrust::transform(thrust::make_counting_iterator(begin),
+                          thrust::make_counting_iterator(end),
+                          feature->data_.begin(), func);
+    } else {
+        thrust::copy(data_.begin() + begin, data_.begin() + end,
+                     feature->data_.begin());
+    }
+    return feature;
+}
+
+std::shared_ptr<FPFHFeatureBatch> ComputeFPFHFeatureBatch(
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &inputs,
+        const geometry::KDTreeSearchParamKNN &search_param,
+        bool half_precision) {
+    auto batch = std::make_shared<FPFHFeatureBatch>();
+    batch->half_precision_ = half_precision;
+    batch->offsets_.resize(inputs.size() + 1, 0);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!inputs[i]->HasNormals()) {
+            utility::LogError(
+                    "[ComputeFPFHFeatureBatch] Failed because input point "
+                    "cloud {} has no normal.",
+                    i);
+        }
+        batch->offsets_[i + 1] = batch->offsets_[i] + inputs[i]->points_.size();
+    }
+    const size_t n_total = batch->offsets_.back();
+    const int knn = search_param.knn_;
+
+    // Every cloud is searched on its own index, the results are gathered
+    // into one neighbor list over the concatenated points so that the SPFH
+    // and the weighting passes run once for the whole batch.
+    utility::device_vector<Eigen::Vector3f> points(n_total);
+    utility::device_vector<Eigen::Vector3f> normals(n_total);
+    utility::device_vector<int> indices(n_total * knn);
+    utility::device_vector<float> distance2(n_total * knn);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const auto &input = *inputs[i];
+        if (input.IsEmpty()) continue;
+        const size_t offset = batch->offsets_[i];
+        thrust::copy(input.points_.begin(), input.points_.end(),
+                     points.begin() + offset);
+        thrust::copy(input.normals_.begin(), input.normals_.end(),
+                     normals.begin() + offset);
+        geometry::KDTreeFlann kdtree(input);
+        utility::device_vector<int> cloud_indices;
+        utility::device_vector<float> cloud_distance2;
+        kdtree.SearchKNN(input.points_, knn, cloud_indices, cloud_distance2);
+        thrust::transform(cloud_indices.begin(), cloud_indices.end(),
+                          indices.begin() + offset * knn,
+                          offset_indices_functor((int)offset));
+        thrust::copy(cloud_distance2.begin(), cloud_distance2.end(),
+                     distance2.begin() + offset * knn);
+    }
+    auto feature = ComputeFPFHFeature(points, normals, indices, distance2, knn);
+    if (half_precision) {
+        batch->half_data_.resize(n_total * 33);
+        const float *data = (const float *)thrust::raw_pointer_cast(
+                feature->data_.data());
+        thrust::transform(thrust::device_pointer_cast(data),
+                          thrust::device_pointer_cast(data + n_total * 33),
+                          batch->half_data_.begin(), float_to_half_functor());
+    } else {
+        batch->data_.swap(feature->data_);
+    }
+    return batch;
+}
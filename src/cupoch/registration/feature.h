@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cuda_fp16.h>
+
 #include <Eigen/Core>
 #include <memory>
+#include <vector>
 
 #include "cupoch/geometry/kdtree_search_param.h"
 #include "cupoch/utility/device_vector.h"
@@ -9,6 +12,7 @@
 namespace cupoch {
 
 namespace geometry {
+class NeighborhoodCache;
 class PointCloud;
 }
 
@@ -32,5 +36,52 @@ std::shared_ptr<Feature<33>> ComputeFPFHFeature(
         const geometry::KDTreeSearchParam &search_param =
                 geometry::KDTreeSearchParamKNN());
 
+/// FPFH features of the points \p indices of \p input only, in their
+/// order, e.g. of its keypoints from geometry::ComputeISSKeypoints(). Only
+/// the neighbors of these points and of their neighbors are searched, so
+/// the cost scales with the number of keypoints instead of the points.
+std::shared_ptr<Feature<33>> ComputeFPFHFeature(
+        const geometry::PointCloud &input,
+        const utility::device_vector<size_t> &indices,
+        const geometry::KDTreeSearchParam &search_param =
+                geometry::KDTreeSearchParamKNN());
+
+/// Same as above, from the neighborhood for \p search_param in \p cache,
+/// which must be built on \p input.
+std::shared_ptr<Feature<33>> ComputeFPFHFeature(
+        const geometry::PointCloud &input,
+        geometry::NeighborhoodCache &cache,
+        const geometry::KDTreeSearchParam &search_param =
+                geometry::KDTreeSearchParamKNN());
+
+/// FPFH features of a batch of point clouds, stored back to back: the
+/// features of cloud i are the entries offsets_[i] to offsets_[i + 1].
+/// With half precision the histograms are kept in half_data_ as 33
+/// consecutive halfs per point instead of data_, which halves the memory
+/// and the bandwidth of the matching.
+class FPFHFeatureBatch {
+public:
+    size_t NumPointClouds() const {
+        return offsets_.empty() ? 0 : offsets_.size() - 1;
+    }
+    /// Single precision features of the cloud \p i.
+    std::shared_ptr<Feature<33>> GetFeature(size_t i) const;
+
+public:
+    std::vector<size_t> offsets_;
+    bool half_precision_ = false;
+    utility::device_vector<Feature<33>::FeatureType> data_;
+    utility::device_vector<__half> half_data_;
+};
+
+/// Function to compute FPFH features for several point clouds at once. The
+/// neighbors are searched in each cloud, then the SPFH and FPFH passes run
+/// once over all the points of the batch.
+std::shared_ptr<FPFHFeatureBatch> ComputeFPFHFeatureBatch(
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &inputs,
+        const geometry::KDTreeSearchParamKNN &search_param =
+                geometry::KDTreeSearchParamKNN(),
+        bool half_precision = false);
+
 }  // namespace registration
 }  // namespace cupoch
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "cupoch/registration/feature_matching.inl"
+
+namespace cupoch {
+namespace registration {
+
+template void FeatureKNNSearch<33>(const Feature<33> &query,
+                                   const Feature<33> &reference,
+                                   int knn,
+                                   utility::device_vector<int> &indices,
+                                   utility::device_vector<float> &distance2);
+template CorrespondenceSet MatchFeatures<33>(const Feature<33> &source_feature,
+                                             const Feature<33> &target_feature,
+                                             bool mutual_filter,
+                                             float ratio);
+
+}  // namespace registration
+}  // namespace cupoch
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "cupoch/registration/feature.h"
+#include "cupoch/registration/registration.h"
+
+namespace cupoch {
+namespace registration {
+
+/// Largest number of neighbors of FeatureKNNSearch().
+static const int kMaxFeatureKNN = 16;
+
+/// Exact k nearest neighbors of the features \p query among \p reference,
+/// for features of any dimension. The search is a tiled brute force: each
+/// block of threads streams tiles of reference features through shared
+/// memory, the squared distances are expanded as |q|^2 + |r|^2 - 2 q.r as
+/// in a GEMM, and each thread keeps the k best candidates of its query
+/// sorted in registers. \p indices and \p distance2 hold \p knn entries per
+/// query, by increasing squared distance, -1 and infinity when there are
+/// fewer than \p knn reference features. \p knn is at most kMaxFeatureKNN.
+template <int Dim>
+void FeatureKNNSearch(const Feature<Dim> &query,
+                      const Feature<Dim> &reference,
+                      int knn,
+                      utility::device_vector<int> &indices,
+                      utility::device_vector<float> &distance2);
+
+/// Matches every source feature to its nearest target feature. With
+/// \p mutual_filter only the pairs that are also the nearest source feature
+/// of their target feature are kept. With \p ratio below 1 the ratio test
+/// of Lowe drops the matches whose distance is not below \p ratio times the
+/// distance of the second nearest target feature, i.e. the ambiguous ones.
+template <int Dim>
+CorrespondenceSet MatchFeatures(const Feature<Dim> &source_feature,
+                                const Feature<Dim> &target_feature,
+                                bool mutual_filter = true,
+                                float ratio = 1.0);
+
+}  // namespace registration
+}  // namespace cupoch
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/remove.h>
+#include <thrust/transform.h>
+
+#include <limits>
+
+#include "cupoch/registration/feature_matching.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+namespace registration {
+
+namespace {
+
+const int kFeatureKNNBlockSize = 128;
+
+// Reference features per tile, bounded so that a tile of up to 256
+// dimensions fits in 32KB of shared memory.
+template <int Dim>
+struct feature_knn_tile {
+    static constexpr int kSize = (Dim <= 128) ? 64 : 32;
+};
+
+// One thread per query, with the query and its K best candidates in
+// registers. The tile is stored dimension major, so that the threads of a
+// warp, which read the same reference at the same time, get broadcasts.
+template <int Dim, int K>
+__global__ void feature_knn_kernel(const float *query,
+                                   int n_query,
+                                   const float *reference,
+                                   int n_reference,
+                                   int knn,
+                                   int *indices,
+                                   float *distance2) {
+    constexpr int kTile = feature_knn_tile<Dim>::kSize;
+    __shared__ float tile[Dim * kTile];
+    __shared__ float tile_norm2[kTile];
+    const int i = blockIdx.x * blockDim.x + threadIdx.x;
+    const bool active = i < n_query;
+
+    float q[Dim];
+    float q_norm2 = 0.0f;
+#pragma unroll
+    for (int d = 0; d < Dim; ++d) {
+        q[d] = (active) ? query[(size_t)i * Dim + d] : 0.0f;
+        q_norm2 += q[d] * q[d];
+    }
+    float best_d[K];
+    int best_i[K];
+#pragma unroll
+    for (int k = 0; k < K; ++k) {
+        best_d[k] = std::numeric_limits<float>::infinity();
+        best_i[k] = -1;
+    }
+
+    for (int base = 0; base < n_reference; base += kTile) {
+        const int n_tile = min(kTile, n_reference - base);
+        // Coalesced load of the tile, contiguous in the reference array.
+        for (int t = threadIdx.x; t < n_tile * Dim; t += blockDim.x) {
+            const int r = t / Dim;
+            const int d = t - r * Dim;
+            tile[d * kTile + r] = reference[(size_t)base * Dim + t];
+        }
+        __syncthreads();
+        for (int r = threadIdx.x; r < n_tile; r += blockDim.x) {
+            float n2 = 0.0f;
+            for (int d = 0; d < Dim; ++d) {
+                const float v = tile[d * kTile + r];
+                n2 += v * v;
+            }
+            tile_norm2[r] = n2;
+        }
+        __syncthreads();
+        if (active) {
+            for (int r = 0; r < n_tile; ++r) {
+                float dot = 0.0f;
+#pragma unroll
+                for (int d = 0; d < Dim; ++d) dot += q[d] * tile[d * kTile + r];
+                const float dist2 =
+                        fmaxf(q_norm2 + tile_norm2[r] - 2.0f * dot, 0.0f);
+                if (dist2 < best_d[K - 1]) {
+                    best_d[K - 1] = dist2;
+                    best_i[K - 1] = base + r;
+#pragma unroll
+                    for (int k = K - 1; k > 0; --k) {
+                        if (best_d[k] < best_d[k - 1]) {
+                            const float td = best_d[k];
+                            best_d[k] = best_d[k - 1];
+                            best_d[k - 1] = td;
+                            const int ti = best_i[k];
+                            best_i[k] = best_i[k - 1];
+                            best_i[k - 1] = ti;
+                        }
+                    }
+                }
+            }
+        }
+        __syncthreads();
+    }
+    if (!active) return;
+#pragma unroll
+    for (int k = 0; k < K; ++k) {
+        if (k < knn) {
+            indices[(size_t)i * knn + k] = best_i[k];
+            distance2[(size_t)i * knn + k] = best_d[k];
+        }
+    }
+}
+
+template <int Dim, int K>
+void LaunchFeatureKNN(const Feature<Dim> &query,
+                      const Feature<Dim> &reference,
+                      int knn,
+                      utility::device_vector<int> &indices,
+                      utility::device_vector<float> &distance2) {
+    const int n_query = query.Num();
+    const int n_blocks =
+            (n_query + kFeatureKNNBlockSize - 1) / kFeatureKNNBlockSize;
+    feature_knn_kernel<Dim, K><<<n_blocks, kFeatureKNNBlockSize>>>(
+            reinterpret_cast<const float *>(
+                    thrust::raw_pointer_cast(query.data_.data())),
+            n_query,
+            reinterpret_cast<const float *>(
+                    thrust::raw_pointer_cast(reference.data_.data())),
+            (int)reference.Num(), knn, thrust::raw_pointer_cast(indices.data()),
+            thrust::raw_pointer_cast(distance2.data()));
+    cudaSafeCall(cudaGetLastError());
+}
+
+struct make_feature_match_functor {
+    make_feature_match_functor(const int *source_to_target,
+                               const float *distance2,
+                               const int *target_to_source,
+                               float ratio2)
+        : source_to_target_(source_to_target),
+          distance2_(distance2),
+          target_to_source_(target_to_source),
+          ratio2_(ratio2){};
+    const int *source_to_target_;
+    const float *distance2_;
+    const int *target_to_source_;
+    const float ratio2_;
+    __device__ Eigen::Vector2i operator()(int i) const {
+        const int stride = (ratio2_ < 1.0f) ? 2 : 1;
+        const int j = source_to_target_[i * stride];
+        if (j < 0 || (target_to_source_ && target_to_source_[j] != i)) {
+            return Eigen::Vector2i(-1, -1);
+        }
+        // Squared distances, so the ratio is squared. A missing second
+        // neighbor is at infinity and passes.
+        if (stride == 2 &&
+            !(distance2_[i * 2] < ratio2_ * distance2_[i * 2 + 1])) {
+            return Eigen::Vector2i(-1, -1);
+        }
+        return Eigen::Vector2i(i, j);
+    }
+};
+
+}  // namespace
+
+template <int Dim>
+void FeatureKNNSearch(const Feature<Dim> &query,
+                      const Feature<Dim> &reference,
+                      int knn,
+                      utility::device_vector<int> &indices,
+                      utility::device_vector<float> &distance2) {
+    if (knn <= 0 || knn > kMaxFeatureKNN) {
+        utility::LogError(
+                "[FeatureKNNSearch] knn must be between 1 and {:d}.",
+                kMaxFeatureKNN);
+        return;
+    }
+    indices.resize(query.Num() * knn);
+    distance2.resize(query.Num() * knn);
+    if (query.Num() == 0) return;
+    if (knn == 1) {
+        LaunchFeatureKNN<Dim, 1>(query, reference, knn, indices, distance2);
+    } else if (knn == 2) {
+        LaunchFeatureKNN<Dim, 2>(query, reference, knn, indices, distance2);
+    } else if (knn <= 4) {
+        LaunchFeatureKNN<Dim, 4>(query, reference, knn, indices, distance2);
+    } else if (knn <= 8) {
+        LaunchFeatureKNN<Dim, 8>(query, reference, knn, indices, distance2);
+    } else {
+        LaunchFeatureKNN<Dim, 16>(query, reference, knn, indices, distance2);
+    }
+}
+
+template <int Dim>
+CorrespondenceSet MatchFeatures(const Feature<Dim> &source_feature,
+                                const Feature<Dim> &target_feature,
+                                bool mutual_filter,
+                                float ratio) {
+    CorrespondenceSet corres;
+    const size_t n_source = source_feature.Num();
+    const size_t n_target = target_feature.Num();
+    if (n_source == 0 || n_target == 0) return corres;
+
+    const bool ratio_test = ratio < 1.0;
+    utility::device_vector<int> source_to_target;
+    utility::device_vector<float> distance2;
+    FeatureKNNSearch(source_feature, target_feature, (ratio_test) ? 2 : 1,
+                     source_to_target, distance2);
+    utility::device_vector<int> target_to_source;
+    if (mutual_filter) {
+        utility::device_vector<float> target_distance2;
+        FeatureKNNSearch(target_feature, source_feature, 1, target_to_source,
+                         target_distance2);
+    }
+    corres.resize(n_source);
+    make_feature_match_functor func(
+            thrust::raw_pointer_cast(source_to_target.data()),
+            thrust::raw_pointer_cast(distance2.data()),
+            mutual_filter ? thrust::raw_pointer_cast(target_to_source.data())
+                          : nullptr,
+            (ratio_test) ? ratio * ratio : 1.0f);
+    thrust::transform(thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator((int)n_source),
+                      corres.begin(), func);
+    auto end = thrust::remove_if(
+            corres.begin(), corres.end(),
+            [] __device__(const Eigen::Vector2i &x) { return x[0] < 0; });
+    corres.resize(thrust::distance(corres.begin(), end));
+    return corres;
+}
+
+}  // namespace registration
+}  // namespace cupoch
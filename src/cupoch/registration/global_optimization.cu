@@ -0,0 +1,618 @@
+#include <thrust/inner_product.h>
+
+#include "cupoch/registration/global_optimization.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/sparse_matrix.h"
+
+using namespace cupoch;
+using namespace cupoch::registration;
+
+namespace {
+
+/// Initial damping of Levenberg-Marquardt relative to the largest diagonal
+/// entry of the normal equations.
+constexpr float kInitialLambdaScale = 1e-5;
+
+__device__ Eigen::Matrix4f InverseRigid(const Eigen::Matrix4f &t) {
+    Eigen::Matrix4f inv = Eigen::Matrix4f::Identity();
+    inv.block<3, 3>(0, 0) = t.block<3, 3>(0, 0).transpose();
+    inv.block<3, 1>(0, 3) = -inv.block<3, 3>(0, 0) * t.block<3, 1>(0, 3);
+    return inv;
+}
+
+/// Residual of the edge (i, j), the linearized log(T_j^-1 T_i T_ij^-1).
+__device__ Eigen::Vector6f ComputeEdgeResidual(const Eigen::Matrix4f &ti,
+                                               const Eigen::Matrix4f &tj,
+                                               const Eigen::Matrix4f &tij) {
+    const Eigen::Matrix4f e = InverseRigid(tj) * ti * InverseRigid(tij);
+    Eigen::Vector6f r;
+    r << 0.5 * (e(2, 1) - e(1, 2)), 0.5 * (e(0, 2) - e(2, 0)),
+            0.5 * (e(1, 0) - e(0, 1)), e(0, 3), e(1, 3), e(2, 3);
+    return r;
+}
+
+/// Jacobian block of the residual of the edge for a left perturbation of
+/// the source pose, the adjoint of T_j^-1. The block of the target pose is
+/// its opposite.
+__device__ Eigen::Matrix6f ComputeEdgeJacobian(const Eigen::Matrix4f &tj) {
+    const Eigen::Matrix3f rt = tj.block<3, 3>(0, 0).transpose();
+    const Eigen::Vector3f t = tj.block<3, 1>(0, 3);
+    Eigen::Matrix3f tx;
+    tx << 0.0, -t[2], t[1], t[2], 0.0, -t[0], -t[1], t[0], 0.0;
+    Eigen::Matrix6f a = Eigen::Matrix6f::Zero();
+    a.block<3, 3>(0, 0) = rt;
+    a.block<3, 3>(3, 3) = rt;
+    a.block<3, 3>(3, 0) = -rt * tx;
+    return a;
+}
+
+struct edge_functor_base {
+    edge_functor_base(const Eigen::Matrix4f_u *poses,
+                      const Eigen::Vector2i *ids,
+                      const Eigen::Matrix4f_u *transformations,
+                      const Eigen::Matrix6f_u *informations)
+        : poses_(poses),
+          ids_(ids),
+          transformations_(transformations),
+          informations_(informations){};
+    const Eigen::Matrix4f_u *poses_;
+    const Eigen::Vector2i *ids_;
+    const Eigen::Matrix4f_u *transformations_;
+    const Eigen::Matrix6f_u *informations_;
+    __device__ Eigen::Vector6f Residual(int e) const {
+        return ComputeEdgeResidual(poses_[ids_[e][0]], poses_[ids_[e][1]],
+                                   transformations_[e]);
+    }
+    __device__ float SquaredError(int e) const {
+        const Eigen::Vector6f r = Residual(e);
+        return r.dot(Eigen::Matrix6f(informations_[e]) * r);
+    }
+};
+
+struct edge_cost_functor : public edge_functor_base {
+    edge_cost_functor(const Eigen::Matrix4f_u *poses,
+                      const Eigen::Vector2i *ids,
+                      const Eigen::Matrix4f_u *transformations,
+                      const Eigen::Matrix6f_u *informations,
+                      const int *uncertain,
+                      const float *line_process,
+                      float mu)
+        : edge_functor_base(poses, ids, transformations, informations),
+          uncertain_(uncertain),
+          line_process_(line_process),
+          mu_(mu){};
+    const int *uncertain_;
+    const float *line_process_;
+    const float mu_;
+    __device__ float operator()(int e) const {
+        const float s = SquaredError(e);
+        if (!uncertain_[e]) return 0.5 * s;
+        const float l = line_process_[e];
+        const float d = sqrt(l) - 1.0;
+        return 0.5 * (l * s + mu_ * d * d);
+    }
+};
+
+struct update_line_process_functor : public edge_functor_base {
+    update_line_process_functor(const Eigen::Matrix4f_u *poses,
+                                const Eigen::Vector2i *ids,
+                                const Eigen::Matrix4f_u *transformations,
+                                const Eigen::Matrix6f_u *informations,
+                                const int *uncertain,
+                                float *line_process,
+                                float mu)
+        : edge_functor_base(poses, ids, transformations, informations),
+          uncertain_(uncertain),
+          line_process_(line_process),
+          mu_(mu){};
+    const int *uncertain_;
+    float *line_process_;
+    const float mu_;
+    __device__ void operator()(int e) const {
+        if (!uncertain_[e]) {
+            line_process_[e] = 1.0;
+            return;
+        }
+        const float l = mu_ / (mu_ + SquaredError(e));
+        line_process_[e] = l * l;
+    }
+};
+
+/// Adds the blocks of one edge to the normal equations: M = w A^T L A on
+/// the diagonal blocks of both nodes and -M off the diagonal, g = w A^T L r
+/// and -g on the right hand side.
+struct build_system_functor : public edge_functor_base {
+    build_system_functor(const Eigen::Matrix4f_u *poses,
+                         const Eigen::Vector2i *ids,
+                         const Eigen::Matrix4f_u *transformations,
+                         const Eigen::Matrix6f_u *informations,
+                         const float *line_process,
+                         Eigen::Matrix6f_u *edge_blocks,
+                         float *diagonal,
+                         float *rhs)
+        : edge_functor_base(poses, ids, transformations, informations),
+          line_process_(line_process),
+          edge_blocks_(edge_blocks),
+          diagonal_(diagonal),
+          rhs_(rhs){};
+    const float *line_process_;
+    Eigen::Matrix6f_u *edge_blocks_;
+    float *diagonal_;
+    float *rhs_;
+    __device__ void operator()(int e) const {
+        const int i = ids_[e][0];
+        const int j = ids_[e][1];
+        const Eigen::Vector6f r = Residual(e);
+        const Eigen::Matrix6f a = ComputeEdgeJacobian(poses_[j]);
+        const Eigen::Matrix6f atl = line_process_[e] * a.transpose() *
+                                    Eigen::Matrix6f(informations_[e]);
+        const Eigen::Matrix6f m = atl * a;
+        const Eigen::Vector6f g = atl * r;
+        edge_blocks_[e] = m;
+        for (int k = 0; k < 36; ++k) {
+            atomicAdd(&diagonal_[i * 36 + k], m(k));
+            atomicAdd(&diagonal_[j * 36 + k], m(k));
+        }
+        for (int k = 0; k < 6; ++k) {
+            atomicAdd(&rhs_[i * 6 + k], g(k));
+            atomicAdd(&rhs_[j * 6 + k], -g(k));
+        }
+    }
+};
+
+/// Diagonal block of node n of H + lambda I, first in the triplets of the
+/// system; the block of the reference node is the identity.
+struct node_block_functor {
+    node_block_functor(const float *diagonal,
+                       float lambda,
+                       int reference_node,
+                       int *rows,
+                       int *cols,
+                       float *values)
+        : diagonal_(diagonal),
+          lambda_(lambda),
+          reference_node_(reference_node),
+          rows_(rows),
+          cols_(cols),
+          values_(values){};
+    const float *diagonal_;
+    const float lambda_;
+    const int reference_node_;
+    int *rows_;
+    int *cols_;
+    float *values_;
+    __device__ void operator()(int n) const {
+        rows_[n] = n;
+        cols_[n] = n;
+        Eigen::Map<Eigen::Matrix6f> block(values_ + n * 36);
+        if (n == reference_node_) {
+            block.setIdentity();
+            return;
+        }
+        block = Eigen::Map<const Eigen::Matrix6f>(diagonal_ + n * 36) +
+                lambda_ * Eigen::Matrix6f::Identity();
+    }
+};
+
+/// Off-diagonal blocks -M of edge e, at (i, j) and (j, i) after the node
+/// blocks; zero if an endpoint is the reference node, whose row and column
+/// are eliminated.
+struct edge_block_functor {
+    edge_block_functor(const Eigen::Vector2i *ids,
+                       const Eigen::Matrix6f_u *edge_blocks,
+                       int reference_node,
+                       int n_nodes,
+                       int *rows,
+                       int *cols,
+                       float *values)
+        : ids_(ids),
+          edge_blocks_(edge_blocks),
+          reference_node_(reference_node),
+          n_nodes_(n_nodes),
+          rows_(rows),
+          cols_(cols),
+          values_(values){};
+    const Eigen::Vector2i *ids_;
+    const Eigen::Matrix6f_u *edge_blocks_;
+    const int reference_node_;
+    const int n_nodes_;
+    int *rows_;
+    int *cols_;
+    float *values_;
+    __device__ void operator()(int e) const {
+        const int i = ids_[e][0];
+        const int j = ids_[e][1];
+        const int k = n_nodes_ + 2 * e;
+        rows_[k] = i;
+        cols_[k] = j;
+        rows_[k + 1] = j;
+        cols_[k + 1] = i;
+        Eigen::Matrix6f m = -Eigen::Matrix6f(edge_blocks_[e]);
+        if (i == reference_node_ || j == reference_node_) m.setZero();
+        Eigen::Map<Eigen::Matrix6f>(values_ + k * 36) = m;
+        Eigen::Map<Eigen::Matrix6f>(values_ + (k + 1) * 36) = m.transpose();
+    }
+};
+
+struct update_poses_functor {
+    update_poses_functor(const Eigen::Matrix4f_u *poses,
+                         const float *delta,
+                         Eigen::Matrix4f_u *updated)
+        : poses_(poses), delta_(delta), updated_(updated){};
+    const Eigen::Matrix4f_u *poses_;
+    const float *delta_;
+    Eigen::Matrix4f_u *updated_;
+    __device__ void operator()(int n) const {
+        updated_[n] = utility::DeviceVector6fToMatrix4f(
+                              Eigen::Map<const Eigen::Vector6f>(delta_ +
+                                                                n * 6)) *
+                      poses_[n];
+    }
+};
+
+struct diagonal_entry_functor {
+    diagonal_entry_functor(const float *diagonal) : diagonal_(diagonal){};
+    const float *diagonal_;
+    __device__ float operator()(int k) const {
+        return diagonal_[(k / 6) * 36 + (k % 6) * 7];
+    }
+};
+
+struct abs_functor {
+    __device__ float operator()(float x) const { return fabs(x); }
+};
+
+struct translation_norm2_functor {
+    __device__ float operator()(const Eigen::Matrix4f_u &pose) const {
+        return pose.block<3, 1>(0, 3).squaredNorm();
+    }
+};
+
+float Dot(const utility::device_vector<float> &a,
+          const utility::device_vector<float> &b) {
+    return thrust::inner_product(a.begin(), a.end(), b.begin(), 0.0f);
+}
+
+/// Pose graph on the device with the block sparse normal equations of its
+/// current poses.
+class DevicePoseGraph {
+public:
+    DevicePoseGraph(const PoseGraph &pose_graph,
+                    int reference_node,
+                    float line_process_weight)
+        : n_nodes_(pose_graph.nodes_.size()),
+          n_edges_(pose_graph.edges_.size()),
+          reference_node_(reference_node),
+          mu_(line_process_weight) {
+        thrust::host_vector<Eigen::Matrix4f_u> poses(n_nodes_);
+        for (int n = 0; n < n_nodes_; ++n) {
+            poses[n] = pose_graph.nodes_[n].pose_;
+        }
+        thrust::host_vector<Eigen::Vector2i> ids(n_edges_);
+        thrust::host_vector<Eigen::Matrix4f_u> transformations(n_edges_);
+        thrust::host_vector<Eigen::Matrix6f_u> informations(n_edges_);
+        thrust::host_vector<int> uncertain(n_edges_);
+        for (int e = 0; e < n_edges_; ++e) {
+            const auto &edge = pose_graph.edges_[e];
+            ids[e] = Eigen::Vector2i(edge.source_node_id_,
+                                     edge.target_node_id_);
+            transformations[e] = edge.transformation_;
+            informations[e] = edge.information_;
+            uncertain[e] = edge.uncertain_;
+        }
+        poses_ = poses;
+        ids_ = ids;
+        transformations_ = transformations;
+        informations_ = informations;
+        uncertain_ = uncertain;
+        line_process_.resize(n_edges_, 1.0);
+        edge_blocks_.resize(n_edges_);
+        diagonal_.resize(n_nodes_ * 36);
+        rhs_.resize(n_nodes_ * 6);
+        updated_poses_.resize(n_nodes_);
+        b_.resize(n_nodes_ * 6);
+        triplet_rows_.resize(n_nodes_ + 2 * n_edges_);
+        triplet_cols_.resize(n_nodes_ + 2 * n_edges_);
+        triplet_values_.resize((n_nodes_ + 2 * n_edges_) * 36);
+    }
+
+public:
+    void CopyTo(PoseGraph &pose_graph) const {
+        thrust::host_vector<Eigen::Matrix4f_u> poses = poses_;
+        for (int n = 0; n < n_nodes_; ++n) {
+            pose_graph.nodes_[n].pose_ = poses[n];
+        }
+        thrust::host_vector<float> line_process = line_process_;
+        for (int e = 0; e < n_edges_; ++e) {
+            if (pose_graph.edges_[e].uncertain_) {
+                pose_graph.edges_[e].confidence_ = line_process[e];
+            }
+        }
+    }
+
+    float ComputeCost(const utility::device_vector<Eigen::Matrix4f_u> &poses)
+            const {
+        edge_cost_functor func(thrust::raw_pointer_cast(poses.data()),
+                               thrust::raw_pointer_cast(ids_.data()),
+                               thrust::raw_pointer_cast(transformations_.data()),
+                               thrust::raw_pointer_cast(informations_.data()),
+                               thrust::raw_pointer_cast(uncertain_.data()),
+                               thrust::raw_pointer_cast(line_process_.data()),
+                               mu_);
+        return thrust::transform_reduce(
+                thrust::make_counting_iterator(0),
+                thrust::make_counting_iterator(n_edges_), func, 0.0f,
+                thrust::plus<float>());
+    }
+
+    void UpdateLineProcess() {
+        update_line_process_functor func(
+                thrust::raw_pointer_cast(poses_.data()),
+                thrust::raw_pointer_cast(ids_.data()),
+                thrust::raw_pointer_cast(transformations_.data()),
+                thrust::raw_pointer_cast(informations_.data()),
+                thrust::raw_pointer_cast(uncertain_.data()),
+                thrust::raw_pointer_cast(line_process_.data()), mu_);
+        thrust::for_each(thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(n_edges_), func);
+    }
+
+    void BuildSystem() {
+        thrust::fill(diagonal_.begin(), diagonal_.end(), 0.0f);
+        thrust::fill(rhs_.begin(), rhs_.end(), 0.0f);
+        build_system_functor func(
+                thrust::raw_pointer_cast(poses_.data()),
+                thrust::raw_pointer_cast(ids_.data()),
+                thrust::raw_pointer_cast(transformations_.data()),
+                thrust::raw_pointer_cast(informations_.data()),
+                thrust::raw_pointer_cast(line_process_.data()),
+                thrust::raw_pointer_cast(edge_blocks_.data()),
+                thrust::raw_pointer_cast(diagonal_.data()),
+                thrust::raw_pointer_cast(rhs_.data()));
+        thrust::for_each(thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(n_edges_), func);
+        thrust::fill_n(rhs_.begin() + reference_node_ * 6, 6, 0.0f);
+    }
+
+    float GetMaxDiagonal() const {
+        return thrust::transform_reduce(
+                thrust::make_counting_iterator(0),
+                thrust::make_counting_iterator(n_nodes_ * 6),
+                diagonal_entry_functor(
+                        thrust::raw_pointer_cast(diagonal_.data())),
+                0.0f, thrust::maximum<float>());
+    }
+
+    float GetMaxRightTerm() const {
+        return thrust::transform_reduce(rhs_.begin(), rhs_.end(),
+                                        abs_functor(), 0.0f,
+                                        thrust::maximum<float>());
+    }
+
+    float GetTranslationNorm() const {
+        return std::sqrt(thrust::transform_reduce(
+                poses_.begin(), poses_.end(), translation_norm2_functor(),
+                0.0f, thrust::plus<float>()));
+    }
+
+    /// Solves (H + lambda I) delta = -b by conjugate gradients
+    /// preconditioned with the inverse diagonal blocks.
+    void Solve(float lambda,
+               const GlobalOptimizationConvergenceCriteria &criteria,
+               utility::device_vector<float> &delta) {
+        delta.resize(n_nodes_ * 6);
+        thrust::fill(delta.begin(), delta.end(), 0.0f);
+        thrust::transform(rhs_.begin(), rhs_.end(), b_.begin(),
+                          thrust::negate<float>());
+        const utility::SparseMatrix system = BuildSparseSystem(lambda);
+        utility::SolveConjugateGradient(
+                system, b_, delta,
+                utility::ConjugateGradientOption(
+                        criteria.max_iteration_pcg_,
+                        criteria.pcg_relative_tolerance_,
+                        utility::PreconditionerType::BlockJacobi));
+    }
+
+    /// Reduction of the cost predicted by the linear model for \p delta.
+    float PredictedReduction(float lambda,
+                             const utility::device_vector<float> &delta) const {
+        return 0.5 * (lambda * Dot(delta, delta) - Dot(delta, rhs_));
+    }
+
+    /// Applies \p delta to the poses into the candidate poses.
+    const utility::device_vector<Eigen::Matrix4f_u> &UpdatePoses(
+            const utility::device_vector<float> &delta) {
+        update_poses_functor func(
+                thrust::raw_pointer_cast(poses_.data()),
+                thrust::raw_pointer_cast(delta.data()),
+                thrust::raw_pointer_cast(updated_poses_.data()));
+        thrust::for_each(thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(n_nodes_), func);
+        return updated_poses_;
+    }
+
+    void AcceptUpdatedPoses() { poses_.swap(updated_poses_); }
+
+    const utility::device_vector<Eigen::Matrix4f_u> &GetPoses() const {
+        return poses_;
+    }
+
+private:
+    /// H + lambda I in 6x6 blocks, one per node and two per edge.
+    utility::SparseMatrix BuildSparseSystem(float lambda) {
+        node_block_functor node_func(
+                thrust::raw_pointer_cast(diagonal_.data()), lambda,
+                reference_node_,
+                thrust::raw_pointer_cast(triplet_rows_.data()),
+                thrust::raw_pointer_cast(triplet_cols_.data()),
+                thrust::raw_pointer_cast(triplet_values_.data()));
+        thrust::for_each(thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(n_nodes_), node_func);
+        edge_block_functor edge_func(
+                thrust::raw_pointer_cast(ids_.data()),
+                thrust::raw_pointer_cast(edge_blocks_.data()),
+                reference_node_, n_nodes_,
+                thrust::raw_pointer_cast(triplet_rows_.data()),
+                thrust::raw_pointer_cast(triplet_cols_.data()),
+                thrust::raw_pointer_cast(triplet_values_.data()));
+        thrust::for_each(thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(n_edges_), edge_func);
+        return utility::SparseMatrix::FromTriplets(n_nodes_, n_nodes_, 6,
+                                                   triplet_rows_,
+                                                   triplet_cols_,
+                                                   triplet_values_);
+    }
+
+    const int n_nodes_;
+    const int n_edges_;
+    const int reference_node_;
+    const float mu_;
+    utility::device_vector<Eigen::Matrix4f_u> poses_;
+    utility::device_vector<Eigen::Matrix4f_u> updated_poses_;
+    utility::device_vector<Eigen::Vector2i> ids_;
+    utility::device_vector<Eigen::Matrix4f_u> transformations_;
+    utility::device_vector<Eigen::Matrix6f_u> informations_;
+    utility::device_vector<int> uncertain_;
+    utility::device_vector<float> line_process_;
+    utility::device_vector<Eigen::Matrix6f_u> edge_blocks_;
+    utility::device_vector<float> diagonal_;
+    utility::device_vector<float> rhs_;
+    utility::device_vector<float> b_;
+    utility::device_vector<int> triplet_rows_;
+    utility::device_vector<int> triplet_cols_;
+    utility::device_vector<float> triplet_values_;
+};
+
+void OptimizeDevicePoseGraph(
+        DevicePoseGraph &graph,
+        bool levenberg_marquardt,
+        const GlobalOptimizationConvergenceCriteria &criteria) {
+    utility::device_vector<float> delta;
+    float lambda = -1.0;
+    float nu = 2.0;
+    for (int i = 0; i < criteria.max_iteration_; ++i) {
+        graph.UpdateLineProcess();
+        const float cost = graph.ComputeCost(graph.GetPoses());
+        utility::LogDebug("[GlobalOptimization] Iteration #{:d}: residual {:e}",
+                          i, cost);
+        if (cost < criteria.min_residual_) break;
+        graph.BuildSystem();
+        if (graph.GetMaxRightTerm() < criteria.min_right_term_) break;
+        if (levenberg_marquardt && lambda < 0.0) {
+            lambda = kInitialLambdaScale * graph.GetMaxDiagonal();
+        }
+        const float x_norm = graph.GetTranslationNorm();
+        const int max_iteration_lm =
+                (levenberg_marquardt) ? criteria.max_iteration_lm_ : 1;
+        bool stop = true;
+        for (int j = 0; j < max_iteration_lm; ++j) {
+            const float damping = (levenberg_marquardt) ? lambda : 0.0;
+            graph.Solve(damping, criteria, delta);
+            if (std::sqrt(Dot(delta, delta)) <
+                criteria.min_relative_increment_ *
+                        (x_norm + criteria.min_relative_increment_)) {
+                break;
+            }
+            const float new_cost =
+                    graph.ComputeCost(graph.UpdatePoses(delta));
+            if (levenberg_marquardt) {
+                const float rho = (cost - new_cost) /
+                                  graph.PredictedReduction(damping, delta);
+                if (!(rho > 0.0)) {
+                    lambda *= nu;
+                    nu *= 2.0;
+                    continue;
+                }
+                const float s = 2.0 * rho - 1.0;
+                lambda *= std::max(1.0f / 3.0f, 1.0f - s * s * s);
+                nu = 2.0;
+            }
+            graph.AcceptUpdatedPoses();
+            stop = (cost - new_cost <
+                    criteria.min_relative_residual_increment_ * cost);
+            break;
+        }
+        if (stop) break;
+    }
+    graph.UpdateLineProcess();
+}
+
+/// Weight mu of the line process of the uncertain edges, the penalty of an
+/// edge that is switched off. The information matrices grow with the number
+/// of correspondences, so mu is scaled by the mean translational
+/// information of the certain edges.
+float ComputeLineProcessWeight(const PoseGraph &pose_graph,
+                               const GlobalOptimizationOption &option) {
+    float sum = 0.0;
+    int count = 0;
+    for (const auto &edge : pose_graph.edges_) {
+        if (edge.uncertain_) continue;
+        sum += edge.information_(5, 5);
+        ++count;
+    }
+    const float mean_information = (count > 0) ? sum / count : 1.0;
+    return option.preference_loop_closure_ *
+           option.max_correspondence_distance_ *
+           option.max_correspondence_distance_ * mean_information;
+}
+
+void OptimizePoseGraph(PoseGraph &pose_graph,
+                       const GlobalOptimizationMethod &method,
+                       const GlobalOptimizationConvergenceCriteria &criteria,
+                       int reference_node,
+                       float line_process_weight) {
+    DevicePoseGraph graph(pose_graph, reference_node, line_process_weight);
+    OptimizeDevicePoseGraph(graph,
+                            method.GetGlobalOptimizationMethodType() ==
+                                    GlobalOptimizationMethodType::
+                                            LevenbergMarquardt,
+                            criteria);
+    graph.CopyTo(pose_graph);
+}
+
+}  // namespace
+
+void cupoch::registration::GlobalOptimization(
+        PoseGraph &pose_graph,
+        const GlobalOptimizationMethod &method,
+        const GlobalOptimizationConvergenceCriteria &criteria,
+        const GlobalOptimizationOption &option) {
+    const int n_nodes = pose_graph.nodes_.size();
+    if (n_nodes == 0 || pose_graph.edges_.empty()) {
+        utility::LogWarning(
+                "[GlobalOptimization] Pose graph has no nodes or no edges.");
+        return;
+    }
+    if (pose_graph.CountInvalidEdges() > 0) {
+        utility::LogError("[GlobalOptimization] Pose graph has invalid edges.");
+        return;
+    }
+    const int reference_node =
+            (option.reference_node_ < 0) ? 0 : option.reference_node_;
+    if (reference_node >= n_nodes) {
+        utility::LogError("[GlobalOptimization] Invalid reference node {:d}.",
+                          reference_node);
+        return;
+    }
+    const float line_process_weight =
+            ComputeLineProcessWeight(pose_graph, option);
+    OptimizePoseGraph(pose_graph, method, criteria, reference_node,
+                      line_process_weight);
+
+    std::vector<PoseGraphEdge> edges;
+    edges.reserve(pose_graph.edges_.size());
+    for (const auto &edge : pose_graph.edges_) {
+        if (!edge.uncertain_ ||
+            edge.confidence_ >= option.edge_prune_threshold_) {
+            edges.push_back(edge);
+        }
+    }
+    if (edges.size() == pose_graph.edges_.size()) return;
+    utility::LogDebug("[GlobalOptimization] Pruned {:d} edges.",
+                      pose_graph.edges_.size() - edges.size());
+    pose_graph.edges_.swap(edges);
+    OptimizePoseGraph(pose_graph, method, criteria, reference_node,
+                      line_process_weight);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "cupoch/registration/pose_graph.h"
+
+namespace cupoch {
+namespace registration {
+
+enum class GlobalOptimizationMethodType {
+    Unspecified = 0,
+    LevenbergMarquardt = 1,
+    GaussNewton = 2,
+};
+
+/// \class GlobalOptimizationMethod
+///
+/// \brief Base class of the solvers of GlobalOptimization().
+class GlobalOptimizationMethod {
+public:
+    GlobalOptimizationMethod() {}
+    virtual ~GlobalOptimizationMethod() {}
+
+public:
+    virtual GlobalOptimizationMethodType GetGlobalOptimizationMethodType()
+            const = 0;
+};
+
+/// Levenberg-Marquardt steps with an adaptive damping of the normal
+/// equations; a step is kept only if it lowers the residual.
+class GlobalOptimizationLevenbergMarquardt : public GlobalOptimizationMethod {
+public:
+    GlobalOptimizationLevenbergMarquardt() {}
+    ~GlobalOptimizationLevenbergMarquardt() override {}
+
+public:
+    GlobalOptimizationMethodType GetGlobalOptimizationMethodType()
+            const override {
+        return GlobalOptimizationMethodType::LevenbergMarquardt;
+    }
+};
+
+/// Undamped Gauss-Newton steps, all of them kept.
+class GlobalOptimizationGaussNewton : public GlobalOptimizationMethod {
+public:
+    GlobalOptimizationGaussNewton() {}
+    ~GlobalOptimizationGaussNewton() override {}
+
+public:
+    GlobalOptimizationMethodType GetGlobalOptimizationMethodType()
+            const override {
+        return GlobalOptimizationMethodType::GaussNewton;
+    }
+};
+
+class GlobalOptimizationConvergenceCriteria {
+public:
+    GlobalOptimizationConvergenceCriteria(
+            int max_iteration = 100,
+            float min_relative_increment = 1e-6,
+            float min_relative_residual_increment = 1e-6,
+            float min_right_term = 1e-6,
+            float min_residual = 1e-6,
+            int max_iteration_lm = 20,
+            int max_iteration_pcg = 200,
+            float pcg_relative_tolerance = 1e-6)
+        : max_iteration_(max_iteration),
+          min_relative_increment_(min_relative_increment),
+          min_relative_residual_increment_(min_relative_residual_increment),
+          min_right_term_(min_right_term),
+          min_residual_(min_residual),
+          max_iteration_lm_(max_iteration_lm),
+          max_iteration_pcg_(max_iteration_pcg),
+          pcg_relative_tolerance_(pcg_relative_tolerance) {}
+    ~GlobalOptimizationConvergenceCriteria() {}
+
+public:
+    int max_iteration_;
+    /// Stops when the norm of the step falls below this fraction of the
+    /// norm of the node translations.
+    float min_relative_increment_;
+    float min_relative_residual_increment_;
+    /// Stops when the largest entry of the gradient falls below this value.
+    float min_right_term_;
+    float min_residual_;
+    /// Maximum number of damping updates in one Levenberg-Marquardt step.
+    int max_iteration_lm_;
+    /// The normal equations are solved by conjugate gradients, stopped
+    /// after max_iteration_pcg_ iterations or when the residual norm falls
+    /// below pcg_relative_tolerance_ times the norm of the right hand side.
+    int max_iteration_pcg_;
+    float pcg_relative_tolerance_;
+};
+
+class GlobalOptimizationOption {
+public:
+    GlobalOptimizationOption(float max_correspondence_distance = 0.075,
+                             float edge_prune_threshold = 0.25,
+                             float preference_loop_closure = 1.0,
+                             int reference_node = -1)
+        : max_correspondence_distance_(max_correspondence_distance),
+          edge_prune_threshold_(edge_prune_threshold),
+          preference_loop_closure_(preference_loop_closure),
+          reference_node_(reference_node) {}
+    ~GlobalOptimizationOption() {}
+
+public:
+    /// Distance used to compute the information matrices of the edges; it
+    /// scales the penalty of the uncertain edges.
+    float max_correspondence_distance_;
+    /// Uncertain edges whose confidence ends below this value are removed.
+    float edge_prune_threshold_;
+    /// Weight of the uncertain edges against the certain ones.
+    float preference_loop_closure_;
+    /// Node kept fixed; -1 fixes the first node.
+    int reference_node_;
+};
+
+/// Optimizes the poses of \p pose_graph in place. Every edge (i, j)
+/// contributes the residual log(T_j^-1 T_i T_ij^-1) weighted by its
+/// information matrix, and every uncertain edge is weighted by a line
+/// process. The Jacobian has one 6x6 block per edge endpoint, so the normal
+/// equations are assembled on the device as one diagonal block per node and
+/// one off-diagonal block per edge, and solved by conjugate gradients
+/// preconditioned with the inverse diagonal blocks. After the optimization
+/// the uncertain edges get their final confidence, the ones below
+/// GlobalOptimizationOption::edge_prune_threshold_ are removed and the
+/// pruned graph is optimized again.
+void GlobalOptimization(
+        PoseGraph &pose_graph,
+        const GlobalOptimizationMethod &method =
+                GlobalOptimizationLevenbergMarquardt(),
+        const GlobalOptimizationConvergenceCriteria &criteria =
+                GlobalOptimizationConvergenceCriteria(),
+        const GlobalOptimizationOption &option = GlobalOptimizationOption());
+
+}  // namespace registration
+}  // namespace cupoch
@@ -0,0 +1,534 @@
+#include <thrust/extrema.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/random.h>
+
+#include <Eigen/Geometry>
+#include <cmath>
+#include <limits>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/registration/feature_matching.h"
+#include "cupoch/registration/global_registration.h"
+#include "cupoch/registration/kabsch.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/svd3_cuda.h"
+
+using namespace cupoch;
+using namespace cupoch::registration;
+
+namespace {
+
+__device__ unsigned int HashSeed(unsigned int seed, unsigned int idx) {
+    unsigned int h = seed ^ (idx * 0x9e3779b9u);
+    h = (h ^ 61) ^ (h >> 16);
+    h *= 9;
+    h = h ^ (h >> 4);
+    h *= 0x27d4eb2d;
+    return h ^ (h >> 15);
+}
+
+__device__ void SampleTriplet(thrust::default_random_engine &rng,
+                              int n,
+                              int samples[3]) {
+    thrust::uniform_int_distribution<int> dist(0, n - 1);
+    samples[0] = dist(rng);
+    do {
+        samples[1] = dist(rng);
+    } while (samples[1] == samples[0]);
+    do {
+        samples[2] = dist(rng);
+    } while (samples[2] == samples[0] || samples[2] == samples[1]);
+}
+
+// A rigid transform keeps the edge lengths, so the triangles of a valid
+// triplet have edges within \p similarity of each other.
+__device__ bool IsSimilarTriangle(const Eigen::Vector3f *src,
+                                  const Eigen::Vector3f *tgt,
+                                  float similarity) {
+    for (int k = 0; k < 3; ++k) {
+        const float src_len = (src[k] - src[(k + 1) % 3]).norm();
+        const float tgt_len = (tgt[k] - tgt[(k + 1) % 3]).norm();
+        if (src_len < similarity * tgt_len || tgt_len < similarity * src_len) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Kabsch on the 3 sampled pairs, the same solve as Kabsch() on the host.
+__device__ Eigen::Matrix4f EstimateRigidTransform(const Eigen::Vector3f *src,
+                                                  const Eigen::Vector3f *tgt) {
+    const Eigen::Vector3f src_center = (src[0] + src[1] + src[2]) / 3.0;
+    const Eigen::Vector3f tgt_center = (tgt[0] + tgt[1] + tgt[2]) / 3.0;
+    Eigen::Matrix3f hh = Eigen::Matrix3f::Zero();
+    for (int k = 0; k < 3; ++k) {
+        hh += (src[k] - src_center) * (tgt[k] - tgt_center).transpose();
+    }
+    Eigen::Matrix3f uu, ss, vv;
+    svd(hh(0, 0), hh(0, 1), hh(0, 2), hh(1, 0), hh(1, 1), hh(1, 2), hh(2, 0),
+        hh(2, 1), hh(2, 2), uu(0, 0), uu(0, 1), uu(0, 2), uu(1, 0), uu(1, 1),
+        uu(1, 2), uu(2, 0), uu(2, 1), uu(2, 2), ss(0, 0), ss(0, 1), ss(0, 2),
+        ss(1, 0), ss(1, 1), ss(1, 2), ss(2, 0), ss(2, 1), ss(2, 2), vv(0, 0),
+        vv(0, 1), vv(0, 2), vv(1, 0), vv(1, 1), vv(1, 2), vv(2, 0), vv(2, 1),
+        vv(2, 2));
+    ss = Eigen::Matrix3f::Identity();
+    ss(2, 2) = (uu * vv).determinant();
+    Eigen::Matrix4f tr = Eigen::Matrix4f::Identity();
+    tr.block<3, 3>(0, 0) = vv * ss * uu.transpose();
+    tr.block<3, 1>(0, 3) = tgt_center - tr.block<3, 3>(0, 0) * src_center;
+    return tr;
+}
+
+struct ransac_hypothesis_functor {
+    ransac_hypothesis_functor(const Eigen::Vector3f *source,
+                              const Eigen::Vector3f *target,
+                              const Eigen::Vector2i *corres,
+                              int n_corres,
+                              float max_correspondence_distance,
+                              unsigned int seed)
+        : source_(source),
+          target_(target),
+          corres_(corres),
+          n_corres_(n_corres),
+          max_dist2_(max_correspondence_distance *
+                     max_correspondence_distance),
+          seed_(seed){};
+    const Eigen::Vector3f *source_;
+    const Eigen::Vector3f *target_;
+    const Eigen::Vector2i *corres_;
+    const int n_corres_;
+    const float max_dist2_;
+    const unsigned int seed_;
+    // Pairs whose edge lengths differ by more than this ratio cannot be
+    // related by a rigid transform and are rejected before scoring.
+    static constexpr float kEdgeLengthSimilarity = 0.9;
+    __device__ thrust::tuple<int, Eigen::Matrix4f_u> operator()(
+            unsigned int idx) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        int samples[3];
+        SampleTriplet(rng, n_corres_, samples);
+        Eigen::Vector3f src[3];
+        Eigen::Vector3f tgt[3];
+        for (int k = 0; k < 3; ++k) {
+            src[k] = source_[corres_[samples[k]][0]];
+            tgt[k] = target_[corres_[samples[k]][1]];
+        }
+        if (!IsSimilarTriangle(src, tgt, kEdgeLengthSimilarity)) {
+            return thrust::make_tuple(0, Eigen::Matrix4f_u::Identity());
+        }
+        const Eigen::Matrix4f tr = EstimateRigidTransform(src, tgt);
+        const Eigen::Matrix3f rot = tr.block<3, 3>(0, 0);
+        const Eigen::Vector3f trans = tr.block<3, 1>(0, 3);
+        int count = 0;
+        for (int i = 0; i < n_corres_; ++i) {
+            const Eigen::Vector3f diff = rot * source_[corres_[i][0]] + trans -
+                                         target_[corres_[i][1]];
+            if (diff.squaredNorm() < max_dist2_) ++count;
+        }
+        return thrust::make_tuple(count, Eigen::Matrix4f_u(tr));
+    }
+};
+
+struct correspondence_error_functor {
+    correspondence_error_functor(const Eigen::Vector3f *source,
+                                 const Eigen::Vector3f *target,
+                                 const Eigen::Matrix4f &transformation)
+        : source_(source),
+          target_(target),
+          rot_(transformation.block<3, 3>(0, 0)),
+          trans_(transformation.block<3, 1>(0, 3)){};
+    const Eigen::Vector3f *source_;
+    const Eigen::Vector3f *target_;
+    const Eigen::Matrix3f rot_;
+    const Eigen::Vector3f trans_;
+    __device__ float operator()(const Eigen::Vector2i &c) const {
+        return (rot_ * source_[c[0]] + trans_ - target_[c[1]]).squaredNorm();
+    }
+};
+
+struct tuple_test_functor {
+    tuple_test_functor(const Eigen::Vector3f *source,
+                       const Eigen::Vector3f *target,
+                       const Eigen::Vector2i *corres,
+                       int n_corres,
+                       float tuple_scale,
+                       unsigned int seed)
+        : source_(source),
+          target_(target),
+          corres_(corres),
+          n_corres_(n_corres),
+          tuple_scale_(tuple_scale),
+          seed_(seed){};
+    const Eigen::Vector3f *source_;
+    const Eigen::Vector3f *target_;
+    const Eigen::Vector2i *corres_;
+    const int n_corres_;
+    const float tuple_scale_;
+    const unsigned int seed_;
+    __device__ thrust::tuple<bool, Eigen::Vector3i> operator()(
+            unsigned int idx) const {
+        thrust::default_random_engine rng(HashSeed(seed_, idx));
+        int samples[3];
+        SampleTriplet(rng, n_corres_, samples);
+        Eigen::Vector3f src[3];
+        Eigen::Vector3f tgt[3];
+        for (int k = 0; k < 3; ++k) {
+            src[k] = source_[corres_[samples[k]][0]];
+            tgt[k] = target_[corres_[samples[k]][1]];
+        }
+        return thrust::make_tuple(
+                IsSimilarTriangle(src, tgt, tuple_scale_),
+                Eigen::Vector3i(samples[0], samples[1], samples[2]));
+    }
+};
+
+struct normalize_points_functor {
+    normalize_points_functor(const Eigen::Vector3f &center, float scale)
+        : center_(center), scale_(scale){};
+    const Eigen::Vector3f center_;
+    const float scale_;
+    __device__ Eigen::Vector3f operator()(const Eigen::Vector3f &p) const {
+        return (p - center_) / scale_;
+    }
+};
+
+struct distance_to_center_functor {
+    distance_to_center_functor(const Eigen::Vector3f &center)
+        : center_(center){};
+    const Eigen::Vector3f center_;
+    __device__ float operator()(const Eigen::Vector3f &p) const {
+        return (p - center_).norm();
+    }
+};
+
+struct fgr_jacobian_residual_functor {
+    fgr_jacobian_residual_functor(const Eigen::Vector3f *source,
+                                  const Eigen::Vector3f *target,
+                                  const Eigen::Vector2i *corres,
+                                  const Eigen::Matrix4f &transformation,
+                                  float mu)
+        : source_(source),
+          target_(target),
+          corres_(corres),
+          rot_(transformation.block<3, 3>(0, 0)),
+          trans_(transformation.block<3, 1>(0, 3)),
+          mu_(mu){};
+    const Eigen::Vector3f *source_;
+    const Eigen::Vector3f *target_;
+    const Eigen::Vector2i *corres_;
+    const Eigen::Matrix3f rot_;
+    const Eigen::Vector3f trans_;
+    const float mu_;
+    // Geman-McClure penalty through its line process: the weight of a pair
+    // is (mu / (mu + r^2))^2, applied as its square root to both the
+    // jacobian rows and the residuals.
+    __device__ void operator()(int idx,
+                               Eigen::Vector6f *vec,
+                               float *r) const {
+        const Eigen::Vector3f q = rot_ * source_[corres_[idx][0]] + trans_;
+        const Eigen::Vector3f rpq = q - target_[corres_[idx][1]];
+        const float w = mu_ / (rpq.squaredNorm() + mu_);
+        vec[0] << 0.0, q(2), -q(1), 1.0, 0.0, 0.0;
+        vec[1] << -q(2), 0.0, q(0), 0.0, 1.0, 0.0;
+        vec[2] << q(1), -q(0), 0.0, 0.0, 0.0, 1.0;
+        for (int k = 0; k < 3; ++k) {
+            vec[k] *= w;
+            r[k] = w * rpq(k);
+        }
+    }
+};
+
+// Fills the inliers of \p corres under \p transformation and the fitness
+// and RMSE over them into \p result.
+void EvaluateCorrespondences(const geometry::PointCloud &source,
+                             const geometry::PointCloud &target,
+                             const CorrespondenceSet &corres,
+                             float max_correspondence_distance,
+                             const Eigen::Matrix4f &transformation,
+                             RegistrationResult &result) {
+    const float max_dist2 =
+            max_correspondence_distance * max_correspondence_distance;
+    correspondence_error_functor func(
+            thrust::raw_pointer_cast(source.points_.data()),
+            thrust::raw_pointer_cast(target.points_.data()), transformation);
+    result.transformation_ = transformation;
+    result.fitness_ = 0.0;
+    result.inlier_rmse_ = 0.0;
+    result.correspondence_set_.resize(corres.size());
+    auto end = thrust::copy_if(
+            corres.begin(), corres.end(), result.correspondence_set_.begin(),
+            [func, max_dist2] __device__(const Eigen::Vector2i &c) {
+                return func(c) < max_dist2;
+            });
+    result.correspondence_set_.resize(
+            thrust::distance(result.correspondence_set_.begin(), end));
+    if (!result.correspondence_set_.empty()) {
+        const float error2 = thrust::transform_reduce(
+                result.correspondence_set_.begin(),
+                result.correspondence_set_.end(), func, 0.0f,
+                thrust::plus<float>());
+        const size_t n_inliers = result.correspondence_set_.size();
+        result.fitness_ = (float)n_inliers / (float)source.points_.size();
+        result.inlier_rmse_ = std::sqrt(error2 / (float)n_inliers);
+    }
+}
+
+}  // namespace
+
+CorrespondenceSet cupoch::registration::ComputeFeatureCorrespondences(
+        const Feature<33> &source_feature,
+        const Feature<33> &target_feature,
+        bool mutual_filter /* = true*/) {
+    return MatchFeatures(source_feature, target_feature, mutual_filter);
+}
+
+RegistrationResult
+cupoch::registration::RegistrationRANSACBasedOnCorrespondence(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres,
+        float max_correspondence_distance,
+        const RANSACConvergenceCriteria
+                &criteria /* = RANSACConvergenceCriteria()*/,
+        unsigned int seed /* = 0*/) {
+    RegistrationResult result;
+    const int n_corres = corres.size();
+    if (n_corres < 3 || max_correspondence_distance <= 0.0 ||
+        criteria.max_iteration_ <= 0 ||
+        criteria.num_hypotheses_per_launch_ <= 0) {
+        utility::LogWarning(
+                "[RegistrationRANSACBasedOnCorrespondence] Needs at least 3 "
+                "correspondences and positive parameters.\n");
+        return result;
+    }
+
+    const int n_launch = std::min(criteria.num_hypotheses_per_launch_,
+                                  criteria.max_iteration_);
+    utility::device_vector<int> counts(n_launch);
+    utility::device_vector<Eigen::Matrix4f_u> transforms(n_launch);
+    ransac_hypothesis_functor func(
+            thrust::raw_pointer_cast(source.points_.data()),
+            thrust::raw_pointer_cast(target.points_.data()),
+            thrust::raw_pointer_cast(corres.data()), n_corres,
+            max_correspondence_distance, seed);
+    int best_count = 0;
+    Eigen::Matrix4f best_transformation = Eigen::Matrix4f::Identity();
+    int n_done = 0;
+    while (n_done < criteria.max_iteration_) {
+        const int n = std::min(n_launch, criteria.max_iteration_ - n_done);
+        thrust::transform(
+                thrust::make_counting_iterator<unsigned int>(n_done),
+                thrust::make_counting_iterator<unsigned int>(n_done + n),
+                make_tuple_begin(counts, transforms), func);
+        auto itr = thrust::max_element(counts.begin(), counts.begin() + n);
+        const int count = *itr;
+        n_done += n;
+        if (count > best_count) {
+            best_count = count;
+            best_transformation =
+                    transforms[thrust::distance(counts.begin(), itr)];
+        }
+        // Number of hypotheses needed to draw an all inlier sample with the
+        // requested confidence, at the best inlier ratio found so far.
+        if (best_count > 0) {
+            const double inlier_ratio = (double)best_count / n_corres;
+            const double p_sample = std::pow(inlier_ratio, 3);
+            if (p_sample >= 1.0) break;
+            const double n_needed = std::log(1.0 - criteria.confidence_) /
+                                    std::log(1.0 - p_sample);
+            if (n_done >= n_needed) break;
+        }
+    }
+    if (best_count < 3) return result;
+
+    // Refine on the inliers of the best hypothesis.
+    EvaluateCorrespondences(source, target, corres,
+                            max_correspondence_distance, best_transformation,
+                            result);
+    const Eigen::Matrix4f refined = Kabsch(source.points_, target.points_,
+                                           result.correspondence_set_);
+    EvaluateCorrespondences(source, target, corres,
+                            max_correspondence_distance, refined, result);
+    return result;
+}
+
+RegistrationResult
+cupoch::registration::RegistrationRANSACBasedOnFeatureMatching(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const Feature<33> &source_feature,
+        const Feature<33> &target_feature,
+        float max_correspondence_distance,
+        bool mutual_filter /* = true*/,
+        const RANSACConvergenceCriteria
+                &criteria /* = RANSACConvergenceCriteria()*/,
+        unsigned int seed /* = 0*/) {
+    if (source_feature.Num() != source.points_.size() ||
+        target_feature.Num() != target.points_.size()) {
+        utility::LogWarning(
+                "[RegistrationRANSACBasedOnFeatureMatching] The features do "
+                "not match the point clouds.\n");
+        return RegistrationResult();
+    }
+    const auto corres = ComputeFeatureCorrespondences(
+            source_feature, target_feature, mutual_filter);
+    return RegistrationRANSACBasedOnCorrespondence(
+            source, target, corres, max_correspondence_distance, criteria,
+            seed);
+}
+
+RegistrationResult
+cupoch::registration::FastGlobalRegistrationBasedOnCorrespondence(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres,
+        const FastGlobalRegistrationOption
+                &option /* = FastGlobalRegistrationOption()*/) {
+    RegistrationResult result;
+    if (corres.size() < 3 || option.maximum_correspondence_distance_ <= 0.0) {
+        utility::LogWarning(
+                "[FastGlobalRegistrationBasedOnCorrespondence] Needs at least "
+                "3 correspondences and a positive distance.\n");
+        return result;
+    }
+
+    // Tuple test: keep the correspondences of random triplets whose
+    // triangles have similar edge lengths in both clouds.
+    CorrespondenceSet tuple_corres;
+    const CorrespondenceSet *fgr_corres = &corres;
+    if (option.tuple_test_) {
+        const int n_corres = corres.size();
+        const int n_trials = n_corres * 100;
+        utility::device_vector<bool> passed(n_trials);
+        utility::device_vector<Eigen::Vector3i> tuples(n_trials);
+        tuple_test_functor func(thrust::raw_pointer_cast(source.points_.data()),
+                                thrust::raw_pointer_cast(target.points_.data()),
+                                thrust::raw_pointer_cast(corres.data()),
+                                n_corres, option.tuple_scale_, option.seed_);
+        thrust::transform(
+                thrust::make_counting_iterator<unsigned int>(0),
+                thrust::make_counting_iterator<unsigned int>(n_trials),
+                make_tuple_begin(passed, tuples), func);
+        auto end = thrust::remove_if(tuples.begin(), tuples.end(),
+                                     passed.begin(),
+                                     thrust::logical_not<bool>());
+        const int n_tuples =
+                std::min((int)thrust::distance(tuples.begin(), end),
+                         option.maximum_tuple_count_);
+        utility::device_vector<int> used(n_corres, 0);
+        int *used_ptr = thrust::raw_pointer_cast(used.data());
+        thrust::for_each(tuples.begin(), tuples.begin() + n_tuples,
+                         [used_ptr] __device__(const Eigen::Vector3i &t) {
+                             used_ptr[t[0]] = 1;
+                             used_ptr[t[1]] = 1;
+                             used_ptr[t[2]] = 1;
+                         });
+        tuple_corres.resize(n_corres);
+        auto corres_end = thrust::copy_if(
+                corres.begin(), corres.end(), used.begin(),
+                tuple_corres.begin(),
+                [] __device__(int u) { return u != 0; });
+        tuple_corres.resize(thrust::distance(tuple_corres.begin(), corres_end));
+        if (tuple_corres.size() < 3) {
+            utility::LogWarning(
+                    "[FastGlobalRegistrationBasedOnCorrespondence] Too few "
+                    "correspondences pass the tuple test.\n");
+            return result;
+        }
+        fgr_corres = &tuple_corres;
+    }
+
+    // Both clouds are centered and scaled so that mu is relative to the
+    // extent of the clouds.
+    const size_t n_source = source.points_.size();
+    const size_t n_target = target.points_.size();
+    const Eigen::Vector3f source_center =
+            thrust::reduce(source.points_.begin(), source.points_.end(),
+                           Eigen::Vector3f(0.0, 0.0, 0.0),
+                           thrust::plus<Eigen::Vector3f>()) /
+            (float)n_source;
+    const Eigen::Vector3f target_center =
+            thrust::reduce(target.points_.begin(), target.points_.end(),
+                           Eigen::Vector3f(0.0, 0.0, 0.0),
+                           thrust::plus<Eigen::Vector3f>()) /
+            (float)n_target;
+    const float source_extent = thrust::transform_reduce(
+            source.points_.begin(), source.points_.end(),
+            distance_to_center_functor(source_center), 0.0f,
+            thrust::maximum<float>());
+    const float target_extent = thrust::transform_reduce(
+            target.points_.begin(), target.points_.end(),
+            distance_to_center_functor(target_center), 0.0f,
+            thrust::maximum<float>());
+    float scale = std::max(source_extent, target_extent);
+    if (scale <= 0.0) scale = 1.0;
+    utility::device_vector<Eigen::Vector3f> source_points(n_source);
+    utility::device_vector<Eigen::Vector3f> target_points(n_target);
+    thrust::transform(source.points_.begin(), source.points_.end(),
+                      source_points.begin(),
+                      normalize_points_functor(source_center, scale));
+    thrust::transform(target.points_.begin(), target.points_.end(),
+                      target_points.begin(),
+                      normalize_points_functor(target_center, scale));
+
+    const float max_dist = option.maximum_correspondence_distance_ / scale;
+    float mu = 1.0;
+    Eigen::Matrix4f transformation = Eigen::Matrix4f::Identity();
+    for (int i = 0; i < option.iteration_number_; ++i) {
+        if (option.decrease_mu_ && i % 4 == 0 && mu > max_dist * max_dist) {
+            mu /= option.division_factor_;
+        }
+        fgr_jacobian_residual_functor func(
+                thrust::raw_pointer_cast(source_points.data()),
+                thrust::raw_pointer_cast(target_points.data()),
+                thrust::raw_pointer_cast(fgr_corres->data()), transformation,
+                mu);
+        Eigen::Matrix6f JTJ;
+        Eigen::Vector6f JTr;
+        float r2;
+        thrust::tie(JTJ, JTr, r2) =
+                utility::ComputeJTJandJTr<Eigen::Matrix6f, Eigen::Vector6f, 3>(
+                        func, (int)fgr_corres->size(), false);
+        bool is_success;
+        Eigen::Matrix4f delta;
+        thrust::tie(is_success, delta) =
+                utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ, JTr);
+        if (!is_success) break;
+        transformation = delta * transformation;
+    }
+
+    // Back to the original frames: x_t = R (x_s - c_s) + s t + c_t.
+    const Eigen::Matrix3f rot = transformation.block<3, 3>(0, 0);
+    Eigen::Matrix4f final_transformation = Eigen::Matrix4f::Identity();
+    final_transformation.block<3, 3>(0, 0) = rot;
+    final_transformation.block<3, 1>(0, 3) =
+            target_center - rot * source_center +
+            scale * transformation.block<3, 1>(0, 3);
+    EvaluateCorrespondences(source, target, corres,
+                            option.maximum_correspondence_distance_,
+                            final_transformation, result);
+    return result;
+}
+
+RegistrationResult
+cupoch::registration::FastGlobalRegistrationBasedOnFeatureMatching(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const Feature<33> &source_feature,
+        const Feature<33> &target_feature,
+        const FastGlobalRegistrationOption
+                &option /* = FastGlobalRegistrationOption()*/) {
+    if (source_feature.Num() != source.points_.size() ||
+        target_feature.Num() != target.points_.size()) {
+        utility::LogWarning(
+                "[FastGlobalRegistrationBasedOnFeatureMatching] The features "
+                "do not match the point clouds.\n");
+        return RegistrationResult();
+    }
+    const auto corres = ComputeFeatureCorrespondences(
+            source_feature, target_feature, option.mutual_filter_);
+    return FastGlobalRegistrationBasedOnCorrespondence(source, target, corres,
+                                                       option);
+}
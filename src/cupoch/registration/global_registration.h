@@ -0,0 +1,128 @@
+#pragma once
+
+#include "cupoch/registration/feature.h"
+#include "cupoch/registration/registration.h"
+
+namespace cupoch {
+
+namespace geometry {
+class PointCloud;
+}
+
+namespace registration {
+
+class RANSACConvergenceCriteria {
+public:
+    RANSACConvergenceCriteria(int max_iteration = 100000,
+                              float confidence = 0.999,
+                              int num_hypotheses_per_launch = 4096)
+        : max_iteration_(max_iteration),
+          confidence_(confidence),
+          num_hypotheses_per_launch_(num_hypotheses_per_launch) {}
+    ~RANSACConvergenceCriteria() {}
+
+public:
+    int max_iteration_;
+    float confidence_;
+    /// Number of hypotheses sampled and scored by one kernel launch.
+    int num_hypotheses_per_launch_;
+};
+
+class FastGlobalRegistrationOption {
+public:
+    FastGlobalRegistrationOption(float division_factor = 1.4,
+                                 bool decrease_mu = true,
+                                 float maximum_correspondence_distance = 0.025,
+                                 int iteration_number = 64,
+                                 bool tuple_test = true,
+                                 float tuple_scale = 0.95,
+                                 int maximum_tuple_count = 1000,
+                                 bool mutual_filter = true,
+                                 unsigned int seed = 0)
+        : division_factor_(division_factor),
+          decrease_mu_(decrease_mu),
+          maximum_correspondence_distance_(maximum_correspondence_distance),
+          iteration_number_(iteration_number),
+          tuple_test_(tuple_test),
+          tuple_scale_(tuple_scale),
+          maximum_tuple_count_(maximum_tuple_count),
+          mutual_filter_(mutual_filter),
+          seed_(seed) {}
+    ~FastGlobalRegistrationOption() {}
+
+public:
+    /// Division factor of mu, applied every 4 iterations.
+    float division_factor_;
+    bool decrease_mu_;
+    /// mu is not decreased below the square of this distance, which is
+    /// also the inlier threshold of the result.
+    float maximum_correspondence_distance_;
+    int iteration_number_;
+    /// Keep only the correspondences of random triplets whose edge lengths
+    /// agree within tuple_scale_.
+    bool tuple_test_;
+    float tuple_scale_;
+    int maximum_tuple_count_;
+    bool mutual_filter_;
+    unsigned int seed_;
+};
+
+/// Matches every source feature to its nearest target feature by a brute
+/// force search in feature space, MatchFeatures() without ratio test. With
+/// \p mutual_filter only the pairs that are also the nearest source feature
+/// of their target feature are kept.
+CorrespondenceSet ComputeFeatureCorrespondences(
+        const Feature<33> &source_feature,
+        const Feature<33> &target_feature,
+        bool mutual_filter = true);
+
+/// RANSAC on a set of putative correspondences. Every hypothesis is fitted
+/// with Kabsch on 3 random correspondences and scored by the number of
+/// correspondences it maps within \p max_correspondence_distance. All the
+/// hypotheses of a launch are sampled and scored in parallel, and the best
+/// one is refined with Kabsch on its inliers.
+RegistrationResult RegistrationRANSACBasedOnCorrespondence(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres,
+        float max_correspondence_distance,
+        const RANSACConvergenceCriteria &criteria =
+                RANSACConvergenceCriteria(),
+        unsigned int seed = 0);
+
+/// Global registration from the FPFH features of the two point clouds, to
+/// initialize RegistrationICP().
+RegistrationResult RegistrationRANSACBasedOnFeatureMatching(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const Feature<33> &source_feature,
+        const Feature<33> &target_feature,
+        float max_correspondence_distance,
+        bool mutual_filter = true,
+        const RANSACConvergenceCriteria &criteria =
+                RANSACConvergenceCriteria(),
+        unsigned int seed = 0);
+
+/// Fast Global Registration (Zhou et al., ECCV 2016) on a set of putative
+/// correspondences. The Geman-McClure objective is minimized by Gauss-Newton
+/// steps on its line process, each step being one reduction of the 6x6
+/// system over all correspondences. The number of steps is fixed by
+/// iteration_number_, without resampling. The clouds are normalized to unit
+/// extent during the solve.
+RegistrationResult FastGlobalRegistrationBasedOnCorrespondence(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres,
+        const FastGlobalRegistrationOption &option =
+                FastGlobalRegistrationOption());
+
+RegistrationResult FastGlobalRegistrationBasedOnFeatureMatching(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const Feature<33> &source_feature,
+        const Feature<33> &target_feature,
+        const FastGlobalRegistrationOption &option =
+                FastGlobalRegistrationOption());
+
+}  // namespace registration
+}  // namespace cupoch
@@ -1,9 +1,12 @@
+#include <thrust/binary_search.h>
 #include <thrust/reduce.h>
 #include <thrust/transform_reduce.h>
 
 #include <Eigen/Geometry>
+#include <cub/device/device_segmented_reduce.cuh>
 
 #include "cupoch/registration/kabsch.h"
+#include "cupoch/utility/platform.h"
 #include "cupoch/utility/svd3_cuda.h"
 
 using namespace cupoch;
@@ -55,6 +58,170 @@ struct set_correspondence_functor {
     }
 };
 
+/// Rotation and translation from the centers and the normalized cross
+/// covariance \p hh. A positive \p model_variance also gives the Umeyama
+/// scale.
+__host__ __device__ Eigen::Matrix4f KabschFromCovariance(
+        const Eigen::Vector3f &model_center,
+        const Eigen::Vector3f &target_center,
+        const Eigen::Matrix3f &hh,
+        float model_variance) {
+    // Do svd
+    Eigen::Matrix3f uu, ss, vv;
+    svd(hh(0, 0), hh(0, 1), hh(0, 2), hh(1, 0), hh(1, 1), hh(1, 2), hh(2, 0),
+        hh(2, 1), hh(2, 2), uu(0, 0), uu(0, 1), uu(0, 2), uu(1, 0), uu(1, 1),
+        uu(1, 2), uu(2, 0), uu(2, 1), uu(2, 2), ss(0, 0), ss(0, 1), ss(0, 2),
+        ss(1, 0), ss(1, 1), ss(1, 2), ss(2, 0), ss(2, 1), ss(2, 2), vv(0, 0),
+        vv(0, 1), vv(0, 2), vv(1, 0), vv(1, 1), vv(1, 2), vv(2, 0), vv(2, 1),
+        vv(2, 2));
+    Eigen::Matrix3f dd = Eigen::Matrix3f::Identity();
+    dd(2, 2) = (uu * vv).determinant();
+    const float scale = (model_variance > 0.0)
+                                ? (ss * dd).trace() / model_variance
+                                : 1.0;
+    Eigen::Matrix4f tr = Eigen::Matrix4f::Identity();
+    tr.block<3, 3>(0, 0) = scale * vv * dd * uu.transpose();
+
+    // The translation
+    tr.block<3, 1>(0, 3) = target_center;
+    tr.block<3, 1>(0, 3) -= tr.block<3, 3>(0, 0) * model_center;
+    return tr;
+}
+
+struct kabsch_centers {
+    Eigen::Vector3f sum_x_;
+    Eigen::Vector3f sum_y_;
+    __host__ __device__ static kabsch_centers Zero() {
+        kabsch_centers c;
+        c.sum_x_.setZero();
+        c.sum_y_.setZero();
+        return c;
+    }
+};
+
+struct add_kabsch_centers_functor {
+    __host__ __device__ kabsch_centers operator()(
+            const kabsch_centers &x, const kabsch_centers &y) const {
+        kabsch_centers c;
+        c.sum_x_ = x.sum_x_ + y.sum_x_;
+        c.sum_y_ = x.sum_y_ + y.sum_y_;
+        return c;
+    }
+};
+
+struct kabsch_covariance {
+    Eigen::Matrix3f sum_xy_;
+    float sum_xx_;
+    __host__ __device__ static kabsch_covariance Zero() {
+        kabsch_covariance c;
+        c.sum_xy_.setZero();
+        c.sum_xx_ = 0.0;
+        return c;
+    }
+};
+
+struct add_kabsch_covariance_functor {
+    __host__ __device__ kabsch_covariance operator()(
+            const kabsch_covariance &x, const kabsch_covariance &y) const {
+        kabsch_covariance c;
+        c.sum_xy_ = x.sum_xy_ + y.sum_xy_;
+        c.sum_xx_ = x.sum_xx_ + y.sum_xx_;
+        return c;
+    }
+};
+
+struct batch_centers_functor {
+    batch_centers_functor(const Eigen::Vector3f *model,
+                          const Eigen::Vector3f *target,
+                          const Eigen::Vector2i *corres)
+        : model_(model), target_(target), corres_(corres){};
+    const Eigen::Vector3f *model_;
+    const Eigen::Vector3f *target_;
+    const Eigen::Vector2i *corres_;
+    __device__ kabsch_centers operator()(int idx) const {
+        kabsch_centers c;
+        c.sum_x_ = model_[corres_[idx][0]];
+        c.sum_y_ = target_[corres_[idx][1]];
+        return c;
+    }
+};
+
+struct batch_covariance_functor {
+    batch_covariance_functor(const Eigen::Vector3f *model,
+                             const Eigen::Vector3f *target,
+                             const Eigen::Vector2i *corres,
+                             const int *set_ids,
+                             const int *offsets,
+                             const kabsch_centers *centers)
+        : model_(model),
+          target_(target),
+          corres_(corres),
+          set_ids_(set_ids),
+          offsets_(offsets),
+          centers_(centers){};
+    const Eigen::Vector3f *model_;
+    const Eigen::Vector3f *target_;
+    const Eigen::Vector2i *corres_;
+    const int *set_ids_;
+    const int *offsets_;
+    const kabsch_centers *centers_;
+    __device__ kabsch_covariance operator()(int idx) const {
+        const int s = set_ids_[idx];
+        const float inv_n = 1.0 / (offsets_[s + 1] - offsets_[s]);
+        const Eigen::Vector3f x =
+                model_[corres_[idx][0]] - centers_[s].sum_x_ * inv_n;
+        const Eigen::Vector3f y =
+                target_[corres_[idx][1]] - centers_[s].sum_y_ * inv_n;
+        kabsch_covariance c;
+        c.sum_xy_ = x * y.transpose();
+        c.sum_xx_ = x.squaredNorm();
+        return c;
+    }
+};
+
+struct batch_kabsch_functor {
+    batch_kabsch_functor(const int *offsets,
+                         const kabsch_centers *centers,
+                         const kabsch_covariance *covariances,
+                         bool with_scaling)
+        : offsets_(offsets),
+          centers_(centers),
+          covariances_(covariances),
+          with_scaling_(with_scaling){};
+    const int *offsets_;
+    const kabsch_centers *centers_;
+    const kabsch_covariance *covariances_;
+    const bool with_scaling_;
+    __device__ Eigen::Matrix4f_u operator()(int s) const {
+        const int n = offsets_[s + 1] - offsets_[s];
+        if (n < 3) return Eigen::Matrix4f_u::Identity();
+        const float inv_n = 1.0 / n;
+        return KabschFromCovariance(
+                centers_[s].sum_x_ * inv_n, centers_[s].sum_y_ * inv_n,
+                covariances_[s].sum_xy_ * inv_n,
+                (with_scaling_) ? covariances_[s].sum_xx_ * inv_n : 0.0f);
+    }
+};
+
+template <typename T, typename InputIteratorT, typename ReductionOpT>
+void SegmentedReduce(InputIteratorT input,
+                     const utility::device_vector<int> &offsets,
+                     ReductionOpT op,
+                     utility::device_vector<T> &output) {
+    const int n_sets = offsets.size() - 1;
+    output.resize(n_sets);
+    const int *offsets_ptr = thrust::raw_pointer_cast(offsets.data());
+    size_t temp_bytes = 0;
+    cudaSafeCall(cub::DeviceSegmentedReduce::Reduce(
+            NULL, temp_bytes, input, thrust::raw_pointer_cast(output.data()),
+            n_sets, offsets_ptr, offsets_ptr + 1, op, T::Zero()));
+    utility::device_vector<char> temp(temp_bytes);
+    cudaSafeCall(cub::DeviceSegmentedReduce::Reduce(
+            thrust::raw_pointer_cast(temp.data()), temp_bytes, input,
+            thrust::raw_pointer_cast(output.data()), n_sets, offsets_ptr,
+            offsets_ptr + 1, op, T::Zero()));
+}
+
 }  // namespace
 
 Eigen::Matrix4f_u cupoch::registration::Kabsch(
@@ -76,7 +243,7 @@ Eigen::Matrix4f_u cupoch::registration::Kabsch(
             thrust::make_counting_iterator<size_t>(0),
             thrust::make_counting_iterator(corres.size()), ex_func1,
             Eigen::Vector3f(0.0, 0.0, 0.0), thrust::plus<Eigen::Vector3f>());
-    float divided_by = 1.0f / model.size();
+    float divided_by = 1.0f / corres.size();
     model_center *= divided_by;
     target_center *= divided_by;
 
@@ -92,25 +259,15 @@ Eigen::Matrix4f_u cupoch::registration::Kabsch(
             thrust::make_counting_iterator(corres.size()), func, init,
             thrust::plus<Eigen::Matrix3f>());
 
-    // Do svd
-    hh /= model.size();
-    Eigen::Matrix3f uu, ss, vv;
-    svd(hh(0, 0), hh(0, 1), hh(0, 2), hh(1, 0), hh(1, 1), hh(1, 2), hh(2, 0),
-        hh(2, 1), hh(2, 2), uu(0, 0), uu(0, 1), uu(0, 2), uu(1, 0), uu(1, 1),
-        uu(1, 2), uu(2, 0), uu(2, 1), uu(2, 2), ss(0, 0), ss(0, 1), ss(0, 2),
-        ss(1, 0), ss(1, 1), ss(1, 2), ss(2, 0), ss(2, 1), ss(2, 2), vv(0, 0),
-        vv(0, 1), vv(0, 2), vv(1, 0), vv(1, 1), vv(1, 2), vv(2, 0), vv(2, 1),
-        vv(2, 2));
-    ss = Eigen::Matrix3f::Identity();
-    ss(2, 2) = (uu * vv).determinant();
-    Eigen::Matrix4f_u tr = Eigen::Matrix4f_u::Identity();
-    tr.block<3, 3>(0, 0) = vv * ss * uu.transpose();
-
-    // The translation
-    tr.block<3, 1>(0, 3) = target_center;
-    tr.block<3, 1>(0, 3) -= tr.block<3, 3>(0, 0) * model_center;
+    hh /= corres.size();
+    return Kabsch(model_center, target_center, hh);
+}
 
-    return tr;
+Eigen::Matrix4f_u cupoch::registration::Kabsch(
+        const Eigen::Vector3f &model_center,
+        const Eigen::Vector3f &target_center,
+        const Eigen::Matrix3f &hh) {
+    return KabschFromCovariance(model_center, target_center, hh, 0.0);
 }
 
 Eigen::Matrix4f_u cupoch::registration::Kabsch(
@@ -122,4 +279,52 @@ Eigen::Matrix4f_u cupoch::registration::Kabsch(
                       thrust::make_counting_iterator(model.size()),
                       corres.begin(), func);
     return Kabsch(model, target, corres);
-}
\ No newline at end of file
+}
+
+utility::device_vector<Eigen::Matrix4f_u> cupoch::registration::KabschBatch(
+        const utility::device_vector<Eigen::Vector3f> &model,
+        const utility::device_vector<Eigen::Vector3f> &target,
+        const CorrespondenceSet &corres,
+        const utility::device_vector<int> &offsets,
+        bool with_scaling) {
+    if (offsets.size() < 2) return utility::device_vector<Eigen::Matrix4f_u>();
+    const int n_sets = offsets.size() - 1;
+    const int n_corres = corres.size();
+    utility::device_vector<int> set_ids(n_corres);
+    thrust::upper_bound(offsets.begin() + 1, offsets.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(n_corres),
+                        set_ids.begin());
+
+    utility::device_vector<kabsch_centers> centers;
+    SegmentedReduce(thrust::make_transform_iterator(
+                            thrust::make_counting_iterator(0),
+                            batch_centers_functor(
+                                    thrust::raw_pointer_cast(model.data()),
+                                    thrust::raw_pointer_cast(target.data()),
+                                    thrust::raw_pointer_cast(corres.data()))),
+                    offsets, add_kabsch_centers_functor(), centers);
+    utility::device_vector<kabsch_covariance> covariances;
+    SegmentedReduce(
+            thrust::make_transform_iterator(
+                    thrust::make_counting_iterator(0),
+                    batch_covariance_functor(
+                            thrust::raw_pointer_cast(model.data()),
+                            thrust::raw_pointer_cast(target.data()),
+                            thrust::raw_pointer_cast(corres.data()),
+                            thrust::raw_pointer_cast(set_ids.data()),
+                            thrust::raw_pointer_cast(offsets.data()),
+                            thrust::raw_pointer_cast(centers.data()))),
+            offsets, add_kabsch_covariance_functor(), covariances);
+
+    utility::device_vector<Eigen::Matrix4f_u> transformations(n_sets);
+    thrust::transform(thrust::make_counting_iterator(0),
+                      thrust::make_counting_iterator(n_sets),
+                      transformations.begin(),
+                      batch_kabsch_functor(
+                              thrust::raw_pointer_cast(offsets.data()),
+                              thrust::raw_pointer_cast(centers.data()),
+                              thrust::raw_pointer_cast(covariances.data()),
+                              with_scaling));
+    return transformations;
+}
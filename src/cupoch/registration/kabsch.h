@@ -14,5 +14,25 @@ Eigen::Matrix4f_u Kabsch(const utility::device_vector<Eigen::Vector3f> &model,
 Eigen::Matrix4f_u Kabsch(const utility::device_vector<Eigen::Vector3f> &model,
                          const utility::device_vector<Eigen::Vector3f> &target);
 
+/// Kabsch from precomputed centers and the normalized cross covariance
+/// H = sum((x - model_center) * (y - target_center)^T) / n.
+Eigen::Matrix4f_u Kabsch(const Eigen::Vector3f &model_center,
+                         const Eigen::Vector3f &target_center,
+                         const Eigen::Matrix3f &hh);
+
+/// Kabsch on many correspondence sets at once. Set i is
+/// corres[offsets[i], offsets[i + 1]) between \p model and \p target, so
+/// \p offsets has one entry more than there are sets. The centers and the
+/// cross covariances of all the sets are computed by two segmented
+/// reductions and all the 3x3 SVDs are solved on the device. With
+/// \p with_scaling, the transformations also scale the model (Umeyama). A
+/// set with fewer than 3 correspondences gives the identity.
+utility::device_vector<Eigen::Matrix4f_u> KabschBatch(
+        const utility::device_vector<Eigen::Vector3f> &model,
+        const utility::device_vector<Eigen::Vector3f> &target,
+        const CorrespondenceSet &corres,
+        const utility::device_vector<int> &offsets,
+        bool with_scaling = false);
+
 }  // namespace registration
 }  // namespace cupoch
\ No newline at end of file
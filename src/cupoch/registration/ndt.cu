@@ -0,0 +1,277 @@
+#include <thrust/binary_search.h>
+#include <thrust/count.h>
+#include <thrust/functional.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/remove.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/registration/ndt.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/eigen.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::registration;
+
+namespace {
+
+// The voxel and its 6 face neighbors.
+__constant__ int kNeighborOffsets[7][3] = {{0, 0, 0},  {1, 0, 0}, {-1, 0, 0},
+                                           {0, 1, 0},  {0, -1, 0}, {0, 0, 1},
+                                           {0, 0, -1}};
+
+struct compute_key_functor {
+    compute_key_functor(float resolution) : resolution_(resolution){};
+    const float resolution_;
+    __device__ Eigen::Vector3i operator()(const Eigen::Vector3f &pt) const {
+        return Eigen::Vector3i(int(floor(pt(0) / resolution_)),
+                               int(floor(pt(1) / resolution_)),
+                               int(floor(pt(2) / resolution_)));
+    }
+};
+
+// Mean and square root of the inverse covariance U, with U^T U the inverse
+// covariance, of the points perm[offsets[v]] to perm[offsets[v] +
+// counts[v] - 1]. The voxels of too few points or of a singular covariance
+// are flagged invalid.
+struct compute_distribution_functor {
+    compute_distribution_functor(const Eigen::Vector3f *points,
+                                 const int *perm,
+                                 const int *offsets,
+                                 const int *counts,
+                                 int min_points)
+        : points_(points),
+          perm_(perm),
+          offsets_(offsets),
+          counts_(counts),
+          min_points_(min_points){};
+    const Eigen::Vector3f *points_;
+    const int *perm_;
+    const int *offsets_;
+    const int *counts_;
+    const int min_points_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Matrix3f, bool>
+    operator()(size_t idx) const {
+        const int begin = offsets_[idx];
+        const int n = counts_[idx];
+        Eigen::Vector3f mean = Eigen::Vector3f::Zero();
+        Eigen::Matrix3f u = Eigen::Matrix3f::Zero();
+        if (n < min_points_) return thrust::make_tuple(mean, u, false);
+        for (int i = 0; i < n; ++i) mean += points_[perm_[begin + i]];
+        mean /= n;
+        Eigen::Matrix3f cov = Eigen::Matrix3f::Zero();
+        for (int i = 0; i < n; ++i) {
+            const Eigen::Vector3f d = points_[perm_[begin + i]] - mean;
+            cov.noalias() += d * d.transpose();
+        }
+        cov /= (n - 1);
+        cov += 0.01f * cov.trace() * Eigen::Matrix3f::Identity();
+        if (cov.determinant() <= 0.0f) {
+            return thrust::make_tuple(mean, u, false);
+        }
+        // Cholesky factor L of the inverse covariance, U = L^T.
+        const Eigen::Matrix3f a = cov.inverse();
+        const float l00 = sqrt(a(0, 0));
+        const float l10 = a(1, 0) / l00;
+        const float l20 = a(2, 0) / l00;
+        const float l11 = sqrt(a(1, 1) - l10 * l10);
+        const float l21 = (a(2, 1) - l20 * l10) / l11;
+        const float l22 = sqrt(a(2, 2) - l20 * l20 - l21 * l21);
+        u << l00, l10, l20, 0.0f, l11, l21, 0.0f, 0.0f, l22;
+        return thrust::make_tuple(mean, u, isfinite(l22));
+    }
+};
+
+__device__ int FindDistribution(const Eigen::Vector3i *keys,
+                                int n_keys,
+                                const Eigen::Vector3i &key) {
+    const Eigen::Vector3i *it =
+            thrust::lower_bound(thrust::seq, keys, keys + n_keys, key);
+    return (it != keys + n_keys && *it == key) ? it - keys : -1;
+}
+
+// Element idx matches the point idx / 7 to the distribution of its voxel
+// shifted by kNeighborOffsets[idx % 7]. The 3 rows are the whitened
+// residual U (p - mean), weighted by the square root of the Gaussian score.
+struct ndt_jacobian_and_residual_functor {
+    ndt_jacobian_and_residual_functor(const Eigen::Vector3f *points,
+                                      const Eigen::Vector3i *keys,
+                                      const Eigen::Vector3f *means,
+                                      const Eigen::Matrix3f *sqrt_infos,
+                                      int n_keys,
+                                      float resolution)
+        : points_(points),
+          keys_(keys),
+          means_(means),
+          sqrt_infos_(sqrt_infos),
+          n_keys_(n_keys),
+          resolution_(resolution){};
+    const Eigen::Vector3f *points_;
+    const Eigen::Vector3i *keys_;
+    const Eigen::Vector3f *means_;
+    const Eigen::Matrix3f *sqrt_infos_;
+    const int n_keys_;
+    const float resolution_;
+    __device__ bool operator()(int idx,
+                               Eigen::Vector6f J_r[3],
+                               float r[3]) const {
+        const Eigen::Vector3f &p = points_[idx / 7];
+        const int *offset = kNeighborOffsets[idx % 7];
+        const Eigen::Vector3i key =
+                compute_key_functor(resolution_)(p) +
+                Eigen::Vector3i(offset[0], offset[1], offset[2]);
+        const int j = FindDistribution(keys_, n_keys_, key);
+        if (j < 0) return false;
+        const Eigen::Matrix3f &u = sqrt_infos_[j];
+        const Eigen::Vector3f e = u * (p - means_[j]);
+        const float sqrt_w = exp(-0.25f * e.squaredNorm());
+        for (int k = 0; k < 3; ++k) {
+            const Eigen::Vector3f uk = sqrt_w * u.row(k).transpose();
+            J_r[k].block<3, 1>(0, 0) = p.cross(uk);
+            J_r[k].block<3, 1>(3, 0) = uk;
+            r[k] = sqrt_w * e(k);
+        }
+        return true;
+    }
+};
+
+struct has_distribution_functor {
+    has_distribution_functor(const Eigen::Vector3i *keys,
+                             int n_keys,
+                             float resolution)
+        : keys_(keys), n_keys_(n_keys), resolution_(resolution){};
+    const Eigen::Vector3i *keys_;
+    const int n_keys_;
+    const float resolution_;
+    __device__ bool operator()(const Eigen::Vector3f &p) const {
+        return FindDistribution(keys_, n_keys_,
+                                compute_key_functor(resolution_)(p)) >= 0;
+    }
+};
+
+// JTJ and JTr of the current pose, and its fitness and RMSE.
+thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f> NDTStep(
+        const geometry::PointCloud &pcd,
+        const NDTMap &target,
+        float &fitness,
+        float &inlier_rmse) {
+    const int n_points = pcd.points_.size();
+    const int n_keys = target.keys_.size();
+    ndt_jacobian_and_residual_functor func(
+            thrust::raw_pointer_cast(pcd.points_.data()),
+            thrust::raw_pointer_cast(target.keys_.data()),
+            thrust::raw_pointer_cast(target.means_.data()),
+            thrust::raw_pointer_cast(target.sqrt_inv_covariances_.data()),
+            n_keys, target.resolution_);
+    auto res = utility::ReduceJTJandJTr<3>(func, n_points * 7);
+    const int n_valid = thrust::get<3>(res);
+    const int n_inliers = thrust::count_if(
+            pcd.points_.begin(), pcd.points_.end(),
+            has_distribution_functor(
+                    thrust::raw_pointer_cast(target.keys_.data()), n_keys,
+                    target.resolution_));
+    fitness = (n_points > 0) ? float(n_inliers) / n_points : 0.0f;
+    inlier_rmse =
+            (n_valid > 0) ? std::sqrt(thrust::get<2>(res) / n_valid) : 0.0f;
+    return thrust::make_tuple(thrust::get<0>(res), thrust::get<1>(res));
+}
+
+}  // namespace
+
+NDTMap::NDTMap(const geometry::PointCloud &target,
+               float resolution,
+               int min_points)
+    : resolution_(resolution) {
+    CUPOCH_PROFILE("NDTMap");
+    if (resolution <= 0.0) {
+        utility::LogError("[NDTMap] resolution must be positive.");
+    }
+    const size_t n = target.points_.size();
+    utility::device_vector<Eigen::Vector3i> keys(n);
+    thrust::transform(target.points_.begin(), target.points_.end(),
+                      keys.begin(), compute_key_functor(resolution));
+    utility::device_vector<int> perm(n);
+    thrust::sequence(perm.begin(), perm.end());
+    thrust::sort_by_key(keys.begin(), keys.end(), perm.begin());
+    keys_.resize(n);
+    utility::device_vector<int> counts(n);
+    auto end = thrust::reduce_by_key(keys.begin(), keys.end(),
+                                     thrust::make_constant_iterator(1),
+                                     keys_.begin(), counts.begin());
+    const size_t n_voxels = thrust::distance(keys_.begin(), end.first);
+    keys_.resize(n_voxels);
+    counts.resize(n_voxels);
+    utility::device_vector<int> offsets(n_voxels);
+    thrust::exclusive_scan(counts.begin(), counts.end(), offsets.begin());
+
+    means_.resize(n_voxels);
+    sqrt_inv_covariances_.resize(n_voxels);
+    utility::device_vector<bool> valid(n_voxels);
+    compute_distribution_functor func(
+            thrust::raw_pointer_cast(target.points_.data()),
+            thrust::raw_pointer_cast(perm.data()),
+            thrust::raw_pointer_cast(offsets.data()),
+            thrust::raw_pointer_cast(counts.data()), min_points);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_voxels),
+                      make_tuple_begin(means_, sqrt_inv_covariances_, valid),
+                      func);
+    auto begin = make_tuple_begin(keys_, means_, sqrt_inv_covariances_);
+    auto end_valid = thrust::remove_if(
+            begin, make_tuple_end(keys_, means_, sqrt_inv_covariances_),
+            valid.begin(), thrust::logical_not<bool>());
+    const size_t n_valid = thrust::distance(begin, end_valid);
+    keys_.resize(n_valid);
+    means_.resize(n_valid);
+    sqrt_inv_covariances_.resize(n_valid);
+}
+
+NDTMap::~NDTMap() {}
+
+RegistrationResult cupoch::registration::RegistrationNDT(
+        const geometry::PointCloud &source,
+        const NDTMap &target,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const ICPConvergenceCriteria &criteria /* = ICPConvergenceCriteria()*/) {
+    CUPOCH_PROFILE("RegistrationNDT");
+    Eigen::Matrix4f transformation = init;
+    geometry::PointCloud pcd;
+    pcd.points_ = source.points_;
+    if (init.isIdentity() == false) {
+        pcd.Transform(init);
+    }
+    RegistrationResult output(transformation);
+    if (pcd.points_.empty() || target.keys_.empty()) return output;
+    Eigen::Matrix6f JTJ;
+    Eigen::Vector6f JTr;
+    thrust::tie(JTJ, JTr) =
+            NDTStep(pcd, target, output.fitness_, output.inlier_rmse_);
+    for (int i = 0; i < criteria.max_iteration_; i++) {
+        utility::LogDebug("NDT Iteration #{:d}: Fitness {:.4f}, RMSE {:.4f}",
+                          i, output.fitness_, output.inlier_rmse_);
+        bool is_success;
+        Eigen::Matrix4f update;
+        thrust::tie(is_success, update) =
+                utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ, JTr);
+        if (!is_success) break;
+        transformation = update * transformation;
+        pcd.Transform(update);
+        const float prev_fitness = output.fitness_;
+        const float prev_inlier_rmse = output.inlier_rmse_;
+        thrust::tie(JTJ, JTr) =
+                NDTStep(pcd, target, output.fitness_, output.inlier_rmse_);
+        if (std::abs(prev_fitness - output.fitness_) <
+                    criteria.relative_fitness_ &&
+            std::abs(prev_inlier_rmse - output.inlier_rmse_) <
+                    criteria.relative_rmse_) {
+            break;
+        }
+    }
+    output.transformation_ = transformation;
+    return output;
+}
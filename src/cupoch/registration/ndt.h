@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include "cupoch/registration/registration.h"
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+
+namespace geometry {
+class PointCloud;
+}
+
+namespace registration {
+
+/// \class NDTMap
+///
+/// \brief Normal distributions of a target point cloud over the voxels of
+/// a regular grid, built once and reused by RegistrationNDT().
+///
+/// The points are binned as in VoxelGrid::CreateFromPointCloud, with the
+/// voxel of key k spanning [k * resolution, (k + 1) * resolution). Every
+/// voxel of at least \p min_points points keeps the mean of its points and
+/// the upper triangular U, U^T U being the inverse of their covariance. The
+/// covariance is regularized by 1% of its trace on the diagonal, so that
+/// planar voxels stay invertible.
+class NDTMap {
+public:
+    NDTMap(const geometry::PointCloud &target,
+           float resolution,
+           int min_points = 6);
+    ~NDTMap();
+
+public:
+    size_t GetNumDistributions() const { return keys_.size(); }
+
+public:
+    float resolution_;
+    /// Sorted voxel keys and their distributions.
+    utility::device_vector<Eigen::Vector3i> keys_;
+    utility::device_vector<Eigen::Vector3f> means_;
+    utility::device_vector<Eigen::Matrix3f> sqrt_inv_covariances_;
+};
+
+/// Point-to-distribution NDT registration (Magnusson, "The
+/// Three-Dimensional Normal-Distributions Transform", 2009).
+///
+/// Every source point is matched to the distributions of its voxel and of
+/// the 6 face neighbors, and the Gauss-Newton steps minimize the sum of
+/// their Mahalanobis distances, each weighted by the Gaussian score of the
+/// distribution. fitness_ is the ratio of the source points that have a
+/// distribution and inlier_rmse_ the RMS of the weighted Mahalanobis
+/// distances. The correspondence set is left empty.
+RegistrationResult RegistrationNDT(
+        const geometry::PointCloud &source,
+        const NDTMap &target,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+}  // namespace registration
+}  // namespace cupoch
@@ -0,0 +1,21 @@
+#include "cupoch/registration/pose_graph.h"
+
+using namespace cupoch;
+using namespace cupoch::registration;
+
+PoseGraph::PoseGraph() {}
+
+PoseGraph::~PoseGraph() {}
+
+size_t PoseGraph::CountInvalidEdges() const {
+    const int n_nodes = nodes_.size();
+    size_t n_invalid = 0;
+    for (const auto &edge : edges_) {
+        if (edge.source_node_id_ < 0 || edge.source_node_id_ >= n_nodes ||
+            edge.target_node_id_ < 0 || edge.target_node_id_ >= n_nodes ||
+            edge.source_node_id_ == edge.target_node_id_) {
+            ++n_invalid;
+        }
+    }
+    return n_invalid;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+
+#include "cupoch/utility/eigen.h"
+
+namespace cupoch {
+namespace registration {
+
+/// \class PoseGraphNode
+///
+/// \brief Node of a PoseGraph: the pose that transforms the frame of the
+/// node into the global frame.
+class PoseGraphNode {
+public:
+    PoseGraphNode(const Eigen::Matrix4f &pose = Eigen::Matrix4f::Identity())
+        : pose_(pose){};
+    ~PoseGraphNode(){};
+
+public:
+    Eigen::Matrix4f_u pose_;
+};
+
+/// \class PoseGraphEdge
+///
+/// \brief Edge of a PoseGraph: the measured transformation from the source
+/// node to the target node and its information matrix, as returned by
+/// odometry::ComputeRGBDOdometry() or GetInformationMatrixFromPointClouds().
+///
+/// The information matrix is the Gauss-Newton Hessian of the alignment in
+/// the (rotation, translation) order of utility::TransformVector6fToMatrix4f.
+/// An uncertain edge (typically a loop closure) is weighted by a confidence
+/// that GlobalOptimization() lowers when the edge disagrees with the others
+/// and stores in confidence_.
+class PoseGraphEdge {
+public:
+    PoseGraphEdge(int source_node_id = -1,
+                  int target_node_id = -1,
+                  const Eigen::Matrix4f &transformation =
+                          Eigen::Matrix4f::Identity(),
+                  const Eigen::Matrix6f &information =
+                          Eigen::Matrix6f::Identity(),
+                  bool uncertain = false,
+                  float confidence = 1.0)
+        : source_node_id_(source_node_id),
+          target_node_id_(target_node_id),
+          transformation_(transformation),
+          information_(information),
+          uncertain_(uncertain),
+          confidence_(confidence){};
+    ~PoseGraphEdge(){};
+
+public:
+    int source_node_id_;
+    int target_node_id_;
+    Eigen::Matrix4f_u transformation_;
+    Eigen::Matrix6f_u information_;
+    bool uncertain_;
+    float confidence_;
+};
+
+/// \class PoseGraph
+///
+/// \brief Graph of poses and pairwise constraints, optimized by
+/// GlobalOptimization().
+class PoseGraph {
+public:
+    PoseGraph();
+    ~PoseGraph();
+
+public:
+    /// Number of edges whose source or target is not a node of the graph.
+    size_t CountInvalidEdges() const;
+
+public:
+    std::vector<PoseGraphNode> nodes_;
+    std::vector<PoseGraphEdge> edges_;
+};
+
+}  // namespace registration
+}  // namespace cupoch
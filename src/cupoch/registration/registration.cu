@@ -1,8 +1,26 @@
+#include <thrust/binary_search.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <algorithm>
+#include <typeinfo>
+#include <cub/device/device_segmented_reduce.cuh>
+
 #include "cupoch/geometry/kdtree_flann.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/pointcloud_batch.h"
+#include "cupoch/registration/correspondence_rejection.h"
+#include "cupoch/registration/kabsch.h"
 #include "cupoch/registration/registration.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/cuda_graph.h"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+#include "cupoch/utility/svd3_cuda.h"
 
 using namespace cupoch;
 using namespace cupoch::registration;
@@ -27,35 +45,49 @@ struct make_correspondence_pair_functor {
     }
 };
 
-RegistrationResult GetRegistrationResultAndCorrespondences(
+void GetRegistrationResultAndCorrespondences(
+        cudaStream_t stream,
+        utility::Workspace &workspace,
         const geometry::PointCloud &source,
         const geometry::PointCloud &target,
         const geometry::KDTreeFlann &target_kdtree,
         float max_correspondence_distance,
-        const Eigen::Matrix4f &transformation) {
-    RegistrationResult result(transformation);
+        const CorrespondenceRejection &rejection,
+        const Eigen::Matrix4f &transformation,
+        RegistrationResult &result) {
+    result.transformation_ = transformation;
+    result.fitness_ = 0.0;
+    result.inlier_rmse_ = 0.0;
     if (max_correspondence_distance <= 0.0) {
-        return result;
+        result.correspondence_set_.clear();
+        return;
     }
 
     const int n_pt = source.points_.size();
-    utility::device_vector<int> indices(n_pt);
-    utility::device_vector<float> dists(n_pt);
+    utility::device_vector<int> &indices =
+            workspace.GetBuffer<int>("icp_indices", n_pt);
+    utility::device_vector<float> &dists =
+            workspace.GetBuffer<float>("icp_distances", n_pt);
     target_kdtree.SearchHybrid(source.points_, max_correspondence_distance, 1,
                                indices, dists);
+    RejectCorrespondences(stream, workspace, source, target, rejection,
+                          indices, dists);
     extact_knn_distance_functor func(thrust::raw_pointer_cast(dists.data()));
     result.correspondence_set_.resize(n_pt);
-    const float error2 =
-            thrust::transform_reduce(thrust::make_counting_iterator(0),
-                                     thrust::make_counting_iterator(n_pt), func,
-                                     0.0f, thrust::plus<float>());
-    thrust::transform(thrust::make_counting_iterator(0),
+    const float error2 = thrust::transform_reduce(
+            utility::exec_policy(stream)->on(stream),
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(n_pt), func, 0.0f,
+            thrust::plus<float>());
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator(0),
                       thrust::make_counting_iterator(n_pt),
                       result.correspondence_set_.begin(),
                       make_correspondence_pair_functor(
                               thrust::raw_pointer_cast(indices.data())));
     auto end =
-            thrust::remove_if(result.correspondence_set_.begin(),
+            thrust::remove_if(utility::exec_policy(stream)->on(stream),
+                              result.correspondence_set_.begin(),
                               result.correspondence_set_.end(),
                               [] __device__(const Eigen::Vector2i &x) -> bool {
                                   return (x[0] < 0);
@@ -63,15 +95,1062 @@ RegistrationResult GetRegistrationResultAndCorrespondences(
     int n_out = thrust::distance(result.correspondence_set_.begin(), end);
     result.correspondence_set_.resize(n_out);
 
-    if (result.correspondence_set_.empty()) {
-        result.fitness_ = 0.0;
-        result.inlier_rmse_ = 0.0;
-    } else {
+    if (!result.correspondence_set_.empty()) {
         size_t corres_number = result.correspondence_set_.size();
         result.fitness_ = (float)corres_number / (float)source.points_.size();
         result.inlier_rmse_ = std::sqrt(error2 / (float)corres_number);
     }
-    return result;
+}
+
+/// Copies \p src into \p buffer_name of \p workspace and moves the buffer
+/// into \p dst.
+void BorrowCopy(utility::Workspace &workspace,
+                const std::string &buffer_name,
+                const utility::device_vector<Eigen::Vector3f> &src,
+                utility::device_vector<Eigen::Vector3f> &dst) {
+    auto &buffer = workspace.GetBuffer<Eigen::Vector3f>(buffer_name, src.size());
+    thrust::copy(src.begin(), src.end(), buffer.begin());
+    dst.swap(buffer);
+}
+
+struct pt2pt_moments {
+    Eigen::Matrix3f sum_st_;
+    Eigen::Vector3f sum_s_;
+    Eigen::Vector3f sum_t_;
+    float error2_;
+    int count_;
+    __host__ __device__ static pt2pt_moments Zero() {
+        pt2pt_moments m;
+        m.sum_st_.setZero();
+        m.sum_s_.setZero();
+        m.sum_t_.setZero();
+        m.error2_ = 0.0;
+        m.count_ = 0;
+        return m;
+    }
+};
+
+struct add_pt2pt_moments_functor {
+    __host__ __device__ pt2pt_moments operator()(const pt2pt_moments &x,
+                                                 const pt2pt_moments &y) const {
+        pt2pt_moments m;
+        m.sum_st_ = x.sum_st_ + y.sum_st_;
+        m.sum_s_ = x.sum_s_ + y.sum_s_;
+        m.sum_t_ = x.sum_t_ + y.sum_t_;
+        m.error2_ = x.error2_ + y.error2_;
+        m.count_ = x.count_ + y.count_;
+        return m;
+    }
+};
+
+struct pt2pl_moments {
+    Eigen::Matrix6f JTJ_;
+    Eigen::Vector6f JTr_;
+    float error2_;
+    int count_;
+    __host__ __device__ static pt2pl_moments Zero() {
+        pt2pl_moments m;
+        m.JTJ_.setZero();
+        m.JTr_.setZero();
+        m.error2_ = 0.0;
+        m.count_ = 0;
+        return m;
+    }
+};
+
+struct add_pt2pl_moments_functor {
+    __host__ __device__ pt2pl_moments operator()(const pt2pl_moments &x,
+                                                 const pt2pl_moments &y) const {
+        pt2pl_moments m;
+        m.JTJ_ = x.JTJ_ + y.JTJ_;
+        m.JTr_ = x.JTr_ + y.JTr_;
+        m.error2_ = x.error2_ + y.error2_;
+        m.count_ = x.count_ + y.count_;
+        return m;
+    }
+};
+
+/// Per source point contribution of its nearest neighbour to the
+/// point-to-point or point-to-plane normal equations. Points without a
+/// neighbour contribute zero, so no correspondence set is built. The
+/// point-to-point moments are taken about \p reference, a point near the
+/// clouds, so that the cross covariance of clouds far from the origin does
+/// not cancel out.
+struct pt2pt_moments_functor {
+    pt2pt_moments_functor(const Eigen::Vector3f *source,
+                          const Eigen::Vector3f *target,
+                          const int *indices,
+                          const float *distances,
+                          const Eigen::Vector3f &reference)
+        : source_(source),
+          target_(target),
+          indices_(indices),
+          distances_(distances),
+          reference_(reference){};
+    const Eigen::Vector3f *source_;
+    const Eigen::Vector3f *target_;
+    const int *indices_;
+    const float *distances_;
+    const Eigen::Vector3f reference_;
+    __device__ pt2pt_moments operator()(int idx) const {
+        pt2pt_moments m = pt2pt_moments::Zero();
+        const int j = indices_[idx];
+        if (j < 0) return m;
+        const Eigen::Vector3f vs = source_[idx] - reference_;
+        const Eigen::Vector3f vt = target_[j] - reference_;
+        m.sum_st_ = vs * vt.transpose();
+        m.sum_s_ = vs;
+        m.sum_t_ = vt;
+        m.error2_ = distances_[idx];
+        m.count_ = 1;
+        return m;
+    }
+};
+
+struct pt2pl_moments_functor {
+    pt2pl_moments_functor(const Eigen::Vector3f *source,
+                          const Eigen::Vector3f *target_points,
+                          const Eigen::Vector3f *target_normals,
+                          const int *indices,
+                          const float *distances,
+                          const RobustKernel &kernel)
+        : source_(source),
+          target_points_(target_points),
+          target_normals_(target_normals),
+          indices_(indices),
+          distances_(distances),
+          kernel_(kernel){};
+    const Eigen::Vector3f *source_;
+    const Eigen::Vector3f *target_points_;
+    const Eigen::Vector3f *target_normals_;
+    const int *indices_;
+    const float *distances_;
+    const RobustKernel kernel_;
+    __device__ pt2pl_moments operator()(int idx) const {
+        pt2pl_moments m = pt2pl_moments::Zero();
+        const int j = indices_[idx];
+        if (j < 0) return m;
+        const Eigen::Vector3f &vs = source_[idx];
+        const Eigen::Vector3f &vt = target_points_[j];
+        const Eigen::Vector3f &nt = target_normals_[j];
+        const float r = (vs - vt).dot(nt);
+        Eigen::Vector6f vec;
+        vec.block<3, 1>(0, 0) = vs.cross(nt);
+        vec.block<3, 1>(3, 0) = nt;
+        const float w = kernel_.Weight(r);
+        m.JTJ_ = w * vec * vec.transpose();
+        m.JTr_ = w * vec * r;
+        m.error2_ = distances_[idx];
+        m.count_ = 1;
+        return m;
+    }
+};
+
+/// Runs the nearest neighbour search and directly reduces the normal
+/// equations of \p estimation. Returns the update for the current pose together
+/// with its fitness and RMSE.
+Eigen::Matrix4f FusedICPStep(cudaStream_t stream,
+                             utility::Workspace &workspace,
+                             const geometry::PointCloud &source,
+                             const geometry::PointCloud &target,
+                             const geometry::KDTreeFlann &target_kdtree,
+                             float max_correspondence_distance,
+                             const CorrespondenceRejection &rejection,
+                             const TransformationEstimation &estimation,
+                             float &fitness,
+                             float &inlier_rmse) {
+    const int n_pt = source.points_.size();
+    utility::device_vector<int> &indices =
+            workspace.GetBuffer<int>("icp_indices", n_pt);
+    utility::device_vector<float> &dists =
+            workspace.GetBuffer<float>("icp_distances", n_pt);
+    target_kdtree.SearchHybrid(source.points_, max_correspondence_distance, 1,
+                               indices, dists);
+    RejectCorrespondences(stream, workspace, source, target, rejection,
+                          indices, dists);
+    int count = 0;
+    float error2 = 0.0;
+    Eigen::Matrix4f update = Eigen::Matrix4f::Identity();
+    if (estimation.GetTransformationEstimationType() ==
+        TransformationEstimationType::PointToPlane) {
+        pt2pl_moments_functor func(
+                thrust::raw_pointer_cast(source.points_.data()),
+                thrust::raw_pointer_cast(target.points_.data()),
+                thrust::raw_pointer_cast(target.normals_.data()),
+                thrust::raw_pointer_cast(indices.data()),
+                thrust::raw_pointer_cast(dists.data()),
+                ((const TransformationEstimationPointToPlane &)estimation)
+                        .kernel_);
+        const pt2pl_moments m = thrust::transform_reduce(
+                utility::exec_policy(stream)->on(stream),
+                thrust::make_counting_iterator(0),
+                thrust::make_counting_iterator(n_pt), func,
+                pt2pl_moments::Zero(), add_pt2pl_moments_functor());
+        count = m.count_;
+        error2 = m.error2_;
+        if (count > 0) {
+            bool is_success;
+            Eigen::Matrix4f extrinsic;
+            thrust::tie(is_success, extrinsic) =
+                    utility::SolveJacobianSystemAndObtainExtrinsicMatrix(
+                            m.JTJ_, m.JTr_);
+            if (is_success) update = extrinsic;
+        }
+    } else if (n_pt > 0) {
+        const Eigen::Vector3f reference = source.points_[0];
+        pt2pt_moments_functor func(
+                thrust::raw_pointer_cast(source.points_.data()),
+                thrust::raw_pointer_cast(target.points_.data()),
+                thrust::raw_pointer_cast(indices.data()),
+                thrust::raw_pointer_cast(dists.data()), reference);
+        const pt2pt_moments m = thrust::transform_reduce(
+                utility::exec_policy(stream)->on(stream),
+                thrust::make_counting_iterator(0),
+                thrust::make_counting_iterator(n_pt), func,
+                pt2pt_moments::Zero(), add_pt2pt_moments_functor());
+        count = m.count_;
+        error2 = m.error2_;
+        if (count > 0) {
+            const Eigen::Vector3f source_mean = m.sum_s_ / count;
+            const Eigen::Vector3f target_mean = m.sum_t_ / count;
+            const Eigen::Matrix3f hh =
+                    m.sum_st_ / count - source_mean * target_mean.transpose();
+            update = Kabsch(reference + source_mean, reference + target_mean,
+                            hh);
+        }
+    }
+    fitness = (n_pt > 0) ? (float)count / (float)n_pt : 0.0;
+    inlier_rmse = (count > 0) ? std::sqrt(error2 / (float)count) : 0.0;
+    return update;
+}
+
+/// Builds the correspondence set from the indices left in \p workspace by
+/// the last FusedICPStep().
+void MaterializeCorrespondences(cudaStream_t stream,
+                                utility::Workspace &workspace,
+                                size_t n_pt,
+                                CorrespondenceSet &corres) {
+    const utility::device_vector<int> &indices =
+            workspace.GetBuffer<int>("icp_indices", n_pt);
+    corres.resize(n_pt);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator<int>(0),
+                      thrust::make_counting_iterator<int>(n_pt), corres.begin(),
+                      make_correspondence_pair_functor(
+                              thrust::raw_pointer_cast(indices.data())));
+    auto end = thrust::remove_if(
+            utility::exec_policy(stream)->on(stream), corres.begin(),
+            corres.end(),
+            [] __device__(const Eigen::Vector2i &x) -> bool {
+                return (x[0] < 0);
+            });
+    corres.resize(thrust::distance(corres.begin(), end));
+}
+
+// The exact types only, since the subclasses, the python trampolines
+// included, may override ComputeTransformation().
+bool IsFusedEstimation(const TransformationEstimation &estimation) {
+    return typeid(estimation) ==
+                   typeid(TransformationEstimationPointToPoint) ||
+           typeid(estimation) == typeid(TransformationEstimationPointToPlane);
+}
+
+/// Hands the buffers borrowed by BorrowCopy() back to \p workspace.
+void ReturnBorrowed(utility::Workspace &workspace,
+                    const geometry::PointCloud &source,
+                    geometry::PointCloud &pcd) {
+    workspace.GetBuffer<Eigen::Vector3f>("icp_source_points", 0)
+            .swap(pcd.points_);
+    if (source.HasNormals()) {
+        workspace.GetBuffer<Eigen::Vector3f>("icp_source_normals", 0)
+                .swap(pcd.normals_);
+    }
+    if (source.HasColors()) {
+        workspace.GetBuffer<Eigen::Vector3f>("icp_source_colors", 0)
+                .swap(pcd.colors_);
+    }
+}
+
+bool CheckICPInputs(const geometry::PointCloud &source,
+                    const geometry::PointCloud &target,
+                    float max_correspondence_distance,
+                    const TransformationEstimation &estimation) {
+    if (max_correspondence_distance <= 0.0) {
+        utility::LogError("Invalid max_correspondence_distance.");
+        return false;
+    }
+
+    if ((estimation.GetTransformationEstimationType() ==
+                 TransformationEstimationType::PointToPlane ||
+         estimation.GetTransformationEstimationType() ==
+                 TransformationEstimationType::ColoredICP ||
+         estimation.GetTransformationEstimationType() ==
+                 TransformationEstimationType::GeneralizedICP) &&
+        (!source.HasNormals() || !target.HasNormals())) {
+        utility::LogError(
+                "TransformationEstimationPointToPlane, "
+                "TransformationEstimationColoredICP and "
+                "TransformationEstimationForGeneralizedICP "
+                "require pre-computed normal vectors.");
+        return false;
+    }
+    return true;
+}
+
+RegistrationResult RegistrationICPWithKDTree(
+        utility::ExecutionContext &ctx,
+        utility::Workspace &workspace,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const geometry::KDTreeFlann &kdtree,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init,
+        const TransformationEstimation &estimation,
+        const ICPConvergenceCriteria &criteria,
+        bool compute_correspondence_set,
+        const CorrespondenceRejection &rejection) {
+    CUPOCH_PROFILE("RegistrationICP", ctx.GetStream());
+    Eigen::Matrix4f transformation = init;
+    // The transformed source and the correspondence set live in the
+    // workspace and are handed back at the end, so that iterations and
+    // repeated calls reuse the same device memory.
+    geometry::PointCloud pcd;
+    BorrowCopy(workspace, "icp_source_points", source.points_, pcd.points_);
+    if (source.HasNormals()) {
+        BorrowCopy(workspace, "icp_source_normals", source.normals_,
+                   pcd.normals_);
+    }
+    if (source.HasColors()) {
+        BorrowCopy(workspace, "icp_source_colors", source.colors_,
+                   pcd.colors_);
+    }
+    if (init.isIdentity() == false) {
+        pcd.Transform(ctx, init);
+    }
+    if (IsFusedEstimation(estimation)) {
+        RegistrationResult output(transformation);
+        Eigen::Matrix4f update = FusedICPStep(
+                ctx.GetStream(), workspace, pcd, target, kdtree,
+                max_correspondence_distance, rejection, estimation,
+                output.fitness_, output.inlier_rmse_);
+        for (int i = 0; i < criteria.max_iteration_; i++) {
+            utility::LogDebug(
+                    "ICP Iteration #{:d}: Fitness {:.4f}, RMSE {:.4f}", i,
+                    output.fitness_, output.inlier_rmse_);
+            transformation = update * transformation;
+            pcd.Transform(ctx, update);
+            const float prev_fitness = output.fitness_;
+            const float prev_inlier_rmse = output.inlier_rmse_;
+            update = FusedICPStep(ctx.GetStream(), workspace, pcd, target,
+                                  kdtree, max_correspondence_distance,
+                                  rejection, estimation, output.fitness_,
+                                  output.inlier_rmse_);
+            if (std::abs(prev_fitness - output.fitness_) <
+                        criteria.relative_fitness_ &&
+                std::abs(prev_inlier_rmse - output.inlier_rmse_) <
+                        criteria.relative_rmse_) {
+                break;
+            }
+        }
+        output.transformation_ = transformation;
+        if (compute_correspondence_set) {
+            MaterializeCorrespondences(ctx.GetStream(), workspace,
+                                       pcd.points_.size(),
+                                       output.correspondence_set_);
+        }
+        ReturnBorrowed(workspace, source, pcd);
+        return output;
+    }
+    RegistrationResult result;
+    auto &corres = workspace.GetBuffer<Eigen::Vector2i>("icp_correspondences",
+                                                        source.points_.size());
+    result.correspondence_set_.swap(corres);
+    GetRegistrationResultAndCorrespondences(
+            ctx.GetStream(), workspace, pcd, target, kdtree,
+            max_correspondence_distance, rejection, transformation, result);
+    for (int i = 0; i < criteria.max_iteration_; i++) {
+        utility::LogDebug("ICP Iteration #{:d}: Fitness {:.4f}, RMSE {:.4f}", i,
+                          result.fitness_, result.inlier_rmse_);
+        Eigen::Matrix4f update = estimation.ComputeTransformation(
+                pcd, target, result.correspondence_set_);
+        transformation = update * transformation;
+        pcd.Transform(ctx, update);
+        const float prev_fitness = result.fitness_;
+        const float prev_inlier_rmse = result.inlier_rmse_;
+        GetRegistrationResultAndCorrespondences(
+                ctx.GetStream(), workspace, pcd, target, kdtree,
+                max_correspondence_distance, rejection, transformation,
+                result);
+        if (std::abs(prev_fitness - result.fitness_) <
+                    criteria.relative_fitness_ &&
+            std::abs(prev_inlier_rmse - result.inlier_rmse_) <
+                    criteria.relative_rmse_) {
+            break;
+        }
+    }
+    RegistrationResult output(result);
+    result.correspondence_set_.swap(corres);
+    ReturnBorrowed(workspace, source, pcd);
+    return output;
+}
+
+// The batch grid key packs the pair and the cell coordinates in 16 bits
+// each.
+constexpr int kBatchKeyBits = 16;
+constexpr int kBatchKeyOffset = 1 << (kBatchKeyBits - 1);
+constexpr unsigned long long kBatchEmptyKey = ~0ull;
+constexpr int kBatchICPBlockSize = 128;
+// Iterations between two checks of the number of running pairs.
+constexpr int kBatchICPCheckInterval = 8;
+
+__device__ Eigen::Vector3i ComputeBatchCell(const Eigen::Vector3f &pt,
+                                            float cell_size) {
+    return Eigen::Vector3i(int(floor(pt(0) / cell_size)),
+                           int(floor(pt(1) / cell_size)),
+                           int(floor(pt(2) / cell_size)));
+}
+
+__device__ unsigned long long PackBatchCellKey(int pair,
+                                               const Eigen::Vector3i &cell) {
+    for (int i = 0; i < 3; ++i) {
+        if (cell[i] < -kBatchKeyOffset || cell[i] >= kBatchKeyOffset)
+            return kBatchEmptyKey;
+    }
+    return ((unsigned long long)pair << (3 * kBatchKeyBits)) |
+           ((unsigned long long)(cell[0] + kBatchKeyOffset)
+            << (2 * kBatchKeyBits)) |
+           ((unsigned long long)(cell[1] + kBatchKeyOffset) << kBatchKeyBits) |
+           (unsigned long long)(cell[2] + kBatchKeyOffset);
+}
+
+struct compute_batch_cell_key_functor {
+    compute_batch_cell_key_functor(const Eigen::Vector3f *points,
+                                   const int *pair_ids,
+                                   float cell_size)
+        : points_(points), pair_ids_(pair_ids), cell_size_(cell_size){};
+    const Eigen::Vector3f *points_;
+    const int *pair_ids_;
+    const float cell_size_;
+    __device__ unsigned long long operator()(size_t idx) const {
+        return PackBatchCellKey(pair_ids_[idx],
+                                ComputeBatchCell(points_[idx], cell_size_));
+    }
+};
+
+/// Per pair state of the device resident ICP loop.
+struct batch_icp_state {
+    Eigen::Matrix4f_u transformation_;
+    float fitness_;
+    float inlier_rmse_;
+    int count_;
+    int n_evaluations_;
+    int active_;
+};
+
+struct is_active_state_functor {
+    __device__ bool operator()(const batch_icp_state &s) const {
+        return s.active_ != 0;
+    }
+};
+
+/// Moves the source point \p idx with the transformation of its pair and
+/// searches its nearest target point of the same pair. The cell size is the
+/// search radius, so only the 27 surrounding cells are visited. The points
+/// of converged pairs are left untouched.
+struct batch_nearest_neighbor_functor {
+    batch_nearest_neighbor_functor(const Eigen::Vector3f *source,
+                                   const int *pair_ids,
+                                   const batch_icp_state *states,
+                                   const unsigned long long *cell_keys,
+                                   const int *cell_starts,
+                                   const int *cell_counts,
+                                   int n_cells,
+                                   const Eigen::Vector3f *sorted_points,
+                                   const int *sorted_indices,
+                                   float cell_size,
+                                   Eigen::Vector3f *transformed,
+                                   int *indices,
+                                   float *distance2)
+        : source_(source),
+          pair_ids_(pair_ids),
+          states_(states),
+          cell_keys_(cell_keys),
+          cell_starts_(cell_starts),
+          cell_counts_(cell_counts),
+          n_cells_(n_cells),
+          sorted_points_(sorted_points),
+          sorted_indices_(sorted_indices),
+          cell_size_(cell_size),
+          transformed_(transformed),
+          indices_(indices),
+          distance2_(distance2){};
+    const Eigen::Vector3f *source_;
+    const int *pair_ids_;
+    const batch_icp_state *states_;
+    const unsigned long long *cell_keys_;
+    const int *cell_starts_;
+    const int *cell_counts_;
+    const int n_cells_;
+    const Eigen::Vector3f *sorted_points_;
+    const int *sorted_indices_;
+    const float cell_size_;
+    Eigen::Vector3f *transformed_;
+    int *indices_;
+    float *distance2_;
+    __device__ void operator()(size_t idx) const {
+        const int pair = pair_ids_[idx];
+        if (!states_[pair].active_) return;
+        const Eigen::Matrix4f_u &tf = states_[pair].transformation_;
+        const Eigen::Vector3f q =
+                tf.block<3, 3>(0, 0) * source_[idx] + tf.block<3, 1>(0, 3);
+        transformed_[idx] = q;
+        const Eigen::Vector3i center = ComputeBatchCell(q, cell_size_);
+        float best_d2 = cell_size_ * cell_size_;
+        int best_i = -1;
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const unsigned long long key = PackBatchCellKey(
+                            pair, center + Eigen::Vector3i(dx, dy, dz));
+                    if (key == kBatchEmptyKey) continue;
+                    const int c = thrust::lower_bound(thrust::seq, cell_keys_,
+                                                      cell_keys_ + n_cells_,
+                                                      key) -
+                                  cell_keys_;
+                    if (c == n_cells_ || cell_keys_[c] != key) continue;
+                    for (int k = cell_starts_[c];
+                         k < cell_starts_[c] + cell_counts_[c]; ++k) {
+                        const float d2 = (sorted_points_[k] - q).squaredNorm();
+                        if (d2 <= best_d2) {
+                            best_d2 = d2;
+                            best_i = sorted_indices_[k];
+                        }
+                    }
+                }
+            }
+        }
+        indices_[idx] = best_i;
+        distance2_[idx] = (best_i < 0) ? 0.0 : best_d2;
+    }
+};
+
+__device__ bool ComputeBatchUpdate(const pt2pl_moments &m,
+                                   Eigen::Matrix4f &update) {
+    Eigen::Vector6f x;
+    if (!utility::SolveCholesky6(m.JTJ_, -m.JTr_, x)) return false;
+    update = utility::DeviceVector6fToMatrix4f(x);
+    return true;
+}
+
+__device__ bool ComputeBatchUpdate(const pt2pt_moments &m,
+                                   Eigen::Matrix4f &update) {
+    const Eigen::Vector3f source_center = m.sum_s_ / m.count_;
+    const Eigen::Vector3f target_center = m.sum_t_ / m.count_;
+    const Eigen::Matrix3f hh = m.sum_st_ / m.count_ -
+                               source_center * target_center.transpose();
+    Eigen::Matrix3f uu, ss, vv;
+    svd(hh(0, 0), hh(0, 1), hh(0, 2), hh(1, 0), hh(1, 1), hh(1, 2), hh(2, 0),
+        hh(2, 1), hh(2, 2), uu(0, 0), uu(0, 1), uu(0, 2), uu(1, 0), uu(1, 1),
+        uu(1, 2), uu(2, 0), uu(2, 1), uu(2, 2), ss(0, 0), ss(0, 1), ss(0, 2),
+        ss(1, 0), ss(1, 1), ss(1, 2), ss(2, 0), ss(2, 1), ss(2, 2), vv(0, 0),
+        vv(0, 1), vv(0, 2), vv(1, 0), vv(1, 1), vv(1, 2), vv(2, 0), vv(2, 1),
+        vv(2, 2));
+    ss = Eigen::Matrix3f::Identity();
+    ss(2, 2) = (uu * vv).determinant();
+    update = Eigen::Matrix4f::Identity();
+    update.block<3, 3>(0, 0) = vv * ss * uu.transpose();
+    update.block<3, 1>(0, 3) =
+            target_center - update.block<3, 3>(0, 0) * source_center;
+    return true;
+}
+
+/// Turns the reduced moments of every pair into its fitness and RMSE,
+/// tests the convergence against the previous evaluation and applies the
+/// update of the pairs still running. Mirrors the host loop of
+/// RegistrationICP(): at most max_iteration updates are applied.
+template <typename MomentsT>
+struct batch_icp_update_functor {
+    batch_icp_update_functor(const MomentsT *moments,
+                             const int *source_offsets,
+                             const ICPConvergenceCriteria &criteria,
+                             batch_icp_state *states)
+        : moments_(moments),
+          source_offsets_(source_offsets),
+          relative_fitness_(criteria.relative_fitness_),
+          relative_rmse_(criteria.relative_rmse_),
+          max_iteration_(criteria.max_iteration_),
+          states_(states){};
+    const MomentsT *moments_;
+    const int *source_offsets_;
+    const float relative_fitness_;
+    const float relative_rmse_;
+    const int max_iteration_;
+    batch_icp_state *states_;
+    __device__ void operator()(size_t pair) const {
+        batch_icp_state &s = states_[pair];
+        if (!s.active_) return;
+        const MomentsT &m = moments_[pair];
+        const int n_pt = source_offsets_[pair + 1] - source_offsets_[pair];
+        const float fitness = (n_pt > 0) ? (float)m.count_ / (float)n_pt : 0.0;
+        const float inlier_rmse =
+                (m.count_ > 0) ? sqrt(m.error2_ / (float)m.count_) : 0.0;
+        const bool converged =
+                s.n_evaluations_ > 0 &&
+                fabs(s.fitness_ - fitness) < relative_fitness_ &&
+                fabs(s.inlier_rmse_ - inlier_rmse) < relative_rmse_;
+        s.fitness_ = fitness;
+        s.inlier_rmse_ = inlier_rmse;
+        s.count_ = m.count_;
+        if (converged || s.n_evaluations_ >= max_iteration_) {
+            s.active_ = 0;
+            return;
+        }
+        s.n_evaluations_++;
+        Eigen::Matrix4f update;
+        if (m.count_ > 0 && ComputeBatchUpdate(m, update)) {
+            s.transformation_ = update * Eigen::Matrix4f(s.transformation_);
+        }
+    }
+};
+
+template <typename FuncT>
+__global__ void batch_icp_kernel(FuncT func, size_t n) {
+    const size_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+    if (idx < n) func(idx);
+}
+
+template <typename FuncT>
+void LaunchBatchICPKernel(cudaStream_t stream, const FuncT &func, size_t n) {
+    const int n_blocks = (n + kBatchICPBlockSize - 1) / kBatchICPBlockSize;
+    batch_icp_kernel<<<n_blocks, kBatchICPBlockSize, 0, stream>>>(func, n);
+    cudaSafeCall(cudaGetLastError());
+}
+
+/// One device resident ICP iteration for all the pairs: search, per pair
+/// reduction and update. Nothing is read back to the host, so the
+/// iteration can be captured as a CUDA graph.
+template <typename MomentsT, typename MomentsFuncT, typename AddT>
+class BatchICPIteration {
+public:
+    BatchICPIteration(const batch_nearest_neighbor_functor &search_func,
+                      size_t n_source,
+                      const MomentsFuncT &moments_func,
+                      const AddT &add,
+                      const utility::device_vector<int> &source_offsets,
+                      const ICPConvergenceCriteria &criteria,
+                      utility::device_vector<batch_icp_state> &states)
+        : search_func_(search_func),
+          n_source_(n_source),
+          moments_func_(moments_func),
+          add_(add),
+          source_offsets_(thrust::raw_pointer_cast(source_offsets.data())),
+          n_pairs_(states.size()),
+          moments_(states.size()),
+          update_func_(thrust::raw_pointer_cast(moments_.data()),
+                       source_offsets_,
+                       criteria,
+                       thrust::raw_pointer_cast(states.data())) {
+        auto moments_begin = thrust::make_transform_iterator(
+                thrust::make_counting_iterator(0), moments_func_);
+        size_t temp_bytes = 0;
+        cudaSafeCall(cub::DeviceSegmentedReduce::Reduce(
+                NULL, temp_bytes, moments_begin,
+                thrust::raw_pointer_cast(moments_.data()), n_pairs_,
+                source_offsets_, source_offsets_ + 1, add_, MomentsT::Zero()));
+        temp_.resize(temp_bytes);
+    }
+
+    void Enqueue(cudaStream_t stream) {
+        utility::TunedForEach("BatchICP::Search", n_source_, search_func_,
+                              stream);
+        auto moments_begin = thrust::make_transform_iterator(
+                thrust::make_counting_iterator(0), moments_func_);
+        size_t temp_bytes = temp_.size();
+        cudaSafeCall(cub::DeviceSegmentedReduce::Reduce(
+                thrust::raw_pointer_cast(temp_.data()), temp_bytes,
+                moments_begin, thrust::raw_pointer_cast(moments_.data()),
+                n_pairs_, source_offsets_, source_offsets_ + 1, add_,
+                MomentsT::Zero(), stream));
+        LaunchBatchICPKernel(stream, update_func_, n_pairs_);
+    }
+
+    size_t NumSources() const { return n_source_; }
+
+private:
+    batch_nearest_neighbor_functor search_func_;
+    size_t n_source_;
+    MomentsFuncT moments_func_;
+    AddT add_;
+    const int *source_offsets_;
+    int n_pairs_;
+    utility::device_vector<MomentsT> moments_;
+    utility::device_vector<char> temp_;
+    batch_icp_update_functor<MomentsT> update_func_;
+};
+
+/// Captures \p iteration once as a CUDA graph and replays it until every
+/// pair has converged. The host only checks the number of running pairs
+/// every kBatchICPCheckInterval iterations.
+template <typename IterationT>
+void RunBatchICPLoop(utility::ExecutionContext &ctx,
+                     IterationT &iteration,
+                     int max_iteration,
+                     const utility::device_vector<batch_icp_state> &states) {
+    // The first evaluation plus one per update.
+    const int n_launches = max_iteration + 1;
+    int launched = 0;
+    // The launches captured in the graph are not timed, so the first
+    // iterations are enqueued one by one while the search is being tuned.
+    utility::LaunchConfig config;
+    while (utility::IsLaunchTuningEnabled() && launched < n_launches &&
+           !utility::GetTunedLaunchConfig("BatchICP::Search",
+                                          iteration.NumSources(), config)) {
+        iteration.Enqueue(ctx.GetStream());
+        ++launched;
+    }
+    if (launched == n_launches) return;
+    utility::CUDAGraph graph;
+    if (!graph.Capture([&](cudaStream_t stream) {
+            iteration.Enqueue(stream);
+        })) {
+        return;
+    }
+    while (launched < n_launches) {
+        const int n = std::min(kBatchICPCheckInterval, n_launches - launched);
+        for (int i = 0; i < n; ++i) graph.Launch(ctx);
+        launched += n;
+        const int n_active = thrust::count_if(
+                utility::exec_policy(ctx.GetStream())->on(ctx.GetStream()),
+                states.begin(), states.end(), is_active_state_functor());
+        if (n_active == 0) break;
+    }
+}
+
+struct make_batch_correspondence_functor {
+    make_batch_correspondence_functor(const int *indices,
+                                      const int *pair_ids,
+                                      const int *source_offsets,
+                                      const int *target_offsets)
+        : indices_(indices),
+          pair_ids_(pair_ids),
+          source_offsets_(source_offsets),
+          target_offsets_(target_offsets){};
+    const int *indices_;
+    const int *pair_ids_;
+    const int *source_offsets_;
+    const int *target_offsets_;
+    __device__ Eigen::Vector2i operator()(int i) const {
+        const int pair = pair_ids_[i];
+        return (indices_[i] < 0)
+                       ? Eigen::Vector2i(-1, -1)
+                       : Eigen::Vector2i(i - source_offsets_[pair],
+                                         indices_[i] - target_offsets_[pair]);
+    }
+};
+
+/// ICP of the pairs of concatenated clouds, pair i being the sources
+/// [source_offsets[i], source_offsets[i + 1]) and the targets
+/// [target_offsets[i], target_offsets[i + 1]). The normals of the targets
+/// are only read by the point to plane estimation.
+void RegistrationICPBatchConcatenated(
+        utility::ExecutionContext &ctx,
+        const thrust::host_vector<int> &source_offsets,
+        const thrust::host_vector<int> &target_offsets,
+        const utility::device_vector<Eigen::Vector3f> &source_points,
+        const utility::device_vector<Eigen::Vector3f> &target_points,
+        const utility::device_vector<Eigen::Vector3f> &target_normals,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u> &transforms,
+        const TransformationEstimation &estimation,
+        const ICPConvergenceCriteria &criteria,
+        std::vector<RegistrationResult> &results) {
+    const size_t n_pairs = transforms.size();
+    const int n_source = source_offsets[n_pairs];
+    const int n_target = target_offsets[n_pairs];
+    const bool point_to_plane = estimation.GetTransformationEstimationType() ==
+                                TransformationEstimationType::PointToPlane;
+    cudaStream_t stream = ctx.GetStream();
+    utility::device_vector<int> d_source_offsets = source_offsets;
+    utility::device_vector<int> d_target_offsets = target_offsets;
+    utility::device_vector<int> source_pairs(n_source);
+    utility::device_vector<int> target_pairs(n_target);
+    thrust::upper_bound(utility::exec_policy(stream)->on(stream),
+                        d_source_offsets.begin() + 1, d_source_offsets.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(n_source),
+                        source_pairs.begin());
+    thrust::upper_bound(utility::exec_policy(stream)->on(stream),
+                        d_target_offsets.begin() + 1, d_target_offsets.end(),
+                        thrust::make_counting_iterator(0),
+                        thrust::make_counting_iterator(n_target),
+                        target_pairs.begin());
+
+    // Grid of all the targets, sorted by pair and cell.
+    utility::device_vector<unsigned long long> keys(n_target);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator<size_t>(n_target),
+                      keys.begin(),
+                      compute_batch_cell_key_functor(
+                              thrust::raw_pointer_cast(target_points.data()),
+                              thrust::raw_pointer_cast(target_pairs.data()),
+                              max_correspondence_distance));
+    utility::device_vector<int> sorted_indices(n_target);
+    thrust::sequence(utility::exec_policy(stream)->on(stream),
+                     sorted_indices.begin(), sorted_indices.end());
+    thrust::sort_by_key(utility::exec_policy(stream)->on(stream),
+                        keys.begin(), keys.end(), sorted_indices.begin());
+    utility::device_vector<Eigen::Vector3f> sorted_points(n_target);
+    thrust::gather(utility::exec_policy(stream)->on(stream),
+                   sorted_indices.begin(), sorted_indices.end(),
+                   target_points.begin(), sorted_points.begin());
+    utility::device_vector<unsigned long long> cell_keys(n_target);
+    utility::device_vector<int> cell_counts(n_target);
+    auto end = thrust::reduce_by_key(
+            utility::exec_policy(stream)->on(stream), keys.begin(), keys.end(),
+            thrust::make_constant_iterator(1), cell_keys.begin(),
+            cell_counts.begin());
+    const int n_cells = thrust::distance(cell_keys.begin(), end.first);
+    utility::device_vector<int> cell_starts(n_cells);
+    thrust::exclusive_scan(utility::exec_policy(stream)->on(stream),
+                           cell_counts.begin(), cell_counts.begin() + n_cells,
+                           cell_starts.begin());
+
+    thrust::host_vector<batch_icp_state> h_states(n_pairs);
+    for (size_t i = 0; i < n_pairs; ++i) {
+        h_states[i].transformation_ = transforms[i];
+        h_states[i].fitness_ = 0.0;
+        h_states[i].inlier_rmse_ = 0.0;
+        h_states[i].count_ = 0;
+        h_states[i].n_evaluations_ = 0;
+        h_states[i].active_ = 1;
+    }
+    utility::device_vector<batch_icp_state> states = h_states;
+    utility::device_vector<Eigen::Vector3f> transformed(n_source);
+    utility::device_vector<int> indices(n_source, -1);
+    utility::device_vector<float> dists(n_source, 0.0);
+    batch_nearest_neighbor_functor search_func(
+            thrust::raw_pointer_cast(source_points.data()),
+            thrust::raw_pointer_cast(source_pairs.data()),
+            thrust::raw_pointer_cast(states.data()),
+            thrust::raw_pointer_cast(cell_keys.data()),
+            thrust::raw_pointer_cast(cell_starts.data()),
+            thrust::raw_pointer_cast(cell_counts.data()), n_cells,
+            thrust::raw_pointer_cast(sorted_points.data()),
+            thrust::raw_pointer_cast(sorted_indices.data()),
+            max_correspondence_distance,
+            thrust::raw_pointer_cast(transformed.data()),
+            thrust::raw_pointer_cast(indices.data()),
+            thrust::raw_pointer_cast(dists.data()));
+    if (point_to_plane) {
+        pt2pl_moments_functor func(
+                thrust::raw_pointer_cast(transformed.data()),
+                thrust::raw_pointer_cast(target_points.data()),
+                thrust::raw_pointer_cast(target_normals.data()),
+                thrust::raw_pointer_cast(indices.data()),
+                thrust::raw_pointer_cast(dists.data()),
+                ((const TransformationEstimationPointToPlane &)estimation)
+                        .kernel_);
+        BatchICPIteration<pt2pl_moments, pt2pl_moments_functor,
+                          add_pt2pl_moments_functor>
+                iteration(search_func, n_source, func,
+                          add_pt2pl_moments_functor(), d_source_offsets,
+                          criteria, states);
+        RunBatchICPLoop(ctx, iteration, criteria.max_iteration_, states);
+    } else {
+        pt2pt_moments_functor func(
+                thrust::raw_pointer_cast(transformed.data()),
+                thrust::raw_pointer_cast(target_points.data()),
+                thrust::raw_pointer_cast(indices.data()),
+                thrust::raw_pointer_cast(dists.data()),
+                Eigen::Vector3f::Zero());
+        BatchICPIteration<pt2pt_moments, pt2pt_moments_functor,
+                          add_pt2pt_moments_functor>
+                iteration(search_func, n_source, func,
+                          add_pt2pt_moments_functor(), d_source_offsets,
+                          criteria, states);
+        RunBatchICPLoop(ctx, iteration, criteria.max_iteration_, states);
+    }
+    h_states = states;
+
+    // The indices of every pair are the ones of its last evaluation, which
+    // was run at its final transformation.
+    CorrespondenceSet corres(n_source);
+    thrust::transform(utility::exec_policy(stream)->on(stream),
+                      thrust::make_counting_iterator(0),
+                      thrust::make_counting_iterator(n_source), corres.begin(),
+                      make_batch_correspondence_functor(
+                              thrust::raw_pointer_cast(indices.data()),
+                              thrust::raw_pointer_cast(source_pairs.data()),
+                              thrust::raw_pointer_cast(
+                                      d_source_offsets.data()),
+                              thrust::raw_pointer_cast(
+                                      d_target_offsets.data())));
+    thrust::remove_if(utility::exec_policy(stream)->on(stream), corres.begin(),
+                      corres.end(),
+                      [] __device__(const Eigen::Vector2i &x) -> bool {
+                          return (x[0] < 0);
+                      });
+    int offset = 0;
+    for (size_t i = 0; i < n_pairs; ++i) {
+        const batch_icp_state &s = h_states[i];
+        results[i].transformation_ = s.transformation_;
+        results[i].fitness_ = s.fitness_;
+        results[i].inlier_rmse_ = s.inlier_rmse_;
+        results[i].correspondence_set_.resize(s.count_);
+        thrust::copy(corres.begin() + offset,
+                     corres.begin() + offset + s.count_,
+                     results[i].correspondence_set_.begin());
+        offset += s.count_;
+    }
+}
+
+std::vector<RegistrationResult> RegistrationICPBatchImpl(
+        utility::ExecutionContext &ctx,
+        const std::vector<const geometry::PointCloud *> &sources,
+        const std::vector<const geometry::PointCloud *> &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u> &inits,
+        const TransformationEstimation &estimation,
+        const ICPConvergenceCriteria &criteria) {
+    const size_t n_pairs = sources.size();
+    const std::vector<Eigen::Matrix4f_u> transforms =
+            inits.empty() ? std::vector<Eigen::Matrix4f_u>(
+                                    n_pairs, Eigen::Matrix4f::Identity())
+                          : inits;
+    std::vector<RegistrationResult> results;
+    for (size_t i = 0; i < std::min(n_pairs, transforms.size()); ++i) {
+        results.emplace_back(transforms[i]);
+    }
+    if (targets.size() != n_pairs || transforms.size() != n_pairs) {
+        utility::LogError(
+                "[RegistrationICPBatch] sources, targets and inits must have "
+                "the same size.");
+        return results;
+    }
+    if (n_pairs >= (1 << kBatchKeyBits)) {
+        utility::LogError("[RegistrationICPBatch] Too many pairs.");
+        return results;
+    }
+    if (!IsFusedEstimation(estimation)) {
+        utility::LogError(
+                "[RegistrationICPBatch] Only "
+                "TransformationEstimationPointToPoint and "
+                "TransformationEstimationPointToPlane are supported.");
+        return results;
+    }
+    const bool point_to_plane = estimation.GetTransformationEstimationType() ==
+                                TransformationEstimationType::PointToPlane;
+    thrust::host_vector<int> source_offsets(n_pairs + 1, 0);
+    thrust::host_vector<int> target_offsets(n_pairs + 1, 0);
+    for (size_t i = 0; i < n_pairs; ++i) {
+        if (!CheckICPInputs(*sources[i], *targets[i],
+                            max_correspondence_distance, estimation)) {
+            return results;
+        }
+        source_offsets[i + 1] = source_offsets[i] + sources[i]->points_.size();
+        target_offsets[i + 1] = target_offsets[i] + targets[i]->points_.size();
+    }
+    const int n_source = source_offsets[n_pairs];
+    const int n_target = target_offsets[n_pairs];
+    if (n_pairs == 0 || n_source == 0 || n_target == 0) return results;
+
+    utility::device_vector<Eigen::Vector3f> source_points(n_source);
+    utility::device_vector<Eigen::Vector3f> target_points(n_target);
+    utility::device_vector<Eigen::Vector3f> target_normals(
+            point_to_plane ? n_target : 0);
+    for (size_t i = 0; i < n_pairs; ++i) {
+        thrust::copy(sources[i]->points_.begin(), sources[i]->points_.end(),
+                     source_points.begin() + source_offsets[i]);
+        thrust::copy(targets[i]->points_.begin(), targets[i]->points_.end(),
+                     target_points.begin() + target_offsets[i]);
+        if (point_to_plane) {
+            thrust::copy(targets[i]->normals_.begin(),
+                         targets[i]->normals_.end(),
+                         target_normals.begin() + target_offsets[i]);
+        }
+    }
+    RegistrationICPBatchConcatenated(
+            ctx, source_offsets, target_offsets, source_points, target_points,
+            target_normals, max_correspondence_distance, transforms,
+            estimation, criteria, results);
+    return results;
+}
+
+struct information_moments {
+    Eigen::Matrix3f sum_qq_;
+    Eigen::Vector3f sum_q_;
+    int count_;
+    __host__ __device__ static information_moments Zero() {
+        information_moments m;
+        m.sum_qq_.setZero();
+        m.sum_q_.setZero();
+        m.count_ = 0;
+        return m;
+    }
+};
+
+struct add_information_moments_functor {
+    __host__ __device__ information_moments operator()(
+            const information_moments &x, const information_moments &y) const {
+        information_moments m;
+        m.sum_qq_ = x.sum_qq_ + y.sum_qq_;
+        m.sum_q_ = x.sum_q_ + y.sum_q_;
+        m.count_ = x.count_ + y.count_;
+        return m;
+    }
+};
+
+/// Moments of the target points of the correspondences, read every
+/// \p stride ints from \p target_indices, so that both the per point
+/// indices of a KNN search and the second column of a CorrespondenceSet
+/// can be reduced.
+struct information_moments_functor {
+    information_moments_functor(const Eigen::Vector3f *target_points,
+                                const int *target_indices,
+                                int stride)
+        : target_points_(target_points),
+          target_indices_(target_indices),
+          stride_(stride){};
+    const Eigen::Vector3f *target_points_;
+    const int *target_indices_;
+    const int stride_;
+    __device__ information_moments operator()(int i) const {
+        information_moments m = information_moments::Zero();
+        const int idx = target_indices_[i * stride_];
+        if (idx < 0) return m;
+        const Eigen::Vector3f &q = target_points_[idx];
+        m.sum_qq_ = q * q.transpose();
+        m.sum_q_ = q;
+        m.count_ = 1;
+        return m;
+    }
+};
+
+/// sum_i G_i^T G_i with G_i = [-[q_i]x, I], from the moments of the q_i.
+Eigen::Matrix6f ComputeInformationMatrix(
+        const geometry::PointCloud &target,
+        const int *target_indices,
+        int stride,
+        int n) {
+    const information_moments m = thrust::transform_reduce(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(n),
+            information_moments_functor(
+                    thrust::raw_pointer_cast(target.points_.data()),
+                    target_indices, stride),
+            information_moments::Zero(), add_information_moments_functor());
+    Eigen::Matrix3f sum_qx;
+    sum_qx << 0.0, -m.sum_q_[2], m.sum_q_[1], m.sum_q_[2], 0.0, -m.sum_q_[0],
+            -m.sum_q_[1], m.sum_q_[0], 0.0;
+    Eigen::Matrix6f information;
+    information.block<3, 3>(0, 0) =
+            m.sum_qq_.trace() * Eigen::Matrix3f::Identity() - m.sum_qq_;
+    information.block<3, 3>(0, 3) = sum_qx;
+    information.block<3, 3>(3, 0) = -sum_qx;
+    information.block<3, 3>(3, 3) =
+            (float)m.count_ * Eigen::Matrix3f::Identity();
+    return information;
 }
 
 }  // namespace
@@ -107,47 +1186,396 @@ RegistrationResult cupoch::registration::RegistrationICP(
         /* = TransformationEstimationPointToPoint(false)*/,
         const ICPConvergenceCriteria
                 &criteria /* = ICPConvergenceCriteria()*/) {
-    if (max_correspondence_distance <= 0.0) {
-        utility::LogError("Invalid max_correspondence_distance.");
+    return RegistrationICP(utility::ExecutionContext::Default(), source,
+                           target, max_correspondence_distance, init,
+                           estimation, criteria);
+}
+
+RegistrationResult cupoch::registration::RegistrationICP(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint(false)*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    utility::Workspace workspace;
+    return RegistrationICP(ctx, workspace, source, target,
+                           max_correspondence_distance, init, estimation,
+                           criteria);
+}
+
+RegistrationResult cupoch::registration::RegistrationICP(
+        utility::ExecutionContext &ctx,
+        utility::Workspace &workspace,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint(false)*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    if (!CheckICPInputs(source, target, max_correspondence_distance,
+                        estimation)) {
+        return RegistrationResult(init);
     }
+    geometry::KDTreeFlann kdtree(ctx, target);
+    kdtree.SetWorkspace(&workspace);
+    return RegistrationICPWithKDTree(ctx, workspace, source, target, kdtree,
+                                     max_correspondence_distance, init,
+                                     estimation, criteria, true,
+                                     CorrespondenceRejection());
+}
 
-    if ((estimation.GetTransformationEstimationType() ==
-                 TransformationEstimationType::PointToPlane ||
-         estimation.GetTransformationEstimationType() ==
-                 TransformationEstimationType::ColoredICP) &&
-        (!source.HasNormals() || !target.HasNormals())) {
+RegistrationResult cupoch::registration::RegistrationICP(
+        utility::ExecutionContext &ctx,
+        utility::Workspace &workspace,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const geometry::KDTreeFlann &target_kdtree,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint(false)*/,
+        const ICPConvergenceCriteria &criteria /* = ICPConvergenceCriteria()*/,
+        const CorrespondenceRejection
+                &rejection /* = CorrespondenceRejection()*/) {
+    if (!CheckICPInputs(source, target, max_correspondence_distance,
+                        estimation)) {
+        return RegistrationResult(init);
+    }
+    return RegistrationICPWithKDTree(ctx, workspace, source, target,
+                                     target_kdtree, max_correspondence_distance,
+                                     init, estimation, criteria, true,
+                                     rejection);
+}
+
+RegistrationResult cupoch::registration::RegistrationMultiScaleICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const std::vector<float> &voxel_sizes,
+        const std::vector<ICPConvergenceCriteria> &criteria,
+        const std::vector<float> &max_correspondence_distances,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/) {
+    return RegistrationMultiScaleICP(utility::ExecutionContext::Default(),
+                                     source, target, voxel_sizes, criteria,
+                                     max_correspondence_distances, init,
+                                     estimation);
+}
+
+RegistrationResult cupoch::registration::RegistrationMultiScaleICP(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const std::vector<float> &voxel_sizes,
+        const std::vector<ICPConvergenceCriteria> &criteria,
+        const std::vector<float> &max_correspondence_distances,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/) {
+    const size_t n_levels = voxel_sizes.size();
+    if (n_levels == 0 || criteria.size() != n_levels ||
+        max_correspondence_distances.size() != n_levels) {
         utility::LogError(
-                "TransformationEstimationPointToPlane and "
-                "TransformationEstimationColoredICP "
-                "require pre-computed normal vectors.");
+                "[RegistrationMultiScaleICP] voxel_sizes, criteria and "
+                "max_correspondence_distances must have the same non zero "
+                "size.");
+        return RegistrationResult(init);
+    }
+    for (size_t i = 1; i < n_levels; ++i) {
+        if (voxel_sizes[i] > voxel_sizes[i - 1]) {
+            utility::LogError(
+                    "[RegistrationMultiScaleICP] voxel_sizes must be "
+                    "decreasing.");
+            return RegistrationResult(init);
+        }
     }
+    const auto type = estimation.GetTransformationEstimationType();
+    const bool needs_normals =
+            type == TransformationEstimationType::PointToPlane ||
+            type == TransformationEstimationType::GeneralizedICP;
+    const bool needs_source_normals =
+            type == TransformationEstimationType::GeneralizedICP;
 
-    Eigen::Matrix4f transformation = init;
-    geometry::KDTreeFlann kdtree(target);
-    geometry::PointCloud pcd = source;
-    if (init.isIdentity() == false) {
-        pcd.Transform(init);
+    // Build the pyramid from the finest level up.
+    std::vector<std::shared_ptr<geometry::PointCloud>> sources(n_levels);
+    std::vector<std::shared_ptr<geometry::PointCloud>> targets(n_levels);
+    const geometry::PointCloud *finer_source = &source;
+    const geometry::PointCloud *finer_target = &target;
+    for (int i = (int)n_levels - 1; i >= 0; --i) {
+        const float voxel_size = voxel_sizes[i];
+        if (voxel_size > 0.0) {
+            sources[i] = finer_source->VoxelDownSample(ctx, voxel_size);
+            targets[i] = finer_target->VoxelDownSample(ctx, voxel_size);
+        } else {
+            sources[i] = std::make_shared<geometry::PointCloud>(*finer_source);
+            targets[i] = std::make_shared<geometry::PointCloud>(*finer_target);
+        }
+        const float normal_radius =
+                (voxel_size > 0.0) ? voxel_size * 2.0
+                                   : max_correspondence_distances[i] * 2.0;
+        if (needs_normals && !targets[i]->HasNormals()) {
+            targets[i]->EstimateNormals(
+                    geometry::KDTreeSearchParamHybrid(normal_radius, 30));
+        }
+        if (needs_source_normals && !sources[i]->HasNormals()) {
+            sources[i]->EstimateNormals(
+                    geometry::KDTreeSearchParamHybrid(normal_radius, 30));
+        }
+        finer_source = sources[i].get();
+        finer_target = targets[i].get();
     }
-    RegistrationResult result;
-    result = GetRegistrationResultAndCorrespondences(
-            pcd, target, kdtree, max_correspondence_distance, transformation);
-    for (int i = 0; i < criteria.max_iteration_; i++) {
-        utility::LogDebug("ICP Iteration #{:d}: Fitness {:.4f}, RMSE {:.4f}", i,
-                          result.fitness_, result.inlier_rmse_);
-        Eigen::Matrix4f update = estimation.ComputeTransformation(
-                pcd, target, result.correspondence_set_);
-        transformation = update * transformation;
-        pcd.Transform(update);
-        RegistrationResult backup = result;
-        result = GetRegistrationResultAndCorrespondences(
-                pcd, target, kdtree, max_correspondence_distance,
-                transformation);
-        if (std::abs(backup.fitness_ - result.fitness_) <
-                    criteria.relative_fitness_ &&
-            std::abs(backup.inlier_rmse_ - result.inlier_rmse_) <
-                    criteria.relative_rmse_) {
-            break;
+
+    utility::Workspace workspace;
+    RegistrationResult result(init);
+    for (size_t i = 0; i < n_levels; ++i) {
+        if (!CheckICPInputs(*sources[i], *targets[i],
+                            max_correspondence_distances[i], estimation)) {
+            return result;
         }
+        geometry::KDTreeFlann kdtree(ctx, *targets[i]);
+        kdtree.SetWorkspace(&workspace);
+        result = RegistrationICPWithKDTree(
+                ctx, workspace, *sources[i], *targets[i], kdtree,
+                max_correspondence_distances[i], result.transformation_,
+                estimation, criteria[i], i + 1 == n_levels,
+                CorrespondenceRejection());
     }
     return result;
-}
\ No newline at end of file
+}
+
+std::vector<RegistrationResult> cupoch::registration::RegistrationICPBatch(
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &sources,
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u>
+                &inits /* = std::vector<Eigen::Matrix4f_u>()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    return RegistrationICPBatch(utility::ExecutionContext::Default(), sources,
+                                targets, max_correspondence_distance, inits,
+                                estimation, criteria);
+}
+
+std::vector<RegistrationResult> cupoch::registration::RegistrationICPBatch(
+        utility::ExecutionContext &ctx,
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &sources,
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u>
+                &inits /* = std::vector<Eigen::Matrix4f_u>()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    std::vector<const geometry::PointCloud *> source_ptrs;
+    std::vector<const geometry::PointCloud *> target_ptrs;
+    for (const auto &source : sources) source_ptrs.push_back(source.get());
+    for (const auto &target : targets) target_ptrs.push_back(target.get());
+    return RegistrationICPBatchImpl(ctx, source_ptrs, target_ptrs,
+                                    max_correspondence_distance, inits,
+                                    estimation, criteria);
+}
+
+std::vector<RegistrationResult> cupoch::registration::RegistrationICPBatch(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloudBatch &sources,
+        const geometry::PointCloudBatch &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u>
+                &inits /* = std::vector<Eigen::Matrix4f_u>()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    const size_t n_pairs = sources.GetNumClouds();
+    const std::vector<Eigen::Matrix4f_u> transforms =
+            inits.empty() ? std::vector<Eigen::Matrix4f_u>(
+                                    n_pairs, Eigen::Matrix4f::Identity())
+                          : inits;
+    std::vector<RegistrationResult> results;
+    for (size_t i = 0; i < std::min(n_pairs, transforms.size()); ++i) {
+        results.emplace_back(transforms[i]);
+    }
+    if (targets.GetNumClouds() != n_pairs || transforms.size() != n_pairs) {
+        utility::LogError(
+                "[RegistrationICPBatch] sources, targets and inits must have "
+                "the same size.");
+        return results;
+    }
+    if (n_pairs >= (1 << kBatchKeyBits)) {
+        utility::LogError("[RegistrationICPBatch] Too many pairs.");
+        return results;
+    }
+    if (!IsFusedEstimation(estimation)) {
+        utility::LogError(
+                "[RegistrationICPBatch] Only "
+                "TransformationEstimationPointToPoint and "
+                "TransformationEstimationPointToPlane are supported.");
+        return results;
+    }
+    if (max_correspondence_distance <= 0.0) {
+        utility::LogError("Invalid max_correspondence_distance.");
+        return results;
+    }
+    const bool point_to_plane = estimation.GetTransformationEstimationType() ==
+                                TransformationEstimationType::PointToPlane;
+    if (point_to_plane && !targets.HasNormals()) {
+        utility::LogError(
+                "TransformationEstimationPointToPlane requires pre-computed "
+                "normal vectors.");
+        return results;
+    }
+    if (n_pairs == 0 || sources.IsEmpty() || targets.IsEmpty()) {
+        return results;
+    }
+    RegistrationICPBatchConcatenated(
+            ctx, sources.GetOffsets(), targets.GetOffsets(), sources.points_,
+            targets.points_, targets.normals_, max_correspondence_distance,
+            transforms, estimation, criteria, results);
+    return results;
+}
+
+std::vector<RegistrationResult> cupoch::registration::RegistrationICPBatch(
+        const geometry::PointCloudBatch &sources,
+        const geometry::PointCloudBatch &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u>
+                &inits /* = std::vector<Eigen::Matrix4f_u>()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    return RegistrationICPBatch(utility::ExecutionContext::Default(), sources,
+                                targets, max_correspondence_distance, inits,
+                                estimation, criteria);
+}
+
+RegistrationResult cupoch::registration::RegistrationICPOnDevice(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    return RegistrationICPOnDevice(utility::ExecutionContext::Default(),
+                                   source, target, max_correspondence_distance,
+                                   init, estimation, criteria);
+}
+
+RegistrationResult cupoch::registration::RegistrationICPOnDevice(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init /* = Eigen::Matrix4f::Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint()*/,
+        const ICPConvergenceCriteria
+                &criteria /* = ICPConvergenceCriteria()*/) {
+    auto results = RegistrationICPBatchImpl(
+            ctx, {&source}, {&target}, max_correspondence_distance,
+            {Eigen::Matrix4f_u(init)}, estimation, criteria);
+    return results.empty() ? RegistrationResult(init) : results[0];
+}
+
+ICPRegistrator::ICPRegistrator(float max_correspondence_distance,
+                               const ICPConvergenceCriteria &criteria)
+    : ICPRegistrator(utility::ExecutionContext::Default(),
+                     max_correspondence_distance,
+                     criteria) {}
+
+ICPRegistrator::ICPRegistrator(utility::ExecutionContext &ctx,
+                               float max_correspondence_distance,
+                               const ICPConvergenceCriteria &criteria)
+    : max_correspondence_distance_(max_correspondence_distance),
+      criteria_(criteria),
+      context_(&ctx),
+      target_(new geometry::PointCloud()),
+      kdtree_(new geometry::KDTreeFlann(ctx)),
+      estimation_(std::make_shared<TransformationEstimationPointToPoint>()) {
+    kdtree_->SetWorkspace(&workspace_);
+}
+
+ICPRegistrator::~ICPRegistrator() {}
+
+void ICPRegistrator::SetTarget(const geometry::PointCloud &target,
+                               bool estimate_normals) {
+    *target_ = target;
+    if (estimate_normals && !target_->HasNormals()) {
+        target_->EstimateNormals();
+    }
+    kdtree_->SetGeometry(*target_);
+}
+
+bool ICPRegistrator::HasTarget() const { return target_->HasPoints(); }
+
+Eigen::Matrix6f cupoch::registration::GetInformationMatrixFromPointClouds(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &transformation) {
+    if (source.IsEmpty() || target.IsEmpty()) {
+        utility::LogWarning(
+                "[GetInformationMatrixFromPointClouds] Empty point cloud.");
+        return Eigen::Matrix6f::Identity();
+    }
+    geometry::PointCloud transformed = source;
+    transformed.Transform(transformation);
+    geometry::KDTreeFlann kdtree(target);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> dists;
+    kdtree.SearchHybrid(transformed.points_, max_correspondence_distance, 1,
+                        indices, dists);
+    return ComputeInformationMatrix(target,
+                                    thrust::raw_pointer_cast(indices.data()),
+                                    1, indices.size());
+}
+
+Eigen::Matrix6f cupoch::registration::GetInformationMatrixFromRegistrationResult(
+        const geometry::PointCloud &target, const RegistrationResult &result) {
+    if (result.correspondence_set_.empty()) {
+        utility::LogWarning(
+                "[GetInformationMatrixFromRegistrationResult] Empty "
+                "correspondence set.");
+        return Eigen::Matrix6f::Identity();
+    }
+    const int *target_indices =
+            thrust::raw_pointer_cast(result.correspondence_set_.data())
+                    ->data() +
+            1;
+    return ComputeInformationMatrix(target, target_indices, 2,
+                                    result.correspondence_set_.size());
+}
+
+RegistrationResult ICPRegistrator::Register(const geometry::PointCloud &source,
+                                            const Eigen::Matrix4f &init) {
+    return Register(source, init, *estimation_);
+}
+
+RegistrationResult ICPRegistrator::Register(
+        const geometry::PointCloud &source,
+        const Eigen::Matrix4f &init,
+        const TransformationEstimation &estimation) {
+    if (!HasTarget()) {
+        utility::LogError("[ICPRegistrator] Target is not set.");
+        return RegistrationResult(init);
+    }
+    if (!CheckICPInputs(source, *target_, max_correspondence_distance_,
+                        estimation)) {
+        return RegistrationResult(init);
+    }
+    return RegistrationICPWithKDTree(*context_, workspace_, source, *target_,
+                                     *kdtree_, max_correspondence_distance_,
+                                     init, estimation, criteria_,
+                                     compute_correspondence_set_, rejection_);
+}
@@ -1,13 +1,20 @@
 #pragma once
 #include <thrust/host_vector.h>
 
+#include <vector>
+
+#include "cupoch/registration/correspondence_rejection.h"
 #include "cupoch/registration/transformation_estimation.h"
 #include "cupoch/utility/eigen.h"
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/workspace.h"
 
 namespace cupoch {
 
 namespace geometry {
 class PointCloud;
+class PointCloudBatch;
+class KDTreeFlann;
 }
 
 namespace registration {
@@ -56,5 +63,236 @@ RegistrationResult RegistrationICP(
                 TransformationEstimationPointToPoint(),
         const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
 
+/// Same as RegistrationICP(), with the correspondence search and the point
+/// cloud updates enqueued on the stream of \p ctx.
+RegistrationResult RegistrationICP(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// Same as above, with the temporaries of the correspondence search taken
+/// from \p workspace. Calling it repeatedly with the same workspace and
+/// similarly sized clouds does not allocate device memory after the first
+/// call, except for the returned correspondence set.
+RegistrationResult RegistrationICP(
+        utility::ExecutionContext &ctx,
+        utility::Workspace &workspace,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// Same as above, with the correspondences searched in \p target_kdtree,
+/// which must be built on \p target, so that a target registered many
+/// times keeps one KD-tree, and filtered by \p rejection on the device
+/// every iteration.
+RegistrationResult RegistrationICP(
+        utility::ExecutionContext &ctx,
+        utility::Workspace &workspace,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const geometry::KDTreeFlann &target_kdtree,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria(),
+        const CorrespondenceRejection &rejection = CorrespondenceRejection());
+
+/// Same as RegistrationICP(), with the whole iteration loop kept on the
+/// device: the correspondence search, the 6x6 solve, the update of the
+/// transformation and the convergence test run as one CUDA graph replayed
+/// every iteration, and the host only polls for convergence every few
+/// iterations. The correspondences are searched in a uniform grid of cell
+/// \p max_correspondence_distance instead of a KD-tree, which is exact and
+/// builds faster. Only TransformationEstimationPointToPoint and
+/// TransformationEstimationPointToPlane are supported.
+RegistrationResult RegistrationICPOnDevice(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+RegistrationResult RegistrationICPOnDevice(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// Coarse to fine ICP. Level i downsamples both clouds with
+/// \p voxel_sizes[i] (0 keeps the full clouds) and runs ICP with
+/// \p max_correspondence_distances[i] and \p criteria[i]. The voxel sizes
+/// must be decreasing; each level is downsampled from the next finer one,
+/// so the pyramid is built with one pass per level. The transformation of a
+/// level initializes the next, and all the levels share one workspace. For
+/// the estimations that need normals, the levels without normals get them
+/// estimated within twice their voxel size.
+RegistrationResult RegistrationMultiScaleICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const std::vector<float> &voxel_sizes,
+        const std::vector<ICPConvergenceCriteria> &criteria,
+        const std::vector<float> &max_correspondence_distances,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint());
+
+RegistrationResult RegistrationMultiScaleICP(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const std::vector<float> &voxel_sizes,
+        const std::vector<ICPConvergenceCriteria> &criteria,
+        const std::vector<float> &max_correspondence_distances,
+        const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint());
+
+/// ICP on many independent (source, target) pairs at once. The clouds of
+/// all the pairs are concatenated, the targets share one grid index keyed
+/// by pair and cell, and every iteration runs one search, one segmented
+/// reduction and one per pair solve for all the pairs, with the loop kept
+/// on the device as in RegistrationICPOnDevice(). A pair stops moving once
+/// it meets \p criteria. \p inits is either empty (identity for every
+/// pair) or has one matrix per pair. Only
+/// TransformationEstimationPointToPoint and
+/// TransformationEstimationPointToPlane are supported. Meant for many small
+/// pairs; a large pair is better served by RegistrationICP().
+std::vector<RegistrationResult> RegistrationICPBatch(
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &sources,
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u> &inits =
+                std::vector<Eigen::Matrix4f_u>(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+std::vector<RegistrationResult> RegistrationICPBatch(
+        utility::ExecutionContext &ctx,
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &sources,
+        const std::vector<std::shared_ptr<geometry::PointCloud>> &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u> &inits =
+                std::vector<Eigen::Matrix4f_u>(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// Same as above for the clouds of two batches, cloud i of \p sources being
+/// aligned to cloud i of \p targets, without concatenating them again.
+std::vector<RegistrationResult> RegistrationICPBatch(
+        utility::ExecutionContext &ctx,
+        const geometry::PointCloudBatch &sources,
+        const geometry::PointCloudBatch &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u> &inits =
+                std::vector<Eigen::Matrix4f_u>(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+std::vector<RegistrationResult> RegistrationICPBatch(
+        const geometry::PointCloudBatch &sources,
+        const geometry::PointCloudBatch &targets,
+        float max_correspondence_distance,
+        const std::vector<Eigen::Matrix4f_u> &inits =
+                std::vector<Eigen::Matrix4f_u>(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// Information matrix of the alignment of \p source by \p transformation
+/// to \p target, sum_i G_i^T G_i over the correspondences within
+/// \p max_correspondence_distance, where G_i is the Jacobian of the target
+/// point of correspondence i for a (rotation, translation) perturbation.
+/// Used as the information of a PoseGraphEdge.
+Eigen::Matrix6f GetInformationMatrixFromPointClouds(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        float max_correspondence_distance,
+        const Eigen::Matrix4f &transformation);
+
+/// Same as GetInformationMatrixFromPointClouds() from the correspondences
+/// of \p result, without a second search. \p result must come from a
+/// registration against \p target with its correspondence set kept; its
+/// correspondences lie within the max correspondence distance of the last
+/// iteration.
+Eigen::Matrix6f GetInformationMatrixFromRegistrationResult(
+        const geometry::PointCloud &target, const RegistrationResult &result);
+
+/// \class ICPRegistrator
+///
+/// \brief Stateful ICP for registering many sources against one target.
+///
+/// The target, its KD-tree and the scratch buffers are kept between calls,
+/// so the cost of Register() is only the correspondence search and the
+/// solve.
+class ICPRegistrator {
+public:
+    ICPRegistrator(float max_correspondence_distance,
+                   const ICPConvergenceCriteria &criteria =
+                           ICPConvergenceCriteria());
+    ICPRegistrator(utility::ExecutionContext &ctx,
+                   float max_correspondence_distance,
+                   const ICPConvergenceCriteria &criteria =
+                           ICPConvergenceCriteria());
+    ~ICPRegistrator();
+    ICPRegistrator(const ICPRegistrator &) = delete;
+    ICPRegistrator &operator=(const ICPRegistrator &) = delete;
+
+public:
+    /// Copies \p target and builds its KD-tree. If \p estimate_normals is
+    /// true and the target has no normals, they are estimated once here.
+    void SetTarget(const geometry::PointCloud &target,
+                   bool estimate_normals = false);
+    bool HasTarget() const;
+    const geometry::PointCloud &GetTarget() const { return *target_; }
+
+    /// Sets the transformation estimation used by Register(source, init).
+    void SetTransformationEstimation(
+            const std::shared_ptr<TransformationEstimation> &estimation) {
+        estimation_ = estimation;
+    }
+
+    RegistrationResult Register(
+            const geometry::PointCloud &source,
+            const Eigen::Matrix4f &init = Eigen::Matrix4f::Identity());
+    RegistrationResult Register(const geometry::PointCloud &source,
+                                const Eigen::Matrix4f &init,
+                                const TransformationEstimation &estimation);
+
+public:
+    float max_correspondence_distance_;
+    ICPConvergenceCriteria criteria_;
+    /// If false, RegistrationResult::correspondence_set_ is left empty and
+    /// point-to-point / point-to-plane iterations never build it.
+    bool compute_correspondence_set_ = true;
+    /// Filters of the correspondences of every iteration.
+    CorrespondenceRejection rejection_;
+
+private:
+    utility::ExecutionContext *context_;
+    std::unique_ptr<geometry::PointCloud> target_;
+    std::unique_ptr<geometry::KDTreeFlann> kdtree_;
+    std::shared_ptr<TransformationEstimation> estimation_;
+    utility::Workspace workspace_;
+};
+
 }  // namespace registration
 }  // namespace cupoch
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cmath>
+
+namespace cupoch {
+namespace registration {
+
+enum class RobustKernelType {
+    L2 = 0,
+    Huber = 1,
+    Tukey = 2,
+    Cauchy = 3,
+};
+
+/// \class RobustKernel
+///
+/// \brief Robust loss of the residuals, applied by iteratively reweighted
+/// least squares.
+///
+/// Weight() is the IRLS weight rho'(r) / r of the loss rho. The kernel is a
+/// plain value type without virtual functions, so the estimations evaluate
+/// it inside their per-correspondence reduction in device code.
+class RobustKernel {
+public:
+    RobustKernel(RobustKernelType type = RobustKernelType::L2, float k = 1.0)
+        : type_(type), k_(k) {}
+
+public:
+    __host__ __device__ float Weight(float residual) const {
+        const float abs_r = fabsf(residual);
+        switch (type_) {
+            case RobustKernelType::Huber:
+                return (abs_r <= k_) ? 1.0 : k_ / abs_r;
+            case RobustKernelType::Tukey: {
+                if (abs_r > k_) return 0.0;
+                const float t = 1.0 - (residual * residual) / (k_ * k_);
+                return t * t;
+            }
+            case RobustKernelType::Cauchy:
+                return 1.0 / (1.0 + (residual * residual) / (k_ * k_));
+            default:
+                return 1.0;
+        }
+    }
+    bool IsL2() const { return type_ == RobustKernelType::L2; }
+
+public:
+    RobustKernelType type_;
+    /// Scale of the residuals, beyond which they are down-weighted.
+    float k_;
+};
+
+}  // namespace registration
+}  // namespace cupoch
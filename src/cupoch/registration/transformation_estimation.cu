@@ -50,15 +50,18 @@ struct pt2pl_jacobian_residual_functor
     pt2pl_jacobian_residual_functor(const Eigen::Vector3f *source,
                                     const Eigen::Vector3f *target_points,
                                     const Eigen::Vector3f *target_normals,
-                                    const Eigen::Vector2i *corres)
+                                    const Eigen::Vector2i *corres,
+                                    const RobustKernel &kernel)
         : source_(source),
           target_points_(target_points),
           target_normals_(target_normals),
-          corres_(corres){};
+          corres_(corres),
+          kernel_(kernel){};
     const Eigen::Vector3f *source_;
     const Eigen::Vector3f *target_points_;
     const Eigen::Vector3f *target_normals_;
     const Eigen::Vector2i *corres_;
+    const RobustKernel kernel_;
     __device__ void operator()(int idx, Eigen::Vector6f &vec, float &r) const {
         const Eigen::Vector3f &vs = source_[corres_[idx][0]];
         const Eigen::Vector3f &vt = target_points_[corres_[idx][1]];
@@ -66,6 +69,100 @@ struct pt2pl_jacobian_residual_functor
         r = (vs - vt).dot(nt);
         vec.block<3, 1>(0, 0) = vs.cross(nt);
         vec.block<3, 1>(3, 0) = nt;
+        // The square root of the IRLS weight on both factors weights the
+        // outer products by it.
+        const float sqrt_w = sqrt(kernel_.Weight(r));
+        vec *= sqrt_w;
+        r *= sqrt_w;
+    }
+};
+
+// Cholesky factor L of the inverse of C_s + C_t, so that the Mahalanobis
+// distance d^T (C_s + C_t)^-1 d is |L^T d|^2.
+__device__ Eigen::Matrix3f GICPInformationFactor(const Eigen::Vector3f &ns,
+                                                 const Eigen::Vector3f &nt,
+                                                 float epsilon) {
+    const Eigen::Matrix3f cov =
+            2.0 * Eigen::Matrix3f::Identity() -
+            (1.0 - epsilon) * (ns * ns.transpose() + nt * nt.transpose());
+    const Eigen::Matrix3f info = cov.inverse();
+    Eigen::Matrix3f l = Eigen::Matrix3f::Zero();
+    l(0, 0) = sqrt(info(0, 0));
+    l(1, 0) = info(1, 0) / l(0, 0);
+    l(2, 0) = info(2, 0) / l(0, 0);
+    l(1, 1) = sqrt(info(1, 1) - l(1, 0) * l(1, 0));
+    l(2, 1) = (info(2, 1) - l(2, 0) * l(1, 0)) / l(1, 1);
+    l(2, 2) = sqrt(info(2, 2) - l(2, 0) * l(2, 0) - l(2, 1) * l(2, 1));
+    return l;
+}
+
+struct diff_square_gicp_functor {
+    diff_square_gicp_functor(const Eigen::Vector3f *source_points,
+                             const Eigen::Vector3f *source_normals,
+                             const Eigen::Vector3f *target_points,
+                             const Eigen::Vector3f *target_normals,
+                             const Eigen::Vector2i *corres,
+                             float epsilon)
+        : source_points_(source_points),
+          source_normals_(source_normals),
+          target_points_(target_points),
+          target_normals_(target_normals),
+          corres_(corres),
+          epsilon_(epsilon){};
+    const Eigen::Vector3f *source_points_;
+    const Eigen::Vector3f *source_normals_;
+    const Eigen::Vector3f *target_points_;
+    const Eigen::Vector3f *target_normals_;
+    const Eigen::Vector2i *corres_;
+    const float epsilon_;
+    __device__ float operator()(size_t idx) const {
+        const int is = corres_[idx][0];
+        const int it = corres_[idx][1];
+        const Eigen::Matrix3f l = GICPInformationFactor(
+                source_normals_[is], target_normals_[it], epsilon_);
+        return (l.transpose() * (source_points_[is] - target_points_[it]))
+                .squaredNorm();
+    }
+};
+
+struct gicp_jacobian_residual_functor {
+    gicp_jacobian_residual_functor(const Eigen::Vector3f *source_points,
+                                   const Eigen::Vector3f *source_normals,
+                                   const Eigen::Vector3f *target_points,
+                                   const Eigen::Vector3f *target_normals,
+                                   const Eigen::Vector2i *corres,
+                                   float epsilon)
+        : source_points_(source_points),
+          source_normals_(source_normals),
+          target_points_(target_points),
+          target_normals_(target_normals),
+          corres_(corres),
+          epsilon_(epsilon){};
+    const Eigen::Vector3f *source_points_;
+    const Eigen::Vector3f *source_normals_;
+    const Eigen::Vector3f *target_points_;
+    const Eigen::Vector3f *target_normals_;
+    const Eigen::Vector2i *corres_;
+    const float epsilon_;
+    // The three rows of L^T J and L^T d, whose outer products sum to the
+    // Mahalanobis weighted J^T M J and J^T M d.
+    __device__ void operator()(int idx,
+                               Eigen::Vector6f *vec,
+                               float *r) const {
+        const int is = corres_[idx][0];
+        const int it = corres_[idx][1];
+        const Eigen::Vector3f &vs = source_points_[is];
+        const Eigen::Vector3f d = vs - target_points_[it];
+        const Eigen::Matrix3f l = GICPInformationFactor(
+                source_normals_[is], target_normals_[it], epsilon_);
+        Eigen::Vector6f jac[3];
+        jac[0] << 0.0, vs(2), -vs(1), 1.0, 0.0, 0.0;
+        jac[1] << -vs(2), 0.0, vs(0), 0.0, 1.0, 0.0;
+        jac[2] << vs(1), -vs(0), 0.0, 0.0, 0.0, 1.0;
+        for (int k = 0; k < 3; ++k) {
+            vec[k] = l(0, k) * jac[0] + l(1, k) * jac[1] + l(2, k) * jac[2];
+            r[k] = l(0, k) * d(0) + l(1, k) * d(1) + l(2, k) * d(2);
+        }
     }
 };
 
@@ -124,7 +221,7 @@ Eigen::Matrix4f TransformationEstimationPointToPlane::ComputeTransformation(
             thrust::raw_pointer_cast(source.points_.data()),
             thrust::raw_pointer_cast(target.points_.data()),
             thrust::raw_pointer_cast(target.normals_.data()),
-            thrust::raw_pointer_cast(corres.data()));
+            thrust::raw_pointer_cast(corres.data()), kernel_);
     thrust::tie(JTJ, JTr, r2) =
             utility::ComputeJTJandJTr<Eigen::Matrix6f, Eigen::Vector6f,
                                       pt2pl_jacobian_residual_functor>(
@@ -136,4 +233,51 @@ Eigen::Matrix4f TransformationEstimationPointToPlane::ComputeTransformation(
             utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ, JTr);
 
     return is_success ? extrinsic : Eigen::Matrix4f::Identity();
-}
\ No newline at end of file
+}
+
+float TransformationEstimationForGeneralizedICP::ComputeRMSE(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres) const {
+    if (corres.empty() || !source.HasNormals() || !target.HasNormals())
+        return 0.0;
+    diff_square_gicp_functor func(
+            thrust::raw_pointer_cast(source.points_.data()),
+            thrust::raw_pointer_cast(source.normals_.data()),
+            thrust::raw_pointer_cast(target.points_.data()),
+            thrust::raw_pointer_cast(target.normals_.data()),
+            thrust::raw_pointer_cast(corres.data()), epsilon_);
+    const float err = thrust::transform_reduce(
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(corres.size()), func, 0.0f,
+            thrust::plus<float>());
+    return std::sqrt(err / (float)corres.size());
+}
+
+Eigen::Matrix4f TransformationEstimationForGeneralizedICP::ComputeTransformation(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres) const {
+    if (corres.empty() || !source.HasNormals() || !target.HasNormals())
+        return Eigen::Matrix4f::Identity();
+
+    Eigen::Matrix6f JTJ;
+    Eigen::Vector6f JTr;
+    float r2;
+    gicp_jacobian_residual_functor func(
+            thrust::raw_pointer_cast(source.points_.data()),
+            thrust::raw_pointer_cast(source.normals_.data()),
+            thrust::raw_pointer_cast(target.points_.data()),
+            thrust::raw_pointer_cast(target.normals_.data()),
+            thrust::raw_pointer_cast(corres.data()), epsilon_);
+    thrust::tie(JTJ, JTr, r2) =
+            utility::ComputeJTJandJTr<Eigen::Matrix6f, Eigen::Vector6f, 3>(
+                    func, (int)corres.size());
+
+    bool is_success;
+    Eigen::Matrix4f extrinsic;
+    thrust::tie(is_success, extrinsic) =
+            utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ, JTr);
+
+    return is_success ? extrinsic : Eigen::Matrix4f::Identity();
+}
@@ -3,6 +3,7 @@
 #include <Eigen/Core>
 #include <memory>
 
+#include "cupoch/registration/robust_kernel.h"
 #include "cupoch/utility/device_vector.h"
 
 namespace cupoch {
@@ -20,6 +21,7 @@ enum class TransformationEstimationType {
     PointToPoint = 1,
     PointToPlane = 2,
     ColoredICP = 3,
+    GeneralizedICP = 4,
 };
 
 /// Base class that estimates a transformation between two point clouds
@@ -66,10 +68,13 @@ private:
             TransformationEstimationType::PointToPoint;
 };
 
-/// Estimate a transformation for point to plane distance
+/// Estimate a transformation for point to plane distance. The residuals are
+/// weighted by \p kernel, which is L2 by default.
 class TransformationEstimationPointToPlane : public TransformationEstimation {
 public:
-    TransformationEstimationPointToPlane() {}
+    TransformationEstimationPointToPlane(
+            const RobustKernel &kernel = RobustKernel())
+        : kernel_(kernel) {}
     ~TransformationEstimationPointToPlane() override {}
 
 public:
@@ -85,10 +90,50 @@ public:
             const geometry::PointCloud &target,
             const CorrespondenceSet &corres) const override;
 
+public:
+    RobustKernel kernel_;
+
 private:
     const TransformationEstimationType type_ =
             TransformationEstimationType::PointToPlane;
 };
 
+/// Estimate a transformation for the plane to plane distance of
+/// Generalized ICP (A. Segal, D. Haehnel, S. Thrun, RSS 2009).
+///
+/// The covariance of every point is the plane covariance
+/// I - (1 - epsilon) n n^T of its normal, i.e. the covariance of its
+/// neighborhood with the eigenvalues regularized to (epsilon, 1, 1). It is
+/// built from the normals inside the reduction, so both clouds only need
+/// normals estimated by EstimateNormals().
+class TransformationEstimationForGeneralizedICP
+    : public TransformationEstimation {
+public:
+    TransformationEstimationForGeneralizedICP(float epsilon = 1e-3)
+        : epsilon_(epsilon) {}
+    ~TransformationEstimationForGeneralizedICP() override {}
+
+public:
+    TransformationEstimationType GetTransformationEstimationType()
+            const override {
+        return type_;
+    };
+    /// Root mean of the squared Mahalanobis distances.
+    float ComputeRMSE(const geometry::PointCloud &source,
+                      const geometry::PointCloud &target,
+                      const CorrespondenceSet &corres) const override;
+    Eigen::Matrix4f ComputeTransformation(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const override;
+
+public:
+    float epsilon_;
+
+private:
+    const TransformationEstimationType type_ =
+            TransformationEstimationType::GeneralizedICP;
+};
+
 }  // namespace registration
 }  // namespace cupoch
\ No newline at end of file
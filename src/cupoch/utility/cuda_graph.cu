@@ -0,0 +1,58 @@
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/cuda_graph.h"
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+CUDAGraph::CUDAGraph() {
+    cudaSafeCall(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+    cudaSafeCall(cudaEventCreateWithFlags(&before_, cudaEventDisableTiming));
+    cudaSafeCall(cudaEventCreateWithFlags(&after_, cudaEventDisableTiming));
+}
+
+CUDAGraph::~CUDAGraph() {
+    Reset();
+    cudaEventDestroy(after_);
+    cudaEventDestroy(before_);
+    cudaStreamDestroy(stream_);
+}
+
+bool CUDAGraph::Capture(const std::function<void(cudaStream_t)> &func) {
+    Reset();
+    cudaGraph_t graph;
+    cudaSafeCall(
+            cudaStreamBeginCapture(stream_, cudaStreamCaptureModeThreadLocal));
+    func(stream_);
+    const cudaError_t err = cudaStreamEndCapture(stream_, &graph);
+    if (err != cudaSuccess) {
+        utility::LogWarning("[CUDAGraph] Capture failed: {}.",
+                            cudaGetErrorString(err));
+        cudaGetLastError();
+        return false;
+    }
+    cudaSafeCall(cudaGraphInstantiate(&exec_, graph, NULL, NULL, 0));
+    cudaSafeCall(cudaGraphDestroy(graph));
+    return true;
+}
+
+bool CUDAGraph::Launch(ExecutionContext &ctx) {
+    if (!IsCaptured()) {
+        utility::LogWarning("[CUDAGraph] Nothing has been captured.");
+        return false;
+    }
+    cudaSafeCall(cudaEventRecord(before_, ctx.GetStream()));
+    cudaSafeCall(cudaStreamWaitEvent(stream_, before_, 0));
+    cudaSafeCall(cudaGraphLaunch(exec_, stream_));
+    cudaSafeCall(cudaEventRecord(after_, stream_));
+    cudaSafeCall(cudaStreamWaitEvent(ctx.GetStream(), after_, 0));
+    return true;
+}
+
+void CUDAGraph::Reset() {
+    if (exec_) {
+        cudaGraphExecDestroy(exec_);
+        exec_ = nullptr;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cuda_runtime.h>
+
+#include <functional>
+
+namespace cupoch {
+namespace utility {
+
+class ExecutionContext;
+
+/// \class CUDAGraph
+///
+/// \brief Work of a fixed shape recorded once as a CUDA graph and replayed.
+///
+/// Replaying a graph costs one launch instead of one per kernel, which
+/// dominates for small inputs. Only stream ordered work that neither
+/// synchronizes with the host nor allocates can be recorded: kernels, cub
+/// calls with preallocated temporaries and asynchronous copies. Thrust
+/// algorithms synchronize and cannot be recorded. The recorded work reads
+/// and writes the same buffers on every replay, so the inputs are updated
+/// in place between two replays.
+///
+/// The graph is recorded and replayed on a stream owned by the object and
+/// ordered after and before the stream given to Launch(), so it also works
+/// with the legacy default stream, which cannot be captured.
+class CUDAGraph {
+public:
+    CUDAGraph();
+    ~CUDAGraph();
+    CUDAGraph(const CUDAGraph &) = delete;
+    CUDAGraph &operator=(const CUDAGraph &) = delete;
+
+public:
+    /// Records the work enqueued by \p func on the stream it is given.
+    /// Replaces the previous recording.
+    bool Capture(const std::function<void(cudaStream_t)> &func);
+    /// Replays the recording after the work queued on \p ctx, and makes
+    /// \p ctx wait for it.
+    bool Launch(ExecutionContext &ctx);
+    bool IsCaptured() const { return exec_ != nullptr; }
+    void Reset();
+
+private:
+    cudaStream_t stream_;
+    cudaEvent_t before_;
+    cudaEvent_t after_;
+    cudaGraphExec_t exec_ = nullptr;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,10 @@
+#include "cupoch/utility/device_hash_map.inl"
+
+namespace cupoch {
+namespace utility {
+
+template class device_hash_map<unsigned int, int>;
+template class device_hash_map<unsigned long long, int>;
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <thrust/pair.h>
+
+#include <type_traits>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace utility {
+
+/// \struct device_hash_map_view
+///
+/// \brief Device side handle of a device_hash_map, copied by value into
+/// kernels and functors.
+///
+/// The operations are lock free, with one atomicCAS per probed slot. Inserts
+/// and finds may run in the same kernel, a find racing with the insert of
+/// its key seeing the slot before its value is written, but erase must not
+/// race with inserts of the same key. A view is invalidated by the rehash of
+/// its map.
+template <typename Key, typename Value>
+struct device_hash_map_view {
+    static constexpr Key kEmptyKey = ~Key(0);
+    static constexpr Key kErasedKey = ~Key(0) - 1;
+
+    /// Slot of \p key, -1 if it is not in the map.
+    __device__ int find_slot(Key key) const;
+    /// Value of \p key, nullptr if it is not in the map.
+    __device__ Value *find(Key key) const;
+    /// Slot of \p key, claimed if it was not in the map. The second element
+    /// is true if the slot was claimed by this call. The slot is -1 if the
+    /// table is full.
+    __device__ thrust::pair<int, bool> insert_slot(Key key) const;
+    /// Inserts \p key with \p value, keeping the value of a key already in
+    /// the map. Returns true if the key was inserted.
+    __device__ bool insert(Key key, const Value &value) const;
+    /// Returns true if \p key was in the map.
+    __device__ bool erase(Key key) const;
+
+    Key *keys_;
+    Value *values_;
+    unsigned int mask_;
+    /// Number of keys and of erased slots.
+    unsigned long long *counters_;
+};
+
+/// \class device_hash_map
+///
+/// \brief Open addressing hash map on the device with linear probing.
+///
+/// The keys are 32 or 64 bit unsigned integers, such as the cells packed by
+/// PackCellKey or Morton codes, the two largest values being reserved for
+/// the empty and erased slots. The bulk operations run one thread per key
+/// and grow the table so that its load stays at most 1/2, erased slots
+/// included. The keys and values are kept in the parallel arrays keys_ and
+/// values_, so the occupied slots can be iterated with occupied_slots().
+/// Kernels use view() to find, insert and erase single keys.
+template <typename Key, typename Value>
+class device_hash_map {
+public:
+    static_assert(std::is_same<Key, unsigned int>::value ||
+                          std::is_same<Key, unsigned long long>::value,
+                  "device_hash_map keys must be unsigned int or unsigned "
+                  "long long, the types of atomicCAS.");
+    typedef device_hash_map_view<Key, Value> view_type;
+
+    /// The table holds \p capacity keys before its first rehash.
+    explicit device_hash_map(size_t capacity = 0);
+
+public:
+    /// Number of keys, read from the device.
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t bucket_count() const { return keys_.size(); }
+    void clear();
+    /// Rehashes the table, dropping the erased slots, so that \p n keys fit
+    /// at a load of 1/2.
+    void rehash(size_t n);
+    /// Rehashes the table only if \p n keys do not fit.
+    void reserve(size_t n);
+
+    /// Inserts \p keys with \p values, keeping the values of the keys
+    /// already in the map. Returns the number of inserted keys.
+    size_t insert(const utility::device_vector<Key> &keys,
+                  const utility::device_vector<Value> &values);
+    /// Values of \p keys, \p default_value for the keys not in the map.
+    utility::device_vector<Value> find(const utility::device_vector<Key> &keys,
+                                       const Value &default_value) const;
+    utility::device_vector<bool> contains(
+            const utility::device_vector<Key> &keys) const;
+    /// Returns the number of erased keys.
+    size_t erase(const utility::device_vector<Key> &keys);
+
+    /// Slots of the keys, in increasing order.
+    utility::device_vector<int> occupied_slots() const;
+    /// Keys and values in slot order.
+    void retrieve_all(utility::device_vector<Key> &keys,
+                      utility::device_vector<Value> &values) const;
+
+    /// The view is valid until the next rehash, and the view of a const map
+    /// must only be used to find keys.
+    view_type view() const;
+
+public:
+    utility::device_vector<Key> keys_;
+    utility::device_vector<Value> values_;
+
+private:
+    size_t num_erased() const;
+    utility::device_vector<unsigned long long> counters_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/transform.h>
+
+#include <algorithm>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/device_hash_map.h"
+#include "cupoch/utility/helper.h"
+
+namespace cupoch {
+namespace utility {
+
+template <typename Key, typename Value>
+constexpr Key device_hash_map_view<Key, Value>::kEmptyKey;
+
+template <typename Key, typename Value>
+constexpr Key device_hash_map_view<Key, Value>::kErasedKey;
+
+template <typename Key, typename Value>
+__device__ inline int device_hash_map_view<Key, Value>::find_slot(
+        Key key) const {
+    if (key >= kErasedKey) return -1;
+    unsigned int slot = HashCellKey(key) & mask_;
+    for (unsigned int i = 0; i <= mask_; ++i) {
+        const Key k = keys_[slot];
+        if (k == key) return slot;
+        if (k == kEmptyKey) return -1;
+        slot = (slot + 1) & mask_;
+    }
+    return -1;
+}
+
+template <typename Key, typename Value>
+__device__ inline Value *device_hash_map_view<Key, Value>::find(
+        Key key) const {
+    const int slot = find_slot(key);
+    return (slot < 0) ? nullptr : values_ + slot;
+}
+
+template <typename Key, typename Value>
+__device__ inline thrust::pair<int, bool>
+device_hash_map_view<Key, Value>::insert_slot(Key key) const {
+    if (key >= kErasedKey) return thrust::make_pair(-1, false);
+    unsigned int slot = HashCellKey(key) & mask_;
+    for (unsigned int i = 0; i <= mask_; ++i) {
+        const Key prev = atomicCAS(&keys_[slot], kEmptyKey, key);
+        if (prev == kEmptyKey) {
+            atomicAdd(&counters_[0], 1ull);
+            return thrust::make_pair(int(slot), true);
+        }
+        if (prev == key) return thrust::make_pair(int(slot), false);
+        slot = (slot + 1) & mask_;
+    }
+    return thrust::make_pair(-1, false);
+}
+
+template <typename Key, typename Value>
+__device__ inline bool device_hash_map_view<Key, Value>::insert(
+        Key key, const Value &value) const {
+    const thrust::pair<int, bool> res = insert_slot(key);
+    if (res.second) values_[res.first] = value;
+    return res.second;
+}
+
+template <typename Key, typename Value>
+__device__ inline bool device_hash_map_view<Key, Value>::erase(
+        Key key) const {
+    const int slot = find_slot(key);
+    if (slot < 0 || atomicCAS(&keys_[slot], key, kErasedKey) != key) {
+        return false;
+    }
+    atomicAdd(&counters_[0], ~0ull);
+    atomicAdd(&counters_[1], 1ull);
+    return true;
+}
+
+namespace {
+
+template <typename Key, typename Value>
+struct insert_hash_map_functor {
+    insert_hash_map_functor(const device_hash_map_view<Key, Value> &view)
+        : view_(view){};
+    const device_hash_map_view<Key, Value> view_;
+    __device__ void operator()(const thrust::tuple<Key, Value> &x) const {
+        view_.insert(thrust::get<0>(x), thrust::get<1>(x));
+    }
+};
+
+template <typename Key, typename Value>
+struct find_hash_map_functor {
+    find_hash_map_functor(const device_hash_map_view<Key, Value> &view,
+                          const Value &default_value)
+        : view_(view), default_value_(default_value){};
+    const device_hash_map_view<Key, Value> view_;
+    const Value default_value_;
+    __device__ Value operator()(Key key) const {
+        const Value *value = view_.find(key);
+        return (value) ? *value : default_value_;
+    }
+};
+
+template <typename Key, typename Value>
+struct contains_hash_map_functor {
+    contains_hash_map_functor(const device_hash_map_view<Key, Value> &view)
+        : view_(view){};
+    const device_hash_map_view<Key, Value> view_;
+    __device__ bool operator()(Key key) const {
+        return view_.find_slot(key) >= 0;
+    }
+};
+
+template <typename Key, typename Value>
+struct erase_hash_map_functor {
+    erase_hash_map_functor(const device_hash_map_view<Key, Value> &view)
+        : view_(view){};
+    const device_hash_map_view<Key, Value> view_;
+    __device__ void operator()(Key key) const { view_.erase(key); }
+};
+
+template <typename Key>
+struct is_occupied_hash_slot_functor {
+    __device__ bool operator()(Key key) const {
+        return key < device_hash_map_view<Key, int>::kErasedKey;
+    }
+};
+
+}  // namespace
+
+template <typename Key, typename Value>
+device_hash_map<Key, Value>::device_hash_map(size_t capacity)
+    : counters_(2, 0) {
+    rehash(capacity);
+}
+
+template <typename Key, typename Value>
+size_t device_hash_map<Key, Value>::size() const {
+    return counters_[0];
+}
+
+template <typename Key, typename Value>
+size_t device_hash_map<Key, Value>::num_erased() const {
+    return counters_[1];
+}
+
+template <typename Key, typename Value>
+void device_hash_map<Key, Value>::clear() {
+    thrust::fill(keys_.begin(), keys_.end(), view_type::kEmptyKey);
+    thrust::fill(counters_.begin(), counters_.end(), 0);
+}
+
+template <typename Key, typename Value>
+void device_hash_map<Key, Value>::rehash(size_t n) {
+    const size_t n_keys = std::max(n, size());
+    size_t capacity = 1;
+    while (capacity < 2 * n_keys) capacity <<= 1;
+    utility::device_vector<Key> old_keys(capacity, view_type::kEmptyKey);
+    utility::device_vector<Value> old_values(capacity);
+    old_keys.swap(keys_);
+    old_values.swap(values_);
+    thrust::fill(counters_.begin(), counters_.end(), 0);
+    thrust::for_each(make_tuple_begin(old_keys, old_values),
+                     make_tuple_end(old_keys, old_values),
+                     insert_hash_map_functor<Key, Value>(view()));
+}
+
+template <typename Key, typename Value>
+void device_hash_map<Key, Value>::reserve(size_t n) {
+    if (2 * (n + num_erased()) > bucket_count()) rehash(n);
+}
+
+template <typename Key, typename Value>
+size_t device_hash_map<Key, Value>::insert(
+        const utility::device_vector<Key> &keys,
+        const utility::device_vector<Value> &values) {
+    if (keys.size() != values.size()) {
+        utility::LogError(
+                "[device_hash_map::insert] keys and values must have the "
+                "same size.");
+    }
+    const size_t n_prev = size();
+    reserve(n_prev + keys.size());
+    thrust::for_each(make_tuple_begin(keys, values),
+                     make_tuple_end(keys, values),
+                     insert_hash_map_functor<Key, Value>(view()));
+    return size() - n_prev;
+}
+
+template <typename Key, typename Value>
+utility::device_vector<Value> device_hash_map<Key, Value>::find(
+        const utility::device_vector<Key> &keys,
+        const Value &default_value) const {
+    utility::device_vector<Value> values(keys.size());
+    thrust::transform(keys.begin(), keys.end(), values.begin(),
+                      find_hash_map_functor<Key, Value>(view(),
+                                                        default_value));
+    return values;
+}
+
+template <typename Key, typename Value>
+utility::device_vector<bool> device_hash_map<Key, Value>::contains(
+        const utility::device_vector<Key> &keys) const {
+    utility::device_vector<bool> res(keys.size());
+    thrust::transform(keys.begin(), keys.end(), res.begin(),
+                      contains_hash_map_functor<Key, Value>(view()));
+    return res;
+}
+
+template <typename Key, typename Value>
+size_t device_hash_map<Key, Value>::erase(
+        const utility::device_vector<Key> &keys) {
+    const size_t n_prev = size();
+    thrust::for_each(keys.begin(), keys.end(),
+                     erase_hash_map_functor<Key, Value>(view()));
+    return n_prev - size();
+}
+
+template <typename Key, typename Value>
+utility::device_vector<int> device_hash_map<Key, Value>::occupied_slots()
+        const {
+    utility::device_vector<int> slots(size());
+    thrust::copy_if(thrust::make_counting_iterator<int>(0),
+                    thrust::make_counting_iterator<int>(bucket_count()),
+                    keys_.begin(), slots.begin(),
+                    is_occupied_hash_slot_functor<Key>());
+    return slots;
+}
+
+template <typename Key, typename Value>
+void device_hash_map<Key, Value>::retrieve_all(
+        utility::device_vector<Key> &keys,
+        utility::device_vector<Value> &values) const {
+    const size_t n = size();
+    keys.resize(n);
+    values.resize(n);
+    thrust::copy_if(make_tuple_begin(keys_, values_),
+                    make_tuple_end(keys_, values_), keys_.begin(),
+                    make_tuple_begin(keys, values),
+                    is_occupied_hash_slot_functor<Key>());
+}
+
+template <typename Key, typename Value>
+typename device_hash_map<Key, Value>::view_type
+device_hash_map<Key, Value>::view() const {
+    view_type v;
+    v.keys_ = const_cast<Key *>(thrust::raw_pointer_cast(keys_.data()));
+    v.values_ = const_cast<Value *>(thrust::raw_pointer_cast(values_.data()));
+    v.mask_ = keys_.size() - 1;
+    v.counters_ = const_cast<unsigned long long *>(
+            thrust::raw_pointer_cast(counters_.data()));
+    return v;
+}
+
+}  // namespace utility
+}  // namespace cupoch
@@ -6,18 +6,101 @@
 #else
 #include <thrust/device_vector.h>
 #endif
+#include <thrust/device_malloc_allocator.h>
 #include <thrust/host_vector.h>
+#ifndef CUPOCH_CPU_BACKEND
 #include <thrust/system/cuda/experimental/pinned_allocator.h>
+#endif
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "cupoch/utility/memory_resource.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/platform.h"
 
 namespace cupoch {
 namespace utility {
 
+#ifdef CUPOCH_CPU_BACKEND
+template<typename T>
+using pinned_host_vector = thrust::host_vector<T>;
+#else
 template<typename T>
 using pinned_host_vector = thrust::host_vector<T, thrust::cuda::experimental::pinned_allocator<T>>;
+#endif
+
+/// Device allocator taking the memory from the MemoryResource and on the
+/// allocation stream of its construction, and reporting the allocations to
+/// the memory tracker, which attributes them to the subsystem of the
+/// current ScopedMemorySubsystem. A failed allocation is retried as long as
+/// the out of memory handlers release memory, then throws OutOfMemoryError.
+template <typename T>
+class tracked_device_allocator : public thrust::device_malloc_allocator<T> {
+public:
+    using base = thrust::device_malloc_allocator<T>;
+    using pointer = typename base::pointer;
+    using size_type = typename base::size_type;
+    // The allocator moves with the memory it allocated.
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = tracked_device_allocator<U>;
+    };
+
+    tracked_device_allocator()
+        : resource_(GetMemoryResource()), stream_(GetAllocationStream()) {}
+    explicit tracked_device_allocator(MemoryResource *resource)
+        : resource_(resource), stream_(GetAllocationStream()) {}
+    template <typename U>
+    tracked_device_allocator(const tracked_device_allocator<U> &other)
+        : resource_(other.resource_), stream_(other.stream_) {}
+
+    pointer allocate(size_type n) {
+        const size_t bytes = n * sizeof(T);
+        void *ptr = nullptr;
+        for (int attempt = 0;; ++attempt) {
+            try {
+                ptr = resource_->Allocate(bytes, stream_);
+                break;
+            } catch (const std::bad_alloc &) {
+                if (!HandleOutOfMemory(bytes, attempt)) {
+                    throw OutOfMemoryError(
+                            "[device_vector] Out of memory allocating " +
+                            std::to_string(bytes) + " bytes.");
+                }
+            }
+        }
+        RecordDeviceAllocation(ptr, bytes);
+        return pointer(static_cast<T *>(ptr));
+    }
+
+    void deallocate(pointer ptr, size_type n) {
+        RecordDeviceDeallocation(thrust::raw_pointer_cast(ptr));
+        resource_->Deallocate(thrust::raw_pointer_cast(ptr), n * sizeof(T),
+                              stream_);
+    }
+
+    bool operator==(const tracked_device_allocator &other) const {
+        return resource_ == other.resource_ && stream_ == other.stream_;
+    }
+    bool operator!=(const tracked_device_allocator &other) const {
+        return !(*this == other);
+    }
+
+    MemoryResource *resource_;
+    cudaStream_t stream_;
+};
 
-#ifdef USE_RMM
 template <typename T>
-using device_vector = rmm::device_vector<T>;
+using device_vector = thrust::device_vector<T, tracked_device_allocator<T>>;
+
+#ifdef USE_RMM
 
 inline decltype(auto) exec_policy(cudaStream_t stream = 0) {
     return rmm::exec_policy(stream);
@@ -33,15 +116,26 @@ inline void InitializeAllocator(
     rmmOptions_t options = {mode, initial_pool_size, logging, devices};
     rmmInitialize(&options);
     is_initialized = true;
+    SetMemoryResource(std::make_shared<RmmMemoryResource>());
 }
 
 #else
-template <typename T>
-using device_vector = thrust::device_vector<T>;
+#ifdef CUPOCH_CPU_BACKEND
+/// Policy of the OpenMP or TBB device system of thrust cupoch_cpu is built
+/// on. The streams are ignored and the algorithms return once done.
+struct host_exec_policy {
+    decltype(auto) on(cudaStream_t stream) const { return thrust::device; }
+};
 
+inline const host_exec_policy *exec_policy(cudaStream_t stream = 0) {
+    static const host_exec_policy policy;
+    return &policy;
+}
+#else
 inline decltype(auto) exec_policy(cudaStream_t stream = 0) {
     return &thrust::cuda::par;
 }
+#endif
 
 inline void InitializeAllocator(
         rmmAllocationMode_t mode = CudaDefaultAllocation,
@@ -51,5 +145,71 @@ inline void InitializeAllocator(
 
 #endif
 
+/// Resizes \p dst and enqueues the download of \p src into it on \p stream.
+/// Being pinned, \p dst is written by the DMA engine while the host goes on;
+/// it must not be read before the stream is synchronized.
+template <typename T>
+void CopyToHostAsync(const device_vector<T> &src,
+                     pinned_host_vector<T> &dst,
+                     cudaStream_t stream = 0) {
+    dst.resize(src.size());
+    if (src.empty()) return;
+#ifdef CUPOCH_CPU_BACKEND
+    thrust::copy(src.begin(), src.end(), dst.begin());
+#else
+    cudaSafeCall(cudaMemcpyAsync(thrust::raw_pointer_cast(dst.data()),
+                                 thrust::raw_pointer_cast(src.data()),
+                                 src.size() * sizeof(T),
+                                 cudaMemcpyDeviceToHost, stream));
+#endif
+}
+
+/// Vector of \p n copies of \p value for the voxels of a dense volume,
+/// allocated from the volume memory resource if it is set.
+template <typename T>
+device_vector<T> MakeVolumeVector(size_t n, const T &value = T()) {
+    MemoryResource *resource = GetVolumeMemoryResource();
+    if (!resource) return device_vector<T>(n, value);
+    return device_vector<T>(n, value, tracked_device_allocator<T>(resource));
+}
+
+/// True if the memory of \p vec is accessible from the host, e.g. allocated
+/// by a MappedHostMemoryResource.
+template <typename T>
+bool IsHostAccessible(const device_vector<T> &vec) {
+    return vec.get_allocator().resource_->IsHostAccessible();
+}
+
+/// Uploads \p src into \p dst, with a memcpy on the host if \p dst is
+/// accessible from it, which is a copy within the DRAM shared by the host
+/// and an integrated GPU instead of a DMA transfer.
+template <typename T, typename Alloc>
+void CopyFromHost(const thrust::host_vector<T, Alloc> &src,
+                  device_vector<T> &dst) {
+    if (!IsHostAccessible(dst)) {
+        dst = src;
+        return;
+    }
+    dst.resize(src.size());
+#ifndef CUPOCH_CPU_BACKEND
+    // Waits for the resize and the kernels still using the old values.
+    cudaSafeCall(cudaDeviceSynchronize());
+#endif
+    if (src.empty()) return;
+    std::memcpy(thrust::raw_pointer_cast(dst.data()),
+                thrust::raw_pointer_cast(src.data()), src.size() * sizeof(T));
+}
+
+/// Downloads \p src, with a memcpy on the host if it is accessible from it.
+template <typename T>
+thrust::host_vector<T> CopyToHost(const device_vector<T> &src) {
+    if (!IsHostAccessible(src)) return thrust::host_vector<T>(src);
+#ifndef CUPOCH_CPU_BACKEND
+    cudaSafeCall(cudaDeviceSynchronize());
+#endif
+    const T *data = thrust::raw_pointer_cast(src.data());
+    return thrust::host_vector<T>(data, data + src.size());
+}
+
 }  // namespace utility
 }  // namespace cupoch
\ No newline at end of file
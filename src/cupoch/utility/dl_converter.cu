@@ -1,5 +1,6 @@
 #include <type_traits>
 
+#include "cupoch/utility/console.h"
 #include "cupoch/utility/dl_converter.h"
 #include "cupoch/utility/platform.h"
 
@@ -25,7 +26,9 @@ DLDataTypeCode GetDLDataTypeCode() {
 
 template <typename T, int Dim>
 struct DeviceVectorDLMTensor {
-    thrust::device_vector<Eigen::Matrix<T, Dim, 1>> handle;
+    /// Holds the data of the tensor when there is no owner.
+    utility::device_vector<Eigen::Matrix<T, Dim, 1>> handle;
+    std::shared_ptr<const void> owner;
     DLManagedTensor tensor;
 };
 
@@ -39,13 +42,19 @@ void deleter(DLManagedTensor *arg) {
 
 template <typename T, int Dim>
 DLManagedTensor *cupoch::utility::ToDLPack(
-        const utility::device_vector<Eigen::Matrix<T, Dim, 1>> &src) {
+        const utility::device_vector<Eigen::Matrix<T, Dim, 1>> &src,
+        std::shared_ptr<const void> owner) {
     DeviceVectorDLMTensor<T, Dim> *dvdl(new DeviceVectorDLMTensor<T, Dim>);
-    dvdl->handle = src;
+    const Eigen::Matrix<T, Dim, 1> *data = thrust::raw_pointer_cast(src.data());
+    if (owner) {
+        dvdl->owner = std::move(owner);
+    } else {
+        dvdl->handle = src;
+        data = thrust::raw_pointer_cast(dvdl->handle.data());
+    }
     dvdl->tensor.manager_ctx = dvdl;
     dvdl->tensor.deleter = &deleter<T, Dim>;
-    dvdl->tensor.dl_tensor.data = const_cast<void *>(
-            (const void *)(thrust::raw_pointer_cast(src.data())));
+    dvdl->tensor.dl_tensor.data = const_cast<void *>((const void *)data);
     int64_t device_id = GetDevice();
     DLContext ctx;
     ctx.device_id = device_id;
@@ -66,39 +75,61 @@ DLManagedTensor *cupoch::utility::ToDLPack(
     return &(dvdl->tensor);
 }
 
+template <typename T, int Dim>
+void cupoch::utility::FromDLPack(
+        const DLManagedTensor *src,
+        utility::device_vector<Eigen::Matrix<T, Dim, 1>> &dst) {
+    const DLTensor &tensor = src->dl_tensor;
+    if (tensor.ctx.device_type != DLDeviceType::kDLGPU) {
+        utility::LogError("[FromDLPack] The tensor is not on the GPU.");
+    }
+    if (tensor.ndim != 2 || tensor.shape[1] != Dim) {
+        utility::LogError("[FromDLPack] The tensor shape must be (N, {:d}).",
+                          Dim);
+    }
+    if (tensor.dtype.code != GetDLDataTypeCode<T>() ||
+        tensor.dtype.bits != sizeof(T) * 8 || tensor.dtype.lanes != 1) {
+        utility::LogError("[FromDLPack] Invalid data type of the tensor.");
+    }
+    if (tensor.strides != nullptr && tensor.shape[0] > 1 &&
+        (tensor.strides[0] != Dim || tensor.strides[1] != 1)) {
+        utility::LogError("[FromDLPack] The tensor must be contiguous.");
+    }
+    const size_t n = tensor.shape[0];
+    const char *data = (const char *)tensor.data + tensor.byte_offset;
+    if (dst.size() == n &&
+        data == (const char *)thrust::raw_pointer_cast(dst.data())) {
+        return;
+    }
+    dst.resize(n);
+    if (n == 0) return;
+    cudaSafeCall(cudaMemcpy(thrust::raw_pointer_cast(dst.data()), data,
+                            n * sizeof(Eigen::Matrix<T, Dim, 1>),
+                            cudaMemcpyDeviceToDevice));
+}
+
+template DLManagedTensor *cupoch::utility::ToDLPack(
+        const utility::device_vector<Eigen::Matrix<float, 2, 1>> &src,
+        std::shared_ptr<const void> owner);
 template DLManagedTensor *cupoch::utility::ToDLPack(
-        const utility::device_vector<Eigen::Matrix<float, 3, 1>> &src);
+        const utility::device_vector<Eigen::Matrix<float, 3, 1>> &src,
+        std::shared_ptr<const void> owner);
 template DLManagedTensor *cupoch::utility::ToDLPack(
-        const utility::device_vector<Eigen::Matrix<int, 2, 1>> &src);
+        const utility::device_vector<Eigen::Matrix<int, 2, 1>> &src,
+        std::shared_ptr<const void> owner);
 template DLManagedTensor *cupoch::utility::ToDLPack(
-        const utility::device_vector<Eigen::Matrix<int, 3, 1>> &src);
+        const utility::device_vector<Eigen::Matrix<int, 3, 1>> &src,
+        std::shared_ptr<const void> owner);
 
-template <>
-void cupoch::utility::FromDLPack(
+template void cupoch::utility::FromDLPack(
         const DLManagedTensor *src,
-        utility::device_vector<Eigen::Matrix<float, 3, 1>> &dst) {
-    dst.resize(src->dl_tensor.shape[0]);
-    auto base_ptr = thrust::device_pointer_cast(
-            (Eigen::Matrix<float, 3, 1> *)src->dl_tensor.data);
-    thrust::copy(base_ptr, base_ptr + src->dl_tensor.shape[0], dst.begin());
-}
-
-template <>
-void cupoch::utility::FromDLPack(
+        utility::device_vector<Eigen::Matrix<float, 2, 1>> &dst);
+template void cupoch::utility::FromDLPack(
         const DLManagedTensor *src,
-        utility::device_vector<Eigen::Matrix<int, 2, 1>> &dst) {
-    dst.resize(src->dl_tensor.shape[0]);
-    auto base_ptr = thrust::device_pointer_cast(
-            (Eigen::Matrix<int, 2, 1> *)src->dl_tensor.data);
-    thrust::copy(base_ptr, base_ptr + src->dl_tensor.shape[0], dst.begin());
-}
-
-template <>
-void cupoch::utility::FromDLPack(
+        utility::device_vector<Eigen::Matrix<float, 3, 1>> &dst);
+template void cupoch::utility::FromDLPack(
+        const DLManagedTensor *src,
+        utility::device_vector<Eigen::Matrix<int, 2, 1>> &dst);
+template void cupoch::utility::FromDLPack(
         const DLManagedTensor *src,
-        utility::device_vector<Eigen::Matrix<int, 3, 1>> &dst) {
-    dst.resize(src->dl_tensor.shape[0]);
-    auto base_ptr = thrust::device_pointer_cast(
-            (Eigen::Matrix<int, 3, 1> *)src->dl_tensor.data);
-    thrust::copy(base_ptr, base_ptr + src->dl_tensor.shape[0], dst.begin());
-}
\ No newline at end of file
+        utility::device_vector<Eigen::Matrix<int, 3, 1>> &dst);
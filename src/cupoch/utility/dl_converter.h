@@ -3,21 +3,30 @@
 #include <dlpack/dlpack.h>
 
 #include <Eigen/Core>
+#include <memory>
 
 #include "cupoch/utility/device_vector.h"
 
 namespace cupoch {
 namespace utility {
 
-// Zero copy
+/// Exports \p src as a DLPack tensor of shape (size, Dim).
+/// With an \p owner, the object holding \p src, the tensor shares the
+/// memory of \p src without a copy and keeps \p owner alive until its
+/// deleter runs; \p src must not be resized in the meantime. Without one
+/// the tensor holds a copy of \p src.
 template <typename T, int Dim>
 DLManagedTensor *ToDLPack(
-        const utility::device_vector<Eigen::Matrix<T, Dim, 1>> &src);
+        const utility::device_vector<Eigen::Matrix<T, Dim, 1>> &src,
+        std::shared_ptr<const void> owner = nullptr);
 
-// Copy
+/// Imports a contiguous (size, Dim) device tensor of matching type into
+/// \p dst in a single device copy, which is skipped when the tensor already
+/// is the memory of \p dst, e.g. exported from it by ToDLPack. The caller
+/// keeps the ownership of \p src.
 template <typename T, int Dim>
 void FromDLPack(const DLManagedTensor *src,
                 utility::device_vector<Eigen::Matrix<T, Dim, 1>> &dst);
 
 }  // namespace utility
-}  // namespace cupoch
\ No newline at end of file
+}  // namespace cupoch
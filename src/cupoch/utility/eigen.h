@@ -1,7 +1,9 @@
 #pragma once
+#include <cuda_runtime.h>
 #include <thrust/tuple.h>
 
 #include <Eigen/Core>
+#include <vector>
 
 namespace Eigen {
 
@@ -9,6 +11,7 @@ namespace Eigen {
 typedef Eigen::Matrix<float, 6, 6> Matrix6f;
 typedef Eigen::Matrix<float, 6, 1> Vector6f;
 
+typedef Eigen::Matrix<float, 4, 1, Eigen::DontAlign> Vector4f_u;
 typedef Eigen::Matrix<float, 4, 4, Eigen::DontAlign> Matrix4f_u;
 typedef Eigen::Matrix<float, 6, 6, Eigen::DontAlign> Matrix6f_u;
 
@@ -36,6 +39,68 @@ Eigen::Matrix4f TransformVector6fToMatrix4f(const Eigen::Vector6f &input);
 /// Function to transform 4D motion matrix to 6D motion vector
 Eigen::Vector6f TransformMatrix4fToVector6f(const Eigen::Matrix4f &input);
 
+/// Device version of TransformVector6fToMatrix4f().
+__device__ inline Eigen::Matrix4f DeviceVector6fToMatrix4f(
+        const Eigen::Vector6f &x) {
+    Eigen::Matrix4f output = Eigen::Matrix4f::Identity();
+    output.block<3, 1>(0, 3) = x.tail<3>();
+    const float th = x.head<3>().norm();
+    if (th == 0) return output;
+    const Eigen::Vector3f w = x.head<3>() / th;
+    const float cth = cos(th);
+    const float sth = sin(th);
+    Eigen::Matrix3f wx;
+    wx << 0.0, -w[2], w[1], w[2], 0.0, -w[0], -w[1], w[0], 0.0;
+    output.block<3, 3>(0, 0) = Eigen::Matrix3f::Identity() * cth +
+                               sth * wx +
+                               (1.0 - cth) * w * w.transpose();
+    return output;
+}
+
+/// In place Cholesky factorization of a symmetric positive definite 6x6
+/// matrix; the factor is left in the lower triangle. Returns false if \p a
+/// is not positive definite.
+__device__ inline bool CholeskyFactor6(Eigen::Matrix6f &a) {
+    for (int j = 0; j < 6; ++j) {
+        float d = a(j, j);
+        for (int k = 0; k < j; ++k) d -= a(j, k) * a(j, k);
+        if (d <= 0.0) return false;
+        a(j, j) = sqrt(d);
+        for (int i = j + 1; i < 6; ++i) {
+            float s = a(i, j);
+            for (int k = 0; k < j; ++k) s -= a(i, k) * a(j, k);
+            a(i, j) = s / a(j, j);
+        }
+    }
+    return true;
+}
+
+/// Solves L L^T x = b with the factor of CholeskyFactor6().
+__device__ inline void CholeskySolve6(const Eigen::Matrix6f &l,
+                                      const Eigen::Vector6f &b,
+                                      Eigen::Vector6f &x) {
+    for (int i = 0; i < 6; ++i) {
+        float s = b(i);
+        for (int k = 0; k < i; ++k) s -= l(i, k) * x(k);
+        x(i) = s / l(i, i);
+    }
+    for (int i = 5; i >= 0; --i) {
+        float s = x(i);
+        for (int k = i + 1; k < 6; ++k) s -= l(k, i) * x(k);
+        x(i) = s / l(i, i);
+    }
+}
+
+/// Solves A x = b for a symmetric positive definite 6x6 A. Returns false if
+/// A is not positive definite.
+__device__ inline bool SolveCholesky6(Eigen::Matrix6f a,
+                                      const Eigen::Vector6f &b,
+                                      Eigen::Vector6f &x) {
+    if (!CholeskyFactor6(a)) return false;
+    CholeskySolve6(a, b, x);
+    return true;
+}
+
 /// Function to solve Ax=b
 template <int Dim>
 thrust::tuple<bool, Eigen::Matrix<float, Dim, 1>> SolveLinearSystemPSD(
@@ -71,6 +136,29 @@ thrust::tuple<MatType, VecType, float> ComputeJTJandJTr(const FuncType &f,
                                                         int iteration_num,
                                                         bool verbose = true);
 
+/// Function to reduce the normal equations of 6-dim Jacobians
+/// Input: functor f and number of elements
+/// Output: JTJ, JTr, sum of r^2, number of valid elements
+/// Note: f takes index of element, outputs its NumJ rows and residuals, and
+/// returns whether the element is valid. Only the 21 unique entries of JTJ
+/// are accumulated, in registers, and reduced with warp shuffles, then per
+/// block before the atomic pass. In the deterministic mode the sums of the
+/// blocks are added in order on the host instead.
+template <int NumJ, typename FuncType>
+thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int> ReduceJTJandJTr(
+        const FuncType &f,
+        int iteration_num,
+        cudaStream_t stream = cudaStreamPerThread);
+
+/// Same as ReduceJTJandJTr() for independent systems in one launch, the
+/// system s having counts[s] elements. f takes the index of the system
+/// before the index of the element.
+template <int NumJ, typename FuncType>
+std::vector<thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int>>
+ReduceJTJandJTrBatch(const FuncType &f,
+                     const std::vector<int> &counts,
+                     cudaStream_t stream = cudaStreamPerThread);
+
 template <typename MatType, typename VecType, int NumJ, typename FuncJType,
           typename FuncW1Type, typename FuncW2Type>
 thrust::tuple<MatType, VecType, float, float> ComputeWeightedJTJandJTr(const FuncJType &fj,
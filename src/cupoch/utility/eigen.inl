@@ -1,9 +1,14 @@
 #include <thrust/iterator/counting_iterator.h>
 #include <thrust/transform_reduce.h>
 
+#include <algorithm>
+#include <type_traits>
+
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/device_vector.h"
 #include "cupoch/utility/eigen.h"
 #include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
 
 namespace cupoch {
 namespace utility {
@@ -48,6 +53,190 @@ struct multiple_jtj_jtr_functor {
     }
 };
 
+constexpr int kJTJWarpSize = 32;
+constexpr int kJTJBlockSize = 256;
+constexpr int kJTJMaxBlocks = 1024;
+// The upper triangle of JTJ, JTr, r2 and the number of valid elements.
+constexpr int kJTJNumSums = 21 + 6 + 1 + 1;
+
+#ifdef __CUDACC__
+// Grid-stride loop over the elements. Every thread accumulates the normal
+// equations of its elements, the warps reduce them with shuffles, the
+// first warp reduces those of the block and its first lane adds them to
+// sums, or writes them to the row blockIdx.x of sums if per_block is set,
+// leaving the sum over the blocks to be done in a fixed order.
+template <int NumJ, typename FuncType>
+__device__ void ReduceJTJandJTrOfBlock(const FuncType &func,
+                                       int n,
+                                       float *sums,
+                                       bool per_block) {
+    __shared__ float warp_sums[kJTJBlockSize / kJTJWarpSize][kJTJNumSums];
+    float acc[kJTJNumSums];
+    for (int k = 0; k < kJTJNumSums; ++k) acc[k] = 0.0;
+    for (int idx = blockIdx.x * blockDim.x + threadIdx.x; idx < n;
+         idx += blockDim.x * gridDim.x) {
+        Eigen::Vector6f J_r[NumJ];
+        float r[NumJ];
+        if (!func(idx, J_r, r)) continue;
+        for (int j = 0; j < NumJ; ++j) {
+            int k = 0;
+            for (int a = 0; a < 6; ++a) {
+                for (int b = a; b < 6; ++b) {
+                    acc[k++] += J_r[j](a) * J_r[j](b);
+                }
+            }
+            for (int a = 0; a < 6; ++a) acc[21 + a] += J_r[j](a) * r[j];
+            acc[27] += r[j] * r[j];
+        }
+        acc[28] += 1.0;
+    }
+    const int lane = threadIdx.x % kJTJWarpSize;
+    const int warp = threadIdx.x / kJTJWarpSize;
+    for (int offset = kJTJWarpSize / 2; offset > 0; offset /= 2) {
+        for (int k = 0; k < kJTJNumSums; ++k) {
+            acc[k] += __shfl_down_sync(0xffffffff, acc[k], offset);
+        }
+    }
+    if (lane == 0) {
+        for (int k = 0; k < kJTJNumSums; ++k) warp_sums[warp][k] = acc[k];
+    }
+    __syncthreads();
+    if (warp != 0) return;
+    const int n_warps = blockDim.x / kJTJWarpSize;
+    for (int k = 0; k < kJTJNumSums; ++k) {
+        acc[k] = (lane < n_warps) ? warp_sums[lane][k] : 0.0f;
+    }
+    for (int offset = kJTJWarpSize / 2; offset > 0; offset /= 2) {
+        for (int k = 0; k < kJTJNumSums; ++k) {
+            acc[k] += __shfl_down_sync(0xffffffff, acc[k], offset);
+        }
+    }
+    if (lane != 0) return;
+    if (per_block) {
+        float *block_sums = sums + blockIdx.x * kJTJNumSums;
+        for (int k = 0; k < kJTJNumSums; ++k) block_sums[k] = acc[k];
+    } else {
+        for (int k = 0; k < kJTJNumSums; ++k) atomicAdd(&sums[k], acc[k]);
+    }
+}
+
+template <int NumJ, typename FuncType>
+__global__ void reduce_jtj_jtr_kernel(FuncType func,
+                                      int n,
+                                      float *sums,
+                                      bool per_block) {
+    ReduceJTJandJTrOfBlock<NumJ>(func, n, sums, per_block);
+}
+
+// Binds the system of the functors of ReduceJTJandJTrBatch().
+template <typename FuncType>
+struct jtj_system_functor {
+    __device__ jtj_system_functor(const FuncType &f, int system)
+        : f_(f), system_(system){};
+    const FuncType &f_;
+    const int system_;
+    __device__ bool operator()(int idx,
+                               Eigen::Vector6f *J_r,
+                               float *r) const {
+        return f_(system_, idx, J_r, r);
+    }
+};
+
+// The row blockIdx.y of the grid reduces the system of the same index.
+template <int NumJ, typename FuncType>
+__global__ void reduce_jtj_jtr_batch_kernel(FuncType func,
+                                            const int *counts,
+                                            float *sums,
+                                            bool per_block) {
+    const int system = blockIdx.y;
+    const int stride = per_block ? gridDim.x * kJTJNumSums : kJTJNumSums;
+    ReduceJTJandJTrOfBlock<NumJ>(jtj_system_functor<FuncType>(func, system),
+                                 counts[system], sums + system * stride,
+                                 per_block);
+}
+#endif
+
+// Adapts the Jacobian functors of ComputeJTJandJTr(), whose rows are all
+// valid, to reduce_jtj_jtr_kernel.
+template <typename FuncType>
+struct single_jacobian_functor {
+    single_jacobian_functor(const FuncType &f) : f_(f){};
+    const FuncType f_;
+    __device__ bool operator()(int idx,
+                               Eigen::Vector6f J_r[1],
+                               float r[1]) const {
+        f_(idx, J_r[0], r[0]);
+        return true;
+    }
+};
+
+template <int NumJ, typename FuncType>
+struct multiple_jacobian_functor {
+    multiple_jacobian_functor(const FuncType &f) : f_(f){};
+    const FuncType f_;
+    __device__ bool operator()(int idx,
+                               Eigen::Vector6f J_r[NumJ],
+                               float r[NumJ]) const {
+        f_(idx, J_r, r);
+        return true;
+    }
+};
+
+template <typename MatType, typename VecType>
+struct is_6dim_system
+    : std::integral_constant<bool,
+                             std::is_same<MatType, Eigen::Matrix6f>::value &&
+                                     std::is_same<VecType,
+                                                  Eigen::Vector6f>::value> {};
+
+template <typename MatType, typename VecType, typename FuncType>
+thrust::tuple<MatType, VecType, float> ReduceSingleJTJandJTr(
+        const FuncType &f, int iteration_num, std::true_type) {
+    auto res = ReduceJTJandJTr<1>(single_jacobian_functor<FuncType>(f),
+                                  iteration_num);
+    return thrust::make_tuple(thrust::get<0>(res), thrust::get<1>(res),
+                              thrust::get<2>(res));
+}
+
+template <typename MatType, typename VecType, typename FuncType>
+thrust::tuple<MatType, VecType, float> ReduceSingleJTJandJTr(
+        const FuncType &f, int iteration_num, std::false_type) {
+    MatType JTJ;
+    VecType JTr;
+    JTJ.setZero();
+    JTr.setZero();
+    jtj_jtr_functor<MatType, VecType, FuncType> func(f);
+    return thrust::transform_reduce(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(iteration_num), func,
+            thrust::make_tuple(JTJ, JTr, 0.0f),
+            thrust::plus<thrust::tuple<MatType, VecType, float>>());
+}
+
+template <typename MatType, typename VecType, int NumJ, typename FuncType>
+thrust::tuple<MatType, VecType, float> ReduceMultipleJTJandJTr(
+        const FuncType &f, int iteration_num, std::true_type) {
+    auto res = ReduceJTJandJTr<NumJ>(
+            multiple_jacobian_functor<NumJ, FuncType>(f), iteration_num);
+    return thrust::make_tuple(thrust::get<0>(res), thrust::get<1>(res),
+                              thrust::get<2>(res));
+}
+
+template <typename MatType, typename VecType, int NumJ, typename FuncType>
+thrust::tuple<MatType, VecType, float> ReduceMultipleJTJandJTr(
+        const FuncType &f, int iteration_num, std::false_type) {
+    MatType JTJ;
+    VecType JTr;
+    JTJ.setZero();
+    JTr.setZero();
+    multiple_jtj_jtr_functor<MatType, VecType, NumJ, FuncType> func(f);
+    return thrust::transform_reduce(
+            thrust::make_counting_iterator(0),
+            thrust::make_counting_iterator(iteration_num), func,
+            thrust::make_tuple(JTJ, JTr, 0.0f),
+            thrust::plus<thrust::tuple<MatType, VecType, float>>());
+}
+
 template <typename FuncType>
 struct wrapped_calc_weights_functor {
     wrapped_calc_weights_functor(const FuncType &f, float r2_sum) : f_(f), r2_sum_(r2_sum) {};
@@ -60,22 +249,107 @@ struct wrapped_calc_weights_functor {
 
 }  // namespace
 
+#ifdef __CUDACC__
+// Sums the rows of the n_blocks blocks in order into the first one.
+inline void SumJTJBlocks(float *sums, int n_blocks) {
+    for (int b = 1; b < n_blocks; ++b) {
+        for (int k = 0; k < kJTJNumSums; ++k) {
+            sums[k] += sums[b * kJTJNumSums + k];
+        }
+    }
+}
+
+inline thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int>
+UnpackJTJSums(const float *sums) {
+    Eigen::Matrix6f JTJ;
+    Eigen::Vector6f JTr;
+    int k = 0;
+    for (int a = 0; a < 6; ++a) {
+        for (int b = a; b < 6; ++b) {
+            JTJ(a, b) = sums[k];
+            JTJ(b, a) = sums[k];
+            ++k;
+        }
+    }
+    for (int a = 0; a < 6; ++a) JTr(a) = sums[21 + a];
+    return thrust::make_tuple(JTJ, JTr, sums[27], (int)sums[28]);
+}
+
+template <int NumJ, typename FuncType>
+thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int> ReduceJTJandJTr(
+        const FuncType &f, int iteration_num, cudaStream_t stream) {
+    const int n_blocks =
+            std::min((iteration_num + kJTJBlockSize - 1) / kJTJBlockSize,
+                     kJTJMaxBlocks);
+    const bool per_block = IsDeterministicMode();
+    const int n_rows = per_block ? std::max(n_blocks, 1) : 1;
+    utility::device_vector<float> sums(n_rows * kJTJNumSums, 0.0);
+    if (n_blocks > 0) {
+        reduce_jtj_jtr_kernel<NumJ><<<n_blocks, kJTJBlockSize, 0, stream>>>(
+                f, iteration_num, thrust::raw_pointer_cast(sums.data()),
+                per_block);
+        cudaSafeCall(cudaGetLastError());
+    }
+    std::vector<float> h_sums(sums.size());
+    cudaSafeCall(cudaMemcpyAsync(h_sums.data(),
+                                 thrust::raw_pointer_cast(sums.data()),
+                                 h_sums.size() * sizeof(float),
+                                 cudaMemcpyDeviceToHost, stream));
+    cudaSafeCall(cudaStreamSynchronize(stream));
+    SumJTJBlocks(h_sums.data(), n_rows);
+    return UnpackJTJSums(h_sums.data());
+}
+
+template <int NumJ, typename FuncType>
+std::vector<thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int>>
+ReduceJTJandJTrBatch(const FuncType &f,
+                     const std::vector<int> &counts,
+                     cudaStream_t stream) {
+    const int n_systems = counts.size();
+    std::vector<thrust::tuple<Eigen::Matrix6f, Eigen::Vector6f, float, int>>
+            res;
+    if (n_systems == 0) return res;
+    utility::device_vector<int> d_counts(counts.size());
+    cudaSafeCall(cudaMemcpyAsync(thrust::raw_pointer_cast(d_counts.data()),
+                                 counts.data(), n_systems * sizeof(int),
+                                 cudaMemcpyHostToDevice, stream));
+    const int max_count = *std::max_element(counts.begin(), counts.end());
+    const int n_blocks =
+            std::min((max_count + kJTJBlockSize - 1) / kJTJBlockSize,
+                     std::max(kJTJMaxBlocks / n_systems, 1));
+    const bool per_block = IsDeterministicMode();
+    const int n_rows = per_block ? std::max(n_blocks, 1) : 1;
+    utility::device_vector<float> sums(n_systems * n_rows * kJTJNumSums, 0.0);
+    if (n_blocks > 0) {
+        reduce_jtj_jtr_batch_kernel<NumJ>
+                <<<dim3(n_blocks, n_systems), kJTJBlockSize, 0, stream>>>(
+                        f, thrust::raw_pointer_cast(d_counts.data()),
+                        thrust::raw_pointer_cast(sums.data()), per_block);
+        cudaSafeCall(cudaGetLastError());
+    }
+    std::vector<float> h_sums(n_systems * kJTJNumSums);
+    cudaSafeCall(cudaMemcpyAsync(h_sums.data(),
+                                 thrust::raw_pointer_cast(sums.data()),
+                                 h_sums.size() * sizeof(float),
+                                 cudaMemcpyDeviceToHost, stream));
+    cudaSafeCall(cudaStreamSynchronize(stream));
+    res.reserve(n_systems);
+    for (int s = 0; s < n_systems; ++s) {
+        float *system_sums = h_sums.data() + s * n_rows * kJTJNumSums;
+        SumJTJBlocks(system_sums, n_rows);
+        res.push_back(UnpackJTJSums(system_sums));
+    }
+    return res;
+}
+#endif
+
 template <typename MatType, typename VecType, typename FuncType>
 thrust::tuple<MatType, VecType, float> ComputeJTJandJTr(const FuncType &f,
                                                         int iteration_num,
                                                         bool verbose) {
-    MatType JTJ;
-    VecType JTr;
-    float r2_sum = 0.0;
-    JTJ.setZero();
-    JTr.setZero();
-    jtj_jtr_functor<MatType, VecType, FuncType> func(f);
-    auto jtj_jtr_r2 = thrust::transform_reduce(
-            thrust::make_counting_iterator(0),
-            thrust::make_counting_iterator(iteration_num), func,
-            thrust::make_tuple(JTJ, JTr, r2_sum),
-            thrust::plus<thrust::tuple<MatType, VecType, float>>());
-    r2_sum = thrust::get<2>(jtj_jtr_r2);
+    auto jtj_jtr_r2 = ReduceSingleJTJandJTr<MatType, VecType>(
+            f, iteration_num, is_6dim_system<MatType, VecType>());
+    const float r2_sum = thrust::get<2>(jtj_jtr_r2);
     if (verbose) {
         LogDebug("Residual : {:.2e} (# of elements : {:d})",
                  r2_sum / (float)iteration_num, iteration_num);
@@ -86,18 +360,9 @@ thrust::tuple<MatType, VecType, float> ComputeJTJandJTr(const FuncType &f,
 template <typename MatType, typename VecType, int NumJ, typename FuncType>
 thrust::tuple<MatType, VecType, float> ComputeJTJandJTr(
         const FuncType &f, int iteration_num, bool verbose /*=true*/) {
-    MatType JTJ;
-    VecType JTr;
-    float r2_sum = 0.0;
-    JTJ.setZero();
-    JTr.setZero();
-    multiple_jtj_jtr_functor<MatType, VecType, NumJ, FuncType> func(f);
-    auto jtj_jtr_r2 = thrust::transform_reduce(
-            thrust::make_counting_iterator(0),
-            thrust::make_counting_iterator(iteration_num), func,
-            thrust::make_tuple(JTJ, JTr, r2_sum),
-            thrust::plus<thrust::tuple<MatType, VecType, float>>());
-    r2_sum = thrust::get<2>(jtj_jtr_r2);
+    auto jtj_jtr_r2 = ReduceMultipleJTJandJTr<MatType, VecType, NumJ>(
+            f, iteration_num, is_6dim_system<MatType, VecType>());
+    const float r2_sum = thrust::get<2>(jtj_jtr_r2);
     if (verbose) {
         LogDebug("Residual : {:.2e} (# of elements : {:d})",
                  r2_sum / (float)iteration_num, iteration_num);
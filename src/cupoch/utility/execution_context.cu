@@ -0,0 +1,78 @@
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+// The host device systems of cupoch_cpu run the algorithms to completion on
+// the calling thread, so the contexts need neither streams nor events there.
+#ifdef CUPOCH_CPU_BACKEND
+
+ExecutionContext::ExecutionContext() : stream_(0), owns_stream_(false) {}
+
+ExecutionContext::ExecutionContext(cudaStream_t stream)
+    : stream_(stream), owns_stream_(false) {}
+
+ExecutionContext::~ExecutionContext() {}
+
+cudaEvent_t ExecutionContext::RecordEvent() { return nullptr; }
+
+void ExecutionContext::WaitEvent(cudaEvent_t event) const {}
+
+void ExecutionContext::WaitFor(ExecutionContext &other) {}
+
+void ExecutionContext::Synchronize() {}
+
+#else
+
+ExecutionContext::ExecutionContext() : owns_stream_(true) {
+    cudaSafeCall(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+}
+
+ExecutionContext::ExecutionContext(cudaStream_t stream)
+    : stream_(stream), owns_stream_(false) {}
+
+ExecutionContext::~ExecutionContext() {
+    for (auto &event : free_events_) cudaEventDestroy(event);
+    for (auto &event : used_events_) cudaEventDestroy(event);
+    if (owns_stream_) cudaStreamDestroy(stream_);
+}
+
+cudaEvent_t ExecutionContext::RecordEvent() {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    cudaEvent_t event;
+    if (free_events_.empty()) {
+        cudaSafeCall(
+                cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    } else {
+        event = free_events_.back();
+        free_events_.pop_back();
+    }
+    cudaSafeCall(cudaEventRecord(event, stream_));
+    used_events_.push_back(event);
+    return event;
+}
+
+void ExecutionContext::WaitEvent(cudaEvent_t event) const {
+    cudaSafeCall(cudaStreamWaitEvent(stream_, event, 0));
+}
+
+void ExecutionContext::WaitFor(ExecutionContext &other) {
+    if (other.stream_ == stream_) return;
+    WaitEvent(other.RecordEvent());
+}
+
+void ExecutionContext::Synchronize() {
+    cudaSafeCall(cudaStreamSynchronize(stream_));
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    free_events_.insert(free_events_.end(), used_events_.begin(),
+                        used_events_.end());
+    used_events_.clear();
+}
+
+#endif
+
+ExecutionContext &ExecutionContext::Default() {
+    static ExecutionContext context(0);
+    return context;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cuda_runtime.h>
+
+#include <mutex>
+#include <vector>
+
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+namespace utility {
+
+/// \class ExecutionContext
+///
+/// \brief Bundle of a CUDA stream, the temporary allocator bound to that
+/// stream and a pool of reusable events.
+///
+/// Functions taking an ExecutionContext enqueue all their kernels on the
+/// context stream and only wait for that stream, so that independent
+/// pipelines using different contexts can overlap on one device.
+class ExecutionContext {
+public:
+    /// Creates a context owning a new non-blocking stream.
+    ExecutionContext();
+    /// Wraps an existing stream. The stream is not destroyed by the context.
+    explicit ExecutionContext(cudaStream_t stream);
+    ~ExecutionContext();
+    ExecutionContext(const ExecutionContext &) = delete;
+    ExecutionContext &operator=(const ExecutionContext &) = delete;
+
+public:
+    cudaStream_t GetStream() const { return stream_; }
+
+    /// Thrust execution policy allocating its temporaries on the context
+    /// stream. Use as `Policy()->on(GetStream())`.
+    decltype(auto) Policy() const { return exec_policy(stream_); }
+
+    /// Records an event on the context stream. The event stays owned by the
+    /// context and is recycled on the next call to Synchronize().
+    cudaEvent_t RecordEvent();
+
+    /// Makes the context stream wait for \p event without blocking the host.
+    void WaitEvent(cudaEvent_t event) const;
+
+    /// Makes the context stream wait for the work already queued on
+    /// \p other without blocking the host.
+    void WaitFor(ExecutionContext &other);
+
+    /// Blocks the host until the work queued on the context stream is done.
+    void Synchronize();
+
+    /// Forces the deterministic variants of the algorithms run with this
+    /// context, as SetDeterministicMode() does for all of them.
+    void SetDeterministic(bool enable) { deterministic_ = enable; }
+    bool IsDeterministic() const {
+        return deterministic_ || IsDeterministicMode();
+    }
+
+    /// Context wrapping the default stream, used by the overloads that do not
+    /// take an explicit context.
+    static ExecutionContext &Default();
+
+private:
+    cudaStream_t stream_;
+    bool owns_stream_;
+    bool deterministic_ = false;
+    std::vector<cudaEvent_t> free_events_;
+    std::vector<cudaEvent_t> used_events_;
+    std::mutex event_mutex_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
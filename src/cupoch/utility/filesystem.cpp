@@ -67,6 +67,37 @@ bool ChangeWorkingDirectory(const std::string &directory) {
     return (chdir(directory.c_str()) == 0);
 }
 
+bool DirectoryExists(const std::string &directory) {
+    struct stat info;
+    if (stat(directory.c_str(), &info) == -1) return false;
+    return S_ISDIR(info.st_mode);
+}
+
+bool MakeDirectory(const std::string &directory) {
+#ifdef WINDOWS
+    return (_mkdir(directory.c_str()) == 0);
+#else
+    return (mkdir(directory.c_str(), S_IRWXU) == 0);
+#endif
+}
+
+bool MakeDirectoryHierarchy(const std::string &directory) {
+    std::string full_path = directory;
+    if (full_path.empty()) return false;
+    if (full_path.back() != '/' && full_path.back() != '\\') {
+        full_path += "/";
+    }
+    size_t curr_pos = full_path.find_first_of("/\\", 1);
+    while (curr_pos != std::string::npos) {
+        std::string subdir = full_path.substr(0, curr_pos + 1);
+        if (!DirectoryExists(subdir)) {
+            if (!MakeDirectory(subdir)) return false;
+        }
+        curr_pos = full_path.find_first_of("/\\", curr_pos + 1);
+    }
+    return true;
+}
+
 FILE *FOpen(const std::string &filename, const std::string &mode) {
     FILE *fp;
 #ifndef _WIN32
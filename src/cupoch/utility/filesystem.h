@@ -19,6 +19,13 @@ std::string GetWorkingDirectory();
 
 bool ChangeWorkingDirectory(const std::string &directory);
 
+bool DirectoryExists(const std::string &directory);
+
+bool MakeDirectory(const std::string &directory);
+
+/// Makes \p directory and its missing parents.
+bool MakeDirectoryHierarchy(const std::string &directory);
+
 // wrapper for fopen that enables unicode paths on Windows
 FILE *FOpen(const std::string &filename, const std::string &mode);
 
@@ -260,6 +260,45 @@ __host__ __device__ inline int IndexOf(const Eigen::Vector3i &xyz, int resolutio
     return IndexOf(xyz(0), xyz(1), xyz(2), resolution);
 }
 
+/// Keys of the cells of an unbounded integer grid for the open addressing
+/// hash tables on the device: 21 bits per axis, so cells in
+/// [-2^20, 2^20) are representable. Other cells map to kEmptyCellKey.
+constexpr int kCellKeyBits = 21;
+constexpr int kCellKeyOffset = 1 << (kCellKeyBits - 1);
+constexpr unsigned long long kEmptyCellKey = ~0ull;
+
+__host__ __device__ inline unsigned long long PackCellKey(
+        const Eigen::Vector3i &cell) {
+    for (int i = 0; i < 3; ++i) {
+        if (cell[i] < -kCellKeyOffset || cell[i] >= kCellKeyOffset)
+            return kEmptyCellKey;
+    }
+    return ((unsigned long long)(cell[0] + kCellKeyOffset)
+            << (2 * kCellKeyBits)) |
+           ((unsigned long long)(cell[1] + kCellKeyOffset) << kCellKeyBits) |
+           (unsigned long long)(cell[2] + kCellKeyOffset);
+}
+
+__host__ __device__ inline Eigen::Vector3i UnpackCellKey(
+        unsigned long long key) {
+    const unsigned long long mask = (1ull << kCellKeyBits) - 1;
+    return Eigen::Vector3i(
+            int((key >> (2 * kCellKeyBits)) & mask) - kCellKeyOffset,
+            int((key >> kCellKeyBits) & mask) - kCellKeyOffset,
+            int(key & mask) - kCellKeyOffset);
+}
+
+/// 64 bit finalizer of MurmurHash3, to spread neighboring cells over the
+/// table.
+__host__ __device__ inline unsigned int HashCellKey(unsigned long long key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return (unsigned int)key;
+}
+
 namespace utility {
 
 /// Function to split a string, mimics boost::split
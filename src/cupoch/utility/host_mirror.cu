@@ -0,0 +1,65 @@
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/transform_reduce.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "cupoch/utility/host_mirror.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+namespace {
+
+// Finalizer of splitmix64, mixing the word with its index so that the sum
+// over the words depends on their order.
+__host__ __device__ inline uint64_t MixWord(uint64_t word, uint64_t i) {
+    uint64_t z = word + (i + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+struct hash_words_functor {
+    hash_words_functor(const uint8_t *data, size_t bytes)
+        : data_(data), bytes_(bytes){};
+    const uint8_t *data_;
+    const size_t bytes_;
+    __device__ uint64_t operator()(size_t i) const {
+        uint64_t word = 0;
+        if ((i + 1) * 8 <= bytes_) {
+            word = reinterpret_cast<const uint64_t *>(data_)[i];
+        } else {
+            for (size_t j = i * 8; j < bytes_; ++j) {
+                word |= uint64_t(data_[j]) << (8 * (j - i * 8));
+            }
+        }
+        return MixWord(word, i);
+    }
+};
+
+}  // namespace
+
+uint64_t cupoch::utility::HashHostMemory(const void *ptr, size_t bytes) {
+    const uint8_t *data = static_cast<const uint8_t *>(ptr);
+    uint64_t hash = bytes;
+    for (size_t i = 0; i * 8 < bytes; ++i) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i * 8, std::min<size_t>(8, bytes - i * 8));
+        hash += MixWord(word, i);
+    }
+    return hash;
+}
+
+uint64_t cupoch::utility::HashDeviceMemory(const void *ptr,
+                                           size_t bytes,
+                                           cudaStream_t stream /* = 0*/) {
+    const size_t n_words = (bytes + 7) / 8;
+    if (n_words == 0) return bytes;
+    return thrust::transform_reduce(
+            utility::exec_policy(stream)->on(stream),
+            thrust::make_counting_iterator<size_t>(0),
+            thrust::make_counting_iterator(n_words),
+            hash_words_functor(static_cast<const uint8_t *>(ptr), bytes),
+            uint64_t(bytes), thrust::plus<uint64_t>());
+}
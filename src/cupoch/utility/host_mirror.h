@@ -0,0 +1,89 @@
+#pragma once
+
+#include <thrust/host_vector.h>
+
+#include <cstdint>
+#include <mutex>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace utility {
+
+/// 64 bit hash of the bytes [ptr, ptr + bytes) of host memory.
+uint64_t HashHostMemory(const void *ptr, size_t bytes);
+/// Same hash as HashHostMemory() of device memory, computed on the device
+/// at its bandwidth, 8 bytes per thread. \p ptr must be 8 byte aligned.
+uint64_t HashDeviceMemory(const void *ptr,
+                          size_t bytes,
+                          cudaStream_t stream = 0);
+
+/// \class HostMirror
+///
+/// \brief Host copy of a device_vector which is only transferred when it is
+/// stale. The mirror remembers the hash of the values it holds, and the
+/// device vector is compared to it by a hash on the device, so the changes
+/// made to the vector by any kernel are caught while the unchanged vectors
+/// are neither downloaded nor uploaded again. Copies of a mirror start
+/// empty. The member functions are thread safe.
+template <typename T>
+class HostMirror {
+public:
+    HostMirror() = default;
+    HostMirror(const HostMirror &) {}
+    HostMirror &operator=(const HostMirror &) {
+        Invalidate();
+        return *this;
+    }
+
+    /// Host copy of \p device, downloaded unless the mirror is current.
+    thrust::host_vector<T> Download(const device_vector<T> &device) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t hash = HashOf(device);
+        if (!valid_ || host_.size() != device.size() || hash != hash_) {
+            host_ = CopyToHost(device);
+            hash_ = hash;
+            valid_ = true;
+        }
+        return host_;
+    }
+
+    /// Uploads \p host into \p device unless it already holds the same
+    /// values.
+    void Upload(const thrust::host_vector<T> &host, device_vector<T> &device) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t hash =
+                HashHostMemory(thrust::raw_pointer_cast(host.data()),
+                               host.size() * sizeof(T));
+        if (valid_ && host.size() == host_.size() &&
+            host.size() == device.size() && hash == hash_ &&
+            HashOf(device) == hash_) {
+            return;
+        }
+        CopyFromHost(host, device);
+        host_ = host;
+        hash_ = hash;
+        valid_ = true;
+    }
+
+    void Invalidate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        valid_ = false;
+        host_.clear();
+        host_.shrink_to_fit();
+    }
+
+private:
+    static uint64_t HashOf(const device_vector<T> &device) {
+        return HashDeviceMemory(thrust::raw_pointer_cast(device.data()),
+                                device.size() * sizeof(T));
+    }
+
+    std::mutex mutex_;
+    thrust::host_vector<T> host_;
+    uint64_t hash_ = 0;
+    bool valid_ = false;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,296 @@
+#include "cupoch/utility/launch_tuner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/filesystem.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+namespace {
+
+// Timings of each candidate, the fastest of them is kept.
+const int kNumTrials = 2;
+const int kBlockSizes[] = {64, 128, 256, 512};
+const int kItemsPerThread[] = {1, 2, 4};
+
+struct TuningEntry {
+    std::string cache_key_;
+    std::vector<LaunchConfig> candidates_;
+    std::vector<float> best_ms_;
+    int num_trials_ = 0;
+    bool decided_ = false;
+    LaunchConfig config_;
+    // A trial is in flight between the start of its scope and its end, then
+    // pending until its stop event is read.
+    bool in_flight_ = false;
+    bool pending_ = false;
+    int pending_candidate_ = 0;
+    cudaEvent_t start_ = nullptr;
+    cudaEvent_t stop_ = nullptr;
+};
+
+std::string DefaultCacheFile() {
+    const char *filename = std::getenv("CUPOCH_TUNING_CACHE");
+    if (filename) return filename;
+    const char *home = std::getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.cache/cupoch/launch_configs.txt";
+}
+
+int SizeClass(size_t n) {
+    int size_class = 0;
+    while (n >>= 1) ++size_class;
+    return size_class;
+}
+
+LaunchConfig Clamp(LaunchConfig config, int max_block_size) {
+    config.block_size_ = std::min(config.block_size_, max_block_size);
+    return config;
+}
+
+class LaunchTuner {
+public:
+    // Never destroyed, like the CUDA events of its entries.
+    static LaunchTuner &GetInstance() {
+        static LaunchTuner *tuner = new LaunchTuner();
+        return *tuner;
+    }
+
+    std::atomic<bool> enabled_{true};
+    std::mutex mutex_;
+    std::string cache_file_ = DefaultCacheFile();
+    bool loaded_ = false;
+    std::unordered_map<std::string, LaunchConfig> cached_;
+    // Keyed by the cache key and the device, as the events are per device.
+    std::unordered_map<std::string, TuningEntry> entries_;
+    std::unordered_map<int, std::string> archs_;
+
+    const std::string &GetArch(int device) {
+        auto it = archs_.find(device);
+        if (it != archs_.end()) return it->second;
+        int major = 0;
+        int minor = 0;
+        cudaSafeCall(cudaDeviceGetAttribute(
+                &major, cudaDevAttrComputeCapabilityMajor, device));
+        cudaSafeCall(cudaDeviceGetAttribute(
+                &minor, cudaDevAttrComputeCapabilityMinor, device));
+        return archs_[device] = fmt::format("sm_{:d}{:d}", major, minor);
+    }
+
+    std::string CacheKey(const std::string &kernel, int device, size_t n) {
+        return fmt::format("{} {} {:d}", kernel, GetArch(device),
+                           SizeClass(n));
+    }
+
+    // Lines of "<kernel> <arch> <size class> <block size> <items per
+    // thread>", the last one of a key wins.
+    void LoadCache() {
+        if (loaded_) return;
+        loaded_ = true;
+        if (cache_file_.empty()) return;
+        std::ifstream file(cache_file_);
+        std::string kernel, arch;
+        int size_class;
+        LaunchConfig config;
+        while (file >> kernel >> arch >> size_class >> config.block_size_ >>
+               config.items_per_thread_) {
+            if (config.block_size_ <= 0 || config.items_per_thread_ <= 0) {
+                continue;
+            }
+            cached_[fmt::format("{} {} {:d}", kernel, arch, size_class)] =
+                    config;
+        }
+    }
+
+    void SaveCache(const std::string &key, const LaunchConfig &config) {
+        if (cache_file_.empty()) return;
+        const std::string directory =
+                filesystem::GetFileParentDirectory(cache_file_);
+        if (!directory.empty()) filesystem::MakeDirectoryHierarchy(directory);
+        std::ofstream file(cache_file_, std::ios::app);
+        if (!file) {
+            utility::LogDebug("[LaunchTuner] Cannot write {}.", cache_file_);
+            return;
+        }
+        file << key << " " << config.block_size_ << " "
+             << config.items_per_thread_ << "\n";
+    }
+
+    TuningEntry &GetEntry(const std::string &kernel, int device, size_t n) {
+        LoadCache();
+        const std::string cache_key = CacheKey(kernel, device, n);
+        const std::string key = fmt::format("{} {:d}", cache_key, device);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) return it->second;
+        TuningEntry &entry = entries_[key];
+        entry.cache_key_ = cache_key;
+        auto cached = cached_.find(cache_key);
+        if (cached != cached_.end()) {
+            entry.decided_ = true;
+            entry.config_ = cached->second;
+            return entry;
+        }
+        for (int block_size : kBlockSizes) {
+            for (int items_per_thread : kItemsPerThread) {
+                entry.candidates_.push_back({block_size, items_per_thread});
+            }
+        }
+        entry.best_ms_.assign(entry.candidates_.size(),
+                              std::numeric_limits<float>::max());
+        return entry;
+    }
+
+    // Reads the pending trial of \p entry, and chooses its configuration once
+    // all the candidates are timed.
+    void Collect(TuningEntry &entry) {
+        if (!entry.pending_) return;
+        entry.pending_ = false;
+        cudaSafeCall(cudaEventSynchronize(entry.stop_));
+        float ms = 0.0f;
+        cudaSafeCall(cudaEventElapsedTime(&ms, entry.start_, entry.stop_));
+        float &best = entry.best_ms_[entry.pending_candidate_];
+        best = std::min(best, ms);
+        const int n_candidates = int(entry.candidates_.size());
+        if (entry.num_trials_ < n_candidates * kNumTrials) return;
+        const int c = int(std::min_element(entry.best_ms_.begin(),
+                                           entry.best_ms_.end()) -
+                          entry.best_ms_.begin());
+        entry.decided_ = true;
+        entry.config_ = entry.candidates_[c];
+        cudaSafeCall(cudaEventDestroy(entry.start_));
+        cudaSafeCall(cudaEventDestroy(entry.stop_));
+        entry.start_ = nullptr;
+        entry.stop_ = nullptr;
+        cached_[entry.cache_key_] = entry.config_;
+        SaveCache(entry.cache_key_, entry.config_);
+        utility::LogDebug("[LaunchTuner] {}: {:d} threads x {:d} items.",
+                          entry.cache_key_, entry.config_.block_size_,
+                          entry.config_.items_per_thread_);
+    }
+
+    void DestroyEntries() {
+        for (auto &kv : entries_) {
+            TuningEntry &entry = kv.second;
+            if (entry.in_flight_) continue;
+            if (entry.start_) cudaEventDestroy(entry.start_);
+            if (entry.stop_) cudaEventDestroy(entry.stop_);
+        }
+        entries_.clear();
+        cached_.clear();
+        loaded_ = false;
+    }
+
+private:
+    LaunchTuner() = default;
+};
+
+}  // namespace
+
+void utility::EnableLaunchTuning(bool enable) {
+    LaunchTuner::GetInstance().enabled_ = enable;
+}
+
+bool utility::IsLaunchTuningEnabled() {
+    return LaunchTuner::GetInstance().enabled_;
+}
+
+void utility::SetLaunchTuningCacheFile(const std::string &filename) {
+    LaunchTuner &tuner = LaunchTuner::GetInstance();
+    std::lock_guard<std::mutex> lock(tuner.mutex_);
+    tuner.cache_file_ = filename;
+    tuner.DestroyEntries();
+}
+
+std::string utility::GetLaunchTuningCacheFile() {
+    LaunchTuner &tuner = LaunchTuner::GetInstance();
+    std::lock_guard<std::mutex> lock(tuner.mutex_);
+    return tuner.cache_file_;
+}
+
+void utility::ResetLaunchTuning() {
+    LaunchTuner &tuner = LaunchTuner::GetInstance();
+    std::lock_guard<std::mutex> lock(tuner.mutex_);
+    tuner.DestroyEntries();
+}
+
+bool utility::GetTunedLaunchConfig(const std::string &kernel,
+                                   size_t n,
+                                   LaunchConfig &config) {
+    LaunchTuner &tuner = LaunchTuner::GetInstance();
+    int device = 0;
+    cudaSafeCall(cudaGetDevice(&device));
+    std::lock_guard<std::mutex> lock(tuner.mutex_);
+    TuningEntry &entry = tuner.GetEntry(kernel, device, n);
+    if (!entry.in_flight_) tuner.Collect(entry);
+    if (!entry.decided_) return false;
+    config = entry.config_;
+    return true;
+}
+
+ScopedLaunchTuning::ScopedLaunchTuning(const std::string &kernel,
+                                       size_t n,
+                                       int max_block_size,
+                                       cudaStream_t stream)
+    : stream_(stream) {
+    LaunchTuner &tuner = LaunchTuner::GetInstance();
+    config_ = Clamp(config_, max_block_size);
+    if (!tuner.enabled_) return;
+    int device = 0;
+    cudaSafeCall(cudaGetDevice(&device));
+    std::lock_guard<std::mutex> lock(tuner.mutex_);
+    TuningEntry &entry = tuner.GetEntry(kernel, device, n);
+    // Another thread is timing a launch of the same entry.
+    if (entry.in_flight_) return;
+    tuner.Collect(entry);
+    if (entry.decided_) {
+        config_ = Clamp(entry.config_, max_block_size);
+        return;
+    }
+    cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+    cudaSafeCall(cudaStreamIsCapturing(stream, &status));
+    if (status != cudaStreamCaptureStatusNone) return;
+
+    const int c = entry.num_trials_ % int(entry.candidates_.size());
+    ++entry.num_trials_;
+    if (!entry.start_) {
+        cudaSafeCall(cudaEventCreate(&entry.start_));
+        cudaSafeCall(cudaEventCreate(&entry.stop_));
+    }
+    cudaSafeCall(cudaEventRecord(entry.start_, stream));
+    entry.in_flight_ = true;
+    entry.pending_candidate_ = c;
+    config_ = Clamp(entry.candidates_[c], max_block_size);
+    key_ = fmt::format("{} {:d}", entry.cache_key_, device);
+    trial_ = true;
+}
+
+ScopedLaunchTuning::~ScopedLaunchTuning() {
+    if (!trial_) return;
+    LaunchTuner &tuner = LaunchTuner::GetInstance();
+    std::lock_guard<std::mutex> lock(tuner.mutex_);
+    auto it = tuner.entries_.find(key_);
+    if (it == tuner.entries_.end()) return;
+    TuningEntry &entry = it->second;
+    entry.in_flight_ = false;
+    // A destructor must not throw, so a failure only drops the trial, which
+    // is run again by a later launch.
+    const cudaError_t err = cudaEventRecord(entry.stop_, stream_);
+    if (err != cudaSuccess) {
+        utility::LogWarning(
+                "[ScopedLaunchTuning] Recording the stop event failed: {}\n",
+                cudaGetErrorString(err));
+        --entry.num_trials_;
+        return;
+    }
+    entry.pending_ = true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cuda_runtime.h>
+
+#include <string>
+
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+namespace utility {
+
+/// Launch configuration of a tuned kernel, each thread processing
+/// \p items_per_thread_ items a block apart.
+struct LaunchConfig {
+    int block_size_ = 256;
+    int items_per_thread_ = 1;
+
+    int NumBlocks(size_t n) const {
+        const size_t items_per_block = size_t(block_size_) * items_per_thread_;
+        return int((n + items_per_block - 1) / items_per_block);
+    }
+};
+
+/// Turns the autotuning on or off, it is on by default. The kernels use the
+/// default LaunchConfig while it is off.
+void EnableLaunchTuning(bool enable);
+bool IsLaunchTuningEnabled();
+
+/// File the tuned configurations are cached in across processes. Defaults to
+/// $CUPOCH_TUNING_CACHE, else to ~/.cache/cupoch/launch_configs.txt. An empty
+/// name keeps them in memory only.
+void SetLaunchTuningCacheFile(const std::string &filename);
+std::string GetLaunchTuningCacheFile();
+
+/// Forgets the configurations tuned so far, the cache file is read again at
+/// the next launch.
+void ResetLaunchTuning();
+
+/// Gets the configuration chosen for \p kernel and \p n items on the current
+/// device, returns false while it is being tuned.
+bool GetTunedLaunchConfig(const std::string &kernel,
+                          size_t n,
+                          LaunchConfig &config);
+
+/// \class ScopedLaunchTuning
+///
+/// \brief Chooses the configuration of the launch of \p kernel on \p n items
+/// made in the enclosing scope.
+///
+/// The configurations are tuned per device architecture and per power of two
+/// of the number of items. The first launches of a size class try the
+/// candidate block sizes and items per thread in turn and time them with CUDA
+/// events on \p stream. Each launch is made once with a single candidate, so
+/// the kernels with side effects behave as usual while they are tuned. Once
+/// every candidate is timed, the fastest is kept and appended to the cache
+/// file. The launches captured in a CUDA graph are not timed.
+class ScopedLaunchTuning {
+public:
+    ScopedLaunchTuning(const std::string &kernel,
+                       size_t n,
+                       int max_block_size = 1024,
+                       cudaStream_t stream = cudaStreamPerThread);
+    ~ScopedLaunchTuning();
+    ScopedLaunchTuning(const ScopedLaunchTuning &) = delete;
+    ScopedLaunchTuning &operator=(const ScopedLaunchTuning &) = delete;
+
+    const LaunchConfig &GetConfig() const { return config_; }
+
+private:
+    LaunchConfig config_;
+    std::string key_;
+    bool trial_ = false;
+    cudaStream_t stream_;
+};
+
+#ifdef __CUDACC__
+template <typename Func>
+__global__ void tuned_for_each_kernel(Func func,
+                                      size_t n,
+                                      int items_per_thread) {
+    const size_t begin =
+            size_t(blockIdx.x) * blockDim.x * items_per_thread + threadIdx.x;
+    for (int k = 0; k < items_per_thread; ++k) {
+        const size_t idx = begin + size_t(k) * blockDim.x;
+        if (idx >= n) return;
+        func(idx);
+    }
+}
+
+/// Calls \p func on the indices [0, n) like thrust::for_each on a counting
+/// iterator, with the launch configuration tuned for \p kernel.
+template <typename Func>
+void TunedForEach(const std::string &kernel,
+                  size_t n,
+                  const Func &func,
+                  cudaStream_t stream = cudaStreamPerThread) {
+    if (n == 0) return;
+    cudaFuncAttributes attributes;
+    cudaSafeCall(cudaFuncGetAttributes(&attributes,
+                                       tuned_for_each_kernel<Func>));
+    ScopedLaunchTuning tuning(kernel, n, attributes.maxThreadsPerBlock,
+                              stream);
+    const LaunchConfig &config = tuning.GetConfig();
+    tuned_for_each_kernel<Func>
+            <<<config.NumBlocks(n), config.block_size_, 0, stream>>>(
+                    func, n, config.items_per_thread_);
+    cudaSafeCall(cudaGetLastError());
+}
+#endif
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,438 @@
+#include "cupoch/utility/memory_resource.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+#ifdef USE_RMM
+#include <rmm/mr/device/default_memory_resource.hpp>
+#include <rmm/mr/device/device_memory_resource.hpp>
+#endif
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+namespace {
+
+// The smallest bin of BinningMemoryResource, which keeps the blocks
+// aligned as those of cudaMalloc.
+const size_t kMinBinBytes = 256;
+
+// Never destroyed, the static device vectors are freed after them.
+std::mutex &GetResourcesMutex() {
+    static std::mutex *mutex = new std::mutex();
+    return *mutex;
+}
+
+std::shared_ptr<MemoryResource> MakeDefaultResource() {
+#ifdef CUPOCH_CPU_BACKEND
+    return std::make_shared<HostMemoryResource>();
+#else
+#ifdef USE_ZERO_COPY
+    if (IsIntegratedDevice()) {
+        return std::make_shared<MappedHostMemoryResource>();
+    }
+#endif
+    return std::make_shared<CudaMemoryResource>();
+#endif
+}
+
+std::vector<std::shared_ptr<MemoryResource>> &GetResources() {
+    static auto *resources = new std::vector<std::shared_ptr<MemoryResource>>(
+            1, MakeDefaultResource());
+    return *resources;
+}
+
+std::atomic<MemoryResource *> current_resource(nullptr);
+std::atomic<MemoryResource *> volume_resource(nullptr);
+
+thread_local cudaStream_t allocation_stream = 0;
+
+}  // namespace
+
+void *CudaMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    void *ptr = nullptr;
+    if (cudaMalloc(&ptr, bytes) != cudaSuccess) {
+        cudaGetLastError();
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+// The deallocations run in destructors, so they warn instead of throwing.
+void CudaMemoryResource::Deallocate(void *ptr,
+                                    size_t bytes,
+                                    cudaStream_t stream) {
+    const cudaError_t err = cudaFree(ptr);
+    if (err != cudaSuccess) {
+        utility::LogWarning("[CudaMemoryResource] cudaFree failed: {}\n",
+                            cudaGetErrorString(err));
+    }
+}
+
+MappedHostMemoryResource::MappedHostMemoryResource(
+        bool write_combined /* = false*/)
+    : write_combined_(write_combined) {}
+
+// With the unified address space of the 64 bit platforms, the host pointer
+// of mapped memory is also its device pointer.
+void *MappedHostMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    const unsigned int flags =
+            cudaHostAllocMapped |
+            ((write_combined_) ? cudaHostAllocWriteCombined : 0);
+    void *ptr = nullptr;
+    if (cudaHostAlloc(&ptr, bytes, flags) != cudaSuccess) {
+        cudaGetLastError();
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void MappedHostMemoryResource::Deallocate(void *ptr,
+                                          size_t bytes,
+                                          cudaStream_t stream) {
+    const cudaError_t err = cudaFreeHost(ptr);
+    if (err != cudaSuccess) {
+        utility::LogWarning(
+                "[MappedHostMemoryResource] cudaFreeHost failed: {}\n",
+                cudaGetErrorString(err));
+    }
+}
+
+void *HostMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    return ::operator new(bytes);
+}
+
+void HostMemoryResource::Deallocate(void *ptr,
+                                    size_t bytes,
+                                    cudaStream_t stream) {
+    ::operator delete(ptr);
+}
+
+void *ManagedMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    void *ptr = nullptr;
+    if (cudaMallocManaged(&ptr, bytes) != cudaSuccess) {
+        cudaGetLastError();
+        throw std::bad_alloc();
+    }
+    // The hints are not supported by every device, and only tune the
+    // migrations.
+    const int device = GetDevice();
+    if (cudaMemAdvise(ptr, bytes, cudaMemAdviseSetPreferredLocation,
+                      device) != cudaSuccess ||
+        cudaMemAdvise(ptr, bytes, cudaMemAdviseSetAccessedBy,
+                      cudaCpuDeviceId) != cudaSuccess) {
+        cudaGetLastError();
+    }
+    return ptr;
+}
+
+void ManagedMemoryResource::Deallocate(void *ptr,
+                                       size_t bytes,
+                                       cudaStream_t stream) {
+    const cudaError_t err = cudaFree(ptr);
+    if (err != cudaSuccess) {
+        utility::LogWarning("[ManagedMemoryResource] cudaFree failed: {}\n",
+                            cudaGetErrorString(err));
+    }
+}
+
+#if CUDART_VERSION >= 11020
+
+CudaAsyncMemoryResource::CudaAsyncMemoryResource(
+        size_t initial_pool_size /* = 0*/,
+        size_t release_threshold /* = ~size_t(0)*/) {
+    cudaMemPoolProps props = {};
+    props.allocType = cudaMemAllocationTypePinned;
+    props.location.type = cudaMemLocationTypeDevice;
+    props.location.id = GetDevice();
+    cudaSafeCall(cudaMemPoolCreate(&pool_, &props));
+    uint64_t threshold = release_threshold;
+    cudaSafeCall(cudaMemPoolSetAttribute(
+            pool_, cudaMemPoolAttrReleaseThreshold, &threshold));
+    if (initial_pool_size > 0) {
+        // Freed below the threshold, the memory stays in the pool.
+        void *ptr = Allocate(initial_pool_size, 0);
+        Deallocate(ptr, initial_pool_size, 0);
+        cudaSafeCall(cudaStreamSynchronize(0));
+    }
+}
+
+CudaAsyncMemoryResource::~CudaAsyncMemoryResource() {
+    cudaDeviceSynchronize();
+    cudaMemPoolDestroy(pool_);
+}
+
+void *CudaAsyncMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    void *ptr = nullptr;
+    if (cudaMallocFromPoolAsync(&ptr, bytes, pool_, stream) != cudaSuccess) {
+        cudaGetLastError();
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void CudaAsyncMemoryResource::Deallocate(void *ptr,
+                                         size_t bytes,
+                                         cudaStream_t stream) {
+    const cudaError_t err = cudaFreeAsync(ptr, stream);
+    if (err != cudaSuccess) {
+        utility::LogWarning(
+                "[CudaAsyncMemoryResource] cudaFreeAsync failed: {}\n",
+                cudaGetErrorString(err));
+    }
+}
+
+#else
+
+CudaAsyncMemoryResource::CudaAsyncMemoryResource(
+        size_t initial_pool_size /* = 0*/,
+        size_t release_threshold /* = ~size_t(0)*/) {
+    throw CudaError(cudaErrorNotSupported,
+                    "[CudaAsyncMemoryResource] cudaMallocAsync requires "
+                    "CUDA 11.2.");
+}
+
+CudaAsyncMemoryResource::~CudaAsyncMemoryResource() {}
+
+void *CudaAsyncMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    throw std::bad_alloc();
+}
+
+void CudaAsyncMemoryResource::Deallocate(void *ptr,
+                                         size_t bytes,
+                                         cudaStream_t stream) {}
+
+#endif
+
+PerStreamMemoryResource::PerStreamMemoryResource(const Factory &factory)
+    : factory_(factory) {}
+
+MemoryResource &PerStreamMemoryResource::GetResource(cudaStream_t stream) {
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        for (const auto &entry : resources_) {
+            if (entry.first == stream) return *entry.second;
+        }
+    }
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    for (const auto &entry : resources_) {
+        if (entry.first == stream) return *entry.second;
+    }
+    resources_.emplace_back(stream, factory_());
+    return *resources_.back().second;
+}
+
+void *PerStreamMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    return GetResource(stream).Allocate(bytes, stream);
+}
+
+void PerStreamMemoryResource::Deallocate(void *ptr,
+                                         size_t bytes,
+                                         cudaStream_t stream) {
+    GetResource(stream).Deallocate(ptr, bytes, stream);
+}
+
+BinningMemoryResource::BinningMemoryResource(
+        const std::shared_ptr<MemoryResource> &upstream,
+        size_t max_bin_bytes /* = 1 << 20*/,
+        size_t chunk_bytes /* = 1 << 24*/)
+    : upstream_(upstream),
+      max_bin_bytes_(max_bin_bytes),
+      chunk_bytes_(chunk_bytes) {
+    for (size_t bytes = kMinBinBytes; bytes <= max_bin_bytes_; bytes <<= 1) {
+        bins_.emplace_back(new Bin());
+    }
+}
+
+BinningMemoryResource::~BinningMemoryResource() {
+    for (const auto &chunk : chunks_) {
+        upstream_->Deallocate(chunk.first, chunk.second, 0);
+    }
+}
+
+int BinningMemoryResource::BinOf(size_t bytes) const {
+    if (bytes > max_bin_bytes_) return -1;
+    int bin = 0;
+    while ((kMinBinBytes << bin) < bytes) ++bin;
+    return (bin < (int)bins_.size()) ? bin : -1;
+}
+
+void *BinningMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    const int b = BinOf(bytes);
+    if (b < 0) return upstream_->Allocate(bytes, stream);
+    Bin &bin = *bins_[b];
+    std::lock_guard<std::mutex> lock(bin.mutex_);
+    if (bin.free_blocks_.empty()) {
+        const size_t block_bytes = kMinBinBytes << b;
+        const size_t n_blocks = std::max(chunk_bytes_ / block_bytes, size_t(1));
+        char *chunk = static_cast<char *>(
+                upstream_->Allocate(n_blocks * block_bytes, stream));
+        {
+            std::lock_guard<std::mutex> chunks_lock(chunks_mutex_);
+            chunks_.emplace_back(chunk, n_blocks * block_bytes);
+        }
+        for (size_t i = n_blocks; i > 0; --i) {
+            bin.free_blocks_.push_back(chunk + (i - 1) * block_bytes);
+        }
+    }
+    void *ptr = bin.free_blocks_.back();
+    bin.free_blocks_.pop_back();
+    return ptr;
+}
+
+void BinningMemoryResource::Deallocate(void *ptr,
+                                       size_t bytes,
+                                       cudaStream_t stream) {
+    const int b = BinOf(bytes);
+    if (b < 0) {
+        upstream_->Deallocate(ptr, bytes, stream);
+        return;
+    }
+    Bin &bin = *bins_[b];
+    std::lock_guard<std::mutex> lock(bin.mutex_);
+    bin.free_blocks_.push_back(ptr);
+}
+
+LimitingMemoryResource::LimitingMemoryResource(
+        const std::shared_ptr<MemoryResource> &upstream, size_t limit_bytes)
+    : upstream_(upstream), limit_bytes_(limit_bytes) {}
+
+void *LimitingMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    if (allocated_bytes_.fetch_add(bytes) + bytes > limit_bytes_) {
+        allocated_bytes_ -= bytes;
+        throw std::bad_alloc();
+    }
+    try {
+        return upstream_->Allocate(bytes, stream);
+    } catch (...) {
+        allocated_bytes_ -= bytes;
+        throw;
+    }
+}
+
+void LimitingMemoryResource::Deallocate(void *ptr,
+                                        size_t bytes,
+                                        cudaStream_t stream) {
+    upstream_->Deallocate(ptr, bytes, stream);
+    allocated_bytes_ -= bytes;
+}
+
+#ifdef USE_RMM
+
+void *RmmMemoryResource::Allocate(size_t bytes, cudaStream_t stream) {
+    rmm::mr::device_memory_resource *resource =
+            (resource_) ? resource_ : rmm::mr::get_default_resource();
+    return resource->allocate(bytes, stream);
+}
+
+void RmmMemoryResource::Deallocate(void *ptr,
+                                   size_t bytes,
+                                   cudaStream_t stream) {
+    rmm::mr::device_memory_resource *resource =
+            (resource_) ? resource_ : rmm::mr::get_default_resource();
+    resource->deallocate(ptr, bytes, stream);
+}
+
+#endif
+
+void cupoch::utility::SetMemoryResource(
+        const std::shared_ptr<MemoryResource> &resource) {
+    std::lock_guard<std::mutex> lock(GetResourcesMutex());
+    GetResources().push_back(resource);
+    current_resource = resource.get();
+}
+
+MemoryResource *cupoch::utility::GetMemoryResource() {
+    MemoryResource *resource = current_resource;
+    if (resource) return resource;
+    static MemoryResource *default_resource = GetResources().front().get();
+    return default_resource;
+}
+
+bool cupoch::utility::EnableZeroCopyMemory(bool write_combined /* = false*/) {
+    if (!IsIntegratedDevice()) {
+        utility::LogWarning(
+                "[EnableZeroCopyMemory] The device is not integrated, the "
+                "device memory is kept.\n");
+        return false;
+    }
+    SetMemoryResource(
+            std::make_shared<MappedHostMemoryResource>(write_combined));
+    return true;
+}
+
+void cupoch::utility::SetVolumeMemoryResource(
+        const std::shared_ptr<MemoryResource> &resource) {
+    std::lock_guard<std::mutex> lock(GetResourcesMutex());
+    if (resource) GetResources().push_back(resource);
+    volume_resource = resource.get();
+}
+
+MemoryResource *cupoch::utility::GetVolumeMemoryResource() {
+    return volume_resource;
+}
+
+void cupoch::utility::EnableVolumeOversubscription(bool enable) {
+    SetVolumeMemoryResource(
+            (enable) ? std::make_shared<ManagedMemoryResource>() : nullptr);
+}
+
+bool cupoch::utility::IsManagedMemory(const void *ptr) {
+    if (!ptr) return false;
+    cudaPointerAttributes attributes;
+    if (cudaPointerGetAttributes(&attributes, ptr) != cudaSuccess) {
+        cudaGetLastError();
+        return false;
+    }
+    return attributes.type == cudaMemoryTypeManaged;
+}
+
+void cupoch::utility::PrefetchManagedRegion(const void *ptr,
+                                            size_t bytes,
+                                            size_t begin,
+                                            size_t end,
+                                            cudaStream_t stream /* = 0*/) {
+    if (!IsManagedMemory(ptr)) return;
+    // Without concurrent managed access, as on Windows and Jetson, the
+    // memory is not paged on demand and cannot be prefetched.
+    int concurrent = 0;
+    cudaSafeCall(cudaDeviceGetAttribute(
+            &concurrent, cudaDevAttrConcurrentManagedAccess, GetDevice()));
+    if (!concurrent) return;
+    end = std::min(end, bytes);
+    begin = std::min(begin, end);
+    const char *data = static_cast<const char *>(ptr);
+    if (begin > 0) {
+        cudaSafeCall(cudaMemPrefetchAsync(data, begin, cudaCpuDeviceId,
+                                          stream));
+    }
+    if (end > begin) {
+        cudaSafeCall(cudaMemPrefetchAsync(data + begin, end - begin,
+                                          GetDevice(), stream));
+    }
+    if (bytes > end) {
+        cudaSafeCall(cudaMemPrefetchAsync(data + end, bytes - end,
+                                          cudaCpuDeviceId, stream));
+    }
+}
+
+void cupoch::utility::SetAllocationStream(cudaStream_t stream) {
+    allocation_stream = stream;
+}
+
+cudaStream_t cupoch::utility::GetAllocationStream() {
+    return allocation_stream;
+}
+
+ScopedAllocationStream::ScopedAllocationStream(cudaStream_t stream)
+    : previous_(allocation_stream) {
+    allocation_stream = stream;
+}
+
+ScopedAllocationStream::~ScopedAllocationStream() {
+    allocation_stream = previous_;
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cuda_runtime.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#ifdef USE_RMM
+namespace rmm {
+namespace mr {
+class device_memory_resource;
+}
+}  // namespace rmm
+#endif
+
+namespace cupoch {
+namespace utility {
+
+/// \class MemoryResource
+///
+/// \brief Source of the device memory of device_vector.
+///
+/// Allocations are ordered on a stream: the memory of Allocate(bytes, s) is
+/// usable by the work queued on s afterwards, and Deallocate(ptr, bytes, s)
+/// only recycles it once the work queued on s before is done. Allocate
+/// throws std::bad_alloc on failure, which lets the out of memory handlers
+/// run. Resources must be thread safe.
+class MemoryResource {
+public:
+    virtual ~MemoryResource() = default;
+    virtual void *Allocate(size_t bytes, cudaStream_t stream) = 0;
+    virtual void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) = 0;
+    /// True if the host may read and write the memory through the pointers
+    /// returned by Allocate once the device is synchronized.
+    virtual bool IsHostAccessible() const { return false; }
+};
+
+/// cudaMalloc and cudaFree, which synchronize the device.
+class CudaMemoryResource : public MemoryResource {
+public:
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+};
+
+/// cudaMallocAsync and cudaFreeAsync from a pool of the driver, which
+/// allocate without synchronizing and reuse the memory freed on the same
+/// stream without any lock in cupoch. Requires CUDA 11.2.
+class CudaAsyncMemoryResource : public MemoryResource {
+public:
+    /// The pool keeps up to \p release_threshold bytes of freed memory
+    /// across the synchronizations instead of returning it to the device.
+    explicit CudaAsyncMemoryResource(size_t initial_pool_size = 0,
+                                     size_t release_threshold = ~size_t(0));
+    ~CudaAsyncMemoryResource() override;
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+
+private:
+#if CUDART_VERSION >= 11020
+    cudaMemPool_t pool_;
+#endif
+};
+
+/// \class MappedHostMemoryResource
+///
+/// \brief Pinned host memory mapped into the address space of the device,
+/// read by the kernels over the bus. On integrated GPUs such as Jetson the
+/// host and the device share the DRAM, so the kernels and the host use the
+/// same pages and the uploads and downloads become plain memcpy. Write
+/// combined memory skips the CPU caches: it speeds up the buffers the host
+/// only writes, e.g. the sensor frames, but makes the host reads very slow.
+class MappedHostMemoryResource : public MemoryResource {
+public:
+    explicit MappedHostMemoryResource(bool write_combined = false);
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+    bool IsHostAccessible() const override { return true; }
+
+private:
+    bool write_combined_;
+};
+
+/// \class HostMemoryResource
+///
+/// \brief Pageable host memory from the C++ allocator, the memory of the
+/// host device systems of thrust, OpenMP and TBB, which run the thrust
+/// algorithms on the CPU cores. The CUDA kernels can only read it on the
+/// systems with heterogeneous memory management.
+class HostMemoryResource : public MemoryResource {
+public:
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+    bool IsHostAccessible() const override { return true; }
+};
+
+/// \class ManagedMemoryResource
+///
+/// \brief cudaMallocManaged memory, migrated on demand between the host
+/// and the device. The allocations are advised to reside on the device and
+/// to stay mapped for the host, which avoids the page faults of the host
+/// accesses on the devices supporting concurrent managed access. The host
+/// must not touch the memory while kernels run on devices without it, as
+/// on Jetson.
+class ManagedMemoryResource : public MemoryResource {
+public:
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+    bool IsHostAccessible() const override { return true; }
+};
+
+/// \class PerStreamMemoryResource
+///
+/// \brief One resource per stream, created on first use by \p factory, so
+/// that the pipelines working on different streams do not share a pool or
+/// its lock. Memory must be deallocated on the stream it was allocated on.
+class PerStreamMemoryResource : public MemoryResource {
+public:
+    typedef std::function<std::shared_ptr<MemoryResource>()> Factory;
+    explicit PerStreamMemoryResource(const Factory &factory);
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+
+private:
+    MemoryResource &GetResource(cudaStream_t stream);
+
+    Factory factory_;
+    std::shared_timed_mutex mutex_;
+    std::vector<std::pair<cudaStream_t, std::shared_ptr<MemoryResource>>>
+            resources_;
+};
+
+/// \class BinningMemoryResource
+///
+/// \brief Arena for the small allocations: the sizes up to
+/// \p max_bin_bytes are rounded up to a power of 2 and served from a free
+/// list per size, refilled by slicing chunks of \p chunk_bytes allocated
+/// from \p upstream. Each bin has its own lock, and the larger allocations
+/// go to \p upstream. The free lists ignore the streams, so a binning
+/// resource shared by several streams must only be used under a
+/// PerStreamMemoryResource. The chunks are returned to \p upstream when the
+/// resource is destroyed.
+class BinningMemoryResource : public MemoryResource {
+public:
+    BinningMemoryResource(const std::shared_ptr<MemoryResource> &upstream,
+                          size_t max_bin_bytes = 1 << 20,
+                          size_t chunk_bytes = 1 << 24);
+    ~BinningMemoryResource() override;
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+    bool IsHostAccessible() const override {
+        return upstream_->IsHostAccessible();
+    }
+
+private:
+    struct Bin {
+        std::mutex mutex_;
+        std::vector<void *> free_blocks_;
+    };
+    int BinOf(size_t bytes) const;
+
+    std::shared_ptr<MemoryResource> upstream_;
+    size_t max_bin_bytes_;
+    size_t chunk_bytes_;
+    std::vector<std::unique_ptr<Bin>> bins_;
+    std::mutex chunks_mutex_;
+    std::vector<std::pair<void *, size_t>> chunks_;
+};
+
+/// Fails the allocations of \p upstream that would bring the memory in use
+/// above \p limit_bytes.
+class LimitingMemoryResource : public MemoryResource {
+public:
+    LimitingMemoryResource(const std::shared_ptr<MemoryResource> &upstream,
+                           size_t limit_bytes);
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+    bool IsHostAccessible() const override {
+        return upstream_->IsHostAccessible();
+    }
+    size_t GetAllocatedBytes() const { return allocated_bytes_; }
+    size_t GetLimit() const { return limit_bytes_; }
+
+private:
+    std::shared_ptr<MemoryResource> upstream_;
+    size_t limit_bytes_;
+    std::atomic<size_t> allocated_bytes_{0};
+};
+
+#ifdef USE_RMM
+/// Memory of \p resource, or of the default resource of RMM set by
+/// InitializeAllocator() if it is NULL.
+class RmmMemoryResource : public MemoryResource {
+public:
+    explicit RmmMemoryResource(rmm::mr::device_memory_resource *resource =
+                                       nullptr)
+        : resource_(resource) {}
+    void *Allocate(size_t bytes, cudaStream_t stream) override;
+    void Deallocate(void *ptr, size_t bytes, cudaStream_t stream) override;
+
+private:
+    rmm::mr::device_memory_resource *resource_;
+};
+#endif
+
+/// Resource of the device_vectors constructed from now on, the
+/// CudaMemoryResource by default, or the MappedHostMemoryResource on
+/// integrated GPUs when built with USE_ZERO_COPY. The vectors keep the
+/// resource they were constructed with, so the previous resources stay
+/// alive.
+void SetMemoryResource(const std::shared_ptr<MemoryResource> &resource);
+MemoryResource *GetMemoryResource();
+
+/// Allocates the device_vectors constructed from now on, and so the point
+/// clouds and images, in mapped host memory if the device is integrated.
+/// Returns false, leaving the resource unchanged, on discrete GPUs, where
+/// the kernels would read the memory over PCIe.
+bool EnableZeroCopyMemory(bool write_combined = false);
+
+/// Resource of the voxels of the dense volumes constructed from now on,
+/// UniformTSDFVolume and the DenseGrids, NULL by default for the resource
+/// of the other vectors. A ManagedMemoryResource lets the volumes exceed the
+/// device memory, the pages of the regions out of view being evicted to the
+/// host.
+void SetVolumeMemoryResource(const std::shared_ptr<MemoryResource> &resource);
+MemoryResource *GetVolumeMemoryResource();
+/// Backs the volumes constructed from now on by managed memory, or by the
+/// resource of the other vectors again if \p enable is false.
+void EnableVolumeOversubscription(bool enable);
+
+/// True if \p ptr points to managed memory.
+bool IsManagedMemory(const void *ptr);
+/// Enqueues on \p stream the migration of the bytes [begin, end) of the
+/// managed allocation [ptr, ptr + bytes) to the current device and of its
+/// other bytes to the host, so that only the working set of the next
+/// kernels stays resident. Does nothing if \p ptr is not managed.
+void PrefetchManagedRegion(const void *ptr,
+                           size_t bytes,
+                           size_t begin,
+                           size_t end,
+                           cudaStream_t stream = 0);
+
+/// Stream the device_vectors constructed by the calling thread allocate
+/// and free their memory on, 0 by default.
+void SetAllocationStream(cudaStream_t stream);
+cudaStream_t GetAllocationStream();
+
+/// \class ScopedAllocationStream
+///
+/// \brief Sets the allocation stream of the calling thread in the
+/// enclosing scope, e.g. to the stream of the ExecutionContext of a sensor
+/// pipeline.
+class ScopedAllocationStream {
+public:
+    explicit ScopedAllocationStream(cudaStream_t stream);
+    ~ScopedAllocationStream();
+    ScopedAllocationStream(const ScopedAllocationStream &) = delete;
+    ScopedAllocationStream &operator=(const ScopedAllocationStream &) =
+            delete;
+
+private:
+    cudaStream_t previous_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,143 @@
+#include "cupoch/utility/memory_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "cupoch/utility/console.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+namespace {
+
+const int kNumSubsystems = int(MemorySubsystem::NumSubsystems);
+
+const char *const kSubsystemNames[kNumSubsystems] = {
+        "Other", "PointCloud", "KDTree", "TSDF", "Occupancy", "Visualizer"};
+
+struct Allocation {
+    int subsystem_;
+    size_t bytes_;
+};
+
+class MemoryTracker {
+public:
+    // Never destroyed, the static device vectors are freed after it.
+    static MemoryTracker &GetInstance() {
+        static MemoryTracker *tracker = new MemoryTracker();
+        return *tracker;
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::mutex mutex_;
+    std::unordered_map<void *, Allocation> allocations_;
+    std::atomic<size_t> num_tracked_{0};
+    // The subsystems, then the total.
+    MemoryUsage usages_[kNumSubsystems + 1];
+
+    void Add(int index, size_t bytes) {
+        MemoryUsage &usage = usages_[index];
+        usage.live_bytes_ += bytes;
+        usage.peak_bytes_ = std::max(usage.peak_bytes_, usage.live_bytes_);
+        ++usage.num_allocations_;
+    }
+
+    void Remove(int index, size_t bytes) {
+        MemoryUsage &usage = usages_[index];
+        usage.live_bytes_ -= bytes;
+        --usage.num_allocations_;
+    }
+
+private:
+    MemoryTracker() {
+        for (int i = 0; i < kNumSubsystems; ++i) {
+            usages_[i].subsystem_ = kSubsystemNames[i];
+        }
+        usages_[kNumSubsystems].subsystem_ = "Total";
+    }
+};
+
+thread_local MemorySubsystem current_subsystem = MemorySubsystem::Other;
+
+}  // namespace
+
+void utility::EnableMemoryTracking(bool enable) {
+    MemoryTracker::GetInstance().enabled_ = enable;
+}
+
+bool utility::IsMemoryTrackingEnabled() {
+    return MemoryTracker::GetInstance().enabled_;
+}
+
+void utility::RecordDeviceAllocation(void *ptr, size_t bytes) {
+    MemoryTracker &tracker = MemoryTracker::GetInstance();
+    if (!tracker.enabled_ || ptr == nullptr) return;
+    const int subsystem = int(current_subsystem);
+    std::lock_guard<std::mutex> lock(tracker.mutex_);
+    tracker.allocations_[ptr] = {subsystem, bytes};
+    ++tracker.num_tracked_;
+    tracker.Add(subsystem, bytes);
+    tracker.Add(kNumSubsystems, bytes);
+}
+
+void utility::RecordDeviceDeallocation(void *ptr) {
+    MemoryTracker &tracker = MemoryTracker::GetInstance();
+    // Also looked up when disabled, for the memory accounted before.
+    if (tracker.num_tracked_ == 0) return;
+    std::lock_guard<std::mutex> lock(tracker.mutex_);
+    auto it = tracker.allocations_.find(ptr);
+    if (it == tracker.allocations_.end()) return;
+    tracker.Remove(it->second.subsystem_, it->second.bytes_);
+    tracker.Remove(kNumSubsystems, it->second.bytes_);
+    tracker.allocations_.erase(it);
+    --tracker.num_tracked_;
+}
+
+std::vector<MemoryUsage> utility::GetMemoryUsage() {
+    MemoryTracker &tracker = MemoryTracker::GetInstance();
+    std::lock_guard<std::mutex> lock(tracker.mutex_);
+    return std::vector<MemoryUsage>(tracker.usages_,
+                                    tracker.usages_ + kNumSubsystems + 1);
+}
+
+MemoryUsage utility::GetMemoryUsage(MemorySubsystem subsystem) {
+    if (subsystem == MemorySubsystem::NumSubsystems) {
+        utility::LogError("[GetMemoryUsage] Invalid subsystem.");
+    }
+    MemoryTracker &tracker = MemoryTracker::GetInstance();
+    std::lock_guard<std::mutex> lock(tracker.mutex_);
+    return tracker.usages_[int(subsystem)];
+}
+
+void utility::ResetPeakMemoryUsage() {
+    MemoryTracker &tracker = MemoryTracker::GetInstance();
+    std::lock_guard<std::mutex> lock(tracker.mutex_);
+    for (auto &usage : tracker.usages_) usage.peak_bytes_ = usage.live_bytes_;
+}
+
+std::string utility::GetMemoryReport() {
+    const auto usages = GetMemoryUsage();
+    std::string report =
+            fmt::format("{:<12} {:>12} {:>12} {:>12}\n", "Subsystem",
+                        "Live (MB)", "Peak (MB)", "Allocations");
+    for (const auto &usage : usages) {
+        report += fmt::format("{:<12} {:>12.2f} {:>12.2f} {:>12}\n",
+                              usage.subsystem_, usage.live_bytes_ / 1048576.0,
+                              usage.peak_bytes_ / 1048576.0,
+                              usage.num_allocations_);
+    }
+    return report;
+}
+
+MemorySubsystem utility::GetMemorySubsystem() { return current_subsystem; }
+
+ScopedMemorySubsystem::ScopedMemorySubsystem(MemorySubsystem subsystem)
+    : previous_(current_subsystem) {
+    current_subsystem = subsystem;
+}
+
+ScopedMemorySubsystem::~ScopedMemorySubsystem() {
+    current_subsystem = previous_;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cupoch {
+namespace utility {
+
+/// Subsystems the device allocations are attributed to.
+enum class MemorySubsystem {
+    Other = 0,
+    PointCloud,
+    KDTree,
+    TSDF,
+    Occupancy,
+    Visualizer,
+    NumSubsystems,
+};
+
+/// Device memory held by a subsystem, in bytes.
+struct MemoryUsage {
+    std::string subsystem_;
+    size_t live_bytes_ = 0;
+    /// High-water mark since the tracking started or the last reset.
+    size_t peak_bytes_ = 0;
+    size_t num_allocations_ = 0;
+};
+
+/// Turns the accounting of the allocations of device_vector on or off, it is
+/// off by default. The memory allocated while it is off isn't accounted.
+void EnableMemoryTracking(bool enable);
+bool IsMemoryTrackingEnabled();
+
+/// Called by the allocator of device_vector.
+void RecordDeviceAllocation(void *ptr, size_t bytes);
+void RecordDeviceDeallocation(void *ptr);
+
+/// Usage of every subsystem, followed by the total as "Total".
+std::vector<MemoryUsage> GetMemoryUsage();
+MemoryUsage GetMemoryUsage(MemorySubsystem subsystem);
+/// Sets the peaks to the live usages.
+void ResetPeakMemoryUsage();
+/// Table of the live and peak usages.
+std::string GetMemoryReport();
+
+/// Subsystem the allocations of the calling thread are attributed to.
+MemorySubsystem GetMemorySubsystem();
+
+/// \class ScopedMemorySubsystem
+///
+/// \brief Attributes the device allocations of the calling thread in the
+/// enclosing scope to \p subsystem. The innermost scope wins, so a KDTree
+/// built inside a point cloud operation is accounted to the KDTree. The
+/// memory stays attributed to the subsystem that allocated it when it is
+/// released elsewhere.
+class ScopedMemorySubsystem {
+public:
+    explicit ScopedMemorySubsystem(MemorySubsystem subsystem);
+    ~ScopedMemorySubsystem();
+    ScopedMemorySubsystem(const ScopedMemorySubsystem &) = delete;
+    ScopedMemorySubsystem &operator=(const ScopedMemorySubsystem &) = delete;
+
+private:
+    MemorySubsystem previous_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,47 @@
+#include <algorithm>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/multi_device.h"
+
+namespace cupoch {
+namespace utility {
+
+std::vector<int> ResolveDevices(const std::vector<int> &devices) {
+    int n_devices = 0;
+    cudaSafeCall(cudaGetDeviceCount(&n_devices));
+    std::vector<int> resolved = devices;
+    if (resolved.empty()) {
+        for (int i = 0; i < n_devices; ++i) resolved.push_back(i);
+    }
+    for (int device : resolved) {
+        if (device < 0 || device >= n_devices) {
+            LogError("[ResolveDevices] Invalid device {:d}.", device);
+        }
+    }
+    return resolved;
+}
+
+void EnablePeerAccess(const std::vector<int> &devices) {
+    std::vector<int> peers = devices;
+    peers.push_back(GetDevice());
+    std::sort(peers.begin(), peers.end());
+    peers.erase(std::unique(peers.begin(), peers.end()), peers.end());
+    for (int device : peers) {
+        DeviceScope scope(device);
+        for (int peer : peers) {
+            int can_access = 0;
+            if (peer == device) continue;
+            cudaSafeCall(cudaDeviceCanAccessPeer(&can_access, device, peer));
+            if (!can_access) continue;
+            const cudaError_t err = cudaDeviceEnablePeerAccess(peer, 0);
+            if (err == cudaErrorPeerAccessAlreadyEnabled) {
+                cudaGetLastError();
+            } else {
+                cudaSafeCall(err);
+            }
+        }
+    }
+}
+
+}  // namespace utility
+}  // namespace cupoch
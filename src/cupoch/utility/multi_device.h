@@ -0,0 +1,83 @@
+#pragma once
+
+#include <future>
+#include <vector>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace utility {
+
+/// Makes \p device the current device until the end of the scope.
+class DeviceScope {
+public:
+    explicit DeviceScope(int device) : previous_(GetDevice()) {
+        SetDevice(device);
+    }
+    ~DeviceScope() { SetDevice(previous_); }
+    DeviceScope(const DeviceScope &) = delete;
+    DeviceScope &operator=(const DeviceScope &) = delete;
+
+private:
+    int previous_;
+};
+
+/// Returns \p devices, or all the visible devices when it is empty. Throws
+/// on an invalid device number.
+std::vector<int> ResolveDevices(const std::vector<int> &devices);
+
+/// Enables the direct peer access between all the pairs of \p devices and
+/// the current device that support it.
+void EnablePeerAccess(const std::vector<int> &devices);
+
+/// Runs func(i) on a thread of its own for each device, the device being
+/// current, and waits for the work queued by all the calls. The buffers
+/// allocated on a device must be released by the call of that device.
+template <typename Func>
+void ParallelForDevices(const std::vector<int> &devices, const Func &func) {
+    // The workers read the inputs queued on the stream of the caller.
+    cudaSafeCall(cudaStreamSynchronize(0));
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < devices.size(); ++i) {
+        futures.push_back(std::async(std::launch::async, [&func, &devices, i] {
+            SetDevice(devices[i]);
+            func(i);
+            cudaSafeCall(cudaStreamSynchronize(0));
+        }));
+    }
+    for (auto &future : futures) future.get();
+}
+
+/// Copies \p src, on \p src_device, to \p dst on the current device.
+template <typename T>
+void CopyFromDevice(const device_vector<T> &src,
+                    int src_device,
+                    device_vector<T> &dst) {
+    dst.resize(src.size());
+    if (src.empty()) return;
+    cudaSafeCall(cudaMemcpyPeerAsync(thrust::raw_pointer_cast(dst.data()),
+                                     GetDevice(),
+                                     thrust::raw_pointer_cast(src.data()),
+                                     src_device, src.size() * sizeof(T), 0));
+}
+
+/// Copies \p src, on the current device, to \p dst on \p dst_device.
+template <typename T>
+void CopyToDevice(const device_vector<T> &src,
+                  int dst_device,
+                  device_vector<T> &dst) {
+    const int src_device = GetDevice();
+    {
+        DeviceScope scope(dst_device);
+        dst.resize(src.size());
+        cudaSafeCall(cudaStreamSynchronize(0));
+    }
+    if (src.empty()) return;
+    cudaSafeCall(cudaMemcpyPeerAsync(thrust::raw_pointer_cast(dst.data()),
+                                     dst_device,
+                                     thrust::raw_pointer_cast(src.data()),
+                                     src_device, src.size() * sizeof(T), 0));
+}
+
+}  // namespace utility
+}  // namespace cupoch
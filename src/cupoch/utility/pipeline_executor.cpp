@@ -0,0 +1,232 @@
+#include "cupoch/utility/pipeline_executor.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/memory_resource.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+PipelineExecutor::PipelineExecutor(size_t max_frames_in_flight)
+    : max_frames_in_flight_(std::max<size_t>(max_frames_in_flight, 1)) {}
+
+PipelineExecutor::~PipelineExecutor() {
+    if (started_) {
+        try {
+            WaitAll();
+        } catch (const std::exception &e) {
+            LogWarning("[PipelineExecutor] {}", e.what());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto &stage : stages_) stage->thread_.join();
+    }
+    for (auto &stage : stages_) {
+        for (auto &event : stage->start_events_) cudaEventDestroy(event);
+        for (auto &event : stage->end_events_) cudaEventDestroy(event);
+    }
+}
+
+int PipelineExecutor::AddStage(const std::string &name,
+                               const StageFunction &function,
+                               const std::vector<int> &dependencies) {
+    if (started_) {
+        LogError("[PipelineExecutor] Stages must be added before the first "
+                 "frame is submitted.");
+        return -1;
+    }
+    const int id = stages_.size();
+    for (int dep : dependencies) {
+        if (dep < 0 || dep >= id) {
+            LogError("[PipelineExecutor] Stage {} depends on the unknown "
+                     "stage {:d}.",
+                     name, dep);
+            return -1;
+        }
+    }
+    auto stage = std::make_unique<Stage>();
+    stage->name_ = name;
+    stage->function_ = function;
+    stage->dependencies_ = dependencies;
+    stage->ctx_ = std::make_unique<ExecutionContext>();
+    stage->start_events_.resize(max_frames_in_flight_);
+    stage->end_events_.resize(max_frames_in_flight_);
+    for (size_t i = 0; i < max_frames_in_flight_; ++i) {
+        cudaSafeCall(cudaEventCreate(&stage->start_events_[i]));
+        cudaSafeCall(cudaEventCreate(&stage->end_events_[i]));
+    }
+    stage->host_ms_.resize(max_frames_in_flight_, 0.0f);
+    stages_.push_back(std::move(stage));
+    return id;
+}
+
+void PipelineExecutor::Start() {
+    started_ = true;
+    // The stage threads use the device of the thread submitting the frames.
+    const int device = GetDevice();
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        stages_[i]->thread_ = std::thread([this, i, device]() {
+            SetDevice(device);
+            RunStage(i);
+        });
+    }
+}
+
+void PipelineExecutor::RunStage(int id) {
+    Stage &stage = *stages_[id];
+    ScopedAllocationStream allocation_stream(stage.ctx_->GetStream());
+    while (true) {
+        size_t frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto is_ready = [&]() {
+                if (stage.done_ >= submitted_) return false;
+                for (int dep : stage.dependencies_) {
+                    if (stages_[dep]->done_ <= stage.done_) return false;
+                }
+                return true;
+            };
+            cv_.wait(lock, [&]() { return stopping_ || is_ready(); });
+            if (!is_ready()) return;
+            frame = stage.done_;
+        }
+        const size_t slot = frame % max_frames_in_flight_;
+        const cudaStream_t stream = stage.ctx_->GetStream();
+        try {
+            for (int dep : stage.dependencies_) {
+                stage.ctx_->WaitEvent(stages_[dep]->end_events_[slot]);
+            }
+            cudaSafeCall(cudaEventRecord(stage.start_events_[slot], stream));
+            const auto start = std::chrono::steady_clock::now();
+            {
+                ScopedProfile profile(stage.name_.c_str(), stream);
+                stage.function_(*stage.ctx_, frame);
+            }
+            stage.host_ms_[slot] =
+                    std::chrono::duration<float, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+            cudaSafeCall(cudaEventRecord(stage.end_events_[slot], stream));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stage.done_;
+        }
+        cv_.notify_all();
+    }
+}
+
+size_t PipelineExecutor::Submit() {
+    if (!started_) Start();
+    while (submitted_ - retired_ >= max_frames_in_flight_) RetireFrame();
+    RethrowError();
+    size_t frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame = submitted_++;
+    }
+    cv_.notify_all();
+    return frame;
+}
+
+void PipelineExecutor::RetireFrame() {
+    const size_t frame = retired_;
+    const size_t slot = frame % max_frames_in_flight_;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]() {
+            for (const auto &stage : stages_) {
+                if (stage->done_ <= frame) return false;
+            }
+            return true;
+        });
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &stage : stages_) {
+        cudaSafeCall(cudaEventSynchronize(stage->end_events_[slot]));
+        float device_ms = 0.0f;
+        if (cudaEventElapsedTime(&device_ms, stage->start_events_[slot],
+                                 stage->end_events_[slot]) != cudaSuccess) {
+            // The events of a failed stage may not have been recorded.
+            cudaGetLastError();
+            continue;
+        }
+        ++stage->count_;
+        stage->total_host_ms_ += stage->host_ms_[slot];
+        stage->total_device_ms_ += device_ms;
+        stage->max_device_ms_ = std::max(stage->max_device_ms_, device_ms);
+    }
+    ++retired_;
+}
+
+void PipelineExecutor::RethrowError() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void PipelineExecutor::Wait(size_t frame) {
+    if (frame >= submitted_) {
+        LogError("[PipelineExecutor] Frame {:d} was not submitted.",
+                 (int)frame);
+        return;
+    }
+    while (retired_ <= frame) RetireFrame();
+    RethrowError();
+}
+
+void PipelineExecutor::WaitAll() {
+    if (submitted_ > 0) Wait(submitted_ - 1);
+}
+
+std::vector<PipelineStageStats> PipelineExecutor::GetStageStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PipelineStageStats> stats;
+    for (const auto &stage : stages_) {
+        PipelineStageStats s;
+        s.name_ = stage->name_;
+        s.count_ = stage->count_;
+        if (stage->count_ > 0) {
+            s.mean_host_ms_ = stage->total_host_ms_ / stage->count_;
+            s.mean_device_ms_ = stage->total_device_ms_ / stage->count_;
+        }
+        s.max_device_ms_ = stage->max_device_ms_;
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+std::string PipelineExecutor::GetStageReport() const {
+    std::string report = fmt::format("{:<32} {:>8} {:>14} {:>14} {:>14}\n",
+                                     "Stage", "Count", "Host (ms)",
+                                     "Device (ms)", "Max (ms)");
+    for (const auto &stat : GetStageStats()) {
+        report += fmt::format("{:<32} {:>8} {:>14.3f} {:>14.3f} {:>14.3f}\n",
+                              stat.name_, stat.count_, stat.mean_host_ms_,
+                              stat.mean_device_ms_, stat.max_device_ms_);
+    }
+    return report;
+}
+
+void PipelineExecutor::ResetStageStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &stage : stages_) {
+        stage->count_ = 0;
+        stage->total_host_ms_ = 0.0;
+        stage->total_device_ms_ = 0.0;
+        stage->max_device_ms_ = 0.0f;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <cuda_runtime.h>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cupoch/utility/execution_context.h"
+
+namespace cupoch {
+namespace utility {
+
+/// Latency of a stage of a PipelineExecutor over the retired frames, in
+/// milliseconds.
+struct PipelineStageStats {
+    std::string name_;
+    size_t count_ = 0;
+    /// Time the host spent in the stage function.
+    float mean_host_ms_ = 0.0f;
+    /// GPU time of the work the stage enqueued on its stream, from the
+    /// completion of its dependencies.
+    float mean_device_ms_ = 0.0f;
+    float max_device_ms_ = 0.0f;
+};
+
+/// \class PipelineExecutor
+///
+/// \brief Runs the stages of a per-frame processing graph, e.g. ingest,
+/// filter, normals, odometry, integration and visualization, on their own
+/// host threads and streams.
+///
+/// Each stage is called once per frame with its ExecutionContext, on which
+/// it enqueues its work, and with the frame number. A stage runs frame f
+/// once its dependencies have run it, and its stream waits for the work
+/// they enqueued, so the independent stages overlap and consecutive frames
+/// are pipelined: the ingest of frame f + 1 runs along the integration of
+/// frame f. The device vectors the stages construct are allocated on their
+/// streams.
+///
+/// At most \p max_frames_in_flight frames are processed at once, so the
+/// per-frame data passed from a stage to the next one can live in
+/// GetMaxFramesInFlight() slots indexed by frame % GetMaxFramesInFlight().
+class PipelineExecutor {
+public:
+    typedef std::function<void(ExecutionContext &ctx, size_t frame)>
+            StageFunction;
+
+    explicit PipelineExecutor(size_t max_frames_in_flight = 2);
+    /// Waits for the submitted frames.
+    ~PipelineExecutor();
+    PipelineExecutor(const PipelineExecutor &) = delete;
+    PipelineExecutor &operator=(const PipelineExecutor &) = delete;
+
+public:
+    /// Adds a stage run after the stages \p dependencies, given by the ids
+    /// returned by the previous calls, and returns its id. The stages must
+    /// be added before the first frame is submitted.
+    int AddStage(const std::string &name,
+                 const StageFunction &function,
+                 const std::vector<int> &dependencies = {});
+
+    /// Starts the processing of the next frame and returns its number,
+    /// waiting first for the oldest frame if max_frames_in_flight frames
+    /// are being processed.
+    size_t Submit();
+
+    /// Blocks until the stages have run \p frame and their GPU work is
+    /// done. Rethrows the first exception thrown by a stage.
+    void Wait(size_t frame);
+    /// Blocks until all the submitted frames are done.
+    void WaitAll();
+
+    size_t GetMaxFramesInFlight() const { return max_frames_in_flight_; }
+    size_t GetNumStages() const { return stages_.size(); }
+    ExecutionContext &GetContext(int stage) { return *stages_[stage]->ctx_; }
+
+    /// Latencies of the stages over the frames done so far, in the order
+    /// they were added.
+    std::vector<PipelineStageStats> GetStageStats() const;
+    /// Table of GetStageStats().
+    std::string GetStageReport() const;
+    void ResetStageStats();
+
+private:
+    struct Stage {
+        std::string name_;
+        StageFunction function_;
+        std::vector<int> dependencies_;
+        std::unique_ptr<ExecutionContext> ctx_;
+        /// Events recorded around the work of the stage, per frame slot.
+        std::vector<cudaEvent_t> start_events_;
+        std::vector<cudaEvent_t> end_events_;
+        std::vector<float> host_ms_;
+        /// Number of frames the stage has run.
+        size_t done_ = 0;
+        std::thread thread_;
+        size_t count_ = 0;
+        double total_host_ms_ = 0.0;
+        double total_device_ms_ = 0.0;
+        float max_device_ms_ = 0.0f;
+    };
+
+    void Start();
+    void RunStage(int id);
+    /// Waits for the oldest frame and adds its latencies to the stats.
+    void RetireFrame();
+    void RethrowError();
+
+    size_t max_frames_in_flight_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+    bool started_ = false;
+    bool stopping_ = false;
+    size_t submitted_ = 0;
+    size_t retired_ = 0;
+    std::exception_ptr error_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
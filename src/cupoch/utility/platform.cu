@@ -1,15 +1,46 @@
 #include "cupoch/utility/platform.h"
+#ifndef CUPOCH_CPU_BACKEND
 #if defined(__arm__) || defined(__aarch64__)
 #include <GL/gl.h>
 #endif
 #include <cuda_gl_interop.h>
+#endif
 
+#include <atomic>
 #include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
 
 using namespace cupoch;
 using namespace cupoch::utility;
 
-cudaStream_t cupoch::utility::GetStream(size_t i) {
+namespace {
+
+std::atomic<bool> per_thread_streams(false);
+std::atomic<bool> deterministic_mode(false);
+// -1 if the thread follows the global mode.
+thread_local int thread_deterministic_mode = -1;
+
+struct ThreadStreams {
+    ThreadStreams() {
+        for (size_t i = 0; i < MAX_NUM_STREAMS; ++i) streams_[i] = nullptr;
+    }
+    ~ThreadStreams() {
+        for (size_t i = 0; i < MAX_NUM_STREAMS; ++i) {
+            if (streams_[i]) cudaStreamDestroy(streams_[i]);
+        }
+    }
+    cudaStream_t Get(size_t i) {
+        if (!streams_[i]) {
+            cudaStreamCreateWithFlags(&streams_[i], cudaStreamNonBlocking);
+        }
+        return streams_[i];
+    }
+    cudaStream_t streams_[MAX_NUM_STREAMS];
+};
+
+cudaStream_t GetGlobalStream(size_t i) {
     static std::once_flag streamInitFlags[MAX_NUM_STREAMS];
     static cudaStream_t streams[MAX_NUM_STREAMS];
     std::call_once(streamInitFlags[i],
@@ -17,19 +48,129 @@ cudaStream_t cupoch::utility::GetStream(size_t i) {
     return streams[i];
 }
 
+std::mutex oom_handlers_mutex;
+std::vector<std::pair<int, OutOfMemoryHandler>> oom_handlers;
+int next_oom_handler_id = 0;
+
+}  // namespace
+
+void cupoch::utility::SetPerThreadStreams(bool enable) {
+    per_thread_streams = enable;
+}
+
+bool cupoch::utility::IsPerThreadStreams() { return per_thread_streams; }
+
+void cupoch::utility::SetDeterministicMode(bool enable) {
+    deterministic_mode = enable;
+}
+
+bool cupoch::utility::IsDeterministicMode() {
+    if (thread_deterministic_mode >= 0) return thread_deterministic_mode != 0;
+    return deterministic_mode;
+}
+
+ScopedDeterministicMode::ScopedDeterministicMode(bool enable)
+    : previous_(thread_deterministic_mode) {
+    thread_deterministic_mode = enable ? 1 : 0;
+}
+
+ScopedDeterministicMode::~ScopedDeterministicMode() {
+    thread_deterministic_mode = previous_;
+}
+
+cudaStream_t cupoch::utility::GetStream(size_t i) {
+#ifdef CUPOCH_CPU_BACKEND
+    // The host device systems run the algorithms in order on the calling
+    // thread, and there is no device to create the streams on.
+    return 0;
+#else
+    if (per_thread_streams) {
+        thread_local ThreadStreams streams;
+        return streams.Get(i);
+    }
+    return GetGlobalStream(i);
+#endif
+}
+
+void cupoch::utility::SynchronizeStreams(size_t n) {
+#ifndef CUPOCH_CPU_BACKEND
+    for (size_t i = 0; i < n; ++i) {
+        cudaSafeCall(cudaStreamSynchronize(GetStream(i)));
+    }
+#endif
+}
+
 int cupoch::utility::GetDevice() {
+#ifdef CUPOCH_CPU_BACKEND
+    return 0;
+#else
     int device_no;
     cudaGetDevice(&device_no);
     return device_no;
+#endif
 }
 
-void cupoch::utility::SetDevice(int device_no) { cudaSetDevice(device_no); }
+void cupoch::utility::SetDevice(int device_no) {
+#ifndef CUPOCH_CPU_BACKEND
+    cudaSetDevice(device_no);
+#endif
+}
 
-void cupoch::utility::Error(const char *error_string,
+bool cupoch::utility::IsIntegratedDevice() {
+#ifdef CUPOCH_CPU_BACKEND
+    return false;
+#else
+    int integrated = 0;
+    cudaSafeCall(cudaDeviceGetAttribute(&integrated, cudaDevAttrIntegrated,
+                                        GetDevice()));
+    return integrated != 0;
+#endif
+}
+
+void cupoch::utility::Error(cudaError_t error,
                             const char *file,
                             const int line,
                             const char *func) {
-    std::cout << "Error: " << error_string << "\t" << file << ":" << line
-              << std::endl;
-    exit(0);
+    std::ostringstream what;
+    what << "CUDA error: " << cudaGetErrorString(error) << " at " << file
+         << ":" << line;
+    if (func && *func) what << " (" << func << ")";
+    if (error == cudaErrorMemoryAllocation) throw OutOfMemoryError(what.str());
+    throw CudaError(error, what.str());
+}
+
+int cupoch::utility::AddOutOfMemoryHandler(const OutOfMemoryHandler &handler) {
+    std::lock_guard<std::mutex> lock(oom_handlers_mutex);
+    oom_handlers.emplace_back(next_oom_handler_id, handler);
+    return next_oom_handler_id++;
+}
+
+void cupoch::utility::RemoveOutOfMemoryHandler(int id) {
+    std::lock_guard<std::mutex> lock(oom_handlers_mutex);
+    for (auto it = oom_handlers.begin(); it != oom_handlers.end(); ++it) {
+        if (it->first == id) {
+            oom_handlers.erase(it);
+            return;
+        }
+    }
+}
+
+void cupoch::utility::ClearOutOfMemoryHandlers() {
+    std::lock_guard<std::mutex> lock(oom_handlers_mutex);
+    oom_handlers.clear();
+}
+
+bool cupoch::utility::HandleOutOfMemory(size_t bytes, int attempt) {
+    if (attempt >= kMaxOutOfMemoryRetries) return false;
+    // The handlers run unlocked, so that they can remove themselves.
+    std::vector<std::pair<int, OutOfMemoryHandler>> handlers;
+    {
+        std::lock_guard<std::mutex> lock(oom_handlers_mutex);
+        handlers = oom_handlers;
+    }
+    bool released = false;
+    for (const auto &handler : handlers) {
+        if (handler.second(bytes)) released = true;
+    }
+    return released;
 }
\ No newline at end of file
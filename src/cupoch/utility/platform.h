@@ -1,7 +1,10 @@
 #pragma once
 #include <cuda_runtime.h>
 
+#include <functional>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 #ifdef _WIN32
 #define __FILENAME__ \
@@ -16,22 +19,122 @@
 #else /* defined(__CUDACC__) || defined(__MSVC__) */
 #define cudaSafeCall(expr) ___cudaSafeCall(expr, __FILENAME__, __LINE__)
 #endif
+// Same as cudaSafeCall() for the allocating calls, e.g. cudaMallocPitch(),
+// which are wrapped so that they can be retried after an out of memory
+// handler released memory. The other calls must be evaluated once.
+#if defined(__GNUC__)
+#define cudaSafeMalloc(expr)                                               \
+    ___cudaSafeMalloc([&]() -> cudaError_t { return (expr); }, __FILENAME__, \
+                      __LINE__, __func__)
+#else /* defined(__CUDACC__) || defined(__MSVC__) */
+#define cudaSafeMalloc(expr)                                               \
+    ___cudaSafeMalloc([&]() -> cudaError_t { return (expr); }, __FILENAME__, \
+                      __LINE__)
+#endif
 
 namespace cupoch {
 namespace utility {
 
 static const size_t MAX_NUM_STREAMS = 16;
 
+/// Selects whether GetStream() hands out one stream set shared by all host
+/// threads (default) or a separate non-blocking stream set for each host
+/// thread. Each thread then only waits for its own work.
+void SetPerThreadStreams(bool enable);
+
+bool IsPerThreadStreams();
+
 cudaStream_t GetStream(size_t i);
 
+/// Blocks the host until the work queued on GetStream(0), ...,
+/// GetStream(n - 1) is done. This replaces device wide synchronizations
+/// after fanning work out to several streams.
+void SynchronizeStreams(size_t n);
+
+/// Forces the deterministic variant of the algorithms that also have a
+/// faster one accumulating with atomics, e.g. the hashed
+/// PointCloud::VoxelDownSample() and the reduction of the normal equations
+/// of the registrations and odometries, so that the runs are bitwise
+/// reproducible. Off by default, for tests and replay debugging.
+void SetDeterministicMode(bool enable);
+
+/// True if the deterministic mode is set globally or by a
+/// ScopedDeterministicMode of the calling thread.
+bool IsDeterministicMode();
+
+/// \class ScopedDeterministicMode
+///
+/// \brief Overrides the deterministic mode for the calling thread in the
+/// enclosing scope.
+class ScopedDeterministicMode {
+public:
+    explicit ScopedDeterministicMode(bool enable = true);
+    ~ScopedDeterministicMode();
+    ScopedDeterministicMode(const ScopedDeterministicMode &) = delete;
+    ScopedDeterministicMode &operator=(const ScopedDeterministicMode &) =
+            delete;
+
+private:
+    int previous_;
+};
+
 int GetDevice();
 
 void SetDevice(int device_no);
 
-void Error(const char *error_string,
+/// True if the current device shares the memory of the host, as the
+/// Jetson boards.
+bool IsIntegratedDevice();
+
+/// \class CudaError
+///
+/// \brief Thrown by cudaSafeCall() on a failed CUDA call. The errors of a
+/// kernel, such as illegal addresses, leave the context unusable, so only
+/// the out of memory errors are worth recovering from.
+class CudaError : public std::runtime_error {
+public:
+    CudaError(cudaError_t error, const std::string &what)
+        : std::runtime_error(what), error_(error) {}
+    cudaError_t GetError() const { return error_; }
+
+private:
+    cudaError_t error_;
+};
+
+/// Thrown once the out of memory handlers could not free enough memory.
+class OutOfMemoryError : public CudaError {
+public:
+    explicit OutOfMemoryError(const std::string &what)
+        : CudaError(cudaErrorMemoryAllocation, what) {}
+};
+
+/// Throws OutOfMemoryError or CudaError for \p error.
+void Error(cudaError_t error,
            const char *file,
            const int line,
            const char *func);
+
+/// Called with the size of the failed allocation, 0 if it is unknown.
+/// Returns true if it released device memory, e.g. by clearing a Workspace
+/// or dropping a cached KDTreeFlann, so that the allocation is worth
+/// retrying.
+typedef std::function<bool(size_t)> OutOfMemoryHandler;
+
+/// Registers \p handler and returns its id for RemoveOutOfMemoryHandler().
+/// The handlers run in the order they were added, on the thread whose
+/// allocation failed, and must not allocate device memory.
+int AddOutOfMemoryHandler(const OutOfMemoryHandler &handler);
+void RemoveOutOfMemoryHandler(int id);
+void ClearOutOfMemoryHandlers();
+
+/// Number of times a failed allocation is retried.
+static const int kMaxOutOfMemoryRetries = 3;
+
+/// Runs the out of memory handlers after the \p attempt-th failure of an
+/// allocation of \p bytes. Returns true if the allocation should be
+/// retried.
+bool HandleOutOfMemory(size_t bytes, int attempt);
+
 }  // namespace utility
 }  // namespace cupoch
 
@@ -39,6 +142,19 @@ static inline void ___cudaSafeCall(cudaError_t err,
                                    const char *file,
                                    const int line,
                                    const char *func = "") {
-    if (cudaSuccess != err)
-        cupoch::utility::Error(cudaGetErrorString(err), file, line, func);
+    if (cudaSuccess != err) cupoch::utility::Error(err, file, line, func);
+}
+
+template <typename Call>
+static inline void ___cudaSafeMalloc(Call &&call,
+                                     const char *file,
+                                     const int line,
+                                     const char *func = "") {
+    cudaError_t err = call();
+    for (int attempt = 0; err == cudaErrorMemoryAllocation &&
+                          cupoch::utility::HandleOutOfMemory(0, attempt);
+         ++attempt) {
+        err = call();
+    }
+    if (cudaSuccess != err) cupoch::utility::Error(err, file, line, func);
 }
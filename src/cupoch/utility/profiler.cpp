@@ -0,0 +1,227 @@
+#include "cupoch/utility/profiler.h"
+
+#ifdef USE_NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+namespace {
+
+// Beyond this number of timings waiting for their events, the completed ones
+// are collected when a range closes.
+const size_t kMaxPendingTimings = 256;
+
+struct Timing {
+    cudaEvent_t start_;
+    cudaEvent_t stop_;
+    int device_;
+};
+
+struct Operation {
+    std::string path_;
+    std::vector<Timing> pending_;
+    std::vector<float> samples_;
+};
+
+class Profiler {
+public:
+    static Profiler &GetInstance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::mutex mutex_;
+    std::vector<Operation> operations_;
+    std::unordered_map<std::string, int> indices_;
+    std::unordered_map<int, std::vector<cudaEvent_t>> free_events_;
+
+    int FindOperation(const std::string &path) {
+        auto it = indices_.find(path);
+        if (it != indices_.end()) return it->second;
+        const int index = int(operations_.size());
+        operations_.push_back({path, {}, {}});
+        indices_[path] = index;
+        return index;
+    }
+
+    cudaError_t AcquireEvent(int device, cudaEvent_t &event) {
+        auto &events = free_events_[device];
+        if (events.empty()) return cudaEventCreate(&event);
+        event = events.back();
+        events.pop_back();
+        return cudaSuccess;
+    }
+
+    // Moves the timings of \p op done on the device to its samples, all of
+    // them waiting for their events if \p wait.
+    void Collect(Operation &op, bool wait) {
+        auto it = op.pending_.begin();
+        for (; it != op.pending_.end(); ++it) {
+            if (wait) {
+                cudaSafeCall(cudaEventSynchronize(it->stop_));
+            } else if (cudaEventQuery(it->stop_) != cudaSuccess) {
+                break;
+            }
+            // Called from ~ScopedProfile(), so the failures drop the timing
+            // instead of throwing.
+            float ms = 0.0f;
+            const cudaError_t err =
+                    cudaEventElapsedTime(&ms, it->start_, it->stop_);
+            if (err == cudaSuccess) {
+                op.samples_.push_back(ms);
+            } else {
+                utility::LogWarning(
+                        "[Profiler] cudaEventElapsedTime failed: {}\n",
+                        cudaGetErrorString(err));
+            }
+            free_events_[it->device_].push_back(it->start_);
+            free_events_[it->device_].push_back(it->stop_);
+        }
+        op.pending_.erase(op.pending_.begin(), it);
+    }
+
+private:
+    Profiler() = default;
+};
+
+// The operations open on the host thread, innermost last.
+thread_local std::vector<int> open_operations;
+
+}  // namespace
+
+void utility::EnableProfiling(bool enable) {
+#ifdef CUPOCH_CPU_BACKEND
+    // The timings are taken by CUDA events, which need a device.
+    if (enable) {
+        utility::LogWarning("[EnableProfiling] Not supported by cupoch_cpu.\n");
+        return;
+    }
+#endif
+    Profiler::GetInstance().enabled_ = enable;
+}
+
+bool utility::IsProfilingEnabled() {
+    return Profiler::GetInstance().enabled_;
+}
+
+void utility::ResetProfile() {
+    Profiler &profiler = Profiler::GetInstance();
+    std::lock_guard<std::mutex> lock(profiler.mutex_);
+    for (auto &op : profiler.operations_) {
+        profiler.Collect(op, true);
+        op.samples_.clear();
+    }
+}
+
+std::vector<ProfileStats> utility::GetProfileStats() {
+    Profiler &profiler = Profiler::GetInstance();
+    std::vector<ProfileStats> stats;
+    std::lock_guard<std::mutex> lock(profiler.mutex_);
+    for (auto &op : profiler.operations_) {
+        profiler.Collect(op, true);
+        if (op.samples_.empty()) continue;
+        std::vector<float> samples = op.samples_;
+        std::sort(samples.begin(), samples.end());
+        ProfileStats stat;
+        stat.name_ = op.path_;
+        stat.count_ = samples.size();
+        for (float ms : samples) stat.total_ms_ += ms;
+        stat.mean_ms_ = stat.total_ms_ / stat.count_;
+        const size_t p99 = size_t(std::ceil(0.99 * samples.size())) - 1;
+        stat.p99_ms_ = samples[p99];
+        stat.max_ms_ = samples.back();
+        stats.push_back(stat);
+    }
+    std::sort(stats.begin(), stats.end(),
+              [](const ProfileStats &a, const ProfileStats &b) {
+                  return a.name_ < b.name_;
+              });
+    return stats;
+}
+
+std::string utility::GetProfileReport() {
+    const auto stats = GetProfileStats();
+    std::string report =
+            fmt::format("{:<48} {:>8} {:>12} {:>10} {:>10} {:>10}\n",
+                        "Operation", "Count", "Total (ms)", "Mean (ms)",
+                        "P99 (ms)", "Max (ms)");
+    for (const auto &stat : stats) {
+        const size_t depth = std::count(stat.name_.begin(), stat.name_.end(),
+                                        '/');
+        const size_t slash = stat.name_.rfind('/');
+        const std::string name =
+                std::string(2 * depth, ' ') +
+                (slash == std::string::npos ? stat.name_
+                                            : stat.name_.substr(slash + 1));
+        report += fmt::format(
+                "{:<48} {:>8} {:>12.3f} {:>10.3f} {:>10.3f} {:>10.3f}\n", name,
+                stat.count_, stat.total_ms_, stat.mean_ms_, stat.p99_ms_,
+                stat.max_ms_);
+    }
+    return report;
+}
+
+ScopedProfile::ScopedProfile(const char *name,
+                             cudaStream_t stream /* = cudaStreamPerThread*/)
+    : active_(IsProfilingEnabled()), op_(-1), stream_(stream) {
+    if (!active_) return;
+#ifdef USE_NVTX
+    nvtxRangePushA(name);
+#endif
+    Profiler &profiler = Profiler::GetInstance();
+    const int device = GetDevice();
+    {
+        std::lock_guard<std::mutex> lock(profiler.mutex_);
+        std::string path = name;
+        if (!open_operations.empty()) {
+            path = profiler.operations_[open_operations.back()].path_ + "/" +
+                   path;
+        }
+        op_ = profiler.FindOperation(path);
+        cudaSafeCall(profiler.AcquireEvent(device, start_));
+    }
+    cudaSafeCall(cudaEventRecord(start_, stream_));
+    open_operations.push_back(op_);
+}
+
+ScopedProfile::~ScopedProfile() {
+    if (!active_) return;
+    Profiler &profiler = Profiler::GetInstance();
+    const int device = GetDevice();
+    {
+        std::lock_guard<std::mutex> lock(profiler.mutex_);
+        // A destructor must not throw, so a failure only drops the timing.
+        cudaEvent_t stop = nullptr;
+        cudaError_t err = profiler.AcquireEvent(device, stop);
+        if (err == cudaSuccess) err = cudaEventRecord(stop, stream_);
+        if (err == cudaSuccess) {
+            Operation &op = profiler.operations_[op_];
+            op.pending_.push_back({start_, stop, device});
+            if (op.pending_.size() > kMaxPendingTimings) {
+                profiler.Collect(op, false);
+            }
+        } else {
+            utility::LogWarning("[ScopedProfile] Recording the stop event "
+                                "failed: {}\n",
+                                cudaGetErrorString(err));
+            profiler.free_events_[device].push_back(start_);
+            if (stop) profiler.free_events_[device].push_back(stop);
+        }
+    }
+    open_operations.pop_back();
+#ifdef USE_NVTX
+    nvtxRangePop();
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cuda_runtime.h>
+
+#include <string>
+#include <vector>
+
+namespace cupoch {
+namespace utility {
+
+/// Statistics of the timings of one profiled operation, in milliseconds of
+/// GPU time between the start and the end of the operation on its stream.
+struct ProfileStats {
+    /// Path of the operation, the names of the enclosing ranges separated by
+    /// '/'.
+    std::string name_;
+    size_t count_ = 0;
+    float total_ms_ = 0.0f;
+    float mean_ms_ = 0.0f;
+    float p99_ms_ = 0.0f;
+    float max_ms_ = 0.0f;
+};
+
+/// Turns the profiler on or off, it is off by default. The ranges opened
+/// while it is off are neither marked nor timed.
+void EnableProfiling(bool enable);
+bool IsProfilingEnabled();
+
+/// Discards the timings collected so far.
+void ResetProfile();
+
+/// Statistics of the operations profiled so far, sorted by their path.
+/// Waits for the timed work to finish.
+std::vector<ProfileStats> GetProfileStats();
+
+/// Table of GetProfileStats(), nested operations indented under their
+/// callers.
+std::string GetProfileReport();
+
+/// \class ScopedProfile
+///
+/// \brief Profiles the enclosing scope as the operation \p name, nested in
+/// the ranges opened before it on the same host thread.
+///
+/// The scope is marked by an NVTX range when built with USE_NVTX and timed by
+/// CUDA events recorded on \p stream, so the timings include the
+/// asynchronous GPU work enqueued in the scope rather than the host time.
+class ScopedProfile {
+public:
+    explicit ScopedProfile(const char *name,
+                           cudaStream_t stream = cudaStreamPerThread);
+    ~ScopedProfile();
+    ScopedProfile(const ScopedProfile &) = delete;
+    ScopedProfile &operator=(const ScopedProfile &) = delete;
+
+private:
+    bool active_;
+    int op_;
+    cudaStream_t stream_;
+    cudaEvent_t start_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
+
+#define CUPOCH_PROFILE_CONCAT_(a, b) a##b
+#define CUPOCH_PROFILE_CONCAT(a, b) CUPOCH_PROFILE_CONCAT_(a, b)
+/// Profiles the rest of the enclosing scope as the operation named by the
+/// first argument, timed on the stream given as second argument if any.
+#define CUPOCH_PROFILE(...)                                 \
+    ::cupoch::utility::ScopedProfile CUPOCH_PROFILE_CONCAT( \
+            cupoch_scoped_profile_, __LINE__)(__VA_ARGS__)
@@ -0,0 +1,473 @@
+#include <thrust/binary_search.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/inner_product.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/scan.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include <memory>
+
+#ifdef USE_CUSPARSE
+#include <cusparse.h>
+#endif
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/sparse_matrix.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+namespace {
+
+/// Largest block inverted by the block Jacobi preconditioner.
+constexpr int kMaxPreconditionerBlockSize = 8;
+
+struct block_key_functor {
+    block_key_functor(int block_cols) : block_cols_(block_cols){};
+    const int block_cols_;
+    __device__ long long operator()(const thrust::tuple<int, int> &x) const {
+        return static_cast<long long>(thrust::get<0>(x)) * block_cols_ +
+               thrust::get<1>(x);
+    }
+};
+
+// Entry e of the unique block u, the sum of the duplicated blocks.
+struct sum_blocks_functor {
+    sum_blocks_functor(const int *order,
+                       const int *starts,
+                       const int *counts,
+                       const float *values,
+                       int block_entries)
+        : order_(order),
+          starts_(starts),
+          counts_(counts),
+          values_(values),
+          block_entries_(block_entries){};
+    const int *order_;
+    const int *starts_;
+    const int *counts_;
+    const float *values_;
+    const int block_entries_;
+    __device__ float operator()(size_t idx) const {
+        const int u = idx / block_entries_;
+        const int e = idx % block_entries_;
+        float sum = 0.0f;
+        for (int m = starts_[u]; m < starts_[u] + counts_[u]; ++m) {
+            sum += values_[order_[m] * block_entries_ + e];
+        }
+        return sum;
+    }
+};
+
+struct bsr_multiply_functor {
+    bsr_multiply_functor(const int *row_offsets,
+                         const int *col_indices,
+                         const float *values,
+                         int block_size,
+                         const float *x,
+                         float *y)
+        : row_offsets_(row_offsets),
+          col_indices_(col_indices),
+          values_(values),
+          block_size_(block_size),
+          x_(x),
+          y_(y){};
+    const int *row_offsets_;
+    const int *col_indices_;
+    const float *values_;
+    const int block_size_;
+    const float *x_;
+    float *y_;
+    __device__ void operator()(int r) const {
+        const int br = r / block_size_;
+        const int i = r % block_size_;
+        const int bb = block_size_ * block_size_;
+        float sum = 0.0f;
+        for (int k = row_offsets_[br]; k < row_offsets_[br + 1]; ++k) {
+            const float *block = values_ + k * bb + i;
+            const float *x = x_ + col_indices_[k] * block_size_;
+            for (int j = 0; j < block_size_; ++j) {
+                sum += block[j * block_size_] * x[j];
+            }
+        }
+        y_[r] = sum;
+    }
+};
+
+/// Lower Cholesky factor, in place, of the column major n x n matrix a.
+__device__ bool CholeskyFactorInPlace(float *a, int n) {
+    for (int j = 0; j < n; ++j) {
+        float d = a[j * n + j];
+        for (int k = 0; k < j; ++k) d -= a[k * n + j] * a[k * n + j];
+        if (!(d > 0.0f)) return false;
+        d = sqrt(d);
+        a[j * n + j] = d;
+        for (int i = j + 1; i < n; ++i) {
+            float s = a[j * n + i];
+            for (int k = 0; k < j; ++k) s -= a[k * n + i] * a[k * n + j];
+            a[j * n + i] = s / d;
+        }
+    }
+    return true;
+}
+
+// Factors of the diagonal blocks, the identity for the missing and the not
+// positive definite ones. Jacobi keeps only their diagonals.
+struct factor_diagonal_blocks_functor {
+    factor_diagonal_blocks_functor(const int *row_offsets,
+                                   const int *col_indices,
+                                   const float *values,
+                                   int block_size,
+                                   bool block_jacobi,
+                                   float *factors)
+        : row_offsets_(row_offsets),
+          col_indices_(col_indices),
+          values_(values),
+          block_size_(block_size),
+          block_jacobi_(block_jacobi),
+          factors_(factors){};
+    const int *row_offsets_;
+    const int *col_indices_;
+    const float *values_;
+    const int block_size_;
+    const bool block_jacobi_;
+    float *factors_;
+    __device__ void operator()(int br) const {
+        const int n = block_size_;
+        float *f = factors_ + br * n * n;
+        for (int e = 0; e < n * n; ++e) {
+            f[e] = (e % (n + 1) == 0) ? 1.0f : 0.0f;
+        }
+        for (int k = row_offsets_[br]; k < row_offsets_[br + 1]; ++k) {
+            if (col_indices_[k] != br) continue;
+            const float *block = values_ + k * n * n;
+            if (!block_jacobi_) {
+                for (int i = 0; i < n; ++i) {
+                    const float d = block[i * (n + 1)];
+                    f[i * (n + 1)] = (d > 0.0f) ? d : 1.0f;
+                }
+                return;
+            }
+            float a[kMaxPreconditionerBlockSize * kMaxPreconditionerBlockSize];
+            for (int e = 0; e < n * n; ++e) a[e] = block[e];
+            if (CholeskyFactorInPlace(a, n)) {
+                for (int e = 0; e < n * n; ++e) f[e] = a[e];
+            }
+            return;
+        }
+    }
+};
+
+// z = M^-1 r on one block row, from the Cholesky factor L of its diagonal
+// block, or from its diagonal for Jacobi.
+struct apply_preconditioner_functor {
+    apply_preconditioner_functor(const float *factors,
+                                 int block_size,
+                                 bool block_jacobi,
+                                 const float *r,
+                                 float *z)
+        : factors_(factors),
+          block_size_(block_size),
+          block_jacobi_(block_jacobi),
+          r_(r),
+          z_(z){};
+    const float *factors_;
+    const int block_size_;
+    const bool block_jacobi_;
+    const float *r_;
+    float *z_;
+    __device__ void operator()(int br) const {
+        const int n = block_size_;
+        const float *l = factors_ + br * n * n;
+        const float *r = r_ + br * n;
+        float *z = z_ + br * n;
+        if (!block_jacobi_) {
+            for (int i = 0; i < n; ++i) z[i] = r[i] / l[i * (n + 1)];
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            float s = r[i];
+            for (int k = 0; k < i; ++k) s -= l[k * n + i] * z[k];
+            z[i] = s / l[i * (n + 1)];
+        }
+        for (int i = n - 1; i >= 0; --i) {
+            float s = z[i];
+            for (int k = i + 1; k < n; ++k) s -= l[i * n + k] * z[k];
+            z[i] = s / l[i * (n + 1)];
+        }
+    }
+};
+
+struct axpy_functor {
+    axpy_functor(float a) : a_(a){};
+    const float a_;
+    __device__ float operator()(float x, float y) const { return x + a_ * y; }
+};
+
+float Dot(const device_vector<float> &a, const device_vector<float> &b) {
+    return thrust::inner_product(a.begin(), a.end(), b.begin(), 0.0f);
+}
+
+#if defined(USE_CUSPARSE) && CUDART_VERSION >= 11020
+void CusparseSafeCall(cusparseStatus_t status) {
+    if (status != CUSPARSE_STATUS_SUCCESS) {
+        utility::LogError("[SolveConjugateGradient] cuSPARSE error: {}",
+                          cusparseGetErrorString(status));
+    }
+}
+
+/// y = A x by cusparseSpMV on a CSR matrix.
+class CusparseMultiplier {
+public:
+    CusparseMultiplier(const SparseMatrix &A,
+                       device_vector<float> &x,
+                       device_vector<float> &y) {
+        CusparseSafeCall(cusparseCreate(&handle_));
+        CusparseSafeCall(cusparseSetStream(handle_, cudaStreamPerThread));
+        CusparseSafeCall(cusparseCreateCsr(
+                &matrix_, A.Rows(), A.Cols(), A.NumBlocks(),
+                const_cast<int *>(thrust::raw_pointer_cast(
+                        A.row_offsets_.data())),
+                const_cast<int *>(thrust::raw_pointer_cast(
+                        A.col_indices_.data())),
+                const_cast<float *>(thrust::raw_pointer_cast(
+                        A.values_.data())),
+                CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
+                CUSPARSE_INDEX_BASE_ZERO, CUDA_R_32F));
+        CusparseSafeCall(cusparseCreateDnVec(
+                &x_, A.Cols(), thrust::raw_pointer_cast(x.data()),
+                CUDA_R_32F));
+        CusparseSafeCall(cusparseCreateDnVec(
+                &y_, A.Rows(), thrust::raw_pointer_cast(y.data()),
+                CUDA_R_32F));
+        size_t buffer_size = 0;
+        const float alpha = 1.0f, beta = 0.0f;
+        CusparseSafeCall(cusparseSpMV_bufferSize(
+                handle_, CUSPARSE_OPERATION_NON_TRANSPOSE, &alpha, matrix_,
+                x_, &beta, y_, CUDA_R_32F, CUSPARSE_SPMV_ALG_DEFAULT,
+                &buffer_size));
+        buffer_.resize(buffer_size);
+    }
+    ~CusparseMultiplier() {
+        cusparseDestroyDnVec(y_);
+        cusparseDestroyDnVec(x_);
+        cusparseDestroySpMat(matrix_);
+        cusparseDestroy(handle_);
+    }
+    CusparseMultiplier(const CusparseMultiplier &) = delete;
+    CusparseMultiplier &operator=(const CusparseMultiplier &) = delete;
+
+    /// Multiplies the vectors given at construction.
+    void Multiply() {
+        const float alpha = 1.0f, beta = 0.0f;
+        CusparseSafeCall(cusparseSpMV(
+                handle_, CUSPARSE_OPERATION_NON_TRANSPOSE, &alpha, matrix_,
+                x_, &beta, y_, CUDA_R_32F, CUSPARSE_SPMV_ALG_DEFAULT,
+                thrust::raw_pointer_cast(buffer_.data())));
+    }
+
+private:
+    cusparseHandle_t handle_;
+    cusparseSpMatDescr_t matrix_;
+    cusparseDnVecDescr_t x_;
+    cusparseDnVecDescr_t y_;
+    device_vector<char> buffer_;
+};
+#endif
+
+}  // namespace
+
+SparseMatrix SparseMatrix::FromTriplets(int block_rows,
+                                        int block_cols,
+                                        int block_size,
+                                        const device_vector<int> &row_indices,
+                                        const device_vector<int> &col_indices,
+                                        const device_vector<float> &values) {
+    SparseMatrix mat;
+    mat.block_rows_ = block_rows;
+    mat.block_cols_ = block_cols;
+    mat.block_size_ = block_size;
+    const size_t n = row_indices.size();
+    const int bb = block_size * block_size;
+    if (col_indices.size() != n || values.size() != n * bb) {
+        utility::LogError(
+                "[SparseMatrix::FromTriplets] the triplets must have the "
+                "same size.");
+        return mat;
+    }
+    device_vector<long long> keys(n);
+    thrust::transform(make_tuple_begin(row_indices, col_indices),
+                      make_tuple_end(row_indices, col_indices), keys.begin(),
+                      block_key_functor(block_cols));
+    device_vector<int> order(n);
+    thrust::sequence(order.begin(), order.end());
+    thrust::stable_sort_by_key(keys.begin(), keys.end(), order.begin());
+
+    device_vector<long long> unique_keys(n);
+    device_vector<int> counts(n);
+    auto end = thrust::reduce_by_key(keys.begin(), keys.end(),
+                                     thrust::make_constant_iterator(1),
+                                     unique_keys.begin(), counts.begin());
+    const size_t n_blocks = thrust::distance(unique_keys.begin(), end.first);
+    resize_all(n_blocks, unique_keys, counts);
+    device_vector<int> starts(n_blocks);
+    thrust::exclusive_scan(counts.begin(), counts.end(), starts.begin());
+    mat.values_.resize(n_blocks * bb);
+    thrust::transform(thrust::make_counting_iterator<size_t>(0),
+                      thrust::make_counting_iterator(n_blocks * bb),
+                      mat.values_.begin(),
+                      sum_blocks_functor(
+                              thrust::raw_pointer_cast(order.data()),
+                              thrust::raw_pointer_cast(starts.data()),
+                              thrust::raw_pointer_cast(counts.data()),
+                              thrust::raw_pointer_cast(values.data()), bb));
+
+    mat.col_indices_.resize(n_blocks);
+    thrust::transform(unique_keys.begin(), unique_keys.end(),
+                      mat.col_indices_.begin(),
+                      [block_cols] __device__(long long key) {
+                          return int(key % block_cols);
+                      });
+    // The first block of each block row is the first key not below it.
+    device_vector<long long> row_keys(block_rows + 1);
+    thrust::transform(thrust::make_counting_iterator<long long>(0),
+                      thrust::make_counting_iterator<long long>(block_rows + 1),
+                      row_keys.begin(),
+                      [block_cols] __device__(long long row) {
+                          return row * block_cols;
+                      });
+    mat.row_offsets_.resize(block_rows + 1);
+    thrust::lower_bound(unique_keys.begin(), unique_keys.end(),
+                        row_keys.begin(), row_keys.end(),
+                        mat.row_offsets_.begin());
+    return mat;
+}
+
+void SparseMatrix::Multiply(const device_vector<float> &x,
+                            device_vector<float> &y) const {
+    y.resize(Rows());
+    bsr_multiply_functor func(thrust::raw_pointer_cast(row_offsets_.data()),
+                              thrust::raw_pointer_cast(col_indices_.data()),
+                              thrust::raw_pointer_cast(values_.data()),
+                              block_size_, thrust::raw_pointer_cast(x.data()),
+                              thrust::raw_pointer_cast(y.data()));
+    thrust::for_each(thrust::make_counting_iterator(0),
+                     thrust::make_counting_iterator(Rows()), func);
+}
+
+ConjugateGradientResult utility::SolveConjugateGradient(
+        const SparseMatrix &A,
+        const device_vector<float> &b,
+        device_vector<float> &x,
+        const ConjugateGradientOption &option) {
+    ConjugateGradientResult result;
+    const int n = A.Rows();
+    if (A.Cols() != n || int(b.size()) != n) {
+        utility::LogError(
+                "[SolveConjugateGradient] the matrix must be square and of "
+                "the size of the right hand side.");
+        return result;
+    }
+    if (int(x.size()) != n) {
+        x.resize(n);
+        thrust::fill(x.begin(), x.end(), 0.0f);
+    }
+    const float b_norm2 = Dot(b, b);
+    if (b_norm2 == 0.0f) {
+        thrust::fill(x.begin(), x.end(), 0.0f);
+        result.converged_ = true;
+        return result;
+    }
+
+    PreconditionerType preconditioner = option.preconditioner_;
+    if (preconditioner == PreconditionerType::BlockJacobi &&
+        A.block_size_ > kMaxPreconditionerBlockSize) {
+        utility::LogWarning(
+                "[SolveConjugateGradient] blocks of size {:d} are too large "
+                "for the block Jacobi preconditioner, using Jacobi.",
+                A.block_size_);
+        preconditioner = PreconditionerType::Jacobi;
+    }
+    const bool block_jacobi = preconditioner == PreconditionerType::BlockJacobi;
+    device_vector<float> factors;
+    if (preconditioner != PreconditionerType::None) {
+        factors.resize(A.block_rows_ * A.block_size_ * A.block_size_);
+        thrust::for_each(
+                thrust::make_counting_iterator(0),
+                thrust::make_counting_iterator(A.block_rows_),
+                factor_diagonal_blocks_functor(
+                        thrust::raw_pointer_cast(A.row_offsets_.data()),
+                        thrust::raw_pointer_cast(A.col_indices_.data()),
+                        thrust::raw_pointer_cast(A.values_.data()),
+                        A.block_size_, block_jacobi,
+                        thrust::raw_pointer_cast(factors.data())));
+    }
+    auto precondition = [&](const device_vector<float> &r,
+                            device_vector<float> &z) {
+        if (preconditioner == PreconditionerType::None) {
+            thrust::copy(r.begin(), r.end(), z.begin());
+            return;
+        }
+        thrust::for_each(thrust::make_counting_iterator(0),
+                         thrust::make_counting_iterator(A.block_rows_),
+                         apply_preconditioner_functor(
+                                 thrust::raw_pointer_cast(factors.data()),
+                                 A.block_size_, block_jacobi,
+                                 thrust::raw_pointer_cast(r.data()),
+                                 thrust::raw_pointer_cast(z.data())));
+    };
+
+    device_vector<float> r(n), z(n), p(n), q(n);
+#if defined(USE_CUSPARSE) && CUDART_VERSION >= 11020
+    std::unique_ptr<CusparseMultiplier> cusparse;
+    if (option.use_cusparse_ && A.block_size_ == 1) {
+        cusparse.reset(new CusparseMultiplier(A, p, q));
+    }
+    auto multiply = [&]() {
+        if (cusparse) {
+            cusparse->Multiply();
+        } else {
+            A.Multiply(p, q);
+        }
+    };
+#else
+    auto multiply = [&]() { A.Multiply(p, q); };
+#endif
+
+    // r = b - A x, computed through p and q.
+    thrust::copy(x.begin(), x.end(), p.begin());
+    multiply();
+    thrust::transform(b.begin(), b.end(), q.begin(), r.begin(),
+                      axpy_functor(-1.0f));
+    const float tol2 = option.relative_tolerance_ *
+                       option.relative_tolerance_ * b_norm2;
+    precondition(r, z);
+    thrust::copy(z.begin(), z.end(), p.begin());
+    float rz = Dot(r, z);
+    float r_norm2 = Dot(r, r);
+    while (r_norm2 > tol2 && result.iterations_ < option.max_iteration_) {
+        multiply();
+        const float pq = Dot(p, q);
+        if (!(pq > 0.0f)) break;
+        const float alpha = rz / pq;
+        thrust::transform(x.begin(), x.end(), p.begin(), x.begin(),
+                          axpy_functor(alpha));
+        thrust::transform(r.begin(), r.end(), q.begin(), r.begin(),
+                          axpy_functor(-alpha));
+        precondition(r, z);
+        const float rz_new = Dot(r, z);
+        thrust::transform(z.begin(), z.end(), p.begin(), p.begin(),
+                          axpy_functor(rz_new / rz));
+        rz = rz_new;
+        r_norm2 = Dot(r, r);
+        ++result.iterations_;
+    }
+    result.relative_residual_ = std::sqrt(r_norm2 / b_norm2);
+    result.converged_ = r_norm2 <= tol2;
+    return result;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace utility {
+
+/// \class SparseMatrix
+///
+/// \brief Block sparse row (BSR) matrix of floats on the device, made of
+/// dense block_size_ x block_size_ blocks stored column major. Block row i
+/// holds the blocks row_offsets_[i] to row_offsets_[i + 1], sorted by their
+/// block column. A block size of 1 is the CSR format.
+class SparseMatrix {
+public:
+    SparseMatrix() {}
+    ~SparseMatrix() {}
+
+public:
+    /// Assembles a matrix of \p block_rows x \p block_cols blocks from the
+    /// blocks of block coordinates \p row_indices and \p col_indices, with
+    /// block_size^2 entries each in \p values. The duplicated blocks are
+    /// summed, in the order they are given.
+    static SparseMatrix FromTriplets(int block_rows,
+                                     int block_cols,
+                                     int block_size,
+                                     const device_vector<int> &row_indices,
+                                     const device_vector<int> &col_indices,
+                                     const device_vector<float> &values);
+
+    int Rows() const { return block_rows_ * block_size_; }
+    int Cols() const { return block_cols_ * block_size_; }
+    size_t NumBlocks() const { return col_indices_.size(); }
+
+    /// y = A x, one thread per row.
+    void Multiply(const device_vector<float> &x,
+                  device_vector<float> &y) const;
+
+public:
+    int block_rows_ = 0;
+    int block_cols_ = 0;
+    int block_size_ = 1;
+    device_vector<int> row_offsets_;
+    device_vector<int> col_indices_;
+    device_vector<float> values_;
+};
+
+enum class PreconditionerType {
+    None = 0,
+    /// Inverse of the diagonal.
+    Jacobi = 1,
+    /// Inverse of the diagonal blocks by Cholesky factorization, for the
+    /// block sizes up to 8. The blocks that are not positive definite are
+    /// left out.
+    BlockJacobi = 2,
+};
+
+class ConjugateGradientOption {
+public:
+    ConjugateGradientOption(
+            int max_iteration = 1000,
+            float relative_tolerance = 1e-6,
+            PreconditionerType preconditioner = PreconditionerType::BlockJacobi,
+            bool use_cusparse = true)
+        : max_iteration_(max_iteration),
+          relative_tolerance_(relative_tolerance),
+          preconditioner_(preconditioner),
+          use_cusparse_(use_cusparse) {}
+    ~ConjugateGradientOption() {}
+
+public:
+    int max_iteration_;
+    /// Stops when the residual norm falls below this fraction of the norm
+    /// of the right hand side.
+    float relative_tolerance_;
+    PreconditionerType preconditioner_;
+    /// Multiplies the CSR matrices by cuSPARSE when cupoch is built with
+    /// USE_CUSPARSE.
+    bool use_cusparse_;
+};
+
+class ConjugateGradientResult {
+public:
+    int iterations_ = 0;
+    /// Residual norm over the norm of the right hand side.
+    float relative_residual_ = 0.0f;
+    bool converged_ = false;
+};
+
+/// Solves A x = b for a symmetric positive definite \p A by preconditioned
+/// conjugate gradients, starting from \p x if it has the size of \p b and
+/// from zero otherwise. All the vectors stay on the device; only the dot
+/// products are read back.
+ConjugateGradientResult SolveConjugateGradient(
+        const SparseMatrix &A,
+        const device_vector<float> &b,
+        device_vector<float> &x,
+        const ConjugateGradientOption &option = ConjugateGradientOption());
+
+}  // namespace utility
+}  // namespace cupoch
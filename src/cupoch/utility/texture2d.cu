@@ -0,0 +1,40 @@
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/texture2d.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+Texture2D::Texture2D(int width,
+                     int height,
+                     const cudaChannelFormatDesc &desc,
+                     bool linear_filter,
+                     bool normalized_read)
+    : width_(width),
+      height_(height),
+      element_bytes_((desc.x + desc.y + desc.z + desc.w) / 8) {
+    cudaSafeMalloc(cudaMallocArray(&array_, &desc, width_, height_));
+    cudaResourceDesc res_desc = {};
+    res_desc.resType = cudaResourceTypeArray;
+    res_desc.res.array.array = array_;
+    cudaTextureDesc tex_desc = {};
+    tex_desc.addressMode[0] = cudaAddressModeClamp;
+    tex_desc.addressMode[1] = cudaAddressModeClamp;
+    tex_desc.filterMode =
+            linear_filter ? cudaFilterModeLinear : cudaFilterModePoint;
+    tex_desc.readMode = normalized_read ? cudaReadModeNormalizedFloat
+                                        : cudaReadModeElementType;
+    tex_desc.normalizedCoords = 0;
+    cudaSafeCall(
+            cudaCreateTextureObject(&texture_, &res_desc, &tex_desc, NULL));
+}
+
+Texture2D::~Texture2D() {
+    cudaDestroyTextureObject(texture_);
+    cudaFreeArray(array_);
+}
+
+void Texture2D::CopyFrom(const void *data, size_t pitch, cudaStream_t stream) {
+    cudaSafeCall(cudaMemcpy2DToArrayAsync(
+            array_, 0, 0, data, pitch, width_ * element_bytes_, height_,
+            cudaMemcpyDeviceToDevice, stream));
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cuda_runtime.h>
+
+namespace cupoch {
+namespace utility {
+
+/// \class Texture2D
+///
+/// \brief Image in a cudaArray, read through a texture object.
+///
+/// The elements are described by \p desc, of 1, 2 or 4 channels. With
+/// \p normalized_read the 8 and 16 bit integers are read as floats in
+/// [0, 1], which the linear filter mode requires; it interpolates
+/// bilinearly in hardware, with 8 bit fractional weights. A pixel (u, v) is
+/// read with tex2D(tex, u + 0.5, v + 0.5) in unnormalized coordinates, and
+/// the reads out of the image are clamped to its border.
+class Texture2D {
+public:
+    Texture2D(int width,
+              int height,
+              const cudaChannelFormatDesc &desc,
+              bool linear_filter = true,
+              bool normalized_read = false);
+    ~Texture2D();
+    Texture2D(const Texture2D &) = delete;
+    Texture2D &operator=(const Texture2D &) = delete;
+
+public:
+    /// Enqueues on \p stream the copy of the packed rows of \p pitch bytes
+    /// from the device memory \p data.
+    void CopyFrom(const void *data, size_t pitch, cudaStream_t stream = 0);
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+    cudaTextureObject_t GetTextureObject() const { return texture_; }
+
+private:
+    int width_;
+    int height_;
+    size_t element_bytes_;
+    cudaArray_t array_ = nullptr;
+    cudaTextureObject_t texture_ = 0;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,41 @@
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/texture3d.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+Texture3D::Texture3D(int resolution, bool linear_filter)
+    : resolution_(resolution) {
+    cudaChannelFormatDesc desc = cudaCreateChannelDesc<float>();
+    cudaSafeMalloc(cudaMalloc3DArray(
+            &array_, &desc,
+            make_cudaExtent(resolution_, resolution_, resolution_)));
+    cudaResourceDesc res_desc = {};
+    res_desc.resType = cudaResourceTypeArray;
+    res_desc.res.array.array = array_;
+    cudaTextureDesc tex_desc = {};
+    for (int i = 0; i < 3; ++i) {
+        tex_desc.addressMode[i] = cudaAddressModeClamp;
+    }
+    tex_desc.filterMode =
+            linear_filter ? cudaFilterModeLinear : cudaFilterModePoint;
+    tex_desc.readMode = cudaReadModeElementType;
+    tex_desc.normalizedCoords = 0;
+    cudaSafeCall(cudaCreateTextureObject(&texture_, &res_desc, &tex_desc, NULL));
+}
+
+Texture3D::~Texture3D() {
+    cudaDestroyTextureObject(texture_);
+    cudaFreeArray(array_);
+}
+
+void Texture3D::CopyFrom(const float *data) {
+    cudaMemcpy3DParms params = {};
+    params.srcPtr = make_cudaPitchedPtr(const_cast<float *>(data),
+                                        resolution_ * sizeof(float),
+                                        resolution_, resolution_);
+    params.dstArray = array_;
+    params.extent = make_cudaExtent(resolution_, resolution_, resolution_);
+    params.kind = cudaMemcpyDeviceToDevice;
+    cudaSafeCall(cudaMemcpy3D(&params));
+}
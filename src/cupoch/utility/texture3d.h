@@ -0,0 +1,37 @@
+#pragma once
+#include <cuda_runtime.h>
+
+namespace cupoch {
+namespace utility {
+
+/// \class Texture3D
+///
+/// \brief Float volume in a cudaArray, read through a texture object.
+///
+/// The texture cache is laid out for 3D locality, and the linear filter
+/// mode interpolates trilinearly in hardware, with 8 bit fractional weights.
+/// The volume has the layout of DenseGrid, the last index being the
+/// fastest, so a voxel (x, y, z) is read with tex3D<float>(tex, z, y, x)
+/// in unnormalized coordinates, offset by 0.5 to the voxel centers. The
+/// reads out of the volume are clamped to its border.
+class Texture3D {
+public:
+    Texture3D(int resolution, bool linear_filter = true);
+    ~Texture3D();
+    Texture3D(const Texture3D &) = delete;
+    Texture3D &operator=(const Texture3D &) = delete;
+
+public:
+    /// Copies resolution^3 floats from the device memory \p data.
+    void CopyFrom(const float *data);
+    int GetResolution() const { return resolution_; }
+    cudaTextureObject_t GetTextureObject() const { return texture_; }
+
+private:
+    int resolution_;
+    cudaArray_t array_ = nullptr;
+    cudaTextureObject_t texture_ = 0;
+};
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace cupoch {
+namespace utility {
+
+/// Lock-free union-find over a parent array, usable from device code by
+/// any number of threads at once. Every set is rooted at its smallest
+/// element, so the roots give a deterministic labelling.
+__device__ inline int FindRoot(int *parents, int x) {
+    int p = parents[x];
+    while (p != x) {
+        // Path halving while walking up to the root.
+        const int gp = parents[p];
+        if (gp != p) parents[x] = gp;
+        x = p;
+        p = gp;
+    }
+    return x;
+}
+
+__device__ inline void UnionRoots(int *parents, int a, int b) {
+    a = FindRoot(parents, a);
+    b = FindRoot(parents, b);
+    while (a != b) {
+        if (a < b) {
+            const int tmp = a;
+            a = b;
+            b = tmp;
+        }
+        const int old = atomicCAS(&parents[a], a, b);
+        if (old == a) break;
+        a = FindRoot(parents, old);
+        b = FindRoot(parents, b);
+    }
+}
+
+}  // namespace utility
+}  // namespace cupoch
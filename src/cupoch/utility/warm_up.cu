@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/memory_resource.h"
+#include "cupoch/utility/profiler.h"
+#include "cupoch/utility/warm_up.h"
+
+using namespace cupoch;
+using namespace cupoch::utility;
+
+void cupoch::utility::WarmUp(const WarmUpConfig &config) {
+    CUPOCH_PROFILE("WarmUp");
+    if (config.eager_module_loading_) {
+#ifdef _WIN32
+        if (!std::getenv("CUDA_MODULE_LOADING")) {
+            _putenv_s("CUDA_MODULE_LOADING", "EAGER");
+        }
+#else
+        setenv("CUDA_MODULE_LOADING", "EAGER", 0);
+#endif
+    }
+    // Creates the context.
+    cudaSafeCall(cudaFree(0));
+
+    const size_t num_streams = std::min(config.num_streams_, MAX_NUM_STREAMS);
+    for (size_t i = 0; i < num_streams; ++i) GetStream(i);
+
+    if (config.pool_bytes_ > 0) {
+        // One stream at a time, so that a pool shared by the streams only
+        // grows to pool_bytes_.
+        MemoryResource *resource = GetMemoryResource();
+        std::vector<cudaStream_t> streams(1, GetAllocationStream());
+        for (size_t i = 0; i < num_streams; ++i) {
+            streams.push_back(GetStream(i));
+        }
+        for (cudaStream_t stream : streams) {
+            void *ptr = resource->Allocate(config.pool_bytes_, stream);
+            resource->Deallocate(ptr, config.pool_bytes_, stream);
+            cudaSafeCall(cudaStreamSynchronize(stream));
+        }
+    }
+
+    if (config.load_launch_tuning_cache_ && IsLaunchTuningEnabled()) {
+        LaunchConfig launch_config;
+        GetTunedLaunchConfig("WarmUp", 1, launch_config);
+    }
+
+    for (const auto &task : config.tasks_) task();
+    cudaSafeCall(cudaDeviceSynchronize());
+    LogDebug("[WarmUp] {:d} streams, {:d} pool bytes, {:d} tasks.",
+             (int)num_streams, (int)config.pool_bytes_,
+             (int)config.tasks_.size());
+}
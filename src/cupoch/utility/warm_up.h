@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "cupoch/utility/platform.h"
+
+namespace cupoch {
+namespace utility {
+
+/// \struct WarmUpConfig
+///
+/// \brief What WarmUp() prepares before the first frame of a real-time loop.
+struct WarmUpConfig {
+    /// Streams of GetStream() created, for the calling thread if the streams
+    /// are per thread.
+    size_t num_streams_ = MAX_NUM_STREAMS;
+    /// Bytes allocated and freed on each stream through GetMemoryResource(),
+    /// which grows the pools of the pooled resources, e.g. a
+    /// CudaAsyncMemoryResource keeping its memory across synchronizations.
+    /// It has no effect on the default CudaMemoryResource.
+    size_t pool_bytes_ = 0;
+    /// Loads the kernels of all the modules when the context is created
+    /// instead of at their first launch, by setting CUDA_MODULE_LOADING to
+    /// EAGER unless it is set. Only effective if WarmUp() is the first CUDA
+    /// call of the process.
+    bool eager_module_loading_ = true;
+    /// Reads the launch tuning cache file now rather than at the first tuned
+    /// launch.
+    bool load_launch_tuning_cache_ = true;
+    /// Calls made once the streams and the pools are ready, e.g. a
+    /// KDTreeFlann built on a cloud of the expected size or an ICP on two
+    /// frames, whose buffers then stay in the pools.
+    std::vector<std::function<void()>> tasks_;
+};
+
+/// Creates the CUDA context, the streams and the pools of \p config and runs
+/// its tasks, so that the first calls of the loop do not pay for the lazy
+/// initializations. Blocks until the device is done.
+void WarmUp(const WarmUpConfig &config = WarmUpConfig());
+
+}  // namespace utility
+}  // namespace cupoch
@@ -0,0 +1,67 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+
+#include "cupoch/utility/device_vector.h"
+
+namespace cupoch {
+namespace utility {
+
+/// \class Workspace
+///
+/// \brief Scratch arena of named device buffers for iterative algorithms.
+///
+/// Buffers only grow: requesting a buffer that is smaller than its capacity
+/// does not allocate, so an algorithm called repeatedly with the same
+/// workspace performs no device allocation after the first call.
+/// A workspace must not be shared by concurrently running algorithms.
+class Workspace {
+public:
+    Workspace() = default;
+    ~Workspace() = default;
+    Workspace(const Workspace &) = delete;
+    Workspace &operator=(const Workspace &) = delete;
+
+public:
+    /// Returns the buffer \p name resized to \p n elements. Elements kept
+    /// from a previous request are not reinitialized.
+    template <typename T>
+    device_vector<T> &GetBuffer(const std::string &name, size_t n) {
+        auto &entry = buffers_[name];
+        auto holder = std::dynamic_pointer_cast<BufferHolder<T>>(entry);
+        if (!holder) {
+            holder = std::make_shared<BufferHolder<T>>();
+            entry = holder;
+        }
+        holder->data_.resize(n);
+        return holder->data_;
+    }
+
+    /// Releases all buffers.
+    void Clear() { buffers_.clear(); }
+
+    /// Device memory held by the workspace in bytes.
+    size_t GetAllocatedBytes() const {
+        size_t total = 0;
+        for (const auto &entry : buffers_) total += entry.second->Capacity();
+        return total;
+    }
+
+private:
+    struct BufferHolderBase {
+        virtual ~BufferHolderBase() = default;
+        virtual size_t Capacity() const = 0;
+    };
+
+    template <typename T>
+    struct BufferHolder : public BufferHolderBase {
+        size_t Capacity() const override { return data_.capacity() * sizeof(T); }
+        device_vector<T> data_;
+    };
+
+    std::map<std::string, std::shared_ptr<BufferHolderBase>> buffers_;
+};
+
+}  // namespace utility
+}  // namespace cupoch
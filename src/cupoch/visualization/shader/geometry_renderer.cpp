@@ -11,7 +11,9 @@ bool PointCloudRenderer::Render(const RenderOption &option,
     if (is_visible_ == false || geometry_ptr_->IsEmpty()) return true;
     const auto &pointcloud = (const geometry::PointCloud &)(*geometry_ptr_);
     bool success = true;
-    if (pointcloud.HasNormals()) {
+    if (option.point_lod_) {
+        success &= lod_point_shader_.Render(pointcloud, option, view);
+    } else if (pointcloud.HasNormals()) {
         if (option.point_color_option_ ==
             RenderOption::PointColorOption::Normal) {
             success &= normal_point_shader_.Render(pointcloud, option, view);
@@ -40,12 +42,22 @@ bool PointCloudRenderer::AddGeometry(
 
 bool PointCloudRenderer::UpdateGeometry() {
     simple_point_shader_.InvalidateGeometry();
+    lod_point_shader_.InvalidateGeometry();
     phong_point_shader_.InvalidateGeometry();
     normal_point_shader_.InvalidateGeometry();
     simplewhite_normal_shader_.InvalidateGeometry();
     return true;
 }
 
+bool PointCloudRenderer::UpdateGeometry(const GeometryUpdate &update) {
+    simple_point_shader_.InvalidateGeometry();
+    lod_point_shader_.InvalidateGeometry();
+    phong_point_shader_.InvalidateGeometry(update);
+    normal_point_shader_.InvalidateGeometry();
+    simplewhite_normal_shader_.InvalidateGeometry();
+    return true;
+}
+
 bool LineSetRenderer::Render(const RenderOption &option,
                              const ViewControl &view) {
     if (is_visible_ == false || geometry_ptr_->IsEmpty()) return true;
@@ -147,7 +159,7 @@ bool VoxelGridRenderer::Render(const RenderOption &option,
         return simple_shader_for_voxel_grid_line_.Render(*geometry_ptr_, option,
                                                          view);
     } else {
-        return phong_shader_for_voxel_grid_face_.Render(*geometry_ptr_, option,
+        return phong_shader_for_voxel_grid_.Render(*geometry_ptr_, option,
                                                         view);
     }
 }
@@ -164,7 +176,7 @@ bool VoxelGridRenderer::AddGeometry(
 
 bool VoxelGridRenderer::UpdateGeometry() {
     simple_shader_for_voxel_grid_line_.InvalidateGeometry();
-    phong_shader_for_voxel_grid_face_.InvalidateGeometry();
+    phong_shader_for_voxel_grid_.InvalidateGeometry();
     return true;
 }
 
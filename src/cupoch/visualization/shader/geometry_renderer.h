@@ -2,7 +2,9 @@
 
 #include "cupoch/geometry/geometry.h"
 #include "cupoch/visualization/shader/simple_shader.h"
+#include "cupoch/visualization/shader/lod_shader.h"
 #include "cupoch/visualization/shader/phong_shader.h"
+#include "cupoch/visualization/shader/instanced_phong_shader.h"
 #include "cupoch/visualization/shader/normal_shader.h"
 #include "cupoch/visualization/shader/simple_white_shader.h"
 #include "cupoch/visualization/shader/image_shader.h"
@@ -34,6 +36,11 @@ public:
     /// Function to update geometry
     /// Programmer must call this function to notify a change of the geometry
     virtual bool UpdateGeometry() = 0;
+    /// Same as above for a change of the part \p update of the geometry,
+    /// which the shaders with persistent buffers rewrite alone.
+    virtual bool UpdateGeometry(const GeometryUpdate &update) {
+        return UpdateGeometry();
+    }
 
     bool HasGeometry() const { return bool(geometry_ptr_); }
     std::shared_ptr<const geometry::Geometry> GetGeometry() const {
@@ -62,9 +69,11 @@ public:
     bool AddGeometry(
             std::shared_ptr<const geometry::Geometry> geometry_ptr) override;
     bool UpdateGeometry() override;
+    bool UpdateGeometry(const GeometryUpdate &update) override;
 
 protected:
     SimpleShaderForPointCloud simple_point_shader_;
+    SimpleShaderForPointCloudLOD lod_point_shader_;
     PhongShaderForPointCloud phong_point_shader_;
     NormalShaderForPointCloud normal_point_shader_;
     SimpleWhiteShaderForPointCloudNormal simplewhite_normal_shader_;
@@ -130,7 +139,7 @@ public:
 
 protected:
     SimpleShaderForVoxelGridLine simple_shader_for_voxel_grid_line_;
-    PhongShaderForVoxelGridFace phong_shader_for_voxel_grid_face_;
+    InstancedPhongShaderForVoxelGrid phong_shader_for_voxel_grid_;
 };
 
 class OccupancyGridRenderer : public GeometryRenderer {
@@ -144,7 +153,7 @@ public:
     bool UpdateGeometry() override;
 
 protected:
-    PhongShaderForOccupancyGrid phong_shader_for_occupancy_grid_;
+    InstancedPhongShaderForOccupancyGrid phong_shader_for_occupancy_grid_;
 };
 
 class CoordinateFrameRenderer : public GeometryRenderer {
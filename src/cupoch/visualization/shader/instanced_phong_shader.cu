@@ -0,0 +1,440 @@
+#include "cupoch/visualization/shader/instanced_phong_shader.h"
+
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/visualization/shader/shader.h"
+#include "cupoch/visualization/utility/color_map.h"
+#include "cupoch/utility/platform.h"
+#include <thrust/sort.h>
+#include <cuda_runtime.h>
+#include <cuda_gl_interop.h>
+
+using namespace cupoch;
+using namespace cupoch::visualization;
+using namespace cupoch::visualization::glsl;
+
+namespace {
+
+// Coordinates of 8 vertices in a cuboid (assume origin (0,0,0), size 1)
+const int cuboid_vertex_offsets[8][3] = {
+    {0, 0, 0}, {1, 0, 0},
+    {0, 1, 0}, {1, 1, 0},
+    {0, 0, 1}, {1, 0, 1},
+    {0, 1, 1}, {1, 1, 1},
+};
+
+// Vertex indices of 12 triangles in a cuboid, for right-handed manifold mesh
+const int cuboid_triangles_vertex_indices[12][3] = {
+    {0, 2, 1}, {0, 1, 4},
+    {0, 4, 2}, {5, 1, 7},
+    {5, 7, 4}, {5, 4, 1},
+    {3, 7, 1}, {3, 1, 2},
+    {3, 2, 7}, {6, 4, 7},
+    {6, 7, 2}, {6, 2, 4},
+};
+
+const int cuboid_normals[12][3] = {
+    {0, 0, -1}, {0, -1, 0},
+    {-1, 0, 0}, {1, 0, 0},
+    {0, 0, 1}, {0, -1, 0},
+    {1, 0, 0}, {0, 0, -1},
+    {0, 1, 0}, {0, 0, 1},
+    {0, 1, 0}, {-1, 0, 0},
+};
+
+struct default_color_functor {
+    __host__ __device__ default_color_functor() {};
+    __host__ __device__ ~default_color_functor() {};
+    __host__ __device__ default_color_functor(const default_color_functor& other) {};
+    __device__ Eigen::Vector3f color(const geometry::Voxel& voxel) const {
+        return voxel.color_;
+    }
+    __device__ float alpha(const geometry::Voxel& voxel) const {
+        return 1.0;
+    }
+};
+
+struct occupancy_color_functor {
+    __host__ __device__ occupancy_color_functor(float occ_prob_thres_log, bool visualize_free_area)
+     : occ_prob_thres_log_(occ_prob_thres_log), visualize_free_area_(visualize_free_area) {};
+    const float occ_prob_thres_log_;
+    const bool visualize_free_area_;
+    __host__ __device__ ~occupancy_color_functor() {};
+    __host__ __device__ occupancy_color_functor(const occupancy_color_functor& other)
+     : occ_prob_thres_log_(other.occ_prob_thres_log_), visualize_free_area_(other.visualize_free_area_) {};
+    __device__ Eigen::Vector3f color(geometry::OccupancyVoxel ocv) const {
+        return (ocv.prob_log_ > occ_prob_thres_log_) ? ocv.color_ : Eigen::Vector3f(0.0, 1.0, 0.0);
+    }
+    __device__ float alpha(geometry::OccupancyVoxel ocv) const {
+        return (ocv.prob_log_ > occ_prob_thres_log_) ? 1.0 : ((visualize_free_area_) ? 0.2 : 0.0);
+    }
+};
+
+template<typename VoxelType, typename ColorFuncType>
+struct compute_voxel_instance_functor {
+    compute_voxel_instance_functor(const Eigen::Vector3f& origin, float voxel_size, bool has_colors,
+                                   RenderOption::MeshColorOption color_option,
+                                   const Eigen::Vector3f& default_mesh_color,
+                                   const ViewControl& view, const ColorFuncType& cfunc)
+                                   : origin_(origin), voxel_size_(voxel_size), has_colors_(has_colors),
+                                     color_option_(color_option), default_mesh_color_(default_mesh_color),
+                                     view_(view), cfunc_(cfunc) {};
+    const Eigen::Vector3f origin_;
+    const float voxel_size_;
+    const bool has_colors_;
+    const RenderOption::MeshColorOption color_option_;
+    const Eigen::Vector3f default_mesh_color_;
+    const ViewControl view_;
+    const ColorFuncType cfunc_;
+    const ColorMap::ColorMapOption colormap_option_ = GetGlobalColorMapOption();
+    __device__
+    thrust::tuple<Eigen::Vector3f, Eigen::Vector4f> operator() (const VoxelType& voxel) const {
+        const Eigen::Vector3f base_vertex =
+                origin_ + voxel.grid_index_.template cast<float>() * voxel_size_;
+        Eigen::Vector4f voxel_color;
+        voxel_color[3] = cfunc_.alpha(voxel);
+        switch (color_option_) {
+            case RenderOption::MeshColorOption::XCoordinate:
+                voxel_color.head<3>() = GetColorMapColor(view_.GetBoundingBox().GetXPercentage(base_vertex(0)), colormap_option_);
+                break;
+            case RenderOption::MeshColorOption::YCoordinate:
+                voxel_color.head<3>() = GetColorMapColor(view_.GetBoundingBox().GetYPercentage(base_vertex(1)), colormap_option_);
+                break;
+            case RenderOption::MeshColorOption::ZCoordinate:
+                voxel_color.head<3>() = GetColorMapColor(view_.GetBoundingBox().GetZPercentage(base_vertex(2)), colormap_option_);
+                break;
+            case RenderOption::MeshColorOption::Color:
+                if (has_colors_) {
+                    voxel_color.head<3>() = cfunc_.color(voxel);
+                    break;
+                }
+            case RenderOption::MeshColorOption::Default:
+            default:
+                voxel_color.head<3>() = default_mesh_color_;
+                break;
+        }
+        return thrust::make_tuple(base_vertex, voxel_color);
+    }
+};
+
+struct alpha_greater_functor {
+    __device__ bool operator () (const thrust::tuple<Eigen::Vector3f, Eigen::Vector4f>& lhs,
+                                 const thrust::tuple<Eigen::Vector3f, Eigen::Vector4f>& rhs) {
+        const Eigen::Vector4f& lc = thrust::get<1>(lhs);
+        const Eigen::Vector4f& rc = thrust::get<1>(rhs);
+        return lc[3] > rc[3];
+    }
+};
+
+}
+
+bool InstancedPhongShader::Compile() {
+    if (CompileShaders(instanced_phong_vertex_shader, NULL, phong_fragment_shader) == false) {
+        PrintShaderWarning("Compiling shaders failed.");
+        return false;
+    }
+    vertex_position_ = glGetAttribLocation(program_, "vertex_position");
+    vertex_normal_ = glGetAttribLocation(program_, "vertex_normal");
+    instance_origin_ = glGetAttribLocation(program_, "instance_origin");
+    instance_color_ = glGetAttribLocation(program_, "instance_color");
+    instance_size_ = glGetUniformLocation(program_, "instance_size");
+    MVP_ = glGetUniformLocation(program_, "MVP");
+    V_ = glGetUniformLocation(program_, "V");
+    M_ = glGetUniformLocation(program_, "M");
+    light_position_world_ =
+            glGetUniformLocation(program_, "light_position_world_4");
+    light_color_ = glGetUniformLocation(program_, "light_color_4");
+    light_diffuse_power_ =
+            glGetUniformLocation(program_, "light_diffuse_power_4");
+    light_specular_power_ =
+            glGetUniformLocation(program_, "light_specular_power_4");
+    light_specular_shininess_ =
+            glGetUniformLocation(program_, "light_specular_shininess_4");
+    light_ambient_ = glGetUniformLocation(program_, "light_ambient");
+    return true;
+}
+
+void InstancedPhongShader::Release() {
+    UnbindGeometry(true);
+    ReleaseProgram();
+}
+
+bool InstancedPhongShader::BindGeometry(const geometry::Geometry &geometry,
+                                        const RenderOption &option,
+                                        const ViewControl &view) {
+    // The cube of the instances, written once.
+    if (!has_cube_) {
+        Eigen::Vector3f positions[12 * 3];
+        Eigen::Vector3f normals[12 * 3];
+        for (int j = 0; j < 12; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                const int *offset = cuboid_vertex_offsets[cuboid_triangles_vertex_indices[j][k]];
+                positions[j * 3 + k] = Eigen::Vector3f(offset[0], offset[1], offset[2]);
+                normals[j * 3 + k] = Eigen::Vector3f(cuboid_normals[j][0], cuboid_normals[j][1], cuboid_normals[j][2]);
+            }
+        }
+        glGenBuffers(1, &vertex_position_buffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_position_buffer_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
+        glGenBuffers(1, &vertex_normal_buffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_normal_buffer_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(normals), normals, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        has_cube_ = true;
+    }
+
+    if (PrepareBinding(geometry, option, view) == false) {
+        PrintShaderWarning("Binding failed when preparing data.");
+        return false;
+    }
+    bound_ = true;
+    return true;
+}
+
+void InstancedPhongShader::MapInstanceBuffers(
+        size_t n_instances,
+        thrust::device_ptr<Eigen::Vector3f> &origins,
+        thrust::device_ptr<Eigen::Vector4f> &colors) {
+    ReserveBuffer(0, instance_origin_buffer_, n_instances * sizeof(Eigen::Vector3f));
+    ReserveBuffer(1, instance_color_buffer_, n_instances * sizeof(Eigen::Vector4f));
+    Eigen::Vector3f* raw_origins_ptr;
+    Eigen::Vector4f* raw_colors_ptr;
+    size_t n_bytes;
+    cudaSafeCall(cudaGraphicsMapResources(2, cuda_graphics_resources_));
+    cudaSafeCall(cudaGraphicsResourceGetMappedPointer((void **)&raw_origins_ptr, &n_bytes, cuda_graphics_resources_[0]));
+    cudaSafeCall(cudaGraphicsResourceGetMappedPointer((void **)&raw_colors_ptr, &n_bytes, cuda_graphics_resources_[1]));
+    origins = thrust::device_pointer_cast(raw_origins_ptr);
+    colors = thrust::device_pointer_cast(raw_colors_ptr);
+}
+
+bool InstancedPhongShader::RenderGeometry(const geometry::Geometry &geometry,
+                                          const RenderOption &option,
+                                          const ViewControl &view) {
+    if (PrepareRendering(geometry, option, view) == false) {
+        PrintShaderWarning("Rendering failed during preparation.");
+        return false;
+    }
+    glUseProgram(program_);
+    glUniformMatrix4fv(MVP_, 1, GL_FALSE, view.GetMVPMatrix().data());
+    glUniformMatrix4fv(V_, 1, GL_FALSE, view.GetViewMatrix().data());
+    glUniformMatrix4fv(M_, 1, GL_FALSE, view.GetModelMatrix().data());
+    glUniformMatrix4fv(light_position_world_, 1, GL_FALSE,
+                       light_position_world_data_.data());
+    glUniformMatrix4fv(light_color_, 1, GL_FALSE, light_color_data_.data());
+    glUniform4fv(light_diffuse_power_, 1, light_diffuse_power_data_.data());
+    glUniform4fv(light_specular_power_, 1, light_specular_power_data_.data());
+    glUniform4fv(light_specular_shininess_, 1,
+                 light_specular_shininess_data_.data());
+    glUniform4fv(light_ambient_, 1, light_ambient_data_.data());
+    glUniform1f(instance_size_, GetInstanceSize(geometry));
+    glEnableVertexAttribArray(vertex_position_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_position_buffer_);
+    glVertexAttribPointer(vertex_position_, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(vertex_normal_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_normal_buffer_);
+    glVertexAttribPointer(vertex_normal_, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(instance_origin_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_origin_buffer_);
+    glVertexAttribPointer(instance_origin_, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glVertexAttribDivisor(instance_origin_, 1);
+    glEnableVertexAttribArray(instance_color_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_color_buffer_);
+    glVertexAttribPointer(instance_color_, 4, GL_FLOAT, GL_FALSE, 0, NULL);
+    glVertexAttribDivisor(instance_color_, 1);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 12 * 3, draw_arrays_size_);
+    glVertexAttribDivisor(instance_origin_, 0);
+    glVertexAttribDivisor(instance_color_, 0);
+    glDisableVertexAttribArray(vertex_position_);
+    glDisableVertexAttribArray(vertex_normal_);
+    glDisableVertexAttribArray(instance_origin_);
+    glDisableVertexAttribArray(instance_color_);
+    return true;
+}
+
+void InstancedPhongShader::UnbindGeometry(bool finalize) {
+    // The buffers are kept over the updates of the geometry.
+    if (finalize) {
+        ReleaseBuffer(0, instance_origin_buffer_, finalize);
+        ReleaseBuffer(1, instance_color_buffer_, finalize);
+        if (has_cube_) {
+            glDeleteBuffers(1, &vertex_position_buffer_);
+            glDeleteBuffers(1, &vertex_normal_buffer_);
+            has_cube_ = false;
+        }
+    }
+    bound_ = false;
+}
+
+void InstancedPhongShader::SetLighting(const ViewControl &view,
+                                       const RenderOption &option) {
+    const auto &box = view.GetBoundingBox();
+    light_position_world_data_.setOnes();
+    light_color_data_.setOnes();
+    for (int i = 0; i < 4; i++) {
+        light_position_world_data_.block<3, 1>(0, i) =
+                box.GetCenter().cast<GLfloat>() +
+                (float)box.GetMaxExtent() *
+                        ((float)option.light_position_relative_[i](0) *
+                                 view.GetRight() +
+                         (float)option.light_position_relative_[i](1) *
+                                 view.GetUp() +
+                         (float)option.light_position_relative_[i](2) *
+                                 view.GetFront());
+        light_color_data_.block<3, 1>(0, i) =
+                option.light_color_[i].cast<GLfloat>();
+    }
+    if (option.light_on_) {
+        light_diffuse_power_data_ =
+                Eigen::Vector4f(option.light_diffuse_power_).cast<GLfloat>();
+        light_specular_power_data_ =
+                Eigen::Vector4f(option.light_specular_power_).cast<GLfloat>();
+        light_specular_shininess_data_ =
+                Eigen::Vector4f(option.light_specular_shininess_)
+                        .cast<GLfloat>();
+        light_ambient_data_.block<3, 1>(0, 0) =
+                option.light_ambient_color_.cast<GLfloat>();
+        light_ambient_data_(3) = 1.0f;
+    } else {
+        light_diffuse_power_data_ = gl_helper::GLVector4f::Zero();
+        light_specular_power_data_ = gl_helper::GLVector4f::Zero();
+        light_specular_shininess_data_ = gl_helper::GLVector4f::Ones();
+        light_ambient_data_ = gl_helper::GLVector4f(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+}
+
+bool InstancedPhongShaderForVoxelGrid::PrepareRendering(
+        const geometry::Geometry &geometry,
+        const RenderOption &option,
+        const ViewControl &view) {
+    if (geometry.GetGeometryType() !=
+        geometry::Geometry::GeometryType::VoxelGrid) {
+        PrintShaderWarning("Rendering type is not geometry::VoxelGrid.");
+        return false;
+    }
+    if (option.mesh_show_back_face_) {
+        glDisable(GL_CULL_FACE);
+    } else {
+        glEnable(GL_CULL_FACE);
+    }
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GLenum(option.GetGLDepthFunc()));
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    SetLighting(view, option);
+    return true;
+}
+
+bool InstancedPhongShaderForVoxelGrid::PrepareBinding(
+        const geometry::Geometry &geometry,
+        const RenderOption &option,
+        const ViewControl &view) {
+    if (geometry.GetGeometryType() !=
+        geometry::Geometry::GeometryType::VoxelGrid) {
+        PrintShaderWarning("Rendering type is not geometry::VoxelGrid.");
+        return false;
+    }
+    const geometry::VoxelGrid &voxel_grid =
+            (const geometry::VoxelGrid &)geometry;
+    if (voxel_grid.HasVoxels() == false) {
+        PrintShaderWarning("Binding failed with empty voxel grid.");
+        return false;
+    }
+
+    const size_t n_voxels = voxel_grid.voxels_values_.size();
+    thrust::device_ptr<Eigen::Vector3f> origins;
+    thrust::device_ptr<Eigen::Vector4f> colors;
+    MapInstanceBuffers(n_voxels, origins, colors);
+    compute_voxel_instance_functor<geometry::Voxel, default_color_functor> func(
+        voxel_grid.origin_, voxel_grid.voxel_size_,
+        voxel_grid.HasColors(), option.mesh_color_option_,
+        option.default_mesh_color_, view, default_color_functor());
+    thrust::transform(voxel_grid.voxels_values_.begin(), voxel_grid.voxels_values_.end(),
+                      make_tuple_iterator(origins, colors), func);
+    Unmap(2);
+    draw_arrays_mode_ = GL_TRIANGLES;
+    draw_arrays_size_ = GLsizei(n_voxels);
+    return true;
+}
+
+size_t InstancedPhongShaderForVoxelGrid::GetDataSize(const geometry::Geometry &geometry) const {
+    return ((const geometry::VoxelGrid &)geometry).voxels_values_.size();
+}
+
+float InstancedPhongShaderForVoxelGrid::GetInstanceSize(const geometry::Geometry &geometry) const {
+    return ((const geometry::VoxelGrid &)geometry).voxel_size_;
+}
+
+bool InstancedPhongShaderForOccupancyGrid::PrepareRendering(
+        const geometry::Geometry &geometry,
+        const RenderOption &option,
+        const ViewControl &view) {
+    if (geometry.GetGeometryType() !=
+        geometry::Geometry::GeometryType::OccupancyGrid) {
+        PrintShaderWarning("Rendering type is not geometry::OccupancyGrid.");
+        return false;
+    }
+    if (option.mesh_show_back_face_) {
+        glDisable(GL_CULL_FACE);
+    } else {
+        glEnable(GL_CULL_FACE);
+    }
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GLenum(option.GetGLDepthFunc()));
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    if (option.mesh_show_wireframe_) {
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0, 1.0);
+    } else {
+        glDisable(GL_POLYGON_OFFSET_FILL);
+    }
+    SetLighting(view, option);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    return true;
+}
+
+bool InstancedPhongShaderForOccupancyGrid::PrepareBinding(
+        const geometry::Geometry &geometry,
+        const RenderOption &option,
+        const ViewControl &view) {
+    if (geometry.GetGeometryType() !=
+        geometry::Geometry::GeometryType::OccupancyGrid) {
+        PrintShaderWarning("Rendering type is not geometry::OccupancyGrid.");
+        return false;
+    }
+    const geometry::OccupancyGrid &occupancy_grid =
+            (const geometry::OccupancyGrid &)geometry;
+    if (occupancy_grid.HasVoxels() == false) {
+        PrintShaderWarning("Binding failed with empty voxel grid.");
+        return false;
+    }
+
+    auto voxels = occupancy_grid.ExtractKnownVoxels();
+    const size_t n_voxels = voxels->size();
+    Eigen::Vector3f origin = occupancy_grid.origin_ - 0.5 * occupancy_grid.voxel_size_ * Eigen::Vector3f::Constant(occupancy_grid.resolution_);
+    thrust::device_ptr<Eigen::Vector3f> origins;
+    thrust::device_ptr<Eigen::Vector4f> colors;
+    MapInstanceBuffers(n_voxels, origins, colors);
+    compute_voxel_instance_functor<geometry::OccupancyVoxel, occupancy_color_functor> func(
+        origin, occupancy_grid.voxel_size_,
+        occupancy_grid.HasColors(), option.mesh_color_option_,
+        option.default_mesh_color_, view,
+        occupancy_color_functor(occupancy_grid.occ_prob_thres_log_, occupancy_grid.visualize_free_area_));
+    auto begin = make_tuple_iterator(origins, colors);
+    thrust::transform(voxels->begin(), voxels->end(), begin, func);
+    // The opaque voxels are drawn first for the blending.
+    thrust::sort(begin, begin + n_voxels, alpha_greater_functor());
+    Unmap(2);
+    draw_arrays_mode_ = GL_TRIANGLES;
+    draw_arrays_size_ = GLsizei(n_voxels);
+    return true;
+}
+
+size_t InstancedPhongShaderForOccupancyGrid::GetDataSize(const geometry::Geometry &geometry) const {
+    const geometry::OccupancyGrid &occupancy_grid = (const geometry::OccupancyGrid &)geometry;
+    Eigen::Vector3ui16 diff = occupancy_grid.max_bound_ - occupancy_grid.min_bound_ + Eigen::Vector3ui16::Ones();
+    return diff[0] * diff[1] * diff[2];
+}
+
+float InstancedPhongShaderForOccupancyGrid::GetInstanceSize(const geometry::Geometry &geometry) const {
+    return ((const geometry::OccupancyGrid &)geometry).voxel_size_;
+}
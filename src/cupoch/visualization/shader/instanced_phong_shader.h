@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <thrust/device_ptr.h>
+
+#include "cupoch/visualization/shader/shader_wrapper.h"
+
+namespace cupoch {
+namespace visualization {
+
+namespace glsl {
+
+/// Phong shader drawing one cube mesh per instance. The cube is kept in a
+/// static buffer and only the origin and the color of every instance are
+/// written by CUDA, to buffers kept over the updates of the geometry.
+class InstancedPhongShader : public ShaderWrapper {
+public:
+    ~InstancedPhongShader() override { Release(); }
+
+protected:
+    InstancedPhongShader(const std::string &name) : ShaderWrapper(name) {
+        Compile();
+    }
+
+protected:
+    bool Compile() final;
+    void Release() final;
+    bool BindGeometry(const geometry::Geometry &geometry,
+                      const RenderOption &option,
+                      const ViewControl &view) final;
+    bool RenderGeometry(const geometry::Geometry &geometry,
+                        const RenderOption &option,
+                        const ViewControl &view) final;
+    void UnbindGeometry(bool finalize = false) final;
+
+protected:
+    virtual bool PrepareRendering(const geometry::Geometry &geometry,
+                                  const RenderOption &option,
+                                  const ViewControl &view) = 0;
+    /// Writes the instances between MapInstanceBuffers() and Unmap(2) and
+    /// sets draw_arrays_size_ to their number.
+    virtual bool PrepareBinding(const geometry::Geometry &geometry,
+                                const RenderOption &option,
+                                const ViewControl &view) = 0;
+    /// Upper bound of the number of instances.
+    virtual size_t GetDataSize(const geometry::Geometry &geometry) const = 0;
+    /// Edge length of the cubes.
+    virtual float GetInstanceSize(const geometry::Geometry &geometry) const = 0;
+
+protected:
+    /// Maps the instance buffers, grown to hold \p n_instances if needed.
+    void MapInstanceBuffers(size_t n_instances,
+                            thrust::device_ptr<Eigen::Vector3f> &origins,
+                            thrust::device_ptr<Eigen::Vector4f> &colors);
+    void SetLighting(const ViewControl &view, const RenderOption &option);
+
+protected:
+    GLuint vertex_position_;
+    GLuint vertex_position_buffer_;
+    GLuint vertex_normal_;
+    GLuint vertex_normal_buffer_;
+    GLuint instance_origin_;
+    GLuint instance_origin_buffer_;
+    GLuint instance_color_;
+    GLuint instance_color_buffer_;
+    GLuint instance_size_;
+    GLuint MVP_;
+    GLuint V_;
+    GLuint M_;
+    GLuint light_position_world_;
+    GLuint light_color_;
+    GLuint light_diffuse_power_;
+    GLuint light_specular_power_;
+    GLuint light_specular_shininess_;
+    GLuint light_ambient_;
+    bool has_cube_ = false;
+
+    // At most support 4 lights
+    gl_helper::GLMatrix4f light_position_world_data_;
+    gl_helper::GLMatrix4f light_color_data_;
+    gl_helper::GLVector4f light_diffuse_power_data_;
+    gl_helper::GLVector4f light_specular_power_data_;
+    gl_helper::GLVector4f light_specular_shininess_data_;
+    gl_helper::GLVector4f light_ambient_data_;
+};
+
+class InstancedPhongShaderForVoxelGrid : public InstancedPhongShader {
+public:
+    InstancedPhongShaderForVoxelGrid()
+        : InstancedPhongShader("InstancedPhongShaderForVoxelGrid") {}
+
+protected:
+    bool PrepareRendering(const geometry::Geometry &geometry,
+                          const RenderOption &option,
+                          const ViewControl &view) final;
+    bool PrepareBinding(const geometry::Geometry &geometry,
+                        const RenderOption &option,
+                        const ViewControl &view) final;
+    size_t GetDataSize(const geometry::Geometry &geometry) const final;
+    float GetInstanceSize(const geometry::Geometry &geometry) const final;
+};
+
+class InstancedPhongShaderForOccupancyGrid : public InstancedPhongShader {
+public:
+    InstancedPhongShaderForOccupancyGrid()
+        : InstancedPhongShader("InstancedPhongShaderForOccupancyGrid") {}
+
+protected:
+    bool PrepareRendering(const geometry::Geometry &geometry,
+                          const RenderOption &option,
+                          const ViewControl &view) final;
+    bool PrepareBinding(const geometry::Geometry &geometry,
+                        const RenderOption &option,
+                        const ViewControl &view) final;
+    size_t GetDataSize(const geometry::Geometry &geometry) const final;
+    float GetInstanceSize(const geometry::Geometry &geometry) const final;
+};
+
+}  // namespace glsl
+
+}  // namespace visualization
+}  // namespace cupoch
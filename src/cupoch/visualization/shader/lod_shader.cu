@@ -0,0 +1,402 @@
+#include "cupoch/visualization/shader/lod_shader.h"
+
+#include "cupoch/geometry/morton_code.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/visualization/shader/shader.h"
+#include "cupoch/visualization/utility/color_map.h"
+#include "cupoch/utility/helper.h"
+#include "cupoch/utility/platform.h"
+#include <thrust/copy.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/iterator/constant_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/sort.h>
+#include <cuda_runtime.h>
+#include <cuda_gl_interop.h>
+
+using namespace cupoch;
+using namespace cupoch::visualization;
+using namespace cupoch::visualization::glsl;
+
+namespace {
+
+// States of the nodes in a selection.
+enum NodeState : int {
+    NodeCulled = 0,
+    NodeDrawn = 1,
+    NodeRefined = 2,
+};
+
+struct compute_point_color_functor {
+    compute_point_color_functor(bool has_colors, RenderOption::PointColorOption color_option, const ViewControl& view)
+        : has_colors_(has_colors), color_option_(color_option), view_(view) {};
+    const bool has_colors_;
+    const RenderOption::PointColorOption color_option_;
+    const ViewControl view_;
+    const ColorMap::ColorMapOption colormap_option_ = GetGlobalColorMapOption();
+    __device__
+    Eigen::Vector3f operator() (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f>& pt_cl) {
+        const Eigen::Vector3f &point = thrust::get<0>(pt_cl);
+        const Eigen::Vector3f &color = thrust::get<1>(pt_cl);
+        switch (color_option_) {
+            case RenderOption::PointColorOption::XCoordinate:
+                return GetColorMapColor(view_.GetBoundingBox().GetXPercentage(point(0)), colormap_option_);
+            case RenderOption::PointColorOption::YCoordinate:
+                return GetColorMapColor(view_.GetBoundingBox().GetYPercentage(point(1)), colormap_option_);
+            case RenderOption::PointColorOption::ZCoordinate:
+                return GetColorMapColor(view_.GetBoundingBox().GetZPercentage(point(2)), colormap_option_);
+            case RenderOption::PointColorOption::Color:
+            case RenderOption::PointColorOption::Default:
+            default:
+                if (has_colors_) {
+                    return color;
+                } else {
+                    return GetColorMapColor(view_.GetBoundingBox().GetZPercentage(point(2)), colormap_option_);
+                }
+        }
+    }
+};
+
+// Morton code of the deepest cell of a point in the root cube.
+struct compute_point_code_functor {
+    compute_point_code_functor(const Eigen::Vector3f& origin, float root_size)
+        : origin_(origin), scale_(float(1 << geometry::kMortonBitsPerAxis) / root_size) {};
+    const Eigen::Vector3f origin_;
+    const float scale_;
+    __device__ geometry::MortonCode operator()(const Eigen::Vector3f& point) const {
+        const int max_index = (1 << geometry::kMortonBitsPerAxis) - 1;
+        const Eigen::Vector3f ref = (point - origin_) * scale_;
+        return geometry::EncodeMorton(
+                (unsigned int)max(0, min(int(ref[0]), max_index)),
+                (unsigned int)max(0, min(int(ref[1]), max_index)),
+                (unsigned int)max(0, min(int(ref[2]), max_index)));
+    }
+};
+
+struct level_key_functor {
+    level_key_functor(int shift) : shift_(shift) {};
+    const int shift_;
+    __device__ geometry::MortonCode operator()(geometry::MortonCode code) const {
+        return code >> shift_;
+    }
+};
+
+struct add_point_color_functor {
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, int> operator()(
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, int>& lhs,
+            const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, int>& rhs) const {
+        return thrust::make_tuple(
+                Eigen::Vector3f(thrust::get<0>(lhs) + thrust::get<0>(rhs)),
+                Eigen::Vector3f(thrust::get<1>(lhs) + thrust::get<1>(rhs)),
+                thrust::get<2>(lhs) + thrust::get<2>(rhs));
+    }
+};
+
+// Cell center and representative point and color of a node.
+struct compute_node_functor {
+    compute_node_functor(const Eigen::Vector3f& origin, float cell_size)
+        : origin_(origin), cell_size_(cell_size) {};
+    const Eigen::Vector3f origin_;
+    const float cell_size_;
+    __device__ thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector3f>
+    operator()(const thrust::tuple<geometry::MortonCode, Eigen::Vector3f, Eigen::Vector3f, int>& x) const {
+        const geometry::MortonCode key = thrust::get<0>(x);
+        const float n = thrust::get<3>(x);
+        const Eigen::Vector3f index(geometry::CompactMortonBits(key >> 2),
+                                    geometry::CompactMortonBits(key >> 1),
+                                    geometry::CompactMortonBits(key));
+        return thrust::make_tuple(
+                Eigen::Vector3f(origin_ + (index.array() + 0.5f).matrix() * cell_size_),
+                Eigen::Vector3f(thrust::get<1>(x) / n),
+                Eigen::Vector3f(thrust::get<2>(x) / n));
+    }
+};
+
+// Index of the node of a level holding a cell, by a binary search of the
+// sorted keys of the level.
+struct find_node_functor {
+    find_node_functor(const geometry::MortonCode* keys, int n_keys, int offset, int shift)
+        : keys_(keys), n_keys_(n_keys), offset_(offset), shift_(shift) {};
+    const geometry::MortonCode* keys_;
+    const int n_keys_;
+    const int offset_;
+    const int shift_;
+    __device__ int operator()(geometry::MortonCode code) const {
+        const geometry::MortonCode key = code >> shift_;
+        int lo = 0;
+        int hi = n_keys_;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (keys_[mid] < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return offset_ + lo;
+    }
+};
+
+// A node is culled unless its parent is refined and its bounding sphere
+// intersects the view frustum, and refined when its cell spans more pixels
+// than the error.
+struct select_node_functor {
+    select_node_functor(const Eigen::Vector3f* centers, const int* parents, int* states,
+                        const Eigen::Matrix4f& mvp, float cell_size,
+                        float pixel_scale, float pixel_error)
+        : centers_(centers), parents_(parents), states_(states), mvp_(mvp),
+          cell_size_(cell_size), pixel_scale_(pixel_scale), pixel_error_(pixel_error) {};
+    const Eigen::Vector3f* centers_;
+    const int* parents_;
+    int* states_;
+    const Eigen::Matrix4f mvp_;
+    const float cell_size_;
+    const float pixel_scale_;
+    const float pixel_error_;
+    __device__ void operator()(int idx) const {
+        const int parent = parents_[idx];
+        if (parent >= 0 && states_[parent] != NodeRefined) {
+            states_[idx] = NodeCulled;
+            return;
+        }
+        const Eigen::Vector4f point(centers_[idx][0], centers_[idx][1], centers_[idx][2], 1.0f);
+        const float radius = 0.8660254f * cell_size_;
+        const Eigen::Vector4f row3 = mvp_.row(3).transpose();
+        // Frustum planes from the rows of the projection (Gribb & Hartmann).
+        for (int i = 0; i < 3; ++i) {
+            const Eigen::Vector4f row = mvp_.row(i).transpose();
+            const Eigen::Vector4f lower = row3 + row;
+            const Eigen::Vector4f upper = row3 - row;
+            if (lower.dot(point) < -radius * lower.head<3>().norm() ||
+                upper.dot(point) < -radius * upper.head<3>().norm()) {
+                states_[idx] = NodeCulled;
+                return;
+            }
+        }
+        const float w = max(row3.dot(point), 1.0e-6f);
+        states_[idx] = (cell_size_ * pixel_scale_ / w > pixel_error_) ? NodeRefined : NodeDrawn;
+    }
+};
+
+struct is_node_state_functor {
+    is_node_state_functor(int state) : state_(state) {};
+    const int state_;
+    __device__ bool operator()(int state) const { return state == state_; }
+};
+
+}
+
+bool SimpleShaderForPointCloudLOD::Compile() {
+    if (CompileShaders(simple_vertex_shader, NULL, simple_fragment_shader) ==
+        false) {
+        PrintShaderWarning("Compiling shaders failed.");
+        return false;
+    }
+    vertex_position_ = glGetAttribLocation(program_, "vertex_position");
+    vertex_color_ = glGetAttribLocation(program_, "vertex_color");
+    MVP_ = glGetUniformLocation(program_, "MVP");
+    return true;
+}
+
+void SimpleShaderForPointCloudLOD::Release() {
+    UnbindGeometry(true);
+    ReleaseProgram();
+}
+
+bool SimpleShaderForPointCloudLOD::BindGeometry(const geometry::Geometry &geometry,
+                                                const RenderOption &option,
+                                                const ViewControl &view) {
+    if (geometry.GetGeometryType() !=
+        geometry::Geometry::GeometryType::PointCloud) {
+        PrintShaderWarning("Rendering type is not geometry::PointCloud.");
+        return false;
+    }
+    const geometry::PointCloud &pointcloud =
+            (const geometry::PointCloud &)geometry;
+    if (pointcloud.HasPoints() == false) {
+        PrintShaderWarning("Binding failed with empty pointcloud.");
+        return false;
+    }
+    UnbindGeometry();
+
+    // At most one vertex is drawn per point, so the buffers are allocated
+    // once for the whole cloud.
+    const size_t n_points = pointcloud.points_.size();
+    ReserveBuffer(0, vertex_position_buffer_, n_points * sizeof(Eigen::Vector3f));
+    ReserveBuffer(1, vertex_color_buffer_, n_points * sizeof(Eigen::Vector3f));
+
+    points_ = pointcloud.points_;
+    colors_.resize(n_points);
+    compute_point_color_functor color_func(pointcloud.HasColors(), option.point_color_option_, view);
+    if (pointcloud.HasColors()) {
+        thrust::transform(make_tuple_begin(pointcloud.points_, pointcloud.colors_),
+                          make_tuple_end(pointcloud.points_, pointcloud.colors_),
+                          colors_.begin(), color_func);
+    } else {
+        const thrust::constant_iterator<Eigen::Vector3f> no_colors(Eigen::Vector3f::Zero());
+        thrust::transform(make_tuple_iterator(pointcloud.points_.begin(), no_colors),
+                          make_tuple_iterator(pointcloud.points_.end(), no_colors),
+                          colors_.begin(), color_func);
+    }
+
+    // Sorted by their deepest cells, the points of every node are contiguous
+    // at all the levels.
+    origin_ = pointcloud.GetMinBound();
+    root_size_ = (pointcloud.GetMaxBound() - origin_).maxCoeff();
+    if (root_size_ <= 0.0f) root_size_ = 1.0f;
+    utility::device_vector<geometry::MortonCode> codes(n_points);
+    thrust::transform(points_.begin(), points_.end(), codes.begin(),
+                      compute_point_code_functor(origin_, root_size_));
+    thrust::sort_by_key(codes.begin(), codes.end(), make_tuple_begin(points_, colors_));
+
+    // The levels are built down to the one holding 8 points per node on
+    // average.
+    utility::device_vector<geometry::MortonCode> keys(n_points);
+    utility::device_vector<geometry::MortonCode> parent_keys;
+    utility::device_vector<Eigen::Vector3f> point_sums(n_points);
+    utility::device_vector<Eigen::Vector3f> color_sums(n_points);
+    utility::device_vector<int> counts(n_points);
+    level_offsets_.assign(1, 0);
+    for (int depth = 0;; ++depth) {
+        const int shift = 3 * (geometry::kMortonBitsPerAxis - depth);
+        const auto level_keys = thrust::make_transform_iterator(codes.begin(), level_key_functor(shift));
+        const auto end = thrust::reduce_by_key(
+                level_keys, level_keys + n_points,
+                make_tuple_iterator(points_.begin(), colors_.begin(),
+                                    thrust::make_constant_iterator(1)),
+                keys.begin(), make_tuple_begin(point_sums, color_sums, counts),
+                thrust::equal_to<geometry::MortonCode>(), add_point_color_functor());
+        const int n_nodes = thrust::distance(keys.begin(), end.first);
+        const int offset = level_offsets_.back();
+        resize_all(offset + n_nodes, node_centers_, node_points_, node_colors_, node_parents_);
+        thrust::transform(make_tuple_iterator(keys.begin(), point_sums.begin(), color_sums.begin(), counts.begin()),
+                          make_tuple_iterator(keys.begin() + n_nodes, point_sums.begin() + n_nodes,
+                                              color_sums.begin() + n_nodes, counts.begin() + n_nodes),
+                          make_tuple_iterator(node_centers_.begin() + offset, node_points_.begin() + offset,
+                                              node_colors_.begin() + offset),
+                          compute_node_functor(origin_, root_size_ / float(1 << depth)));
+        if (depth == 0) {
+            node_parents_[0] = -1;
+        } else {
+            thrust::transform(keys.begin(), keys.begin() + n_nodes, node_parents_.begin() + offset,
+                              find_node_functor(thrust::raw_pointer_cast(parent_keys.data()),
+                                                int(parent_keys.size()), level_offsets_[depth - 1], 3));
+        }
+        level_offsets_.push_back(offset + n_nodes);
+        if (size_t(n_nodes) * 8 >= n_points || depth == geometry::kMortonBitsPerAxis) {
+            point_leaves_.resize(n_points);
+            thrust::transform(codes.begin(), codes.end(), point_leaves_.begin(),
+                              find_node_functor(thrust::raw_pointer_cast(keys.data()), n_nodes, offset, shift));
+            break;
+        }
+        parent_keys.assign(keys.begin(), keys.begin() + n_nodes);
+    }
+    node_states_.resize(node_centers_.size());
+    selected_ = false;
+    bound_ = true;
+    return true;
+}
+
+void SimpleShaderForPointCloudLOD::SelectNodes(const RenderOption &option,
+                                               const ViewControl &view) {
+    const Eigen::Matrix4f mvp = view.GetMVPMatrix();
+    const float pixel_scale = view.GetProjectionMatrix()(1, 1) * view.GetWindowHeight() * 0.5f;
+    // The levels are selected top down, each after the one of its parents.
+    for (size_t l = 0; l + 1 < level_offsets_.size(); ++l) {
+        select_node_functor func(thrust::raw_pointer_cast(node_centers_.data()),
+                                 thrust::raw_pointer_cast(node_parents_.data()),
+                                 thrust::raw_pointer_cast(node_states_.data()),
+                                 mvp, root_size_ / float(1 << l), pixel_scale,
+                                 option.point_lod_pixel_error_);
+        thrust::for_each(thrust::make_counting_iterator(level_offsets_[l]),
+                         thrust::make_counting_iterator(level_offsets_[l + 1]), func);
+    }
+
+    Eigen::Vector3f* raw_points_ptr;
+    Eigen::Vector3f* raw_colors_ptr;
+    size_t n_bytes;
+    cudaSafeCall(cudaGraphicsMapResources(2, cuda_graphics_resources_));
+    cudaSafeCall(cudaGraphicsResourceGetMappedPointer((void **)&raw_points_ptr, &n_bytes, cuda_graphics_resources_[0]));
+    cudaSafeCall(cudaGraphicsResourceGetMappedPointer((void **)&raw_colors_ptr, &n_bytes, cuda_graphics_resources_[1]));
+    thrust::device_ptr<Eigen::Vector3f> dev_points_ptr = thrust::device_pointer_cast(raw_points_ptr);
+    thrust::device_ptr<Eigen::Vector3f> dev_colors_ptr = thrust::device_pointer_cast(raw_colors_ptr);
+
+    // The representatives of the drawn nodes, then the points of the refined
+    // leaves.
+    const auto out = make_tuple_iterator(dev_points_ptr, dev_colors_ptr);
+    const auto nodes_end = thrust::copy_if(make_tuple_begin(node_points_, node_colors_),
+                                           make_tuple_end(node_points_, node_colors_),
+                                           node_states_.begin(), out,
+                                           is_node_state_functor(NodeDrawn));
+    const auto points_end = thrust::copy_if(
+            make_tuple_begin(points_, colors_), make_tuple_end(points_, colors_),
+            thrust::make_permutation_iterator(node_states_.begin(), point_leaves_.begin()),
+            nodes_end, is_node_state_functor(NodeRefined));
+    Unmap(2);
+
+    draw_arrays_mode_ = GL_POINTS;
+    draw_arrays_size_ = GLsizei(thrust::distance(out, points_end));
+    selected_ = true;
+    selected_MVP_ = view.GetMVPMatrix();
+    selected_height_ = view.GetWindowHeight();
+    selected_pixel_error_ = option.point_lod_pixel_error_;
+}
+
+bool SimpleShaderForPointCloudLOD::RenderGeometry(const geometry::Geometry &geometry,
+                                                  const RenderOption &option,
+                                                  const ViewControl &view) {
+    if (geometry.GetGeometryType() !=
+        geometry::Geometry::GeometryType::PointCloud) {
+        PrintShaderWarning("Rendering type is not geometry::PointCloud.");
+        return false;
+    }
+    if (!selected_ || selected_MVP_ != view.GetMVPMatrix() ||
+        selected_height_ != view.GetWindowHeight() ||
+        selected_pixel_error_ != option.point_lod_pixel_error_) {
+        SelectNodes(option, view);
+    }
+    glPointSize(GLfloat(option.point_size_));
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GLenum(option.GetGLDepthFunc()));
+    glUseProgram(program_);
+    glUniformMatrix4fv(MVP_, 1, GL_FALSE, view.GetMVPMatrix().data());
+    glEnableVertexAttribArray(vertex_position_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_position_buffer_);
+    glVertexAttribPointer(vertex_position_, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glEnableVertexAttribArray(vertex_color_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_color_buffer_);
+    glVertexAttribPointer(vertex_color_, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+    glDrawArrays(draw_arrays_mode_, 0, draw_arrays_size_);
+    glDisableVertexAttribArray(vertex_position_);
+    glDisableVertexAttribArray(vertex_color_);
+    return true;
+}
+
+void SimpleShaderForPointCloudLOD::UnbindGeometry(bool finalize) {
+    // The buffers are kept for the next cloud, the octree is rebuilt.
+    if (finalize) {
+        ReleaseBuffer(0, vertex_position_buffer_, finalize);
+        ReleaseBuffer(1, vertex_color_buffer_, finalize);
+    }
+    if (bound_) {
+        utility::device_vector<Eigen::Vector3f>().swap(node_centers_);
+        utility::device_vector<Eigen::Vector3f>().swap(node_points_);
+        utility::device_vector<Eigen::Vector3f>().swap(node_colors_);
+        utility::device_vector<int>().swap(node_parents_);
+        utility::device_vector<int>().swap(node_states_);
+        utility::device_vector<Eigen::Vector3f>().swap(points_);
+        utility::device_vector<Eigen::Vector3f>().swap(colors_);
+        utility::device_vector<int>().swap(point_leaves_);
+        level_offsets_.clear();
+        selected_ = false;
+        bound_ = false;
+    }
+}
+
+size_t SimpleShaderForPointCloudLOD::GetDataSize(const geometry::Geometry &geometry) const {
+    return ((const geometry::PointCloud &)geometry).points_.size();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <vector>
+
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/visualization/shader/shader_wrapper.h"
+
+namespace cupoch {
+namespace visualization {
+
+namespace glsl {
+
+/// \class SimpleShaderForPointCloudLOD
+///
+/// \brief Shader drawing a point cloud with a level of detail chosen per
+/// frame.
+///
+/// Binding the cloud builds an octree on the device: the points are sorted by
+/// the Morton codes of their cells and every node keeps the mean position and
+/// color of its points as representative. At every change of the view the
+/// nodes in the view frustum are selected top down by their size on the
+/// screen: a node is drawn as its representative once its cell is smaller
+/// than RenderOption::point_lod_pixel_error_ pixels, and the leaves still
+/// larger are drawn with all their points. The selection is written by CUDA
+/// into vertex buffers allocated once for the whole cloud.
+class SimpleShaderForPointCloudLOD : public ShaderWrapper {
+public:
+    SimpleShaderForPointCloudLOD()
+        : ShaderWrapper("SimpleShaderForPointCloudLOD") {
+        Compile();
+    }
+    ~SimpleShaderForPointCloudLOD() override { Release(); }
+
+protected:
+    bool Compile() final;
+    void Release() final;
+    bool BindGeometry(const geometry::Geometry &geometry,
+                      const RenderOption &option,
+                      const ViewControl &view) final;
+    bool RenderGeometry(const geometry::Geometry &geometry,
+                        const RenderOption &option,
+                        const ViewControl &view) final;
+    void UnbindGeometry(bool finalize = false) final;
+    size_t GetDataSize(const geometry::Geometry &geometry) const final;
+
+private:
+    /// Writes the points of the nodes selected for \p view to the buffers.
+    void SelectNodes(const RenderOption &option, const ViewControl &view);
+
+private:
+    GLuint vertex_position_;
+    GLuint vertex_position_buffer_;
+    GLuint vertex_color_;
+    GLuint vertex_color_buffer_;
+    GLuint MVP_;
+
+    Eigen::Vector3f origin_;
+    float root_size_ = 0.0f;
+    /// The nodes of the level l are [level_offsets_[l], level_offsets_[l+1]).
+    std::vector<int> level_offsets_;
+    utility::device_vector<Eigen::Vector3f> node_centers_;
+    utility::device_vector<Eigen::Vector3f> node_points_;
+    utility::device_vector<Eigen::Vector3f> node_colors_;
+    utility::device_vector<int> node_parents_;
+    utility::device_vector<int> node_states_;
+    /// The points in Morton order and the deepest nodes holding them.
+    utility::device_vector<Eigen::Vector3f> points_;
+    utility::device_vector<Eigen::Vector3f> colors_;
+    utility::device_vector<int> point_leaves_;
+
+    bool selected_ = false;
+    gl_helper::GLMatrix4f selected_MVP_;
+    int selected_height_ = 0;
+    float selected_pixel_error_ = 0.0f;
+};
+
+}  // namespace glsl
+
+}  // namespace visualization
+}  // namespace cupoch
@@ -2,12 +2,12 @@
 
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/trianglemesh.h"
-#include "cupoch/geometry/voxelgrid.h"
-#include "cupoch/geometry/occupancygrid.h"
 #include "cupoch/visualization/shader/shader.h"
 #include "cupoch/visualization/utility/color_map.h"
 #include "cupoch/utility/platform.h"
 #include <thrust/iterator/constant_iterator.h>
+#include <thrust/copy.h>
+#include <algorithm>
 #include <cuda_runtime.h>
 #include <cuda_gl_interop.h>
 
@@ -17,45 +17,17 @@ using namespace cupoch::visualization::glsl;
 
 namespace {
 
-// Coordinates of 8 vertices in a cuboid (assume origin (0,0,0), size 1)
-__constant__ int cuboid_vertex_offsets[8][3] = {
-    {0, 0, 0}, {1, 0, 0},
-    {0, 1, 0}, {1, 1, 0},
-    {0, 0, 1}, {1, 0, 1},
-    {0, 1, 1}, {1, 1, 1},
-};
-
-// Vertex indices of 12 triangles in a cuboid, for right-handed manifold mesh
-__constant__ int cuboid_triangles_vertex_indices[12][3] = {
-    {0, 2, 1}, {0, 1, 4},
-    {0, 4, 2}, {5, 1, 7},
-    {5, 7, 4}, {5, 4, 1},
-    {3, 7, 1}, {3, 1, 2},
-    {3, 2, 7}, {6, 4, 7},
-    {6, 7, 2}, {6, 2, 4},
-};
-
-__constant__ int cuboid_normals[12][3] = {
-    {0, 0, -1}, {0, -1, 0},
-    {-1, 0, 0}, {1, 0, 0},
-    {0, 0, 1}, {0, -1, 0},
-    {1, 0, 0}, {0, 0, -1},
-    {0, 1, 0}, {0, 0, 1},
-    {0, 1, 0}, {-1, 0, 0},
-};
-
-struct copy_pointcloud_functor{
-    copy_pointcloud_functor(bool has_colors, RenderOption::PointColorOption color_option, const ViewControl& view)
+struct copy_pointcloud_color_functor {
+    copy_pointcloud_color_functor(bool has_colors, RenderOption::PointColorOption color_option, const ViewControl& view)
         : has_colors_(has_colors), color_option_(color_option), view_(view) {};
     const bool has_colors_;
     const RenderOption::PointColorOption color_option_;
     const ViewControl view_;
     const ColorMap::ColorMapOption colormap_option_ = GetGlobalColorMapOption();
     __device__
-    thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector4f> operator() (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector3f>& pt_nm_cl) {
-        const Eigen::Vector3f &point = thrust::get<0>(pt_nm_cl);
-        const Eigen::Vector3f &normal = thrust::get<1>(pt_nm_cl);
-        const Eigen::Vector3f &color = thrust::get<2>(pt_nm_cl);
+    Eigen::Vector4f operator() (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f>& pt_cl) {
+        const Eigen::Vector3f &point = thrust::get<0>(pt_cl);
+        const Eigen::Vector3f &color = thrust::get<1>(pt_cl);
         Eigen::Vector4f color_tmp;
         color_tmp[3] = 1.0;
         switch (color_option_) {
@@ -78,7 +50,7 @@ struct copy_pointcloud_functor{
                 }
                 break;
         }
-        return thrust::make_tuple(point, normal, color_tmp);
+        return color_tmp;
     }
 };
 
@@ -143,116 +115,6 @@ struct copy_trianglemesh_functor {
 
 };
 
-template<typename VoxelType>
-struct compute_voxel_vertices_functor {
-    compute_voxel_vertices_functor(const VoxelType* voxels, const Eigen::Vector3f& origin, float voxel_size)
-     : voxels_(voxels), origin_(origin), voxel_size_(voxel_size) {};
-    const VoxelType* voxels_;
-    const Eigen::Vector3f origin_;
-    const float voxel_size_;
-    __device__
-    Eigen::Vector3f operator() (size_t idx) const {
-        int i = idx / 8;
-        int j = idx % 8;
-        const VoxelType &voxel = voxels_[i];
-        // 8 vertices in a voxel
-        Eigen::Vector3f base_vertex =
-                origin_ + voxel.grid_index_.template cast<float>() * voxel_size_;
-        const auto offset_v = Eigen::Vector3f(cuboid_vertex_offsets[j][0],
-                                              cuboid_vertex_offsets[j][1],
-                                              cuboid_vertex_offsets[j][2]);
-        return base_vertex + offset_v * voxel_size_;
-    }
-};
-
-struct default_color_functor {
-    __host__ __device__ default_color_functor() {};
-    __host__ __device__ ~default_color_functor() {};
-    __host__ __device__ default_color_functor(const default_color_functor& other) {};
-    __device__ Eigen::Vector3f color(const geometry::Voxel& voxel) const {
-        return voxel.color_;
-    }
-    __device__ float alpha(const geometry::Voxel& voxel) const {
-        return 1.0;
-    }
-};
-
-struct occupancy_color_functor {
-    __host__ __device__ occupancy_color_functor(float occ_prob_thres_log, bool visualize_free_area)
-     : occ_prob_thres_log_(occ_prob_thres_log), visualize_free_area_(visualize_free_area) {};
-    const float occ_prob_thres_log_;
-    const bool visualize_free_area_;
-    __host__ __device__ ~occupancy_color_functor() {};
-    __host__ __device__ occupancy_color_functor(const occupancy_color_functor& other)
-     : occ_prob_thres_log_(other.occ_prob_thres_log_), visualize_free_area_(other.visualize_free_area_) {};
-    __device__ Eigen::Vector3f color(geometry::OccupancyVoxel ocv) const {
-        return (ocv.prob_log_ > occ_prob_thres_log_) ? ocv.color_ : Eigen::Vector3f(0.0, 1.0, 0.0);
-    }
-    __device__ float alpha(geometry::OccupancyVoxel ocv) const {
-        return (ocv.prob_log_ > occ_prob_thres_log_) ? 1.0 : ((visualize_free_area_) ? 0.2 : 0.0);
-    }
-};
-
-template<typename VoxelType, typename ColorFuncType>
-struct copy_voxelgrid_face_functor {
-    copy_voxelgrid_face_functor(const Eigen::Vector3f* vertices, const VoxelType* voxels, bool has_colors,
-                                RenderOption::MeshColorOption color_option,
-                                const Eigen::Vector3f& default_mesh_color,
-                                const ViewControl& view, const ColorFuncType& cfunc)
-                                : vertices_(vertices), voxels_(voxels), has_colors_(has_colors),
-                                 color_option_(color_option), default_mesh_color_(default_mesh_color),
-                                 view_(view), cfunc_(cfunc) {};
-    const Eigen::Vector3f* vertices_;
-    const VoxelType* voxels_;
-    const bool has_colors_;
-    const RenderOption::MeshColorOption color_option_;
-    const Eigen::Vector3f default_mesh_color_;
-    const ViewControl view_;
-    const ColorFuncType cfunc_;
-    const ColorMap::ColorMapOption colormap_option_ = GetGlobalColorMapOption();
-    __device__
-    thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector4f> operator() (size_t idx) const {
-        int i = idx / (12 * 3);
-        int jk = idx % (12 * 3);
-        int j = jk / 3;
-        int k = jk % 3;
-        // Voxel color (applied to all points)
-        Eigen::Vector4f voxel_color;
-        voxel_color[3] = cfunc_.alpha(voxels_[i]);
-        switch (color_option_) {
-            case RenderOption::MeshColorOption::XCoordinate:
-                voxel_color.head<3>() = GetColorMapColor(view_.GetBoundingBox().GetXPercentage(vertices_[i * 8](0)), colormap_option_);
-                break;
-            case RenderOption::MeshColorOption::YCoordinate:
-                voxel_color.head<3>() = GetColorMapColor(view_.GetBoundingBox().GetYPercentage(vertices_[i * 8](1)), colormap_option_);
-                break;
-            case RenderOption::MeshColorOption::ZCoordinate:
-                voxel_color.head<3>() = GetColorMapColor(view_.GetBoundingBox().GetZPercentage(vertices_[i * 8](2)), colormap_option_);
-                break;
-            case RenderOption::MeshColorOption::Color:
-                if (has_colors_) {
-                    voxel_color.head<3>() = cfunc_.color(voxels_[i]);
-                    break;
-                }
-            case RenderOption::MeshColorOption::Default:
-            default:
-                voxel_color.head<3>() = default_mesh_color_;
-                break;
-        }
-        return thrust::make_tuple(vertices_[i * 8 + cuboid_triangles_vertex_indices[j][k]],
-            Eigen::Vector3f(cuboid_normals[j][0], cuboid_normals[j][1], cuboid_normals[j][2]), voxel_color);
-    }
-};
-
-struct alpha_greater_functor {
-    __device__ bool operator () (const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector4f>& lhs,
-                                 const thrust::tuple<Eigen::Vector3f, Eigen::Vector3f, Eigen::Vector4f>& rhs) {
-        const Eigen::Vector4f& lc = thrust::get<2>(lhs);
-        const Eigen::Vector4f& rc = thrust::get<2>(rhs);
-        return lc[3] > rc[3];
-    }
-};
-
 }
 
 bool PhongShader::Compile() {
@@ -287,33 +149,22 @@ void PhongShader::Release() {
 bool PhongShader::BindGeometry(const geometry::Geometry &geometry,
                                const RenderOption &option,
                                const ViewControl &view) {
-    // If there is already geometry, we first unbind it.
-    // We use GL_STATIC_DRAW. When geometry changes, we clear buffers and
-    // rebind the geometry. Note that this approach is slow. If the geometry is
-    // changing per frame, consider implementing a new ShaderWrapper using
-    // GL_STREAM_DRAW, and replace UnbindGeometry() with Buffer Object
-    // Streaming mechanisms.
-    UnbindGeometry();
-
-    // Prepare data to be passed to GPU
+    // The buffers are allocated with headroom and registered to CUDA once, so
+    // that an update of the geometry only rewrites its changed part through
+    // the mapped buffers.
     const size_t num_data_size = GetDataSize(geometry);
-
-    // Create buffers and bind the geometry
-    glGenBuffers(1, &vertex_position_buffer_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_position_buffer_);
-    glBufferData(GL_ARRAY_BUFFER, num_data_size * sizeof(Eigen::Vector3f), 0, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    cudaSafeCall(cudaGraphicsGLRegisterBuffer(&cuda_graphics_resources_[0], vertex_position_buffer_, cudaGraphicsMapFlagsNone));
-    glGenBuffers(1, &vertex_normal_buffer_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_normal_buffer_);
-    glBufferData(GL_ARRAY_BUFFER, num_data_size * sizeof(Eigen::Vector3f), 0, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    cudaSafeCall(cudaGraphicsGLRegisterBuffer(&cuda_graphics_resources_[1], vertex_normal_buffer_, cudaGraphicsMapFlagsNone));
-    glGenBuffers(1, &vertex_color_buffer_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_color_buffer_);
-    glBufferData(GL_ARRAY_BUFFER, num_data_size * sizeof(Eigen::Vector4f), 0, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    cudaSafeCall(cudaGraphicsGLRegisterBuffer(&cuda_graphics_resources_[2], vertex_color_buffer_, cudaGraphicsMapFlagsNone));
+    bool recreated = ReserveBuffer(0, vertex_position_buffer_,
+                                   num_data_size * sizeof(Eigen::Vector3f));
+    recreated |= ReserveBuffer(1, vertex_normal_buffer_,
+                               num_data_size * sizeof(Eigen::Vector3f));
+    recreated |= ReserveBuffer(2, vertex_color_buffer_,
+                               num_data_size * sizeof(Eigen::Vector4f));
+    if (recreated) {
+        pending_update_ = GeometryUpdate();
+    } else if (num_data_size > bound_data_size_) {
+        pending_update_.Merge(GeometryUpdate(AllVertexAttributes,
+                                             bound_data_size_, num_data_size));
+    }
 
     Eigen::Vector3f* raw_points_ptr;
     Eigen::Vector3f* raw_normals_ptr;
@@ -329,11 +180,14 @@ bool PhongShader::BindGeometry(const geometry::Geometry &geometry,
 
     if (PrepareBinding(geometry, option, view, dev_points_ptr, dev_normals_ptr, dev_colors_ptr) ==
         false) {
+        Unmap(3);
         PrintShaderWarning("Binding failed when preparing data.");
         return false;
     }
 
     Unmap(3);
+    pending_update_ = GeometryUpdate(0);
+    bound_data_size_ = num_data_size;
     bound_ = true;
     return true;
 }
@@ -374,17 +228,19 @@ bool PhongShader::RenderGeometry(const geometry::Geometry &geometry,
 }
 
 void PhongShader::UnbindGeometry(bool finalize) {
-    if (bound_) {
-        if (!finalize) {
-            cudaSafeCall(cudaGraphicsUnregisterResource(cuda_graphics_resources_[0]));
-            cudaSafeCall(cudaGraphicsUnregisterResource(cuda_graphics_resources_[1]));
-            cudaSafeCall(cudaGraphicsUnregisterResource(cuda_graphics_resources_[2]));
-        }
-        glDeleteBuffers(1, &vertex_position_buffer_);
-        glDeleteBuffers(1, &vertex_normal_buffer_);
-        glDeleteBuffers(1, &vertex_color_buffer_);
-        bound_ = false;
-    }
+    if (finalize) {
+        ReleaseBuffer(0, vertex_position_buffer_, finalize);
+        ReleaseBuffer(1, vertex_normal_buffer_, finalize);
+        ReleaseBuffer(2, vertex_color_buffer_, finalize);
+        bound_data_size_ = 0;
+    }
+    pending_update_ = GeometryUpdate();
+    bound_ = false;
+}
+
+void PhongShader::InvalidateGeometry(const GeometryUpdate &update) {
+    pending_update_.Merge(update);
+    bound_ = false;
 }
 
 void PhongShader::SetLighting(const ViewControl &view,
@@ -462,17 +318,40 @@ bool PhongShaderForPointCloud::PrepareBinding(
         PrintShaderWarning("Binding failed with pointcloud with no normals.");
         return false;
     }
-    copy_pointcloud_functor func(pointcloud.HasColors(), option.point_color_option_, view);
-    if (pointcloud.HasColors()) {
-        thrust::transform(make_tuple_begin(pointcloud.points_, pointcloud.normals_, pointcloud.colors_),
-                          make_tuple_end(pointcloud.points_, pointcloud.normals_, pointcloud.colors_),
-                          make_tuple_iterator(points, normals, colors), func);
-    } else {
-        thrust::transform(make_tuple_iterator(pointcloud.points_.begin(), pointcloud.normals_.begin(),
-                                              thrust::constant_iterator<Eigen::Vector3f>(Eigen::Vector3f::Zero())),
-                          make_tuple_iterator(pointcloud.points_.end(), pointcloud.normals_.end(),
-                                              thrust::constant_iterator<Eigen::Vector3f>(Eigen::Vector3f::Zero())),
-                          make_tuple_iterator(points, normals, colors), func);
+    // Only the pending part of the buffers is written. The colors may be
+    // computed from the positions, so they are rewritten with them.
+    const size_t n_points = pointcloud.points_.size();
+    const size_t begin = std::min(pending_update_.begin_, n_points);
+    const size_t end = std::min(pending_update_.end_, n_points);
+    const unsigned int attributes = pending_update_.attributes_;
+    if (begin < end && (attributes & VertexPositions)) {
+        thrust::copy(pointcloud.points_.begin() + begin,
+                     pointcloud.points_.begin() + end, points + begin);
+    }
+    if (begin < end && (attributes & VertexNormals)) {
+        thrust::copy(pointcloud.normals_.begin() + begin,
+                     pointcloud.normals_.begin() + end, normals + begin);
+    }
+    if (begin < end && (attributes & (VertexPositions | VertexColors))) {
+        copy_pointcloud_color_functor func(pointcloud.HasColors(),
+                                           option.point_color_option_, view);
+        if (pointcloud.HasColors()) {
+            thrust::transform(
+                    make_tuple_iterator(pointcloud.points_.begin() + begin,
+                                        pointcloud.colors_.begin() + begin),
+                    make_tuple_iterator(pointcloud.points_.begin() + end,
+                                        pointcloud.colors_.begin() + end),
+                    colors + begin, func);
+        } else {
+            const thrust::constant_iterator<Eigen::Vector3f> no_colors(
+                    Eigen::Vector3f::Zero());
+            thrust::transform(
+                    make_tuple_iterator(pointcloud.points_.begin() + begin,
+                                        no_colors),
+                    make_tuple_iterator(pointcloud.points_.begin() + end,
+                                        no_colors),
+                    colors + begin, func);
+        }
     }
     draw_arrays_mode_ = GL_POINTS;
     draw_arrays_size_ = GLsizei(pointcloud.points_.size());
@@ -553,151 +432,3 @@ bool PhongShaderForTriangleMesh::PrepareBinding(
 size_t PhongShaderForTriangleMesh::GetDataSize(const geometry::Geometry &geometry) const {
     return ((const geometry::TriangleMesh &)geometry).triangles_.size() * 3;
 }
-
-bool PhongShaderForVoxelGridFace::PrepareRendering(
-        const geometry::Geometry &geometry,
-        const RenderOption &option,
-        const ViewControl &view) {
-    if (geometry.GetGeometryType() !=
-        geometry::Geometry::GeometryType::VoxelGrid) {
-        PrintShaderWarning("Rendering type is not geometry::VoxelGrid.");
-        return false;
-    }
-    if (option.mesh_show_back_face_) {
-        glDisable(GL_CULL_FACE);
-    } else {
-        glEnable(GL_CULL_FACE);
-    }
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GLenum(option.GetGLDepthFunc()));
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    SetLighting(view, option);
-    return true;
-}
-
-bool PhongShaderForVoxelGridFace::PrepareBinding(
-        const geometry::Geometry &geometry,
-        const RenderOption &option,
-        const ViewControl &view,
-        thrust::device_ptr<Eigen::Vector3f> &points,
-        thrust::device_ptr<Eigen::Vector3f> &normals,
-        thrust::device_ptr<Eigen::Vector4f> &colors) {
-    if (geometry.GetGeometryType() !=
-        geometry::Geometry::GeometryType::VoxelGrid) {
-        PrintShaderWarning("Rendering type is not geometry::VoxelGrid.");
-        return false;
-    }
-    const geometry::VoxelGrid &voxel_grid =
-            (const geometry::VoxelGrid &)geometry;
-    if (voxel_grid.HasVoxels() == false) {
-        PrintShaderWarning("Binding failed with empty voxel grid.");
-        return false;
-    }
-
-    utility::device_vector<Eigen::Vector3f> vertices(voxel_grid.voxels_values_.size() * 8);
-    compute_voxel_vertices_functor<geometry::Voxel> func1(thrust::raw_pointer_cast(voxel_grid.voxels_values_.data()),
-                                                          voxel_grid.origin_, voxel_grid.voxel_size_);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator<size_t>(voxel_grid.voxels_values_.size() * 8),
-                      vertices.begin(), func1);
-
-    size_t n_out = voxel_grid.voxels_values_.size() * 12 * 3;
-    copy_voxelgrid_face_functor<geometry::Voxel, default_color_functor> func2(
-        thrust::raw_pointer_cast(vertices.data()),
-        thrust::raw_pointer_cast(voxel_grid.voxels_values_.data()),
-        voxel_grid.HasColors(), option.mesh_color_option_,
-        option.default_mesh_color_,
-        view, default_color_functor());
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_out),
-                      make_tuple_iterator(points, normals, colors), func2);
-    draw_arrays_mode_ = GL_TRIANGLES;
-    draw_arrays_size_ = GLsizei(n_out);
-
-    return true;
-}
-
-size_t PhongShaderForVoxelGridFace::GetDataSize(const geometry::Geometry &geometry) const {
-    return ((const geometry::VoxelGrid &)geometry).voxels_keys_.size() * 12 * 3;
-}
-
-bool PhongShaderForOccupancyGrid::PrepareRendering(
-        const geometry::Geometry &geometry,
-        const RenderOption &option,
-        const ViewControl &view) {
-    if (geometry.GetGeometryType() !=
-        geometry::Geometry::GeometryType::OccupancyGrid) {
-        PrintShaderWarning("Rendering type is not geometry::OccupancyGrid.");
-        return false;
-    }
-    if (option.mesh_show_back_face_) {
-        glDisable(GL_CULL_FACE);
-    } else {
-        glEnable(GL_CULL_FACE);
-    }
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GLenum(option.GetGLDepthFunc()));
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    if (option.mesh_show_wireframe_) {
-        glEnable(GL_POLYGON_OFFSET_FILL);
-        glPolygonOffset(1.0, 1.0);
-    } else {
-        glDisable(GL_POLYGON_OFFSET_FILL);
-    }
-    SetLighting(view, option);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    return true;
-}
-
-bool PhongShaderForOccupancyGrid::PrepareBinding(
-        const geometry::Geometry &geometry,
-        const RenderOption &option,
-        const ViewControl &view,
-        thrust::device_ptr<Eigen::Vector3f> &points,
-        thrust::device_ptr<Eigen::Vector3f> &normals,
-        thrust::device_ptr<Eigen::Vector4f> &colors) {
-    if (geometry.GetGeometryType() !=
-        geometry::Geometry::GeometryType::OccupancyGrid) {
-        PrintShaderWarning("Rendering type is not geometry::OccupancyGrid.");
-        return false;
-    }
-    const geometry::OccupancyGrid &occupancy_grid =
-            (const geometry::OccupancyGrid &)geometry;
-    if (occupancy_grid.HasVoxels() == false) {
-        PrintShaderWarning("Binding failed with empty voxel grid.");
-        return false;
-    }
-
-    auto voxels = occupancy_grid.ExtractKnownVoxels();
-    utility::device_vector<Eigen::Vector3f> vertices(voxels->size() * 8);
-    Eigen::Vector3f origin = occupancy_grid.origin_ - 0.5 * occupancy_grid.voxel_size_ * Eigen::Vector3f::Constant(occupancy_grid.resolution_);
-    compute_voxel_vertices_functor<geometry::OccupancyVoxel> func1(thrust::raw_pointer_cast(voxels->data()),
-                                                                   origin, occupancy_grid.voxel_size_);
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator<size_t>(voxels->size() * 8),
-                      vertices.begin(), func1);
-
-    size_t n_out = voxels->size() * 12 * 3;
-    copy_voxelgrid_face_functor<geometry::OccupancyVoxel, occupancy_color_functor> func2(
-        thrust::raw_pointer_cast(vertices.data()),
-        thrust::raw_pointer_cast(voxels->data()),
-        occupancy_grid.HasColors(), option.mesh_color_option_,
-        option.default_mesh_color_, view,
-        occupancy_color_functor(occupancy_grid.occ_prob_thres_log_, occupancy_grid.visualize_free_area_));
-    thrust::transform(thrust::make_counting_iterator<size_t>(0),
-                      thrust::make_counting_iterator(n_out),
-                      make_tuple_iterator(points, normals, colors), func2);
-    auto begin = make_tuple_iterator(points, normals, colors);
-    thrust::sort(begin, begin + n_out, alpha_greater_functor());
-    draw_arrays_mode_ = GL_TRIANGLES;
-    draw_arrays_size_ = GLsizei(n_out);
-
-    return true;
-}
-
-size_t PhongShaderForOccupancyGrid::GetDataSize(const geometry::Geometry &geometry) const {
-    const geometry::OccupancyGrid &occupancy_grid = (const geometry::OccupancyGrid &)geometry;
-    Eigen::Vector3ui16 diff = occupancy_grid.max_bound_ - occupancy_grid.min_bound_ + Eigen::Vector3ui16::Ones();
-    return diff[0] * diff[1] * diff[2] * 12 * 3;
-}
\ No newline at end of file
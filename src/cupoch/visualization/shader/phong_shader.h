@@ -17,6 +17,10 @@ public:
 protected:
     PhongShader(const std::string &name) : ShaderWrapper(name) { Compile(); }
 
+public:
+    using ShaderWrapper::InvalidateGeometry;
+    void InvalidateGeometry(const GeometryUpdate &update) final;
+
 protected:
     bool Compile() final;
     void Release() final;
@@ -26,6 +30,8 @@ protected:
     bool RenderGeometry(const geometry::Geometry &geometry,
                         const RenderOption &option,
                         const ViewControl &view) final;
+    /// The buffers are kept over the updates of the geometry and only
+    /// unbound from CUDA when \p finalize is set.
     void UnbindGeometry(bool finalize = false) final;
 
 protected:
@@ -59,6 +65,11 @@ protected:
     GLuint light_specular_shininess_;
     GLuint light_ambient_;
 
+    /// Part of the buffers to rewrite at the next binding. The shaders which
+    /// can't write parts of their buffers rewrite them whole.
+    GeometryUpdate pending_update_;
+    size_t bound_data_size_ = 0;
+
     // At most support 4 lights
     gl_helper::GLMatrix4f light_position_world_data_;
     gl_helper::GLMatrix4f light_color_data_;
@@ -102,40 +113,6 @@ protected:
     size_t GetDataSize(const geometry::Geometry &geometry) const final;
 };
 
-class PhongShaderForVoxelGridFace : public PhongShader {
-public:
-    PhongShaderForVoxelGridFace() : PhongShader("PhongShaderForVoxelGridFace") {}
-
-protected:
-    bool PrepareRendering(const geometry::Geometry &geometry,
-                          const RenderOption &option,
-                          const ViewControl &view) final;
-    bool PrepareBinding(const geometry::Geometry &geometry,
-                        const RenderOption &option,
-                        const ViewControl &view,
-                        thrust::device_ptr<Eigen::Vector3f> &points,
-                        thrust::device_ptr<Eigen::Vector3f> &normals,
-                        thrust::device_ptr<Eigen::Vector4f> &colors) final;
-    size_t GetDataSize(const geometry::Geometry &geometry) const final;
-};
-
-class PhongShaderForOccupancyGrid : public PhongShader {
-public:
-    PhongShaderForOccupancyGrid() : PhongShader("PhongShaderForOccupancyGrid") {}
-
-protected:
-    bool PrepareRendering(const geometry::Geometry &geometry,
-                          const RenderOption &option,
-                          const ViewControl &view) final;
-    bool PrepareBinding(const geometry::Geometry &geometry,
-                        const RenderOption &option,
-                        const ViewControl &view,
-                        thrust::device_ptr<Eigen::Vector3f> &points,
-                        thrust::device_ptr<Eigen::Vector3f> &normals,
-                        thrust::device_ptr<Eigen::Vector4f> &colors) final;
-    size_t GetDataSize(const geometry::Geometry &geometry) const final;
-};
-
 }  // namespace glsl
 
 }  // namespace visualization
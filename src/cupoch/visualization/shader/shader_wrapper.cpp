@@ -2,18 +2,34 @@
 
 #include "cupoch/geometry/geometry.h"
 #include "cupoch/utility/console.h"
+#include "cupoch/utility/memory_tracker.h"
 #include "cupoch/utility/platform.h"
 #include <cuda_runtime.h>
 #include <cuda_gl_interop.h>
 
+#include <algorithm>
+
 namespace cupoch {
 namespace visualization {
 
 namespace glsl {
 
+void GeometryUpdate::Merge(const GeometryUpdate &other) {
+    if (other.IsEmpty()) return;
+    if (IsEmpty()) {
+        *this = other;
+        return;
+    }
+    attributes_ |= other.attributes_;
+    begin_ = std::min(begin_, other.begin_);
+    end_ = std::max(end_, other.end_);
+}
+
 bool ShaderWrapper::Render(const geometry::Geometry &geometry,
                            const RenderOption &option,
                            const ViewControl &view) {
+    utility::ScopedMemorySubsystem memory_subsystem(
+            utility::MemorySubsystem::Visualizer);
     if (compiled_ == false) {
         Compile();
     }
@@ -37,6 +53,38 @@ void ShaderWrapper::InvalidateGeometry() {
     }
 }
 
+void ShaderWrapper::InvalidateGeometry(const GeometryUpdate &update) {
+    InvalidateGeometry();
+}
+
+bool ShaderWrapper::ReserveBuffer(size_t index, GLuint &buffer, size_t size) {
+    if (buffer_capacities_[index] > 0 && size <= buffer_capacities_[index]) {
+        return false;
+    }
+    ReleaseBuffer(index, buffer);
+    const size_t capacity = std::max(size + size / 2, size_t(1));
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity, 0, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    cudaSafeCall(cudaGraphicsGLRegisterBuffer(&cuda_graphics_resources_[index],
+                                              buffer,
+                                              cudaGraphicsMapFlagsNone));
+    buffer_capacities_[index] = capacity;
+    return true;
+}
+
+void ShaderWrapper::ReleaseBuffer(size_t index, GLuint &buffer, bool finalize) {
+    if (buffer_capacities_[index] == 0) return;
+    if (!finalize) {
+        cudaSafeCall(
+                cudaGraphicsUnregisterResource(cuda_graphics_resources_[index]));
+    }
+    cuda_graphics_resources_[index] = NULL;
+    glDeleteBuffers(1, &buffer);
+    buffer_capacities_[index] = 0;
+}
+
 void ShaderWrapper::PrintShaderWarning(const std::string &message) const {
     utility::LogWarning("[{}] {}", GetShaderName(), message);
 }
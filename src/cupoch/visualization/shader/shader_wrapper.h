@@ -2,6 +2,8 @@
 
 #include <GL/glew.h>
 
+#include <limits>
+
 #include "cupoch/geometry/geometry.h"
 #include "cupoch/visualization/visualizer/render_option.h"
 #include "cupoch/visualization/visualizer/view_control.h"
@@ -11,6 +13,34 @@ namespace visualization {
 
 namespace glsl {
 
+/// Vertex attributes of a geometry.
+enum VertexAttribute : unsigned int {
+    VertexPositions = 1 << 0,
+    VertexNormals = 1 << 1,
+    VertexColors = 1 << 2,
+    AllVertexAttributes = VertexPositions | VertexNormals | VertexColors,
+};
+
+/// Part of a geometry changed since it was bound: the vertex attributes in
+/// attributes_ of the vertices in [begin_, end_) of the vertex buffers, the
+/// points for a point cloud. The shaders with persistent buffers only rewrite
+/// this part, the others rebind the whole geometry.
+struct GeometryUpdate {
+    GeometryUpdate() {}
+    GeometryUpdate(unsigned int attributes,
+                   size_t begin = 0,
+                   size_t end = std::numeric_limits<size_t>::max())
+        : attributes_(attributes), begin_(begin), end_(end) {}
+
+    bool IsEmpty() const { return attributes_ == 0 || begin_ >= end_; }
+    /// Extends the update to cover \p other too.
+    void Merge(const GeometryUpdate &other);
+
+    unsigned int attributes_ = AllVertexAttributes;
+    size_t begin_ = 0;
+    size_t end_ = std::numeric_limits<size_t>::max();
+};
+
 class ShaderWrapper {
 public:
     virtual ~ShaderWrapper() {}
@@ -32,6 +62,10 @@ public:
     /// Function to invalidate the geometry (set the dirty flag and release
     /// geometry resource)
     void InvalidateGeometry();
+    /// Same as above for a change of the part \p update of the geometry.
+    /// The shaders with persistent buffers keep them bound to CUDA and only
+    /// rewrite this part on the next rendering.
+    virtual void InvalidateGeometry(const GeometryUpdate &update);
 
     const std::string &GetShaderName() const { return shader_name_; }
 
@@ -65,6 +99,15 @@ protected:
                         const char *const geometry_shader_code,
                         const char *const fragment_shader_code);
     void ReleaseProgram();
+    /// Makes the GL buffer \p buffer, registered as the CUDA resource
+    /// \p index, hold at least \p size bytes. The buffer is kept over the
+    /// updates of the geometry and only re-created, with half of \p size of
+    /// headroom, when it is too small. Returns true if it was re-created, so
+    /// its whole content must be written.
+    bool ReserveBuffer(size_t index, GLuint &buffer, size_t size);
+    /// Deletes the buffer of ReserveBuffer(). The CUDA resource is not
+    /// unregistered when \p finalize is set, as in UnbindGeometry().
+    void ReleaseBuffer(size_t index, GLuint &buffer, bool finalize = false);
 
 protected:
     GLuint vertex_shader_;
@@ -76,6 +119,7 @@ protected:
     bool compiled_ = false;
     bool bound_ = false;
     cudaGraphicsResource_t cuda_graphics_resources_[4] = {NULL, NULL, NULL, NULL};
+    size_t buffer_capacities_[4] = {0, 0, 0, 0};
 
     void SetShaderName(const std::string &shader_name) {
         shader_name_ = shader_name;
@@ -1,7 +1,11 @@
 #include "cupoch/visualization/utility/draw_geometry.h"
 
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/image.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/integration/uniform_tsdfvolume.h"
 #include "cupoch/visualization/visualizer/visualizer.h"
 #include "cupoch/utility/console.h"
 
@@ -39,4 +43,94 @@ bool cupoch::visualization::DrawGeometries(const std::vector<std::shared_ptr<con
     visualizer.Run();
     visualizer.DestroyVisualizerWindow();
     return true;
-}
\ No newline at end of file
+}
+
+namespace {
+
+typedef std::function<std::shared_ptr<geometry::Image>(
+        const camera::PinholeCameraParameters &)>
+        RaycastFunction;
+
+bool DrawRaycast(const RaycastFunction &raycast,
+                 const geometry::AxisAlignedBoundingBox &bound,
+                 const std::string &window_name,
+                 int width,
+                 int height,
+                 int left,
+                 int top) {
+    Visualizer visualizer;
+    if (visualizer.CreateVisualizerWindow(window_name, width, height, left,
+                                          top) == false) {
+        utility::LogWarning("[DrawTSDFVolume] Failed creating OpenGL window.");
+        return false;
+    }
+    // The image is drawn over the window, so the camera is fit to the
+    // volume instead.
+    auto image = std::make_shared<geometry::Image>();
+    visualizer.AddGeometry(image, false);
+    visualizer.GetViewControl().FitInGeometry(bound);
+    visualizer.ResetViewPoint();
+    Eigen::Matrix4f last_extrinsic = Eigen::Matrix4f::Zero();
+    visualizer.RegisterAnimationCallback([&](Visualizer *vis) {
+        camera::PinholeCameraParameters parameters;
+        if (!vis->GetViewControl().ConvertToPinholeCameraParameters(
+                    parameters)) {
+            return false;
+        }
+        if (parameters.extrinsic_ == last_extrinsic &&
+            parameters.intrinsic_.width_ == image->width_ &&
+            parameters.intrinsic_.height_ == image->height_) {
+            return false;
+        }
+        last_extrinsic = parameters.extrinsic_;
+        *image = *raycast(parameters);
+        return true;
+    });
+    visualizer.Run();
+    visualizer.DestroyVisualizerWindow();
+    return true;
+}
+
+}  // namespace
+
+bool cupoch::visualization::DrawTSDFVolume(const integration::UniformTSDFVolume &volume,
+                                           const std::string &window_name /* = "Cupoch"*/,
+                                           int width /* = 640*/,
+                                           int height /* = 480*/,
+                                           int left /* = 50*/,
+                                           int top /* = 50*/,
+                                           float max_depth /* = 3.0*/,
+                                           bool show_depth /* = false*/) {
+    const bool depth = show_depth ||
+                       volume.color_type_ == integration::TSDFVolumeColorType::NoColor;
+    auto raycast = [&](const camera::PinholeCameraParameters &parameters) {
+        return depth ? volume.RaycastDepth(parameters.intrinsic_,
+                                           parameters.extrinsic_, max_depth)
+                     : volume.RaycastColor(parameters.intrinsic_,
+                                           parameters.extrinsic_, max_depth);
+    };
+    const geometry::AxisAlignedBoundingBox bound(
+            volume.origin_,
+            volume.origin_ + Eigen::Vector3f::Constant(volume.length_));
+    return DrawRaycast(raycast, bound, window_name, width, height, left, top);
+}
+
+bool cupoch::visualization::DrawTSDFVolume(const integration::ScalableTSDFVolume &volume,
+                                           const std::string &window_name /* = "Cupoch"*/,
+                                           int width /* = 640*/,
+                                           int height /* = 480*/,
+                                           int left /* = 50*/,
+                                           int top /* = 50*/,
+                                           float max_depth /* = 3.0*/,
+                                           bool show_depth /* = false*/) {
+    const bool depth = show_depth ||
+                       volume.color_type_ == integration::TSDFVolumeColorType::NoColor;
+    auto raycast = [&](const camera::PinholeCameraParameters &parameters) {
+        return depth ? volume.RaycastDepth(parameters.intrinsic_,
+                                           parameters.extrinsic_, max_depth)
+                     : volume.RaycastColor(parameters.intrinsic_,
+                                           parameters.extrinsic_, max_depth);
+    };
+    return DrawRaycast(raycast, volume.GetAxisAlignedBoundingBox(),
+                       window_name, width, height, left, top);
+}
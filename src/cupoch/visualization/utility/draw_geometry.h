@@ -8,6 +8,12 @@
 #include "cupoch/geometry/geometry.h"
 
 namespace cupoch {
+
+namespace integration {
+class UniformTSDFVolume;
+class ScalableTSDFVolume;
+}  // namespace integration
+
 namespace visualization {
 
 class Visualizer;
@@ -38,5 +44,35 @@ bool DrawGeometries(const std::vector<std::shared_ptr<const geometry::Geometry>>
                     bool mesh_show_wireframe = false,
                     bool mesh_show_back_face = false);
 
+/// The function to preview a TSDF volume without meshing it: every frame
+/// the window camera moves, the volume is raycast from it and the color
+/// (or, with \p show_depth or without color, the depth) of the surface is
+/// drawn over the window. The mouse moves the camera as in DrawGeometries().
+///
+/// \param volume The volume to be shown.
+/// \param window_name The displayed title of the visualization window.
+/// \param width The width of the visualization window.
+/// \param height The height of the visualization window.
+/// \param left margin of the visualization window.
+/// \param top The top margin of the visualization window.
+/// \param max_depth Length of the rays.
+/// \param show_depth Show the raycast depth instead of the color.
+bool DrawTSDFVolume(const integration::UniformTSDFVolume &volume,
+                    const std::string &window_name = "Cupoch",
+                    int width = 640,
+                    int height = 480,
+                    int left = 50,
+                    int top = 50,
+                    float max_depth = 3.0,
+                    bool show_depth = false);
+bool DrawTSDFVolume(const integration::ScalableTSDFVolume &volume,
+                    const std::string &window_name = "Cupoch",
+                    int width = 640,
+                    int height = 480,
+                    int left = 50,
+                    int top = 50,
+                    float max_depth = 3.0,
+                    bool show_depth = false);
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,458 @@
+#include <cuda_gl_interop.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <algorithm>
+
+#ifdef USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/visualization/visualizer/offscreen_renderer.h"
+
+using namespace cupoch;
+using namespace cupoch::visualization;
+
+namespace {
+
+// glReadPixels reads the rows bottom up.
+struct flip_color_functor {
+    flip_color_functor(const float *src, float *dst, int width, int height)
+        : src_(src), dst_(dst), width_(width), height_(height){};
+    const float *src_;
+    float *dst_;
+    const int width_;
+    const int height_;
+    __device__ void operator()(size_t idx) const {
+        const int n_row = width_ * 3;
+        const int i = idx / n_row;
+        const int j = idx % n_row;
+        dst_[idx] = src_[(height_ - i - 1) * n_row + j];
+    }
+};
+
+struct convert_depth_functor {
+    convert_depth_functor(const float *src,
+                          float *dst,
+                          int width,
+                          int height,
+                          float z_near,
+                          float z_far)
+        : src_(src),
+          dst_(dst),
+          width_(width),
+          height_(height),
+          z_near_(z_near),
+          z_far_(z_far){};
+    const float *src_;
+    float *dst_;
+    const int width_;
+    const int height_;
+    const float z_near_;
+    const float z_far_;
+    __device__ void operator()(size_t idx) const {
+        const int i = idx / width_;
+        const int j = idx % width_;
+        const float d = src_[(height_ - i - 1) * width_ + j];
+        dst_[idx] = (d == 1.0f)
+                            ? 0.0f
+                            : 2.0f * z_near_ * z_far_ /
+                                      (z_far_ + z_near_ -
+                                       (2.0f * d - 1.0f) * (z_far_ - z_near_));
+    }
+};
+
+#ifdef USE_EGL
+// The display of the EGL device driving the CUDA device, the default display
+// when the devices can't be enumerated.
+EGLDisplay GetDeviceDisplay(int device) {
+    auto query_devices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress(
+            "eglQueryDevicesEXT");
+    auto query_device_attrib = (PFNEGLQUERYDEVICEATTRIBEXTPROC)eglGetProcAddress(
+            "eglQueryDeviceAttribEXT");
+    auto get_platform_display =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+                    "eglGetPlatformDisplayEXT");
+    if (query_devices && query_device_attrib && get_platform_display) {
+        EGLDeviceEXT egl_devices[16];
+        EGLint n_devices = 0;
+        query_devices(16, egl_devices, &n_devices);
+        for (EGLint i = 0; i < n_devices; ++i) {
+            EGLAttrib cuda_device = -1;
+            if (query_device_attrib(egl_devices[i], EGL_CUDA_DEVICE_NV,
+                                    &cuda_device) == EGL_TRUE &&
+                cuda_device == device) {
+                return get_platform_display(EGL_PLATFORM_DEVICE_EXT,
+                                            egl_devices[i], nullptr);
+            }
+        }
+        utility::LogWarning(
+                "[OffscreenRenderer] No EGL device for CUDA device {}, using "
+                "the default display.",
+                device);
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
+}  // namespace
+
+OffscreenRenderer::OffscreenRenderer() {}
+
+OffscreenRenderer::~OffscreenRenderer() { DestroyContext(); }
+
+bool OffscreenRenderer::CreateContext(int width /* = 640*/,
+                                      int height /* = 480*/,
+                                      int device /* = -1*/) {
+#ifdef USE_EGL
+    if (context_) {
+        utility::LogWarning("[OffscreenRenderer] Context already created.");
+        return true;
+    }
+    if (device < 0) device = utility::GetDevice();
+    EGLDisplay display = GetDeviceDisplay(device);
+    if (display == EGL_NO_DISPLAY ||
+        eglInitialize(display, nullptr, nullptr) == EGL_FALSE) {
+        utility::LogWarning("[OffscreenRenderer] Failed to initialize EGL.");
+        return false;
+    }
+    display_ = display;
+
+    const EGLint config_attribs[] = {EGL_SURFACE_TYPE,
+                                     EGL_PBUFFER_BIT,
+                                     EGL_RED_SIZE,
+                                     8,
+                                     EGL_GREEN_SIZE,
+                                     8,
+                                     EGL_BLUE_SIZE,
+                                     8,
+                                     EGL_DEPTH_SIZE,
+                                     24,
+                                     EGL_RENDERABLE_TYPE,
+                                     EGL_OPENGL_BIT,
+                                     EGL_NONE};
+    EGLConfig config;
+    EGLint n_configs = 0;
+    if (eglChooseConfig(display, config_attribs, &config, 1, &n_configs) ==
+                EGL_FALSE ||
+        n_configs == 0 || eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+        utility::LogWarning(
+                "[OffscreenRenderer] No EGL configuration for OpenGL.");
+        DestroyContext();
+        return false;
+    }
+    // The frames are drawn to a framebuffer object, the surface is only
+    // needed to make the context current.
+    const EGLint surface_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    surface_ = eglCreatePbufferSurface(display, config, surface_attribs);
+    const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_MINOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT,
+                                          context_attribs);
+    if (surface_ == EGL_NO_SURFACE || context == EGL_NO_CONTEXT) {
+        utility::LogWarning("[OffscreenRenderer] Failed to create context.");
+        DestroyContext();
+        return false;
+    }
+    context_ = context;
+    if (MakeCurrent() == false) {
+        DestroyContext();
+        return false;
+    }
+
+    glewExperimental = true;
+    GLenum glew_status = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLEW built for GLX fails to load its extensions without X display, the
+    // core functions are loaded regardless.
+    if (glew_status == GLEW_ERROR_NO_GLX_DISPLAY) glew_status = GLEW_OK;
+#endif
+    if (glew_status != GLEW_OK) {
+        utility::LogWarning("[OffscreenRenderer] Failed to initialize GLEW.");
+        DestroyContext();
+        return false;
+    }
+
+    width_ = width;
+    height_ = height;
+    glGenVertexArrays(1, &vao_id_);
+    glBindVertexArray(vao_id_);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glGenRenderbuffers(1, &color_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_RENDERBUFFER, color_buffer_);
+    glGenRenderbuffers(1, &depth_buffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width_,
+                          height_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              GL_RENDERBUFFER, depth_buffer_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        utility::LogWarning(
+                "[OffscreenRenderer] Incomplete framebuffer object.");
+        DestroyContext();
+        return false;
+    }
+
+    // Pixel buffers of the colors and of the depths.
+    const size_t sizes[2] = {size_t(width_) * height_ * 3 * sizeof(float),
+                             size_t(width_) * height_ * sizeof(float)};
+    glGenBuffers(2, pixel_buffers_);
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffers_[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, sizes[i], nullptr, GL_STREAM_READ);
+        cudaSafeCall(cudaGraphicsGLRegisterBuffer(
+                &pixel_resources_[i], pixel_buffers_[i],
+                cudaGraphicsMapFlagsReadOnly));
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // depth test
+    glEnable(GL_DEPTH_TEST);
+    glClearDepth(1.0f);
+
+    // pixel alignment
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // polygon rendering
+    glEnable(GL_CULL_FACE);
+
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+    view_control_.ChangeWindowSize(width_, height_);
+    ResetViewPoint();
+    return true;
+#else
+    utility::LogWarning(
+            "[OffscreenRenderer] Headless rendering requires building with "
+            "USE_EGL.");
+    return false;
+#endif
+}
+
+void OffscreenRenderer::DestroyContext() {
+#ifdef USE_EGL
+    if (display_ == nullptr) return;
+    if (context_ && MakeCurrent()) {
+        // The renderers release their buffers in the context.
+        geometry_renderers_.clear();
+        for (int i = 0; i < 2; ++i) {
+            if (pixel_resources_[i]) {
+                cudaSafeCall(cudaGraphicsUnregisterResource(
+                        pixel_resources_[i]));
+                pixel_resources_[i] = nullptr;
+            }
+        }
+        if (pixel_buffers_[0]) glDeleteBuffers(2, pixel_buffers_);
+        if (depth_buffer_) glDeleteRenderbuffers(1, &depth_buffer_);
+        if (color_buffer_) glDeleteRenderbuffers(1, &color_buffer_);
+        if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+        if (vao_id_) glDeleteVertexArrays(1, &vao_id_);
+        pixel_buffers_[0] = pixel_buffers_[1] = 0;
+        depth_buffer_ = color_buffer_ = framebuffer_ = vao_id_ = 0;
+    }
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context_) eglDestroyContext(display_, context_);
+    if (surface_) eglDestroySurface(display_, surface_);
+    eglTerminate(display_);
+    context_ = surface_ = display_ = nullptr;
+#endif
+}
+
+bool OffscreenRenderer::MakeCurrent() {
+#ifdef USE_EGL
+    if (context_ == nullptr ||
+        eglMakeCurrent(display_, surface_, surface_, context_) == EGL_FALSE) {
+        utility::LogWarning(
+                "[OffscreenRenderer] Failed to make the context current.");
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool OffscreenRenderer::AddGeometry(
+        std::shared_ptr<const geometry::Geometry> geometry_ptr,
+        bool reset_bounding_box) {
+    if (MakeCurrent() == false) {
+        return false;
+    }
+    std::shared_ptr<glsl::GeometryRenderer> renderer_ptr;
+    switch (geometry_ptr->GetGeometryType()) {
+        case geometry::Geometry::GeometryType::PointCloud:
+            renderer_ptr = std::make_shared<glsl::PointCloudRenderer>();
+            break;
+        case geometry::Geometry::GeometryType::VoxelGrid:
+            renderer_ptr = std::make_shared<glsl::VoxelGridRenderer>();
+            break;
+        case geometry::Geometry::GeometryType::OccupancyGrid:
+            renderer_ptr = std::make_shared<glsl::OccupancyGridRenderer>();
+            break;
+        case geometry::Geometry::GeometryType::LineSet:
+            renderer_ptr = std::make_shared<glsl::LineSetRenderer>();
+            break;
+        case geometry::Geometry::GeometryType::Graph:
+            renderer_ptr = std::make_shared<glsl::GraphRenderer>();
+            break;
+        case geometry::Geometry::GeometryType::TriangleMesh:
+            renderer_ptr = std::make_shared<glsl::TriangleMeshRenderer>();
+            break;
+        case geometry::Geometry::GeometryType::Image:
+            renderer_ptr = std::make_shared<glsl::ImageRenderer>();
+            break;
+        default:
+            return false;
+    }
+    if (renderer_ptr->AddGeometry(geometry_ptr) == false) {
+        return false;
+    }
+    geometry_renderers_.push_back(renderer_ptr);
+    if (reset_bounding_box) {
+        view_control_.FitInGeometry(*geometry_ptr);
+        ResetViewPoint();
+    }
+    return UpdateGeometry(geometry_ptr);
+}
+
+bool OffscreenRenderer::RemoveGeometry(
+        std::shared_ptr<const geometry::Geometry> geometry_ptr,
+        bool reset_bounding_box) {
+    if (MakeCurrent() == false) {
+        return false;
+    }
+    auto it = std::find_if(geometry_renderers_.begin(),
+                           geometry_renderers_.end(),
+                           [&](const std::shared_ptr<glsl::GeometryRenderer> &r) {
+                               return r->GetGeometry() == geometry_ptr;
+                           });
+    if (it == geometry_renderers_.end()) return false;
+    geometry_renderers_.erase(it);
+    if (reset_bounding_box) ResetViewPoint(true);
+    return true;
+}
+
+bool OffscreenRenderer::ClearGeometries() {
+    if (MakeCurrent() == false) {
+        return false;
+    }
+    geometry_renderers_.clear();
+    return true;
+}
+
+bool OffscreenRenderer::UpdateGeometry(
+        std::shared_ptr<const geometry::Geometry> geometry_ptr) {
+    if (MakeCurrent() == false) {
+        return false;
+    }
+    bool success = true;
+    for (const auto &renderer_ptr : geometry_renderers_) {
+        if (geometry_ptr == nullptr ||
+            renderer_ptr->HasGeometry(geometry_ptr)) {
+            success = (success && renderer_ptr->UpdateGeometry());
+        }
+    }
+    return success;
+}
+
+void OffscreenRenderer::ResetViewPoint(bool reset_bounding_box /* = false*/) {
+    if (reset_bounding_box) {
+        view_control_.ResetBoundingBox();
+        for (const auto &renderer_ptr : geometry_renderers_) {
+            view_control_.FitInGeometry(*renderer_ptr->GetGeometry());
+        }
+    }
+    view_control_.Reset();
+}
+
+void OffscreenRenderer::Render() {
+    if (MakeCurrent() == false) {
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    view_control_.SetViewMatrices();
+
+    glDisable(GL_BLEND);
+    auto &background_color = render_option_.background_color_;
+    glClearColor((GLclampf)background_color(0), (GLclampf)background_color(1),
+                 (GLclampf)background_color(2), 1.0f);
+    glClearDepth(1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    for (const auto &renderer_ptr : geometry_renderers_) {
+        renderer_ptr->Render(render_option_, view_control_);
+    }
+}
+
+const float *OffscreenRenderer::MapPixels(int index, GLenum format) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffers_[index]);
+    glReadPixels(0, 0, width_, height_, format, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    // Mapping waits for the commands of the context reading the buffer.
+    cudaSafeCall(cudaGraphicsMapResources(1, &pixel_resources_[index]));
+    float *pixels;
+    size_t size;
+    cudaSafeCall(cudaGraphicsResourceGetMappedPointer(
+            (void **)&pixels, &size, pixel_resources_[index]));
+    return pixels;
+}
+
+void OffscreenRenderer::UnmapPixels(int index) {
+    cudaSafeCall(cudaGraphicsUnmapResources(1, &pixel_resources_[index]));
+}
+
+std::shared_ptr<geometry::Image> OffscreenRenderer::CaptureScreenFloatBuffer(
+        bool do_render /* = true*/) {
+    auto image_ptr = std::make_shared<geometry::Image>();
+    if (MakeCurrent() == false) {
+        return image_ptr;
+    }
+    if (do_render) Render();
+    image_ptr->Prepare(width_, height_, 3, 4);
+    const float *pixels = MapPixels(0, GL_RGB);
+    flip_color_functor func(
+            pixels, (float *)thrust::raw_pointer_cast(image_ptr->data_.data()),
+            width_, height_);
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(
+                             size_t(width_) * height_ * 3),
+                     func);
+    UnmapPixels(0);
+    return image_ptr;
+}
+
+std::shared_ptr<geometry::Image> OffscreenRenderer::CaptureDepthFloatBuffer(
+        bool do_render /* = true*/) {
+    auto image_ptr = std::make_shared<geometry::Image>();
+    if (MakeCurrent() == false) {
+        return image_ptr;
+    }
+    if (do_render) Render();
+    image_ptr->Prepare(width_, height_, 1, 4);
+    const float *pixels = MapPixels(1, GL_DEPTH_COMPONENT);
+    convert_depth_functor func(
+            pixels, (float *)thrust::raw_pointer_cast(image_ptr->data_.data()),
+            width_, height_, view_control_.GetZNear(), view_control_.GetZFar());
+    thrust::for_each(thrust::make_counting_iterator<size_t>(0),
+                     thrust::make_counting_iterator<size_t>(size_t(width_) *
+                                                            height_),
+                     func);
+    UnmapPixels(1);
+    return image_ptr;
+}
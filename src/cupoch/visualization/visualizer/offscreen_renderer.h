@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <memory>
+#include <vector>
+
+#include "cupoch/visualization/shader/geometry_renderer.h"
+#include "cupoch/visualization/visualizer/render_option.h"
+#include "cupoch/visualization/visualizer/view_control.h"
+
+struct cudaGraphicsResource;
+
+namespace cupoch {
+
+namespace geometry {
+class Image;
+}  // namespace geometry
+
+namespace visualization {
+
+/// \class OffscreenRenderer
+///
+/// \brief Renders geometries without a display, in an EGL context on the GPU
+/// of a CUDA device.
+///
+/// The frames are drawn to a framebuffer object, and the captures read it to
+/// pixel buffers that are mapped to CUDA, so the images stay on the device.
+/// Only available when built with USE_EGL, CreateContext() fails otherwise.
+class OffscreenRenderer {
+public:
+    OffscreenRenderer();
+    ~OffscreenRenderer();
+    OffscreenRenderer(const OffscreenRenderer &) = delete;
+    OffscreenRenderer &operator=(const OffscreenRenderer &) = delete;
+
+public:
+    /// Creates the context on the EGL device of the CUDA device \p device,
+    /// the current one when negative, with frames of \p width x \p height.
+    bool CreateContext(int width = 640, int height = 480, int device = -1);
+    void DestroyContext();
+    /// Makes the context current on the calling thread.
+    bool MakeCurrent();
+
+    bool AddGeometry(std::shared_ptr<const geometry::Geometry> geometry_ptr,
+                     bool reset_bounding_box = true);
+    bool RemoveGeometry(std::shared_ptr<const geometry::Geometry> geometry_ptr,
+                        bool reset_bounding_box = true);
+    bool ClearGeometries();
+    /// Must be called when a geometry has changed, all of them when
+    /// \p geometry_ptr is null.
+    bool UpdateGeometry(
+            std::shared_ptr<const geometry::Geometry> geometry_ptr = nullptr);
+    void ResetViewPoint(bool reset_bounding_box = false);
+
+    ViewControl &GetViewControl() { return view_control_; }
+    RenderOption &GetRenderOption() { return render_option_; }
+
+    void Render();
+    /// Colors of the frame on the device, 3 channels of floats in [0, 1].
+    std::shared_ptr<geometry::Image> CaptureScreenFloatBuffer(
+            bool do_render = true);
+    /// Depths of the frame on the device, 0 where nothing is drawn.
+    std::shared_ptr<geometry::Image> CaptureDepthFloatBuffer(
+            bool do_render = true);
+
+private:
+    /// Reads the framebuffer to the pixel buffer \p index and maps it.
+    const float *MapPixels(int index, GLenum format);
+    void UnmapPixels(int index);
+
+private:
+    void *display_ = nullptr;
+    void *surface_ = nullptr;
+    void *context_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    GLuint vao_id_ = 0;
+    GLuint framebuffer_ = 0;
+    GLuint color_buffer_ = 0;
+    GLuint depth_buffer_ = 0;
+    GLuint pixel_buffers_[2] = {0, 0};
+    cudaGraphicsResource *pixel_resources_[2] = {nullptr, nullptr};
+
+    ViewControl view_control_;
+    RenderOption render_option_;
+    std::vector<std::shared_ptr<glsl::GeometryRenderer>> geometry_renderers_;
+};
+
+}  // namespace visualization
+}  // namespace cupoch
@@ -72,6 +72,8 @@ bool RenderOption::ConvertToJsonValue(Json::Value &value) const {
     value["point_size"] = point_size_;
     value["point_color_option"] = (int)point_color_option_;
     value["point_show_normal"] = point_show_normal_;
+    value["point_lod"] = point_lod_;
+    value["point_lod_pixel_error"] = point_lod_pixel_error_;
 
     value["mesh_shade_option"] = (int)mesh_shade_option_;
     value["mesh_color_option"] = (int)mesh_color_option_;
@@ -195,6 +197,10 @@ bool RenderOption::ConvertFromJsonValue(const Json::Value &value) {
                     .asInt();
     point_show_normal_ =
             value.get("point_show_normal", point_show_normal_).asBool();
+    point_lod_ = value.get("point_lod", point_lod_).asBool();
+    point_lod_pixel_error_ =
+            value.get("point_lod_pixel_error", point_lod_pixel_error_)
+                    .asFloat();
 
     mesh_shade_option_ =
             (MeshShadeOption)value
@@ -167,6 +167,10 @@ public:
     float point_size_ = POINT_SIZE_DEFAULT;
     PointColorOption point_color_option_ = PointColorOption::Default;
     bool point_show_normal_ = false;
+    /// Draws the point clouds at a level of detail chosen per frame, each
+    /// point standing for the points within point_lod_pixel_error_ pixels.
+    bool point_lod_ = false;
+    float point_lod_pixel_error_ = 2.0f;
 
     // TriangleMesh options
     MeshShadeOption mesh_shade_option_ = MeshShadeOption::FlatShade;
@@ -0,0 +1,208 @@
+#include "cupoch/visualization/visualizer/threaded_visualizer.h"
+
+#include <cuda_runtime.h>
+
+#include <vector>
+
+#include "cupoch/geometry/graph.h"
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/lineset.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/utility/console.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/visualization/visualizer/visualizer.h"
+
+using namespace cupoch;
+using namespace cupoch::visualization;
+
+namespace {
+
+// The clouds and the meshes, streamed the most, are assigned to keep the
+// allocations of the snapshot, the other geometries are copied.
+template <class T>
+std::shared_ptr<geometry::Geometry> AssignSnapshot(
+        const geometry::Geometry &src,
+        std::shared_ptr<geometry::Geometry> dst) {
+    if (!dst) return std::make_shared<T>((const T &)src);
+    *std::static_pointer_cast<T>(dst) = (const T &)src;
+    return dst;
+}
+
+template <class T>
+std::shared_ptr<geometry::Geometry> CopySnapshot(
+        const geometry::Geometry &src) {
+    return std::make_shared<T>((const T &)src);
+}
+
+std::shared_ptr<geometry::Geometry> WriteSnapshot(
+        const geometry::Geometry &src,
+        std::shared_ptr<geometry::Geometry> dst) {
+    if (dst && dst->GetGeometryType() != src.GetGeometryType()) dst.reset();
+    switch (src.GetGeometryType()) {
+        case geometry::Geometry::GeometryType::PointCloud:
+            return AssignSnapshot<geometry::PointCloud>(src, dst);
+        case geometry::Geometry::GeometryType::TriangleMesh:
+            return AssignSnapshot<geometry::TriangleMesh>(src, dst);
+        case geometry::Geometry::GeometryType::LineSet:
+            return CopySnapshot<geometry::LineSet>(src);
+        case geometry::Geometry::GeometryType::Graph:
+            return CopySnapshot<geometry::Graph>(src);
+        case geometry::Geometry::GeometryType::VoxelGrid:
+            return CopySnapshot<geometry::VoxelGrid>(src);
+        case geometry::Geometry::GeometryType::OccupancyGrid:
+            return CopySnapshot<geometry::OccupancyGrid>(src);
+        case geometry::Geometry::GeometryType::Image:
+            return CopySnapshot<geometry::Image>(src);
+        default:
+            return nullptr;
+    }
+}
+
+}  // namespace
+
+ThreadedVisualizer::ThreadedVisualizer() : running_(false), stop_(false) {}
+
+ThreadedVisualizer::~ThreadedVisualizer() { Stop(); }
+
+bool ThreadedVisualizer::Start(const std::string &window_name /* = "Cupoch"*/,
+                               int width /* = 640*/,
+                               int height /* = 480*/,
+                               int left /* = 50*/,
+                               int top /* = 50*/) {
+    if (thread_.joinable()) {
+        utility::LogWarning("[ThreadedVisualizer] Already started.");
+        return running_;
+    }
+    stop_ = false;
+    start_finished_ = false;
+    thread_ = std::thread(&ThreadedVisualizer::RenderLoop, this, window_name,
+                          width, height, left, top);
+    std::unique_lock<std::mutex> lock(mutex_);
+    started_.wait(lock, [this] { return start_finished_; });
+    return running_;
+}
+
+void ThreadedVisualizer::Stop() {
+    stop_ = true;
+    if (thread_.joinable()) thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_.clear();
+}
+
+bool ThreadedVisualizer::PostGeometry(const std::string &name,
+                                      const geometry::Geometry &geometry,
+                                      bool reset_bounding_box /* = true*/) {
+    if (running_ == false) {
+        return false;
+    }
+    Snapshot *snapshot;
+    std::shared_ptr<geometry::Geometry> back;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot = &snapshots_[name];
+        if (snapshot->writing_) {
+            utility::LogWarning(
+                    "[ThreadedVisualizer] {} is already being posted.", name);
+            return false;
+        }
+        snapshot->writing_ = true;
+        snapshot->removed_ = false;
+        back = snapshot->back_;
+    }
+    // The back snapshot isn't read by the render thread until it is posted.
+    back = WriteSnapshot(geometry, back);
+    if (back) cudaSafeCall(cudaStreamSynchronize(cudaStreamPerThread));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot->writing_ = false;
+    if (!back) {
+        utility::LogWarning("[ThreadedVisualizer] Unsupported geometry type.");
+        return false;
+    }
+    snapshot->back_ = back;
+    snapshot->posted_ = true;
+    snapshot->reset_bounding_box_ = reset_bounding_box;
+    return true;
+}
+
+bool ThreadedVisualizer::RemoveGeometry(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(name);
+    if (it == snapshots_.end()) return false;
+    it->second.removed_ = true;
+    it->second.posted_ = false;
+    return true;
+}
+
+void ThreadedVisualizer::RenderLoop(std::string window_name,
+                                    int width,
+                                    int height,
+                                    int left,
+                                    int top) {
+    Visualizer visualizer;
+    const bool success = visualizer.CreateVisualizerWindow(window_name, width,
+                                                           height, left, top);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = success;
+        start_finished_ = true;
+    }
+    started_.notify_all();
+    if (success == false) return;
+
+    visualizer.BuildUtilities();
+    visualizer.UpdateWindowTitle();
+    while (stop_ == false && visualizer.PollEvents()) {
+        SwapSnapshots(visualizer);
+        visualizer.RenderImGui();
+    }
+    running_ = false;
+    visualizer.DestroyVisualizerWindow();
+}
+
+void ThreadedVisualizer::SwapSnapshots(Visualizer &visualizer) {
+    std::vector<std::pair<Snapshot *, bool>> swapped;
+    std::vector<std::shared_ptr<geometry::Geometry>> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = snapshots_.begin(); it != snapshots_.end();) {
+            Snapshot &snapshot = it->second;
+            if (snapshot.writing_) {
+                ++it;
+                continue;
+            }
+            if (snapshot.removed_) {
+                if (snapshot.shown_) removed.push_back(snapshot.shown_);
+                it = snapshots_.erase(it);
+                continue;
+            }
+            if (snapshot.posted_) {
+                std::swap(snapshot.front_, snapshot.back_);
+                snapshot.posted_ = false;
+                swapped.emplace_back(&snapshot, snapshot.reset_bounding_box_);
+            }
+            ++it;
+        }
+    }
+    // The elements of the map are only erased above, by this thread, so the
+    // snapshots stay valid. Their shown_ is only used by this thread and
+    // their front_ is only written when swapped by it.
+    for (const auto &geometry_ptr : removed) {
+        visualizer.RemoveGeometry(geometry_ptr, false);
+    }
+    for (const auto &swap : swapped) {
+        Snapshot *snapshot = swap.first;
+        if (snapshot->shown_ == nullptr ||
+            !visualizer.ReplaceGeometry(snapshot->shown_, snapshot->front_)) {
+            // First post, or a geometry of another type.
+            if (snapshot->shown_) {
+                visualizer.RemoveGeometry(snapshot->shown_, false);
+            }
+            visualizer.AddGeometry(snapshot->front_, swap.second);
+        }
+        snapshot->shown_ = snapshot->front_;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace cupoch {
+
+namespace geometry {
+class Geometry;
+}  // namespace geometry
+
+namespace visualization {
+
+class Visualizer;
+
+/// \class ThreadedVisualizer
+///
+/// \brief Visualizer running its window and render loop on a thread of its
+/// own, decoupled from the thread producing the geometries.
+///
+/// Every geometry is double buffered on the device: PostGeometry() copies it
+/// to the back snapshot, on the per-thread stream of the caller, and the
+/// render thread swaps it to the front at its next frame. The front snapshot
+/// is only read by the render thread, so posting never waits for a frame and
+/// slow frames never block the producer; the snapshots posted between two
+/// frames replace each other.
+///
+/// GLFW requires the windows to be created on the main thread on macOS, the
+/// threaded mode is meant for Linux and Windows.
+class ThreadedVisualizer {
+public:
+    ThreadedVisualizer();
+    ~ThreadedVisualizer();
+    ThreadedVisualizer(const ThreadedVisualizer &) = delete;
+    ThreadedVisualizer &operator=(const ThreadedVisualizer &) = delete;
+
+public:
+    /// Starts the render thread and waits for its window to be created.
+    bool Start(const std::string &window_name = "Cupoch",
+               int width = 640,
+               int height = 480,
+               int left = 50,
+               int top = 50);
+    /// Closes the window and joins the render thread. Must not be called
+    /// while a geometry is being posted.
+    void Stop();
+    /// False once the window is closed.
+    bool IsRunning() const { return running_; }
+
+    /// Posts a snapshot of \p geometry shown as \p name, which is added to the
+    /// scene at its first post.
+    bool PostGeometry(const std::string &name,
+                      const geometry::Geometry &geometry,
+                      bool reset_bounding_box = true);
+    /// Removes the geometry \p name at the next frame.
+    bool RemoveGeometry(const std::string &name);
+
+private:
+    struct Snapshot {
+        std::shared_ptr<geometry::Geometry> front_;
+        std::shared_ptr<geometry::Geometry> back_;
+        /// The geometry drawn by the visualizer, front_ once swapped.
+        std::shared_ptr<geometry::Geometry> shown_;
+        bool posted_ = false;
+        bool writing_ = false;
+        bool removed_ = false;
+        bool reset_bounding_box_ = false;
+    };
+
+    void RenderLoop(std::string window_name,
+                    int width,
+                    int height,
+                    int left,
+                    int top);
+    /// Swaps the posted snapshots to the front, on the render thread.
+    void SwapSnapshots(Visualizer &visualizer);
+
+private:
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_;
+    std::mutex mutex_;
+    std::condition_variable started_;
+    bool start_finished_ = false;
+    std::unordered_map<std::string, Snapshot> snapshots_;
+};
+
+}  // namespace visualization
+}  // namespace cupoch
@@ -395,6 +395,30 @@ bool Visualizer::ClearGeometries() {
     return UpdateGeometry();
 }
 
+bool Visualizer::ReplaceGeometry(
+        std::shared_ptr<const geometry::Geometry> geometry_ptr,
+        std::shared_ptr<const geometry::Geometry> new_geometry_ptr) {
+    if (is_initialized_ == false) {
+        return false;
+    }
+    auto it = geometry_ptrs_.find(geometry_ptr);
+    if (it == geometry_ptrs_.end()) return false;
+    glfwMakeContextCurrent(window_);
+    for (const auto &renderer_ptr : geometry_renderer_ptrs_) {
+        if (renderer_ptr->HasGeometry(geometry_ptr)) {
+            if (renderer_ptr->AddGeometry(new_geometry_ptr) == false) {
+                return false;
+            }
+            break;
+        }
+    }
+    const bool visible = it->second;
+    geometry_ptrs_.erase(it);
+    geometry_ptrs_[new_geometry_ptr] = visible;
+    UpdateRender();
+    return true;
+}
+
 bool Visualizer::UpdateGeometry(
         std::shared_ptr<const geometry::Geometry> geometry_ptr) {
     glfwMakeContextCurrent(window_);
@@ -409,6 +433,20 @@ bool Visualizer::UpdateGeometry(
     return success;
 }
 
+bool Visualizer::UpdateGeometryPart(
+        std::shared_ptr<const geometry::Geometry> geometry_ptr,
+        const glsl::GeometryUpdate &update) {
+    glfwMakeContextCurrent(window_);
+    bool success = true;
+    for (const auto &renderer_ptr : geometry_renderer_ptrs_) {
+        if (renderer_ptr->HasGeometry(geometry_ptr)) {
+            success = (success && renderer_ptr->UpdateGeometry(update));
+        }
+    }
+    UpdateRender();
+    return success;
+}
+
 void Visualizer::UpdateRender() {is_redraw_required_ = true;}
 
 bool Visualizer::HasGeometry() const {return !geometry_ptrs_.empty();}
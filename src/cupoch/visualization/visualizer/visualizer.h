@@ -107,6 +107,12 @@ public:
     /// all geometry objects.
     virtual bool ClearGeometries();
 
+    /// Function to draw \p new_geometry_ptr in place of \p geometry_ptr, of
+    /// the same type, keeping its renderer, buffers and visibility.
+    virtual bool ReplaceGeometry(
+            std::shared_ptr<const geometry::Geometry> geometry_ptr,
+            std::shared_ptr<const geometry::Geometry> new_geometry_ptr);
+
     /// Function to update geometry
     /// This function must be called when geometry has been changed. Otherwise
     /// the behavior of Visualizer is undefined.
@@ -114,6 +120,12 @@ public:
     /// updates the geometry specified.
     virtual bool UpdateGeometry(
             std::shared_ptr<const geometry::Geometry> geometry_ptr = nullptr);
+    /// Function to update the part \p update of a geometry, e.g. the points
+    /// appended to a point cloud or the colors recomputed for it. The
+    /// renderers only rewrite this part of their buffers when they can.
+    virtual bool UpdateGeometryPart(
+            std::shared_ptr<const geometry::Geometry> geometry_ptr,
+            const glsl::GeometryUpdate &update);
     virtual bool HasGeometry() const;
 
     /// Function to set the redraw flag as dirty
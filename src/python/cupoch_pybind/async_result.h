@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <string>
+
+#include "cupoch_pybind/cupoch_pybind.h"
+
+namespace cupoch {
+namespace wrapper {
+
+/// Result of a call running on a worker thread without the GIL. The worker
+/// enqueues its kernels on the per-thread default stream of its own thread
+/// and only waits for that stream, so the calls of several futures overlap
+/// on the device.
+template <typename T>
+class AsyncResult {
+public:
+    explicit AsyncResult(std::future<T> &&future)
+        : future_(future.share()) {}
+    /// Waits for the call, so that the arguments kept alive by the future
+    /// outlive it.
+    ~AsyncResult() {
+        if (future_.valid()) {
+            py::gil_scoped_release release;
+            future_.wait();
+        }
+    }
+    AsyncResult(const AsyncResult &) = delete;
+    AsyncResult &operator=(const AsyncResult &) = delete;
+
+public:
+    bool Done() const {
+        return future_.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+    }
+    /// Waits for the call and returns its result, rethrowing its exception.
+    T Get() const { return future_.get(); }
+
+private:
+    std::shared_future<T> future_;
+};
+
+/// Runs \p func on a new thread. The binding must keep the arguments used by
+/// \p func alive with py::keep_alive<0, i>().
+template <typename Func>
+auto RunAsync(Func func) {
+    using T = decltype(func());
+    return new AsyncResult<T>(std::async(std::launch::async, std::move(func)));
+}
+
+template <typename T>
+void pybind_async_result(py::module &m, const std::string &name) {
+    py::class_<AsyncResult<T>>(
+            m, name.c_str(),
+            "Future of a call running on a worker thread without the GIL.")
+            .def("done", &AsyncResult<T>::Done,
+                 "Returns ``True`` if the call is complete.")
+            .def("result", &AsyncResult<T>::Get,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Wait for the call and return its result.");
+}
+
+}  // namespace wrapper
+}  // namespace cupoch
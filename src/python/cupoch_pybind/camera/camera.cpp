@@ -45,6 +45,23 @@ void pybind_camera_classes(py::module &m) {
             .def("is_valid", &camera::PinholeCameraIntrinsic::IsValid,
                  "Returns True iff both the width and height are greater than "
                  "0.")
+            .def("set_distortion",
+                 &camera::PinholeCameraIntrinsic::SetDistortion, "model"_a,
+                 "coeffs"_a, "Set the lens distortion.")
+            .def("has_distortion",
+                 &camera::PinholeCameraIntrinsic::HasDistortion,
+                 "Returns True if the images must be undistorted.")
+            .def("distort_pixel",
+                 &camera::PinholeCameraIntrinsic::DistortPixel, "uv"_a,
+                 "Returns the distorted pixel of a pixel of the ideal "
+                 "pinhole camera.")
+            .def_readwrite("distortion_model",
+                           &camera::PinholeCameraIntrinsic::distortion_model_,
+                           "DistortionModel: Lens distortion model.")
+            .def_readwrite("distortion_coeffs",
+                           &camera::PinholeCameraIntrinsic::distortion_coeffs_,
+                           "5 numpy array: Distortion coefficients, "
+                           "``(k1, k2, p1, p2, k3)`` or ``(k1, k2, k3, k4)``.")
             .def_readwrite("width", &camera::PinholeCameraIntrinsic::width_,
                            "int: Width of the image.")
             .def_readwrite("height", &camera::PinholeCameraIntrinsic::height_,
@@ -105,6 +122,14 @@ void pybind_camera_classes(py::module &m) {
             }),
             py::none(), py::none(), "");
 
+    // cupoch.camera.DistortionModel
+    py::enum_<camera::DistortionModel>(m, "DistortionModel",
+                                       "Lens distortion models.")
+            .value("NoDistortion", camera::DistortionModel::None)
+            .value("BrownConrady", camera::DistortionModel::BrownConrady)
+            .value("Fisheye", camera::DistortionModel::Fisheye)
+            .export_values();
+
     // cupoch.camera.PinholeCameraParameters
     py::class_<camera::PinholeCameraParameters> pinhole_param(
             m, "PinholeCameraParameters",
@@ -3,8 +3,11 @@
 
 #include "cupoch/collision/collision.h"
 #include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/lineset.h"
 #include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/trianglemesh.h"
 
 using namespace cupoch;
 
@@ -18,11 +21,38 @@ void pybind_collision_methods(py::module &m) {
            .def_property("collision_index_pairs", [] (collision::CollisionResult &res) {return wrapper::device_vector_vector2i(res.collision_index_pairs_);},
                          [] (collision::CollisionResult &res, const wrapper::device_vector_vector2i& vec) {wrapper::FromWrapper(res.collision_index_pairs_, vec);});
 
+    py::class_<collision::DistanceResult, std::shared_ptr<collision::DistanceResult>>
+            dist_res(m, "DistanceResult",
+                     "Distance result class.");
+    py::detail::bind_default_constructor<collision::DistanceResult>(dist_res);
+    py::detail::bind_copy_functions<collision::DistanceResult>(dist_res);
+    dist_res.def("is_empty", &collision::DistanceResult::IsEmpty)
+            .def_property_readonly("index_pairs", [] (collision::DistanceResult &res) {return wrapper::device_vector_vector2i(res.index_pairs_);})
+            .def_property_readonly("distances", [] (collision::DistanceResult &res) {return wrapper::device_vector_float(res.distances_);})
+            .def_property_readonly("first_points", [] (collision::DistanceResult &res) {return wrapper::device_vector_vector3f(res.first_points_);})
+            .def_property_readonly("second_points", [] (collision::DistanceResult &res) {return wrapper::device_vector_vector3f(res.second_points_);});
+
     m.def("compute_intersection", py::overload_cast<const geometry::VoxelGrid&, const geometry::VoxelGrid&, float>(&collision::ComputeIntersection));
     m.def("compute_intersection", py::overload_cast<const geometry::VoxelGrid&, const geometry::LineSet&, float>(&collision::ComputeIntersection));
     m.def("compute_intersection", py::overload_cast<const geometry::LineSet&, const geometry::VoxelGrid&, float>(&collision::ComputeIntersection));
     m.def("compute_intersection", py::overload_cast<const geometry::VoxelGrid&, const geometry::OccupancyGrid&, float>(&collision::ComputeIntersection));
     m.def("compute_intersection", py::overload_cast<const geometry::OccupancyGrid&, const geometry::VoxelGrid&, float>(&collision::ComputeIntersection));
+    m.def("compute_intersection", py::overload_cast<const geometry::VoxelGrid&, const geometry::TriangleMesh&, float>(&collision::ComputeIntersection));
+    m.def("compute_intersection", py::overload_cast<const geometry::TriangleMesh&, const geometry::VoxelGrid&, float>(&collision::ComputeIntersection));
+    m.def("compute_intersection", py::overload_cast<const collision::Primitive&, const geometry::PointCloud&, float>(&collision::ComputeIntersection),
+          "primitive"_a, "pointcloud"_a, "margin"_a = 0.0f);
+    m.def("compute_intersection", py::overload_cast<const collision::Primitive&, const geometry::OccupancyGrid&, float>(&collision::ComputeIntersection),
+          "primitive"_a, "occgrid"_a, "margin"_a = 0.0f);
+    m.def("compute_intersection", py::overload_cast<const collision::Primitive&, const geometry::DistanceTransform&, float>(&collision::ComputeIntersection),
+          "primitive"_a, "distance_transform"_a, "margin"_a = 0.0f);
+    m.def("compute_distance", py::overload_cast<const collision::Primitive&, const geometry::PointCloud&, float>(&collision::ComputeDistance),
+          "primitive"_a, "pointcloud"_a, "max_distance"_a = std::numeric_limits<float>::infinity());
+    m.def("compute_distance", py::overload_cast<const collision::Primitive&, const geometry::VoxelGrid&, float>(&collision::ComputeDistance),
+          "primitive"_a, "voxelgrid"_a, "max_distance"_a = std::numeric_limits<float>::infinity());
+    m.def("compute_distance", py::overload_cast<const collision::Primitive&, const geometry::TriangleMesh&, float>(&collision::ComputeDistance),
+          "primitive"_a, "mesh"_a, "max_distance"_a = std::numeric_limits<float>::infinity());
+    m.def("compute_distance", py::overload_cast<const collision::Primitive&, const geometry::DistanceTransform&, float>(&collision::ComputeDistance),
+          "primitive"_a, "distance_transform"_a, "max_distance"_a = std::numeric_limits<float>::infinity());
 }
 
 void pybind_collision(py::module &m) {
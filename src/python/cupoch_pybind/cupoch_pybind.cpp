@@ -6,6 +6,7 @@
 #include "cupoch_pybind/integration/integration.h"
 #include "cupoch_pybind/collision/collision.h"
 #include "cupoch_pybind/io/io.h"
+#include "cupoch_pybind/localization/localization.h"
 #include "cupoch_pybind/odometry/odometry.h"
 #include "cupoch_pybind/registration/registration.h"
 #include "cupoch_pybind/utility/utility.h"
@@ -42,5 +43,6 @@ PYBIND11_MODULE(cupoch, m) {
     pybind_io(m);
     pybind_registration(m);
     pybind_odometry(m);
+    pybind_localization(m);
     pybind_visualization(m);
 }
\ No newline at end of file
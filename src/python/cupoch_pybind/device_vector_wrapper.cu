@@ -1,5 +1,9 @@
 #include "cupoch_pybind/device_vector_wrapper.h"
 
+#include <cstring>
+
+#include "cupoch/utility/platform.h"
+
 namespace cupoch {
 namespace wrapper {
 
@@ -56,12 +60,56 @@ bool device_vector_wrapper<Type>::empty() const {
     return data_.empty();
 }
 
+namespace {
+
+/// Pinned staging buffer of the downloads of cpu(), one per host thread. It
+/// grows to the largest download and is reused by the later calls.
+utility::pinned_host_vector<char> &GetStagingBuffer(size_t size) {
+    thread_local utility::pinned_host_vector<char> staging;
+    if (staging.size() < size) {
+        staging.clear();
+        staging.shrink_to_fit();
+        staging.resize(size);
+    }
+    return staging;
+}
+
+}  // namespace
+
 template <typename Type>
 thrust::host_vector<Type> device_vector_wrapper<Type>::cpu() const {
-    thrust::host_vector<Type> ans = data_;
+    thrust::host_vector<Type> ans(data_.size());
+    if (data_.empty()) return ans;
+    const size_t size = data_.size() * sizeof(Type);
+    utility::pinned_host_vector<char> &staging = GetStagingBuffer(size);
+    cudaSafeCall(cudaMemcpyAsync(thrust::raw_pointer_cast(staging.data()),
+                                 thrust::raw_pointer_cast(data_.data()), size,
+                                 cudaMemcpyDeviceToHost, 0));
+    cudaSafeCall(cudaStreamSynchronize(0));
+    memcpy(thrust::raw_pointer_cast(ans.data()),
+           thrust::raw_pointer_cast(staging.data()), size);
     return ans;
 }
 
+template <typename Type>
+void device_vector_wrapper<Type>::CopyFromDevice(const Type* data,
+                                                 size_t size,
+                                                 cudaStream_t stream) {
+    data_.resize(size);
+    if (size == 0) return;
+    cudaEvent_t event;
+    cudaSafeCall(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    cudaSafeCall(cudaEventRecord(event, stream));
+    cudaSafeCall(cudaStreamWaitEvent(0, event, 0));
+    cudaSafeCall(cudaMemcpyAsync(thrust::raw_pointer_cast(data_.data()), data,
+                                 size * sizeof(Type), cudaMemcpyDeviceToDevice,
+                                 0));
+    // The producer must not reuse the memory before the copy is done.
+    cudaSafeCall(cudaEventRecord(event, 0));
+    cudaSafeCall(cudaStreamWaitEvent(stream, event, 0));
+    cudaSafeCall(cudaEventDestroy(event));
+}
+
 template class device_vector_wrapper<Eigen::Vector3f>;
 template class device_vector_wrapper<Eigen::Vector2f>;
 template class device_vector_wrapper<Eigen::Vector3i>;
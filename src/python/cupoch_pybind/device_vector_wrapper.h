@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cuda_runtime.h>
 #include <thrust/host_vector.h>
 
 #include <Eigen/Core>
@@ -29,6 +30,11 @@ public:
     size_t size() const;
     bool empty() const;
     thrust::host_vector<Type> cpu() const;
+    /// Copies \p size elements of the device memory \p data, which is
+    /// written by the work queued on \p stream. The copy waits for that work
+    /// and the later work on \p stream waits for the copy, without blocking
+    /// the host.
+    void CopyFromDevice(const Type* data, size_t size, cudaStream_t stream);
     utility::device_vector<Type> data_;
 };
 
@@ -7,9 +7,11 @@
 using namespace cupoch;
 using namespace cupoch::dlpack;
 
+template <typename T, int Dim>
 py::capsule cupoch::dlpack::ToDLpackCapsule(
-        utility::device_vector<Eigen::Vector3f> &src) {
-    void const *managed_tensor = utility::ToDLPack(src);
+        utility::device_vector<Eigen::Matrix<T, Dim, 1>> &src,
+        std::shared_ptr<const void> owner) {
+    void const *managed_tensor = utility::ToDLPack(src, std::move(owner));
 
     return py::capsule(managed_tensor, "dltensor", [](::PyObject *obj) {
         auto *ptr = ::PyCapsule_GetPointer(obj, "dltensor");
@@ -22,10 +24,41 @@ py::capsule cupoch::dlpack::ToDLpackCapsule(
     });
 }
 
+template <typename T, int Dim>
 void cupoch::dlpack::FromDLpackCapsule(
-        py::capsule dlpack, utility::device_vector<Eigen::Vector3f> &dst) {
+        py::capsule dlpack,
+        utility::device_vector<Eigen::Matrix<T, Dim, 1>> &dst) {
     auto obj = py::cast<py::object>(dlpack);
     ::DLManagedTensor *managed_tensor =
             (::DLManagedTensor *)::PyCapsule_GetPointer(obj.ptr(), "dltensor");
-    utility::FromDLPack<float, 3>(managed_tensor, dst);
-}
\ No newline at end of file
+    if (managed_tensor == nullptr) {
+        throw py::error_already_set();
+    }
+    utility::FromDLPack<T, Dim>(managed_tensor, dst);
+    // The consumer of a DLPack capsule releases the tensor and marks the
+    // capsule as used, so that the producer does not release it again.
+    if (managed_tensor->deleter) managed_tensor->deleter(managed_tensor);
+    ::PyCapsule_SetName(obj.ptr(), "used_dltensor");
+}
+
+template py::capsule cupoch::dlpack::ToDLpackCapsule(
+        utility::device_vector<Eigen::Vector2f> &src,
+        std::shared_ptr<const void> owner);
+template py::capsule cupoch::dlpack::ToDLpackCapsule(
+        utility::device_vector<Eigen::Vector3f> &src,
+        std::shared_ptr<const void> owner);
+template py::capsule cupoch::dlpack::ToDLpackCapsule(
+        utility::device_vector<Eigen::Vector2i> &src,
+        std::shared_ptr<const void> owner);
+template py::capsule cupoch::dlpack::ToDLpackCapsule(
+        utility::device_vector<Eigen::Vector3i> &src,
+        std::shared_ptr<const void> owner);
+
+template void cupoch::dlpack::FromDLpackCapsule(
+        py::capsule dlpack, utility::device_vector<Eigen::Vector2f> &dst);
+template void cupoch::dlpack::FromDLpackCapsule(
+        py::capsule dlpack, utility::device_vector<Eigen::Vector3f> &dst);
+template void cupoch::dlpack::FromDLpackCapsule(
+        py::capsule dlpack, utility::device_vector<Eigen::Vector2i> &dst);
+template void cupoch::dlpack::FromDLpackCapsule(
+        py::capsule dlpack, utility::device_vector<Eigen::Vector3i> &dst);
@@ -3,6 +3,7 @@
 #include <pybind11/pybind11.h>
 
 #include <Eigen/Core>
+#include <memory>
 
 #include "cupoch/utility/device_vector.h"
 namespace py = pybind11;
@@ -10,10 +11,17 @@ namespace py = pybind11;
 namespace cupoch {
 namespace dlpack {
 
-py::capsule ToDLpackCapsule(utility::device_vector<Eigen::Vector3f>& src);
+/// The capsule shares the memory of \p src and keeps \p owner, the
+/// geometry holding \p src, alive as long as the tensor is in use.
+template <typename T, int Dim>
+py::capsule ToDLpackCapsule(
+        utility::device_vector<Eigen::Matrix<T, Dim, 1>>& src,
+        std::shared_ptr<const void> owner = nullptr);
 
+/// Copies the tensor into \p dst and consumes the capsule.
+template <typename T, int Dim>
 void FromDLpackCapsule(py::capsule dlpack,
-                       utility::device_vector<Eigen::Vector3f>& dst);
+                       utility::device_vector<Eigen::Matrix<T, Dim, 1>>& dst);
 
 }  // namespace dlpack
-}  // namespace cupoch
\ No newline at end of file
+}  // namespace cupoch
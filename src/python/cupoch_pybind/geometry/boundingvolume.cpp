@@ -1,5 +1,6 @@
 #include "cupoch/geometry/boundingvolume.h"
 
+#include "cupoch_pybind/device_vector_wrapper.h"
 #include "cupoch_pybind/docstring.h"
 #include "cupoch_pybind/geometry/geometry.h"
 #include "cupoch_pybind/geometry/geometry_trampoline.h"
@@ -40,6 +41,18 @@ void pybind_boundingvolume(py::module &m) {
                         "Returns an oriented bounding box from the "
                         "AxisAlignedBoundingBox.",
                         "aabox"_a)
+            .def_static(
+                    "create_from_point_clusters",
+                    [](const wrapper::device_vector_vector3f &points,
+                       const wrapper::device_vector_int &labels) {
+                        return geometry::OrientedBoundingBox::
+                                CreateFromPointClusters(points.data_,
+                                                        labels.data_);
+                    },
+                    "Returns the oriented bounding boxes of the clusters of "
+                    "the points, the box of label l at index l. The points "
+                    "labeled -1 are ignored.",
+                    "points"_a, "labels"_a)
             .def("volume", &geometry::OrientedBoundingBox::Volume,
                  "Returns the volume of the bounding box.")
             .def("get_box_points", &geometry::OrientedBoundingBox::GetBoxPoints,
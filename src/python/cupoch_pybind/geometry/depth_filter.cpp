@@ -0,0 +1,71 @@
+#include "cupoch/geometry/depth_filter.h"
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/geometry/geometry.h"
+
+using namespace cupoch;
+
+void pybind_depth_filter(py::module &m) {
+    py::class_<geometry::DepthFilterOption> option(
+            m, "DepthFilterOption", "Parameters of the DepthFilter stages.");
+    py::enum_<geometry::DepthFilterOption::HoleFillingMode> hole_filling_mode(
+            option, "HoleFillingMode");
+    hole_filling_mode
+            .value("Disabled",
+                   geometry::DepthFilterOption::HoleFillingMode::Disabled)
+            .value("FarthestFromAround",
+                   geometry::DepthFilterOption::HoleFillingMode::
+                           FarthestFromAround)
+            .value("NearestFromAround",
+                   geometry::DepthFilterOption::HoleFillingMode::
+                           NearestFromAround)
+            .export_values();
+    option.def(py::init<float, float, float, int, float, float, int, float,
+                        bool, geometry::DepthFilterOption::HoleFillingMode,
+                        int>(),
+               "min_depth"_a = 0.0, "max_depth"_a = 4.0,
+               "flying_pixel_threshold"_a = 0.05,
+               "spatial_half_kernel_size"_a = 2,
+               "spatial_sigma_space"_a = 2.0, "spatial_sigma_depth"_a = 0.02,
+               "temporal_window"_a = 3, "temporal_delta"_a = 0.02,
+               "temporal_persistence"_a = false,
+               "hole_filling_mode"_a =
+                       geometry::DepthFilterOption::HoleFillingMode::Disabled,
+               "hole_filling_radius"_a = 1)
+            .def_readwrite("min_depth",
+                           &geometry::DepthFilterOption::min_depth_)
+            .def_readwrite("max_depth",
+                           &geometry::DepthFilterOption::max_depth_)
+            .def_readwrite("flying_pixel_threshold",
+                           &geometry::DepthFilterOption::flying_pixel_threshold_)
+            .def_readwrite(
+                    "spatial_half_kernel_size",
+                    &geometry::DepthFilterOption::spatial_half_kernel_size_)
+            .def_readwrite("spatial_sigma_space",
+                           &geometry::DepthFilterOption::spatial_sigma_space_)
+            .def_readwrite("spatial_sigma_depth",
+                           &geometry::DepthFilterOption::spatial_sigma_depth_)
+            .def_readwrite("temporal_window",
+                           &geometry::DepthFilterOption::temporal_window_)
+            .def_readwrite("temporal_delta",
+                           &geometry::DepthFilterOption::temporal_delta_)
+            .def_readwrite("temporal_persistence",
+                           &geometry::DepthFilterOption::temporal_persistence_)
+            .def_readwrite("hole_filling_mode",
+                           &geometry::DepthFilterOption::hole_filling_mode_)
+            .def_readwrite("hole_filling_radius",
+                           &geometry::DepthFilterOption::hole_filling_radius_);
+
+    py::class_<geometry::DepthFilter, std::shared_ptr<geometry::DepthFilter>>
+            filter(m, "DepthFilter",
+                   "Preprocessing of a stream of float depth images.");
+    filter.def(py::init<const geometry::DepthFilterOption &>(),
+               "option"_a = geometry::DepthFilterOption())
+            .def("process", &geometry::DepthFilter::Process,
+                 "Filters a single channel float depth image in place.",
+                 "depth"_a)
+            .def("reset", &geometry::DepthFilter::Reset,
+                 "Forgets the previous frames.")
+            .def("get_history_size", &geometry::DepthFilter::GetHistorySize)
+            .def_property_readonly("option",
+                                   &geometry::DepthFilter::GetOption);
+}
@@ -155,12 +155,17 @@ void pybind_geometry(py::module &m) {
     pybind_geometry_classes(m_submodule);
     pybind_kdtreeflann(m_submodule);
     pybind_pointcloud(m_submodule);
+    pybind_pointcloud_batch(m_submodule);
     pybind_voxelgrid(m_submodule);
     pybind_occupanygrid(m_submodule);
+    pybind_voxel_point_map(m_submodule);
     pybind_lineset(m_submodule);
     pybind_graph(m_submodule);
     pybind_meshbase(m_submodule);
     pybind_trianglemesh(m_submodule);
     pybind_image(m_submodule);
+    pybind_range_image(m_submodule);
     pybind_boundingvolume(m_submodule);
+    pybind_raycasting_scene(m_submodule);
+    pybind_depth_filter(m_submodule);
 }
\ No newline at end of file
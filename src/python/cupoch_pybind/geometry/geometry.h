@@ -5,12 +5,17 @@
 void pybind_geometry(py::module &m);
 
 void pybind_pointcloud(py::module &m);
+void pybind_pointcloud_batch(py::module &m);
 void pybind_voxelgrid(py::module &m);
 void pybind_occupanygrid(py::module &m);
+void pybind_voxel_point_map(py::module &m);
 void pybind_lineset(py::module &m);
 void pybind_graph(py::module &m);
 void pybind_meshbase(py::module &m);
 void pybind_trianglemesh(py::module &m);
 void pybind_image(py::module &m);
+void pybind_range_image(py::module &m);
 void pybind_kdtreeflann(py::module &m);
-void pybind_boundingvolume(py::module &m);
\ No newline at end of file
+void pybind_boundingvolume(py::module &m);
+void pybind_raycasting_scene(py::module &m);
+void pybind_depth_filter(py::module &m);
\ No newline at end of file
@@ -39,6 +39,16 @@ void pybind_graph(py::module &m) {
                   auto res = graph.DijkstraPath(start_node, end_node);
                   return *res;
               })
+         .def("a_star_path", [] (const geometry::Graph &graph, int start_node, int end_node, float delta) {
+                  auto res = graph.AStarPath(start_node, end_node, delta);
+                  return *res;
+              }, "start_node"_a, "end_node"_a, "delta"_a = 0.0)
+         .def("connected_components", [] (const geometry::Graph &graph) {
+                  thrust::host_vector<int> labels = graph.ConnectedComponents();
+                  return labels;
+              }, "Label of the connected component of each node, its smallest node index")
+         .def("minimum_spanning_tree", &geometry::Graph::MinimumSpanningTree,
+              "Minimum spanning forest of the graph")
          .def_static("create_from_triangle_mesh",
                      &geometry::Graph::CreateFromTriangleMesh,
                      "Function to make graph from a TriangleMesh",
@@ -1,5 +1,7 @@
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/geometry/image.h"
 #include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/geometry/undistortion_map.h"
 #include "cupoch_pybind/docstring.h"
 #include "cupoch_pybind/geometry/geometry.h"
 #include "cupoch_pybind/geometry/geometry_trampoline.h"
@@ -109,6 +111,12 @@ void pybind_image(py::module &m) {
                      }
                  },
                  "Function to filter Image", "filter_type"_a)
+            .def("bilateral_filter",
+                 py::overload_cast<int, float, float>(
+                         &geometry::Image::BilateralFilter, py::const_),
+                 "Function to bilateral filter a float depth Image, zero "
+                 "depths being invalid",
+                 "half_kernel_size"_a, "sigma_space"_a, "sigma_depth"_a)
             .def("flip_vertical", &geometry::Image::FlipVertical,
                  "Function to flip image vertically (upside down)")
             .def("flip_horizontal", &geometry::Image::FlipHorizontal,
@@ -183,11 +191,36 @@ void pybind_image(py::module &m) {
                                     "Use numpy.asarray to access buffer data.");
                  })
             .def_static("create_from_color_and_depth",
-                        &geometry::RGBDImage::CreateFromColorAndDepth,
+                        py::overload_cast<const geometry::Image &,
+                                          const geometry::Image &, float,
+                                          float, bool>(
+                                &geometry::RGBDImage::CreateFromColorAndDepth),
                         "Function to make RGBDImage from color and depth image",
                         "color"_a, "depth"_a, "depth_scale"_a = 1000.0,
                         "depth_trunc"_a = 3.0,
                         "convert_rgb_to_intensity"_a = true)
+            .def_static(
+                    "create_from_color_and_unaligned_depth",
+                    py::overload_cast<const geometry::Image &,
+                                      const geometry::Image &,
+                                      const camera::PinholeCameraIntrinsic &,
+                                      const camera::PinholeCameraIntrinsic &,
+                                      const Eigen::Matrix4f &, float, float,
+                                      bool>(
+                            &geometry::RGBDImage::CreateFromColorAndDepth),
+                    "Function to make RGBDImage from color and depth image "
+                    "of different cameras, the depth being registered to "
+                    "the color camera",
+                    "color"_a, "depth"_a, "color_intrinsic"_a,
+                    "depth_intrinsic"_a, "depth_to_color"_a,
+                    "depth_scale"_a = 1000.0, "depth_trunc"_a = 3.0,
+                    "convert_rgb_to_intensity"_a = true)
+            .def_static("register_depth_to_color",
+                        &geometry::RGBDImage::RegisterDepthToColor,
+                        "Reprojects a depth image to the color camera, at "
+                        "its resolution",
+                        "depth"_a, "depth_intrinsic"_a, "color_intrinsic"_a,
+                        "depth_to_color"_a, "depth_scale"_a = 1000.0)
             .def_static("create_from_redwood_format",
                         &geometry::RGBDImage::CreateFromRedwoodFormat,
                         "Function to make RGBDImage (for Redwood format)",
@@ -221,6 +254,29 @@ void pybind_image(py::module &m) {
                                     map_shared_argument_docstrings);
     docstring::ClassMethodDocInject(m, "RGBDImage", "create_from_nyu_format",
                                     map_shared_argument_docstrings);
+
+    py::class_<geometry::UndistortionMap,
+               std::shared_ptr<geometry::UndistortionMap>>
+            undistortion_map(m, "UndistortionMap",
+                             "Lookup table undistorting the frames of a "
+                             "camera on the device.");
+    undistortion_map
+            .def(py::init<const camera::PinholeCameraIntrinsic &>(),
+                 "intrinsic"_a)
+            .def(py::init<const camera::PinholeCameraIntrinsic &,
+                          const camera::PinholeCameraIntrinsic &>(),
+                 "intrinsic"_a, "undistorted"_a)
+            .def(
+                    "remap",
+                    [](const geometry::UndistortionMap &map,
+                       const geometry::Image &image, bool linear_filter) {
+                        return map.Remap(image, linear_filter);
+                    },
+                    "Undistorts an image, bilinearly or at the nearest "
+                    "pixel.",
+                    "image"_a, "linear_filter"_a = true)
+            .def_readonly("width", &geometry::UndistortionMap::width_)
+            .def_readonly("height", &geometry::UndistortionMap::height_);
 }
 
 void pybind_image_methods(py::module &m) {}
\ No newline at end of file
@@ -25,6 +25,13 @@ void pybind_kdtreeflann(py::module &m) {
                    geometry::KDTreeSearchParam::SearchType::Hybrid)
             .export_values();
 
+    // cupoch.geometry.SearchIndexType
+    py::enum_<geometry::SearchIndexType>(m, "SearchIndexType",
+                                         py::arithmetic())
+            .value("KDTreeFlann", geometry::SearchIndexType::KDTreeFlann)
+            .value("VoxelHash", geometry::SearchIndexType::VoxelHash)
+            .export_values();
+
     // cupoch.geometry.KDTreeSearchParamKNN
     py::class_<geometry::KDTreeSearchParamKNN> kdtreesearchparam_knn(
             m, "KDTreeSearchParamKNN", kdtreesearchparam,
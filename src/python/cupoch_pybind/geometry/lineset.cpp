@@ -1,6 +1,7 @@
 #include "cupoch/geometry/lineset.h"
 #include "cupoch/geometry/pointcloud.h"
 
+#include "cupoch_pybind/dl_converter.h"
 #include "cupoch_pybind/docstring.h"
 #include "cupoch_pybind/geometry/geometry.h"
 #include "cupoch_pybind/geometry/geometry_trampoline.h"
@@ -66,7 +67,13 @@ void pybind_lineset(py::module &m) {
             .def_property("lines", [] (geometry::LineSet &line) {return wrapper::device_vector_vector2i(line.lines_);},
                                    [] (geometry::LineSet &line, const wrapper::device_vector_vector2i& vec) {wrapper::FromWrapper(line.lines_, vec);})
             .def_property("colors", [] (geometry::LineSet &line) {return wrapper::device_vector_vector3f(line.colors_);},
-                                    [] (geometry::LineSet &line, const wrapper::device_vector_vector3f& vec) {wrapper::FromWrapper(line.colors_, vec);});
+                                    [] (geometry::LineSet &line, const wrapper::device_vector_vector3f& vec) {wrapper::FromWrapper(line.colors_, vec);})
+            .def("to_points_dlpack", [](std::shared_ptr<geometry::LineSet> line) {return dlpack::ToDLpackCapsule(line->points_, line);})
+            .def("to_lines_dlpack", [](std::shared_ptr<geometry::LineSet> line) {return dlpack::ToDLpackCapsule(line->lines_, line);})
+            .def("to_colors_dlpack", [](std::shared_ptr<geometry::LineSet> line) {return dlpack::ToDLpackCapsule(line->colors_, line);})
+            .def("from_points_dlpack", [](geometry::LineSet &line, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, line.points_);})
+            .def("from_lines_dlpack", [](geometry::LineSet &line, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, line.lines_);})
+            .def("from_colors_dlpack", [](geometry::LineSet &line, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, line.colors_);});
     docstring::ClassMethodDocInject(m, "LineSet", "has_colors");
     docstring::ClassMethodDocInject(m, "LineSet", "has_lines");
     docstring::ClassMethodDocInject(m, "LineSet", "has_points");
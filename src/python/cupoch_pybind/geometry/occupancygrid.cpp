@@ -1,6 +1,9 @@
 #include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/occupancy_octree.h"
 #include "cupoch/camera/pinhole_camera_parameters.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/sparse_occupancygrid.h"
+#include "cupoch/geometry/voxelgrid.h"
 
 #include "cupoch_pybind/docstring.h"
 #include "cupoch_pybind/device_map_wrapper.h"
@@ -50,6 +53,35 @@ void pybind_occupanygrid(py::module &m) {
                     "color", &geometry::OccupancyVoxel::color_,
                     "Float32 numpy array of shape (3,): Color of the voxel.");
 
+    py::class_<geometry::OccupancyGridDelta,
+               std::shared_ptr<geometry::OccupancyGridDelta>>
+            delta(m, "OccupancyGridDelta",
+                  "Voxels of an occupancy grid whose state changed since a "
+                  "version.");
+    py::detail::bind_default_constructor<geometry::OccupancyGridDelta>(delta);
+    delta.def("__repr__",
+              [](const geometry::OccupancyGridDelta &d) {
+                  return std::string("geometry::OccupancyGridDelta with ") +
+                         std::to_string(d.GetNumVoxels()) + " voxels.";
+              })
+            .def("get_num_voxels", &geometry::OccupancyGridDelta::GetNumVoxels)
+            .def("serialize",
+                 [](const geometry::OccupancyGridDelta &d) {
+                     const std::vector<uint8_t> data = d.Serialize();
+                     return py::bytes(reinterpret_cast<const char *>(data.data()),
+                                      data.size());
+                 })
+            .def("deserialize",
+                 [](geometry::OccupancyGridDelta &d, const py::bytes &bytes) {
+                     const std::string str = bytes;
+                     return d.Deserialize(std::vector<uint8_t>(str.begin(), str.end()));
+                 },
+                 "data"_a)
+            .def_readonly("from_version", &geometry::OccupancyGridDelta::from_version_)
+            .def_readonly("to_version", &geometry::OccupancyGridDelta::to_version_)
+            .def_readonly("reset", &geometry::OccupancyGridDelta::reset_)
+            .def_readonly("origin", &geometry::OccupancyGridDelta::origin_);
+
     py::class_<geometry::OccupancyGrid, PyGeometry3D<geometry::OccupancyGrid>,
                std::shared_ptr<geometry::OccupancyGrid>, geometry::Geometry3D>
             occupancygrid(m, "OccupancyGrid",
@@ -71,9 +103,44 @@ void pybind_occupanygrid(py::module &m) {
                  })
             .def("reconstruct", &geometry::OccupancyGrid::Reconstruct,
                  "Reconstruct dense voxel grid.")
+            .def("move_origin", &geometry::OccupancyGrid::MoveOrigin,
+                 "Move the grid to a new origin, keeping the voxels inside it.",
+                 "origin"_a)
             .def("insert", py::overload_cast<const geometry::PointCloud&, const Eigen::Vector3f&, float>(&geometry::OccupancyGrid::Insert),
                  "Function to insert occupancy grid from pointcloud.",
                  "pointcloud"_a, "viewpoint"_a, "max_range"_a = -1.0)
+            .def("extract_frontier_voxels", &geometry::OccupancyGrid::ExtractFrontierVoxels,
+                 "Free voxels with an unknown neighbor.")
+            .def("cluster_frontier_voxels",
+                 [](const geometry::OccupancyGrid &og,
+                    const std::shared_ptr<utility::device_vector<geometry::OccupancyVoxel>> &frontiers,
+                    int min_cluster_size) {
+                     thrust::host_vector<int> labels = og.ClusterFrontierVoxels(*frontiers, min_cluster_size);
+                     return labels;
+                 },
+                 "Cluster index of each frontier voxel, -1 for the small clusters.",
+                 "frontiers"_a, "min_cluster_size"_a = 1)
+            .def("compute_information_gain",
+                 [](const geometry::OccupancyGrid &og, const std::vector<Eigen::Matrix4f_u> &view_poses,
+                    const std::vector<Eigen::Vector3f> &ray_directions, float max_range) {
+                     const utility::device_vector<Eigen::Matrix4f_u> d_poses(view_poses.begin(), view_poses.end());
+                     const utility::device_vector<Eigen::Vector3f> d_dirs(ray_directions.begin(),
+                                                                           ray_directions.end());
+                     thrust::host_vector<int> gains = og.ComputeInformationGain(d_poses, d_dirs, max_range);
+                     return gains;
+                 },
+                 "Number of unknown voxels seen by the rays of each view.",
+                 "view_poses"_a, "ray_directions"_a, "max_range"_a)
+            .def("enable_change_tracking", &geometry::OccupancyGrid::EnableChangeTracking,
+                 "Record the version of the state changes of the voxels.")
+            .def("disable_change_tracking", &geometry::OccupancyGrid::DisableChangeTracking)
+            .def("is_change_tracking_enabled", &geometry::OccupancyGrid::IsChangeTrackingEnabled)
+            .def("get_version", &geometry::OccupancyGrid::GetVersion)
+            .def("export_delta", &geometry::OccupancyGrid::ExportDelta,
+                 "Voxels whose state changed after since_version.",
+                 "since_version"_a)
+            .def("apply_delta", &geometry::OccupancyGrid::ApplyDelta,
+                 "Apply the delta of another grid.", "delta"_a)
             .def_readwrite("voxel_size", &geometry::OccupancyGrid::voxel_size_)
             .def_readwrite("resolution", &geometry::OccupancyGrid::resolution_)
             .def_readwrite("origin", &geometry::OccupancyGrid::origin_)
@@ -82,5 +149,95 @@ void pybind_occupanygrid(py::module &m) {
             .def_readwrite("prob_hit_log", &geometry::OccupancyGrid::prob_hit_log_)
             .def_readwrite("prob_miss_log", &geometry::OccupancyGrid::prob_miss_log_)
             .def_readwrite("occ_prob_thres_log", &geometry::OccupancyGrid::occ_prob_thres_log_)
-            .def_readwrite("visualize_free_area", &geometry::OccupancyGrid::visualize_free_area_);
+            .def_readwrite("visualize_free_area", &geometry::OccupancyGrid::visualize_free_area_)
+            .def_readonly("ring_offset", &geometry::OccupancyGrid::ring_offset_);
+
+    py::class_<geometry::SparseOccupancyGrid,
+               std::shared_ptr<geometry::SparseOccupancyGrid>>
+            sparse_occupancygrid(m, "SparseOccupancyGrid",
+                                 "Occupancy map made of voxel blocks allocated "
+                                 "on demand in a hash table.");
+    py::detail::bind_copy_functions<geometry::SparseOccupancyGrid>(sparse_occupancygrid);
+    sparse_occupancygrid
+            .def(py::init<float, int>(),
+                 "Create a sparse occupancy grid", "voxel_size"_a = 0.05,
+                 "max_num_blocks"_a = 65536)
+            .def("__repr__",
+                 [](const geometry::SparseOccupancyGrid &grid) {
+                     return std::string("geometry::SparseOccupancyGrid with ") +
+                            std::to_string(grid.GetNumBlocks()) + " blocks.";
+                 })
+            .def("clear", &geometry::SparseOccupancyGrid::Clear)
+            .def("is_empty", &geometry::SparseOccupancyGrid::IsEmpty)
+            .def("is_occupied", &geometry::SparseOccupancyGrid::IsOccupied,
+                 "point"_a)
+            .def("is_unknown", &geometry::SparseOccupancyGrid::IsUnknown,
+                 "point"_a)
+            .def("get_prob_log",
+                 [](const geometry::SparseOccupancyGrid &grid,
+                    const Eigen::Vector3f &point) {
+                     auto res = grid.GetProbLog(point);
+                     return std::make_tuple(thrust::get<0>(res), thrust::get<1>(res));
+                 },
+                 "point"_a)
+            .def("insert", py::overload_cast<const geometry::PointCloud&, const Eigen::Vector3f&, float>(&geometry::SparseOccupancyGrid::Insert),
+                 "Function to insert occupancy grid from pointcloud.",
+                 "pointcloud"_a, "viewpoint"_a, "max_range"_a = -1.0)
+            .def("extract_occupied_voxels", &geometry::SparseOccupancyGrid::ExtractOccupiedVoxels)
+            .def("extract_free_voxels", &geometry::SparseOccupancyGrid::ExtractFreeVoxels)
+            .def("get_num_blocks", &geometry::SparseOccupancyGrid::GetNumBlocks)
+            .def_readonly("voxel_size", &geometry::SparseOccupancyGrid::voxel_size_)
+            .def_readonly("max_num_blocks", &geometry::SparseOccupancyGrid::max_num_blocks_)
+            .def_readwrite("clamping_thres_min", &geometry::SparseOccupancyGrid::clamping_thres_min_)
+            .def_readwrite("clamping_thres_max", &geometry::SparseOccupancyGrid::clamping_thres_max_)
+            .def_readwrite("prob_hit_log", &geometry::SparseOccupancyGrid::prob_hit_log_)
+            .def_readwrite("prob_miss_log", &geometry::SparseOccupancyGrid::prob_miss_log_)
+            .def_readwrite("occ_prob_thres_log", &geometry::SparseOccupancyGrid::occ_prob_thres_log_);
+
+    py::class_<geometry::OccupancyOctree,
+               std::shared_ptr<geometry::OccupancyOctree>>
+            occupancy_octree(m, "OccupancyOctree",
+                             "Occupancy map as a linear octree with pruning "
+                             "of the homogeneous subtrees.");
+    py::detail::bind_copy_functions<geometry::OccupancyOctree>(occupancy_octree);
+    occupancy_octree
+            .def(py::init<float, int>(),
+                 "Create an occupancy octree", "resolution"_a = 0.05,
+                 "max_height"_a = 16)
+            .def("__repr__",
+                 [](const geometry::OccupancyOctree &octree) {
+                     return std::string("geometry::OccupancyOctree with ") +
+                            std::to_string(octree.GetNumNodes()) + " nodes.";
+                 })
+            .def("clear", &geometry::OccupancyOctree::Clear)
+            .def("is_empty", &geometry::OccupancyOctree::IsEmpty)
+            .def("get_num_nodes", &geometry::OccupancyOctree::GetNumNodes)
+            .def("is_occupied", &geometry::OccupancyOctree::IsOccupied,
+                 "point"_a, "height"_a = 0)
+            .def("is_unknown", &geometry::OccupancyOctree::IsUnknown,
+                 "point"_a, "height"_a = 0)
+            .def("get_prob_log",
+                 [](const geometry::OccupancyOctree &octree,
+                    const Eigen::Vector3f &point, int height) {
+                     auto res = octree.GetProbLog(point, height);
+                     return std::make_tuple(thrust::get<0>(res), thrust::get<1>(res));
+                 },
+                 "point"_a, "height"_a = 0)
+            .def("insert", py::overload_cast<const geometry::PointCloud&, const Eigen::Vector3f&, float>(&geometry::OccupancyOctree::Insert),
+                 "Function to insert occupancy octree from pointcloud.",
+                 "pointcloud"_a, "viewpoint"_a, "max_range"_a = -1.0)
+            .def("prune", &geometry::OccupancyOctree::Prune)
+            .def("extract_occupied_voxels", &geometry::OccupancyOctree::ExtractOccupiedVoxels,
+                 "height"_a = 0)
+            .def_static("create_from_occupancy_grid",
+                        &geometry::OccupancyOctree::CreateFromOccupancyGrid,
+                        "grid"_a, "max_height"_a = 16)
+            .def_readonly("resolution", &geometry::OccupancyOctree::resolution_)
+            .def_readonly("max_height", &geometry::OccupancyOctree::max_height_)
+            .def_readwrite("clamping_thres_min", &geometry::OccupancyOctree::clamping_thres_min_)
+            .def_readwrite("clamping_thres_max", &geometry::OccupancyOctree::clamping_thres_max_)
+            .def_readwrite("prob_hit_log", &geometry::OccupancyOctree::prob_hit_log_)
+            .def_readwrite("prob_miss_log", &geometry::OccupancyOctree::prob_miss_log_)
+            .def_readwrite("occ_prob_thres_log", &geometry::OccupancyOctree::occ_prob_thres_log_)
+            .def_readwrite("auto_prune", &geometry::OccupancyOctree::auto_prune_);
 }
\ No newline at end of file
@@ -1,14 +1,44 @@
 #include "cupoch_pybind/geometry/geometry.h"
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/keypoint.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/pointcloud_pipeline.h"
+#include "cupoch/geometry/range_image.h"
 #include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/geometry/trianglemesh.h"
 #include "cupoch_pybind/geometry/geometry_trampoline.h"
+#include "cupoch_pybind/async_result.h"
 #include "cupoch_pybind/dl_converter.h"
 #include "cupoch_pybind/docstring.h"
 
 using namespace cupoch;
 
 void pybind_pointcloud(py::module &m) {
+    wrapper::pybind_async_result<wrapper::device_vector_int>(
+            m, "IntVectorFuture");
+    py::class_<geometry::GroundSegmentationOption> ground_option(
+            m, "GroundSegmentationOption",
+            "Parameters of the concentric zone ground segmentation.");
+    ground_option.def(py::init<>())
+            .def_readwrite("zone_boundaries",
+                           &geometry::GroundSegmentationOption::zone_boundaries_)
+            .def_readwrite("num_rings",
+                           &geometry::GroundSegmentationOption::num_rings_)
+            .def_readwrite("num_sectors",
+                           &geometry::GroundSegmentationOption::num_sectors_)
+            .def_readwrite("num_lowest_points",
+                           &geometry::GroundSegmentationOption::num_lowest_points_)
+            .def_readwrite("seed_height",
+                           &geometry::GroundSegmentationOption::seed_height_)
+            .def_readwrite("distance_threshold",
+                           &geometry::GroundSegmentationOption::distance_threshold_)
+            .def_readwrite("uprightness_threshold",
+                           &geometry::GroundSegmentationOption::uprightness_threshold_)
+            .def_readwrite("num_iterations",
+                           &geometry::GroundSegmentationOption::num_iterations_)
+            .def_readwrite("min_points",
+                           &geometry::GroundSegmentationOption::min_points_);
+
     py::class_<geometry::PointCloud, PyGeometry3D<geometry::PointCloud>,
                std::shared_ptr<geometry::PointCloud>, geometry::Geometry3D>
             pointcloud(m, "PointCloud",
@@ -34,28 +64,112 @@ void pybind_pointcloud(py::module &m) {
                                     [] (geometry::PointCloud &pcd, const wrapper::device_vector_vector3f& vec) {wrapper::FromWrapper(pcd.normals_, vec);})
             .def_property("colors", [] (geometry::PointCloud &pcd) {return wrapper::device_vector_vector3f(pcd.colors_);},
                                     [] (geometry::PointCloud &pcd, const wrapper::device_vector_vector3f& vec) {wrapper::FromWrapper(pcd.colors_, vec);})
-            .def("to_points_dlpack", [](geometry::PointCloud &pcd) {return dlpack::ToDLpackCapsule(pcd.points_);})
-            .def("to_normals_dlpack", [](geometry::PointCloud &pcd) {return dlpack::ToDLpackCapsule(pcd.normals_);})
-            .def("to_colors_dlpack", [](geometry::PointCloud &pcd) {return dlpack::ToDLpackCapsule(pcd.colors_);})
+            .def("to_points_dlpack", [](std::shared_ptr<geometry::PointCloud> pcd) {return dlpack::ToDLpackCapsule(pcd->points_, pcd);})
+            .def("to_normals_dlpack", [](std::shared_ptr<geometry::PointCloud> pcd) {return dlpack::ToDLpackCapsule(pcd->normals_, pcd);})
+            .def("to_colors_dlpack", [](std::shared_ptr<geometry::PointCloud> pcd) {return dlpack::ToDLpackCapsule(pcd->colors_, pcd);})
             .def("from_points_dlpack", [](geometry::PointCloud &pcd, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, pcd.points_);})
             .def("from_normals_dlpack", [](geometry::PointCloud &pcd, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, pcd.normals_);})
             .def("from_colors_dlpack", [](geometry::PointCloud &pcd, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, pcd.colors_);})
             .def(py::self + py::self)
             .def(py::self += py::self)
+            .def("append", &geometry::PointCloud::Append,
+                 "Appends the point clouds with the memory reserved once "
+                 "for all of them.",
+                 "clouds"_a)
+            .def("reserve", &geometry::PointCloud::Reserve,
+                 "Reserves the memory of the points, and of their normals, "
+                 "colors and attributes.",
+                 "n_points"_a, "normals"_a = true, "colors"_a = true,
+                 "attribute_dim"_a = 0)
             .def("has_points", &geometry::PointCloud::HasPoints,
                  "Returns ``True`` if the point cloud contains points.")
             .def("has_normals", &geometry::PointCloud::HasNormals,
                  "Returns ``True`` if the point cloud contains point normals.")
             .def("has_colors", &geometry::PointCloud::HasColors,
                  "Returns ``True`` if the point cloud contains point colors.")
+            .def("has_attributes", &geometry::PointCloud::HasAttributes,
+                 "Returns ``True`` if the point cloud contains custom point "
+                 "attributes.")
+            .def("set_attribute",
+                 (void (geometry::PointCloud::*)(
+                         const std::string &,
+                         const thrust::host_vector<float> &)) &
+                         geometry::PointCloud::SetAttribute,
+                 "Adds or overwrites a scalar per-point attribute channel.",
+                 "name"_a, "values"_a)
+            .def("get_attribute", &geometry::PointCloud::GetAttribute,
+                 "Returns a copy of the attribute channel ``name``.", "name"_a)
+            .def("clear_attributes", &geometry::PointCloud::ClearAttributes,
+                 "Removes all custom attribute channels.")
+            .def_property_readonly(
+                    "attribute_names",
+                    [](const geometry::PointCloud &pcd) {
+                        return pcd.attribute_names_;
+                    })
             .def("normalize_normals", &geometry::PointCloud::NormalizeNormals,
                  "Normalize point normals to length 1.")
-            .def("transform", &geometry::PointCloud::Transform,
+            .def("compute_mean_and_covariance",
+                 &geometry::PointCloud::ComputeMeanAndCovariance,
+                 "Function to compute the mean and covariance matrix of a "
+                 "point cloud.")
+            .def("transform",
+                 (geometry::PointCloud &(geometry::PointCloud::*)(
+                         const Eigen::Matrix4f &)) &
+                         geometry::PointCloud::Transform,
                  "Apply transformation (4x4 matrix) to the geometry "
                  "coordinates.")
+            .def("transform_batch",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(
+                         const std::vector<Eigen::Matrix4f_u> &) const) &
+                         geometry::PointCloud::TransformBatch,
+                 "Transforms the point cloud by each of the transformations "
+                 "into one concatenated point cloud in a single launch.",
+                 "transformations"_a)
+            .def_static(
+                    "transform_batch",
+                    [](const std::vector<std::shared_ptr<geometry::PointCloud>>
+                               &clouds,
+                       const std::vector<Eigen::Matrix4f_u> &transformations) {
+                        auto res = geometry::PointCloud::TransformBatch(
+                                clouds, transformations);
+                        return std::make_tuple(
+                                std::get<0>(res),
+                                wrapper::device_vector_int(
+                                        std::move(std::get<1>(res))));
+                    },
+                    "Transforms every cloud by its transformation into one "
+                    "concatenated point cloud in a single launch. Returns "
+                    "it with the offsets of the clouds in it.",
+                    "clouds"_a, "transformations"_a)
+            .def("deskew",
+                 (geometry::PointCloud &(geometry::PointCloud::*)(
+                         const std::vector<float> &,
+                         const std::vector<Eigen::Matrix4f_u> &, float,
+                         const std::string &)) &
+                         geometry::PointCloud::Deskew,
+                 "Corrects the motion distortion of a scan from the sensor "
+                 "poses at the given times and the per-point time attribute.",
+                 "pose_times"_a, "poses"_a, "reference_time"_a,
+                 "time_attribute"_a = "time")
+            .def("deskew",
+                 (geometry::PointCloud &(geometry::PointCloud::*)(
+                         const Eigen::Matrix4f &, const Eigen::Matrix4f &,
+                         float, float, const std::string &)) &
+                         geometry::PointCloud::Deskew,
+                 "Corrects the motion distortion of a scan from the sensor "
+                 "poses at its start and end, to the start frame.",
+                 "start_pose"_a, "end_pose"_a, "start_time"_a = 0.0,
+                 "end_time"_a = 1.0, "time_attribute"_a = "time")
             .def("paint_uniform_color",
                  &geometry::PointCloud::PaintUniformColor, "color"_a,
                  "Assigns each point in the PointCloud the same color.")
+            .def("colorize_from_images",
+                 &geometry::PointCloud::ColorizeFromImages, "images"_a,
+                 "intrinsics"_a, "extrinsics"_a,
+                 "occlusion_tolerance"_a = 0.1, "splat_radius"_a = 2,
+                 "Colors the points from the images of several cameras, "
+                 "with occlusion testing on a depth buffer per camera.")
             .def("select_by_index", [] (const geometry::PointCloud& pcd, const wrapper::device_vector_size_t& index, bool invert) {
                      return pcd.SelectByIndex(index.data_, invert); },
                  "Function to select points from input pointcloud into output "
@@ -64,19 +178,47 @@ void pybind_pointcloud(py::module &m) {
                  "``True`` to "
                  "invert the selection of indices.",
                  "indices"_a, "invert"_a = false)
-            .def("voxel_down_sample", &geometry::PointCloud::VoxelDownSample,
+            .def("voxel_down_sample",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(float, bool) const) &
+                         geometry::PointCloud::VoxelDownSample,
                  "Function to downsample input pointcloud into output "
                  "pointcloud with "
                  "a voxel",
-                 "voxel_size"_a)
+                 "voxel_size"_a, "deterministic"_a = true)
             .def("uniform_down_sample",
-                 &geometry::PointCloud::UniformDownSample,
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(size_t) const) &
+                         geometry::PointCloud::UniformDownSample,
                  "Function to downsample input pointcloud into output "
                  "pointcloud "
                  "uniformly. The sample is performed in the order of the "
                  "points with "
                  "the 0-th point always chosen, not at random.",
                  "every_k_points"_a)
+            .def("approximate_voxel_down_sample",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(float) const) &
+                         geometry::PointCloud::ApproximateVoxelDownSample,
+                 "Function to downsample input pointcloud into output "
+                 "pointcloud with a voxel, keeping the first point of every "
+                 "voxel",
+                 "voxel_size"_a)
+            .def("random_down_sample",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(size_t, unsigned int) const) &
+                         geometry::PointCloud::RandomDownSample,
+                 "Function to downsample input pointcloud into output "
+                 "pointcloud with a fixed number of random points",
+                 "n_samples"_a, "seed"_a = 0)
+            .def("farthest_point_down_sample",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(size_t, size_t) const) &
+                         geometry::PointCloud::FarthestPointDownSample,
+                 "Function to downsample input pointcloud into output "
+                 "pointcloud with a fixed number of points by farthest point "
+                 "sampling",
+                 "n_samples"_a, "start_index"_a = 0)
             .def("crop",
                  (std::shared_ptr<geometry::PointCloud>(
                          geometry::PointCloud::*)(
@@ -91,45 +233,211 @@ void pybind_pointcloud(py::module &m) {
                          geometry::PointCloud::Crop,
                  "Function to crop input pointcloud into output pointcloud",
                  "bounding_box"_a)
+            .def("crop_in_place",
+                 (geometry::PointCloud & (geometry::PointCloud::*)(
+                         const geometry::AxisAlignedBoundingBox &)) &
+                         geometry::PointCloud::CropInPlace,
+                 "Function to crop the pointcloud in place",
+                 "bounding_box"_a)
+            .def("crop_in_place",
+                 (geometry::PointCloud & (geometry::PointCloud::*)(
+                         const geometry::OrientedBoundingBox &)) &
+                         geometry::PointCloud::CropInPlace,
+                 "Function to crop the pointcloud in place",
+                 "bounding_box"_a)
+            .def("select_by_mask_in_place",
+                 [](geometry::PointCloud &pcd, const std::vector<bool> &mask,
+                    bool invert) -> geometry::PointCloud & {
+                     thrust::host_vector<bool> h_mask(mask.begin(),
+                                                      mask.end());
+                     utility::device_vector<bool> d_mask = h_mask;
+                     return pcd.SelectByMaskInPlace(d_mask, invert);
+                 },
+                 "Function to keep the points selected by a boolean mask, "
+                 "compacting the pointcloud in place",
+                 "mask"_a, "invert"_a = false)
+            .def("compute_radius_inlier_mask",
+                 &geometry::PointCloud::ComputeRadiusInlierMask,
+                 "Mask of the points kept by ``remove_radius_outlier``",
+                 "nb_points"_a, "radius"_a,
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann)
+            .def("compute_statistical_inlier_mask",
+                 (geometry::SelectionMask(geometry::PointCloud::*)(
+                         size_t, float, geometry::SearchIndexType) const) &
+                         geometry::PointCloud::ComputeStatisticalInlierMask,
+                 "Mask of the points kept by ``remove_statistical_outlier``",
+                 "nb_neighbors"_a, "std_ratio"_a,
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann)
+            .def("compute_crop_mask", &geometry::PointCloud::ComputeCropMask,
+                 "Mask of the points within the bounding box",
+                 "bounding_box"_a)
+            .def("select_by_mask",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloud::*)(
+                         const geometry::SelectionMask &, bool) const) &
+                         geometry::PointCloud::SelectByMask,
+                 "Function to compact the points selected by a mask into "
+                 "output pointcloud",
+                 "mask"_a, "invert"_a = false)
+            .def("pipeline", &geometry::PointCloud::Pipeline,
+                 "Starts a lazy chain of point operations, fused into a few "
+                 "kernels by ``run``",
+                 py::keep_alive<0, 1>())
             .def("remove_none_finite_points",
                  &geometry::PointCloud::RemoveNoneFinitePoints,
                  "Function to remove none-finite points from the PointCloud",
                  "remove_nan"_a = true, "remove_infinite"_a = true)
             .def("remove_radius_outlier",
-                 [] (const geometry::PointCloud& pcd, size_t nb_points, float search_radius) {
-                      auto res = pcd.RemoveRadiusOutliers(nb_points, search_radius);
+                 [] (const geometry::PointCloud& pcd, size_t nb_points, float search_radius,
+                     geometry::SearchIndexType index_type) {
+                      auto res = pcd.RemoveRadiusOutliers(nb_points, search_radius, index_type);
                       return std::make_tuple(std::get<0>(res), wrapper::device_vector_size_t(std::move(std::get<1>(res))));
                  },
                  "Function to remove points that have less than nb_points"
                  " in a given sphere of a given radius",
-                 "nb_points"_a, "radius"_a)
+                 "nb_points"_a, "radius"_a,
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann)
             .def("remove_statistical_outlier",
-                 [] (const geometry::PointCloud& pcd, size_t nb_neighbors, float std_ratio) {
-                      auto res = pcd.RemoveStatisticalOutliers(nb_neighbors, std_ratio);
+                 [] (const geometry::PointCloud& pcd, size_t nb_neighbors, float std_ratio,
+                     geometry::SearchIndexType index_type) {
+                      auto res = pcd.RemoveStatisticalOutliers(nb_neighbors, std_ratio, index_type);
                       return std::make_tuple(std::get<0>(res), wrapper::device_vector_size_t(std::move(std::get<1>(res))));
                  },
                  "Function to remove points that are further away from their "
                  "neighbors in average",
-                 "nb_neighbors"_a, "std_ratio"_a)
-            .def("estimate_normals", &geometry::PointCloud::EstimateNormals,
+                 "nb_neighbors"_a, "std_ratio"_a,
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann)
+            .def("segment_plane",
+                 [] (const geometry::PointCloud& pcd, float distance_threshold, int ransac_n,
+                     int num_iterations, unsigned int seed) {
+                      auto res = pcd.SegmentPlane(distance_threshold, ransac_n, num_iterations, seed);
+                      return std::make_tuple(std::get<0>(res), wrapper::device_vector_size_t(std::move(std::get<1>(res))));
+                 },
+                 "Segments the dominant plane with RANSAC. Returns the plane "
+                 "(a, b, c, d) and the indices of its inliers.",
+                 "distance_threshold"_a = 0.01, "ransac_n"_a = 3,
+                 "num_iterations"_a = 100, "seed"_a = 0)
+            .def("segment_ground",
+                 [] (const geometry::PointCloud& pcd, const geometry::GroundSegmentationOption& option) {
+                      return wrapper::device_vector_size_t(pcd.SegmentGround(option));
+                 },
+                 "Returns the indices of the ground points, fitted region "
+                 "by region on a concentric zone model around the origin.",
+                 "option"_a = geometry::GroundSegmentationOption())
+            .def("estimate_normals",
+                 (bool (geometry::PointCloud::*)(
+                         const geometry::KDTreeSearchParam &,
+                         geometry::SearchIndexType)) &
+                         geometry::PointCloud::EstimateNormals,
                  "Function to compute the normals of a point cloud. Normals "
                  "are oriented with respect to the input point cloud if "
                  "normals exist",
-                 "search_param"_a = geometry::KDTreeSearchParamKNN())
+                 "search_param"_a = geometry::KDTreeSearchParamKNN(),
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann)
+            .def("estimate_organized_normals",
+                 &geometry::PointCloud::EstimateOrganizedNormals,
+                 "Function to compute the normals of an organized point cloud "
+                 "from its image-space neighbors",
+                 "width"_a, "height"_a, "step"_a = 1)
             .def("orient_normals_to_align_with_direction",
                  &geometry::PointCloud::OrientNormalsToAlignWithDirection,
                  "Function to orient the normals of a point cloud",
                  "orientation_reference"_a = Eigen::Vector3f(0.0, 0.0, 1.0))
+            .def("orient_normals_consistent_tangent_plane",
+                 &geometry::PointCloud::OrientNormalsConsistentTangentPlane,
+                 "Function to orient the normals consistently along the "
+                 "minimum spanning tree of the k nearest neighbor graph",
+                 "k"_a)
             .def("cluster_dbscan",
-                 [] (const geometry::PointCloud& pcd, float eps, size_t min_points, bool print_progress, size_t max_edges) {
-                      auto res = pcd.ClusterDBSCAN(eps, min_points, print_progress, max_edges);
+                 [] (const geometry::PointCloud& pcd, float eps, size_t min_points, bool print_progress, size_t max_edges,
+                     geometry::SearchIndexType index_type) {
+                      auto res = pcd.ClusterDBSCAN(eps, min_points, print_progress, max_edges, index_type);
                       return wrapper::device_vector_int(std::move(res));
                  },
+                 py::call_guard<py::gil_scoped_release>(),
                  "Cluster PointCloud using the DBSCAN algorithm  Ester et al., "
                  "'A Density-Based Algorithm for Discovering Clusters in Large "
                  "Spatial Databases with Noise', 1996. Returns a list of point "
                  "labels, -1 indicates noise according to the algorithm.",
-                 "eps"_a, "min_points"_a, "print_progress"_a = false, "max_edges"_a = geometry::NUM_MAX_NN)
+                 "eps"_a, "min_points"_a, "print_progress"_a = false, "max_edges"_a = geometry::NUM_MAX_NN,
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann)
+            .def("cluster_dbscan_async",
+                 [] (const geometry::PointCloud& pcd, float eps, size_t min_points, bool print_progress, size_t max_edges,
+                     geometry::SearchIndexType index_type) {
+                      return wrapper::RunAsync([&pcd, eps, min_points, print_progress, max_edges, index_type]() {
+                          auto res = pcd.ClusterDBSCAN(eps, min_points, print_progress, max_edges, index_type);
+                          return wrapper::device_vector_int(std::move(res));
+                      });
+                 },
+                 "Same as cluster_dbscan, on a worker thread. Returns an "
+                 "``IntVectorFuture`` of the labels.",
+                 "eps"_a, "min_points"_a, "print_progress"_a = false, "max_edges"_a = geometry::NUM_MAX_NN,
+                 "index_type"_a = geometry::SearchIndexType::KDTreeFlann,
+                 py::keep_alive<0, 1>())
+            .def("compute_convex_hull",
+                 [] (const geometry::PointCloud& pcd) {
+                      auto res = pcd.ComputeConvexHull();
+                      return std::make_tuple(std::get<0>(res), wrapper::device_vector_size_t(std::move(std::get<1>(res))));
+                 },
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Computes the convex hull of the point cloud by QuickHull. "
+                 "Returns the hull and the indices of its vertices in the "
+                 "points.")
+            .def("compute_convex_hulls",
+                 [] (const geometry::PointCloud& pcd, const wrapper::device_vector_int& labels) {
+                      return pcd.ComputeConvexHulls(labels.data_);
+                 },
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Computes the convex hulls of the clusters of the labels, "
+                 "the hull of label l at index l. The points labeled -1 are "
+                 "ignored.",
+                 "labels"_a)
+            .def("hidden_point_removal",
+                 [] (const geometry::PointCloud& pcd, const Eigen::Vector3f& camera_location, float radius) {
+                      auto res = pcd.HiddenPointRemoval(camera_location, radius);
+                      return std::make_tuple(std::get<0>(res), wrapper::device_vector_size_t(std::move(std::get<1>(res))));
+                 },
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Removes the points hidden from the camera by spherical "
+                 "flipping and convex hull. Returns the hull and the indices "
+                 "of the visible points.",
+                 "camera_location"_a, "radius"_a)
+            .def("hidden_point_removal_batch",
+                 [] (const geometry::PointCloud& pcd, const std::vector<Eigen::Vector3f>& camera_locations, float radius) {
+                      auto res = pcd.HiddenPointRemovalBatch(camera_locations, radius);
+                      std::vector<wrapper::device_vector_size_t> out;
+                      for (auto& r : res) out.emplace_back(std::move(r));
+                      return out;
+                 },
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Indices of the points visible from each camera location.",
+                 "camera_locations"_a, "radius"_a)
+            .def("project_to_depth_image",
+                 &geometry::PointCloud::ProjectToDepthImage,
+                 "Renders the nearest points seen from a camera into a float "
+                 "depth image, zero where there is no point.",
+                 "intrinsic"_a, "extrinsic"_a = Eigen::Matrix4f::Identity())
+            .def("project_to_index_image",
+                 &geometry::PointCloud::ProjectToIndexImage,
+                 "Renders the indices of the nearest points seen from a "
+                 "camera into an int image, -1 where there is no point.",
+                 "intrinsic"_a, "extrinsic"_a = Eigen::Matrix4f::Identity())
+            .def("to_range_image", &geometry::PointCloud::ToRangeImage,
+                 "Projects the points onto a float range image, zero where "
+                 "there is no point.",
+                 "projection"_a)
+            .def("to_range_index_image",
+                 &geometry::PointCloud::ToRangeIndexImage,
+                 "Projects the indices of the nearest points onto an int "
+                 "range image, -1 where there is no point.",
+                 "projection"_a)
+            .def_static("create_from_range_image",
+                        &geometry::PointCloud::CreateFromRangeImage,
+                        "Factory function to create a pointcloud from the "
+                        "float range image of a spinning LiDAR.",
+                        "range"_a,
+                        "projection"_a,
+                        "project_valid_range_only"_a = true)
             .def_static(
                     "create_from_depth_image",
                     &geometry::PointCloud::CreateFromDepthImage,
@@ -143,7 +451,7 @@ void pybind_pointcloud(py::module &m) {
                     "depth"_a, "intrinsic"_a,
                     "extrinsic"_a = Eigen::Matrix4f::Identity(),
                     "depth_scale"_a = 1000.0, "depth_trunc"_a = 1000.0,
-                    "stride"_a = 1)
+                    "stride"_a = 1, "project_valid_depth_only"_a = true)
             .def_static(
                     "create_from_rgbd_image",
                     &geometry::PointCloud::CreateFromRGBDImage,
@@ -156,7 +464,22 @@ void pybind_pointcloud(py::module &m) {
         )",
                     "image"_a, "intrinsic"_a,
                     "extrinsic"_a = Eigen::Matrix4f::Identity(),
-                    "project_valid_depth_only"_a = true);
+                    "project_valid_depth_only"_a = true)
+            .def("unproject_depth_image",
+                 &geometry::PointCloud::UnprojectDepthImage,
+                 "Replaces the points by the valid pixels of a depth image, "
+                 "keeping the allocated memory.",
+                 "depth"_a, "intrinsic"_a,
+                 "extrinsic"_a = Eigen::Matrix4f::Identity(),
+                 "depth_scale"_a = 1000.0, "depth_trunc"_a = 1000.0,
+                 "stride"_a = 1)
+            .def("unproject_rgbd_image",
+                 &geometry::PointCloud::UnprojectRGBDImage,
+                 "Replaces the points and colors by the valid pixels of an "
+                 "RGB-D image, keeping the allocated memory.",
+                 "image"_a, "intrinsic"_a,
+                 "extrinsic"_a = Eigen::Matrix4f::Identity(),
+                 "depth_trunc"_a = 1000.0, "stride"_a = 1);
      docstring::ClassMethodDocInject(m, "PointCloud", "has_colors");
      docstring::ClassMethodDocInject(m, "PointCloud", "has_normals");
      docstring::ClassMethodDocInject(m, "PointCloud", "has_points");
@@ -172,11 +495,24 @@ void pybind_pointcloud(py::module &m) {
      docstring::ClassMethodDocInject(
              m, "PointCloud", "voxel_down_sample",
              {{"voxel_size", "Voxel size to downsample into."},
-              {"invert", "set to ``True`` to invert the selection of indices"}});
+              {"deterministic",
+               "Set to ``False`` to accumulate the voxels in a hash table, "
+               "which is faster but does not fix the output order."}});
      docstring::ClassMethodDocInject(
              m, "PointCloud", "uniform_down_sample",
              {{"every_k_points",
                "Sample rate, the selected point indices are [0, k, 2k, ...]"}});
+     docstring::ClassMethodDocInject(
+             m, "PointCloud", "approximate_voxel_down_sample",
+             {{"voxel_size", "Voxel size to downsample into."}});
+     docstring::ClassMethodDocInject(
+             m, "PointCloud", "random_down_sample",
+             {{"n_samples", "Number of output points."},
+              {"seed", "Seed of the random selection."}});
+     docstring::ClassMethodDocInject(
+             m, "PointCloud", "farthest_point_down_sample",
+             {{"n_samples", "Number of output points."},
+              {"start_index", "Index of the first selected point."}});
      docstring::ClassMethodDocInject(
              m, "PointCloud", "remove_none_finite_points",
              {{"remove_nan", "Remove NaN values from the PointCloud"},
@@ -198,6 +534,12 @@ void pybind_pointcloud(py::module &m) {
                "If true, the normal estiamtion uses a non-iterative method to "
                "extract the eigenvector from the covariance matrix. This is "
                "faster, but is not as numerical stable."}});
+     docstring::ClassMethodDocInject(
+             m, "PointCloud", "estimate_organized_normals",
+             {{"width", "Width of the image the points are organized on."},
+              {"height", "Height of the image the points are organized on."},
+              {"step", "Pixel distance of the neighbors used for the "
+                       "differences."}});
      docstring::ClassMethodDocInject(
              m, "PointCloud", "orient_normals_to_align_with_direction",
              {{"orientation_reference",
@@ -225,4 +567,82 @@ void pybind_pointcloud(py::module &m) {
                      "have nan point. If this value is False, return point "
                      "cloud, which has whole points"},
             });
-}
\ No newline at end of file
+
+    docstring::ClassMethodDocInject(
+            m, "PointCloud", "segment_plane",
+            {{"distance_threshold",
+              "Max distance of a point to the plane to be an inlier."},
+             {"ransac_n", "Number of points of a plane hypothesis."},
+             {"num_iterations", "Number of hypotheses."},
+             {"seed", "Seed of the random sampling."}});
+
+    py::class_<geometry::SelectionMask> selection_mask(
+            m, "SelectionMask", "Selection of points, one bit per point.");
+    selection_mask.def(py::init<size_t, bool>(), "size"_a, "value"_a = true)
+            .def(py::init([](const std::vector<bool> &mask) {
+                     return geometry::SelectionMask(thrust::host_vector<bool>(
+                             mask.begin(), mask.end()));
+                 }),
+                 "mask"_a)
+            .def("size", &geometry::SelectionMask::Size)
+            .def("count", &geometry::SelectionMask::Count,
+                 "Number of selected points.")
+            .def("get_mask",
+                 [](const geometry::SelectionMask &mask) {
+                     const auto h_mask = mask.GetMask();
+                     return std::vector<bool>(h_mask.begin(), h_mask.end());
+                 })
+            .def("logical_and", &geometry::SelectionMask::And, "other"_a,
+                 py::return_value_policy::reference_internal)
+            .def("logical_or", &geometry::SelectionMask::Or, "other"_a,
+                 py::return_value_policy::reference_internal)
+            .def("invert", &geometry::SelectionMask::Invert,
+                 py::return_value_policy::reference_internal);
+
+    py::class_<geometry::PointCloudPipeline> pipeline(
+            m, "PointCloudPipeline",
+            "Lazy chain of point operations on a PointCloud.");
+    pipeline.def("transform", &geometry::PointCloudPipeline::Transform,
+                 "Appends a transform, composed with the previous one.",
+                 "transformation"_a,
+                 py::return_value_policy::reference_internal)
+            .def("crop",
+                 (geometry::PointCloudPipeline &
+                  (geometry::PointCloudPipeline::*)(
+                          const geometry::AxisAlignedBoundingBox &)) &
+                         geometry::PointCloudPipeline::Crop,
+                 "Appends an axis aligned crop.", "bounding_box"_a,
+                 py::return_value_policy::reference_internal)
+            .def("crop",
+                 (geometry::PointCloudPipeline &
+                  (geometry::PointCloudPipeline::*)(
+                          const geometry::OrientedBoundingBox &)) &
+                         geometry::PointCloudPipeline::Crop,
+                 "Appends an oriented crop.", "bounding_box"_a,
+                 py::return_value_policy::reference_internal)
+            .def("remove_non_finite",
+                 &geometry::PointCloudPipeline::RemoveNonFinite,
+                 "Appends the removal of the non finite points.",
+                 "remove_nan"_a = true, "remove_infinite"_a = true,
+                 py::return_value_policy::reference_internal)
+            .def("voxel_down_sample",
+                 &geometry::PointCloudPipeline::VoxelDownSample,
+                 "Sets the final voxel down sampling.", "voxel_size"_a,
+                 "deterministic"_a = true,
+                 py::return_value_policy::reference_internal)
+            .def("run",
+                 (std::shared_ptr<geometry::PointCloud>(
+                         geometry::PointCloudPipeline::*)() const) &
+                         geometry::PointCloudPipeline::Run,
+                 "Runs the pipeline and returns the output point cloud.");
+
+    m.def("compute_iss_keypoints", &geometry::ComputeISSKeypoints,
+          "Intrinsic Shape Signature keypoints of the point cloud",
+          "input"_a, "salient_radius"_a = 0.0, "non_max_radius"_a = 0.0,
+          "gamma_21"_a = 0.975, "gamma_32"_a = 0.975, "min_neighbors"_a = 5,
+          "max_nn"_a = geometry::NUM_MAX_NN);
+    m.def("compute_harris3d_keypoints", &geometry::ComputeHarris3DKeypoints,
+          "Harris 3D keypoints of the point cloud, from its normals",
+          "input"_a, "radius"_a, "threshold"_a = 0.0, "min_neighbors"_a = 5,
+          "max_nn"_a = geometry::NUM_MAX_NN);
+}
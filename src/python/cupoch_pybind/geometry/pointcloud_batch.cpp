@@ -0,0 +1,101 @@
+#include "cupoch/geometry/pointcloud_batch.h"
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch_pybind/device_vector_wrapper.h"
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/geometry/geometry.h"
+
+using namespace cupoch;
+
+void pybind_pointcloud_batch(py::module &m) {
+    py::class_<geometry::PointCloudBatch,
+               std::shared_ptr<geometry::PointCloudBatch>>
+            batch(m, "PointCloudBatch",
+                  "Many small point clouds stored as one concatenated "
+                  "point cloud and the offsets of the clouds in it.");
+    py::detail::bind_default_constructor<geometry::PointCloudBatch>(batch);
+    py::detail::bind_copy_functions<geometry::PointCloudBatch>(batch);
+    batch.def(py::init<const std::vector<
+                      std::shared_ptr<geometry::PointCloud>> &>(),
+              "Concatenates the point clouds.", "clouds"_a)
+            .def("__repr__",
+                 [](const geometry::PointCloudBatch &batch) {
+                     return std::string("geometry::PointCloudBatch with ") +
+                            std::to_string(batch.GetNumClouds()) +
+                            " clouds and " +
+                            std::to_string(batch.GetNumPoints()) + " points.";
+                 })
+            .def("__len__", &geometry::PointCloudBatch::GetNumClouds)
+            .def("__getitem__", &geometry::PointCloudBatch::GetCloud)
+            .def_static(
+                    "create_from_labels",
+                    [](const geometry::PointCloud &cloud,
+                       const wrapper::device_vector_int &labels) {
+                        return geometry::PointCloudBatch::CreateFromLabels(
+                                cloud, labels.data_);
+                    },
+                    "Returns the batch of the clusters of the point cloud, "
+                    "cloud l holding the points of label l. The points "
+                    "labeled -1 are dropped.",
+                    "cloud"_a, "labels"_a)
+            .def_property_readonly(
+                    "points",
+                    [](const geometry::PointCloudBatch &batch) {
+                        return wrapper::device_vector_vector3f(batch.points_);
+                    })
+            .def_property_readonly(
+                    "normals",
+                    [](const geometry::PointCloudBatch &batch) {
+                        return wrapper::device_vector_vector3f(batch.normals_);
+                    })
+            .def_property_readonly(
+                    "colors",
+                    [](const geometry::PointCloudBatch &batch) {
+                        return wrapper::device_vector_vector3f(batch.colors_);
+                    })
+            .def_property_readonly("offsets",
+                                   &geometry::PointCloudBatch::GetOffsets)
+            .def("get_labels",
+                 [](const geometry::PointCloudBatch &batch) {
+                     return wrapper::device_vector_int(batch.GetLabels());
+                 },
+                 "Returns the index of the cloud of every point.")
+            .def("get_num_clouds", &geometry::PointCloudBatch::GetNumClouds)
+            .def("get_num_points", &geometry::PointCloudBatch::GetNumPoints)
+            .def("has_normals", &geometry::PointCloudBatch::HasNormals)
+            .def("has_colors", &geometry::PointCloudBatch::HasColors)
+            .def("is_empty", &geometry::PointCloudBatch::IsEmpty)
+            .def("clear", &geometry::PointCloudBatch::Clear)
+            .def("get_cloud", &geometry::PointCloudBatch::GetCloud,
+                 "Returns a copy of cloud i.", "i"_a)
+            .def("split", &geometry::PointCloudBatch::Split,
+                 "Returns copies of all the clouds.")
+            .def("to_point_cloud", &geometry::PointCloudBatch::ToPointCloud,
+                 "Returns the concatenated point cloud.")
+            .def("transform", &geometry::PointCloudBatch::Transform,
+                 "Transforms cloud i by transformations[i].",
+                 "transformations"_a)
+            .def("voxel_down_sample",
+                 &geometry::PointCloudBatch::VoxelDownSample,
+                 "Voxel down samples every cloud in one pass, on a grid "
+                 "shared by all the clouds.",
+                 "voxel_size"_a)
+            .def("estimate_normals",
+                 &geometry::PointCloudBatch::EstimateNormals,
+                 "Estimates the normals from the nearest neighbors of every "
+                 "point within its own cloud.",
+                 "knn"_a = 30)
+            .def("get_oriented_bounding_boxes",
+                 &geometry::PointCloudBatch::GetOrientedBoundingBoxes,
+                 "Returns the oriented bounding box of every cloud.");
+    docstring::ClassMethodDocInject(m, "PointCloudBatch", "transform",
+                                    {{"transformations",
+                                      "One 4x4 transformation per cloud."}});
+    docstring::ClassMethodDocInject(
+            m, "PointCloudBatch", "voxel_down_sample",
+            {{"voxel_size", "Voxel size to downsample into."}});
+    docstring::ClassMethodDocInject(
+            m, "PointCloudBatch", "estimate_normals",
+            {{"knn", "Number of neighbors used for the normals."}});
+}
@@ -0,0 +1,39 @@
+#include "cupoch/geometry/range_image.h"
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/geometry/geometry.h"
+
+using namespace cupoch;
+
+void pybind_range_image(py::module &m) {
+    py::class_<geometry::RangeImageProjection> projection(
+            m, "RangeImageProjection",
+            "Spherical projection of a spinning LiDAR scan onto a range "
+            "image.");
+    projection
+            .def(py::init<int, int, float, float, float, float>(),
+                 "num_rings"_a = 64, "num_columns"_a = 1024,
+                 "min_elevation"_a = -0.4346, "max_elevation"_a = 0.0349,
+                 "min_range"_a = 0.0, "max_range"_a = 1000.0)
+            .def_readwrite("num_rings",
+                           &geometry::RangeImageProjection::num_rings_)
+            .def_readwrite("num_columns",
+                           &geometry::RangeImageProjection::num_columns_)
+            .def_readwrite("min_elevation",
+                           &geometry::RangeImageProjection::min_elevation_)
+            .def_readwrite("max_elevation",
+                           &geometry::RangeImageProjection::max_elevation_)
+            .def_readwrite("min_range",
+                           &geometry::RangeImageProjection::min_range_)
+            .def_readwrite("max_range",
+                           &geometry::RangeImageProjection::max_range_);
+
+    m.def("label_range_image_ground", &geometry::LabelRangeImageGround,
+          "Labels the ground pixels of a range image, 1 for ground and 0 "
+          "otherwise.",
+          "range"_a, "projection"_a, "max_slope"_a = 0.1745);
+    m.def("cluster_range_image", &geometry::ClusterRangeImage,
+          "Segments a range image into objects. Returns the int image of "
+          "the cluster labels, -1 for the invalid and ground pixels.",
+          "range"_a, "projection"_a, "angle_threshold"_a = 0.1745,
+          "ground"_a = geometry::Image());
+}
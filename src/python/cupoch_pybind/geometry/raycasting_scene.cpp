@@ -0,0 +1,74 @@
+#include "cupoch/geometry/raycasting_scene.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/geometry/geometry.h"
+
+using namespace cupoch;
+
+void pybind_raycasting_scene(py::module &m) {
+    py::class_<geometry::RaycastingScene,
+               std::shared_ptr<geometry::RaycastingScene>>
+            scene(m, "RaycastingScene",
+                  "Batched ray casting against triangle meshes.");
+    py::detail::bind_default_constructor<geometry::RaycastingScene>(scene);
+    scene.def("add_triangles", &geometry::RaycastingScene::AddTriangles,
+              "Adds the triangles of a mesh and returns the id of the "
+              "geometry.",
+              "mesh"_a)
+            .def("clear", &geometry::RaycastingScene::Clear,
+                 "Removes all the geometries.")
+            .def("get_num_geometries",
+                 &geometry::RaycastingScene::GetNumGeometries)
+            .def("get_num_triangles",
+                 &geometry::RaycastingScene::GetNumTriangles)
+            .def(
+                    "cast_rays",
+                    [](const geometry::RaycastingScene &self,
+                       const wrapper::device_vector_vector3f &origins,
+                       const wrapper::device_vector_vector3f &directions,
+                       float max_distance) {
+                        geometry::RayCastResult result;
+                        self.CastRays(origins.data_, directions.data_, result,
+                                      max_distance);
+                        py::dict out;
+                        out["t_hit"] = wrapper::device_vector_float(
+                                std::move(result.t_hit_));
+                        out["geometry_ids"] =
+                                thrust::host_vector<unsigned int>(
+                                        result.geometry_ids_);
+                        out["primitive_ids"] =
+                                thrust::host_vector<unsigned int>(
+                                        result.primitive_ids_);
+                        out["primitive_uvs"] = wrapper::device_vector_vector2f(
+                                std::move(result.primitive_uvs_));
+                        out["primitive_normals"] =
+                                wrapper::device_vector_vector3f(std::move(
+                                        result.primitive_normals_));
+                        return out;
+                    },
+                    "First hits of the rays, as a dict of t_hit, "
+                    "geometry_ids, primitive_ids, primitive_uvs and "
+                    "primitive_normals.",
+                    "origins"_a, "directions"_a,
+                    "max_distance"_a = std::numeric_limits<float>::infinity())
+            .def(
+                    "count_intersections",
+                    [](const geometry::RaycastingScene &self,
+                       const wrapper::device_vector_vector3f &origins,
+                       const wrapper::device_vector_vector3f &directions,
+                       float max_distance) {
+                        return wrapper::device_vector_int(
+                                self.CountIntersections(origins.data_,
+                                                        directions.data_,
+                                                        max_distance));
+                    },
+                    "Number of triangles crossed by every ray.", "origins"_a,
+                    "directions"_a,
+                    "max_distance"_a = std::numeric_limits<float>::infinity())
+            .def("simulate_lidar", &geometry::RaycastingScene::SimulateLidar,
+                 "Simulated scan of a spinning LiDAR, in the sensor frame.",
+                 "sensor_pose"_a, "n_horizontal"_a, "n_vertical"_a,
+                 "fov_up"_a, "fov_down"_a, "max_range"_a);
+    scene.attr("INVALID_ID") = geometry::RaycastingScene::kInvalidId;
+}
@@ -78,6 +78,23 @@ void pybind_trianglemesh(py::module &m) {
                  "that references a single vertex multiple times in a single "
                  "triangle. They are usually the product of removing "
                  "duplicated vertices.")
+            .def("cluster_connected_triangles",
+                 [](const geometry::TriangleMesh &mesh) {
+                     auto res = mesh.ClusterConnectedTriangles();
+                     return std::make_tuple(
+                             wrapper::device_vector_int(std::get<0>(res)),
+                             wrapper::device_vector_size_t(std::get<1>(res)),
+                             wrapper::device_vector_float(std::get<2>(res)));
+                 },
+                 "Function that clusters the triangles connected through "
+                 "shared edges. Returns the cluster of every triangle and "
+                 "the number of triangles and the area of every cluster.")
+            .def("remove_small_triangle_clusters",
+                 &geometry::TriangleMesh::RemoveSmallTriangleClusters,
+                 "Function that removes the triangles of the connected "
+                 "clusters with fewer than min_num_triangles triangles or an "
+                 "area below min_area.",
+                 "min_num_triangles"_a, "min_area"_a = 0.0)
             .def("filter_sharpen", &geometry::TriangleMesh::FilterSharpen,
                  "Function to sharpen triangle mesh. The output value "
                  "(:math:`v_o`) is the input value (:math:`v_i`) plus strength "
@@ -116,6 +133,12 @@ void pybind_trianglemesh(py::module &m) {
                  "shrinkage of the triangle mesh.",
                  "number_of_iterations"_a = 1, "lambda"_a = 0.5, "mu"_a = -0.53,
                  "filter_scope"_a = geometry::MeshBase::FilterScope::All)
+            .def("simplify_quadric_decimation",
+                 &geometry::TriangleMesh::SimplifyQuadricDecimation,
+                 "Function to simplify mesh using Quadric Error Metric "
+                 "Decimation by Garland and Heckbert",
+                 "target_number_of_triangles"_a,
+                 "maximum_error"_a = std::numeric_limits<float>::infinity())
             .def("has_vertices", &geometry::TriangleMesh::HasVertices,
                  "Returns ``True`` if the mesh contains vertices.")
             .def("has_triangles", &geometry::TriangleMesh::HasTriangles,
@@ -150,6 +173,67 @@ void pybind_trianglemesh(py::module &m) {
                  &geometry::TriangleMesh::SamplePointsUniformly,
                  "Function to uniformly sample points from the mesh.",
                  "number_of_points"_a = 100, "use_triangle_normal"_a = false)
+            .def("sample_points_by_importance",
+                 [](const geometry::TriangleMesh &mesh, size_t number_of_points,
+                    const wrapper::device_vector_float &triangle_weights,
+                    bool use_triangle_normal, unsigned int seed) {
+                     return mesh.SamplePointsByImportance(number_of_points,
+                                                          triangle_weights.data_,
+                                                          use_triangle_normal, seed);
+                 },
+                 "Function to sample points from the mesh with a density "
+                 "proportional to the area of the triangles times their "
+                 "weights.",
+                 "number_of_points"_a, "triangle_weights"_a,
+                 "use_triangle_normal"_a = false, "seed"_a = 0)
+            .def("sample_points_poisson_disk",
+                 &geometry::TriangleMesh::SamplePointsPoissonDisk,
+                 "Function to sample points from the mesh, where each point "
+                 "has approximately the same distance to the neighbouring "
+                 "points (blue noise). Method is based on Yuksel, \"Sample "
+                 "Elimination for Generating Poisson Disk Sample Sets\", "
+                 "EUROGRAPHICS, 2015.",
+                 "number_of_points"_a, "init_factor"_a = 5,
+                 "use_triangle_normal"_a = false, "seed"_a = 0)
+            .def_static("sample_points_uniformly_batch",
+                        [](const std::vector<std::shared_ptr<geometry::TriangleMesh>> &meshes,
+                           size_t number_of_points_per_mesh, bool use_triangle_normal,
+                           unsigned int seed) {
+                            std::vector<std::shared_ptr<const geometry::TriangleMesh>> cmeshes(
+                                    meshes.begin(), meshes.end());
+                            return geometry::TriangleMesh::SamplePointsUniformlyBatch(
+                                    cmeshes, number_of_points_per_mesh, use_triangle_normal, seed);
+                        },
+                        "Function to uniformly sample the same number of "
+                        "points from every mesh in one pass.",
+                        "meshes"_a, "number_of_points_per_mesh"_a,
+                        "use_triangle_normal"_a = false, "seed"_a = 0)
+            .def("compute_triangle_curvatures",
+                 [](const geometry::TriangleMesh &mesh) {
+                     return wrapper::device_vector_float(mesh.ComputeTriangleCurvatures());
+                 },
+                 "Function that computes a curvature of every triangle from "
+                 "the deviation of the vertex normals to its normal.")
+            .def_static("create_from_point_cloud_poisson",
+                        [](const geometry::PointCloud &pcd, size_t depth,
+                           float scale, float point_weight, int max_iterations,
+                           float tolerance) {
+                            auto res = geometry::TriangleMesh::
+                                    CreateFromPointCloudPoisson(
+                                            pcd, depth, scale, point_weight,
+                                            max_iterations, tolerance);
+                            return std::make_tuple(
+                                    std::get<0>(res),
+                                    wrapper::device_vector_float(
+                                            std::get<1>(res)));
+                        },
+                        "Function that computes a triangle mesh from an "
+                        "oriented point cloud by screened Poisson surface "
+                        "reconstruction. Returns the mesh and the density of "
+                        "the samples at its vertices.",
+                        "pcd"_a, "depth"_a = 8, "scale"_a = 1.1,
+                        "point_weight"_a = 4.0, "max_iterations"_a = 200,
+                        "tolerance"_a = 1.0e-4)
             .def_static("create_box", &geometry::TriangleMesh::CreateBox,
                         "Factory function to create a box. The left bottom "
                         "corner on the "
@@ -227,12 +311,18 @@ void pybind_trianglemesh(py::module &m) {
                                           [] (geometry::TriangleMesh &mesh, const wrapper::device_vector_vector2f& vec) {wrapper::FromWrapper(mesh.triangle_uvs_, vec);})
             .def_readwrite("texture", &geometry::TriangleMesh::texture_,
                            "cupoch.geometry.Image: The texture image.")
-            .def("to_vertices_dlpack", [](geometry::TriangleMesh &mesh) {return dlpack::ToDLpackCapsule(mesh.vertices_);})
-            .def("to_vertex_normals_dlpack", [](geometry::TriangleMesh &mesh) {return dlpack::ToDLpackCapsule(mesh.vertex_normals_);})
-            .def("to_vertex_colors_dlpack", [](geometry::TriangleMesh &mesh) {return dlpack::ToDLpackCapsule(mesh.vertex_colors_);})
+            .def("to_vertices_dlpack", [](std::shared_ptr<geometry::TriangleMesh> mesh) {return dlpack::ToDLpackCapsule(mesh->vertices_, mesh);})
+            .def("to_vertex_normals_dlpack", [](std::shared_ptr<geometry::TriangleMesh> mesh) {return dlpack::ToDLpackCapsule(mesh->vertex_normals_, mesh);})
+            .def("to_vertex_colors_dlpack", [](std::shared_ptr<geometry::TriangleMesh> mesh) {return dlpack::ToDLpackCapsule(mesh->vertex_colors_, mesh);})
             .def("from_vertices_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.vertices_);})
             .def("from_vertex_normals_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.vertex_normals_);})
-            .def("from_vertex_colors_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.vertex_colors_);});
+            .def("from_vertex_colors_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.vertex_colors_);})
+            .def("to_triangles_dlpack", [](std::shared_ptr<geometry::TriangleMesh> mesh) {return dlpack::ToDLpackCapsule(mesh->triangles_, mesh);})
+            .def("to_triangle_normals_dlpack", [](std::shared_ptr<geometry::TriangleMesh> mesh) {return dlpack::ToDLpackCapsule(mesh->triangle_normals_, mesh);})
+            .def("to_triangle_uvs_dlpack", [](std::shared_ptr<geometry::TriangleMesh> mesh) {return dlpack::ToDLpackCapsule(mesh->triangle_uvs_, mesh);})
+            .def("from_triangles_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.triangles_);})
+            .def("from_triangle_normals_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.triangle_normals_);})
+            .def("from_triangle_uvs_dlpack", [](geometry::TriangleMesh &mesh, py::capsule dlpack) {dlpack::FromDLpackCapsule(dlpack, mesh.triangle_uvs_);});
      docstring::ClassMethodDocInject(m, "TriangleMesh",
                                      "compute_edge_list");
      docstring::ClassMethodDocInject(m, "TriangleMesh",
@@ -286,6 +376,13 @@ void pybind_trianglemesh(py::module &m) {
               {"lambda", "Filter parameter."},
               {"mu", "Filter parameter."},
               {"scope", "Mesh property that should be filtered."}});
+     docstring::ClassMethodDocInject(
+             m, "TriangleMesh", "simplify_quadric_decimation",
+             {{"target_number_of_triangles",
+               "The number of triangles that the simplified mesh should have. "
+               "It is not guaranteed that this number will be reached."},
+              {"maximum_error",
+               "The maximum error where a vertex is allowed to be merged"}});
      docstring::ClassMethodDocInject(
              m, "TriangleMesh", "paint_uniform_color",
              {{"color", "RGB color for the PointCloud."}});
@@ -0,0 +1,59 @@
+#include "cupoch/geometry/voxel_point_map.h"
+#include "cupoch/geometry/pointcloud.h"
+
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/geometry/geometry.h"
+
+using namespace cupoch;
+
+void pybind_voxel_point_map(py::module &m) {
+    py::class_<geometry::VoxelPointMap,
+               std::shared_ptr<geometry::VoxelPointMap>>
+            voxel_point_map(m, "VoxelPointMap",
+                            "Point map of bounded memory holding at most a "
+                            "fixed number of points per voxel.");
+    py::detail::bind_copy_functions<geometry::VoxelPointMap>(voxel_point_map);
+    py::enum_<geometry::VoxelPointMap::ReplacementPolicy>(
+            voxel_point_map, "ReplacementPolicy")
+            .value("KeepOldest",
+                   geometry::VoxelPointMap::ReplacementPolicy::KeepOldest)
+            .value("ReplaceOldest",
+                   geometry::VoxelPointMap::ReplacementPolicy::ReplaceOldest)
+            .export_values();
+    voxel_point_map
+            .def(py::init<float, int, int,
+                          geometry::VoxelPointMap::ReplacementPolicy>(),
+                 "Create a voxel point map", "voxel_size"_a = 0.5,
+                 "max_points_per_voxel"_a = 20,
+                 "max_num_voxels"_a = 1 << 18,
+                 "policy"_a =
+                         geometry::VoxelPointMap::ReplacementPolicy::KeepOldest)
+            .def("__repr__",
+                 [](const geometry::VoxelPointMap &map) {
+                     return std::string("geometry::VoxelPointMap with ") +
+                            std::to_string(map.GetNumVoxels()) + " voxels.";
+                 })
+            .def("clear", &geometry::VoxelPointMap::Clear)
+            .def("is_empty", &geometry::VoxelPointMap::IsEmpty)
+            .def("get_num_voxels", &geometry::VoxelPointMap::GetNumVoxels)
+            .def("get_num_points", &geometry::VoxelPointMap::GetNumPoints)
+            .def("insert",
+                 py::overload_cast<const geometry::PointCloud &,
+                                   const Eigen::Matrix4f &>(
+                         &geometry::VoxelPointMap::Insert),
+                 "Function to insert a scan registered at pose.",
+                 "pointcloud"_a, "pose"_a = Eigen::Matrix4f::Identity())
+            .def("remove_far_voxels",
+                 &geometry::VoxelPointMap::RemoveFarVoxels,
+                 "Function to free the voxels farther than radius from "
+                 "center.",
+                 "center"_a, "radius"_a)
+            .def("extract_point_cloud",
+                 &geometry::VoxelPointMap::ExtractPointCloud)
+            .def_readonly("voxel_size", &geometry::VoxelPointMap::voxel_size_)
+            .def_readonly("max_points_per_voxel",
+                          &geometry::VoxelPointMap::max_points_per_voxel_)
+            .def_readonly("max_num_voxels",
+                          &geometry::VoxelPointMap::max_num_voxels_)
+            .def_readwrite("policy", &geometry::VoxelPointMap::policy_);
+}
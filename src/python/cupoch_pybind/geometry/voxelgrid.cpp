@@ -1,4 +1,5 @@
 #include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/geometry/voxelgrid_hash_map.h"
 #include "cupoch/camera/pinhole_camera_parameters.h"
 #include "cupoch/geometry/image.h"
 #include "cupoch/geometry/pointcloud.h"
@@ -72,7 +73,10 @@ void pybind_voxelgrid(py::module &m) {
                  "Returns ``True`` if the voxel grid contains voxels.")
             .def("get_voxel", &geometry::VoxelGrid::GetVoxel, "point"_a,
                  "Returns voxel index given query point.")
-            .def("check_if_included", &geometry::VoxelGrid::CheckIfIncluded,
+            .def("check_if_included",
+                 py::overload_cast<const thrust::host_vector<Eigen::Vector3f>
+                                           &>(
+                         &geometry::VoxelGrid::CheckIfIncluded),
                  "queries"_a,
                  "Element-wise check if a query in the list is included in "
                  "the VoxelGrid. Queries are double precision and "
@@ -94,6 +98,16 @@ void pybind_voxelgrid(py::module &m) {
                  "(pixel value > 0). If keep_voxels_outside_image is true then "
                  "voxels are only carved if all boundary points project to a "
                  "valid image location.")
+            .def("carve_depth_maps", &geometry::VoxelGrid::CarveDepthMaps,
+                 "depth_maps"_a, "camera_params"_a,
+                 "keep_voxels_outside_image"_a = false,
+                 "Same as carve_depth_map for all the views in one pass over "
+                 "the voxels.")
+            .def("carve_silhouettes", &geometry::VoxelGrid::CarveSilhouettes,
+                 "silhouette_masks"_a, "camera_params"_a,
+                 "keep_voxels_outside_image"_a = false,
+                 "Same as carve_silhouette for all the views in one pass over "
+                 "the voxels.")
             .def_static("create_dense", &geometry::VoxelGrid::CreateDense,
                         "Creates a voxel grid where every voxel is set (hence "
                         "dense). This is a useful starting point for voxel "
@@ -117,6 +131,18 @@ void pybind_voxelgrid(py::module &m) {
                     &geometry::VoxelGrid::CreateFromTriangleMeshWithinBounds,
                     "Function to make voxels from a PointCloud", "input"_a,
                     "voxel_size"_a, "min_bound"_a, "max_bound"_a)
+            .def_static("create_solid_from_triangle_mesh",
+                        &geometry::VoxelGrid::CreateSolidFromTriangleMesh,
+                        "Function to make the voxels of the surface and of "
+                        "the inside of a closed TriangleMesh",
+                        "input"_a, "voxel_size"_a)
+            .def_static(
+                    "create_solid_from_triangle_mesh_within_bounds",
+                    &geometry::VoxelGrid::
+                            CreateSolidFromTriangleMeshWithinBounds,
+                    "Function to make the voxels of the surface and of the "
+                    "inside of a closed TriangleMesh",
+                    "input"_a, "voxel_size"_a, "min_bound"_a, "max_bound"_a)
             .def_readwrite("origin", &geometry::VoxelGrid::origin_,
                            "``float32`` vector of length 3: Coorindate of the "
                            "origin point.")
@@ -176,6 +202,50 @@ void pybind_voxelgrid(py::module &m) {
               "Minimum boundary point for the VoxelGrid to create."},
              {"max_bound",
               "Maximum boundary point for the VoxelGrid to create."}});
+    docstring::ClassMethodDocInject(
+            m, "VoxelGrid", "create_solid_from_triangle_mesh",
+            {{"input", "The input TriangleMesh"},
+             {"voxel_size", "Voxel size of of the VoxelGrid construction."}});
+    docstring::ClassMethodDocInject(
+            m, "VoxelGrid", "create_solid_from_triangle_mesh_within_bounds",
+            {{"input", "The input TriangleMesh"},
+             {"voxel_size", "Voxel size of of the VoxelGrid construction."},
+             {"min_bound",
+              "Minimum boundary point for the VoxelGrid to create."},
+             {"max_bound",
+              "Maximum boundary point for the VoxelGrid to create."}});
+
+    py::class_<geometry::VoxelGridHashMap,
+               std::shared_ptr<geometry::VoxelGridHashMap>>
+            hash_map(m, "VoxelGridHashMap",
+                     "Device hash table from the voxel indices of a "
+                     "VoxelGrid to their positions in the grid.");
+    py::detail::bind_default_constructor<geometry::VoxelGridHashMap>(hash_map);
+    hash_map.def(py::init<const geometry::VoxelGrid &>(), "voxelgrid"_a)
+            .def("set_voxel_grid", &geometry::VoxelGridHashMap::SetVoxelGrid,
+                 "Builds the table of the voxels of a VoxelGrid.",
+                 "voxelgrid"_a)
+            .def("get_num_voxels", &geometry::VoxelGridHashMap::GetNumVoxels)
+            .def(
+                    "find",
+                    [](const geometry::VoxelGridHashMap &self,
+                       const wrapper::device_vector_vector3i &voxels) {
+                        return wrapper::device_vector_int(
+                                self.Find(voxels.data_));
+                    },
+                    "Positions of the voxel indices in the grid, -1 for the "
+                    "voxels not in it.",
+                    "voxels"_a)
+            .def(
+                    "find_points",
+                    [](const geometry::VoxelGridHashMap &self,
+                       const wrapper::device_vector_vector3f &queries) {
+                        return wrapper::device_vector_int(
+                                self.FindPoints(queries.data_));
+                    },
+                    "Positions of the voxels of the points in the grid, -1 "
+                    "for the points out of it.",
+                    "queries"_a);
 }
 
 void pybind_voxelgrid_methods(py::module &m) {}
\ No newline at end of file
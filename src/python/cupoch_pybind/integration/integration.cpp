@@ -1,7 +1,9 @@
 #include "cupoch/geometry/voxelgrid.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
 #include "cupoch/integration/tsdfvolume.h"
 #include "cupoch/integration/uniform_tsdfvolume.h"
 
+#include "cupoch_pybind/async_result.h"
 #include "cupoch_pybind/docstring.h"
 #include "cupoch_pybind/integration/integration.h"
 
@@ -57,8 +59,26 @@ In SIGGRAPH, 1996)");
             .def("reset", &integration::TSDFVolume::Reset,
                  "Function to reset the integration::TSDFVolume")
             .def("integrate", &integration::TSDFVolume::Integrate,
+                 py::call_guard<py::gil_scoped_release>(),
                  "Function to integrate an RGB-D image into the volume",
                  "image"_a, "intrinsic"_a, "extrinsic"_a)
+            .def("integrate_async",
+                 [](integration::TSDFVolume &vol,
+                    const geometry::RGBDImage &image,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const Eigen::Matrix4f &extrinsic) {
+                     const Eigen::Matrix4f_u extrinsic_u = extrinsic;
+                     return wrapper::RunAsync([&vol, &image, intrinsic,
+                                               extrinsic_u]() {
+                         vol.Integrate(image, intrinsic, extrinsic_u);
+                         return true;
+                     });
+                 },
+                 "Function to integrate an RGB-D image into the volume on a "
+                 "worker thread, returning a ``cupoch.utility.BoolFuture``. "
+                 "The integrations into one volume must not overlap.",
+                 "image"_a, "intrinsic"_a, "extrinsic"_a,
+                 py::keep_alive<0, 1>(), py::keep_alive<0, 2>())
             .def("extract_point_cloud",
                  &integration::TSDFVolume::ExtractPointCloud,
                  "Function to extract a point cloud with normals")
@@ -95,11 +115,14 @@ In SIGGRAPH, 1996)");
             uniform_tsdfvolume);
     uniform_tsdfvolume
             .def(py::init([](float length, int resolution, float sdf_trunc,
-                             integration::TSDFVolumeColorType color_type) {
+                             integration::TSDFVolumeColorType color_type,
+                             bool use_compact_voxels) {
                      return new integration::UniformTSDFVolume(
-                             length, resolution, sdf_trunc, color_type);
+                             length, resolution, sdf_trunc, color_type,
+                             Eigen::Vector3f::Zero(), use_compact_voxels);
                  }),
-                 "length"_a, "resolution"_a, "sdf_trunc"_a, "color_type"_a)
+                 "length"_a, "resolution"_a, "sdf_trunc"_a, "color_type"_a,
+                 "use_compact_voxels"_a = false)
             .def("__repr__",
                  [](const integration::UniformTSDFVolume &vol) {
                      return std::string("integration::UniformTSDFVolume ") +
@@ -115,6 +138,58 @@ In SIGGRAPH, 1996)");
             .def("extract_voxel_grid",
                  &integration::UniformTSDFVolume::ExtractVoxelGrid,
                  "Debug function to extract the voxel data VoxelGrid.")
+            .def("raycast",
+                 [](const integration::UniformTSDFVolume &vol,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const Eigen::Matrix4f &extrinsic, float max_depth) {
+                     return vol.Raycast(intrinsic, extrinsic, max_depth);
+                 },
+                 "Function to raycast the vertex, normal and color maps of "
+                 "the surface seen by a camera.",
+                 "intrinsic"_a, "extrinsic"_a, "max_depth"_a = 3.0)
+            .def("raycast_depth",
+                 [](const integration::UniformTSDFVolume &vol,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const Eigen::Matrix4f &extrinsic, float max_depth) {
+                     return vol.RaycastDepth(intrinsic, extrinsic, max_depth);
+                 },
+                 "Function to raycast the depth image of the surface seen "
+                 "by a camera.",
+                 "intrinsic"_a, "extrinsic"_a, "max_depth"_a = 3.0)
+            .def("raycast_color",
+                 [](const integration::UniformTSDFVolume &vol,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const Eigen::Matrix4f &extrinsic, float max_depth) {
+                     return vol.RaycastColor(intrinsic, extrinsic, max_depth);
+                 },
+                 "Function to raycast the color image of the surface seen "
+                 "by a camera.",
+                 "intrinsic"_a, "extrinsic"_a, "max_depth"_a = 3.0)
+            .def("integrate_batch",
+                 [](integration::UniformTSDFVolume &vol,
+                    const std::vector<std::shared_ptr<geometry::RGBDImage>>
+                            &images,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const std::vector<Eigen::Matrix4f_u> &extrinsics) {
+                     vol.IntegrateBatch(images, intrinsic, extrinsics);
+                 },
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Function to integrate RGB-D images into the volume in one "
+                 "sweep over the voxels",
+                 "images"_a, "intrinsic"_a, "extrinsics"_a)
+            .def("extract_triangle_mesh_incremental",
+                 &integration::UniformTSDFVolume::
+                         ExtractTriangleMeshIncremental,
+                 "Function to extract a triangle mesh, meshing again only "
+                 "the blocks changed since the previous call. The returned "
+                 "mesh is updated in place by the next call.")
+            .def("get_memory_size",
+                 &integration::UniformTSDFVolume::GetMemorySize,
+                 "Device memory of the voxels, in bytes.")
+            .def_readonly("use_compact_voxels",
+                          &integration::UniformTSDFVolume::use_compact_voxels_,
+                          "If True, the voxels are stored in 8 bytes with a "
+                          "quantized TSDF and color.")
             .def_readwrite("length", &integration::UniformTSDFVolume::length_,
                            "Total length, where ``voxel_length = length / "
                            "resolution``.")
@@ -124,6 +199,70 @@ In SIGGRAPH, 1996)");
                            "``voxel_length = length / resolution``");
     docstring::ClassMethodDocInject(m, "UniformTSDFVolume",
                                     "extract_voxel_point_cloud");
+
+    // cupoch.integration.ScalableTSDFVolume: cupoch.integration.TSDFVolume
+    py::class_<integration::ScalableTSDFVolume,
+               PyTSDFVolume<integration::ScalableTSDFVolume>,
+               integration::TSDFVolume>
+            scalable_tsdfvolume(m, "ScalableTSDFVolume",
+                                "ScalableTSDFVolume implements a TSDF volume "
+                                "made of voxel blocks allocated on demand "
+                                "from a hash table on the device.");
+    py::detail::bind_copy_functions<integration::ScalableTSDFVolume>(
+            scalable_tsdfvolume);
+    scalable_tsdfvolume
+            .def(py::init([](float voxel_length, float sdf_trunc,
+                             integration::TSDFVolumeColorType color_type,
+                             int max_num_blocks, int depth_sampling_stride) {
+                     return new integration::ScalableTSDFVolume(
+                             voxel_length, sdf_trunc, color_type,
+                             max_num_blocks, depth_sampling_stride);
+                 }),
+                 "voxel_length"_a, "sdf_trunc"_a, "color_type"_a,
+                 "max_num_blocks"_a = 65536, "depth_sampling_stride"_a = 4)
+            .def("__repr__",
+                 [](const integration::ScalableTSDFVolume &vol) {
+                     return std::string("integration::ScalableTSDFVolume "
+                                        "with ") +
+                            std::to_string(vol.GetNumBlocks()) +
+                            std::string(" blocks.");
+                 })
+            .def("extract_voxel_point_cloud",
+                 &integration::ScalableTSDFVolume::ExtractVoxelPointCloud,
+                 "Debug function to extract the voxel data into a point cloud.")
+            .def("raycast_depth",
+                 [](const integration::ScalableTSDFVolume &vol,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const Eigen::Matrix4f &extrinsic, float max_depth) {
+                     return vol.RaycastDepth(intrinsic, extrinsic, max_depth);
+                 },
+                 "Function to raycast the depth image of the surface seen "
+                 "by a camera.",
+                 "intrinsic"_a, "extrinsic"_a, "max_depth"_a = 3.0)
+            .def("raycast_color",
+                 [](const integration::ScalableTSDFVolume &vol,
+                    const camera::PinholeCameraIntrinsic &intrinsic,
+                    const Eigen::Matrix4f &extrinsic, float max_depth) {
+                     return vol.RaycastColor(intrinsic, extrinsic, max_depth);
+                 },
+                 "Function to raycast the color image of the surface seen "
+                 "by a camera.",
+                 "intrinsic"_a, "extrinsic"_a, "max_depth"_a = 3.0)
+            .def("get_axis_aligned_bounding_box",
+                 &integration::ScalableTSDFVolume::GetAxisAlignedBoundingBox,
+                 "Bounds of the allocated blocks.")
+            .def("get_num_blocks",
+                 &integration::ScalableTSDFVolume::GetNumBlocks,
+                 "Number of allocated voxel blocks.")
+            .def_readonly("max_num_blocks",
+                          &integration::ScalableTSDFVolume::max_num_blocks_,
+                          "Maximum number of voxel blocks.")
+            .def_readwrite(
+                    "depth_sampling_stride",
+                    &integration::ScalableTSDFVolume::depth_sampling_stride_,
+                    "Stride of the depth pixels that allocate blocks.");
+    docstring::ClassMethodDocInject(m, "ScalableTSDFVolume",
+                                    "extract_voxel_point_cloud");
 }
 
 void pybind_integration_methods(py::module &m) {
@@ -1,4 +1,5 @@
 #include "cupoch_pybind/io/io.h"
+#include "cupoch_pybind/async_result.h"
 #include "cupoch_pybind/docstring.h"
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/camera/pinhole_camera_parameters.h"
@@ -68,6 +69,7 @@ void pybind_class_io(py::module &m_io) {
                  io::ReadImage(filename, image);
                  return image;
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to read Image from file", "filename"_a);
     docstring::FunctionDocInject(m_io, "read_image",
                                  map_shared_argument_docstrings);
@@ -77,6 +79,7 @@ void pybind_class_io(py::module &m_io) {
                 int quality) {
                  return io::WriteImage(filename, image, quality);
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to write Image to file", "filename"_a, "image"_a,
              "quality"_a = 90);
     docstring::FunctionDocInject(m_io, "write_image",
@@ -92,6 +95,7 @@ void pybind_class_io(py::module &m_io) {
                                     remove_infinite_points, print_progress);
                  return pcd;
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to read PointCloud from file", "filename"_a,
              "format"_a = "auto", "remove_nan_points"_a = true,
              "remove_infinite_points"_a = true, "print_progress"_a = false);
@@ -105,12 +109,52 @@ void pybind_class_io(py::module &m_io) {
                  return io::WritePointCloud(filename, pointcloud, write_ascii,
                                             compressed, print_progress);
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to write PointCloud to file", "filename"_a,
              "pointcloud"_a, "write_ascii"_a = false, "compressed"_a = false,
              "print_progress"_a = false);
     docstring::FunctionDocInject(m_io, "write_point_cloud",
                                  map_shared_argument_docstrings);
 
+    wrapper::pybind_async_result<std::shared_ptr<geometry::PointCloud>>(
+            m_io, "PointCloudFuture");
+    m_io.def("read_point_cloud_async",
+             [](const std::string &filename, const std::string &format,
+                bool remove_nan_points, bool remove_infinite_points) {
+                 return wrapper::RunAsync([filename, format, remove_nan_points,
+                                           remove_infinite_points]() {
+                     auto pcd = std::make_shared<geometry::PointCloud>();
+                     io::ReadPointCloud(filename, *pcd, format,
+                                        remove_nan_points,
+                                        remove_infinite_points);
+                     return pcd;
+                 });
+             },
+             "Function to read PointCloud from file on a worker thread, "
+             "returning a ``PointCloudFuture``",
+             "filename"_a, "format"_a = "auto", "remove_nan_points"_a = true,
+             "remove_infinite_points"_a = true);
+    docstring::FunctionDocInject(m_io, "read_point_cloud_async",
+                                 map_shared_argument_docstrings);
+
+    m_io.def("write_point_cloud_async",
+             [](const std::string &filename,
+                const geometry::PointCloud &pointcloud, bool write_ascii,
+                bool compressed) {
+                 return wrapper::RunAsync([filename, &pointcloud, write_ascii,
+                                           compressed]() {
+                     return io::WritePointCloud(filename, pointcloud,
+                                                write_ascii, compressed);
+                 });
+             },
+             "Function to write PointCloud to file on a worker thread, "
+             "returning a ``cupoch.utility.BoolFuture``. The point cloud "
+             "must not be modified before the future is done.",
+             "filename"_a, "pointcloud"_a, "write_ascii"_a = false,
+             "compressed"_a = false, py::keep_alive<0, 2>());
+    docstring::FunctionDocInject(m_io, "write_point_cloud_async",
+                                 map_shared_argument_docstrings);
+
     // cupoch::geometry::TriangleMesh
     m_io.def("read_triangle_mesh",
              [](const std::string &filename, bool print_progress) {
@@ -118,6 +162,7 @@ void pybind_class_io(py::module &m_io) {
                  io::ReadTriangleMesh(filename, mesh, print_progress);
                  return mesh;
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to read TriangleMesh from file", "filename"_a,
              "print_progress"_a = false);
     docstring::FunctionDocInject(m_io, "read_triangle_mesh",
@@ -133,6 +178,7 @@ void pybind_class_io(py::module &m_io) {
                          write_vertex_normals, write_vertex_colors,
                          write_triangle_uvs, print_progress);
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to write TriangleMesh to file", "filename"_a, "mesh"_a,
              "write_ascii"_a = false, "compressed"_a = false,
              "write_vertex_normals"_a = true, "write_vertex_colors"_a = true,
@@ -148,6 +194,7 @@ void pybind_class_io(py::module &m_io) {
                  io::ReadVoxelGrid(filename, voxel_grid, format);
                  return voxel_grid;
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to read VoxelGrid from file", "filename"_a,
              "format"_a = "auto", "print_progress"_a = false);
     docstring::FunctionDocInject(m_io, "read_voxel_grid",
@@ -160,6 +207,7 @@ void pybind_class_io(py::module &m_io) {
                  return io::WriteVoxelGrid(filename, voxel_grid, write_ascii,
                                            compressed, print_progress);
              },
+             py::call_guard<py::gil_scoped_release>(),
              "Function to write VoxelGrid to file", "filename"_a,
              "voxel_grid"_a, "write_ascii"_a = false, "compressed"_a = false,
              "print_progress"_a = false);
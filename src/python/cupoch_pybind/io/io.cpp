@@ -3,4 +3,5 @@
 void pybind_io(py::module &m) {
     py::module m_io = m.def_submodule("io");
     pybind_class_io(m_io);
+    pybind_ros(m_io);
 }
\ No newline at end of file
@@ -4,3 +4,4 @@
 
 void pybind_io(py::module& m);
 void pybind_class_io(py::module& m);
+void pybind_ros(py::module& m);
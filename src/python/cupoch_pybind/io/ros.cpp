@@ -0,0 +1,116 @@
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/ros/image_msg.h"
+#include "cupoch/io/ros/pointcloud2_msg.h"
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/io/io.h"
+
+using namespace cupoch;
+
+namespace {
+
+const uint8_t *GetBufferData(py::buffer data, size_t size) {
+    py::buffer_info info = data.request();
+    if (size_t(info.size * info.itemsize) < size) {
+        throw std::runtime_error("The buffer is smaller than the message.");
+    }
+    return (const uint8_t *)info.ptr;
+}
+
+}  // namespace
+
+void pybind_ros(py::module &m_io) {
+    py::class_<io::PointField> point_field(
+            m_io, "PointField",
+            "Description of one field of a sensor_msgs/PointField.");
+    py::detail::bind_default_constructor<io::PointField>(point_field);
+    py::detail::bind_copy_functions<io::PointField>(point_field);
+    point_field
+            .def(py::init<const std::string &, uint32_t, uint8_t, uint32_t>(),
+                 "name"_a, "offset"_a, "datatype"_a, "count"_a = 1)
+            .def_readwrite("name", &io::PointField::name_)
+            .def_readwrite("offset", &io::PointField::offset_)
+            .def_readwrite("datatype", &io::PointField::datatype_)
+            .def_readwrite("count", &io::PointField::count_);
+
+    py::class_<io::PointCloud2MsgInfo> pointcloud2_info(
+            m_io, "PointCloud2MsgInfo",
+            "Layout of the data buffer of a sensor_msgs/PointCloud2 message.");
+    py::detail::bind_default_constructor<io::PointCloud2MsgInfo>(
+            pointcloud2_info);
+    py::detail::bind_copy_functions<io::PointCloud2MsgInfo>(pointcloud2_info);
+    pointcloud2_info
+            .def_static("default", &io::PointCloud2MsgInfo::Default,
+                        "Layout of packed x, y, z float32 points, followed "
+                        "by the rgb and normal fields when requested.",
+                        "width"_a, "has_colors"_a = false,
+                        "has_normals"_a = false)
+            .def("get_size", &io::PointCloud2MsgInfo::GetSize)
+            .def_readwrite("height", &io::PointCloud2MsgInfo::height_)
+            .def_readwrite("width", &io::PointCloud2MsgInfo::width_)
+            .def_readwrite("fields", &io::PointCloud2MsgInfo::fields_)
+            .def_readwrite("is_bigendian",
+                           &io::PointCloud2MsgInfo::is_bigendian_)
+            .def_readwrite("point_step", &io::PointCloud2MsgInfo::point_step_)
+            .def_readwrite("row_step", &io::PointCloud2MsgInfo::row_step_)
+            .def_readwrite("is_dense", &io::PointCloud2MsgInfo::is_dense_);
+
+    py::class_<io::ImageMsgInfo> image_info(
+            m_io, "ImageMsgInfo",
+            "Layout of the data buffer of a sensor_msgs/Image message.");
+    py::detail::bind_copy_functions<io::ImageMsgInfo>(image_info);
+    image_info
+            .def(py::init<uint32_t, uint32_t, const std::string &, bool,
+                          uint32_t>(),
+                 "width"_a, "height"_a, "encoding"_a, "is_bigendian"_a = false,
+                 "step"_a = 0)
+            .def("get_size", &io::ImageMsgInfo::GetSize)
+            .def_readwrite("height", &io::ImageMsgInfo::height_)
+            .def_readwrite("width", &io::ImageMsgInfo::width_)
+            .def_readwrite("encoding", &io::ImageMsgInfo::encoding_)
+            .def_readwrite("is_bigendian", &io::ImageMsgInfo::is_bigendian_)
+            .def_readwrite("step", &io::ImageMsgInfo::step_);
+
+    m_io.def("create_from_pointcloud2_msg",
+             [](py::buffer data, const io::PointCloud2MsgInfo &info) {
+                 return io::CreateFromPointCloud2Msg(
+                         GetBufferData(data, info.GetSize()), info);
+             },
+             "Function to create PointCloud from the data of a "
+             "sensor_msgs/PointCloud2 message",
+             "data"_a, "info"_a);
+    m_io.def("create_to_pointcloud2_msg",
+             [](const geometry::PointCloud &pointcloud,
+                const io::PointCloud2MsgInfo &info) {
+                 std::string data(info.GetSize(), '\0');
+                 if (!io::CreateToPointCloud2Msg((uint8_t *)&data[0], info,
+                                                 pointcloud)) {
+                     throw std::runtime_error(
+                             "Failed to convert PointCloud to message.");
+                 }
+                 return py::bytes(data);
+             },
+             "Function to pack PointCloud into the data of a "
+             "sensor_msgs/PointCloud2 message",
+             "pointcloud"_a, "info"_a);
+    m_io.def("create_from_image_msg",
+             [](py::buffer data, const io::ImageMsgInfo &info) {
+                 return io::CreateFromImageMsg(
+                         GetBufferData(data, info.GetSize()), info);
+             },
+             "Function to create Image from the data of a sensor_msgs/Image "
+             "message",
+             "data"_a, "info"_a);
+    m_io.def("create_to_image_msg",
+             [](const geometry::Image &image, const io::ImageMsgInfo &info) {
+                 std::string data(info.GetSize(), '\0');
+                 if (!io::CreateToImageMsg((uint8_t *)&data[0], info, image)) {
+                     throw std::runtime_error(
+                             "Failed to convert Image to message.");
+                 }
+                 return py::bytes(data);
+             },
+             "Function to copy Image into the data of a sensor_msgs/Image "
+             "message",
+             "image"_a, "info"_a);
+}
@@ -0,0 +1,107 @@
+#include "cupoch/localization/monte_carlo_localization.h"
+#include "cupoch/geometry/distancetransform.h"
+
+#include "cupoch_pybind/device_vector_wrapper.h"
+#include "cupoch_pybind/docstring.h"
+#include "cupoch_pybind/localization/localization.h"
+
+using namespace cupoch;
+
+void pybind_localization_classes(py::module &m) {
+    // cupoch.localization.MonteCarloLocalizationOption
+    py::class_<localization::MonteCarloLocalizationOption> mcl_option(
+            m, "MonteCarloLocalizationOption",
+            "Class that defines Monte Carlo localization options.");
+    mcl_option
+            .def(py::init<float, float, float, const Eigen::Vector4f_u &, int,
+                          int, float, float, float, float>(),
+                 "sigma_hit"_a = 0.2, "z_hit"_a = 0.95, "z_rand"_a = 0.05,
+                 "motion_noise"_a = Eigen::Vector4f_u(0.2, 0.2, 0.2, 0.2),
+                 "min_particles"_a = 100, "max_particles"_a = 10000,
+                 "kld_error"_a = 0.05, "kld_z"_a = 2.33,
+                 "kld_bin_size_xy"_a = 0.5, "kld_bin_size_yaw"_a = 0.1745)
+            .def_readwrite("sigma_hit",
+                           &localization::MonteCarloLocalizationOption::
+                                   sigma_hit_,
+                           "Standard deviation of the distance of a beam end "
+                           "to the nearest obstacle.")
+            .def_readwrite("z_hit",
+                           &localization::MonteCarloLocalizationOption::z_hit_,
+                           "Weight of the hit term of the likelihood field.")
+            .def_readwrite("z_rand",
+                           &localization::MonteCarloLocalizationOption::z_rand_,
+                           "Weight of the random term of the likelihood field.")
+            .def_readwrite("motion_noise",
+                           &localization::MonteCarloLocalizationOption::
+                                   motion_noise_,
+                           "Noise alpha1 to alpha4 of the odometry motion "
+                           "model.")
+            .def_readwrite("min_particles",
+                           &localization::MonteCarloLocalizationOption::
+                                   min_particles_)
+            .def_readwrite("max_particles",
+                           &localization::MonteCarloLocalizationOption::
+                                   max_particles_)
+            .def_readwrite("kld_error",
+                           &localization::MonteCarloLocalizationOption::
+                                   kld_error_)
+            .def_readwrite("kld_z",
+                           &localization::MonteCarloLocalizationOption::kld_z_)
+            .def_readwrite("kld_bin_size_xy",
+                           &localization::MonteCarloLocalizationOption::
+                                   kld_bin_size_xy_)
+            .def_readwrite("kld_bin_size_yaw",
+                           &localization::MonteCarloLocalizationOption::
+                                   kld_bin_size_yaw_);
+
+    // cupoch.localization.MonteCarloLocalization
+    py::class_<localization::MonteCarloLocalization> mcl(
+            m, "MonteCarloLocalization",
+            "Particle filter localization of a planar robot on the distance "
+            "field of a map.");
+    mcl.def(py::init<const std::shared_ptr<geometry::DistanceTransform> &,
+                     const localization::MonteCarloLocalizationOption &,
+                     unsigned int>(),
+            "map"_a,
+            "option"_a = localization::MonteCarloLocalizationOption(),
+            "seed"_a = 0)
+            .def("initialize",
+                 &localization::MonteCarloLocalization::Initialize,
+                 "Draws the particles around the pose (x, y, yaw).", "mean"_a,
+                 "stddev"_a, "num_particles"_a)
+            .def("predict", &localization::MonteCarloLocalization::Predict,
+                 "Moves the particles by the odometry motion (dx, dy, dyaw).",
+                 "delta"_a)
+            .def("update",
+                 [](localization::MonteCarloLocalization &self,
+                    const wrapper::device_vector_vector3f &scan) {
+                     self.Update(scan.data_);
+                 },
+                 "Weights the particles by the likelihood of the beam ends.",
+                 "scan"_a)
+            .def("resample", &localization::MonteCarloLocalization::Resample,
+                 "Draws the next particles by KLD and low variance "
+                 "resampling.")
+            .def("get_mean_pose",
+                 &localization::MonteCarloLocalization::GetMeanPose)
+            .def("get_effective_sample_size",
+                 &localization::MonteCarloLocalization::GetEffectiveSampleSize)
+            .def("get_num_particles",
+                 &localization::MonteCarloLocalization::GetNumParticles)
+            .def_property_readonly(
+                    "particles",
+                    [](const localization::MonteCarloLocalization &self) {
+                        return wrapper::device_vector_vector3f(
+                                self.particles_);
+                    })
+            .def_property_readonly(
+                    "weights",
+                    [](const localization::MonteCarloLocalization &self) {
+                        return wrapper::device_vector_float(self.weights_);
+                    });
+}
+
+void pybind_localization(py::module &m) {
+    py::module m_submodule = m.def_submodule("localization");
+    pybind_localization_classes(m_submodule);
+}
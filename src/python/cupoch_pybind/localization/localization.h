@@ -0,0 +1,5 @@
+#pragma once
+
+#include "cupoch_pybind/cupoch_pybind.h"
+
+void pybind_localization(py::module &m);
@@ -145,6 +145,26 @@ Anonymous submission.)");
             [](const odometry::RGBDOdometryJacobianFromHybridTerm &te) {
                 return std::string("RGBDOdometryJacobianFromHybridTerm");
             });
+
+    // cupoch.odometry.RGBDOdometryTracker
+    py::class_<odometry::RGBDOdometryTracker> tracker(
+            m, "RGBDOdometryTracker",
+            "Frame to frame RGB-D odometry that keeps the preprocessed "
+            "previous frame.");
+    tracker.def(py::init<const camera::PinholeCameraIntrinsic &,
+                         const odometry::RGBDOdometryJacobian &,
+                         const odometry::OdometryOption &>(),
+                "pinhole_camera_intrinsic"_a,
+                "jacobian"_a = odometry::RGBDOdometryJacobianFromHybridTerm(),
+                "option"_a = odometry::OdometryOption())
+            .def("track", &odometry::RGBDOdometryTracker::Track,
+                 "Estimates the motion from ``frame`` to the previous frame. "
+                 "Output: (is_success, 4x4 motion matrix, 6x6 information "
+                 "matrix).",
+                 "frame"_a, "odo_init"_a = Eigen::Matrix4f::Identity())
+            .def("has_previous_frame",
+                 &odometry::RGBDOdometryTracker::HasPreviousFrame)
+            .def("reset", &odometry::RGBDOdometryTracker::Reset);
 }
 
 void pybind_odometry_methods(py::module &m) {
@@ -165,6 +185,53 @@ void pybind_odometry_methods(py::module &m) {
           "prev_twist"_a = Eigen::Vector6f::Zero(),
           "jacobian"_a = odometry::RGBDOdometryJacobianFromHybridTerm(),
           "option"_a = odometry::OdometryOption());
+    m.def("compute_depth_icp_odometry",
+          py::overload_cast<const geometry::Image &, const geometry::Image &,
+                            const camera::PinholeCameraIntrinsic &,
+                            const Eigen::Matrix4f &,
+                            const odometry::OdometryOption &>(
+                  &odometry::ComputeDepthICPOdometry),
+          "Function to estimate 6D rigid motion from two depth images with "
+          "projective point-to-plane ICP. "
+          "Output: (is_success, 4x4 motion matrix, 6x6 information matrix).",
+          "depth_source"_a, "depth_target"_a,
+          "pinhole_camera_intrinsic"_a = camera::PinholeCameraIntrinsic(),
+          "odo_init"_a = Eigen::Matrix4f::Identity(),
+          "option"_a = odometry::OdometryOption());
+    m.def("compute_depth_icp_odometry",
+          py::overload_cast<const geometry::Image &, const geometry::Image &,
+                            const geometry::Image &,
+                            const camera::PinholeCameraIntrinsic &,
+                            const Eigen::Matrix4f &,
+                            const odometry::OdometryOption &>(
+                  &odometry::ComputeDepthICPOdometry),
+          "Function to estimate 6D rigid motion from a depth image to the "
+          "vertex and normal maps of a model, such as the ones of "
+          "UniformTSDFVolume.raycast. "
+          "Output: (is_success, 4x4 motion matrix, 6x6 information matrix).",
+          "depth_source"_a, "target_vertex_map"_a, "target_normal_map"_a,
+          "pinhole_camera_intrinsic"_a = camera::PinholeCameraIntrinsic(),
+          "odo_init"_a = Eigen::Matrix4f::Identity(),
+          "option"_a = odometry::OdometryOption());
+    m.def("compute_rgbd_odometry_batch", &odometry::ComputeRGBDOdometryBatch,
+          "Function to estimate the 6D rigid motions of several independent "
+          "RGBD image pairs in the same launches. "
+          "Output: list of (is_success, 4x4 motion matrix, 6x6 information "
+          "matrix).",
+          "rgbd_sources"_a, "rgbd_targets"_a, "pinhole_camera_intrinsics"_a,
+          "odo_inits"_a = std::vector<Eigen::Matrix4f_u>(),
+          "jacobian"_a = odometry::RGBDOdometryJacobianFromHybridTerm(),
+          "option"_a = odometry::OdometryOption());
+    m.def("compute_multi_camera_rgbd_odometry",
+          &odometry::ComputeMultiCameraRGBDOdometry,
+          "Function to estimate the 6D rigid motion of a rig of rigidly "
+          "coupled RGBD cameras. "
+          "Output: (is_success, 4x4 rig motion matrix, 6x6 information "
+          "matrix).",
+          "rgbd_sources"_a, "rgbd_targets"_a, "pinhole_camera_intrinsics"_a,
+          "camera_to_rig"_a, "odo_init"_a = Eigen::Matrix4f::Identity(),
+          "jacobian"_a = odometry::RGBDOdometryJacobianFromHybridTerm(),
+          "option"_a = odometry::OdometryOption());
     docstring::FunctionDocInject(
             m, "compute_rgbd_odometry",
             {
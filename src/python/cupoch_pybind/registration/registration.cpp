@@ -1,8 +1,13 @@
 #include "cupoch_pybind/registration/registration.h"
 #include "cupoch/registration/registration.h"
 #include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/pointcloud_batch.h"
 #include "cupoch/registration/colored_icp.h"
+#include "cupoch/registration/global_optimization.h"
+#include "cupoch/registration/ndt.h"
+#include "cupoch/registration/pose_graph.h"
 #include "cupoch/utility/console.h"
+#include "cupoch_pybind/async_result.h"
 #include "cupoch_pybind/docstring.h"
 
 using namespace cupoch;
@@ -73,6 +78,31 @@ void pybind_registration_classes(py::module &m) {
                         c.max_iteration_);
             });
 
+    // cupoch.registration.RobustKernelType
+    py::enum_<registration::RobustKernelType> robust_kernel_type(
+            m, "RobustKernelType", py::arithmetic());
+    robust_kernel_type.value("L2", registration::RobustKernelType::L2)
+            .value("Huber", registration::RobustKernelType::Huber)
+            .value("Tukey", registration::RobustKernelType::Tukey)
+            .value("Cauchy", registration::RobustKernelType::Cauchy)
+            .export_values();
+
+    // cupoch.registration.RobustKernel
+    py::class_<registration::RobustKernel> robust_kernel(
+            m, "RobustKernel",
+            "Robust loss of the residuals, applied by iteratively "
+            "reweighted least squares.");
+    py::detail::bind_copy_functions<registration::RobustKernel>(
+            robust_kernel);
+    robust_kernel
+            .def(py::init<registration::RobustKernelType, float>(),
+                 "type"_a = registration::RobustKernelType::L2, "k"_a = 1.0)
+            .def("weight", &registration::RobustKernel::Weight, "residual"_a,
+                 "IRLS weight of the residual.")
+            .def_readwrite("type", &registration::RobustKernel::type_)
+            .def_readwrite("k", &registration::RobustKernel::k_,
+                           "Scale of the residuals.");
+
     // cupoch.registration.TransformationEstimation
     py::class_<
             registration::TransformationEstimation,
@@ -123,16 +153,53 @@ void pybind_registration_classes(py::module &m) {
             te_p2l(m, "TransformationEstimationPointToPlane",
                    "Class to estimate a transformation for point to plane "
                    "distance.");
-    py::detail::bind_default_constructor<
-            registration::TransformationEstimationPointToPlane>(te_p2l);
     py::detail::bind_copy_functions<
             registration::TransformationEstimationPointToPlane>(te_p2l);
+    te_p2l.def(py::init([](const registration::RobustKernel &kernel) {
+                   return new registration::
+                           TransformationEstimationPointToPlane(kernel);
+               }),
+               "kernel"_a = registration::RobustKernel())
+            .def_readwrite(
+                    "kernel",
+                    &registration::TransformationEstimationPointToPlane::kernel_,
+                    "Robust kernel of the residuals.");
     te_p2l.def(
             "__repr__",
             [](const registration::TransformationEstimationPointToPlane &te) {
                 return std::string("TransformationEstimationPointToPlane");
             });
 
+    // cupoch.registration.TransformationEstimationForGeneralizedICP:
+    // TransformationEstimation
+    py::class_<registration::TransformationEstimationForGeneralizedICP,
+               PyTransformationEstimation<
+                       registration::TransformationEstimationForGeneralizedICP>,
+               registration::TransformationEstimation>
+            te_gicp(m, "TransformationEstimationForGeneralizedICP",
+                    "Class to estimate a transformation for the plane to "
+                    "plane distance of Generalized ICP.");
+    py::detail::bind_copy_functions<
+            registration::TransformationEstimationForGeneralizedICP>(te_gicp);
+    te_gicp.def(py::init([](float epsilon) {
+                    return new registration::
+                            TransformationEstimationForGeneralizedICP(epsilon);
+                }),
+                "epsilon"_a = 1e-3)
+            .def_readwrite("epsilon",
+                           &registration::
+                                   TransformationEstimationForGeneralizedICP::
+                                           epsilon_,
+                           "Smallest eigenvalue of the plane covariances.")
+            .def("__repr__",
+                 [](const registration::
+                            TransformationEstimationForGeneralizedICP &te) {
+                     return std::string(
+                                    "TransformationEstimationForGeneralizedICP "
+                                    "with epsilon ") +
+                            std::to_string(te.epsilon_);
+                 });
+
     // cupoch.registration.RegistrationResult
     py::class_<registration::RegistrationResult> registration_result(
             m, "RegistrationResult",
@@ -171,6 +238,204 @@ void pybind_registration_classes(py::module &m) {
                        std::to_string(rr.correspondence_set_.size()) +
                        std::string("\nAccess transformation to get result.");
             });
+
+    // cupoch.registration.CorrespondenceRejection
+    py::class_<registration::CorrespondenceRejection> rejection(
+            m, "CorrespondenceRejection",
+            "Filters of the ICP correspondences applied on the device on top "
+            "of the max correspondence distance.");
+    py::detail::bind_copy_functions<registration::CorrespondenceRejection>(
+            rejection);
+    rejection
+            .def(py::init<float, float, bool, float>(),
+                 "max_normal_angle"_a = 0.0, "median_distance_factor"_a = 0.0,
+                 "one_to_one"_a = false, "trim_ratio"_a = 1.0)
+            .def_readwrite(
+                    "max_normal_angle",
+                    &registration::CorrespondenceRejection::max_normal_angle_,
+                    "Maximum angle in radians between the normals of a pair, "
+                    "0 to disable.")
+            .def_readwrite("median_distance_factor",
+                           &registration::CorrespondenceRejection::
+                                   median_distance_factor_,
+                           "Maximum distance of a pair relative to the median "
+                           "distance, 0 to disable.")
+            .def_readwrite("one_to_one",
+                           &registration::CorrespondenceRejection::one_to_one_,
+                           "Keeps only the closest source point of each "
+                           "target point.")
+            .def_readwrite("trim_ratio",
+                           &registration::CorrespondenceRejection::trim_ratio_,
+                           "Fraction of the closest pairs kept.");
+
+    // cupoch.registration.ICPRegistrator
+    py::class_<registration::ICPRegistrator> icp_registrator(
+            m, "ICPRegistrator",
+            "Stateful ICP that keeps the target point cloud, its KD-tree and "
+            "scratch buffers between registrations.");
+    icp_registrator
+            .def(py::init<float, const registration::ICPConvergenceCriteria &>(),
+                 "max_correspondence_distance"_a,
+                 "criteria"_a = registration::ICPConvergenceCriteria())
+            .def("set_target", &registration::ICPRegistrator::SetTarget,
+                 "Sets the target point cloud and builds its KD-tree.",
+                 "target"_a, "estimate_normals"_a = false)
+            .def("has_target", &registration::ICPRegistrator::HasTarget)
+            .def("register",
+                 (registration::RegistrationResult(
+                         registration::ICPRegistrator::*)(
+                         const geometry::PointCloud &, const Eigen::Matrix4f &,
+                         const registration::TransformationEstimation &)) &
+                         registration::ICPRegistrator::Register,
+                 "Registers ``source`` against the target.", "source"_a,
+                 "init"_a = Eigen::Matrix4f::Identity(),
+                 "estimation_method"_a =
+                         registration::TransformationEstimationPointToPoint())
+            .def_readwrite("max_correspondence_distance",
+                           &registration::ICPRegistrator::
+                                   max_correspondence_distance_)
+            .def_readwrite("criteria",
+                           &registration::ICPRegistrator::criteria_)
+            .def_readwrite("compute_correspondence_set",
+                           &registration::ICPRegistrator::
+                                   compute_correspondence_set_)
+            .def_readwrite("rejection",
+                           &registration::ICPRegistrator::rejection_);
+
+    // cupoch.registration.ColoredICPTarget
+    py::class_<registration::ColoredICPTarget> colored_icp_target(
+            m, "ColoredICPTarget",
+            "Target of colored ICP with its KD-tree and color gradients "
+            "computed once.");
+    colored_icp_target
+            .def(py::init<const geometry::PointCloud &,
+                          const geometry::KDTreeSearchParamHybrid &>(),
+                 "target"_a, "search_param"_a)
+            .def("get_point_cloud",
+                 &registration::ColoredICPTarget::GetPointCloud,
+                 py::return_value_policy::reference_internal);
+
+    // cupoch.registration.NDTMap
+    py::class_<registration::NDTMap> ndt_map(
+            m, "NDTMap",
+            "Normal distributions of a target point cloud over a voxel "
+            "grid, built once for NDT registration.");
+    ndt_map.def(py::init<const geometry::PointCloud &, float, int>(),
+                "target"_a, "resolution"_a, "min_points"_a = 6)
+            .def("get_num_distributions",
+                 &registration::NDTMap::GetNumDistributions)
+            .def_readonly("resolution", &registration::NDTMap::resolution_);
+
+    // cupoch.registration.PoseGraph
+    py::class_<registration::PoseGraphNode> pose_graph_node(
+            m, "PoseGraphNode", "Node of a pose graph.");
+    pose_graph_node
+            .def(py::init<const Eigen::Matrix4f &>(),
+                 "pose"_a = Eigen::Matrix4f::Identity())
+            .def_readwrite("pose", &registration::PoseGraphNode::pose_);
+    py::class_<registration::PoseGraphEdge> pose_graph_edge(
+            m, "PoseGraphEdge", "Edge of a pose graph.");
+    pose_graph_edge
+            .def(py::init<int, int, const Eigen::Matrix4f &,
+                          const Eigen::Matrix6f &, bool, float>(),
+                 "source_node_id"_a = -1, "target_node_id"_a = -1,
+                 "transformation"_a = Eigen::Matrix4f::Identity(),
+                 "information"_a = Eigen::Matrix6f::Identity(),
+                 "uncertain"_a = false, "confidence"_a = 1.0)
+            .def_readwrite("source_node_id",
+                           &registration::PoseGraphEdge::source_node_id_)
+            .def_readwrite("target_node_id",
+                           &registration::PoseGraphEdge::target_node_id_)
+            .def_readwrite("transformation",
+                           &registration::PoseGraphEdge::transformation_)
+            .def_readwrite("information",
+                           &registration::PoseGraphEdge::information_)
+            .def_readwrite("uncertain",
+                           &registration::PoseGraphEdge::uncertain_)
+            .def_readwrite("confidence",
+                           &registration::PoseGraphEdge::confidence_);
+    py::class_<registration::PoseGraph> pose_graph(
+            m, "PoseGraph",
+            "Graph of poses and pairwise constraints. ``nodes`` and "
+            "``edges`` are copied on access and must be assigned as a "
+            "whole.");
+    pose_graph.def(py::init<>())
+            .def_readwrite("nodes", &registration::PoseGraph::nodes_)
+            .def_readwrite("edges", &registration::PoseGraph::edges_);
+
+    // cupoch.registration.GlobalOptimizationMethod
+    py::class_<registration::GlobalOptimizationMethod>
+            global_optimization_method(m, "GlobalOptimizationMethod",
+                                       "Base class of the pose graph "
+                                       "solvers.");
+    py::class_<registration::GlobalOptimizationLevenbergMarquardt,
+               registration::GlobalOptimizationMethod>
+            global_optimization_lm(m, "GlobalOptimizationLevenbergMarquardt",
+                                   "Levenberg-Marquardt pose graph solver.");
+    global_optimization_lm.def(py::init<>());
+    py::class_<registration::GlobalOptimizationGaussNewton,
+               registration::GlobalOptimizationMethod>
+            global_optimization_gn(m, "GlobalOptimizationGaussNewton",
+                                   "Gauss-Newton pose graph solver.");
+    global_optimization_gn.def(py::init<>());
+
+    py::class_<registration::GlobalOptimizationConvergenceCriteria>
+            global_optimization_criteria(
+                    m, "GlobalOptimizationConvergenceCriteria",
+                    "Convergence criteria of GlobalOptimization.");
+    global_optimization_criteria
+            .def(py::init<int, float, float, float, float, int, int,
+                          float>(),
+                 "max_iteration"_a = 100, "min_relative_increment"_a = 1e-6,
+                 "min_relative_residual_increment"_a = 1e-6,
+                 "min_right_term"_a = 1e-6, "min_residual"_a = 1e-6,
+                 "max_iteration_lm"_a = 20, "max_iteration_pcg"_a = 200,
+                 "pcg_relative_tolerance"_a = 1e-6)
+            .def_readwrite("max_iteration",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   max_iteration_)
+            .def_readwrite("min_relative_increment",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   min_relative_increment_)
+            .def_readwrite("min_relative_residual_increment",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   min_relative_residual_increment_)
+            .def_readwrite("min_right_term",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   min_right_term_)
+            .def_readwrite("min_residual",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   min_residual_)
+            .def_readwrite("max_iteration_lm",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   max_iteration_lm_)
+            .def_readwrite("max_iteration_pcg",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   max_iteration_pcg_)
+            .def_readwrite("pcg_relative_tolerance",
+                           &registration::GlobalOptimizationConvergenceCriteria::
+                                   pcg_relative_tolerance_);
+
+    py::class_<registration::GlobalOptimizationOption>
+            global_optimization_option(m, "GlobalOptimizationOption",
+                                       "Options of GlobalOptimization.");
+    global_optimization_option
+            .def(py::init<float, float, float, int>(),
+                 "max_correspondence_distance"_a = 0.075,
+                 "edge_prune_threshold"_a = 0.25,
+                 "preference_loop_closure"_a = 1.0, "reference_node"_a = -1)
+            .def_readwrite("max_correspondence_distance",
+                           &registration::GlobalOptimizationOption::
+                                   max_correspondence_distance_)
+            .def_readwrite("edge_prune_threshold",
+                           &registration::GlobalOptimizationOption::
+                                   edge_prune_threshold_)
+            .def_readwrite("preference_loop_closure",
+                           &registration::GlobalOptimizationOption::
+                                   preference_loop_closure_)
+            .def_readwrite("reference_node",
+                           &registration::GlobalOptimizationOption::
+                                   reference_node_);
 }
 
 // Registration functions have similar arguments, sharing arg docstrings
@@ -188,11 +453,28 @@ static const std::unordered_map<std::string, std::string>
                 {"estimation_method",
                  "Estimation method. One of "
                  "(``registration::TransformationEstimationPointToPoint``, "
-                 "``registration::TransformationEstimationPointToPlane``)"},
+                 "``registration::TransformationEstimationPointToPlane``, "
+                 "``registration::TransformationEstimationForGeneralizedICP``)"},
                 {"init", "Initial transformation estimation"},
+                {"kernel", "Robust kernel of the residuals."},
                 {"lambda_geometric", "lambda_geometric value"},
                 {"max_correspondence_distance",
                  "Maximum correspondence points-pair distance."},
+                {"max_correspondence_distances",
+                 "Maximum correspondence points-pair distance of every "
+                 "level."},
+                {"voxel_sizes",
+                 "Decreasing voxel sizes of the levels, 0 keeps the full "
+                 "point clouds."},
+                {"criteria_list", "Convergence criteria of every level."},
+                {"sources", "The source point clouds of the pairs."},
+                {"targets", "The target point clouds of the pairs."},
+                {"inits",
+                 "Initial transformation of every pair, identities if "
+                 "empty."},
+                {"ctx",
+                 "``cupoch.utility.ExecutionContext`` whose stream runs the "
+                 "registration."},
                 {"option", "Registration option"},
                 {"ransac_n", "Fit ransac with ``ransac_n`` correspondences"},
                 {"source_feature", "Source point cloud feature."},
@@ -204,24 +486,207 @@ static const std::unordered_map<std::string, std::string>
                  "``target``"}};
 
 void pybind_registration_methods(py::module &m) {
-    m.def("registration_icp", &registration::RegistrationICP,
+    m.def("registration_icp",
+          (registration::RegistrationResult(*)(
+                  const geometry::PointCloud &, const geometry::PointCloud &,
+                  float, const Eigen::Matrix4f &,
+                  const registration::TransformationEstimation &,
+                  const registration::ICPConvergenceCriteria &)) &
+                  registration::RegistrationICP,
+          py::call_guard<py::gil_scoped_release>(),
           "Function for ICP registration", "source"_a, "target"_a,
           "max_correspondence_distance"_a,
           "init"_a = Eigen::Matrix4f::Identity(),
           "estimation_method"_a =
                   registration::TransformationEstimationPointToPoint(),
           "criteria"_a = registration::ICPConvergenceCriteria());
+    m.def("registration_icp",
+          (registration::RegistrationResult(*)(
+                  utility::ExecutionContext &, const geometry::PointCloud &,
+                  const geometry::PointCloud &, float, const Eigen::Matrix4f &,
+                  const registration::TransformationEstimation &,
+                  const registration::ICPConvergenceCriteria &)) &
+                  registration::RegistrationICP,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for ICP registration with the work enqueued on the "
+          "stream of ``ctx``",
+          "ctx"_a, "source"_a, "target"_a, "max_correspondence_distance"_a,
+          "init"_a = Eigen::Matrix4f::Identity(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint(),
+          "criteria"_a = registration::ICPConvergenceCriteria());
     docstring::FunctionDocInject(m, "registration_icp",
                                  map_shared_argument_docstrings);
 
-    m.def("registration_colored_icp", &registration::RegistrationColoredICP,
+    wrapper::pybind_async_result<registration::RegistrationResult>(
+            m, "RegistrationResultFuture");
+    m.def("registration_icp_async",
+          [](const geometry::PointCloud &source,
+             const geometry::PointCloud &target,
+             float max_correspondence_distance, const Eigen::Matrix4f &init,
+             const registration::TransformationEstimation &estimation,
+             const registration::ICPConvergenceCriteria &criteria) {
+              const Eigen::Matrix4f_u init_u = init;
+              return wrapper::RunAsync([&source, &target,
+                                        max_correspondence_distance, init_u,
+                                        &estimation, criteria]() {
+                  // A stream of its own, so that registrations running on
+                  // several futures overlap.
+                  utility::ExecutionContext ctx;
+                  return registration::RegistrationICP(
+                          ctx, source, target, max_correspondence_distance,
+                          init_u, estimation, criteria);
+              });
+          },
+          "Function for ICP registration on a worker thread, returning a "
+          "``RegistrationResultFuture``",
+          "source"_a, "target"_a, "max_correspondence_distance"_a,
+          "init"_a = Eigen::Matrix4f::Identity(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint(),
+          "criteria"_a = registration::ICPConvergenceCriteria(),
+          py::keep_alive<0, 1>(), py::keep_alive<0, 2>(),
+          py::keep_alive<0, 5>());
+    docstring::FunctionDocInject(m, "registration_icp_async",
+                                 map_shared_argument_docstrings);
+
+    m.def("registration_icp_on_device",
+          (registration::RegistrationResult(*)(
+                  const geometry::PointCloud &, const geometry::PointCloud &,
+                  float, const Eigen::Matrix4f &,
+                  const registration::TransformationEstimation &,
+                  const registration::ICPConvergenceCriteria &)) &
+                  registration::RegistrationICPOnDevice,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for ICP registration with the iteration loop kept on "
+          "the device",
+          "source"_a, "target"_a, "max_correspondence_distance"_a,
+          "init"_a = Eigen::Matrix4f::Identity(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint(),
+          "criteria"_a = registration::ICPConvergenceCriteria());
+    m.def("registration_icp_on_device",
+          (registration::RegistrationResult(*)(
+                  utility::ExecutionContext &, const geometry::PointCloud &,
+                  const geometry::PointCloud &, float, const Eigen::Matrix4f &,
+                  const registration::TransformationEstimation &,
+                  const registration::ICPConvergenceCriteria &)) &
+                  registration::RegistrationICPOnDevice,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for ICP registration with the iteration loop kept on "
+          "the device and enqueued on the stream of ``ctx``",
+          "ctx"_a, "source"_a, "target"_a, "max_correspondence_distance"_a,
+          "init"_a = Eigen::Matrix4f::Identity(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint(),
+          "criteria"_a = registration::ICPConvergenceCriteria());
+    docstring::FunctionDocInject(m, "registration_icp_on_device",
+                                 map_shared_argument_docstrings);
+
+    m.def("registration_multi_scale_icp",
+          (registration::RegistrationResult(*)(
+                  const geometry::PointCloud &, const geometry::PointCloud &,
+                  const std::vector<float> &,
+                  const std::vector<registration::ICPConvergenceCriteria> &,
+                  const std::vector<float> &, const Eigen::Matrix4f &,
+                  const registration::TransformationEstimation &)) &
+                  registration::RegistrationMultiScaleICP,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for coarse to fine ICP registration", "source"_a,
+          "target"_a, "voxel_sizes"_a, "criteria_list"_a,
+          "max_correspondence_distances"_a,
+          "init"_a = Eigen::Matrix4f::Identity(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint());
+    docstring::FunctionDocInject(m, "registration_multi_scale_icp",
+                                 map_shared_argument_docstrings);
+
+    m.def("registration_icp_batch",
+          (std::vector<registration::RegistrationResult>(*)(
+                  const std::vector<std::shared_ptr<geometry::PointCloud>> &,
+                  const std::vector<std::shared_ptr<geometry::PointCloud>> &,
+                  float, const std::vector<Eigen::Matrix4f_u> &,
+                  const registration::TransformationEstimation &,
+                  const registration::ICPConvergenceCriteria &)) &
+                  registration::RegistrationICPBatch,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for ICP registration of many pairs at once",
+          "sources"_a, "targets"_a, "max_correspondence_distance"_a,
+          "inits"_a = std::vector<Eigen::Matrix4f_u>(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint(),
+          "criteria"_a = registration::ICPConvergenceCriteria());
+    docstring::FunctionDocInject(m, "registration_icp_batch",
+                                 map_shared_argument_docstrings);
+    m.def("registration_icp_batch",
+          (std::vector<registration::RegistrationResult>(*)(
+                  const geometry::PointCloudBatch &,
+                  const geometry::PointCloudBatch &, float,
+                  const std::vector<Eigen::Matrix4f_u> &,
+                  const registration::TransformationEstimation &,
+                  const registration::ICPConvergenceCriteria &)) &
+                  registration::RegistrationICPBatch,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for ICP registration of the clouds of two batches",
+          "sources"_a, "targets"_a, "max_correspondence_distance"_a,
+          "inits"_a = std::vector<Eigen::Matrix4f_u>(),
+          "estimation_method"_a =
+                  registration::TransformationEstimationPointToPoint(),
+          "criteria"_a = registration::ICPConvergenceCriteria());
+
+    m.def("registration_colored_icp",
+          (registration::RegistrationResult(*)(
+                  const geometry::PointCloud &, const geometry::PointCloud &,
+                  float, const Eigen::Matrix4f &,
+                  const registration::ICPConvergenceCriteria &, float,
+                  const registration::RobustKernel &)) &
+                  registration::RegistrationColoredICP,
+          py::call_guard<py::gil_scoped_release>(),
           "Function for Colored ICP registration", "source"_a, "target"_a,
           "max_correspondence_distance"_a,
           "init"_a = Eigen::Matrix4f::Identity(),
           "criteria"_a = registration::ICPConvergenceCriteria(),
-          "lambda_geometric"_a = 0.968);
+          "lambda_geometric"_a = 0.968,
+          "kernel"_a = registration::RobustKernel());
+    m.def("registration_colored_icp",
+          (registration::RegistrationResult(*)(
+                  const geometry::PointCloud &,
+                  registration::ColoredICPTarget &, float,
+                  const Eigen::Matrix4f &,
+                  const registration::ICPConvergenceCriteria &, float,
+                  const registration::RobustKernel &)) &
+                  registration::RegistrationColoredICP,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for Colored ICP registration against a prepared target",
+          "source"_a, "target"_a, "max_correspondence_distance"_a,
+          "init"_a = Eigen::Matrix4f::Identity(),
+          "criteria"_a = registration::ICPConvergenceCriteria(),
+          "lambda_geometric"_a = 0.968,
+          "kernel"_a = registration::RobustKernel());
     docstring::FunctionDocInject(m, "registration_colored_icp",
                                  map_shared_argument_docstrings);
+    m.def("registration_ndt", &registration::RegistrationNDT,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function for point-to-distribution NDT registration", "source"_a,
+          "target"_a, "init"_a = Eigen::Matrix4f::Identity(),
+          "criteria"_a = registration::ICPConvergenceCriteria());
+    m.def("get_information_matrix_from_point_clouds",
+          &registration::GetInformationMatrixFromPointClouds,
+          "Function to compute the information matrix from the "
+          "correspondences of two aligned point clouds",
+          "source"_a, "target"_a, "max_correspondence_distance"_a,
+          "transformation"_a);
+    m.def("get_information_matrix_from_registration_result",
+          &registration::GetInformationMatrixFromRegistrationResult,
+          "Function to compute the information matrix from the "
+          "correspondence set of a registration result",
+          "target"_a, "result"_a);
+    m.def("global_optimization", &registration::GlobalOptimization,
+          py::call_guard<py::gil_scoped_release>(),
+          "Function to optimize a pose graph in place", "pose_graph"_a,
+          "method"_a = registration::GlobalOptimizationLevenbergMarquardt(),
+          "criteria"_a = registration::GlobalOptimizationConvergenceCriteria(),
+          "option"_a = registration::GlobalOptimizationOption());
 }
 
 void pybind_registration(py::module &m) {
@@ -73,6 +73,84 @@ py_array_to_vectors_int_eigen_allocator(
 
 namespace {
 
+/// Stream handles of the CUDA array interface, 1 and 2 being the legacy and
+/// the per-thread default streams.
+const uintptr_t LEGACY_DEFAULT_STREAM = 1;
+const uintptr_t PER_THREAD_DEFAULT_STREAM = 2;
+
+template <typename Scalar>
+std::string GetCudaTypeStr() {
+    const char kind = (std::is_floating_point<Scalar>::value) ? 'f'
+                      : (std::is_signed<Scalar>::value)       ? 'i'
+                                                              : 'u';
+    return std::string("<") + kind + std::to_string(sizeof(Scalar));
+}
+
+/// Version 3 of the CUDA array interface of \p v, a (n,) or (n, Dim) array
+/// of Scalar. cupoch enqueues its work, the copies into the wrappers
+/// included, on the per-thread default stream, which the consumers are
+/// asked to wait for.
+template <typename Type, typename Scalar, int Dim>
+py::dict GetCudaArrayInterface(
+        const cupoch::wrapper::device_vector_wrapper<Type> &v) {
+    py::dict interface;
+    interface["shape"] = (Dim == 1) ? py::make_tuple(v.size())
+                                    : py::make_tuple(v.size(), Dim);
+    interface["typestr"] = GetCudaTypeStr<Scalar>();
+    interface["data"] = py::make_tuple(
+            (uintptr_t)thrust::raw_pointer_cast(v.data_.data()), false);
+    interface["strides"] = py::none();
+    interface["stream"] = PER_THREAD_DEFAULT_STREAM;
+    interface["version"] = 3;
+    return interface;
+}
+
+/// Copies the device array exported by \p obj through the CUDA array
+/// interface, after the work of the stream it names.
+template <typename Type, typename Scalar, int Dim>
+cupoch::wrapper::device_vector_wrapper<Type> FromCudaArrayInterface(
+        py::object obj) {
+    if (!py::hasattr(obj, "__cuda_array_interface__")) {
+        throw py::type_error("The object has no __cuda_array_interface__.");
+    }
+    py::dict interface = obj.attr("__cuda_array_interface__");
+    py::tuple shape = interface["shape"];
+    const size_t n = (shape.size() > 0) ? shape[0].cast<size_t>() : 0;
+    if ((Dim == 1 && shape.size() != 1) ||
+        (Dim > 1 &&
+         (shape.size() != 2 || shape[1].cast<size_t>() != size_t(Dim)))) {
+        throw py::value_error("Invalid shape of the CUDA array.");
+    }
+    if (interface["typestr"].cast<std::string>() != GetCudaTypeStr<Scalar>()) {
+        throw py::value_error("Invalid data type of the CUDA array.");
+    }
+    if (interface.contains("strides") && !interface["strides"].is_none()) {
+        py::tuple strides = interface["strides"];
+        const bool contiguous =
+                n <= 1 || strides[0].cast<size_t>() == Dim * sizeof(Scalar);
+        if (!contiguous ||
+            (Dim > 1 && strides[1].cast<size_t>() != sizeof(Scalar))) {
+            throw py::value_error("The CUDA array must be contiguous.");
+        }
+    }
+    if (interface.contains("mask") && !interface["mask"].is_none()) {
+        throw py::value_error("Masked CUDA arrays are not supported.");
+    }
+    const uintptr_t data = interface["data"].cast<py::tuple>()[0]
+                                   .cast<uintptr_t>();
+    cudaStream_t stream = 0;
+    if (interface.contains("stream") && !interface["stream"].is_none()) {
+        const uintptr_t handle = interface["stream"].cast<uintptr_t>();
+        stream = (handle == LEGACY_DEFAULT_STREAM) ? cudaStreamLegacy
+                 : (handle == PER_THREAD_DEFAULT_STREAM)
+                         ? cudaStreamPerThread
+                         : (cudaStream_t)handle;
+    }
+    cupoch::wrapper::device_vector_wrapper<Type> vec;
+    vec.CopyFromDevice((const Type *)data, n, stream);
+    return vec;
+}
+
 template <typename Scalar,
           typename Vector = cupoch::wrapper::device_vector_wrapper<Scalar>,
           typename holder_type = std::unique_ptr<Vector>>
@@ -80,6 +158,11 @@ py::class_<Vector, holder_type> pybind_eigen_vector_of_scalar(
         py::module &m, const std::string &bind_name) {
     auto vec = py::bind_vector_without_repr<cupoch::wrapper::device_vector_wrapper<Scalar>>(m, bind_name, py::module_local());
     vec.def("cpu", &cupoch::wrapper::device_vector_wrapper<Scalar>::cpu);
+    vec.def(py::init(&FromCudaArrayInterface<Scalar, Scalar, 1>),
+            "Copy an array exposing ``__cuda_array_interface__``",
+            "array"_a);
+    vec.def_property_readonly("__cuda_array_interface__",
+                              &GetCudaArrayInterface<Scalar, Scalar, 1>);
     vec.def("__iadd__", [] (cupoch::wrapper::device_vector_wrapper<Scalar>& self, const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& other) {
             thrust::host_vector<Scalar> hso(other.data(), other.data() + other.rows());
             self += hso;
@@ -105,7 +188,22 @@ py::class_<Vector, holder_type> pybind_eigen_vector_of_vector(
     typedef typename EigenVector::Scalar Scalar;
     auto vec = py::bind_vector_without_repr<cupoch::wrapper::device_vector_wrapper<EigenVector>>(
             m, bind_name, py::module_local());
-    vec.def(py::init(init_func));
+    // A single constructor, so that the device arrays are not converted
+    // through numpy.
+    vec.def(py::init([init_func](py::object array) {
+        if (py::hasattr(array, "__cuda_array_interface__")) {
+            return FromCudaArrayInterface<EigenVector, Scalar,
+                                          EigenVector::RowsAtCompileTime>(
+                    array);
+        }
+        return init_func(array.cast<py::array_t<
+                                 Scalar, py::array::c_style |
+                                                 py::array::forcecast>>());
+    }));
+    vec.def_property_readonly(
+            "__cuda_array_interface__",
+            &GetCudaArrayInterface<EigenVector, Scalar,
+                                   EigenVector::RowsAtCompileTime>);
     vec.def("__repr__", [repr_name](const cupoch::wrapper::device_vector_wrapper<EigenVector> &v) {
         return repr_name + std::string(" with ") + std::to_string(v.size()) +
                std::string(" elements.\n") +
@@ -1,7 +1,346 @@
 #include "cupoch_pybind/utility/utility.h"
 
+#include "cupoch/utility/execution_context.h"
+#include "cupoch/utility/launch_tuner.h"
+#include "cupoch/utility/memory_resource.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "cupoch/utility/pipeline_executor.h"
+#include "cupoch/utility/platform.h"
+#include "cupoch/utility/profiler.h"
+#include "cupoch/utility/warm_up.h"
+#include "cupoch_pybind/async_result.h"
+#include "cupoch_pybind/docstring.h"
+
+using namespace cupoch;
+
 void pybind_utility(py::module &m) {
     py::module m_submodule = m.def_submodule("utility");
     pybind_console(m_submodule);
     pybind_eigen(m_submodule);
+
+    // Registered after their base, so that OutOfMemoryError is matched first.
+    auto &cuda_error = py::register_exception<utility::CudaError>(
+            m_submodule, "CudaError", PyExc_RuntimeError);
+    py::register_exception<utility::OutOfMemoryError>(
+            m_submodule, "OutOfMemoryError", cuda_error.ptr());
+
+    m_submodule.def("set_per_thread_streams", &utility::SetPerThreadStreams,
+                    "Give each host thread its own set of CUDA streams",
+                    "enable"_a);
+    docstring::FunctionDocInject(
+            m_submodule, "set_per_thread_streams",
+            {{"enable",
+              "If ``True``, host threads stop sharing streams and only "
+              "wait for their own work."}});
+    m_submodule.def("is_per_thread_streams", &utility::IsPerThreadStreams,
+                    "Returns ``True`` if each host thread has its own set of "
+                    "CUDA streams");
+    m_submodule.def("set_deterministic_mode", &utility::SetDeterministicMode,
+                    "Force the deterministic variants of the algorithms that "
+                    "also have a faster one accumulating with atomics",
+                    "enable"_a);
+    m_submodule.def("is_deterministic_mode", &utility::IsDeterministicMode,
+                    "Returns ``True`` if the deterministic variants are "
+                    "forced");
+
+    m_submodule.def("enable_profiling", &utility::EnableProfiling,
+                    "Turn the profiler of the operations on or off",
+                    "enable"_a);
+    m_submodule.def("is_profiling_enabled", &utility::IsProfilingEnabled,
+                    "Returns ``True`` if the operations are profiled");
+    m_submodule.def("reset_profile", &utility::ResetProfile,
+                    "Discard the timings collected so far",
+                    py::call_guard<py::gil_scoped_release>());
+    m_submodule.def(
+            "get_profile_stats",
+            []() {
+                py::list stats;
+                for (const auto &stat : utility::GetProfileStats()) {
+                    py::dict d;
+                    d["name"] = stat.name_;
+                    d["count"] = stat.count_;
+                    d["total_ms"] = stat.total_ms_;
+                    d["mean_ms"] = stat.mean_ms_;
+                    d["p99_ms"] = stat.p99_ms_;
+                    d["max_ms"] = stat.max_ms_;
+                    stats.append(d);
+                }
+                return stats;
+            },
+            "Statistics of the profiled operations, as dicts of their name, "
+            "count, total_ms, mean_ms, p99_ms and max_ms");
+    m_submodule.def("get_profile_report", &utility::GetProfileReport,
+                    "Table of the GPU time of the profiled operations",
+                    py::call_guard<py::gil_scoped_release>());
+
+    py::enum_<utility::MemorySubsystem>(m_submodule, "MemorySubsystem",
+                                        "Subsystems the device memory is "
+                                        "attributed to.")
+            .value("Other", utility::MemorySubsystem::Other)
+            .value("PointCloud", utility::MemorySubsystem::PointCloud)
+            .value("KDTree", utility::MemorySubsystem::KDTree)
+            .value("TSDF", utility::MemorySubsystem::TSDF)
+            .value("Occupancy", utility::MemorySubsystem::Occupancy)
+            .value("Visualizer", utility::MemorySubsystem::Visualizer)
+            .export_values();
+    m_submodule.def("enable_memory_tracking", &utility::EnableMemoryTracking,
+                    "Turn the accounting of the device memory per subsystem "
+                    "on or off",
+                    "enable"_a);
+    m_submodule.def("is_memory_tracking_enabled",
+                    &utility::IsMemoryTrackingEnabled,
+                    "Returns ``True`` if the device memory is accounted");
+    m_submodule.def(
+            "get_memory_usage",
+            []() {
+                py::dict usages;
+                for (const auto &usage : utility::GetMemoryUsage()) {
+                    py::dict d;
+                    d["live_bytes"] = usage.live_bytes_;
+                    d["peak_bytes"] = usage.peak_bytes_;
+                    d["num_allocations"] = usage.num_allocations_;
+                    usages[py::str(usage.subsystem_)] = d;
+                }
+                return usages;
+            },
+            "Live and peak device memory of every subsystem and of the "
+            "total, keyed by their name");
+    m_submodule.def("reset_peak_memory_usage", &utility::ResetPeakMemoryUsage,
+                    "Set the peak usages to the live ones");
+    m_submodule.def("get_memory_report", &utility::GetMemoryReport,
+                    "Table of the live and peak device memory per subsystem");
+
+    m_submodule.def("enable_launch_tuning", &utility::EnableLaunchTuning,
+                    "Turn the autotuning of the launch configurations of the "
+                    "kernels on or off",
+                    "enable"_a);
+    m_submodule.def("is_launch_tuning_enabled",
+                    &utility::IsLaunchTuningEnabled,
+                    "Returns ``True`` if the launch configurations are tuned");
+    m_submodule.def("set_launch_tuning_cache_file",
+                    &utility::SetLaunchTuningCacheFile,
+                    "Set the file the tuned launch configurations are cached "
+                    "in, an empty name keeps them in memory only",
+                    "filename"_a);
+    m_submodule.def("get_launch_tuning_cache_file",
+                    &utility::GetLaunchTuningCacheFile,
+                    "File the tuned launch configurations are cached in");
+    m_submodule.def("reset_launch_tuning", &utility::ResetLaunchTuning,
+                    "Forget the tuned launch configurations");
+
+    py::class_<utility::MemoryResource,
+               std::shared_ptr<utility::MemoryResource>>(
+            m_submodule, "MemoryResource",
+            "Source of the device memory of the cupoch arrays.");
+    py::class_<utility::CudaMemoryResource,
+               std::shared_ptr<utility::CudaMemoryResource>,
+               utility::MemoryResource>(m_submodule, "CudaMemoryResource",
+                                        "cudaMalloc and cudaFree.")
+            .def(py::init<>());
+    py::class_<utility::CudaAsyncMemoryResource,
+               std::shared_ptr<utility::CudaAsyncMemoryResource>,
+               utility::MemoryResource>(
+            m_submodule, "CudaAsyncMemoryResource",
+            "Stream ordered pool of cudaMallocAsync, requires CUDA 11.2.")
+            .def(py::init<size_t, size_t>(), "initial_pool_size"_a = 0,
+                 "release_threshold"_a = ~size_t(0));
+    py::class_<utility::MappedHostMemoryResource,
+               std::shared_ptr<utility::MappedHostMemoryResource>,
+               utility::MemoryResource>(
+            m_submodule, "MappedHostMemoryResource",
+            "Pinned host memory mapped for the device, shared without copies "
+            "on integrated GPUs.")
+            .def(py::init<bool>(), "write_combined"_a = false);
+    py::class_<utility::ManagedMemoryResource,
+               std::shared_ptr<utility::ManagedMemoryResource>,
+               utility::MemoryResource>(m_submodule, "ManagedMemoryResource",
+                                        "cudaMallocManaged memory.")
+            .def(py::init<>());
+    py::class_<utility::PerStreamMemoryResource,
+               std::shared_ptr<utility::PerStreamMemoryResource>,
+               utility::MemoryResource>(
+            m_submodule, "PerStreamMemoryResource",
+            "One resource per allocation stream, created by ``factory``.")
+            .def(py::init([](py::function factory) {
+                     return std::make_shared<utility::PerStreamMemoryResource>(
+                             [factory]() {
+                                 py::gil_scoped_acquire gil;
+                                 return factory()
+                                         .cast<std::shared_ptr<
+                                                 utility::MemoryResource>>();
+                             });
+                 }),
+                 "factory"_a);
+    py::class_<utility::BinningMemoryResource,
+               std::shared_ptr<utility::BinningMemoryResource>,
+               utility::MemoryResource>(
+            m_submodule, "BinningMemoryResource",
+            "Power of 2 bins for the small allocations, carved from chunks "
+            "of ``upstream``.")
+            .def(py::init<const std::shared_ptr<utility::MemoryResource> &,
+                          size_t, size_t>(),
+                 "upstream"_a, "max_bin_bytes"_a = 1 << 20,
+                 "chunk_bytes"_a = 1 << 24);
+    py::class_<utility::LimitingMemoryResource,
+               std::shared_ptr<utility::LimitingMemoryResource>,
+               utility::MemoryResource>(
+            m_submodule, "LimitingMemoryResource",
+            "Fails the allocations of ``upstream`` above ``limit_bytes``.")
+            .def(py::init<const std::shared_ptr<utility::MemoryResource> &,
+                          size_t>(),
+                 "upstream"_a, "limit_bytes"_a)
+            .def_property_readonly(
+                    "allocated_bytes",
+                    &utility::LimitingMemoryResource::GetAllocatedBytes)
+            .def_property_readonly("limit",
+                                   &utility::LimitingMemoryResource::GetLimit);
+    m_submodule.def("set_memory_resource", &utility::SetMemoryResource,
+                    "Set the resource of the arrays created from now on",
+                    "resource"_a);
+    m_submodule.def("enable_zero_copy_memory", &utility::EnableZeroCopyMemory,
+                    "Allocate the arrays created from now on in mapped host "
+                    "memory if the device is integrated",
+                    "write_combined"_a = false);
+    m_submodule.def("set_volume_memory_resource",
+                    &utility::SetVolumeMemoryResource,
+                    "Set the resource of the voxels of the dense volumes "
+                    "created from now on, None for the resource of the arrays",
+                    "resource"_a);
+    m_submodule.def("enable_volume_oversubscription",
+                    &utility::EnableVolumeOversubscription,
+                    "Back the dense volumes created from now on by managed "
+                    "memory, so that they can exceed the device memory",
+                    "enable"_a = true);
+    m_submodule.def("is_integrated_device", &utility::IsIntegratedDevice,
+                    "True if the device shares the memory of the host");
+
+    py::class_<utility::WarmUpConfig>(
+            m_submodule, "WarmUpConfig",
+            "What ``warm_up`` prepares before the first frame of a real-time "
+            "loop.")
+            .def(py::init<>())
+            .def_readwrite("num_streams", &utility::WarmUpConfig::num_streams_,
+                           "Number of streams created.")
+            .def_readwrite("pool_bytes", &utility::WarmUpConfig::pool_bytes_,
+                           "Bytes allocated and freed on each stream to grow "
+                           "the pools of the memory resource.")
+            .def_readwrite("eager_module_loading",
+                           &utility::WarmUpConfig::eager_module_loading_,
+                           "Load all the kernels when the context is "
+                           "created.")
+            .def_readwrite("load_launch_tuning_cache",
+                           &utility::WarmUpConfig::load_launch_tuning_cache_,
+                           "Read the launch tuning cache file now.")
+            .def_readwrite("tasks", &utility::WarmUpConfig::tasks_,
+                           "Callables run once the streams and the pools "
+                           "are ready.");
+    m_submodule.def("warm_up", &utility::WarmUp,
+                    "Create the CUDA context, the streams and the pools and "
+                    "run the warm-up tasks before the first frame",
+                    "config"_a = utility::WarmUpConfig());
+
+    wrapper::pybind_async_result<bool>(m_submodule, "BoolFuture");
+
+    py::class_<utility::ExecutionContext> context(
+            m_submodule, "ExecutionContext",
+            "CUDA stream on which the functions taking a ``ctx`` enqueue "
+            "their work. Wrapping the stream of CuPy, Numba or PyTorch, e.g. "
+            "``cupy.cuda.get_current_stream().ptr`` or "
+            "``torch.cuda.current_stream().cuda_stream``, orders cupoch "
+            "with their work without synchronizing the host.");
+    context.def(py::init<>(), "Create a context owning a new stream")
+            .def(py::init([](uintptr_t stream) {
+                     return new utility::ExecutionContext(
+                             (cudaStream_t)stream);
+                 }),
+                 "Wrap an existing stream, which the context does not "
+                 "destroy",
+                 "stream"_a)
+            .def_property_readonly(
+                    "stream",
+                    [](const utility::ExecutionContext &ctx) {
+                        return (uintptr_t)ctx.GetStream();
+                    },
+                    "Handle of the CUDA stream.")
+            .def("synchronize", &utility::ExecutionContext::Synchronize,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Block until the work queued on the stream is done.")
+            .def("wait_for", &utility::ExecutionContext::WaitFor,
+                 "Make the stream wait for the work already queued on "
+                 "another context, without blocking the host.",
+                 "other"_a)
+            .def_property(
+                    "deterministic",
+                    &utility::ExecutionContext::IsDeterministic,
+                    &utility::ExecutionContext::SetDeterministic,
+                    "Force the deterministic variants of the algorithms run "
+                    "with this context.");
+
+    py::class_<utility::PipelineStageStats>(
+            m_submodule, "PipelineStageStats",
+            "Latency of a stage of a PipelineExecutor in milliseconds.")
+            .def_readonly("name", &utility::PipelineStageStats::name_)
+            .def_readonly("count", &utility::PipelineStageStats::count_)
+            .def_readonly("mean_host_ms",
+                          &utility::PipelineStageStats::mean_host_ms_)
+            .def_readonly("mean_device_ms",
+                          &utility::PipelineStageStats::mean_device_ms_)
+            .def_readonly("max_device_ms",
+                          &utility::PipelineStageStats::max_device_ms_);
+    py::class_<utility::PipelineExecutor>(
+            m_submodule, "PipelineExecutor",
+            "Runs the stages of a per-frame processing graph on their own "
+            "threads and streams, overlapping the independent stages and "
+            "pipelining the consecutive frames. Call ``wait_all`` before "
+            "dropping it, the stages need the GIL to finish.")
+            .def(py::init<size_t>(), "max_frames_in_flight"_a = 2)
+            .def(
+                    "add_stage",
+                    [](utility::PipelineExecutor &executor,
+                       const std::string &name, py::function function,
+                       const std::vector<int> &dependencies) {
+                        // Called from the stage threads, which hold the
+                        // GIL only while in Python, so the function is
+                        // also released under the GIL.
+                        std::shared_ptr<py::function> holder(
+                                new py::function(function),
+                                [](py::function *f) {
+                                    py::gil_scoped_acquire acquire;
+                                    delete f;
+                                });
+                        auto stage = [holder](utility::ExecutionContext &ctx,
+                                              size_t frame) {
+                            py::gil_scoped_acquire acquire;
+                            (*holder)(py::cast(&ctx,
+                                               py::return_value_policy::
+                                                       reference),
+                                      frame);
+                        };
+                        return executor.AddStage(name, stage, dependencies);
+                    },
+                    "Add a stage called with its ExecutionContext and the "
+                    "frame number after the stages ``dependencies``, and "
+                    "return its id.",
+                    "name"_a, "function"_a,
+                    "dependencies"_a = std::vector<int>())
+            .def("submit", &utility::PipelineExecutor::Submit,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Start the processing of the next frame and return its "
+                 "number.")
+            .def("wait", &utility::PipelineExecutor::Wait,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Block until the frame is done.", "frame"_a)
+            .def("wait_all", &utility::PipelineExecutor::WaitAll,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Block until all the submitted frames are done.")
+            .def_property_readonly(
+                    "max_frames_in_flight",
+                    &utility::PipelineExecutor::GetMaxFramesInFlight)
+            .def("get_stage_stats", &utility::PipelineExecutor::GetStageStats,
+                 "Latencies of the stages over the frames done so far.")
+            .def("get_stage_report",
+                 &utility::PipelineExecutor::GetStageReport,
+                 "Table of the latencies of the stages.")
+            .def("reset_stage_stats",
+                 &utility::PipelineExecutor::ResetStageStats);
 }
\ No newline at end of file
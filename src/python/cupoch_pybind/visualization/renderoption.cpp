@@ -51,6 +51,14 @@ void pybind_renderoption(py::module &m) {
             .def_readwrite("point_show_normal",
                            &visualization::RenderOption::point_show_normal_,
                            "bool: Whether to show normal for ``PointCloud``.")
+            .def_readwrite("point_lod", &visualization::RenderOption::point_lod_,
+                           "bool: Whether to draw ``PointCloud`` at a level "
+                           "of detail chosen per frame.")
+            .def_readwrite(
+                    "point_lod_pixel_error",
+                    &visualization::RenderOption::point_lod_pixel_error_,
+                    "float: Size in pixels of the cells drawn as one point "
+                    "at the level of detail.")
             .def_readwrite("show_coordinate_frame",
                            &visualization::RenderOption::show_coordinate_frame_,
                            "bool: Whether to show coordinate frame.")
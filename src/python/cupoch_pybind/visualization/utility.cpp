@@ -1,5 +1,7 @@
 #include "cupoch/geometry/pointcloud.h"
 #include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/integration/uniform_tsdfvolume.h"
 #include "cupoch/io/class_io/ijson_convertible_io.h"
 #include "cupoch/utility/filesystem.h"
 #include "cupoch/visualization/utility/draw_geometry.h"
@@ -20,9 +22,12 @@ static const std::unordered_map<std::string, std::string>
                 {"height", "The height of the visualization window."},
                 {"key_to_callback", "Map of key to call back functions."},
                 {"left", "The left margin of the visualization window."},
+                {"max_depth", "Length of the rays."},
                 {"optional_view_trajectory_json_file",
                  "Camera trajectory json file path for custom animation."},
+                {"show_depth", "Show the raycast depth instead of the color."},
                 {"top", "The top margin of the visualization window."},
+                {"volume", "The TSDF volume to be raycast."},
                 {"width", "The width of the visualization window."},
                 {"window_name",
                  "The displayed title of the visualization window."}};
@@ -49,4 +54,29 @@ void pybind_visualization_utility_methods(py::module &m) {
           "mesh_show_back_face"_a = false);
     docstring::FunctionDocInject(m, "draw_geometries",
                                  map_shared_argument_docstrings);
+
+    m.def("draw_tsdf_volume",
+          [](const integration::UniformTSDFVolume &volume,
+             const std::string &window_name, int width, int height, int left,
+             int top, float max_depth, bool show_depth) {
+              visualization::DrawTSDFVolume(volume, window_name, width, height,
+                                            left, top, max_depth, show_depth);
+          },
+          "Function to preview a TSDF volume by raycasting it from the "
+          "window camera",
+          "volume"_a, "window_name"_a = "cupoch", "width"_a = 640,
+          "height"_a = 480, "left"_a = 50, "top"_a = 50, "max_depth"_a = 3.0,
+          "show_depth"_a = false);
+    m.def("draw_tsdf_volume",
+          [](const integration::ScalableTSDFVolume &volume,
+             const std::string &window_name, int width, int height, int left,
+             int top, float max_depth, bool show_depth) {
+              visualization::DrawTSDFVolume(volume, window_name, width, height,
+                                            left, top, max_depth, show_depth);
+          },
+          "Function to preview a TSDF volume by raycasting it from the "
+          "window camera",
+          "volume"_a, "window_name"_a = "cupoch", "width"_a = 640,
+          "height"_a = 480, "left"_a = 50, "top"_a = 50, "max_depth"_a = 3.0,
+          "show_depth"_a = false);
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include "cupoch/visualization/visualizer/offscreen_renderer.h"
+#include "cupoch/visualization/visualizer/threaded_visualizer.h"
 #include "cupoch/visualization/visualizer/visualizer.h"
 #include "cupoch/geometry/image.h"
 
@@ -94,6 +96,76 @@ void pybind_visualizer(py::module &m) {
                  "do_render"_a = false, "depth_scale"_a = 1000.0)
             .def("get_window_name", &visualization::Visualizer::GetWindowName);
 
+    py::class_<visualization::OffscreenRenderer,
+               std::shared_ptr<visualization::OffscreenRenderer>>
+            offscreen(m, "OffscreenRenderer",
+                      "Renderer without display, capturing to device images.");
+    offscreen.def(py::init<>())
+            .def("create_context",
+                 &visualization::OffscreenRenderer::CreateContext,
+                 "Function to create an EGL context on a CUDA device",
+                 "width"_a = 640, "height"_a = 480, "device"_a = -1)
+            .def("destroy_context",
+                 &visualization::OffscreenRenderer::DestroyContext,
+                 "Function to destroy the context")
+            .def("add_geometry", &visualization::OffscreenRenderer::AddGeometry,
+                 "Function to add geometry to the scene", "geometry"_a,
+                 "reset_bounding_box"_a = true)
+            .def("remove_geometry",
+                 &visualization::OffscreenRenderer::RemoveGeometry,
+                 "Function to remove geometry", "geometry"_a,
+                 "reset_bounding_box"_a = true)
+            .def("clear_geometries",
+                 &visualization::OffscreenRenderer::ClearGeometries,
+                 "Function to clear geometries from the scene")
+            .def("update_geometry",
+                 &visualization::OffscreenRenderer::UpdateGeometry,
+                 "Function to update geometry", "geometry"_a = py::none())
+            .def("reset_view_point",
+                 &visualization::OffscreenRenderer::ResetViewPoint,
+                 "Function to reset view point", "reset_bounding_box"_a = false)
+            .def("get_view_control",
+                 &visualization::OffscreenRenderer::GetViewControl,
+                 "Function to retrieve the associated ``ViewControl``",
+                 py::return_value_policy::reference_internal)
+            .def("get_render_option",
+                 &visualization::OffscreenRenderer::GetRenderOption,
+                 "Function to retrieve the associated ``RenderOption``",
+                 py::return_value_policy::reference_internal)
+            .def("render", &visualization::OffscreenRenderer::Render,
+                 "Function to render a frame")
+            .def("capture_screen_float_buffer",
+                 &visualization::OffscreenRenderer::CaptureScreenFloatBuffer,
+                 "Function to capture the colors in a device float buffer",
+                 "do_render"_a = true)
+            .def("capture_depth_float_buffer",
+                 &visualization::OffscreenRenderer::CaptureDepthFloatBuffer,
+                 "Function to capture the depths in a device float buffer",
+                 "do_render"_a = true);
+
+    py::class_<visualization::ThreadedVisualizer,
+               std::shared_ptr<visualization::ThreadedVisualizer>>
+            threaded(m, "ThreadedVisualizer",
+                     "Visualizer rendering on a thread of its own.");
+    threaded.def(py::init<>())
+            .def("start", &visualization::ThreadedVisualizer::Start,
+                 "Function to start the render thread and its window",
+                 "window_name"_a = "Cupoch", "width"_a = 640,
+                 "height"_a = 480, "left"_a = 50, "top"_a = 50)
+            .def("stop", &visualization::ThreadedVisualizer::Stop,
+                 "Function to close the window and join the render thread",
+                 py::call_guard<py::gil_scoped_release>())
+            .def("is_running", &visualization::ThreadedVisualizer::IsRunning,
+                 "Returns ``False`` once the window is closed")
+            .def("post_geometry",
+                 &visualization::ThreadedVisualizer::PostGeometry,
+                 "Function to post a snapshot of the geometry ``name``",
+                 "name"_a, "geometry"_a, "reset_bounding_box"_a = true,
+                 py::call_guard<py::gil_scoped_release>())
+            .def("remove_geometry",
+                 &visualization::ThreadedVisualizer::RemoveGeometry,
+                 "Function to remove the geometry ``name``", "name"_a);
+
     docstring::ClassMethodDocInject(m, "Visualizer", "add_geometry",
                                     map_visualizer_docstrings);
     docstring::ClassMethodDocInject(m, "Visualizer", "remove_geometry",
@@ -1,4 +1,9 @@
 #include "cupoch/collision/collision.h"
+#include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/lineset.h"
+#include "cupoch/geometry/trianglemesh.h"
 #include "cupoch/geometry/voxelgrid.h"
 
 #include "tests/test_utility/raw.h"
@@ -25,4 +30,150 @@ TEST(Collision, VoxelVoxel) {
     auto res3 = collision::ComputeIntersection(voxel1, voxel2);
     EXPECT_EQ(res3->collision_index_pairs_.size(), 1);
     EXPECT_EQ(res3->GetCollisionIndexPairs()[0], Eigen::Vector2i(0, 0));
-}
\ No newline at end of file
+}
+TEST(Collision, VoxelVoxelDifferentSizes) {
+    geometry::VoxelGrid voxel1;
+    geometry::VoxelGrid voxel2;
+    voxel1.voxel_size_ = 1.0;
+    voxel2.voxel_size_ = 0.25;
+    voxel1.AddVoxel(geometry::Voxel(Eigen::Vector3i(0, 0, 0)));
+    voxel1.AddVoxel(geometry::Voxel(Eigen::Vector3i(3, 0, 0)));
+    voxel2.AddVoxel(geometry::Voxel(Eigen::Vector3i(0, 0, 0)));
+    voxel2.AddVoxel(geometry::Voxel(Eigen::Vector3i(8, 0, 0)));
+    auto res1 = collision::ComputeIntersection(voxel1, voxel2);
+    ASSERT_EQ(res1->collision_index_pairs_.size(), 1);
+    EXPECT_EQ(res1->GetCollisionIndexPairs()[0], Eigen::Vector2i(0, 0));
+    auto res2 = collision::ComputeIntersection(voxel1, voxel2, 1.1);
+    auto pairs2 = res2->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs2.size(), 3);
+    EXPECT_EQ(pairs2[0], Eigen::Vector2i(0, 0));
+    EXPECT_EQ(pairs2[1], Eigen::Vector2i(0, 1));
+    EXPECT_EQ(pairs2[2], Eigen::Vector2i(1, 1));
+    auto res3 = collision::ComputeIntersection(voxel2, voxel1, 1.1);
+    auto pairs3 = res3->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs3.size(), 3);
+    EXPECT_EQ(pairs3[0], Eigen::Vector2i(0, 0));
+    EXPECT_EQ(pairs3[1], Eigen::Vector2i(1, 0));
+    EXPECT_EQ(pairs3[2], Eigen::Vector2i(1, 1));
+}
+
+TEST(Collision, VoxelLineSetAndMesh) {
+    geometry::VoxelGrid voxel;
+    voxel.voxel_size_ = 1.0;
+    voxel.AddVoxel(geometry::Voxel(Eigen::Vector3i(0, 0, 0)));
+    voxel.AddVoxel(geometry::Voxel(Eigen::Vector3i(4, 0, 0)));
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back({4.5, 0.5, -1.0});
+    h_points.push_back({4.5, 0.5, 2.0});
+    h_points.push_back({2.0, 0.5, -1.0});
+    h_points.push_back({2.0, 0.5, 2.0});
+    thrust::host_vector<Eigen::Vector2i> h_lines;
+    h_lines.push_back({0, 1});
+    h_lines.push_back({2, 3});
+    geometry::LineSet lineset(h_points, h_lines);
+    auto res1 = collision::ComputeIntersection(voxel, lineset);
+    auto pairs1 = res1->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs1.size(), 1);
+    EXPECT_EQ(pairs1[0], Eigen::Vector2i(1, 0));
+    auto res2 = collision::ComputeIntersection(lineset, voxel, 1.1);
+    auto pairs2 = res2->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs2.size(), 2);
+    EXPECT_EQ(pairs2[0], Eigen::Vector2i(0, 1));
+    EXPECT_EQ(pairs2[1], Eigen::Vector2i(1, 0));
+
+    geometry::TriangleMesh mesh;
+    thrust::host_vector<Eigen::Vector3f> h_vertices;
+    h_vertices.push_back({4.2, -1.0, 0.5});
+    h_vertices.push_back({4.2, 2.0, 0.5});
+    h_vertices.push_back({4.2, 0.5, 3.0});
+    mesh.SetVertices(h_vertices);
+    thrust::host_vector<Eigen::Vector3i> h_triangles;
+    h_triangles.push_back({0, 1, 2});
+    mesh.SetTriangles(h_triangles);
+    auto res3 = collision::ComputeIntersection(voxel, mesh);
+    auto pairs3 = res3->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs3.size(), 1);
+    EXPECT_EQ(pairs3[0], Eigen::Vector2i(1, 0));
+}
+
+TEST(Collision, PrimitiveWithoutVoxelization) {
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back({0.5, 0.0, 0.0});
+    h_points.push_back({2.0, 0.0, 0.0});
+    h_points.push_back({1.05, 0.0, 0.0});
+    geometry::PointCloud pointcloud(h_points);
+    collision::Sphere sphere(1.0);
+    auto res1 = collision::ComputeIntersection(sphere, pointcloud);
+    auto pairs1 = res1->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs1.size(), 1);
+    EXPECT_EQ(pairs1[0], Eigen::Vector2i(0, 0));
+    auto res2 = collision::ComputeIntersection(sphere, pointcloud, 0.1);
+    auto pairs2 = res2->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs2.size(), 2);
+    EXPECT_EQ(pairs2[1], Eigen::Vector2i(0, 2));
+    Eigen::Matrix4f tf = Eigen::Matrix4f::Identity();
+    tf.block<3, 1>(0, 3) = Eigen::Vector3f(2.0, 0.0, 0.0);
+    collision::Box box(Eigen::Vector3f(0.2, 0.2, 0.2), tf);
+    auto res3 = collision::ComputeIntersection(box, pointcloud);
+    auto pairs3 = res3->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs3.size(), 1);
+    EXPECT_EQ(pairs3[0], Eigen::Vector2i(0, 1));
+
+    geometry::OccupancyGrid occgrid(0.1, 64);
+    occgrid.AddVoxel(Eigen::Vector3i(32, 32, 32), true);
+    collision::Sphere near_sphere(0.2, Eigen::Vector3f(0.2, 0.05, 0.05));
+    collision::Sphere far_sphere(0.2, Eigen::Vector3f(0.5, 0.05, 0.05));
+    auto res4 = collision::ComputeIntersection(near_sphere, occgrid);
+    auto pairs4 = res4->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs4.size(), 1);
+    EXPECT_EQ(pairs4[0], Eigen::Vector2i(0, IndexOf(32, 32, 32, 64)));
+    EXPECT_FALSE(collision::ComputeIntersection(far_sphere, occgrid)->IsCollided());
+
+    geometry::DistanceTransform dt(0.1, 64);
+    thrust::host_vector<Eigen::Vector3i> h_sites;
+    h_sites.push_back({32, 32, 32});
+    dt.ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_sites));
+    auto res5 = collision::ComputeIntersection(near_sphere, dt);
+    auto pairs5 = res5->GetCollisionIndexPairs();
+    ASSERT_EQ(pairs5.size(), 1);
+    EXPECT_EQ(pairs5[0], Eigen::Vector2i(0, IndexOf(32, 32, 32, 64)));
+    EXPECT_FALSE(collision::ComputeIntersection(far_sphere, dt)->IsCollided());
+    EXPECT_TRUE(collision::ComputeIntersection(far_sphere, dt, 0.3)->IsCollided());
+}
+
+TEST(Collision, PrimitiveDistances) {
+    collision::Sphere sphere(0.5);
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back({0.0, 3.0, 0.0});
+    h_points.push_back({2.0, 0.0, 0.0});
+    geometry::PointCloud pointcloud(h_points);
+    auto res1 = collision::ComputeDistance(sphere, pointcloud);
+    ASSERT_EQ(res1->index_pairs_.size(), 1);
+    EXPECT_EQ(res1->GetIndexPairs()[0], Eigen::Vector2i(0, 1));
+    EXPECT_NEAR(res1->GetDistances()[0], 1.5, 1.0e-5);
+    thrust::host_vector<Eigen::Vector3f> h_first = res1->first_points_;
+    ExpectEQ(h_first[0], Eigen::Vector3f(0.5, 0.0, 0.0));
+    EXPECT_TRUE(collision::ComputeDistance(sphere, pointcloud, 1.0)->IsEmpty());
+
+    geometry::VoxelGrid voxel;
+    voxel.voxel_size_ = 1.0;
+    voxel.AddVoxel(geometry::Voxel(Eigen::Vector3i(2, 0, 0)));
+    auto res2 = collision::ComputeDistance(sphere, voxel);
+    ASSERT_EQ(res2->index_pairs_.size(), 1);
+    EXPECT_NEAR(res2->GetDistances()[0], 1.5, 1.0e-4);
+
+    geometry::TriangleMesh mesh;
+    thrust::host_vector<Eigen::Vector3f> h_vertices;
+    h_vertices.push_back({1.0, -1.0, -1.0});
+    h_vertices.push_back({1.0, 1.0, -1.0});
+    h_vertices.push_back({1.0, 0.0, 1.0});
+    mesh.SetVertices(h_vertices);
+    thrust::host_vector<Eigen::Vector3i> h_triangles;
+    h_triangles.push_back({0, 1, 2});
+    mesh.SetTriangles(h_triangles);
+    auto res3 = collision::ComputeDistance(sphere, mesh);
+    ASSERT_EQ(res3->index_pairs_.size(), 1);
+    EXPECT_NEAR(res3->GetDistances()[0], 0.5, 1.0e-4);
+    thrust::host_vector<Eigen::Vector3f> h_second = res3->second_points_;
+    ExpectEQ(h_second[0], Eigen::Vector3f(1.0, 0.0, 0.0));
+}
@@ -0,0 +1,40 @@
+#include "cupoch/collision/continuous_collision.h"
+#include "cupoch/geometry/distancetransform.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(ContinuousCollision, ComputeTimesOfImpact) {
+    geometry::DistanceTransform dt(0.1, 64);
+    thrust::host_vector<Eigen::Vector3i> h_sites;
+    h_sites.push_back({32, 32, 32});
+    dt.ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_sites));
+
+    thrust::host_vector<Eigen::Matrix4f_u> h_starts;
+    thrust::host_vector<Eigen::Matrix4f_u> h_ends;
+    Eigen::Matrix4f_u tf = Eigen::Matrix4f_u::Identity();
+    // Through the obstacle, the sphere touching it at t = 0.4.
+    tf.block<3, 1>(0, 3) = Eigen::Vector3f(1.0, 0.05, 0.05);
+    h_starts.push_back(tf);
+    tf.block<3, 1>(0, 3) = Eigen::Vector3f(-1.0, 0.05, 0.05);
+    h_ends.push_back(tf);
+    // Far from it.
+    tf.block<3, 1>(0, 3) = Eigen::Vector3f(1.0, 1.0, 1.0);
+    h_starts.push_back(tf);
+    tf.block<3, 1>(0, 3) = Eigen::Vector3f(1.0, -1.0, 1.0);
+    h_ends.push_back(tf);
+
+    collision::Sphere sphere(0.1);
+    utility::device_vector<float> times;
+    collision::ComputeTimesOfImpact(sphere, utility::device_vector<Eigen::Matrix4f_u>(h_starts),
+                                    utility::device_vector<Eigen::Matrix4f_u>(h_ends), dt, times);
+    thrust::host_vector<float> h_times = times;
+    ASSERT_EQ(h_times.size(), 2);
+    EXPECT_LE(h_times[0], 0.4);
+    EXPECT_GE(h_times[0], 0.3);
+    EXPECT_TRUE(std::isinf(h_times[1]));
+}
@@ -0,0 +1,60 @@
+#include "cupoch/collision/robot_collision.h"
+#include "cupoch/geometry/distancetransform.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+Eigen::Matrix4f_u Translation(float x, float y, float z) {
+    Eigen::Matrix4f_u tf = Eigen::Matrix4f_u::Identity();
+    tf.block<3, 1>(0, 3) = Eigen::Vector3f(x, y, z);
+    return tf;
+}
+
+}  // namespace
+
+TEST(RobotCollisionChecker, Check) {
+    auto dt = std::make_shared<geometry::DistanceTransform>(0.1, 64);
+    thrust::host_vector<Eigen::Vector3i> h_sites;
+    h_sites.push_back({32, 32, 32});
+    dt->ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_sites));
+
+    collision::RobotCollisionChecker checker;
+    checker.AddLink(collision::Sphere(0.1));
+    checker.AddLink(collision::Box(Eigen::Vector3f(0.2, 0.2, 0.2)));
+    checker.AddSelfCollisionPair(0, 1);
+    checker.SetDistanceTransform(dt);
+    EXPECT_EQ(checker.GetNumLinks(), 2);
+
+    thrust::host_vector<Eigen::Matrix4f_u> h_transforms;
+    // Free.
+    h_transforms.push_back(Translation(0.5, 0.05, 0.05));
+    h_transforms.push_back(Translation(1.0, 1.0, 1.0));
+    // The sphere hits the obstacle.
+    h_transforms.push_back(Translation(0.15, 0.05, 0.05));
+    h_transforms.push_back(Translation(1.0, 1.0, 1.0));
+    // The sphere hits the box.
+    h_transforms.push_back(Translation(0.5, 0.05, 0.05));
+    h_transforms.push_back(Translation(0.55, 0.05, 0.05));
+    utility::device_vector<Eigen::Matrix4f_u> transforms = h_transforms;
+    utility::device_vector<uint8_t> collided;
+    utility::device_vector<float> min_distances;
+    checker.Check(transforms, collided, min_distances);
+    thrust::host_vector<uint8_t> h_collided = collided;
+    thrust::host_vector<float> h_min_distances = min_distances;
+    ASSERT_EQ(h_collided.size(), 3);
+    EXPECT_EQ(h_collided[0], 0);
+    EXPECT_EQ(h_collided[1], 1);
+    EXPECT_EQ(h_collided[2], 1);
+    EXPECT_NEAR(h_min_distances[0], 0.3, 1.0e-4);
+
+    checker.margin_ = 0.35;
+    checker.Check(transforms, collided);
+    h_collided = collided;
+    EXPECT_EQ(h_collided[0], 1);
+}
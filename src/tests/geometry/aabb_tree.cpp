@@ -0,0 +1,97 @@
+#include "cupoch/geometry/aabb_tree.h"
+#include "cupoch/geometry/voxelgrid.h"
+
+#include "tests/test_utility/raw.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(AABBTree, IntersectLineSegments) {
+    geometry::VoxelGrid voxelgrid;
+    voxelgrid.voxel_size_ = 1.0;
+    for (int i = 0; i < 10; ++i) {
+        voxelgrid.AddVoxel(geometry::Voxel(Eigen::Vector3i(3 * i, 0, 0)));
+    }
+    utility::device_vector<Eigen::Vector3f> min_bounds;
+    utility::device_vector<Eigen::Vector3f> max_bounds;
+    geometry::AABBTree::AppendBoxes(voxelgrid, min_bounds, max_bounds);
+    geometry::AABBTree tree;
+    tree.Build(min_bounds, max_bounds);
+    EXPECT_EQ(tree.GetNumBoxes(), 10);
+
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back({9.5, -1.0, 0.5});
+    h_points.push_back({9.5, 2.0, 0.5});
+    h_points.push_back({10.5, -1.0, 0.5});
+    h_points.push_back({10.5, 2.0, 0.5});
+    thrust::host_vector<Eigen::Vector2i> h_lines;
+    h_lines.push_back({0, 1});
+    h_lines.push_back({2, 3});
+    auto hits = tree.IntersectLineSegments(utility::device_vector<Eigen::Vector3f>(h_points),
+                                           utility::device_vector<Eigen::Vector2i>(h_lines));
+    thrust::host_vector<int> h_hits = hits;
+    thrust::host_vector<Eigen::Vector3i> h_keys = voxelgrid.voxels_keys_;
+    ASSERT_GE(h_hits[0], 0);
+    EXPECT_EQ(h_keys[h_hits[0]], Eigen::Vector3i(9, 0, 0));
+    EXPECT_EQ(h_hits[1], -1);
+    // Grown by the margin, the box at x = 9 reaches the second segment.
+    auto hits_margin = tree.IntersectLineSegments(utility::device_vector<Eigen::Vector3f>(h_points),
+                                                  utility::device_vector<Eigen::Vector2i>(h_lines), 0.6);
+    thrust::host_vector<int> h_hits_margin = hits_margin;
+    EXPECT_GE(h_hits_margin[1], 0);
+}
+
+TEST(AABBTree, Queries) {
+    thrust::host_vector<Eigen::Vector3f> h_mins;
+    thrust::host_vector<Eigen::Vector3f> h_maxs;
+    for (int i = 0; i < 8; ++i) {
+        h_mins.push_back(Eigen::Vector3f(2.0 * i, 0.0, 0.0));
+        h_maxs.push_back(Eigen::Vector3f(2.0 * i + 1.0, 1.0, 1.0));
+    }
+    geometry::AABBTree tree;
+    tree.Build(utility::device_vector<Eigen::Vector3f>(h_mins),
+               utility::device_vector<Eigen::Vector3f>(h_maxs));
+
+    thrust::host_vector<Eigen::Vector3f> h_qmins;
+    thrust::host_vector<Eigen::Vector3f> h_qmaxs;
+    h_qmins.push_back(Eigen::Vector3f(0.5, 0.5, 0.5));
+    h_qmaxs.push_back(Eigen::Vector3f(2.5, 0.6, 0.6));
+    h_qmins.push_back(Eigen::Vector3f(0.0, 5.0, 0.0));
+    h_qmaxs.push_back(Eigen::Vector3f(1.0, 6.0, 1.0));
+    auto pairs = tree.IntersectBoxes(utility::device_vector<Eigen::Vector3f>(h_qmins),
+                                     utility::device_vector<Eigen::Vector3f>(h_qmaxs));
+    thrust::host_vector<Eigen::Vector2i> h_pairs = pairs;
+    ASSERT_EQ(h_pairs.size(), 2);
+    EXPECT_EQ(h_pairs[0], Eigen::Vector2i(0, 0));
+    EXPECT_EQ(h_pairs[1], Eigen::Vector2i(0, 1));
+
+    thrust::host_vector<Eigen::Vector3f> h_origins;
+    thrust::host_vector<Eigen::Vector3f> h_dirs;
+    h_origins.push_back(Eigen::Vector3f(3.5, 0.5, 0.5));
+    h_dirs.push_back(Eigen::Vector3f(1.0, 0.0, 0.0));
+    h_origins.push_back(Eigen::Vector3f(3.5, 0.5, 0.5));
+    h_dirs.push_back(Eigen::Vector3f(0.0, 1.0, 0.0));
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distances;
+    tree.IntersectRays(utility::device_vector<Eigen::Vector3f>(h_origins),
+                       utility::device_vector<Eigen::Vector3f>(h_dirs), indices, distances);
+    thrust::host_vector<int> h_indices = indices;
+    thrust::host_vector<float> h_distances = distances;
+    EXPECT_EQ(h_indices[0], 2);
+    EXPECT_NEAR(h_distances[0], 0.5, 1.0e-6);
+    EXPECT_EQ(h_indices[1], -1);
+
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back(Eigen::Vector3f(9.2, 0.5, 0.5));
+    h_points.push_back(Eigen::Vector3f(20.0, 0.5, 0.5));
+    tree.ComputeClosestBoxes(utility::device_vector<Eigen::Vector3f>(h_points), indices, distances);
+    h_indices = indices;
+    h_distances = distances;
+    EXPECT_EQ(h_indices[0], 4);
+    EXPECT_NEAR(h_distances[0], 0.2, 1.0e-5);
+    EXPECT_EQ(h_indices[1], 7);
+    EXPECT_NEAR(h_distances[1], 5.0, 1.0e-5);
+}
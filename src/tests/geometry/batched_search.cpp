@@ -0,0 +1,84 @@
+#include "cupoch/geometry/batched_search.h"
+
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(BatchedSearch, SearchKNNBatched) {
+    int size = 300;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    utility::device_vector<Eigen::Vector3f> points_dv = points;
+    thrust::host_vector<int> offsets;
+    offsets.push_back(0);
+    offsets.push_back(100);
+    offsets.push_back(300);
+    utility::device_vector<int> offsets_dv = offsets;
+
+    int knn = 10;
+    utility::device_vector<int> result_offsets_dv;
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    EXPECT_EQ(geometry::SearchKNNBatched(points_dv, offsets_dv, knn,
+                                         result_offsets_dv, indices_dv,
+                                         distance2_dv),
+              1);
+    thrust::host_vector<int> result_offsets = result_offsets_dv;
+    thrust::host_vector<float> distance2 = distance2_dv;
+    EXPECT_EQ(result_offsets.size(), size + 1);
+    EXPECT_EQ(result_offsets[size], size * knn);
+
+    for (int s = 0; s < 2; ++s) {
+        geometry::PointCloud pc;
+        pc.SetPoints(thrust::host_vector<Eigen::Vector3f>(
+                points.begin() + offsets[s], points.begin() + offsets[s + 1]));
+        geometry::KDTreeFlann kdtree(pc);
+        utility::device_vector<int> ref_indices_dv;
+        utility::device_vector<float> ref_distance2_dv;
+        kdtree.SearchKNN(pc.points_, knn, ref_indices_dv, ref_distance2_dv);
+        thrust::host_vector<float> ref_distance2 = ref_distance2_dv;
+        thrust::host_vector<float> seg_distance2(
+                distance2.begin() + result_offsets[offsets[s]],
+                distance2.begin() + result_offsets[offsets[s + 1]]);
+        ExpectEQ(ref_distance2, seg_distance2);
+    }
+}
+
+TEST(BatchedSearch, SearchRadiusBatched) {
+    thrust::host_vector<Eigen::Vector3f> points;
+    points.push_back(Eigen::Vector3f(0.0, 0.0, 0.0));
+    points.push_back(Eigen::Vector3f(0.5, 0.0, 0.0));
+    points.push_back(Eigen::Vector3f(2.0, 0.0, 0.0));
+    points.push_back(Eigen::Vector3f(0.0, 0.0, 0.0));
+    points.push_back(Eigen::Vector3f(0.1, 0.0, 0.0));
+    utility::device_vector<Eigen::Vector3f> points_dv = points;
+    thrust::host_vector<int> offsets;
+    offsets.push_back(0);
+    offsets.push_back(3);
+    offsets.push_back(5);
+    utility::device_vector<int> offsets_dv = offsets;
+
+    utility::device_vector<int> result_offsets_dv;
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    geometry::SearchRadiusBatched(points_dv, offsets_dv, 1.0, 10,
+                                  result_offsets_dv, indices_dv, distance2_dv);
+
+    int ref_offsets0[] = {0, 2, 4, 5, 7, 9};
+    int ref_indices0[] = {0, 1, 1, 0, 2, 3, 4, 4, 3};
+    thrust::host_vector<int> ref_offsets(ref_offsets0, ref_offsets0 + 6);
+    thrust::host_vector<int> ref_indices(ref_indices0, ref_indices0 + 9);
+    thrust::host_vector<int> result_offsets = result_offsets_dv;
+    thrust::host_vector<int> indices = indices_dv;
+    ExpectEQ(ref_offsets, result_offsets);
+    ExpectEQ(ref_indices, indices);
+}
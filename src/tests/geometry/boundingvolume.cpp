@@ -0,0 +1,47 @@
+#include "cupoch/geometry/boundingvolume.h"
+
+#include <Eigen/Geometry>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(OrientedBoundingBox, CreateFromPointClusters) {
+    // Grids of extent 4 x 2 x 1, rotated about z for the cluster 0 and
+    // axis aligned for the cluster 2, and a noise point.
+    const Matrix3f rot = AngleAxisf(M_PI / 6.0, Vector3f::UnitZ()).matrix();
+    const Vector3f center0(1.0, -2.0, 0.5);
+    const Vector3f center2(10.0, 0.0, 0.0);
+    thrust::host_vector<Vector3f> points;
+    thrust::host_vector<int> labels;
+    for (int i = 0; i <= 8; ++i) {
+        for (int j = 0; j <= 4; ++j) {
+            for (int k = 0; k <= 2; ++k) {
+                const Vector3f p(-2.0 + 0.5 * i, -1.0 + 0.5 * j,
+                                 -0.5 + 0.5 * k);
+                points.push_back(center0 + rot * p);
+                labels.push_back(0);
+                points.push_back(center2 + p);
+                labels.push_back(2);
+            }
+        }
+    }
+    points.push_back(Vector3f(100.0, 100.0, 100.0));
+    labels.push_back(-1);
+    utility::device_vector<Vector3f> d_points = points;
+    utility::device_vector<int> d_labels = labels;
+
+    const auto boxes = geometry::OrientedBoundingBox::CreateFromPointClusters(
+            d_points, d_labels);
+    ASSERT_EQ(boxes.size(), 3);
+    ExpectEQ(boxes[0].center_, center0, 1.0e-4);
+    ExpectEQ(boxes[0].extent_, Vector3f(4.0, 2.0, 1.0), 1.0e-4);
+    EXPECT_NEAR(abs(boxes[0].R_.col(0).dot(rot.col(0))), 1.0, 1.0e-4);
+    EXPECT_NEAR(boxes[0].R_.determinant(), 1.0, 1.0e-4);
+    EXPECT_NEAR(boxes[1].Volume(), 0.0, 1.0e-6);
+    ExpectEQ(boxes[2].center_, center2, 1.0e-4);
+    EXPECT_NEAR(boxes[2].Volume(), 8.0, 1.0e-3);
+}
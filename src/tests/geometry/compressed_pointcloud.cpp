@@ -0,0 +1,56 @@
+#include "cupoch/geometry/compressed_pointcloud.h"
+
+#include <gtest/gtest.h>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace cupoch::geometry;
+using namespace unit_test;
+
+TEST(CompressedPointCloud, CompressDecompress) {
+    size_t size = 100;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    thrust::host_vector<Vector3f> normals(size);
+    thrust::host_vector<Vector3f> colors(size);
+    Rand(points, Zero3f, Vector3f(10.0, 10.0, 10.0), 0);
+    Rand(normals, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 1);
+    Rand(colors, Zero3f, Vector3f(1.0, 1.0, 1.0), 2);
+    pc.SetPoints(points);
+    pc.SetNormals(normals);
+    pc.SetColors(colors);
+
+    CompressedPointCloud cpc(pc, CompressedPointCloud::PointEncoding::Int16,
+                             0.001);
+    EXPECT_EQ(size, cpc.GetNumPoints());
+    EXPECT_TRUE(cpc.HasNormals());
+    EXPECT_TRUE(cpc.HasColors());
+    EXPECT_EQ(size * 15, cpc.GetMemoryFootprint());
+
+    auto output = cpc.Decompress();
+    ExpectEQ(points, output->GetPoints(), 1e-3);
+    ExpectEQ(normals, output->GetNormals(), 1e-3);
+    ExpectEQ(colors, output->GetColors(), 1.0 / 255.0);
+}
+
+TEST(CompressedPointCloud, Transform) {
+    size_t size = 100;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(10.0, 10.0, 10.0), 0);
+    pc.SetPoints(points);
+
+    Matrix4f transformation = Matrix4f::Identity();
+    transformation.block<3, 3>(0, 0) =
+            AngleAxisf(0.5, Vector3f::UnitZ()).toRotationMatrix();
+    transformation.block<3, 1>(0, 3) = Vector3f(1.0, 2.0, 3.0);
+
+    CompressedPointCloud cpc(pc, CompressedPointCloud::PointEncoding::Int16);
+    cpc.Transform(transformation);
+    pc.Transform(transformation);
+    ExpectEQ(pc.GetPoints(), cpc.Decompress()->GetPoints(), 1e-3);
+}
@@ -0,0 +1,49 @@
+#include "cupoch/geometry/densegrid.h"
+
+#include <vector>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(DenseGrid, LinearGridLayout) {
+    const int res = 6;
+    EXPECT_EQ(geometry::LinearGridLayout::NumStorageVoxels(res), 216);
+    EXPECT_EQ(geometry::LinearGridLayout::StorageIndexOf(Vector3i(1, 2, 3), res),
+              IndexOf(1, 2, 3, res));
+    EXPECT_EQ(geometry::LinearGridLayout::GridIndexOf(IndexOf(1, 2, 3, res), res),
+              Vector3i(1, 2, 3));
+}
+
+TEST(DenseGrid, BrickedGridLayout) {
+    typedef geometry::BrickedGridLayout<4> Layout;
+    // Padded to 3 bricks along each axis.
+    const int res = 10;
+    ASSERT_EQ(Layout::NumStorageVoxels(res), 12 * 12 * 12);
+    vector<int> count(Layout::NumStorageVoxels(res), 0);
+    for (int x = 0; x < res; ++x) {
+        for (int y = 0; y < res; ++y) {
+            for (int z = 0; z < res; ++z) {
+                const int idx = Layout::StorageIndexOf(Vector3i(x, y, z), res);
+                ASSERT_GE(idx, 0);
+                ASSERT_LT(idx, (int)count.size());
+                ++count[idx];
+                EXPECT_EQ(Layout::GridIndexOf(idx, res), Vector3i(x, y, z));
+            }
+        }
+    }
+    for (int x = 0; x < res; ++x) {
+        for (int y = 0; y < res; ++y) {
+            for (int z = 0; z < res; ++z) {
+                EXPECT_EQ(count[Layout::StorageIndexOf(Vector3i(x, y, z), res)], 1);
+            }
+        }
+    }
+    // The voxels of a brick are contiguous.
+    const int base = Layout::StorageIndexOf(Vector3i(4, 4, 4), res);
+    EXPECT_EQ(base % Layout::kBrickVoxels, 0);
+    EXPECT_EQ(Layout::StorageIndexOf(Vector3i(7, 7, 7), res), base + Layout::kBrickVoxels - 1);
+}
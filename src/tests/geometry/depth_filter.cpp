@@ -0,0 +1,118 @@
+#include "cupoch/geometry/depth_filter.h"
+
+#include <limits>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+geometry::Image CreateDepth(int width,
+                            int height,
+                            const thrust::host_vector<float> &depths) {
+    geometry::Image image;
+    image.Prepare(width, height, 1, 4);
+    thrust::host_vector<uint8_t> data((const uint8_t *)depths.data(),
+                                      (const uint8_t *)depths.data() +
+                                              depths.size() * sizeof(float));
+    image.SetData(data);
+    return image;
+}
+
+thrust::host_vector<float> GetDepths(const geometry::Image &image) {
+    thrust::host_vector<uint8_t> data = image.GetData();
+    const float *p = (const float *)data.data();
+    return thrust::host_vector<float>(p, p + image.width_ * image.height_);
+}
+
+geometry::DepthFilterOption NoFilterOption() {
+    geometry::DepthFilterOption option;
+    option.flying_pixel_threshold_ = 0.0;
+    option.spatial_half_kernel_size_ = 0;
+    option.temporal_window_ = 0;
+    return option;
+}
+
+}  // namespace
+
+TEST(DepthFilter, TruncateAndRemoveFlyingPixels) {
+    // A step from 1 to 2 with a flying pixel column at 1.5 in between.
+    const int width = 9;
+    const int height = 5;
+    thrust::host_vector<float> depths(width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            depths[y * width + x] = (x < 4) ? 1.0 : ((x == 4) ? 1.5 : 2.0);
+        }
+    }
+    depths[0] = std::numeric_limits<float>::quiet_NaN();
+    depths[width - 1] = 5.0;
+    auto image = CreateDepth(width, height, depths);
+
+    auto option = NoFilterOption();
+    option.flying_pixel_threshold_ = 0.05;
+    geometry::DepthFilter filter(option);
+    filter.Process(image);
+    auto out = GetDepths(image);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int i = y * width + x;
+            if (i == 0 || i == width - 1 || x == 4) {
+                EXPECT_EQ(out[i], 0.0);
+            } else {
+                EXPECT_EQ(out[i], depths[i]);
+            }
+        }
+    }
+}
+
+TEST(DepthFilter, TemporalAndHoleFilling) {
+    const int width = 6;
+    const int height = 4;
+    auto option = NoFilterOption();
+    option.temporal_window_ = 2;
+    option.temporal_delta_ = 0.05;
+    option.temporal_persistence_ = true;
+    geometry::DepthFilter filter(option);
+
+    thrust::host_vector<float> first(width * height, 1.0);
+    auto image = CreateDepth(width, height, first);
+    filter.Process(image);
+    EXPECT_EQ(filter.GetHistorySize(), 1);
+
+    // Averaged with the first frame except on a moving edge, and a hole
+    // filled from the history.
+    thrust::host_vector<float> second(width * height, 1.02);
+    second[1] = 1.5;
+    second[2] = 0.0;
+    image = CreateDepth(width, height, second);
+    filter.Process(image);
+    EXPECT_EQ(filter.GetHistorySize(), 2);
+    auto out = GetDepths(image);
+    EXPECT_NEAR(out[0], 1.01, THRESHOLD_1E_4);
+    EXPECT_NEAR(out[1], 1.5, THRESHOLD_1E_4);
+    EXPECT_NEAR(out[2], 1.0, THRESHOLD_1E_4);
+
+    // A new size resets the history.
+    image = CreateDepth(width / 2, height, thrust::host_vector<float>(
+                                                   width / 2 * height, 1.0));
+    filter.Process(image);
+    EXPECT_EQ(filter.GetHistorySize(), 1);
+
+    option = NoFilterOption();
+    option.hole_filling_mode_ =
+            geometry::DepthFilterOption::HoleFillingMode::FarthestFromAround;
+    geometry::DepthFilter hole_filter(option);
+    thrust::host_vector<float> holes(width * height, 1.0);
+    holes[width + 2] = 0.0;
+    holes[width + 3] = 2.0;
+    image = CreateDepth(width, height, holes);
+    hole_filter.Process(image);
+    out = GetDepths(image);
+    EXPECT_EQ(out[width + 2], 2.0);
+    EXPECT_EQ(out[width + 3], 2.0);
+}
@@ -1,4 +1,5 @@
 #include "cupoch/geometry/distancetransform.h"
+#include "cupoch/geometry/occupancygrid.h"
 #include "cupoch/geometry/voxelgrid.h"
 
 #include "tests/test_utility/raw.h"
@@ -21,4 +22,116 @@ TEST(DistanceTransform, ComputeVoronoiDiagram) {
     auto v = dt.GetVoxel(Eigen::Vector3f(0.0, 0.0, 0.0));
     EXPECT_TRUE(thrust::get<0>(v));
     EXPECT_EQ(thrust::get<1>(v).nearest_index_, ref.cast<unsigned short>() + Eigen::Vector3ui16::Constant(512 / 2));
-}
\ No newline at end of file
+}
+TEST(DistanceTransform, CreateVoronoiGraph) {
+    // Two walls at x = 2 and x = 12, the skeleton being the mid plane.
+    const int resolution = 16;
+    thrust::host_vector<Eigen::Vector3i> h_sites;
+    for (int y = 0; y < resolution; ++y) {
+        for (int z = 0; z < resolution; ++z) {
+            h_sites.push_back(Eigen::Vector3i(2, y, z));
+            h_sites.push_back(Eigen::Vector3i(12, y, z));
+        }
+    }
+    geometry::DistanceTransform dt(1.0, resolution);
+    dt.ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_sites));
+    thrust::host_vector<Eigen::Vector3i> skeleton = dt.ExtractVoronoiSkeleton();
+    EXPECT_GE(skeleton.size(), resolution * resolution);
+    for (size_t i = 0; i < skeleton.size(); ++i) {
+        EXPECT_GE(skeleton[i][0], 6);
+        EXPECT_LE(skeleton[i][0], 8);
+    }
+    auto graph = dt.CreateVoronoiGraph();
+    EXPECT_EQ(graph->points_.size(), skeleton.size());
+    EXPECT_TRUE(graph->HasLines());
+}
+
+TEST(DistanceTransform, UpdateEDT) {
+    const int resolution = 32;
+    thrust::host_vector<Eigen::Vector3i> h_first;
+    h_first.push_back(Eigen::Vector3i(4, 4, 4));
+    h_first.push_back(Eigen::Vector3i(20, 8, 12));
+    thrust::host_vector<Eigen::Vector3i> h_removed;
+    h_removed.push_back(Eigen::Vector3i(4, 4, 4));
+    thrust::host_vector<Eigen::Vector3i> h_added;
+    h_added.push_back(Eigen::Vector3i(24, 24, 24));
+    geometry::DistanceTransform dt(1.0, resolution);
+    dt.ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_first));
+    dt.UpdateEDT(utility::device_vector<Eigen::Vector3i>(h_added),
+                 utility::device_vector<Eigen::Vector3i>(h_removed));
+
+    thrust::host_vector<geometry::DistanceVoxel> h_voxels = dt.voxels_;
+    const Eigen::Vector3i sites[2] = {Eigen::Vector3i(20, 8, 12), Eigen::Vector3i(24, 24, 24)};
+    for (int x = 0; x < resolution; x += 3) {
+        for (int y = 0; y < resolution; y += 3) {
+            for (int z = 0; z < resolution; z += 3) {
+                Eigen::Vector3f p(x, y, z);
+                float ref = std::min((sites[0].cast<float>() - p).norm(),
+                                     (sites[1].cast<float>() - p).norm());
+                EXPECT_NEAR(h_voxels[IndexOf(x, y, z, resolution)].distance_, ref, 1.0e-4);
+            }
+        }
+    }
+}
+
+TEST(DistanceTransform, ComputeEDTFromOccupancyGrid) {
+    const int resolution = 32;
+    geometry::OccupancyGrid occupancygrid(1.0, resolution);
+    occupancygrid.AddVoxel(Eigen::Vector3i(8, 8, 8), true);
+    occupancygrid.AddVoxel(Eigen::Vector3i(9, 8, 8), true);
+    occupancygrid.AddVoxel(Eigen::Vector3i(12, 8, 8), false);
+    geometry::DistanceTransform dt(1.0, resolution);
+    dt.ComputeEDT(occupancygrid);
+    thrust::host_vector<geometry::DistanceVoxel> h_voxels = dt.voxels_;
+    EXPECT_NEAR(h_voxels[IndexOf(12, 8, 8, resolution)].distance_, 3.0, 1.0e-4);
+    EXPECT_NEAR(h_voxels[IndexOf(8, 8, 8, resolution)].distance_, 0.0, 1.0e-4);
+
+    dt.ComputeEDT(occupancygrid, true);
+    h_voxels = dt.voxels_;
+    EXPECT_NEAR(h_voxels[IndexOf(12, 8, 8, resolution)].distance_, 3.0, 1.0e-4);
+    EXPECT_NEAR(h_voxels[IndexOf(8, 8, 8, resolution)].distance_, -1.0, 1.0e-4);
+}
+
+TEST(DistanceTransform, GetDistancesAndGradients) {
+    const int resolution = 32;
+    thrust::host_vector<Eigen::Vector3i> h_sites;
+    h_sites.push_back(Eigen::Vector3i(8, 16, 16));
+    geometry::DistanceTransform dt(1.0, resolution);
+    dt.ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_sites));
+
+    // The center of the site voxel is at (-7.5, 0.5, 0.5).
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back(Eigen::Vector3f(-2.0, 0.5, 0.5));
+    h_points.push_back(Eigen::Vector3f(-7.5, 0.5, 0.5));
+    utility::device_vector<float> distances;
+    utility::device_vector<Eigen::Vector3f> gradients;
+    dt.GetDistancesAndGradients(utility::device_vector<Eigen::Vector3f>(h_points),
+                                distances, gradients);
+    thrust::host_vector<float> h_distances = distances;
+    thrust::host_vector<Eigen::Vector3f> h_gradients = gradients;
+    EXPECT_NEAR(h_distances[0], 5.5, 1.0e-4);
+    EXPECT_NEAR(h_distances[1], 0.0, 1.0e-4);
+    EXPECT_NEAR(h_gradients[0][0], 1.0, 1.0e-4);
+    EXPECT_LT(std::abs(h_gradients[0][1]), 0.1);
+}
+
+TEST(DistanceTransform, GetDistancesWithTexture) {
+    const int resolution = 32;
+    thrust::host_vector<Eigen::Vector3i> h_sites;
+    h_sites.push_back(Eigen::Vector3i(8, 16, 16));
+    geometry::DistanceTransform dt(0.5, resolution);
+    dt.ComputeEDT(utility::device_vector<Eigen::Vector3i>(h_sites));
+    dt.UpdateTexture();
+    EXPECT_TRUE(dt.HasTexture());
+
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back(Eigen::Vector3f(-1.0, 0.25, 0.25));
+    utility::device_vector<float> distances;
+    utility::device_vector<Eigen::Vector3f> gradients;
+    dt.GetDistancesAndGradients(utility::device_vector<Eigen::Vector3f>(h_points),
+                                distances, gradients, true);
+    thrust::host_vector<float> h_distances = distances;
+    thrust::host_vector<Eigen::Vector3f> h_gradients = gradients;
+    EXPECT_NEAR(h_distances[0], 2.75, 0.02);
+    EXPECT_NEAR(h_gradients[0][0], 1.0, 0.02);
+}
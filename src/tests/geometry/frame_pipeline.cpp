@@ -0,0 +1,57 @@
+#include "cupoch/geometry/frame_pipeline.h"
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+geometry::Image CreatePlaneDepth(int width, int height, uint16_t depth) {
+    geometry::Image image;
+    image.Prepare(width, height, 1, 2);
+    thrust::host_vector<uint16_t> pixels(width * height, depth);
+    // Leave a band without depth.
+    for (int i = 0; i < width * 10; ++i) pixels[i] = 0;
+    thrust::host_vector<uint8_t> data((uint8_t *)pixels.data(),
+                                      (uint8_t *)pixels.data() +
+                                              pixels.size() * 2);
+    image.SetData(data);
+    return image;
+}
+
+}  // namespace
+
+TEST(DepthFramePipeline, ProcessAndReplay) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    const float voxel_size = 0.05;
+    geometry::DepthFramePipeline pipeline(intrinsic, voxel_size);
+    EXPECT_EQ(pipeline.GetCapacity(),
+              (size_t)(intrinsic.width_ * intrinsic.height_));
+
+    // The second frame replays the graph recorded by the first one.
+    for (uint16_t depth : {1000, 2000}) {
+        auto image = CreatePlaneDepth(intrinsic.width_, intrinsic.height_,
+                                      depth);
+        ASSERT_TRUE(pipeline.Process(image));
+        auto pcd = pipeline.GetPointCloud();
+
+        auto ref = geometry::PointCloud::CreateFromDepthImage(image, intrinsic)
+                           ->VoxelDownSample(voxel_size);
+        ASSERT_TRUE(pcd->HasNormals());
+        EXPECT_NEAR((float)pcd->points_.size(), (float)ref->points_.size(),
+                    0.2 * ref->points_.size());
+        thrust::host_vector<Vector3f> points = pcd->points_;
+        thrust::host_vector<Vector3f> normals = pcd->normals_;
+        for (size_t i = 0; i < points.size(); ++i) {
+            EXPECT_NEAR(points[i](2), depth / 1000.0, 1.0e-3);
+            EXPECT_NEAR(std::abs(normals[i](2)), 1.0, 1.0e-3);
+        }
+    }
+}
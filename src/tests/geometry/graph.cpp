@@ -82,4 +82,111 @@ TEST(Graph, DijkstraPath) {
     EXPECT_EQ((*res)[2].shortest_distance_, 2.0);
     EXPECT_EQ((*res)[3].shortest_distance_, 2.0);
     EXPECT_EQ((*res)[4].shortest_distance_, 3.0);
-}
\ No newline at end of file
+}
+
+TEST(Graph, ConnectedComponents) {
+    geometry::Graph gp;
+    thrust::host_vector<Eigen::Vector3f> points(6, Eigen::Vector3f::Zero());
+    gp.SetPoints(points);
+    gp.AddEdge({4, 1});
+    gp.AddEdge({1, 3});
+    gp.AddEdge({2, 5});
+
+    thrust::host_vector<int> labels = gp.ConnectedComponents();
+    const int ref[] = {0, 1, 2, 1, 1, 2};
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(labels[i], ref[i]);
+}
+
+TEST(Graph, MinimumSpanningTree) {
+    geometry::Graph gp;
+    thrust::host_vector<Eigen::Vector3f> points(5, Eigen::Vector3f::Zero());
+    gp.SetPoints(points);
+    gp.AddEdge({0, 1}, 1.0);
+    gp.AddEdge({0, 2}, 4.0);
+    gp.AddEdge({1, 2}, 2.0);
+    gp.AddEdge({2, 3}, 3.0);
+    gp.AddEdge({1, 3}, 5.0);
+    gp.AddEdge({3, 4}, 1.0);
+
+    auto tree = gp.MinimumSpanningTree();
+    // Both directions of the 4 tree edges.
+    EXPECT_EQ(tree->lines_.size(), 8);
+    thrust::host_vector<float> weights = tree->edge_weights_;
+    float total = 0.0;
+    for (size_t i = 0; i < weights.size(); ++i) total += weights[i];
+    EXPECT_FLOAT_EQ(total, 2.0 * 7.0);
+}
+
+TEST(Graph, AStarPath) {
+    geometry::Graph gp;
+    thrust::host_vector<Eigen::Vector3f> points;
+    points.push_back({0.0, 0.0, 0.0});
+    points.push_back({1.0, 0.0, 0.0});
+    points.push_back({0.0, 1.0, 0.0});
+    points.push_back({1.0, 1.0, 0.0});
+    points.push_back({2.0, 1.0, 0.0});
+    gp.SetPoints(points);
+    gp.AddEdge({0, 1}, 1.0);
+    gp.AddEdge({0, 2}, 1.0);
+    gp.AddEdge({1, 3}, 1.0);
+    gp.AddEdge({2, 3}, 3.0);
+    gp.AddEdge({3, 4}, 1.0);
+
+    auto path = gp.AStarPath(0, 4);
+    ASSERT_EQ(path->size(), 4);
+    EXPECT_EQ((*path)[0], 0);
+    EXPECT_EQ((*path)[1], 1);
+    EXPECT_EQ((*path)[2], 3);
+    EXPECT_EQ((*path)[3], 4);
+
+    auto res = gp.DeltaSteppingPaths(0, -1, 0.5);
+    thrust::host_vector<geometry::Graph::SSSPResult> h_res = *res;
+    EXPECT_EQ(h_res[3].shortest_distance_, 2.0);
+    EXPECT_EQ(h_res[3].prev_index_, 1);
+    EXPECT_EQ(h_res[4].shortest_distance_, 3.0);
+}
+
+TEST(Graph, DeltaEdges) {
+    geometry::Graph gp;
+    thrust::host_vector<Eigen::Vector3f> points;
+    points.push_back({0.0, 0.0, 0.0});
+    points.push_back({1.0, 0.0, 0.0});
+    points.push_back({0.0, 1.0, 0.0});
+    points.push_back({1.0, 1.0, 0.0});
+    points.push_back({2.0, 1.0, 0.0});
+    gp.SetPoints(points);
+    gp.AddEdge({0, 1}, 1.0);
+    gp.AddEdge({0, 2}, 1.0);
+    gp.AddEdge({1, 3}, 1.0);
+    gp.AddEdge({2, 3}, 3.0);
+    gp.AddEdge({3, 4}, 1.0);
+    gp.max_delta_ratio_ = 1.0;
+    const size_t n_lines = gp.lines_.size();
+
+    thrust::host_vector<Eigen::Vector2i> h_removed;
+    h_removed.push_back({1, 3});
+    gp.RemoveDeltaEdges(utility::device_vector<Eigen::Vector2i>(h_removed));
+    thrust::host_vector<Eigen::Vector2i> h_added;
+    h_added.push_back({2, 4});
+    thrust::host_vector<float> h_weights;
+    h_weights.push_back(2.0);
+    gp.AddDeltaEdges(utility::device_vector<Eigen::Vector2i>(h_added),
+                     utility::device_vector<float>(h_weights));
+    EXPECT_TRUE(gp.HasDeltaEdges());
+    EXPECT_EQ(gp.lines_.size(), n_lines);
+
+    auto path = gp.AStarPath(0, 4);
+    ASSERT_EQ(path->size(), 3);
+    EXPECT_EQ((*path)[1], 2);
+    auto res = gp.DijkstraPaths(1);
+    thrust::host_vector<geometry::Graph::SSSPResult> h_res = *res;
+    EXPECT_EQ(h_res[3].shortest_distance_, 5.0);
+    EXPECT_EQ(h_res[3].prev_index_, 2);
+
+    gp.MergeDeltaEdges();
+    EXPECT_FALSE(gp.HasDeltaEdges());
+    EXPECT_EQ(gp.lines_.size(), n_lines);
+    h_res = *gp.DijkstraPaths(1);
+    EXPECT_EQ(h_res[3].shortest_distance_, 5.0);
+    EXPECT_EQ(h_res[4].shortest_distance_, 4.0);
+}
@@ -1,6 +1,8 @@
 #include "cupoch/geometry/image.h"
 
 #include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/image_pyramid.h"
+#include "cupoch/geometry/image_view.h"
 #include "tests/test_utility/unit_test.h"
 
 using namespace Eigen;
@@ -722,4 +724,153 @@ TEST(Image, Downsample) {
     EXPECT_EQ(num_of_channels, output->num_of_channels_);
     EXPECT_EQ(bytes_per_channel, output->bytes_per_channel_);
     ExpectEQ(ref, output->GetData());
-}
\ No newline at end of file
+}
+TEST(Image, FilterArbitraryKernel) {
+    // Larger than a block, with a kernel of 9 taps.
+    const int width = 70;
+    const int height = 21;
+    thrust::host_vector<float> h_data(width * height);
+    Rand(h_data, 0.0, 1.0, 0);
+    geometry::Image image;
+    image.Prepare(width, height, 1, 4);
+    thrust::host_vector<uint8_t> bytes(image.data_.size());
+    memcpy(bytes.data(), h_data.data(), bytes.size());
+    image.SetData(bytes);
+    thrust::host_vector<float> h_dx(9);
+    thrust::host_vector<float> h_dy(5);
+    Rand(h_dx, -1.0, 1.0, 1);
+    Rand(h_dy, -1.0, 1.0, 2);
+
+    geometry::Image output;
+    geometry::Image buffer;
+    image.Filter(utility::device_vector<float>(h_dx),
+                 utility::device_vector<float>(h_dy), output, buffer);
+    EXPECT_EQ(output.width_, width);
+    EXPECT_EQ(output.height_, height);
+
+    auto at = [&](const thrust::host_vector<float> &img, int x, int y) {
+        x = std::min(std::max(x, 0), width - 1);
+        y = std::min(std::max(y, 0), height - 1);
+        return img[y * width + x];
+    };
+    thrust::host_vector<float> rows(width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float sum = 0.0;
+            for (int i = -4; i <= 4; ++i) sum += at(h_data, x + i, y) * h_dx[i + 4];
+            rows[y * width + x] = sum;
+        }
+    }
+    thrust::host_vector<uint8_t> out_bytes = output.GetData();
+    const float *out = (const float *)out_bytes.data();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float sum = 0.0;
+            for (int i = -2; i <= 2; ++i) sum += at(rows, x, y + i) * h_dy[i + 2];
+            EXPECT_NEAR(out[y * width + x], sum, THRESHOLD_1E_4);
+        }
+    }
+}
+
+TEST(Image, BilateralFilter) {
+    // A step of depth with a hole.
+    const int width = 8;
+    const int height = 6;
+    thrust::host_vector<float> h_depth(width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            h_depth[y * width + x] = (x < width / 2) ? 1.0 : 2.0;
+        }
+    }
+    h_depth[2 * width + 1] = 0.0;
+    geometry::Image depth;
+    depth.Prepare(width, height, 1, 4);
+    thrust::host_vector<uint8_t> bytes(depth.data_.size());
+    memcpy(bytes.data(), h_depth.data(), bytes.size());
+    depth.SetData(bytes);
+
+    auto output = depth.BilateralFilter(2, 2.0, 0.05);
+    thrust::host_vector<uint8_t> out_bytes = output->GetData();
+    const float *out = (const float *)out_bytes.data();
+    for (int i = 0; i < width * height; ++i) {
+        EXPECT_NEAR(out[i], h_depth[i], THRESHOLD_1E_4);
+    }
+}
+
+TEST(Image, FloatImagePyramid) {
+    const int width = 16;
+    const int height = 8;
+    const size_t num_of_levels = 3;
+    geometry::Image image;
+    image.Prepare(width, height, 1, 4);
+    thrust::host_vector<float> h_data(width * height);
+    Rand(h_data, 0.0, 1.0, 0);
+    thrust::host_vector<uint8_t> bytes(image.data_.size());
+    memcpy(bytes.data(), h_data.data(), bytes.size());
+    image.SetData(bytes);
+
+    geometry::FloatImagePyramid pyramid;
+    pyramid.Build(image, num_of_levels);
+    EXPECT_EQ(pyramid.GetNumLevels(), num_of_levels);
+    const float *data = pyramid.GetLevelData(0);
+
+    // Reference: blur then downsample every level.
+    auto level = std::make_shared<geometry::Image>(image);
+    geometry::Image output;
+    for (size_t i = 0; i < num_of_levels; ++i) {
+        if (i > 0) level = level->Filter(FilterType::Gaussian3)->Downsample();
+        EXPECT_EQ(pyramid.GetWidth(i), level->width_);
+        EXPECT_EQ(pyramid.GetHeight(i), level->height_);
+        pyramid.CopyLevel(i, output);
+        thrust::host_vector<uint8_t> ref_bytes = level->GetData();
+        thrust::host_vector<uint8_t> out_bytes = output.GetData();
+        const float *ref = (const float *)ref_bytes.data();
+        const float *out = (const float *)out_bytes.data();
+        for (int j = 0; j < level->width_ * level->height_; ++j) {
+            EXPECT_NEAR(out[j], ref[j], THRESHOLD_1E_4);
+        }
+    }
+
+    // Same size, the buffer is reused.
+    pyramid.Build(image, num_of_levels);
+    EXPECT_EQ(pyramid.GetLevelData(0), data);
+}
+
+TEST(Image, PitchedImage) {
+    const int width = 13;
+    const int height = 7;
+    geometry::Image image;
+    image.Prepare(width, height, 1, 4);
+    thrust::host_vector<float> h_data(width * height);
+    Rand(h_data, 0.0, 1.0, 0);
+    thrust::host_vector<uint8_t> bytes(image.data_.size());
+    memcpy(bytes.data(), h_data.data(), bytes.size());
+    image.SetData(bytes);
+
+    geometry::PitchedImage<float> pitched;
+    pitched.CopyFrom(image);
+    EXPECT_EQ(pitched.width_, width);
+    EXPECT_EQ(pitched.height_, height);
+    EXPECT_GE(pitched.pitch_, width * sizeof(float));
+    geometry::Image copy;
+    pitched.CopyTo(copy);
+    ExpectEQ(bytes, copy.GetData());
+    EXPECT_THROW(geometry::MakeImageView<uint8_t>(image), std::runtime_error);
+
+    thrust::host_vector<Eigen::Vector2f> h_uvs;
+    h_uvs.push_back(Eigen::Vector2f(0.0, 0.0));
+    h_uvs.push_back(Eigen::Vector2f(3.25, 2.5));
+    h_uvs.push_back(Eigen::Vector2f(11.75, 5.125));
+    h_uvs.push_back(Eigen::Vector2f(12.0, 6.0));
+    h_uvs.push_back(Eigen::Vector2f(13.5, 1.0));
+    auto values = geometry::SampleTexture(
+            pitched, utility::device_vector<Eigen::Vector2f>(h_uvs));
+    thrust::host_vector<float> h_values = values;
+    geometry::ImageView<const float> view(h_data.data(), width, height,
+                                          width * sizeof(float));
+    for (size_t i = 0; i < h_uvs.size(); ++i) {
+        auto ref = view.FloatValueAt(h_uvs[i][0], h_uvs[i][1]);
+        // 8 bit interpolation weights of the texture units.
+        EXPECT_NEAR(h_values[i], ref.second, 1.0 / 128.0);
+    }
+}
@@ -0,0 +1,81 @@
+#include "cupoch/geometry/incremental_kdtree_flann.h"
+
+#include <thrust/sort.h>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(IncrementalKDTreeFlann, SearchKNNMatchesKDTreeFlann) {
+    int size = 1000;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    geometry::IncrementalKDTreeFlann index;
+    for (int i = 0; i < size; i += 100) {
+        thrust::host_vector<Eigen::Vector3f> batch(points.begin() + i,
+                                                   points.begin() + i + 100);
+        utility::device_vector<Eigen::Vector3f> batch_dv = batch;
+        EXPECT_EQ(index.InsertPoints(batch_dv), i);
+    }
+    EXPECT_EQ(index.GetNumPoints(), size);
+    EXPECT_LT(index.GetNumSubTrees(), 10);
+
+    geometry::KDTreeFlann kdtree(pc);
+    utility::device_vector<int> ref_indices_dv;
+    utility::device_vector<float> ref_distance2_dv;
+    kdtree.SearchKNN(pc.points_, 10, ref_indices_dv, ref_distance2_dv);
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    EXPECT_EQ(index.SearchKNN(pc.points_, 10, indices_dv, distance2_dv), 1);
+
+    thrust::host_vector<float> ref_distance2 = ref_distance2_dv;
+    thrust::host_vector<float> distance2 = distance2_dv;
+    ExpectEQ(ref_distance2, distance2);
+}
+
+TEST(IncrementalKDTreeFlann, RemovePoints) {
+    int size = 100;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    utility::device_vector<Eigen::Vector3f> points_dv = points;
+
+    geometry::IncrementalKDTreeFlann index(1.0);
+    index.InsertPoints(points_dv);
+
+    thrust::host_vector<int> removed;
+    for (int i = 0; i < size; i += 2) removed.push_back(i);
+    utility::device_vector<int> removed_dv = removed;
+    EXPECT_EQ(index.RemovePoints(removed_dv), size / 2);
+    EXPECT_EQ(index.RemovePoints(removed_dv), 0);
+    EXPECT_EQ(index.GetNumPoints(), size / 2);
+
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    index.SearchKNN(points_dv, 1, indices_dv, distance2_dv);
+    thrust::host_vector<int> indices = indices_dv;
+    for (int i = 0; i < size; ++i) {
+        EXPECT_EQ(indices[i] % 2, 1);
+        if (i % 2 == 1) EXPECT_EQ(indices[i], i);
+    }
+
+    index.Rebuild();
+    EXPECT_EQ(index.GetNumSubTrees(), 1);
+    index.SearchKNN(points_dv, 1, indices_dv, distance2_dv);
+    thrust::host_vector<int> rebuilt_indices = indices_dv;
+    ExpectEQ(indices, rebuilt_indices);
+}
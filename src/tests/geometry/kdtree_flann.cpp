@@ -160,4 +160,46 @@ TEST(KDTreeFlann, SearchHybrid) {
     thrust::sort(distance2.begin(), distance2.end());
     ExpectEQ(ref_indices, indices);
     ExpectEQ(ref_distance2, distance2);
-}
\ No newline at end of file
+}
+TEST(KDTreeFlann, SearchRadiusCSR) {
+    int size = 100;
+
+    geometry::PointCloud pc;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    pc.SetPoints(points);
+
+    geometry::KDTreeFlann kdtree(pc);
+
+    float radius = 3.0;
+    int max_nn = 10;
+    utility::device_vector<int> dense_indices_dv;
+    utility::device_vector<float> dense_distance2_dv;
+    kdtree.SearchHybrid(pc.points_, radius, max_nn, dense_indices_dv,
+                        dense_distance2_dv);
+    thrust::host_vector<int> dense_indices = dense_indices_dv;
+    thrust::host_vector<int> ref_offsets(1, 0);
+    thrust::host_vector<int> ref_indices;
+    for (int i = 0; i < size; ++i) {
+        for (int k = 0; k < max_nn; ++k) {
+            if (dense_indices[i * max_nn + k] >= 0)
+                ref_indices.push_back(dense_indices[i * max_nn + k]);
+        }
+        ref_offsets.push_back(ref_indices.size());
+    }
+
+    utility::device_vector<int> offsets_dv;
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    int result = kdtree.SearchRadiusCSR(pc.points_, radius, max_nn, offsets_dv,
+                                        indices_dv, distance2_dv);
+    EXPECT_EQ(result, ref_indices.size());
+    thrust::host_vector<int> offsets = offsets_dv;
+    thrust::host_vector<int> indices = indices_dv;
+    ExpectEQ(ref_offsets, offsets);
+    ExpectEQ(ref_indices, indices);
+}
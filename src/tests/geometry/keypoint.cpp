@@ -0,0 +1,48 @@
+#include "cupoch/geometry/keypoint.h"
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+std::shared_ptr<geometry::PointCloud> CubeSurface(int n) {
+    thrust::host_vector<Vector3f> points;
+    const float step = 1.0 / (n - 1);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            for (int k = 0; k < n; ++k) {
+                if (i == 0 || j == 0 || k == 0 || i == n - 1 ||
+                    j == n - 1 || k == n - 1) {
+                    points.push_back(Vector3f(i * step, j * step, k * step));
+                }
+            }
+        }
+    }
+    auto pc = std::make_shared<geometry::PointCloud>();
+    pc->SetPoints(points);
+    return pc;
+}
+
+}  // namespace
+
+TEST(Keypoint, ComputeISSKeypoints) {
+    auto pc = CubeSurface(11);
+    auto indices = geometry::ComputeISSKeypointIndices(*pc, 0.25, 0.2);
+    EXPECT_GT(indices.size(), 0);
+    EXPECT_LT(indices.size(), pc->points_.size());
+    auto keypoints = geometry::ComputeISSKeypoints(*pc, 0.25, 0.2);
+    EXPECT_EQ(keypoints->points_.size(), indices.size());
+}
+
+TEST(Keypoint, ComputeHarris3DKeypoints) {
+    auto pc = CubeSurface(11);
+    pc->EstimateNormals(geometry::KDTreeSearchParamKNN(10));
+    auto indices = geometry::ComputeHarris3DKeypointIndices(*pc, 0.2);
+    EXPECT_GT(indices.size(), 0);
+    EXPECT_LT(indices.size(), pc->points_.size());
+}
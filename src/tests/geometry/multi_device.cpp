@@ -0,0 +1,83 @@
+#include "cupoch/geometry/multi_device.h"
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+// Three slabs on the first device, so that the halo exchange is exercised
+// on machines with a single GPU.
+const std::vector<int> kDevices = {0, 0, 0};
+
+}  // namespace
+
+TEST(MultiDevicePointCloudProcessor, VoxelDownSample) {
+    size_t size = 1000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    geometry::PointCloud pc(points);
+
+    const float voxel_size = 100.0;
+    auto ref_pc = pc.VoxelDownSample(voxel_size);
+    geometry::MultiDevicePointCloudProcessor processor(kDevices);
+    auto output_pc = processor.VoxelDownSample(pc, voxel_size);
+    EXPECT_EQ(ref_pc->points_.size(), output_pc->points_.size());
+
+    auto ref_pt = ref_pc->GetPoints();
+    auto output_pt = output_pc->GetPoints();
+    sort::Do(ref_pt);
+    sort::Do(output_pt);
+    ExpectEQ(ref_pt, output_pt);
+}
+
+TEST(MultiDevicePointCloudProcessor, RemoveOutliers) {
+    size_t size = 500;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(10.0, 10.0, 10.0), 0);
+    points[0] = Vector3f(100.0, 100.0, 100.0);
+    geometry::PointCloud pc(points);
+    geometry::MultiDevicePointCloudProcessor processor(kDevices);
+
+    thrust::host_vector<size_t> ref_radius =
+            std::get<1>(pc.RemoveRadiusOutliers(3, 1.0));
+    thrust::host_vector<size_t> radius =
+            std::get<1>(processor.RemoveRadiusOutliers(pc, 3, 1.0));
+    EXPECT_EQ(ref_radius.size(), radius.size());
+    for (size_t i = 0; i < std::min(ref_radius.size(), radius.size()); ++i) {
+        EXPECT_EQ(ref_radius[i], radius[i]);
+    }
+
+    thrust::host_vector<size_t> ref_stat =
+            std::get<1>(pc.RemoveStatisticalOutliers(10, 1.0));
+    thrust::host_vector<size_t> stat =
+            std::get<1>(processor.RemoveStatisticalOutliers(pc, 10, 1.0, 5.0));
+    EXPECT_EQ(ref_stat.size(), stat.size());
+    for (size_t i = 0; i < std::min(ref_stat.size(), stat.size()); ++i) {
+        EXPECT_EQ(ref_stat[i], stat[i]);
+    }
+}
+
+TEST(MultiDevicePointCloudProcessor, EstimateNormals) {
+    size_t size = 500;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(10.0, 10.0, 10.0), 0);
+    geometry::PointCloud ref_pc(points);
+    geometry::PointCloud pc(points);
+
+    const geometry::KDTreeSearchParamRadius param(3.0);
+    ref_pc.EstimateNormals(param);
+    geometry::MultiDevicePointCloudProcessor processor(kDevices);
+    EXPECT_TRUE(processor.EstimateNormals(pc, param));
+
+    thrust::host_vector<Vector3f> ref_normals = ref_pc.GetNormals();
+    thrust::host_vector<Vector3f> normals = pc.GetNormals();
+    ASSERT_EQ(ref_normals.size(), normals.size());
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_NEAR(std::abs(ref_normals[i].dot(normals[i])), 1.0, 1e-4);
+    }
+}
@@ -0,0 +1,56 @@
+#include "cupoch/geometry/neighborhood_cache.h"
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/registration/feature.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(NeighborhoodCache, SharedAcrossStages) {
+    size_t size = 500;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 0);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    geometry::PointCloud ref_pc;
+    ref_pc.SetPoints(points);
+
+    geometry::NeighborhoodCache cache(pc);
+    const auto &neighborhood =
+            cache.GetNeighborhood(geometry::KDTreeSearchParamKNN(30));
+    EXPECT_EQ(neighborhood.knn_, 30);
+    EXPECT_EQ(neighborhood.indices_.size(), size * 30);
+
+    // The smaller neighborhoods are sliced from the cached one.
+    auto ref_res = ref_pc.RemoveStatisticalOutliers(20, 1.0);
+    auto res = pc.RemoveStatisticalOutliers(cache, 20, 1.0);
+    thrust::host_vector<size_t> ref_inliers = std::get<1>(ref_res);
+    thrust::host_vector<size_t> inliers = std::get<1>(res);
+    EXPECT_TRUE(ref_inliers == inliers);
+
+    ref_pc.EstimateNormals(geometry::KDTreeSearchParamKNN(20));
+    EXPECT_TRUE(pc.EstimateNormals(cache, geometry::KDTreeSearchParamKNN(20)));
+    ExpectEQ(ref_pc.GetNormals(), pc.GetNormals());
+
+    auto ref_fpfh = registration::ComputeFPFHFeature(
+            ref_pc, geometry::KDTreeSearchParamKNN(30));
+    auto fpfh = registration::ComputeFPFHFeature(
+            pc, cache, geometry::KDTreeSearchParamKNN(30));
+    thrust::host_vector<registration::Feature<33>::FeatureType> ref_data =
+            ref_fpfh->data_;
+    thrust::host_vector<registration::Feature<33>::FeatureType> data =
+            fpfh->data_;
+    ASSERT_EQ(ref_data.size(), data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        for (int j = 0; j < 33; ++j) {
+            EXPECT_NEAR(ref_data[i][j], data[i][j], 1.0e-4);
+        }
+    }
+    EXPECT_EQ(cache.GetNumSearches(), (size_t)1);
+
+    geometry::NeighborhoodCache other_cache(ref_pc);
+    EXPECT_FALSE(pc.EstimateNormals(other_cache));
+}
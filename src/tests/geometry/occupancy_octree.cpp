@@ -0,0 +1,57 @@
+#include "cupoch/geometry/occupancy_octree.h"
+#include "cupoch/geometry/occupancygrid.h"
+#include "cupoch/geometry/voxelgrid.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(OccupancyOctree, Insert) {
+    geometry::OccupancyOctree octree(1.0);
+    thrust::host_vector<Eigen::Vector3f> host_points;
+    host_points.push_back({0.5, 0.5, 3.5});
+    octree.Insert(host_points, Eigen::Vector3f(0.5, 0.5, 0.5));
+    EXPECT_EQ(octree.GetNumNodes(), 4);
+    auto free1 = octree.GetProbLog(Eigen::Vector3f(0.5, 0.5, 1.5));
+    EXPECT_TRUE(thrust::get<0>(free1));
+    EXPECT_FLOAT_EQ(thrust::get<1>(free1), octree.prob_miss_log_);
+    EXPECT_TRUE(octree.IsOccupied(Eigen::Vector3f(0.5, 0.5, 3.5)));
+    EXPECT_TRUE(octree.IsUnknown(Eigen::Vector3f(0.5, 0.5, 4.5)));
+    // The cell of 4^3 leaves holds the maximum of its leaves.
+    EXPECT_FALSE(octree.IsOccupied(Eigen::Vector3f(0.5, 0.5, 1.5)));
+    EXPECT_TRUE(octree.IsOccupied(Eigen::Vector3f(0.5, 0.5, 1.5), 2));
+    EXPECT_EQ(octree.ExtractOccupiedVoxels(0)->voxels_keys_.size(), 1);
+    EXPECT_EQ(octree.ExtractOccupiedVoxels(2)->voxels_keys_.size(), 1);
+}
+
+TEST(OccupancyOctree, PruneAndExpand) {
+    geometry::OccupancyGrid grid(1.0, 16);
+    for (int i = 0; i < 8; ++i) {
+        grid.AddVoxel(Eigen::Vector3i(8 + (i >> 2), 8 + ((i >> 1) & 1),
+                                      8 + (i & 1)),
+                      true);
+    }
+    auto octree = geometry::OccupancyOctree::CreateFromOccupancyGrid(grid);
+    EXPECT_FLOAT_EQ(octree->prob_hit_log_, grid.prob_hit_log_);
+    // The 8 leaves of [0, 2)^3 are merged into one node.
+    EXPECT_EQ(octree->GetNumNodes(), 1);
+    EXPECT_TRUE(octree->IsOccupied(Eigen::Vector3f(1.5, 0.5, 1.5)));
+    EXPECT_TRUE(octree->IsUnknown(Eigen::Vector3f(2.5, 0.5, 0.5)));
+    EXPECT_EQ(octree->ExtractOccupiedVoxels(0)->voxels_keys_.size(), 8);
+    EXPECT_EQ(octree->ExtractOccupiedVoxels(1)->voxels_keys_.size(), 1);
+
+    // A hit on one leaf splits the node again.
+    thrust::host_vector<Eigen::Vector3f> host_points;
+    host_points.push_back({1.5, 1.5, 1.5});
+    octree->Insert(host_points, Eigen::Vector3f(1.5, 1.5, 1.5));
+    EXPECT_EQ(octree->GetNumNodes(), 8);
+    // The values of the grid are quantized.
+    const float tol = geometry::CompactOccupancyVoxel::kProbLogResolution;
+    auto hit = octree->GetProbLog(Eigen::Vector3f(1.5, 1.5, 1.5));
+    EXPECT_NEAR(thrust::get<1>(hit), 2.0 * octree->prob_hit_log_, tol);
+    auto other = octree->GetProbLog(Eigen::Vector3f(0.5, 0.5, 0.5));
+    EXPECT_NEAR(thrust::get<1>(other), octree->prob_hit_log_, tol);
+}
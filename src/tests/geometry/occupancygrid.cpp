@@ -7,6 +7,12 @@ using namespace cupoch;
 using namespace std;
 using namespace unit_test;
 
+namespace {
+// The log odds are stored quantized, each update within half a step.
+const float kProbLogTol =
+        2.0 * geometry::CompactOccupancyVoxel::kProbLogResolution;
+}
+
 TEST(OccupancyGrid, Bounds) {
     auto occupancy_grid = std::make_shared<geometry::OccupancyGrid>();
     EXPECT_FLOAT_EQ(occupancy_grid->voxel_size_, 0.05);
@@ -29,15 +35,15 @@ TEST(OccupancyGrid, GetVoxel) {
     occupancy_grid->AddVoxel(Eigen::Vector3i(h_res + 1, h_res, h_res), true);
     auto res1 = occupancy_grid->GetVoxel(Eigen::Vector3f(1.5, 0.0, 0.0));
     EXPECT_TRUE(thrust::get<0>(res1));
-    EXPECT_FLOAT_EQ(thrust::get<1>(res1).prob_log_, occupancy_grid->prob_hit_log_);
+    EXPECT_NEAR(thrust::get<1>(res1).prob_log_, occupancy_grid->prob_hit_log_, kProbLogTol);
     occupancy_grid->AddVoxel(Eigen::Vector3i(h_res + 1, h_res, h_res), true);
     auto res2 = occupancy_grid->GetVoxel(Eigen::Vector3f(1.5, 0.0, 0.0));
     EXPECT_TRUE(thrust::get<0>(res2));
-    EXPECT_FLOAT_EQ(thrust::get<1>(res2).prob_log_, 2.0 * occupancy_grid->prob_hit_log_);
+    EXPECT_NEAR(thrust::get<1>(res2).prob_log_, 2.0 * occupancy_grid->prob_hit_log_, kProbLogTol);
     occupancy_grid->AddVoxel(Eigen::Vector3i(h_res + 1, h_res, h_res), false);
     auto res3 = occupancy_grid->GetVoxel(Eigen::Vector3f(1.5, 0.0, 0.0));
     EXPECT_TRUE(thrust::get<0>(res3));
-    EXPECT_FLOAT_EQ(thrust::get<1>(res3).prob_log_, 2.0 * occupancy_grid->prob_hit_log_ + occupancy_grid->prob_miss_log_);
+    EXPECT_NEAR(thrust::get<1>(res3).prob_log_, 2.0 * occupancy_grid->prob_hit_log_ + occupancy_grid->prob_miss_log_, kProbLogTol);
 }
 
 TEST(OccupancyGrid, Insert) {
@@ -58,4 +64,173 @@ TEST(OccupancyGrid, Insert) {
     EXPECT_TRUE(thrust::get<0>(res4));
     auto res5 = occupancy_grid->GetVoxel(Eigen::Vector3f(0.0, 0.0, 4.5));
     EXPECT_FALSE(thrust::get<0>(res5));
-}
\ No newline at end of file
+}
+TEST(OccupancyGrid, InsertUpdatesVoxelsOncePerScan) {
+    auto occupancy_grid = std::make_shared<geometry::OccupancyGrid>();
+    occupancy_grid->origin_ = Eigen::Vector3f(-0.5, -0.5, 0);
+    occupancy_grid->voxel_size_ = 1.0;
+    thrust::host_vector<Eigen::Vector3f> host_points;
+    host_points.push_back({0.0, 0.0, 3.5});
+    host_points.push_back({0.0, 0.0, 3.5});
+    host_points.push_back({0.1, 0.1, 3.5});
+    // The ray to an occupied voxel must not clear another hit of the scan.
+    host_points.push_back({0.0, 0.0, 5.5});
+    occupancy_grid->Insert(host_points, Eigen::Vector3f::Zero());
+    auto free1 = occupancy_grid->GetVoxel(Eigen::Vector3f(0.0, 0.0, 1.5));
+    EXPECT_NEAR(thrust::get<1>(free1).prob_log_,
+                occupancy_grid->prob_miss_log_, kProbLogTol);
+    auto hit1 = occupancy_grid->GetVoxel(Eigen::Vector3f(0.0, 0.0, 3.5));
+    EXPECT_NEAR(thrust::get<1>(hit1).prob_log_,
+                occupancy_grid->prob_hit_log_, kProbLogTol);
+    EXPECT_TRUE(occupancy_grid->IsOccupied(Eigen::Vector3f(0.0, 0.0, 5.5)));
+    EXPECT_EQ(occupancy_grid->ExtractKnownVoxels()->size(), 6);
+
+    // The next scan updates the same voxels again.
+    occupancy_grid->Insert(host_points, Eigen::Vector3f::Zero());
+    auto free2 = occupancy_grid->GetVoxel(Eigen::Vector3f(0.0, 0.0, 1.5));
+    EXPECT_NEAR(thrust::get<1>(free2).prob_log_,
+                2.0 * occupancy_grid->prob_miss_log_, kProbLogTol);
+}
+
+TEST(OccupancyGrid, MoveOrigin) {
+    geometry::OccupancyGrid occupancy_grid(1.0, 16);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(0, 8, 8), true);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(10, 8, 8), true);
+    occupancy_grid.MoveOrigin(Eigen::Vector3f(3.2, 0.0, 0.0));
+    ExpectEQ(occupancy_grid.origin_, Eigen::Vector3f(3.0, 0.0, 0.0));
+    EXPECT_TRUE(occupancy_grid.IsOccupied(Eigen::Vector3f(2.5, 0.5, 0.5)));
+    EXPECT_TRUE(occupancy_grid.IsUnknown(Eigen::Vector3f(-7.5, 0.5, 0.5)));
+    // Stored where the voxel at -7.5 was, cleared when it scrolled in.
+    EXPECT_TRUE(occupancy_grid.IsUnknown(Eigen::Vector3f(8.5, 0.5, 0.5)));
+    auto voxels = occupancy_grid.ExtractOccupiedVoxels();
+    EXPECT_EQ(voxels->size(), 1);
+    geometry::OccupancyVoxel v = (*voxels)[0];
+    EXPECT_EQ(v.grid_index_.cast<int>(), Eigen::Vector3i(7, 8, 8));
+
+    thrust::host_vector<Eigen::Vector3f> host_points;
+    host_points.push_back({8.5, 0.5, 0.5});
+    occupancy_grid.Insert(host_points, Eigen::Vector3f(3.5, 0.5, 0.5));
+    EXPECT_TRUE(occupancy_grid.IsOccupied(Eigen::Vector3f(8.5, 0.5, 0.5)));
+    auto free = occupancy_grid.GetVoxel(Eigen::Vector3f(5.5, 0.5, 0.5));
+    EXPECT_NEAR(thrust::get<1>(free).prob_log_,
+                occupancy_grid.prob_miss_log_, kProbLogTol);
+}
+
+TEST(OccupancyGrid, CompactVoxels) {
+    EXPECT_EQ(sizeof(geometry::CompactOccupancyVoxel), 2);
+    geometry::OccupancyGrid occupancy_grid(1.0, 16);
+    EXPECT_TRUE(occupancy_grid.IsUnknown(Eigen::Vector3f(0.5, 0.5, 0.5)));
+    // Exactly on the threshold is free, as with IsOccupied().
+    occupancy_grid.prob_hit_log_ = 0.5;
+    occupancy_grid.occ_prob_thres_log_ = 0.5;
+    occupancy_grid.AddVoxel(Eigen::Vector3i(8, 8, 8), true);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(9, 8, 8), true);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(9, 8, 8), true);
+    EXPECT_FALSE(occupancy_grid.IsOccupied(Eigen::Vector3f(0.5, 0.5, 0.5)));
+    EXPECT_TRUE(occupancy_grid.IsOccupied(Eigen::Vector3f(1.5, 0.5, 0.5)));
+    EXPECT_EQ(occupancy_grid.ExtractKnownVoxels()->size(), 2);
+    EXPECT_EQ(occupancy_grid.ExtractFreeVoxels()->size(), 1);
+    auto occupied = occupancy_grid.ExtractOccupiedVoxels();
+    ASSERT_EQ(occupied->size(), 1);
+    geometry::OccupancyVoxel v = (*occupied)[0];
+    EXPECT_EQ(v.grid_index_.cast<int>(), Eigen::Vector3i(9, 8, 8));
+    EXPECT_FLOAT_EQ(v.prob_log_, 1.0);
+    // Clamped.
+    for (int i = 0; i < 10; ++i) {
+        occupancy_grid.AddVoxel(Eigen::Vector3i(9, 8, 8), true);
+    }
+    auto res = occupancy_grid.GetVoxel(Eigen::Vector3f(1.5, 0.5, 0.5));
+    EXPECT_FLOAT_EQ(thrust::get<1>(res).prob_log_,
+                    occupancy_grid.clamping_thres_max_);
+}
+
+TEST(OccupancyGrid, GetVoxels) {
+    geometry::OccupancyGrid occupancy_grid(1.0, 16);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(10, 8, 8), true);
+    occupancy_grid.MoveOrigin(Eigen::Vector3f(3.0, 0.0, 0.0));
+    thrust::host_vector<Eigen::Vector3f> host_points;
+    host_points.push_back({2.5, 0.5, 0.5});
+    host_points.push_back({3.5, 0.5, 0.5});
+    host_points.push_back({100.0, 0.5, 0.5});
+    utility::device_vector<int> indices;
+    utility::device_vector<geometry::CompactOccupancyVoxel> voxels;
+    occupancy_grid.GetVoxels(utility::device_vector<Eigen::Vector3f>(host_points),
+                             indices, voxels);
+    thrust::host_vector<int> h_indices = indices;
+    thrust::host_vector<geometry::CompactOccupancyVoxel> h_voxels = voxels;
+    EXPECT_GE(h_indices[0], 0);
+    EXPECT_NEAR(h_voxels[0].GetProbLog(), occupancy_grid.prob_hit_log_, kProbLogTol);
+    EXPECT_TRUE(h_voxels[1].IsUnknown());
+    EXPECT_EQ(h_indices[2], -1);
+    EXPECT_TRUE(h_voxels[2].IsUnknown());
+}
+
+TEST(OccupancyGrid, FrontierVoxels) {
+    geometry::OccupancyGrid occupancy_grid(1.0, 16);
+    // Free voxels in the middle of unknown space, two of them adjacent.
+    occupancy_grid.AddVoxel(Eigen::Vector3i(4, 4, 4), false);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(5, 5, 4), false);
+    occupancy_grid.AddVoxel(Eigen::Vector3i(10, 10, 10), false);
+    auto frontiers = occupancy_grid.ExtractFrontierVoxels();
+    EXPECT_EQ(frontiers->size(), 3);
+    thrust::host_vector<int> labels = occupancy_grid.ClusterFrontierVoxels(*frontiers);
+    ASSERT_EQ(labels.size(), 3);
+    EXPECT_EQ(labels[0], labels[1]);
+    EXPECT_NE(labels[0], labels[2]);
+    labels = occupancy_grid.ClusterFrontierVoxels(*frontiers, 2);
+    EXPECT_EQ(labels[0], 0);
+    EXPECT_EQ(labels[1], 0);
+    EXPECT_EQ(labels[2], -1);
+}
+
+TEST(OccupancyGrid, ComputeInformationGain) {
+    geometry::OccupancyGrid occupancy_grid(1.0, 16);
+    // Wall 3 voxels in front of the second view.
+    occupancy_grid.AddVoxel(Eigen::Vector3i(11, 8, 8), true);
+    thrust::host_vector<Eigen::Matrix4f_u> poses(2, Eigen::Matrix4f_u::Identity());
+    poses[0](1, 3) = 3.5;
+    poses[1](1, 3) = 0.5;
+    poses[0](0, 3) = poses[1](0, 3) = 0.5;
+    poses[0](2, 3) = poses[1](2, 3) = 0.5;
+    thrust::host_vector<Eigen::Vector3f> dirs(1, Eigen::Vector3f::UnitX());
+    thrust::host_vector<int> gains = occupancy_grid.ComputeInformationGain(
+            utility::device_vector<Eigen::Matrix4f_u>(poses),
+            utility::device_vector<Eigen::Vector3f>(dirs), 5.0);
+    ASSERT_EQ(gains.size(), 2);
+    EXPECT_EQ(gains[0], 6);
+    EXPECT_EQ(gains[1], 3);
+}
+
+TEST(OccupancyGrid, ExportAndApplyDelta) {
+    geometry::OccupancyGrid sender(1.0, 16);
+    geometry::OccupancyGrid receiver(1.0, 16);
+    sender.AddVoxel(Eigen::Vector3i(3, 4, 5), true);
+    sender.EnableChangeTracking();
+    sender.AddVoxel(Eigen::Vector3i(6, 6, 6), false);
+
+    // The voxels known before the tracking are in the first delta.
+    geometry::OccupancyGridDelta delta = sender.ExportDelta(0);
+    EXPECT_EQ(delta.GetNumVoxels(), 2);
+    geometry::OccupancyGridDelta decoded;
+    EXPECT_FALSE(decoded.Deserialize(std::vector<uint8_t>(4, 0)));
+    EXPECT_TRUE(decoded.Deserialize(delta.Serialize()));
+    EXPECT_EQ(decoded.GetNumVoxels(), 2);
+    EXPECT_EQ(decoded.to_version_, sender.GetVersion());
+    receiver.ApplyDelta(decoded);
+    EXPECT_EQ(receiver.ExtractOccupiedVoxels()->size(), 1);
+    EXPECT_EQ(receiver.ExtractFreeVoxels()->size(), 1);
+    EXPECT_TRUE(receiver.IsOccupied(Eigen::Vector3f(-4.5, -3.5, -2.5)));
+
+    // Updates that keep the state of the voxel are not sent.
+    const unsigned int version = sender.GetVersion();
+    sender.AddVoxel(Eigen::Vector3i(3, 4, 5), true);
+    EXPECT_EQ(sender.ExportDelta(version).GetNumVoxels(), 0);
+    for (int i = 0; i < 5; ++i) {
+        sender.AddVoxel(Eigen::Vector3i(3, 4, 5), false);
+    }
+    delta = sender.ExportDelta(version);
+    EXPECT_EQ(delta.GetNumVoxels(), 1);
+    receiver.ApplyDelta(delta);
+    EXPECT_EQ(receiver.ExtractOccupiedVoxels()->size(), 0);
+    EXPECT_EQ(receiver.ExtractFreeVoxels()->size(), 2);
+}
@@ -2,8 +2,17 @@
 
 #include <gtest/gtest.h>
 #include <thrust/unique.h>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <limits>
 
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
 #include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/kdtree_flann.h"
+#include "cupoch/geometry/pointcloud_pipeline.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/utility/dl_converter.h"
 #include "tests/test_utility/unit_test.h"
 
 using namespace Eigen;
@@ -120,6 +129,52 @@ TEST(PointCloud, GetMaxBound) {
     ExpectEQ(Vector3f(996.078431, 996.078431, 996.078431), pc.GetMaxBound());
 }
 
+TEST(PointCloud, ComputePointStatistics) {
+    int size = 100;
+
+    Vector3f vmin(1000.0, 1000.0, 1000.0);
+    Vector3f vmax(1010.0, 1010.0, 1010.0);
+
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    pc.SetPoints(points);
+
+    Vector3f min_bound = points[0];
+    Vector3f max_bound = points[0];
+    Vector3d mean = Vector3d::Zero();
+    for (const auto &pt : points) {
+        min_bound = min_bound.cwiseMin(pt);
+        max_bound = max_bound.cwiseMax(pt);
+        mean += pt.cast<double>();
+    }
+    mean /= size;
+    Matrix3d covariance = Matrix3d::Zero();
+    for (const auto &pt : points) {
+        const Vector3d d = pt.cast<double>() - mean;
+        covariance += d * d.transpose();
+    }
+    covariance /= size;
+
+    const auto stats = pc.ComputePointStatistics(pc.points_, true);
+    EXPECT_EQ(stats.num_points_, size);
+    ExpectEQ(min_bound, stats.min_bound_);
+    ExpectEQ(max_bound, stats.max_bound_);
+    ExpectEQ(Vector3f(mean.cast<float>()), stats.mean_, 1.0e-3);
+    EXPECT_TRUE(stats.covariance_.isApprox(covariance.cast<float>(), 1.0e-3));
+
+    const auto box = pc.GetAxisAlignedBoundingBox();
+    ExpectEQ(pc.GetMinBound(), box.min_bound_);
+    ExpectEQ(pc.GetMaxBound(), box.max_bound_);
+
+    Vector3f mean_f;
+    Matrix3f covariance_f;
+    std::tie(mean_f, covariance_f) = pc.ComputeMeanAndCovariance();
+    ExpectEQ(stats.mean_, mean_f);
+    ExpectEQ(stats.covariance_, covariance_f);
+}
+
 TEST(PointCloud, Transform) {
     thrust::host_vector<Vector3f> ref_points;
     ref_points.push_back(Vector3f(1.411252, 4.274168, 3.130918));
@@ -170,6 +225,40 @@ TEST(PointCloud, Transform) {
     ExpectEQ(ref_normals, pc.GetNormals());
 }
 
+TEST(PointCloud, OperatorAppend) {
+    thrust::host_vector<Vector3f> points(100);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    geometry::PointCloud frame;
+    frame.SetPoints(points);
+    frame.SetNormals(points);
+
+    geometry::PointCloud map;
+    for (int i = 0; i < 10; ++i) map += frame;
+    EXPECT_EQ(map.points_.size(), 1000);
+    EXPECT_TRUE(map.HasNormals());
+    EXPECT_GE(map.points_.capacity(), 1000);
+
+    // Added to itself.
+    map += map;
+    EXPECT_EQ(map.points_.size(), 2000);
+    thrust::host_vector<Vector3f> h_points = map.points_;
+    for (int i = 0; i < 2000; ++i) ExpectEQ(points[i % 100], h_points[i]);
+
+    std::vector<std::shared_ptr<geometry::PointCloud>> clouds;
+    for (int i = 0; i < 5; ++i) {
+        clouds.push_back(std::make_shared<geometry::PointCloud>(frame));
+    }
+    geometry::PointCloud appended;
+    appended.Append(clouds);
+    EXPECT_EQ(appended.points_.size(), 500);
+    EXPECT_TRUE(appended.HasNormals());
+    clouds.push_back(std::make_shared<geometry::PointCloud>());
+    clouds.back()->SetPoints(points);
+    appended.Append(clouds);
+    EXPECT_EQ(appended.points_.size(), 1100);
+    EXPECT_FALSE(appended.HasNormals());
+}
+
 TEST(PointCloud, HasPoints) {
     int size = 100;
 
@@ -406,6 +495,57 @@ TEST(PointCloud, VoxelDownSample) {
     ExpectEQ(ref_colors, output_cl);
 }
 
+TEST(PointCloud, VoxelDownSampleHash) {
+    size_t size = 1000;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    pc.SetPoints(points);
+    thrust::host_vector<Vector3f> colors(size);
+    Rand(colors, Zero3f, Vector3f(1.0, 1.0, 1.0), 1);
+    pc.SetColors(colors);
+
+    float voxel_size = 200.0;
+    auto ref_pc = pc.VoxelDownSample(voxel_size);
+    auto output_pc = pc.VoxelDownSample(voxel_size, false);
+    EXPECT_EQ(ref_pc->points_.size(), output_pc->points_.size());
+
+    auto ref_pt = ref_pc->GetPoints();
+    auto ref_cl = ref_pc->GetColors();
+    auto output_pt = output_pc->GetPoints();
+    auto output_cl = output_pc->GetColors();
+    sort::Do(ref_pt);
+    sort::Do(ref_cl);
+    sort::Do(output_pt);
+    sort::Do(output_cl);
+
+    ExpectEQ(ref_pt, output_pt);
+    ExpectEQ(ref_cl, output_cl);
+}
+
+TEST(PointCloud, VoxelDownSampleDeterministicMode) {
+    size_t size = 1000;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    pc.SetPoints(points);
+
+    float voxel_size = 200.0;
+    auto ref_pt = pc.VoxelDownSample(voxel_size)->GetPoints();
+    {
+        // The sort is used, so the points come in the same order.
+        utility::ScopedDeterministicMode deterministic;
+        auto output_pt = pc.VoxelDownSample(voxel_size, false)->GetPoints();
+        ExpectEQ(ref_pt, output_pt);
+    }
+    utility::ExecutionContext ctx;
+    ctx.SetDeterministic(true);
+    auto output_pt = pc.VoxelDownSample(ctx, voxel_size, false)->GetPoints();
+    ExpectEQ(ref_pt, output_pt);
+}
+
 TEST(PointCloud, UniformDownSample) {
     thrust::host_vector<Vector3f> ref;
     ref.push_back(Vector3f(839.215686, 392.156863, 780.392157));
@@ -450,6 +590,124 @@ TEST(PointCloud, UniformDownSample) {
     ExpectEQ(ref, output_pc->GetPoints());
 }
 
+TEST(PointCloud, ApproximateVoxelDownSample) {
+    geometry::PointCloud pc;
+    thrust::host_vector<Vector3f> points;
+    points.push_back(Vector3f(0.1, 0.1, 0.1));
+    points.push_back(Vector3f(0.2, 0.2, 0.2));
+    points.push_back(Vector3f(1.3, 0.1, 0.1));
+    points.push_back(Vector3f(1.4, 0.2, 0.1));
+    points.push_back(Vector3f(0.1, 2.5, 0.1));
+    pc.SetPoints(points);
+
+    auto output_pc = pc.ApproximateVoxelDownSample(1.0);
+    thrust::host_vector<Vector3f> ref;
+    ref.push_back(points[0]);
+    ref.push_back(points[2]);
+    ref.push_back(points[4]);
+    auto output_pt = output_pc->GetPoints();
+    sort::Do(ref);
+    sort::Do(output_pt);
+    ExpectEQ(ref, output_pt);
+}
+
+TEST(PointCloud, RandomDownSample) {
+    size_t size = 100;
+    geometry::PointCloud pc;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    pc.SetPoints(points);
+
+    auto output_pc = pc.RandomDownSample(30, 1);
+    EXPECT_EQ(30, output_pc->points_.size());
+    auto output_pt = output_pc->GetPoints();
+    sort::Do(output_pt);
+    for (size_t i = 1; i < output_pt.size(); ++i) {
+        EXPECT_FALSE(output_pt[i - 1] == output_pt[i]);
+    }
+
+    // Padded with repeated points when more points are requested.
+    geometry::PointCloud padded;
+    utility::ExecutionContext ctx;
+    pc.RandomDownSample(ctx, 150, 1, padded);
+    EXPECT_EQ(150, padded.points_.size());
+}
+
+TEST(PointCloud, FarthestPointDownSample) {
+    geometry::PointCloud pc;
+    thrust::host_vector<Vector3f> points;
+    points.push_back(Vector3f(0.0, 0.0, 0.0));
+    points.push_back(Vector3f(0.1, 0.0, 0.0));
+    points.push_back(Vector3f(10.0, 0.0, 0.0));
+    points.push_back(Vector3f(5.0, 0.0, 0.0));
+    points.push_back(Vector3f(9.9, 0.0, 0.0));
+    pc.SetPoints(points);
+
+    auto output_pc = pc.FarthestPointDownSample(3);
+    thrust::host_vector<Vector3f> ref;
+    ref.push_back(points[0]);
+    ref.push_back(points[2]);
+    ref.push_back(points[3]);
+    ExpectEQ(ref, output_pc->GetPoints());
+}
+
+TEST(PointCloud, DownSampleWithExecutionContext) {
+    size_t size = 100;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    pc.SetPoints(points);
+
+    utility::ExecutionContext ctx;
+    auto ref_uniform = pc.UniformDownSample(4);
+    auto output_uniform = pc.UniformDownSample(ctx, 4);
+    ExpectEQ(ref_uniform->GetPoints(), output_uniform->GetPoints());
+
+    auto ref_voxel = pc.VoxelDownSample(100.0);
+    auto output_voxel = pc.VoxelDownSample(ctx, 100.0);
+    auto ref_pt = ref_voxel->GetPoints();
+    auto output_pt = output_voxel->GetPoints();
+    sort::Do(ref_pt);
+    sort::Do(output_pt);
+    ExpectEQ(ref_pt, output_pt);
+}
+
+TEST(PointCloud, SelectByIndexWithAttributes) {
+    size_t size = 10;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    pc.SetPoints(points);
+
+    thrust::host_vector<float> intensity(size);
+    thrust::host_vector<float> label(size);
+    for (size_t i = 0; i < size; i++) {
+        intensity[i] = 0.5 * i;
+        label[i] = i;
+    }
+    pc.SetAttribute("intensity", intensity);
+    pc.SetAttribute("label", label);
+    EXPECT_TRUE(pc.HasAttributes());
+    EXPECT_EQ(2, pc.GetAttributeDimension());
+    EXPECT_EQ(1, pc.GetAttributeIndex("label"));
+
+    thrust::host_vector<size_t> indices;
+    indices.push_back(1);
+    indices.push_back(4);
+    indices.push_back(7);
+    auto output = pc.SelectByIndex(utility::device_vector<size_t>(indices));
+    EXPECT_TRUE(output->HasAttributes());
+    auto out_label = output->GetAttribute("label");
+    auto out_intensity = output->GetAttribute("intensity");
+    EXPECT_EQ(indices.size(), out_label.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        EXPECT_FLOAT_EQ(label[indices[i]], out_label[i]);
+        EXPECT_FLOAT_EQ(intensity[indices[i]], out_intensity[i]);
+    }
+}
+
 TEST(PointCloud, CropPointCloud) {
     size_t size = 100;
     geometry::PointCloud pc;
@@ -470,6 +728,194 @@ TEST(PointCloud, CropPointCloud) {
     ExpectGE(maxBound, output_pc->GetPoints());
 }
 
+TEST(PointCloud, CropInPlace) {
+    size_t size = 100;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1000.0, 1000.0, 1000.0),
+         0);
+    pc.SetPoints(points);
+    pc.SetNormals(points);
+
+    const geometry::AxisAlignedBoundingBox bbox(Vector3f(200.0, 200.0, 200.0),
+                                                Vector3f(800.0, 800.0, 800.0));
+    auto expected_pc = pc.Crop(bbox);
+    pc.CropInPlace(bbox);
+    ExpectEQ(expected_pc->GetPoints(), pc.GetPoints());
+    ExpectEQ(expected_pc->GetNormals(), pc.GetNormals());
+}
+
+TEST(PointCloud, SelectByMaskInPlace) {
+    thrust::host_vector<Vector3f> points;
+    thrust::host_vector<bool> h_mask;
+    for (int i = 0; i < 10; ++i) {
+        points.push_back(Vector3f(i, 0.0, 0.0));
+        h_mask.push_back(i % 3 == 0);
+    }
+    geometry::PointCloud pc(points);
+    thrust::host_vector<float> intensity(points.size());
+    for (int i = 0; i < 10; ++i) intensity[i] = i;
+    pc.SetAttribute("intensity", intensity);
+    pc.SetAttribute("label", intensity);
+    const utility::device_vector<bool> mask = h_mask;
+
+    geometry::PointCloud inverted = pc;
+    pc.SelectByMaskInPlace(mask);
+    ASSERT_EQ(pc.points_.size(), 4);
+    EXPECT_TRUE(pc.HasAttributes());
+    const thrust::host_vector<float> labels = pc.GetAttribute("label");
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(pc.GetPoints()[i](0), 3 * i);
+        EXPECT_EQ(labels[i], 3 * i);
+    }
+    inverted.SelectByMaskInPlace(mask, true);
+    EXPECT_EQ(inverted.points_.size(), 6);
+
+    geometry::PointCloud moved(std::move(inverted));
+    EXPECT_EQ(moved.points_.size(), 6);
+    EXPECT_TRUE(moved.HasAttributes());
+}
+
+TEST(PointCloud, SelectByMask) {
+    size_t size = 100;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1000.0, 1000.0, 1000.0),
+         0);
+    pc.SetPoints(points);
+    pc.SetColors(points);
+
+    const geometry::AxisAlignedBoundingBox bbox(Vector3f(200.0, 200.0, 200.0),
+                                                Vector3f(800.0, 800.0, 800.0));
+    auto expected_pc = pc.Crop(bbox);
+    geometry::SelectionMask mask = pc.ComputeCropMask(bbox);
+    EXPECT_EQ(mask.Count(), expected_pc->points_.size());
+    auto output_pc = pc.SelectByMask(mask);
+    ExpectEQ(expected_pc->GetPoints(), output_pc->GetPoints());
+    ExpectEQ(expected_pc->GetColors(), output_pc->GetColors());
+    EXPECT_EQ(pc.SelectByMask(mask, true)->points_.size() +
+                      output_pc->points_.size(),
+              size);
+
+    mask.And(pc.ComputeRadiusInlierMask(1, 300.0));
+    auto radius_pc = std::get<0>(pc.RemoveRadiusOutliers(1, 300.0));
+    EXPECT_EQ(pc.SelectByMask(mask)->points_.size(),
+              radius_pc->Crop(bbox)->points_.size());
+}
+
+TEST(PointCloud, Pipeline) {
+    size_t size = 1000;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1000.0, 1000.0, 1000.0),
+         0);
+    pc.SetPoints(points);
+
+    Matrix4f T = Matrix4f::Identity();
+    T.block<3, 1>(0, 3) = Vector3f(-100.0, 50.0, 10.0);
+    const geometry::AxisAlignedBoundingBox bbox(Vector3f(200.0, 200.0, 200.0),
+                                                Vector3f(800.0, 800.0, 800.0));
+
+    auto output_pc = pc.Pipeline().Transform(T).Transform(T).Crop(bbox).Run();
+    geometry::PointCloud expected = pc;
+    expected.Transform(T * T);
+    auto expected_pc = expected.Crop(bbox);
+    ExpectEQ(expected_pc->GetPoints(), output_pc->GetPoints(), 1e-3);
+    EXPECT_EQ(pc.Pipeline().Transform(T).Transform(T).GetStages().size(), 1);
+
+    auto down_pc = pc.Pipeline()
+                           .Transform(T)
+                           .Transform(T)
+                           .Crop(bbox)
+                           .VoxelDownSample(100.0)
+                           .Run();
+    auto expected_down_pc = expected_pc->VoxelDownSample(100.0);
+    ExpectEQ(expected_down_pc->GetPoints(), down_pc->GetPoints(), 1e-3);
+
+    thrust::host_vector<Vector3f> nan_points = points;
+    nan_points[0](0) = std::numeric_limits<float>::quiet_NaN();
+    pc.SetPoints(nan_points);
+    EXPECT_EQ(pc.Pipeline().RemoveNonFinite().Run()->points_.size(),
+              size - 1);
+}
+
+TEST(PointCloud, TransformBatch) {
+    thrust::host_vector<Vector3f> points;
+    points.push_back(Vector3f(1.0, 0.0, 0.0));
+    points.push_back(Vector3f(0.0, 2.0, 0.0));
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetNormals(points);
+    std::vector<Matrix4f_u> transformations(3, Matrix4f::Identity());
+    transformations[1](0, 3) = 1.0;
+    transformations[2].block<3, 3>(0, 0) =
+            AngleAxisf(M_PI / 2, Vector3f::UnitZ()).toRotationMatrix();
+
+    auto batch = pc.TransformBatch(transformations);
+    EXPECT_EQ(6, batch->points_.size());
+    EXPECT_TRUE(batch->HasNormals());
+    for (int i = 0; i < 3; ++i) {
+        geometry::PointCloud ref = pc;
+        ref.Transform(transformations[i]);
+        for (int j = 0; j < 2; ++j) {
+            ExpectEQ(ref.GetPoints()[j], batch->GetPoints()[i * 2 + j]);
+            ExpectEQ(ref.GetNormals()[j], batch->GetNormals()[i * 2 + j]);
+        }
+    }
+
+    auto other = std::make_shared<geometry::PointCloud>();
+    other->SetPoints(thrust::host_vector<Vector3f>(3, Vector3f(0.0, 0.0, 1.0)));
+    std::vector<std::shared_ptr<geometry::PointCloud>> clouds = {
+            std::make_shared<geometry::PointCloud>(pc), other};
+    auto result = geometry::PointCloud::TransformBatch(
+            clouds, std::vector<Matrix4f_u>(transformations.begin() + 1,
+                                            transformations.end()));
+    auto concat = std::get<0>(result);
+    thrust::host_vector<int> offsets = std::get<1>(result);
+    int offsets0[] = {0, 2, 5};
+    ExpectEQ(thrust::host_vector<int>(offsets0, offsets0 + 3), offsets);
+    EXPECT_FALSE(concat->HasNormals());
+    ExpectEQ(Vector3f(2.0, 0.0, 0.0), Vector3f(concat->GetPoints()[0]));
+    ExpectEQ(Vector3f(0.0, 0.0, 1.0), Vector3f(concat->GetPoints()[4]));
+}
+
+TEST(PointCloud, Deskew) {
+    thrust::host_vector<Vector3f> points(4, Vector3f(1.0, 0.0, 0.0));
+    thrust::host_vector<float> times(4);
+    times[0] = 0.0;
+    times[1] = 0.5;
+    times[2] = 1.0;
+    times[3] = 2.0;
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetAttribute("time", times);
+
+    // The sensor moves by 1 along x and turns by pi / 2 during the scan.
+    Matrix4f end_pose = Matrix4f::Identity();
+    end_pose.block<3, 3>(0, 0) =
+            AngleAxisf(M_PI / 2, Vector3f::UnitZ()).toRotationMatrix();
+    end_pose(0, 3) = 1.0;
+    geometry::PointCloud start = pc;
+    start.Deskew(Matrix4f::Identity(), end_pose);
+    thrust::host_vector<Vector3f> ref(4);
+    ref[0] = Vector3f(1.0, 0.0, 0.0);
+    ref[1] = Vector3f(0.5 + std::sqrt(0.5), std::sqrt(0.5), 0.0);
+    ref[2] = Vector3f(1.0, 1.0, 0.0);
+    ref[3] = Vector3f(1.0, 1.0, 0.0);
+    ExpectEQ(ref, start.GetPoints());
+
+    std::vector<float> pose_times = {0.0, 1.0};
+    std::vector<Matrix4f_u> poses = {Matrix4f::Identity(), end_pose};
+    geometry::PointCloud end = pc;
+    end.Deskew(pose_times, poses, 1.0);
+    ExpectEQ(Vector3f(1.0, 0.0, 0.0), Vector3f(end.GetPoints()[2]));
+    end.Transform(end_pose);
+    ExpectEQ(ref, end.GetPoints());
+}
+
 TEST(PointCloud, EstimateNormals) {
     thrust::host_vector<Vector3f> ref;
     ref.push_back(Vector3f(0.282003, 0.866394, 0.412111));
@@ -534,6 +980,97 @@ TEST(PointCloud, EstimateNormals) {
     ExpectEQ(ref, normals);
 }
 
+TEST(PointCloud, EstimateNormalsFromNeighbors) {
+    // Points on the plane z = 0.5 x.
+    size_t size = 500;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(-1.0, -1.0, 0.0), Vector3f(1.0, 1.0, 0.0), 0);
+    for (auto &point : points) point(2) = 0.5 * point(0);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    const int knn = 20;
+    geometry::KDTreeFlann kdtree(pc);
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    kdtree.SearchKNN(pc.points_, knn, indices, distance2);
+    utility::device_vector<Vector3f> eigenvalues;
+    utility::device_vector<float> curvatures;
+    EXPECT_FALSE(pc.EstimateNormals(indices, knn + 1));
+    EXPECT_TRUE(pc.EstimateNormals(indices, knn, eigenvalues, curvatures));
+    thrust::host_vector<Vector3f> normals = pc.GetNormals();
+    thrust::host_vector<Vector3f> h_eigenvalues = eigenvalues;
+    thrust::host_vector<float> h_curvatures = curvatures;
+    const Vector3f ref = Vector3f(-0.5, 0.0, 1.0).normalized();
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_NEAR(std::abs(normals[i].dot(ref)), 1.0, 1.0e-3);
+        EXPECT_LE(h_eigenvalues[i](0), h_eigenvalues[i](1));
+        EXPECT_LE(h_eigenvalues[i](1), h_eigenvalues[i](2));
+        EXPECT_NEAR(h_curvatures[i], 0.0, 1.0e-3);
+    }
+
+    geometry::PointCloud ref_pc;
+    ref_pc.SetPoints(points);
+    ref_pc.EstimateNormals(geometry::KDTreeSearchParamKNN(knn));
+    ExpectEQ(ref_pc.GetNormals(), normals);
+
+    auto ref_res = pc.RemoveStatisticalOutliers(knn, 1.0);
+    auto res = pc.RemoveStatisticalOutliers(distance2, knn, 1.0);
+    thrust::host_vector<size_t> ref_inliers = std::get<1>(ref_res);
+    thrust::host_vector<size_t> inliers = std::get<1>(res);
+    EXPECT_TRUE(ref_inliers == inliers);
+}
+
+TEST(PointCloud, RemoveStatisticalOutliersVoxelHash) {
+    size_t size = 500;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(10.0, 10.0, 10.0), 0);
+    points[0] = Vector3f(100.0, 100.0, 100.0);
+    pc.SetPoints(points);
+
+    auto ref_res = pc.RemoveStatisticalOutliers(10, 1.0);
+    auto res = pc.RemoveStatisticalOutliers(
+            10, 1.0, geometry::SearchIndexType::VoxelHash);
+    thrust::host_vector<size_t> ref_inliers = std::get<1>(ref_res);
+    thrust::host_vector<size_t> inliers = std::get<1>(res);
+    EXPECT_TRUE(ref_inliers == inliers);
+    EXPECT_NE(inliers[0], 0);
+}
+
+TEST(PointCloud, EstimateOrganizedNormals) {
+    // A slanted plane z = 1 + 0.5 x seen by a camera looking along +z, with
+    // a hole and a depth step.
+    const int width = 16;
+    const int height = 12;
+    thrust::host_vector<Vector3f> points(width * height);
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            const float x = 0.1 * c;
+            const float y = 0.1 * r;
+            const float z = (r < height / 2) ? 1.0 + 0.5 * x : 5.0 + 0.5 * x;
+            points[r * width + c] = Vector3f(x, y, z);
+        }
+    }
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    points[5 * width + 5] = Vector3f(nan, nan, nan);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    EXPECT_FALSE(pc.EstimateOrganizedNormals(width + 1, height));
+    EXPECT_TRUE(pc.EstimateOrganizedNormals(width, height));
+    const Vector3f ref = Vector3f(0.5, 0.0, -1.0).normalized();
+    thrust::host_vector<Vector3f> normals = pc.GetNormals();
+    for (int i = 0; i < width * height; ++i) {
+        if (i == 5 * width + 5) {
+            EXPECT_FALSE(normals[i].allFinite());
+        } else {
+            ExpectEQ(normals[i], ref);
+        }
+    }
+}
+
 TEST(PointCloud, OrientNormalsToAlignWithDirection) {
     thrust::host_vector<Vector3f> ref;
     ref.push_back(Vector3f(0.282003, 0.866394, 0.412111));
@@ -592,4 +1129,352 @@ TEST(PointCloud, OrientNormalsToAlignWithDirection) {
     pc.OrientNormalsToAlignWithDirection(Vector3f(1.5, 0.5, 3.3));
 
     ExpectEQ(ref, pc.GetNormals());
-}
\ No newline at end of file
+}
+
+TEST(PointCloud, OrientNormalsConsistentTangentPlane) {
+    // Radial normals of a sphere with random signs.
+    const int size = 2000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 0);
+    thrust::host_vector<Vector3f> normals(size);
+    for (int i = 0; i < size; ++i) {
+        points[i].normalize();
+        normals[i] = (i % 3 == 0) ? -points[i] : points[i];
+    }
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetNormals(normals);
+    EXPECT_TRUE(pc.OrientNormalsConsistentTangentPlane(10));
+    normals = pc.GetNormals();
+    const float sign = normals[0].dot(points[0]);
+    for (int i = 0; i < size; ++i) {
+        EXPECT_GT(sign * normals[i].dot(points[i]), 0.0);
+    }
+}
+
+TEST(PointCloud, ClusterDBSCAN) {
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < 5; ++i) points.push_back(Vector3f(0.1 * i, 0.0, 0.0));
+    points.push_back(Vector3f(5.0, 5.0, 5.0));
+    for (int i = 0; i < 5; ++i) points.push_back(Vector3f(10.0, 0.1 * i, 0.0));
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    int labels0[] = {0, 0, 0, 0, 0, -1, 1, 1, 1, 1, 1};
+    thrust::host_vector<int> ref(labels0, labels0 + 11);
+    thrust::host_vector<int> labels = pc.ClusterDBSCAN(0.15, 2);
+    ExpectEQ(ref, labels);
+}
+
+TEST(PointCloud, ClusterEuclidean) {
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < 5; ++i) points.push_back(Vector3f(0.1 * i, 0.0, 0.0));
+    points.push_back(Vector3f(5.0, 5.0, 5.0));
+    for (int i = 0; i < 3; ++i) points.push_back(Vector3f(10.0, 0.1 * i, 0.0));
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    auto result = pc.ClusterEuclidean(0.15, 2);
+    thrust::host_vector<int> indices = std::get<0>(result);
+    thrust::host_vector<int> offsets = std::get<1>(result);
+    int indices0[] = {0, 1, 2, 3, 4, 6, 7, 8};
+    int offsets0[] = {0, 5, 8};
+    ExpectEQ(thrust::host_vector<int>(indices0, indices0 + 8), indices);
+    ExpectEQ(thrust::host_vector<int>(offsets0, offsets0 + 3), offsets);
+}
+
+TEST(PointCloud, SegmentPlane) {
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 20; ++j) {
+            points.push_back(Vector3f(0.1 * i, 0.1 * j, 1.0));
+        }
+    }
+    for (int i = 0; i < 10; ++i) {
+        points.push_back(Vector3f(0.2 * i, 0.1, 3.0 + 0.1 * i));
+    }
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    auto result = pc.SegmentPlane(0.01, 3, 100);
+    const Vector4f plane = std::get<0>(result);
+    thrust::host_vector<size_t> inliers = std::get<1>(result);
+    EXPECT_EQ(400, inliers.size());
+    for (size_t i = 0; i < inliers.size(); ++i) EXPECT_EQ(i, inliers[i]);
+    EXPECT_NEAR(1.0, std::abs(plane(2)), 1.0e-4);
+    EXPECT_NEAR(0.0, plane(2) + plane(3), 1.0e-4);
+}
+
+TEST(PointCloud, SegmentGround) {
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < 37; ++i) {
+        for (int j = 0; j < 64; ++j) {
+            const float r = 3.0 + 0.25 * i;
+            const float theta = 2.0 * M_PI * j / 64;
+            points.push_back(
+                    Vector3f(r * std::cos(theta), r * std::sin(theta), 0.0));
+        }
+    }
+    const size_t n_ground = points.size();
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 7; ++j) {
+            points.push_back(Vector3f(6.0, 0.1 * i - 0.2, 0.5 + 0.25 * j));
+        }
+    }
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    thrust::host_vector<size_t> ground = pc.SegmentGround();
+    EXPECT_EQ(n_ground, ground.size());
+    for (size_t i = 0; i < ground.size(); ++i) EXPECT_EQ(i, ground[i]);
+}
+
+TEST(PointCloud, ProjectToDepthAndIndexImage) {
+    const int width = 8;
+    const int height = 6;
+    camera::PinholeCameraIntrinsic intrinsic(width, height, 4.0, 4.0, 4.0, 3.0);
+    thrust::host_vector<Vector3f> points;
+    points.push_back(Vector3f(0.0, 0.0, 3.0));
+    // In front of the first point, on the same pixel.
+    points.push_back(Vector3f(0.0, 0.0, 2.0));
+    points.push_back(Vector3f(1.0, -0.5, 2.0));
+    // Behind the camera and out of the image.
+    points.push_back(Vector3f(0.0, 0.0, -1.0));
+    points.push_back(Vector3f(10.0, 0.0, 1.0));
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    auto depth = pc.ProjectToDepthImage(intrinsic);
+    auto index = pc.ProjectToIndexImage(intrinsic);
+    EXPECT_EQ(depth->width_, width);
+    EXPECT_EQ(depth->height_, height);
+    thrust::host_vector<uint8_t> depth_bytes = depth->GetData();
+    thrust::host_vector<uint8_t> index_bytes = index->GetData();
+    const float *d = (const float *)depth_bytes.data();
+    const int *idx = (const int *)index_bytes.data();
+    for (int i = 0; i < width * height; ++i) {
+        if (i == 3 * width + 4) {
+            EXPECT_EQ(d[i], 2.0);
+            EXPECT_EQ(idx[i], 1);
+        } else if (i == 2 * width + 6) {
+            EXPECT_EQ(d[i], 2.0);
+            EXPECT_EQ(idx[i], 2);
+        } else {
+            EXPECT_EQ(d[i], 0.0);
+            EXPECT_EQ(idx[i], -1);
+        }
+    }
+
+    // Seen from 1 m further back.
+    Matrix4f extrinsic = Matrix4f::Identity();
+    extrinsic(2, 3) = 1.0;
+    depth = pc.ProjectToDepthImage(intrinsic, extrinsic);
+    depth_bytes = depth->GetData();
+    d = (const float *)depth_bytes.data();
+    EXPECT_EQ(d[3 * width + 4], 3.0);
+}
+
+TEST(PointCloud, UnprojectDepthImage) {
+    const int width = 64;
+    const int height = 48;
+    camera::PinholeCameraIntrinsic intrinsic(width, height, 50.0, 50.0, 32.0,
+                                             24.0);
+    thrust::host_vector<uint16_t> pixels(width * height, 1500);
+    // A band without depth and a band beyond the truncation.
+    for (int i = 0; i < width * 8; ++i) pixels[i] = 0;
+    for (int i = width * 8; i < width * 16; ++i) pixels[i] = 5000;
+    thrust::host_vector<uint8_t> data((uint8_t *)pixels.data(),
+                                      (uint8_t *)pixels.data() +
+                                              pixels.size() * 2);
+    geometry::Image depth;
+    depth.Prepare(width, height, 1, 2);
+    depth.SetData(data);
+    Matrix4f extrinsic = Matrix4f::Identity();
+    extrinsic(0, 3) = 1.0;
+
+    auto ref = geometry::PointCloud::CreateFromDepthImage(
+            depth, intrinsic, extrinsic, 1000.0, 3.0);
+    geometry::PointCloud pc;
+    ASSERT_TRUE(pc.UnprojectDepthImage(depth, intrinsic, extrinsic, 1000.0,
+                                       3.0));
+    EXPECT_EQ(pc.points_.size(), (size_t)(width * (height - 16)));
+    EXPECT_EQ(pc.points_.size(), ref->points_.size());
+    EXPECT_FALSE(pc.HasColors());
+    ExpectEQ(pc.GetMinBound(), ref->GetMinBound());
+    ExpectEQ(pc.GetMaxBound(), ref->GetMaxBound());
+
+    // The next frame reuses the memory of the first one.
+    const Vector3f *ptr = thrust::raw_pointer_cast(pc.points_.data());
+    ASSERT_TRUE(pc.UnprojectDepthImage(depth, intrinsic, extrinsic, 1000.0,
+                                       3.0, 2));
+    EXPECT_EQ(pc.points_.size(), (size_t)(width * (height - 16) / 4));
+    EXPECT_EQ(thrust::raw_pointer_cast(pc.points_.data()), ptr);
+    thrust::host_vector<Vector3f> points = pc.points_;
+    for (const auto &p : points) EXPECT_NEAR(p(2), 1.5, 1.0e-6);
+}
+
+TEST(PointCloud, DLPack) {
+    size_t size = 100;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    auto pc = std::make_shared<geometry::PointCloud>();
+    pc->SetPoints(points);
+
+    // The tensor of an owner shares its memory and keeps it alive.
+    DLManagedTensor *shared = utility::ToDLPack(pc->points_, pc);
+    EXPECT_EQ(shared->dl_tensor.data,
+              (void *)thrust::raw_pointer_cast(pc->points_.data()));
+    EXPECT_EQ(shared->dl_tensor.shape[0], int64_t(size));
+    EXPECT_EQ(shared->dl_tensor.shape[1], 3);
+    std::weak_ptr<geometry::PointCloud> weak = pc;
+    pc.reset();
+    EXPECT_FALSE(weak.expired());
+
+    geometry::PointCloud copied;
+    utility::FromDLPack(shared, copied.points_);
+    ExpectEQ(copied.GetPoints(), points);
+    shared->deleter(shared);
+    EXPECT_TRUE(weak.expired());
+
+    // Without an owner the tensor holds a copy.
+    DLManagedTensor *owned = utility::ToDLPack(copied.points_);
+    EXPECT_NE(owned->dl_tensor.data,
+              (void *)thrust::raw_pointer_cast(copied.points_.data()));
+    geometry::PointCloud imported;
+    utility::FromDLPack(owned, imported.points_);
+    owned->deleter(owned);
+    ExpectEQ(imported.GetPoints(), points);
+
+    // The shape must match the destination.
+    owned = utility::ToDLPack(imported.points_);
+    utility::device_vector<Vector2i> lines;
+    EXPECT_THROW(utility::FromDLPack(owned, lines), std::runtime_error);
+    owned->deleter(owned);
+}
+
+TEST(PointCloud, GetPinned) {
+    size_t size = 100;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    utility::pinned_host_vector<Vector3f> pinned;
+    pc.GetPoints(pinned);
+    cudaSafeCall(cudaStreamSynchronize(0));
+    ExpectEQ(thrust::host_vector<Vector3f>(pinned), points);
+
+    utility::pinned_host_vector<Vector3f> normals(10);
+    pc.GetNormals(normals);
+    EXPECT_TRUE(normals.empty());
+}
+
+TEST(PointCloud, ColorizeFromImages) {
+    const int width = 8;
+    const int height = 6;
+    camera::PinholeCameraIntrinsic intrinsic(width, height, 4.0, 4.0, 4.0, 3.0);
+    thrust::host_vector<Vector3f> points;
+    points.push_back(Vector3f(0.0, 0.0, 2.0));
+    // On the same ray, behind the first point from the first camera and
+    // in front of it from the second.
+    points.push_back(Vector3f(0.0, 0.0, 3.0));
+    // Out of the images.
+    points.push_back(Vector3f(10.0, 0.0, 1.0));
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+
+    geometry::Image red;
+    red.Prepare(width, height, 3, 1);
+    thrust::host_vector<uint8_t> red_data(width * height * 3, 0);
+    for (int i = 0; i < width * height; ++i) red_data[3 * i] = 255;
+    red.SetData(red_data);
+    geometry::Image blue;
+    blue.Prepare(width, height, 3, 4);
+    thrust::host_vector<float> blue_pixels(width * height * 3, 0.0);
+    for (int i = 0; i < width * height; ++i) blue_pixels[3 * i + 2] = 1.0;
+    blue.SetData(thrust::host_vector<uint8_t>(
+            (const uint8_t *)blue_pixels.data(),
+            (const uint8_t *)blue_pixels.data() +
+                    blue_pixels.size() * sizeof(float)));
+
+    // The second camera is at z = 4, looking back at the first one.
+    std::vector<Matrix4f_u> extrinsics(2, Matrix4f_u::Identity());
+    extrinsics[1](0, 0) = -1.0;
+    extrinsics[1](2, 2) = -1.0;
+    extrinsics[1](2, 3) = 4.0;
+    pc.ColorizeFromImages({red, blue}, {intrinsic, intrinsic}, extrinsics);
+    thrust::host_vector<Vector3f> colors = pc.GetColors();
+    ExpectEQ(Vector3f(1.0, 0.0, 0.0), colors[0]);
+    ExpectEQ(Vector3f(0.0, 0.0, 1.0), colors[1]);
+    ExpectEQ(Vector3f(0.0, 0.0, 0.0), colors[2]);
+}
+
+TEST(PointCloud, ComputeConvexHull) {
+    thrust::host_vector<Vector3f> points;
+    thrust::host_vector<int> labels;
+    // A unit cube with points inside for the cluster 0, a tetrahedron for
+    // the cluster 1 and a noise point.
+    for (int i = 0; i < 8; ++i) {
+        points.push_back(Vector3f(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+        labels.push_back(0);
+    }
+    for (int i = 1; i < 5; ++i) {
+        for (int j = 1; j < 5; ++j) {
+            points.push_back(Vector3f(0.2 * i, 0.2 * j, 0.1 * (i + j)));
+            labels.push_back(0);
+        }
+    }
+    const Vector3f offset(5.0, 0.0, 0.0);
+    points.push_back(offset);
+    points.push_back(offset + Vector3f(1.0, 0.0, 0.0));
+    points.push_back(offset + Vector3f(0.0, 1.0, 0.0));
+    points.push_back(offset + Vector3f(0.0, 0.0, 1.0));
+    points.push_back(offset + Vector3f(0.1, 0.1, 0.1));
+    for (int i = 0; i < 5; ++i) labels.push_back(1);
+    points.push_back(Vector3f(-10.0, 0.0, 0.0));
+    labels.push_back(-1);
+
+    geometry::PointCloud pc(thrust::host_vector<Vector3f>(points.begin(),
+                                                          points.begin() + 24));
+    auto hull = pc.ComputeConvexHull();
+    EXPECT_EQ(std::get<0>(hull)->vertices_.size(), 8);
+    EXPECT_EQ(std::get<0>(hull)->triangles_.size(), 12);
+    thrust::host_vector<size_t> indices = std::get<1>(hull);
+    std::sort(indices.begin(), indices.end());
+    for (size_t i = 0; i < 8; ++i) EXPECT_EQ(indices[i], i);
+
+    pc.SetPoints(points);
+    const utility::device_vector<int> d_labels = labels;
+    const auto hulls = pc.ComputeConvexHulls(d_labels);
+    ASSERT_EQ(hulls.size(), 2);
+    EXPECT_EQ(hulls[0]->triangles_.size(), 12);
+    EXPECT_EQ(hulls[1]->vertices_.size(), 4);
+    EXPECT_EQ(hulls[1]->triangles_.size(), 4);
+}
+
+TEST(PointCloud, HiddenPointRemoval) {
+    // Fibonacci sphere seen from both sides.
+    const int n = 500;
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < n; ++i) {
+        const float z = 1.0 - 2.0 * (i + 0.5) / n;
+        const float r = std::sqrt(1.0 - z * z);
+        const float phi = i * M_PI * (3.0 - std::sqrt(5.0));
+        points.push_back(Vector3f(r * cos(phi), r * sin(phi), z));
+    }
+    geometry::PointCloud pc(points);
+    auto res = pc.HiddenPointRemoval(Vector3f(0.0, 0.0, 5.0), 600.0);
+    thrust::host_vector<size_t> visible = std::get<1>(res);
+    EXPECT_GT(visible.size(), n / 4);
+    EXPECT_LT(visible.size(), n / 2);
+    for (size_t i : visible) EXPECT_GT(points[i][2], 0.0);
+
+    const auto batch = pc.HiddenPointRemovalBatch(
+            {Vector3f(0.0, 0.0, 5.0), Vector3f(0.0, 0.0, -5.0)}, 600.0);
+    ASSERT_EQ(batch.size(), 2);
+    thrust::host_vector<size_t> front = batch[0];
+    thrust::host_vector<size_t> back = batch[1];
+    EXPECT_TRUE(std::equal(front.begin(), front.end(), visible.begin()));
+    EXPECT_EQ(back.size(), visible.size());
+    for (size_t i : back) EXPECT_LT(points[i][2], 0.0);
+}
@@ -0,0 +1,98 @@
+#include "cupoch/geometry/pointcloud_batch.h"
+
+#include <Eigen/Geometry>
+
+#include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+// Grid of (n + 1)^3 points of spacing 0.1 starting at origin.
+std::shared_ptr<geometry::PointCloud> MakeGrid(const Vector3f &origin, int n) {
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i <= n; ++i) {
+        for (int j = 0; j <= n; ++j) {
+            for (int k = 0; k <= n; ++k) {
+                points.push_back(origin + 0.1f * Vector3f(i, j, k));
+            }
+        }
+    }
+    auto cloud = std::make_shared<geometry::PointCloud>();
+    cloud->SetPoints(points);
+    return cloud;
+}
+
+}  // namespace
+
+TEST(PointCloudBatch, ConstructAndSplit) {
+    const std::vector<std::shared_ptr<geometry::PointCloud>> clouds = {
+            MakeGrid(Vector3f::Zero(), 2), MakeGrid(Vector3f(5.0, 0.0, 0.0), 1),
+            std::make_shared<geometry::PointCloud>()};
+    geometry::PointCloudBatch batch(clouds);
+    EXPECT_EQ(batch.GetNumClouds(), 3);
+    EXPECT_EQ(batch.GetNumPoints(), 35);
+    const thrust::host_vector<int> offsets = batch.GetOffsets();
+    ASSERT_EQ(offsets.size(), 4);
+    EXPECT_EQ(offsets[1], 27);
+    EXPECT_EQ(offsets[2], 35);
+    EXPECT_EQ(offsets[3], 35);
+
+    const thrust::host_vector<int> labels = batch.GetLabels();
+    EXPECT_EQ(labels[0], 0);
+    EXPECT_EQ(labels[26], 0);
+    EXPECT_EQ(labels[27], 1);
+    EXPECT_EQ(labels[34], 1);
+
+    const auto split = batch.Split();
+    ASSERT_EQ(split.size(), 3);
+    for (size_t i = 0; i < split.size(); ++i) {
+        ExpectEQ(split[i]->GetPoints(), clouds[i]->GetPoints());
+    }
+}
+
+TEST(PointCloudBatch, CreateFromLabels) {
+    auto cloud = MakeGrid(Vector3f::Zero(), 1);
+    const thrust::host_vector<int> h_labels =
+            std::vector<int>{1, -1, 0, 1, 0, -1, 1, 1};
+    const utility::device_vector<int> labels = h_labels;
+    const auto batch =
+            geometry::PointCloudBatch::CreateFromLabels(*cloud, labels);
+    EXPECT_EQ(batch->GetNumClouds(), 2);
+    EXPECT_EQ(batch->GetNumPoints(), 6);
+    const thrust::host_vector<Vector3f> points = cloud->GetPoints();
+    const auto cloud1 = batch->GetCloud(1);
+    const thrust::host_vector<Vector3f> expected =
+            std::vector<Vector3f>{points[0], points[3], points[6], points[7]};
+    ExpectEQ(cloud1->GetPoints(), expected);
+}
+
+TEST(PointCloudBatch, TransformAndDownSample) {
+    const std::vector<std::shared_ptr<geometry::PointCloud>> clouds = {
+            MakeGrid(Vector3f::Zero(), 3), MakeGrid(Vector3f::Zero(), 3)};
+    geometry::PointCloudBatch batch(clouds);
+    Matrix4f_u shift = Matrix4f_u::Identity();
+    shift.block<3, 1>(0, 3) = Vector3f(1.0, 2.0, 3.0);
+    batch.Transform({Matrix4f_u::Identity(), shift});
+    const auto moved = batch.GetCloud(1);
+    EXPECT_NEAR(moved->GetMinBound()(0), 1.0, 1.0e-5);
+    EXPECT_NEAR(moved->GetMinBound()(2), 3.0, 1.0e-5);
+
+    // Each grid of 4^3 points falls into 2^3 voxels of 0.25, and the grids
+    // share no voxel.
+    const auto down = batch.VoxelDownSample(0.25);
+    EXPECT_EQ(down->GetNumClouds(), 2);
+    const thrust::host_vector<int> offsets = down->GetOffsets();
+    EXPECT_EQ(offsets[1], 8);
+    EXPECT_EQ(offsets[2], 16);
+
+    const auto boxes = batch.GetOrientedBoundingBoxes();
+    ASSERT_EQ(boxes.size(), 2);
+    ExpectEQ(boxes[0].center_, Vector3f(0.15, 0.15, 0.15), 1.0e-4);
+    ExpectEQ(boxes[1].center_, Vector3f(1.15, 2.15, 3.15), 1.0e-4);
+}
@@ -0,0 +1,135 @@
+#include "cupoch/geometry/range_image.h"
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+geometry::RangeImageProjection SmallProjection() {
+    return geometry::RangeImageProjection(32, 64, -0.4, 0.1);
+}
+
+geometry::Image CreateRange(const geometry::RangeImageProjection &projection,
+                            const thrust::host_vector<float> &ranges) {
+    geometry::Image image;
+    image.Prepare(projection.num_columns_, projection.num_rings_, 1, 4);
+    thrust::host_vector<uint8_t> data((const uint8_t *)ranges.data(),
+                                      (const uint8_t *)ranges.data() +
+                                              ranges.size() * sizeof(float));
+    image.SetData(data);
+    return image;
+}
+
+template <typename T>
+thrust::host_vector<T> GetPixels(const geometry::Image &image) {
+    thrust::host_vector<uint8_t> data = image.GetData();
+    const T *p = (const T *)data.data();
+    return thrust::host_vector<T>(p, p + image.width_ * image.height_);
+}
+
+}  // namespace
+
+TEST(RangeImage, CreateFromAndToRangeImage) {
+    const auto projection = SmallProjection();
+    const int n_pixels = projection.num_rings_ * projection.num_columns_;
+    thrust::host_vector<float> ranges(n_pixels, 5.0);
+    ranges[10] = 0.0;
+    const auto range = CreateRange(projection, ranges);
+
+    auto pc = geometry::PointCloud::CreateFromRangeImage(range, projection);
+    EXPECT_EQ(n_pixels - 1, pc->points_.size());
+    auto organized = geometry::PointCloud::CreateFromRangeImage(
+            range, projection, false);
+    EXPECT_EQ(n_pixels, organized->points_.size());
+
+    thrust::host_vector<float> projected =
+            GetPixels<float>(*pc->ToRangeImage(projection));
+    for (int i = 0; i < n_pixels; ++i) {
+        EXPECT_NEAR(ranges[i], projected[i], 1.0e-4);
+    }
+    thrust::host_vector<int> indices =
+            GetPixels<int>(*pc->ToRangeIndexImage(projection));
+    EXPECT_EQ(-1, indices[10]);
+    EXPECT_EQ(0, indices[0]);
+    EXPECT_EQ(n_pixels - 2, indices[n_pixels - 1]);
+}
+
+TEST(RangeImage, LabelRangeImageGround) {
+    // Flat ground 1.7 below the sensor and a wall at x = -8 in the first
+    // 8 columns.
+    const auto projection = SmallProjection();
+    const int width = projection.num_columns_;
+    thrust::host_vector<float> ranges(projection.num_rings_ * width, 0.0);
+    thrust::host_vector<bool> is_wall(ranges.size(), false);
+    thrust::host_vector<float> heights(ranges.size(), 0.0);
+    for (int row = 0; row < projection.num_rings_; ++row) {
+        for (int col = 0; col < width; ++col) {
+            const Vector3f dir = projection.GetBeamDirection(row, col);
+            const int idx = row * width + col;
+            const float ground = (dir(2) < 0.0) ? -1.7 / dir(2) : 0.0;
+            const float wall = (col < 8 && dir(0) < 0.0) ? -8.0 / dir(0) : 0.0;
+            if (wall > 0.0 && (ground == 0.0 || wall < ground)) {
+                ranges[idx] = wall;
+                is_wall[idx] = true;
+                heights[idx] = wall * dir(2) + 1.7;
+            } else {
+                ranges[idx] = ground;
+            }
+        }
+    }
+    auto labels = geometry::LabelRangeImageGround(
+            CreateRange(projection, ranges), projection);
+    thrust::host_vector<uint8_t> h_labels = GetPixels<uint8_t>(*labels);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (ranges[i] == 0.0) {
+            EXPECT_EQ(0, h_labels[i]);
+        } else if (!is_wall[i]) {
+            EXPECT_EQ(1, h_labels[i]);
+        } else if (heights[i] > 0.3) {
+            EXPECT_EQ(0, h_labels[i]);
+        }
+    }
+}
+
+TEST(RangeImage, ClusterRangeImage) {
+    const auto projection = SmallProjection();
+    const int width = projection.num_columns_;
+    thrust::host_vector<float> ranges(projection.num_rings_ * width, 0.0);
+    for (int row = 4; row < 12; ++row) {
+        for (int col = 0; col < 10; ++col) ranges[row * width + col] = 5.0;
+        for (int col = 10; col < 20; ++col) ranges[row * width + col] = 10.0;
+        for (int col = 30; col < 40; ++col) ranges[row * width + col] = 5.0;
+    }
+    const auto range = CreateRange(projection, ranges);
+    thrust::host_vector<int> labels = GetPixels<int>(
+            *geometry::ClusterRangeImage(range, projection));
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        const int col = i % width;
+        if (ranges[i] == 0.0) {
+            EXPECT_EQ(-1, labels[i]);
+        } else {
+            EXPECT_EQ((col < 10) ? 0 : ((col < 20) ? 1 : 2), labels[i]);
+        }
+    }
+
+    // Leaves out the ground pixels.
+    geometry::Image ground;
+    ground.Prepare(width, projection.num_rings_, 1, 1);
+    thrust::host_vector<uint8_t> h_ground(ranges.size(), 0);
+    for (int col = 30; col < 40; ++col) {
+        for (int row = 4; row < 12; ++row) h_ground[row * width + col] = 1;
+    }
+    ground.SetData(h_ground);
+    labels = GetPixels<int>(
+            *geometry::ClusterRangeImage(range, projection, 0.1745, ground));
+    for (int row = 4; row < 12; ++row) {
+        EXPECT_EQ(0, labels[row * width + 5]);
+        EXPECT_EQ(1, labels[row * width + 15]);
+        EXPECT_EQ(-1, labels[row * width + 35]);
+    }
+}
@@ -0,0 +1,81 @@
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/raycasting_scene.h"
+#include "cupoch/geometry/trianglemesh.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(RaycastingScene, CastRays) {
+    auto box = geometry::TriangleMesh::CreateBox();
+    auto far_box = geometry::TriangleMesh::CreateBox();
+    far_box->Translate(Vector3f(0.0, 0.0, 3.0));
+    geometry::RaycastingScene scene;
+    EXPECT_EQ(scene.AddTriangles(*box), 0);
+    EXPECT_EQ(scene.AddTriangles(*far_box), 1);
+    EXPECT_EQ(scene.GetNumGeometries(), 2);
+    EXPECT_EQ(scene.GetNumTriangles(), 24);
+
+    thrust::host_vector<Vector3f> h_origins;
+    thrust::host_vector<Vector3f> h_dirs;
+    // Through both boxes, then from between them, then missing.
+    h_origins.push_back({0.3, 0.6, -1.0});
+    h_dirs.push_back({0.0, 0.0, 1.0});
+    h_origins.push_back({0.3, 0.6, 2.0});
+    h_dirs.push_back({0.0, 0.0, 2.0});
+    h_origins.push_back({2.5, 0.5, -1.0});
+    h_dirs.push_back({0.0, 0.0, 1.0});
+    utility::device_vector<Vector3f> origins(h_origins);
+    utility::device_vector<Vector3f> dirs(h_dirs);
+    geometry::RayCastResult result;
+    scene.CastRays(origins, dirs, result);
+    thrust::host_vector<float> t_hit = result.t_hit_;
+    thrust::host_vector<unsigned int> geometry_ids = result.geometry_ids_;
+    thrust::host_vector<Vector3f> normals = result.primitive_normals_;
+    EXPECT_NEAR(t_hit[0], 1.0, THRESHOLD_1E_4);
+    EXPECT_EQ(geometry_ids[0], 0);
+    EXPECT_NEAR(std::abs(normals[0][2]), 1.0, THRESHOLD_1E_4);
+    EXPECT_NEAR(t_hit[1], 0.5, THRESHOLD_1E_4);
+    EXPECT_EQ(geometry_ids[1], 1);
+    EXPECT_TRUE(std::isinf(t_hit[2]));
+    EXPECT_EQ(geometry_ids[2], geometry::RaycastingScene::kInvalidId);
+
+    // Stopped before the second box.
+    scene.CastRays(origins, dirs, result, 0.25);
+    t_hit = result.t_hit_;
+    EXPECT_TRUE(std::isinf(t_hit[1]));
+
+    // Odd from inside of the first box, even from outside.
+    h_origins[2] = Vector3f(0.5, 0.5, 0.5);
+    h_dirs[2] = Vector3f(0.3, 0.7, 0.1);
+    thrust::host_vector<int> counts = scene.CountIntersections(
+            utility::device_vector<Vector3f>(h_origins),
+            utility::device_vector<Vector3f>(h_dirs));
+    EXPECT_EQ(counts[0], 4);
+    EXPECT_EQ(counts[1], 2);
+    EXPECT_EQ(counts[2], 1);
+}
+
+TEST(RaycastingScene, SimulateLidar) {
+    auto room = geometry::TriangleMesh::CreateBox(4.0, 4.0, 4.0);
+    geometry::RaycastingScene scene;
+    scene.AddTriangles(*room);
+    Matrix4f pose = Matrix4f::Identity();
+    pose.block<3, 1>(0, 3) = Vector3f(2.1, 1.9, 2.05);
+    auto scan = scene.SimulateLidar(pose, 15, 5, 30.0, -30.0, 10.0);
+    EXPECT_EQ(scan->points_.size(), 75);
+    EXPECT_EQ(scan->normals_.size(), 75);
+    // The points are in the sensor frame, on the walls once moved back.
+    thrust::host_vector<Vector3f> points = scan->points_;
+    for (const auto &p : points) {
+        const Vector3f w = p + pose.block<3, 1>(0, 3);
+        EXPECT_NEAR(std::min(w.minCoeff(), 4.0f - w.maxCoeff()), 0.0,
+                    THRESHOLD_1E_4);
+    }
+    // The walls are out of range.
+    scan = scene.SimulateLidar(pose, 16, 5, 30.0, -30.0, 1.5);
+    EXPECT_EQ(scan->points_.size(), 0);
+}
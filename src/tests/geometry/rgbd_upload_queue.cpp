@@ -0,0 +1,56 @@
+#include "cupoch/geometry/rgbd_upload_queue.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(RGBDUploadQueue, PushAndPop) {
+    const int width = 5;
+    const int height = 4;
+    geometry::RGBDUploadQueue queue(width, height);
+    EXPECT_EQ(queue.GetNumBuffers(), 2u);
+    EXPECT_EQ(queue.Pop(), nullptr);
+
+    std::vector<thrust::host_vector<uint8_t>> colors;
+    std::vector<thrust::host_vector<uint8_t>> depths;
+    for (int i = 0; i < 3; ++i) {
+        colors.emplace_back(width * height * 3);
+        depths.emplace_back(width * height * 2);
+        Rand(colors.back(), 0, 255, i);
+        Rand(depths.back(), 0, 255, 10 + i);
+    }
+    EXPECT_TRUE(queue.Push(colors[0].data(), depths[0].data()));
+    EXPECT_TRUE(queue.Push(colors[1].data(), depths[1].data()));
+    EXPECT_FALSE(queue.Push(colors[2].data(), depths[2].data()));
+    EXPECT_EQ(queue.GetSize(), 2u);
+
+    const geometry::RGBDImage *frame = queue.Pop();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->color_.width_, width);
+    EXPECT_EQ(frame->color_.num_of_channels_, 3);
+    EXPECT_EQ(frame->depth_.bytes_per_channel_, 2);
+    ExpectEQ(colors[0], frame->color_.GetData());
+    ExpectEQ(depths[0], frame->depth_.GetData());
+    // The free buffer holds the frame popped last.
+    EXPECT_FALSE(queue.Push(colors[2].data(), depths[2].data()));
+
+    frame = queue.Pop();
+    ASSERT_NE(frame, nullptr);
+    ExpectEQ(colors[1], frame->color_.GetData());
+    ExpectEQ(depths[1], frame->depth_.GetData());
+
+    // Straight from pinned memory.
+    utility::pinned_host_vector<uint8_t> color(colors[2].begin(),
+                                               colors[2].end());
+    utility::pinned_host_vector<uint8_t> depth(depths[2].begin(),
+                                               depths[2].end());
+    EXPECT_TRUE(queue.Push(color.data(), depth.data()));
+    frame = queue.Pop();
+    ASSERT_NE(frame, nullptr);
+    ExpectEQ(colors[2], frame->color_.GetData());
+    ExpectEQ(depths[2], frame->depth_.GetData());
+    EXPECT_EQ(queue.Pop(), nullptr);
+}
@@ -0,0 +1,79 @@
+#include "cupoch/geometry/rgbdimage.h"
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+geometry::Image CreateDepth(int width,
+                            int height,
+                            const thrust::host_vector<uint16_t> &depths) {
+    geometry::Image image;
+    image.Prepare(width, height, 1, 2);
+    thrust::host_vector<uint8_t> data(
+            (const uint8_t *)depths.data(),
+            (const uint8_t *)depths.data() + depths.size() * sizeof(uint16_t));
+    image.SetData(data);
+    return image;
+}
+
+thrust::host_vector<uint16_t> GetDepths(const geometry::Image &image) {
+    thrust::host_vector<uint8_t> data = image.GetData();
+    const uint16_t *p = (const uint16_t *)data.data();
+    return thrust::host_vector<uint16_t>(p, p + image.width_ * image.height_);
+}
+
+}  // namespace
+
+TEST(RGBDImage, RegisterDepthToColor) {
+    const int width = 32;
+    const int height = 24;
+    camera::PinholeCameraIntrinsic intrinsic(width, height, 100.0, 100.0,
+                                             15.5, 11.5);
+    thrust::host_vector<uint16_t> depths(width * height, 1000);
+    depths[5 * width + 5] = 0;
+    const auto depth = CreateDepth(width, height, depths);
+
+    auto registered = geometry::RGBDImage::RegisterDepthToColor(
+            depth, intrinsic, intrinsic, Matrix4f::Identity());
+    EXPECT_EQ(2, registered->bytes_per_channel_);
+    thrust::host_vector<uint16_t> same = GetDepths(*registered);
+    for (size_t i = 0; i < depths.size(); ++i) {
+        EXPECT_EQ(depths[i], same[i]);
+    }
+
+    // The color camera is 0.1 m to the left, the image shifts 10 pixels to
+    // the right at 1 m.
+    Matrix4f depth_to_color = Matrix4f::Identity();
+    depth_to_color(0, 3) = 0.1;
+    registered = geometry::RGBDImage::RegisterDepthToColor(
+            depth, intrinsic, intrinsic, depth_to_color);
+    thrust::host_vector<uint16_t> shifted = GetDepths(*registered);
+    for (int v = 0; v < height; ++v) {
+        for (int u = 0; u < width; ++u) {
+            const uint16_t expected = (u < 10) ? 0 : depths[v * width + u - 10];
+            EXPECT_EQ(expected, shifted[v * width + u]);
+        }
+    }
+
+    // The footprints fill the color image of twice the resolution.
+    camera::PinholeCameraIntrinsic color_intrinsic(2 * width, 2 * height,
+                                                   200.0, 200.0, 31.5, 23.5);
+    depths[0] = 500;
+    registered = geometry::RGBDImage::RegisterDepthToColor(
+            CreateDepth(width, height, depths), intrinsic, color_intrinsic,
+            Matrix4f::Identity());
+    EXPECT_EQ(2 * width, registered->width_);
+    thrust::host_vector<uint16_t> upsampled = GetDepths(*registered);
+    for (int v = 0; v < 2 * height; ++v) {
+        for (int u = 0; u < 2 * width; ++u) {
+            EXPECT_EQ(depths[(v / 2) * width + u / 2],
+                      upsampled[v * 2 * width + u]);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include "cupoch/geometry/selection_mask.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace cupoch::geometry;
+using namespace unit_test;
+
+TEST(SelectionMask, Constructor) {
+    SelectionMask all(70);
+    EXPECT_EQ(all.Size(), 70);
+    EXPECT_EQ(all.words_.size(), 3);
+    EXPECT_EQ(all.Count(), 70);
+    SelectionMask none(70, false);
+    EXPECT_EQ(none.Count(), 0);
+    EXPECT_EQ(none.GetIndices().size(), 0);
+}
+
+TEST(SelectionMask, Combine) {
+    thrust::host_vector<bool> h_a(40), h_b(40);
+    for (int i = 0; i < 40; ++i) {
+        h_a[i] = i % 2 == 0;
+        h_b[i] = i % 3 == 0;
+    }
+    SelectionMask a(h_a);
+    SelectionMask b(h_b);
+    SelectionMask c = a;
+    c.And(b);
+    const thrust::host_vector<size_t> indices = c.GetIndices();
+    ASSERT_EQ(indices.size(), 7);
+    for (size_t i = 0; i < indices.size(); ++i) EXPECT_EQ(indices[i], 6 * i);
+
+    a.Or(b);
+    EXPECT_EQ(a.Count(), 27);
+    // The bits past the size stay cleared.
+    a.Invert();
+    EXPECT_EQ(a.Count(), 13);
+    const thrust::host_vector<bool> mask = a.GetMask();
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_EQ(mask[i], !(h_a[i] || h_b[i]));
+    }
+}
@@ -0,0 +1,44 @@
+#include "cupoch/geometry/sparse_occupancygrid.h"
+#include "cupoch/geometry/voxelgrid.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(SparseOccupancyGrid, Insert) {
+    geometry::SparseOccupancyGrid grid(1.0, 64);
+    EXPECT_TRUE(grid.IsEmpty());
+    thrust::host_vector<Eigen::Vector3f> host_points;
+    host_points.push_back({0.5, 0.5, 3.5});
+    grid.Insert(host_points, Eigen::Vector3f(0.5, 0.5, 0.5));
+    EXPECT_EQ(grid.GetNumBlocks(), 1);
+    EXPECT_EQ(grid.ExtractFreeVoxels()->voxels_keys_.size(), 3);
+    EXPECT_EQ(grid.ExtractOccupiedVoxels()->voxels_keys_.size(), 1);
+    auto free1 = grid.GetProbLog(Eigen::Vector3f(0.5, 0.5, 1.5));
+    EXPECT_TRUE(thrust::get<0>(free1));
+    EXPECT_FLOAT_EQ(thrust::get<1>(free1), grid.prob_miss_log_);
+    EXPECT_TRUE(grid.IsOccupied(Eigen::Vector3f(0.5, 0.5, 3.5)));
+    EXPECT_TRUE(grid.IsUnknown(Eigen::Vector3f(0.5, 0.5, 4.5)));
+
+    // Far points allocate the blocks of their rays, also on the negative side.
+    host_points.clear();
+    host_points.push_back({0.5, 0.5, 20.5});
+    host_points.push_back({-10.5, 0.5, 0.5});
+    grid.Insert(host_points, Eigen::Vector3f(0.5, 0.5, 0.5));
+    EXPECT_EQ(grid.GetNumBlocks(), 5);
+    EXPECT_TRUE(grid.IsOccupied(Eigen::Vector3f(0.5, 0.5, 20.5)));
+    EXPECT_TRUE(grid.IsOccupied(Eigen::Vector3f(-10.5, 0.5, 0.5)));
+    auto free2 = grid.GetProbLog(Eigen::Vector3f(0.5, 0.5, 1.5));
+    EXPECT_FLOAT_EQ(thrust::get<1>(free2), 2.0 * grid.prob_miss_log_);
+    // The previous hit is crossed by the ray of this scan.
+    auto hit = grid.GetProbLog(Eigen::Vector3f(0.5, 0.5, 3.5));
+    EXPECT_FLOAT_EQ(thrust::get<1>(hit),
+                    grid.prob_hit_log_ + grid.prob_miss_log_);
+
+    grid.Clear();
+    EXPECT_TRUE(grid.IsEmpty());
+    EXPECT_TRUE(grid.IsUnknown(Eigen::Vector3f(0.5, 0.5, 1.5)));
+}
@@ -0,0 +1,84 @@
+#include "cupoch/geometry/streaming.h"
+
+#include <thrust/sort.h>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(StreamingVoxelDownSampler, MatchesVoxelDownSample) {
+    size_t size = 1000;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(1000.0, 1000.0, 1000.0), 0);
+    pc.SetPoints(points);
+
+    const float voxel_size = 100.0;
+    auto ref_pc = pc.VoxelDownSample(voxel_size);
+
+    const Vector3f origin =
+            pc.GetMinBound() - Vector3f::Constant(voxel_size * 0.5);
+    geometry::StreamingVoxelDownSampler sampler(voxel_size, origin);
+    for (size_t begin = 0; begin < size; begin += 300) {
+        const size_t end = std::min(begin + 300, size);
+        geometry::PointCloud chunk;
+        chunk.SetPoints(thrust::host_vector<Vector3f>(points.begin() + begin,
+                                                      points.begin() + end));
+        sampler.AddChunk(chunk);
+    }
+    auto output_pc = sampler.GetPointCloud();
+    EXPECT_EQ(ref_pc->points_.size(), sampler.GetNumVoxels());
+
+    auto ref_pt = ref_pc->GetPoints();
+    auto output_pt = output_pc->GetPoints();
+    sort::Do(ref_pt);
+    sort::Do(output_pt);
+    ExpectEQ(ref_pt, output_pt);
+}
+
+TEST(StreamingStatisticalOutlierRemoval, MatchesRemoveStatisticalOutliers) {
+    size_t size = 500;
+    geometry::PointCloud pc;
+
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Zero3f, Vector3f(10.0, 10.0, 10.0), 0);
+    points[0] = Vector3f(100.0, 100.0, 100.0);
+    pc.SetPoints(points);
+
+    auto ref = pc.RemoveStatisticalOutliers(10, 1.0);
+    thrust::host_vector<size_t> ref_indices = std::get<1>(ref);
+
+    // Two tiles split at x = 5, each with the other as its halo.
+    thrust::host_vector<Vector3f> left, right;
+    thrust::host_vector<size_t> left_indices, right_indices;
+    for (size_t i = 0; i < size; ++i) {
+        if (points[i][0] < 5.0) {
+            left.push_back(points[i]);
+            left_indices.push_back(i);
+        } else {
+            right.push_back(points[i]);
+            right_indices.push_back(i);
+        }
+    }
+    geometry::PointCloud left_pc(left), right_pc(right);
+    geometry::StreamingStatisticalOutlierRemoval sor(10, 1.0);
+    sor.AccumulateTile(left_pc, right_pc);
+    sor.AccumulateTile(right_pc, left_pc);
+    thrust::host_vector<size_t> left_inliers = sor.FilterTile(left_pc, right_pc);
+    thrust::host_vector<size_t> right_inliers =
+            sor.FilterTile(right_pc, left_pc);
+
+    thrust::host_vector<size_t> indices;
+    for (auto i : left_inliers) indices.push_back(left_indices[i]);
+    for (auto i : right_inliers) indices.push_back(right_indices[i]);
+    thrust::sort(indices.begin(), indices.end());
+    EXPECT_EQ(ref_indices.size(), indices.size());
+    for (size_t i = 0; i < std::min(ref_indices.size(), indices.size()); ++i) {
+        EXPECT_EQ(ref_indices[i], indices[i]);
+    }
+}
@@ -1,4 +1,8 @@
 #include "cupoch/geometry/trianglemesh.h"
+
+#include <cmath>
+#include <limits>
+
 #include "cupoch/geometry/boundingvolume.h"
 #include "cupoch/geometry/pointcloud.h"
 #include "tests/test_utility/unit_test.h"
@@ -465,6 +469,121 @@ TEST(TriangleMesh, ComputeEdgeList) {
     ExpectEQ(ref, tm.GetEdgeList());
 }
 
+TEST(TriangleMesh, GetVertexAdjacency) {
+    thrust::host_vector<Eigen::Vector3f> vertices;
+    vertices.push_back({0, 0, 1});
+    vertices.push_back({1, 1, 0});
+    vertices.push_back({-1, 1, 0});
+    vertices.push_back({-1, -1, 0});
+    vertices.push_back({1, -1, 0});
+    thrust::host_vector<Eigen::Vector3i> triangles;
+    triangles.push_back({0, 1, 2});
+    triangles.push_back({0, 2, 3});
+    triangles.push_back({0, 3, 4});
+    triangles.push_back({0, 4, 1});
+    triangles.push_back({1, 2, 4});
+    triangles.push_back({2, 3, 4});
+    geometry::TriangleMesh tm;
+    tm.SetVertices(vertices);
+    tm.SetTriangles(triangles);
+
+    auto adjacency = tm.GetVertexAdjacency();
+    thrust::host_vector<int> ref_offsets(std::vector<int>({0, 4, 7, 11, 14, 18}));
+    thrust::host_vector<int> ref_indices(std::vector<int>(
+            {1, 2, 3, 4, 0, 2, 4, 0, 1, 3, 4, 0, 2, 4, 0, 1, 2, 3}));
+    ExpectEQ(ref_offsets, thrust::host_vector<int>(adjacency->offsets_));
+    ExpectEQ(ref_indices, thrust::host_vector<int>(adjacency->indices_));
+    EXPECT_EQ(adjacency, tm.GetVertexAdjacency());
+
+    // Changing the topology drops the cached adjacency.
+    triangles.pop_back();
+    triangles.pop_back();
+    tm.SetTriangles(triangles);
+    auto updated = tm.GetVertexAdjacency();
+    EXPECT_NE(adjacency, updated);
+    EXPECT_EQ(updated->indices_.size(), 16);
+}
+
+TEST(TriangleMesh, GetVertexTriangleAdjacency) {
+    thrust::host_vector<Eigen::Vector3f> vertices;
+    vertices.push_back({0, 0, 0});
+    vertices.push_back({1, 0, 0});
+    vertices.push_back({0, 1, 0});
+    vertices.push_back({-1, 0, 0});
+    vertices.push_back({5, 5, 5});
+    thrust::host_vector<Eigen::Vector3i> triangles;
+    triangles.push_back({0, 1, 2});
+    triangles.push_back({0, 2, 3});
+    geometry::TriangleMesh tm;
+    tm.SetVertices(vertices);
+    tm.SetTriangles(triangles);
+
+    auto adjacency = tm.GetVertexTriangleAdjacency();
+    thrust::host_vector<int> ref_offsets(std::vector<int>({0, 2, 3, 5, 6, 6}));
+    thrust::host_vector<int> ref_indices(std::vector<int>({0, 1, 0, 0, 1, 1}));
+    ExpectEQ(ref_offsets, thrust::host_vector<int>(adjacency->offsets_));
+    ExpectEQ(ref_indices, thrust::host_vector<int>(adjacency->indices_));
+
+    tm.ComputeVertexNormals();
+    thrust::host_vector<Eigen::Vector3f> normals = tm.GetVertexNormals();
+    EXPECT_EQ(normals.size(), 5);
+    for (size_t i = 0; i < 4; ++i) {
+        ExpectEQ(normals[i], Eigen::Vector3f(0, 0, 1));
+    }
+}
+
+TEST(TriangleMesh, RemoveDuplicatedKeepsOrder) {
+    geometry::TriangleMesh tm;
+    thrust::host_vector<Vector3f> vertices;
+    vertices.push_back({0.0, 0.0, 0.0});
+    vertices.push_back({1.0, 0.0, 0.0});
+    vertices.push_back({0.0, 0.0, 0.0});
+    vertices.push_back({0.0, 1.0, 0.0});
+    thrust::host_vector<Vector3i> triangles;
+    triangles.push_back({0, 1, 3});
+    triangles.push_back({2, 1, 3});
+    triangles.push_back({1, 3, 0});
+    triangles.push_back({0, 3, 1});
+    tm.SetVertices(vertices);
+    tm.SetTriangles(triangles);
+
+    tm.RemoveDuplicatedVertices();
+    thrust::host_vector<Vector3f> out_vertices = tm.GetVertices();
+    ASSERT_EQ(out_vertices.size(), 3);
+    ExpectEQ(out_vertices[0], Vector3f(0.0, 0.0, 0.0));
+    ExpectEQ(out_vertices[1], Vector3f(1.0, 0.0, 0.0));
+    ExpectEQ(out_vertices[2], Vector3f(0.0, 1.0, 0.0));
+    thrust::host_vector<Vector3i> out_triangles = tm.GetTriangles();
+    ExpectEQ(out_triangles[1], Vector3i(0, 1, 2));
+
+    // The rotations of a triangle are duplicates, not the flipped ones.
+    tm.RemoveDuplicatedTriangles();
+    out_triangles = tm.GetTriangles();
+    ASSERT_EQ(out_triangles.size(), 2);
+    ExpectEQ(out_triangles[0], Vector3i(0, 1, 2));
+    ExpectEQ(out_triangles[1], Vector3i(0, 2, 1));
+}
+
+TEST(TriangleMesh, RemoveDuplicatedNaNVertices) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    geometry::TriangleMesh tm;
+    thrust::host_vector<Vector3f> vertices;
+    vertices.push_back({nan, 0.0, 0.0});
+    vertices.push_back({1.0, 0.0, 0.0});
+    vertices.push_back({nan, 0.0, 0.0});
+    vertices.push_back({-0.0, 1.0, 0.0});
+    vertices.push_back({0.0, 1.0, 0.0});
+    tm.SetVertices(vertices);
+
+    // The copies of a NaN vertex are merged like any other, and -0 like 0.
+    tm.RemoveDuplicatedVertices();
+    thrust::host_vector<Vector3f> out_vertices = tm.GetVertices();
+    ASSERT_EQ(out_vertices.size(), 3);
+    EXPECT_TRUE(std::isnan(out_vertices[0](0)));
+    ExpectEQ(out_vertices[1], Vector3f(1.0, 0.0, 0.0));
+    ExpectEQ(out_vertices[2], Vector3f(0.0, 1.0, 0.0));
+}
+
 TEST(TriangleMesh, Purge) {
     Vector3f ref_vertices_raw[] = {{839.215686, 392.156863, 780.392157},
                                    {796.078431, 909.803922, 196.078431},
@@ -732,6 +851,63 @@ TEST(TriangleMesh, SamplePointsUniformly) {
     }
 }
 
+TEST(TriangleMesh, SamplePointsByImportance) {
+    thrust::host_vector<Vector3f> vertices;
+    vertices.push_back(Vector3f(0, 0, 0));
+    vertices.push_back(Vector3f(1, 0, 0));
+    vertices.push_back(Vector3f(0, 1, 0));
+    vertices.push_back(Vector3f(-1, 0, 0));
+    thrust::host_vector<Vector3i> triangles;
+    triangles.push_back(Vector3i(0, 1, 2));
+    triangles.push_back(Vector3i(0, 2, 3));
+    geometry::TriangleMesh mesh(vertices, triangles);
+
+    // Only the second triangle has a weight.
+    thrust::host_vector<float> h_weights(2);
+    h_weights[0] = 0.0;
+    h_weights[1] = 1.0;
+    utility::device_vector<float> weights = h_weights;
+    size_t n_points = 100;
+    auto pcd = mesh.SamplePointsByImportance(n_points, weights);
+    EXPECT_EQ(pcd->points_.size(), n_points);
+    thrust::host_vector<Vector3f> points = pcd->GetPoints();
+    for (size_t i = 0; i < n_points; ++i) {
+        EXPECT_LE(points[i][0], 1.0e-6);
+    }
+}
+
+TEST(TriangleMesh, SamplePointsPoissonDisk) {
+    auto sphere = geometry::TriangleMesh::CreateSphere(1.0, 20);
+    size_t n_points = 200;
+    auto pcd = sphere->SamplePointsPoissonDisk(n_points);
+    EXPECT_EQ(pcd->points_.size(), n_points);
+    thrust::host_vector<Vector3f> points = pcd->GetPoints();
+    float min_dist = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < n_points; ++i) {
+        EXPECT_NEAR(points[i].norm(), 1.0, 0.05);
+        for (size_t j = i + 1; j < n_points; ++j) {
+            min_dist = std::min(min_dist, (points[i] - points[j]).norm());
+        }
+    }
+    // Far from the clumps of uniform sampling.
+    const float r_max = std::sqrt(4.0 * M_PI / (2.0 * std::sqrt(3.0) * n_points));
+    EXPECT_GT(min_dist, 0.3 * r_max);
+}
+
+TEST(TriangleMesh, SamplePointsUniformlyBatch) {
+    auto sphere1 = geometry::TriangleMesh::CreateSphere(1.0, 10);
+    auto sphere2 = geometry::TriangleMesh::CreateSphere(0.5, 10);
+    sphere2->Translate(Vector3f(5, 0, 0));
+    size_t n_points = 50;
+    auto pcd = geometry::TriangleMesh::SamplePointsUniformlyBatch({sphere1, sphere2}, n_points);
+    EXPECT_EQ(pcd->points_.size(), 2 * n_points);
+    thrust::host_vector<Vector3f> points = pcd->GetPoints();
+    for (size_t i = 0; i < n_points; ++i) {
+        EXPECT_LE(points[i].norm(), 1.0 + 1.0e-4);
+        EXPECT_LE((points[n_points + i] - Vector3f(5, 0, 0)).norm(), 0.5 + 1.0e-4);
+    }
+}
+
 TEST(TriangleMesh, FilterSharpen) {
     auto mesh = std::make_shared<geometry::TriangleMesh>();
     thrust::host_vector<Eigen::Vector3f> vertices;
@@ -872,6 +1048,18 @@ TEST(TriangleMesh, FilterSmoothTaubin) {
     ExpectEQ(mesh->GetVertices(), ref2);
 }
 
+TEST(TriangleMesh, SimplifyQuadricDecimation) {
+    auto sphere = geometry::TriangleMesh::CreateSphere(1.0, 20);
+    auto mesh = sphere->SimplifyQuadricDecimation(100);
+    EXPECT_LE(mesh->triangles_.size(), 100);
+    EXPECT_GT(mesh->triangles_.size(), 0);
+    EXPECT_LT(mesh->vertices_.size(), sphere->vertices_.size());
+    thrust::host_vector<Vector3f> vertices = mesh->GetVertices();
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        EXPECT_NEAR(vertices[i].norm(), 1.0, 0.2);
+    }
+}
+
 TEST(TriangleMesh, HasVertices) {
     int size = 100;
 
@@ -1220,3 +1408,97 @@ TEST(TriangleMesh, CreateMeshArrow) {
     ExpectEQ(ref_vertices, output_tm->GetVertices());
     ExpectEQ(ref_triangles, output_tm->GetTriangles());
 }
+
+TEST(TriangleMesh, GetSelfIntersectingTriangles) {
+    geometry::TriangleMesh mesh;
+    thrust::host_vector<Eigen::Vector3f> vertices;
+    vertices.push_back({0.0, 0.0, 0.0});
+    vertices.push_back({1.0, 0.0, 0.0});
+    vertices.push_back({0.0, 1.0, 0.0});
+    vertices.push_back({0.2, 0.2, -0.5});
+    vertices.push_back({0.2, 0.2, 0.5});
+    vertices.push_back({0.8, 0.8, 0.5});
+    vertices.push_back({5.0, 5.0, 5.0});
+    vertices.push_back({6.0, 5.0, 5.0});
+    vertices.push_back({5.0, 6.0, 5.0});
+    thrust::host_vector<Eigen::Vector3i> triangles;
+    triangles.push_back({0, 1, 2});
+    triangles.push_back({3, 4, 5});
+    triangles.push_back({6, 7, 8});
+    // Shares a vertex with the first triangle.
+    triangles.push_back({0, 4, 5});
+    mesh.SetVertices(vertices);
+    mesh.SetTriangles(triangles);
+    thrust::host_vector<Eigen::Vector2i> pairs = mesh.GetSelfIntersectingTriangles();
+    ASSERT_EQ(pairs.size(), 1);
+    EXPECT_EQ(pairs[0], Eigen::Vector2i(0, 1));
+}
+
+TEST(TriangleMesh, CreateFromPointCloudPoisson) {
+    // Fibonacci sphere of radius 1 with the outward normals.
+    const int n = 2000;
+    thrust::host_vector<Eigen::Vector3f> points;
+    for (int i = 0; i < n; ++i) {
+        const float z = 1.0 - (2.0 * i + 1.0) / n;
+        const float r = std::sqrt(1.0 - z * z);
+        const float phi = i * 2.399963;
+        points.push_back({r * std::cos(phi), r * std::sin(phi), z});
+    }
+    geometry::PointCloud pcd;
+    pcd.SetPoints(points);
+    pcd.SetNormals(points);
+
+    auto res = geometry::TriangleMesh::CreateFromPointCloudPoisson(pcd, 5);
+    auto mesh = std::get<0>(res);
+    ASSERT_GT(mesh->triangles_.size(), 0);
+    EXPECT_EQ(std::get<1>(res).size(), mesh->vertices_.size());
+    thrust::host_vector<Eigen::Vector3f> vertices = mesh->GetVertices();
+    for (const auto &v : vertices) {
+        EXPECT_NEAR(v.norm(), 1.0, 0.1);
+    }
+
+    geometry::PointCloud no_normals;
+    no_normals.SetPoints(points);
+    EXPECT_TRUE(std::get<0>(geometry::TriangleMesh::CreateFromPointCloudPoisson(
+                                    no_normals, 5))
+                        ->IsEmpty());
+}
+
+TEST(TriangleMesh, ClusterConnectedTriangles) {
+    geometry::TriangleMesh mesh;
+    thrust::host_vector<Eigen::Vector3f> vertices;
+    // A unit square of two triangles and a lone small triangle.
+    vertices.push_back({0.0, 0.0, 0.0});
+    vertices.push_back({1.0, 0.0, 0.0});
+    vertices.push_back({1.0, 1.0, 0.0});
+    vertices.push_back({0.0, 1.0, 0.0});
+    vertices.push_back({5.0, 5.0, 5.0});
+    vertices.push_back({5.1, 5.0, 5.0});
+    vertices.push_back({5.0, 5.1, 5.0});
+    thrust::host_vector<Eigen::Vector3i> triangles;
+    triangles.push_back({4, 5, 6});
+    triangles.push_back({0, 1, 2});
+    triangles.push_back({0, 2, 3});
+    mesh.SetVertices(vertices);
+    mesh.SetTriangles(triangles);
+
+    auto res = mesh.ClusterConnectedTriangles();
+    thrust::host_vector<int> labels = std::get<0>(res);
+    thrust::host_vector<size_t> n_triangles = std::get<1>(res);
+    thrust::host_vector<float> areas = std::get<2>(res);
+    ASSERT_EQ(labels.size(), 3);
+    EXPECT_EQ(labels[0], 0);
+    EXPECT_EQ(labels[1], 1);
+    EXPECT_EQ(labels[2], 1);
+    ASSERT_EQ(n_triangles.size(), 2);
+    EXPECT_EQ(n_triangles[0], 1);
+    EXPECT_EQ(n_triangles[1], 2);
+    EXPECT_NEAR(areas[0], 0.005, 1.0e-5);
+    EXPECT_NEAR(areas[1], 1.0, 1.0e-5);
+
+    mesh.RemoveSmallTriangleClusters(2);
+    thrust::host_vector<Eigen::Vector3i> kept = mesh.GetTriangles();
+    ASSERT_EQ(kept.size(), 2);
+    EXPECT_EQ(kept[0], Eigen::Vector3i(0, 1, 2));
+    EXPECT_EQ(kept[1], Eigen::Vector3i(0, 2, 3));
+}
@@ -0,0 +1,108 @@
+#include "cupoch/geometry/undistortion_map.h"
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/image.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+template <typename T>
+geometry::Image CreateImage(int width,
+                            int height,
+                            int num_of_channels,
+                            const thrust::host_vector<T> &pixels) {
+    geometry::Image image;
+    image.Prepare(width, height, num_of_channels, sizeof(T));
+    thrust::host_vector<uint8_t> data(
+            (const uint8_t *)pixels.data(),
+            (const uint8_t *)pixels.data() + pixels.size() * sizeof(T));
+    image.SetData(data);
+    return image;
+}
+
+template <typename T>
+thrust::host_vector<T> GetPixels(const geometry::Image &image) {
+    thrust::host_vector<uint8_t> data = image.GetData();
+    const T *p = (const T *)data.data();
+    return thrust::host_vector<T>(p, p + data.size() / sizeof(T));
+}
+
+}  // namespace
+
+TEST(UndistortionMap, DistortPixel) {
+    camera::PinholeCameraIntrinsic intrinsic(100, 100, 100.0, 100.0, 50.0,
+                                             50.0);
+    EXPECT_FALSE(intrinsic.HasDistortion());
+    camera::DistortionCoefficients coeffs =
+            camera::DistortionCoefficients::Zero();
+    coeffs[0] = 0.1;
+    intrinsic.SetDistortion(camera::DistortionModel::BrownConrady, coeffs);
+    EXPECT_TRUE(intrinsic.HasDistortion());
+    ExpectEQ(Vector2f(60.05, 70.1),
+             intrinsic.DistortPixel(Vector2f(60.0, 70.0)));
+    ExpectEQ(Vector2f(50.0, 50.0),
+             intrinsic.DistortPixel(Vector2f(50.0, 50.0)));
+}
+
+TEST(UndistortionMap, RemapIdentity) {
+    const int width = 16;
+    const int height = 12;
+    camera::PinholeCameraIntrinsic intrinsic(width, height, 20.0, 20.0, 7.5,
+                                             5.5);
+    geometry::UndistortionMap map(intrinsic);
+
+    thrust::host_vector<uint8_t> color(width * height * 3);
+    for (size_t i = 0; i < color.size(); ++i) color[i] = (i * 37) % 256;
+    auto remapped = map.Remap(CreateImage(width, height, 3, color));
+    EXPECT_EQ(3, remapped->num_of_channels_);
+    thrust::host_vector<uint8_t> remapped_color =
+            GetPixels<uint8_t>(*remapped);
+    for (size_t i = 0; i < color.size(); ++i) {
+        EXPECT_EQ(color[i], remapped_color[i]);
+    }
+
+    thrust::host_vector<uint16_t> depth(width * height);
+    for (size_t i = 0; i < depth.size(); ++i) depth[i] = 1000 + 7 * i;
+    remapped = map.Remap(CreateImage(width, height, 1, depth), false);
+    EXPECT_EQ(2, remapped->bytes_per_channel_);
+    thrust::host_vector<uint16_t> remapped_depth =
+            GetPixels<uint16_t>(*remapped);
+    for (size_t i = 0; i < depth.size(); ++i) {
+        EXPECT_EQ(depth[i], remapped_depth[i]);
+    }
+}
+
+TEST(UndistortionMap, RemapBrownConrady) {
+    const int width = 64;
+    const int height = 48;
+    camera::PinholeCameraIntrinsic intrinsic(width, height, 50.0, 50.0, 31.5,
+                                             23.5);
+    camera::DistortionCoefficients coeffs =
+            camera::DistortionCoefficients::Zero();
+    coeffs << -0.2, 0.05, 0.001, -0.002, 0.0;
+    intrinsic.SetDistortion(camera::DistortionModel::BrownConrady, coeffs);
+    geometry::UndistortionMap map(intrinsic);
+
+    // The ramp along the columns reads back the distorted column.
+    thrust::host_vector<float> ramp(width * height);
+    for (int v = 0; v < height; ++v) {
+        for (int u = 0; u < width; ++u) ramp[v * width + u] = u;
+    }
+    thrust::host_vector<float> remapped =
+            GetPixels<float>(*map.Remap(CreateImage(width, height, 1, ramp)));
+    for (int v = 0; v < height; ++v) {
+        for (int u = 0; u < width; ++u) {
+            const Vector2f uv_d = intrinsic.DistortPixel(Vector2f(u, v));
+            if (uv_d[0] < 0.0 || uv_d[0] > width - 1 || uv_d[1] < 0.0 ||
+                uv_d[1] > height - 1) {
+                continue;
+            }
+            EXPECT_NEAR(uv_d[0], remapped[v * width + u], 1.0e-2);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include "cupoch/geometry/voxel_hash_index.h"
+
+#include <thrust/sort.h>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(VoxelHashIndex, SearchKNN) {
+    thrust::host_vector<int> ref_indices;
+    int indices0[] = {27, 48, 4,  77, 90, 7,  54, 17, 76, 38,
+                      39, 60, 15, 84, 11, 57, 3,  32, 99, 36,
+                      52, 40, 26, 59, 22, 97, 20, 42, 73, 24};
+    for (int i = 0; i < 30; ++i) ref_indices.push_back(indices0[i]);
+
+    int size = 100;
+
+    geometry::PointCloud pc;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    pc.SetPoints(points);
+
+    geometry::VoxelHashIndex index(1.0, pc);
+
+    thrust::host_vector<Eigen::Vector3f> query(1);
+    query[0] = Eigen::Vector3f(1.647059, 4.392157, 8.784314);
+    utility::device_vector<Eigen::Vector3f> query_dv = query;
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+
+    int result = index.SearchKNN(query_dv, 30, indices_dv, distance2_dv);
+    EXPECT_EQ(result, 1);
+
+    thrust::host_vector<int> indices = indices_dv;
+    thrust::sort(ref_indices.begin(), ref_indices.end());
+    thrust::sort(indices.begin(), indices.end());
+    ExpectEQ(ref_indices, indices);
+}
+
+TEST(VoxelHashIndex, SearchHybridMatchesKDTreeFlann) {
+    int size = 1000;
+
+    geometry::PointCloud pc;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    pc.SetPoints(points);
+
+    geometry::KDTreeSearchParamHybrid param(1.5, 10);
+    utility::device_vector<int> ref_indices_dv;
+    utility::device_vector<float> ref_distance2_dv;
+    geometry::SearchNeighbors(geometry::SearchIndexType::KDTreeFlann,
+                              pc.points_, pc.points_, param, ref_indices_dv,
+                              ref_distance2_dv);
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    geometry::SearchNeighbors(geometry::SearchIndexType::VoxelHash,
+                              pc.points_, pc.points_, param, indices_dv,
+                              distance2_dv);
+
+    thrust::host_vector<int> ref_indices = ref_indices_dv;
+    thrust::host_vector<int> indices = indices_dv;
+    thrust::host_vector<float> ref_distance2 = ref_distance2_dv;
+    thrust::host_vector<float> distance2 = distance2_dv;
+    ExpectEQ(ref_indices, indices);
+    ExpectEQ(ref_distance2, distance2);
+}
+
+TEST(VoxelHashIndex, SearchRadiusCSRMatchesKDTreeFlann) {
+    int size = 1000;
+
+    geometry::PointCloud pc;
+
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+
+    thrust::host_vector<Eigen::Vector3f> points(size);
+    Rand(points, vmin, vmax, 0);
+    pc.SetPoints(points);
+
+    utility::device_vector<int> ref_offsets_dv;
+    utility::device_vector<int> ref_indices_dv;
+    utility::device_vector<float> ref_distance2_dv;
+    geometry::SearchNeighborsCSR(geometry::SearchIndexType::KDTreeFlann,
+                                 pc.points_, pc.points_, 1.5, 10,
+                                 ref_offsets_dv, ref_indices_dv,
+                                 ref_distance2_dv);
+    utility::device_vector<int> offsets_dv;
+    utility::device_vector<int> indices_dv;
+    utility::device_vector<float> distance2_dv;
+    geometry::SearchNeighborsCSR(geometry::SearchIndexType::VoxelHash,
+                                 pc.points_, pc.points_, 1.5, 10, offsets_dv,
+                                 indices_dv, distance2_dv);
+
+    thrust::host_vector<int> ref_offsets = ref_offsets_dv;
+    thrust::host_vector<int> offsets = offsets_dv;
+    thrust::host_vector<float> ref_distance2 = ref_distance2_dv;
+    thrust::host_vector<float> distance2 = distance2_dv;
+    ExpectEQ(ref_offsets, offsets);
+    ExpectEQ(ref_distance2, distance2);
+}
@@ -0,0 +1,71 @@
+#include "cupoch/geometry/voxel_point_map.h"
+#include "cupoch/geometry/pointcloud.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(VoxelPointMap, Insert) {
+    geometry::VoxelPointMap map(1.0, 4, 16);
+    EXPECT_TRUE(map.IsEmpty());
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < 10; ++i) points.push_back(Vector3f(0.5, 0.5, 0.05 * i));
+    points.push_back(Vector3f(-0.5, 0.5, 0.5));
+    map.Insert(points);
+    EXPECT_EQ(map.GetNumVoxels(), 2);
+    // The voxel at the origin keeps 4 of its 10 points.
+    EXPECT_EQ(map.GetNumPoints(), 5);
+    EXPECT_EQ(map.ExtractPointCloud()->points_.size(), 5);
+
+    // The scan is inserted at its pose in the map frame.
+    Matrix4f pose = Matrix4f::Identity();
+    pose.block<3, 1>(0, 3) = Vector3f(10.0, 0.0, 0.0);
+    map.Insert(points, pose);
+    EXPECT_EQ(map.GetNumVoxels(), 4);
+    EXPECT_EQ(map.GetNumPoints(), 10);
+
+    // At most 16 voxels are allocated.
+    points.clear();
+    for (int i = 0; i < 32; ++i) points.push_back(Vector3f(0.5, 0.5, i + 2.5));
+    map.Insert(points);
+    EXPECT_EQ(map.GetNumVoxels(), 16);
+
+    map.Clear();
+    EXPECT_TRUE(map.IsEmpty());
+    EXPECT_EQ(map.GetNumPoints(), 0);
+}
+
+TEST(VoxelPointMap, ReplaceOldest) {
+    geometry::VoxelPointMap map(
+            1.0, 4, 16,
+            geometry::VoxelPointMap::ReplacementPolicy::ReplaceOldest);
+    // One point per scan, so that the order of the insertions is known.
+    for (int i = 0; i < 10; ++i) {
+        thrust::host_vector<Vector3f> points(1, Vector3f(0.5, 0.5, 0.05 * i));
+        map.Insert(points);
+    }
+    EXPECT_EQ(map.GetNumPoints(), 4);
+    thrust::host_vector<Vector3f> h_points = map.ExtractPointCloud()->points_;
+    for (const auto &p : h_points) EXPECT_GT(p(2), 0.29);
+}
+
+TEST(VoxelPointMap, RemoveFarVoxels) {
+    geometry::VoxelPointMap map(1.0, 4, 64);
+    thrust::host_vector<Vector3f> points;
+    for (int i = 0; i < 20; ++i) points.push_back(Vector3f(i + 0.5, 0.5, 0.5));
+    map.Insert(points);
+    EXPECT_EQ(map.GetNumVoxels(), 20);
+    map.RemoveFarVoxels(Vector3f(0.5, 0.5, 0.5), 5.0);
+    EXPECT_EQ(map.GetNumVoxels(), 6);
+    thrust::host_vector<Vector3f> h_points = map.ExtractPointCloud()->points_;
+    EXPECT_EQ(h_points.size(), 6);
+    for (const auto &p : h_points) EXPECT_LT(p(0), 6.0);
+
+    // The freed voxels can be allocated again, and the kept ones are found.
+    map.Insert(points);
+    EXPECT_EQ(map.GetNumVoxels(), 20);
+    EXPECT_EQ(map.GetNumPoints(), 26);
+}
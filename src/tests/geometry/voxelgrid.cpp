@@ -1,13 +1,39 @@
 #include "cupoch/geometry/voxelgrid.h"
 
+#include <algorithm>
+
+#include "cupoch/camera/pinhole_camera_parameters.h"
+#include "cupoch/geometry/image.h"
 #include "cupoch/geometry/lineset.h"
+#include "cupoch/geometry/morton_code.h"
 #include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/geometry/voxelgrid_hash_map.h"
 #include "cupoch/visualization/utility/draw_geometry.h"
 #include "tests/test_utility/unit_test.h"
 
 using namespace cupoch;
 using namespace unit_test;
 
+namespace {
+
+template <typename T>
+std::shared_ptr<geometry::Image> CreateHalfImage(int width,
+                                                 int height,
+                                                 T value) {
+    thrust::host_vector<T> pixels(width * height, 0);
+    for (int v = 0; v < height; ++v) {
+        for (int u = 0; u < width / 2; ++u) pixels[v * width + u] = value;
+    }
+    auto image = std::make_shared<geometry::Image>();
+    image->Prepare(width, height, 1, sizeof(T));
+    image->SetData(thrust::host_vector<uint8_t>(
+            (uint8_t *)pixels.data(),
+            (uint8_t *)pixels.data() + pixels.size() * sizeof(T)));
+    return image;
+}
+
+}  // namespace
+
 TEST(VoxelGrid, Bounds) {
     auto voxel_grid = std::make_shared<geometry::VoxelGrid>();
     voxel_grid->origin_ = Eigen::Vector3f(0, 0, 0);
@@ -47,4 +73,212 @@ TEST(VoxelGrid, Visualization) {
 
     // Uncomment the line below for visualization test
     // visualization::DrawGeometries({voxel_grid});
-}
\ No newline at end of file
+}
+TEST(VoxelGrid, ConnectedComponents) {
+    geometry::VoxelGrid voxel_grid;
+    voxel_grid.voxel_size_ = 1.0;
+    voxel_grid.AddVoxel(geometry::Voxel(Eigen::Vector3i(0, 0, 0)));
+    voxel_grid.AddVoxel(geometry::Voxel(Eigen::Vector3i(1, 0, 0)));
+    voxel_grid.AddVoxel(geometry::Voxel(Eigen::Vector3i(2, 1, 0)));
+    voxel_grid.AddVoxel(geometry::Voxel(Eigen::Vector3i(3, 2, 1)));
+    voxel_grid.AddVoxel(geometry::Voxel(Eigen::Vector3i(5, 5, 5)));
+
+    int labels6[] = {0, 0, 1, 2, 3};
+    int labels18[] = {0, 0, 0, 1, 2};
+    int labels26[] = {0, 0, 0, 0, 1};
+    thrust::host_vector<int> labels = voxel_grid.ConnectedComponents(6);
+    ExpectEQ(thrust::host_vector<int>(labels6, labels6 + 5), labels);
+    labels = voxel_grid.ConnectedComponents(18);
+    ExpectEQ(thrust::host_vector<int>(labels18, labels18 + 5), labels);
+    labels = voxel_grid.ConnectedComponents(26);
+    ExpectEQ(thrust::host_vector<int>(labels26, labels26 + 5), labels);
+}
+
+TEST(VoxelGrid, MortonCode) {
+    const Eigen::Vector3i keys[] = {
+            Eigen::Vector3i(0, 0, 0), Eigen::Vector3i(1, 2, 3),
+            Eigen::Vector3i(-1, -2, -3), Eigen::Vector3i(-(1 << 20), 0, 5),
+            Eigen::Vector3i((1 << 20) - 1, (1 << 20) - 1, (1 << 20) - 1)};
+    for (const auto &key : keys) {
+        EXPECT_TRUE(geometry::IsMortonEncodable(key));
+        ExpectEQ(key, geometry::DecodeMorton(geometry::EncodeMorton(key)));
+    }
+    EXPECT_FALSE(geometry::IsMortonEncodable(Eigen::Vector3i(1 << 20, 0, 0)));
+    EXPECT_LT(geometry::EncodeMorton(Eigen::Vector3i(0, 0, 1)),
+              geometry::EncodeMorton(Eigen::Vector3i(0, 1, 0)));
+    EXPECT_LT(geometry::EncodeMorton(Eigen::Vector3i(0, 1, 0)),
+              geometry::EncodeMorton(Eigen::Vector3i(1, 0, 0)));
+    EXPECT_LT(geometry::EncodeMorton(Eigen::Vector3i(1, 1, 1)),
+              geometry::EncodeMorton(Eigen::Vector3i(2, 0, 0)));
+}
+
+TEST(VoxelGrid, MergeVoxels) {
+    geometry::VoxelGrid grid0;
+    grid0.voxel_size_ = 1.0;
+    thrust::host_vector<geometry::Voxel> voxels0;
+    for (int i = 0; i < 8; ++i) {
+        voxels0.push_back(geometry::Voxel(Eigen::Vector3i(i, 0, 0),
+                                          Eigen::Vector3f(1.0, 0.0, 0.0)));
+    }
+    grid0.AddVoxels(voxels0);
+    geometry::VoxelGrid grid1;
+    grid1.voxel_size_ = 1.0;
+    thrust::host_vector<geometry::Voxel> voxels1;
+    for (int i = 4; i < 12; ++i) {
+        voxels1.push_back(geometry::Voxel(Eigen::Vector3i(i, 0, 0),
+                                          Eigen::Vector3f(0.0, 1.0, 0.0)));
+    }
+    grid1.AddVoxels(voxels1);
+
+    // The colors of the voxels in both grids are averaged.
+    geometry::VoxelGrid merged = grid0 + grid1;
+    thrust::host_vector<Eigen::Vector3i> keys;
+    thrust::host_vector<geometry::Voxel> values;
+    keys = merged.voxels_keys_;
+    values = merged.voxels_values_;
+    ASSERT_EQ(keys.size(), 12);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i > 0) {
+            EXPECT_LT(geometry::EncodeMorton(keys[i - 1]),
+                      geometry::EncodeMorton(keys[i]));
+        }
+        const int x = keys[i](0);
+        const Eigen::Vector3f color =
+                (x < 4) ? Eigen::Vector3f(1.0, 0.0, 0.0)
+                        : (x < 8) ? Eigen::Vector3f(0.5, 0.5, 0.0)
+                                  : Eigen::Vector3f(0.0, 1.0, 0.0);
+        ExpectEQ(values[i].color_, color);
+        ExpectEQ(values[i].grid_index_, keys[i]);
+    }
+
+    // The voxels already in the grid are kept.
+    grid0.AddVoxels(voxels1);
+    keys = grid0.voxels_keys_;
+    values = grid0.voxels_values_;
+    ASSERT_EQ(keys.size(), 12);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(values[i].color_(0), (keys[i](0) < 8) ? 1.0 : 0.0);
+    }
+
+    // Voxels set out of Morton order are sorted before the merge.
+    geometry::VoxelGrid unsorted;
+    unsorted.voxel_size_ = 1.0;
+    thrust::host_vector<Eigen::Vector3i> unsorted_keys;
+    thrust::host_vector<geometry::Voxel> unsorted_values;
+    for (int i = 7; i >= 0; --i) {
+        unsorted_keys.push_back(Eigen::Vector3i(0, i, 0));
+        unsorted_values.push_back(geometry::Voxel(Eigen::Vector3i(0, i, 0)));
+    }
+    unsorted.SetVoxels(unsorted_keys, unsorted_values);
+    unsorted += grid1;
+    keys = unsorted.voxels_keys_;
+    values = unsorted.voxels_values_;
+    ASSERT_EQ(keys.size(), 16);
+    for (size_t i = 1; i < keys.size(); ++i) {
+        EXPECT_LT(geometry::EncodeMorton(keys[i - 1]),
+                  geometry::EncodeMorton(keys[i]));
+    }
+}
+
+TEST(VoxelGrid, HashMap) {
+    geometry::VoxelGrid voxel_grid;
+    voxel_grid.voxel_size_ = 0.5;
+    voxel_grid.origin_ = Eigen::Vector3f(-1.0, 0.0, 0.0);
+    thrust::host_vector<geometry::Voxel> voxels;
+    for (int i = 0; i < 100; ++i) {
+        voxels.push_back(geometry::Voxel(Eigen::Vector3i(i, -i, 2 * i)));
+    }
+    voxel_grid.AddVoxels(voxels);
+
+    geometry::VoxelGridHashMap hash_map(voxel_grid);
+    EXPECT_EQ(hash_map.GetNumVoxels(), 100);
+    thrust::host_vector<Eigen::Vector3i> keys = voxel_grid.voxels_keys_;
+    thrust::host_vector<Eigen::Vector3i> query_keys = keys;
+    query_keys.push_back(Eigen::Vector3i(1, 1, 1));
+    thrust::host_vector<int> indices =
+            hash_map.Find(utility::device_vector<Eigen::Vector3i>(query_keys));
+    ASSERT_EQ(indices.size(), 101);
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(indices[i], i);
+    EXPECT_EQ(indices[100], -1);
+
+    // The voxel (3, -3, 6) spans [0.5, 1.0) x [-1.5, -1.0) x [3.0, 3.5).
+    thrust::host_vector<Eigen::Vector3f> queries;
+    queries.push_back(Eigen::Vector3f(0.75, -1.25, 3.25));
+    queries.push_back(Eigen::Vector3f(0.75, -1.25, 3.75));
+    thrust::host_vector<bool> included = voxel_grid.CheckIfIncluded(queries);
+    EXPECT_TRUE(included[0]);
+    EXPECT_FALSE(included[1]);
+    thrust::host_vector<int> point_indices = hash_map.FindPoints(
+            utility::device_vector<Eigen::Vector3f>(queries));
+    ExpectEQ(keys[point_indices[0]], Eigen::Vector3i(3, -3, 6));
+    EXPECT_EQ(point_indices[1], -1);
+}
+
+TEST(VoxelGrid, CreateFromTriangleMesh) {
+    // The faces of the box lie in the middle of the outer voxels.
+    auto box = geometry::TriangleMesh::CreateBox(4.0, 4.0, 4.0);
+    const Eigen::Vector3f min_bound = Eigen::Vector3f::Constant(-0.125);
+    const Eigen::Vector3f max_bound = Eigen::Vector3f::Constant(4.125);
+    auto surface = geometry::VoxelGrid::CreateFromTriangleMeshWithinBounds(
+            *box, 0.25, min_bound, max_bound);
+    EXPECT_EQ(surface->voxels_keys_.size(), 17 * 17 * 17 - 15 * 15 * 15);
+    thrust::host_vector<Eigen::Vector3i> keys = surface->voxels_keys_;
+    for (const auto &key : keys) {
+        EXPECT_TRUE(key.minCoeff() == 0 || key.maxCoeff() == 16);
+    }
+
+    auto solid = geometry::VoxelGrid::CreateSolidFromTriangleMeshWithinBounds(
+            *box, 0.25, min_bound, max_bound);
+    EXPECT_EQ(solid->voxels_keys_.size(), 17 * 17 * 17);
+
+    // With a margin of one voxel around the box.
+    auto mask = geometry::VoxelGrid::ComputeSolidMaskFromTriangleMesh(
+            *box, 1.0, Eigen::Vector3f::Constant(-1.5),
+            Eigen::Vector3f::Constant(5.5));
+    EXPECT_EQ(mask.size(), 7 * 7 * 7);
+    thrust::host_vector<uint8_t> h_mask = mask;
+    for (int w = 0; w < 7; ++w) {
+        for (int h = 0; h < 7; ++h) {
+            for (int d = 0; d < 7; ++d) {
+                const bool inside = std::min({w, h, d}) > 0 &&
+                                    std::max({w, h, d}) < 6;
+                EXPECT_EQ(h_mask[(w * 7 + h) * 7 + d], inside ? 1 : 0);
+            }
+        }
+    }
+}
+
+TEST(VoxelGrid, CarveDepthMapsAndSilhouettes) {
+    const int width = 64;
+    const int height = 48;
+    camera::PinholeCameraParameters view0;
+    view0.intrinsic_ = camera::PinholeCameraIntrinsic(width, height, 40.0,
+                                                      40.0, 32.0, 24.0);
+    view0.extrinsic_ = Eigen::Matrix4f::Identity();
+    camera::PinholeCameraParameters view1 = view0;
+    view1.extrinsic_(0, 3) = 0.2;
+    auto dense = geometry::VoxelGrid::CreateDense(
+            Eigen::Vector3f(-0.5, -0.5, 1.0), 0.1, 1.0, 1.0, 1.0);
+    auto depth0 = CreateHalfImage<float>(width, height, 1.5);
+    auto depth1 = CreateHalfImage<float>(width, height, 1.3);
+
+    geometry::VoxelGrid sequential = *dense;
+    sequential.CarveDepthMap(*depth0, view0, false);
+    sequential.CarveDepthMap(*depth1, view1, false);
+    geometry::VoxelGrid batch = *dense;
+    batch.CarveDepthMaps({depth0, depth1}, {view0, view1}, false);
+    EXPECT_GT(batch.voxels_keys_.size(), 0);
+    EXPECT_LT(batch.voxels_keys_.size(), dense->voxels_keys_.size());
+    thrust::host_vector<Eigen::Vector3i> sequential_keys =
+            sequential.voxels_keys_;
+    thrust::host_vector<Eigen::Vector3i> batch_keys = batch.voxels_keys_;
+    ExpectEQ(sequential_keys, batch_keys);
+
+    // Only the voxels seen on the left half of the mask are kept.
+    auto mask = CreateHalfImage<uint8_t>(width, height, 255);
+    geometry::VoxelGrid carved = *dense;
+    carved.CarveSilhouettes({mask}, {view0}, false);
+    EXPECT_GT(carved.voxels_keys_.size(), 0);
+    thrust::host_vector<Eigen::Vector3i> keys = carved.voxels_keys_;
+    for (const auto &key : keys) EXPECT_LT(key(0), 5);
+}
@@ -0,0 +1,49 @@
+#include "cupoch/integration/multi_device_tsdfvolume.h"
+
+#include "cupoch/camera/pinhole_camera_intrinsic.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/geometry/trianglemesh.h"
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/io/class_io/image_io.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace unit_test;
+
+TEST(MultiDeviceScalableTSDFVolume, MatchesScalableTSDFVolume) {
+    geometry::Image im_color, im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    auto im_rgbd = geometry::RGBDImage::CreateFromColorAndDepth(
+            im_color, im_depth, 1000.0, 4.0, false);
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    const Eigen::Matrix4f extrinsic = Eigen::Matrix4f::Identity();
+
+    integration::ScalableTSDFVolume ref_volume(
+            0.02, 0.04, integration::TSDFVolumeColorType::RGB8);
+    ref_volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+    // Three shards on the first device, so that the halo exchange is
+    // exercised on machines with a single GPU.
+    integration::MultiDeviceScalableTSDFVolume volume(
+            0.02, 0.04, integration::TSDFVolumeColorType::RGB8, {0, 0, 0});
+    volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+
+    EXPECT_EQ(volume.GetNumBlocks(), ref_volume.GetNumBlocks());
+    for (size_t i = 0; i < volume.GetDevices().size(); ++i) {
+        EXPECT_GT(volume.GetShard(i).GetNumBlocks(), 0);
+    }
+    EXPECT_EQ(volume.ExtractPointCloud()->points_.size(),
+              ref_volume.ExtractPointCloud()->points_.size());
+    auto mesh = volume.ExtractTriangleMesh();
+    auto ref_mesh = ref_volume.ExtractTriangleMesh();
+    EXPECT_EQ(mesh->vertices_.size(), ref_mesh->vertices_.size());
+    EXPECT_EQ(mesh->triangles_.size(), ref_mesh->triangles_.size());
+    EXPECT_EQ(mesh->vertex_colors_.size(), mesh->vertices_.size());
+
+    volume.Reset();
+    EXPECT_EQ(volume.GetNumBlocks(), 0);
+}
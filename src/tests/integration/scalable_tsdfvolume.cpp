@@ -0,0 +1,126 @@
+#include <fstream>
+
+#include "cupoch/integration/scalable_tsdfvolume.h"
+#include "cupoch/integration/uniform_tsdfvolume.h"
+#include "cupoch/io/class_io/image_io.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace unit_test;
+
+namespace {
+
+// Extrinsics of the frames of a trajectory in the .log format.
+std::vector<Eigen::Matrix4f> ReadExtrinsics(const std::string& path) {
+    std::vector<Eigen::Matrix4f> extrinsics;
+    std::ifstream file(path);
+    int ids[3];
+    while (file >> ids[0] >> ids[1] >> ids[2]) {
+        Eigen::Matrix4f pose;
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) file >> pose(r, c);
+        }
+        extrinsics.push_back(pose.inverse());
+    }
+    return extrinsics;
+}
+
+std::shared_ptr<geometry::RGBDImage> ReadRGBDImage(size_t i) {
+    std::ostringstream color_path, depth_path;
+    color_path << TEST_DATA_DIR << "/rgbd/color/" << std::setfill('0')
+               << std::setw(5) << i << ".jpg";
+    depth_path << TEST_DATA_DIR << "/rgbd/depth/" << std::setfill('0')
+               << std::setw(5) << i << ".png";
+    geometry::Image im_color, im_depth;
+    io::ReadImage(color_path.str(), im_color);
+    io::ReadImage(depth_path.str(), im_depth);
+    return geometry::RGBDImage::CreateFromColorAndDepth(im_color, im_depth,
+                                                        1000.0, 4.0, false);
+}
+
+}  // namespace
+
+TEST(ScalableTSDFVolume, Constructor) {
+    integration::ScalableTSDFVolume tsdf_volume(
+            0.04, 0.16, integration::TSDFVolumeColorType::RGB8, 1000);
+    EXPECT_EQ(tsdf_volume.voxel_length_, 0.04f);
+    EXPECT_EQ(tsdf_volume.sdf_trunc_, 0.16f);
+    EXPECT_EQ(tsdf_volume.max_num_blocks_, 1000);
+    EXPECT_EQ(tsdf_volume.GetNumBlocks(), 0);
+    EXPECT_EQ(tsdf_volume.block_table_.bucket_count(), 2048u);
+    EXPECT_EQ(tsdf_volume.voxels_.size(), 0u);
+}
+
+TEST(ScalableTSDFVolume, RealData) {
+    const std::vector<Eigen::Matrix4f> extrinsics = ReadExtrinsics(
+            std::string(TEST_DATA_DIR) + "/rgbd/odometry.log");
+    ASSERT_FALSE(extrinsics.empty());
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+
+    // Same voxels as the 4m, 100^3 UniformTSDFVolume test.
+    integration::UniformTSDFVolume uniform_volume(
+            4.0, 100, 0.04, integration::TSDFVolumeColorType::RGB8);
+    integration::ScalableTSDFVolume scalable_volume(
+            0.04, 0.04, integration::TSDFVolumeColorType::RGB8);
+    for (size_t i = 0; i < extrinsics.size(); ++i) {
+        auto im_rgbd = ReadRGBDImage(i);
+        uniform_volume.Integrate(*im_rgbd, intrinsic, extrinsics[i]);
+        scalable_volume.Integrate(*im_rgbd, intrinsic, extrinsics[i]);
+    }
+    EXPECT_GT(scalable_volume.GetNumBlocks(), 0);
+    EXPECT_LT(scalable_volume.voxels_.size(), 100u * 100u * 100u);
+
+    // The scene lies in the positive octant covered by the uniform volume,
+    // and the scalable volume adds the surface beyond its borders.
+    auto uniform_pcd = uniform_volume.ExtractPointCloud();
+    auto scalable_pcd = scalable_volume.ExtractPointCloud();
+    EXPECT_GE(scalable_pcd->points_.size(), uniform_pcd->points_.size());
+    EXPECT_EQ(scalable_pcd->normals_.size(), scalable_pcd->points_.size());
+    EXPECT_EQ(scalable_pcd->colors_.size(), scalable_pcd->points_.size());
+
+    auto mesh = scalable_volume.ExtractTriangleMesh();
+    EXPECT_GT(mesh->vertices_.size(), 0u);
+    EXPECT_GT(mesh->triangles_.size(), 0u);
+    EXPECT_EQ(mesh->vertex_colors_.size(), mesh->vertices_.size());
+
+    auto voxel_pcd = scalable_volume.ExtractVoxelPointCloud();
+    EXPECT_GT(voxel_pcd->points_.size(), 0u);
+
+    scalable_volume.Reset();
+    EXPECT_EQ(scalable_volume.GetNumBlocks(), 0);
+    EXPECT_EQ(scalable_volume.ExtractPointCloud()->points_.size(), 0u);
+}
+
+TEST(ScalableTSDFVolume, RaycastDepth) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    auto im_rgbd = ReadRGBDImage(0);
+    integration::ScalableTSDFVolume tsdf_volume(
+            0.01, 0.04, integration::TSDFVolumeColorType::RGB8);
+    const Eigen::Matrix4f extrinsic = Eigen::Matrix4f::Identity();
+    tsdf_volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+    const auto bound = tsdf_volume.GetAxisAlignedBoundingBox();
+    EXPECT_GT(bound.GetMaxExtent(), 0.0f);
+
+    // Seen from the integrated camera, the surface lies at the input depth.
+    auto depth = tsdf_volume.RaycastDepth(intrinsic, extrinsic, 4.0);
+    ASSERT_EQ(depth->width_, intrinsic.width_);
+    thrust::host_vector<uint8_t> h_raycast = depth->data_;
+    thrust::host_vector<uint8_t> h_input = im_rgbd->depth_.data_;
+    const float* raycast = (const float*)h_raycast.data();
+    const float* input = (const float*)h_input.data();
+    int n_hits = 0;
+    float diff_sum = 0.0;
+    for (int i = 0; i < intrinsic.width_ * intrinsic.height_; ++i) {
+        if (raycast[i] <= 0.0 || input[i] <= 0.0) continue;
+        diff_sum += std::abs(raycast[i] - input[i]);
+        ++n_hits;
+    }
+    EXPECT_GT(n_hits, intrinsic.width_ * intrinsic.height_ / 4);
+    EXPECT_LT(diff_sum / n_hits, 0.01);
+
+    auto color = tsdf_volume.RaycastColor(intrinsic, extrinsic, 4.0);
+    EXPECT_EQ(color->num_of_channels_, 3);
+    EXPECT_EQ(color->height_, intrinsic.height_);
+}
@@ -1,3 +1,4 @@
+#include "cupoch/geometry/distancetransform.h"
 #include "cupoch/integration/uniform_tsdfvolume.h"
 #include "cupoch/io/class_io/image_io.h"
 #include "cupoch/utility/filesystem.h"
@@ -160,4 +161,331 @@ TEST(UniformTSDFVolume, RealData) {
     }
     ExpectEQ(color_sum, Eigen::Vector3f(2096.428416, 2096.428416, 2096.428416),
              /*threshold*/ 0.1);
-}
\ No newline at end of file
+}
+TEST(UniformTSDFVolume, Raycast) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    geometry::Image im_color;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    geometry::Image im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    std::shared_ptr<geometry::RGBDImage> im_rgbd =
+            geometry::RGBDImage::CreateFromColorAndDepth(
+                    im_color, im_depth, 1000.0, 3.0, false);
+
+    integration::UniformTSDFVolume tsdf_volume(
+            3.0, 256, 0.04, integration::TSDFVolumeColorType::RGB8,
+            Eigen::Vector3f(-1.5, -1.5, 0.0));
+    const Eigen::Matrix4f extrinsic = Eigen::Matrix4f::Identity();
+    tsdf_volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+
+    std::shared_ptr<geometry::Image> vertex_map, normal_map, color_map;
+    std::tie(vertex_map, normal_map, color_map) =
+            tsdf_volume.Raycast(intrinsic, extrinsic);
+    EXPECT_EQ(vertex_map->width_, intrinsic.width_);
+    EXPECT_EQ(vertex_map->num_of_channels_, 3);
+    EXPECT_EQ(color_map->height_, intrinsic.height_);
+
+    // Seen from the integrated camera, the surface lies at the input depth.
+    thrust::host_vector<uint8_t> h_vertex = vertex_map->data_;
+    thrust::host_vector<uint8_t> h_normal = normal_map->data_;
+    thrust::host_vector<uint8_t> h_depth = im_rgbd->depth_.data_;
+    const float* vertices = (const float*)h_vertex.data();
+    const float* normals = (const float*)h_normal.data();
+    const float* depths = (const float*)h_depth.data();
+    int n_hits = 0;
+    float diff_sum = 0.0;
+    for (int i = 0; i < intrinsic.width_ * intrinsic.height_; ++i) {
+        const float z = vertices[3 * i + 2];
+        if (std::isnan(z) || depths[i] <= 0.0) continue;
+        diff_sum += std::abs(z - depths[i]);
+        EXPECT_NEAR(Eigen::Map<const Eigen::Vector3f>(normals + 3 * i).norm(),
+                    1.0, 1.0e-3);
+        ++n_hits;
+    }
+    EXPECT_GT(n_hits, intrinsic.width_ * intrinsic.height_ / 4);
+    EXPECT_LT(diff_sum / n_hits, 0.01);
+}
+
+TEST(UniformTSDFVolume, RaycastDepthAndColor) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    geometry::Image im_color;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    geometry::Image im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    std::shared_ptr<geometry::RGBDImage> im_rgbd =
+            geometry::RGBDImage::CreateFromColorAndDepth(
+                    im_color, im_depth, 1000.0, 3.0, false);
+    integration::UniformTSDFVolume tsdf_volume(
+            3.0, 256, 0.04, integration::TSDFVolumeColorType::RGB8,
+            Eigen::Vector3f(-1.5, -1.5, 0.0));
+    const Eigen::Matrix4f extrinsic = Eigen::Matrix4f::Identity();
+    tsdf_volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+
+    auto depth = tsdf_volume.RaycastDepth(intrinsic, extrinsic);
+    auto color = tsdf_volume.RaycastColor(intrinsic, extrinsic);
+    EXPECT_EQ(depth->num_of_channels_, 1);
+    EXPECT_EQ(depth->bytes_per_channel_, 4);
+    EXPECT_EQ(color->num_of_channels_, 3);
+    EXPECT_EQ(color->bytes_per_channel_, 1);
+
+    // Skipping the unobserved blocks gives the hits of the full raycast.
+    std::shared_ptr<geometry::Image> vertex_map, normal_map, color_map;
+    std::tie(vertex_map, normal_map, color_map) =
+            tsdf_volume.Raycast(intrinsic, extrinsic);
+    thrust::host_vector<uint8_t> h_vertex = vertex_map->data_;
+    thrust::host_vector<uint8_t> h_depth = depth->data_;
+    const float* vertices = (const float*)h_vertex.data();
+    const float* depths = (const float*)h_depth.data();
+    int n_hits = 0;
+    for (int i = 0; i < intrinsic.width_ * intrinsic.height_; ++i) {
+        const float z = vertices[3 * i + 2];
+        if (std::isnan(z)) {
+            EXPECT_EQ(depths[i], 0.0f);
+            continue;
+        }
+        EXPECT_NEAR(depths[i], z, 1.0e-5);
+        ++n_hits;
+    }
+    EXPECT_GT(n_hits, intrinsic.width_ * intrinsic.height_ / 4);
+}
+
+TEST(UniformTSDFVolume, CompactVoxels) {
+    static_assert(sizeof(geometry::CompactTSDFVoxel) == 8,
+                  "CompactTSDFVoxel must stay 8 bytes");
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    geometry::Image im_color;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    geometry::Image im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    std::shared_ptr<geometry::RGBDImage> im_rgbd =
+            geometry::RGBDImage::CreateFromColorAndDepth(
+                    im_color, im_depth, 1000.0, 4.0, false);
+
+    integration::UniformTSDFVolume full_volume(
+            4.0, 100, 0.04, integration::TSDFVolumeColorType::RGB8);
+    integration::UniformTSDFVolume compact_volume(
+            4.0, 100, 0.04, integration::TSDFVolumeColorType::RGB8,
+            Eigen::Vector3f::Zero(), true);
+    EXPECT_EQ(compact_volume.voxels_.size(), 0u);
+    EXPECT_EQ(int(compact_volume.compact_voxels_.size()),
+              compact_volume.voxel_num_);
+    EXPECT_EQ(compact_volume.GetMemorySize() * 4, full_volume.GetMemorySize());
+
+    const Eigen::Matrix4f extrinsic = Eigen::Matrix4f::Identity();
+    full_volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+    compact_volume.Integrate(*im_rgbd, intrinsic, extrinsic);
+
+    // The quantization moves only the points whose TSDF is close to the
+    // thresholds of the extraction.
+    auto full_pcd = full_volume.ExtractPointCloud();
+    auto compact_pcd = compact_volume.ExtractPointCloud();
+    ASSERT_GT(full_pcd->points_.size(), 0u);
+    EXPECT_NEAR(float(compact_pcd->points_.size()),
+                float(full_pcd->points_.size()),
+                0.01 * full_pcd->points_.size());
+    EXPECT_EQ(compact_pcd->colors_.size(), compact_pcd->points_.size());
+    auto full_mesh = full_volume.ExtractTriangleMesh();
+    auto compact_mesh = compact_volume.ExtractTriangleMesh();
+    EXPECT_NEAR(float(compact_mesh->triangles_.size()),
+                float(full_mesh->triangles_.size()),
+                0.01 * full_mesh->triangles_.size());
+}
+
+TEST(UniformTSDFVolume, ExtractTriangleMeshIncremental) {
+    std::string test_data_dir = std::string(TEST_DATA_DIR);
+    thrust::host_vector<Eigen::Matrix4f> poses;
+    ASSERT_TRUE(ReadPoses(test_data_dir + "/rgbd/odometry.log", poses));
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    integration::UniformTSDFVolume tsdf_volume(
+            4.0, 100, 0.04, integration::TSDFVolumeColorType::RGB8);
+
+    std::shared_ptr<geometry::TriangleMesh> incremental;
+    for (size_t i = 0; i < poses.size(); ++i) {
+        std::ostringstream im_color_path, im_depth_path;
+        im_color_path << TEST_DATA_DIR << "/rgbd/color/" << std::setfill('0')
+                      << std::setw(5) << i << ".jpg";
+        im_depth_path << TEST_DATA_DIR << "/rgbd/depth/" << std::setfill('0')
+                      << std::setw(5) << i << ".png";
+        geometry::Image im_color, im_depth;
+        io::ReadImage(im_color_path.str(), im_color);
+        io::ReadImage(im_depth_path.str(), im_depth);
+        std::shared_ptr<geometry::RGBDImage> im_rgbd =
+                geometry::RGBDImage::CreateFromColorAndDepth(
+                        im_color, im_depth, 1000.0, 4.0, false);
+        tsdf_volume.Integrate(*im_rgbd, intrinsic, poses[i].inverse());
+
+        // The patched mesh has the triangles of a full extraction, with the
+        // vertices repeated per cube.
+        incremental = tsdf_volume.ExtractTriangleMeshIncremental();
+        auto full = tsdf_volume.ExtractTriangleMesh();
+        EXPECT_EQ(incremental->triangles_.size(), full->triangles_.size());
+        EXPECT_GE(incremental->vertices_.size(), full->vertices_.size());
+        EXPECT_EQ(incremental->vertex_colors_.size(),
+                  incremental->vertices_.size());
+    }
+    EXPECT_GT(incremental->triangles_.size(), 0u);
+
+    // Without a new frame, nothing is meshed again.
+    const size_t n_triangles = incremental->triangles_.size();
+    EXPECT_EQ(tsdf_volume.ExtractTriangleMeshIncremental()->triangles_.size(),
+              n_triangles);
+
+    tsdf_volume.Reset();
+    EXPECT_EQ(tsdf_volume.ExtractTriangleMeshIncremental()->triangles_.size(),
+              0u);
+}
+
+TEST(UniformTSDFVolume, ExtractTriangleMeshSharesVertices) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    geometry::Image im_color;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    geometry::Image im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    std::shared_ptr<geometry::RGBDImage> im_rgbd =
+            geometry::RGBDImage::CreateFromColorAndDepth(
+                    im_color, im_depth, 1000.0, 4.0, false);
+    integration::UniformTSDFVolume tsdf_volume(
+            3.0, 128, 0.04, integration::TSDFVolumeColorType::RGB8,
+            Eigen::Vector3f(-1.5, -1.5, 0.0));
+    tsdf_volume.Integrate(*im_rgbd, intrinsic, Eigen::Matrix4f::Identity());
+
+    auto mesh = tsdf_volume.ExtractTriangleMesh();
+    ASSERT_GT(mesh->triangles_.size(), 0u);
+    EXPECT_EQ(mesh->vertex_colors_.size(), mesh->vertices_.size());
+    // Every vertex is used, and only the vertices of the surface passing
+    // exactly through a voxel are repeated.
+    const size_t n_vertices = mesh->vertices_.size();
+    geometry::TriangleMesh deduplicated = *mesh;
+    deduplicated.RemoveUnreferencedVertices();
+    EXPECT_EQ(deduplicated.vertices_.size(), n_vertices);
+    deduplicated.RemoveDuplicatedVertices();
+    EXPECT_GT(deduplicated.vertices_.size(), 0.999 * n_vertices);
+    // A closed patch of surface has about twice as many triangles as
+    // vertices; repeated vertices would give three vertices per triangle.
+    EXPECT_LT(n_vertices, mesh->triangles_.size());
+}
+
+TEST(UniformTSDFVolume, ExtractESDFIncremental) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    geometry::Image im_color;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    geometry::Image im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    std::shared_ptr<geometry::RGBDImage> im_rgbd =
+            geometry::RGBDImage::CreateFromColorAndDepth(
+                    im_color, im_depth, 1000.0, 4.0, false);
+    integration::UniformTSDFVolume tsdf_volume(
+            3.0, 128, 0.04, integration::TSDFVolumeColorType::RGB8,
+            Eigen::Vector3f(-1.5, -1.5, 0.0));
+    tsdf_volume.Integrate(*im_rgbd, intrinsic, Eigen::Matrix4f::Identity());
+
+    const float max_distance = 0.3;
+    auto esdf = tsdf_volume.ExtractESDFIncremental(max_distance);
+    auto mesh = tsdf_volume.ExtractTriangleMesh();
+    ASSERT_GT(mesh->vertices_.size(), 0u);
+    // The surface is at most about a voxel from the sites, and no distance
+    // exceeds the bound of the wavefront.
+    utility::device_vector<float> distances;
+    esdf->GetDistances(mesh->vertices_, distances);
+    thrust::host_vector<float> h_distances = distances;
+    const float voxel_length = 3.0 / 128;
+    for (size_t i = 0; i < h_distances.size(); ++i) {
+        EXPECT_LE(h_distances[i], 2.0 * voxel_length);
+    }
+    thrust::host_vector<geometry::DistanceVoxel> h_voxels = esdf->voxels_;
+    float max_d = 0;
+    for (const auto& v : h_voxels) max_d = std::max(max_d, v.distance_);
+    EXPECT_NEAR(max_d * voxel_length, max_distance, 1.0e-5);
+
+    // Without a new frame, the transform is kept as it is.
+    EXPECT_EQ(tsdf_volume.ExtractESDFIncremental(max_distance), esdf);
+    tsdf_volume.Integrate(*im_rgbd, intrinsic, Eigen::Matrix4f::Identity());
+    EXPECT_EQ(tsdf_volume.ExtractESDFIncremental(max_distance), esdf);
+}
+
+TEST(UniformTSDFVolume, IntegrateRawDepth) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    geometry::Image im_color;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/color/00000.jpg",
+                  im_color);
+    geometry::Image im_depth;
+    io::ReadImage(std::string(TEST_DATA_DIR) + "/rgbd/depth/00000.png",
+                  im_depth);
+    ASSERT_EQ(im_depth.bytes_per_channel_, 2);
+    // No truncation, as the 16 bit depth is read as it is.
+    std::shared_ptr<geometry::RGBDImage> im_rgbd =
+            geometry::RGBDImage::CreateFromColorAndDepth(
+                    im_color, im_depth, 1000.0, 1000.0, false);
+    geometry::RGBDImage im_raw(im_color, im_depth);
+    integration::UniformTSDFVolume converted(
+            3.0, 64, 0.04, integration::TSDFVolumeColorType::RGB8,
+            Eigen::Vector3f(-1.5, -1.5, 0.0));
+    integration::UniformTSDFVolume raw = converted;
+    converted.Integrate(*im_rgbd, intrinsic, Eigen::Matrix4f::Identity());
+    raw.Integrate(im_raw, intrinsic, Eigen::Matrix4f::Identity());
+    const size_t n_converted = converted.ExtractPointCloud()->points_.size();
+    ASSERT_GT(n_converted, 0u);
+    // Up to the rounding of the depth scaling.
+    EXPECT_NEAR(raw.ExtractPointCloud()->points_.size(), n_converted,
+                0.01 * n_converted);
+}
+
+TEST(UniformTSDFVolume, IntegrateBatch) {
+    std::string test_data_dir = std::string(TEST_DATA_DIR);
+    thrust::host_vector<Eigen::Matrix4f> poses;
+    ASSERT_TRUE(ReadPoses(test_data_dir + "/rgbd/odometry.log", poses));
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    integration::UniformTSDFVolume sequential(
+            4.0, 100, 0.04, integration::TSDFVolumeColorType::RGB8);
+    integration::UniformTSDFVolume batched(
+            4.0, 100, 0.04, integration::TSDFVolumeColorType::RGB8);
+
+    std::vector<std::shared_ptr<geometry::RGBDImage>> images;
+    std::vector<Eigen::Matrix4f_u> extrinsics;
+    for (size_t i = 0; i < poses.size(); ++i) {
+        std::ostringstream im_color_path, im_depth_path;
+        im_color_path << TEST_DATA_DIR << "/rgbd/color/" << std::setfill('0')
+                      << std::setw(5) << i << ".jpg";
+        im_depth_path << TEST_DATA_DIR << "/rgbd/depth/" << std::setfill('0')
+                      << std::setw(5) << i << ".png";
+        geometry::Image im_color, im_depth;
+        io::ReadImage(im_color_path.str(), im_color);
+        io::ReadImage(im_depth_path.str(), im_depth);
+        images.push_back(geometry::RGBDImage::CreateFromColorAndDepth(
+                im_color, im_depth, 1000.0, 4.0, false));
+        extrinsics.push_back(poses[i].inverse());
+        sequential.Integrate(*images.back(), intrinsic, extrinsics.back());
+    }
+    batched.IntegrateBatch(images, intrinsic, extrinsics);
+
+    // The frames are applied in the same order to every voxel.
+    thrust::host_vector<geometry::TSDFVoxel> h_sequential = sequential.voxels_;
+    thrust::host_vector<geometry::TSDFVoxel> h_batched = batched.voxels_;
+    ASSERT_EQ(h_batched.size(), h_sequential.size());
+    for (size_t i = 0; i < h_sequential.size(); ++i) {
+        EXPECT_NEAR(h_batched[i].tsdf_, h_sequential[i].tsdf_, 1.0e-5);
+        EXPECT_NEAR(h_batched[i].weight_, h_sequential[i].weight_, 1.0e-5);
+    }
+    EXPECT_EQ(batched.ExtractPointCloud()->points_.size(),
+              sequential.ExtractPointCloud()->points_.size());
+    EXPECT_EQ(batched.ExtractTriangleMeshIncremental()->triangles_.size(),
+              sequential.ExtractTriangleMesh()->triangles_.size());
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/io/class_io/image_io.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace cupoch::io;
+using namespace unit_test;
+
+TEST(ImageIO, ReadImagesFromJPG) {
+    const std::string color = std::string(TEST_DATA_DIR) + "/lena_color.jpg";
+    const std::string gray = std::string(TEST_DATA_DIR) + "/lena_gray.jpg";
+    std::vector<std::shared_ptr<geometry::Image>> images;
+    EXPECT_FALSE(ReadImagesFromJPG({color, gray, "missing.jpg"}, images));
+    ASSERT_EQ(images.size(), 3u);
+    EXPECT_EQ(images[0]->num_of_channels_, 3);
+    EXPECT_EQ(images[1]->num_of_channels_, 1);
+    EXPECT_TRUE(images[2]->IsEmpty());
+
+    // Same pixels as one by one, up to the rounding of the decoders.
+    geometry::Image single;
+    ASSERT_TRUE(ReadImageFromJPG(color, single));
+    EXPECT_EQ(single.width_, images[0]->width_);
+    EXPECT_EQ(single.height_, images[0]->height_);
+    thrust::host_vector<uint8_t> ref = single.GetData();
+    thrust::host_vector<uint8_t> data = images[0]->GetData();
+    ASSERT_EQ(ref.size(), data.size());
+    for (size_t i = 0; i < ref.size(); ++i) {
+        EXPECT_LE(std::abs((int)ref[i] - (int)data[i]), 2);
+    }
+}
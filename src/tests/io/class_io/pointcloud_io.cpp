@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/class_io/async_writer.h"
 #include "cupoch/io/class_io/pointcloud_io.h"
+#include "cupoch/io/file_format/ascii_records.h"
+#include "cupoch/io/file_format/packed_records.h"
 #include "tests/test_utility/unit_test.h"
 #include <thrust/unique.h>
 
@@ -9,4 +17,233 @@ using namespace cupoch::io;
 using namespace unit_test;
 
 TEST(PointCloud, CreatePointCloudFromFile) {
-}
\ No newline at end of file
+}
+TEST(PointCloud, ReadPackedBinaryFiles) {
+    size_t size = 100;
+    thrust::host_vector<Vector3f> points(size);
+    thrust::host_vector<Vector3f> normals(size);
+    thrust::host_vector<Vector3f> colors(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    Rand(normals, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 1);
+    Rand(colors, Zero3f, Vector3f(1.0, 1.0, 1.0), 2);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetNormals(normals);
+    pc.SetColors(colors);
+
+    // Binary PLY and binary and binary_compressed PCD take the mapped path.
+    const std::string ply_file = "test_packed_binary.ply";
+    const std::string pcd_file = "test_packed_binary.pcd";
+    for (int i = 0; i < 3; ++i) {
+        const std::string &filename = (i == 0) ? ply_file : pcd_file;
+        if (i == 0) {
+            EXPECT_TRUE(WritePointCloudToPLY(filename, pc, false));
+        } else {
+            EXPECT_TRUE(WritePointCloudToPCD(filename, pc, false, i == 2));
+        }
+        geometry::PointCloud output;
+        EXPECT_TRUE(ReadPointCloud(filename, output));
+        ExpectEQ(output.GetPoints(), points);
+        ExpectEQ(output.GetNormals(), normals);
+        ExpectEQ(output.GetColors(), colors, 1.0 / 255.0);
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(PointCloud, ReadAsciiFiles) {
+    size_t size = 100;
+    thrust::host_vector<Vector3f> points(size);
+    thrust::host_vector<Vector3f> normals(size);
+    thrust::host_vector<Vector3f> colors(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    Rand(normals, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 1);
+    Rand(colors, Zero3f, Vector3f(1.0, 1.0, 1.0), 2);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetNormals(normals);
+    pc.SetColors(colors);
+
+    for (const std::string ext :
+         {"ply", "pcd", "xyz", "xyzn", "xyzrgb", "pts"}) {
+        const std::string filename = "test_read_ascii." + ext;
+        EXPECT_TRUE(WritePointCloud(filename, pc, true));
+        geometry::PointCloud output;
+        EXPECT_TRUE(ReadPointCloud(filename, output));
+        ExpectEQ(output.GetPoints(), points, 1.0e-5);
+        if (ext == "ply" || ext == "pcd" || ext == "xyzn") {
+            ExpectEQ(output.GetNormals(), normals, 1.0e-5);
+        }
+        if (ext == "ply" || ext == "pcd" || ext == "pts") {
+            ExpectEQ(output.GetColors(), colors, 1.0 / 255.0);
+        } else if (ext == "xyzrgb") {
+            ExpectEQ(output.GetColors(), colors, 1.0e-5);
+        }
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(PointCloud, ReadAsciiRecords) {
+    // Large enough to be split into several chunks.
+    const int n_rows = 200000;
+    std::string data = "# x y z\n";
+    for (int i = 0; i < n_rows; ++i) {
+        data += std::to_string(i) + " -" + std::to_string(i) + ".5\t1e-2\r\n";
+        if (i % 1000 == 0) data += "\n";
+    }
+    AsciiRecordLayout layout;
+    for (int i = 0; i < 3; ++i) layout.fields_[i].column_ = i;
+    HostPointCloud host_pc;
+    EXPECT_TRUE(ReadAsciiRecords(data.data(), data.size(), n_rows, layout,
+                                 host_pc, 4));
+    EXPECT_EQ(host_pc.points_.size(), n_rows);
+    EXPECT_TRUE(host_pc.normals_.empty());
+    for (int i = 0; i < n_rows; i += 997) {
+        ExpectEQ(host_pc.points_[i], Vector3f(i, -i - 0.5f, 0.01f));
+    }
+    EXPECT_TRUE(ReadAsciiRecords(data.data(), data.size(), 10, layout,
+                                 host_pc, 4));
+    EXPECT_EQ(host_pc.points_.size(), 10);
+    // A missing column.
+    layout.fields_[PackedRecordLayout::NormalX].column_ = 3;
+    layout.fields_[PackedRecordLayout::NormalY].column_ = 4;
+    layout.fields_[PackedRecordLayout::NormalZ].column_ = 5;
+    EXPECT_FALSE(ReadAsciiRecords(data.data(), data.size(), n_rows, layout,
+                                  host_pc, 4));
+}
+
+TEST(PointCloud, ReadLASFile) {
+    // LAS 1.2, point format 2: the points (i, 2 i, -i) cm from the offset,
+    // intensity i, class i % 10 and color i * 256.
+    const int n_points = 10;
+    const int record_length = 26;
+    std::vector<char> data(227 + n_points * record_length, 0);
+    auto put = [&data](size_t offset, auto value) {
+        memcpy(data.data() + offset, &value, sizeof(value));
+    };
+    memcpy(data.data(), "LASF", 4);
+    data[24] = 1;
+    data[25] = 2;
+    put(94, (uint16_t)227);
+    put(96, (uint32_t)227);
+    data[104] = 2;
+    put(105, (uint16_t)record_length);
+    put(107, (uint32_t)n_points);
+    for (int i = 0; i < 3; ++i) {
+        put(131 + 8 * i, 0.01);
+        put(155 + 8 * i, 100.0 * (i + 1));
+    }
+    for (int i = 0; i < n_points; ++i) {
+        const size_t record = 227 + i * record_length;
+        put(record, (int32_t)i);
+        put(record + 4, (int32_t)(2 * i));
+        put(record + 8, (int32_t)-i);
+        put(record + 12, (uint16_t)i);
+        data[record + 15] = (char)(0x20 | (i % 10));
+        for (int c = 0; c < 3; ++c) {
+            put(record + 20 + 2 * c, (uint16_t)(i * 256));
+        }
+    }
+    const std::string filename = "test_read.las";
+    FILE *file = fopen(filename.c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+
+    geometry::PointCloud pc;
+    EXPECT_TRUE(ReadPointCloud(filename, pc));
+    EXPECT_EQ(pc.points_.size(), n_points);
+    thrust::host_vector<Vector3f> points = pc.GetPoints();
+    thrust::host_vector<Vector3f> colors = pc.GetColors();
+    thrust::host_vector<float> intensity = pc.GetAttribute("intensity");
+    thrust::host_vector<float> classification =
+            pc.GetAttribute("classification");
+    for (int i = 0; i < n_points; ++i) {
+        ExpectEQ(points[i], Vector3f(100.0 + 0.01 * i, 200.0 + 0.02 * i,
+                                     300.0 - 0.01 * i));
+        ExpectEQ(colors[i], Vector3f::Constant(i * 256 / 65535.0));
+        EXPECT_EQ(intensity[i], i);
+        EXPECT_EQ(classification[i], i % 10);
+    }
+
+    PointCloudStreamReader reader(4);
+    EXPECT_TRUE(reader.Open(filename));
+    EXPECT_EQ(reader.GetNumPoints(), n_points);
+    geometry::PointCloud chunk;
+    size_t n_chunks = 0;
+    while (reader.ReadChunk(chunk)) {
+        thrust::host_vector<float> chunk_intensity =
+                chunk.GetAttribute("intensity");
+        EXPECT_EQ(chunk_intensity[0], 4 * n_chunks);
+        ++n_chunks;
+    }
+    EXPECT_EQ(n_chunks, 3);
+    EXPECT_EQ(reader.GetNumReadPoints(), n_points);
+    std::remove(filename.c_str());
+}
+
+TEST(PointCloud, DecompressLZF) {
+    // Literal run "ab", then a back reference of 4 bytes at distance 2 that
+    // overlaps its own output.
+    const char compressed[] = {0x01, 'a', 'b', 0x40, 0x01};
+    utility::device_vector<char> output;
+    EXPECT_TRUE(DecompressLZF(compressed, sizeof(compressed), 6, output));
+    thrust::host_vector<char> h_output = output;
+    EXPECT_EQ(std::string(h_output.begin(), h_output.end()), "ababab");
+    EXPECT_FALSE(DecompressLZF(compressed, sizeof(compressed), 7, output));
+    const char corrupted[] = {0x01, 'a', 'b', 0x40, 0x05};
+    EXPECT_FALSE(DecompressLZF(corrupted, sizeof(corrupted), 6, output));
+}
+
+TEST(PointCloud, ReadWriteCBF) {
+    size_t size = 1000;
+    thrust::host_vector<Vector3f> points(size);
+    thrust::host_vector<Vector3f> colors(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    // Constant colors so that the LZF compression kicks in.
+    for (auto &color : colors) color = Vector3f(0.5, 0.25, 1.0);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetColors(colors);
+
+    const std::string filename = "test_read_write.cbf";
+    for (bool compressed : {false, true}) {
+        EXPECT_TRUE(WritePointCloud(filename, pc, false, compressed));
+        geometry::PointCloud output;
+        EXPECT_TRUE(ReadPointCloud(filename, output));
+        ExpectEQ(output.GetPoints(), points);
+        ExpectEQ(output.GetColors(), colors);
+        EXPECT_FALSE(output.HasNormals());
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(PointCloud, AsyncWriter) {
+    size_t size = 1000;
+    thrust::host_vector<Vector3f> points(size);
+    thrust::host_vector<Vector3f> normals(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    Rand(normals, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 1);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetNormals(normals);
+
+    AsyncWriter writer(2);
+    const std::string ply_file = "test_async_writer.ply";
+    const std::string pcd_file = "test_async_writer.pcd";
+    auto ply_result = writer.WritePointCloud(ply_file, pc);
+    auto pcd_result = writer.WritePointCloud(pcd_file, pc, false, true);
+    // The files hold the point cloud as it was at the time of the calls.
+    pc.Translate(Vector3f(1.0, 2.0, 3.0));
+    EXPECT_TRUE(ply_result.get());
+    EXPECT_TRUE(pcd_result.get());
+    writer.Wait();
+    EXPECT_EQ(writer.GetNumPending(), 0);
+    for (const auto &filename : {ply_file, pcd_file}) {
+        geometry::PointCloud output;
+        EXPECT_TRUE(ReadPointCloud(filename, output));
+        ExpectEQ(output.GetPoints(), points);
+        ExpectEQ(output.GetNormals(), normals);
+        std::remove(filename.c_str());
+    }
+    EXPECT_FALSE(
+            writer.WritePointCloud(ply_file, geometry::PointCloud()).get());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "cupoch/geometry/image.h"
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/io/ros/image_msg.h"
+#include "cupoch/io/ros/pointcloud2_msg.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace cupoch::io;
+using namespace unit_test;
+
+TEST(RosMsg, PointCloud2RoundTrip) {
+    size_t size = 100;
+    thrust::host_vector<Vector3f> points(size);
+    thrust::host_vector<Vector3f> normals(size);
+    thrust::host_vector<Vector3f> colors(size);
+    Rand(points, Vector3f(-10.0, -10.0, -10.0), Vector3f(10.0, 10.0, 10.0), 0);
+    Rand(normals, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 1);
+    Rand(colors, Zero3f, Vector3f(1.0, 1.0, 1.0), 2);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.SetNormals(normals);
+    pc.SetColors(colors);
+
+    const PointCloud2MsgInfo info =
+            PointCloud2MsgInfo::Default(size, true, true);
+    EXPECT_EQ(info.GetSize(), size * 32);
+    std::vector<uint8_t> data(info.GetSize());
+    EXPECT_TRUE(CreateToPointCloud2Msg(data.data(), info, pc));
+    float x;
+    memcpy(&x, data.data() + 32, sizeof(x));
+    EXPECT_EQ(x, points[1](0));
+
+    auto output = CreateFromPointCloud2Msg(data.data(), info);
+    ExpectEQ(output->GetPoints(), points);
+    ExpectEQ(output->GetNormals(), normals);
+    ExpectEQ(output->GetColors(), colors, 1.0 / 255.0);
+
+    // 8 bit r, g, b fields in padded rows of 10 points.
+    PointCloud2MsgInfo padded;
+    padded.width_ = 10;
+    padded.height_ = 10;
+    padded.fields_ = {PointField("x", 0, PointField::FLOAT32),
+                      PointField("y", 4, PointField::FLOAT32),
+                      PointField("z", 8, PointField::FLOAT32),
+                      PointField("r", 12, PointField::UINT8),
+                      PointField("g", 13, PointField::UINT8),
+                      PointField("b", 14, PointField::UINT8)};
+    padded.point_step_ = 16;
+    padded.row_step_ = 10 * 16 + 8;
+    data.assign(padded.GetSize(), 0);
+    EXPECT_TRUE(CreateToPointCloud2Msg(data.data(), padded, pc));
+    output = CreateFromPointCloud2Msg(data.data(), padded);
+    ExpectEQ(output->GetPoints(), points);
+    EXPECT_FALSE(output->HasNormals());
+    ExpectEQ(output->GetColors(), colors, 1.0 / 255.0);
+}
+
+TEST(RosMsg, ImageRoundTrip) {
+    const int width = 5;
+    const int height = 4;
+    // bgr8 rows padded to 16 bytes.
+    ImageMsgInfo info(width, height, "bgr8", false, 16);
+    std::vector<uint8_t> data(info.GetSize(), 0);
+    for (int v = 0; v < height; ++v) {
+        for (int u = 0; u < width; ++u) {
+            uint8_t *pixel = data.data() + v * info.step_ + u * 3;
+            pixel[0] = u;
+            pixel[1] = v;
+            pixel[2] = u + v;
+        }
+    }
+    auto image = CreateFromImageMsg(data.data(), info);
+    EXPECT_EQ(image->width_, width);
+    EXPECT_EQ(image->height_, height);
+    EXPECT_EQ(image->num_of_channels_, 3);
+    thrust::host_vector<uint8_t> pixels = image->GetData();
+    EXPECT_EQ(pixels[(2 * width + 3) * 3], 5);
+    EXPECT_EQ(pixels[(2 * width + 3) * 3 + 2], 3);
+
+    std::vector<uint8_t> output(info.GetSize(), 0);
+    EXPECT_TRUE(CreateToImageMsg(output.data(), info, *image));
+    for (int v = 0; v < height; ++v) {
+        EXPECT_EQ(memcmp(output.data() + v * info.step_,
+                         data.data() + v * info.step_, width * 3),
+                  0);
+    }
+    EXPECT_FALSE(CreateToImageMsg(output.data(),
+                                  ImageMsgInfo(width, height, "mono8"),
+                                  *image));
+}
@@ -0,0 +1,91 @@
+#include "cupoch/localization/monte_carlo_localization.h"
+
+#include <thrust/host_vector.h>
+
+#include <cmath>
+#include <limits>
+
+#include "cupoch/geometry/distancetransform.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+// A room of the voxel indices [4, 58] x [4, 40] at z = 32, whose walls are
+// at x = -2.75, 2.65 and y = -2.75, 0.85 in the grid of 0.1 voxels.
+std::shared_ptr<geometry::DistanceTransform> CreateRoom() {
+    thrust::host_vector<Vector3i> h_sites;
+    for (int i = 4; i <= 58; ++i) {
+        h_sites.push_back(Vector3i(i, 4, 32));
+        h_sites.push_back(Vector3i(i, 40, 32));
+    }
+    for (int j = 5; j < 40; ++j) {
+        h_sites.push_back(Vector3i(4, j, 32));
+        h_sites.push_back(Vector3i(58, j, 32));
+    }
+    auto dt = std::make_shared<geometry::DistanceTransform>(0.1, 64);
+    dt->ComputeEDT(utility::device_vector<Vector3i>(h_sites));
+    return dt;
+}
+
+// Beam ends in the robot frame of a scan of the room from the pose.
+thrust::host_vector<Vector3f> ScanRoom(const Vector3f &pose, int n_beams) {
+    const float walls[4] = {-2.75, 2.65, -2.75, 0.85};
+    thrust::host_vector<Vector3f> scan;
+    for (int k = 0; k < n_beams; ++k) {
+        const float a = 2.0 * M_PI * k / n_beams;
+        const Vector2f dir(std::cos(pose[2] + a), std::sin(pose[2] + a));
+        float t = std::numeric_limits<float>::max();
+        for (int w = 0; w < 4; ++w) {
+            const int axis = w / 2;
+            if (std::abs(dir[axis]) < 1.0e-6) continue;
+            const float s = (walls[w] - pose[axis]) / dir[axis];
+            if (s > 0.0) t = std::min(t, s);
+        }
+        scan.push_back(Vector3f(t * std::cos(a), t * std::sin(a), 0.05));
+    }
+    return scan;
+}
+
+}  // namespace
+
+TEST(MonteCarloLocalization, Predict) {
+    localization::MonteCarloLocalizationOption option;
+    option.motion_noise_.setZero();
+    option.min_particles_ = 10;
+    localization::MonteCarloLocalization mcl(CreateRoom(), option);
+    mcl.Initialize(Vector3f(0.5, 0.0, M_PI / 2), Vector3f::Zero(), 100);
+    mcl.Predict(Vector3f(1.0, 0.0, M_PI / 4));
+    thrust::host_vector<Vector3f> particles = mcl.particles_;
+    for (const auto &p : particles) {
+        ExpectEQ(Vector3f(0.5, 1.0, 3.0 * M_PI / 4), p, 1.0e-4);
+    }
+
+    // The bins of the identical particles ask for the fewest particles.
+    mcl.Resample();
+    EXPECT_EQ(10, mcl.GetNumParticles());
+    EXPECT_NEAR(10.0, mcl.GetEffectiveSampleSize(), 1.0e-3);
+}
+
+TEST(MonteCarloLocalization, UpdateAndResample) {
+    const Vector3f pose(0.3, -0.2, 0.2);
+    const utility::device_vector<Vector3f> scan(ScanRoom(pose, 36));
+    localization::MonteCarloLocalization mcl(CreateRoom());
+    mcl.Initialize(Vector3f::Zero(), Vector3f(0.3, 0.3, 0.3), 4000);
+    for (int i = 0; i < 5; ++i) {
+        mcl.Update(scan);
+        thrust::host_vector<float> weights = mcl.weights_;
+        float total = 0.0;
+        for (float w : weights) total += w;
+        EXPECT_NEAR(1.0, total, 1.0e-3);
+        EXPECT_GT(mcl.GetEffectiveSampleSize(), 0.0);
+        mcl.Resample();
+        EXPECT_GE(mcl.GetNumParticles(), mcl.GetOption().min_particles_);
+        EXPECT_LE(mcl.GetNumParticles(), mcl.GetOption().max_particles_);
+    }
+    ExpectEQ(pose, mcl.GetMeanPose(), 0.1);
+}
@@ -0,0 +1,75 @@
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/integration/uniform_tsdfvolume.h"
+#include "cupoch/odometry/odometry.h"
+#include "tests/odometry/odometry_tools.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace unit_test;
+using namespace odometry_tools;
+
+namespace {
+
+geometry::Image MakeShortDepth() {
+    geometry::Image depth;
+    depth.Prepare(4, 4, 1, 2);
+    return depth;
+}
+
+}  // namespace
+
+TEST(DepthICPOdometry, ComputeDepthICPOdometry) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    auto source = ReadRGBDFrame(1);
+    auto target = ReadRGBDFrame(0);
+
+    auto self = odometry::ComputeDepthICPOdometry(target->depth_,
+                                                  target->depth_, intrinsic);
+    EXPECT_TRUE(std::get<0>(self));
+    EXPECT_TRUE(std::get<1>(self).isApprox(Eigen::Matrix4f::Identity(),
+                                           1.0e-4));
+
+    auto ref = odometry::ComputeRGBDOdometry(*source, *target, intrinsic);
+    auto res = odometry::ComputeDepthICPOdometry(source->depth_,
+                                                 target->depth_, intrinsic);
+    EXPECT_TRUE(std::get<0>(res));
+    const Eigen::Matrix4f diff =
+            std::get<1>(res).inverse() * std::get<1>(ref);
+    EXPECT_LT(diff.block<3, 1>(0, 3).norm(), 0.02);
+    EXPECT_LT(Eigen::AngleAxisf(diff.block<3, 3>(0, 0)).angle(), 0.02);
+}
+
+TEST(DepthICPOdometry, FrameToModel) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    auto source = ReadRGBDFrame(1);
+    auto target = ReadRGBDFrame(0);
+    integration::UniformTSDFVolume volume(
+            3.0, 256, 0.04, integration::TSDFVolumeColorType::NoColor,
+            Eigen::Vector3f(-1.5, -1.5, 0.0));
+    volume.Integrate(*target, intrinsic, Eigen::Matrix4f::Identity());
+    std::shared_ptr<geometry::Image> vertex_map, normal_map, color_map;
+    std::tie(vertex_map, normal_map, color_map) =
+            volume.Raycast(intrinsic, Eigen::Matrix4f::Identity());
+
+    auto ref = odometry::ComputeDepthICPOdometry(source->depth_,
+                                                 target->depth_, intrinsic);
+    auto res = odometry::ComputeDepthICPOdometry(
+            source->depth_, *vertex_map, *normal_map, intrinsic);
+    EXPECT_TRUE(std::get<0>(res));
+    const Eigen::Matrix4f diff =
+            std::get<1>(res).inverse() * std::get<1>(ref);
+    EXPECT_LT(diff.block<3, 1>(0, 3).norm(), 0.02);
+    EXPECT_LT(Eigen::AngleAxisf(diff.block<3, 3>(0, 0)).angle(), 0.02);
+
+    // The camera of the source goes back into the volume at
+    // odo^-1 * extrinsic of the target.
+    volume.Integrate(*source, intrinsic, std::get<1>(res).inverse());
+}
+
+TEST(DepthICPOdometry, RejectsNonFloatDepth) {
+    auto res = odometry::ComputeDepthICPOdometry(MakeShortDepth(),
+                                                 MakeShortDepth());
+    EXPECT_FALSE(std::get<0>(res));
+}
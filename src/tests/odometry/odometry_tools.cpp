@@ -2,6 +2,11 @@
 
 #include <thrust/host_vector.h>
 
+#include <iomanip>
+#include <sstream>
+
+#include "cupoch/io/class_io/image_io.h"
+
 using namespace cupoch;
 using namespace std;
 using namespace unit_test;
@@ -110,4 +115,21 @@ shared_ptr<geometry::Image> odometry_tools::DepthBuffer(const int& width,
     image->SetData(data);
 
     return image;
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------
+// Read frame i of the RGBD sequence of the test data.
+// ----------------------------------------------------------------------------
+shared_ptr<geometry::RGBDImage> odometry_tools::ReadRGBDFrame(const int& i) {
+    geometry::Image color;
+    ostringstream color_path;
+    color_path << TEST_DATA_DIR << "/rgbd/color/" << setfill('0') << setw(5)
+               << i << ".jpg";
+    io::ReadImage(color_path.str(), color);
+    geometry::Image depth;
+    ostringstream depth_path;
+    depth_path << TEST_DATA_DIR << "/rgbd/depth/" << setfill('0') << setw(5)
+               << i << ".png";
+    io::ReadImage(depth_path.str(), depth);
+    return geometry::RGBDImage::CreateFromColorAndDepth(color, depth);
+}
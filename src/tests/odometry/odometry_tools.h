@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cupoch/geometry/image.h"
+#include "cupoch/geometry/rgbdimage.h"
 #include "tests/test_utility/unit_test.h"
 
 namespace odometry_tools {
@@ -32,4 +33,7 @@ std::shared_ptr<cupoch::geometry::Image> DepthBuffer(const int& width,
                                                      const float& vmin,
                                                      const float& vmax,
                                                      const int& seed);
+
+// Read frame i of the RGBD sequence of the test data.
+std::shared_ptr<cupoch::geometry::RGBDImage> ReadRGBDFrame(const int& i);
 }  // namespace odometry_tools
\ No newline at end of file
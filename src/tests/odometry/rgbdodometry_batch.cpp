@@ -0,0 +1,56 @@
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/odometry/odometry.h"
+#include "tests/odometry/odometry_tools.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace unit_test;
+using namespace odometry_tools;
+
+TEST(RGBDOdometryBatch, MatchesSinglePairs) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    std::vector<std::shared_ptr<geometry::RGBDImage>> sources, targets;
+    for (int i = 0; i < 2; ++i) {
+        sources.push_back(ReadRGBDFrame(i + 1));
+        targets.push_back(ReadRGBDFrame(i));
+    }
+    const std::vector<camera::PinholeCameraIntrinsic> intrinsics(2, intrinsic);
+    auto res = odometry::ComputeRGBDOdometryBatch(sources, targets,
+                                                  intrinsics);
+    ASSERT_EQ(res.size(), 2);
+    for (int i = 0; i < 2; ++i) {
+        auto ref = odometry::ComputeRGBDOdometry(*sources[i], *targets[i],
+                                                 intrinsic);
+        EXPECT_EQ(std::get<0>(res[i]), std::get<0>(ref));
+        EXPECT_TRUE(std::get<1>(res[i]).isApprox(std::get<1>(ref), 1.0e-3));
+        EXPECT_TRUE(std::get<2>(res[i]).isApprox(std::get<2>(ref), 1.0e-2));
+    }
+
+    auto mismatched = odometry::ComputeRGBDOdometryBatch(
+            sources, targets,
+            std::vector<camera::PinholeCameraIntrinsic>(1, intrinsic));
+    ASSERT_EQ(mismatched.size(), 2);
+    EXPECT_FALSE(std::get<0>(mismatched[0]));
+}
+
+TEST(RGBDOdometryBatch, MultiCameraOfIdenticalCameras) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    auto source = ReadRGBDFrame(1);
+    auto target = ReadRGBDFrame(0);
+    auto ref = odometry::ComputeRGBDOdometry(*source, *target, intrinsic);
+
+    // Two cameras at the same pose double the normal equations, which
+    // leaves the motion unchanged.
+    const std::vector<std::shared_ptr<geometry::RGBDImage>> sources(2, source);
+    const std::vector<std::shared_ptr<geometry::RGBDImage>> targets(2, target);
+    const std::vector<camera::PinholeCameraIntrinsic> intrinsics(2, intrinsic);
+    const std::vector<Eigen::Matrix4f_u> camera_to_rig(
+            2, Eigen::Matrix4f_u::Identity());
+    auto res = odometry::ComputeMultiCameraRGBDOdometry(
+            sources, targets, intrinsics, camera_to_rig);
+    EXPECT_EQ(std::get<0>(res), std::get<0>(ref));
+    EXPECT_TRUE(std::get<1>(res).isApprox(std::get<1>(ref), 1.0e-3));
+    EXPECT_TRUE(std::get<2>(res).isApprox(2.0 * std::get<2>(ref), 1.0e-2));
+}
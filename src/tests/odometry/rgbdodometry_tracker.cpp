@@ -0,0 +1,31 @@
+#include "cupoch/geometry/rgbdimage.h"
+#include "cupoch/odometry/odometry.h"
+#include "tests/odometry/odometry_tools.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace unit_test;
+using namespace odometry_tools;
+
+TEST(RGBDOdometryTracker, Track) {
+    camera::PinholeCameraIntrinsic intrinsic(
+            camera::PinholeCameraIntrinsicParameters::PrimeSenseDefault);
+    odometry::RGBDOdometryTracker tracker(intrinsic);
+    auto first = ReadRGBDFrame(0);
+    EXPECT_FALSE(std::get<0>(tracker.Track(*first)));
+    EXPECT_TRUE(tracker.HasPreviousFrame());
+
+    std::shared_ptr<geometry::RGBDImage> previous = first;
+    for (int i = 1; i < 3; ++i) {
+        auto frame = ReadRGBDFrame(i);
+        auto ref = odometry::ComputeRGBDOdometry(*frame, *previous, intrinsic);
+        auto res = tracker.Track(*frame);
+        EXPECT_EQ(std::get<0>(res), std::get<0>(ref));
+        EXPECT_TRUE(std::get<1>(res).isApprox(std::get<1>(ref), 1.0e-3));
+        EXPECT_TRUE(std::get<2>(res).isApprox(std::get<2>(ref), 1.0e-2));
+        previous = frame;
+    }
+
+    tracker.Reset();
+    EXPECT_FALSE(tracker.HasPreviousFrame());
+}
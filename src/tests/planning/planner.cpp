@@ -1,5 +1,6 @@
 #include "cupoch/planning/planner.h"
 #include "cupoch/geometry/boundingvolume.h"
+#include "cupoch/geometry/occupancygrid.h"
 #include "tests/test_utility/unit_test.h"
 
 using namespace cupoch;
@@ -12,3 +13,43 @@ TEST(SimplePlanner, FindPath) {
     planning::SimplePlanner planner(*graph);
     planner.FindPath(Eigen::Vector3f(-1.0, -0.5, -0.2), Eigen::Vector3f(0.8, 0.9, 0.7));
 }
+
+TEST(GridPlanner, FindPath) {
+    geometry::OccupancyGrid grid(0.1, 16);
+    // Free space with a wall at x = 8 leaving an opening at y = 14.
+    thrust::host_vector<Eigen::Vector3i> h_free;
+    thrust::host_vector<Eigen::Vector3i> h_wall;
+    for (int x = 0; x < 16; ++x) {
+        for (int y = 0; y < 16; ++y) {
+            for (int z = 0; z < 16; ++z) {
+                if (x == 8 && y < 13) {
+                    h_wall.push_back(Eigen::Vector3i(x, y, z));
+                } else {
+                    h_free.push_back(Eigen::Vector3i(x, y, z));
+                }
+            }
+        }
+    }
+    grid.AddVoxels(utility::device_vector<Eigen::Vector3i>(h_free), false);
+    grid.AddVoxels(utility::device_vector<Eigen::Vector3i>(h_wall), true);
+    planning::GridPlanner planner(0.05);
+    planner.UpdateMap(grid);
+    EXPECT_TRUE(planner.IsBlocked(Eigen::Vector3f(0.05, 0.05, 0.05)));
+    const Eigen::Vector3f start(-0.35, -0.35, 0.05);
+    const Eigen::Vector3f goal(0.35, -0.35, 0.05);
+    auto path = planner.FindPath(start, goal);
+    ASSERT_GT(path->size(), 2);
+    ExpectEQ(path->front(), start);
+    ExpectEQ(path->back(), goal);
+    for (const auto& p : *path) {
+        EXPECT_FALSE(planner.IsBlocked(p));
+    }
+    // The detour goes through the opening.
+    bool through_opening = false;
+    for (const auto& p : *path) {
+        if (p[1] > 0.45) through_opening = true;
+    }
+    EXPECT_TRUE(through_opening);
+    auto replan = planner.FindPath(Eigen::Vector3f(-0.25, -0.35, 0.05), goal);
+    EXPECT_LE(replan->size(), path->size());
+}
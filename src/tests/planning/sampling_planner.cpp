@@ -0,0 +1,83 @@
+#include "cupoch/planning/sampling_planner.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace unit_test;
+
+namespace {
+
+std::shared_ptr<planning::ValidityChecker> MakeSphereChecker() {
+    auto checker = std::make_shared<planning::ValidityChecker>(0.05, 0.02);
+    checker->AddPrimitive(collision::Sphere(0.3, Eigen::Vector3f::Zero()));
+    return checker;
+}
+
+void ExpectPathAroundSphere(const planning::Path& path,
+                            const Eigen::Vector3f& start,
+                            const Eigen::Vector3f& goal) {
+    ASSERT_GT(path.size(), 2);
+    ExpectEQ(path.front(), start);
+    ExpectEQ(path.back(), goal);
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        for (int k = 0; k <= 10; ++k) {
+            const Eigen::Vector3f p = path[i] + (path[i + 1] - path[i]) * (k / 10.0);
+            EXPECT_GT(p.norm(), 0.3 + 0.05 - 0.01);
+        }
+    }
+}
+
+}  // namespace
+
+TEST(ValidityChecker, CheckSegments) {
+    auto checker = MakeSphereChecker();
+    Eigen::Matrix4f box_pose = Eigen::Matrix4f::Identity();
+    box_pose.block<3, 1>(0, 3) = Eigen::Vector3f(1.0, 0.0, 0.0);
+    checker->AddPrimitive(collision::Box(Eigen::Vector3f(0.2, 0.2, 0.2), box_pose));
+    thrust::host_vector<Eigen::Vector3f> h_points;
+    h_points.push_back(Eigen::Vector3f(0.0, 0.0, 0.2));
+    h_points.push_back(Eigen::Vector3f(0.0, 0.0, 0.4));
+    h_points.push_back(Eigen::Vector3f(1.0, 0.0, 0.12));
+    h_points.push_back(Eigen::Vector3f(1.0, 0.0, 0.2));
+    utility::device_vector<Eigen::Vector3f> points = h_points;
+    utility::device_vector<uint8_t> valid;
+    checker->CheckPoints(points, valid);
+    thrust::host_vector<uint8_t> h_valid = valid;
+    EXPECT_EQ(h_valid[0], 0);
+    EXPECT_EQ(h_valid[1], 1);
+    EXPECT_EQ(h_valid[2], 0);
+    EXPECT_EQ(h_valid[3], 1);
+
+    thrust::host_vector<Eigen::Vector3f> h_starts;
+    thrust::host_vector<Eigen::Vector3f> h_ends;
+    h_starts.push_back(Eigen::Vector3f(-1.0, 0.0, 0.0));
+    h_ends.push_back(Eigen::Vector3f(-0.5, 0.0, 0.0));
+    h_starts.push_back(Eigen::Vector3f(-1.0, 0.0, 0.0));
+    h_ends.push_back(Eigen::Vector3f(0.5, 0.0, 0.0));
+    checker->CheckSegments(utility::device_vector<Eigen::Vector3f>(h_starts),
+                           utility::device_vector<Eigen::Vector3f>(h_ends), valid);
+    h_valid = valid;
+    EXPECT_EQ(h_valid[0], 1);
+    EXPECT_EQ(h_valid[1], 0);
+}
+
+TEST(PRMStarPlanner, FindPath) {
+    planning::PRMStarPlanner planner(Eigen::Vector3f(-1.0, -1.0, -1.0),
+                                     Eigen::Vector3f(1.0, 1.0, 1.0),
+                                     MakeSphereChecker(), 2000);
+    planner.Build();
+    EXPECT_GT(planner.graph_.points_.size(), 1500);
+    const Eigen::Vector3f start(-0.8, 0.0, 0.0);
+    const Eigen::Vector3f goal(0.8, 0.0, 0.0);
+    auto path = planner.FindPath(start, goal);
+    ExpectPathAroundSphere(*path, start, goal);
+}
+
+TEST(RRTConnectPlanner, FindPath) {
+    planning::RRTConnectPlanner planner(Eigen::Vector3f(-1.0, -1.0, -1.0),
+                                        Eigen::Vector3f(1.0, 1.0, 1.0),
+                                        MakeSphereChecker(), 0.2);
+    const Eigen::Vector3f start(-0.8, 0.0, 0.0);
+    const Eigen::Vector3f goal(0.8, 0.0, 0.0);
+    auto path = planner.FindPath(start, goal);
+    ExpectPathAroundSphere(*path, start, goal);
+}
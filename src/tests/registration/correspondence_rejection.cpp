@@ -0,0 +1,33 @@
+#include "cupoch/registration/correspondence_rejection.h"
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(CorrespondenceRejection, OneToOneAndTrim) {
+    thrust::host_vector<Vector3f> points(6, Vector3f::Zero());
+    geometry::PointCloud source;
+    source.SetPoints(points);
+    geometry::PointCloud target;
+    target.SetPoints(thrust::host_vector<Vector3f>(3, Vector3f::Zero()));
+    // Sources 0 and 1 share target 0, source 5 has no neighbour.
+    const int h_indices[] = {0, 0, 1, 2, 1, -1};
+    const float h_dists[] = {0.2, 0.1, 0.3, 0.4, 0.5, INFINITY};
+    thrust::host_vector<int> indices_h(h_indices, h_indices + 6);
+    thrust::host_vector<float> dists_h(h_dists, h_dists + 6);
+    utility::device_vector<int> indices = indices_h;
+    utility::device_vector<float> dists = dists_h;
+    utility::Workspace workspace;
+    registration::CorrespondenceRejection rejection(0.0, 0.0, true, 0.5);
+    registration::RejectCorrespondences(0, workspace, source, target,
+                                        rejection, indices, dists);
+    indices_h = indices;
+    // Sources 1, 2 and 3 survive the one-to-one test, and the closest half
+    // of them the trimming.
+    const int expected[] = {-1, 0, 1, -1, -1, -1};
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(indices_h[i], expected[i]);
+}
@@ -0,0 +1,67 @@
+#include "cupoch/registration/feature.h"
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(Feature, ComputeFPFHFeatureBatch) {
+    std::vector<std::shared_ptr<geometry::PointCloud>> pcs;
+    for (int i = 0; i < 3; ++i) {
+        thrust::host_vector<Vector3f> points(100 + 50 * i);
+        Rand(points, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), i);
+        auto pc = std::make_shared<geometry::PointCloud>();
+        pc->SetPoints(points);
+        pc->EstimateNormals(geometry::KDTreeSearchParamKNN(10));
+        pcs.push_back(pc);
+    }
+    const geometry::KDTreeSearchParamKNN param(20);
+    auto batch = registration::ComputeFPFHFeatureBatch(pcs, param);
+    auto half_batch = registration::ComputeFPFHFeatureBatch(pcs, param, true);
+    EXPECT_EQ(batch->NumPointClouds(), pcs.size());
+    EXPECT_EQ(half_batch->half_data_.size(), batch->data_.size() * 33);
+    for (size_t i = 0; i < pcs.size(); ++i) {
+        auto ref = registration::ComputeFPFHFeature(*pcs[i], param);
+        thrust::host_vector<registration::Feature<33>::FeatureType> ref_data =
+                ref->data_;
+        thrust::host_vector<registration::Feature<33>::FeatureType> data =
+                batch->GetFeature(i)->data_;
+        thrust::host_vector<registration::Feature<33>::FeatureType> half_data =
+                half_batch->GetFeature(i)->data_;
+        ASSERT_EQ(ref_data.size(), data.size());
+        ASSERT_EQ(ref_data.size(), half_data.size());
+        for (size_t j = 0; j < data.size(); ++j) {
+            for (int k = 0; k < 33; ++k) {
+                EXPECT_NEAR(ref_data[j][k], data[j][k], 1.0e-4);
+                EXPECT_NEAR(ref_data[j][k], half_data[j][k], 0.2);
+            }
+        }
+    }
+}
+
+TEST(Feature, ComputeFPFHFeatureSubset) {
+    thrust::host_vector<Vector3f> points(200);
+    Rand(points, Vector3f(-1.0, -1.0, -1.0), Vector3f(1.0, 1.0, 1.0), 0);
+    geometry::PointCloud pc;
+    pc.SetPoints(points);
+    pc.EstimateNormals(geometry::KDTreeSearchParamKNN(10));
+    const geometry::KDTreeSearchParamKNN param(20);
+    thrust::host_vector<size_t> h_indices;
+    for (size_t i = 0; i < points.size(); i += 7) h_indices.push_back(i);
+    utility::device_vector<size_t> indices = h_indices;
+    auto ref = registration::ComputeFPFHFeature(pc, param);
+    auto sub = registration::ComputeFPFHFeature(pc, indices, param);
+    thrust::host_vector<registration::Feature<33>::FeatureType> ref_data =
+            ref->data_;
+    thrust::host_vector<registration::Feature<33>::FeatureType> sub_data =
+            sub->data_;
+    ASSERT_EQ(sub_data.size(), h_indices.size());
+    for (size_t j = 0; j < h_indices.size(); ++j) {
+        for (int k = 0; k < 33; ++k) {
+            EXPECT_NEAR(ref_data[h_indices[j]][k], sub_data[j][k], 1.0e-4);
+        }
+    }
+}
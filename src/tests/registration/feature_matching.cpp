@@ -0,0 +1,75 @@
+#include "cupoch/registration/feature_matching.h"
+
+#include <algorithm>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+typedef registration::Feature<33>::FeatureType FeatureType;
+
+thrust::host_vector<FeatureType> RandomFeatures(int n, int seed) {
+    thrust::host_vector<FeatureType> features(n);
+    srand(seed);
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < 33; ++d) features[i][d] = rand() % 1000 / 10.0f;
+    }
+    return features;
+}
+
+}  // namespace
+
+TEST(FeatureMatching, FeatureKNNSearch) {
+    const int knn = 3;
+    const auto h_query = RandomFeatures(100, 0);
+    const auto h_reference = RandomFeatures(300, 1);
+    registration::Feature<33> query;
+    query.data_ = h_query;
+    registration::Feature<33> reference;
+    reference.data_ = h_reference;
+    utility::device_vector<int> indices;
+    utility::device_vector<float> distance2;
+    registration::FeatureKNNSearch(query, reference, knn, indices, distance2);
+    thrust::host_vector<int> h_indices = indices;
+    thrust::host_vector<float> h_distance2 = distance2;
+    ASSERT_EQ(h_indices.size(), 100u * knn);
+    for (int i = 0; i < 100; ++i) {
+        vector<pair<float, int>> ref(300);
+        for (int j = 0; j < 300; ++j) {
+            ref[j] = make_pair((h_reference[j] - h_query[i]).squaredNorm(), j);
+        }
+        sort(ref.begin(), ref.end());
+        for (int k = 0; k < knn; ++k) {
+            EXPECT_EQ(h_indices[i * knn + k], ref[k].second);
+            EXPECT_NEAR(h_distance2[i * knn + k], ref[k].first,
+                        1.0e-3 * ref[k].first + 1.0e-2);
+        }
+    }
+}
+
+TEST(FeatureMatching, RatioTest) {
+    thrust::host_vector<FeatureType> h_source(2, FeatureType::Zero());
+    h_source[1][0] = 100.0;
+    // The first source feature has two target features at the same
+    // distance, the second one a single close target feature.
+    thrust::host_vector<FeatureType> h_target(3, FeatureType::Zero());
+    h_target[0][1] = 1.0;
+    h_target[1][2] = 1.0;
+    h_target[2][0] = 99.0;
+    registration::Feature<33> source;
+    source.data_ = h_source;
+    registration::Feature<33> target;
+    target.data_ = h_target;
+    thrust::host_vector<Vector2i> all =
+            registration::MatchFeatures(source, target, false);
+    EXPECT_EQ(all.size(), 2u);
+    thrust::host_vector<Vector2i> unambiguous =
+            registration::MatchFeatures(source, target, false, 0.8);
+    ASSERT_EQ(unambiguous.size(), 1u);
+    EXPECT_EQ(unambiguous[0], Vector2i(1, 2));
+}
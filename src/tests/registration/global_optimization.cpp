@@ -0,0 +1,56 @@
+#include "cupoch/registration/global_optimization.h"
+
+#include <Eigen/Geometry>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(GlobalOptimization, LevenbergMarquardt) {
+    // Poses on a circle, chained by exact odometry edges and closed by one
+    // consistent and one wrong loop closure.
+    const int n_nodes = 20;
+    std::vector<Matrix4f> ground_truth(n_nodes);
+    for (int i = 0; i < n_nodes; ++i) {
+        const float angle = 2.0 * M_PI * i / n_nodes;
+        ground_truth[i] = Matrix4f::Identity();
+        ground_truth[i].block<3, 3>(0, 0) =
+                AngleAxisf(angle, Vector3f::UnitZ()).matrix();
+        ground_truth[i].block<3, 1>(0, 3) =
+                Vector3f(std::cos(angle), std::sin(angle), 0.0);
+    }
+    registration::PoseGraph pose_graph;
+    for (int i = 0; i < n_nodes; ++i) {
+        // Drift the initial poses away from the ground truth.
+        Matrix4f drift = Matrix4f::Identity();
+        drift.block<3, 3>(0, 0) =
+                AngleAxisf(0.01 * i, Vector3f::UnitX()).matrix();
+        drift.block<3, 1>(0, 3) = Vector3f(0.0, 0.0, 0.02 * i);
+        pose_graph.nodes_.push_back(
+                registration::PoseGraphNode(drift * ground_truth[i]));
+    }
+    const Matrix6f information = Matrix6f::Identity() * 100.0;
+    for (int i = 1; i < n_nodes; ++i) {
+        pose_graph.edges_.push_back(registration::PoseGraphEdge(
+                i, i - 1, ground_truth[i - 1].inverse() * ground_truth[i],
+                information));
+    }
+    pose_graph.edges_.push_back(registration::PoseGraphEdge(
+            n_nodes - 1, 0, ground_truth[0].inverse() * ground_truth[n_nodes - 1],
+            information, true));
+    Matrix4f wrong = ground_truth[0].inverse() * ground_truth[n_nodes / 2];
+    wrong.block<3, 1>(0, 3) += Vector3f(0.0, 0.0, 1.0);
+    pose_graph.edges_.push_back(registration::PoseGraphEdge(
+            n_nodes / 2, 0, wrong, information, true));
+
+    registration::GlobalOptimization(pose_graph);
+    ASSERT_EQ(pose_graph.edges_.size(), n_nodes);
+    EXPECT_GT(pose_graph.edges_.back().confidence_, 0.25);
+    for (int i = 0; i < n_nodes; ++i) {
+        EXPECT_TRUE(Matrix4f(pose_graph.nodes_[i].pose_)
+                            .isApprox(ground_truth[i], 1.0e-3));
+    }
+}
@@ -0,0 +1,87 @@
+#include "cupoch/registration/global_registration.h"
+
+#include <Eigen/Geometry>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(GlobalRegistration, ComputeFeatureCorrespondences) {
+    const int size = 50;
+    thrust::host_vector<registration::Feature<33>::FeatureType> features(size);
+    for (int i = 0; i < size; ++i) {
+        features[i] = registration::Feature<33>::FeatureType::Zero();
+        features[i][i % 33] = 100.0 + i;
+    }
+    registration::Feature<33> source_feature;
+    source_feature.data_ = features;
+    // The target features are the source ones in reverse order.
+    thrust::host_vector<registration::Feature<33>::FeatureType> reversed(
+            features.rbegin(), features.rend());
+    registration::Feature<33> target_feature;
+    target_feature.data_ = reversed;
+
+    auto corres = registration::ComputeFeatureCorrespondences(source_feature,
+                                                              target_feature);
+    thrust::host_vector<Vector2i> h_corres = corres;
+    ASSERT_EQ(h_corres.size(), (size_t)size);
+    for (int i = 0; i < size; ++i) {
+        EXPECT_EQ(h_corres[i], Vector2i(i, size - 1 - i));
+    }
+}
+
+TEST(GlobalRegistration, RegistrationRANSACBasedOnCorrespondence) {
+    const int size = 200;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(10.0, 10.0, 10.0), 0);
+    geometry::PointCloud source;
+    source.SetPoints(points);
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.5, Vector3f(1.0, 2.0, 3.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(1.0, -2.0, 0.5);
+    geometry::PointCloud target = source;
+    target.Transform(ref_tf);
+
+    // 60% of the correspondences are true, the others are shuffled.
+    thrust::host_vector<Vector2i> h_corres(size);
+    for (int i = 0; i < size; ++i) {
+        h_corres[i] = Vector2i(i, (i % 5 < 3) ? i : (i * 7 + 3) % size);
+    }
+    registration::CorrespondenceSet corres = h_corres;
+    auto result = registration::RegistrationRANSACBasedOnCorrespondence(
+            source, target, corres, 0.05);
+    EXPECT_TRUE(result.transformation_.isApprox(ref_tf, 1.0e-3));
+    EXPECT_NEAR(result.fitness_, 0.6, 1.0e-2);
+    EXPECT_NEAR(result.inlier_rmse_, 0.0, 1.0e-3);
+}
+
+TEST(GlobalRegistration, FastGlobalRegistrationBasedOnCorrespondence) {
+    const int size = 200;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(10.0, 10.0, 10.0), 0);
+    geometry::PointCloud source;
+    source.SetPoints(points);
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.3, Vector3f(1.0, 2.0, 3.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(1.0, -2.0, 0.5);
+    geometry::PointCloud target = source;
+    target.Transform(ref_tf);
+
+    thrust::host_vector<Vector2i> h_corres(size);
+    for (int i = 0; i < size; ++i) {
+        h_corres[i] = Vector2i(i, (i % 5 < 3) ? i : (i * 7 + 3) % size);
+    }
+    registration::CorrespondenceSet corres = h_corres;
+    registration::FastGlobalRegistrationOption option;
+    option.maximum_correspondence_distance_ = 0.05;
+    auto result = registration::FastGlobalRegistrationBasedOnCorrespondence(
+            source, target, corres, option);
+    EXPECT_TRUE(result.transformation_.isApprox(ref_tf, 1.0e-2));
+    EXPECT_NEAR(result.fitness_, 0.6, 1.0e-2);
+}
@@ -32,4 +32,48 @@ TEST(Kabsch, Kabsch) {
     std::cout << ref_tf << std::endl;
     std::cout << res << std::endl;
     EXPECT_TRUE(res.isApprox(ref_tf, 1.0e-3));
-}
\ No newline at end of file
+}
+TEST(Kabsch, KabschBatch) {
+    const int n_sets = 4;
+    const size_t size = 20;
+    Vector3f vmin(0.0, 0.0, 0.0);
+    Vector3f vmax(10.0, 10.0, 10.0);
+    thrust::host_vector<Vector3f> model(n_sets * size);
+    Rand(model, vmin, vmax, 0);
+    thrust::host_vector<Vector3f> target(n_sets * size);
+    thrust::host_vector<Vector2i> corres(n_sets * size);
+    thrust::host_vector<int> offsets(n_sets + 1);
+    std::vector<Matrix4f> ref_tfs(n_sets);
+    for (int s = 0; s < n_sets; ++s) {
+        const float rad = deg_to_rad(10.0f * (s + 1));
+        ref_tfs[s] = Matrix4f::Identity();
+        ref_tfs[s].block<3, 3>(0, 0) =
+                AngleAxisf(rad, Vector3f(1.0, s, 1.0).normalized()).matrix() *
+                (1.0 + 0.1 * s);
+        ref_tfs[s].block<3, 1>(0, 3) = Vector3f(s, -1.0, 0.5 * s);
+        offsets[s] = s * size;
+        for (size_t i = 0; i < size; ++i) {
+            const int idx = s * size + i;
+            target[idx] = ref_tfs[s].block<3, 3>(0, 0) * model[idx] +
+                          ref_tfs[s].block<3, 1>(0, 3);
+            // Reverse the target order to check the correspondences.
+            corres[idx] = Vector2i(idx, s * size + size - 1 - i);
+        }
+        thrust::host_vector<Vector3f> reversed(target.begin() + s * size,
+                                               target.begin() + (s + 1) * size);
+        for (size_t i = 0; i < size; ++i) {
+            target[s * size + size - 1 - i] = reversed[i];
+        }
+    }
+    offsets[n_sets] = n_sets * size;
+    utility::device_vector<Vector3f> d_model = model;
+    utility::device_vector<Vector3f> d_target = target;
+    registration::CorrespondenceSet d_corres = corres;
+    utility::device_vector<int> d_offsets = offsets;
+    thrust::host_vector<Matrix4f_u> res = registration::KabschBatch(
+            d_model, d_target, d_corres, d_offsets, true);
+    ASSERT_EQ(res.size(), n_sets);
+    for (int s = 0; s < n_sets; ++s) {
+        EXPECT_TRUE(Matrix4f(res[s]).isApprox(ref_tfs[s], 1.0e-3));
+    }
+}
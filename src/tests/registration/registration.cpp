@@ -0,0 +1,340 @@
+#include "cupoch/registration/registration.h"
+
+#include <Eigen/Geometry>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/registration/colored_icp.h"
+#include "cupoch/registration/ndt.h"
+#include "cupoch/utility/memory_tracker.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+// Point to point estimation whose own transformation is always identity.
+class IdentityEstimation
+    : public registration::TransformationEstimationPointToPoint {
+public:
+    Matrix4f ComputeTransformation(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const registration::CorrespondenceSet &corres) const override {
+        ++num_calls_;
+        return Matrix4f::Identity();
+    }
+
+    mutable int num_calls_ = 0;
+};
+
+// Point to point estimation run one ComputeTransformation() per iteration,
+// as only the exact estimation types take the fused step.
+class UnfusedPointToPoint
+    : public registration::TransformationEstimationPointToPoint {};
+
+}  // namespace
+
+TEST(Registration, RegistrationMultiScaleICP) {
+    // Points on the faces of a unit cube.
+    const int size = 20000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.1, Vector3f(1.0, 2.0, 3.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.05, -0.08, 0.03);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    const std::vector<float> voxel_sizes = {0.1, 0.05, 0.0};
+    const std::vector<float> distances = {0.3, 0.1, 0.05};
+    const std::vector<registration::ICPConvergenceCriteria> criteria = {
+            registration::ICPConvergenceCriteria(1e-6, 1e-6, 30),
+            registration::ICPConvergenceCriteria(1e-6, 1e-6, 20),
+            registration::ICPConvergenceCriteria(1e-6, 1e-6, 10)};
+    auto result = registration::RegistrationMultiScaleICP(
+            source, target, voxel_sizes, criteria, distances,
+            Matrix4f::Identity(),
+            registration::TransformationEstimationPointToPlane());
+    EXPECT_TRUE(result.transformation_.isApprox(ref_tf, 1.0e-3));
+    EXPECT_GT(result.fitness_, 0.99);
+    EXPECT_FALSE(result.correspondence_set_.empty());
+}
+
+TEST(Registration, RegistrationICPBatch) {
+    const int n_pairs = 3;
+    const int size = 5000;
+    std::vector<std::shared_ptr<geometry::PointCloud>> sources;
+    std::vector<std::shared_ptr<geometry::PointCloud>> targets;
+    std::vector<Matrix4f_u> ref_tfs;
+    for (int p = 0; p < n_pairs; ++p) {
+        thrust::host_vector<Vector3f> points(size);
+        Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), p);
+        for (int i = 0; i < size; ++i) {
+            points[i]((i / 2) % 3) = (float)(i % 2);
+        }
+        auto target = std::make_shared<geometry::PointCloud>();
+        target->SetPoints(points);
+        Matrix4f ref_tf = Matrix4f::Identity();
+        ref_tf.block<3, 3>(0, 0) =
+                AngleAxisf(0.02 * (p + 1), Vector3f(p, 1.0, 2.0).normalized())
+                        .matrix();
+        ref_tf.block<3, 1>(0, 3) = Vector3f(0.01 * p, -0.02, 0.01);
+        auto source = std::make_shared<geometry::PointCloud>(*target);
+        source->Transform(ref_tf.inverse());
+        sources.push_back(source);
+        targets.push_back(target);
+        ref_tfs.push_back(ref_tf);
+    }
+    auto results = registration::RegistrationICPBatch(
+            sources, targets, 0.1, std::vector<Matrix4f_u>(),
+            registration::TransformationEstimationPointToPoint(),
+            registration::ICPConvergenceCriteria(1e-6, 1e-6, 50));
+    ASSERT_EQ(results.size(), (size_t)n_pairs);
+    for (int p = 0; p < n_pairs; ++p) {
+        EXPECT_TRUE(results[p].transformation_.isApprox(ref_tfs[p], 1.0e-3));
+        EXPECT_GT(results[p].fitness_, 0.99);
+        EXPECT_EQ(results[p].correspondence_set_.size(),
+                  (size_t)(results[p].fitness_ * size + 0.5));
+    }
+}
+
+TEST(Registration, RegistrationICPOnDevice) {
+    const int size = 5000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    target.EstimateNormals();
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.05, Vector3f(1.0, 1.0, 0.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.02, -0.01, 0.03);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    const auto criteria = registration::ICPConvergenceCriteria(1e-6, 1e-6, 50);
+    auto host_result = registration::RegistrationICP(
+            source, target, 0.1, Matrix4f::Identity(),
+            registration::TransformationEstimationPointToPlane(), criteria);
+    auto device_result = registration::RegistrationICPOnDevice(
+            source, target, 0.1, Matrix4f::Identity(),
+            registration::TransformationEstimationPointToPlane(), criteria);
+    EXPECT_TRUE(device_result.transformation_.isApprox(ref_tf, 1.0e-3));
+    EXPECT_TRUE(device_result.transformation_.isApprox(
+            host_result.transformation_, 1.0e-3));
+    EXPECT_NEAR(device_result.fitness_, host_result.fitness_, 1.0e-3);
+    EXPECT_EQ(device_result.correspondence_set_.size(),
+              host_result.correspondence_set_.size());
+}
+
+TEST(Registration, RegistrationICPSubclassedEstimation) {
+    const int size = 5000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.01, -0.01, 0.02);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    // The override is called instead of the fused point to point step.
+    const IdentityEstimation estimation;
+    auto result = registration::RegistrationICP(
+            source, target, 0.05, Matrix4f::Identity(), estimation);
+    EXPECT_GT(estimation.num_calls_, 0);
+    EXPECT_TRUE(result.transformation_.isIdentity());
+}
+
+TEST(Registration, RegistrationICPFarFromOrigin) {
+    const int size = 5000;
+    const Vector3f offset(500.0, -300.0, 800.0);
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+        points[i] += offset;
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    // Rotation about the center of the cloud, so that the points move by
+    // less than the correspondence distance.
+    const Vector3f center = offset + Vector3f::Constant(0.5);
+    const Matrix3f rot =
+            AngleAxisf(0.03, Vector3f(1.0, 2.0, 3.0).normalized()).matrix();
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) = rot;
+    ref_tf.block<3, 1>(0, 3) =
+            center - rot * center + Vector3f(0.01, -0.02, 0.01);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    const auto criteria = registration::ICPConvergenceCriteria(1e-6, 1e-6, 50);
+    auto fused_result = registration::RegistrationICP(
+            source, target, 0.1, Matrix4f::Identity(),
+            registration::TransformationEstimationPointToPoint(), criteria);
+    auto unfused_result = registration::RegistrationICP(
+            source, target, 0.1, Matrix4f::Identity(), UnfusedPointToPoint(),
+            criteria);
+    const Matrix4f &fused_tf = fused_result.transformation_;
+    const Matrix4f &unfused_tf = unfused_result.transformation_;
+    EXPECT_TRUE(fused_tf.block<3, 3>(0, 0).isApprox(rot, 1.0e-3));
+    EXPECT_TRUE(fused_tf.block<3, 3>(0, 0).isApprox(
+            unfused_tf.block<3, 3>(0, 0), 1.0e-3));
+    ExpectEQ(Vector3f(fused_tf.block<3, 1>(0, 3)),
+             Vector3f(unfused_tf.block<3, 1>(0, 3)), 1.0e-2);
+    EXPECT_NEAR(fused_result.fitness_, unfused_result.fitness_, 1.0e-3);
+}
+
+TEST(Registration, ICPRegistrator) {
+    const int size = 5000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.05, Vector3f(1.0, 0.0, 1.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.02, 0.01, -0.03);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    const auto criteria = registration::ICPConvergenceCriteria(1e-6, 1e-6, 30);
+    auto ref_result = registration::RegistrationICP(
+            source, target, 0.1, Matrix4f::Identity(),
+            registration::TransformationEstimationPointToPoint(), criteria);
+    registration::ICPRegistrator registrator(0.1, criteria);
+    EXPECT_FALSE(registrator.HasTarget());
+    registrator.SetTarget(target);
+    ASSERT_TRUE(registrator.HasTarget());
+    auto result = registrator.Register(source);
+    EXPECT_TRUE(result.transformation_.isApprox(ref_result.transformation_,
+                                                1.0e-4));
+    EXPECT_NEAR(result.fitness_, ref_result.fitness_, 1.0e-4);
+    EXPECT_EQ(result.correspondence_set_.size(),
+              ref_result.correspondence_set_.size());
+
+    // The KD-tree and the buffers of the first call are reused, so another
+    // source of the same size allocates no device memory at all once the
+    // correspondence set is not built.
+    Matrix4f other_tf = Matrix4f::Identity();
+    other_tf.block<3, 1>(0, 3) = Vector3f(-0.02, 0.03, 0.01);
+    geometry::PointCloud other_source = target;
+    other_source.Transform(other_tf.inverse());
+    registrator.compute_correspondence_set_ = false;
+    utility::EnableMemoryTracking(true);
+    const size_t n_allocations =
+            utility::GetMemoryUsage().back().num_allocations_;
+    result = registrator.Register(other_source);
+    EXPECT_EQ(utility::GetMemoryUsage().back().num_allocations_,
+              n_allocations);
+    utility::EnableMemoryTracking(false);
+    EXPECT_TRUE(result.correspondence_set_.empty());
+    EXPECT_TRUE(result.transformation_.isApprox(other_tf, 1.0e-3));
+    EXPECT_GT(result.fitness_, 0.99);
+}
+
+TEST(Registration, ColoredICPTarget) {
+    const int size = 5000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    thrust::host_vector<Vector3f> colors(size);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+        colors[i] = points[i];
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    target.SetColors(colors);
+    target.EstimateNormals();
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.05, Vector3f(0.0, 1.0, 1.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.01, 0.02, -0.02);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    const float max_distance = 0.05;
+    auto ref_result = registration::RegistrationColoredICP(source, target,
+                                                          max_distance);
+    registration::ColoredICPTarget colored_target(
+            target,
+            geometry::KDTreeSearchParamHybrid(max_distance * 2.0, 30));
+    EXPECT_EQ(colored_target.GetColorGradients().size(), size);
+    for (int i = 0; i < 2; ++i) {
+        auto result = registration::RegistrationColoredICP(
+                source, colored_target, max_distance);
+        EXPECT_TRUE(result.transformation_.isApprox(
+                ref_result.transformation_, 1.0e-4));
+        EXPECT_NEAR(result.fitness_, ref_result.fitness_, 1.0e-4);
+    }
+}
+
+TEST(Registration, RegistrationNDT) {
+    const int size = 40000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+        // Keeps the faces off the voxel boundaries.
+        points[i] += Vector3f::Constant(0.1);
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.02, Vector3f(1.0, 2.0, 3.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.01, -0.01, 0.005);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    // The map is built once and reused for every scan.
+    registration::NDTMap map(target, 0.3);
+    EXPECT_GT(map.GetNumDistributions(), 0);
+    for (int i = 0; i < 2; ++i) {
+        auto result = registration::RegistrationNDT(
+                source, map, Matrix4f::Identity(),
+                registration::ICPConvergenceCriteria(1e-6, 1e-6, 50));
+        EXPECT_TRUE(result.transformation_.isApprox(ref_tf, 1.0e-2));
+        EXPECT_GT(result.fitness_, 0.99);
+    }
+}
+
+TEST(Registration, GetInformationMatrixFromRegistrationResult) {
+    const int size = 5000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.01, -0.01, 0.02);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    auto result = registration::RegistrationICP(source, target, 0.05);
+    ASSERT_FALSE(result.correspondence_set_.empty());
+    const Matrix6f information =
+            registration::GetInformationMatrixFromRegistrationResult(target,
+                                                                     result);
+    const Matrix6f ref_information =
+            registration::GetInformationMatrixFromPointClouds(
+                    source, target, 0.05, result.transformation_);
+    EXPECT_NEAR(information(5, 5), result.correspondence_set_.size(), 1.0e-3);
+    EXPECT_TRUE(information.isApprox(ref_information, 1.0e-3));
+}
@@ -0,0 +1,87 @@
+#include "cupoch/registration/transformation_estimation.h"
+
+#include <Eigen/Geometry>
+
+#include "cupoch/geometry/pointcloud.h"
+#include "cupoch/registration/registration.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace Eigen;
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(TransformationEstimation, GeneralizedICP) {
+    // Points on the faces of a unit cube.
+    const int size = 3000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    target.EstimateNormals(geometry::KDTreeSearchParamKNN(10));
+
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 3>(0, 0) =
+            AngleAxisf(0.05, Vector3f(1.0, 2.0, 3.0).normalized()).matrix();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.02, -0.03, 0.01);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+
+    const registration::TransformationEstimationForGeneralizedICP estimation;
+    EXPECT_EQ(estimation.GetTransformationEstimationType(),
+              registration::TransformationEstimationType::GeneralizedICP);
+    auto result = registration::RegistrationICP(
+            source, target, 0.1, Matrix4f::Identity(), estimation);
+    EXPECT_TRUE(result.transformation_.isApprox(ref_tf, 1.0e-3));
+    EXPECT_GT(result.fitness_, 0.99);
+}
+
+TEST(TransformationEstimation, RobustKernel) {
+    const registration::RobustKernel l2;
+    const registration::RobustKernel huber(
+            registration::RobustKernelType::Huber, 0.5);
+    const registration::RobustKernel tukey(
+            registration::RobustKernelType::Tukey, 0.5);
+    const registration::RobustKernel cauchy(
+            registration::RobustKernelType::Cauchy, 0.5);
+    EXPECT_FLOAT_EQ(l2.Weight(3.0), 1.0);
+    EXPECT_FLOAT_EQ(huber.Weight(0.25), 1.0);
+    EXPECT_FLOAT_EQ(huber.Weight(-2.0), 0.25);
+    EXPECT_FLOAT_EQ(tukey.Weight(0.25), 0.5625);
+    EXPECT_FLOAT_EQ(tukey.Weight(1.0), 0.0);
+    EXPECT_FLOAT_EQ(cauchy.Weight(0.5), 0.5);
+
+    // Point to plane step with a fifth of the correspondences wrong.
+    const int size = 3000;
+    thrust::host_vector<Vector3f> points(size);
+    Rand(points, Vector3f(0.0, 0.0, 0.0), Vector3f(1.0, 1.0, 1.0), 0);
+    for (int i = 0; i < size; ++i) {
+        points[i]((i / 2) % 3) = (float)(i % 2);
+    }
+    geometry::PointCloud target;
+    target.SetPoints(points);
+    target.EstimateNormals(geometry::KDTreeSearchParamKNN(10));
+    Matrix4f ref_tf = Matrix4f::Identity();
+    ref_tf.block<3, 1>(0, 3) = Vector3f(0.01, -0.02, 0.01);
+    geometry::PointCloud source = target;
+    source.Transform(ref_tf.inverse());
+    thrust::host_vector<Vector2i> h_corres(size);
+    for (int i = 0; i < size; ++i) {
+        h_corres[i] = Vector2i(i, (i % 5 == 0) ? (i * 7 + 1) % size : i);
+    }
+    registration::CorrespondenceSet corres = h_corres;
+
+    const registration::TransformationEstimationPointToPlane l2_estimation;
+    const registration::TransformationEstimationPointToPlane tukey_estimation(
+            registration::RobustKernel(registration::RobustKernelType::Tukey,
+                                       0.05));
+    const Matrix4f l2_tf =
+            l2_estimation.ComputeTransformation(source, target, corres);
+    const Matrix4f tukey_tf =
+            tukey_estimation.ComputeTransformation(source, target, corres);
+    EXPECT_LT((tukey_tf - ref_tf).norm(), 1.0e-3);
+    EXPECT_LT((tukey_tf - ref_tf).norm(), (l2_tf - ref_tf).norm());
+}
@@ -0,0 +1,68 @@
+#include "cupoch/utility/device_hash_map.h"
+
+#include <thrust/host_vector.h>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(DeviceHashMap, InsertFindErase) {
+    utility::device_hash_map<unsigned long long, int> map(4);
+    EXPECT_EQ(map.bucket_count(), 8u);
+    EXPECT_TRUE(map.empty());
+
+    // Enough keys to rehash the table twice.
+    const int n = 100;
+    thrust::host_vector<unsigned long long> h_keys(n);
+    thrust::host_vector<int> h_values(n);
+    for (int i = 0; i < n; ++i) {
+        h_keys[i] = 7919ull * i;
+        h_values[i] = i;
+    }
+    utility::device_vector<unsigned long long> keys = h_keys;
+    utility::device_vector<int> values = h_values;
+    EXPECT_EQ(map.insert(keys, values), size_t(n));
+    EXPECT_EQ(map.size(), size_t(n));
+    EXPECT_GE(map.bucket_count(), size_t(2 * n));
+    // The values of the keys already in the map are kept.
+    utility::device_vector<int> other_values(n, -5);
+    EXPECT_EQ(map.insert(keys, other_values), 0u);
+
+    thrust::host_vector<unsigned long long> h_queries(3);
+    h_queries[0] = 0;
+    h_queries[1] = 7919ull * 42;
+    h_queries[2] = 1;
+    utility::device_vector<unsigned long long> queries = h_queries;
+    thrust::host_vector<int> found = map.find(queries, -1);
+    EXPECT_EQ(found[0], 0);
+    EXPECT_EQ(found[1], 42);
+    EXPECT_EQ(found[2], -1);
+
+    utility::device_vector<unsigned long long> erased(keys.begin(),
+                                                     keys.begin() + n / 2);
+    EXPECT_EQ(map.erase(erased), size_t(n / 2));
+    EXPECT_EQ(map.size(), size_t(n / 2));
+    thrust::host_vector<bool> contained = map.contains(queries);
+    EXPECT_FALSE(contained[0]);
+    EXPECT_TRUE(contained[1]);
+    EXPECT_FALSE(contained[2]);
+    EXPECT_EQ(map.occupied_slots().size(), size_t(n / 2));
+
+    utility::device_vector<unsigned long long> all_keys;
+    utility::device_vector<int> all_values;
+    map.retrieve_all(all_keys, all_values);
+    thrust::host_vector<unsigned long long> h_all_keys = all_keys;
+    thrust::host_vector<int> h_all_values = all_values;
+    ASSERT_EQ(h_all_keys.size(), size_t(n / 2));
+    for (size_t i = 0; i < h_all_keys.size(); ++i) {
+        EXPECT_EQ(h_all_keys[i], 7919ull * h_all_values[i]);
+        EXPECT_GE(h_all_values[i], n / 2);
+    }
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    found = map.find(queries, -1);
+    EXPECT_EQ(found[1], -1);
+}
@@ -0,0 +1,38 @@
+#include "cupoch/utility/host_mirror.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(HostMirror, Hash) {
+    thrust::host_vector<uint8_t> h(1003);
+    for (size_t i = 0; i < h.size(); ++i) h[i] = (uint8_t)(i * 7);
+    utility::device_vector<uint8_t> d = h;
+    const uint64_t hash = utility::HashHostMemory(h.data(), h.size());
+    EXPECT_EQ(utility::HashDeviceMemory(thrust::raw_pointer_cast(d.data()),
+                                        d.size()),
+              hash);
+    d[1002] = 0;
+    EXPECT_NE(utility::HashDeviceMemory(thrust::raw_pointer_cast(d.data()),
+                                        d.size()),
+              hash);
+}
+
+TEST(HostMirror, DownloadUpload) {
+    utility::HostMirror<float> mirror;
+    utility::device_vector<float> d(100, 1.0f);
+    EXPECT_EQ(mirror.Download(d)[99], 1.0f);
+    // The change of the device values is caught by the hash.
+    d[99] = 2.0f;
+    EXPECT_EQ(mirror.Download(d)[99], 2.0f);
+    thrust::host_vector<float> h(50, 3.0f);
+    mirror.Upload(h, d);
+    EXPECT_EQ(d.size(), 50u);
+    EXPECT_EQ(d[0], 3.0f);
+    d[0] = 4.0f;
+    // The same host values are uploaded again over the changed vector.
+    mirror.Upload(h, d);
+    EXPECT_EQ(d[0], 3.0f);
+}
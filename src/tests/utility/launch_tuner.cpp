@@ -0,0 +1,49 @@
+#include "cupoch/utility/launch_tuner.h"
+
+#include <cstdio>
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(LaunchTuner, TuneAndCache) {
+    const std::string default_cache = utility::GetLaunchTuningCacheFile();
+    const std::string cache = "launch_tuner_test_cache.txt";
+    std::remove(cache.c_str());
+    utility::SetLaunchTuningCacheFile(cache);
+    utility::EnableLaunchTuning(true);
+
+    utility::LaunchConfig config;
+    EXPECT_FALSE(utility::GetTunedLaunchConfig("LaunchTunerTest", 1000,
+                                               config));
+    int n_launches = 0;
+    while (!utility::GetTunedLaunchConfig("LaunchTunerTest", 1000, config)) {
+        ASSERT_LT(n_launches, 100);
+        utility::ScopedLaunchTuning tuning("LaunchTunerTest", 1000, 256);
+        EXPECT_LE(tuning.GetConfig().block_size_, 256);
+        ++n_launches;
+    }
+    EXPECT_GT(n_launches, 1);
+    {
+        // Same size class.
+        utility::ScopedLaunchTuning tuning("LaunchTunerTest", 1023);
+        EXPECT_EQ(tuning.GetConfig().block_size_, config.block_size_);
+        EXPECT_EQ(tuning.GetConfig().items_per_thread_,
+                  config.items_per_thread_);
+    }
+
+    utility::ResetLaunchTuning();
+    utility::LaunchConfig cached;
+    EXPECT_TRUE(utility::GetTunedLaunchConfig("LaunchTunerTest", 1000,
+                                              cached));
+    EXPECT_EQ(cached.block_size_, config.block_size_);
+    EXPECT_EQ(cached.items_per_thread_, config.items_per_thread_);
+
+    utility::SetLaunchTuningCacheFile("");
+    EXPECT_FALSE(utility::GetTunedLaunchConfig("LaunchTunerTest", 1000,
+                                               config));
+    utility::SetLaunchTuningCacheFile(default_cache);
+    std::remove(cache.c_str());
+}
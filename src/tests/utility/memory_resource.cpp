@@ -0,0 +1,106 @@
+#include "cupoch/utility/memory_resource.h"
+
+#include "cupoch/utility/device_vector.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(MemoryResource, LimitingAndBinning) {
+    auto cuda = std::make_shared<utility::CudaMemoryResource>();
+    auto limiting = std::make_shared<utility::LimitingMemoryResource>(
+            cuda, 1 << 20);
+    auto binning = std::make_shared<utility::BinningMemoryResource>(
+            limiting, 4096, 1 << 16);
+    void *a = binning->Allocate(100, 0);
+    void *b = binning->Allocate(200, 0);
+    EXPECT_NE(a, b);
+    // The first block of the 256 bytes bin sliced a whole chunk.
+    EXPECT_EQ(limiting->GetAllocatedBytes(), size_t(1 << 16));
+    binning->Deallocate(a, 100, 0);
+    EXPECT_EQ(binning->Allocate(256, 0), a);
+    binning->Deallocate(a, 256, 0);
+    binning->Deallocate(b, 200, 0);
+    EXPECT_THROW(limiting->Allocate(2 << 20, 0), std::bad_alloc);
+    EXPECT_EQ(limiting->GetAllocatedBytes(), size_t(1 << 16));
+    binning.reset();
+    EXPECT_EQ(limiting->GetAllocatedBytes(), 0u);
+}
+
+TEST(MemoryResource, DeviceVector) {
+    auto limiting = std::make_shared<utility::LimitingMemoryResource>(
+            std::make_shared<utility::CudaMemoryResource>(), 1 << 20);
+    utility::SetMemoryResource(limiting);
+    {
+        utility::device_vector<float> a(1000, 1.0f);
+        EXPECT_EQ(limiting->GetAllocatedBytes(), 1000 * sizeof(float));
+        EXPECT_THROW(utility::device_vector<float>(1 << 20),
+                     utility::OutOfMemoryError);
+        // The vectors keep their resource once another one is set.
+        utility::SetMemoryResource(
+                std::make_shared<utility::CudaMemoryResource>());
+        utility::device_vector<float> b = a;
+        a.clear();
+        a.shrink_to_fit();
+        EXPECT_EQ(limiting->GetAllocatedBytes(), 0u);
+        EXPECT_EQ(b[999], 1.0f);
+    }
+}
+
+TEST(MemoryResource, MappedHost) {
+    auto mapped = std::make_shared<utility::MappedHostMemoryResource>();
+    EXPECT_TRUE(mapped->IsHostAccessible());
+    utility::SetMemoryResource(mapped);
+    {
+        utility::device_vector<float> a;
+        EXPECT_TRUE(utility::IsHostAccessible(a));
+        thrust::host_vector<float> h(100, 2.0f);
+        utility::CopyFromHost(h, a);
+        // The host sees the values written through the device pointer.
+        a[0] = 3.0f;
+        thrust::host_vector<float> res = utility::CopyToHost(a);
+        EXPECT_EQ(res.size(), 100u);
+        EXPECT_EQ(res[0], 3.0f);
+        EXPECT_EQ(res[99], 2.0f);
+    }
+    utility::SetMemoryResource(
+            std::make_shared<utility::CudaMemoryResource>());
+}
+
+TEST(MemoryResource, Host) {
+    utility::HostMemoryResource host;
+    EXPECT_TRUE(host.IsHostAccessible());
+    float *ptr = static_cast<float *>(host.Allocate(100 * sizeof(float), 0));
+    ASSERT_NE(ptr, nullptr);
+    ptr[99] = 1.0f;
+    EXPECT_EQ(ptr[99], 1.0f);
+    host.Deallocate(ptr, 100 * sizeof(float), 0);
+}
+
+TEST(MemoryResource, VolumeMemoryResource) {
+    auto limiting = std::make_shared<utility::LimitingMemoryResource>(
+            std::make_shared<utility::CudaMemoryResource>(), 1 << 20);
+    utility::SetVolumeMemoryResource(limiting);
+    {
+        auto voxels = utility::MakeVolumeVector<float>(1000, 1.0f);
+        EXPECT_EQ(limiting->GetAllocatedBytes(), 1000 * sizeof(float));
+        // The other vectors keep the memory resource.
+        utility::device_vector<float> other(1000);
+        EXPECT_EQ(limiting->GetAllocatedBytes(), 1000 * sizeof(float));
+        EXPECT_FALSE(utility::IsManagedMemory(
+                thrust::raw_pointer_cast(voxels.data())));
+    }
+    EXPECT_EQ(limiting->GetAllocatedBytes(), 0u);
+    utility::EnableVolumeOversubscription(true);
+    {
+        auto voxels = utility::MakeVolumeVector<float>(1000, 1.0f);
+        EXPECT_TRUE(utility::IsManagedMemory(
+                thrust::raw_pointer_cast(voxels.data())));
+        utility::PrefetchManagedRegion(thrust::raw_pointer_cast(voxels.data()),
+                                       voxels.size() * sizeof(float), 0,
+                                       500 * sizeof(float));
+        EXPECT_EQ(voxels[999], 1.0f);
+    }
+    utility::SetVolumeMemoryResource(nullptr);
+}
@@ -0,0 +1,50 @@
+#include "cupoch/utility/memory_tracker.h"
+
+#include "cupoch/utility/device_vector.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(MemoryTracker, Subsystems) {
+    utility::EnableMemoryTracking(true);
+    const auto before =
+            utility::GetMemoryUsage(utility::MemorySubsystem::KDTree);
+    {
+        utility::ScopedMemorySubsystem kdtree(utility::MemorySubsystem::KDTree);
+        utility::device_vector<float> a(1000);
+        {
+            utility::ScopedMemorySubsystem tsdf(utility::MemorySubsystem::TSDF);
+            EXPECT_EQ(utility::GetMemorySubsystem(),
+                      utility::MemorySubsystem::TSDF);
+        }
+        EXPECT_EQ(utility::GetMemorySubsystem(),
+                  utility::MemorySubsystem::KDTree);
+        {
+            utility::device_vector<float> b(500);
+            const auto usage =
+                    utility::GetMemoryUsage(utility::MemorySubsystem::KDTree);
+            EXPECT_EQ(usage.live_bytes_,
+                      before.live_bytes_ + 1500 * sizeof(float));
+            EXPECT_EQ(usage.num_allocations_, before.num_allocations_ + 2);
+        }
+        const auto usage =
+                utility::GetMemoryUsage(utility::MemorySubsystem::KDTree);
+        EXPECT_EQ(usage.live_bytes_,
+                  before.live_bytes_ + 1000 * sizeof(float));
+        EXPECT_GE(usage.peak_bytes_,
+                  before.live_bytes_ + 1500 * sizeof(float));
+    }
+    EXPECT_EQ(utility::GetMemorySubsystem(), utility::MemorySubsystem::Other);
+    const auto after =
+            utility::GetMemoryUsage(utility::MemorySubsystem::KDTree);
+    EXPECT_EQ(after.live_bytes_, before.live_bytes_);
+
+    utility::ResetPeakMemoryUsage();
+    EXPECT_EQ(utility::GetMemoryUsage(utility::MemorySubsystem::KDTree)
+                      .peak_bytes_,
+              after.live_bytes_);
+    EXPECT_NE(utility::GetMemoryReport().find("KDTree"), std::string::npos);
+    utility::EnableMemoryTracking(false);
+}
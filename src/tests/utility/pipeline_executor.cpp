@@ -0,0 +1,57 @@
+#include "cupoch/utility/pipeline_executor.h"
+
+#include <atomic>
+#include <stdexcept>
+
+#include "cupoch/utility/device_vector.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(PipelineExecutor, RunsStagesInDependencyOrder) {
+    utility::PipelineExecutor executor(2);
+    const size_t n_slots = executor.GetMaxFramesInFlight();
+    std::vector<utility::device_vector<int>> slots(n_slots);
+    std::vector<int> results(8, -1);
+    std::atomic<int> n_side(0);
+    const int ingest = executor.AddStage(
+            "ingest", [&](utility::ExecutionContext &ctx, size_t frame) {
+                slots[frame % n_slots].assign(16, frame);
+            });
+    // Independent of the rest of the graph.
+    executor.AddStage("side", [&](utility::ExecutionContext &ctx,
+                                  size_t frame) { ++n_side; });
+    executor.AddStage(
+            "consume",
+            [&](utility::ExecutionContext &ctx, size_t frame) {
+                ctx.Synchronize();
+                results[frame] = slots[frame % n_slots][15];
+            },
+            {ingest});
+    EXPECT_EQ(executor.GetNumStages(), 3);
+    for (int i = 0; i < 8; ++i) executor.Submit();
+    executor.WaitAll();
+    for (int i = 0; i < 8; ++i) EXPECT_EQ(results[i], i);
+    EXPECT_EQ(n_side, 8);
+
+    const auto stats = executor.GetStageStats();
+    ASSERT_EQ(stats.size(), 3);
+    EXPECT_EQ(stats[0].name_, "ingest");
+    for (const auto &stat : stats) {
+        EXPECT_EQ(stat.count_, 8);
+        EXPECT_GE(stat.mean_device_ms_, 0.0f);
+    }
+}
+
+TEST(PipelineExecutor, RethrowsStageErrors) {
+    utility::PipelineExecutor executor;
+    executor.AddStage("fail", [](utility::ExecutionContext &ctx,
+                                 size_t frame) {
+        if (frame == 1) throw std::runtime_error("stage failure");
+    });
+    executor.Wait(executor.Submit());
+    const size_t frame = executor.Submit();
+    EXPECT_THROW(executor.Wait(frame), std::runtime_error);
+}
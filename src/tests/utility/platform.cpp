@@ -0,0 +1,62 @@
+#include "cupoch/utility/platform.h"
+
+#include "cupoch/utility/device_vector.h"
+#include "cupoch/utility/warm_up.h"
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(Platform, CudaSafeCallThrows) {
+    EXPECT_THROW(cudaSafeCall(cudaErrorInvalidValue), utility::CudaError);
+    EXPECT_THROW(cudaSafeCall(cudaErrorMemoryAllocation),
+                 utility::OutOfMemoryError);
+    EXPECT_NO_THROW(cudaSafeCall(cudaSuccess));
+}
+
+TEST(Platform, OutOfMemoryHandler) {
+    int n_calls = 0;
+    const int id = utility::AddOutOfMemoryHandler([&n_calls](size_t) {
+        ++n_calls;
+        return true;
+    });
+    // Far more than any device holds.
+    EXPECT_THROW(utility::device_vector<char>(size_t(1) << 50),
+                 utility::OutOfMemoryError);
+    EXPECT_EQ(n_calls, utility::kMaxOutOfMemoryRetries);
+    utility::RemoveOutOfMemoryHandler(id);
+
+    // The allocation succeeds once enough memory is released.
+    n_calls = 0;
+    cudaError_t result = cudaErrorMemoryAllocation;
+    utility::AddOutOfMemoryHandler([&](size_t) {
+        ++n_calls;
+        result = cudaSuccess;
+        return true;
+    });
+    EXPECT_NO_THROW(cudaSafeMalloc(result));
+    EXPECT_EQ(n_calls, 1);
+
+    // The other calls are neither retried nor evaluated twice.
+    n_calls = 0;
+    int n_evaluations = 0;
+    EXPECT_THROW(cudaSafeCall((++n_evaluations, cudaErrorMemoryAllocation)),
+                 utility::OutOfMemoryError);
+    EXPECT_EQ(n_evaluations, 1);
+    EXPECT_EQ(n_calls, 0);
+    utility::ClearOutOfMemoryHandlers();
+}
+
+TEST(Platform, WarmUp) {
+    utility::WarmUpConfig config;
+    config.num_streams_ = 2;
+    config.pool_bytes_ = 1 << 20;
+    int n_calls = 0;
+    config.tasks_.push_back([&n_calls]() {
+        utility::device_vector<float> buffer(1024, 1.0f);
+        ++n_calls;
+    });
+    EXPECT_NO_THROW(utility::WarmUp(config));
+    EXPECT_EQ(n_calls, 1);
+}
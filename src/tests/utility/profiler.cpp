@@ -0,0 +1,39 @@
+#include "cupoch/utility/profiler.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+TEST(Profiler, NestedScopes) {
+    utility::EnableProfiling(true);
+    utility::ResetProfile();
+    for (int i = 0; i < 3; ++i) {
+        CUPOCH_PROFILE("ProfilerTestOuter");
+        for (int j = 0; j < 2; ++j) {
+            CUPOCH_PROFILE("ProfilerTestInner");
+        }
+    }
+    utility::EnableProfiling(false);
+    {
+        CUPOCH_PROFILE("ProfilerTestDisabled");
+    }
+
+    const auto stats = utility::GetProfileStats();
+    ASSERT_EQ(stats.size(), 2);
+    EXPECT_EQ(stats[0].name_, "ProfilerTestOuter");
+    EXPECT_EQ(stats[0].count_, 3);
+    EXPECT_EQ(stats[1].name_, "ProfilerTestOuter/ProfilerTestInner");
+    EXPECT_EQ(stats[1].count_, 6);
+    for (const auto &stat : stats) {
+        EXPECT_GE(stat.mean_ms_, 0.0f);
+        EXPECT_LE(stat.mean_ms_, stat.p99_ms_);
+        EXPECT_LE(stat.p99_ms_, stat.max_ms_);
+    }
+    EXPECT_NE(utility::GetProfileReport().find("  ProfilerTestInner"),
+              std::string::npos);
+
+    utility::ResetProfile();
+    EXPECT_TRUE(utility::GetProfileStats().empty());
+}
@@ -0,0 +1,102 @@
+#include "cupoch/utility/sparse_matrix.h"
+
+#include "tests/test_utility/unit_test.h"
+
+using namespace cupoch;
+using namespace std;
+using namespace unit_test;
+
+namespace {
+
+// Laplacian of a path of n nodes plus the identity, with the diagonal given
+// as two duplicated halves.
+utility::SparseMatrix PathLaplacian(int n) {
+    thrust::host_vector<int> rows, cols;
+    thrust::host_vector<float> values;
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < 2; ++k) {
+            rows.push_back(i);
+            cols.push_back(i);
+            values.push_back(1.5);
+        }
+        if (i + 1 < n) {
+            rows.push_back(i);
+            cols.push_back(i + 1);
+            values.push_back(-1.0);
+            rows.push_back(i + 1);
+            cols.push_back(i);
+            values.push_back(-1.0);
+        }
+    }
+    return utility::SparseMatrix::FromTriplets(
+            n, n, 1, utility::device_vector<int>(rows),
+            utility::device_vector<int>(cols),
+            utility::device_vector<float>(values));
+}
+
+}  // namespace
+
+TEST(SparseMatrix, FromTriplets) {
+    const utility::SparseMatrix a = PathLaplacian(4);
+    EXPECT_EQ(a.Rows(), 4);
+    EXPECT_EQ(a.NumBlocks(), 10);
+    thrust::host_vector<int> offsets = a.row_offsets_;
+    thrust::host_vector<int> ref_offsets = vector<int>({0, 2, 5, 8, 10});
+    ExpectEQ(offsets, ref_offsets);
+    thrust::host_vector<float> values = a.values_;
+    EXPECT_FLOAT_EQ(values[0], 3.0);
+    EXPECT_FLOAT_EQ(values[1], -1.0);
+
+    utility::device_vector<float> x(4, 1.0f), y;
+    a.Multiply(x, y);
+    thrust::host_vector<float> h_y = y;
+    thrust::host_vector<float> ref_y = vector<float>({2.0, 1.0, 1.0, 2.0});
+    ExpectEQ(h_y, ref_y);
+}
+
+TEST(SparseMatrix, SolveConjugateGradient) {
+    const int n = 100;
+    const utility::SparseMatrix a = PathLaplacian(n);
+    thrust::host_vector<float> h_b(n);
+    for (int i = 0; i < n; ++i) h_b[i] = std::sin(0.1 * i);
+    const utility::device_vector<float> b = h_b;
+    for (auto preconditioner : {utility::PreconditionerType::None,
+                                utility::PreconditionerType::Jacobi,
+                                utility::PreconditionerType::BlockJacobi}) {
+        utility::device_vector<float> x;
+        const auto res = utility::SolveConjugateGradient(
+                a, b, x,
+                utility::ConjugateGradientOption(1000, 1e-6, preconditioner));
+        EXPECT_TRUE(res.converged_);
+        utility::device_vector<float> ax;
+        a.Multiply(x, ax);
+        thrust::host_vector<float> h_ax = ax;
+        for (int i = 0; i < n; ++i) EXPECT_NEAR(h_ax[i], h_b[i], 1.0e-4);
+    }
+}
+
+TEST(SparseMatrix, SolveBlockSystem) {
+    // Two coupled 3x3 SPD blocks.
+    thrust::host_vector<int> rows = vector<int>({0, 1, 0, 1});
+    thrust::host_vector<int> cols = vector<int>({0, 1, 1, 0});
+    thrust::host_vector<float> values;
+    const float d[9] = {4, 1, 0, 1, 3, 1, 0, 1, 2};
+    for (int k = 0; k < 2; ++k) values.insert(values.end(), d, d + 9);
+    for (int k = 0; k < 2; ++k) {
+        for (int e = 0; e < 9; ++e) values.push_back(e % 4 == 0 ? -0.5 : 0.0);
+    }
+    const auto a = utility::SparseMatrix::FromTriplets(
+            2, 2, 3, utility::device_vector<int>(rows),
+            utility::device_vector<int>(cols),
+            utility::device_vector<float>(values));
+    thrust::host_vector<float> h_b = vector<float>({1, 2, 3, 4, 5, 6});
+    const utility::device_vector<float> b = h_b;
+    utility::device_vector<float> x;
+    const auto res = utility::SolveConjugateGradient(a, b, x);
+    EXPECT_TRUE(res.converged_);
+    EXPECT_LE(res.iterations_, 10);
+    utility::device_vector<float> ax;
+    a.Multiply(x, ax);
+    thrust::host_vector<float> h_ax = ax;
+    for (int i = 0; i < 6; ++i) EXPECT_NEAR(h_ax[i], h_b[i], 1.0e-4);
+}